@@ -59,6 +59,11 @@ def pl_copts():
         "//conditions:default": [],
     })
 
+    perf_probe_flags = select({
+        "@px//bazel:disable_perf_probes": ["-DPL_DISABLE_PERF_PROBES=1"],
+        "//conditions:default": [],
+    })
+
     # Leaving this here as an example of how to add compiler dependent_flags.
     compiler_dependent_flags = select({
         "@px//bazel:gcc_build": [
@@ -73,7 +78,7 @@ def pl_copts():
         ],
     })
 
-    return posix_options + manual_system_includes + tcmalloc_flags + compiler_dependent_flags
+    return posix_options + manual_system_includes + tcmalloc_flags + perf_probe_flags + compiler_dependent_flags
 
 # Compute the final linkopts based on various options.
 def pl_linkopts():
@@ -0,0 +1,134 @@
+# Copyright 2018- The Pixie Authors.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+# Compares two directories of google-benchmark JSON results (as written by run_benchmarks.sh).
+# The per-repetition times of each benchmark are compared with a two-sided Mann-Whitney U test,
+# and a benchmark is reported as a regression when the change is both significant and larger than
+# the threshold. Allocation counters are compared exactly, since they are deterministic.
+# Exits with 1 if any benchmark regressed.
+import argparse
+import json
+import math
+import os
+import statistics
+import sys
+
+
+def load_results(results_dir):
+    '''Returns {benchmark name: {'times': [...], 'allocs_per_iter': ..., ...}}.'''
+    results = {}
+    for filename in sorted(os.listdir(results_dir)):
+        if not filename.endswith('.json'):
+            continue
+        with open(os.path.join(results_dir, filename)) as f:
+            data = json.load(f)
+        for bm in data.get('benchmarks', []):
+            # Skip the mean/median/stddev aggregates, we compute our own.
+            if bm.get('run_type') == 'aggregate' or 'error_occurred' in bm:
+                continue
+            name = '{}/{}'.format(os.path.splitext(filename)[0], bm['run_name'])
+            entry = results.setdefault(name, {'times': []})
+            entry['times'].append(bm['real_time'])
+            for counter in ['allocs_per_iter', 'max_bytes_used']:
+                if counter in bm:
+                    entry[counter] = bm[counter]
+    return results
+
+
+def mann_whitney_u(xs, ys):
+    '''Two-sided Mann-Whitney U test using the normal approximation with tie correction.
+
+    Returns the p-value.
+    '''
+    n1, n2 = len(xs), len(ys)
+    values = sorted([(v, 0) for v in xs] + [(v, 1) for v in ys])
+    ranks = [0.0] * len(values)
+    tie_term = 0.0
+    i = 0
+    while i < len(values):
+        j = i
+        while j + 1 < len(values) and values[j + 1][0] == values[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = (i + j) / 2.0 + 1
+        t = j - i + 1
+        tie_term += t ** 3 - t
+        i = j + 1
+
+    r1 = sum(r for r, (_, group) in zip(ranks, values) if group == 0)
+    u1 = r1 - n1 * (n1 + 1) / 2.0
+    mean = n1 * n2 / 2.0
+    n = n1 + n2
+    var = n1 * n2 / 12.0 * ((n + 1) - tie_term / (n * (n - 1)))
+    if var <= 0:
+        return 1.0
+    # Continuity correction.
+    z = (abs(u1 - mean) - 0.5) / math.sqrt(var)
+    return max(0.0, min(1.0, math.erfc(z / math.sqrt(2))))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Compares benchmark results against a baseline.')
+    parser.add_argument('baseline_dir', help='Directory with the baseline JSON results.')
+    parser.add_argument('new_dir', help='Directory with the new JSON results.')
+    parser.add_argument('--alpha', type=float, default=0.01,
+                        help='Significance level of the U test.')
+    parser.add_argument('--threshold', type=float, default=0.05,
+                        help='Minimum relative change of the median time to report.')
+    args = parser.parse_args()
+
+    baseline = load_results(args.baseline_dir)
+    new = load_results(args.new_dir)
+
+    regressions = []
+    row = '{:<70} {:>12} {:>12} {:>8} {:>8}  {}'
+    print(row.format('Benchmark', 'Base (med)', 'New (med)', 'Delta', 'p-value', ''))
+    for name in sorted(new):
+        if name not in baseline:
+            print(row.format(name, '-', '', '', '', 'new'))
+            continue
+        base_times, new_times = baseline[name]['times'], new[name]['times']
+        base_med, new_med = statistics.median(base_times), statistics.median(new_times)
+        delta = (new_med - base_med) / base_med if base_med else 0.0
+        p = mann_whitney_u(base_times, new_times)
+
+        notes = []
+        if p < args.alpha and abs(delta) >= args.threshold:
+            notes.append('REGRESSION' if delta > 0 else 'improvement')
+        for counter in ['allocs_per_iter', 'max_bytes_used']:
+            before, after = baseline[name].get(counter), new[name].get(counter)
+            if before is not None and after is not None and before != after:
+                notes.append('{} {:g} -> {:g}'.format(counter, before, after))
+        if len(base_times) < 5 or len(new_times) < 5:
+            notes.append('too few repetitions')
+        if 'REGRESSION' in notes:
+            regressions.append(name)
+
+        print(row.format(name, '{:.1f}'.format(base_med), '{:.1f}'.format(new_med),
+                         '{:+.1%}'.format(delta), '{:.3f}'.format(p), ', '.join(notes)))
+
+    for name in sorted(set(baseline) - set(new)):
+        print(row.format(name, '', '-', '', '', 'missing'))
+
+    if regressions:
+        print('\n{} benchmark(s) regressed.'.format(len(regressions)))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
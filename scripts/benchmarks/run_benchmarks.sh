@@ -0,0 +1,86 @@
+#! /bin/bash
+
+# Copyright 2018- The Pixie Authors.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+# Runs a suite of google-benchmark targets with a fixed number of repetitions on pinned CPUs and
+# writes one JSON result file per target. If a baseline directory is given, the results are
+# compared against it with compare_benchmarks.py.
+#
+# Usage: run_benchmarks.sh [-c cpus] [-r repetitions] [-o out_dir] [-b baseline_dir] suite_file
+
+set -e
+
+usage() {
+  echo "Usage: $0 [-c cpus] [-r repetitions] [-o out_dir] [-b baseline_dir] suite_file"
+  echo "  -c  CPU list passed to taskset (default: 2)"
+  echo "  -r  Number of repetitions of each benchmark (default: 10)"
+  echo "  -o  Directory to write the JSON results to (default: benchmark_results/<git sha>)"
+  echo "  -b  Baseline results directory to compare against"
+  exit 1
+}
+
+script_dir="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+cpus="2"
+repetitions="10"
+out_dir=""
+baseline_dir=""
+
+while getopts "c:r:o:b:h" opt; do
+  case ${opt} in
+    c) cpus="${OPTARG}" ;;
+    r) repetitions="${OPTARG}" ;;
+    o) out_dir="${OPTARG}" ;;
+    b) baseline_dir="${OPTARG}" ;;
+    *) usage ;;
+  esac
+done
+shift $((OPTIND - 1))
+
+suite_file="$1"
+if [[ -z "${suite_file}" ]]; then
+  usage
+fi
+if [[ -z "${out_dir}" ]]; then
+  out_dir="benchmark_results/$(git rev-parse --short HEAD)"
+fi
+mkdir -p "${out_dir}"
+out_dir="$(cd "${out_dir}" && pwd)"
+
+# Lines are bazel targets, optionally followed by extra benchmark arguments. '#' starts a comment.
+mapfile -t suite < <(sed -e 's/#.*//' -e '/^[[:space:]]*$/d' "${suite_file}")
+
+for line in "${suite[@]}"; do
+  read -r -a args <<< "${line}"
+  target="${args[0]}"
+  extra_args=("${args[@]:1}")
+  name="${target##*:}"
+
+  echo "Running ${target} on CPUs ${cpus}..."
+  # run_under keeps the benchmark pinned while bazel itself is free to use the other CPUs.
+  bazel run -c opt --run_under="taskset -c ${cpus}" "${target}" -- \
+    --benchmark_repetitions="${repetitions}" \
+    --benchmark_enable_random_interleaving=true \
+    --benchmark_out="${out_dir}/${name}.json" \
+    --benchmark_out_format=json \
+    "${extra_args[@]}"
+done
+
+echo "Results written to ${out_dir}"
+
+if [[ -n "${baseline_dir}" ]]; then
+  python3 "${script_dir}/compare_benchmarks.py" "${baseline_dir}" "${out_dir}"
+fi
@@ -20,6 +20,7 @@
 #include <google/protobuf/text_format.h>
 
 #include <algorithm>
+#include <limits>
 #include <random>
 #include <vector>
 
@@ -130,6 +131,51 @@ void BM_Query_Int(benchmark::State& state, std::vector<types::DataType> types,
   BM_Query(state, types, distribution_types, query, num_batches, default_params, default_params);
 }
 
+// Aggregates a table where every group key appears twice, which stresses the agg hash table
+// rather than the UDAs. Compare runs with different --carnot_agg_num_threads values to measure
+// the partitioned aggregation.
+// NOLINTNEXTLINE : runtime/references.
+void BM_Query_HighCardinality(benchmark::State& state, const std::string& query) {
+  constexpr int64_t kRowBatchSize = 64 * 1024;
+  int64_t num_groups = state.range(0);
+  int64_t num_batches = std::max<int64_t>(1, 2 * num_groups / kRowBatchSize);
+
+  // Make sure the whole data set fits into the table.
+  FLAGS_table_store_table_size_limit = std::numeric_limits<int32_t>::max();
+
+  std::vector<types::DataType> col_types = {types::DataType::INT64, types::DataType::INT64};
+  auto table = Table::Create("test_table", table_store::schema::Relation(
+                                               col_types, table_store::DefaultColumnNames(2)));
+  for (int64_t i = 0; i < num_batches; ++i) {
+    auto rb = table_store::schema::RowBatch(RowDescriptor(col_types), kRowBatchSize);
+    auto keys = datagen::CreateLargeData<types::Int64Value>(kRowBatchSize, 0, num_groups - 1);
+    auto values = datagen::CreateLargeData<types::Int64Value>(kRowBatchSize);
+    PX_CHECK_OK(rb.AddColumn(types::ToArrow(keys, arrow::default_memory_pool())));
+    PX_CHECK_OK(rb.AddColumn(types::ToArrow(values, arrow::default_memory_pool())));
+    PX_CHECK_OK(table->WriteRowBatch(rb));
+  }
+
+  auto table_store = std::make_shared<table_store::TableStore>();
+  table_store->AddTable("test_table", table);
+  auto server = LocalGRPCResultSinkServer();
+  auto carnot = SetUpCarnot(table_store, &server);
+
+  int64_t bytes_processed = 0;
+  int i = 0;
+  for (auto _ : state) {
+    auto queryWithTableName = absl::Substitute(query, "results_" + std::to_string(i));
+    auto res = carnot->ExecuteQuery(queryWithTableName, sole::uuid4(), CurrentTimeNS());
+    if (!res.ok()) {
+      LOG(FATAL) << "Aggregate benchmark query did not execute successfully.";
+    }
+    bytes_processed += server.exec_stats().ConsumeValueOrDie().execution_stats().bytes_processed();
+    server.ResetQueryResults();
+    ++i;
+  }
+
+  state.SetBytesProcessed(int64_t(bytes_processed));
+}
+
 const std::unique_ptr<const datagen::DistributionParams> sample_selection_params =
     std::make_unique<const datagen::ZipfianParams>(2, 2, 999);
 const std::unique_ptr<const datagen::DistributionParams> sample_length_params =
@@ -198,6 +244,12 @@ BENCHMARK_CAPTURE(BM_Query_Int, eval_group_by_one_exponential_int,
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
 
+BENCHMARK_CAPTURE(BM_Query_HighCardinality, eval_group_by_one_high_cardinality_int,
+                  kGroupByOneQuery)
+    ->RangeMultiplier(4)
+    ->Range(1 << 16, 1 << 22)
+    ->Unit(benchmark::kMillisecond);
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
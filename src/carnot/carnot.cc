@@ -23,18 +23,26 @@
 #include "src/carnot/carnotpb/carnot.grpc.pb.h"
 #include "src/carnot/carnotpb/carnot.pb.h"
 #include "src/carnot/engine_state.h"
+#include "src/carnot/exec_trace.h"
 #include "src/carnot/exec/exec_graph.h"
 #include "src/carnot/exec/grpc_router.h"
+#include "src/carnot/exec/grpc_sink_node.h"
 #include "src/carnot/funcs/builtins/builtins.h"
+#include "src/carnot/funcs/builtins/ml_ops.h"
 #include "src/carnot/plan/operators.h"
 #include "src/carnot/plan/plan.h"
 #include "src/carnot/planner/compiler/compiler.h"
 #include "src/carnot/planner/distributed/annotate_abortable_sources_for_limits_rule.h"
+#include "src/carnot/query_result_cache.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/perf/perf.h"
 #include "src/shared/types/type_utils.h"
 #include "src/table_store/table_store.h"
 
+DEFINE_bool(carnot_prewarm_ml_models, gflags::BoolFromEnv("PL_CARNOT_PREWARM_ML_MODELS", false),
+            "Whether to load the models of the ML functions at startup, so that the first query "
+            "using them doesn't pay the model load time.");
+
 namespace px {
 namespace carnot {
 
@@ -58,6 +66,9 @@ class CarnotImpl final : public Carnot {
   Status ExecuteQuery(const std::string& query, const sole::uuid& query_id,
                       types::Time64NSValue time_now, bool analyze) override;
 
+  StatusOr<planpb::Plan> CompileQuery(const std::string& query,
+                                      types::Time64NSValue time_now) override;
+
   Status ExecutePlan(const planpb::Plan& plan, const sole::uuid& query_id, bool analyze) override;
 
   void RegisterAgentMetadataCallback(AgentMetadataCallbackFunc func) override {
@@ -73,6 +84,9 @@ class CarnotImpl final : public Carnot {
 
   Status RegisterUDFsInPlanFragment(exec::ExecState* exec_state, plan::PlanFragment* pf);
   Status WalkExpression(exec::ExecState* exec_state, const plan::ScalarExpression& expr);
+  // Sends the cached batches of the GRPC sinks of pf through new sinks for this query.
+  Status SendCachedBatches(exec::ExecState* exec_state, plan::PlanFragment* pf,
+                           const QueryResultCache::SentBatches& cached_batches);
   /**
    * Returns the Table Store.
    */
@@ -100,6 +114,9 @@ class CarnotImpl final : public Carnot {
 
   // The id of the agent that owns this Carnot instance.
   sole::uuid agent_id_;
+
+  // Null when the result cache is disabled.
+  std::unique_ptr<QueryResultCache> result_cache_;
 };
 
 Status CarnotImpl::Init(const sole::uuid& agent_id, std::unique_ptr<udf::Registry> func_registry,
@@ -118,12 +135,19 @@ Status CarnotImpl::Init(const sole::uuid& agent_id, std::unique_ptr<udf::Registr
                                                  clients_config_->stub_generator,
                                                  clients_config_->add_auth_to_grpc_context_func,
                                                  &server_config_->grpc_router));
+  if (FLAGS_carnot_prewarm_ml_models) {
+    builtins::PrewarmMLModels(engine_state_->model_pool());
+  }
+  if (FLAGS_carnot_query_result_cache_ttl_ms > 0) {
+    result_cache_ = std::make_unique<QueryResultCache>(
+        std::chrono::milliseconds(FLAGS_carnot_query_result_cache_ttl_ms),
+        FLAGS_carnot_query_result_cache_max_bytes);
+  }
   return Status::OK();
 }
 
-Status CarnotImpl::ExecuteQuery(const std::string& query, const sole::uuid& query_id,
-                                types::Time64NSValue time_now, bool analyze) {
-  // Compile the query.
+StatusOr<planpb::Plan> CarnotImpl::CompileQuery(const std::string& query,
+                                                types::Time64NSValue time_now) {
   auto compiler_state = engine_state_->CreateLocalExecutionCompilerState(time_now);
   PX_ASSIGN_OR_RETURN(auto logical_plan, compiler_.CompileToIR(query, compiler_state.get()));
   // TOOD(james/nserrino/philkuz): This is a hack to make sure that the distributed rule for limits
@@ -131,7 +155,14 @@ Status CarnotImpl::ExecuteQuery(const std::string& query, const sole::uuid& quer
   // rules in these test envs.
   planner::distributed::AnnotateAbortableSourcesForLimitsRule rule;
   PX_RETURN_IF_ERROR(rule.Execute(logical_plan.get()));
-  PX_ASSIGN_OR_RETURN(auto plan_proto, logical_plan->ToProto());
+  return logical_plan->ToProto();
+}
+
+Status CarnotImpl::ExecuteQuery(const std::string& query, const sole::uuid& query_id,
+                                types::Time64NSValue time_now, bool analyze) {
+  // Compile the query.
+  PX_ASSIGN_OR_RETURN(auto plan_proto, CompileQuery(query, time_now));
+  auto compiler_state = engine_state_->CreateLocalExecutionCompilerState(time_now);
   auto dest = plan_proto.add_execution_status_destinations();
   dest->set_grpc_address(compiler_state->result_address());
   dest->set_ssl_targetname(compiler_state->result_ssl_targetname());
@@ -181,6 +212,7 @@ Status CarnotImpl::RegisterUDFsInPlanFragment(exec::ExecState* exec_state, plan:
       .OnUDTFSource(no_op)
       .OnEmptySource(no_op)
       .OnOTelSink(no_op)
+      .OnFileExportSink(no_op)
       .Walk(pf);
 }
 
@@ -227,6 +259,9 @@ void CarnotImpl::GRPCServerFunc() {
 
   builder.AddListeningPort(server_address, server_config_->grpc_server_creds);
   builder.RegisterService(&server_config_->grpc_router);
+  for (const auto& service : server_config_->services) {
+    builder.RegisterService(service.get());
+  }
   grpc_server_ = builder.BuildAndStart();
   std::cout << "Server listening on " << server_address << std::endl;
   CHECK(grpc_server_ != nullptr);
@@ -318,6 +353,31 @@ Status InitiateOutgoingConns(
                                                 std::move(req));
 }
 
+Status CarnotImpl::SendCachedBatches(exec::ExecState* exec_state, plan::PlanFragment* pf,
+                                     const QueryResultCache::SentBatches& cached_batches) {
+  auto fragment_it = cached_batches.find(pf->id());
+  for (const auto& [node_id, node] : pf->nodes()) {
+    if (node->op_type() != planpb::GRPC_SINK_OPERATOR) {
+      continue;
+    }
+    if (fragment_it == cached_batches.end() || fragment_it->second.count(node_id) == 0) {
+      return error::Internal("No cached row batches for GRPC sink $0 of plan fragment $1", node_id,
+                             pf->id());
+    }
+    const auto& batches = fragment_it->second.at(node_id);
+    const auto& desc = batches.front()->desc();
+    exec::GRPCSinkNode sink;
+    PX_RETURN_IF_ERROR(sink.Init(*node, desc, {desc}));
+    PX_RETURN_IF_ERROR(sink.Prepare(exec_state));
+    PX_RETURN_IF_ERROR(sink.Open(exec_state));
+    for (const auto& rb : batches) {
+      PX_RETURN_IF_ERROR(sink.ConsumeNext(exec_state, *rb, 0));
+    }
+    PX_RETURN_IF_ERROR(sink.Close(exec_state));
+  }
+  return Status::OK();
+}
+
 Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uuid& query_id,
                                bool analyze) {
   auto timer = ElapsedTimer();
@@ -328,6 +388,20 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
   // For each of the plan fragments in the plan, execute the query.
   std::vector<std::string> output_table_strs;
   auto exec_state = engine_state_->CreateExecState(query_id);
+  // A plan whose results are in the cache is answered by sending them again. Otherwise its
+  // results are recorded for the cache, if the plan can be cached at all.
+  std::string cache_key;
+  if (result_cache_ != nullptr && !analyze) {
+    cache_key = QueryResultCache::Key(logical_plan);
+  }
+  std::shared_ptr<const QueryResultCache::SentBatches> cached_batches;
+  if (!cache_key.empty()) {
+    cached_batches = result_cache_->Get(cache_key);
+    exec_state->set_record_sent_batches(cached_batches == nullptr);
+  }
+  QueryResultCache::SentBatches sent_batches;
+  bool cacheable = true;
+
   auto outgoing_conns = GetOutgoingConns(exec_state.get(), logical_plan);
   PX_RETURN_IF_ERROR(InitiateOutgoingConns(query_id, outgoing_conns,
                                            engine_state_->add_auth_to_grpc_context_func()));
@@ -355,11 +429,26 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
   auto s =
       plan::PlanWalker()
           .OnPlanFragment([&](auto* pf) {
+            if (cached_batches != nullptr) {
+              return SendCachedBatches(exec_state.get(), pf, *cached_batches);
+            }
             auto exec_graph = exec::ExecutionGraph();
             PX_RETURN_IF_ERROR(exec_graph.Init(schema.get(), plan_state.get(), exec_state.get(), pf,
                                                /* collect_exec_node_stats */ analyze));
             PX_RETURN_IF_ERROR(exec_graph.Execute());
 
+            if (exec_state->record_sent_batches()) {
+              auto& fragment_batches = sent_batches[pf->id()];
+              fragment_batches = exec_state->TakeSentBatches();
+              // A sink that sent nothing can't be replayed.
+              for (const auto& [node_id, node] : pf->nodes()) {
+                if (node->op_type() == planpb::GRPC_SINK_OPERATOR &&
+                    fragment_batches.count(node_id) == 0) {
+                  cacheable = false;
+                }
+              }
+            }
+
             // We must get this while exec_graph is alive. ExecutionGraph destructor calls
             // GRPCRouter::DeleteQuery() which would delete this data.
             auto errors = exec_state->grpc_router()->GetIncomingWorkerErrors(query_id);
@@ -375,6 +464,9 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
                     absl::Substitute("$0 (id=$1)", pf->nodes()[node_id]->DebugString(), node_id);
                 exec::ExecNodeStats* stats = exec_node->stats();
                 stats->AddExtraMetric("batches_output", stats->batches_output);
+                if (stats->dropped_batch_spans > 0) {
+                  stats->AddExtraMetric("dropped_batch_spans", stats->dropped_batch_spans);
+                }
                 int64_t total_time_ns = stats->TotalExecTime();
                 int64_t self_time_ns = stats->SelfExecTime();
                 LOG(INFO) << absl::Substitute(
@@ -390,6 +482,14 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
                 stats_pb->set_records_output(stats->rows_output);
                 stats_pb->set_total_execution_time_ns(total_time_ns);
                 stats_pb->set_self_execution_time_ns(self_time_ns);
+                stats_pb->set_bytes_allocated(stats->bytes_allocated);
+                for (const auto& span : stats->batch_spans) {
+                  auto* span_pb = stats_pb->add_batch_spans();
+                  span_pb->set_start_time_ns(span.start_time_ns);
+                  span_pb->set_duration_ns(span.duration_ns);
+                  span_pb->set_records(span.rows);
+                  span_pb->set_bytes(span.bytes);
+                }
 
                 for (const auto& [k, v] : stats->extra_metrics) {
                   (*stats_pb->mutable_extra_metrics())[k] = v;
@@ -400,11 +500,21 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
                 }
                 (*stats_pb->mutable_extra_info())["DebugString"] =
                     pf->nodes()[node_id]->DebugString();
+                (*stats_pb->mutable_extra_info())["Operator"] =
+                    planpb::OperatorType_Name(pf->nodes()[node_id]->op_type());
               }
             }
             return Status::OK();
           })
           .Walk(&plan);
+  if (!s.ok() && exec_state->exec_mem_pool()->limit_exceeded()) {
+    if (exec_state->exec_metrics() != nullptr) {
+      exec_state->exec_metrics()->query_memory_limit_exceeded_counter.Increment();
+    }
+    s = error::ResourceUnavailable("Query $0 exceeded its memory limit of $1 bytes: $2",
+                                   query_id.str(), exec_state->exec_mem_pool()->limit_bytes(),
+                                   s.msg());
+  }
   if (!s.ok()) {
     PX_RETURN_IF_ERROR(SendErrorToOutgoingConns(query_id, outgoing_conns,
                                                 engine_state_->add_auth_to_grpc_context_func(), s));
@@ -424,6 +534,10 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
     return combined_status;
   }
 
+  if (exec_state->record_sent_batches() && cacheable) {
+    result_cache_->Put(cache_key, std::move(sent_batches));
+  }
+
   std::vector<uuidpb::UUID> incoming_agents;
   for (const auto& id : logical_plan.incoming_agent_ids()) {
     incoming_agents.push_back(id);
@@ -450,6 +564,7 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
   agent_operator_exec_stats.set_execution_time_ns(timer.ElapsedTime_us() * 1000);
   agent_operator_exec_stats.set_bytes_processed(bytes_processed);
   agent_operator_exec_stats.set_records_processed(rows_processed);
+  agent_operator_exec_stats.set_peak_memory_bytes(exec_state->exec_mem_pool()->max_memory());
 
   std::vector<queryresultspb::AgentExecutionStats> all_agent_stats;
   if (analyze) {
@@ -460,6 +575,16 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
   // analyze=true will send per operator stats.
   all_agent_stats.push_back(agent_operator_exec_stats);
 
+  if (analyze && FLAGS_carnot_exec_trace_batches && !FLAGS_carnot_exec_trace_dir.empty()) {
+    // The trace is only useful for debugging, so failing to write it doesn't fail the query.
+    Status trace_status = WriteExecutionTrace(FLAGS_carnot_exec_trace_dir, query_id,
+                                              all_agent_stats);
+    if (!trace_status.ok()) {
+      LOG(WARNING) << absl::Substitute("Failed to write the execution trace of query $0: $1",
+                                       query_id.str(), trace_status.msg());
+    }
+  }
+
   return SendFinalExecutionStatsToOutgoingConns(query_id, outgoing_conns,
                                                 engine_state_->add_auth_to_grpc_context_func(),
                                                 agent_operator_exec_stats, all_agent_stats);
@@ -43,6 +43,8 @@ class Carnot : public NotCopyable {
     int grpc_server_port;
     std::shared_ptr<grpc::ServerCredentials> grpc_server_creds;
     exec::GRPCRouter grpc_router;
+    // Additional services to serve alongside the router, such as the agent debug service.
+    std::vector<std::shared_ptr<grpc::Service>> services;
   };
 
   struct ClientsConfig {
@@ -72,6 +74,15 @@ class Carnot : public NotCopyable {
    */
   virtual Status ExecuteQuery(const std::string& query, const sole::uuid& query_id,
                               types::Time64NSValue time_now, bool analyze = false) = 0;
+  /**
+   * Compiles the given query into a plan for this Carnot instance, without executing it.
+   *
+   * @param query the query in the form of a string.
+   * @param time_now the current time.
+   * @return the plan of the query if successful. Error status otherwise.
+   */
+  virtual StatusOr<planpb::Plan> CompileQuery(const std::string& query,
+                                              types::Time64NSValue time_now) = 0;
   /**
    * Executes the given logical plan.
    *
@@ -16,10 +16,18 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include <absl/strings/match.h>
+#include <absl/strings/str_split.h>
 #include <parser.hpp>
 #include <sole.hpp>
 
@@ -28,12 +36,26 @@
 #include "src/carnot/exec/local_grpc_result_server.h"
 #include "src/carnot/funcs/funcs.h"
 #include "src/common/base/base.h"
+#include "src/common/base/file.h"
+#include "src/common/zlib/zlib_wrapper.h"
 #include "src/shared/types/column_wrapper.h"
 #include "src/shared/types/type_utils.h"
+#include "src/table_store/schemapb/schema.pb.h"
 #include "src/table_store/table_store.h"
 
 DEFINE_string(input_file, gflags::StringFromEnv("INPUT_FILE", ""),
-              "The csv containing data to run the query on.");
+              "The csv containing data to run the query on, or a file or directory of tables "
+              "written by the file export sink (.pb.gz).");
+
+DEFINE_string(input_format, gflags::StringFromEnv("INPUT_FORMAT", ""),
+              "The format of input_file: csv or export. Inferred from input_file if empty.");
+
+DEFINE_string(input_columns, gflags::StringFromEnv("INPUT_COLUMNS", ""),
+              "Comma separated names of the columns to load from exported tables. All the columns "
+              "are loaded if empty.");
+
+DEFINE_int32(load_threads, gflags::Int32FromEnv("LOAD_THREADS", 0),
+             "The number of threads that decode exported tables. Defaults to the number of cores.");
 
 DEFINE_string(output_file, gflags::StringFromEnv("OUTPUT_FILE", ""),
               "The file path to write the output data to.");
@@ -199,6 +221,114 @@ std::shared_ptr<px::table_store::Table> GetTableFromCsv(const std::string& filen
   return table;
 }
 
+constexpr char kExportFileExtension[] = ".pb.gz";
+
+/**
+ * The row batches of one exported file, pruned to the loaded columns.
+ */
+struct DecodedExportFile {
+  px::Status status;
+  px::table_store::schema::Relation relation;
+  std::vector<std::unique_ptr<px::table_store::schema::RowBatch>> row_batches;
+};
+
+DecodedExportFile DecodeExportFile(const std::string& filename,
+                                   const std::vector<std::string>& columns) {
+  DecodedExportFile decoded;
+  decoded.status = [&]() -> px::Status {
+    PX_ASSIGN_OR_RETURN(std::string contents, px::ReadFileToString(filename, std::ios::binary));
+    PX_ASSIGN_OR_RETURN(std::string serialized, px::zlib::Inflate(contents));
+    px::table_store::schemapb::Table table_pb;
+    if (!table_pb.ParseFromString(serialized)) {
+      return px::error::InvalidArgument("Could not parse the exported table in $0", filename);
+    }
+    px::table_store::schema::Relation file_relation;
+    PX_RETURN_IF_ERROR(file_relation.FromProto(&table_pb.relation()));
+
+    std::vector<int64_t> col_idxs;
+    for (const auto& name : columns.empty() ? file_relation.col_names() : columns) {
+      if (!file_relation.HasColumn(name)) {
+        return px::error::InvalidArgument("Column '$0' is not in $1", name, filename);
+      }
+      int64_t idx = file_relation.GetColumnIndex(name);
+      col_idxs.push_back(idx);
+      decoded.relation.AddColumn(file_relation.GetColumnType(idx), name);
+    }
+    px::table_store::schema::RowDescriptor desc(decoded.relation.col_types());
+    for (const auto& rb_pb : table_pb.row_batches()) {
+      PX_ASSIGN_OR_RETURN(auto rb, px::table_store::schema::RowBatch::FromProto(rb_pb));
+      auto pruned = std::make_unique<px::table_store::schema::RowBatch>(desc, rb->num_rows());
+      for (int64_t idx : col_idxs) {
+        PX_RETURN_IF_ERROR(pruned->AddColumn(rb->ColumnAt(idx)));
+      }
+      decoded.row_batches.push_back(std::move(pruned));
+    }
+    return px::Status::OK();
+  }();
+  return decoded;
+}
+
+/**
+ * Loads the tables written by the file export sink into a Carnot table. The files are decoded in
+ * parallel, and their row batches are appended in file name order, which is the order in which
+ * they were written.
+ * @param path An exported file, or a directory that is searched for exported files.
+ * @param columns The names of the columns to load, all of them if empty.
+ * @param num_threads The number of threads that decode files.
+ * @return The Carnot table.
+ */
+px::StatusOr<std::shared_ptr<px::table_store::Table>> GetTableFromExport(
+    const std::string& path, const std::string& table_name,
+    const std::vector<std::string>& columns, int num_threads) {
+  std::vector<std::string> filenames;
+  if (std::filesystem::is_directory(path)) {
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(path)) {
+      if (entry.is_regular_file() && absl::EndsWith(entry.path().string(), kExportFileExtension)) {
+        filenames.push_back(entry.path().string());
+      }
+    }
+    std::sort(filenames.begin(), filenames.end());
+  } else {
+    filenames.push_back(path);
+  }
+  if (filenames.empty()) {
+    return px::error::InvalidArgument("No exported tables found in $0", path);
+  }
+
+  std::vector<DecodedExportFile> decoded(filenames.size());
+  std::atomic<size_t> next_file = 0;
+  std::vector<std::thread> threads;
+  num_threads = std::clamp(num_threads, 1, static_cast<int>(filenames.size()));
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&]() {
+      for (size_t f = next_file++; f < filenames.size(); f = next_file++) {
+        decoded[f] = DecodeExportFile(filenames[f], columns);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::shared_ptr<px::table_store::Table> table;
+  for (size_t f = 0; f < filenames.size(); ++f) {
+    PX_RETURN_IF_ERROR(decoded[f].status);
+    if (table == nullptr) {
+      table = px::table_store::Table::Create(table_name, decoded[f].relation);
+    } else if (table->GetRelation() != decoded[f].relation) {
+      return px::error::InvalidArgument("The relation of $0 is $1, expected $2", filenames[f],
+                                        decoded[f].relation.DebugString(),
+                                        table->GetRelation().DebugString());
+    }
+    for (const auto& rb : decoded[f].row_batches) {
+      PX_RETURN_IF_ERROR(table->WriteRowBatch(*rb));
+    }
+    // Release the decoded batches as soon as they are copied into the table.
+    decoded[f].row_batches.clear();
+  }
+  return table;
+}
+
 /**
  * Write the table to a CSV.
  * @param filename The name of the output CSV file.
@@ -236,7 +366,29 @@ int main(int argc, char* argv[]) {
   auto rb_size = FLAGS_rowbatch_size;
   auto table_name = FLAGS_table_name;
 
-  auto table = GetTableFromCsv(filename, rb_size);
+  auto input_format = FLAGS_input_format;
+  if (input_format.empty()) {
+    input_format = std::filesystem::is_directory(filename) ||
+                           absl::EndsWith(filename, kExportFileExtension)
+                       ? "export"
+                       : "csv";
+  }
+
+  auto load_start = std::chrono::steady_clock::now();
+  std::shared_ptr<px::table_store::Table> table;
+  if (input_format == "csv") {
+    table = GetTableFromCsv(filename, rb_size);
+  } else if (input_format == "export") {
+    std::vector<std::string> columns = absl::StrSplit(FLAGS_input_columns, ',', absl::SkipEmpty());
+    int num_threads = FLAGS_load_threads;
+    if (num_threads <= 0) {
+      num_threads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    table = GetTableFromExport(filename, table_name, columns, num_threads).ConsumeValueOrDie();
+  } else {
+    LOG(FATAL) << absl::Substitute("Unknown input format '$0'", input_format);
+  }
+  auto load_end = std::chrono::steady_clock::now();
 
   // Execute query.
   auto table_store = std::make_shared<px::table_store::TableStore>();
@@ -258,10 +410,16 @@ int main(int argc, char* argv[]) {
                                            std::move(clients_config), std::move(server_config))
                     .ConsumeValueOrDie();
   table_store->AddTable(table_name, table);
+  auto exec_start = std::chrono::steady_clock::now();
   auto exec_status = carnot->ExecuteQuery(query, sole::uuid4(), px::CurrentTimeNS());
   if (!exec_status.ok()) {
     LOG(FATAL) << absl::Substitute("Query failed to execute: $0", exec_status.msg());
   }
+  auto exec_end = std::chrono::steady_clock::now();
+  LOG(INFO) << absl::Substitute(
+      "Loaded $0 rows in $1 ms, executed the query in $2 ms", table->GetTableStats().num_rows,
+      std::chrono::duration_cast<std::chrono::milliseconds>(load_end - load_start).count(),
+      std::chrono::duration_cast<std::chrono::milliseconds>(exec_end - exec_start).count());
 
   auto output_names = result_server.output_tables();
   if (!output_names.size()) {
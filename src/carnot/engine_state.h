@@ -26,6 +26,7 @@
 
 #include "src/carnot/exec/exec_metrics.h"
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/otel_export_state.h"
 #include "src/carnot/funcs/funcs.h"
 #include "src/carnot/plan/plan_state.h"
 #include "src/carnot/planner/compiler_state/compiler_state.h"
@@ -59,7 +60,8 @@ class EngineState : public NotCopyable {
         add_auth_to_grpc_context_func_(add_auth_to_grpc_context_func),
         grpc_router_(grpc_router),
         model_pool_(std::move(model_pool)),
-        metrics_(std::make_unique<ExecMetrics>(&(GetMetricsRegistry()))) {}
+        metrics_(std::make_unique<ExecMetrics>(&(GetMetricsRegistry()))),
+        otel_export_states_(std::make_unique<exec::OTelExportStateStore>()) {}
 
   static StatusOr<std::unique_ptr<EngineState>> CreateDefault(
       std::unique_ptr<udf::Registry> func_registry,
@@ -87,7 +89,8 @@ class EngineState : public NotCopyable {
         [this](const std::string& remote_addr, bool insecure) {
           return TraceStubGenerator(remote_addr, insecure);
         },
-        query_id, model_pool_.get(), grpc_router_, add_auth_to_grpc_context_func_, metrics_.get());
+        query_id, model_pool_.get(), grpc_router_, add_auth_to_grpc_context_func_, metrics_.get(),
+        otel_export_states_.get());
   }
   std::shared_ptr<grpc::Channel> CreateChannel(const std::string& remote_addr, bool insecure) {
     grpc::ChannelArguments args;
@@ -97,6 +100,9 @@ class EngineState : public NotCopyable {
     args.SetInt(GRPC_ARG_HTTP2_BDP_PROBE, 1);
     args.SetInt(GRPC_ARG_HTTP2_MIN_RECV_PING_INTERVAL_WITHOUT_DATA_MS, 50000);
     args.SetInt(GRPC_ARG_HTTP2_MIN_SENT_PING_INTERVAL_WITHOUT_DATA_MS, 100000);
+    // Give every channel its own connection, so that the OTel export channels to a collector are
+    // actually sent in parallel.
+    args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
 
     auto channel_creds = insecure ? grpc::InsecureChannelCredentials()
                                   : grpc::SslCredentials(grpc::SslCredentialsOptions());
@@ -148,6 +154,7 @@ class EngineState : public NotCopyable {
   exec::GRPCRouter* grpc_router_ = nullptr;
   std::unique_ptr<udf::ModelPool> model_pool_;
   std::unique_ptr<ExecMetrics> metrics_;
+  std::unique_ptr<exec::OTelExportStateStore> otel_export_states_;
 };
 
 }  // namespace carnot
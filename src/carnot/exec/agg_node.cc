@@ -23,6 +23,7 @@
 #include <arrow/status.h>
 #include <algorithm>
 #include <cstdint>
+#include <numeric>
 
 #include <magic_enum.hpp>
 
@@ -31,21 +32,37 @@
 #include "src/carnot/planpb/plan.pb.h"
 #include "src/carnot/udf/udf_wrapper.h"
 #include "src/common/base/base.h"
+#include "src/common/base/thread_pool.h"
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/type_utils.h"
 #include "src/shared/types/types.h"
 
+DEFINE_int32(carnot_agg_num_threads, gflags::Int32FromEnv("PL_CARNOT_AGG_NUM_THREADS", 1),
+             "The number of threads used by a group by aggregate to update and evaluate its "
+             "hash table partitions. 1 disables partitioning.");
+
 namespace px {
 namespace carnot {
 namespace exec {
 
 using SharedArray = std::shared_ptr<arrow::Array>;
 constexpr int64_t kAggCompactionThreshold = 512;
+// Using more partitions than threads keeps the work balanced when the key distribution is skewed.
+constexpr size_t kAggPartitionsPerThread = 4;
+// Rough size of the state of a single UDA, used to account the memory of the groups.
+constexpr int64_t kAggUDAStateBytesEstimate = 64;
 
 using table_store::schema::RowBatch;
 using table_store::schema::RowDescriptor;
 
 namespace {
+// The pool is shared by all of the aggregates running in this process. The calling thread
+// always participates in the work, so the pool holds one thread less than requested.
+ThreadPool* AggThreadPool() {
+  static ThreadPool pool(std::max(0, FLAGS_carnot_agg_num_threads - 1));
+  return &pool;
+}
+
 template <types::DataType DT>
 void ExtractIntoGroupArgs(std::vector<GroupArgs>* group_args, arrow::Array* col, int rt_col_idx) {
   auto num_rows = col->length();
@@ -66,11 +83,11 @@ void AppendToBuilder(arrow::ArrayBuilder* builder, RowTuple* rt, size_t rt_idx)
 
 template <types::DataType DT>
 void ExtractToColumnWrapper(const std::vector<GroupArgs>& group_args,
+                            const std::vector<int64_t>& row_idxs,
                             const table_store::schema::RowBatch& rb, size_t col_idx,
                             size_t rb_col_idx) {
-  size_t num_rows = rb.num_rows();
-  DCHECK(num_rows <= group_args.size());
-  for (size_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+  DCHECK(static_cast<size_t>(rb.num_rows()) <= group_args.size());
+  for (int64_t row_idx : row_idxs) {
     DCHECK(group_args[row_idx].av != nullptr);
     auto col_wrapper = group_args[row_idx].av->agg_cols[col_idx].get();
     auto arr = rb.ColumnAt(rb_col_idx).get();
@@ -126,6 +143,13 @@ Status AggNode::InitImpl(const plan::Operator& plan_node) {
     DCHECK(group.idx < input_descriptor_->size());
     group_data_types_.emplace_back(input_descriptor_->type(group.idx));
   }
+  if (plan_node_->time_windowed()) {
+    auto window_dt = group_data_types_[plan_node_->time_window_group()];
+    if (window_dt != types::TIME64NS && window_dt != types::INT64) {
+      return error::InvalidArgument("Time window group must be a time, got $0",
+                                    types::ToString(window_dt));
+    }
+  }
 
   auto values_size = plan_node_->values().size();
   for (size_t i = 0; i < values_size; ++i) {
@@ -137,6 +161,55 @@ Status AggNode::InitImpl(const plan::Operator& plan_node) {
   return CreateColumnMapping();
 }
 
+size_t AggNode::NumGroups() const {
+  size_t num_groups = 0;
+  for (const auto& partition : partitions_) {
+    num_groups += partition->agg_hash_map.size();
+  }
+  return num_groups;
+}
+
+Status AggNode::ForEachPartition(const std::function<Status(AggPartition*)>& fn) {
+  if (partitions_.size() == 1) {
+    return fn(partitions_[0].get());
+  }
+  std::vector<Status> statuses(partitions_.size());
+  AggThreadPool()->ParallelFor(partitions_.size(),
+                               [&](size_t i) { statuses[i] = fn(partitions_[i].get()); });
+  for (const auto& s : statuses) {
+    PX_RETURN_IF_ERROR(s);
+  }
+  return Status::OK();
+}
+
+void AggNode::PartitionRowBatch(int64_t num_rows) {
+  for (auto& partition : partitions_) {
+    partition->row_idxs.clear();
+  }
+  spill_row_idxs_.clear();
+  if (partitions_.size() == 1 && !spilling_) {
+    auto& row_idxs = partitions_[0]->row_idxs;
+    row_idxs.resize(num_rows);
+    std::iota(row_idxs.begin(), row_idxs.end(), 0);
+    return;
+  }
+
+  // The group hashes were already computed by ExtractRowTupleForBatch. The bucketing is done in
+  // row order, so that each partition sees its rows in input order.
+  DCHECK_GE(static_cast<int64_t>(group_hashes_.size()), num_rows);
+  for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+    // The low bits of the hash are used by the partition's hash map, so partition on the high
+    // bits to keep the keys of a partition well spread in its own table.
+    uint64_t hash = group_hashes_[row_idx];
+    auto& partition = partitions_[(hash >> 32) % partitions_.size()];
+    if (spilling_ && !partition->agg_hash_map.contains(group_args_chunk_[row_idx].rt)) {
+      spill_row_idxs_.push_back(row_idx);
+      continue;
+    }
+    partition->row_idxs.push_back(row_idx);
+  }
+}
+
 Status AggNode::PrepareImpl(ExecState* exec_state) {
   function_ctx_ = exec_state->CreateFunctionContext();
   return Status::OK();
@@ -145,9 +218,26 @@ Status AggNode::PrepareImpl(ExecState* exec_state) {
 Status AggNode::OpenImpl(ExecState* exec_state) {
   if (HasNoGroups()) {
     PX_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_no_groups_, exec_state));
+    if (!plan_node_->partial_agg()) {
+      PX_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_for_deserialize_, exec_state));
+    }
+    return Status::OK();
   }
-  if (!plan_node_->partial_agg()) {
-    PX_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_for_deserialize_, exec_state));
+
+  group_bytes_estimate_ = sizeof(RowTuple) + sizeof(AggHashValue) +
+                          group_data_types_.size() * sizeof(types::FixedSizeValueUnion) +
+                          value_data_types_.size() * kAggUDAStateBytesEstimate;
+  if (num_partitions_ == 0) {
+    num_partitions_ = FLAGS_carnot_agg_num_threads > 1
+                          ? FLAGS_carnot_agg_num_threads * kAggPartitionsPerThread
+                          : 1;
+  }
+  for (size_t i = 0; i < num_partitions_; ++i) {
+    auto partition = std::make_unique<AggPartition>();
+    if (!plan_node_->partial_agg()) {
+      PX_RETURN_IF_ERROR(CreateUDAInfoValues(&partition->udas_for_deserialize, exec_state));
+    }
+    partitions_.push_back(std::move(partition));
   }
   return Status::OK();
 }
@@ -159,11 +249,14 @@ Status AggNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_
   return AggregateGroupByClause(exec_state, rb);
 }
 
-Status AggNode::CloseImpl(ExecState*) {
+Status AggNode::CloseImpl(ExecState* exec_state) {
   udas_no_groups_.clear();
   group_args_chunk_.clear();
   group_args_pool_.Clear();
-  udas_pool_.Clear();
+  partitions_.clear();
+  spill_.reset();
+  exec_state->memory_budget()->Release(groups_bytes_);
+  groups_bytes_ = 0;
 
   return Status::OK();
 }
@@ -177,7 +270,17 @@ Status AggNode::ClearAggState(ExecState* exec_state) {
     udas_no_groups_.clear();
     PX_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_no_groups_, exec_state));
   }
-  agg_hash_map_.clear();
+  // Drop the memory of the groups as well, so that spilled partitions (and the next window) can
+  // reuse it.
+  for (auto& partition : partitions_) {
+    partition->agg_hash_map.clear();
+    partition->udas_pool.Clear();
+  }
+  group_args_chunk_.clear();
+  group_args_pool_.Clear();
+  dropped_groups_ = 0;
+  exec_state->memory_budget()->Release(groups_bytes_);
+  groups_bytes_ = 0;
   return Status::OK();
 }
 
@@ -231,35 +334,44 @@ Status AggNode::ExtractRowTupleForBatch(const RowBatch& rb) {
   }
 
   // Scan through all the group args in column order and extract the entire column.
+  group_cols_.clear();
   for (size_t idx = 0; idx < plan_node_->groups().size(); idx++) {
     auto grp = plan_node_->groups()[idx];
     DCHECK(grp.idx < input_descriptor_->size());
     DCHECK(idx < group_data_types_.size());
     auto dt = group_data_types_[idx];
     auto col = rb.ColumnAt(grp.idx).get();
+    group_cols_.push_back(col);
 
 #define TYPE_CASE(_dt_) ExtractIntoGroupArgs<_dt_>(&group_args_chunk_, col, idx);
     PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
 #undef TYPE_CASE
   }
+
+  // Hash the group columns a column at a time, so that partitioning and the hash table lookups
+  // don't have to rehash each RowTuple.
+  HashKeyColumns(group_cols_, group_data_types_, &group_hashes_);
+  for (size_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+    group_args_chunk_[row_idx].rt->SetHash(group_hashes_[row_idx]);
+  }
   return Status::OK();
 }
 
-Status AggNode::HashRowBatch(ExecState* exec_state, const RowBatch& rb) {
-  PX_UNUSED(exec_state);
+Status AggNode::HashRowBatch(ExecState* exec_state, const RowBatch& rb,
+                             AggPartition* partition) {
   // Loop through all the row and basically store the values into column chunk based on which
   // group they belong to.
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+  for (int64_t row_idx : partition->row_idxs) {
     auto& ga = group_args_chunk_[row_idx];
     AggHashValue* val = nullptr;
     // Check to see if in hash
     // TODO(zasgar): Change this to upsert.
-    auto it = agg_hash_map_.find(ga.rt);
+    auto it = partition->agg_hash_map.find(ga.rt);
     // If not in hash then insert
-    if (it == agg_hash_map_.end()) {
+    if (it == partition->agg_hash_map.end()) {
       // Create a val array.
-      val = CreateAggHashValue(exec_state);
-      agg_hash_map_[ga.rt] = val;
+      val = CreateAggHashValue(exec_state, partition);
+      partition->agg_hash_map[ga.rt] = val;
       // We have inserted this, so the stored RowTuple is now in the table.
       ga.rt = nullptr;
     } else {
@@ -275,7 +387,8 @@ Status AggNode::HashRowBatch(ExecState* exec_state, const RowBatch& rb) {
 
     // Even if we're not doing a partial agg we want to extract the group values.
     if (plan_node_->partial_agg() || i < plan_node_->groups().size()) {
-#define TYPE_CASE(_dt_) ExtractToColumnWrapper<_dt_>(group_args_chunk_, rb, i, rb_col_idx);
+#define TYPE_CASE(_dt_) \
+  ExtractToColumnWrapper<_dt_>(group_args_chunk_, partition->row_idxs, rb, i, rb_col_idx);
 
       PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
 #undef TYPE_CASE
@@ -284,18 +397,17 @@ Status AggNode::HashRowBatch(ExecState* exec_state, const RowBatch& rb) {
   if (!plan_node_->partial_agg()) {
     // If we're not performing a partial_agg, then we're receiving serialized partial aggs, so we
     // deserialize and merge them here.
-    PX_RETURN_IF_ERROR(DeserializeAndMergeGrouped(group_args_chunk_, rb));
+    PX_RETURN_IF_ERROR(DeserializeAndMergeGrouped(partition, rb));
   }
 
   return Status::OK();
 }
 
-Status AggNode::EvaluatePartialAggregates(ExecState* exec_state, size_t num_records) {
-  PX_UNUSED(exec_state);
+Status AggNode::EvaluatePartialAggregates(ExecState* exec_state, AggPartition* partition) {
   // TODO(zasgar): This only needs to run for unique groups. We should find
   // a way to optimize this.
-  for (size_t i = 0; i < num_records; ++i) {
-    DCHECK(i < group_args_chunk_.size());
+  for (int64_t i : partition->row_idxs) {
+    DCHECK(static_cast<size_t>(i) < group_args_chunk_.size());
     auto& ga = group_args_chunk_[i];
     DCHECK(ga.av != nullptr);
     if (ga.av->agg_cols[0]->Size() > kAggCompactionThreshold) {
@@ -320,7 +432,9 @@ Status AggNode::ResetGroupArgs() {
   return Status::OK();
 }
 
-Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* output_rb) {
+Status AggNode::ConvertAggHashMapToRowBatch(
+    ExecState* exec_state, RowBatch* output_rb,
+    const std::function<bool(const RowTuple&)>& include) {
   PX_UNUSED(exec_state);
   DCHECK(output_rb != nullptr);
   std::vector<std::unique_ptr<arrow::ArrayBuilder>> group_builders;
@@ -332,34 +446,50 @@ Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* out
     value_builders.push_back(types::MakeArrowBuilder(value_data_type, exec_state->exec_mem_pool()));
   }
 
+  // Flush the buffered input values into the UDAs. This is where most of the UDA update work
+  // happens, so it runs concurrently in each partition.
+  if (plan_node_->partial_agg()) {
+    PX_RETURN_IF_ERROR(ForEachPartition([&](AggPartition* partition) {
+      for (const auto& kv : partition->agg_hash_map) {
+        if (include && !include(*kv.first)) {
+          continue;
+        }
+        PX_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, kv.second));
+      }
+      return Status::OK();
+    }));
+  }
+
   // Agg into agg values and emit!
-  for (const auto& kv : agg_hash_map_) {
-    auto* groups_rt = kv.first;
-    auto* val = kv.second;
+  for (const auto& partition : partitions_) {
+    for (const auto& kv : partition->agg_hash_map) {
+      auto* groups_rt = kv.first;
+      auto* val = kv.second;
+      if (include && !include(*groups_rt)) {
+        continue;
+      }
 
-    for (size_t i = 0; i < group_data_types_.size(); ++i) {
-      DCHECK(i < group_builders.size());
+      for (size_t i = 0; i < group_data_types_.size(); ++i) {
+        DCHECK(i < group_builders.size());
 
 #define TYPE_CASE(_dt_) AppendToBuilder<_dt_>(group_builders[i].get(), groups_rt, i);
-      PX_SWITCH_FOREACH_DATATYPE(group_data_types_[i], TYPE_CASE);
+        PX_SWITCH_FOREACH_DATATYPE(group_data_types_[i], TYPE_CASE);
 #undef TYPE_CASE
-    }
-    if (plan_node_->partial_agg()) {
-      PX_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, val));
-    }
-
-    if (plan_node_->finalize_results()) {
-      // Actually Finalize the UDA based on the column wrapper chunks.
-      for (size_t i = 0; i < val->udas.size(); ++i) {
-        const auto& uda_info = val->udas[i];
-        PX_RETURN_IF_ERROR(uda_info.def->FinalizeArrow(uda_info.uda.get(), function_ctx_.get(),
-                                                       value_builders[i].get()));
       }
-    } else {
-      for (size_t i = 0; i < val->udas.size(); ++i) {
-        const auto& uda_info = val->udas[i];
-        PX_RETURN_IF_ERROR(uda_info.def->SerializeArrow(uda_info.uda.get(), function_ctx_.get(),
-                                                        value_builders[i].get()));
+
+      if (plan_node_->finalize_results()) {
+        // Actually Finalize the UDA based on the column wrapper chunks.
+        for (size_t i = 0; i < val->udas.size(); ++i) {
+          const auto& uda_info = val->udas[i];
+          PX_RETURN_IF_ERROR(uda_info.def->FinalizeArrow(uda_info.uda.get(), function_ctx_.get(),
+                                                         value_builders[i].get()));
+        }
+      } else {
+        for (size_t i = 0; i < val->udas.size(); ++i) {
+          const auto& uda_info = val->udas[i];
+          PX_RETURN_IF_ERROR(uda_info.def->SerializeArrow(uda_info.uda.get(), function_ctx_.get(),
+                                                          value_builders[i].get()));
+        }
       }
     }
   }
@@ -380,6 +510,115 @@ Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* out
 }
 
 Status AggNode::AggregateGroupByClause(ExecState* exec_state, const RowBatch& rb) {
+  // A time windowed aggregate only holds its open windows, and it can't emit a window if some of
+  // its rows were spilled, so it never spills.
+  if (!spilling_ && !plan_node_->time_windowed() && exec_state->memory_budget()->Exceeded()) {
+    VLOG(1) << absl::Substitute(
+        "$0 is over the query memory budget ($1 of $2 bytes), spilling new groups to $3",
+        DebugString(), exec_state->memory_budget()->used_bytes(),
+        exec_state->memory_budget()->limit_bytes(), FLAGS_carnot_exec_spill_dir);
+    spilling_ = true;
+    if (spill_ == nullptr) {
+      spill_ = std::make_unique<SpillPartitions>(FLAGS_carnot_exec_spill_partitions);
+    }
+  }
+  PX_RETURN_IF_ERROR(AggregateRowBatch(exec_state, rb));
+  if (ReadyToEmitBatches(rb)) {
+    return EmitGroups(exec_state, rb.eow(), rb.eos());
+  }
+  if (plan_node_->time_windowed()) {
+    return EmitCompleteWindows(exec_state, rb);
+  }
+  return Status::OK();
+}
+
+bool AggNode::WindowComplete(const RowTuple& groups_rt) const {
+  // Both TIME64NS and INT64 window starts are stored as an Int64Value.
+  int64_t window_start =
+      types::Get<types::Int64Value>(groups_rt.fixed_values[plan_node_->time_window_group()]).val;
+  return window_start + plan_node_->time_window_size_ns() <= watermark_;
+}
+
+Status AggNode::EmitCompleteWindows(ExecState* exec_state, const RowBatch& rb) {
+  // The window starts are TIME64NS or INT64 values, both of which are stored as int64s.
+  const auto& window_col = rb.ColumnAt(plan_node_->groups()[plan_node_->time_window_group()].idx);
+  const int64_t* window_starts = window_col->data()->GetValues<int64_t>(1);
+  for (int64_t row_idx = 0; row_idx < window_col->length(); ++row_idx) {
+    if (!has_watermark_ || window_starts[row_idx] > watermark_) {
+      watermark_ = window_starts[row_idx];
+      has_watermark_ = true;
+    }
+  }
+  if (!has_watermark_) {
+    return Status::OK();
+  }
+
+  size_t num_complete = 0;
+  for (const auto& partition : partitions_) {
+    for (const auto& kv : partition->agg_hash_map) {
+      num_complete += WindowComplete(*kv.first);
+    }
+  }
+  if (num_complete == 0) {
+    return Status::OK();
+  }
+
+  auto include = [this](const RowTuple& groups_rt) { return WindowComplete(groups_rt); };
+  RowBatch output_rb(*output_descriptor_, num_complete);
+  PX_RETURN_IF_ERROR(ConvertAggHashMapToRowBatch(exec_state, &output_rb, include));
+  PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+
+  for (auto& partition : partitions_) {
+    auto& agg_hash_map = partition->agg_hash_map;
+    for (auto it = agg_hash_map.begin(); it != agg_hash_map.end();) {
+      if (WindowComplete(*it->first)) {
+        agg_hash_map.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+  }
+  int64_t dropped_bytes = static_cast<int64_t>(num_complete) * group_bytes_estimate_;
+  exec_state->memory_budget()->Release(dropped_bytes);
+  groups_bytes_ -= dropped_bytes;
+  dropped_groups_ += num_complete;
+  if (dropped_groups_ > NumGroups()) {
+    CompactGroups();
+  }
+  return Status::OK();
+}
+
+void AggNode::CompactGroups() {
+  // The open group keys share group_args_pool_ with the scratch row tuples, so all of them are
+  // released and the scratch tuples are recreated by the next row batch.
+  std::vector<std::unique_ptr<RowTuple>> keys;
+  for (auto& partition : partitions_) {
+    std::vector<std::unique_ptr<AggHashValue>> values;
+    for (const auto& [groups_rt, val] : partition->agg_hash_map) {
+      uint64_t hash = groups_rt->Hash();
+      auto key = std::make_unique<RowTuple>(&group_data_types_);
+      key->fixed_values.swap(groups_rt->fixed_values);
+      key->variable_values.swap(groups_rt->variable_values);
+      key->SetHash(hash);
+      keys.push_back(std::move(key));
+      values.push_back(std::make_unique<AggHashValue>(std::move(*val)));
+    }
+    partition->agg_hash_map.clear();
+    partition->udas_pool.Clear();
+    for (size_t i = 0; i < values.size(); ++i) {
+      partition->agg_hash_map[keys[keys.size() - values.size() + i].get()] =
+          partition->udas_pool.Add(values[i].release());
+    }
+  }
+  group_args_chunk_.clear();
+  group_args_pool_.Clear();
+  for (auto& key : keys) {
+    group_args_pool_.Add(key.release());
+  }
+  dropped_groups_ = 0;
+}
+
+Status AggNode::AggregateRowBatch(ExecState* exec_state, const RowBatch& rb) {
   // Extracts the row tuples (column wise).
   // TODO(zasgar): PL-455 - Chunk this so we don't create a crazy number of row tuples if the batch
   // is large. The process is as follows:
@@ -387,21 +626,75 @@ Status AggNode::AggregateGroupByClause(ExecState* exec_state, const RowBatch& rb
   // 2. Hash row batch and update agg values.
   // 3. If the agg values are large then run aggregate and compact.
   // 4. Reset state to prepare for next row batch.
-  // 5. If it's the last batch then emit the values.
   PX_RETURN_IF_ERROR(ExtractRowTupleForBatch(rb));
-  PX_RETURN_IF_ERROR(HashRowBatch(exec_state, rb));
-  if (plan_node_->partial_agg() && plan_node_->values().size() > 0) {
-    PX_RETURN_IF_ERROR(EvaluatePartialAggregates(exec_state, rb.num_rows()));
+  PartitionRowBatch(rb.num_rows());
+  if (!spill_row_idxs_.empty()) {
+    PX_RETURN_IF_ERROR(SpillRows(rb));
+  }
+  size_t num_groups_before = NumGroups();
+  PX_RETURN_IF_ERROR(ForEachPartition([&](AggPartition* partition) {
+    PX_RETURN_IF_ERROR(HashRowBatch(exec_state, rb, partition));
+    if (plan_node_->partial_agg() && plan_node_->values().size() > 0) {
+      PX_RETURN_IF_ERROR(EvaluatePartialAggregates(exec_state, partition));
+    }
+    return Status::OK();
+  }));
+  int64_t new_groups_bytes = (NumGroups() - num_groups_before) * group_bytes_estimate_;
+  groups_bytes_ += new_groups_bytes;
+  exec_state->memory_budget()->Consume(new_groups_bytes);
+  return ResetGroupArgs();
+}
+
+Status AggNode::SpillRows(const RowBatch& rb) {
+  PX_ASSIGN_OR_RETURN(auto spilled_rb, TakeRows(rb, spill_row_idxs_));
+  std::vector<uint64_t> hashes;
+  hashes.reserve(spill_row_idxs_.size());
+  for (int64_t row_idx : spill_row_idxs_) {
+    hashes.push_back(group_hashes_[row_idx]);
   }
-  PX_RETURN_IF_ERROR(ResetGroupArgs());
-  if (ReadyToEmitBatches(rb)) {
-    RowBatch output_rb(*output_descriptor_, agg_hash_map_.size());
-    PX_RETURN_IF_ERROR(ConvertAggHashMapToRowBatch(exec_state, &output_rb));
-    output_rb.set_eow(rb.eow());
-    output_rb.set_eos(rb.eos());
-    PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
-    PX_RETURN_IF_ERROR(ClearAggState(exec_state));
+  return spill_->Append(*spilled_rb, hashes);
+}
+
+Status AggNode::EmitInMemoryGroups(ExecState* exec_state, bool eow, bool eos) {
+  RowBatch output_rb(*output_descriptor_, NumGroups());
+  PX_RETURN_IF_ERROR(ConvertAggHashMapToRowBatch(exec_state, &output_rb));
+  output_rb.set_eow(eow);
+  output_rb.set_eos(eos);
+  PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+  return ClearAggState(exec_state);
+}
+
+Status AggNode::EmitGroups(ExecState* exec_state, bool eow, bool eos) {
+  if (spill_ == nullptr || spill_->empty()) {
+    spilling_ = false;
+    return EmitInMemoryGroups(exec_state, eow, eos);
   }
+
+  std::vector<size_t> spilled_partitions;
+  for (size_t i = 0; i < spill_->num_partitions(); ++i) {
+    if (spill_->partition(i) != nullptr) {
+      spilled_partitions.push_back(i);
+    }
+  }
+  PX_RETURN_IF_ERROR(EmitInMemoryGroups(exec_state, false, false));
+
+  // None of the spilled groups are in memory, so each partition is aggregated from scratch
+  // (without spilling again) and emitted. The last one carries the window and stream markers.
+  spilling_ = false;
+  for (const auto& [i, partition] : Enumerate(spilled_partitions)) {
+    auto spill_file = spill_->partition(partition);
+    PX_RETURN_IF_ERROR(spill_file->Rewind());
+    while (true) {
+      PX_ASSIGN_OR_RETURN(auto rb, spill_file->ReadNext());
+      if (rb == nullptr) {
+        break;
+      }
+      PX_RETURN_IF_ERROR(AggregateRowBatch(exec_state, *rb));
+    }
+    bool last = i == spilled_partitions.size() - 1;
+    PX_RETURN_IF_ERROR(EmitInMemoryGroups(exec_state, last && eow, last && eos));
+  }
+  spill_->Clear();
   return Status::OK();
 }
 
@@ -480,7 +773,7 @@ Status AggNode::EvaluateAggHashValue(ExecState* exec_state, AggHashValue* val) {
                         const std::vector<StatusOr<types::SharedColumnWrapper>>& children)
                         -> types::SharedColumnWrapper {
       DCHECK_EQ(children.size(), 0ULL);
-      return val->agg_cols[plan_cols_to_stored_map_[col.Index()]];
+      return val->agg_cols[plan_cols_to_stored_map_.at(col.Index())];
     });
 
     walker.OnAggregateExpression(
@@ -549,8 +842,8 @@ Status AggNode::CreateColumnMapping() {
   return Status::OK();
 }
 
-AggHashValue* AggNode::CreateAggHashValue(ExecState* exec_state) {
-  auto* val = udas_pool_.Add(new AggHashValue);
+AggHashValue* AggNode::CreateAggHashValue(ExecState* exec_state, AggPartition* partition) {
+  auto* val = partition->udas_pool.Add(new AggHashValue);
   PX_CHECK_OK(CreateUDAInfoValues(&(val->udas), exec_state));
   for (const auto& dt : stored_cols_data_types_) {
     val->agg_cols.emplace_back(types::ColumnWrapper::Make(dt, 0));
@@ -584,27 +877,29 @@ Status AggNode::CreateUDAInfoValues(std::vector<UDAInfo>* val, ExecState* exec_s
 
 Status AggNode::DeserializeAndMergeNoGroups(const RowBatch& rb) {
   for (int64_t row_idx = 0; row_idx < rb.num_rows(); row_idx++) {
-    PX_RETURN_IF_ERROR(DeserializeAndMergeRow(&udas_no_groups_, rb, row_idx, 0));
+    PX_RETURN_IF_ERROR(
+        DeserializeAndMergeRow(&udas_for_deserialize_, &udas_no_groups_, rb, row_idx, 0));
   }
   return Status::OK();
 }
 
-Status AggNode::DeserializeAndMergeGrouped(const std::vector<GroupArgs>& group_args,
-                                           const RowBatch& rb) {
+Status AggNode::DeserializeAndMergeGrouped(AggPartition* partition, const RowBatch& rb) {
   auto groups_size = static_cast<int64_t>(plan_node_->groups().size());
-  for (int64_t row_idx = 0; row_idx < rb.num_rows(); row_idx++) {
-    DCHECK(group_args[row_idx].av != nullptr);
-    PX_RETURN_IF_ERROR(
-        DeserializeAndMergeRow(&group_args[row_idx].av->udas, rb, row_idx, groups_size));
+  for (int64_t row_idx : partition->row_idxs) {
+    DCHECK(group_args_chunk_[row_idx].av != nullptr);
+    PX_RETURN_IF_ERROR(DeserializeAndMergeRow(&partition->udas_for_deserialize,
+                                              &group_args_chunk_[row_idx].av->udas, rb, row_idx,
+                                              groups_size));
   }
 
   return Status::OK();
 }
 
-Status AggNode::DeserializeAndMergeRow(std::vector<UDAInfo>* udas, const RowBatch& rb,
+Status AggNode::DeserializeAndMergeRow(std::vector<UDAInfo>* udas_for_deserialize,
+                                       std::vector<UDAInfo>* udas, const RowBatch& rb,
                                        int64_t row_idx, int64_t groups_size) {
   for (size_t uda_idx = 0; uda_idx < udas->size(); ++uda_idx) {
-    auto& deserial_uda_info = udas_for_deserialize_[uda_idx];
+    auto& deserial_uda_info = (*udas_for_deserialize)[uda_idx];
     auto& merge_uda_info = (*udas)[uda_idx];
     int64_t col_idx = groups_size + static_cast<int64_t>(uda_idx);
     DCHECK_EQ(types::STRING, rb.desc().type(col_idx));
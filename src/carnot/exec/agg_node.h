@@ -18,6 +18,7 @@
 
 #pragma once
 #include <cstddef>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -28,6 +29,7 @@
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/expression_evaluator.h"
 #include "src/carnot/exec/row_tuple.h"
+#include "src/carnot/exec/spill_file.h"
 #include "src/carnot/plan/operators.h"
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/udf/base.h"
@@ -41,6 +43,8 @@
 #include "src/table_store/schema/row_batch.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_int32(carnot_agg_num_threads);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -66,11 +70,31 @@ struct GroupArgs {
   AggHashValue* av;
 };
 
+using AggHashMap = AbslRowTupleHashMap<AggHashValue*>;
+
+/**
+ * The groups of an aggregate are radix-partitioned on the hash of their group key. Since no key
+ * is shared between partitions, each partition can be updated and evaluated by its own thread.
+ */
+struct AggPartition {
+  AggHashMap agg_hash_map;
+  // Owns the AggHashValues of this partition.
+  ObjectPool udas_pool{"agg_partition_udas_pool"};
+  // Scratch UDAs used to deserialize partial aggregates before they are merged in.
+  std::vector<UDAInfo> udas_for_deserialize;
+  // Indices of the rows of the current row batch that belong to this partition.
+  std::vector<int64_t> row_idxs;
+};
+
 class AggNode : public ProcessingNode {
-  using AggHashMap = AbslRowTupleHashMap<AggHashValue*>;
 
  public:
   AggNode() = default;
+  /**
+   * Creates an AggNode that uses the given number of partitions for its group by hash table,
+   * instead of deriving it from --carnot_agg_num_threads.
+   */
+  explicit AggNode(size_t num_partitions) : num_partitions_(num_partitions) {}
   virtual ~AggNode() = default;
 
  protected:
@@ -86,7 +110,6 @@ class AggNode : public ProcessingNode {
                          size_t parent_index) override;
 
  private:
-  AggHashMap agg_hash_map_;
   bool HasNoGroups() const { return plan_node_->groups().empty(); }
   // ReadyToEmitBatches returns true when the input stream has reached a point where output batches
   // can be emitted. In the windowed aggregate case, this happens whenever end of window (eow) is
@@ -103,9 +126,10 @@ class AggNode : public ProcessingNode {
 
   Status DeserializeAndMergeNoGroups(const RowBatch& rb);
 
-  Status DeserializeAndMergeGrouped(const std::vector<GroupArgs>& group_args, const RowBatch& rb);
+  Status DeserializeAndMergeGrouped(AggPartition* partition, const RowBatch& rb);
 
-  Status DeserializeAndMergeRow(std::vector<UDAInfo>* udas, const RowBatch& rb, int64_t row_idx,
+  Status DeserializeAndMergeRow(std::vector<UDAInfo>* udas_for_deserialize,
+                                std::vector<UDAInfo>* udas, const RowBatch& rb, int64_t row_idx,
                                 int64_t groups_size);
 
   // Store information about aggregate node from the query planner.
@@ -134,7 +158,12 @@ class AggNode : public ProcessingNode {
   std::vector<types::DataType> stored_cols_data_types_;
 
   ObjectPool group_args_pool_{"group_args_pool"};
-  ObjectPool udas_pool_{"udas_pool"};
+
+  // The number of partitions of the group by hash table. Partitions are processed concurrently on
+  // the shared agg thread pool when there is more than one. Zero means it is derived from
+  // --carnot_agg_num_threads.
+  size_t num_partitions_ = 0;
+  std::vector<std::unique_ptr<AggPartition>> partitions_;
 
   std::vector<types::DataType> group_data_types_;
   std::vector<types::DataType> value_data_types_;
@@ -143,19 +172,64 @@ class AggNode : public ProcessingNode {
   // This vector holds pointers to the row_tuples which are managed by the group_args_pool_.
 
   std::vector<GroupArgs> group_args_chunk_;
+  // The group columns of the current row batch and their per row hashes.
+  std::vector<const arrow::Array*> group_cols_;
+  std::vector<uint64_t> group_hashes_;
   // END: Variables specific to GroupBy Agg.
 
+  // Once the query is over its memory budget, the aggregate stops creating groups in memory. The
+  // rows of the groups that are not in memory yet are spilled to hash partitions on disk, and each
+  // partition is aggregated and emitted on its own after the in-memory groups.
+  bool spilling_ = false;
+  std::unique_ptr<SpillPartitions> spill_;
+  // The rows of the current row batch that are spilled.
+  std::vector<int64_t> spill_row_idxs_;
+  // The approximate memory held by a group, and by all of the groups as accounted against the
+  // query memory budget.
+  int64_t group_bytes_estimate_ = 0;
+  int64_t groups_bytes_ = 0;
+
+  // Variables specific to time windowed aggregates. The watermark is the latest window start that
+  // has been seen, every window that ends at or before it is complete.
+  bool has_watermark_ = false;
+  int64_t watermark_ = 0;
+  // The number of groups dropped since the group storage was last compacted.
+  size_t dropped_groups_ = 0;
+
   // Creates a mapping between plan cols and stored cols (see above comment).
   Status CreateColumnMapping();
 
   Status ExtractRowTupleForBatch(const table_store::schema::RowBatch& rb);
-  Status HashRowBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
-  Status EvaluatePartialAggregates(ExecState* exec_state, size_t num_records);
+  // Assigns each row of the current row batch to the partition of its group key. While spilling,
+  // the rows of groups that are not in memory go to spill_row_idxs_ instead.
+  void PartitionRowBatch(int64_t num_rows);
+  // Updates the groups with the row batch.
+  Status AggregateRowBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  Status SpillRows(const table_store::schema::RowBatch& rb);
+  // Emits all of the groups, including the spilled ones, and clears the aggregate state.
+  Status EmitGroups(ExecState* exec_state, bool eow, bool eos);
+  Status EmitInMemoryGroups(ExecState* exec_state, bool eow, bool eos);
+  // Advances the watermark past the window starts of the row batch, then emits and drops the
+  // groups of the windows that are now complete.
+  Status EmitCompleteWindows(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  bool WindowComplete(const RowTuple& groups_rt) const;
+  // The groups that were dropped still hold their memory in the object pools, so once they
+  // outnumber the open groups, the open groups are moved to fresh storage and the pools released.
+  void CompactGroups();
+  // Runs fn on every partition, in parallel if there is more than one partition.
+  Status ForEachPartition(const std::function<Status(AggPartition*)>& fn);
+  size_t NumGroups() const;
+  Status HashRowBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                      AggPartition* partition);
+  Status EvaluatePartialAggregates(ExecState* exec_state, AggPartition* partition);
   Status ResetGroupArgs();
-  Status ConvertAggHashMapToRowBatch(ExecState* exec_state,
-                                     table_store::schema::RowBatch* output_rb);
+  // Converts the groups to the output row batch. If include is set, only the groups it returns
+  // true for are converted.
+  Status ConvertAggHashMapToRowBatch(
+      ExecState* exec_state, table_store::schema::RowBatch* output_rb,
+      const std::function<bool(const RowTuple&)>& include = nullptr);
 
-  AggHashValue* CreateAggHashValue(ExecState* exec_state);
+  AggHashValue* CreateAggHashValue(ExecState* exec_state, AggPartition* partition);
   RowTuple* CreateGroupArgsRowTuple() {
     return group_args_pool_.Add(new RowTuple(&group_data_types_));
   }
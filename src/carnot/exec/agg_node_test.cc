@@ -472,6 +472,41 @@ agg_op {
   finalize_results: true
 })";
 
+constexpr char kTimeWindowedMultipleGroupAgg[] = R"(
+op_type: AGGREGATE_OPERATOR
+agg_op {
+  values {
+    name: "minsum"
+    args {
+      column {
+        node:0
+        index: 2
+      }
+    }
+    args {
+      column {
+        node:0
+        index: 2
+      }
+    }
+  }
+  groups {
+     node: 0
+     index: 0
+  }
+  groups {
+     node: 0
+     index: 1
+  }
+  group_names: "window"
+  group_names: "g1"
+  value_names: "value1"
+  partial_agg: true
+  finalize_results: true
+  time_window_size_ns: 10
+  time_window_group: 0
+})";
+
 std::unique_ptr<ExecState> MakeTestExecState(udf::Registry* registry) {
   auto table_store = std::make_shared<table_store::TableStore>();
   return std::make_unique<ExecState>(registry, table_store, MockResultSinkStubGenerator,
@@ -732,6 +767,58 @@ TEST_F(AggNodeTest, single_group_windowed) {
       .Close();
 }
 
+TEST_F(AggNodeTest, multiple_groups_time_windowed) {
+  auto plan_node = PlanNodeFromPbtxt(kTimeWindowedMultipleGroupAgg);
+  RowDescriptor input_rd({types::DataType::TIME64NS, types::DataType::INT64,
+                          types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::TIME64NS, types::DataType::INT64,
+                           types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  // Each window is emitted once a row of a later window is seen, and the last window at eos.
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Time64NSValue>({0, 0, 0, 10})
+                       .AddColumn<types::Int64Value>({1, 2, 1, 1})
+                       .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, false, false)
+                          .AddColumn<types::Time64NSValue>({0, 0})
+                          .AddColumn<types::Int64Value>({1, 2})
+                          .AddColumn<types::Int64Value>({4, 2})
+                          .get(),
+                      false)
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, false, false)
+                       .AddColumn<types::Time64NSValue>({10, 20})
+                       .AddColumn<types::Int64Value>({1, 1})
+                       .AddColumn<types::Int64Value>({5, 6})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, false, false)
+                          .AddColumn<types::Time64NSValue>({10})
+                          .AddColumn<types::Int64Value>({1})
+                          .AddColumn<types::Int64Value>({9})
+                          .get(),
+                      false)
+      .ConsumeNext(RowBatchBuilder(input_rd, 1, true, true)
+                       .AddColumn<types::Time64NSValue>({20})
+                       .AddColumn<types::Int64Value>({2})
+                       .AddColumn<types::Int64Value>({7})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, true)
+                          .AddColumn<types::Time64NSValue>({20, 20})
+                          .AddColumn<types::Int64Value>({1, 2})
+                          .AddColumn<types::Int64Value>({6, 7})
+                          .get(),
+                      false)
+      .Close();
+}
+
 TEST_F(AggNodeTest, no_aggregate_expressions) {
   auto plan_node = PlanNodeFromPbtxt(kSingleGroupNoValues);
   RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
@@ -982,6 +1069,115 @@ TEST_F(AggNodeTest, multiple_groups_partial_finalize) {
       .Close();
 }
 
+TEST_F(AggNodeTest, multiple_groups_blocking_partitioned) {
+  FLAGS_carnot_agg_num_threads = 4;
+  auto plan_node = PlanNodeFromPbtxt(kBlockingMultipleGroupAgg);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get(), /*num_partitions*/ 8);
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 5, 1, 2})
+                       .AddColumn<types::Int64Value>({2, 1, 3, 1})
+                       .AddColumn<types::Int64Value>({2, 5, 3, 1})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, true, true)
+                       .AddColumn<types::Int64Value>({5, 1, 3, 3})
+                       .AddColumn<types::Int64Value>({1, 2, 3, 3})
+                       .AddColumn<types::Int64Value>({1, 3, 3, 8})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 5, true, true)
+                          .AddColumn<types::Int64Value>({1, 1, 2, 5, 3})
+                          .AddColumn<types::Int64Value>({2, 3, 1, 1, 3})
+                          .AddColumn<types::Int64Value>({4, 3, 1, 2, 6})
+                          .get(),
+                      false)
+      .Close();
+}
+
+TEST_F(AggNodeTest, multiple_groups_partial_finalize_partitioned) {
+  FLAGS_carnot_agg_num_threads = 4;
+  auto plan_node = PlanNodeFromPbtxt(kPartialMultipleGroupAggFinalize);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get(), /*num_partitions*/ 8);
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 5, 1, 2})
+                       .AddColumn<types::Int64Value>({2, 1, 3, 1})
+                       .AddColumn<types::StringValue>({"2", "5", "3", "1"})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, true, true)
+                       .AddColumn<types::Int64Value>({5, 1, 3, 3})
+                       .AddColumn<types::Int64Value>({1, 2, 3, 3})
+                       .AddColumn<types::StringValue>({"1", "3", "3", "8"})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 5, true, true)
+                          .AddColumn<types::Int64Value>({1, 1, 2, 5, 3})
+                          .AddColumn<types::Int64Value>({2, 3, 1, 1, 3})
+                          .AddColumn<types::Int64Value>({5, 3, 1, 6, 11})
+                          .get(),
+                      false)
+      .Close();
+}
+
+TEST_F(AggNodeTest, multiple_groups_blocking_spilled) {
+  PX_SET_FOR_SCOPE(FLAGS_carnot_exec_query_memory_budget_bytes, 1);
+  PX_SET_FOR_SCOPE(FLAGS_carnot_exec_spill_partitions, 1);
+  auto exec_state = MakeTestExecState(func_registry_.get());
+  EXPECT_OK(exec_state->AddUDA(0, "minsum",
+                               std::vector<types::DataType>({types::INT64, types::INT64})));
+
+  auto plan_node = PlanNodeFromPbtxt(kBlockingMultipleGroupAgg);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state.get());
+
+  // The first batch puts the query over its budget, so the new group of the second batch is
+  // spilled and emitted after the groups that are in memory.
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 5, 1, 2})
+                       .AddColumn<types::Int64Value>({2, 1, 3, 1})
+                       .AddColumn<types::Int64Value>({2, 5, 3, 1})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, true, true)
+                       .AddColumn<types::Int64Value>({5, 1, 3, 3})
+                       .AddColumn<types::Int64Value>({1, 2, 3, 3})
+                       .AddColumn<types::Int64Value>({1, 3, 3, 8})
+                       .get(),
+                   0, 2)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 4, false, false)
+                          .AddColumn<types::Int64Value>({1, 1, 2, 5})
+                          .AddColumn<types::Int64Value>({2, 3, 1, 1})
+                          .AddColumn<types::Int64Value>({4, 3, 1, 2})
+                          .get(),
+                      false)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, true)
+                          .AddColumn<types::Int64Value>({3})
+                          .AddColumn<types::Int64Value>({3})
+                          .AddColumn<types::Int64Value>({6})
+                          .get(),
+                      false)
+      .Close();
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -0,0 +1,313 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/as_of_join_node.h"
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/carnot/udf/udf_wrapper.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using types::DataType;
+
+namespace {
+
+template <DataType DT>
+Status AppendFromArray(arrow::ArrayBuilder* builder, const arrow::Array* col, int64_t row) {
+  return table_store::schema::CopyValue<DT>(builder, types::GetValueFromArrowArray<DT>(col, row));
+}
+
+template <DataType DT>
+Status AppendFromTuple(arrow::ArrayBuilder* builder, const RowTuple* rt, size_t idx) {
+  using ValueType = typename types::DataTypeTraits<DT>::value_type;
+  return table_store::schema::CopyValue<DT>(builder, udf::UnWrap(rt->GetValue<ValueType>(idx)));
+}
+
+template <DataType DT>
+Status AppendDefault(arrow::ArrayBuilder* builder) {
+  using ValueType = typename types::DataTypeTraits<DT>::value_type;
+  ValueType zeroval;
+  return table_store::schema::CopyValue<DT>(builder, udf::UnWrap(zeroval));
+}
+
+}  // namespace
+
+std::string AsOfJoinNode::DebugStringImpl() {
+  return absl::Substitute("Exec::AsOfJoinNode<$0>", plan_node_->DebugString());
+}
+
+Status AsOfJoinNode::InitImpl(const plan::Operator& plan_node) {
+  CHECK(plan_node.op_type() == planpb::OperatorType::AS_OF_JOIN_OPERATOR);
+  if (input_descriptors_.size() != 2) {
+    return error::InvalidArgument("AsOfJoin operator expects two input relations, got $0",
+                                  input_descriptors_.size());
+  }
+  const auto* join_plan_node = static_cast<const plan::AsOfJoinOperator*>(&plan_node);
+  plan_node_ = std::make_unique<plan::AsOfJoinOperator>(*join_plan_node);
+  output_rows_per_batch_ = plan_node_->rows_per_batch() == 0 ? kDefaultAsOfJoinRowBatchSize
+                                                             : plan_node_->rows_per_batch();
+
+  time_col_indices_[kLeft] = plan_node_->left_time_column_index();
+  time_col_indices_[kRight] = plan_node_->right_time_column_index();
+  for (size_t parent_index : {kLeft, kRight}) {
+    if (input_descriptors_[parent_index].type(time_col_indices_[parent_index]) !=
+        DataType::TIME64NS) {
+      return error::InvalidArgument("AsOfJoin time column of input $0 must be TIME64NS",
+                                    parent_index);
+    }
+    used_col_indices_[parent_index].push_back(time_col_indices_[parent_index]);
+  }
+
+  for (const auto& eq_condition : plan_node_->equality_conditions()) {
+    int64_t left_index = eq_condition.left_column_index();
+    int64_t right_index = eq_condition.right_column_index();
+    auto dt = input_descriptors_[kLeft].type(left_index);
+    if (dt != input_descriptors_[kRight].type(right_index)) {
+      return error::InvalidArgument("AsOfJoin key columns $0 and $1 have different types",
+                                    left_index, right_index);
+    }
+    key_data_types_.push_back(dt);
+    key_indices_[kLeft].push_back(left_index);
+    key_indices_[kRight].push_back(right_index);
+    used_col_indices_[kLeft].push_back(left_index);
+    used_col_indices_[kRight].push_back(right_index);
+#define TYPE_CASE(_dt_) key_extract_fns_.push_back(&ExtractIntoRowTuple<_dt_>);
+    PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
+#undef TYPE_CASE
+  }
+
+  auto add_right_value = [this](int64_t input_col_index, DataType dt) {
+    right_value_types_.push_back(dt);
+    right_value_indices_.push_back(input_col_index);
+#define TYPE_CASE(_dt_) right_value_extract_fns_.push_back(&ExtractIntoRowTuple<_dt_>);
+    PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
+#undef TYPE_CASE
+  };
+  for (const auto& output_col : plan_node_->output_columns()) {
+    OutputColumn col;
+    col.parent_index = output_col.parent_index();
+    col.input_col_index = output_col.column_index();
+    col.right_value_idx = right_value_types_.size();
+    auto dt = input_descriptors_[col.parent_index].type(col.input_col_index);
+    if (col.parent_index == kRight) {
+      add_right_value(col.input_col_index, dt);
+    }
+    used_col_indices_[col.parent_index].push_back(col.input_col_index);
+#define TYPE_CASE(_dt_)                               \
+  col.append_from_array = &AppendFromArray<_dt_>;     \
+  col.append_from_tuple = &AppendFromTuple<_dt_>;     \
+  col.append_default = &AppendDefault<_dt_>;
+    PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
+#undef TYPE_CASE
+    output_columns_.push_back(col);
+  }
+  // The time of the latest right row is kept after the output columns, for the tolerance check.
+  add_right_value(time_col_indices_[kRight], DataType::TIME64NS);
+
+  lookup_key_ = std::make_unique<RowTuple>(&key_data_types_);
+  return Status::OK();
+}
+
+Status AsOfJoinNode::InitializeColumnBuilders() {
+  for (size_t i = 0; i < output_descriptor_->size(); ++i) {
+    column_builders_[i] =
+        types::MakeArrowBuilder(output_descriptor_->type(i), arrow::default_memory_pool());
+    PX_RETURN_IF_ERROR(column_builders_[i]->Reserve(output_rows_per_batch_));
+  }
+  return Status::OK();
+}
+
+Status AsOfJoinNode::PrepareImpl(ExecState* /*exec_state*/) {
+  column_builders_.resize(output_descriptor_->size());
+  return InitializeColumnBuilders();
+}
+
+Status AsOfJoinNode::OpenImpl(ExecState* /*exec_state*/) { return Status::OK(); }
+
+Status AsOfJoinNode::CloseImpl(ExecState* /*exec_state*/) {
+  for (auto& input : inputs_) {
+    input.batches.clear();
+  }
+  latest_right_.clear();
+  tuple_pool_.Clear();
+  return Status::OK();
+}
+
+int64_t AsOfJoinNode::TimeAt(size_t parent_index, const InputBatch& batch, int64_t row) const {
+  return types::GetValueFromArrowArray<DataType::TIME64NS>(
+      batch.columns[time_col_indices_[parent_index]].get(), row);
+}
+
+void AsOfJoinNode::ExtractKey(size_t parent_index, const InputBatch& batch, int64_t row) {
+  lookup_key_->Reset();
+  const auto& key_indices = key_indices_[parent_index];
+  for (size_t i = 0; i < key_indices.size(); ++i) {
+    key_extract_fns_[i](lookup_key_.get(), batch.columns[key_indices[i]].get(), i, row);
+  }
+}
+
+void AsOfJoinNode::UpdateLatestRight(const InputBatch& batch, int64_t row) {
+  ExtractKey(kRight, batch, row);
+  RowTuple* values;
+  auto it = latest_right_.find(lookup_key_.get());
+  if (it != latest_right_.end()) {
+    values = it->second;
+    values->Reset();
+  } else {
+    // The lookup key becomes the key of the new entry.
+    RowTuple* key = tuple_pool_.Add(lookup_key_.release());
+    lookup_key_ = std::make_unique<RowTuple>(&key_data_types_);
+    values = tuple_pool_.Add(new RowTuple(&right_value_types_));
+    latest_right_.emplace(key, values);
+  }
+  for (size_t i = 0; i < right_value_indices_.size(); ++i) {
+    right_value_extract_fns_[i](values, batch.columns[right_value_indices_[i]].get(), i, row);
+  }
+}
+
+Status AsOfJoinNode::EmitLeftRow(ExecState* exec_state, const InputBatch& batch, int64_t row,
+                                 int64_t time) {
+  const RowTuple* right_values = nullptr;
+  ExtractKey(kLeft, batch, row);
+  auto it = latest_right_.find(lookup_key_.get());
+  if (it != latest_right_.end()) {
+    int64_t right_time =
+        it->second->GetValue<types::Time64NSValue>(right_value_types_.size() - 1).val;
+    if (plan_node_->tolerance_ns() == 0 || time - right_time <= plan_node_->tolerance_ns()) {
+      right_values = it->second;
+    }
+  }
+  if (right_values == nullptr && plan_node_->type() == planpb::JoinOperator::INNER) {
+    return Status::OK();
+  }
+
+  for (size_t i = 0; i < output_columns_.size(); ++i) {
+    const auto& col = output_columns_[i];
+    auto builder = column_builders_[i].get();
+    if (col.parent_index == kLeft) {
+      PX_RETURN_IF_ERROR(
+          col.append_from_array(builder, batch.columns[col.input_col_index].get(), row));
+    } else if (right_values != nullptr) {
+      PX_RETURN_IF_ERROR(col.append_from_tuple(builder, right_values, col.right_value_idx));
+    } else {
+      PX_RETURN_IF_ERROR(col.append_default(builder));
+    }
+  }
+  if (++queued_rows_ == output_rows_per_batch_) {
+    return NextOutputBatch(exec_state, /*eos*/ false);
+  }
+  return Status::OK();
+}
+
+Status AsOfJoinNode::MergeInputs(ExecState* exec_state) {
+  auto& left = inputs_[kLeft];
+  auto& right = inputs_[kRight];
+  while (!left.empty()) {
+    const InputBatch& left_batch = left.front();
+    int64_t left_row = left.next_row;
+    int64_t left_time = TimeAt(kLeft, left_batch, left_row);
+    // Fold in the right rows at or before the left row's time. Until the right input is past that
+    // time, a right row with the same time may still arrive.
+    bool right_past_left = right.eos;
+    while (!right.empty()) {
+      if (TimeAt(kRight, right.front(), right.next_row) > left_time) {
+        right_past_left = true;
+        break;
+      }
+      UpdateLatestRight(right.front(), right.next_row);
+      right.Advance();
+    }
+    if (!right_past_left) {
+      return Status::OK();
+    }
+    PX_RETURN_IF_ERROR(EmitLeftRow(exec_state, left_batch, left_row, left_time));
+    left.Advance();
+  }
+
+  // All of the later left rows are at or after the last left time, so the right rows up to it can
+  // be folded in already rather than buffered.
+  while (!right.empty() && TimeAt(kRight, right.front(), right.next_row) <= left.last_time) {
+    UpdateLatestRight(right.front(), right.next_row);
+    right.Advance();
+  }
+  return Status::OK();
+}
+
+Status AsOfJoinNode::NextOutputBatch(ExecState* exec_state, bool eos) {
+  PX_ASSIGN_OR_RETURN(auto output_rb, RowBatch::FromColumnBuilders(*output_descriptor_, eos, eos,
+                                                                   &column_builders_));
+  queued_rows_ = 0;
+  PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, *output_rb));
+  return InitializeColumnBuilders();
+}
+
+Status AsOfJoinNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb,
+                                     size_t parent_index) {
+  // Once the left input is done, the rest of the right input isn't needed.
+  if (sent_eos_) {
+    return Status::OK();
+  }
+
+  auto& input = inputs_[parent_index];
+  auto time_col = rb.ColumnAt(time_col_indices_[parent_index]);
+  for (int64_t row = 0; row < rb.num_rows(); ++row) {
+    auto time = types::GetValueFromArrowArray<DataType::TIME64NS>(time_col.get(), row);
+    if (time < input.last_time) {
+      return error::InvalidArgument(
+          "AsOfJoin input $0 must be ordered by time, got time $1 after time $2", parent_index,
+          time, input.last_time);
+    }
+    input.last_time = time;
+  }
+  if (rb.num_rows() > 0) {
+    InputBatch batch{std::vector<std::shared_ptr<arrow::Array>>(rb.num_columns()), rb.num_rows()};
+    for (auto col_idx : used_col_indices_[parent_index]) {
+      if (batch.columns[col_idx] == nullptr) {
+        batch.columns[col_idx] = rb.ColumnAt(col_idx);
+      }
+    }
+    input.batches.push_back(std::move(batch));
+  }
+  input.eos = rb.eos();
+
+  PX_RETURN_IF_ERROR(MergeInputs(exec_state));
+  if (inputs_[kLeft].eos && inputs_[kLeft].empty()) {
+    inputs_[kRight].batches.clear();
+    return NextOutputBatch(exec_state, /*eos*/ true);
+  }
+  return Status::OK();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <arrow/array/builder_base.h>
+
+#include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/row_tuple.h"
+#include "src/carnot/plan/operators.h"
+#include "src/common/base/base.h"
+#include "src/common/base/status.h"
+#include "src/common/memory/memory.h"
+#include "src/table_store/table_store.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+constexpr int64_t kDefaultAsOfJoinRowBatchSize = 1024;
+
+/**
+ * AsOfJoinNode joins each left row with the latest right row that has equal keys and a time at or
+ * before the left row's time.
+ *
+ * Both inputs are ordered by time, as table cursors produce them, so the join merges the two
+ * streams: right rows are folded into a map holding the latest right row of each key until the
+ * right input passes the time of the next left row, which is then joined against the map. The
+ * state is one row per key plus the input that arrived ahead of the other input, rather than
+ * the hash tables over the whole build input that the EquijoinNode needs.
+ */
+class AsOfJoinNode : public ProcessingNode {
+ public:
+  AsOfJoinNode() = default;
+  virtual ~AsOfJoinNode() = default;
+
+ protected:
+  std::string DebugStringImpl() override;
+  Status InitImpl(const plan::Operator& plan_node) override;
+  Status PrepareImpl(ExecState* exec_state) override;
+  Status OpenImpl(ExecState* exec_state) override;
+  Status CloseImpl(ExecState* exec_state) override;
+  Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                         size_t parent_index) override;
+
+ private:
+  static constexpr size_t kLeft = 0;
+  static constexpr size_t kRight = 1;
+
+  using ExtractFn = void (*)(RowTuple*, arrow::Array*, int, int);
+  using AppendFromArrayFn = Status (*)(arrow::ArrayBuilder*, const arrow::Array*, int64_t);
+  using AppendFromTupleFn = Status (*)(arrow::ArrayBuilder*, const RowTuple*, size_t);
+  using AppendDefaultFn = Status (*)(arrow::ArrayBuilder*);
+
+  struct OutputColumn {
+    size_t parent_index;
+    int64_t input_col_index;
+    // For right columns, the index of the column in the latest right row tuples.
+    size_t right_value_idx;
+    AppendFromArrayFn append_from_array;
+    AppendFromTupleFn append_from_tuple;
+    AppendDefaultFn append_default;
+  };
+
+  // The columns of an input batch that the join reads, the others are left unset.
+  struct InputBatch {
+    std::vector<std::shared_ptr<arrow::Array>> columns;
+    int64_t num_rows;
+  };
+
+  // An input's batches that haven't been fully merged yet, and the next row to merge.
+  struct InputQueue {
+    std::deque<InputBatch> batches;
+    int64_t next_row = 0;
+    // The time of the last row received, every later row is at or after it.
+    int64_t last_time = std::numeric_limits<int64_t>::min();
+    bool eos = false;
+
+    bool empty() const { return batches.empty(); }
+    const InputBatch& front() const { return batches.front(); }
+    void Advance() {
+      if (++next_row == batches.front().num_rows) {
+        batches.pop_front();
+        next_row = 0;
+      }
+    }
+  };
+
+  int64_t TimeAt(size_t parent_index, const InputBatch& batch, int64_t row) const;
+  void ExtractKey(size_t parent_index, const InputBatch& batch, int64_t row);
+  void UpdateLatestRight(const InputBatch& batch, int64_t row);
+  Status EmitLeftRow(ExecState* exec_state, const InputBatch& batch, int64_t row, int64_t time);
+  Status MergeInputs(ExecState* exec_state);
+  Status InitializeColumnBuilders();
+  Status NextOutputBatch(ExecState* exec_state, bool eos);
+
+  std::unique_ptr<plan::AsOfJoinOperator> plan_node_;
+  int64_t output_rows_per_batch_;
+
+  std::vector<types::DataType> key_data_types_;
+  std::vector<int64_t> key_indices_[2];
+  std::vector<ExtractFn> key_extract_fns_;
+  int64_t time_col_indices_[2];
+  // The right columns that are output, followed by the right time column.
+  std::vector<types::DataType> right_value_types_;
+  std::vector<int64_t> right_value_indices_;
+  std::vector<ExtractFn> right_value_extract_fns_;
+  std::vector<OutputColumn> output_columns_;
+  // The columns of each input that the join reads.
+  std::vector<int64_t> used_col_indices_[2];
+
+  InputQueue inputs_[2];
+  // The key of the last extracted row.
+  std::unique_ptr<RowTuple> lookup_key_;
+  // The latest right row of each key.
+  AbslRowTupleHashMap<RowTuple*> latest_right_;
+  ObjectPool tuple_pool_{"as_of_join_tuple_pool"};
+
+  std::vector<std::unique_ptr<arrow::ArrayBuilder>> column_builders_;
+  int64_t queued_rows_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
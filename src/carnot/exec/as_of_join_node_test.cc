@@ -0,0 +1,227 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/as_of_join_node.h"
+
+#include <absl/strings/substitute.h>
+#include <gmock/gmock.h>
+#include <google/protobuf/text_format.h>
+#include <gtest/gtest.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/carnot/planpb/test_proto.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowDescriptor;
+using types::DataType;
+
+class AsOfJoinNodeTest : public ::testing::Test {
+ public:
+  AsOfJoinNodeTest() {
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    auto table_store = std::make_shared<table_store::TableStore>();
+    exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
+                                              MockResultSinkStubGenerator, MockMetricsStubGenerator,
+                                              MockTraceStubGenerator, sole::uuid4(), nullptr);
+  }
+
+ protected:
+  std::unique_ptr<plan::Operator> PlanNodeFromPbtxt(const std::string& pbtxt) {
+    planpb::Operator op_pb;
+    EXPECT_TRUE(google::protobuf::TextFormat::MergeFromString(
+        absl::Substitute(planpb::testutils::kOperatorProtoTmpl, "AS_OF_JOIN_OPERATOR",
+                         "as_of_join_op", pbtxt),
+        &op_pb));
+    return plan::AsOfJoinOperator::FromProto(op_pb, 1);
+  }
+
+  std::unique_ptr<ExecState> exec_state_;
+  std::unique_ptr<udf::Registry> func_registry_;
+};
+
+TEST_F(AsOfJoinNodeTest, inner_join_on_key) {
+  // Left input: [time_:Time64Ns, pod:String, latency:Int]
+  // Right input: [time_:Time64Ns, pod:String, cpu:Float]
+  // Output: [time_, pod, latency, cpu], joining each left row with the latest right row of the
+  // same pod at or before it.
+  const char* proto = R"(
+    type: INNER
+    left_time_column_index: 0
+    right_time_column_index: 0
+    equality_conditions {
+      left_column_index: 1
+      right_column_index: 1
+    }
+    output_columns { parent_index: 0 column_index: 0 }
+    output_columns { parent_index: 0 column_index: 1 }
+    output_columns { parent_index: 0 column_index: 2 }
+    output_columns { parent_index: 1 column_index: 2 }
+    column_names: "time_"
+    column_names: "pod"
+    column_names: "latency"
+    column_names: "cpu"
+    rows_per_batch: 3
+  )";
+  auto plan_node = PlanNodeFromPbtxt(proto);
+  RowDescriptor left_rd({DataType::TIME64NS, DataType::STRING, DataType::INT64});
+  RowDescriptor right_rd({DataType::TIME64NS, DataType::STRING, DataType::FLOAT64});
+  RowDescriptor output_rd(
+      {DataType::TIME64NS, DataType::STRING, DataType::INT64, DataType::FLOAT64});
+
+  auto tester = exec::ExecNodeTester<AsOfJoinNode, plan::AsOfJoinOperator>(
+      *plan_node, output_rd, {left_rd, right_rd}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(right_rd, 3, false, false)
+                       .AddColumn<types::Time64NSValue>({10, 20, 30})
+                       .AddColumn<types::StringValue>({"a", "b", "a"})
+                       .AddColumn<types::Float64Value>({1.0, 2.0, 3.0})
+                       .get(),
+                   1, 0)
+      // The first row has no earlier right row of pod a, so it's dropped.
+      .ConsumeNext(RowBatchBuilder(left_rd, 3, false, false)
+                       .AddColumn<types::Time64NSValue>({5, 20, 25})
+                       .AddColumn<types::StringValue>({"a", "b", "a"})
+                       .AddColumn<types::Int64Value>({1, 2, 3})
+                       .get(),
+                   0, 0)
+      // A later right row could still have time 30, so the first row has to wait.
+      .ConsumeNext(RowBatchBuilder(left_rd, 2, true, true)
+                       .AddColumn<types::Time64NSValue>({30, 40})
+                       .AddColumn<types::StringValue>({"a", "b"})
+                       .AddColumn<types::Int64Value>({4, 5})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(right_rd, 2, true, true)
+                       .AddColumn<types::Time64NSValue>({35, 50})
+                       .AddColumn<types::StringValue>({"b", "b"})
+                       .AddColumn<types::Float64Value>({4.0, 5.0})
+                       .get(),
+                   1, 2)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, false, false)
+                          .AddColumn<types::Time64NSValue>({20, 25, 30})
+                          .AddColumn<types::StringValue>({"b", "a", "a"})
+                          .AddColumn<types::Int64Value>({2, 3, 4})
+                          .AddColumn<types::Float64Value>({2.0, 1.0, 3.0})
+                          .get())
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, true)
+                          .AddColumn<types::Time64NSValue>({40})
+                          .AddColumn<types::StringValue>({"b"})
+                          .AddColumn<types::Int64Value>({5})
+                          .AddColumn<types::Float64Value>({4.0})
+                          .get())
+      .Close();
+}
+
+TEST_F(AsOfJoinNodeTest, left_outer_join_with_tolerance) {
+  // Left input: [time_:Time64Ns, latency:Int]
+  // Right input: [time_:Time64Ns, cpu:Float]
+  // Output: [time_, latency, cpu], with cpu defaulted when the latest right row is older than the
+  // tolerance.
+  const char* proto = R"(
+    type: LEFT_OUTER
+    left_time_column_index: 0
+    right_time_column_index: 0
+    tolerance_ns: 10
+    output_columns { parent_index: 0 column_index: 0 }
+    output_columns { parent_index: 0 column_index: 1 }
+    output_columns { parent_index: 1 column_index: 1 }
+    column_names: "time_"
+    column_names: "latency"
+    column_names: "cpu"
+  )";
+  auto plan_node = PlanNodeFromPbtxt(proto);
+  RowDescriptor left_rd({DataType::TIME64NS, DataType::INT64});
+  RowDescriptor right_rd({DataType::TIME64NS, DataType::FLOAT64});
+  RowDescriptor output_rd({DataType::TIME64NS, DataType::INT64, DataType::FLOAT64});
+
+  auto tester = exec::ExecNodeTester<AsOfJoinNode, plan::AsOfJoinOperator>(
+      *plan_node, output_rd, {left_rd, right_rd}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(right_rd, 2, true, true)
+                       .AddColumn<types::Time64NSValue>({10, 30})
+                       .AddColumn<types::Float64Value>({1.0, 3.0})
+                       .get(),
+                   1, 0)
+      .ConsumeNext(RowBatchBuilder(left_rd, 4, true, true)
+                       .AddColumn<types::Time64NSValue>({5, 15, 25, 30})
+                       .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 4, true, true)
+                          .AddColumn<types::Time64NSValue>({5, 15, 25, 30})
+                          .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                          .AddColumn<types::Float64Value>({0.0, 1.0, 0.0, 3.0})
+                          .get())
+      .Close();
+}
+
+TEST_F(AsOfJoinNodeTest, finishes_with_left_input) {
+  const char* proto = R"(
+    type: INNER
+    left_time_column_index: 0
+    right_time_column_index: 0
+    output_columns { parent_index: 0 column_index: 0 }
+    output_columns { parent_index: 1 column_index: 1 }
+    column_names: "time_"
+    column_names: "cpu"
+  )";
+  auto plan_node = PlanNodeFromPbtxt(proto);
+  RowDescriptor left_rd({DataType::TIME64NS});
+  RowDescriptor right_rd({DataType::TIME64NS, DataType::FLOAT64});
+  RowDescriptor output_rd({DataType::TIME64NS, DataType::FLOAT64});
+
+  auto tester = exec::ExecNodeTester<AsOfJoinNode, plan::AsOfJoinOperator>(
+      *plan_node, output_rd, {left_rd, right_rd}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(right_rd, 1, false, false)
+                       .AddColumn<types::Time64NSValue>({5})
+                       .AddColumn<types::Float64Value>({1.0})
+                       .get(),
+                   1, 0)
+      .ConsumeNext(RowBatchBuilder(left_rd, 1, true, true)
+                       .AddColumn<types::Time64NSValue>({10})
+                       .get(),
+                   0, 0)
+      // Once the right input is past the last left row, the join is done.
+      .ConsumeNext(RowBatchBuilder(right_rd, 1, false, false)
+                       .AddColumn<types::Time64NSValue>({20})
+                       .AddColumn<types::Float64Value>({2.0})
+                       .get(),
+                   1, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, true)
+                          .AddColumn<types::Time64NSValue>({10})
+                          .AddColumn<types::Float64Value>({1.0})
+                          .get())
+      .ConsumeNext(RowBatchBuilder(right_rd, 1, true, true)
+                       .AddColumn<types::Time64NSValue>({30})
+                       .AddColumn<types::Float64Value>({3.0})
+                       .get(),
+                   1, 0)
+      .Close();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -133,12 +133,24 @@ Status EquijoinNode::PrepareImpl(ExecState* /*exec_state*/) {
 
 Status EquijoinNode::OpenImpl(ExecState* /*exec_state*/) { return Status::OK(); }
 
-Status EquijoinNode::CloseImpl(ExecState* /*exec_state*/) {
+Status EquijoinNode::CloseImpl(ExecState* exec_state) {
+  ClearBuildState(exec_state);
+  build_spill_.reset();
+  probe_spill_.reset();
+  return Status::OK();
+}
+
+void EquijoinNode::ClearBuildState(ExecState* exec_state) {
   join_keys_chunk_.clear();
+  build_wrappers_chunk_.clear();
+  probe_wrappers_chunk_.clear();
   build_buffer_.clear();
+  build_buffer_rows_.clear();
   probed_keys_.clear();
   key_values_pool_.Clear();
-  return Status::OK();
+  column_values_pool_.Clear();
+  exec_state->memory_budget()->Release(build_bytes_);
+  build_bytes_ = 0;
 }
 
 template <types::DataType DT>
@@ -175,16 +187,24 @@ Status EquijoinNode::ExtractJoinKeysForBatch(const table_store::schema::RowBatch
   const TableSpec& spec = is_probe ? probe_spec_ : build_spec_;
 
   // Scan through all the group args in column order and extract the entire column.
+  key_cols_.clear();
   for (size_t tuple_col_idx = 0; tuple_col_idx < spec.key_indices.size(); ++tuple_col_idx) {
     auto input_col_idx = spec.key_indices[tuple_col_idx];
     auto dt = key_data_types_[tuple_col_idx];
     auto col = rb.ColumnAt(input_col_idx).get();
+    key_cols_.push_back(col);
 
 #define TYPE_CASE(_dt_) ExtractIntoRowTuples<_dt_>(&join_keys_chunk_, col, tuple_col_idx);
     PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
 #undef TYPE_CASE
   }
 
+  // Hash the keys a column at a time, the build and probe lookups then reuse the cached hashes.
+  HashKeyColumns(key_cols_, key_data_types_, &key_hashes_);
+  for (size_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+    join_keys_chunk_[row_idx]->SetHash(key_hashes_[row_idx]);
+  }
+
   return Status::OK();
 }
 
@@ -416,10 +436,21 @@ Status EquijoinNode::ConsumeBuildBatch(ExecState* exec_state,
     build_eos_ = true;
   }
 
-  PX_RETURN_IF_ERROR(ExtractJoinKeysForBatch(rb, false));
-  PX_RETURN_IF_ERROR(HashRowBatch(rb));
+  if (!spilling_ && exec_state->memory_budget()->Exceeded()) {
+    PX_RETURN_IF_ERROR(StartSpilling(exec_state));
+  }
+
+  if (spilling_) {
+    PX_RETURN_IF_ERROR(SpillBatch(rb, false));
+  } else {
+    PX_RETURN_IF_ERROR(ExtractJoinKeysForBatch(rb, false));
+    PX_RETURN_IF_ERROR(HashRowBatch(rb));
+    build_bytes_ += rb.NumBytes();
+    exec_state->memory_budget()->Consume(rb.NumBytes());
+  }
 
   if (build_eos_) {
+    PX_RETURN_IF_ERROR(PublishRuntimeFilter());
     while (probe_batches_.size()) {
       PX_RETURN_IF_ERROR(DoProbe(exec_state, probe_batches_.front()));
       probe_batches_.pop();
@@ -428,8 +459,185 @@ Status EquijoinNode::ConsumeBuildBatch(ExecState* exec_state,
   return Status::OK();
 }
 
+Status EquijoinNode::PublishRuntimeFilter() {
+  // A spilled build side is too large for a filter to be selective, and its keys are on disk.
+  if (runtime_filter_slots_.empty() || spilling_ ||
+      static_cast<int64_t>(build_buffer_rows_.size()) > FLAGS_carnot_join_runtime_filter_max_keys) {
+    return Status::OK();
+  }
+  PX_ASSIGN_OR_RETURN(std::shared_ptr<RuntimeFilter> filter,
+                      RuntimeFilter::Create(build_buffer_rows_.size()));
+  for (const auto& key_and_rows : build_buffer_rows_) {
+    filter->InsertHash(key_and_rows.first->Hash());
+  }
+  for (const auto& slot : runtime_filter_slots_) {
+    slot->Publish(filter);
+  }
+  return Status::OK();
+}
+
+Status EquijoinNode::StartSpilling(ExecState* exec_state) {
+  VLOG(1) << absl::Substitute(
+      "$0 is over the query memory budget ($1 of $2 bytes), spilling to $3", DebugString(),
+      exec_state->memory_budget()->used_bytes(), exec_state->memory_budget()->limit_bytes(),
+      FLAGS_carnot_exec_spill_dir);
+  build_spill_ = std::make_unique<SpillPartitions>(FLAGS_carnot_exec_spill_partitions);
+  probe_spill_ = std::make_unique<SpillPartitions>(FLAGS_carnot_exec_spill_partitions);
+  spilling_ = true;
+
+  PX_RETURN_IF_ERROR(SpillBuildBuffer());
+  ClearBuildState(exec_state);
+  while (probe_batches_.size()) {
+    PX_RETURN_IF_ERROR(SpillBatch(probe_batches_.front(), true));
+    probe_batches_.pop();
+  }
+  return Status::OK();
+}
+
+RowDescriptor SpilledDescriptor(const std::vector<types::DataType>& key_types,
+                                const std::vector<types::DataType>& input_col_types) {
+  std::vector<types::DataType> types = key_types;
+  types.insert(types.end(), input_col_types.begin(), input_col_types.end());
+  return RowDescriptor(types);
+}
+
+Status EquijoinNode::SpillBatch(const RowBatch& rb, bool is_probe) {
+  if (is_probe && rb.eos()) {
+    probe_eos_ = true;
+  }
+  if (rb.num_rows() == 0) {
+    return Status::OK();
+  }
+  const TableSpec& spec = is_probe ? probe_spec_ : build_spec_;
+  // Only the keys and the output columns need to be kept, the projection shares the input arrays.
+  RowBatch spilled_rb(SpilledDescriptor(key_data_types_, spec.input_col_types), rb.num_rows());
+  for (auto col_idx : spec.key_indices) {
+    PX_RETURN_IF_ERROR(spilled_rb.AddColumn(rb.ColumnAt(col_idx)));
+  }
+  for (auto col_idx : spec.input_col_indices) {
+    PX_RETURN_IF_ERROR(spilled_rb.AddColumn(rb.ColumnAt(col_idx)));
+  }
+
+  key_cols_.clear();
+  for (size_t i = 0; i < key_data_types_.size(); ++i) {
+    key_cols_.push_back(spilled_rb.ColumnAt(i).get());
+  }
+  HashKeyColumns(key_cols_, key_data_types_, &key_hashes_);
+  return (is_probe ? probe_spill_ : build_spill_)->Append(spilled_rb, key_hashes_);
+}
+
+Status EquijoinNode::SpillBuildBuffer() {
+  auto desc = SpilledDescriptor(key_data_types_, build_spec_.input_col_types);
+  size_t num_keys = key_data_types_.size();
+  std::vector<std::vector<std::unique_ptr<arrow::ArrayBuilder>>> partition_builders(
+      build_spill_->num_partitions());
+
+  auto flush = [&](size_t partition) -> Status {
+    auto& builders = partition_builders[partition];
+    PX_ASSIGN_OR_RETURN(auto rb, RowBatch::FromColumnBuilders(desc, false, false, &builders));
+    builders.clear();
+    return build_spill_->AppendToPartition(partition, *rb);
+  };
+
+  for (const auto& [rt, wrappers] : build_buffer_) {
+    int64_t num_rows = build_buffer_rows_[rt];
+    size_t partition = build_spill_->PartitionForHash(rt->Hash());
+    auto& builders = partition_builders[partition];
+    if (builders.empty()) {
+      for (size_t i = 0; i < desc.size(); ++i) {
+        builders.push_back(MakeArrowBuilder(desc.type(i), arrow::default_memory_pool()));
+      }
+    }
+    for (const auto& builder : builders) {
+      PX_RETURN_IF_ERROR(builder->Reserve(num_rows));
+    }
+
+    // Every build row of the key gets a copy of the key, followed by its buffered values.
+    for (size_t i = 0; i < num_keys; ++i) {
+#define TYPE_CASE(_dt_)                                                                 \
+  PX_RETURN_IF_ERROR(table_store::schema::CopyValueRepeated<_dt_>(                      \
+      builders[i].get(),                                                                \
+      udf::UnWrap(rt->GetValue<types::DataTypeTraits<_dt_>::value_type>(i)), num_rows))
+      PX_SWITCH_FOREACH_DATATYPE(key_data_types_[i], TYPE_CASE);
+#undef TYPE_CASE
+    }
+    for (size_t i = 0; i < build_spec_.input_col_types.size(); ++i) {
+#define TYPE_CASE(_dt_) \
+  PX_RETURN_IF_ERROR(   \
+      AppendValuesFromWrapper<_dt_>(builders[num_keys + i].get(), wrappers->at(i), 0, num_rows))
+      PX_SWITCH_FOREACH_DATATYPE(build_spec_.input_col_types[i], TYPE_CASE);
+#undef TYPE_CASE
+    }
+
+    if (builders[0]->length() >= static_cast<int64_t>(kDefaultJoinRowBatchSize)) {
+      PX_RETURN_IF_ERROR(flush(partition));
+    }
+  }
+
+  for (size_t partition = 0; partition < partition_builders.size(); ++partition) {
+    if (!partition_builders[partition].empty() && partition_builders[partition][0]->length()) {
+      PX_RETURN_IF_ERROR(flush(partition));
+    }
+  }
+  return Status::OK();
+}
+
+Status EquijoinNode::JoinSpilledPartitions(ExecState* exec_state) {
+  // From here on the input batches are the spilled ones, which hold the keys followed by the
+  // output columns.
+  for (TableSpec* spec : {&build_spec_, &probe_spec_}) {
+    for (size_t i = 0; i < spec->key_indices.size(); ++i) {
+      spec->key_indices[i] = i;
+    }
+    for (size_t i = 0; i < spec->input_col_indices.size(); ++i) {
+      spec->input_col_indices[i] = key_data_types_.size() + i;
+    }
+  }
+
+  for (size_t partition = 0; partition < build_spill_->num_partitions(); ++partition) {
+    ClearBuildState(exec_state);
+
+    auto build_file = build_spill_->partition(partition);
+    if (build_file != nullptr) {
+      PX_RETURN_IF_ERROR(build_file->Rewind());
+      while (true) {
+        PX_ASSIGN_OR_RETURN(auto rb, build_file->ReadNext());
+        if (rb == nullptr) {
+          break;
+        }
+        PX_RETURN_IF_ERROR(ExtractJoinKeysForBatch(*rb, false));
+        PX_RETURN_IF_ERROR(HashRowBatch(*rb));
+      }
+    }
+
+    auto probe_file = probe_spill_->partition(partition);
+    if (probe_file != nullptr) {
+      PX_RETURN_IF_ERROR(probe_file->Rewind());
+      while (true) {
+        PX_ASSIGN_OR_RETURN(auto rb, probe_file->ReadNext());
+        if (rb == nullptr) {
+          break;
+        }
+        PX_RETURN_IF_ERROR(DoProbe(exec_state, *rb));
+      }
+    }
+
+    if (build_spec_.emit_unmatched_rows) {
+      PX_RETURN_IF_ERROR(EmitUnmatchedBuildRows(exec_state));
+    }
+  }
+
+  ClearBuildState(exec_state);
+  build_spill_->Clear();
+  probe_spill_->Clear();
+  return Status::OK();
+}
+
 Status EquijoinNode::ConsumeProbeBatch(ExecState* exec_state,
                                        const table_store::schema::RowBatch& rb) {
+  if (spilling_) {
+    return SpillBatch(rb, true);
+  }
   if (!build_eos_) {
     probe_batches_.push(rb);
     return Status::OK();
@@ -448,7 +656,9 @@ Status EquijoinNode::ConsumeNextImpl(ExecState* exec_state, const table_store::s
   }
 
   if (build_eos_ && probe_eos_) {
-    if (build_spec_.emit_unmatched_rows) {
+    if (spilling_) {
+      PX_RETURN_IF_ERROR(JoinSpilledPartitions(exec_state));
+    } else if (build_spec_.emit_unmatched_rows) {
       PX_RETURN_IF_ERROR(EmitUnmatchedBuildRows(exec_state));
     }
 
@@ -31,6 +31,8 @@
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/row_tuple.h"
+#include "src/carnot/exec/runtime_filter.h"
+#include "src/carnot/exec/spill_file.h"
 #include "src/carnot/plan/operators.h"
 #include "src/common/base/base.h"
 #include "src/common/base/status.h"
@@ -64,6 +66,26 @@ class EquijoinNode : public ProcessingNode {
   EquijoinNode() = default;
   virtual ~EquijoinNode() = default;
 
+  /**
+   * Whether rows of the probe input that don't match any build key can be dropped before they
+   * reach the join, which holds unless the join has to emit the unmatched probe rows.
+   */
+  bool SupportsRuntimeFilter() const { return !probe_spec_.emit_unmatched_rows; }
+  // The parent index of the probe input and the indices of its key columns.
+  size_t probe_parent_index() const {
+    return probe_table_ == EquijoinNode::JoinInputTable::kLeftTable ? 0 : 1;
+  }
+  const std::vector<int64_t>& probe_key_indices() const { return probe_spec_.key_indices; }
+  const std::vector<types::DataType>& key_data_types() const { return key_data_types_; }
+
+  /**
+   * Adds a slot that the join publishes a bloom filter of its build keys to, once the build
+   * input is done.
+   */
+  void AddRuntimeFilterSlot(std::shared_ptr<RuntimeFilterSlot> slot) {
+    runtime_filter_slots_.push_back(std::move(slot));
+  }
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -90,6 +112,16 @@ class EquijoinNode : public ProcessingNode {
   Status ConsumeBuildBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status ConsumeProbeBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
 
+  // Grace hash join. Once the query is over its memory budget, the build side held in memory and
+  // all of the remaining input are written to hash partitions on disk. When both inputs are done
+  // the partitions are joined one at a time.
+  Status StartSpilling(ExecState* exec_state);
+  Status SpillBuildBuffer();
+  Status SpillBatch(const table_store::schema::RowBatch& rb, bool is_probe);
+  Status JoinSpilledPartitions(ExecState* exec_state);
+  void ClearBuildState(ExecState* exec_state);
+  Status PublishRuntimeFilter();
+
   bool build_eos_ = false;
   bool probe_eos_ = false;
   // Note whether the left or the right table is the probe table.
@@ -104,6 +136,17 @@ class EquijoinNode : public ProcessingNode {
 
   std::vector<types::DataType> key_data_types_;
 
+  // Set once the join has moved its state to disk.
+  bool spilling_ = false;
+  // The bytes of build input held in memory, as accounted against the query memory budget.
+  int64_t build_bytes_ = 0;
+  // The spilled rows hold the join keys followed by the input columns that are output.
+  std::unique_ptr<SpillPartitions> build_spill_;
+  std::unique_ptr<SpillPartitions> probe_spill_;
+
+  // Upstream nodes of the probe input that drop rows with keys not in the build input.
+  std::vector<std::shared_ptr<RuntimeFilterSlot>> runtime_filter_slots_;
+
   // Example of the above specs:
   // For input table A (build) which has [key_A_1, output_col_0, key_A_0/output_col_2]
   // and input table B (probe) which has [key_B_0, output_col_3, key_B_1/output_col_1]
@@ -135,6 +178,9 @@ class EquijoinNode : public ProcessingNode {
 
   // Chunk of data to use when extracting join keys.
   std::vector<RowTuple*> join_keys_chunk_;
+  // The key columns of the current row batch and their per row hashes.
+  std::vector<const arrow::Array*> key_cols_;
+  std::vector<uint64_t> key_hashes_;
   // Chunk of data to use when performing the build stage of the join.
   std::vector<std::vector<types::SharedColumnWrapper>*> build_wrappers_chunk_;
 
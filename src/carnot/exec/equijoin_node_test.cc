@@ -29,6 +29,7 @@
 #include "src/carnot/planpb/test_proto.h"
 #include "src/carnot/udf/base.h"
 #include "src/carnot/udf/registry.h"
+#include "src/common/testing/testing.h"
 
 namespace px {
 namespace carnot {
@@ -686,6 +687,86 @@ TEST_F(JoinNodeTest, unordered_many_matches) {
       .Close();
 }
 
+TEST_F(JoinNodeTest, unordered_full_outer_join_spilled) {
+  PX_SET_FOR_SCOPE(FLAGS_carnot_exec_query_memory_budget_bytes, 1);
+  PX_SET_FOR_SCOPE(FLAGS_carnot_exec_spill_partitions, 1);
+  auto exec_state = std::make_unique<ExecState>(
+      func_registry_.get(), std::make_shared<table_store::TableStore>(),
+      MockResultSinkStubGenerator, MockMetricsStubGenerator, MockTraceStubGenerator,
+      sole::uuid4(), nullptr);
+
+  // Same as unordered_full_outer_join, but the first build batch puts the query over its budget
+  // so the join runs from the spilled partitions.
+  const char* proto = R"(
+  type: FULL_OUTER
+  equality_conditions {
+    left_column_index: 0
+    right_column_index: 1
+  }
+  output_columns: {
+    parent_index: 0
+    column_index: 1
+  }
+  output_columns: {
+    parent_index: 1
+    column_index: 1
+  }
+  output_columns: {
+    parent_index: 1
+    column_index: 0
+  }
+  column_names: "left_1"
+  column_names: "right_1"
+  column_names: "right_0"
+  rows_per_batch: 5
+)";
+
+  RowDescriptor input_rd_0({types::DataType::TIME64NS, types::DataType::INT64});
+  RowDescriptor input_rd_1({types::DataType::INT64, types::DataType::TIME64NS});
+  RowDescriptor output_rd(
+      {types::DataType::INT64, types::DataType::TIME64NS, types::DataType::INT64});
+
+  auto plan_node = PlanNodeFromPbtxt(proto);
+  auto tester = exec::ExecNodeTester<EquijoinNode, plan::JoinOperator>(
+      *plan_node, output_rd, {input_rd_0, input_rd_1}, exec_state.get());
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd_0, 5, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Time64NSValue>({101, 200, 101, 200, 101})
+                       .AddColumn<types::Int64Value>({1, 2, 3, 4, 5})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd_0, 5, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Time64NSValue>({200, 200, 200, 300, 300})
+                       .AddColumn<types::Int64Value>({6, 8, 10, 12, 14})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd_0, 2, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Time64NSValue>({400, 500})
+                       .AddColumn<types::Int64Value>({16, 18})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd_1, 3, true, true)
+                       .AddColumn<types::Int64Value>({-10, -20, -30})
+                       .AddColumn<types::Time64NSValue>({110, 120, 101})
+                       .get(),
+                   1, 3)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 5, false, false)
+                          .AddColumn<types::Int64Value>({0, 0, 1, 3, 5})
+                          .AddColumn<types::Time64NSValue>({110, 120, 101, 101, 101})
+                          .AddColumn<types::Int64Value>({-10, -20, -30, -30, -30})
+                          .get(),
+                      true)
+      .ExpectRowBatchesData(RowBatchBuilder(output_rd, 9, true, true)
+                                .AddColumn<types::Int64Value>({2, 4, 6, 8, 10, 12, 14, 16, 18})
+                                .AddColumn<types::Time64NSValue>({0, 0, 0, 0, 0, 0, 0, 0, 0})
+                                .AddColumn<types::Int64Value>({0, 0, 0, 0, 0, 0, 0, 0, 0})
+                                .get(),
+                            2)
+      .Close();
+  EXPECT_EQ(0, exec_state->memory_budget()->used_bytes());
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
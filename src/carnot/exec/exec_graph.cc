@@ -21,12 +21,20 @@
 #include <algorithm>
 #include <memory>
 #include <set>
+#include <string>
+#include <thread>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
 
 #include "src/carnot/exec/agg_node.h"
+#include "src/carnot/exec/as_of_join_node.h"
 #include "src/carnot/exec/empty_source_node.h"
 #include "src/carnot/exec/equijoin_node.h"
 #include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/file_export_sink_node.h"
 #include "src/carnot/exec/filter_node.h"
 #include "src/carnot/exec/grpc_router.h"
 #include "src/carnot/exec/grpc_sink_node.h"
@@ -36,6 +44,7 @@
 #include "src/carnot/exec/memory_sink_node.h"
 #include "src/carnot/exec/memory_source_node.h"
 #include "src/carnot/exec/otel_export_sink_node.h"
+#include "src/carnot/exec/top_k_node.h"
 #include "src/carnot/exec/udtf_source_node.h"
 #include "src/carnot/exec/union_node.h"
 #include "src/carnot/plan/operators.h"
@@ -43,6 +52,15 @@
 #include "src/common/perf/perf.h"
 #include "src/table_store/table_store.h"
 
+DEFINE_int32(carnot_exec_max_parallel_pipelines,
+             gflags::Int32FromEnv("PL_CARNOT_EXEC_MAX_PARALLEL_PIPELINES", 1),
+             "The maximum number of independent pipelines of a plan fragment that are executed "
+             "concurrently. Values <= 1 execute the whole plan fragment on a single thread.");
+
+DEFINE_bool(carnot_exec_trace_batches, gflags::BoolFromEnv("PL_CARNOT_EXEC_TRACE_BATCHES", false),
+            "Record a span for each batch an exec node processes in queries run with analyze, so "
+            "that the execution can be exported as a timeline.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -62,7 +80,9 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
 
   std::unordered_map<int64_t, ExecNode*> nodes;
   std::unordered_map<int64_t, RowDescriptor> descriptors;
-  return plan::PlanFragmentWalker()
+  std::vector<int64_t> join_ids;
+  std::vector<int64_t> memory_source_ids;
+  PX_RETURN_IF_ERROR(plan::PlanFragmentWalker()
       .OnMap([&](auto& node) {
         return OnOperatorImpl<plan::MapOperator, MapNode>(node, &descriptors);
       })
@@ -73,7 +93,12 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
         return OnOperatorImpl<plan::AggregateOperator, AggNode>(node, &descriptors);
       })
       .OnMemorySource([&](auto& node) {
-        return OnOperatorImpl<plan::MemorySourceOperator, MemorySourceNode>(node, &descriptors);
+        memory_source_ids.push_back(node.id());
+        auto s = OnOperatorImpl<plan::MemorySourceOperator, MemorySourceNode>(node, &descriptors);
+        PX_RETURN_IF_ERROR(s);
+        static_cast<MemorySourceNode*>(nodes_[node.id()])
+            ->set_batch_ready_callback(std::bind(&ExecutionGraph::ContinueSource, this, node.id()));
+        return Status::OK();
       })
       .OnFilter([&](auto& node) {
         return OnOperatorImpl<plan::FilterOperator, FilterNode>(node, &descriptors);
@@ -84,7 +109,14 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
       .OnUnion([&](auto& node) {
         return OnOperatorImpl<plan::UnionOperator, UnionNode>(node, &descriptors);
       })
+      .OnTopK([&](auto& node) {
+        return OnOperatorImpl<plan::TopKOperator, TopKNode>(node, &descriptors);
+      })
+      .OnAsOfJoin([&](auto& node) {
+        return OnOperatorImpl<plan::AsOfJoinOperator, AsOfJoinNode>(node, &descriptors);
+      })
       .OnJoin([&](auto& node) {
+        join_ids.push_back(node.id());
         return OnOperatorImpl<plan::JoinOperator, EquijoinNode>(node, &descriptors);
       })
       .OnGRPCSource([&](auto& node) {
@@ -93,14 +125,18 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
         grpc_sources_.insert(node.id());
         return exec_state->grpc_router()->AddGRPCSourceNode(
             exec_state->query_id(), node.id(), static_cast<GRPCSourceNode*>(nodes_[node.id()]),
-            std::bind(&ExecutionGraph::Continue, this));
+            std::bind(&ExecutionGraph::ContinueSource, this, node.id()));
       })
       .OnGRPCSink([&](auto& node) {
         grpc_sinks_.insert(node.id());
         return OnOperatorImpl<plan::GRPCSinkOperator, GRPCSinkNode>(node, &descriptors);
       })
       .OnUDTFSource([&](auto& node) {
-        return OnOperatorImpl<plan::UDTFSourceOperator, UDTFSourceNode>(node, &descriptors);
+        auto s = OnOperatorImpl<plan::UDTFSourceOperator, UDTFSourceNode>(node, &descriptors);
+        PX_RETURN_IF_ERROR(s);
+        static_cast<UDTFSourceNode*>(nodes_[node.id()])
+            ->set_batch_ready_callback(std::bind(&ExecutionGraph::ContinueSource, this, node.id()));
+        return Status::OK();
       })
       .OnEmptySource([&](auto& node) {
         return OnOperatorImpl<plan::EmptySourceOperator, EmptySourceNode>(node, &descriptors);
@@ -108,25 +144,233 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
       .OnOTelSink([&](auto& node) {
         return OnOperatorImpl<plan::OTelExportSinkOperator, OTelExportSinkNode>(node, &descriptors);
       })
-      .Walk(pf_);
+      .OnFileExportSink([&](auto& node) {
+        return OnOperatorImpl<plan::FileExportSinkOperator, FileExportSinkNode>(node,
+                                                                                &descriptors);
+      })
+      .Walk(pf_));
+
+  if (FLAGS_carnot_join_runtime_filter_max_keys > 0) {
+    for (int64_t join_id : join_ids) {
+      AddRuntimeFilter(join_id);
+    }
+  }
+  if (FLAGS_table_store_zone_maps) {
+    for (int64_t source_id : memory_source_ids) {
+      PushDownTablePredicates(source_id);
+    }
+  }
+  return Status::OK();
 }
 
-bool ExecutionGraph::YieldWithTimeout() {
+void ExecutionGraph::AddRuntimeFilter(int64_t join_id) {
+  auto join = static_cast<EquijoinNode*>(nodes_[join_id]);
+  auto join_parents = pf_->dag().ParentsOf(join_id);
+  if (!join->SupportsRuntimeFilter() || join_parents.size() != 2 ||
+      join_parents[0] == join_parents[1]) {
+    return;
+  }
+
+  // Walk up the probe input for as long as the key columns can be traced back and every node
+  // only feeds the join, so that the filter is applied as close to the source as possible.
+  int64_t target_id = join_parents[join->probe_parent_index()];
+  std::vector<int64_t> key_cols = join->probe_key_indices();
+  while (pf_->dag().DependenciesOf(target_id).size() == 1) {
+    auto parents = pf_->dag().ParentsOf(target_id);
+    if (parents.size() != 1 || pf_->dag().DependenciesOf(parents[0]).size() != 1) {
+      break;
+    }
+    std::vector<int64_t> parent_key_cols;
+    plan::Operator* op = pf_->nodes()[target_id].get();
+    if (op->op_type() == planpb::OperatorType::FILTER_OPERATOR) {
+      auto selected_cols = static_cast<plan::FilterOperator*>(op)->selected_cols();
+      for (int64_t col : key_cols) {
+        parent_key_cols.push_back(selected_cols[col]);
+      }
+    } else if (op->op_type() == planpb::OperatorType::MAP_OPERATOR) {
+      const auto& exprs = static_cast<plan::MapOperator*>(op)->expressions();
+      for (int64_t col : key_cols) {
+        if (exprs[col]->ExpressionType() != plan::Expression::kColumn) {
+          break;
+        }
+        parent_key_cols.push_back(static_cast<const plan::Column*>(exprs[col].get())->Index());
+      }
+    }
+    if (parent_key_cols.size() != key_cols.size()) {
+      break;
+    }
+    target_id = parents[0];
+    key_cols = std::move(parent_key_cols);
+  }
+  if (pf_->dag().DependenciesOf(target_id).size() != 1) {
+    return;
+  }
+
+  auto slot = std::make_shared<RuntimeFilterSlot>(std::move(key_cols), join->key_data_types());
+  nodes_[target_id]->set_output_runtime_filter(slot);
+  join->AddRuntimeFilterSlot(std::move(slot));
+}
+
+namespace {
+
+// Appends the comparisons of a column against a constant that are implied by the given filter
+// expression. table_cols maps the columns the expression refers to to the table's columns.
+void AddTablePredicates(const plan::ScalarExpression& expr, const std::vector<int64_t>& table_cols,
+                        std::vector<table_store::internal::ColumnPredicate>* predicates) {
+  using Op = table_store::internal::ColumnPredicate::Op;
+  if (expr.ExpressionType() != plan::Expression::kFunc) {
+    return;
+  }
+  const auto& func = static_cast<const plan::ScalarFunc&>(expr);
+  const auto& args = func.arg_deps();
+  if (func.name() == "logicalAnd") {
+    for (const auto& arg : args) {
+      AddTablePredicates(*arg, table_cols, predicates);
+    }
+    return;
+  }
+
+  if (func.name() == "contains") {
+    // px.contains(col, value) on a string column.
+    if (args.size() == 2 && args[0]->ExpressionType() == plan::Expression::kColumn &&
+        args[1]->ExpressionType() == plan::Expression::kConstant) {
+      const auto& col = static_cast<const plan::Column&>(*args[0]);
+      const auto& val = static_cast<const plan::ScalarValue&>(*args[1]);
+      if (!val.IsNull() && val.DataType() == types::DataType::STRING) {
+        predicates->push_back({table_cols[col.Index()], Op::kContains, val.StringValue()});
+      }
+    }
+    return;
+  }
+
+  static const absl::flat_hash_map<std::string, std::pair<Op, Op>> kOps = {
+      // The op for `col <op> value`, and for `value <op> col`.
+      {"equal", {Op::kEqual, Op::kEqual}},
+      {"lessThan", {Op::kLessThan, Op::kGreaterThan}},
+      {"lessThanEqual", {Op::kLessThanEqual, Op::kGreaterThanEqual}},
+      {"greaterThan", {Op::kGreaterThan, Op::kLessThan}},
+      {"greaterThanEqual", {Op::kGreaterThanEqual, Op::kLessThanEqual}},
+  };
+  auto op_it = kOps.find(func.name());
+  const auto& arg_types = func.registry_arg_types();
+  // Only same-typed comparisons, so that the constant compares like the column's values do.
+  if (op_it == kOps.end() || args.size() != 2 || arg_types.size() != 2 ||
+      arg_types[0] != arg_types[1]) {
+    return;
+  }
+  bool col_first = args[0]->ExpressionType() == plan::Expression::kColumn &&
+                   args[1]->ExpressionType() == plan::Expression::kConstant;
+  bool col_second = args[1]->ExpressionType() == plan::Expression::kColumn &&
+                    args[0]->ExpressionType() == plan::Expression::kConstant;
+  if (!col_first && !col_second) {
+    return;
+  }
+  const auto& col = static_cast<const plan::Column&>(*args[col_first ? 0 : 1]);
+  const auto& val = static_cast<const plan::ScalarValue&>(*args[col_first ? 1 : 0]);
+  if (val.IsNull() || val.DataType() != arg_types[0]) {
+    return;
+  }
+
+  table_store::internal::ColumnPredicate predicate;
+  predicate.column_index = table_cols[col.Index()];
+  predicate.op = col_first ? op_it->second.first : op_it->second.second;
+  switch (val.DataType()) {
+    case types::DataType::BOOLEAN:
+      predicate.value = val.BoolValue();
+      break;
+    case types::DataType::INT64:
+      predicate.value = val.Int64Value();
+      break;
+    case types::DataType::TIME64NS:
+      predicate.value = val.Time64NSValue();
+      break;
+    case types::DataType::FLOAT64:
+      predicate.value = val.Float64Value();
+      break;
+    case types::DataType::UINT128:
+      predicate.value = val.UInt128Value();
+      break;
+    case types::DataType::STRING:
+      predicate.value = val.StringValue();
+      break;
+    default:
+      return;
+  }
+  predicates->push_back(std::move(predicate));
+}
+
+}  // namespace
+
+void ExecutionGraph::PushDownTablePredicates(int64_t source_id) {
+  const auto* source_op =
+      static_cast<const plan::MemorySourceOperator*>(pf_->nodes()[source_id].get());
+  std::vector<int64_t> table_cols = source_op->Columns();
+  std::vector<table_store::internal::ColumnPredicate> predicates;
+
+  int64_t node_id = source_id;
+  while (pf_->dag().DependenciesOf(node_id).size() == 1) {
+    int64_t child_id = pf_->dag().DependenciesOf(node_id)[0];
+    plan::Operator* op = pf_->nodes()[child_id].get();
+    if (op->op_type() != planpb::OperatorType::FILTER_OPERATOR) {
+      break;
+    }
+    auto filter = static_cast<plan::FilterOperator*>(op);
+    AddTablePredicates(*filter->expression(), table_cols, &predicates);
+
+    std::vector<int64_t> child_table_cols;
+    for (int64_t col : filter->selected_cols()) {
+      child_table_cols.push_back(table_cols[col]);
+    }
+    table_cols = std::move(child_table_cols);
+    node_id = child_id;
+  }
+  if (!predicates.empty()) {
+    static_cast<MemorySourceNode*>(nodes_[source_id])->set_table_predicates(std::move(predicates));
+  }
+}
+
+bool ExecutionGraph::YieldWithTimeout() { return YieldWithTimeout(sources_, &last_seen_wakeups_); }
+
+uint64_t ExecutionGraph::SourceReadyCountUnlocked(const std::vector<int64_t>& source_ids) {
+  uint64_t count = 0;
+  for (int64_t source_id : source_ids) {
+    auto it = source_ready_counts_.find(source_id);
+    if (it != source_ready_counts_.end()) {
+      count += it->second;
+    }
+  }
+  return count;
+}
+
+bool ExecutionGraph::YieldWithTimeout(const std::vector<int64_t>& source_ids, Wakeups* seen) {
   std::unique_lock<std::mutex> lock(execution_mutex_);
-  if (continue_) {
-    continue_ = false;
-    return false;
+  auto woken_up = [&] {
+    return continue_count_ != seen->continue_count ||
+           SourceReadyCountUnlocked(source_ids) != seen->source_ready_count;
+  };
+  bool timed_out = false;
+  if (!woken_up()) {
+    timed_out = !execution_cv_.wait_for(lock, yield_timeout_ms_, woken_up);
   }
-  auto timed_out = !(execution_cv_.wait_for(lock, yield_timeout_ms_, [this] { return continue_; }));
+  seen->continue_count = continue_count_;
+  seen->source_ready_count = SourceReadyCountUnlocked(source_ids);
   return timed_out;
 }
 
 void ExecutionGraph::Continue() {
   {
     std::lock_guard<std::mutex> lock(execution_mutex_);
-    continue_ = true;
+    ++continue_count_;
   }
-  execution_cv_.notify_one();
+  execution_cv_.notify_all();
+}
+
+void ExecutionGraph::ContinueSource(int64_t source_id) {
+  {
+    std::lock_guard<std::mutex> lock(execution_mutex_);
+    ++source_ready_counts_[source_id];
+  }
+  execution_cv_.notify_all();
 }
 
 Status ExecutionGraph::CheckUpstreamGRPCConnectionHealth(GRPCSourceNode* source_node) {
@@ -162,8 +406,9 @@ Status ExecutionGraph::CheckUpstreamGRPCConnectionHealth(GRPCSourceNode* source_
       upstream_result_connection_timeout_ms_.count());
 }
 
-Status ExecutionGraph::CheckDownstreamGRPCConnectionsHealth() {
-  for (const auto& grpc_sink_id : grpc_sinks_) {
+Status ExecutionGraph::CheckDownstreamGRPCConnectionsHealth(
+    const absl::flat_hash_set<int64_t>& grpc_sinks) {
+  for (const auto& grpc_sink_id : grpc_sinks) {
     auto node = nodes_.find(grpc_sink_id);
     if (node == nodes_.end()) {
       return error::NotFound("Could not find GRPCSinkNode $0.", grpc_sink_id);
@@ -174,11 +419,111 @@ Status ExecutionGraph::CheckDownstreamGRPCConnectionsHealth() {
   return Status::OK();
 }
 
-Status ExecutionGraph::ExecuteSources() {
+bool ExecutionGraph::StopPipelineIfReceiversDone(const ExecutionPipeline& pipeline) {
+  if (pipeline.grpc_sinks.empty() || pipeline.grpc_sinks.size() != pipeline.num_sinks) {
+    return false;
+  }
+  for (int64_t sink_id : pipeline.grpc_sinks) {
+    if (!static_cast<GRPCSinkNode*>(nodes_[sink_id])->receiver_done()) {
+      return false;
+    }
+  }
+  for (int64_t source_id : pipeline.sources) {
+    exec_state_->StopSource(source_id);
+  }
+  return true;
+}
+
+std::vector<ExecutionPipeline> ExecutionGraph::IndependentPipelines() {
+  // Union-find over the exec nodes. Every node is merged with its children, so two sources end up
+  // with the same root iff they share a downstream operator.
+  absl::flat_hash_map<ExecNode*, ExecNode*> parent;
+  for (const auto& [id, node] : nodes_) {
+    parent.try_emplace(node, node);
+    for (ExecNode* child : node->children()) {
+      parent.try_emplace(child, child);
+    }
+  }
+  auto find_root = [&parent](ExecNode* node) {
+    while (parent[node] != node) {
+      parent[node] = parent[parent[node]];
+      node = parent[node];
+    }
+    return node;
+  };
+  for (const auto& [id, node] : nodes_) {
+    for (ExecNode* child : node->children()) {
+      parent[find_root(node)] = find_root(child);
+    }
+  }
+
+  std::vector<ExecutionPipeline> pipelines;
+  absl::flat_hash_map<ExecNode*, size_t> root_to_pipeline;
+  for (int64_t src_id : sources_) {
+    auto [it, inserted] = root_to_pipeline.try_emplace(find_root(nodes_[src_id]), pipelines.size());
+    if (inserted) {
+      pipelines.emplace_back();
+    }
+    pipelines[it->second].sources.push_back(src_id);
+  }
+  for (int64_t sink_id : grpc_sinks_) {
+    auto it = root_to_pipeline.find(find_root(nodes_[sink_id]));
+    if (it != root_to_pipeline.end()) {
+      pipelines[it->second].grpc_sinks.insert(sink_id);
+    }
+  }
+  for (const auto& [id, node] : nodes_) {
+    if (!node->IsSink()) {
+      continue;
+    }
+    auto it = root_to_pipeline.find(find_root(node));
+    if (it != root_to_pipeline.end()) {
+      ++pipelines[it->second].num_sinks;
+    }
+  }
+  return pipelines;
+}
+
+Status ExecutionGraph::ExecutePipelinesInParallel(
+    const std::vector<ExecutionPipeline>& pipelines) {
+  // Each worker runs a pipeline to completion before claiming the next one, so an operator is
+  // never driven by more than one thread at a time.
+  std::atomic<size_t> next_pipeline = 0;
+  std::vector<Status> statuses(pipelines.size());
+  auto worker = [&]() {
+    for (size_t i = next_pipeline++; i < pipelines.size(); i = next_pipeline++) {
+      statuses[i] = ExecuteSources(pipelines[i]);
+      if (!statuses[i].ok()) {
+        abort_execution_ = true;
+        // Wake up the pipelines that are waiting for more data so they notice the abort.
+        Continue();
+      }
+    }
+  };
+
+  size_t num_workers =
+      std::min(pipelines.size(), static_cast<size_t>(max_parallel_pipelines_));
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < num_workers; ++i) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto& t : workers) {
+    t.join();
+  }
+
+  for (const auto& s : statuses) {
+    PX_RETURN_IF_ERROR(s);
+  }
+  return Status::OK();
+}
+
+Status ExecutionGraph::ExecuteSources(const ExecutionPipeline& pipeline) {
   absl::flat_hash_set<SourceNode*> running_sources;
+  Wakeups seen_wakeups;
 
   absl::flat_hash_map<SourceNode*, int64_t> source_to_id;
-  for (auto node_id : sources_) {
+  for (auto node_id : pipeline.sources) {
     auto node = nodes_.find(node_id);
     if (node == nodes_.end()) {
       return error::NotFound("Could not find SourceNode $0.", node_id);
@@ -190,6 +535,10 @@ Status ExecutionGraph::ExecuteSources() {
 
   // Run all sources to completion, or exit if the query encounters an error.
   while (running_sources.size()) {
+    if (abort_execution_) {
+      // Another pipeline failed, it reports the error for the whole query.
+      return Status::OK();
+    }
     absl::flat_hash_set<SourceNode*> completed_sources_execute_loop;
 
     for (SourceNode* source : running_sources) {
@@ -206,10 +555,10 @@ Status ExecutionGraph::ExecuteSources() {
         }
       }
 
-      exec_state_->SetCurrentSource(source_to_id[source]);
+      int64_t source_id = source_to_id[source];
 
       for (auto i = 0; i < consecutive_generate_calls_per_source_; ++i) {
-        if (!source->NextBatchReady() || !exec_state_->keep_running()) {
+        if (!source->NextBatchReady() || !exec_state_->keep_running(source_id)) {
           break;
         }
         PX_RETURN_IF_ERROR(source->GenerateNext(exec_state_));
@@ -217,12 +566,16 @@ Status ExecutionGraph::ExecuteSources() {
 
       // keep_running will be set to false when a downstream limit for this particular
       // source (set in exec_state) has been reached.
-      if (!source->HasBatchesRemaining() || !exec_state_->keep_running()) {
+      if (!source->HasBatchesRemaining() || !exec_state_->keep_running(source_id)) {
         completed_sources_execute_loop.insert(source);
         break;
       }
     }
-    PX_RETURN_IF_ERROR(CheckDownstreamGRPCConnectionsHealth());
+    PX_RETURN_IF_ERROR(CheckDownstreamGRPCConnectionsHealth(pipeline.grpc_sinks));
+    // Nothing the sources produce is needed once the receivers of all the results are done.
+    if (StopPipelineIfReceiversDone(pipeline)) {
+      return Status::OK();
+    }
 
     // Flush all of the completed sources.
     for (SourceNode* source : completed_sources_execute_loop) {
@@ -247,14 +600,17 @@ Status ExecutionGraph::ExecuteSources() {
     while (wait_for_more_data) {
       auto timer = ElapsedTimer();
       timer.Start();
-      YieldWithTimeout();
+      YieldWithTimeout(pipeline.sources, &seen_wakeups);
       timer.Stop();
 
+      if (abort_execution_) {
+        return Status::OK();
+      }
+
       absl::flat_hash_set<SourceNode*> completed_sources_wait_loop;
 
-      // This check is used for Memory sources that are waiting on data, because we don't currently
-      // have a mechanism to call Yield() on them while they are waiting.
-      // Once we introduce Carnot ETL, we can have the ingest phase of Carnot ETL call yield.
+      // Sources wake up the pipeline when they get data, but the yield also times out, so check
+      // which of them actually have a batch ready.
       for (SourceNode* source : running_sources) {
         if (source->NextBatchReady()) {
           wait_for_more_data = false;
@@ -273,7 +629,10 @@ Status ExecutionGraph::ExecuteSources() {
           }
         }
       }
-      PX_RETURN_IF_ERROR(CheckDownstreamGRPCConnectionsHealth());
+      PX_RETURN_IF_ERROR(CheckDownstreamGRPCConnectionsHealth(pipeline.grpc_sinks));
+      if (StopPipelineIfReceiversDone(pipeline)) {
+        return Status::OK();
+      }
 
       // Flush all of the completed sources after this phase of source deletion.
       for (SourceNode* source : completed_sources_wait_loop) {
@@ -309,7 +668,18 @@ Status ExecutionGraph::Execute() {
 
   // We don't PX_RETURN_IF_ERROR here because we want to make sure we close all of our
   // nodes, even if there was an error during execution.
-  Status source_status = ExecuteSources();
+  Status source_status;
+  std::vector<ExecutionPipeline> pipelines;
+  if (max_parallel_pipelines_ > 1) {
+    pipelines = IndependentPipelines();
+  }
+  if (pipelines.size() > 1) {
+    source_status = ExecutePipelinesInParallel(pipelines);
+  } else {
+    size_t num_sinks = std::count_if(nodes.begin(), nodes.end(),
+                                     [](ExecNode* node) { return node->IsSink(); });
+    source_status = ExecuteSources(ExecutionPipeline{sources_, grpc_sinks_, num_sinks});
+  }
   Status close_status = Status::OK();
 
   for (auto node : nodes) {
@@ -20,6 +20,7 @@
 
 #include <stddef.h>
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>
 #include <cstdint>
 #include <memory>
@@ -39,6 +40,8 @@
 #include "src/shared/types/types.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_int32(carnot_exec_max_parallel_pipelines);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -53,6 +56,17 @@ constexpr std::chrono::milliseconds kDefaultUpstreamResultConnectionTimeout{5000
 constexpr int32_t kDefaultConsecutiveGenerateCallsPerSource = 10;
 using SystemTimePoint = std::chrono::time_point<std::chrono::system_clock>;
 
+/**
+ * A pipeline is a set of sources along with every operator downstream of them. Two pipelines of
+ * the same graph never share an operator, so they can be executed on different threads.
+ */
+struct ExecutionPipeline {
+  std::vector<int64_t> sources;
+  absl::flat_hash_set<int64_t> grpc_sinks;
+  // The number of sinks of the pipeline, including the GRPC sinks.
+  size_t num_sinks = 0;
+};
+
 /**
  * An Execution Graph defines the structure of execution nodes for a given plan fragment.
  */
@@ -69,7 +83,8 @@ class ExecutionGraph {
   ExecutionGraph(const std::chrono::milliseconds& yield_duration,
                  const std::chrono::milliseconds& upstream_result_connection_timeout)
       : upstream_result_connection_timeout_ms_(upstream_result_connection_timeout),
-        yield_timeout_ms_(yield_duration) {}
+        yield_timeout_ms_(yield_duration),
+        max_parallel_pipelines_(FLAGS_carnot_exec_max_parallel_pipelines) {}
 
   ExecutionGraph()
       : ExecutionGraph(kDefaultYieldTimeoutMS, kDefaultUpstreamResultConnectionTimeout) {}
@@ -132,11 +147,33 @@ class ExecutionGraph {
   void Continue();
 
   /**
-   * Yields the execution of the current graph until Continue() is called or the timeout is reached.
-   * @return true if the yield timed out, false if Continue() was called.
+   * Re-awakens the pipeline that executes the given source, when the source has more work available
+   * (e.g. a row batch was queued to a GRPC source, or written to the table of a streaming memory
+   * source). The pipelines of the other sources keep waiting.
+   */
+  void ContinueSource(int64_t source_id);
+
+  /**
+   * Yields the execution of the current graph until Continue() or ContinueSource() is called or
+   * the timeout is reached.
+   * @return true if the yield timed out, false if execution was continued.
    */
   bool YieldWithTimeout();
 
+  /**
+   * Splits the graph into independent pipelines, in the order of their first source.
+   * Sources are grouped together when they (transitively) feed a common operator.
+   */
+  std::vector<ExecutionPipeline> IndependentPipelines();
+
+  /**
+   * Sets how many independent pipelines may be executed concurrently by Execute().
+   * A value of 1 (or less) runs every source on the calling thread.
+   */
+  void set_max_parallel_pipelines(int32_t max_parallel_pipelines) {
+    max_parallel_pipelines_ = max_parallel_pipelines;
+  }
+
   ExecutionStats GetStats() const;
 
   void AddNode(int64_t id, ExecNode* node) {
@@ -157,7 +194,17 @@ class ExecutionGraph {
   Status CheckUpstreamGRPCConnectionHealth(GRPCSourceNode* source_node);
   // Check the downstream GRPC connections for the query.
   // If it is not healthy, we will cancel the query.
-  Status CheckDownstreamGRPCConnectionsHealth();
+  Status CheckDownstreamGRPCConnectionsHealth() {
+    return CheckDownstreamGRPCConnectionsHealth(grpc_sinks_);
+  }
+  Status CheckDownstreamGRPCConnectionsHealth(const absl::flat_hash_set<int64_t>& grpc_sinks);
+
+  /**
+   * Stops the sources of the pipeline if all of its sinks are GRPC sinks whose receivers need no
+   * more results, such as when a limit was reached on the Kelvin they send to.
+   * @return whether the sources were stopped.
+   */
+  bool StopPipelineIfReceiversDone(const ExecutionPipeline& pipeline);
 
  private:
   /**
@@ -207,7 +254,28 @@ class ExecutionGraph {
     return Status::OK();
   }
 
-  Status ExecuteSources();
+  /**
+   * Connects the join to the furthest node up its probe input that it can push a runtime filter
+   * of its build keys to, if any.
+   */
+  void AddRuntimeFilter(int64_t join_id);
+
+  /**
+   * Hands the column comparisons of the filters right downstream of the memory source to its
+   * table cursor, so that it can skip the table batches the filters would drop entirely.
+   */
+  void PushDownTablePredicates(int64_t source_id);
+
+  Status ExecuteSources(const ExecutionPipeline& pipeline);
+  Status ExecutePipelinesInParallel(const std::vector<ExecutionPipeline>& pipelines);
+  // The wake-ups a waiting pipeline has seen, to tell whether there is anything new for it.
+  struct Wakeups {
+    uint64_t continue_count = 0;
+    uint64_t source_ready_count = 0;
+  };
+  // Waits until Continue() is called, or ContinueSource() for one of the given sources.
+  bool YieldWithTimeout(const std::vector<int64_t>& source_ids, Wakeups* seen);
+  uint64_t SourceReadyCountUnlocked(const std::vector<int64_t>& source_ids);
 
   ExecState* exec_state_;
   ObjectPool pool_{"exec_graph_pool"};
@@ -234,8 +302,19 @@ class ExecutionGraph {
   // (Doesn't apply if there is only one active source.)
   int32_t consecutive_generate_calls_per_source_ = kDefaultConsecutiveGenerateCallsPerSource;
 
-  // Whether or not the graph should continue executing or wait for more work to do.
-  bool continue_ = false;
+  // Maximum number of independent pipelines to execute concurrently.
+  int32_t max_parallel_pipelines_;
+
+  // Incremented every time Continue() is called. Each executing pipeline remembers the last value
+  // it observed, so that a single Continue() wakes up every pipeline waiting for more work.
+  uint64_t continue_count_ = 0;
+  // Incremented for a source every time ContinueSource() is called for it. A pipeline only wakes up
+  // when the counts of its own sources change.
+  absl::flat_hash_map<int64_t, uint64_t> source_ready_counts_;
+  // The wake-ups observed by the public YieldWithTimeout().
+  Wakeups last_seen_wakeups_;
+  // Set when one of the concurrently executing pipelines fails, so the others stop early.
+  std::atomic<bool> abort_execution_ = false;
   std::mutex execution_mutex_;
   std::condition_variable execution_cv_;
   // Whether to collect stats on exec nodes.
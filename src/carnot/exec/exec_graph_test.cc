@@ -534,6 +534,95 @@ TEST_F(ExecGraphTest, execute_with_two_limits) {
       types::ToArrow(out_in1, arrow::default_memory_pool())));
 }
 
+TEST_F(ExecGraphTest, independent_pipelines) {
+  auto plan_state = std::make_unique<plan::PlanState>(func_registry_.get());
+  auto schema = std::make_shared<table_store::schema::Schema>();
+  schema->AddRelation(
+      1, table_store::schema::Relation(
+             std::vector<types::DataType>(
+                 {types::DataType::INT64, types::DataType::BOOLEAN, types::DataType::FLOAT64}),
+             std::vector<std::string>({"a", "b", "c"})));
+
+  planpb::PlanFragment two_srcs_pb;
+  ASSERT_TRUE(
+      TextFormat::MergeFromString(planpb::testutils::kPlanWithTwoSourcesWithLimits, &two_srcs_pb));
+  auto two_srcs_pf = std::make_shared<plan::PlanFragment>(1);
+  ASSERT_OK(two_srcs_pf->Init(two_srcs_pb));
+
+  ExecutionGraph two_srcs_graph;
+  ASSERT_OK(two_srcs_graph.Init(schema.get(), plan_state.get(), exec_state_.get(),
+                                two_srcs_pf.get(), /* collect_exec_node_stats */ false));
+  auto pipelines = two_srcs_graph.IndependentPipelines();
+  ASSERT_EQ(2, pipelines.size());
+  EXPECT_EQ(1, pipelines[0].sources.size());
+  EXPECT_EQ(1, pipelines[1].sources.size());
+  EXPECT_NE(pipelines[0].sources[0], pipelines[1].sources[0]);
+
+  planpb::PlanFragment three_srcs_pb;
+  ASSERT_TRUE(TextFormat::MergeFromString(planpb::testutils::kOneLimit3Sources, &three_srcs_pb));
+  auto three_srcs_pf = std::make_shared<plan::PlanFragment>(1);
+  ASSERT_OK(three_srcs_pf->Init(three_srcs_pb));
+
+  ExecutionGraph three_srcs_graph;
+  ASSERT_OK(three_srcs_graph.Init(schema.get(), plan_state.get(), exec_state_.get(),
+                                  three_srcs_pf.get(), /* collect_exec_node_stats */ false));
+  pipelines = three_srcs_graph.IndependentPipelines();
+  ASSERT_EQ(1, pipelines.size());
+  EXPECT_EQ(3, pipelines[0].sources.size());
+}
+
+TEST_F(ExecGraphTest, execute_parallel_pipelines) {
+  planpb::PlanFragment pf_pb;
+  ASSERT_TRUE(
+      TextFormat::MergeFromString(planpb::testutils::kPlanWithTwoSourcesWithLimits, &pf_pb));
+  std::shared_ptr<plan::PlanFragment> plan_fragment_ = std::make_shared<plan::PlanFragment>(1);
+  ASSERT_OK(plan_fragment_->Init(pf_pb));
+
+  auto plan_state = std::make_unique<plan::PlanState>(func_registry_.get());
+
+  auto schema = std::make_shared<table_store::schema::Schema>();
+  schema->AddRelation(
+      1, table_store::schema::Relation(
+             std::vector<types::DataType>(
+                 {types::DataType::INT64, types::DataType::BOOLEAN, types::DataType::FLOAT64}),
+             std::vector<std::string>({"a", "b", "c"})));
+
+  table_store::schema::Relation rel(
+      {types::DataType::INT64, types::DataType::BOOLEAN, types::DataType::FLOAT64},
+      {"col1", "col2", "col3"});
+  auto table = Table::Create("test", rel);
+
+  auto rb1 = RowBatch(RowDescriptor(rel.col_types()), 3);
+  std::vector<types::Int64Value> col1_in1 = {1, 2, 3};
+  std::vector<types::BoolValue> col2_in1 = {true, false, true};
+  std::vector<types::Float64Value> col3_in1 = {1.4, 6.2, 10.2};
+  EXPECT_OK(rb1.AddColumn(types::ToArrow(col1_in1, arrow::default_memory_pool())));
+  EXPECT_OK(rb1.AddColumn(types::ToArrow(col2_in1, arrow::default_memory_pool())));
+  EXPECT_OK(rb1.AddColumn(types::ToArrow(col3_in1, arrow::default_memory_pool())));
+  EXPECT_OK(table->WriteRowBatch(rb1));
+
+  auto table_store = std::make_shared<table_store::TableStore>();
+  table_store->AddTable("numbers", table);
+  auto exec_state_ = std::make_unique<ExecState>(
+      func_registry_.get(), table_store, MockResultSinkStubGenerator, MockMetricsStubGenerator,
+      MockTraceStubGenerator, sole::uuid4(), nullptr);
+
+  ExecutionGraph e;
+  e.set_max_parallel_pipelines(4);
+  ASSERT_OK(e.Init(schema.get(), plan_state.get(), exec_state_.get(), plan_fragment_.get(),
+                   /* collect_exec_node_stats */ false));
+
+  EXPECT_OK(e.Execute());
+
+  std::vector<types::Float64Value> out_col3 = {1.4, 6.2};
+  table_store::Table::Cursor cursor1(exec_state_->table_store()->GetTable("output1"));
+  EXPECT_TRUE(cursor1.GetNextRowBatch({2}).ConsumeValueOrDie()->ColumnAt(0)->Equals(
+      types::ToArrow(out_col3, arrow::default_memory_pool())));
+  table_store::Table::Cursor cursor2(exec_state_->table_store()->GetTable("output2"));
+  EXPECT_TRUE(cursor2.GetNextRowBatch({2}).ConsumeValueOrDie()->ColumnAt(0)->Equals(
+      types::ToArrow(out_col3, arrow::default_memory_pool())));
+}
+
 class YieldingExecGraphTest : public BaseExecGraphTest {
  protected:
   void SetUp() { SetUpExecState(); }
@@ -646,6 +735,17 @@ TEST_F(YieldingExecGraphTest, yield_timeout) {
   exec_thread.join();
 }
 
+TEST_F(YieldingExecGraphTest, continue_other_source_does_not_wake_up) {
+  ExecutionGraph e{std::chrono::milliseconds(1), std::chrono::milliseconds(1)};
+  e.testing_set_exec_state(exec_state_.get());
+
+  // The graph has no source with this ID, so nothing waits for it.
+  e.ContinueSource(7);
+  EXPECT_TRUE(e.YieldWithTimeout());
+  e.Continue();
+  EXPECT_FALSE(e.YieldWithTimeout());
+}
+
 constexpr char kGRPCSourcePlanFragment[] = R"(
   id: 1,
   dag {
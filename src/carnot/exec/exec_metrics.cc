@@ -32,4 +32,10 @@ ExecMetrics::ExecMetrics(prometheus::Registry* registry)
               .Name("otlp_timeouts")
               .Help("Total number of timeouts which occurred when exporting data to an OTLP client")
               .Register(*registry)
-              .Add({{"name", "spans"}})) {}
+              .Add({{"name", "spans"}})),
+      query_memory_limit_exceeded_counter(
+          prometheus::BuildCounter()
+              .Name("carnot_query_memory_limit_exceeded")
+              .Help("Total number of queries that failed because they exceeded their memory limit")
+              .Register(*registry)
+              .Add({})) {}
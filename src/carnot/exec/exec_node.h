@@ -23,11 +23,15 @@
 #include <vector>
 
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/query_memory_pool.h"
+#include "src/carnot/exec/runtime_filter.h"
 #include "src/carnot/plan/operators.h"
 #include "src/common/base/base.h"
 #include "src/common/perf/perf.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_bool(carnot_exec_trace_batches);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -38,8 +42,24 @@ enum class ExecNodeType : int8_t {
   kProcessingNode = 2,
 };
 
+// A single call into an exec node, recorded when batch tracing is enabled.
+struct BatchSpan {
+  // The wall clock time the call started at.
+  int64_t start_time_ns = 0;
+  // The duration of the call, including the time spent in the children of the node.
+  int64_t duration_ns = 0;
+  // The rows and bytes consumed (processing and sink nodes) or produced (source nodes).
+  int64_t rows = 0;
+  int64_t bytes = 0;
+};
+
 struct ExecNodeStats {
-  explicit ExecNodeStats(bool collect_stats) : collect_exec_stats(collect_stats) {}
+  // The maximum number of spans kept per node, which bounds the memory of long running queries.
+  static constexpr size_t kMaxBatchSpans = 10000;
+
+  explicit ExecNodeStats(bool collect_stats)
+      : collect_exec_stats(collect_stats),
+        trace_batches(collect_stats && FLAGS_carnot_exec_trace_batches) {}
   void AddOutputStats(const table_store::schema::RowBatch& rb) {
     if (!collect_exec_stats) {
       return;
@@ -99,6 +119,22 @@ struct ExecNodeStats {
     extra_info[key] = value;
   }
 
+  // Returns the start time of a span, or 0 when the spans aren't traced.
+  int64_t StartSpan() const { return trace_batches ? CurrentTimeNS() : 0; }
+  void EndSpan(int64_t start_time_ns, int64_t rows, int64_t bytes) {
+    if (!trace_batches) {
+      return;
+    }
+    if (batch_spans.size() >= kMaxBatchSpans) {
+      ++dropped_batch_spans;
+      return;
+    }
+    batch_spans.push_back({start_time_ns, CurrentTimeNS() - start_time_ns, rows, bytes});
+  }
+
+  // The counter the arrow allocations of this node are attributed to while it runs.
+  int64_t* memory_attribution() { return collect_exec_stats ? &bytes_allocated : nullptr; }
+
   int64_t ChildExecTime() const { return children_timer.ElapsedTime_us() * 1000; }
   int64_t TotalExecTime() const { return total_timer.ElapsedTime_us() * 1000; }
   int64_t SelfExecTime() const { return TotalExecTime() - ChildExecTime(); }
@@ -115,12 +151,20 @@ struct ExecNodeStats {
   int64_t rows_output = 0;
   // Total batches input to this exec node.
   int64_t batches_output = 0;
+  // Total bytes of the arrow buffers allocated by this exec node itself.
+  int64_t bytes_allocated = 0;
   // Total timer for the node = children_time + self_time.
   ElapsedTimer total_timer;
   // Total timer for the children of the ndoe.
   ElapsedTimer children_timer;
   // Flag to determine whether to collect stats or not.
   bool collect_exec_stats;
+  // Flag to determine whether to record a span for each batch.
+  bool trace_batches;
+  // The recorded spans, in the order the calls started.
+  std::vector<BatchSpan> batch_spans;
+  // The number of spans not recorded because kMaxBatchSpans was reached.
+  int64_t dropped_batch_spans = 0;
 
   // Extra metrics to store.
   absl::flat_hash_map<std::string, double> extra_metrics;
@@ -194,9 +238,15 @@ class ExecNode {
   Status GenerateNext(ExecState* exec_state) {
     DCHECK(is_initialized_);
     DCHECK(type() == ExecNodeType::kSourceNode);
+    int64_t span_start = stats_->StartSpan();
+    int64_t rows_before = stats_->rows_output;
+    int64_t bytes_before = stats_->bytes_output;
     stats_->ResumeTotalTimer();
+    ScopedMemoryAttribution attribution(stats_->memory_attribution());
     PX_RETURN_IF_ERROR(GenerateNextImpl(exec_state));
     stats_->StopTotalTimer();
+    stats_->EndSpan(span_start, stats_->rows_output - rows_before,
+                    stats_->bytes_output - bytes_before);
     return Status::OK();
   }
 
@@ -219,9 +269,16 @@ class ExecNode {
           "ConsumeNext received row batch with end of stream set but not end of window.");
     }
     stats_->AddInputStats(rb);
+    int64_t span_start = stats_->StartSpan();
     stats_->ResumeTotalTimer();
-    PX_RETURN_IF_ERROR(ConsumeNextImpl(exec_state, rb, parent_index));
+    ScopedMemoryAttribution attribution(stats_->memory_attribution());
+    {
+      // Includes the time of the children that the batch is pushed to.
+      PX_PERF_PROBE_SCOPE("carnot", "consume_next");
+      PX_RETURN_IF_ERROR(ConsumeNextImpl(exec_state, rb, parent_index));
+    }
     stats_->StopTotalTimer();
+    stats_->EndSpan(span_start, rb.num_rows(), rb.NumBytes());
     return Status::OK();
   }
 
@@ -275,6 +332,14 @@ class ExecNode {
 
   ExecNodeStats* stats() const { return stats_.get(); }
 
+  /**
+   * Set a runtime filter, published by a downstream join, that drops rows from the output of this
+   * node before they are sent to its children. Only set on nodes with a single child.
+   */
+  void set_output_runtime_filter(std::shared_ptr<RuntimeFilterSlot> runtime_filter) {
+    output_runtime_filter_ = std::move(runtime_filter);
+  }
+
  protected:
   /**
    * Send data to children row batches.
@@ -283,17 +348,13 @@ class ExecNode {
    * @return Status of children execution.
    */
   Status SendRowBatchToChildren(ExecState* exec_state, const table_store::schema::RowBatch& rb) {
-    stats_->ResumeChildTimer();
-    for (size_t i = 0; i < children_.size(); ++i) {
-      PX_RETURN_IF_ERROR(children_[i]->ConsumeNext(exec_state, rb, parent_ids_for_children_[i]));
+    if (output_runtime_filter_ != nullptr) {
+      PX_ASSIGN_OR_RETURN(auto filtered_rb, output_runtime_filter_->Apply(rb));
+      if (filtered_rb != nullptr) {
+        return SendRowBatchToChildrenImpl(exec_state, *filtered_rb);
+      }
     }
-    stats_->StopChildTimer();
-    stats_->AddOutputStats(rb);
-    if (rb.eos()) {
-      DCHECK(!sent_eos_);
-      sent_eos_ = true;
-    }
-    return Status::OK();
+    return SendRowBatchToChildrenImpl(exec_state, rb);
   }
 
   explicit ExecNode(ExecNodeType type) : type_(type) {}
@@ -321,6 +382,21 @@ class ExecNode {
   bool sent_eos_ = false;
 
  private:
+  Status SendRowBatchToChildrenImpl(ExecState* exec_state,
+                                    const table_store::schema::RowBatch& rb) {
+    stats_->ResumeChildTimer();
+    for (size_t i = 0; i < children_.size(); ++i) {
+      PX_RETURN_IF_ERROR(children_[i]->ConsumeNext(exec_state, rb, parent_ids_for_children_[i]));
+    }
+    stats_->StopChildTimer();
+    stats_->AddOutputStats(rb);
+    if (rb.eos()) {
+      DCHECK(!sent_eos_);
+      sent_eos_ = true;
+    }
+    return Status::OK();
+  }
+
   // The stats of this exec node.
   std::unique_ptr<ExecNodeStats> stats_;
   // Unowned reference to the children. Must remain valid for the duration of query.
@@ -334,6 +410,8 @@ class ExecNode {
   ExecNodeType type_;
   // Whether this node has been initialized.
   bool is_initialized_ = false;
+  // Optional filter applied to row batches before they are sent to the children.
+  std::shared_ptr<RuntimeFilterSlot> output_runtime_filter_;
 };
 
 /**
@@ -19,7 +19,9 @@
 #pragma once
 
 #include <arrow/memory_pool.h>
+#include <absl/synchronization/mutex.h>
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
@@ -31,6 +33,9 @@
 #include "src/carnot/carnotpb/carnot.pb.h"
 #include "src/carnot/exec/exec_metrics.h"
 #include "src/carnot/exec/grpc_router.h"
+#include "src/carnot/exec/memory_budget.h"
+#include "src/carnot/exec/otel_export_state.h"
+#include "src/carnot/exec/query_memory_pool.h"
 #include "src/carnot/udf/model_pool.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/base.h"
@@ -72,7 +77,7 @@ class ExecState {
       const TraceStubGenerator& trace_stub_generator, const sole::uuid& query_id,
       udf::ModelPool* model_pool, GRPCRouter* grpc_router = nullptr,
       std::function<void(grpc::ClientContext*)> add_auth_func = [](grpc::ClientContext*) {},
-      ExecMetrics* exec_metrics = nullptr)
+      ExecMetrics* exec_metrics = nullptr, OTelExportStateStore* otel_export_states = nullptr)
       : func_registry_(func_registry),
         table_store_(std::move(table_store)),
         stub_generator_(stub_generator),
@@ -82,17 +87,20 @@ class ExecState {
         model_pool_(model_pool),
         grpc_router_(grpc_router),
         add_auth_to_grpc_client_context_func_(add_auth_func),
-        exec_metrics_(exec_metrics) {}
+        exec_metrics_(exec_metrics),
+        otel_export_states_(otel_export_states),
+        memory_budget_(FLAGS_carnot_exec_query_memory_budget_bytes),
+        exec_mem_pool_(QueryMemoryPool::Create(FLAGS_carnot_exec_query_memory_limit_bytes)) {}
 
   ~ExecState() {
     if (grpc_router_ != nullptr) {
       grpc_router_->DeleteQuery(query_id_);
     }
+    exec_mem_pool_->Release();
   }
-  arrow::MemoryPool* exec_mem_pool() {
-    // TOOD(zasgar): Make this the correct pool.
-    return arrow::default_memory_pool();
-  }
+  // The pool the arrow buffers of this query are allocated from. It tracks and limits the memory
+  // of the query.
+  QueryMemoryPool* exec_mem_pool() { return exec_mem_pool_; }
 
   udf::Registry* func_registry() { return func_registry_; }
 
@@ -119,6 +127,7 @@ class ExecState {
   // Currently, it will either be a Kelvin instance or a query broker.
   carnotpb::ResultSinkService::StubInterface* ResultSinkServiceStub(
       const std::string& remote_address, const std::string& ssl_targetname) {
+    absl::MutexLock lock(&stubs_lock_);
     if (result_sink_stub_map_.contains(remote_address)) {
       return result_sink_stub_map_[remote_address];
     }
@@ -131,40 +140,53 @@ class ExecState {
     return raw;
   }
 
+  // The OTel stubs are cached per address and channel, so that exports can be spread over several
+  // channels to the same collector.
   opentelemetry::proto::collector::metrics::v1::MetricsService::StubInterface* MetricsServiceStub(
-      const std::string& remote_address, bool insecure) {
-    if (metrics_service_stub_map_.contains(remote_address)) {
-      return metrics_service_stub_map_[remote_address];
+      const std::string& remote_address, bool insecure, int channel = 0) {
+    absl::MutexLock lock(&stubs_lock_);
+    auto key = std::make_pair(remote_address, channel);
+    if (metrics_service_stub_map_.contains(key)) {
+      return metrics_service_stub_map_[key];
     }
     std::unique_ptr<opentelemetry::proto::collector::metrics::v1::MetricsService::StubInterface>
         stub_ = metrics_stub_generator_(remote_address, insecure);
     opentelemetry::proto::collector::metrics::v1::MetricsService::StubInterface* raw = stub_.get();
-    metrics_service_stub_map_[remote_address] = raw;
+    metrics_service_stub_map_[key] = raw;
     // Push to the pool.
     metrics_service_stubs_pool_.push_back(std::move(stub_));
     return raw;
   }
   opentelemetry::proto::collector::trace::v1::TraceService::StubInterface* TraceServiceStub(
-      const std::string& remote_address, bool insecure) {
-    if (trace_service_stub_map_.contains(remote_address)) {
-      return trace_service_stub_map_[remote_address];
+      const std::string& remote_address, bool insecure, int channel = 0) {
+    absl::MutexLock lock(&stubs_lock_);
+    auto key = std::make_pair(remote_address, channel);
+    if (trace_service_stub_map_.contains(key)) {
+      return trace_service_stub_map_[key];
     }
     std::unique_ptr<opentelemetry::proto::collector::trace::v1::TraceService::StubInterface> stub_ =
         trace_stub_generator_(remote_address, insecure);
     opentelemetry::proto::collector::trace::v1::TraceService::StubInterface* raw = stub_.get();
-    trace_service_stub_map_[remote_address] = raw;
+    trace_service_stub_map_[key] = raw;
     // Push to the pool.
     trace_service_stubs_pool_.push_back(std::move(stub_));
     return raw;
   }
 
-  udf::ScalarUDFDefinition* GetScalarUDFDefinition(int64_t id) { return id_to_scalar_udf_map_[id]; }
+  // Lookups don't insert into the maps so that they can be called concurrently while executing.
+  udf::ScalarUDFDefinition* GetScalarUDFDefinition(int64_t id) {
+    auto it = id_to_scalar_udf_map_.find(id);
+    return it == id_to_scalar_udf_map_.end() ? nullptr : it->second;
+  }
 
   std::map<int64_t, udf::ScalarUDFDefinition*> id_to_scalar_udf_map() {
     return id_to_scalar_udf_map_;
   }
 
-  udf::UDADefinition* GetUDADefinition(int64_t id) { return id_to_uda_map_[id]; }
+  udf::UDADefinition* GetUDADefinition(int64_t id) {
+    auto it = id_to_uda_map_.find(id);
+    return it == id_to_uda_map_.end() ? nullptr : it->second;
+  }
 
   std::unique_ptr<udf::FunctionContext> CreateFunctionContext() {
     auto ctx = std::make_unique<udf::FunctionContext>(metadata_state_, model_pool_);
@@ -172,21 +194,24 @@ class ExecState {
   }
 
   // A node (ie. Limit) can call this method to say no more records will be processed for this
-  // source. That node is responsible for setting eos.
-  void StopSource(int64_t src_id) { source_id_to_keep_running_map_[src_id] = false; }
-
-  bool keep_running() {
-    DCHECK(current_source_set_);
-    return source_id_to_keep_running_map_[current_source_];
+  // source. That node is responsible for setting eos. If the source receives the results of other
+  // agents, their streams to it are ended as well, so that they stop producing them.
+  void StopSource(int64_t src_id) {
+    {
+      absl::MutexLock lock(&keep_running_lock_);
+      source_id_to_keep_running_map_[src_id] = false;
+    }
+    if (grpc_router_ != nullptr) {
+      grpc_router_->StopSourceStreams(query_id_, src_id);
+    }
   }
 
-  void SetCurrentSource(int64_t source_id) {
-    current_source_ = source_id;
-    current_source_set_ = true;
-    if (source_id_to_keep_running_map_.find(current_source_) ==
-        source_id_to_keep_running_map_.end()) {
-      source_id_to_keep_running_map_[current_source_] = true;
-    }
+  // Whether the given source should keep producing records. Thread-safe, since independent
+  // pipelines of the same query are executed concurrently.
+  bool keep_running(int64_t src_id) {
+    absl::MutexLock lock(&keep_running_lock_);
+    auto it = source_id_to_keep_running_map_.find(src_id);
+    return it == source_id_to_keep_running_map_.end() || it->second;
   }
 
   void set_metadata_state(std::shared_ptr<const md::AgentMetadataState> metadata_state) {
@@ -202,6 +227,33 @@ class ExecState {
 
   ExecMetrics* exec_metrics() { return exec_metrics_; }
 
+  // The export state that OTel export sinks keep between the runs of a script. Null if the
+  // engine doesn't keep state between queries.
+  OTelExportStateStore* otel_export_states() { return otel_export_states_; }
+
+  // The memory budget shared by the blocking operators of this query.
+  QueryMemoryBudget* memory_budget() { return &memory_budget_; }
+
+  // When enabled, the GRPC sinks of the query record the row batches they send, so that they can
+  // be cached and sent again for the same plan. A sink disables it when it stops before sending
+  // all of its results, since those can't be cached.
+  void set_record_sent_batches(bool record) { record_sent_batches_ = record; }
+  bool record_sent_batches() const { return record_sent_batches_; }
+
+  void RecordSentBatch(int64_t sink_id, std::unique_ptr<table_store::schema::RowBatch> rb) {
+    absl::MutexLock lock(&sent_batches_lock_);
+    sent_batches_[sink_id].push_back(std::move(rb));
+  }
+
+  // Returns the batches recorded so far by sink node ID, and clears them.
+  std::map<int64_t, std::vector<std::unique_ptr<table_store::schema::RowBatch>>>
+  TakeSentBatches() {
+    absl::MutexLock lock(&sent_batches_lock_);
+    auto sent_batches = std::move(sent_batches_);
+    sent_batches_.clear();
+    return sent_batches;
+  }
+
  private:
   udf::Registry* func_registry_;
   std::shared_ptr<table_store::TableStore> table_store_;
@@ -216,10 +268,21 @@ class ExecState {
   GRPCRouter* grpc_router_ = nullptr;
   std::function<void(grpc::ClientContext*)> add_auth_to_grpc_client_context_func_;
   ExecMetrics* exec_metrics_;
+  OTelExportStateStore* otel_export_states_;
+  QueryMemoryBudget memory_budget_;
+  // Owned, but released rather than deleted (see QueryMemoryPool).
+  QueryMemoryPool* exec_mem_pool_;
+
+  absl::Mutex keep_running_lock_;
+  std::map<int64_t, bool> source_id_to_keep_running_map_ ABSL_GUARDED_BY(keep_running_lock_);
+
+  std::atomic<bool> record_sent_batches_ = false;
+  absl::Mutex sent_batches_lock_;
+  std::map<int64_t, std::vector<std::unique_ptr<table_store::schema::RowBatch>>> sent_batches_
+      ABSL_GUARDED_BY(sent_batches_lock_);
 
-  int64_t current_source_ = 0;
-  bool current_source_set_ = false;
-  std::map<int64_t, bool> source_id_to_keep_running_map_;
+  // Protects the stub maps below, which can be populated lazily by sinks during execution.
+  absl::Mutex stubs_lock_;
 
   std::vector<std::unique_ptr<carnotpb::ResultSinkService::StubInterface>> result_sink_stubs_pool_;
   // Mapping of remote address to stub that serves that address.
@@ -229,14 +292,14 @@ class ExecState {
   std::vector<
       std::unique_ptr<opentelemetry::proto::collector::metrics::v1::MetricsService::StubInterface>>
       metrics_service_stubs_pool_;
-  absl::flat_hash_map<std::string,
+  absl::flat_hash_map<std::pair<std::string, int>,
                       opentelemetry::proto::collector::metrics::v1::MetricsService::StubInterface*>
       metrics_service_stub_map_;
 
   std::vector<
       std::unique_ptr<opentelemetry::proto::collector::trace::v1::TraceService::StubInterface>>
       trace_service_stubs_pool_;
-  absl::flat_hash_map<std::string,
+  absl::flat_hash_map<std::pair<std::string, int>,
                       opentelemetry::proto::collector::trace::v1::TraceService::StubInterface*>
       trace_service_stub_map_;
 };
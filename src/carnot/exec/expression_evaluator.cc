@@ -66,6 +66,8 @@ std::unique_ptr<ScalarExpressionEvaluator> ScalarExpressionEvaluator::Create(
       return std::make_unique<VectorNativeScalarExpressionEvaluator>(expressions, function_ctx);
     case ScalarExpressionEvaluatorType::kArrowNative:
       return std::make_unique<ArrowNativeScalarExpressionEvaluator>(expressions, function_ctx);
+    case ScalarExpressionEvaluatorType::kFused:
+      return std::make_unique<FusedScalarExpressionEvaluator>(expressions, function_ctx);
     default:
       CHECK(0) << "Unknown expression type";
   }
@@ -184,7 +186,7 @@ Status VectorNativeScalarExpressionEvaluator::Open(ExecState* exec_state) {
 }
 
 Status VectorNativeScalarExpressionEvaluator::Close(ExecState*) {
-  // Nothing here yet.
+  scratch_.clear();
   return Status();
 }
 
@@ -204,14 +206,20 @@ VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
       [&](const plan::ScalarValue& val,
           const std::vector<types::SharedColumnWrapper>& children) -> types::SharedColumnWrapper {
         DCHECK_EQ(children.size(), 0ULL);
-        return EvalScalarToColumnWrapper(exec_state, val, num_rows);
+        auto& scratch = scratch_[&val];
+        if (scratch == nullptr || scratch->Size() != num_rows) {
+          scratch = EvalScalarToColumnWrapper(exec_state, val, num_rows);
+        }
+        return scratch;
       });
 
   walker.OnColumn(
       [&](const plan::Column& col,
           const std::vector<types::SharedColumnWrapper>& children) -> types::SharedColumnWrapper {
         DCHECK_EQ(children.size(), 0ULL);
-        return ColumnWrapper::FromArrow(input.ColumnAt(col.Index()));
+        auto& scratch = scratch_[&col];
+        scratch = ColumnWrapper::FromArrow(input.ColumnAt(col.Index()), std::move(scratch));
+        return scratch;
       });
 
   walker.OnScalarFunc(
@@ -231,7 +239,13 @@ VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
         for (const auto& child : children) {
           raw_children.emplace_back(child.get());
         }
-        auto output = types::ColumnWrapper::Make(def->exec_return_type(), num_rows);
+        auto& output = scratch_[&fn];
+        if (output == nullptr || output.use_count() > 1 ||
+            output->data_type() != def->exec_return_type()) {
+          output = types::ColumnWrapper::Make(def->exec_return_type(), num_rows);
+        } else {
+          output->Resize(num_rows);
+        }
         // TODO(zasgar): need a better way to handle errors.
         PX_CHECK_OK(def->ExecBatch(udf, function_ctx_, raw_children, output.get(), num_rows));
         return output;
@@ -264,7 +278,7 @@ Status VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
   if (expr.ExpressionType() == plan::Expression::kColumn) {
     // Trivial copy reference for arrow column.
     auto col_expr = static_cast<const plan::Column&>(expr);
-    PX_RETURN_IF_ERROR(output->AddColumn(input.ColumnAt(col_expr.Index())));
+    PX_RETURN_IF_ERROR(output->AddColumnFrom(input, col_expr.Index()));
     return Status::OK();
   }
 
@@ -341,6 +355,137 @@ Status exec::ArrowNativeScalarExpressionEvaluator::EvaluateSingleExpression(
   return Status::OK();
 }
 
+Status FusedScalarExpressionEvaluator::Open(ExecState* exec_state) {
+  for (const auto& kv : exec_state->id_to_scalar_udf_map()) {
+    auto udf = kv.second->Make();
+    id_to_udf_map_[kv.first] = std::move(udf);
+  }
+  for (const auto& expr : expressions_) {
+    PX_RETURN_IF_ERROR(InitFuncsInExpression(exec_state, expr));
+  }
+
+  steps_.clear();
+  column_slots_.clear();
+  output_slots_.clear();
+  for (const auto& expr : expressions_) {
+    // Columns and constants at the root of an expression are written out directly by Evaluate.
+    if (expr->ExpressionType() != plan::Expression::kFunc) {
+      output_slots_.push_back(0);
+      continue;
+    }
+    PX_ASSIGN_OR_RETURN(auto slot, Compile(exec_state, *expr));
+    output_slots_.push_back(slot);
+  }
+  slots_.clear();
+  slots_.resize(steps_.size());
+  return Status::OK();
+}
+
+Status FusedScalarExpressionEvaluator::Close(ExecState*) {
+  slots_.clear();
+  return Status::OK();
+}
+
+StatusOr<size_t> FusedScalarExpressionEvaluator::Compile(ExecState* exec_state,
+                                                         const plan::ScalarExpression& expr) {
+  Step step;
+  step.type = expr.ExpressionType();
+  switch (step.type) {
+    case plan::Expression::kColumn: {
+      step.col_idx = static_cast<const plan::Column&>(expr).Index();
+      auto it = column_slots_.find(step.col_idx);
+      if (it != column_slots_.end()) {
+        return it->second;
+      }
+      column_slots_[step.col_idx] = steps_.size();
+      break;
+    }
+    case plan::Expression::kConstant:
+      step.value = static_cast<const plan::ScalarValue*>(&expr);
+      break;
+    case plan::Expression::kFunc: {
+      const auto& fn = static_cast<const plan::ScalarFunc&>(expr);
+      for (const auto& arg : fn.arg_deps()) {
+        PX_ASSIGN_OR_RETURN(auto arg_slot, Compile(exec_state, *arg));
+        step.arg_slots.push_back(arg_slot);
+      }
+      step.def = exec_state->GetScalarUDFDefinition(fn.udf_id());
+      if (step.def == nullptr) {
+        return error::NotFound("Could not find scalar UDF '$0' with id $1", fn.name(),
+                               fn.udf_id());
+      }
+      step.udf = id_to_udf_map_[fn.udf_id()].get();
+      break;
+    }
+    default:
+      return error::InvalidArgument("Cannot evaluate expression: $0", expr.DebugString());
+  }
+  steps_.push_back(std::move(step));
+  return steps_.size() - 1;
+}
+
+Status FusedScalarExpressionEvaluator::Evaluate(ExecState* exec_state, const RowBatch& input,
+                                                RowBatch* output) {
+  CHECK(exec_state != nullptr);
+  CHECK(output != nullptr);
+  CHECK_EQ(static_cast<size_t>(output->num_columns()), expressions_.size());
+
+  size_t num_rows = input.num_rows();
+  for (size_t i = 0; i < steps_.size(); ++i) {
+    const auto& step = steps_[i];
+    auto& slot = slots_[i];
+    switch (step.type) {
+      case plan::Expression::kColumn:
+        slot = ColumnWrapper::FromArrow(input.ColumnAt(step.col_idx), std::move(slot));
+        break;
+      case plan::Expression::kConstant:
+        if (slot == nullptr || slot->Size() != num_rows) {
+          slot = EvalScalarToColumnWrapper(exec_state, *step.value, num_rows);
+        }
+        break;
+      case plan::Expression::kFunc:
+        // The slot is recycled across batches, only its size changes.
+        if (slot == nullptr) {
+          slot = ColumnWrapper::Make(step.def->exec_return_type(), num_rows);
+        } else if (slot->Size() != num_rows) {
+          slot->Resize(num_rows);
+        }
+        args_.clear();
+        for (auto arg_slot : step.arg_slots) {
+          args_.push_back(slots_[arg_slot].get());
+        }
+        PX_RETURN_IF_ERROR(
+            step.def->ExecBatch(step.udf, function_ctx_, args_, slot.get(), num_rows));
+        break;
+      default:
+        return error::Internal("Unexpected step in expression program");
+    }
+  }
+
+  for (size_t i = 0; i < expressions_.size(); ++i) {
+    const auto& expr = *expressions_[i];
+    if (expr.ExpressionType() == plan::Expression::kColumn) {
+      // Shares the input column, without materializing it if the input is a view.
+      PX_RETURN_IF_ERROR(
+          output->AddColumnFrom(input, static_cast<const plan::Column&>(expr).Index()));
+    } else if (expr.ExpressionType() == plan::Expression::kConstant) {
+      PX_RETURN_IF_ERROR(output->AddColumn(EvalScalarToArrow(
+          exec_state, static_cast<const plan::ScalarValue&>(expr), num_rows)));
+    } else {
+      PX_RETURN_IF_ERROR(output->AddColumn(
+          slots_[output_slots_[i]]->ConvertToArrow(exec_state->exec_mem_pool())));
+    }
+  }
+  return Status::OK();
+}
+
+Status FusedScalarExpressionEvaluator::EvaluateSingleExpression(ExecState*, const RowBatch&,
+                                                                const plan::ScalarExpression&,
+                                                                RowBatch*) {
+  return error::Unimplemented("FusedScalarExpressionEvaluator evaluates all of its expressions in "
+                              "Evaluate");
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -26,6 +26,8 @@
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/udf/base.h"
@@ -89,6 +91,7 @@ class ExpressionEvaluator {
 enum class ScalarExpressionEvaluatorType : uint8_t {
   kVectorNative = 0,
   kArrowNative = 1,
+  kFused = 2,
 };
 
 /**
@@ -149,6 +152,12 @@ class VectorNativeScalarExpressionEvaluator : public ScalarExpressionEvaluator {
   Status EvaluateSingleExpression(ExecState* exec_state, const table_store::schema::RowBatch& input,
                                   const plan::ScalarExpression& expr,
                                   table_store::schema::RowBatch* output) override;
+
+ private:
+  // The column computed for each node of the expressions by the previous batch. A column is
+  // recycled for the next batch once the caller has dropped it, so that steady state evaluation
+  // doesn't allocate new columns (or strings) for every batch.
+  absl::flat_hash_map<const plan::ScalarExpression*, types::SharedColumnWrapper> scratch_;
 };
 
 /**
@@ -169,6 +178,59 @@ class ArrowNativeScalarExpressionEvaluator : public ScalarExpressionEvaluator {
                                   table_store::schema::RowBatch* output) override;
 };
 
+/**
+ * A scalar expression evaluator that compiles all of its expressions into one flat program when it
+ * is opened, and runs that program once per row batch.
+ *
+ * Compared to walking every expression tree for each batch, the UDFs are only resolved once, each
+ * input column is converted once per batch no matter how many expressions use it, constant
+ * arguments are only built when the batch size changes and the intermediate columns are reused
+ * across batches.
+ */
+class FusedScalarExpressionEvaluator : public ScalarExpressionEvaluator {
+ public:
+  explicit FusedScalarExpressionEvaluator(const plan::ConstScalarExpressionVector& expressions,
+                                          udf::FunctionContext* function_ctx)
+      : ScalarExpressionEvaluator(expressions, function_ctx) {}
+
+  Status Open(ExecState* exec_state) override;
+  Status Close(ExecState* exec_state) override;
+  Status Evaluate(ExecState* exec_state, const table_store::schema::RowBatch& input,
+                  table_store::schema::RowBatch* output) override;
+
+ protected:
+  Status EvaluateSingleExpression(ExecState* exec_state, const table_store::schema::RowBatch& input,
+                                  const plan::ScalarExpression& expr,
+                                  table_store::schema::RowBatch* output) override;
+
+ private:
+  // A step of the program computes the value of one slot, from the input or earlier slots.
+  struct Step {
+    plan::Expression type;
+    // kColumn: the input column to read.
+    int64_t col_idx = -1;
+    // kConstant: the value to repeat.
+    const plan::ScalarValue* value = nullptr;
+    // kFunc: the UDF to call and the slots that hold its arguments.
+    udf::ScalarUDFDefinition* def = nullptr;
+    udf::ScalarUDF* udf = nullptr;
+    std::vector<size_t> arg_slots;
+  };
+
+  // Appends the steps that compute expr and returns the slot that holds its value.
+  StatusOr<size_t> Compile(ExecState* exec_state, const plan::ScalarExpression& expr);
+
+  std::vector<Step> steps_;
+  // The value of steps_[i], kept across batches.
+  std::vector<types::SharedColumnWrapper> slots_;
+  // Input columns that are already loaded by a step, to their slot.
+  absl::flat_hash_map<int64_t, size_t> column_slots_;
+  // For each of the expressions, the slot of its value.
+  std::vector<size_t> output_slots_;
+  // Scratch space for the arguments of a UDF call.
+  std::vector<const types::ColumnWrapper*> args_;
+};
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
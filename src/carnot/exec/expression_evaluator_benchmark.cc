@@ -149,3 +149,143 @@ BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_simple_add_vector,
                   ScalarExpressionEvaluatorType::kVectorNative, kAddScalarFuncNestedPbtxt)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
+
+BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, eval_col_fused,
+                  ScalarExpressionEvaluatorType::kFused, kColumnReferencePbtxt)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 16);
+BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, eval_const_fused,
+                  ScalarExpressionEvaluatorType::kFused, kScalarInt64ValuePbtxt)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 16);
+BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_add_nested_fused,
+                  ScalarExpressionEvaluatorType::kFused, kAddScalarFuncNestedPbtxt)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 16);
+
+class BinUDF : public ScalarUDF {
+ public:
+  Int64Value Exec(FunctionContext*, Int64Value v, Int64Value size) {
+    return v.val - v.val % size.val;
+  }
+};
+
+class DivideUDF : public ScalarUDF {
+ public:
+  px::types::Float64Value Exec(FunctionContext*, Int64Value v1, px::types::Float64Value v2) {
+    return v1.val / v2.val;
+  }
+};
+
+class GreaterThanEqualUDF : public ScalarUDF {
+ public:
+  px::types::BoolValue Exec(FunctionContext*, Int64Value v1, Int64Value v2) {
+    return v1.val >= v2.val;
+  }
+};
+
+// The expressions of a typical PxL map over http_events, on columns [time_, latency, resp_status]:
+//   df.timestamp = px.bin(df.time_, px.seconds(10))
+//   df.latency_ms = df.latency / 1.0E6
+//   df.failure = df.resp_status >= 400
+//   df.time_ = df.time_
+constexpr char kBinTimePbtxt[] = R"(
+func {
+  name: "bin"
+  id: 0
+  args { column { node: 0 index: 0 } }
+  args { constant { data_type: INT64 int64_value: 10000000000 } }
+  args_data_types: INT64
+  args_data_types: INT64
+})";
+
+constexpr char kLatencyMsPbtxt[] = R"(
+func {
+  name: "divide"
+  id: 1
+  args { column { node: 0 index: 1 } }
+  args { constant { data_type: FLOAT64 float64_value: 1000000 } }
+  args_data_types: INT64
+  args_data_types: FLOAT64
+})";
+
+constexpr char kFailurePbtxt[] = R"(
+func {
+  name: "greaterThanEqual"
+  id: 2
+  args { column { node: 0 index: 2 } }
+  args { constant { data_type: INT64 int64_value: 400 } }
+  args_data_types: INT64
+  args_data_types: INT64
+})";
+
+// Evaluates the map expressions over batches of 1024 rows with a single evaluator, like MapNode.
+// NOLINTNEXTLINE : runtime/references.
+void BM_ScalarExpressionMapBatches(benchmark::State& state,
+                                   const ScalarExpressionEvaluatorType& eval_type) {
+  constexpr int64_t kBatchSize = 1024;
+  size_t num_batches = state.range(0);
+
+  ScalarExpressionVector exprs;
+  for (const char* pbtxt : {kBinTimePbtxt, kLatencyMsPbtxt, kFailurePbtxt, kColumnReferencePbtxt}) {
+    px::carnot::planpb::ScalarExpression se_pb;
+    CHECK(google::protobuf::TextFormat::MergeFromString(pbtxt, &se_pb));
+    auto s_or_se = px::carnot::plan::ScalarExpression::FromProto(se_pb);
+    CHECK(s_or_se.ok());
+    exprs.push_back(s_or_se.ConsumeValueOrDie());
+  }
+
+  auto func_registry = std::make_unique<Registry>("test_registry");
+  auto table_store = std::make_shared<px::table_store::TableStore>();
+  PX_CHECK_OK(func_registry->Register<BinUDF>("bin"));
+  PX_CHECK_OK(func_registry->Register<DivideUDF>("divide"));
+  PX_CHECK_OK(func_registry->Register<GreaterThanEqualUDF>("greaterThanEqual"));
+  auto exec_state = std::make_unique<ExecState>(
+      func_registry.get(), table_store, MockResultSinkStubGenerator, MockMetricsStubGenerator,
+      MockTraceStubGenerator, sole::uuid4(), nullptr);
+  PX_CHECK_OK(exec_state->AddScalarUDF(0, "bin", {DataType::INT64, DataType::INT64}));
+  PX_CHECK_OK(exec_state->AddScalarUDF(1, "divide", {DataType::INT64, DataType::FLOAT64}));
+  PX_CHECK_OK(exec_state->AddScalarUDF(2, "greaterThanEqual", {DataType::INT64, DataType::INT64}));
+
+  RowDescriptor rd({DataType::INT64, DataType::INT64, DataType::INT64});
+  std::vector<std::unique_ptr<RowBatch>> input_rbs;
+  for (size_t i = 0; i < num_batches; ++i) {
+    auto rb = std::make_unique<RowBatch>(rd, kBatchSize);
+    auto time_col = px::datagen::CreateLargeData<Int64Value>(kBatchSize, 0, 1L << 40);
+    auto latency_col = px::datagen::CreateLargeData<Int64Value>(kBatchSize, 0, 1000000000);
+    auto status_col = px::datagen::CreateLargeData<Int64Value>(kBatchSize, 200, 600);
+    PX_CHECK_OK(rb->AddColumn(ToArrow(time_col, arrow::default_memory_pool())));
+    PX_CHECK_OK(rb->AddColumn(ToArrow(latency_col, arrow::default_memory_pool())));
+    PX_CHECK_OK(rb->AddColumn(ToArrow(status_col, arrow::default_memory_pool())));
+    input_rbs.push_back(std::move(rb));
+  }
+
+  RowDescriptor rd_output({DataType::INT64, DataType::FLOAT64, DataType::BOOLEAN, DataType::INT64});
+  auto function_ctx = std::make_unique<px::carnot::udf::FunctionContext>(nullptr, nullptr);
+  auto evaluator = ScalarExpressionEvaluator::Create(
+      px::carnot::plan::ConstScalarExpressionVector(exprs.begin(), exprs.end()), eval_type,
+      function_ctx.get());
+  PX_CHECK_OK(evaluator->Open(exec_state.get()));
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    for (const auto& input_rb : input_rbs) {
+      RowBatch output_rb(rd_output, input_rb->num_rows());
+      PX_CHECK_OK(evaluator->Evaluate(exec_state.get(), *input_rb, &output_rb));
+      benchmark::DoNotOptimize(output_rb);
+    }
+  }
+  PX_CHECK_OK(evaluator->Close(exec_state.get()));
+  state.SetItemsProcessed(int64_t(state.iterations()) * num_batches * kBatchSize);
+}
+
+BENCHMARK_CAPTURE(BM_ScalarExpressionMapBatches, map_arrow,
+                  ScalarExpressionEvaluatorType::kArrowNative)
+    ->RangeMultiplier(4)
+    ->Range(1, 256);
+BENCHMARK_CAPTURE(BM_ScalarExpressionMapBatches, map_native,
+                  ScalarExpressionEvaluatorType::kVectorNative)
+    ->RangeMultiplier(4)
+    ->Range(1, 256);
+BENCHMARK_CAPTURE(BM_ScalarExpressionMapBatches, map_fused, ScalarExpressionEvaluatorType::kFused)
+    ->RangeMultiplier(4)
+    ->Range(1, 256);
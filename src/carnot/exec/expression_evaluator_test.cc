@@ -45,6 +45,7 @@ namespace exec {
 using px::carnot::planpb::testutils::kAddScalarFuncConstPbtxt;
 using px::carnot::planpb::testutils::kAddScalarFuncNestedPbtxt;
 using px::carnot::planpb::testutils::kAddScalarFuncPbtxt;
+using px::carnot::planpb::testutils::kColumnReferencePbtxt;
 using px::carnot::planpb::testutils::kScalarInt64ValuePbtxt;
 using px::carnot::planpb::testutils::kScalarUInt128ValuePbtxt;
 using table_store::schema::RowBatch;
@@ -158,7 +159,8 @@ class ScalarExpressionTest : public ::testing::TestWithParam<ScalarExpressionEva
 
 INSTANTIATE_TEST_SUITE_P(TestVecAndArrow, ScalarExpressionTest,
                          ::testing::Values(ScalarExpressionEvaluatorType::kVectorNative,
-                                           ScalarExpressionEvaluatorType::kArrowNative));
+                                           ScalarExpressionEvaluatorType::kArrowNative,
+                                           ScalarExpressionEvaluatorType::kFused));
 
 TEST_P(ScalarExpressionTest, basic_tests) {
   RowDescriptor rd_output({types::DataType::INT64});
@@ -270,6 +272,34 @@ TEST_P(ScalarExpressionTest, eval_init_arg_udf) {
   EXPECT_EQ("init_arg, 1234, c", casted->GetString(2));
 }
 
+TEST_P(ScalarExpressionTest, eval_multiple_exprs_multiple_batches) {
+  function_ctx_ = std::make_unique<udf::FunctionContext>(nullptr, nullptr);
+  auto evaluator = ScalarExpressionEvaluator::Create(
+      {AddScalarExpr(), ScalarExpressionOf(kAddScalarFuncConstPbtxt),
+       ScalarExpressionOf(kColumnReferencePbtxt)},
+      GetParam(), function_ctx_.get());
+  ASSERT_OK(evaluator->Open(exec_state_.get()));
+
+  RowDescriptor rd_output({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
+  RowBatch output_rb(rd_output, input_rb_->num_rows());
+  ASSERT_OK(evaluator->Evaluate(exec_state_.get(), *input_rb_, &output_rb));
+  EXPECT_TRUE(output_rb.ColumnAt(0)->Equals(
+      ToArrow(std::vector<types::Int64Value>({4, 6, 8}), arrow::default_memory_pool())));
+  EXPECT_TRUE(output_rb.ColumnAt(1)->Equals(
+      ToArrow(std::vector<types::Int64Value>({1338, 1339, 1340}), arrow::default_memory_pool())));
+  EXPECT_TRUE(output_rb.ColumnAt(2)->Equals(input_rb_->ColumnAt(0)));
+
+  // A smaller batch through the same evaluator.
+  ASSERT_OK_AND_ASSIGN(auto small_rb, input_rb_->Slice(1, 2));
+  RowBatch small_output_rb(rd_output, small_rb->num_rows());
+  ASSERT_OK(evaluator->Evaluate(exec_state_.get(), *small_rb, &small_output_rb));
+  EXPECT_TRUE(small_output_rb.ColumnAt(0)->Equals(
+      ToArrow(std::vector<types::Int64Value>({6, 8}), arrow::default_memory_pool())));
+  EXPECT_TRUE(small_output_rb.ColumnAt(1)->Equals(
+      ToArrow(std::vector<types::Int64Value>({1339, 1340}), arrow::default_memory_pool())));
+  EXPECT_OK(evaluator->Close(exec_state_.get()));
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/file_export_sink_node.h"
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+#include <absl/time/clock.h>
+#include <absl/time/time.h>
+
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/common/base/base.h"
+#include "src/common/zlib/zlib_wrapper.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::Relation;
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+namespace {
+
+std::string Hostname() {
+  char hostname[256] = {};
+  if (gethostname(hostname, sizeof(hostname) - 1) != 0) {
+    return "unknown";
+  }
+  return hostname;
+}
+
+}  // namespace
+
+std::string FileExportSinkNode::DebugStringImpl() {
+  return absl::Substitute("Exec::FileExportSinkNode: {table: $0, path: $1, input: $2}",
+                          plan_node_->table_name(), plan_node_->path(),
+                          input_descriptor_->DebugString());
+}
+
+Status FileExportSinkNode::InitImpl(const plan::Operator& plan_node) {
+  CHECK(plan_node.op_type() == planpb::OperatorType::FILE_EXPORT_SINK_OPERATOR);
+  const auto* sink_plan_node = static_cast<const plan::FileExportSinkOperator*>(&plan_node);
+  plan_node_ = std::make_unique<plan::FileExportSinkOperator>(*sink_plan_node);
+  if (input_descriptors_.size() != 1) {
+    return error::InvalidArgument(
+        "FileExportSink operator expects a single input relation, got $0",
+        input_descriptors_.size());
+  }
+  input_descriptor_ = std::make_unique<RowDescriptor>(input_descriptors_[0]);
+  for (int64_t idx : plan_node_->column_idxs()) {
+    if (idx >= static_cast<int64_t>(input_descriptor_->size())) {
+      return error::InvalidArgument("FileExportSink column index $0 is out of range for $1 columns",
+                                    idx, input_descriptor_->size());
+    }
+  }
+  std::vector<types::DataType> export_types;
+  for (int64_t idx : plan_node_->column_idxs()) {
+    export_types.push_back(input_descriptor_->type(idx));
+  }
+  export_descriptor_ = std::make_unique<RowDescriptor>(export_types);
+  node_name_ = plan_node_->node_name().empty() ? Hostname() : plan_node_->node_name();
+  return Status::OK();
+}
+
+Status FileExportSinkNode::PrepareImpl(ExecState*) {
+  Relation relation;
+  for (int64_t idx : plan_node_->column_idxs()) {
+    relation.AddColumn(input_descriptor_->type(idx), plan_node_->ColumnName(idx));
+  }
+  PX_RETURN_IF_ERROR(relation.ToProto(buffered_table_.mutable_relation()));
+  buffered_table_.set_name(plan_node_->table_name());
+  return Status::OK();
+}
+
+Status FileExportSinkNode::OpenImpl(ExecState*) { return Status::OK(); }
+
+Status FileExportSinkNode::CloseImpl(ExecState* exec_state) {
+  // A query that is cancelled before the end of its stream still exports what it buffered.
+  if (buffered_rows_ > 0) {
+    return Flush(exec_state);
+  }
+  return Status::OK();
+}
+
+Status FileExportSinkNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  if (rb.num_rows() > 0) {
+    // Only the exported columns are serialized, the others are never materialized.
+    auto output_rb = RowBatch::WithRowsOf(*export_descriptor_, rb);
+    for (int64_t idx : plan_node_->column_idxs()) {
+      PX_RETURN_IF_ERROR(output_rb->AddColumnFrom(rb, idx));
+    }
+    PX_RETURN_IF_ERROR(output_rb->ToPackedProto(buffered_table_.add_row_batches()));
+    buffered_rows_ += rb.num_rows();
+  }
+  if (buffered_rows_ >= plan_node_->row_group_rows() || (rb.eos() && buffered_rows_ > 0)) {
+    PX_RETURN_IF_ERROR(Flush(exec_state));
+  }
+  if (rb.eos()) {
+    sent_eos_ = true;
+  }
+  return Status::OK();
+}
+
+Status FileExportSinkNode::Flush(ExecState* exec_state) {
+  std::filesystem::path dir = std::filesystem::path(plan_node_->path()) /
+                              plan_node_->table_name() /
+                              absl::FormatTime("%Y%m%d%H", absl::Now(), absl::UTCTimeZone()) /
+                              node_name_;
+  std::error_code ec;
+  std::filesystem::create_directories(dir, ec);
+  if (ec) {
+    return error::Internal("Failed to create export directory $0: $1", dir.string(), ec.message());
+  }
+
+  PX_ASSIGN_OR_RETURN(std::string contents,
+                      zlib::Gzip(buffered_table_.SerializeAsString(), /*level*/ 1));
+  std::string file_name = absl::Substitute("$0-$1-$2.pb.gz", exec_state->query_id().str(),
+                                           plan_node_->id(), files_written_);
+  std::filesystem::path file = dir / file_name;
+  std::ofstream out(file, std::ios::binary | std::ios::trunc);
+  out.write(contents.data(), contents.size());
+  out.close();
+  if (!out) {
+    return error::Internal("Failed to write export file $0", file.string());
+  }
+
+  ++files_written_;
+  buffered_table_.clear_row_batches();
+  buffered_rows_ = 0;
+  return Status::OK();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
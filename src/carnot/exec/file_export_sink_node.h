@@ -0,0 +1,76 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/plan/operators.h"
+#include "src/common/base/base.h"
+#include "src/common/base/status.h"
+#include "src/table_store/schemapb/schema.pb.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * FileExportSinkNode writes the row batches it consumes to files under the path of its plan node,
+ * partitioned as <path>/<table_name>/<YYYYMMDDHH>/<node_name>/. Row batches are buffered until
+ * row_group_rows rows (or the end of the stream) are reached, so that each file holds a large
+ * group of rows rather than one small file per row batch.
+ */
+class FileExportSinkNode : public SinkNode {
+ public:
+  FileExportSinkNode() = default;
+  virtual ~FileExportSinkNode() = default;
+
+  // The number of files written so far.
+  int64_t files_written() const { return files_written_; }
+
+ protected:
+  std::string DebugStringImpl() override;
+  Status InitImpl(const plan::Operator& plan_node) override;
+  Status PrepareImpl(ExecState* exec_state) override;
+  Status OpenImpl(ExecState* exec_state) override;
+  Status CloseImpl(ExecState* exec_state) override;
+  Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                         size_t parent_index) override;
+
+ private:
+  Status Flush(ExecState* exec_state);
+
+  std::unique_ptr<plan::FileExportSinkOperator> plan_node_;
+  std::unique_ptr<table_store::schema::RowDescriptor> input_descriptor_;
+  // The descriptor of the exported columns.
+  std::unique_ptr<table_store::schema::RowDescriptor> export_descriptor_;
+  std::string node_name_;
+
+  // The table of the file being buffered, and the number of rows in it.
+  table_store::schemapb::Table buffered_table_;
+  int64_t buffered_rows_ = 0;
+  int64_t files_written_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/file_export_sink_node.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+#include <google/protobuf/text_format.h>
+#include <gtest/gtest.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/testing/testing.h"
+#include "src/common/zlib/zlib_wrapper.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/schemapb/schema.pb.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+class FileExportSinkNodeTest : public ::testing::Test {
+ public:
+  FileExportSinkNodeTest() {
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    auto table_store = std::make_shared<table_store::TableStore>();
+    exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
+                                              MockResultSinkStubGenerator, MockMetricsStubGenerator,
+                                              MockTraceStubGenerator, sole::uuid4(), nullptr);
+  }
+
+ protected:
+  std::unique_ptr<plan::FileExportSinkOperator> CreatePlanNode(int64_t row_group_rows) {
+    std::string operator_pb_txt = absl::Substitute(R"(
+path: "$0"
+table_name: "http_events"
+node_name: "node-1"
+column_idxs: 2
+column_idxs: 0
+column_names: "time_"
+column_names: "upid"
+column_names: "latency"
+row_group_rows: $1)",
+                                                   temp_dir_.path().string(), row_group_rows);
+    planpb::FileExportSinkOperator pb;
+    EXPECT_TRUE(google::protobuf::TextFormat::ParseFromString(operator_pb_txt, &pb));
+    auto plan_node = std::make_unique<plan::FileExportSinkOperator>(1);
+    EXPECT_OK(plan_node->Init(pb));
+    return plan_node;
+  }
+
+  // Reads all the exported files, in the order in which they were written.
+  std::vector<table_store::schemapb::Table> ReadExportedTables() {
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(temp_dir_.path())) {
+      if (entry.is_regular_file()) {
+        files.push_back(entry.path());
+      }
+    }
+    std::sort(files.begin(), files.end());
+    std::vector<table_store::schemapb::Table> tables;
+    for (const auto& file : files) {
+      EXPECT_EQ(file.parent_path().filename(), "node-1");
+      EXPECT_EQ(file.parent_path().parent_path().parent_path().filename(), "http_events");
+      std::string contents = ReadFileToString(file).ConsumeValueOrDie();
+      std::string serialized = zlib::Inflate(contents).ConsumeValueOrDie();
+      EXPECT_TRUE(tables.emplace_back().ParseFromString(serialized));
+    }
+    return tables;
+  }
+
+  px::testing::TempDir temp_dir_;
+  std::unique_ptr<ExecState> exec_state_;
+  std::unique_ptr<udf::Registry> func_registry_;
+};
+
+TEST_F(FileExportSinkNodeTest, buffers_until_eos) {
+  auto plan_node = CreatePlanNode(/*row_group_rows*/ 100);
+  RowDescriptor input_rd({types::TIME64NS, types::INT64, types::FLOAT64});
+  auto tester = exec::ExecNodeTester<FileExportSinkNode, plan::FileExportSinkOperator>(
+      *plan_node, RowDescriptor({}), {input_rd}, exec_state_.get());
+
+  tester.ConsumeNext(RowBatchBuilder(input_rd, 2, /*eow*/ false, /*eos*/ false)
+                         .AddColumn<types::Time64NSValue>({1, 2})
+                         .AddColumn<types::Int64Value>({10, 20})
+                         .AddColumn<types::Float64Value>({0.5, 1.5})
+                         .get(),
+                     /*parent_id*/ 0, /*child_called_times*/ 0);
+  EXPECT_TRUE(ReadExportedTables().empty());
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 1, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Time64NSValue>({3})
+                       .AddColumn<types::Int64Value>({30})
+                       .AddColumn<types::Float64Value>({2.5})
+                       .get(),
+                   /*parent_id*/ 0, /*child_called_times*/ 0)
+      .Close();
+
+  auto tables = ReadExportedTables();
+  ASSERT_EQ(1, tables.size());
+  EXPECT_EQ("http_events", tables[0].name());
+  // Only the selected columns are exported, in the order of the column indexes.
+  ASSERT_EQ(2, tables[0].relation().columns_size());
+  EXPECT_EQ("latency", tables[0].relation().columns(0).column_name());
+  EXPECT_EQ("time_", tables[0].relation().columns(1).column_name());
+  ASSERT_EQ(2, tables[0].row_batches_size());
+
+  auto rb = RowBatch::FromProto(tables[0].row_batches(1)).ConsumeValueOrDie();
+  EXPECT_EQ(1, rb->num_rows());
+  EXPECT_EQ(types::DataType::FLOAT64, rb->desc().type(0));
+  EXPECT_EQ(types::DataType::TIME64NS, rb->desc().type(1));
+  EXPECT_TRUE(rb->ColumnAt(0)->Equals(types::ToArrow(std::vector<types::Float64Value>{2.5},
+                                                     arrow::default_memory_pool())));
+}
+
+TEST_F(FileExportSinkNodeTest, writes_a_file_per_row_group) {
+  auto plan_node = CreatePlanNode(/*row_group_rows*/ 2);
+  RowDescriptor input_rd({types::TIME64NS, types::INT64, types::FLOAT64});
+  auto tester = exec::ExecNodeTester<FileExportSinkNode, plan::FileExportSinkOperator>(
+      *plan_node, RowDescriptor({}), {input_rd}, exec_state_.get());
+
+  for (int i = 0; i < 3; ++i) {
+    tester.ConsumeNext(RowBatchBuilder(input_rd, 1, /*eow*/ i == 2, /*eos*/ i == 2)
+                           .AddColumn<types::Time64NSValue>({i})
+                           .AddColumn<types::Int64Value>({i})
+                           .AddColumn<types::Float64Value>({0.5})
+                           .get(),
+                       /*parent_id*/ 0, /*child_called_times*/ 0);
+  }
+  tester.Close();
+
+  auto tables = ReadExportedTables();
+  ASSERT_EQ(2, tables.size());
+  EXPECT_EQ(2, tables[0].row_batches_size());
+  EXPECT_EQ(1, tables[1].row_batches_size());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -75,60 +75,6 @@ Status FilterNode::CloseImpl(ExecState* exec_state) {
   return Status::OK();
 }
 
-template <types::DataType T>
-Status PredicateCopyValues(const types::BoolValueColumnWrapper& pred, const arrow::Array* input_col,
-                           RowBatch* output_rb) {
-  DCHECK_EQ(pred.Size(), static_cast<size_t>(input_col->length()));
-  size_t num_output_records = output_rb->num_rows();
-  size_t num_input_records = input_col->length();
-  auto output_col_builder_generic = MakeArrowBuilder(T, arrow::default_memory_pool());
-  auto* output_col_builder = static_cast<typename types::DataTypeTraits<T>::arrow_builder_type*>(
-      output_col_builder_generic.get());
-  PX_RETURN_IF_ERROR(output_col_builder->Reserve(num_output_records));
-  for (size_t idx = 0; idx < num_input_records; ++idx) {
-    if (udf::UnWrap(pred[idx])) {
-      output_col_builder->UnsafeAppend(types::GetValueFromArrowArray<T>(input_col, idx));
-    }
-  }
-  std::shared_ptr<arrow::Array> output_array;
-  PX_RETURN_IF_ERROR(output_col_builder->Finish(&output_array));
-  PX_RETURN_IF_ERROR(output_rb->AddColumn(output_array));
-  return Status::OK();
-}
-
-template <>
-Status PredicateCopyValues<types::STRING>(const types::BoolValueColumnWrapper& pred,
-                                          const arrow::Array* input_col, RowBatch* output_rb) {
-  DCHECK_EQ(pred.Size(), static_cast<size_t>(input_col->length()));
-  size_t num_output_records = output_rb->num_rows();
-  size_t num_input_records = input_col->length();
-  size_t reserved =
-      100;  // This can be an arbritrary number, since we do exponential doubling below.
-  size_t total_size = 0;
-
-  auto output_col_builder_generic = MakeArrowBuilder(types::STRING, arrow::default_memory_pool());
-  auto* output_col_builder = static_cast<types::DataTypeTraits<types::STRING>::arrow_builder_type*>(
-      output_col_builder_generic.get());
-
-  PX_RETURN_IF_ERROR(output_col_builder->Reserve(num_output_records));
-  PX_RETURN_IF_ERROR(output_col_builder->ReserveData(reserved));
-  for (size_t idx = 0; idx < num_input_records; ++idx) {
-    if (udf::UnWrap(pred[idx])) {
-      auto res = types::GetValueFromArrowArray<types::STRING>(input_col, idx);
-      total_size += res.size();
-      while (total_size >= reserved) {
-        reserved *= 2;
-      }
-      PX_RETURN_IF_ERROR(output_col_builder->ReserveData(reserved));
-      output_col_builder->UnsafeAppend(std::move(res));
-    }
-  }
-  std::shared_ptr<arrow::Array> output_array;
-  PX_RETURN_IF_ERROR(output_col_builder->Finish(&output_array));
-  PX_RETURN_IF_ERROR(output_rb->AddColumn(output_array));
-  return Status::OK();
-}
-
 Status FilterNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
   // Current implementation does not merge across row batches, we should
   // consider this for cases where the filter has really low selectivity.
@@ -144,29 +90,33 @@ Status FilterNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, si
 
   DCHECK_EQ(static_cast<size_t>(rb.num_rows()), num_pred);
 
-  // Find out how many of them returned true;
-  size_t num_output_records = 0;
+  // Only the indices of the rows that passed are recorded. The output is a view over the input
+  // columns, so columns that aren't read downstream are never copied.
+  std::vector<int64_t> selected_rows;
+  selected_rows.reserve(num_pred);
   for (size_t i = 0; i < num_pred; ++i) {
     if (pred_col_wrapper[i].val) {
-      ++num_output_records;
+      selected_rows.push_back(i);
     }
   }
-
-  RowBatch output_rb(*output_descriptor_, num_output_records);
   DCHECK_EQ(output_descriptor_->size(), plan_node_->selected_cols().size());
 
-  for (const auto& [output_col_idx, input_col_idx] : Enumerate(plan_node_->selected_cols())) {
-    auto input_col = rb.ColumnAt(input_col_idx);
-    auto col_type = output_descriptor_->type(output_col_idx);
-#define TYPE_CASE(_dt_) \
-  PX_RETURN_IF_ERROR(PredicateCopyValues<_dt_>(pred_col_wrapper, input_col.get(), &output_rb));
-    PX_SWITCH_FOREACH_DATATYPE(col_type, TYPE_CASE);
-#undef TYPE_CASE
+  // When every row passes there is nothing to select, unless the input is itself already a view.
+  if (selected_rows.size() == num_pred && !rb.has_selection()) {
+    RowBatch output_rb(*output_descriptor_, rb.num_rows());
+    for (auto input_col_idx : plan_node_->selected_cols()) {
+      PX_RETURN_IF_ERROR(output_rb.AddColumn(rb.ColumnAt(input_col_idx)));
+    }
+    output_rb.set_eow(rb.eow());
+    output_rb.set_eos(rb.eos());
+    return SendRowBatchToChildren(exec_state, output_rb);
   }
 
-  output_rb.set_eow(rb.eow());
-  output_rb.set_eos(rb.eos());
-  PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+  PX_ASSIGN_OR_RETURN(auto output_rb,
+                      rb.Select(plan_node_->selected_cols(), std::move(selected_rows)));
+  output_rb->set_eow(rb.eow());
+  output_rb->set_eos(rb.eos());
+  PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, *output_rb));
   return Status::OK();
 }
 
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/flow_control_window.h"
+
+#include <absl/time/time.h>
+
+DEFINE_int64(carnot_grpc_router_source_window_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_GRPC_ROUTER_SOURCE_WINDOW_BYTES", 16 * 1024 * 1024),
+             "The number of bytes of row batches that can be queued for each GRPC source of a "
+             "query before the router stops reading from the sending sink. 0 disables the limit.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+// How often a blocked Acquire checks whether it was cancelled.
+constexpr absl::Duration kCancellationPollInterval = absl::Milliseconds(100);
+
+bool FlowControlWindow::HasRoom(int64_t bytes) const {
+  return closed_ || window_bytes_ <= 0 || buffered_bytes_ == 0 ||
+         buffered_bytes_ + bytes <= window_bytes_;
+}
+
+bool FlowControlWindow::Acquire(int64_t bytes, const std::function<bool()>& cancelled) {
+  absl::MutexLock lock(&lock_);
+  while (!HasRoom(bytes)) {
+    if (cancelled()) {
+      return false;
+    }
+    room_cv_.WaitWithTimeout(&lock_, kCancellationPollInterval);
+  }
+  buffered_bytes_ += bytes;
+  return true;
+}
+
+void FlowControlWindow::Release(int64_t bytes) {
+  absl::MutexLock lock(&lock_);
+  buffered_bytes_ -= bytes;
+  DCHECK_GE(buffered_bytes_, 0);
+  room_cv_.SignalAll();
+}
+
+void FlowControlWindow::Close() {
+  absl::MutexLock lock(&lock_);
+  closed_ = true;
+  room_cv_.SignalAll();
+}
+
+int64_t FlowControlWindow::buffered_bytes() const {
+  absl::MutexLock lock(&lock_);
+  return buffered_bytes_;
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <functional>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/common/base/base.h"
+
+DECLARE_int64(carnot_grpc_router_source_window_bytes);
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * A byte window for the row batches that have been received for a GRPCSourceNode but not yet
+ * consumed by it. The GRPCRouter acquires space in the window before it queues a batch and the
+ * source node releases it when it pops the batch.
+ *
+ * Acquire blocks while the window is full. Since the router then stops reading from the
+ * result stream, gRPC's flow control blocks the writes of the GRPCSinkNode on the other end,
+ * which in turn stops that fragment from pulling more data out of its sources.
+ */
+class FlowControlWindow {
+ public:
+  // A window of zero or fewer bytes never blocks.
+  explicit FlowControlWindow(int64_t window_bytes) : window_bytes_(window_bytes) {}
+
+  /**
+   * Waits until `bytes` fit in the window and adds them to it. A batch is always admitted into
+   * an empty window, so batches larger than the window still make progress.
+   * @param cancelled polled while waiting; the wait is abandoned once it returns true.
+   * @return false if the wait was cancelled.
+   */
+  bool Acquire(int64_t bytes, const std::function<bool()>& cancelled) ABSL_LOCKS_EXCLUDED(lock_);
+
+  void Release(int64_t bytes) ABSL_LOCKS_EXCLUDED(lock_);
+
+  /**
+   * Stops the window from blocking, for when its source node has gone away and nothing is going
+   * to release the buffered bytes.
+   */
+  void Close() ABSL_LOCKS_EXCLUDED(lock_);
+
+  int64_t buffered_bytes() const ABSL_LOCKS_EXCLUDED(lock_);
+
+ private:
+  bool HasRoom(int64_t bytes) const ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const int64_t window_bytes_;
+  mutable absl::Mutex lock_;
+  absl::CondVar room_cv_;
+  int64_t buffered_bytes_ ABSL_GUARDED_BY(lock_) = 0;
+  bool closed_ ABSL_GUARDED_BY(lock_) = false;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/flow_control_window.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+const auto NotCancelled = [] { return false; };
+
+TEST(FlowControlWindowTest, acquire_blocks_until_release) {
+  FlowControlWindow window(100);
+  EXPECT_TRUE(window.Acquire(60, NotCancelled));
+  EXPECT_TRUE(window.Acquire(40, NotCancelled));
+  EXPECT_EQ(100, window.buffered_bytes());
+
+  std::atomic<bool> acquired = false;
+  std::thread producer([&] {
+    EXPECT_TRUE(window.Acquire(50, NotCancelled));
+    acquired = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(acquired);
+
+  window.Release(60);
+  producer.join();
+  EXPECT_TRUE(acquired);
+  EXPECT_EQ(90, window.buffered_bytes());
+}
+
+TEST(FlowControlWindowTest, empty_window_admits_large_batch) {
+  FlowControlWindow window(100);
+  EXPECT_TRUE(window.Acquire(1000, NotCancelled));
+  EXPECT_EQ(1000, window.buffered_bytes());
+}
+
+TEST(FlowControlWindowTest, unbounded) {
+  FlowControlWindow window(0);
+  EXPECT_TRUE(window.Acquire(1000, NotCancelled));
+  EXPECT_TRUE(window.Acquire(1000, NotCancelled));
+}
+
+TEST(FlowControlWindowTest, cancel_and_close) {
+  FlowControlWindow window(100);
+  EXPECT_TRUE(window.Acquire(100, NotCancelled));
+
+  std::atomic<bool> cancelled = false;
+  std::thread cancelled_producer([&] {
+    EXPECT_FALSE(window.Acquire(10, [&] { return cancelled.load(); }));
+  });
+  cancelled = true;
+  cancelled_producer.join();
+  EXPECT_EQ(100, window.buffered_bytes());
+
+  std::thread closed_producer([&] { EXPECT_TRUE(window.Acquire(10, NotCancelled)); });
+  window.Close();
+  closed_producer.join();
+  EXPECT_EQ(110, window.buffered_bytes());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -25,6 +25,7 @@
 
 #include <absl/base/internal/spinlock.h>
 #include <absl/container/flat_hash_map.h>
+#include <absl/strings/substitute.h>
 #include <grpcpp/grpcpp.h>
 
 #include "src/carnot/exec/grpc_source_node.h"
@@ -41,8 +42,15 @@ GRPCRouter::SourceNodeTracker* GRPCRouter::GetSourceNodeTracker(QueryTracker* qu
   return &query_tracker->source_node_trackers[source_id];
 }
 
+bool GRPCRouter::SourceStopped(QueryTracker* query_tracker, int64_t source_id) {
+  absl::base_internal::SpinLockHolder query_lock(&query_tracker->query_lock);
+  auto it = query_tracker->source_node_trackers.find(source_id);
+  return it != query_tracker->source_node_trackers.end() && it->second.stop_sending;
+}
+
 Status GRPCRouter::EnqueueRowBatch(QueryTracker* query_tracker,
-                                   std::unique_ptr<carnotpb::TransferResultChunkRequest> req) {
+                                   std::unique_ptr<carnotpb::TransferResultChunkRequest> req,
+                                   ::grpc::ServerContext* context) {
   if (!req->has_query_result() || !req->query_result().has_row_batch() ||
       req->query_result().destination_case() !=
           carnotpb::TransferResultChunkRequest_SinkResult::DestinationCase::kGrpcSourceId) {
@@ -51,7 +59,14 @@ Status GRPCRouter::EnqueueRowBatch(QueryTracker* query_tracker,
         "with a GPRC source ID.");
   }
 
-  auto snt = GetSourceNodeTracker(query_tracker, req->query_result().grpc_source_id());
+  auto source_id = req->query_result().grpc_source_id();
+  // Waiting for room here stops this stream from being read, which pushes back on the sink.
+  auto window = GetSourceNodeTracker(query_tracker, source_id)->window;
+  if (!window->Acquire(req->ByteSizeLong(), [context] { return context->IsCancelled(); })) {
+    return error::Cancelled("Result stream for GRPC source $0 was cancelled", source_id);
+  }
+
+  auto snt = GetSourceNodeTracker(query_tracker, source_id);
   {
     absl::base_internal::SpinLockHolder snt_lock(&snt->node_lock);
     // It's possible that we see row batches before we have gotten information about the query. To
@@ -64,23 +79,26 @@ Status GRPCRouter::EnqueueRowBatch(QueryTracker* query_tracker,
     snt->source_node->set_upstream_initiated_connection();
     PX_RETURN_IF_ERROR(snt->source_node->EnqueueRowBatch(std::move(req)));
   }
-  query_tracker->RestartExecution();
+  query_tracker->RestartExecution(source_id);
   return Status::OK();
 }
 
 void GRPCRouter::MarkResultStreamClosed(QueryTracker* query_tracker, int64_t source_id) {
   auto snt = GetSourceNodeTracker(query_tracker, source_id);
-  absl::base_internal::SpinLockHolder snt_lock(&snt->node_lock);
-  // It's possible that we see row batches before we have gotten information about the query. To
-  // solve this race, We store a backlog of all the pending batches.
-  if (snt->source_node == nullptr) {
-    DCHECK(!snt->connection_closed_by_sink);
-    snt->connection_closed_by_sink = true;
-    return;
+  {
+    absl::base_internal::SpinLockHolder snt_lock(&snt->node_lock);
+    // It's possible that we see row batches before we have gotten information about the query. To
+    // solve this race, We store a backlog of all the pending batches.
+    if (snt->source_node == nullptr) {
+      DCHECK(!snt->connection_closed_by_sink);
+      snt->connection_closed_by_sink = true;
+      return;
+    }
+    DCHECK(!snt->source_node->upstream_closed_connection());
+    snt->source_node->set_upstream_closed_connection();
   }
-  DCHECK(!snt->source_node->upstream_closed_connection());
-  snt->source_node->set_upstream_closed_connection();
-  return;
+  // Wake up the source's pipeline, so that it notices the closed connection right away.
+  query_tracker->RestartExecution(source_id);
 }
 
 // For all inbound result streams, we want to register the context of the stream,
@@ -98,6 +116,7 @@ void GRPCRouter::MarkResultStreamContextAsComplete(QueryTracker* query_tracker,
                                                    ::grpc::ServerContext* context) {
   absl::base_internal::SpinLockHolder lock(&query_tracker->query_lock);
   query_tracker->active_agent_contexts.erase(context);
+  query_tracker->context_source_ids.erase(context);
 }
 
 ::grpc::Status GRPCRouter::HandleTransferResultChunkMessage(
@@ -139,9 +158,25 @@ void GRPCRouter::MarkResultStreamContextAsComplete(QueryTracker* query_tracker,
     return ::grpc::Status::OK;
   }
   if (req->has_query_result() && req->query_result().has_row_batch()) {
-    state->stream_has_query_results = true;
-    state->source_node_id = req->query_result().grpc_source_id();
-    auto s = EnqueueRowBatch(state->query_tracker.get(), std::move(req));
+    if (!state->stream_has_query_results) {
+      state->stream_has_query_results = true;
+      state->source_node_id = req->query_result().grpc_source_id();
+      absl::base_internal::SpinLockHolder query_lock(&state->query_tracker->query_lock);
+      state->query_tracker->context_source_ids[context] = state->source_node_id;
+    }
+    if (SourceStopped(state->query_tracker.get(), state->source_node_id)) {
+      state->stop_sending = true;
+      return ::grpc::Status::OK;
+    }
+    auto s = EnqueueRowBatch(state->query_tracker.get(), std::move(req), context);
+    if (error::IsCancelled(s)) {
+      // The source may have been stopped while this stream waited for room in its window.
+      if (SourceStopped(state->query_tracker.get(), state->source_node_id)) {
+        state->stop_sending = true;
+        return ::grpc::Status::OK;
+      }
+      return ::grpc::Status(grpc::StatusCode::CANCELLED, s.msg());
+    }
     if (!s.ok()) {
       return ::grpc::Status(grpc::StatusCode::INTERNAL, "failed to enqueue batch");
     }
@@ -176,7 +211,7 @@ std::vector<statuspb::Status> GRPCRouter::GetIncomingWorkerErrors(const sole::uu
   TransferResultChunkState state;
   while (reader->Read(req.get())) {
     result_status = HandleTransferResultChunkMessage(std::move(req), context, &state);
-    if (!result_status.ok()) {
+    if (!result_status.ok() || state.stop_sending) {
       break;
     }
     req = std::make_unique<carnotpb::TransferResultChunkRequest>();
@@ -195,6 +230,13 @@ std::vector<statuspb::Status> GRPCRouter::GetIncomingWorkerErrors(const sole::uu
     return ::grpc::Status::OK;
   }
 
+  if (state.stop_sending) {
+    // Ending the stream here, while the sink is still writing, is what stops the sink.
+    response->set_success(true);
+    response->set_stop_sending(true);
+    return ::grpc::Status::OK;
+  }
+
   if (state.stream_has_query_results) {
     MarkResultStreamClosed(state.query_tracker.get(), state.source_node_id);
   }
@@ -218,12 +260,13 @@ Status GRPCRouter::AddGRPCSourceNode(sole::uuid query_id, int64_t source_id,
 
   {
     absl::base_internal::SpinLockHolder lock(&query_tracker->query_lock);
-    query_tracker->restart_execution_func_ = std::move(restart_execution);
+    query_tracker->restart_execution_funcs_[source_id] = std::move(restart_execution);
   }
   auto snt = GetSourceNodeTracker(query_tracker.get(), source_id);
 
   absl::base_internal::SpinLockHolder snt_lock(&snt->node_lock);
   snt->source_node = source_node;
+  source_node->set_flow_control_window(snt->window);
   if (snt->connection_initiated_by_sink) {
     source_node->set_upstream_initiated_connection();
   }
@@ -275,10 +318,34 @@ Status GRPCRouter::DeleteGRPCSourceNode(sole::uuid query_id, int64_t source_id)
     return error::Internal("Query map for query ID $0 does not contain GRPC source $1",
                            query_id.str(), source_id);
   }
+  // Wake up any stream waiting for the deleted source node to consume its data.
+  it->second.window->Close();
   query_tracker->source_node_trackers.erase(it);
   return Status::OK();
 }
 
+void GRPCRouter::StopSourceStreams(sole::uuid query_id, int64_t source_id) {
+  std::shared_ptr<QueryTracker> query_tracker;
+  {
+    absl::base_internal::SpinLockHolder lock(&id_to_query_tracker_map_lock_);
+    auto it = id_to_query_tracker_map_.find(query_id);
+    if (it == id_to_query_tracker_map_.end()) {
+      return;
+    }
+    query_tracker = it->second;
+  }
+  absl::base_internal::SpinLockHolder lock(&query_tracker->query_lock);
+  auto it = query_tracker->source_node_trackers.find(source_id);
+  if (it == query_tracker->source_node_trackers.end()) {
+    return;
+  }
+  VLOG(1) << absl::Substitute("Stopping the result streams to GRPC source $0 of query $1",
+                              source_id, query_id.str());
+  it->second.stop_sending = true;
+  // Wake up any stream waiting for the source to consume its data, so it ends right away.
+  it->second.window->Close();
+}
+
 void GRPCRouter::DeleteQuery(sole::uuid query_id) {
   VLOG(1) << "Deleting query ID from GRPC Router: " << query_id.str();
   std::shared_ptr<QueryTracker> query_tracker;
@@ -294,9 +361,21 @@ void GRPCRouter::DeleteQuery(sole::uuid query_id) {
     id_to_query_tracker_map_.erase(it);
   }
   absl::base_internal::SpinLockHolder lock(&query_tracker->query_lock);
-  query_tracker->ResetRestartExecutionFunc();
-  // For any active input streams for this query, mark their context as cancelled.
+  query_tracker->ResetRestartExecutionFuncs();
+  for (auto& entry : query_tracker->source_node_trackers) {
+    entry.second.window->Close();
+  }
+  // For any active input streams for this query, mark their context as cancelled. Streams to
+  // stopped sources are left to end with stop_sending when their sink sends its next request,
+  // so that the sink stops cleanly instead of failing its query.
   for (auto ctx : query_tracker->active_agent_contexts) {
+    auto source_it = query_tracker->context_source_ids.find(ctx);
+    if (source_it != query_tracker->context_source_ids.end()) {
+      auto snt_it = query_tracker->source_node_trackers.find(source_it->second);
+      if (snt_it != query_tracker->source_node_trackers.end() && snt_it->second.stop_sending) {
+        continue;
+      }
+    }
     ctx->TryCancel();
   }
 }
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <string>
@@ -35,6 +36,7 @@
 
 #include "src/carnot/carnotpb/carnot.grpc.pb.h"
 #include "src/carnot/carnotpb/carnot.pb.h"
+#include "src/carnot/exec/flow_control_window.h"
 #include "src/common/base/base.h"
 #include "src/common/base/statuspb/status.pb.h"
 #include "src/common/uuid/uuid.h"
@@ -62,7 +64,8 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
 
   /**
    * Adds the specified source node to the router. Includes a function that should be called to
-   * retrigger execution of the graph if currently yielded.
+   * retrigger execution of the graph if currently yielded. It's called when a row batch is queued
+   * to this source, or its upstream closes the connection.
    */
   Status AddGRPCSourceNode(sole::uuid query_id, int64_t source_id, GRPCSourceNode* source_node,
                            std::function<void()> restart_execution);
@@ -80,6 +83,14 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
    */
   Status DeleteGRPCSourceNode(sole::uuid query_id, int64_t source_id);
 
+  /**
+   * Ends the result streams to a source node once it needs no more data, such as when a limit
+   * downstream of it has been reached. The sinks of the streams are told to stop sending, which
+   * stops their fragments instead of having them run to completion. Stopping a source that
+   * isn't a GRPC source of the query is ignored.
+   */
+  void StopSourceStreams(sole::uuid query_id, int64_t source_id);
+
   /**
    * @brief Get any errors that may have occured in the incoming worker nodes.
    *
@@ -109,13 +120,19 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
    * for the source node.
    */
   struct SourceNodeTracker {
-    SourceNodeTracker() = default;
+    SourceNodeTracker()
+        : window(
+              std::make_shared<FlowControlWindow>(FLAGS_carnot_grpc_router_source_window_bytes)) {}
+    // Bounds the bytes queued for the source node, whether in the backlog or in its own queue.
+    const std::shared_ptr<FlowControlWindow> window;
     GRPCSourceNode* source_node GUARDED_BY(node_lock) = nullptr;
     // connection_initiated_by_sink and connection_closed_by_sink are true when the
     // grpc sink (aka the client) initiates the query result stream or closes a query result stream,
     // respectively.
     bool connection_initiated_by_sink GUARDED_BY(node_lock) = false;
     bool connection_closed_by_sink GUARDED_BY(node_lock) = false;
+    // Set by StopSourceStreams. The streams to this source are ended with stop_sending.
+    std::atomic<bool> stop_sending = false;
     std::vector<std::unique_ptr<::px::carnotpb::TransferResultChunkRequest>> response_backlog
         GUARDED_BY(node_lock);
     absl::base_internal::SpinLock node_lock;
@@ -128,10 +145,15 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
     QueryTracker() : create_time(std::chrono::steady_clock::now()) {}
     absl::node_hash_map<int64_t, SourceNodeTracker> source_node_trackers GUARDED_BY(query_lock);
     const std::chrono::steady_clock::time_point create_time GUARDED_BY(query_lock);
-    std::function<void()> restart_execution_func_ GUARDED_BY(query_lock);
+    // The function that wakes up the execution of each source, so that a row batch only wakes up
+    // the pipeline that reads it.
+    absl::flat_hash_map<int64_t, std::function<void()>> restart_execution_funcs_
+        GUARDED_BY(query_lock);
     // The set of agents we've seen for the query.
     absl::flat_hash_set<sole::uuid> seen_agents GUARDED_BY(query_lock);
     absl::flat_hash_set<::grpc::ServerContext*> active_agent_contexts GUARDED_BY(query_lock);
+    // The source that each active stream sends to, once it has sent its first row batch.
+    absl::flat_hash_map<::grpc::ServerContext*, int64_t> context_source_ids GUARDED_BY(query_lock);
     // The execution stats for agents that are clients to this service.
     std::vector<queryresultspb::AgentExecutionStats> agent_exec_stats GUARDED_BY(query_lock);
 
@@ -139,15 +161,18 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
     std::vector<statuspb::Status> upstream_exec_errors GUARDED_BY(query_lock);
     absl::base_internal::SpinLock query_lock;
 
-    void ResetRestartExecutionFunc() ABSL_EXCLUSIVE_LOCKS_REQUIRED(query_lock) {
-      restart_execution_func_ = std::function<void()>();
+    void ResetRestartExecutionFuncs() ABSL_EXCLUSIVE_LOCKS_REQUIRED(query_lock) {
+      restart_execution_funcs_.clear();
     }
 
-    void RestartExecution() {
+    void RestartExecution(int64_t source_id) {
       std::function<void()> restart_func;
       {
         absl::base_internal::SpinLockHolder lock(&query_lock);
-        restart_func = restart_execution_func_;
+        auto it = restart_execution_funcs_.find(source_id);
+        if (it != restart_execution_funcs_.end()) {
+          restart_func = it->second;
+        }
       }
       // Check that restart_func is not an empty function.
       if (restart_func) {
@@ -157,7 +182,8 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
   };
 
   Status EnqueueRowBatch(QueryTracker* query_tracker,
-                         std::unique_ptr<carnotpb::TransferResultChunkRequest> req);
+                         std::unique_ptr<carnotpb::TransferResultChunkRequest> req,
+                         ::grpc::ServerContext* context);
 
   struct TransferResultChunkState {
     int64_t source_node_id = 0;
@@ -165,6 +191,8 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
     // stream_has_query_results informs downstream source nodes about the health of the stream.
     // When true, the particular TransferResultChunk call has initiated the query stream.
     bool stream_has_query_results = false;
+    // Set when the source of the stream was stopped, which ends the stream.
+    bool stop_sending = false;
     std::shared_ptr<QueryTracker> query_tracker = nullptr;
   };
   ::grpc::Status HandleTransferResultChunkMessage(
@@ -176,6 +204,7 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
   void MarkResultStreamContextAsComplete(QueryTracker* query_tracker,
                                          ::grpc::ServerContext* context);
   SourceNodeTracker* GetSourceNodeTracker(QueryTracker* query_tracker, int64_t source_id);
+  bool SourceStopped(QueryTracker* query_tracker, int64_t source_id);
 
   absl::node_hash_map<sole::uuid, std::shared_ptr<QueryTracker>> id_to_query_tracker_map_
       GUARDED_BY(id_to_query_tracker_map_lock_);
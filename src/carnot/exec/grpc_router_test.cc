@@ -19,6 +19,7 @@
 #include "src/carnot/exec/grpc_router.h"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <string>
 #include <thread>
@@ -512,6 +513,59 @@ TEST_F(GRPCRouterTest, delete_query_router_test) {
   EXPECT_EQ(0, service_->NumQueriesTracking());
 }
 
+TEST_F(GRPCRouterTest, stop_source_streams_test) {
+  int64_t grpc_source_node_id = 1;
+  auto query_id = sole::uuid4();
+
+  RowDescriptor input_rd({types::DataType::INT64});
+  auto op_proto = planpb::testutils::CreateTestGRPCSource1PB();
+  std::unique_ptr<px::carnot::plan::Operator> plan_node =
+      plan::GRPCSourceOperator::FromProto(op_proto, grpc_source_node_id);
+  auto source_node = FakeGRPCSourceNode();
+  ASSERT_OK(source_node.Init(*plan_node, input_rd, {}));
+
+  std::atomic<int> num_continues = 0;
+  ASSERT_OK(service_->AddGRPCSourceNode(query_id, grpc_source_node_id, &source_node,
+                                        [&] { num_continues++; }));
+
+  carnotpb::TransferResultChunkRequest initiate_stream_req;
+  ToProto(query_id, initiate_stream_req.mutable_query_id());
+  *initiate_stream_req.mutable_initiate_conn() =
+      carnotpb::TransferResultChunkRequest::InitiateConnection();
+
+  auto rb = RowBatchBuilder(input_rd, 2, /*eow*/ false, /*eos*/ false)
+                .AddColumn<types::Int64Value>({1, 2})
+                .get();
+  carnotpb::TransferResultChunkRequest rb_req;
+  EXPECT_OK(rb.ToProto(rb_req.mutable_query_result()->mutable_row_batch()));
+  rb_req.mutable_query_result()->set_grpc_source_id(grpc_source_node_id);
+  ToProto(query_id, rb_req.mutable_query_id());
+
+  px::carnotpb::TransferResultChunkResponse response;
+  grpc::ClientContext context;
+  auto writer = stub_->TransferResultChunk(&context, &response);
+  EXPECT_TRUE(writer->Write(initiate_stream_req));
+  EXPECT_TRUE(writer->Write(rb_req));
+  while (num_continues == 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  service_->StopSourceStreams(query_id, grpc_source_node_id);
+  // Deleting the query must not cancel the stream to the stopped source, so that its sink can
+  // tell that it should stop rather than fail.
+  service_->DeleteQuery(query_id);
+
+  // The next request ends the stream, with a response that tells the sink to stop sending.
+  writer->Write(rb_req);
+  writer->WritesDone();
+  auto status = writer->Finish();
+  EXPECT_TRUE(status.ok()) << status.error_message();
+  EXPECT_TRUE(response.success());
+  EXPECT_TRUE(response.stop_sending());
+  EXPECT_EQ(1, source_node.row_batches.size());
+  EXPECT_FALSE(source_node.upstream_closed_connection());
+}
+
 TEST_F(GRPCRouterTest, threaded_router_test_multi_writer) {
   uint64_t ab = 0xea8aa095697f49f1, cd = 0xb127d50e5b6e2645;
   auto query_uuid = sole::rebuild(ab, cd);
@@ -18,9 +18,11 @@
 
 #include "src/carnot/exec/grpc_sink_node.h"
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <absl/strings/substitute.h>
@@ -29,8 +31,28 @@
 #include "src/carnot/planpb/plan.pb.h"
 #include "src/common/base/macros.h"
 #include "src/common/uuid/uuid_utils.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
 #include "src/table_store/table_store.h"
 
+DEFINE_bool(carnot_grpc_sink_packed_row_batches,
+            gflags::BoolFromEnv("PL_CARNOT_GRPC_SINK_PACKED_ROW_BATCHES", false),
+            "Whether to send row batches to other Carnot instances with their columns packed into "
+            "raw buffers instead of one proto field per value. Only enable once every receiving "
+            "Carnot can decode packed row batches.");
+DEFINE_string(carnot_grpc_sink_compression,
+              gflags::StringFromEnv("PL_CARNOT_GRPC_SINK_COMPRESSION", "none"),
+              "The gRPC message compression for result streams to other Carnot instances. One of "
+              "none, deflate or gzip.");
+DEFINE_int64(carnot_grpc_sink_coalesce_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_GRPC_SINK_COALESCE_BYTES", 0),
+             "Row batches sent to other Carnot instances are held back and merged until this many "
+             "bytes of them are pending, a window ends or they have waited for "
+             "carnot_grpc_sink_coalesce_max_delay_ms. Zero disables coalescing.");
+DEFINE_int64(carnot_grpc_sink_coalesce_max_delay_ms,
+             gflags::Int64FromEnv("PL_CARNOT_GRPC_SINK_COALESCE_MAX_DELAY_MS", 100),
+             "The longest a row batch is held back for coalescing before it is sent.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -67,12 +89,71 @@ StatusOr<carnotpb::TransferResultChunkRequest> RequestWithMetadata(
   return req;
 }
 
+StatusOr<grpc_compression_algorithm> ParseCompression(const std::string& name) {
+  if (name == "none") {
+    return GRPC_COMPRESS_NONE;
+  }
+  if (name == "deflate") {
+    return GRPC_COMPRESS_DEFLATE;
+  }
+  if (name == "gzip") {
+    return GRPC_COMPRESS_GZIP;
+  }
+  return error::InvalidArgument("Unknown GRPCSink compression '$0', expected none, deflate or gzip",
+                                name);
+}
+
+Status GRPCSinkNode::SerializeRowBatch(const RowBatch& rb,
+                                       carnotpb::TransferResultChunkRequest* req) const {
+  auto* row_batch = req->mutable_query_result()->mutable_row_batch();
+  if (pack_row_batches_) {
+    return rb.ToPackedProto(row_batch);
+  }
+  return rb.ToProto(row_batch);
+}
+
+// Concatenates the rows of batches, which all have the given descriptor, into one row batch.
+static StatusOr<std::unique_ptr<RowBatch>> ConcatRowBatches(
+    const RowDescriptor& desc, const std::vector<std::unique_ptr<RowBatch>>& batches,
+    int64_t num_rows) {
+  auto output = std::make_unique<RowBatch>(desc, num_rows);
+  for (size_t col_idx = 0; col_idx < desc.size(); ++col_idx) {
+    auto dt = desc.type(col_idx);
+    auto builder = types::MakeTypeErasedArrowBuilder(dt, arrow::default_memory_pool());
+    PX_RETURN_IF_ERROR(builder->Reserve(num_rows));
+    if (dt == types::DataType::STRING) {
+      int64_t data_bytes = 0;
+      for (const auto& rb : batches) {
+        auto col = std::static_pointer_cast<arrow::StringArray>(rb->ColumnAt(col_idx));
+        data_bytes += col->value_offset(col->length()) - col->value_offset(0);
+      }
+      PX_RETURN_IF_ERROR(builder->ReserveData(data_bytes));
+    }
+    for (const auto& rb : batches) {
+#define TYPE_CASE(_dt_)                                                         \
+  auto iterable = types::ArrowArrayIterator<_dt_>(rb->ColumnAt(col_idx).get()); \
+  types::GetTypedArrowBuilder<_dt_>(builder.get())                              \
+      ->UnsafeAppendValues(iterable.begin(), iterable.end());
+      PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
+#undef TYPE_CASE
+    }
+    std::shared_ptr<arrow::Array> col;
+    PX_RETURN_IF_ERROR(builder->Finish(&col));
+    PX_RETURN_IF_ERROR(output->AddColumn(col));
+  }
+  return output;
+}
+
 Status GRPCSinkNode::OptionallyCheckConnection(ExecState* exec_state) {
-  if (sent_eos_ || cancelled_) {
+  if (sent_eos_ || cancelled_ || receiver_done_) {
     return Status::OK();
   }
 
   auto time_now = std::chrono::system_clock::now();
+  if (!pending_batches_.empty() && time_now - pending_since_ >= coalesce_max_delay_) {
+    // Sending the pending rows also counts as a connection check.
+    return FlushPending(exec_state, /* eow */ false, /* eos */ false, /* parent_index */ 0);
+  }
   auto since_last_flush =
       std::chrono::duration_cast<std::chrono::milliseconds>(time_now - last_send_time_);
   bool recheck_connection = since_last_flush > connection_check_timeout_;
@@ -83,7 +164,7 @@ Status GRPCSinkNode::OptionallyCheckConnection(ExecState* exec_state) {
   PX_ASSIGN_OR_RETURN(auto req, RequestWithMetadata(plan_node_.get(), exec_state));
   PX_ASSIGN_OR_RETURN(auto rb,
                       RowBatch::WithZeroRows(*input_descriptor_, /* eow */ false, /* eos */ false));
-  PX_RETURN_IF_ERROR(rb->ToProto(req.mutable_query_result()->mutable_row_batch()));
+  PX_RETURN_IF_ERROR(SerializeRowBatch(*rb, &req));
 
   PX_RETURN_IF_ERROR(TryWriteRequest(exec_state, req));
   return Status::OK();
@@ -99,6 +180,12 @@ Status GRPCSinkNode::InitImpl(const plan::Operator& plan_node) {
   input_descriptor_ = std::make_unique<RowDescriptor>(input_descriptors_[0]);
   const auto* sink_plan_node = static_cast<const plan::GRPCSinkOperator*>(&plan_node);
   plan_node_ = std::make_unique<plan::GRPCSinkOperator>(*sink_plan_node);
+  if (plan_node_->has_grpc_source_id()) {
+    pack_row_batches_ = FLAGS_carnot_grpc_sink_packed_row_batches;
+    PX_ASSIGN_OR_RETURN(compression_, ParseCompression(FLAGS_carnot_grpc_sink_compression));
+    coalesce_bytes_ = std::max<int64_t>(FLAGS_carnot_grpc_sink_coalesce_bytes, 0);
+    coalesce_max_delay_ = std::chrono::milliseconds(FLAGS_carnot_grpc_sink_coalesce_max_delay_ms);
+  }
   return Status::OK();
 }
 
@@ -126,6 +213,10 @@ Status GRPCSinkNode::StartConnectionWithRetries(ExecState* exec_state, size_t n_
     // Adding auth to GRPC client.
     exec_state->AddAuthToGRPCClientContext(context_.get());
   }
+  // Carnot's gRPC servers accept all of gRPC's built-in compression algorithms.
+  if (compression_ != GRPC_COMPRESS_NONE) {
+    context_->set_compression_algorithm(compression_);
+  }
 
   response_.Clear();
   writer_ = stub_->TransferResultChunk(context_.get(), &response_);
@@ -135,7 +226,7 @@ Status GRPCSinkNode::StartConnectionWithRetries(ExecState* exec_state, size_t n_
   // initiate_result_stream request.
   PX_ASSIGN_OR_RETURN(auto rb,
                       RowBatch::WithZeroRows(*input_descriptor_, /* eow */ false, /* eos */ false));
-  PX_RETURN_IF_ERROR(rb->ToProto(req.mutable_query_result()->mutable_row_batch()));
+  PX_RETURN_IF_ERROR(SerializeRowBatch(*rb, &req));
 
   if (!writer_->Write(req)) {
     return StartConnectionWithRetries(exec_state, n_retries - 1);
@@ -155,6 +246,8 @@ Status GRPCSinkNode::CancelledByServer(ExecState* exec_state) {
 
 Status GRPCSinkNode::TryWriteRequest(ExecState* exec_state,
                                      const carnotpb::TransferResultChunkRequest& req) {
+  // Write blocks while the receiving router's window for this source is full, which pauses this
+  // fragment, and with it the reads from its sources, until the receiver catches up.
   if (writer_->Write(req)) {
     last_send_time_ = std::chrono::system_clock::now();
     return Status::OK();
@@ -164,6 +257,15 @@ Status GRPCSinkNode::TryWriteRequest(ExecState* exec_state,
   // connection just died.
   writer_->WritesDone();
   auto s = writer_->Finish();
+  if (s.ok() && response_.stop_sending()) {
+    LOG(INFO) << absl::Substitute(
+        "GRPCSinkNode $0 of query $1: the receiver at $2 needs no more results, stopping",
+        plan_node_->id(), exec_state->query_id().str(), plan_node_->address());
+    receiver_done_ = true;
+    // The results of this query are incomplete, so they can't be cached.
+    exec_state->set_record_sent_batches(false);
+    return Status::OK();
+  }
   // If the Finish call was successful, then the server closed the connection and sent a response,
   // in which case we shouldn't try to reconnect. If there's an error from the server side
   // other than a RST_STREAM, we also shouldn't retry.
@@ -200,7 +302,7 @@ Status GRPCSinkNode::CloseWriter(ExecState* exec_state) {
 }
 
 Status GRPCSinkNode::CloseImpl(ExecState* exec_state) {
-  if (sent_eos_ || cancelled_) {
+  if (sent_eos_ || cancelled_ || receiver_done_) {
     return Status::OK();
   }
 
@@ -303,20 +405,75 @@ Status GRPCSinkNode::SplitAndSendBatch(ExecState* exec_state, const RowBatch& rb
 }
 
 Status GRPCSinkNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t parent_idx) {
+  if (receiver_done_) {
+    return Status::OK();
+  }
+  if (exec_state->record_sent_batches()) {
+    PX_ASSIGN_OR_RETURN(auto recorded, rb.Materialize());
+    exec_state->RecordSentBatch(plan_node_->id(), std::move(recorded));
+  }
+  if (coalesce_bytes_ > 0) {
+    return CoalesceAndSend(exec_state, rb, parent_idx);
+  }
+  return SendBatch(exec_state, rb, parent_idx);
+}
+
+Status GRPCSinkNode::SendBatch(ExecState* exec_state, const RowBatch& rb, size_t parent_idx) {
   if (rb.NumBytes() > (max_batch_size_ * batch_size_factor_)) {
     return SplitAndSendBatch(exec_state, rb, parent_idx);
   }
   return ConsumeNextImplNoSplit(exec_state, rb, parent_idx);
 }
 
+Status GRPCSinkNode::CoalesceAndSend(ExecState* exec_state, const RowBatch& rb,
+                                     size_t parent_idx) {
+  bool ends_window = rb.eow() || rb.eos();
+  // Nothing to merge with, so there's no need to copy the batch.
+  if (pending_batches_.empty() && (ends_window || rb.NumBytes() >= coalesce_bytes_)) {
+    return SendBatch(exec_state, rb, parent_idx);
+  }
+  // Batches without rows only carry eow and eos, which the flush below sends.
+  if (rb.num_rows() > 0) {
+    if (pending_batches_.empty()) {
+      pending_since_ = std::chrono::system_clock::now();
+    }
+    PX_ASSIGN_OR_RETURN(auto pending, rb.Materialize());
+    pending_bytes_ += pending->NumBytes();
+    pending_rows_ += pending->num_rows();
+    pending_batches_.push_back(std::move(pending));
+  }
+  if (!ends_window && pending_bytes_ < coalesce_bytes_) {
+    return Status::OK();
+  }
+  return FlushPending(exec_state, rb.eow(), rb.eos(), parent_idx);
+}
+
+Status GRPCSinkNode::FlushPending(ExecState* exec_state, bool eow, bool eos, size_t parent_idx) {
+  std::unique_ptr<RowBatch> rb;
+  if (pending_batches_.size() == 1) {
+    rb = std::move(pending_batches_[0]);
+  } else {
+    PX_ASSIGN_OR_RETURN(rb, ConcatRowBatches(*input_descriptor_, pending_batches_, pending_rows_));
+  }
+  pending_batches_.clear();
+  pending_bytes_ = 0;
+  pending_rows_ = 0;
+  rb->set_eow(eow);
+  rb->set_eos(eos);
+  return SendBatch(exec_state, *rb, parent_idx);
+}
+
 Status GRPCSinkNode::ConsumeNextImplNoSplit(ExecState* exec_state, const RowBatch& rb, size_t) {
+  if (receiver_done_) {
+    return Status::OK();
+  }
   PX_ASSIGN_OR_RETURN(auto req, RequestWithMetadata(plan_node_.get(), exec_state));
   // Serialize the RowBatch.
-  PX_RETURN_IF_ERROR(rb.ToProto(req.mutable_query_result()->mutable_row_batch()));
+  PX_RETURN_IF_ERROR(SerializeRowBatch(rb, &req));
 
   PX_RETURN_IF_ERROR(TryWriteRequest(exec_state, req));
 
-  if (!rb.eos()) {
+  if (!rb.eos() || receiver_done_) {
     return Status::OK();
   }
 
@@ -35,6 +35,11 @@
 
 #include "src/carnot/carnotpb/carnot.grpc.pb.h"
 
+DECLARE_bool(carnot_grpc_sink_packed_row_batches);
+DECLARE_string(carnot_grpc_sink_compression);
+DECLARE_int64(carnot_grpc_sink_coalesce_bytes);
+DECLARE_int64(carnot_grpc_sink_coalesce_max_delay_ms);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -58,15 +63,21 @@ class GRPCSinkNode : public SinkNode {
   GRPCSinkNode() : GRPCSinkNode(kMaxBatchSize, kBatchSizeFactor) {}
   virtual ~GRPCSinkNode() = default;
 
-  // Used to check the downstream connection after connection_check_timeout_ has elapsed.
+  // Used to check the downstream connection after connection_check_timeout_ has elapsed. Also
+  // sends the coalesced row batches that have waited longer than coalesce_max_delay_.
   Status OptionallyCheckConnection(ExecState* exec_state);
 
+  // Whether the receiver ended the stream because it needs no more results, in which case the
+  // sink drops the rest of its input.
+  bool receiver_done() const { return receiver_done_; }
+
   void testing_set_connection_check_timeout(const std::chrono::milliseconds& timeout) {
     connection_check_timeout_ = timeout;
   }
   const std::chrono::time_point<std::chrono::system_clock>& testing_last_send_time() const {
     return last_send_time_;
   }
+  int64_t testing_num_pending_rows() const { return pending_rows_; }
 
  protected:
   std::string DebugStringImpl() override;
@@ -80,6 +91,9 @@ class GRPCSinkNode : public SinkNode {
                                 size_t parent_index);
   Status SplitAndSendBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb,
                            size_t parent_index);
+  // Sends rb, split into several requests if it is larger than the max batch size.
+  Status SendBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                   size_t parent_index);
   std::vector<int64_t> SplitBatchSizes(bool has_string_col,
                                        const std::vector<int64_t>& string_col_row_sizes,
                                        int64_t other_col_row_size) const;
@@ -90,8 +104,17 @@ class GRPCSinkNode : public SinkNode {
   Status StartConnectionWithRetries(ExecState* exec_state, size_t n_retries);
   Status CancelledByServer(ExecState* exec_state);
   Status TryWriteRequest(ExecState* exec_state, const carnotpb::TransferResultChunkRequest& req);
+  // Serializes rb into the request, packed when it is going to another Carnot instance.
+  Status SerializeRowBatch(const table_store::schema::RowBatch& rb,
+                           carnotpb::TransferResultChunkRequest* req) const;
+  // Holds back small row batches until coalesce_bytes_ of them are pending or rb ends a window.
+  Status CoalesceAndSend(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                         size_t parent_index);
+  // Sends the pending row batches as one row batch, with the given eow and eos.
+  Status FlushPending(ExecState* exec_state, bool eow, bool eos, size_t parent_index);
 
   bool cancelled_ = false;
+  bool receiver_done_ = false;
 
   std::unique_ptr<grpc::ClientContext> context_;
   carnotpb::TransferResultChunkResponse response_;
@@ -107,6 +130,21 @@ class GRPCSinkNode : public SinkNode {
 
   size_t max_batch_size_;
   float batch_size_factor_;
+
+  // Set from the flags in InitImpl. Both only apply to results sent to another Carnot instance,
+  // since external result consumers expect unpacked, uncompressed row batches.
+  bool pack_row_batches_ = false;
+  grpc_compression_algorithm compression_ = GRPC_COMPRESS_NONE;
+
+  // Row batches smaller than coalesce_bytes_ are merged before they are sent to another Carnot
+  // instance, so that sources that produce many tiny batches don't send one request per batch.
+  // Disabled when zero.
+  int64_t coalesce_bytes_ = 0;
+  std::chrono::milliseconds coalesce_max_delay_{0};
+  std::vector<std::unique_ptr<table_store::schema::RowBatch>> pending_batches_;
+  int64_t pending_bytes_ = 0;
+  int64_t pending_rows_ = 0;
+  std::chrono::time_point<std::chrono::system_clock> pending_since_;
 };
 
 }  // namespace exec
@@ -19,6 +19,7 @@
 #include <utility>
 #include <vector>
 
+#include <absl/strings/str_cat.h>
 #include <benchmark/benchmark.h>
 #include <grpcpp/test/mock_stream.h>
 #include <gtest/gtest.h>
@@ -104,3 +105,78 @@ void BM_GRPCSinkNodeSplitting(benchmark::State& state) {
 }
 
 BENCHMARK(BM_GRPCSinkNodeSplitting)->Unit(benchmark::kMillisecond);
+
+// Compares the per-value proto encoding of row batches sent to another Carnot instance with the
+// packed encoding (state.range(0) == 1) on a batch of mixed column types.
+// NOLINTNEXTLINE : runtime/references.
+void BM_GRPCSinkNodeEncoding(benchmark::State& state) {
+  FLAGS_carnot_grpc_sink_packed_row_batches = state.range(0) == 1;
+  auto func_registry = std::make_unique<px::carnot::udf::Registry>("test_registry");
+  auto table_store = std::make_shared<px::table_store::TableStore>();
+
+  auto mock_unique = std::make_unique<::testing::NiceMock<MockResultSinkServiceStub>>();
+  auto mock = mock_unique.get();
+
+  auto exec_state = std::make_unique<px::carnot::exec::ExecState>(
+      func_registry.get(), table_store,
+      [&](const std::string&, const std::string&)
+          -> std::unique_ptr<ResultSinkService::StubInterface> { return std::move(mock_unique); },
+      MockMetricsStubGenerator, MockTraceStubGenerator, sole::uuid4(), nullptr, nullptr,
+      [&](grpc::ClientContext*) {});
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+  size_t bytes_written = 0;
+  auto writer =
+      new ::testing::NiceMock<grpc::testing::MockClientWriter<TransferResultChunkRequest>>();
+  ON_CALL(*writer, Write(_, _))
+      .WillByDefault(
+          ::testing::Invoke([&](const TransferResultChunkRequest& req, grpc::WriteOptions) {
+            bytes_written += req.ByteSizeLong();
+            return true;
+          }));
+  ON_CALL(*writer, WritesDone()).WillByDefault(Return(true));
+  ON_CALL(*writer, Finish()).WillByDefault(Return(grpc::Status::OK));
+  ON_CALL(*mock, TransferResultChunkRaw(_, _))
+      .WillByDefault(DoAll(SetArgPointee<1>(resp), Return(writer)));
+
+  px::carnot::exec::GRPCSinkNode node;
+  auto op_proto = px::carnot::planpb::testutils::CreateTestGRPCSink1PB();
+  auto plan_node = std::make_unique<px::carnot::plan::GRPCSinkOperator>(1);
+  PX_CHECK_OK(plan_node->Init(op_proto.grpc_sink_op()));
+
+  int64_t num_rows = 8 * 1024;
+  RowDescriptor rd({DataType::TIME64NS, DataType::INT64, DataType::FLOAT64, DataType::STRING});
+  PX_CHECK_OK(node.Init(*plan_node, rd, {rd}));
+  PX_CHECK_OK(node.Prepare(exec_state.get()));
+  PX_CHECK_OK(node.Open(exec_state.get()));
+
+  std::vector<px::types::Time64NSValue> times;
+  std::vector<px::types::Int64Value> ints;
+  std::vector<px::types::Float64Value> floats;
+  std::vector<px::types::StringValue> strings;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    times.emplace_back(1600000000000000000 + i * 1000);
+    ints.emplace_back(i * 7919);
+    floats.emplace_back(i * 0.5);
+    strings.emplace_back(absl::StrCat("/api/v1/service-", i % 100));
+  }
+  auto rb = px::carnot::exec::RowBatchBuilder(rd, num_rows, /*eow*/ false, /*eos*/ false)
+                .AddColumn<px::types::Time64NSValue>(times)
+                .AddColumn<px::types::Int64Value>(ints)
+                .AddColumn<px::types::Float64Value>(floats)
+                .AddColumn<px::types::StringValue>(strings)
+                .get();
+
+  bytes_written = 0;
+  for (auto _ : state) {
+    PX_CHECK_OK(node.ConsumeNext(exec_state.get(), rb, 0));
+  }
+  // items_per_second is rows per second, so ns/row is 1e9 / items_per_second.
+  state.SetItemsProcessed(state.iterations() * num_rows);
+  state.SetBytesProcessed(bytes_written);
+  state.counters["wire_bytes_per_row"] =
+      static_cast<double>(bytes_written) / (state.iterations() * num_rows);
+  FLAGS_carnot_grpc_sink_packed_row_batches = false;
+}
+
+BENCHMARK(BM_GRPCSinkNodeEncoding)->ArgName("packed")->Arg(0)->Arg(1);
@@ -217,6 +217,148 @@ TEST_F(GRPCSinkNodeTest, internal_result) {
   EXPECT_FALSE(add_metadata_called_);
 }
 
+TEST_F(GRPCSinkNodeTest, internal_result_packed) {
+  FLAGS_carnot_grpc_sink_packed_row_batches = true;
+  auto op_proto = planpb::testutils::CreateTestGRPCSink1PB();
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  auto s = plan_node->Init(op_proto.grpc_sink_op());
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::STRING});
+
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+
+  std::vector<TransferResultChunkRequest> actual_protos(2);
+  auto writer = new grpc::testing::MockClientWriter<TransferResultChunkRequest>();
+  EXPECT_CALL(*writer, Write(_, _))
+      .Times(2)
+      .WillOnce(DoAll(SaveArg<0>(&actual_protos[0]), Return(true)))
+      .WillOnce(DoAll(SaveArg<0>(&actual_protos[1]), Return(true)));
+  EXPECT_CALL(*writer, WritesDone());
+  EXPECT_CALL(*writer, Finish()).WillOnce(Return(grpc::Status::OK));
+  EXPECT_CALL(*mock_, TransferResultChunkRaw(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(resp), Return(writer)));
+
+  auto tester = exec::ExecNodeTester<GRPCSinkNode, plan::GRPCSinkOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  auto rb = RowBatchBuilder(output_rd, 2, /*eow*/ true, /*eos*/ true)
+                .AddColumn<types::Int64Value>({1, 2})
+                .AddColumn<types::StringValue>({"abc", "de"})
+                .get();
+  tester.ConsumeNext(rb, 5, 0);
+  tester.Close();
+  FLAGS_carnot_grpc_sink_packed_row_batches = false;
+
+  for (const auto& req : actual_protos) {
+    EXPECT_EQ(0, req.query_result().row_batch().cols_size());
+    EXPECT_EQ(2, req.query_result().row_batch().packed_col_types_size());
+  }
+  ASSERT_OK_AND_ASSIGN(auto received,
+                       RowBatch::FromProto(actual_protos[1].query_result().row_batch()));
+  EXPECT_EQ(rb.DebugString(), received->DebugString());
+}
+
+TEST_F(GRPCSinkNodeTest, internal_result_coalesced) {
+  FLAGS_carnot_grpc_sink_coalesce_bytes = 1024;
+  auto op_proto = planpb::testutils::CreateTestGRPCSink1PB();
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  auto s = plan_node->Init(op_proto.grpc_sink_op());
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::STRING});
+
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+
+  std::vector<TransferResultChunkRequest> actual_protos(2);
+  auto writer = new grpc::testing::MockClientWriter<TransferResultChunkRequest>();
+  EXPECT_CALL(*writer, Write(_, _))
+      .Times(2)
+      .WillOnce(DoAll(SaveArg<0>(&actual_protos[0]), Return(true)))
+      .WillOnce(DoAll(SaveArg<0>(&actual_protos[1]), Return(true)));
+  EXPECT_CALL(*writer, WritesDone());
+  EXPECT_CALL(*writer, Finish()).WillOnce(Return(grpc::Status::OK));
+  EXPECT_CALL(*mock_, TransferResultChunkRaw(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(resp), Return(writer)));
+
+  auto tester = exec::ExecNodeTester<GRPCSinkNode, plan::GRPCSinkOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  tester.ConsumeNext(RowBatchBuilder(output_rd, 1, /*eow*/ false, /*eos*/ false)
+                         .AddColumn<types::Int64Value>({1})
+                         .AddColumn<types::StringValue>({"abc"})
+                         .get(),
+                     5, 0);
+  tester.ConsumeNext(RowBatchBuilder(output_rd, 2, /*eow*/ false, /*eos*/ false)
+                         .AddColumn<types::Int64Value>({2, 3})
+                         .AddColumn<types::StringValue>({"de", ""})
+                         .get(),
+                     5, 0);
+  // Both batches are held back until the batch that ends the stream.
+  EXPECT_EQ(3, tester.node()->testing_num_pending_rows());
+  tester.ConsumeNext(RowBatchBuilder(output_rd, 1, /*eow*/ true, /*eos*/ true)
+                         .AddColumn<types::Int64Value>({4})
+                         .AddColumn<types::StringValue>({"f"})
+                         .get(),
+                     5, 0);
+  EXPECT_EQ(0, tester.node()->testing_num_pending_rows());
+  tester.Close();
+  FLAGS_carnot_grpc_sink_coalesce_bytes = 0;
+
+  auto expected_rb = RowBatchBuilder(output_rd, 4, /*eow*/ true, /*eos*/ true)
+                         .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                         .AddColumn<types::StringValue>({"abc", "de", "", "f"})
+                         .get();
+  ASSERT_OK_AND_ASSIGN(auto received,
+                       RowBatch::FromProto(actual_protos[1].query_result().row_batch()));
+  EXPECT_EQ(expected_rb.DebugString(), received->DebugString());
+}
+
+TEST_F(GRPCSinkNodeTest, coalesced_batches_sent_after_max_delay) {
+  FLAGS_carnot_grpc_sink_coalesce_bytes = 1024;
+  FLAGS_carnot_grpc_sink_coalesce_max_delay_ms = 0;
+  auto op_proto = planpb::testutils::CreateTestGRPCSink1PB();
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  auto s = plan_node->Init(op_proto.grpc_sink_op());
+  RowDescriptor input_rd({types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+
+  std::vector<TransferResultChunkRequest> actual_protos(3);
+  auto writer = new grpc::testing::MockClientWriter<TransferResultChunkRequest>();
+  EXPECT_CALL(*writer, Write(_, _))
+      .Times(3)
+      .WillOnce(DoAll(SaveArg<0>(&actual_protos[0]), Return(true)))
+      .WillOnce(DoAll(SaveArg<0>(&actual_protos[1]), Return(true)))
+      .WillOnce(DoAll(SaveArg<0>(&actual_protos[2]), Return(true)));
+  EXPECT_CALL(*writer, WritesDone());
+  EXPECT_CALL(*writer, Finish()).WillOnce(Return(grpc::Status::OK));
+  EXPECT_CALL(*mock_, TransferResultChunkRaw(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(resp), Return(writer)));
+
+  auto tester = exec::ExecNodeTester<GRPCSinkNode, plan::GRPCSinkOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  tester.ConsumeNext(RowBatchBuilder(output_rd, 2, /*eow*/ false, /*eos*/ false)
+                         .AddColumn<types::Int64Value>({1, 2})
+                         .get(),
+                     5, 0);
+  EXPECT_EQ(2, tester.node()->testing_num_pending_rows());
+  EXPECT_OK(tester.node()->OptionallyCheckConnection(exec_state_.get()));
+  EXPECT_EQ(0, tester.node()->testing_num_pending_rows());
+  tester.ConsumeNext(RowBatchBuilder(output_rd, 0, /*eow*/ true, /*eos*/ true)
+                         .AddColumn<types::Int64Value>({})
+                         .get(),
+                     5, 0);
+  tester.Close();
+  FLAGS_carnot_grpc_sink_coalesce_bytes = 0;
+  FLAGS_carnot_grpc_sink_coalesce_max_delay_ms = 100;
+
+  EXPECT_EQ(2, actual_protos[1].query_result().row_batch().num_rows());
+  EXPECT_FALSE(actual_protos[1].query_result().row_batch().eos());
+  EXPECT_EQ(0, actual_protos[2].query_result().row_batch().num_rows());
+  EXPECT_TRUE(actual_protos[2].query_result().row_batch().eos());
+}
+
 constexpr char kExpectedExternal0RowResult[] = R"proto(
 address: "localhost:1234"
 query_id {
@@ -722,6 +864,48 @@ TEST_F(GRPCSinkNodeTest, retry_failed_writes) {
   EXPECT_FALSE(add_metadata_called_);
 }
 
+TEST_F(GRPCSinkNodeTest, receiver_stops_stream) {
+  auto op_proto = planpb::testutils::CreateTestGRPCSink1PB();
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  auto s = plan_node->Init(op_proto.grpc_sink_op());
+  RowDescriptor input_rd({types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+  resp.set_stop_sending(true);
+
+  auto writer = new grpc::testing::MockClientWriter<TransferResultChunkRequest>();
+  EXPECT_CALL(*writer, Write(_, _))
+      .Times(2)
+      .WillOnce(Return(true))    // Initiate result sink
+      .WillOnce(Return(false));  // Stream ended by the receiver
+  EXPECT_CALL(*writer, WritesDone()).WillOnce(Return(true));
+  EXPECT_CALL(*writer, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  EXPECT_CALL(*mock_, TransferResultChunkRaw(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(resp), Return(writer)));
+
+  exec_state_->set_record_sent_batches(true);
+  auto tester = exec::ExecNodeTester<GRPCSinkNode, plan::GRPCSinkOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  tester.node()->testing_set_connection_check_timeout(std::chrono::milliseconds(-1));
+
+  for (auto i = 0; i < 3; ++i) {
+    auto rb = RowBatchBuilder(output_rd, 1, /*eow*/ i == 2, /*eos*/ i == 2)
+                  .AddColumn<types::Int64Value>({i})
+                  .get();
+    tester.ConsumeNext(rb, 5, 0);
+  }
+  EXPECT_TRUE(tester.node()->receiver_done());
+  // Stopping isn't an error, and the rest of the batches are dropped without writes.
+  EXPECT_OK(tester.node()->OptionallyCheckConnection(exec_state_.get()));
+  // The results are incomplete, so they must not be cached.
+  EXPECT_FALSE(exec_state_->record_sent_batches());
+
+  tester.Close();
+}
+
 TEST_F(GRPCSinkNodeTest, check_connection_after_eos) {
   auto op_proto = planpb::testutils::CreateTestGRPCSink2PB();
   auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
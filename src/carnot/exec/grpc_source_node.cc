@@ -57,28 +57,42 @@ Status GRPCSourceNode::GenerateNextImpl(ExecState* exec_state) {
 
 Status GRPCSourceNode::EnqueueRowBatch(
     std::unique_ptr<carnotpb::TransferResultChunkRequest> row_batch) {
-  if (!row_batch_queue_.enqueue(std::move(row_batch))) {
-    return error::Internal("Failed to enqueue RowBatch");
+  DecodedRowBatch decoded;
+  decoded.request_bytes = row_batch->ByteSizeLong();
+  auto s = [&]() -> Status {
+    if (!row_batch->has_query_result() || !row_batch->query_result().has_row_batch()) {
+      return error::Internal(
+          "GRPCSourceNode::EnqueueRowBatch expected TransferResultChunkRequest to have RowBatch "
+          "message.");
+    }
+    PX_ASSIGN_OR_RETURN(decoded.rb, RowBatch::FromProto(row_batch->query_result().row_batch()));
+    // The proto isn't needed anymore, only its size is still held in the flow control window.
+    row_batch.reset();
+    if (!row_batch_queue_.enqueue(std::move(decoded))) {
+      return error::Internal("Failed to enqueue RowBatch");
+    }
+    return Status::OK();
+  }();
+  if (!s.ok() && flow_control_window_ != nullptr) {
+    flow_control_window_->Release(decoded.request_bytes);
   }
-  return Status::OK();
+  return s;
 }
 
 Status GRPCSourceNode::PopRowBatch() {
   DCHECK(NextBatchReady());
-  std::unique_ptr<carnotpb::TransferResultChunkRequest> rb_request;
-  bool got_one = row_batch_queue_.try_dequeue(rb_request);
+  DecodedRowBatch decoded;
+  bool got_one = row_batch_queue_.try_dequeue(decoded);
   if (!got_one) {
     return error::Internal(
         "Called GRPCSourceNode::OptionallyPopRowBatch but there was no available row batch in the "
         "queue.");
   }
-  if (!rb_request->has_query_result() || !rb_request->query_result().has_row_batch()) {
-    return error::Internal(
-        "GRPCSourceNode::PopRowBatch expected TransferResultChunkRequest to have RowBatch "
-        "message.");
-  }
 
-  PX_ASSIGN_OR_RETURN(rb_, RowBatch::FromProto(rb_request->query_result().row_batch()));
+  if (flow_control_window_ != nullptr) {
+    flow_control_window_->Release(decoded.request_bytes);
+  }
+  rb_ = std::move(decoded.rb);
   return Status::OK();
 }
 
@@ -21,11 +21,13 @@
 #include <chrono>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "src/carnot/carnotpb/carnot.pb.h"
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/flow_control_window.h"
 #include "src/carnot/plan/operators.h"
 #include "src/common/base/base.h"
 #include "src/table_store/table_store.h"
@@ -42,6 +44,9 @@ class GRPCSourceNode : public SourceNode {
   virtual ~GRPCSourceNode() = default;
 
   bool NextBatchReady() override;
+  // Decodes the row batch of the request and queues it. This runs on the thread that received the
+  // request, so that decoding the results of many agents is spread over their streams and
+  // overlaps with the execution of the query, instead of running on the query's thread.
   virtual Status EnqueueRowBatch(std::unique_ptr<carnotpb::TransferResultChunkRequest> row_batch);
 
   // Tracks whether the upstream sink node has successfully initiated the connection to
@@ -56,6 +61,12 @@ class GRPCSourceNode : public SourceNode {
   void set_upstream_closed_connection() { upstream_closed_connection_ = true; }
   bool upstream_closed_connection() const { return upstream_closed_connection_; }
 
+  // The window the GRPCRouter acquired the queued row batches from. Popped batches are released
+  // from it.
+  void set_flow_control_window(std::shared_ptr<FlowControlWindow> window) {
+    flow_control_window_ = std::move(window);
+  }
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -65,15 +76,22 @@ class GRPCSourceNode : public SourceNode {
   Status GenerateNextImpl(ExecState* exec_state) override;
 
  private:
+  // A decoded row batch, with the size of the request it came in, which is released from the flow
+  // control window when the batch is popped.
+  struct DecodedRowBatch {
+    std::unique_ptr<table_store::schema::RowBatch> rb;
+    size_t request_bytes = 0;
+  };
+
   Status PopRowBatch();
 
   std::unique_ptr<table_store::schema::RowBatch> rb_;
-  moodycamel::BlockingConcurrentQueue<std::unique_ptr<carnotpb::TransferResultChunkRequest>>
-      row_batch_queue_;
+  moodycamel::BlockingConcurrentQueue<DecodedRowBatch> row_batch_queue_;
 
   std::unique_ptr<plan::GRPCSourceOperator> plan_node_;
   bool upstream_initiated_connection_ = false;
   bool upstream_closed_connection_ = false;
+  std::shared_ptr<FlowControlWindow> flow_control_window_;
 };
 
 }  // namespace exec
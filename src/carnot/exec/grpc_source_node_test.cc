@@ -87,6 +87,39 @@ TEST_F(GRPCSourceNodeTest, basic) {
   EXPECT_FALSE(tester.node()->HasBatchesRemaining());
 }
 
+TEST_F(GRPCSourceNodeTest, decodes_on_enqueue) {
+  auto op_proto = planpb::testutils::CreateTestGRPCSource1PB();
+  std::unique_ptr<plan::Operator> plan_node = plan::GRPCSourceOperator::FromProto(op_proto, 1);
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<GRPCSourceNode, plan::GRPCSourceOperator>(
+      *plan_node, output_rd, std::vector<RowDescriptor>({}), exec_state_.get());
+  auto window = std::make_shared<FlowControlWindow>(1024 * 1024);
+  tester.node()->set_flow_control_window(window);
+
+  auto rb = RowBatchBuilder(output_rd, 2, /*eow*/ true, /*eos*/ true)
+                .AddColumn<types::Int64Value>({1, 2})
+                .get();
+  auto req = std::make_unique<carnotpb::TransferResultChunkRequest>();
+  EXPECT_OK(rb.ToProto(req->mutable_query_result()->mutable_row_batch()));
+  int64_t req_bytes = req->ByteSizeLong();
+
+  // Requests without a row batch are rejected when they arrive, and give back their window bytes.
+  auto bad_req = std::make_unique<carnotpb::TransferResultChunkRequest>();
+  bad_req->mutable_query_result()->set_grpc_source_id(1);
+  int64_t bad_req_bytes = bad_req->ByteSizeLong();
+  ASSERT_TRUE(window->Acquire(req_bytes + bad_req_bytes, [] { return false; }));
+  EXPECT_NOT_OK(tester.node()->EnqueueRowBatch(std::move(bad_req)));
+  EXPECT_EQ(req_bytes, window->buffered_bytes());
+  EXPECT_FALSE(tester.node()->NextBatchReady());
+
+  // Decoded batches hold on to their request's bytes until they are consumed.
+  EXPECT_OK(tester.node()->EnqueueRowBatch(std::move(req)));
+  EXPECT_EQ(req_bytes, window->buffered_bytes());
+  tester.GenerateNextResult().ExpectRowBatch(rb);
+  EXPECT_EQ(0, window->buffered_bytes());
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
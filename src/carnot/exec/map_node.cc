@@ -47,7 +47,7 @@ Status MapNode::InitImpl(const plan::Operator& plan_node) {
 Status MapNode::PrepareImpl(ExecState* exec_state) {
   function_ctx_ = exec_state->CreateFunctionContext();
   evaluator_ = ScalarExpressionEvaluator::Create(
-      plan_node_->expressions(), ScalarExpressionEvaluatorType::kArrowNative, function_ctx_.get());
+      plan_node_->expressions(), ScalarExpressionEvaluatorType::kFused, function_ctx_.get());
   return Status::OK();
 }
 
@@ -61,11 +61,13 @@ Status MapNode::CloseImpl(ExecState* exec_state) {
   return Status::OK();
 }
 Status MapNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
-  RowBatch output_rb(*output_descriptor_, rb.num_rows());
-  PX_RETURN_IF_ERROR(evaluator_->Evaluate(exec_state, rb, &output_rb));
-  output_rb.set_eow(rb.eow());
-  output_rb.set_eos(rb.eos());
-  PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+  // Columns that are only forwarded stay unmaterialized if the input is a view, e.g. of the rows
+  // that passed a filter, so that only the columns downstream operators read are copied.
+  auto output_rb = RowBatch::WithRowsOf(*output_descriptor_, rb);
+  PX_RETURN_IF_ERROR(evaluator_->Evaluate(exec_state, rb, output_rb.get()));
+  output_rb->set_eow(rb.eow());
+  output_rb->set_eos(rb.eos());
+  PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, *output_rb));
   return Status::OK();
 }
 
@@ -0,0 +1,24 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/memory_budget.h"
+
+DEFINE_int64(carnot_exec_query_memory_budget_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_EXEC_QUERY_MEMORY_BUDGET_BYTES", 0),
+             "The approximate amount of memory the joins and aggregates of a query may hold before "
+             "they spill their state to disk. Zero disables spilling.");
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "src/common/base/base.h"
+
+DECLARE_int64(carnot_exec_query_memory_budget_bytes);
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * Tracks the memory held by the blocking operators (joins and aggregates) of a query. Operators
+ * account for the state they buffer and check Exceeded() to decide when to move that state to
+ * disk. Accounting is approximate and never fails, so a query only degrades to spilling, it does
+ * not error out. A limit of zero disables the budget.
+ */
+class QueryMemoryBudget : public NotCopyable {
+ public:
+  explicit QueryMemoryBudget(int64_t limit_bytes) : limit_bytes_(limit_bytes) {}
+
+  void Consume(int64_t bytes) { used_bytes_ += bytes; }
+  void Release(int64_t bytes) {
+    DCHECK_GE(used_bytes_.load(), bytes);
+    used_bytes_ -= bytes;
+  }
+
+  bool enabled() const { return limit_bytes_ > 0; }
+  bool Exceeded() const { return enabled() && used_bytes_.load() > limit_bytes_; }
+
+  int64_t limit_bytes() const { return limit_bytes_; }
+  int64_t used_bytes() const { return used_bytes_.load(); }
+
+ private:
+  const int64_t limit_bytes_;
+  std::atomic<int64_t> used_bytes_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
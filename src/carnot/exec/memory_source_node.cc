@@ -19,7 +19,9 @@
 #include "src/carnot/exec/memory_source_node.h"
 #include "src/table_store/table/table.h"
 
+#include <cmath>
 #include <limits>
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -27,6 +29,7 @@
 
 #include "src/carnot/planpb/plan.pb.h"
 #include "src/common/base/base.h"
+#include "src/shared/types/type_utils.h"
 
 namespace px {
 namespace carnot {
@@ -34,6 +37,85 @@ namespace exec {
 
 using StartSpec = Table::Cursor::StartSpec;
 using StopSpec = Table::Cursor::StopSpec;
+using table_store::internal::ColumnPredicate;
+
+namespace {
+
+StatusOr<ColumnPredicate> ToColumnPredicate(const planpb::ColumnPredicate& pb,
+                                            const table_store::schema::Relation& relation) {
+  if (pb.column_index() < 0 || pb.column_index() >= static_cast<int64_t>(relation.NumColumns())) {
+    return error::InvalidArgument("Predicate column $0 is not in the table", pb.column_index());
+  }
+  auto col_type = relation.GetColumnType(static_cast<size_t>(pb.column_index()));
+  if (pb.value().data_type() != col_type) {
+    return error::InvalidArgument("Predicate on column $0 of type $1 has a value of type $2",
+                                  relation.GetColumnName(pb.column_index()),
+                                  types::ToString(col_type),
+                                  types::ToString(pb.value().data_type()));
+  }
+
+  ColumnPredicate predicate;
+  predicate.column_index = pb.column_index();
+  switch (pb.op()) {
+    case planpb::ColumnPredicate::EQUAL:
+      // Float equality is approximate in the equal UDF, which the table can't evaluate.
+      if (col_type == types::FLOAT64) {
+        return error::InvalidArgument("Equality predicates on FLOAT64 columns aren't supported");
+      }
+      predicate.op = ColumnPredicate::kEqual;
+      break;
+    case planpb::ColumnPredicate::LESS_THAN:
+      predicate.op = ColumnPredicate::kLessThan;
+      break;
+    case planpb::ColumnPredicate::LESS_THAN_EQUAL:
+      predicate.op = ColumnPredicate::kLessThanEqual;
+      break;
+    case planpb::ColumnPredicate::GREATER_THAN:
+      predicate.op = ColumnPredicate::kGreaterThan;
+      break;
+    case planpb::ColumnPredicate::GREATER_THAN_EQUAL:
+      predicate.op = ColumnPredicate::kGreaterThanEqual;
+      break;
+    case planpb::ColumnPredicate::CONTAINS:
+      if (col_type != types::STRING) {
+        return error::InvalidArgument("Contains predicate on non-string column $0",
+                                      relation.GetColumnName(pb.column_index()));
+      }
+      predicate.op = ColumnPredicate::kContains;
+      break;
+    default:
+      return error::InvalidArgument("Unknown predicate op $0", pb.op());
+  }
+
+  switch (col_type) {
+    case types::BOOLEAN:
+      predicate.value = pb.value().bool_value();
+      break;
+    case types::INT64:
+      predicate.value = pb.value().int64_value();
+      break;
+    case types::TIME64NS:
+      predicate.value = pb.value().time64_ns_value();
+      break;
+    case types::FLOAT64:
+      predicate.value = pb.value().float64_value();
+      break;
+    case types::UINT128:
+      predicate.value =
+          absl::MakeUint128(pb.value().uint128_value().high(), pb.value().uint128_value().low());
+      break;
+    case types::STRING:
+      predicate.value = pb.value().string_value();
+      break;
+    default:
+      return error::InvalidArgument("Predicates are not supported on column $0 of type $1",
+                                    relation.GetColumnName(pb.column_index()),
+                                    types::ToString(col_type));
+  }
+  return predicate;
+}
+
+}  // namespace
 
 std::string MemorySourceNode::DebugStringImpl() {
   return absl::Substitute("Exec::MemorySourceNode: <name: $0, output: $1>", plan_node_->TableName(),
@@ -49,6 +131,8 @@ Status MemorySourceNode::InitImpl(const plan::Operator& plan_node) {
   return Status::OK();
 }
 
+MemorySourceNode::~MemorySourceNode() { RemoveWriteListener(); }
+
 Status MemorySourceNode::PrepareImpl(ExecState*) { return Status::OK(); }
 
 Status MemorySourceNode::OpenImpl(ExecState* exec_state) {
@@ -86,12 +170,51 @@ Status MemorySourceNode::OpenImpl(ExecState* exec_state) {
     }
   }
   cursor_ = std::make_unique<Table::Cursor>(table_, start_spec, stop_spec);
+  cursor_->SetPredicates(table_predicates_);
+  if (!plan_node_->predicates().empty()) {
+    auto relation = table_->GetRelation();
+    std::vector<ColumnPredicate> filter_predicates;
+    for (const auto& predicate_pb : plan_node_->predicates()) {
+      PX_ASSIGN_OR_RETURN(auto predicate, ToColumnPredicate(predicate_pb, relation));
+      filter_predicates.push_back(std::move(predicate));
+    }
+    cursor_->SetFilterPredicates(std::move(filter_predicates));
+  }
+  if (plan_node_->reverse()) {
+    PX_RETURN_IF_ERROR(cursor_->SetReverse());
+  }
+  if (streaming_ && batch_ready_callback_) {
+    write_listener_id_ = table_->AddWriteListener(batch_ready_callback_);
+  }
+  sample_rate_ = plan_node_->sample_rate();
+  if (sample_rate_ < 1.0) {
+    // Splitting the rate evenly keeps most of the savings of skipping whole batches, without
+    // making the sample as clustered as batch sampling alone would.
+    double rate = std::sqrt(sample_rate_);
+    random_generator_.seed(std::random_device()());
+    keep_batch_ = std::bernoulli_distribution(rate);
+    rows_to_next_sample_ = std::geometric_distribution<int64_t>(rate);
+  }
 
   return Status::OK();
 }
 
+void MemorySourceNode::RemoveWriteListener() {
+  if (write_listener_id_.has_value()) {
+    table_->RemoveWriteListener(write_listener_id_.value());
+    write_listener_id_.reset();
+  }
+}
+
 Status MemorySourceNode::CloseImpl(ExecState*) {
+  RemoveWriteListener();
   stats()->AddExtraInfo("streaming", streaming_ ? "true" : "false");
+  stats()->AddExtraInfo("table_predicates", std::to_string(table_predicates_.size()));
+  stats()->AddExtraInfo("filter_predicates", std::to_string(plan_node_->predicates().size()));
+  if (sample_rate_ < 1.0) {
+    stats()->AddExtraInfo("sample_rate", std::to_string(sample_rate_));
+    stats()->AddExtraInfo("rows_skipped", std::to_string(rows_skipped_));
+  }
   return Status::OK();
 }
 
@@ -108,7 +231,12 @@ StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*
                                   /* eos */ cursor_->Done());
   }
 
-  PX_ASSIGN_OR_RETURN(auto row_batch, cursor_->GetNextRowBatch(plan_node_->Columns()));
+  std::unique_ptr<RowBatch> row_batch;
+  if (sample_rate_ < 1.0) {
+    PX_ASSIGN_OR_RETURN(row_batch, GetNextSampledRowBatch());
+  } else {
+    PX_ASSIGN_OR_RETURN(row_batch, cursor_->GetNextRowBatch(plan_node_->Columns()));
+  }
 
   rows_processed_ += row_batch->num_rows();
   bytes_processed_ += row_batch->NumBytes();
@@ -123,6 +251,27 @@ StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*
   return row_batch;
 }
 
+StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextSampledRowBatch() {
+  while (!keep_batch_(random_generator_)) {
+    PX_ASSIGN_OR_RETURN(int64_t num_skipped, cursor_->SkipNextRowBatch());
+    rows_skipped_ += num_skipped;
+    if (!cursor_->NextBatchReady()) {
+      return RowBatch::WithZeroRows(*output_descriptor_, /* eow */ false, /* eos */ false);
+    }
+  }
+  PX_ASSIGN_OR_RETURN(auto row_batch, cursor_->GetNextRowBatch(plan_node_->Columns()));
+
+  std::vector<int64_t> rows;
+  for (int64_t row = rows_to_next_sample_(random_generator_); row < row_batch->num_rows();
+       row += 1 + rows_to_next_sample_(random_generator_)) {
+    rows.push_back(row);
+  }
+  rows_skipped_ += row_batch->num_rows() - static_cast<int64_t>(rows.size());
+  std::vector<int64_t> cols(row_batch->num_columns());
+  std::iota(cols.begin(), cols.end(), 0);
+  return row_batch->Select(cols, std::move(rows));
+}
+
 Status MemorySourceNode::GenerateNextImpl(ExecState* exec_state) {
   PX_ASSIGN_OR_RETURN(auto row_batch, GetNextRowBatch(exec_state));
   PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, *row_batch));
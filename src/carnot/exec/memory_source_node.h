@@ -19,8 +19,12 @@
 #pragma once
 
 #include <stdint.h>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "src/carnot/exec/exec_node.h"
@@ -42,10 +46,27 @@ using table_store::schema::RowBatch;
 class MemorySourceNode : public SourceNode {
  public:
   MemorySourceNode() = default;
-  virtual ~MemorySourceNode() = default;
+  virtual ~MemorySourceNode();
 
   bool NextBatchReady() override;
 
+  /**
+   * Sets a callback that is called whenever a batch is written to the table of a streaming source,
+   * so the execution graph can wake up instead of waiting for its yield timeout. Must be called
+   * before Open.
+   */
+  void set_batch_ready_callback(std::function<void()> callback) {
+    batch_ready_callback_ = std::move(callback);
+  }
+
+  /**
+   * Sets predicates that every row this source is asked for satisfies (i.e. of the filters right
+   * downstream of it), so that the table can skip batches. Must be called before Open.
+   */
+  void set_table_predicates(std::vector<table_store::internal::ColumnPredicate> predicates) {
+    table_predicates_ = std::move(predicates);
+  }
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -56,14 +77,31 @@ class MemorySourceNode : public SourceNode {
 
  private:
   StatusOr<std::unique_ptr<RowBatch>> GetNextRowBatch(ExecState* exec_state);
+  // Reads the next batch of a sampled source. Batches are kept with probability
+  // sqrt(sample_rate), the others are skipped without reading their columns, and the rows of the
+  // kept batches are kept with probability sqrt(sample_rate).
+  StatusOr<std::unique_ptr<RowBatch>> GetNextSampledRowBatch();
   bool InfiniteStreamNextBatchReady();
+  void RemoveWriteListener();
   // Whether this memory source will stream future results.
   bool streaming_ = false;
 
+  double sample_rate_ = 1.0;
+  std::mt19937_64 random_generator_;
+  std::bernoulli_distribution keep_batch_;
+  // The number of rows to skip before the next sampled row of a batch.
+  std::geometric_distribution<int64_t> rows_to_next_sample_;
+  int64_t rows_skipped_ = 0;
+
   std::unique_ptr<Table::Cursor> cursor_;
+  std::vector<table_store::internal::ColumnPredicate> table_predicates_;
 
   std::unique_ptr<plan::MemorySourceOperator> plan_node_;
   table_store::Table* table_ = nullptr;
+
+  std::function<void()> batch_ready_callback_;
+  // Set while the callback listens to the writes of the table.
+  std::optional<int64_t> write_listener_id_;
 };
 
 }  // namespace exec
@@ -107,6 +107,86 @@ TEST_F(MemorySourceNodeTest, basic) {
   EXPECT_EQ(sizeof(int64_t) * 5, tester.node()->BytesProcessed());
 }
 
+TEST_F(MemorySourceNodeTest, filter_predicates) {
+  auto op_proto = planpb::testutils::CreateTestSource1PB();
+  // col1 == true, on a column the source doesn't output.
+  auto predicate = op_proto.mutable_mem_source_op()->add_predicates();
+  predicate->set_column_index(0);
+  predicate->set_op(planpb::ColumnPredicate::EQUAL);
+  predicate->mutable_value()->set_data_type(types::DataType::BOOLEAN);
+  predicate->mutable_value()->set_bool_value(true);
+  std::unique_ptr<plan::Operator> plan_node = plan::MemorySourceOperator::FromProto(op_proto, 1);
+  RowDescriptor output_rd({types::DataType::TIME64NS});
+
+  auto tester = exec::ExecNodeTester<MemorySourceNode, plan::MemorySourceOperator>(
+      *plan_node, output_rd, std::vector<RowDescriptor>({}), exec_state_.get());
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 2, /*eow*/ false, /*eos*/ false)
+          .AddColumn<types::Time64NSValue>({1, 3})
+          .get());
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 0, /*eow*/ true, /*eos*/ true)
+          .AddColumn<types::Time64NSValue>({})
+          .get());
+  EXPECT_FALSE(tester.node()->HasBatchesRemaining());
+  tester.Close();
+  EXPECT_EQ(2, tester.node()->RowsProcessed());
+}
+
+TEST_F(MemorySourceNodeTest, reverse) {
+  auto op_proto = planpb::testutils::CreateTestSource1PB();
+  op_proto.mutable_mem_source_op()->set_reverse(true);
+  std::unique_ptr<plan::Operator> plan_node = plan::MemorySourceOperator::FromProto(op_proto, 1);
+  RowDescriptor output_rd({types::DataType::TIME64NS});
+
+  auto tester = exec::ExecNodeTester<MemorySourceNode, plan::MemorySourceOperator>(
+      *plan_node, output_rd, std::vector<RowDescriptor>({}), exec_state_.get());
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 2, /*eow*/ false, /*eos*/ false)
+          .AddColumn<types::Time64NSValue>({6, 5})
+          .get());
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 3, /*eow*/ true, /*eos*/ true)
+          .AddColumn<types::Time64NSValue>({3, 2, 1})
+          .get());
+  EXPECT_FALSE(tester.node()->HasBatchesRemaining());
+  tester.Close();
+  EXPECT_EQ(5, tester.node()->RowsProcessed());
+}
+
+TEST_F(MemorySourceNodeTest, sampled) {
+  table_store::schema::Relation rel({types::DataType::BOOLEAN, types::DataType::TIME64NS},
+                                    {"col1", "time_"});
+  auto table = Table::Create("sampled", rel);
+  exec_state_->table_store()->AddTable("sampled", table);
+  for (int64_t batch = 0; batch < 100; ++batch) {
+    auto rb = RowBatch(RowDescriptor(rel.col_types()), 100);
+    std::vector<types::BoolValue> col1(100, true);
+    std::vector<types::Time64NSValue> time(100);
+    for (int64_t i = 0; i < 100; ++i) {
+      time[i] = batch * 100 + i;
+    }
+    EXPECT_OK(rb.AddColumn(types::ToArrow(col1, arrow::default_memory_pool())));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(time, arrow::default_memory_pool())));
+    EXPECT_OK(table->WriteRowBatch(rb));
+  }
+
+  auto op_proto = planpb::testutils::CreateTestSource1PB("sampled");
+  op_proto.mutable_mem_source_op()->set_sample_rate(0.25);
+  std::unique_ptr<plan::Operator> plan_node = plan::MemorySourceOperator::FromProto(op_proto, 1);
+  RowDescriptor output_rd({types::DataType::TIME64NS});
+
+  auto tester = exec::ExecNodeTester<MemorySourceNode, plan::MemorySourceOperator>(
+      *plan_node, output_rd, std::vector<RowDescriptor>({}), exec_state_.get());
+  while (tester.node()->HasBatchesRemaining()) {
+    tester.GenerateNextResult();
+  }
+  tester.Close();
+  // 2500 rows are expected, these bounds are more than 5 standard deviations away.
+  EXPECT_GT(tester.node()->RowsProcessed(), 1000);
+  EXPECT_LT(tester.node()->RowsProcessed(), 4000);
+}
+
 TEST_F(MemorySourceNodeTest, empty_table) {
   auto op_proto = planpb::testutils::CreateTestSource1PB("empty");
   std::unique_ptr<plan::Operator> plan_node = plan::MemorySourceOperator::FromProto(op_proto, 1);
@@ -322,18 +322,26 @@ class CoresetDriver {
   std::string ToJSON() const {
     rapidjson::StringBuffer sb;
     rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-    writer.StartObject();
-    writer.Key("base_set");
-    CurrentSet()->ToJSON(&writer);
-    writer.Key("coreset");
-    coreset_data_.ToJSON(&writer);
-    writer.EndObject();
+    ToJSON(&writer);
     return sb.GetString();
   }
 
+  void ToJSON(rapidjson::Writer<rapidjson::StringBuffer>* writer) const {
+    writer->StartObject();
+    writer->Key("base_set");
+    CurrentSet()->ToJSON(writer);
+    writer->Key("coreset");
+    coreset_data_.ToJSON(writer);
+    writer->EndObject();
+  }
+
   void FromJSON(std::string data) {
     rapidjson::Document doc;
     doc.Parse(data.data());
+    FromJSON(doc);
+  }
+
+  void FromJSON(const rapidjson::Document::ValueType& doc) {
     DCHECK(doc.IsObject());
     DCHECK(doc.HasMember("base_set"));
     DCHECK(doc.HasMember("coreset"));
@@ -17,22 +17,53 @@
  */
 
 #include "src/carnot/exec/ml/kmeans.h"
+#include <algorithm>
+#include <functional>
 #include <random>
+#include <vector>
 
 #include "src/carnot/exec/ml/sampling.h"
+#include "src/common/base/thread_pool.h"
+
+DEFINE_int32(carnot_kmeans_num_threads, gflags::Int32FromEnv("PL_CARNOT_KMEANS_NUM_THREADS", 4),
+             "The number of threads used to compute the distances between points and centroids "
+             "when fitting KMeans.");
 
 namespace px {
 namespace carnot {
 namespace exec {
 namespace ml {
 
+namespace {
+// The points are split into chunks of a fixed size, so that the results don't depend on the
+// number of threads.
+constexpr int kPointsPerChunk = 256;
+
+// The pool is shared by all of the KMeans fits running in this process. The calling thread
+// always participates in the work, so the pool holds one thread less than requested.
+ThreadPool* KMeansThreadPool() {
+  static ThreadPool pool(std::max(0, FLAGS_carnot_kmeans_num_threads - 1));
+  return &pool;
+}
+
+size_t NumChunks(int num_points) { return (num_points + kPointsPerChunk - 1) / kPointsPerChunk; }
+
+// Runs fn(chunk, begin, end) for every chunk of the points in [0, num_points), in parallel.
+void ParallelForChunks(int num_points, const std::function<void(size_t, int, int)>& fn) {
+  KMeansThreadPool()->ParallelFor(NumChunks(num_points), [num_points, &fn](size_t chunk) {
+    int begin = static_cast<int>(chunk) * kPointsPerChunk;
+    fn(chunk, begin, std::min(num_points, begin + kPointsPerChunk));
+  });
+}
+}  // namespace
+
 void KMeans::Fit(std::shared_ptr<WeightedPointSet> set) {
   if (set->size() < 2) {
     LOG(ERROR) << "Fitting KMeans on less than 2 points is currently unsupported.";
     return;
   }
-  auto points = set->points();
-  auto weights = set->weights();
+  const auto& points = set->points();
+  const auto& weights = set->weights();
 
   centroids_.resize(k_, points.cols());
   switch (init_type_) {
@@ -52,15 +83,30 @@ bool KMeans::LloydsIteration(const Eigen::MatrixXf& points, const Eigen::VectorX
   Eigen::MatrixXf new_centroids = Eigen::MatrixXf::Zero(centroids_.rows(), centroids_.cols());
   Eigen::ArrayXf centroid_weights = Eigen::ArrayXf::Zero(centroids_.rows());
 
-  for (int i = 0; i < points.rows(); i++) {
-    Eigen::VectorXf::Index closest_centroid;
-    (centroids_.rowwise() - points(i, Eigen::indexing::all))
-        .rowwise()
-        .squaredNorm()
-        .minCoeff(&closest_centroid);
-    new_centroids(closest_centroid, Eigen::indexing::all) +=
-        weights(i) * points(i, Eigen::indexing::all);
-    centroid_weights(closest_centroid) += weights(i);
+  // Each chunk of points accumulates its own sums, which are then added up in order.
+  size_t num_chunks = NumChunks(points.rows());
+  std::vector<Eigen::MatrixXf> chunk_centroids(num_chunks, new_centroids);
+  std::vector<Eigen::ArrayXf> chunk_weights(num_chunks, centroid_weights);
+  Eigen::VectorXf centroid_norms = centroids_.rowwise().squaredNorm();
+  ParallelForChunks(points.rows(), [&](size_t chunk, int begin, int end) {
+    Eigen::MatrixXf& sums = chunk_centroids[chunk];
+    Eigen::ArrayXf& sum_weights = chunk_weights[chunk];
+    // ||p - c||^2 = ||p||^2 - 2 p.c + ||c||^2, and ||p||^2 doesn't change the closest centroid,
+    // so the distances of the whole chunk are computed with a single matrix product.
+    Eigen::MatrixXf dists =
+        (-2.0f * points(Eigen::seq(begin, end - 1), Eigen::indexing::all) * centroids_.transpose())
+            .rowwise() +
+        centroid_norms.transpose();
+    for (int i = begin; i < end; i++) {
+      Eigen::VectorXf::Index closest_centroid;
+      dists(i - begin, Eigen::indexing::all).minCoeff(&closest_centroid);
+      sums(closest_centroid, Eigen::indexing::all) += weights(i) * points(i, Eigen::indexing::all);
+      sum_weights(closest_centroid) += weights(i);
+    }
+  });
+  for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+    new_centroids += chunk_centroids[chunk];
+    centroid_weights += chunk_weights[chunk];
   }
 
   for (int i = 0; i < k_; i++) {
@@ -83,17 +129,21 @@ void KMeans::KMeansPlusPlusInit(const Eigen::MatrixXf& points, const Eigen::Vect
   auto firstCentroid = dist(random_gen_);
   centroids_(0, Eigen::indexing::all) = points(firstCentroid, Eigen::indexing::all);
 
+  // The distance of each point to its closest centroid only has to be updated with the distance
+  // to the newest centroid, instead of recomputing it for all of the previous centroids.
+  Eigen::VectorXf minDist(points.rows());
   Eigen::VectorXf probDist(points.rows());
   for (auto i = 1; i < k_; i++) {
-    for (auto j = 0; j < probDist.rows(); j++) {
-      auto point = points(j, Eigen::indexing::all);
-      Eigen::VectorXf::Index closestCentroid;
-      auto dist = (centroids_(Eigen::seq(0, i - 1), Eigen::indexing::all).rowwise() - point)
-                      .rowwise()
-                      .squaredNorm()
-                      .minCoeff(&closestCentroid);
-      probDist(j) = weights(j) * dist;
-    }
+    auto newCentroid = centroids_(i - 1, Eigen::indexing::all);
+    ParallelForChunks(points.rows(), [&](size_t, int begin, int end) {
+      for (auto j = begin; j < end; j++) {
+        float dist = (newCentroid - points(j, Eigen::indexing::all)).squaredNorm();
+        if (i == 1 || dist < minDist(j)) {
+          minDist(j) = dist;
+        }
+        probDist(j) = weights(j) * minDist(j);
+      }
+    });
     std::discrete_distribution<> pointDist(probDist.begin(), probDist.end());
     auto ind = pointDist(random_gen_);
     centroids_(i, Eigen::indexing::all) = points(ind, Eigen::indexing::all);
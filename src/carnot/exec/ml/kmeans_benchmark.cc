@@ -40,6 +40,22 @@ static void BM_KMeansFit(benchmark::State& state) {
   }
 }
 
+// NOLINTNEXTLINE : runtime/references.
+static void BM_KMeansFitManyPoints(benchmark::State& state) {
+  int k = 10;
+  int d = 64;
+  KMeans kmeans(k);
+
+  Eigen::MatrixXf points = Eigen::MatrixXf::Random(state.range(0), d);
+  Eigen::VectorXf weights = Eigen::VectorXf::Ones(state.range(0));
+  auto set = std::make_shared<WeightedPointSet>(points, weights);
+
+  for (auto _ : state) {
+    kmeans.Fit(set);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
 // NOLINTNEXTLINE : runtime/references.
 static void BM_KMeansTransform(benchmark::State& state) {
   int k = 10;
@@ -59,4 +75,5 @@ static void BM_KMeansTransform(benchmark::State& state) {
 }
 
 BENCHMARK(BM_KMeansFit);
+BENCHMARK(BM_KMeansFitManyPoints)->RangeMultiplier(10)->Range(1000, 100000);
 BENCHMARK(BM_KMeansTransform);
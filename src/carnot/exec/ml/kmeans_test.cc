@@ -97,6 +97,26 @@ TEST(KMeans, trimodal_normal_dist) {
   }
 }
 
+TEST(KMeans, many_points) {
+  int k = 3;
+  int num_copies = 50;
+
+  // Enough points to be split into several chunks when computing the distances.
+  Eigen::MatrixXf data = kmeans_test_data();
+  Eigen::MatrixXf points(data.rows() * num_copies, data.cols());
+  for (int i = 0; i < num_copies; i++) {
+    points(Eigen::seq(i * data.rows(), (i + 1) * data.rows() - 1), Eigen::indexing::all) = data;
+  }
+  Eigen::VectorXf weights = Eigen::VectorXf::Ones(points.rows());
+
+  auto set = std::make_shared<WeightedPointSet>(points, weights);
+
+  KMeans kmeans(k);
+  kmeans.Fit(set);
+
+  EXPECT_THAT(kmeans.centroids(), UnorderedRowsAre(kmeans_expected_centroids(), 0.15));
+}
+
 }  // namespace ml
 }  // namespace exec
 }  // namespace carnot
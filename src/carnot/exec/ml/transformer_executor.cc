@@ -18,14 +18,17 @@
 
 #include "src/carnot/exec/ml/transformer_executor.h"
 
+#include <algorithm>
+#include <utility>
+
 namespace px {
 namespace carnot {
 namespace exec {
 namespace ml {
 
-static int load_ints_from_json(std::string in, int32_t* arr, int max_num) {
+static int load_ints_from_json(std::string_view in, int32_t* arr, int max_num) {
   rapidjson::Document d;
-  rapidjson::ParseResult ok = d.Parse(in.data());
+  rapidjson::ParseResult ok = d.Parse(in.data(), in.size());
   // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
   if (ok == nullptr) {
     return 0;
@@ -50,56 +53,105 @@ static int load_ints_from_json(std::string in, int32_t* arr, int max_num) {
 }
 
 void TransformerExecutor::Execute(std::string doc, std::string* out) {
-  // LOG(INFO) << "inputs: " << tf_interpreter_->inputs().size() << "\n";
-  // LOG(INFO) << "input(0) name: " << tf_interpreter_->GetInputName(0) << "\n";
+  std::vector<std::string> outs;
+  ExecuteBatch({doc}, &outs);
+  *out = std::move(outs[0]);
+}
+
+void TransformerExecutor::ExecuteBatch(const std::vector<std::string_view>& docs,
+                                       std::vector<std::string>* outs) {
+  outs->resize(docs.size());
+  for (size_t start = 0; start < docs.size();) {
+    size_t max_batch_size = supports_batching_ ? kMaxBatchSize : 1;
+    size_t num_docs = std::min(max_batch_size, docs.size() - start);
+    ExecuteChunk(docs.data() + start, num_docs, outs->data() + start);
+    start += num_docs;
+  }
+}
+
+bool TransformerExecutor::ResizeBatch(int batch_size) {
+  if (batch_size == batch_size_) {
+    return true;
+  }
+  tf_interpreter_->ResizeInputTensor(tf_interpreter_->inputs()[0], {batch_size, max_length_});
+  if (tf_interpreter_->AllocateTensors() != kTfLiteOk) {
+    LOG(INFO) << "Failed to allocate tensors";
+    batch_size_ = 0;
+    return false;
+  }
+  batch_size_ = batch_size;
+  return true;
+}
 
-  // int t_size = tf_interpreter_->tensors_size();
-  // for (int i = 0; i < t_size; i++) {
-  //   if (tf_interpreter_->tensor(i)->name) {
-  //     LOG(INFO) << i << ": " << tf_interpreter_->tensor(i)->name << ", "
-  //               << tf_interpreter_->tensor(i)->bytes << ", "
-  //               << tf_interpreter_->tensor(i)->type;
-  //   }
-  // }
+void TransformerExecutor::ExecuteChunk(const std::string_view* docs, size_t num_docs,
+                                       std::string* outs) {
+  for (size_t i = 0; i < num_docs; ++i) {
+    outs[i].clear();
+  }
+  if (!ResizeBatch(static_cast<int>(num_docs))) {
+    return;
+  }
   auto input = tf_interpreter_->typed_input_tensor<int32_t>(0);
   if (input == nullptr) {
     LOG(INFO) << "Error getting typed input tensor, most likely using wrong type for this model";
-    *out = "";
     return;
   }
 
-  auto count = load_ints_from_json(doc, input, max_length_);
-  if (count == 0) {
-    // Either input array was empty or there was an error parsing the json, either way don't
-    // continue.
-    *out = "";
+  valid_docs_.assign(num_docs, false);
+  bool any_valid = false;
+  for (size_t i = 0; i < num_docs; ++i) {
+    int32_t* row = input + i * max_length_;
+    auto count = load_ints_from_json(docs[i], row, max_length_);
+    // Either input array was empty or there was an error parsing the json, either way the doc
+    // gets an empty embedding, but its row is still padded since the batch is inferred at once.
+    valid_docs_[i] = count > 0;
+    any_valid |= valid_docs_[i];
+
+    // Add 1 to each token to account for pad token.
+    for (int j = 0; j < count; j++) {
+      row[j] = row[j] + 1;
+    }
+    for (int j = count; j < max_length_; j++) {
+      row[j] = 0;
+    }
+  }
+  if (!any_valid) {
     return;
   }
 
-  // Add 1 to each token to account for pad token.
-  for (int i = 0; i < count; i++) {
-    input[i] = input[i] + 1;
+  if (tf_interpreter_->Invoke() != kTfLiteOk) {
+    LOG(INFO) << "Failed to run the transformer model";
+    return;
   }
 
-  for (int i = count; i < max_length_; i++) {
-    input[i] = 0;
+  const TfLiteTensor* output_tensor = tf_interpreter_->tensor(tf_interpreter_->outputs()[0]);
+  if (num_docs > 1 && output_tensor->dims->data[0] != static_cast<int>(num_docs)) {
+    // The model has a fixed batch size, fall back to inferring the docs one at a time.
+    LOG(INFO) << "Transformer model doesn't support batching";
+    supports_batching_ = false;
+    for (size_t i = 0; i < num_docs; ++i) {
+      ExecuteChunk(docs + i, 1, outs + i);
+    }
+    return;
   }
-
-  const int embedding_size = 256;
-
-  tf_interpreter_->Invoke();
-
   auto output = tf_interpreter_->typed_output_tensor<float>(0);
 
   // Copy output to json array.
   rapidjson::StringBuffer sb;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-  writer.StartArray();
-  for (int i = 0; i < embedding_size; i++) {
-    writer.Double(output[i]);
+  for (size_t i = 0; i < num_docs; ++i) {
+    if (!valid_docs_[i]) {
+      continue;
+    }
+    sb.Clear();
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+    writer.StartArray();
+    const float* embedding = output + i * kEmbeddingSize;
+    for (int j = 0; j < kEmbeddingSize; j++) {
+      writer.Double(embedding[j]);
+    }
+    writer.EndArray();
+    outs[i] = sb.GetString();
   }
-  writer.EndArray();
-  *out = sb.GetString();
 }
 
 }  // namespace ml
@@ -26,6 +26,8 @@
 #include <tensorflow/lite/model.h>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 #include "src/carnot/udf/model_executor.h"
 #include "src/common/base/utils.h"
 
@@ -36,29 +38,48 @@ namespace ml {
 
 class TransformerExecutor : public udf::ModelExecutor {
  public:
-  TransformerExecutor() : TransformerExecutor("/embedding.proto") {}
+  static constexpr char kDefaultModelPath[] = "/embedding.proto";
+
+  TransformerExecutor() : TransformerExecutor(kDefaultModelPath) {}
   explicit TransformerExecutor(std::string model_proto_path) { Init(model_proto_path); }
 
   static constexpr udf::ModelType Type() { return udf::kTransformer; }
 
+  // Documents are inferred in batches of up to this many, with a single invocation per batch.
+  static constexpr size_t kMaxBatchSize = 32;
+
   void Init(std::string model_proto_path) {
     model_ = tflite::FlatBufferModel::BuildFromFile(model_proto_path.c_str());
     tflite::ops::builtin::BuiltinOpResolver resolver;
     tflite::InterpreterBuilder(*model_, resolver)(&tf_interpreter_);
-    tf_interpreter_->ResizeInputTensor(tf_interpreter_->inputs()[0], {1, max_length_});
-    if (tf_interpreter_->AllocateTensors() != kTfLiteOk) {
-      LOG(INFO) << "Failed to allocate tensors";
-    } else {
+    if (ResizeBatch(1)) {
       LOG(INFO) << "Init Transformer model";
     }
   }
 
   void Execute(std::string doc, std::string* out);
 
+  /**
+   * Computes the embeddings of all of the docs, outs is resized to hold one per doc. Docs that
+   * aren't a valid json array of tokens get an empty embedding, like with Execute.
+   */
+  void ExecuteBatch(const std::vector<std::string_view>& docs, std::vector<std::string>* outs);
+
  private:
+  // Resizes the input tensor to hold batch_size docs, if it doesn't already.
+  bool ResizeBatch(int batch_size);
+  void ExecuteChunk(const std::string_view* docs, size_t num_docs, std::string* outs);
+
+  static constexpr int kEmbeddingSize = 256;
+
   std::unique_ptr<tflite::Interpreter> tf_interpreter_;
   std::unique_ptr<tflite::FlatBufferModel> model_;
   int max_length_ = 64;
+  int batch_size_ = 0;
+  // Cleared if the model turns out to have a fixed batch size, in which case docs are inferred
+  // one at a time.
+  bool supports_batching_ = true;
+  std::vector<bool> valid_docs_;
 };
 
 }  // namespace ml
@@ -20,24 +20,49 @@
 
 #include <rapidjson/document.h>
 #include <simdutf.h>
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <queue>
 #include <random>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#include <absl/strings/str_cat.h>
 #include <absl/strings/substitute.h>
 
 #include "glog/logging.h"
 #include "src/carnot/carnotpb/carnot.pb.h"
 #include "src/carnot/planpb/plan.pb.h"
 #include "src/common/base/macros.h"
+#include "src/common/base/thread_pool.h"
 #include "src/common/uuid/uuid_utils.h"
 #include "src/shared/types/typespb/types.pb.h"
 #include "src/table_store/table_store.h"
 
+DEFINE_int32(carnot_otel_export_num_threads,
+             gflags::Int32FromEnv("PL_CARNOT_OTEL_EXPORT_NUM_THREADS", 8),
+             "The number of threads that send OTel export requests, shared by all of the OTel "
+             "export sinks. 0 sends the requests synchronously from the query.");
+DEFINE_int32(carnot_otel_export_max_inflight_requests,
+             gflags::Int32FromEnv("PL_CARNOT_OTEL_EXPORT_MAX_INFLIGHT_REQUESTS", 4),
+             "The number of export requests an OTel export sink can have in flight before it "
+             "waits for one of them to finish.");
+DEFINE_int64(carnot_otel_export_batch_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_OTEL_EXPORT_BATCH_BYTES", 1024 * 1024),
+             "The size an OTel export request is coalesced up to, across row batches, before it "
+             "is sent. 0 sends a request per row batch.");
+DEFINE_int32(carnot_otel_export_batch_delay_ms,
+             gflags::Int32FromEnv("PL_CARNOT_OTEL_EXPORT_BATCH_DELAY_MS", 1000),
+             "The longest time rows are held back to coalesce them with later row batches. It is "
+             "checked when row batches arrive, and the eos batch always sends the pending rows.");
+DEFINE_int32(carnot_otel_export_channels, gflags::Int32FromEnv("PL_CARNOT_OTEL_EXPORT_CHANNELS", 2),
+             "The number of channels an OTel export sink spreads its requests over.");
+DEFINE_bool(carnot_otel_export_gzip, gflags::BoolFromEnv("PL_CARNOT_OTEL_EXPORT_GZIP", true),
+            "Whether OTel export requests are gzip compressed.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -50,6 +75,21 @@ const int64_t kOTelTraceIDLength = 16;
 
 const int64_t kB3ShortTraceIDLength = 8;
 
+using ::opentelemetry::proto::collector::trace::v1::ExportTraceServiceRequest;
+
+namespace {
+ThreadPool* OTelExportThreadPool() {
+  static ThreadPool pool(std::max(0, FLAGS_carnot_otel_export_num_threads));
+  return &pool;
+}
+}  // namespace
+
+OTelExportSinkNode::~OTelExportSinkNode() {
+  // The export threads reference this node until their requests finished.
+  absl::MutexLock lock(&export_lock_);
+  export_lock_.Await(absl::Condition(this, &OTelExportSinkNode::ExportsDone));
+}
+
 std::string OTelExportSinkNode::DebugStringImpl() {
   return absl::Substitute("Exec::OTelExportSinkNode: $0", plan_node_->DebugString());
 }
@@ -64,18 +104,29 @@ Status OTelExportSinkNode::InitImpl(const plan::Operator& plan_node) {
   input_descriptor_ = std::make_unique<RowDescriptor>(input_descriptors_[0]);
   const auto* sink_plan_node = static_cast<const plan::OTelExportSinkOperator*>(&plan_node);
   plan_node_ = std::make_unique<plan::OTelExportSinkOperator>(*sink_plan_node);
+  for (const auto& metric_pb : plan_node_->metrics()) {
+    has_sum_metrics_ |= metric_pb.has_sum();
+  }
   return Status::OK();
 }
 
 Status OTelExportSinkNode::PrepareImpl(ExecState*) { return Status::OK(); }
 
 Status OTelExportSinkNode::OpenImpl(ExecState* exec_state) {
-  if (plan_node_->metrics().size()) {
-    metrics_service_stub_ =
-        exec_state->MetricsServiceStub(plan_node_->url(), plan_node_->insecure());
+  if (!plan_node_->export_state_key().empty() && exec_state->otel_export_states() != nullptr) {
+    export_state_ = exec_state->otel_export_states()->Get(plan_node_->export_state_key());
+  } else {
+    export_state_ = std::make_shared<OTelExportState>();
   }
-  if (plan_node_->spans().size()) {
-    trace_service_stub_ = exec_state->TraceServiceStub(plan_node_->url(), plan_node_->insecure());
+  for (int channel = 0; channel < std::max(1, FLAGS_carnot_otel_export_channels); ++channel) {
+    if (plan_node_->metrics().size()) {
+      metrics_service_stubs_.push_back(
+          exec_state->MetricsServiceStub(plan_node_->url(), plan_node_->insecure(), channel));
+    }
+    if (plan_node_->spans().size()) {
+      trace_service_stubs_.push_back(
+          exec_state->TraceServiceStub(plan_node_->url(), plan_node_->insecure(), channel));
+    }
   }
   return Status::OK();
 }
@@ -88,6 +139,15 @@ Status OTelExportSinkNode::CloseImpl(ExecState* exec_state) {
   LOG(INFO) << absl::Substitute("Closing OTelExportSinkNode $0 in query $1 before receiving EOS",
                                 plan_node_->id(), exec_state->query_id().str());
 
+  // Still export the rows received so far, like the row batches exported before the close.
+  Status s = MaybeFlush(exec_state, /*force*/ true);
+  if (s.ok()) {
+    s = WaitForExports();
+  }
+  if (!s.ok()) {
+    LOG(WARNING) << absl::Substitute("OTelExportSinkNode $0 in query $1 failed to export: $2",
+                                     plan_node_->id(), exec_state->query_id().str(), s.msg());
+  }
   return Status::OK();
 }
 
@@ -214,22 +274,179 @@ Status FormatOTelStatus(int64_t id, const grpc::Status& status) {
       magic_enum::enum_name(status.error_code()), status.error_message(), status.error_details()));
 }
 
-using ::opentelemetry::proto::metrics::v1::ResourceMetrics;
-Status OTelExportSinkNode::ConsumeMetrics(ExecState* exec_state, const RowBatch& rb) {
-  grpc::ClientContext context;
+void OTelExportSinkNode::PrepareContext(grpc::ClientContext* context) {
   for (const auto& header : plan_node_->endpoint_headers()) {
-    context.AddMetadata(header.first, header.second);
+    context->AddMetadata(header.first, header.second);
+  }
+  context->set_compression_algorithm(FLAGS_carnot_otel_export_gzip ? GRPC_COMPRESS_GZIP
+                                                                   : GRPC_COMPRESS_NONE);
+
+  // Set timeout, to avoid blocking on query.
+  if (plan_node_->timeout() > 0) {
+    std::chrono::system_clock::time_point deadline =
+        std::chrono::system_clock::now() + std::chrono::seconds{plan_node_->timeout()};
+    context->set_deadline(deadline);
+  }
+}
+
+bool OTelExportSinkNode::HasExportSlot() {
+  return num_inflight_exports_ < std::max(1, FLAGS_carnot_otel_export_max_inflight_requests) ||
+         !export_status_.ok();
+}
+
+bool OTelExportSinkNode::ExportsDone() { return num_inflight_exports_ == 0; }
+
+Status OTelExportSinkNode::ExportStatus() {
+  absl::MutexLock lock(&export_lock_);
+  return export_status_;
+}
+
+Status OTelExportSinkNode::WaitForExports() {
+  absl::MutexLock lock(&export_lock_);
+  export_lock_.Await(absl::Condition(this, &OTelExportSinkNode::ExportsDone));
+  return export_status_;
+}
+
+void OTelExportSinkNode::FinishExport(ExecState* exec_state, bool spans,
+                                      const grpc::Status& status) {
+  absl::MutexLock lock(&export_lock_);
+  --num_inflight_exports_;
+  if (status.ok()) {
+    return;
+  }
+  if (status.error_code() == grpc::StatusCode::DEADLINE_EXCEEDED) {
+    if (spans) {
+      exec_state->exec_metrics()->otlp_spans_timeout_counter.Increment();
+    } else {
+      exec_state->exec_metrics()->otlp_metrics_timeout_counter.Increment();
+    }
+  }
+  // Keep the first error, later ones are usually caused by the same problem.
+  if (export_status_.ok()) {
+    export_status_ = FormatOTelStatus(plan_node_->id(), status);
+  }
+}
+
+template <typename TResponse, typename TStub, typename TRequest>
+Status OTelExportSinkNode::Export(ExecState* exec_state, TStub* stub, TRequest* request) {
+  {
+    absl::MutexLock lock(&export_lock_);
+    export_lock_.Await(absl::Condition(this, &OTelExportSinkNode::HasExportSlot));
+    PX_RETURN_IF_ERROR(export_status_);
+    ++num_inflight_exports_;
+  }
+
+  // The task has to be copyable, so the request is shared with it.
+  auto shared_request = std::make_shared<TRequest>();
+  shared_request->Swap(request);
+  auto send = [this, exec_state, stub, shared_request]() {
+    grpc::ClientContext context;
+    PrepareContext(&context);
+    TResponse response;
+    FinishExport(exec_state, std::is_same_v<TRequest, ExportTraceServiceRequest>,
+                 stub->Export(&context, *shared_request, &response));
+  };
+
+  ThreadPool* pool = OTelExportThreadPool();
+  if (pool->num_threads() == 0) {
+    send();
+    return ExportStatus();
+  }
+  pool->Schedule(std::move(send));
+  return Status::OK();
+}
+
+Status OTelExportSinkNode::MaybeFlush(ExecState* exec_state, bool force) {
+  if (pending_metrics_.resource_metrics_size() == 0 && pending_spans_.resource_spans_size() == 0) {
+    return Status::OK();
   }
-  context.set_compression_algorithm(GRPC_COMPRESS_GZIP);
+  auto pending_for = std::chrono::steady_clock::now() - pending_since_;
+  if (!force && static_cast<int64_t>(pending_bytes_) < FLAGS_carnot_otel_export_batch_bytes &&
+      pending_for < std::chrono::milliseconds(FLAGS_carnot_otel_export_batch_delay_ms)) {
+    return Status::OK();
+  }
+
+  if (pending_metrics_.resource_metrics_size()) {
+    auto stub = metrics_service_stubs_[next_stub_++ % metrics_service_stubs_.size()];
+    PX_RETURN_IF_ERROR(
+        Export<opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceResponse>(
+            exec_state, stub, &pending_metrics_));
+  }
+  if (pending_spans_.resource_spans_size()) {
+    auto stub = trace_service_stubs_[next_stub_++ % trace_service_stubs_.size()];
+    PX_RETURN_IF_ERROR(
+        Export<opentelemetry::proto::collector::trace::v1::ExportTraceServiceResponse>(
+            exec_state, stub, &pending_spans_));
+  }
+  pending_metrics_.Clear();
+  pending_spans_.Clear();
+  pending_bytes_ = 0;
+  return Status::OK();
+}
+
+bool OTelExportSinkNode::AddSumDataPoint(const planpb::OTelMetric& metric_pb,
+                                         std::string_view resource_key, const RowBatch& rb,
+                                         int64_t row_idx,
+                                         ::opentelemetry::proto::metrics::v1::Metric* metric) {
+  auto sum = metric->mutable_sum();
+  sum->set_aggregation_temporality(
+      ::opentelemetry::proto::metrics::v1::AGGREGATION_TEMPORALITY_CUMULATIVE);
+  sum->set_is_monotonic(true);
+  auto data_point = sum->add_data_points();
+  AddAttributes(data_point->mutable_attributes(), metric_pb.attributes(), rb, row_idx);
+
+  auto time_col = rb.ColumnAt(metric_pb.time_column_index()).get();
+  int64_t time_ns = types::GetValueFromArrowArray<types::TIME64NS>(time_col, row_idx);
+  data_point->set_time_unix_nano(time_ns);
+
+  std::string key = absl::StrCat(metric_pb.name(), resource_key);
+  for (const auto& attribute : data_point->attributes()) {
+    absl::StrAppend(&key, attribute.SerializeAsString());
+  }
+
+  OTelExportState* state = export_state_.get();
+  absl::MutexLock lock(&state->mu());
+  OTelSumSeries* series = state->GetSeries(key);
+  auto watermark = series_watermarks_.try_emplace(key, series->last_time_ns).first->second;
+  if (time_ns <= watermark) {
+    return false;
+  }
+  if (series->start_time_ns == 0) {
+    series->start_time_ns = time_ns;
+  }
+  series->last_time_ns = std::max(series->last_time_ns, time_ns);
+  data_point->set_start_time_unix_nano(series->start_time_ns);
+  if (metric_pb.sum().has_float_column_index()) {
+    auto double_col = rb.ColumnAt(metric_pb.sum().float_column_index()).get();
+    series->double_total += types::GetValueFromArrowArray<types::FLOAT64>(double_col, row_idx);
+    data_point->set_as_double(series->double_total);
+  } else {
+    auto int_col = rb.ColumnAt(metric_pb.sum().int_column_index()).get();
+    series->int_total += types::GetValueFromArrowArray<types::INT64>(int_col, row_idx);
+    data_point->set_as_int(series->int_total);
+  }
+  return true;
+}
 
-  metrics_response_.Clear();
-  opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest request;
+using ::opentelemetry::proto::metrics::v1::ResourceMetrics;
+Status OTelExportSinkNode::ConsumeMetrics(ExecState*, const RowBatch& rb) {
+  auto& request = pending_metrics_;
 
   for (int64_t row_idx = 0; row_idx < rb.ColumnAt(0)->length(); ++row_idx) {
     ::opentelemetry::proto::metrics::v1::ResourceMetrics resource_metrics;
     auto resource = resource_metrics.mutable_resource();
     AddAttributes(resource->mutable_attributes(), plan_node_->resource_attributes_normal_encoding(),
                   rb, row_idx);
+    // The series of a Sum metric are identified by the resource and the data point attributes.
+    std::string resource_key;
+    if (has_sum_metrics_) {
+      resource_key = resource->SerializeAsString();
+      for (const auto& attribute : plan_node_->resource_attributes_optional_json_encoded()) {
+        auto attribute_col = rb.ColumnAt(attribute.column().column_index()).get();
+        absl::StrAppend(&resource_key,
+                        types::GetValueFromArrowArray<types::STRING>(attribute_col, row_idx));
+      }
+    }
     // TODO(philkuz) optimize by pooling metrics by resource within a batch.
     // TODO(philkuz) optimize by pooling data per metric per resource.
 
@@ -280,31 +497,23 @@ Status OTelExportSinkNode::ConsumeMetrics(ExecState* exec_state, const RowBatch&
           auto int_col = rb.ColumnAt(metric_pb.gauge().int_column_index()).get();
           data_point->set_as_int(types::GetValueFromArrowArray<types::INT64>(int_col, row_idx));
         }
+      } else if (metric_pb.has_sum()) {
+        if (!AddSumDataPoint(metric_pb, resource_key, rb, row_idx, metric)) {
+          library_metrics->mutable_metrics()->RemoveLast();
+        }
       }
     }
+    if (library_metrics->metrics_size() == 0) {
+      continue;
+    }
     ReplicateData<ResourceMetrics>(
         plan_node_->resource_attributes_optional_json_encoded(),
-        [&request](ResourceMetrics metrics) {
+        [this, &request](ResourceMetrics metrics) {
+          pending_bytes_ += metrics.ByteSizeLong();
           *request.add_resource_metrics() = std::move(metrics);
         },
         std::move(resource_metrics), rb, row_idx);
   }
-
-  // Set timeout, to avoid blocking on query.
-  if (plan_node_->timeout() > 0) {
-    std::chrono::system_clock::time_point deadline =
-        std::chrono::system_clock::now() + std::chrono::seconds{plan_node_->timeout()};
-    context.set_deadline(deadline);
-  }
-
-  grpc::Status status = metrics_service_stub_->Export(&context, request, &metrics_response_);
-  if (!status.ok()) {
-    if (status.error_code() == grpc::StatusCode::DEADLINE_EXCEEDED) {
-      exec_state->exec_metrics()->otlp_metrics_timeout_counter.Increment();
-    }
-
-    return FormatOTelStatus(plan_node_->id(), status);
-  }
   return Status::OK();
 }
 
@@ -333,15 +542,8 @@ std::string GenerateID(uint64_t num_bytes) {
 }
 
 using ::opentelemetry::proto::trace::v1::ResourceSpans;
-Status OTelExportSinkNode::ConsumeSpans(ExecState* exec_state, const RowBatch& rb) {
-  grpc::ClientContext context;
-  for (const auto& header : plan_node_->endpoint_headers()) {
-    context.AddMetadata(header.first, header.second);
-  }
-  context.set_compression_algorithm(GRPC_COMPRESS_GZIP);
-
-  metrics_response_.Clear();
-  opentelemetry::proto::collector::trace::v1::ExportTraceServiceRequest request;
+Status OTelExportSinkNode::ConsumeSpans(ExecState*, const RowBatch& rb) {
+  auto& request = pending_spans_;
 
   for (int64_t row_idx = 0; row_idx < rb.ColumnAt(0)->length(); ++row_idx) {
     // TODO(philkuz) aggregate spans by resource.
@@ -417,35 +619,30 @@ Status OTelExportSinkNode::ConsumeSpans(ExecState* exec_state, const RowBatch& r
 
     ReplicateData<ResourceSpans>(
         plan_node_->resource_attributes_optional_json_encoded(),
-        [&request](ResourceSpans span) { *request.add_resource_spans() = std::move(span); },
+        [this, &request](ResourceSpans span) {
+          pending_bytes_ += span.ByteSizeLong();
+          *request.add_resource_spans() = std::move(span);
+        },
         std::move(resource_spans), rb, row_idx);
   }
-  // Set timeout, to avoid blocking on query.
-  if (plan_node_->timeout() > 0) {
-    std::chrono::system_clock::time_point deadline =
-        std::chrono::system_clock::now() + std::chrono::seconds{plan_node_->timeout()};
-    context.set_deadline(deadline);
-  }
-
-  grpc::Status status = trace_service_stub_->Export(&context, request, &trace_response_);
-  if (!status.ok()) {
-    if (status.error_code() == grpc::StatusCode::DEADLINE_EXCEEDED) {
-      exec_state->exec_metrics()->otlp_spans_timeout_counter.Increment();
-    }
-
-    return FormatOTelStatus(plan_node_->id(), status);
-  }
   return Status::OK();
 }
 
 Status OTelExportSinkNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  // Report exports of previous row batches that failed in the meantime.
+  PX_RETURN_IF_ERROR(ExportStatus());
+  if (pending_bytes_ == 0) {
+    pending_since_ = std::chrono::steady_clock::now();
+  }
   if (plan_node_->metrics().size()) {
     PX_RETURN_IF_ERROR(ConsumeMetrics(exec_state, rb));
   }
   if (plan_node_->spans().size()) {
     PX_RETURN_IF_ERROR(ConsumeSpans(exec_state, rb));
   }
+  PX_RETURN_IF_ERROR(MaybeFlush(exec_state, rb.eos()));
   if (rb.eos()) {
+    PX_RETURN_IF_ERROR(WaitForExports());
     sent_eos_ = true;
   }
   return Status::OK();
@@ -18,17 +18,31 @@
 #pragma once
 
 #include <grpcpp/grpcpp.h>
+#include <chrono>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
 
 #include "opentelemetry/proto/collector/metrics/v1/metrics_service.grpc.pb.h"
 #include "opentelemetry/proto/collector/metrics/v1/metrics_service.pb.h"
 
 #include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/otel_export_state.h"
 #include "src/carnot/planpb/plan.pb.h"
 #include "src/common/base/base.h"
 #include "src/shared/types/types.h"
 
+DECLARE_int32(carnot_otel_export_num_threads);
+DECLARE_int32(carnot_otel_export_max_inflight_requests);
+DECLARE_int64(carnot_otel_export_batch_bytes);
+DECLARE_int32(carnot_otel_export_batch_delay_ms);
+DECLARE_int32(carnot_otel_export_channels);
+DECLARE_bool(carnot_otel_export_gzip);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -37,9 +51,23 @@ struct SpanConfig {
   std::string name;
 };
 
+/**
+ * OTelExportSinkNode converts its input into OTel metrics and spans and exports them to a
+ * collector.
+ *
+ * Exports don't block the query on the collector: the rows of consecutive batches are coalesced
+ * into a single request until it is large or old enough, and requests are sent by a thread pool
+ * shared by all export sinks, round robin over several channels to the collector. The number of
+ * requests in flight per sink is bounded, past that ConsumeNext waits for one of them to finish.
+ * Failed exports are reported by the next ConsumeNext, and the eos batch waits for every export.
+ *
+ * Sum metrics are exported as cumulative sums: the increase in each row is added to the running
+ * total of its series, which is kept between the runs of the script in the engine's
+ * OTelExportStateStore.
+ */
 class OTelExportSinkNode : public SinkNode {
  public:
-  virtual ~OTelExportSinkNode() = default;
+  ~OTelExportSinkNode() override;
 
  protected:
   std::string DebugStringImpl() override;
@@ -53,16 +81,52 @@ class OTelExportSinkNode : public SinkNode {
  private:
   Status ConsumeMetrics(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status ConsumeSpans(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  // Adds the row to the running total of its series and exports the total. Returns false if the
+  // row was already added by a previous run of the script, in which case it's not exported.
+  bool AddSumDataPoint(const planpb::OTelMetric& metric_pb, std::string_view resource_key,
+                       const table_store::schema::RowBatch& rb, int64_t row_idx,
+                       opentelemetry::proto::metrics::v1::Metric* metric);
+
+  // Hands the pending requests to the export threads if force is set or they reached the batch
+  // size or delay.
+  Status MaybeFlush(ExecState* exec_state, bool force);
+  template <typename TResponse, typename TStub, typename TRequest>
+  Status Export(ExecState* exec_state, TStub* stub, TRequest* request);
+  void PrepareContext(grpc::ClientContext* context);
+  void FinishExport(ExecState* exec_state, bool spans, const grpc::Status& status);
+  // Returns the first export error, if any.
+  Status ExportStatus();
+  Status WaitForExports();
+
+  bool HasExportSlot() ABSL_EXCLUSIVE_LOCKS_REQUIRED(export_lock_);
+  bool ExportsDone() ABSL_EXCLUSIVE_LOCKS_REQUIRED(export_lock_);
 
   std::unique_ptr<table_store::schema::RowDescriptor> input_descriptor_;
-  opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceResponse metrics_response_;
-  opentelemetry::proto::collector::metrics::v1::MetricsService::StubInterface*
-      metrics_service_stub_;
-  opentelemetry::proto::collector::trace::v1::ExportTraceServiceResponse trace_response_;
-  opentelemetry::proto::collector::trace::v1::TraceService::StubInterface* trace_service_stub_;
+  // One stub per channel to the collector, used round robin.
+  std::vector<opentelemetry::proto::collector::metrics::v1::MetricsService::StubInterface*>
+      metrics_service_stubs_;
+  std::vector<opentelemetry::proto::collector::trace::v1::TraceService::StubInterface*>
+      trace_service_stubs_;
+  size_t next_stub_ = 0;
   std::unique_ptr<plan::OTelExportSinkOperator> plan_node_;
 
+  // The rows waiting to be exported.
+  opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest pending_metrics_;
+  opentelemetry::proto::collector::trace::v1::ExportTraceServiceRequest pending_spans_;
+  size_t pending_bytes_ = 0;
+  std::chrono::steady_clock::time_point pending_since_;
+
+  absl::Mutex export_lock_;
+  int64_t num_inflight_exports_ ABSL_GUARDED_BY(export_lock_) = 0;
+  Status export_status_ ABSL_GUARDED_BY(export_lock_);
+
   std::unique_ptr<SpanConfig> span_config_;
+
+  bool has_sum_metrics_ = false;
+  std::shared_ptr<OTelExportState> export_state_;
+  // The time of the last row of each series exported by the previous runs of the script, as of
+  // the first row of the series in this run.
+  absl::flat_hash_map<std::string, int64_t> series_watermarks_;
 };
 
 }  // namespace exec
@@ -18,6 +18,9 @@
 
 #include "src/carnot/exec/otel_export_sink_node.h"
 
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -88,8 +91,13 @@ class OTelExportSinkNodeTest : public ::testing::Test {
           return std::move(trace_mock_unique_);
         },
         sole::uuid4(), nullptr, nullptr, [](grpc::ClientContext*) {});
+    // The mock stubs can only be handed out once.
+    orig_export_channels_ = FLAGS_carnot_otel_export_channels;
+    FLAGS_carnot_otel_export_channels = 1;
   }
 
+  void TearDown() override { FLAGS_carnot_otel_export_channels = orig_export_channels_; }
+
  protected:
   std::string url_;
   std::unique_ptr<ExecState> exec_state_;
@@ -98,6 +106,7 @@ class OTelExportSinkNodeTest : public ::testing::Test {
   oteltracecollector::MockTraceServiceStub* trace_mock_;
 
  private:
+  int32_t orig_export_channels_;
   // Ownership will be transferred to the GRPC node, so access this ptr via `metrics_mock_` in the
   // tests.
   std::unique_ptr<otelmetricscollector::MockMetricsServiceStub> metrics_mock_unique_;
@@ -142,6 +151,8 @@ metrics {
                  .AddColumn<types::Float64Value>({1.0})
                  .get();
   tester.ConsumeNext(rb1, 1, 0);
+  // Closing exports the rows still pending without an eos.
+  tester.Close();
 
   EXPECT_EQ(url_, "otlp.px.dev");
 }
@@ -198,6 +209,7 @@ metrics {
                  .AddColumn<types::StringValue>({non_utf_8_bytes})
                  .get();
   tester.ConsumeNext(rb1, 1, 0);
+  tester.Close();
   EXPECT_EQ(non_utf_8_bytes, actual_protos[0]
                                  .resource_metrics(0)
                                  .instrumentation_library_metrics(0)
@@ -1732,6 +1744,211 @@ eos: true)pb";
   EXPECT_THAT(retval.ToString(), ::testing::MatchesRegex(".*INTERNAL.*"));
 }
 
+constexpr char kGaugeOperator[] = R"pb(
+metrics {
+  name: "http.resp.latency"
+  time_column_index: 0
+  gauge { int_column_index: 1 }
+})pb";
+
+TEST_F(OTelExportSinkNodeTest, coalesce_row_batches) {
+  PX_SET_FOR_SCOPE(FLAGS_carnot_otel_export_batch_bytes, 1024 * 1024);
+  PX_SET_FOR_SCOPE(FLAGS_carnot_otel_export_batch_delay_ms, 60 * 1000);
+
+  otelmetricscollector::ExportMetricsServiceRequest actual_proto;
+  EXPECT_CALL(*metrics_mock_, Export(_, _, _))
+      .Times(1)
+      .WillRepeatedly(Invoke([&actual_proto](const auto&, const auto& proto, const auto&) {
+        actual_proto = proto;
+        return grpc::Status::OK;
+      }));
+
+  planpb::OTelExportSinkOperator otel_sink_op;
+  EXPECT_TRUE(google::protobuf::TextFormat::ParseFromString(kGaugeOperator, &otel_sink_op));
+  auto plan_node = std::make_unique<plan::OTelExportSinkOperator>(1);
+  EXPECT_OK(plan_node->Init(otel_sink_op));
+  RowDescriptor input_rd({types::TIME64NS, types::INT64});
+  RowDescriptor output_rd({});
+
+  auto tester = exec::ExecNodeTester<OTelExportSinkNode, plan::OTelExportSinkOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  for (int64_t i = 0; i < 3; ++i) {
+    bool eos = i == 2;
+    auto rb = RowBatchBuilder(input_rd, 2, /*eow*/ eos, /*eos*/ eos)
+                  .AddColumn<types::Time64NSValue>({2 * i, 2 * i + 1})
+                  .AddColumn<types::Int64Value>({2 * i, 2 * i + 1})
+                  .get();
+    tester.ConsumeNext(rb, 1, 0);
+  }
+
+  ASSERT_EQ(6, actual_proto.resource_metrics_size());
+  for (const auto& [i, resource_metrics] : Enumerate(actual_proto.resource_metrics())) {
+    EXPECT_EQ(static_cast<int64_t>(i), resource_metrics.instrumentation_library_metrics(0)
+                                           .metrics(0)
+                                           .gauge()
+                                           .data_points(0)
+                                           .as_int());
+  }
+}
+
+TEST_F(OTelExportSinkNodeTest, async_export_error) {
+  PX_SET_FOR_SCOPE(FLAGS_carnot_otel_export_batch_bytes, 0);
+
+  EXPECT_CALL(*metrics_mock_, Export(_, _, _))
+      .Times(1)
+      .WillRepeatedly(Invoke([](const auto&, const auto&, const auto&) {
+        return grpc::Status(grpc::UNAVAILABLE, "collector down");
+      }));
+
+  planpb::OTelExportSinkOperator otel_sink_op;
+  EXPECT_TRUE(google::protobuf::TextFormat::ParseFromString(kGaugeOperator, &otel_sink_op));
+  auto plan_node = std::make_unique<plan::OTelExportSinkOperator>(1);
+  EXPECT_OK(plan_node->Init(otel_sink_op));
+  RowDescriptor input_rd({types::TIME64NS, types::INT64});
+  RowDescriptor output_rd({});
+
+  auto tester = exec::ExecNodeTester<OTelExportSinkNode, plan::OTelExportSinkOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  auto rb1 = RowBatchBuilder(input_rd, 1, /*eow*/ false, /*eos*/ false)
+                 .AddColumn<types::Time64NSValue>({10})
+                 .AddColumn<types::Int64Value>({1})
+                 .get();
+  // The export of the first batch runs in the background, so its failure is reported later.
+  EXPECT_OK(tester.node()->ConsumeNext(exec_state_.get(), rb1, 1));
+
+  auto rb2 = RowBatchBuilder(input_rd, 1, /*eow*/ true, /*eos*/ true)
+                 .AddColumn<types::Time64NSValue>({11})
+                 .AddColumn<types::Int64Value>({2})
+                 .get();
+  auto retval = tester.node()->ConsumeNext(exec_state_.get(), rb2, 1);
+  EXPECT_NOT_OK(retval);
+  EXPECT_THAT(retval.ToString(), ::testing::MatchesRegex(".*UNAVAILABLE.*"));
+}
+
+TEST(OTelExportSinkNodeChannelsTest, round_robin_channels) {
+  PX_SET_FOR_SCOPE(FLAGS_carnot_otel_export_batch_bytes, 0);
+  PX_SET_FOR_SCOPE(FLAGS_carnot_otel_export_channels, 2);
+  PX_SET_FOR_SCOPE(FLAGS_carnot_otel_export_max_inflight_requests, 1);
+
+  auto func_registry = std::make_unique<udf::Registry>("test_registry");
+  std::atomic<int64_t> num_inflight = 0;
+  std::atomic<int64_t> max_inflight = 0;
+  auto export_fn = [&](const auto&, const auto&, const auto&) {
+    int64_t inflight = ++num_inflight;
+    int64_t prev_max = max_inflight;
+    while (inflight > prev_max && !max_inflight.compare_exchange_weak(prev_max, inflight)) {
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    --num_inflight;
+    return grpc::Status::OK;
+  };
+  std::vector<otelmetricscollector::MockMetricsServiceStub*> stubs;
+  auto exec_state = std::make_unique<ExecState>(
+      func_registry.get(), std::make_shared<table_store::TableStore>(),
+      MockResultSinkStubGenerator,
+      [&](const std::string&,
+          bool) -> std::unique_ptr<otelmetricscollector::MetricsService::StubInterface> {
+        auto stub = std::make_unique<otelmetricscollector::MockMetricsServiceStub>();
+        EXPECT_CALL(*stub, Export(_, _, _)).Times(2).WillRepeatedly(Invoke(export_fn));
+        stubs.push_back(stub.get());
+        return stub;
+      },
+      MockTraceStubGenerator, sole::uuid4(), nullptr, nullptr, [](grpc::ClientContext*) {});
+
+  planpb::OTelExportSinkOperator otel_sink_op;
+  EXPECT_TRUE(google::protobuf::TextFormat::ParseFromString(kGaugeOperator, &otel_sink_op));
+  auto plan_node = std::make_unique<plan::OTelExportSinkOperator>(1);
+  EXPECT_OK(plan_node->Init(otel_sink_op));
+  RowDescriptor input_rd({types::TIME64NS, types::INT64});
+  RowDescriptor output_rd({});
+
+  auto tester = exec::ExecNodeTester<OTelExportSinkNode, plan::OTelExportSinkOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state.get());
+  EXPECT_EQ(2, stubs.size());
+  for (int64_t i = 0; i < 4; ++i) {
+    bool eos = i == 3;
+    auto rb = RowBatchBuilder(input_rd, 1, /*eow*/ eos, /*eos*/ eos)
+                  .AddColumn<types::Time64NSValue>({i})
+                  .AddColumn<types::Int64Value>({i})
+                  .get();
+    tester.ConsumeNext(rb, 1, 0);
+  }
+  EXPECT_EQ(1, max_inflight);
+}
+
+constexpr char kSumOperator[] = R"pb(
+export_state_key: "http_requests_script"
+metrics {
+  name: "http.requests"
+  time_column_index: 0
+  sum { int_column_index: 1 }
+})pb";
+
+TEST(OTelExportSinkNodeSumTest, running_totals_are_kept_between_runs) {
+  auto func_registry = std::make_unique<udf::Registry>("test_registry");
+  auto metrics_mock_unique = std::make_unique<otelmetricscollector::MockMetricsServiceStub>();
+  auto metrics_mock = metrics_mock_unique.get();
+  OTelExportStateStore export_states;
+  // Both runs share the exec state, so that the mock stub is only handed out once.
+  ExecState exec_state(
+      func_registry.get(), std::make_shared<table_store::TableStore>(),
+      MockResultSinkStubGenerator,
+      [&metrics_mock_unique](const std::string&, bool)
+          -> std::unique_ptr<otelmetricscollector::MetricsService::StubInterface> {
+        return std::move(metrics_mock_unique);
+      },
+      MockTraceStubGenerator, sole::uuid4(), nullptr, nullptr, [](grpc::ClientContext*) {},
+      nullptr, &export_states);
+  PX_SET_FOR_SCOPE(FLAGS_carnot_otel_export_channels, 1);
+
+  std::vector<otelmetricscollector::ExportMetricsServiceRequest> requests;
+  EXPECT_CALL(*metrics_mock, Export(_, _, _))
+      .Times(2)
+      .WillRepeatedly(Invoke([&requests](const auto&, const auto& proto, const auto&) {
+        requests.push_back(proto);
+        return grpc::Status::OK;
+      }));
+
+  planpb::OTelExportSinkOperator otel_sink_op;
+  EXPECT_TRUE(google::protobuf::TextFormat::ParseFromString(kSumOperator, &otel_sink_op));
+  auto plan_node = std::make_unique<plan::OTelExportSinkOperator>(1);
+  EXPECT_OK(plan_node->Init(otel_sink_op));
+  RowDescriptor input_rd({types::TIME64NS, types::INT64});
+
+  auto run = [&](std::vector<types::Time64NSValue> times, std::vector<types::Int64Value> values) {
+    auto tester = exec::ExecNodeTester<OTelExportSinkNode, plan::OTelExportSinkOperator>(
+        *plan_node, RowDescriptor({}), {input_rd}, &exec_state);
+    tester.ConsumeNext(RowBatchBuilder(input_rd, times.size(), /*eow*/ true, /*eos*/ true)
+                           .AddColumn<types::Time64NSValue>(times)
+                           .AddColumn<types::Int64Value>(values)
+                           .get(),
+                       1, 0);
+  };
+  auto data_point = [&](size_t request, int i) {
+    return requests[request]
+        .resource_metrics(i)
+        .instrumentation_library_metrics(0)
+        .metrics(0)
+        .sum()
+        .data_points(0);
+  };
+
+  run({10, 20}, {5, 7});
+  ASSERT_EQ(1, requests.size());
+  ASSERT_EQ(2, requests[0].resource_metrics_size());
+  EXPECT_EQ(5, data_point(0, 0).as_int());
+  EXPECT_EQ(12, data_point(0, 1).as_int());
+  EXPECT_EQ(10, data_point(0, 1).start_time_unix_nano());
+
+  // The second run overlaps the first one: the row at time 20 was already added to the total.
+  run({20, 30}, {7, 1});
+  ASSERT_EQ(2, requests.size());
+  ASSERT_EQ(1, requests[1].resource_metrics_size());
+  EXPECT_EQ(13, data_point(1, 0).as_int());
+  EXPECT_EQ(30, data_point(1, 0).time_unix_nano());
+  EXPECT_EQ(10, data_point(1, 0).start_time_unix_nano());
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/otel_export_state.h"
+
+#include <string>
+
+DEFINE_int32(carnot_otel_export_state_ttl_secs,
+             gflags::Int32FromEnv("PL_CARNOT_OTEL_EXPORT_STATE_TTL_SECS", 3600),
+             "How long the running totals of an OTel export script are kept after its last run.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+std::shared_ptr<OTelExportState> OTelExportStateStore::Get(const std::string& key,
+                                                           Clock::time_point now) {
+  absl::MutexLock lock(&mu_);
+  auto expiry = now - std::chrono::seconds(FLAGS_carnot_otel_export_state_ttl_secs);
+  absl::erase_if(states_, [&](const auto& entry) { return entry.second.last_used < expiry; });
+
+  Entry& entry = states_[key];
+  if (entry.state == nullptr) {
+    entry.state = std::make_shared<OTelExportState>();
+  }
+  entry.last_used = now;
+  return entry.state;
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
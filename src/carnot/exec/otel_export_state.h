@@ -0,0 +1,99 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/common/base/base.h"
+
+DECLARE_int32(carnot_otel_export_state_ttl_secs);
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * The running total of one series of a Sum metric.
+ */
+struct OTelSumSeries {
+  // The time of the first row of the series, which is the start time of the cumulative sum.
+  int64_t start_time_ns = 0;
+  // The time of the latest row that was added to the total.
+  int64_t last_time_ns = 0;
+  int64_t int_total = 0;
+  double double_total = 0;
+};
+
+/**
+ * The state that an OTel export script keeps between its runs: the running totals of the series
+ * of its Sum metrics. Series are keyed by the metric name and their attributes.
+ */
+class OTelExportState {
+ public:
+  absl::Mutex& mu() ABSL_LOCK_RETURNED(mu_) { return mu_; }
+
+  // Returns the series of the key, which is created on first use.
+  OTelSumSeries* GetSeries(const std::string& key) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return &series_[key];
+  }
+
+  size_t num_series() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) { return series_.size(); }
+
+ private:
+  absl::Mutex mu_;
+  absl::flat_hash_map<std::string, OTelSumSeries> series_ ABSL_GUARDED_BY(mu_);
+};
+
+/**
+ * OTelExportStateStore keeps the export state of the OTel export scripts for the lifetime of the
+ * engine, keyed by the export_state_key of their sinks. The state of a script that hasn't run for
+ * --carnot_otel_export_state_ttl_secs is dropped, and its sums restart from 0 with a new start
+ * time, which OTel consumers treat as a counter reset.
+ */
+class OTelExportStateStore : public NotCopyable {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // Returns the state of the key, which is created on first use.
+  std::shared_ptr<OTelExportState> Get(const std::string& key,
+                                       Clock::time_point now = Clock::now());
+
+  size_t size() {
+    absl::MutexLock lock(&mu_);
+    return states_.size();
+  }
+
+ private:
+  struct Entry {
+    std::shared_ptr<OTelExportState> state;
+    Clock::time_point last_used;
+  };
+
+  absl::Mutex mu_;
+  absl::flat_hash_map<std::string, Entry> states_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/otel_export_state.h"
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+TEST(OTelExportStateStoreTest, state_is_kept_between_runs) {
+  OTelExportStateStore store;
+  auto now = OTelExportStateStore::Clock::now();
+
+  OTelExportState* state = store.Get("script_a", now).get();
+  {
+    absl::MutexLock lock(&state->mu());
+    state->GetSeries("requests")->int_total = 10;
+  }
+
+  OTelExportState* same_state = store.Get("script_a", now + std::chrono::seconds(10)).get();
+  EXPECT_EQ(state, same_state);
+  absl::MutexLock lock(&same_state->mu());
+  EXPECT_EQ(10, same_state->GetSeries("requests")->int_total);
+  EXPECT_EQ(1, same_state->num_series());
+}
+
+TEST(OTelExportStateStoreTest, idle_states_are_dropped) {
+  OTelExportStateStore store;
+  auto now = OTelExportStateStore::Clock::now();
+  auto ttl = std::chrono::seconds(FLAGS_carnot_otel_export_state_ttl_secs);
+
+  auto state_a = store.Get("script_a", now);
+  store.Get("script_b", now + ttl);
+  EXPECT_EQ(2, store.size());
+
+  // script_a hasn't run for longer than the TTL, script_b ran just before.
+  store.Get("script_b", now + ttl + std::chrono::seconds(1));
+  EXPECT_EQ(1, store.size());
+  EXPECT_NE(state_a.get(), store.Get("script_a", now + ttl + std::chrono::seconds(2)).get());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
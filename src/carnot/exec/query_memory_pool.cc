@@ -0,0 +1,84 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/query_memory_pool.h"
+
+DEFINE_int64(carnot_exec_query_memory_limit_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_EXEC_QUERY_MEMORY_LIMIT_BYTES", 0),
+             "The hard limit on the arrow memory a query may allocate. A query that goes over it "
+             "fails instead of growing further. It should be above "
+             "--carnot_exec_query_memory_budget_bytes, so that joins and aggregates spill first. "
+             "Zero disables the limit.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+bool QueryMemoryPool::Reserve(int64_t bytes) {
+  int64_t allocated = bytes_allocated_.fetch_add(bytes) + bytes;
+  if (limit_bytes_ > 0 && bytes > 0 && allocated > limit_bytes_) {
+    bytes_allocated_ -= bytes;
+    limit_exceeded_ = true;
+    return false;
+  }
+  int64_t max_memory = max_memory_.load();
+  while (allocated > max_memory && !max_memory_.compare_exchange_weak(max_memory, allocated)) {
+  }
+  if (attributed_bytes_ != nullptr && bytes > 0) {
+    *attributed_bytes_ += bytes;
+  }
+  return true;
+}
+
+arrow::Status QueryMemoryPool::Allocate(int64_t size, uint8_t** out) {
+  if (!Reserve(size)) {
+    return arrow::Status::OutOfMemory(absl::Substitute(
+        "Allocating $0 bytes takes the query over its memory limit of $1 bytes", size,
+        limit_bytes_));
+  }
+  auto s = pool_->Allocate(size, out);
+  if (!s.ok()) {
+    bytes_allocated_ -= size;
+    return s;
+  }
+  ++refs_;
+  return s;
+}
+
+arrow::Status QueryMemoryPool::Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) {
+  if (!Reserve(new_size - old_size)) {
+    return arrow::Status::OutOfMemory(absl::Substitute(
+        "Growing a buffer to $0 bytes takes the query over its memory limit of $1 bytes",
+        new_size, limit_bytes_));
+  }
+  auto s = pool_->Reallocate(old_size, new_size, ptr);
+  if (!s.ok()) {
+    bytes_allocated_ -= new_size - old_size;
+  }
+  return s;
+}
+
+void QueryMemoryPool::Free(uint8_t* buffer, int64_t size) {
+  pool_->Free(buffer, size);
+  bytes_allocated_ -= size;
+  Unref();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/memory_pool.h>
+#include <arrow/status.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "src/common/base/base.h"
+
+DECLARE_int64(carnot_exec_query_memory_limit_bytes);
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * The arrow memory pool of a query. It accounts for every arrow buffer the query allocates and
+ * fails allocations that would take the query over its limit, so that a runaway query errors out
+ * instead of taking the whole process down. A limit of zero disables the limit.
+ *
+ * Allocations are also attributed to the operator that is running on the allocating thread (see
+ * ScopedMemoryAttribution).
+ *
+ * Buffers, such as the ones a memory sink hands to the table store, can outlive the query. The
+ * pool is therefore reference counted by its owner and by each of its live allocations, and is
+ * deleted once the owner has called Release() and the last buffer has been freed.
+ */
+class QueryMemoryPool final : public arrow::MemoryPool {
+ public:
+  static QueryMemoryPool* Create(int64_t limit_bytes) { return new QueryMemoryPool(limit_bytes); }
+
+  /**
+   * Drops the owner's reference. The pool must not be used by the owner afterwards.
+   */
+  void Release() { Unref(); }
+
+  arrow::Status Allocate(int64_t size, uint8_t** out) override;
+  arrow::Status Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) override;
+  void Free(uint8_t* buffer, int64_t size) override;
+
+  int64_t bytes_allocated() const override { return bytes_allocated_.load(); }
+  int64_t max_memory() const override { return max_memory_.load(); }
+  std::string backend_name() const override { return pool_->backend_name(); }
+
+  int64_t limit_bytes() const { return limit_bytes_; }
+  // Whether an allocation failed because of the limit.
+  bool limit_exceeded() const { return limit_exceeded_.load(); }
+
+ private:
+  explicit QueryMemoryPool(int64_t limit_bytes)
+      : limit_bytes_(limit_bytes), pool_(arrow::default_memory_pool()) {}
+
+  // Adds bytes to the allocated bytes, unless that takes the query over its limit.
+  bool Reserve(int64_t bytes);
+  void Unref() {
+    if (--refs_ == 0) {
+      delete this;
+    }
+  }
+
+  const int64_t limit_bytes_;
+  arrow::MemoryPool* pool_;
+  std::atomic<int64_t> bytes_allocated_ = 0;
+  std::atomic<int64_t> max_memory_ = 0;
+  std::atomic<bool> limit_exceeded_ = false;
+  // The owner's reference and one per live allocation.
+  std::atomic<int64_t> refs_ = 1;
+
+  friend class ScopedMemoryAttribution;
+  // The allocation counter of the operator running on this thread, if any.
+  static inline thread_local int64_t* attributed_bytes_ = nullptr;
+};
+
+/**
+ * Attributes the bytes allocated by the query memory pools on this thread to bytes_allocated,
+ * for as long as it is in scope. Scopes nest, so an operator that calls into its children only
+ * counts its own allocations.
+ */
+class ScopedMemoryAttribution : public NotCopyable {
+ public:
+  explicit ScopedMemoryAttribution(int64_t* bytes_allocated)
+      : prev_(QueryMemoryPool::attributed_bytes_) {
+    QueryMemoryPool::attributed_bytes_ = bytes_allocated;
+  }
+  ~ScopedMemoryAttribution() { QueryMemoryPool::attributed_bytes_ = prev_; }
+
+ private:
+  int64_t* prev_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
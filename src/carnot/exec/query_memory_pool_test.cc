@@ -0,0 +1,108 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/query_memory_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <arrow/builder.h>
+
+#include <memory>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+TEST(QueryMemoryPoolTest, tracks_allocated_and_peak_bytes) {
+  auto pool = QueryMemoryPool::Create(0);
+  uint8_t* a;
+  uint8_t* b;
+  ASSERT_TRUE(pool->Allocate(100, &a).ok());
+  ASSERT_TRUE(pool->Allocate(50, &b).ok());
+  EXPECT_EQ(150, pool->bytes_allocated());
+  ASSERT_TRUE(pool->Reallocate(50, 80, &b).ok());
+  EXPECT_EQ(180, pool->bytes_allocated());
+  pool->Free(a, 100);
+  EXPECT_EQ(80, pool->bytes_allocated());
+  EXPECT_EQ(180, pool->max_memory());
+  pool->Free(b, 80);
+  EXPECT_EQ(0, pool->bytes_allocated());
+  pool->Release();
+}
+
+TEST(QueryMemoryPoolTest, fails_allocations_over_the_limit) {
+  auto pool = QueryMemoryPool::Create(100);
+  uint8_t* a;
+  uint8_t* b;
+  ASSERT_TRUE(pool->Allocate(80, &a).ok());
+  EXPECT_FALSE(pool->limit_exceeded());
+  EXPECT_TRUE(pool->Allocate(40, &b).IsOutOfMemory());
+  EXPECT_TRUE(pool->Reallocate(80, 120, &a).IsOutOfMemory());
+  EXPECT_TRUE(pool->limit_exceeded());
+  EXPECT_EQ(80, pool->bytes_allocated());
+
+  arrow::Int64Builder builder(pool);
+  EXPECT_FALSE(builder.Reserve(100).ok());
+  pool->Free(a, 80);
+  pool->Release();
+}
+
+TEST(QueryMemoryPoolTest, attributes_allocations_to_the_innermost_scope) {
+  auto pool = QueryMemoryPool::Create(0);
+  int64_t parent_bytes = 0;
+  int64_t child_bytes = 0;
+  uint8_t* a;
+  uint8_t* b;
+  uint8_t* c;
+  {
+    ScopedMemoryAttribution parent(&parent_bytes);
+    ASSERT_TRUE(pool->Allocate(10, &a).ok());
+    {
+      ScopedMemoryAttribution child(&child_bytes);
+      ASSERT_TRUE(pool->Allocate(20, &b).ok());
+    }
+    ASSERT_TRUE(pool->Allocate(30, &c).ok());
+  }
+  EXPECT_EQ(40, parent_bytes);
+  EXPECT_EQ(20, child_bytes);
+  pool->Free(a, 10);
+  pool->Free(b, 20);
+  pool->Free(c, 30);
+  pool->Release();
+}
+
+TEST(QueryMemoryPoolTest, buffers_outlive_the_owner) {
+  auto pool = QueryMemoryPool::Create(0);
+  std::shared_ptr<arrow::Array> arr;
+  {
+    arrow::Int64Builder builder(pool);
+    ASSERT_TRUE(builder.AppendValues({1, 2, 3}).ok());
+    ASSERT_TRUE(builder.Finish(&arr).ok());
+  }
+  EXPECT_GT(pool->bytes_allocated(), 0);
+  pool->Release();
+  // The pool stays alive until the array's buffers are freed.
+  EXPECT_EQ(3, arr->length());
+  arr.reset();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -63,6 +63,32 @@ inline const T& GetValueHelper(const RowTuple& rt, size_t idx);
 template <>
 inline const types::StringValue& GetValueHelper<types::StringValue>(const RowTuple& rt, size_t idx);
 
+/**
+ * Finalizer of MurmurHash3, used to hash fixed size key values. It is branch free so that the
+ * column at a time loops in HashKeyColumn compile down to vector instructions.
+ */
+inline uint64_t HashFixedWord(uint64_t v) {
+  v ^= v >> 33;
+  v *= 0xff51afd7ed558ccdULL;
+  v ^= v >> 33;
+  v *= 0xc4ceb9fe1a85ec53ULL;
+  v ^= v >> 33;
+  return v;
+}
+
+inline uint64_t HashFloat64(double v) {
+  uint64_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  return HashFixedWord(bits);
+}
+
+inline uint64_t HashUInt128(absl::uint128 v) {
+  return ::px::HashCombine(HashFixedWord(absl::Uint128High64(v)),
+                           HashFixedWord(absl::Uint128Low64(v)));
+}
+
+inline uint64_t HashString(const char* data, size_t len) { return ::util::Hash64(data, len); }
+
 }  // namespace internal
 
 /**
@@ -81,6 +107,7 @@ struct RowTuple : public NotCopyable {
   void Reset() {
     fixed_values.resize(types->size());
     variable_values.clear();
+    has_cached_hash = false;
   }
 
   /**
@@ -133,21 +160,65 @@ struct RowTuple : public NotCopyable {
   }
 
   /**
-   * Compute the hash of this RowTuple.
+   * Compute the hash of this RowTuple. Returns the cached hash if one was set with SetHash().
    *
    * @return the hash results.
    */
   size_t Hash() const {
+    if (has_cached_hash) {
+      DCHECK_EQ(cached_hash, ComputeHash()) << "Cached hash does not match the tuple values";
+      return cached_hash;
+    }
+    return ComputeHash();
+  }
+
+  /**
+   * Sets the hash of this RowTuple, as computed for the whole batch by HashKeyColumns.
+   * The cached hash is dropped when the tuple is Reset() or any value is written.
+   * @param hash The hash of the current values.
+   */
+  void SetHash(uint64_t hash) {
+    cached_hash = hash;
+    has_cached_hash = true;
+  }
+
+  /**
+   * Hashes the values of this RowTuple one column at a time. This matches the hashes computed by
+   * HashKeyColumns, so tuples hashed either way can be mixed in the same hash table.
+   *
+   * @return the hash results.
+   */
+  uint64_t ComputeHash() const {
     DCHECK(CheckSequentialWriteOrder()) << "Variable sized write ordering mismatch";
-    // For fixed sized data we just hash the stored array.
-    size_t hash = ::util::Hash64(reinterpret_cast<const char*>(fixed_values.data()),
-                                 sizeof(types::FixedSizeValueUnion) * fixed_values.size());
-    // For variable sized data we run the appropriate hash function.
-    for (const auto& val : variable_values) {
-      // This should be edited when we add support for new variable sized types.
-      DCHECK(std::holds_alternative<types::StringValue>(val));
-      hash = ::px::HashCombine(
-          hash, types::utils::hash<types::StringValue>()(std::get<types::StringValue>(val)));
+    uint64_t hash = 0;
+    for (size_t idx = 0; idx < fixed_values.size(); ++idx) {
+      uint64_t value_hash = 0;
+      // PX_CARNOT_UPDATE_FOR_NEW_TYPES.
+      switch (types->at(idx)) {
+        case types::BOOLEAN:
+          value_hash = internal::HashFixedWord(GetValue<types::BoolValue>(idx).val);
+          break;
+        case types::INT64:
+          value_hash = internal::HashFixedWord(GetValue<types::Int64Value>(idx).val);
+          break;
+        case types::TIME64NS:
+          value_hash = internal::HashFixedWord(GetValue<types::Time64NSValue>(idx).val);
+          break;
+        case types::FLOAT64:
+          value_hash = internal::HashFloat64(GetValue<types::Float64Value>(idx).val);
+          break;
+        case types::UINT128:
+          value_hash = internal::HashUInt128(GetValue<types::UInt128Value>(idx).val);
+          break;
+        case types::STRING: {
+          const auto& str = GetValue<types::StringValue>(idx);
+          value_hash = internal::HashString(str.data(), str.size());
+          break;
+        }
+        default:
+          CHECK(0) << "Unknown Type: " << types->at(idx);
+      }
+      hash = idx == 0 ? value_hash : ::px::HashCombine(hash, value_hash);
     }
     return hash;
   }
@@ -185,6 +256,10 @@ struct RowTuple : public NotCopyable {
   // This index is stored as a Int64Value.
   std::vector<types::FixedSizeValueUnion> fixed_values;
   std::vector<VariableSizeValueTypeVariant> variable_values;
+
+  // Hash of the values, if it was already computed for the batch this tuple was extracted from.
+  uint64_t cached_hash = 0;
+  bool has_cached_hash = false;
 };
 
 namespace internal {
@@ -192,6 +267,7 @@ template <typename T>
 inline void SetValueHelper(RowTuple* rt, size_t idx, const T& val) {
   static_assert(types::ValueTypeTraits<T>::is_fixed_size, "Only fixed size values allowed");
   types::SetValue<T>(&rt->fixed_values[idx], val);
+  rt->has_cached_hash = false;
 }
 
 template <>
@@ -235,7 +311,13 @@ struct RowTuplePtrHasher {
  * Equality operator for RowTuple pointers.
  */
 struct RowTuplePtrEq {
-  bool operator()(const RowTuple* k1, const RowTuple* k2) const { return *k1 == *k2; }
+  bool operator()(const RowTuple* k1, const RowTuple* k2) const {
+    // Only compare the full keys when the hashes collide.
+    if (k1->has_cached_hash && k2->has_cached_hash && k1->cached_hash != k2->cached_hash) {
+      return false;
+    }
+    return *k1 == *k2;
+  }
 };
 
 template <class T>
@@ -251,6 +333,107 @@ void ExtractIntoRowTuple(RowTuple* rt, arrow::Array* col, int rt_col_idx, int rt
                              types::GetValue(static_cast<ArrowArrayType*>(col), rt_row_idx));
 }
 
+namespace internal {
+template <typename TValueHashFn>
+inline void HashKeyColumnValues(int64_t num_rows, bool first, uint64_t* hashes,
+                                TValueHashFn value_hash) {
+  if (first) {
+    for (int64_t i = 0; i < num_rows; ++i) {
+      hashes[i] = value_hash(i);
+    }
+    return;
+  }
+  for (int64_t i = 0; i < num_rows; ++i) {
+    hashes[i] = ::px::HashCombine(hashes[i], value_hash(i));
+  }
+}
+}  // namespace internal
+
+/**
+ * Hashes a whole key column into hashes, combining with the hashes of the preceding key columns
+ * unless this is the first key column.
+ * @tparam DT The data type of the column.
+ * @param col The key column.
+ * @param first Whether this is the first key column.
+ * @param hashes The per row hashes (at least col->length() long).
+ */
+template <types::DataType DT>
+void HashKeyColumn(const arrow::Array* col, bool first, uint64_t* hashes);
+
+template <>
+inline void HashKeyColumn<types::BOOLEAN>(const arrow::Array* col, bool first, uint64_t* hashes) {
+  auto arr = static_cast<const arrow::BooleanArray*>(col);
+  internal::HashKeyColumnValues(col->length(), first, hashes, [arr](int64_t i) {
+    return internal::HashFixedWord(arr->Value(i));
+  });
+}
+
+template <>
+inline void HashKeyColumn<types::INT64>(const arrow::Array* col, bool first, uint64_t* hashes) {
+  const int64_t* vals = static_cast<const arrow::Int64Array*>(col)->raw_values();
+  internal::HashKeyColumnValues(col->length(), first, hashes, [vals](int64_t i) {
+    return internal::HashFixedWord(vals[i]);
+  });
+}
+
+template <>
+inline void HashKeyColumn<types::TIME64NS>(const arrow::Array* col, bool first, uint64_t* hashes) {
+  const int64_t* vals = static_cast<const arrow::Time64Array*>(col)->raw_values();
+  internal::HashKeyColumnValues(col->length(), first, hashes, [vals](int64_t i) {
+    return internal::HashFixedWord(vals[i]);
+  });
+}
+
+template <>
+inline void HashKeyColumn<types::FLOAT64>(const arrow::Array* col, bool first, uint64_t* hashes) {
+  const double* vals = static_cast<const arrow::DoubleArray*>(col)->raw_values();
+  internal::HashKeyColumnValues(col->length(), first, hashes, [vals](int64_t i) {
+    return internal::HashFloat64(vals[i]);
+  });
+}
+
+template <>
+inline void HashKeyColumn<types::UINT128>(const arrow::Array* col, bool first, uint64_t* hashes) {
+  auto arr = static_cast<const arrow::UInt128Array*>(col);
+  internal::HashKeyColumnValues(col->length(), first, hashes, [arr](int64_t i) {
+    return internal::HashUInt128(types::UInt128Value(types::GetValue(arr, i)).val);
+  });
+}
+
+template <>
+inline void HashKeyColumn<types::STRING>(const arrow::Array* col, bool first, uint64_t* hashes) {
+  auto arr = static_cast<const arrow::StringArray*>(col);
+  internal::HashKeyColumnValues(col->length(), first, hashes, [arr](int64_t i) {
+    int32_t len = 0;
+    const uint8_t* data = arr->GetValue(i, &len);
+    return internal::HashString(reinterpret_cast<const char*>(data), len);
+  });
+}
+
+/**
+ * Hashes the key columns of a batch one column at a time, rather than hashing a RowTuple per row.
+ * The hashes match RowTuple::Hash() of tuples holding the same keys.
+ * @param cols The key columns, all of the same length.
+ * @param key_types The types of the key columns.
+ * @param hashes Output per row hashes, resized to the number of rows.
+ */
+inline void HashKeyColumns(const std::vector<const arrow::Array*>& cols,
+                           const std::vector<types::DataType>& key_types,
+                           std::vector<uint64_t>* hashes) {
+  DCHECK_EQ(cols.size(), key_types.size());
+  if (cols.empty()) {
+    hashes->clear();
+    return;
+  }
+  hashes->resize(cols[0]->length());
+  for (size_t col_idx = 0; col_idx < cols.size(); ++col_idx) {
+    DCHECK_EQ(cols[col_idx]->length(), static_cast<int64_t>(hashes->size()));
+#define TYPE_CASE(_dt_) HashKeyColumn<_dt_>(cols[col_idx], col_idx == 0, hashes->data());
+    PX_SWITCH_FOREACH_DATATYPE(key_types[col_idx], TYPE_CASE);
+#undef TYPE_CASE
+  }
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
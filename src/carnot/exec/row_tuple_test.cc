@@ -97,6 +97,57 @@ TEST_F(RowTupleTest, check_equality_func_with_same_types_different_after_reset)
   EXPECT_NE(rt1_.Hash(), rt2_.Hash());
 }
 
+TEST_F(RowTupleTest, cached_hash_dropped_on_write) {
+  rt2_.SetHash(rt1_.Hash());
+  EXPECT_EQ(rt1_.Hash(), rt2_.Hash());
+  rt2_.SetValue(1, types::Int64Value(2));
+  EXPECT_FALSE(rt2_.has_cached_hash);
+  EXPECT_NE(rt1_.Hash(), rt2_.Hash());
+}
+
+TEST(HashKeyColumnsTest, matches_row_tuple_hash) {
+  std::vector<types::DataType> key_types = {
+      types::DataType::BOOLEAN, types::DataType::INT64,   types::DataType::FLOAT64,
+      types::DataType::STRING,  types::DataType::UINT128, types::DataType::TIME64NS,
+  };
+  std::vector<types::BoolValue> bools = {true, false, true};
+  std::vector<types::Int64Value> ints = {1, 2, 1};
+  std::vector<types::Float64Value> floats = {0.5, 1.5, 0.5};
+  std::vector<types::StringValue> strs = {"abc", "def", "abc"};
+  std::vector<types::UInt128Value> uints = {{1, 2}, {3, 4}, {1, 2}};
+  std::vector<types::Time64NSValue> times = {10, 20, 10};
+
+  std::vector<std::shared_ptr<arrow::Array>> arrs = {
+      types::ToArrow(bools, arrow::default_memory_pool()),
+      types::ToArrow(ints, arrow::default_memory_pool()),
+      types::ToArrow(floats, arrow::default_memory_pool()),
+      types::ToArrow(strs, arrow::default_memory_pool()),
+      types::ToArrow(uints, arrow::default_memory_pool()),
+      types::ToArrow(times, arrow::default_memory_pool()),
+  };
+  std::vector<const arrow::Array*> cols;
+  for (const auto& arr : arrs) {
+    cols.push_back(arr.get());
+  }
+
+  std::vector<uint64_t> hashes;
+  HashKeyColumns(cols, key_types, &hashes);
+  ASSERT_EQ(3, hashes.size());
+  EXPECT_EQ(hashes[0], hashes[2]);
+  EXPECT_NE(hashes[0], hashes[1]);
+
+  for (size_t row_idx = 0; row_idx < hashes.size(); ++row_idx) {
+    RowTuple rt(&key_types);
+    rt.SetValue(0, bools[row_idx]);
+    rt.SetValue(1, ints[row_idx]);
+    rt.SetValue(2, floats[row_idx]);
+    rt.SetValue(3, strs[row_idx]);
+    rt.SetValue(4, uints[row_idx]);
+    rt.SetValue(5, times[row_idx]);
+    EXPECT_EQ(hashes[row_idx], rt.Hash());
+  }
+}
+
 using RowTupleDeathTest = RowTupleTest;
 
 TEST_F(RowTupleDeathTest, read_wrong_type) {
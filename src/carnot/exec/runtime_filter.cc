@@ -0,0 +1,108 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/runtime_filter.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+#include <absl/container/fixed_array.h>
+
+#include "src/carnot/exec/row_tuple.h"
+
+DEFINE_int64(carnot_join_runtime_filter_max_keys,
+             gflags::Int64FromEnv("PL_CARNOT_JOIN_RUNTIME_FILTER_MAX_KEYS", 1 << 20),
+             "Joins with at most this many distinct build keys push a bloom filter of the keys up "
+             "their probe side. Zero disables runtime join filters.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+
+// A low false positive rate keeps most of the benefit for very selective joins, at ~10 bits/key.
+constexpr double kRuntimeFilterErrorRate = 0.01;
+
+StatusOr<std::unique_ptr<RuntimeFilter>> RuntimeFilter::Create(int64_t num_keys) {
+  PX_ASSIGN_OR_RETURN(auto bloom_filter, bloomfilter::SplitBlockBloomFilter::Create(
+                                             std::max<int64_t>(num_keys, 1),
+                                             kRuntimeFilterErrorRate));
+  return std::unique_ptr<RuntimeFilter>(new RuntimeFilter(std::move(bloom_filter)));
+}
+
+// The key hashes are already well mixed, so they are used as bloom filter hashes directly.
+void RuntimeFilter::InsertHash(uint64_t key_hash) { bloom_filter_->InsertHash(key_hash); }
+
+bool RuntimeFilter::MayContainHash(uint64_t key_hash) const {
+  return bloom_filter_->ContainsHash(key_hash);
+}
+
+void RuntimeFilter::MayContainHashes(absl::Span<const uint64_t> key_hashes,
+                                     absl::Span<bool> out) const {
+  bloom_filter_->ContainsMany(key_hashes, out);
+}
+
+void RuntimeFilterSlot::Publish(std::shared_ptr<const RuntimeFilter> filter) {
+  absl::MutexLock lock(&lock_);
+  filter_ = std::move(filter);
+}
+
+StatusOr<std::unique_ptr<RowBatch>> RuntimeFilterSlot::Apply(const RowBatch& rb) {
+  std::shared_ptr<const RuntimeFilter> filter;
+  {
+    absl::MutexLock lock(&lock_);
+    filter = filter_;
+  }
+  if (filter == nullptr || rb.num_rows() == 0) {
+    return std::unique_ptr<RowBatch>(nullptr);
+  }
+
+  cols_.clear();
+  for (auto col_idx : key_cols_) {
+    cols_.push_back(rb.ColumnAt(col_idx).get());
+  }
+  HashKeyColumns(cols_, key_types_, &hashes_);
+
+  absl::FixedArray<bool, 1024> matches(rb.num_rows());
+  filter->MayContainHashes(absl::MakeConstSpan(hashes_.data(), rb.num_rows()),
+                           absl::MakeSpan(matches));
+
+  selected_rows_.clear();
+  for (int64_t row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+    if (matches[row_idx]) {
+      selected_rows_.push_back(row_idx);
+    }
+  }
+  if (static_cast<int64_t>(selected_rows_.size()) == rb.num_rows()) {
+    return std::unique_ptr<RowBatch>(nullptr);
+  }
+  rows_dropped_ += rb.num_rows() - selected_rows_.size();
+
+  std::vector<int64_t> all_cols(rb.num_columns());
+  std::iota(all_cols.begin(), all_cols.end(), 0);
+  PX_ASSIGN_OR_RETURN(auto filtered_rb, rb.Select(all_cols, selected_rows_));
+  filtered_rb->set_eow(rb.eow());
+  filtered_rb->set_eos(rb.eos());
+  return filtered_rb;
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/types/span.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/common/base/base.h"
+#include "src/shared/bloomfilter/split_block_bloom_filter.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/row_batch.h"
+
+DECLARE_int64(carnot_join_runtime_filter_max_keys);
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * A bloom filter over the key hashes (see HashKeyColumns) of the build side of a join. Probe rows
+ * whose key is definitely not in the build side can't produce any output in an inner (or build
+ * side outer) join, so they can be dropped before they reach the join.
+ */
+class RuntimeFilter {
+ public:
+  static StatusOr<std::unique_ptr<RuntimeFilter>> Create(int64_t num_keys);
+
+  void InsertHash(uint64_t key_hash);
+  bool MayContainHash(uint64_t key_hash) const;
+  // Batched MayContainHash, which overlaps the cache misses of consecutive lookups.
+  void MayContainHashes(absl::Span<const uint64_t> key_hashes, absl::Span<bool> out) const;
+
+ private:
+  explicit RuntimeFilter(std::unique_ptr<bloomfilter::SplitBlockBloomFilter> bloom_filter)
+      : bloom_filter_(std::move(bloom_filter)) {}
+
+  std::unique_ptr<bloomfilter::SplitBlockBloomFilter> bloom_filter_;
+};
+
+/**
+ * Connects a join, which publishes a RuntimeFilter once its build side is done, to the upstream
+ * node on its probe side that applies the filter to its output. The slot is created by the
+ * ExecutionGraph, which resolves which columns of the upstream node hold the join keys.
+ */
+class RuntimeFilterSlot {
+ public:
+  RuntimeFilterSlot(std::vector<int64_t> key_cols, std::vector<types::DataType> key_types)
+      : key_cols_(std::move(key_cols)), key_types_(std::move(key_types)) {}
+
+  void Publish(std::shared_ptr<const RuntimeFilter> filter) ABSL_LOCKS_EXCLUDED(lock_);
+
+  /**
+   * Drops the rows of rb whose keys are not in the published filter.
+   * @return the filtered batch, or nullptr when rb should be passed on as is (nothing published
+   * yet, or no rows dropped).
+   */
+  StatusOr<std::unique_ptr<table_store::schema::RowBatch>> Apply(
+      const table_store::schema::RowBatch& rb) ABSL_LOCKS_EXCLUDED(lock_);
+
+  const std::vector<int64_t>& key_cols() const { return key_cols_; }
+  int64_t rows_dropped() const { return rows_dropped_; }
+
+ private:
+  const std::vector<int64_t> key_cols_;
+  const std::vector<types::DataType> key_types_;
+
+  absl::Mutex lock_;
+  std::shared_ptr<const RuntimeFilter> filter_ ABSL_GUARDED_BY(lock_);
+
+  // Scratch space for Apply, which is only called by the thread that runs the upstream node.
+  std::vector<const arrow::Array*> cols_;
+  std::vector<uint64_t> hashes_;
+  std::vector<int64_t> selected_rows_;
+  int64_t rows_dropped_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/runtime_filter.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "src/carnot/exec/row_tuple.h"
+#include "src/carnot/exec/test_utils.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+class RuntimeFilterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    rb_ = RowBatchBuilder(rd_, 4, /*eow*/ true, /*eos*/ true)
+              .AddColumn<types::StringValue>({"a", "bb", "ccc", "dddd"})
+              .AddColumn<types::Int64Value>({1, 2, 3, 4})
+              .get();
+  }
+
+  // Builds a filter on the int64 keys, hashed the same way as the join hashes its build keys.
+  std::shared_ptr<RuntimeFilter> FilterForKeys(const std::vector<int64_t>& keys) {
+    auto filter = RuntimeFilter::Create(keys.size()).ConsumeValueOrDie();
+    for (auto key : keys) {
+      RowTuple rt(&key_types_);
+      rt.SetValue(0, types::Int64Value(key));
+      filter->InsertHash(rt.Hash());
+    }
+    return filter;
+  }
+
+  RowDescriptor rd_{{types::DataType::STRING, types::DataType::INT64}};
+  std::vector<types::DataType> key_types_{types::DataType::INT64};
+  RowBatch rb_{rd_, 0};
+};
+
+TEST_F(RuntimeFilterTest, passes_batches_before_publish) {
+  RuntimeFilterSlot slot({1}, key_types_);
+  ASSERT_OK_AND_ASSIGN(auto filtered_rb, slot.Apply(rb_));
+  EXPECT_EQ(nullptr, filtered_rb);
+}
+
+TEST_F(RuntimeFilterTest, drops_rows_not_in_filter) {
+  RuntimeFilterSlot slot({1}, key_types_);
+  slot.Publish(FilterForKeys({2, 4, 100}));
+
+  ASSERT_OK_AND_ASSIGN(auto filtered_rb, slot.Apply(rb_));
+  ASSERT_NE(nullptr, filtered_rb);
+  EXPECT_TRUE(filtered_rb->eow());
+  EXPECT_TRUE(filtered_rb->eos());
+  EXPECT_TRUE(filtered_rb->ColumnAt(0)->Equals(types::ToArrow(
+      std::vector<types::StringValue>({"bb", "dddd"}), arrow::default_memory_pool())));
+  EXPECT_TRUE(filtered_rb->ColumnAt(1)->Equals(
+      types::ToArrow(std::vector<types::Int64Value>({2, 4}), arrow::default_memory_pool())));
+  EXPECT_EQ(2, slot.rows_dropped());
+}
+
+TEST_F(RuntimeFilterTest, passes_batch_when_all_rows_match) {
+  RuntimeFilterSlot slot({1}, key_types_);
+  slot.Publish(FilterForKeys({1, 2, 3, 4}));
+
+  ASSERT_OK_AND_ASSIGN(auto filtered_rb, slot.Apply(rb_));
+  EXPECT_EQ(nullptr, filtered_rb);
+  EXPECT_EQ(0, slot.rows_dropped());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
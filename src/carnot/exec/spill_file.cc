@@ -0,0 +1,182 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/spill_file.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include <arrow/memory_pool.h>
+#include <absl/strings/substitute.h>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+#include "src/table_store/schemapb/schema.pb.h"
+
+DEFINE_string(carnot_exec_spill_dir, gflags::StringFromEnv("PL_CARNOT_EXEC_SPILL_DIR", "/tmp"),
+              "The local directory that joins and aggregates spill their state to once the query "
+              "is over its memory budget.");
+DEFINE_int32(carnot_exec_spill_partitions,
+             gflags::Int32FromEnv("PL_CARNOT_EXEC_SPILL_PARTITIONS", 16),
+             "The number of grace hash partitions that spilled state is split into. Each "
+             "partition is loaded back into memory on its own.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+
+StatusOr<std::unique_ptr<RowBatchSpillFile>> RowBatchSpillFile::Create() {
+  std::string path = absl::Substitute("$0/carnot_spill_XXXXXX", FLAGS_carnot_exec_spill_dir);
+  int fd = mkstemp(path.data());
+  if (fd < 0) {
+    return error::Internal("Failed to create spill file in $0: $1", FLAGS_carnot_exec_spill_dir,
+                           std::strerror(errno));
+  }
+  // The file stays usable through the open descriptor.
+  unlink(path.c_str());
+  std::FILE* f = fdopen(fd, "w+b");
+  if (f == nullptr) {
+    close(fd);
+    return error::Internal("Failed to open spill file: $0", std::strerror(errno));
+  }
+  return std::unique_ptr<RowBatchSpillFile>(new RowBatchSpillFile(f));
+}
+
+RowBatchSpillFile::~RowBatchSpillFile() { fclose(f_); }
+
+Status RowBatchSpillFile::Append(const RowBatch& rb) {
+  table_store::schemapb::RowBatchData proto;
+  PX_RETURN_IF_ERROR(rb.ToProto(&proto));
+  std::string buf;
+  if (!proto.SerializeToString(&buf)) {
+    return error::Internal("Failed to serialize spilled row batch");
+  }
+  uint64_t len = buf.size();
+  if (fwrite(&len, sizeof(len), 1, f_) != 1 || fwrite(buf.data(), 1, len, f_) != len) {
+    return error::Internal("Failed to write spill file: $0", std::strerror(errno));
+  }
+  ++num_batches_;
+  bytes_written_ += sizeof(len) + len;
+  return Status::OK();
+}
+
+Status RowBatchSpillFile::Rewind() {
+  if (fflush(f_) != 0 || fseek(f_, 0, SEEK_SET) != 0) {
+    return error::Internal("Failed to rewind spill file: $0", std::strerror(errno));
+  }
+  return Status::OK();
+}
+
+StatusOr<std::unique_ptr<RowBatch>> RowBatchSpillFile::ReadNext() {
+  uint64_t len = 0;
+  if (fread(&len, sizeof(len), 1, f_) != 1) {
+    if (feof(f_)) {
+      return std::unique_ptr<RowBatch>(nullptr);
+    }
+    return error::Internal("Failed to read spill file: $0", std::strerror(errno));
+  }
+  std::string buf(len, '\0');
+  if (fread(buf.data(), 1, len, f_) != len) {
+    return error::Internal("Truncated spill file");
+  }
+  table_store::schemapb::RowBatchData proto;
+  if (!proto.ParseFromString(buf)) {
+    return error::Internal("Failed to parse spilled row batch");
+  }
+  return RowBatch::FromProto(proto);
+}
+
+Status SpillPartitions::Append(const RowBatch& rb, const std::vector<uint64_t>& hashes) {
+  DCHECK_GE(hashes.size(), static_cast<size_t>(rb.num_rows()));
+  std::vector<std::vector<int64_t>> partition_rows(partitions_.size());
+  for (int64_t row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+    partition_rows[PartitionForHash(hashes[row_idx])].push_back(row_idx);
+  }
+  for (size_t i = 0; i < partitions_.size(); ++i) {
+    if (partition_rows[i].empty()) {
+      continue;
+    }
+    PX_ASSIGN_OR_RETURN(auto partition_rb, TakeRows(rb, partition_rows[i]));
+    PX_RETURN_IF_ERROR(AppendToPartition(i, *partition_rb));
+  }
+  return Status::OK();
+}
+
+Status SpillPartitions::AppendToPartition(size_t partition, const RowBatch& rb) {
+  DCHECK_LT(partition, partitions_.size());
+  if (partitions_[partition] == nullptr) {
+    PX_ASSIGN_OR_RETURN(partitions_[partition], RowBatchSpillFile::Create());
+  }
+  PX_RETURN_IF_ERROR(partitions_[partition]->Append(rb));
+  ++num_batches_;
+  return Status::OK();
+}
+
+int64_t SpillPartitions::bytes_written() const {
+  int64_t bytes = 0;
+  for (const auto& partition : partitions_) {
+    if (partition != nullptr) {
+      bytes += partition->bytes_written();
+    }
+  }
+  return bytes;
+}
+
+void SpillPartitions::Clear() {
+  for (auto& partition : partitions_) {
+    partition.reset();
+  }
+  num_batches_ = 0;
+}
+
+template <types::DataType DT>
+Status TakeColumnRows(const arrow::Array* col, const std::vector<int64_t>& row_idxs,
+                      RowBatch* output_rb) {
+  auto builder = types::MakeArrowBuilder(DT, arrow::default_memory_pool());
+  PX_RETURN_IF_ERROR(builder->Reserve(row_idxs.size()));
+  for (int64_t row_idx : row_idxs) {
+    PX_RETURN_IF_ERROR(table_store::schema::CopyValue<DT>(
+        builder.get(), types::GetValueFromArrowArray<DT>(col, row_idx)));
+  }
+  std::shared_ptr<arrow::Array> arr;
+  PX_RETURN_IF_ERROR(builder->Finish(&arr));
+  return output_rb->AddColumn(arr);
+}
+
+StatusOr<std::unique_ptr<RowBatch>> TakeRows(const RowBatch& rb,
+                                             const std::vector<int64_t>& row_idxs) {
+  auto output_rb = std::make_unique<RowBatch>(rb.desc(), row_idxs.size());
+  for (int64_t col_idx = 0; col_idx < rb.num_columns(); ++col_idx) {
+    auto col = rb.ColumnAt(col_idx).get();
+#define TYPE_CASE(_dt_) PX_RETURN_IF_ERROR(TakeColumnRows<_dt_>(col, row_idxs, output_rb.get()));
+    PX_SWITCH_FOREACH_DATATYPE(rb.desc().type(col_idx), TYPE_CASE);
+#undef TYPE_CASE
+  }
+  return output_rb;
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
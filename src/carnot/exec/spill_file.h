@@ -0,0 +1,129 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/common/base/status.h"
+#include "src/table_store/schema/row_batch.h"
+
+DECLARE_string(carnot_exec_spill_dir);
+DECLARE_int32(carnot_exec_spill_partitions);
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * A temporary file of row batches, used by the blocking operators to move their state out of
+ * memory. Batches are stored as length prefixed RowBatchData protos. The file is unlinked as soon
+ * as it is created, so it is cleaned up even if the process dies.
+ */
+class RowBatchSpillFile : public NotCopyable {
+ public:
+  static StatusOr<std::unique_ptr<RowBatchSpillFile>> Create();
+  ~RowBatchSpillFile();
+
+  Status Append(const table_store::schema::RowBatch& rb);
+
+  /**
+   * Positions the file at the first batch, must be called before reading.
+   */
+  Status Rewind();
+
+  /**
+   * Reads the next batch of the file.
+   * @return the batch, or nullptr once all of the batches have been read.
+   */
+  StatusOr<std::unique_ptr<table_store::schema::RowBatch>> ReadNext();
+
+  int64_t num_batches() const { return num_batches_; }
+  int64_t bytes_written() const { return bytes_written_; }
+
+ private:
+  explicit RowBatchSpillFile(std::FILE* f) : f_(f) {}
+
+  std::FILE* f_;
+  int64_t num_batches_ = 0;
+  int64_t bytes_written_ = 0;
+};
+
+/**
+ * Grace hash partitions of spilled rows. Rows are assigned to a partition by the hash of their
+ * key, so all of the rows of a key end up in the same partition and each partition can later be
+ * processed on its own.
+ */
+class SpillPartitions : public NotCopyable {
+ public:
+  explicit SpillPartitions(size_t num_partitions) : partitions_(num_partitions) {
+    DCHECK_GT(num_partitions, 0U);
+    DCHECK_LE(num_partitions, 256U);
+  }
+
+  size_t num_partitions() const { return partitions_.size(); }
+
+  size_t PartitionForHash(uint64_t hash) const {
+    // The in-memory hash tables index on the low and middle bits of the hash, so use the top
+    // bits to keep the keys of a partition spread out once it is loaded back.
+    return (hash >> 56) % partitions_.size();
+  }
+
+  /**
+   * Appends the rows of rb to the partitions of their key hashes.
+   * @param rb The batch.
+   * @param hashes The key hash of each row of rb.
+   */
+  Status Append(const table_store::schema::RowBatch& rb, const std::vector<uint64_t>& hashes);
+
+  /**
+   * Appends rb to the given partition.
+   */
+  Status AppendToPartition(size_t partition, const table_store::schema::RowBatch& rb);
+
+  /**
+   * @return the spill file of the partition, or nullptr if nothing was spilled to it.
+   */
+  RowBatchSpillFile* partition(size_t partition) const { return partitions_[partition].get(); }
+
+  bool empty() const { return num_batches_ == 0; }
+  int64_t bytes_written() const;
+
+  /**
+   * Closes (and deletes) all of the spill files.
+   */
+  void Clear();
+
+ private:
+  std::vector<std::unique_ptr<RowBatchSpillFile>> partitions_;
+  int64_t num_batches_ = 0;
+};
+
+/**
+ * Copies the given rows of rb into a new row batch. Does not set eow and eos.
+ */
+StatusOr<std::unique_ptr<table_store::schema::RowBatch>> TakeRows(
+    const table_store::schema::RowBatch& rb, const std::vector<int64_t>& row_idxs);
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
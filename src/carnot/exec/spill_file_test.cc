@@ -0,0 +1,108 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/spill_file.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "src/carnot/exec/test_utils.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+class SpillFileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    rb_ = RowBatchBuilder(rd_, 4, /*eow*/ false, /*eos*/ true)
+              .AddColumn<types::Int64Value>({1, 2, 3, 4})
+              .AddColumn<types::StringValue>({"a", "bb", "ccc", "dddd"})
+              .get();
+  }
+
+  RowDescriptor rd_{{types::DataType::INT64, types::DataType::STRING}};
+  RowBatch rb_{rd_, 0};
+};
+
+TEST_F(SpillFileTest, round_trip) {
+  ASSERT_OK_AND_ASSIGN(auto file, RowBatchSpillFile::Create());
+  EXPECT_OK(file->Append(rb_));
+  EXPECT_OK(file->Append(rb_));
+  EXPECT_EQ(2, file->num_batches());
+  EXPECT_GT(file->bytes_written(), 0);
+
+  EXPECT_OK(file->Rewind());
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_OK_AND_ASSIGN(auto rb, file->ReadNext());
+    ASSERT_NE(nullptr, rb);
+    EXPECT_EQ(4, rb->num_rows());
+    EXPECT_TRUE(rb->eos());
+    EXPECT_TRUE(rb->ColumnAt(0)->Equals(rb_.ColumnAt(0)));
+    EXPECT_TRUE(rb->ColumnAt(1)->Equals(rb_.ColumnAt(1)));
+  }
+  ASSERT_OK_AND_ASSIGN(auto rb, file->ReadNext());
+  EXPECT_EQ(nullptr, rb);
+}
+
+TEST_F(SpillFileTest, take_rows) {
+  ASSERT_OK_AND_ASSIGN(auto rb, TakeRows(rb_, {3, 1}));
+  auto expected = RowBatchBuilder(rd_, 2, /*eow*/ false, /*eos*/ false)
+                      .AddColumn<types::Int64Value>({4, 2})
+                      .AddColumn<types::StringValue>({"dddd", "bb"})
+                      .get();
+  EXPECT_EQ(2, rb->num_rows());
+  EXPECT_TRUE(rb->ColumnAt(0)->Equals(expected.ColumnAt(0)));
+  EXPECT_TRUE(rb->ColumnAt(1)->Equals(expected.ColumnAt(1)));
+}
+
+TEST_F(SpillFileTest, partitions_keep_rows_of_a_hash_together) {
+  SpillPartitions partitions(4);
+  EXPECT_TRUE(partitions.empty());
+
+  std::vector<uint64_t> hashes = {0, 1ULL << 56, 0, 3ULL << 56};
+  EXPECT_OK(partitions.Append(rb_, hashes));
+  EXPECT_FALSE(partitions.empty());
+  EXPECT_EQ(nullptr, partitions.partition(2));
+
+  auto file = partitions.partition(0);
+  ASSERT_NE(nullptr, file);
+  EXPECT_OK(file->Rewind());
+  ASSERT_OK_AND_ASSIGN(auto rb, file->ReadNext());
+  ASSERT_NE(nullptr, rb);
+  auto expected = RowBatchBuilder(rd_, 2, /*eow*/ false, /*eos*/ false)
+                      .AddColumn<types::Int64Value>({1, 3})
+                      .AddColumn<types::StringValue>({"a", "ccc"})
+                      .get();
+  EXPECT_TRUE(rb->ColumnAt(0)->Equals(expected.ColumnAt(0)));
+  EXPECT_TRUE(rb->ColumnAt(1)->Equals(expected.ColumnAt(1)));
+
+  partitions.Clear();
+  EXPECT_TRUE(partitions.empty());
+  EXPECT_EQ(nullptr, partitions.partition(0));
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/top_k_node.h"
+
+#include <arrow/array.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+using types::DataType;
+
+namespace {
+
+template <DataType T>
+int CompareValues(const arrow::Array* a, int64_t a_idx, const arrow::Array* b, int64_t b_idx) {
+  if constexpr (T == DataType::STRING) {
+    int c = types::GetStringViewFromArrowArray(a, a_idx)
+                .compare(types::GetStringViewFromArrowArray(b, b_idx));
+    return (c > 0) - (c < 0);
+  } else {
+    auto a_val = types::GetValueFromArrowArray<T>(a, a_idx);
+    auto b_val = types::GetValueFromArrowArray<T>(b, b_idx);
+    return (b_val < a_val) - (a_val < b_val);
+  }
+}
+
+}  // namespace
+
+std::string TopKNode::DebugStringImpl() {
+  return absl::Substitute("Exec::TopKNode<$0>", plan_node_->DebugString());
+}
+
+Status TopKNode::InitImpl(const plan::Operator& plan_node) {
+  CHECK(plan_node.op_type() == planpb::OperatorType::TOP_K_OPERATOR);
+  const auto* top_k_plan_node = static_cast<const plan::TopKOperator*>(&plan_node);
+  // copy the plan node to local object;
+  plan_node_ = std::make_unique<plan::TopKOperator>(*top_k_plan_node);
+
+  for (auto sort_col : plan_node_->sort_cols()) {
+#define TYPE_CASE(_dt_) compare_fns_.push_back(&CompareValues<_dt_>);
+    PX_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(sort_col), TYPE_CASE);
+#undef TYPE_CASE
+  }
+  return Status::OK();
+}
+
+Status TopKNode::PrepareImpl(ExecState* /*exec_state*/) { return Status::OK(); }
+
+Status TopKNode::OpenImpl(ExecState* /*exec_state*/) { return Status::OK(); }
+
+Status TopKNode::CloseImpl(ExecState* /*exec_state*/) {
+  batches_.clear();
+  heap_.clear();
+  return Status::OK();
+}
+
+bool TopKNode::RowLess(const RowRef& a, const RowRef& b) const {
+  const auto& sort_cols = plan_node_->sort_cols();
+  for (size_t i = 0; i < sort_cols.size(); ++i) {
+    int c = compare_fns_[i](batches_[a.batch][sort_cols[i]].get(), a.row,
+                            batches_[b.batch][sort_cols[i]].get(), b.row);
+    if (c != 0) {
+      return plan_node_->descending()[i] ? c > 0 : c < 0;
+    }
+  }
+  return a.seq < b.seq;
+}
+
+Status TopKNode::GatherRows(std::vector<RowRef>::const_iterator begin,
+                            std::vector<RowRef>::const_iterator end,
+                            std::vector<std::shared_ptr<arrow::Array>>* columns) const {
+  for (size_t col_idx = 0; col_idx < output_descriptor_->size(); ++col_idx) {
+    auto data_type = output_descriptor_->type(col_idx);
+    auto builder = types::MakeArrowBuilder(data_type, arrow::default_memory_pool());
+    PX_RETURN_IF_ERROR(builder->Reserve(end - begin));
+    for (auto it = begin; it != end; ++it) {
+      const arrow::Array* col = batches_[it->batch][col_idx].get();
+#define TYPE_CASE(_dt_)                                                  \
+  PX_RETURN_IF_ERROR(table_store::schema::CopyValue<_dt_>(               \
+      builder.get(), types::GetValueFromArrowArray<_dt_>(col, it->row)));
+      PX_SWITCH_FOREACH_DATATYPE(data_type, TYPE_CASE);
+#undef TYPE_CASE
+    }
+    std::shared_ptr<arrow::Array> out;
+    PX_RETURN_IF_ERROR(builder->Finish(&out));
+    columns->push_back(out);
+  }
+  return Status::OK();
+}
+
+Status TopKNode::Compact() {
+  std::vector<std::shared_ptr<arrow::Array>> columns;
+  PX_RETURN_IF_ERROR(GatherRows(heap_.begin(), heap_.end(), &columns));
+  batches_.clear();
+  batches_.push_back(std::move(columns));
+  // The gathered batch keeps the heap's order, and seq is unchanged, so the heap stays valid.
+  for (size_t i = 0; i < heap_.size(); ++i) {
+    heap_[i].batch = 0;
+    heap_[i].row = i;
+  }
+  retained_rows_ = heap_.size();
+  return Status::OK();
+}
+
+Status TopKNode::EmitRows(ExecState* exec_state) {
+  auto less = [this](const RowRef& a, const RowRef& b) { return RowLess(a, b); };
+  std::sort_heap(heap_.begin(), heap_.end(), less);
+
+  if (heap_.empty()) {
+    PX_ASSIGN_OR_RETURN(auto rb, RowBatch::WithZeroRows(*output_descriptor_, /* eow */ true,
+                                                        /* eos */ true));
+    return SendRowBatchToChildren(exec_state, *rb);
+  }
+  for (auto begin = heap_.cbegin(); begin != heap_.cend();) {
+    auto end = begin + std::min<int64_t>(kDefaultTopKRowBatchSize, heap_.cend() - begin);
+    std::vector<std::shared_ptr<arrow::Array>> columns;
+    PX_RETURN_IF_ERROR(GatherRows(begin, end, &columns));
+
+    RowBatch output_rb(*output_descriptor_, end - begin);
+    for (const auto& col : columns) {
+      PX_RETURN_IF_ERROR(output_rb.AddColumn(col));
+    }
+    bool last = end == heap_.cend();
+    output_rb.set_eow(last);
+    output_rb.set_eos(last);
+    PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+    begin = end;
+  }
+  batches_.clear();
+  heap_.clear();
+  return Status::OK();
+}
+
+Status TopKNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  auto limit = static_cast<size_t>(plan_node_->limit());
+  if (limit > 0 && rb.num_rows() > 0) {
+    auto less = [this](const RowRef& a, const RowRef& b) { return RowLess(a, b); };
+    int64_t batch_idx = batches_.size();
+    // Only the sort columns are needed to decide whether any row of the batch makes the cut.
+    std::vector<std::shared_ptr<arrow::Array>> columns(output_descriptor_->size());
+    for (auto sort_col : plan_node_->sort_cols()) {
+      columns[sort_col] = rb.ColumnAt(sort_col);
+    }
+    batches_.push_back(std::move(columns));
+
+    bool retained = false;
+    for (int64_t row = 0; row < rb.num_rows(); ++row) {
+      RowRef ref{batch_idx, row, rows_seen_++};
+      if (heap_.size() < limit) {
+        heap_.push_back(ref);
+        std::push_heap(heap_.begin(), heap_.end(), less);
+        retained = true;
+      } else if (RowLess(ref, heap_.front())) {
+        std::pop_heap(heap_.begin(), heap_.end(), less);
+        heap_.back() = ref;
+        std::push_heap(heap_.begin(), heap_.end(), less);
+        retained = true;
+      }
+    }
+
+    if (!retained) {
+      batches_.pop_back();
+    } else {
+      auto& batch = batches_.back();
+      for (size_t col_idx = 0; col_idx < batch.size(); ++col_idx) {
+        if (batch[col_idx] == nullptr) {
+          batch[col_idx] = rb.ColumnAt(col_idx);
+        }
+      }
+      retained_rows_ += rb.num_rows();
+      if (retained_rows_ > static_cast<int64_t>(std::max<size_t>(2 * limit,
+                                                                  kDefaultTopKRowBatchSize))) {
+        PX_RETURN_IF_ERROR(Compact());
+      }
+    }
+  }
+
+  if (rb.eos()) {
+    return EmitRows(exec_state);
+  }
+  return Status::OK();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/plan/operators.h"
+#include "src/common/base/base.h"
+#include "src/common/base/status.h"
+#include "src/table_store/table_store.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+constexpr int64_t kDefaultTopKRowBatchSize = 1024;
+
+/**
+ * TopKNode outputs the first `limit` rows of its input in sort order, once the input is done.
+ *
+ * Rather than buffering and sorting its whole input, it keeps a bounded heap of references to the
+ * best `limit` rows seen so far. Input batches are retained only while they hold a row in the
+ * heap, and the retained rows are compacted into a single batch whenever the retained batches
+ * grow well past `limit` rows, so memory stays proportional to `limit`.
+ */
+class TopKNode : public ProcessingNode {
+ public:
+  TopKNode() = default;
+  virtual ~TopKNode() = default;
+
+ protected:
+  std::string DebugStringImpl() override;
+  Status InitImpl(const plan::Operator& plan_node) override;
+  Status PrepareImpl(ExecState* exec_state) override;
+  Status OpenImpl(ExecState* exec_state) override;
+  Status CloseImpl(ExecState* exec_state) override;
+  Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                         size_t parent_index) override;
+
+ private:
+  // A reference to a row in one of the retained batches. seq is the position of the row in the
+  // input, which breaks ties between equal rows so that the output is stable.
+  struct RowRef {
+    int64_t batch;
+    int64_t row;
+    int64_t seq;
+  };
+  using CompareFn = int (*)(const arrow::Array*, int64_t, const arrow::Array*, int64_t);
+
+  // Returns whether row a comes before row b in the output.
+  bool RowLess(const RowRef& a, const RowRef& b) const;
+  Status GatherRows(std::vector<RowRef>::const_iterator begin,
+                    std::vector<RowRef>::const_iterator end,
+                    std::vector<std::shared_ptr<arrow::Array>>* columns) const;
+  Status Compact();
+  Status EmitRows(ExecState* exec_state);
+
+  std::unique_ptr<plan::TopKOperator> plan_node_;
+  std::vector<CompareFn> compare_fns_;
+  // The columns of each retained input batch. Batches with no rows in the heap are released on
+  // compaction.
+  std::vector<std::vector<std::shared_ptr<arrow::Array>>> batches_;
+  int64_t retained_rows_ = 0;
+  int64_t rows_seen_ = 0;
+  // Max-heap under RowLess, so the front is the worst row currently kept.
+  std::vector<RowRef> heap_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
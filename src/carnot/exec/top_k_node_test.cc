@@ -0,0 +1,145 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/top_k_node.h"
+
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/planpb/test_proto.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowDescriptor;
+using types::Int64Value;
+
+class TopKNodeTest : public ::testing::Test {
+ public:
+  TopKNodeTest() {
+    // Top 3 rows, ordered by column 1 descending, then column 0 ascending.
+    auto op_proto = planpb::testutils::CreateTestTopK1PB();
+    plan_node_ = plan::TopKOperator::FromProto(op_proto, 1);
+
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    auto table_store = std::make_shared<table_store::TableStore>();
+    exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
+                                              MockResultSinkStubGenerator, MockMetricsStubGenerator,
+                                              MockTraceStubGenerator, sole::uuid4(), nullptr);
+  }
+
+ protected:
+  std::unique_ptr<plan::Operator> plan_node_;
+  std::unique_ptr<ExecState> exec_state_;
+  std::unique_ptr<udf::Registry> func_registry_;
+  RowDescriptor rd_{types::DataType::INT64, types::DataType::INT64};
+};
+
+TEST_F(TopKNodeTest, multiple_batches) {
+  auto tester = exec::ExecNodeTester<TopKNode, plan::TopKOperator>(*plan_node_, rd_, {rd_},
+                                                                   exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(rd_, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<Int64Value>({1, 2, 3, 4})
+                       .AddColumn<Int64Value>({10, 30, 20, 30})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(rd_, 3, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<Int64Value>({5, 6, 0})
+                       .AddColumn<Int64Value>({5, 40, 30})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(rd_, 3, true, true)
+                          .AddColumn<Int64Value>({6, 0, 2})
+                          .AddColumn<Int64Value>({40, 30, 30})
+                          .get())
+      .Close();
+}
+
+TEST_F(TopKNodeTest, fewer_rows_than_limit) {
+  auto tester = exec::ExecNodeTester<TopKNode, plan::TopKOperator>(*plan_node_, rd_, {rd_},
+                                                                   exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(rd_, 2, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<Int64Value>({1, 2})
+                       .AddColumn<Int64Value>({10, 20})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(rd_, 2, true, true)
+                          .AddColumn<Int64Value>({2, 1})
+                          .AddColumn<Int64Value>({20, 10})
+                          .get())
+      .Close();
+}
+
+TEST_F(TopKNodeTest, empty_input) {
+  auto tester = exec::ExecNodeTester<TopKNode, plan::TopKOperator>(*plan_node_, rd_, {rd_},
+                                                                   exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(rd_, 0, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<Int64Value>({})
+                       .AddColumn<Int64Value>({})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(rd_, 0, true, true)
+                          .AddColumn<Int64Value>({})
+                          .AddColumn<Int64Value>({})
+                          .get())
+      .Close();
+}
+
+TEST_F(TopKNodeTest, compacts_retained_batches) {
+  auto tester = exec::ExecNodeTester<TopKNode, plan::TopKOperator>(*plan_node_, rd_, {rd_},
+                                                                   exec_state_.get());
+  // Every batch holds the best rows so far, so every batch is retained until compaction.
+  int64_t num_batches = 5;
+  int64_t rows_per_batch = 500;
+  for (int64_t i = 0; i < num_batches; ++i) {
+    std::vector<Int64Value> col0;
+    std::vector<Int64Value> col1;
+    for (int64_t j = 0; j < rows_per_batch; ++j) {
+      col0.push_back(j);
+      col1.push_back(i * rows_per_batch + j);
+    }
+    bool last = i == num_batches - 1;
+    tester.ConsumeNext(RowBatchBuilder(rd_, rows_per_batch, last, last)
+                           .AddColumn<Int64Value>(col0)
+                           .AddColumn<Int64Value>(col1)
+                           .get(),
+                       0, last ? 1 : 0);
+  }
+  tester
+      .ExpectRowBatch(RowBatchBuilder(rd_, 3, true, true)
+                          .AddColumn<Int64Value>({499, 498, 497})
+                          .AddColumn<Int64Value>({2499, 2498, 2497})
+                          .get())
+      .Close();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -20,6 +20,7 @@
 
 #include <arrow/array/builder_base.h>
 #include <arrow/memory_pool.h>
+#include <algorithm>
 #include <ostream>
 #include <string>
 #include <string_view>
@@ -30,12 +31,22 @@
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/base.h"
+#include "src/common/base/thread_pool.h"
 #include "src/common/memory/object_pool.h"
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/types.h"
 #include "src/shared/types/typespb/wrapper/types_pb_wrapper.h"
 #include "src/table_store/table_store.h"
 
+DEFINE_int32(carnot_udtf_prefetch_num_threads,
+             gflags::Int32FromEnv("PL_CARNOT_UDTF_PREFETCH_NUM_THREADS", 4),
+             "The number of threads that run UDTFs ahead of the query, shared by all of the UDTF "
+             "sources. 0 runs the UDTFs synchronously from the query.");
+DEFINE_int32(carnot_udtf_prefetch_batches,
+             gflags::Int32FromEnv("PL_CARNOT_UDTF_PREFETCH_BATCHES", 4),
+             "The number of batches a UDTF source prefetches before it waits for the query to "
+             "consume them.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -44,6 +55,18 @@ namespace exec {
 // The batch size to use for UDTFs by default.
 constexpr int kUDTFBatchSize = 1024;
 
+namespace {
+ThreadPool* UDTFPrefetchThreadPool() {
+  static ThreadPool pool(std::max(0, FLAGS_carnot_udtf_prefetch_num_threads));
+  return &pool;
+}
+}  // namespace
+
+UDTFSourceNode::~UDTFSourceNode() {
+  // A prefetch task references this node until it returns.
+  CancelPrefetch();
+}
+
 std::string UDTFSourceNode::DebugStringImpl() {
   return absl::Substitute("Exec::UDTFSourceNode<$0>", plan_node_->DebugString());
 }
@@ -59,6 +82,13 @@ Status UDTFSourceNode::InitImpl(const plan::Operator& plan_node) {
 Status UDTFSourceNode::PrepareImpl(ExecState* exec_state) {
   // Always has more batches to start with.
   has_more_batches_ = true;
+  {
+    absl::MutexLock lock(&prefetch_lock_);
+    prefetched_batches_.clear();
+    prefetch_status_ = Status::OK();
+    prefetch_done_ = false;
+    prefetch_cancelled_ = false;
+  }
   PX_ASSIGN_OR_RETURN(udtf_def_,
                       exec_state->func_registry()->GetUDTFDefinition(plan_node_->name()));
   return Status::OK();
@@ -95,12 +125,74 @@ Status UDTFSourceNode::OpenImpl(ExecState* exec_state) {
     }
   }
 
-  return udtf_def_->ExecInit(udtf_inst_.get(), function_ctx_.get(), init_args);
+  PX_RETURN_IF_ERROR(udtf_def_->ExecInit(udtf_inst_.get(), function_ctx_.get(), init_args));
+
+  prefetch_ = UDTFPrefetchThreadPool()->num_threads() > 0;
+  if (prefetch_) {
+    absl::MutexLock lock(&prefetch_lock_);
+    MaybeSchedulePrefetch();
+  }
+  return Status::OK();
 }
 
-Status UDTFSourceNode::CloseImpl(ExecState* /*exec_state*/) { return Status::OK(); }
+Status UDTFSourceNode::CloseImpl(ExecState* /*exec_state*/) {
+  CancelPrefetch();
+  return Status::OK();
+}
 
-Status UDTFSourceNode::GenerateNextImpl(ExecState* exec_state) {
+void UDTFSourceNode::CancelPrefetch() {
+  absl::MutexLock lock(&prefetch_lock_);
+  prefetch_cancelled_ = true;
+  prefetch_lock_.Await(absl::Condition(this, &UDTFSourceNode::PrefetchStopped));
+}
+
+bool UDTFSourceNode::PrefetchStopped() { return !prefetch_running_; }
+
+bool UDTFSourceNode::PrefetchedBatchReady() {
+  return !prefetched_batches_.empty() || !prefetch_status_.ok();
+}
+
+void UDTFSourceNode::MaybeSchedulePrefetch() {
+  if (prefetch_running_ || prefetch_done_ || prefetch_cancelled_ ||
+      static_cast<int64_t>(prefetched_batches_.size()) >= FLAGS_carnot_udtf_prefetch_batches) {
+    return;
+  }
+  prefetch_running_ = true;
+  UDTFPrefetchThreadPool()->Schedule([this]() { Prefetch(); });
+}
+
+void UDTFSourceNode::Prefetch() {
+  bool keep_prefetching = true;
+  while (keep_prefetching) {
+    auto rb_or_s = RunUDTFBatch();
+    {
+      absl::MutexLock lock(&prefetch_lock_);
+      if (rb_or_s.ok()) {
+        auto rb = rb_or_s.ConsumeValueOrDie();
+        prefetch_done_ = rb->eos();
+        prefetched_batches_.push_back(std::move(rb));
+      } else {
+        prefetch_status_ = rb_or_s.status();
+        prefetch_done_ = true;
+      }
+    }
+    if (batch_ready_callback_) {
+      batch_ready_callback_();
+    }
+
+    // Stops once the queue is full. GenerateNext schedules the next prefetch when it takes a
+    // batch off the queue.
+    absl::MutexLock lock(&prefetch_lock_);
+    keep_prefetching =
+        !prefetch_done_ && !prefetch_cancelled_ &&
+        static_cast<int64_t>(prefetched_batches_.size()) < FLAGS_carnot_udtf_prefetch_batches;
+    if (!keep_prefetching) {
+      prefetch_running_ = false;
+    }
+  }
+}
+
+StatusOr<std::unique_ptr<table_store::schema::RowBatch>> UDTFSourceNode::RunUDTFBatch() {
   std::vector<std::unique_ptr<arrow::ArrayBuilder>> outputs;
 
   for (const auto& r : udtf_def_->output_relation()) {
@@ -113,22 +205,44 @@ Status UDTFSourceNode::GenerateNextImpl(ExecState* exec_state) {
     outputs_raw.emplace_back(out.get());
   }
 
-  auto has_more_batches = udtf_def_->ExecBatchUpdate(udtf_inst_.get(), function_ctx_.get(),
-                                                     kUDTFBatchSize, &outputs_raw);
+  has_more_batches_ = udtf_def_->ExecBatchUpdate(udtf_inst_.get(), function_ctx_.get(),
+                                                 kUDTFBatchSize, &outputs_raw);
 
   DCHECK_GT(outputs.size(), 0U);
 
-  auto rb_or_s = table_store::schema::RowBatch::FromColumnBuilders(
-      *output_descriptor_, /*eow*/ !has_more_batches, /*eow*/ !has_more_batches, &outputs);
-  if (!rb_or_s.ok()) {
-    return rb_or_s.status();
+  return table_store::schema::RowBatch::FromColumnBuilders(
+      *output_descriptor_, /*eow*/ !has_more_batches_, /*eow*/ !has_more_batches_, &outputs);
+}
+
+Status UDTFSourceNode::GenerateNextImpl(ExecState* exec_state) {
+  if (!prefetch_) {
+    PX_ASSIGN_OR_RETURN(auto rb, RunUDTFBatch());
+    return SendRowBatchToChildren(exec_state, *rb);
   }
-  auto rb = rb_or_s.ConsumeValueOrDie();
 
+  std::unique_ptr<table_store::schema::RowBatch> rb;
+  {
+    absl::MutexLock lock(&prefetch_lock_);
+    // This only waits when GenerateNext is called without checking NextBatchReady first.
+    prefetch_lock_.Await(absl::Condition(this, &UDTFSourceNode::PrefetchedBatchReady));
+    // Batches produced before an error are still sent.
+    if (prefetched_batches_.empty()) {
+      return prefetch_status_;
+    }
+    rb = std::move(prefetched_batches_.front());
+    prefetched_batches_.pop_front();
+    MaybeSchedulePrefetch();
+  }
   return SendRowBatchToChildren(exec_state, *rb);
 }
 
-bool UDTFSourceNode::NextBatchReady() { return HasBatchesRemaining(); }
+bool UDTFSourceNode::NextBatchReady() {
+  if (!prefetch_) {
+    return HasBatchesRemaining();
+  }
+  absl::MutexLock lock(&prefetch_lock_);
+  return HasBatchesRemaining() && PrefetchedBatchReady();
+}
 
 }  // namespace exec
 }  // namespace carnot
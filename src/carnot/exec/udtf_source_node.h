@@ -18,10 +18,16 @@
 
 #pragma once
 
+#include <deque>
+#include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/plan/operators.h"
@@ -37,13 +43,28 @@ namespace px {
 namespace carnot {
 namespace exec {
 
+/**
+ * UDTFSourceNode runs a UDTF and sends its records downstream.
+ *
+ * When the UDTF prefetch pool has threads, the UDTF runs on that pool and its batches are
+ * prefetched into a bounded queue, so UDTFs that block on RPCs don't stall the rest of the query.
+ * NextBatchReady() then reports whether a prefetched batch is waiting.
+ */
 class UDTFSourceNode : public SourceNode {
  public:
   UDTFSourceNode() = default;
-  virtual ~UDTFSourceNode() = default;
+  virtual ~UDTFSourceNode();
 
   bool NextBatchReady() override;
 
+  /**
+   * Sets a callback that is called whenever a prefetched batch becomes ready, so the execution
+   * graph can wake up instead of waiting for its yield timeout.
+   */
+  void set_batch_ready_callback(std::function<void()> callback) {
+    batch_ready_callback_ = std::move(callback);
+  }
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -53,7 +74,27 @@ class UDTFSourceNode : public SourceNode {
   Status GenerateNextImpl(ExecState* exec_state) override;
 
  private:
+  StatusOr<std::unique_ptr<table_store::schema::RowBatch>> RunUDTFBatch();
+  void Prefetch();
+  void CancelPrefetch();
+  void MaybeSchedulePrefetch() ABSL_EXCLUSIVE_LOCKS_REQUIRED(prefetch_lock_);
+  bool PrefetchStopped() ABSL_EXCLUSIVE_LOCKS_REQUIRED(prefetch_lock_);
+  bool PrefetchedBatchReady() ABSL_EXCLUSIVE_LOCKS_REQUIRED(prefetch_lock_);
+
   bool has_more_batches_ = true;
+  bool prefetch_ = false;
+  std::function<void()> batch_ready_callback_;
+
+  absl::Mutex prefetch_lock_;
+  std::deque<std::unique_ptr<table_store::schema::RowBatch>> prefetched_batches_
+      ABSL_GUARDED_BY(prefetch_lock_);
+  Status prefetch_status_ ABSL_GUARDED_BY(prefetch_lock_);
+  // Whether the UDTF produced its last batch.
+  bool prefetch_done_ ABSL_GUARDED_BY(prefetch_lock_) = false;
+  // Whether a prefetch task is scheduled or running. Only one runs at a time, since a UDTF
+  // instance isn't thread safe.
+  bool prefetch_running_ ABSL_GUARDED_BY(prefetch_lock_) = false;
+  bool prefetch_cancelled_ ABSL_GUARDED_BY(prefetch_lock_) = false;
   udf::UDTFDefinition* udtf_def_ = nullptr;
   std::unique_ptr<plan::UDTFSourceOperator> plan_node_;
   std::unique_ptr<udf::FunctionContext> function_ctx_;
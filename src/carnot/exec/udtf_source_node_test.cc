@@ -19,7 +19,10 @@
 #include "src/carnot/exec/udtf_source_node.h"
 
 #include <stdint.h>
+#include <algorithm>
+#include <chrono>
 #include <memory>
+#include <thread>
 #include <vector>
 
 #include <google/protobuf/text_format.h>
@@ -87,6 +90,27 @@ class BasicTestUDTF : public UDTF<BasicTestUDTF> {
   std::string some_string_;
 };
 
+// Produces kNumRecords records, which takes several output batches.
+class CountingTestUDTF : public UDTF<CountingTestUDTF> {
+ public:
+  static constexpr int64_t kNumRecords = 2050;
+
+  static constexpr auto Executor() { return udfspb::UDTFSourceExecutor::UDTF_ALL_AGENTS; }
+
+  static constexpr auto OutputRelation() {
+    return MakeArray(
+        ColInfo("out_int", types::DataType::INT64, types::PatternType::GENERAL, "int result"));
+  }
+
+  bool NextRecord(FunctionContext*, RecordWriter* rw) {
+    rw->Append<IndexOf("out_int")>(idx_);
+    return ++idx_ < kNumRecords;
+  }
+
+ private:
+  int64_t idx_ = 0;
+};
+
 constexpr char kUDTFTestPbtxt[] = R"proto(
   op_type: UDTF_SOURCE_OPERATOR
   udtf_source_op {
@@ -111,6 +135,7 @@ class UDTFSourceNodeTest : public ::testing::Test {
 
     func_registry_ = std::make_unique<udf::Registry>("test_registry");
     EXPECT_OK(func_registry_->Register<BasicTestUDTF>("test_udtf"));
+    EXPECT_OK(func_registry_->Register<CountingTestUDTF>("counting_udtf"));
     auto table_store = std::make_shared<table_store::TableStore>();
 
     exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
@@ -136,6 +161,42 @@ TEST_F(UDTFSourceNodeTest, single_output_batch_test) {
           .get());
 }
 
+TEST_F(UDTFSourceNodeTest, multiple_output_batches_test) {
+  planpb::Operator op_pb;
+  EXPECT_TRUE(google::protobuf::TextFormat::MergeFromString(
+      R"proto(
+        op_type: UDTF_SOURCE_OPERATOR
+        udtf_source_op { name: "counting_udtf" }
+      )proto",
+      &op_pb));
+  auto plan_node = plan::UDTFSourceOperator::FromProto(op_pb, 1);
+
+  RowDescriptor output_rd({types::DataType::INT64});
+  auto tester = exec::ExecNodeTester<UDTFSourceNode, plan::UDTFSourceOperator>(
+      *plan_node, output_rd, {}, exec_state_.get());
+
+  std::vector<types::Int64Value> expected;
+  for (int64_t i = 0; i < CountingTestUDTF::kNumRecords; ++i) {
+    expected.emplace_back(i);
+  }
+  for (size_t start = 0; start < expected.size(); start += 1024) {
+    // Batches can be prefetched on another thread, wait for the next one like the exec graph.
+    while (!tester.node()->NextBatchReady()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    size_t end = std::min(expected.size(), start + 1024);
+    bool eos = end == expected.size();
+    tester.GenerateNextResult().ExpectRowBatch(
+        RowBatchBuilder(output_rd, end - start, /*eow*/ eos, /*eos*/ eos)
+            .AddColumn<types::Int64Value>(
+                std::vector<types::Int64Value>(expected.begin() + start, expected.begin() + end))
+            .get());
+  }
+  EXPECT_FALSE(tester.node()->HasBatchesRemaining());
+  EXPECT_FALSE(tester.node()->NextBatchReady());
+  tester.Close();
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -77,6 +77,9 @@ Status UnionNode::PrepareImpl(ExecState*) {
     time_columns_.resize(num_parents_);
     data_columns_.resize(num_parents_, std::vector<arrow::Array*>(num_output_cols));
 
+    merge_heap_.reserve(num_parents_);
+    num_waiting_parents_ = num_parents_;
+
     column_builders_.resize(num_output_cols);
     PX_RETURN_IF_ERROR(InitializeColumnBuilders());
   }
@@ -111,13 +114,66 @@ types::Time64NSValue UnionNode::GetTimeAtParentCursor(size_t parent_index) const
                                                         row_cursors_[parent_index]);
 }
 
-Status UnionNode::AppendRow(size_t parent) {
-  auto row = row_cursors_[parent];
+// Returns whether the cursor row of parent_a is merged after the cursor row of parent_b.
+// Rows with the same time are merged in parent order, which keeps the output stable.
+bool UnionNode::MergesAfter(size_t parent_a, size_t parent_b) const {
+  auto time_a = GetTimeAtParentCursor(parent_a);
+  auto time_b = GetTimeAtParentCursor(parent_b);
+  return time_a > time_b || (time_a == time_b && parent_a > parent_b);
+}
+
+// Returns the end of the run of rows of the parent's current row batch, starting at its cursor,
+// that can be merged before any row of the other parents. The parent must be the top of the
+// merge heap after it was popped off of it, and the run is limited to the rows that still fit in
+// the output batch.
+size_t UnionNode::MergeRunEnd(size_t parent) const {
+  auto start = row_cursors_[parent];
+  const auto* times = static_cast<const arrow::Time64Array*>(time_columns_[parent])->raw_values();
+  size_t end = time_columns_[parent]->length();
+  end = std::min(end, start + output_rows_per_batch_ -
+                          static_cast<size_t>(column_builders_[0]->length()));
+  if (merge_heap_.empty()) {
+    return end;
+  }
+  size_t next_parent = merge_heap_.front();
+  int64_t limit = GetTimeAtParentCursor(next_parent).val;
+  // The input times are sorted, so the run ends at the first row that merges after the cursor
+  // row of the next parent.
+  if (parent < next_parent) {
+    return std::upper_bound(times + start, times + end, limit) - times;
+  }
+  return std::lower_bound(times + start, times + end, limit) - times;
+}
+
+namespace {
+
+template <types::DataType T>
+Status CopyRows(arrow::ArrayBuilder* output_col_builder, const arrow::Array* input_col,
+                size_t start, size_t end) {
+  if constexpr (T == types::DataType::INT64 || T == types::DataType::FLOAT64 ||
+                T == types::DataType::TIME64NS) {
+    auto* typed_col_builder =
+        static_cast<typename types::DataTypeTraits<T>::arrow_builder_type*>(output_col_builder);
+    const auto* values =
+        static_cast<const typename types::DataTypeTraits<T>::arrow_array_type*>(input_col)
+            ->raw_values();
+    PX_RETURN_IF_ERROR(typed_col_builder->AppendValues(values + start, end - start));
+  } else {
+    for (size_t row = start; row < end; ++row) {
+      PX_RETURN_IF_ERROR(table_store::schema::CopyValue<T>(
+          output_col_builder, types::GetValueFromArrowArray<T>(input_col, row)));
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status UnionNode::AppendRows(size_t parent, size_t start, size_t end) {
   for (size_t i = 0; i < output_descriptor_->size(); ++i) {
     auto input_col = data_columns_[parent][i];
-#define TYPE_CASE(_dt_)                                    \
-  PX_RETURN_IF_ERROR(table_store::schema::CopyValue<_dt_>( \
-      column_builders_[i].get(), types::GetValueFromArrowArray<_dt_>(input_col, row)));
+#define TYPE_CASE(_dt_) \
+  PX_RETURN_IF_ERROR(CopyRows<_dt_>(column_builders_[i].get(), input_col, start, end));
     PX_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(i), TYPE_CASE);
 #undef TYPE_CASE
   }
@@ -170,70 +226,54 @@ Status UnionNode::FlushBatch(ExecState* exec_state) {
 }
 
 Status UnionNode::MergeData(ExecState* exec_state) {
+  auto merges_after = [this](size_t parent_a, size_t parent_b) {
+    return MergesAfter(parent_a, parent_b);
+  };
   while (!sent_eos_) {
-    // Get the smallest time out of all of the current streams.
-    std::vector<size_t> parent_streams;
-    parent_streams.reserve(row_cursors_.size());
-
-    for (size_t parent = 0; parent < row_cursors_.size(); ++parent) {
-      if (flushed_parent_eoses_[parent]) {
-        continue;
-      }
-      // If we lack necessary data, we can't merge anymore.
-      if (!parent_row_batches_[parent].size()) {
-        return Status::OK();
-      }
-      parent_streams.push_back(parent);
+    // If we lack necessary data, we can't merge anymore.
+    if (num_waiting_parents_ > 0) {
+      return Status::OK();
     }
-
     // If we have reached end of stream for all of our inputs, flush the queue.
-    if (!parent_streams.size()) {
+    if (merge_heap_.empty()) {
       return OptionallyFlushRowBatchIfMaxRowsOrEOS(exec_state);
     }
 
-    std::sort(parent_streams.begin(), parent_streams.end(),
-              [this](size_t parent_a, size_t parent_b) {
-                auto time_a = GetTimeAtParentCursor(parent_a);
-                auto time_b = GetTimeAtParentCursor(parent_b);
-                return time_a < time_b || (time_a == time_b && parent_a < parent_b);
-              });
-
-    bool has_limit = parent_streams.size() > 1;
-    size_t parent = parent_streams[0];
-
-    while (parent_row_batches_[parent].size()) {
-      if (has_limit) {
-        size_t next_parent = parent_streams[1];
-        // If this time is greater than another parent stream's earliest time,
-        // or if they are the same but the first parent is at a smaller index, stop merging.
-        // This way rows are always stable with respect to input parent index.
-        if (GetTimeAtParentCursor(parent) > GetTimeAtParentCursor(next_parent) ||
-            (GetTimeAtParentCursor(parent) == GetTimeAtParentCursor(next_parent) &&
-             parent > next_parent)) {
-          break;
-        }
-      }
-
-      PX_RETURN_IF_ERROR(AppendRow(parent));
-
-      // Mark whether or not we hit the eos for this stream, and whether the row batch needs to be
-      // popped.
-      const auto& rb = parent_row_batches_[parent][0];
-      bool pop_row_batch = ++row_cursors_[parent] == static_cast<size_t>(rb.num_rows());
-      if (pop_row_batch && rb.eos()) {
+    // Take the parent with the smallest time out of all of the current streams, and copy the
+    // rows that come before the smallest time of the others.
+    std::pop_heap(merge_heap_.begin(), merge_heap_.end(), merges_after);
+    size_t parent = merge_heap_.back();
+    merge_heap_.pop_back();
+
+    size_t start = row_cursors_[parent];
+    size_t end = MergeRunEnd(parent);
+    PX_RETURN_IF_ERROR(AppendRows(parent, start, end));
+    row_cursors_[parent] = end;
+
+    // Mark whether or not we hit the eos for this stream, and whether the row batch needs to be
+    // popped.
+    const auto& rb = parent_row_batches_[parent].front();
+    if (end == static_cast<size_t>(rb.num_rows())) {
+      if (rb.eos()) {
         flushed_parent_eoses_[parent] = true;
       }
+      // Delete the top row batch from our buffer and update the cursor.
+      parent_row_batches_[parent].pop_front();
+      row_cursors_[parent] = 0;
+      CacheNextRowBatch(parent);
+    }
 
-      if (pop_row_batch) {
-        // Delete the top row batch from our buffer and update the cursor.
-        parent_row_batches_[parent].erase(parent_row_batches_[parent].begin());
-        row_cursors_[parent] = 0;
-        CacheNextRowBatch(parent);
+    if (!flushed_parent_eoses_[parent]) {
+      if (parent_row_batches_[parent].empty()) {
+        ++num_waiting_parents_;
+      } else {
+        merge_heap_.push_back(parent);
+        std::push_heap(merge_heap_.begin(), merge_heap_.end(), merges_after);
       }
-
-      // Flush the current RowBatch if necessary.
-      PX_RETURN_IF_ERROR(OptionallyFlushRowBatchIfMaxRowsOrEOS(exec_state));
     }
+
+    // Flush the current RowBatch if necessary.
+    PX_RETURN_IF_ERROR(OptionallyFlushRowBatchIfMaxRowsOrEOS(exec_state));
   }
   return Status::OK();
 }
@@ -244,7 +284,7 @@ void UnionNode::CacheNextRowBatch(size_t parent) {
     if (parent_row_batches_[parent][0].eos()) {
       flushed_parent_eoses_[parent] = true;
     }
-    parent_row_batches_[parent].erase(parent_row_batches_[parent].begin());
+    parent_row_batches_[parent].pop_front();
   }
   if (!parent_row_batches_[parent].size()) {
     return;
@@ -259,8 +299,18 @@ void UnionNode::CacheNextRowBatch(size_t parent) {
 
 Status UnionNode::ConsumeNextOrdered(ExecState* exec_state, const RowBatch& rb,
                                      size_t parent_index) {
+  bool was_waiting = parent_row_batches_[parent_index].empty();
   parent_row_batches_[parent_index].push_back(rb);
   CacheNextRowBatch(parent_index);
+  if (was_waiting && (flushed_parent_eoses_[parent_index] ||
+                      !parent_row_batches_[parent_index].empty())) {
+    --num_waiting_parents_;
+    if (!flushed_parent_eoses_[parent_index]) {
+      merge_heap_.push_back(parent_index);
+      std::push_heap(merge_heap_.begin(), merge_heap_.end(),
+                     [this](size_t a, size_t b) { return MergesAfter(a, b); });
+    }
+  }
   PX_RETURN_IF_ERROR(MergeData(exec_state));
   return OptionallyFlushRowBatchIfTimeout(exec_state);
 }
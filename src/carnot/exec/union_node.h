@@ -21,6 +21,7 @@
 #include <arrow/array.h>
 #include <arrow/array/builder_base.h>
 #include <stddef.h>
+#include <deque>
 #include <memory>
 #include <string>
 #include <utility>
@@ -91,7 +92,9 @@ class UnionNode : public ProcessingNode {
   void CacheNextRowBatch(size_t parent);
   Status InitializeColumnBuilders();
   types::Time64NSValue GetTimeAtParentCursor(size_t parent_index) const;
-  Status AppendRow(size_t parent);
+  bool MergesAfter(size_t parent_a, size_t parent_b) const;
+  size_t MergeRunEnd(size_t parent) const;
+  Status AppendRows(size_t parent, size_t start, size_t end);
   Status OptionallyFlushRowBatchIfMaxRowsOrEOS(ExecState* exec_state);
   Status OptionallyFlushRowBatchIfTimeout(ExecState* exec_state);
   Status FlushBatch(ExecState* exec_state);
@@ -105,13 +108,18 @@ class UnionNode : public ProcessingNode {
   std::vector<std::unique_ptr<arrow::ArrayBuilder>> column_builders_;
 
   // Hold onto the input row batches for every parent until we copy all of their data.
-  std::vector<std::vector<table_store::schema::RowBatch>> parent_row_batches_;
+  std::vector<std::deque<table_store::schema::RowBatch>> parent_row_batches_;
   // Keep track of where we are in the stream for each parent.
   // The row is always relative to the 'top' row batch that we have for each parent.
   std::vector<size_t> row_cursors_;
   // Cache current working time and data columns for performance reasons.
   std::vector<arrow::Array*> time_columns_;
   std::vector<std::vector<arrow::Array*>> data_columns_;
+  // Min-heap (ordered by MergesAfter) of the parents that have rows to merge.
+  std::vector<size_t> merge_heap_;
+  // The number of parents that haven't sent eos but have no rows to merge. Rows can only be
+  // merged while this is 0, since any of these parents could send earlier rows.
+  size_t num_waiting_parents_ = 0;
 
   bool enable_data_flush_timeout_ = true;
   // When enable_data_flush_timeout_ is set to true, use this time to decide if we should
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/exec/union_node.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/types.h"
+
+using px::carnot::exec::RowBatchBuilder;
+using px::table_store::schema::RowBatch;
+using px::table_store::schema::RowDescriptor;
+using px::types::DataType;
+
+constexpr int64_t kRowsPerBatch = 1024;
+constexpr int64_t kBatchesPerParent = 8;
+
+// Merges the time ordered streams of state.range(0) parents, as a Kelvin does for the results of
+// its PEMs. The rows of the parents interleave when state.range(1) == 1, and otherwise each parent
+// covers its own time range, so that whole batches can be copied at once.
+// NOLINTNEXTLINE : runtime/references.
+void BM_UnionNodeOrderedMerge(benchmark::State& state) {
+  int64_t num_parents = state.range(0);
+  bool interleaved = state.range(1) == 1;
+
+  auto func_registry = std::make_unique<px::carnot::udf::Registry>("test_registry");
+  auto table_store = std::make_shared<px::table_store::TableStore>();
+  auto exec_state = std::make_unique<px::carnot::exec::ExecState>(
+      func_registry.get(), table_store, px::carnot::exec::MockResultSinkStubGenerator,
+      px::carnot::exec::MockMetricsStubGenerator, px::carnot::exec::MockTraceStubGenerator,
+      sole::uuid4(), nullptr);
+
+  px::carnot::planpb::Operator op_proto;
+  op_proto.set_op_type(px::carnot::planpb::UNION_OPERATOR);
+  auto* union_pb = op_proto.mutable_union_op();
+  union_pb->add_column_names("time_");
+  union_pb->add_column_names("value");
+  union_pb->set_rows_per_batch(kRowsPerBatch);
+  for (int64_t i = 0; i < num_parents; ++i) {
+    auto* mapping = union_pb->add_column_mappings();
+    mapping->add_column_indexes(0);
+    mapping->add_column_indexes(1);
+  }
+  auto plan_node = px::carnot::plan::UnionOperator::FromProto(op_proto, /*id*/ 1);
+
+  RowDescriptor rd({DataType::TIME64NS, DataType::INT64});
+  std::vector<std::vector<RowBatch>> parent_batches(num_parents);
+  for (int64_t parent = 0; parent < num_parents; ++parent) {
+    for (int64_t batch = 0; batch < kBatchesPerParent; ++batch) {
+      std::vector<px::types::Time64NSValue> times;
+      std::vector<px::types::Int64Value> values;
+      for (int64_t row = 0; row < kRowsPerBatch; ++row) {
+        int64_t idx = batch * kRowsPerBatch + row;
+        times.push_back(interleaved ? idx * num_parents + parent
+                                    : parent * kBatchesPerParent * kRowsPerBatch + idx);
+        values.push_back(idx);
+      }
+      bool eos = batch == kBatchesPerParent - 1;
+      parent_batches[parent].push_back(RowBatchBuilder(rd, kRowsPerBatch, eos, eos)
+                                           .AddColumn<px::types::Time64NSValue>(times)
+                                           .AddColumn<px::types::Int64Value>(values)
+                                           .get());
+    }
+  }
+
+  for (auto _ : state) {
+    px::carnot::exec::UnionNode node;
+    node.disable_data_flush_timeout();
+    PX_CHECK_OK(node.Init(*plan_node, rd, std::vector<RowDescriptor>(num_parents, rd)));
+    PX_CHECK_OK(node.Prepare(exec_state.get()));
+    PX_CHECK_OK(node.Open(exec_state.get()));
+    // Send the batches round robin, like the PEMs stream their results.
+    for (int64_t batch = 0; batch < kBatchesPerParent; ++batch) {
+      for (int64_t parent = 0; parent < num_parents; ++parent) {
+        PX_CHECK_OK(node.ConsumeNext(exec_state.get(), parent_batches[parent][batch], parent));
+      }
+    }
+    PX_CHECK_OK(node.Close(exec_state.get()));
+  }
+  state.SetItemsProcessed(state.iterations() * num_parents * kBatchesPerParent * kRowsPerBatch);
+}
+
+BENCHMARK(BM_UnionNodeOrderedMerge)
+    ->Args({2, 0})
+    ->Args({2, 1})
+    ->Args({16, 0})
+    ->Args({16, 1})
+    ->Args({128, 0})
+    ->Args({128, 1})
+    ->Unit(benchmark::kMillisecond);
@@ -158,6 +158,47 @@ TEST_F(UnionNodeTest, ordered_disjoint) {
       .Close();
 }
 
+// Rows with equal times are merged in parent order, even across the runs copied at once.
+TEST_F(UnionNodeTest, ordered_equal_times) {
+  auto op_proto = planpb::testutils::CreateTestUnionOrderedPB();
+  plan_node_ = plan::UnionOperator::FromProto(op_proto, /*id*/ 1);
+
+  RowDescriptor input_rd_0({types::DataType::STRING, types::DataType::TIME64NS});
+  RowDescriptor input_rd_1({types::DataType::TIME64NS, types::DataType::STRING});
+
+  RowDescriptor output_rd({types::DataType::STRING, types::DataType::TIME64NS});
+
+  auto tester = exec::ExecNodeTester<UnionNode, plan::UnionOperator>(
+      *plan_node_, output_rd, {input_rd_0, input_rd_1}, exec_state_.get());
+  tester.node()->disable_data_flush_timeout();
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd_0, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::StringValue>({"A", "B", "C", "D"})
+                       .AddColumn<types::Time64NSValue>({1, 2, 2, 3})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd_1, 3, true, true)
+                       .AddColumn<types::Time64NSValue>({2, 2, 4})
+                       .AddColumn<types::StringValue>({"Z", "Y", "X"})
+                       .get(),
+                   1, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 5, false, false)
+                          .AddColumn<types::StringValue>({"A", "B", "C", "Z", "Y"})
+                          .AddColumn<types::Time64NSValue>({1, 2, 2, 2, 2})
+                          .get())
+      .ConsumeNext(RowBatchBuilder(input_rd_0, 1, true, true)
+                       .AddColumn<types::StringValue>({"E"})
+                       .AddColumn<types::Time64NSValue>({5})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, true, true)
+                          .AddColumn<types::StringValue>({"D", "X", "E"})
+                          .AddColumn<types::Time64NSValue>({3, 4, 5})
+                          .get())
+      .Close();
+}
+
 // Partially overlapping time ranges.
 TEST_F(UnionNodeTest, ordered_partial_overlap_string) {
   auto op_proto = planpb::testutils::CreateTestUnionOrderedPB();
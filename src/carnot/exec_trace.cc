@@ -0,0 +1,143 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec_trace.h"
+
+#include <absl/container/flat_hash_set.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "src/common/uuid/uuid_utils.h"
+
+DEFINE_string(carnot_exec_trace_dir, gflags::StringFromEnv("PL_CARNOT_EXEC_TRACE_DIR", ""),
+              "The directory the timeline of each query run with analyze and batch tracing is "
+              "written to. Empty disables writing the timelines.");
+
+namespace px {
+namespace carnot {
+
+namespace {
+
+using TraceWriter = rapidjson::Writer<rapidjson::StringBuffer>;
+
+void WriteMetadataEvent(TraceWriter* writer, std::string_view name, int64_t pid, int64_t tid,
+                        std::string_view value) {
+  writer->StartObject();
+  writer->Key("name");
+  writer->String(name.data(), name.size());
+  writer->Key("ph");
+  writer->String("M");
+  writer->Key("pid");
+  writer->Int64(pid);
+  writer->Key("tid");
+  writer->Int64(tid);
+  writer->Key("args");
+  writer->StartObject();
+  writer->Key("name");
+  writer->String(value.data(), value.size());
+  writer->EndObject();
+  writer->EndObject();
+}
+
+std::string OperatorName(const queryresultspb::OperatorExecutionStats& op_stats) {
+  auto it = op_stats.extra_info().find("Operator");
+  std::string_view type = it == op_stats.extra_info().end() ? "Operator" : it->second;
+  return absl::Substitute("$0 (id=$1)", type, op_stats.node_id());
+}
+
+}  // namespace
+
+std::string ExecutionTraceJSON(
+    const std::vector<queryresultspb::AgentExecutionStats>& agent_stats) {
+  int64_t trace_start_ns = std::numeric_limits<int64_t>::max();
+  for (const auto& agent : agent_stats) {
+    for (const auto& op_stats : agent.operator_execution_stats()) {
+      for (const auto& span : op_stats.batch_spans()) {
+        trace_start_ns = std::min(trace_start_ns, span.start_time_ns());
+      }
+    }
+  }
+
+  rapidjson::StringBuffer sb;
+  TraceWriter writer(sb);
+  writer.StartObject();
+  writer.Key("displayTimeUnit");
+  writer.String("ns");
+  writer.Key("traceEvents");
+  writer.StartArray();
+  for (const auto& [pid, agent] : Enumerate(agent_stats)) {
+    auto agent_id = ParseUUID(agent.agent_id());
+    WriteMetadataEvent(&writer, "process_name", pid, 0,
+                       absl::StrCat("agent ", agent_id.ok() ? agent_id.ValueOrDie().str() : "?"));
+
+    absl::flat_hash_set<int64_t> fragments;
+    for (const auto& op_stats : agent.operator_execution_stats()) {
+      int64_t tid = op_stats.plan_fragment_id();
+      if (fragments.insert(tid).second) {
+        WriteMetadataEvent(&writer, "thread_name", pid, tid, absl::StrCat("fragment ", tid));
+      }
+      std::string name = OperatorName(op_stats);
+      for (const auto& span : op_stats.batch_spans()) {
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(name.data(), name.size());
+        writer.Key("cat");
+        writer.String("operator");
+        writer.Key("ph");
+        writer.String("X");
+        writer.Key("pid");
+        writer.Int64(pid);
+        writer.Key("tid");
+        writer.Int64(tid);
+        // Trace event timestamps are in microseconds.
+        writer.Key("ts");
+        writer.Double((span.start_time_ns() - trace_start_ns) / 1E3);
+        writer.Key("dur");
+        writer.Double(span.duration_ns() / 1E3);
+        writer.Key("args");
+        writer.StartObject();
+        writer.Key("node_id");
+        writer.Int64(op_stats.node_id());
+        writer.Key("records");
+        writer.Int64(span.records());
+        writer.Key("bytes");
+        writer.Int64(span.bytes());
+        writer.EndObject();
+        writer.EndObject();
+      }
+    }
+  }
+  writer.EndArray();
+  writer.EndObject();
+  return sb.GetString();
+}
+
+Status WriteExecutionTrace(const std::string& dir, const sole::uuid& query_id,
+                           const std::vector<queryresultspb::AgentExecutionStats>& agent_stats) {
+  std::string path = absl::Substitute("$0/$1.trace.json", dir, query_id.str());
+  PX_RETURN_IF_ERROR(WriteFileFromString(path, ExecutionTraceJSON(agent_stats)));
+  LOG(INFO) << absl::Substitute("Wrote the execution trace of query $0 to $1", query_id.str(),
+                                path);
+  return Status::OK();
+}
+
+}  // namespace carnot
+}  // namespace px
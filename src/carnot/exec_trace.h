@@ -0,0 +1,51 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "src/carnot/queryresultspb/query_results.pb.h"
+#include "src/common/base/base.h"
+#include "src/common/uuid/uuid.h"
+
+DECLARE_string(carnot_exec_trace_dir);
+
+namespace px {
+namespace carnot {
+
+/**
+ * Converts the batch spans in the execution stats of the agents of a query into the JSON of the
+ * Chrome Trace Event Format, which can be loaded in Perfetto or chrome://tracing.
+ *
+ * Each agent is shown as a process and each of its plan fragments as a thread, with a slice for
+ * every call into an operator. Calls into downstream operators nest within the call that
+ * produced their input, so the slices of a fragment form its call stack over time. Timestamps
+ * are relative to the earliest span, and agents whose clocks are skewed are shown skewed.
+ */
+std::string ExecutionTraceJSON(const std::vector<queryresultspb::AgentExecutionStats>& agent_stats);
+
+/**
+ * Writes the trace of the query to <dir>/<query_id>.trace.json.
+ */
+Status WriteExecutionTrace(const std::string& dir, const sole::uuid& query_id,
+                           const std::vector<queryresultspb::AgentExecutionStats>& agent_stats);
+
+}  // namespace carnot
+}  // namespace px
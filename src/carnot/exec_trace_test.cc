@@ -0,0 +1,92 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec_trace.h"
+
+#include <rapidjson/document.h>
+
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/common/uuid/uuid_utils.h"
+
+namespace px {
+namespace carnot {
+
+using queryresultspb::AgentExecutionStats;
+
+constexpr char kAgentStats[] = R"proto(
+operator_execution_stats {
+  plan_fragment_id: 1
+  node_id: 2
+  extra_info { key: "Operator" value: "MEMORY_SOURCE_OPERATOR" }
+  batch_spans { start_time_ns: 1000000 duration_ns: 5000 records: 10 bytes: 80 }
+  batch_spans { start_time_ns: 1010000 duration_ns: 3000 records: 4 bytes: 32 }
+}
+operator_execution_stats {
+  plan_fragment_id: 1
+  node_id: 3
+  extra_info { key: "Operator" value: "MAP_OPERATOR" }
+  batch_spans { start_time_ns: 1001000 duration_ns: 2000 records: 10 bytes: 80 }
+}
+)proto";
+
+TEST(ExecutionTraceJSON, spans_of_agents) {
+  AgentExecutionStats agent;
+  ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(kAgentStats, &agent));
+  ToProto(sole::rebuild("11285cdd-1de9-4ab1-ae6a-0ba08c8c676c"), agent.mutable_agent_id());
+  std::vector<AgentExecutionStats> agent_stats{agent, AgentExecutionStats()};
+
+  rapidjson::Document doc;
+  doc.Parse(ExecutionTraceJSON(agent_stats).c_str());
+  ASSERT_TRUE(doc.IsObject());
+  ASSERT_TRUE(doc.HasMember("traceEvents"));
+  const auto& events = doc["traceEvents"].GetArray();
+  // The process of each agent, the thread of the fragment and a slice for each span.
+  ASSERT_EQ(6, events.Size());
+
+  EXPECT_EQ(std::string("process_name"), events[0]["name"].GetString());
+  EXPECT_EQ(std::string("agent 11285cdd-1de9-4ab1-ae6a-0ba08c8c676c"),
+            events[0]["args"]["name"].GetString());
+  EXPECT_EQ(std::string("thread_name"), events[1]["name"].GetString());
+  EXPECT_EQ(std::string("fragment 1"), events[1]["args"]["name"].GetString());
+  EXPECT_EQ(1, events[1]["tid"].GetInt64());
+
+  const auto& second_source_span = events[3];
+  EXPECT_EQ(std::string("MEMORY_SOURCE_OPERATOR (id=2)"), second_source_span["name"].GetString());
+  EXPECT_EQ(std::string("X"), second_source_span["ph"].GetString());
+  EXPECT_EQ(0, second_source_span["pid"].GetInt64());
+  EXPECT_EQ(1, second_source_span["tid"].GetInt64());
+  // Timestamps are in microseconds since the first span.
+  EXPECT_DOUBLE_EQ(10.0, second_source_span["ts"].GetDouble());
+  EXPECT_DOUBLE_EQ(3.0, second_source_span["dur"].GetDouble());
+  EXPECT_EQ(4, second_source_span["args"]["records"].GetInt64());
+  EXPECT_EQ(32, second_source_span["args"]["bytes"].GetInt64());
+
+  const auto& map_span = events[4];
+  EXPECT_EQ(std::string("MAP_OPERATOR (id=3)"), map_span["name"].GetString());
+  EXPECT_DOUBLE_EQ(1.0, map_span["ts"].GetDouble());
+  EXPECT_EQ(3, map_span["args"]["node_id"].GetInt64());
+
+  EXPECT_EQ(std::string("process_name"), events[5]["name"].GetString());
+  EXPECT_EQ(1, events[5]["pid"].GetInt64());
+}
+
+}  // namespace carnot
+}  // namespace px
@@ -43,6 +43,14 @@ class SelectUDF : public udf::ScalarUDF {
     return v2;
   }
 
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<BoolValue>& s,
+                   const udf::ColumnView<TArg>& v1, const udf::ColumnView<TArg>& v2,
+                   udf::OutputColumn<TArg>* out) {
+    return udf::ExecBatchElementwise(
+        out, [](const BoolValue& sel, const TArg& l, const TArg& r) { return sel.val ? l : r; },
+        s, v1, v2);
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     // Match the 1st and 2nd arg.
     return {udf::InheritTypeFromArgs<SelectUDF>::CreateGeneric({1, 2})};
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/funcs/builtins/grpc_ops.h"
+
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/empty.pb.h>
+#include <google/protobuf/text_format.h>
+#include <google/protobuf/util/json_util.h>
+
+#include <absl/strings/escaping.h>
+#include <absl/strings/strip.h>
+
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/common/grpcutils/utils.h"
+#include "src/common/zlib/zlib_wrapper.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+using ::google::protobuf::Empty;
+using ::google::protobuf::FileDescriptorSet;
+using ::google::protobuf::Message;
+using ::google::protobuf::TextFormat;
+
+namespace {
+
+// 1 byte compression flag, and 4 bytes length field.
+constexpr size_t kGRPCMessageHeaderSizeBytes = 1 + sizeof(uint32_t);
+
+std::string MessageToString(std::string_view data, Message* message) {
+  std::string out;
+  if (message == nullptr) {
+    // Text format is used without a schema, as JSON can't represent the unknown fields.
+    Empty empty_pb;
+    // Print even if parsing failed, which produces the partial message of a truncated body.
+    empty_pb.ParsePartialFromArray(data.data(), data.size());
+    TextFormat::Printer printer;
+    printer.SetSingleLineMode(true);
+    printer.PrintToString(empty_pb, &out);
+    absl::StripTrailingAsciiWhitespace(&out);
+    return out;
+  }
+  message->Clear();
+  message->ParsePartialFromArray(data.data(), data.size());
+  if (!google::protobuf::util::MessageToJsonString(*message, &out).ok()) {
+    return "<Failed to convert protobuf to JSON>";
+  }
+  return out;
+}
+
+}  // namespace
+
+std::string DecodeGRPCBody(std::string_view body, Message* message) {
+  std::string wire;
+  if (!absl::Base64Unescape(body, &wire) || wire.size() < kGRPCMessageHeaderSizeBytes) {
+    return std::string(body);
+  }
+
+  std::vector<std::string> messages;
+  std::string_view buf = wire;
+  while (buf.size() >= kGRPCMessageHeaderSizeBytes) {
+    const bool is_compressed = buf[0] == 1;
+    const uint32_t len = static_cast<uint8_t>(buf[1]) << 24 | static_cast<uint8_t>(buf[2]) << 16 |
+                         static_cast<uint8_t>(buf[3]) << 8 | static_cast<uint8_t>(buf[4]);
+    buf.remove_prefix(kGRPCMessageHeaderSizeBytes);
+    // The body may have been truncated by the socket tracer, so the last message may be partial.
+    std::string_view data = buf.substr(0, len);
+    buf.remove_prefix(data.size());
+
+    if (!is_compressed) {
+      messages.push_back(MessageToString(data, message));
+      continue;
+    }
+    // gRPC compresses with the algorithm in the grpc-encoding header, which is gzip in practice.
+    StatusOr<std::string> inflated = px::zlib::Inflate(data);
+    if (!inflated.ok()) {
+      messages.push_back("<Failed to gunzip data>");
+      continue;
+    }
+    messages.push_back(MessageToString(inflated.ValueOrDie(), message));
+  }
+  return absl::StrJoin(messages, "\n");
+}
+
+Status GRPCBodyToJSONUDF::Init(FunctionContext*, StringValue descriptor_set) {
+  std::string serialized;
+  FileDescriptorSet fdset;
+  if (!absl::Base64Unescape(descriptor_set, &serialized) || !fdset.ParseFromString(serialized)) {
+    return error::InvalidArgument("The descriptor set is not a base64-encoded FileDescriptorSet");
+  }
+  desc_db_ = std::make_unique<px::grpc::ServiceDescriptorDatabase>(std::move(fdset));
+  return Status::OK();
+}
+
+StringValue GRPCBodyToJSONUDF::Exec(FunctionContext*, StringValue req_path, StringValue body,
+                                    BoolValue is_request) {
+  if (req_path.empty()) {
+    return DecodeGRPCBody(body, nullptr);
+  }
+  px::grpc::MethodInputOutput method =
+      desc_db_->GetMethodInputOutput(px::grpc::MethodPath(req_path));
+  return DecodeGRPCBody(body, is_request.val ? method.input.get() : method.output.get());
+}
+
+void RegisterGRPCOpsOrDie(udf::Registry* registry) {
+  CHECK(registry != nullptr);
+  registry->RegisterOrDie<GRPCBodyToTextUDF>("grpc_body_to_text");
+  registry->RegisterOrDie<GRPCBodyToJSONUDF>("grpc_body_to_json");
+}
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
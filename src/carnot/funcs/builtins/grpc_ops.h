@@ -0,0 +1,93 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "src/carnot/udf/registry.h"
+#include "src/common/grpcutils/service_descriptor_database.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+/**
+ * Decodes the base64-encoded gRPC body of an http_events row, which the socket tracer records
+ * instead of decoding the messages itself when --socket_tracer_grpc_raw_bodies is set. Each of
+ * the length-prefixed messages of the body is decoded into a line of output. Bodies that are not
+ * base64, like those already decoded by the socket tracer, are returned as is.
+ *
+ * @param message An empty message of the type of the body, to decode the body into JSON. If null,
+ *        the body is decoded without a schema, into text format protobuf with field numbers for
+ *        names.
+ */
+std::string DecodeGRPCBody(std::string_view body, google::protobuf::Message* message);
+
+class GRPCBodyToTextUDF : public udf::ScalarUDF {
+ public:
+  StringValue Exec(FunctionContext*, StringValue body) { return DecodeGRPCBody(body, nullptr); }
+
+  static udf::ScalarUDFDocBuilder Doc() {
+    return udf::ScalarUDFDocBuilder("Decodes a gRPC body recorded in wire format.")
+        .Details(
+            "Decodes the protobuf messages of a gRPC request or response body into text format, "
+            "using field numbers instead of names. The body must have been recorded in wire "
+            "format, which the PEMs do when run with --socket_tracer_grpc_raw_bodies; other "
+            "bodies are returned unchanged.")
+        .Example("df.req_body = px.grpc_body_to_text(df.req_body)")
+        .Arg("body", "The req_body or resp_body of an HTTP2 event.")
+        .Returns("The messages of the body in text format, one per line.");
+  }
+};
+
+class GRPCBodyToJSONUDF : public udf::ScalarUDF {
+ public:
+  Status Init(FunctionContext*, StringValue descriptor_set);
+  StringValue Exec(FunctionContext*, StringValue req_path, StringValue body, BoolValue is_request);
+
+  static udf::ScalarUDFDocBuilder Doc() {
+    return udf::ScalarUDFDocBuilder("Decodes a gRPC body recorded in wire format, into JSON.")
+        .Details(
+            "Decodes the protobuf messages of a gRPC request or response body into JSON, using "
+            "the input or output type of the method in the request path. The types are looked up "
+            "in the descriptor set (first arg), which is a base64-encoded, serialized "
+            "google.protobuf.FileDescriptorSet, as produced by "
+            "`protoc --include_imports --descriptor_set_out`. Bodies of methods that are not "
+            "in the descriptor set are decoded like px.grpc_body_to_text().")
+        .Example(
+            "df.req_body = px.grpc_body_to_json(descriptor_set, df.req_path, df.req_body, True)")
+        .Arg("descriptor_set", "The base64-encoded FileDescriptorSet of the services.")
+        .Arg("req_path", "The request path of the HTTP2 event, e.g. /pkg.Service/Method.")
+        .Arg("body", "The req_body or resp_body of the HTTP2 event.")
+        .Arg("is_request", "Whether the body is the request (true) or the response (false).")
+        .Returns("The messages of the body in JSON, one per line.");
+  }
+
+ private:
+  std::unique_ptr<px::grpc::ServiceDescriptorDatabase> desc_db_;
+};
+
+void RegisterGRPCOpsOrDie(udf::Registry* registry);
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/text_format.h>
+
+#include <absl/strings/escaping.h>
+
+#include <string>
+#include <vector>
+
+#include "src/carnot/funcs/builtins/grpc_ops.h"
+#include "src/carnot/udf/test_utils.h"
+#include "src/common/base/base.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+using ::google::protobuf::FileDescriptorSet;
+using ::google::protobuf::TextFormat;
+
+constexpr char kDescriptorSet[] = R"proto(
+file {
+  name: "greet.proto"
+  package: "px.test"
+  message_type {
+    name: "HelloRequest"
+    field { name: "name" number: 1 label: LABEL_OPTIONAL type: TYPE_STRING json_name: "name" }
+  }
+  message_type {
+    name: "HelloReply"
+    field { name: "count" number: 2 label: LABEL_OPTIONAL type: TYPE_INT32 json_name: "count" }
+  }
+  service {
+    name: "Greeter"
+    method {
+      name: "SayHello"
+      input_type: ".px.test.HelloRequest"
+      output_type: ".px.test.HelloReply"
+    }
+  }
+  syntax: "proto3"
+}
+)proto";
+
+// Returns the base64-encoded gRPC body of the serialized messages.
+std::string GRPCBody(const std::vector<std::string>& messages) {
+  std::string body;
+  for (const auto& msg : messages) {
+    body.push_back('\0');
+    const uint32_t len = msg.size();
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      body.push_back(static_cast<char>(len >> shift));
+    }
+    body.append(msg);
+  }
+  return absl::Base64Escape(body);
+}
+
+TEST(GRPCOps, BodyToText) {
+  auto udf_tester = udf::UDFTester<GRPCBodyToTextUDF>();
+  // Field 1 "pixie" followed by field 2 varint 3.
+  const std::string msg = std::string("\x0a\x05pixie\x10\x03", 9);
+  udf_tester.ForInput(GRPCBody({msg, msg})).Expect("1: \"pixie\" 2: 3\n1: \"pixie\" 2: 3");
+  // Bodies that were decoded by the socket tracer are kept as is.
+  udf_tester.ForInput("1: \"pixie\"").Expect("1: \"pixie\"");
+}
+
+TEST(GRPCOps, BodyToJSON) {
+  FileDescriptorSet fdset;
+  ASSERT_TRUE(TextFormat::ParseFromString(kDescriptorSet, &fdset));
+  const std::string descriptor_set = absl::Base64Escape(fdset.SerializeAsString());
+
+  auto udf_tester = udf::UDFTester<GRPCBodyToJSONUDF>();
+  udf_tester.Init(descriptor_set)
+      .ForInput("/px.test.Greeter/SayHello", GRPCBody({std::string("\x0a\x05pixie", 7)}), true)
+      .Expect(R"({"name":"pixie"})");
+  udf_tester.Init(descriptor_set)
+      .ForInput("/px.test.Greeter/SayHello", GRPCBody({std::string("\x10\x03", 2)}), false)
+      .Expect(R"({"count":3})");
+  // Unknown methods are decoded without a schema.
+  udf_tester.Init(descriptor_set)
+      .ForInput("/px.test.Greeter/Unknown", GRPCBody({std::string("\x10\x03", 2)}), false)
+      .Expect("2: 3");
+}
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -18,6 +18,8 @@
 
 #include "src/carnot/funcs/builtins/json_ops.h"
 
+#include <limits>
+
 #include "src/carnot/udf/registry.h"
 
 namespace px {
@@ -26,6 +28,191 @@ namespace builtins {
 
 using types::StringValue;
 
+JSONPlucker::ValueType JSONPlucker::PluckKey(const std::string& json, std::string_view key) {
+  key_ = key;
+  by_index_ = false;
+  return Pluck(json);
+}
+
+JSONPlucker::ValueType JSONPlucker::PluckIndex(const std::string& json, int64_t index) {
+  index_ = index;
+  by_index_ = true;
+  return Pluck(json);
+}
+
+JSONPlucker::ValueType JSONPlucker::Pluck(const std::string& json) {
+  depth_ = 0;
+  root_is_array_ = false;
+  key_matched_ = false;
+  array_idx_ = 0;
+  in_nested_ = false;
+  done_ = false;
+  type_ = ValueType::kNotFound;
+  buffer_.Clear();
+  writer_.Reset(buffer_);
+
+  rapidjson::StringStream stream(json.c_str());
+  reader_.Parse<rapidjson::kParseDefaultFlags>(stream, *this);
+  // The parse fails when the handler stops it, so whether the value was read is tracked by done_
+  // instead. Documents that are invalid before the value is read are treated as not having it.
+  if (!done_) {
+    type_ = ValueType::kNotFound;
+  }
+  return type_;
+}
+
+std::string_view JSONPlucker::str() const {
+  if (type_ == ValueType::kString) {
+    return string_;
+  }
+  return std::string_view(buffer_.GetString(), buffer_.GetSize());
+}
+
+bool JSONPlucker::IsTarget() {
+  if (depth_ != 1) {
+    return false;
+  }
+  if (by_index_) {
+    return root_is_array_ && array_idx_++ == index_;
+  }
+  return std::exchange(key_matched_, false);
+}
+
+bool JSONPlucker::Found(ValueType type) {
+  type_ = type;
+  if (type == ValueType::kNested) {
+    in_nested_ = true;
+    return true;
+  }
+  done_ = true;
+  return false;
+}
+
+bool JSONPlucker::Null() {
+  if (in_nested_) {
+    return writer_.Null();
+  }
+  return !IsTarget() || Found(ValueType::kNull);
+}
+
+bool JSONPlucker::Bool(bool b) {
+  if (in_nested_) {
+    return writer_.Bool(b);
+  }
+  if (!IsTarget()) {
+    return true;
+  }
+  writer_.Bool(b);
+  return Found(ValueType::kBool);
+}
+
+bool JSONPlucker::Int(int i) { return Int64(i); }
+
+bool JSONPlucker::Uint(unsigned u) { return Int64(u); }
+
+bool JSONPlucker::Int64(int64_t i) {
+  if (in_nested_) {
+    return writer_.Int64(i);
+  }
+  if (!IsTarget()) {
+    return true;
+  }
+  int64_ = i;
+  writer_.Int64(i);
+  return Found(ValueType::kInt64);
+}
+
+bool JSONPlucker::Uint64(uint64_t u) {
+  if (u <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+    return Int64(static_cast<int64_t>(u));
+  }
+  if (in_nested_) {
+    return writer_.Uint64(u);
+  }
+  if (!IsTarget()) {
+    return true;
+  }
+  writer_.Uint64(u);
+  return Found(ValueType::kUint64);
+}
+
+bool JSONPlucker::Double(double d) {
+  if (in_nested_) {
+    return writer_.Double(d);
+  }
+  if (!IsTarget()) {
+    return true;
+  }
+  float64_ = d;
+  writer_.Double(d);
+  return Found(ValueType::kDouble);
+}
+
+bool JSONPlucker::RawNumber(const char* str, rapidjson::SizeType len, bool copy) {
+  // Only called with kParseNumbersAsStringsFlag, which isn't used.
+  return writer_.RawNumber(str, len, copy);
+}
+
+bool JSONPlucker::String(const char* str, rapidjson::SizeType len, bool copy) {
+  if (in_nested_) {
+    return writer_.String(str, len, copy);
+  }
+  if (!IsTarget()) {
+    return true;
+  }
+  string_.assign(str, len);
+  return Found(ValueType::kString);
+}
+
+bool JSONPlucker::StartObject() {
+  if (!in_nested_ && IsTarget()) {
+    Found(ValueType::kNested);
+  }
+  ++depth_;
+  return !in_nested_ || writer_.StartObject();
+}
+
+bool JSONPlucker::Key(const char* str, rapidjson::SizeType len, bool copy) {
+  if (in_nested_) {
+    return writer_.Key(str, len, copy);
+  }
+  if (depth_ == 1 && !by_index_) {
+    key_matched_ = key_ == std::string_view(str, len);
+  }
+  return true;
+}
+
+bool JSONPlucker::EndObject(rapidjson::SizeType member_count) {
+  --depth_;
+  if (!in_nested_) {
+    return true;
+  }
+  writer_.EndObject(member_count);
+  // Stop once the plucked value is closed.
+  done_ = depth_ == 1;
+  return !done_;
+}
+
+bool JSONPlucker::StartArray() {
+  if (depth_ == 0) {
+    root_is_array_ = true;
+  } else if (!in_nested_ && IsTarget()) {
+    Found(ValueType::kNested);
+  }
+  ++depth_;
+  return !in_nested_ || writer_.StartArray();
+}
+
+bool JSONPlucker::EndArray(rapidjson::SizeType element_count) {
+  --depth_;
+  if (!in_nested_) {
+    return true;
+  }
+  writer_.EndArray(element_count);
+  done_ = depth_ == 1;
+  return !done_;
+}
+
 void RegisterJSONOpsOrDie(udf::Registry* registry) {
   registry->RegisterOrDie<PluckUDF>("pluck");
   registry->RegisterOrDie<PluckAsInt64UDF>("pluck_int64");
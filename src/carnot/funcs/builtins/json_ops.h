@@ -19,10 +19,12 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include <rapidjson/document.h>
+#include <rapidjson/reader.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
@@ -33,36 +35,94 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
+/**
+ * JSONPlucker finds a single value in a serialized JSON document. Instead of parsing the whole
+ * document into a DOM, it streams it through the RapidJSON SAX reader and stops as soon as the
+ * value has been read, so plucking a key near the start of a large body is cheap. This also means
+ * that a document that is only invalid (e.g. truncated) after the value still returns it.
+ *
+ * A JSONPlucker reuses its buffers across calls, so UDFs keep one per instance.
+ */
+class JSONPlucker {
+ public:
+  enum class ValueType { kNotFound, kNull, kBool, kInt64, kUint64, kDouble, kString, kNested };
+
+  JSONPlucker() : writer_(buffer_) {}
+
+  /**
+   * Finds the value of the key in the top level object of the document.
+   */
+  ValueType PluckKey(const std::string& json, std::string_view key);
+
+  /**
+   * Finds the value at the index in the top level array of the document.
+   */
+  ValueType PluckIndex(const std::string& json, int64_t index);
+
+  /**
+   * The value of a kString, or the serialized JSON of any other found value.
+   */
+  std::string_view str() const;
+  int64_t int64() const { return int64_; }
+  double float64() const { return float64_; }
+
+  // The RapidJSON SAX handler interface. Returning false stops the parse.
+  bool Null();
+  bool Bool(bool b);
+  bool Int(int i);
+  bool Uint(unsigned u);
+  bool Int64(int64_t i);
+  bool Uint64(uint64_t u);
+  bool Double(double d);
+  bool RawNumber(const char* str, rapidjson::SizeType len, bool copy);
+  bool String(const char* str, rapidjson::SizeType len, bool copy);
+  bool StartObject();
+  bool Key(const char* str, rapidjson::SizeType len, bool copy);
+  bool EndObject(rapidjson::SizeType member_count);
+  bool StartArray();
+  bool EndArray(rapidjson::SizeType element_count);
+
+ private:
+  ValueType Pluck(const std::string& json);
+  // Returns whether the value that is starting is the one being plucked.
+  bool IsTarget();
+  // Records a found value, and returns false to stop the parse unless it's a nested value.
+  bool Found(ValueType type);
+
+  std::string_view key_;
+  int64_t index_ = -1;
+  bool by_index_ = false;
+
+  int depth_ = 0;
+  bool root_is_array_ = false;
+  bool key_matched_ = false;
+  int64_t array_idx_ = 0;
+  // Whether the nested value being plucked is being read.
+  bool in_nested_ = false;
+  bool done_ = false;
+
+  ValueType type_ = ValueType::kNotFound;
+  std::string string_;
+  int64_t int64_ = 0;
+  double float64_ = 0.0;
+
+  rapidjson::Reader reader_;
+  rapidjson::StringBuffer buffer_;
+  rapidjson::Writer<rapidjson::StringBuffer> writer_;
+};
+
 // TODO(zasgar): PL-419 To have proper support for JSON we need structs and nullable types.
 // Revisit when we have them.
 class PluckUDF : public udf::ScalarUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
+    auto type = plucker_.PluckKey(in, key);
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
-      return "";
-    }
-    if (!d.IsObject()) {
-      return "";
-    }
-    if (!d.HasMember(key.data())) {
-      return "";
-    }
-    const auto& plucked_value = d[key.data()];
-    if (plucked_value.IsNull()) {
+    if (type == JSONPlucker::ValueType::kNotFound || type == JSONPlucker::ValueType::kNull) {
       return "";
     }
-    if (plucked_value.IsString()) {
-      return plucked_value.GetString();
-    }
-
-    // This is robust to nested JSON.
-    rapidjson::StringBuffer sb;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-    plucked_value.Accept(writer);
-    return sb.GetString();
+    // Nested JSON is serialized back to a string.
+    return std::string(plucker_.str());
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -82,31 +142,19 @@ class PluckUDF : public udf::ScalarUDF {
         .Arg("key", "The key to get the value for.")
         .Returns("The value for the key as a string.");
   }
+
+ private:
+  JSONPlucker plucker_;
 };
 
 class PluckAsInt64UDF : public udf::ScalarUDF {
  public:
   Int64Value Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
-      return 0;
-    }
-    if (!d.IsObject()) {
-      return 0;
-    }
-    if (!d.HasMember(key.data())) {
-      return 0;
-    }
-    const auto& plucked_value = d[key.data()];
-    if (plucked_value.IsNull()) {
+    if (plucker_.PluckKey(in, key) != JSONPlucker::ValueType::kInt64) {
       return 0;
     }
-    if (plucked_value.IsInt64()) {
-      return plucked_value.GetInt64();
-    }
-    return 0;
+    return plucker_.int64();
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -126,31 +174,19 @@ class PluckAsInt64UDF : public udf::ScalarUDF {
         .Arg("key", "The key to get the value for.")
         .Returns("The value for the key as an int.");
   }
+
+ private:
+  JSONPlucker plucker_;
 };
 
 class PluckAsFloat64UDF : public udf::ScalarUDF {
  public:
   Float64Value Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
+    if (plucker_.PluckKey(in, key) != JSONPlucker::ValueType::kDouble) {
       return 0.0;
     }
-    if (!d.IsObject()) {
-      return 0.0;
-    }
-    if (!d.HasMember(key.data())) {
-      return 0.0;
-    }
-    const auto& plucked_value = d[key.data()];
-    if (plucked_value.IsNull()) {
-      return 0.0;
-    }
-    if (plucked_value.IsDouble()) {
-      return plucked_value.GetDouble();
-    }
-    return 0.0;
+    return plucker_.float64();
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -173,38 +209,21 @@ class PluckAsFloat64UDF : public udf::ScalarUDF {
         .Arg("key", "The key to get the value for.")
         .Returns("The value for the key as a float");
   }
+
+ private:
+  JSONPlucker plucker_;
 };
 
 class PluckArrayUDF : public udf::ScalarUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue in, Int64Value index) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
+    auto type = plucker_.PluckIndex(in, index.val);
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
-      return "";
-    }
-    if (!d.IsArray()) {
-      return "";
-    }
-    const auto& plucked_array = d.GetArray();
-    if (index < 0 || index >= plucked_array.Size()) {
-      return "";
-    }
-
-    const auto& plucked_value = plucked_array[index.val];
-    if (plucked_value.IsNull()) {
+    if (type == JSONPlucker::ValueType::kNotFound || type == JSONPlucker::ValueType::kNull) {
       return "";
     }
-    if (plucked_value.IsString()) {
-      return plucked_value.GetString();
-    }
-
-    // This is robust to nested JSON.
-    rapidjson::StringBuffer sb;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-    plucked_value.Accept(writer);
-    return sb.GetString();
+    // Nested JSON is serialized back to a string.
+    return std::string(plucker_.str());
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -226,6 +245,9 @@ class PluckArrayUDF : public udf::ScalarUDF {
         .Arg("index", "The index of the value in the array.")
         .Returns("The value at the ith position in the array as a string.");
   }
+
+ private:
+  JSONPlucker plucker_;
 };
 
 /**
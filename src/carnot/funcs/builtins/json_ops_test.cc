@@ -60,6 +60,28 @@ TEST(JSONOps, PluckUDF_non_object_input_return_empty) {
   udf_tester.ForInput("[\"asdad\"]", "str_key").Expect("");
 }
 
+TEST(JSONOps, PluckUDF_only_top_level_keys) {
+  auto udf_tester = udf::UDFTester<PluckUDF>();
+  udf_tester.ForInput(kTestJSONStr, "abc").Expect("");
+  udf_tester.ForInput(R"({"a": [{"b": 1}], "b": [1, "x\"y", null, true]})", "b")
+      .Expect(R"([1,"x\"y",null,true])");
+  udf_tester.ForInput(R"({"a": true, "b": null, "c": 18446744073709551615})", "a")
+      .Expect("true");
+  udf_tester.ForInput(R"({"a": true, "b": null, "c": 18446744073709551615})", "b").Expect("");
+  udf_tester.ForInput(R"({"a": true, "b": null, "c": 18446744073709551615})", "c")
+      .Expect("18446744073709551615");
+  // The first of duplicate keys wins.
+  udf_tester.ForInput(R"({"a": 1, "a": 2})", "a").Expect("1");
+}
+
+TEST(JSONOps, PluckUDF_stops_after_value) {
+  auto udf_tester = udf::UDFTester<PluckUDF>();
+  // Bodies are often truncated, the value can still be plucked if it's before the truncation.
+  udf_tester.ForInput(R"({"a": {"b": "c"}, "d": "trunc)", "a").Expect(R"({"b":"c"})");
+  udf_tester.ForInput(R"({"a": {"b": "c"}, "d": "trunc)", "d").Expect("");
+  udf_tester.ForInput(R"({"a": {"b": "c")", "a").Expect("");
+}
+
 TEST(JSONOps, PluckAsInt64UDF) {
   auto udf_tester = udf::UDFTester<PluckAsInt64UDF>();
   udf_tester.ForInput(kTestJSONStr, "str_key").Expect(0);
@@ -101,6 +123,15 @@ TEST(JSONOps, PluckArrayUDF) {
   udf_tester.ForInput(kTestJSONArray, 2).Expect(R"({"pixie":"labs"})");
 }
 
+TEST(JSONOps, PluckArrayUDF_nested_arrays) {
+  auto udf_tester = udf::UDFTester<PluckArrayUDF>();
+  udf_tester.ForInput(R"([[0, 1], {"a": [2]}, "c", 3.5])", 0).Expect("[0,1]");
+  udf_tester.ForInput(R"([[0, 1], {"a": [2]}, "c", 3.5])", 1).Expect(R"({"a":[2]})");
+  udf_tester.ForInput(R"([[0, 1], {"a": [2]}, "c", 3.5])", 2).Expect("c");
+  udf_tester.ForInput(R"([[0, 1], {"a": [2]}, "c", 3.5])", 3).Expect("3.5");
+  udf_tester.ForInput(R"([[0, 1], {"a": [2]}, "c", 3.5])", -1).Expect("");
+}
+
 TEST(JSONOps, PluckArrayUDF_input_is_not_array) {
   auto udf_tester = udf::UDFTester<PluckArrayUDF>();
   udf_tester.ForInput(kTestJSONStr, 0).Expect("");
@@ -35,6 +35,11 @@ template <typename TReturn, typename TArg1 = TReturn, typename TArg2 = TReturn>
 class AddUDF : public udf::ScalarUDF {
  public:
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val + b2.val; }
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<TArg1>& b1,
+                   const udf::ColumnView<TArg2>& b2, udf::OutputColumn<TReturn>* out) {
+    return udf::ExecBatchElementwise(
+        out, [](const TArg1& v1, const TArg2& v2) -> TReturn { return v1.val + v2.val; }, b1, b2);
+  }
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
         udf::InheritTypeFromArgs<AddUDF>::Create({types::ST_BYTES, types::ST_THROUGHPUT_PER_NS,
@@ -60,6 +65,11 @@ template <typename TReturn, typename TArg1 = TReturn, typename TArg2 = TReturn>
 class SubtractUDF : public udf::ScalarUDF {
  public:
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val - b2.val; }
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<TArg1>& b1,
+                   const udf::ColumnView<TArg2>& b2, udf::OutputColumn<TReturn>* out) {
+    return udf::ExecBatchElementwise(
+        out, [](const TArg1& v1, const TArg2& v2) -> TReturn { return v1.val - v2.val; }, b1, b2);
+  }
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
         udf::InheritTypeFromArgs<SubtractUDF>::Create({types::ST_BYTES, types::ST_THROUGHPUT_PER_NS,
@@ -89,6 +99,16 @@ class DivideUDF : public udf::ScalarUDF {
     return static_cast<double>(b1.val) / static_cast<double>(b2.val);
   }
 
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<TArg1>& b1,
+                   const udf::ColumnView<TArg2>& b2, udf::OutputColumn<types::Float64Value>* out) {
+    return udf::ExecBatchElementwise(
+        out,
+        [](const TArg1& v1, const TArg2& v2) -> types::Float64Value {
+          return static_cast<double>(v1.val) / static_cast<double>(v2.val);
+        },
+        b1, b2);
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<DivideUDF>(types::ST_THROUGHPUT_PER_NS,
                                                  {types::ST_NONE, types::ST_DURATION_NS}),
@@ -113,6 +133,11 @@ template <typename TReturn, typename TArg1 = TReturn, typename TArg2 = TReturn>
 class MultiplyUDF : public udf::ScalarUDF {
  public:
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val * b2.val; }
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<TArg1>& b1,
+                   const udf::ColumnView<TArg2>& b2, udf::OutputColumn<TReturn>* out) {
+    return udf::ExecBatchElementwise(
+        out, [](const TArg1& v1, const TArg2& v2) -> TReturn { return v1.val * v2.val; }, b1, b2);
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Multiplies the arguments.")
         .Details("Multiplies the two values together. Accessible using the `*` operator syntax.")
@@ -245,6 +270,11 @@ template <typename TReturn, typename TArg1, typename TArg2>
 class ModuloUDF : public udf::ScalarUDF {
  public:
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val % b2.val; }
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<TArg1>& b1,
+                   const udf::ColumnView<TArg2>& b2, udf::OutputColumn<TReturn>* out) {
+    return udf::ExecBatchElementwise(
+        out, [](const TArg1& v1, const TArg2& v2) -> TReturn { return v1.val % v2.val; }, b1, b2);
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Calculates the remainder of the division of the two numbers")
         .Details(
@@ -266,6 +296,12 @@ template <typename TArg1, typename TArg2 = TArg1>
 class LogicalOrUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val || b2.val; }
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<TArg1>& b1,
+                   const udf::ColumnView<TArg2>& b2, udf::OutputColumn<BoolValue>* out) {
+    return udf::ExecBatchElementwise(
+        out, [](const TArg1& v1, const TArg2& v2) -> BoolValue { return v1.val || v2.val; },
+        b1, b2);
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Boolean ORs the passed in values.")
         .Example(R"doc(# Implicit call.
@@ -285,6 +321,12 @@ template <typename TArg1, typename TArg2 = TArg1>
 class LogicalAndUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val && b2.val; }
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<TArg1>& b1,
+                   const udf::ColumnView<TArg2>& b2, udf::OutputColumn<BoolValue>* out) {
+    return udf::ExecBatchElementwise(
+        out, [](const TArg1& v1, const TArg2& v2) -> BoolValue { return v1.val && v2.val; },
+        b1, b2);
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Boolean ANDs the passed in values.")
         .Example(R"doc(# Implicit call.
@@ -374,6 +416,11 @@ template <typename TArg1, typename TArg2 = TArg1>
 class EqualUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 == b2; }
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<TArg1>& b1,
+                   const udf::ColumnView<TArg2>& b2, udf::OutputColumn<BoolValue>* out) {
+    return udf::ExecBatchElementwise(
+        out, [](const TArg1& v1, const TArg2& v2) -> BoolValue { return v1 == v2; }, b1, b2);
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns whether the values are equal.")
         .Details(
@@ -394,6 +441,11 @@ template <typename TArg1, typename TArg2 = TArg1>
 class NotEqualUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 != b2; }
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<TArg1>& b1,
+                   const udf::ColumnView<TArg2>& b2, udf::OutputColumn<BoolValue>* out) {
+    return udf::ExecBatchElementwise(
+        out, [](const TArg1& v1, const TArg2& v2) -> BoolValue { return v1 != v2; }, b1, b2);
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns whether the values are not equal.")
         .Details(
@@ -439,6 +491,11 @@ template <typename TArg1, typename TArg2 = TArg1>
 class GreaterThanUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 > b2; }
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<TArg1>& b1,
+                   const udf::ColumnView<TArg2>& b2, udf::OutputColumn<BoolValue>* out) {
+    return udf::ExecBatchElementwise(
+        out, [](const TArg1& v1, const TArg2& v2) -> BoolValue { return v1 > v2; }, b1, b2);
+  }
 
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -458,6 +515,11 @@ template <typename TArg1, typename TArg2 = TArg1>
 class GreaterThanEqualUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 >= b2; }
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<TArg1>& b1,
+                   const udf::ColumnView<TArg2>& b2, udf::OutputColumn<BoolValue>* out) {
+    return udf::ExecBatchElementwise(
+        out, [](const TArg1& v1, const TArg2& v2) -> BoolValue { return v1 >= v2; }, b1, b2);
+  }
 
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -478,6 +540,11 @@ template <typename TArg1, typename TArg2 = TArg1>
 class LessThanUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 < b2; }
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<TArg1>& b1,
+                   const udf::ColumnView<TArg2>& b2, udf::OutputColumn<BoolValue>* out) {
+    return udf::ExecBatchElementwise(
+        out, [](const TArg1& v1, const TArg2& v2) -> BoolValue { return v1 < v2; }, b1, b2);
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns which value is less than the other.")
         .Example(R"doc(# Implict call.
@@ -494,6 +561,11 @@ template <typename TArg1, typename TArg2 = TArg1>
 class LessThanEqualUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 <= b2; }
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<TArg1>& b1,
+                   const udf::ColumnView<TArg2>& b2, udf::OutputColumn<BoolValue>* out) {
+    return udf::ExecBatchElementwise(
+        out, [](const TArg1& v1, const TArg2& v2) -> BoolValue { return v1 <= v2; }, b1, b2);
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns which value is less than or equal to the the other.")
         .Example(R"doc(
@@ -514,6 +586,12 @@ template <typename TReturn, typename TArg1 = TReturn, typename TArg2 = TReturn>
 class BinUDF : public udf::ScalarUDF {
  public:
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val - (b1.val % b2.val); }
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<TArg1>& b1,
+                   const udf::ColumnView<TArg2>& b2, udf::OutputColumn<TReturn>* out) {
+    return udf::ExecBatchElementwise(
+        out, [](const TArg1& v1, const TArg2& v2) -> TReturn { return v1.val - (v1.val % v2.val); },
+        b1, b2);
+  }
   static udf::ScalarUDFDocBuilder Doc() { return BinDoc(); }
 };
 
@@ -524,6 +602,15 @@ class BinUDF<TReturn, types::Float64Value, TArg2> : public udf::ScalarUDF {
   TReturn Exec(FunctionContext*, Float64Value b1, Int64Value b2) {
     return static_cast<int64_t>(b1.val) - (static_cast<int64_t>(b1.val) % b2.val);
   }
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<Float64Value>& b1,
+                   const udf::ColumnView<Int64Value>& b2, udf::OutputColumn<TReturn>* out) {
+    return udf::ExecBatchElementwise(
+        out,
+        [](const Float64Value& v1, const Int64Value& v2) -> TReturn {
+          return static_cast<int64_t>(v1.val) - (static_cast<int64_t>(v1.val) % v2.val);
+        },
+        b1, b2);
+  }
   static udf::ScalarUDFDocBuilder Doc() { return BinDoc(); }
 };
 
@@ -16,6 +16,9 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
+#include <cmath>
+#include <string>
 #include <vector>
 
 #include "src/carnot/funcs/builtins/math_sketches.h"
@@ -27,6 +30,10 @@ namespace builtins {
 void RegisterMathSketchesOrDie(udf::Registry* registry) {
   registry->RegisterOrDie<QuantilesUDA<types::Int64Value>>("quantiles");
   registry->RegisterOrDie<QuantilesUDA<types::Float64Value>>("quantiles");
+  registry->RegisterOrDie<ApproxCountDistinctUDA<types::Int64Value>>("approx_count_distinct");
+  registry->RegisterOrDie<ApproxCountDistinctUDA<types::Float64Value>>("approx_count_distinct");
+  registry->RegisterOrDie<ApproxCountDistinctUDA<types::StringValue>>("approx_count_distinct");
+  registry->RegisterOrDie<ApproxCountDistinctUDA<types::Time64NSValue>>("approx_count_distinct");
 }
 
 void WriteCentroidArray(rapidjson::Writer<rapidjson::StringBuffer>* writer,
@@ -52,6 +59,128 @@ std::vector<tdigest::Centroid> CentroidArrayFromJSON(const rapidjson::Value& val
   return centroids;
 }
 
+namespace {
+
+// The first byte of a serialized HyperLogLog.
+enum HyperLogLogEncoding : uint8_t {
+  kEmpty = 0,
+  // (register index as two little endian bytes, register value) for each non-zero register.
+  kSparse = 1,
+  // Every register value in order.
+  kDense = 2,
+};
+
+constexpr size_t kSparseEntryBytes = 3;
+
+}  // namespace
+
+void HyperLogLog::AddHash(uint64_t hash) {
+  if (registers_.empty()) {
+    registers_.resize(kNumRegisters);
+  }
+  size_t idx = hash >> (64 - kPrecision);
+  // The rank is the position of the first set bit in the remaining bits of the hash. The bit set
+  // past them bounds the rank when they are all zeros.
+  uint64_t rest = (hash << kPrecision) | (uint64_t{1} << (kPrecision - 1));
+  uint8_t rank = __builtin_clzll(rest) + 1;
+  registers_[idx] = std::max(registers_[idx], rank);
+}
+
+void HyperLogLog::Merge(const HyperLogLog& other) {
+  if (other.registers_.empty()) {
+    return;
+  }
+  if (registers_.empty()) {
+    registers_ = other.registers_;
+    return;
+  }
+  for (size_t i = 0; i < kNumRegisters; ++i) {
+    registers_[i] = std::max(registers_[i], other.registers_[i]);
+  }
+}
+
+int64_t HyperLogLog::Estimate() const {
+  if (registers_.empty()) {
+    return 0;
+  }
+  constexpr double m = kNumRegisters;
+  const double alpha = 0.7213 / (1 + 1.079 / m);
+  double sum = 0;
+  size_t num_zeros = 0;
+  for (uint8_t r : registers_) {
+    sum += std::ldexp(1.0, -r);
+    num_zeros += r == 0;
+  }
+  double estimate = alpha * m * m / sum;
+  // Linear counting is more accurate while many registers are still empty. The hashes are 64
+  // bits, so the correction for hash collisions at large cardinalities isn't needed.
+  if (estimate <= 2.5 * m && num_zeros > 0) {
+    estimate = m * std::log(m / num_zeros);
+  }
+  return std::llround(estimate);
+}
+
+std::string HyperLogLog::Serialize() const {
+  if (registers_.empty()) {
+    return std::string(1, kEmpty);
+  }
+  size_t num_nonzero = kNumRegisters - std::count(registers_.begin(), registers_.end(), 0);
+  if (num_nonzero * kSparseEntryBytes >= kNumRegisters) {
+    std::string out(1, kDense);
+    out.append(registers_.begin(), registers_.end());
+    return out;
+  }
+  std::string out;
+  out.reserve(1 + num_nonzero * kSparseEntryBytes);
+  out.push_back(kSparse);
+  for (size_t i = 0; i < kNumRegisters; ++i) {
+    if (registers_[i] == 0) {
+      continue;
+    }
+    out.push_back(static_cast<char>(i & 0xff));
+    out.push_back(static_cast<char>(i >> 8));
+    out.push_back(static_cast<char>(registers_[i]));
+  }
+  return out;
+}
+
+Status HyperLogLog::Deserialize(std::string_view data) {
+  if (data.empty()) {
+    return error::InvalidArgument("invalid serialized HyperLogLog: empty");
+  }
+  auto encoding = static_cast<uint8_t>(data[0]);
+  data.remove_prefix(1);
+  registers_.clear();
+  switch (encoding) {
+    case kEmpty:
+      return Status::OK();
+    case kDense:
+      if (data.size() != kNumRegisters) {
+        return error::InvalidArgument("invalid serialized HyperLogLog: $0 registers, expected $1",
+                                      data.size(), kNumRegisters);
+      }
+      registers_.assign(data.begin(), data.end());
+      return Status::OK();
+    case kSparse: {
+      if (data.size() % kSparseEntryBytes != 0) {
+        return error::InvalidArgument("invalid serialized HyperLogLog: truncated sparse entry");
+      }
+      registers_.resize(kNumRegisters);
+      for (size_t i = 0; i < data.size(); i += kSparseEntryBytes) {
+        size_t idx = static_cast<uint8_t>(data[i]) | (static_cast<uint8_t>(data[i + 1]) << 8);
+        if (idx >= kNumRegisters) {
+          return error::InvalidArgument("invalid serialized HyperLogLog: register $0", idx);
+        }
+        registers_[idx] = static_cast<uint8_t>(data[i + 2]);
+      }
+      return Status::OK();
+    }
+    default:
+      return error::InvalidArgument("invalid serialized HyperLogLog: encoding $0",
+                                    static_cast<int>(encoding));
+  }
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
@@ -19,6 +19,7 @@
 #include <rapidjson/document.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
+#include <string>
 
 #include <gtest/gtest.h>
 
@@ -108,6 +109,64 @@ TEST(MathSketches, quantiles_serde) {
   EXPECT_EQ(res_before_serde, res_after_serde);
 }
 
+TEST(MathSketches, approx_count_distinct_small) {
+  auto uda_tester = udf::UDATester<ApproxCountDistinctUDA<types::StringValue>>();
+  uda_tester.ForInput("a").ForInput("b").ForInput("a").ForInput("c").ForInput("b").Expect(3);
+}
+
+// The UDATester keeps a UDA per input to test merging, so large cardinalities are tested against
+// the sketch directly.
+TEST(HyperLogLog, estimate) {
+  for (int64_t num_distinct : {100, 1000, 100000, 1000000}) {
+    HyperLogLog hll;
+    for (int64_t i = 0; i < 2 * num_distinct; ++i) {
+      hll.AddHash(types::utils::hash<types::Int64Value>()(i % num_distinct));
+    }
+    EXPECT_NEAR(num_distinct, hll.Estimate(), num_distinct * 0.05);
+  }
+}
+
+TEST(HyperLogLog, merge) {
+  HyperLogLog hll;
+  HyperLogLog other;
+  for (int64_t i = 0; i < 6000; ++i) {
+    hll.AddHash(types::utils::hash<types::Int64Value>()(i));
+  }
+  for (int64_t i = 4000; i < 10000; ++i) {
+    other.AddHash(types::utils::hash<types::Int64Value>()(i));
+  }
+  hll.Merge(other);
+  EXPECT_NEAR(10000, hll.Estimate(), 10000 * 0.05);
+}
+
+TEST(HyperLogLog, serde) {
+  // Few distinct values are serialized sparsely, many are serialized densely.
+  for (int64_t num_distinct : {0, 10, 50000}) {
+    HyperLogLog hll;
+    for (int64_t i = 0; i < num_distinct; ++i) {
+      hll.AddHash(types::utils::hash<types::Int64Value>()(i));
+    }
+    std::string serialized = hll.Serialize();
+    EXPECT_LE(serialized.size(), HyperLogLog::kNumRegisters + 1);
+    if (num_distinct < 1000) {
+      EXPECT_LE(serialized.size(), static_cast<size_t>(1 + 3 * num_distinct));
+    }
+
+    HyperLogLog deserialized;
+    ASSERT_OK(deserialized.Deserialize(serialized));
+    EXPECT_EQ(hll.Estimate(), deserialized.Estimate());
+    EXPECT_EQ(serialized, deserialized.Serialize());
+  }
+}
+
+TEST(MathSketches, approx_count_distinct_deserialize_invalid) {
+  auto uda_tester = udf::UDATester<ApproxCountDistinctUDA<types::Int64Value>>();
+  EXPECT_NOT_OK(uda_tester.Deserialize(""));
+  EXPECT_NOT_OK(uda_tester.Deserialize(std::string("\x02\x01\x01", 3)));
+  EXPECT_NOT_OK(uda_tester.Deserialize(std::string("\x01\xff\xff\x01", 4)));
+  EXPECT_NOT_OK(uda_tester.Deserialize(std::string("\x07", 1)));
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
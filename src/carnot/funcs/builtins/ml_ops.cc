@@ -16,6 +16,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <filesystem>
+
 #include "src/carnot/funcs/builtins/ml_ops.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/base.h"
@@ -39,6 +41,17 @@ void RegisterMLOpsOrDie(udf::Registry* registry) {
   registry->RegisterOrDie<ReservoirSampleUDA<types::StringValue>>("sample");
 }
 
+void PrewarmMLModels(udf::ModelPool* model_pool) {
+  CHECK(model_pool != nullptr);
+  std::error_code ec;
+  if (!std::filesystem::exists(exec::ml::TransformerExecutor::kDefaultModelPath, ec)) {
+    return;
+  }
+  LOG(INFO) << "Prewarming the transformer model pool";
+  model_pool->Prewarm<exec::ml::TransformerExecutor>(
+      model_pool->max_parallelism(), std::string(exec::ml::TransformerExecutor::kDefaultModelPath));
+}
+
 int load_floats_from_json(std::string in, Eigen::VectorXf* out, int max_num) {
   rapidjson::Document d;
   rapidjson::ParseResult ok = d.Parse(in.data());
@@ -24,8 +24,10 @@
 #include <rapidjson/writer.h>
 #include <sentencepiece/sentencepiece_processor.h>
 
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "src/carnot/exec/ml/coreset.h"
@@ -51,7 +53,7 @@ std::string write_ints_to_json(int* arr, int num);
 
 class TransformerUDF : public udf::ScalarUDF {
  public:
-  TransformerUDF() : TransformerUDF("/embedding.proto") {}
+  TransformerUDF() : TransformerUDF(exec::ml::TransformerExecutor::kDefaultModelPath) {}
   explicit TransformerUDF(std::string model_proto_path) : model_proto_path_(model_proto_path) {}
   StringValue Exec(FunctionContext* ctx, StringValue doc) {
     auto executor =
@@ -61,10 +63,37 @@ class TransformerUDF : public udf::ScalarUDF {
     return output;
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& doc,
+                   udf::OutputColumn<StringValue>* out) {
+    using exec::ml::TransformerExecutor;
+    constexpr size_t kBatchSize = TransformerExecutor::kMaxBatchSize;
+    size_t num_batches = (out->size() + kBatchSize - 1) / kBatchSize;
+    ctx->model_pool()->ParallelExecute<TransformerExecutor>(
+        num_batches,
+        [&doc, out](TransformerExecutor* executor, size_t batch) {
+          size_t start = batch * kBatchSize;
+          size_t end = std::min(start + kBatchSize, out->size());
+          std::vector<std::string_view> docs(doc.data() + start, doc.data() + end);
+          std::vector<std::string> embeddings;
+          executor->ExecuteBatch(docs, &embeddings);
+          for (size_t i = start; i < end; ++i) {
+            (*out)[i] = std::move(embeddings[i - start]);
+          }
+        },
+        model_proto_path_);
+    return Status::OK();
+  }
+
  private:
   std::string model_proto_path_;
 };
 
+/**
+ * Loads the models used by the ML UDFs into the model pool, if they can be found at their default
+ * path, so that the first query using them doesn't pay the model load time.
+ */
+void PrewarmMLModels(udf::ModelPool* model_pool);
+
 class SentencePieceUDF : public udf::ScalarUDF {
  public:
   SentencePieceUDF() : SentencePieceUDF("/sentencepiece.proto") {}
@@ -99,7 +128,12 @@ class KMeansUDA : public udf::UDA {
     DCHECK_EQ(d_, d);
     coreset_.Update(point);
   }
-  void Merge(FunctionContext*, const KMeansUDA& other) { coreset_.Merge(other.coreset_); }
+  void Merge(FunctionContext*, const KMeansUDA& other) {
+    if (k_ == -1) {
+      k_ = other.k_;
+    }
+    coreset_.Merge(other.coreset_);
+  }
   StringValue Finalize(FunctionContext*) {
     auto point_set = coreset_.Query();
     KMeans kmeans(k_);
@@ -107,10 +141,29 @@ class KMeansUDA : public udf::UDA {
     return kmeans.ToJSON();
   }
 
-  StringValue Serialize(FunctionContext*) { return coreset_.ToJSON(); }
+  // The partial aggregates hold k along with the coreset, since the instance that finalizes the
+  // aggregate might not have seen any of the input rows itself.
+  StringValue Serialize(FunctionContext*) {
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+    writer.StartObject();
+    writer.Key("k");
+    writer.Int(k_);
+    writer.Key("coreset");
+    coreset_.ToJSON(&writer);
+    writer.EndObject();
+    return sb.GetString();
+  }
 
   Status Deserialize(FunctionContext*, const StringValue& data) {
-    coreset_.FromJSON(data);
+    rapidjson::Document doc;
+    doc.Parse(data.data(), data.size());
+    if (doc.HasParseError() || !doc.IsObject() || !doc.HasMember("k") || !doc["k"].IsInt() ||
+        !doc.HasMember("coreset") || !doc["coreset"].IsObject()) {
+      return error::InvalidArgument("Invalid serialized KMeans state");
+    }
+    k_ = doc["k"].GetInt();
+    coreset_.FromJSON(doc["coreset"]);
     return Status::OK();
   }
 
@@ -73,6 +73,30 @@ static void BM_TransformerModel(benchmark::State& state) {
   }
 }
 
+// NOLINTNEXTLINE : runtime/references.
+static void BM_TransformerModelBatch(benchmark::State& state) {
+  px::carnot::builtins::TransformerUDF udf(FLAGS_embedding_dir);
+  auto model_pool = px::carnot::udf::ModelPool::Create();
+  model_pool->Prewarm<px::carnot::exec::ml::TransformerExecutor>(model_pool->max_parallelism(),
+                                                                 FLAGS_embedding_dir);
+  auto ctx = px::carnot::udf::FunctionContext(nullptr, model_pool.get());
+
+  std::vector<px::types::StringValue> docs;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    auto ints = random_ints(64);
+    docs.push_back(px::carnot::builtins::write_ints_to_json(ints.data(), 64));
+  }
+  std::vector<px::types::StringValue> out(docs.size());
+  px::carnot::udf::OutputColumn<px::types::StringValue> out_col(out.data(), out.size());
+  px::carnot::udf::ColumnView<px::types::StringValue> docs_col(docs.data(), docs.size());
+
+  for (auto _ : state) {
+    PX_CHECK_OK(udf.ExecBatch(&ctx, docs_col, &out_col));
+    benchmark::DoNotOptimize(out);
+  }
+  state.SetItemsProcessed(state.iterations() * docs.size());
+}
+
 // NOLINTNEXTLINE : runtime/references.
 static void BM_SentencePiece(benchmark::State& state) {
   auto udf = px::carnot::builtins::SentencePieceUDF(FLAGS_sentencepiece_dir);
@@ -85,3 +109,7 @@ static void BM_SentencePiece(benchmark::State& state) {
 
 BENCHMARK(BM_SentencePiece)->Unit(benchmark::kMillisecond);
 BENCHMARK(BM_TransformerModel)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TransformerModelBatch)
+    ->RangeMultiplier(4)
+    ->Range(1, 256)
+    ->Unit(benchmark::kMillisecond);
@@ -28,6 +28,7 @@
 #include "src/carnot/funcs/builtins/ml_ops.h"
 #include "src/carnot/udf/test_utils.h"
 #include "src/common/base/base.h"
+#include "src/common/testing/testing.h"
 
 #include "src/carnot/exec/ml/eigen_test_utils.h"
 
@@ -71,6 +72,38 @@ TEST(KMeans, basic) {
   EXPECT_THAT(kmeans.centroids(), UnorderedRowsAre(expected_centroids, 0.1));
 }
 
+TEST(KMeans, partial_aggregates) {
+  int k = 3;
+  int d = 2;
+
+  Eigen::MatrixXf expected_centroids = kmeans_expected_centroids();
+  Eigen::MatrixXf points = kmeans_test_data();
+
+  // Each of the partial aggregates only sees part of the points, and the aggregate that merges
+  // them doesn't see any of them.
+  std::vector<KMeansUDA> partials(3, KMeansUDA(d));
+  for (int i = 0; i < points.rows(); i++) {
+    auto inp = write_vector_to_json(points(i, Eigen::indexing::all).transpose());
+    partials[i % partials.size()].Update(nullptr, inp, k);
+  }
+
+  KMeansUDA merged(d);
+  for (auto& partial : partials) {
+    KMeansUDA deserialized(d);
+    ASSERT_OK(deserialized.Deserialize(nullptr, partial.Serialize(nullptr)));
+    merged.Merge(nullptr, deserialized);
+  }
+
+  px::carnot::exec::ml::KMeans kmeans(k);
+  kmeans.FromJSON(merged.Finalize(nullptr));
+  EXPECT_THAT(kmeans.centroids(), UnorderedRowsAre(expected_centroids, 0.15));
+}
+
+TEST(KMeans, deserialize_invalid) {
+  KMeansUDA uda(2);
+  EXPECT_NOT_OK(uda.Deserialize(nullptr, "not json"));
+}
+
 TEST(SentencePiece, basic) {
   auto udf_tester = udf::UDFTester<SentencePieceUDF>(FLAGS_sentencepiece_dir);
   udf_tester.ForInput("Test 123!");
@@ -102,6 +135,44 @@ TEST(Transformer, basic) {
   }
 }
 
+std::vector<double> parse_embedding(const std::string& embedding) {
+  std::vector<double> vals;
+  rapidjson::Document d;
+  rapidjson::ParseResult ok = d.Parse(embedding.data());
+  if (ok == nullptr || !d.IsArray()) {
+    return vals;
+  }
+  for (rapidjson::Value::ConstValueIterator itr = d.Begin(); itr != d.End(); ++itr) {
+    vals.push_back(itr->GetFloat());
+  }
+  return vals;
+}
+
+TEST(Transformer, exec_batch) {
+  auto pool = udf::ModelPool::Create();
+  pool->Prewarm<exec::ml::TransformerExecutor>(pool->max_parallelism(), FLAGS_embedding_dir);
+  FunctionContext ctx(nullptr, pool.get());
+  TransformerUDF udf(FLAGS_embedding_dir);
+
+  // More docs than fit in a single batch, with a few invalid ones in between.
+  std::vector<StringValue> docs;
+  for (int i = 0; i < 70; ++i) {
+    docs.push_back(i % 10 == 3 ? "not json" : absl::Substitute("[4,$0,803,195,16]", i + 1));
+  }
+  std::vector<StringValue> out(docs.size());
+  udf::OutputColumn<StringValue> out_col(out.data(), out.size());
+  ASSERT_OK(udf.ExecBatch(&ctx, udf::ColumnView<StringValue>(docs.data(), docs.size()), &out_col));
+
+  for (const auto& [i, doc] : Enumerate(docs)) {
+    auto expected = parse_embedding(udf.Exec(&ctx, doc));
+    auto vals = parse_embedding(out[i]);
+    ASSERT_EQ(expected.size(), vals.size()) << doc;
+    for (const auto& [j, val] : Enumerate(expected)) {
+      EXPECT_NEAR(val, vals[j], 0.0001);
+    }
+  }
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
@@ -17,6 +17,7 @@
  */
 #include <algorithm>
 #include <map>
+#include <numeric>
 #include <vector>
 
 #include <absl/strings/numbers.h>
@@ -321,7 +322,7 @@ static std::map<Tag::Type, std::string_view> type_to_sub_str_ = {
     SUB_STR(Tag::Type::IMEISV),   SUB_STR(Tag::Type::IBAN),      SUB_STR(Tag::Type::SSN),
 };
 
-Status RedactPIIUDF::Init(FunctionContext*) {
+PIITaggers::PIITaggers() {
   // Order is important here. For example, IPv6 has to go before IPv4 to support IPv6 addresses with
   // the lowest 32 bits written like IPv4. Also Email has to go before IP since IP addresses can be
   // part of valid emails.
@@ -334,40 +335,77 @@ Status RedactPIIUDF::Init(FunctionContext*) {
   taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::IMEISV>>());
   taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::CC_NUMBER>>());
   taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::SSN>>());
+
+  // The index of each pattern in the set is the index of its tagger.
+  taggers_set_ = std::make_unique<re2::RE2::Set>(RE2::DefaultOptions, RE2::UNANCHORED);
+  for (const auto& tagger : taggers_) {
+    int idx = taggers_set_->Add(tagger->Pattern(), nullptr);
+    DCHECK_GE(idx, 0);
+  }
+  if (!taggers_set_->Compile()) {
+    LOG(WARNING) << "Failed to compile the PII patterns into a set, all of the taggers will run.";
+    taggers_set_ = nullptr;
+  }
+}
+
+const PIITaggers& PIITaggers::Get() {
+  static const auto* taggers = new PIITaggers();
+  return *taggers;
+}
+
+Status PIITaggers::AddTags(std::string_view input, std::vector<Tag>* tags) const {
+  std::vector<int> matched;
+  re2::RE2::Set::ErrorInfo error_info;
+  if (taggers_set_ != nullptr && !taggers_set_->Match(input, &matched, &error_info) &&
+      error_info.kind == re2::RE2::Set::kNoError) {
+    return Status::OK();
+  }
+  if (taggers_set_ == nullptr || error_info.kind != re2::RE2::Set::kNoError) {
+    // The set couldn't be used (e.g. its DFA ran out of memory), so fall back to all taggers.
+    matched.resize(taggers_.size());
+    std::iota(matched.begin(), matched.end(), 0);
+  }
+  // Keep the tags in tagger order, ReplaceTagsWithSubs uses it to break ties.
+  std::sort(matched.begin(), matched.end());
+  for (int idx : matched) {
+    PX_RETURN_IF_ERROR(taggers_[idx]->AddTags(input, tags));
+  }
+  return Status::OK();
+}
+
+Status RedactPIIUDF::Init(FunctionContext*) {
+  taggers_ = &PIITaggers::Get();
   return Status::OK();
 }
 
 // Replace all tagged sequences in the string with the corresponding substitution string. For
 // overlapping tags, we take the longest tag.
-static inline std::string ReplaceTagsWithSubs(std::string input, std::vector<Tag>* tags) {
+static inline void ReplaceTagsWithSubs(std::string_view input, std::vector<Tag>* tags,
+                                       std::string* output) {
   // Sort the tags chronologically.
   std::sort(tags->begin(), tags->end(), [](Tag a, Tag b) { return a.start_idx < b.start_idx; });
 
   // Remove overlapping tags by only keeping the biggest tag for each group of overlapping tags.
-  std::vector<Tag> non_overlapping_tags;
-  for (auto it = tags->begin(); it < tags->end();) {
-    if (it->size == 0) {
-      it++;
+  // The kept tags are compacted in place to the front of tags.
+  size_t num_kept = 0;
+  for (size_t idx = 0; idx < tags->size();) {
+    const Tag first_tag = (*tags)[idx];
+    if (first_tag.size == 0) {
+      idx++;
       continue;
     }
-    std::vector<Tag> overlapping_tags;
-    auto sub_it = it;
-    while (sub_it != tags->end() &&
-           sub_it->start_idx < (it->start_idx + static_cast<int>(it->size))) {
-      overlapping_tags.push_back(*sub_it);
-      sub_it++;
-    }
-    Tag max_size_tag;
-    size_t max_size = 0;
-    for (const auto& tag : overlapping_tags) {
-      if (tag.size > max_size) {
-        max_size_tag = tag;
-        max_size = tag.size;
+    Tag max_size_tag = first_tag;
+    for (; idx < tags->size() &&
+           (*tags)[idx].start_idx < (first_tag.start_idx + static_cast<int>(first_tag.size));
+         idx++) {
+      if ((*tags)[idx].size > max_size_tag.size) {
+        max_size_tag = (*tags)[idx];
       }
     }
-    non_overlapping_tags.push_back(max_size_tag);
-    it = tags->erase(it, it + overlapping_tags.size());
+    (*tags)[num_kept++] = max_size_tag;
   }
+  tags->resize(num_kept);
+  const auto& non_overlapping_tags = *tags;
 
   // Calculate new string size.
   size_t new_string_size = input.size();
@@ -375,9 +413,9 @@ static inline std::string ReplaceTagsWithSubs(std::string input, std::vector<Tag
     new_string_size = new_string_size + type_to_sub_str_[tag.tag_type].size() - tag.size;
   }
   // Build new string from old string and non overlapping tags.
-  std::string output(new_string_size, 0);
+  output->resize(new_string_size);
   int input_idx = 0;
-  auto data_ptr = output.data();
+  auto data_ptr = output->data();
   for (auto tag : non_overlapping_tags) {
     auto n_copy = input.copy(data_ptr, tag.start_idx - input_idx, input_idx);
     data_ptr += n_copy;
@@ -389,18 +427,43 @@ static inline std::string ReplaceTagsWithSubs(std::string input, std::vector<Tag
     input_idx += tag.size;
   }
   input.copy(data_ptr, input.length() - input_idx, input_idx);
-  return output;
+}
+
+void RedactPIIUDF::Redact(std::string_view input, std::string* out) {
+  tags_.clear();
+  auto s = taggers_->AddTags(input, &tags_);
+  if (!s.ok()) {
+    *out = "Invalid regex: " + s.msg();
+    return;
+  }
+  if (tags_.empty()) {
+    out->assign(input);
+    return;
+  }
+  ReplaceTagsWithSubs(input, &tags_, out);
 }
 
 StringValue RedactPIIUDF::Exec(FunctionContext*, StringValue input) {
-  std::vector<Tag> tags;
-  for (const auto& tagger : taggers_) {
-    auto s = tagger->AddTags(&input, &tags);
-    if (!s.ok()) {
-      return "Invalid regex: " + s.msg();
-    }
+  tags_.clear();
+  auto s = taggers_->AddTags(input, &tags_);
+  if (!s.ok()) {
+    return "Invalid regex: " + s.msg();
+  }
+  // Strings without PII are returned as is, without building a new string.
+  if (tags_.empty()) {
+    return input;
   }
-  return ReplaceTagsWithSubs(input, &tags);
+  StringValue output;
+  ReplaceTagsWithSubs(input, &tags_, &output);
+  return output;
+}
+
+Status RedactPIIUDF::ExecBatch(FunctionContext*, const udf::ColumnView<StringValue>& input,
+                               udf::OutputColumn<StringValue>* out) {
+  for (size_t idx = 0; idx < out->size(); ++idx) {
+    Redact(input[idx], &(*out)[idx]);
+  }
+  return Status::OK();
 }
 
 }  // namespace builtins
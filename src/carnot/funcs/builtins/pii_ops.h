@@ -20,9 +20,11 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "re2/re2.h"
+#include "re2/set.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/utils.h"
 #include "src/shared/types/types.h"
@@ -69,13 +71,36 @@ static std::map<std::string, uint32_t> country_codes{
 class Tagger {
  public:
   virtual ~Tagger() = default;
-  virtual Status AddTags(std::string* input, std::vector<Tag>* tags) = 0;
+  // A regex that matches (at least) every string the tagger adds a tag for.
+  virtual std::string_view Pattern() const = 0;
+  virtual Status AddTags(std::string_view input, std::vector<Tag>* tags) const = 0;
+};
+
+/**
+ * PIITaggers are the taggers of RedactPIIUDF. They are immutable once built, so a single instance
+ * is shared by all of the UDF instances. The patterns of all of the taggers are also combined into
+ * a RE2::Set, which finds the taggers that match an input in a single pass over it, so that only
+ * those taggers have to run. Most strings contain no PII, in which case none of them run.
+ */
+class PIITaggers {
+ public:
+  static const PIITaggers& Get();
+
+  Status AddTags(std::string_view input, std::vector<Tag>* tags) const;
+
+ private:
+  PIITaggers();
+
+  std::vector<std::unique_ptr<Tagger>> taggers_;
+  std::unique_ptr<re2::RE2::Set> taggers_set_;
 };
 
 class RedactPIIUDF : public udf::ScalarUDF {
  public:
   Status Init(FunctionContext*);
   StringValue Exec(FunctionContext*, StringValue input);
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<StringValue>& input,
+                   udf::OutputColumn<StringValue>* out);
 
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -93,7 +118,12 @@ class RedactPIIUDF : public udf::ScalarUDF {
   }
 
  private:
-  std::vector<std::unique_ptr<Tagger>> taggers_;
+  // Writes the redacted input to out, or an error message if the tags can't be computed.
+  void Redact(std::string_view input, std::string* out);
+
+  const PIITaggers* taggers_ = nullptr;
+  // Reused across records to avoid allocating it for each one.
+  std::vector<Tag> tags_;
 };
 
 void RegisterPIIOpsOrDie(udf::Registry* registry);
@@ -106,28 +136,24 @@ class RegexTagger : public Tagger {
     DCHECK_EQ(regex_.error_code(), RE2::NoError) << regex_.error();
   }
 
-  Status AddTags(std::string* input, std::vector<Tag>* tags) {
-    re2::StringPiece input_piece(input->data(), input->length());
-    auto prev_length = input_piece.length();
-    int curr_idx = 0;
-    std::string match;
-    while (RE2::FindAndConsume(&input_piece, regex_, &match)) {
-      auto consumed = prev_length - input_piece.length();
-      if (consumed == 0) {
+  std::string_view Pattern() const override { return TagTypeTraits<TTag>::BuildRegexPattern(); }
+
+  Status AddTags(std::string_view input, std::vector<Tag>* tags) const override {
+    re2::StringPiece text(input.data(), input.length());
+    // The match points into the input, so no copies are made while searching.
+    re2::StringPiece match;
+    size_t pos = 0;
+    while (pos < text.size() &&
+           regex_.Match(text, pos, text.size(), RE2::UNANCHORED, &match, /*nsubmatch*/ 1)) {
+      if (match.empty()) {
         return Status(statuspb::Code::INVALID_ARGUMENT,
                       "RegexTagger has a regex pattern which matches an empty string.");
       }
+      pos = match.data() + match.size() - text.data();
       if (!TagTypeTraits<TTag>::Filter(match)) {
         continue;
       }
-      auto match_size = match.length();
-      // FindAndConsume is not anchored at the start of the StringPiece. To find the start we look
-      // at how much more was consumed than matched.
-      int start_idx = curr_idx + (consumed - match_size);
-      prev_length = input_piece.length();
-      curr_idx += consumed;
-
-      tags->push_back(Tag{TTag, start_idx, match_size});
+      tags->push_back(Tag{TTag, static_cast<int>(match.data() - text.data()), match.size()});
     }
     return Status::OK();
   }
@@ -17,6 +17,8 @@
  */
 #include <benchmark/benchmark.h>
 
+#include <vector>
+
 #include "src/carnot/funcs/builtins/pii_ops.h"
 
 namespace px {
@@ -53,6 +55,48 @@ static void BM_RedactPII(benchmark::State& state) {
 
 BENCHMARK(BM_RedactPII)->RangeMultiplier(2)->Range(1, 12);
 
+// HTTP bodies as they show up in http_events: most of them contain no PII at all.
+static constexpr std::string_view kHTTPBodyNoPII = R"body({
+  "id": "4c8a0d54-8f1d-4b7e-9d44-52fd7d2c7f0b",
+  "status": "shipped",
+  "items": [{"sku": "A-1023", "count": 2, "price": 19.99}, {"sku": "B-77", "count": 1}],
+  "created_at": "2021-11-04T17:02:11Z",
+  "tracking": {"carrier": "ups", "url": "https://example.com/track?id=1Z999AA10123456784"}
+})body";
+
+static constexpr std::string_view kHTTPBodyWithPII = R"body({
+  "id": "4c8a0d54-8f1d-4b7e-9d44-52fd7d2c7f0b",
+  "customer": {"email": "jane.doe@example.com", "phone": "555-0100", "ssn": "201-21-0021"},
+  "payment": {"card": "5105 1051 0510 5100", "iban": "GB82 WEST 1234 5698 7654 32"},
+  "client_ip": "10.12.0.8",
+  "created_at": "2021-11-04T17:02:11Z"
+})body";
+
+// Redacts a batch of bodies, of which one out of every state.range(0) contains PII.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RedactPIIHTTPBodies(benchmark::State& state) {
+  RedactPIIUDF udf;
+  PX_UNUSED(udf.Init(nullptr));
+
+  constexpr size_t kNumBodies = 1024;
+  std::vector<StringValue> bodies;
+  int64_t bytes = 0;
+  for (size_t i = 0; i < kNumBodies; ++i) {
+    bodies.emplace_back(i % state.range(0) == 0 ? kHTTPBodyWithPII : kHTTPBodyNoPII);
+    bytes += bodies.back().size();
+  }
+  std::vector<StringValue> out(kNumBodies);
+  for (auto _ : state) {
+    udf::OutputColumn<StringValue> out_col(out.data(), out.size());
+    PX_UNUSED(udf.ExecBatch(nullptr, udf::ColumnView<StringValue>(bodies.data(), bodies.size()),
+                            &out_col));
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetBytesProcessed(bytes * static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_RedactPIIHTTPBodies)->Arg(1)->Arg(10)->Arg(100);
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
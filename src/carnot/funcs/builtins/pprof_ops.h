@@ -18,8 +18,6 @@
 
 #pragma once
 
-#include <absl/container/flat_hash_map.h>
-
 #include <string>
 
 #include "src/carnot/udf/registry.h"
@@ -30,6 +28,7 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
+using px::shared::PProfBuilder;
 using px::shared::PProfProfile;
 
 class CreatePProfRowAggregate : public udf::UDA {
@@ -62,15 +61,13 @@ class CreatePProfRowAggregate : public udf::UDA {
               const Int64Value profiler_period_ms) {
     UpdateOrCheckSamplingPeriod(profiler_period_ms.val);
 
-    histo_[stack_trace] += count.val;
+    builder_.AddStackTrace(stack_trace, count.val);
   }
 
   void Merge(FunctionContext*, const CreatePProfRowAggregate& other) {
     UpdateOrCheckSamplingPeriod(other.profiler_period_ms_);
 
-    for (const auto& [stack_trace, count] : other.histo_) {
-      histo_[stack_trace] += count;
-    }
+    builder_.Merge(other.builder_);
   }
 
   StringValue Serialize(FunctionContext*) {
@@ -78,7 +75,7 @@ class CreatePProfRowAggregate : public udf::UDA {
       return "Protobuf `SerializeToString` failed, multiple profiling periods found.";
     }
 
-    const auto pprof = px::shared::CreatePProfProfile(profiler_period_ms_, histo_);
+    const auto pprof = builder_.Build(profiler_period_ms_);
     std::string output;
     const bool ok = pprof.SerializeToString(&output);
     if (!ok) {
@@ -96,14 +93,8 @@ class CreatePProfRowAggregate : public udf::UDA {
 
     UpdateOrCheckSamplingPeriod(pprof.period() / 1000 / 1000);
 
-    // Deserialize into a map from stack_trace string to count.
-    const auto merge_histo = ::px::shared::DeserializePProfProfile(pprof);
-
-    // Incorporate the deserialized result into our histo_.
-    for (const auto& [stack_trace, count] : merge_histo) {
-      histo_[stack_trace] += count;
-    }
-    return Status::OK();
+    // Incorporate the partial profile without going back to stack trace strings.
+    return builder_.AddProfile(pprof);
   }
 
   StringValue Finalize(FunctionContext* ctx) { return Serialize(ctx); }
@@ -121,11 +112,83 @@ class CreatePProfRowAggregate : public udf::UDA {
     }
   }
 
-  absl::flat_hash_map<std::string, uint64_t> histo_;
+  // Holds the stack traces as vectors of interned symbols, so the aggregate doesn't keep a copy
+  // of every distinct folded stack trace string.
+  PProfBuilder builder_;
   int32_t profiler_period_ms_ = -1;
   bool multiple_profiler_periods_found_ = false;
 };
 
+class CreateInternedPProfRowAggregate : public CreatePProfRowAggregate {
+ public:
+  static udf::UDADocBuilder Doc() {
+    return udf::UDADocBuilder("Convert perf profiling data with interned frames to pprof format.")
+        .Details(
+            "Converts perf profiling stack traces of frame IDs (see "
+            "--stirling_profiler_intern_frames), along with the frames that the IDs stand for, "
+            "into pprof format. Each row either names a frame (frame is non-empty), or holds a "
+            "stack trace of frame IDs and its count (stack_trace is non-empty). Frame IDs are "
+            "scoped by ASID.")
+        .Example(
+            R"doc(
+        | sample_period = px.GetProfilerSamplingPeriodMS()
+        |
+        | stack_traces = px.DataFrame(table='stack_traces.beta', start_time='-1m')
+        | stack_traces.asid = px.asid()
+        | stack_traces.frame_id = -1
+        | stack_traces.frame = ''
+        | stack_traces = stack_traces[['asid', 'frame_id', 'frame', 'stack_trace', 'count']]
+        |
+        | # Frames are reported once every few minutes; read them from further back.
+        | frames = px.DataFrame(table='stack_trace_frames.beta', start_time='-15m')
+        | frames.asid = px.asid()
+        | frames.stack_trace = ''
+        | frames['count'] = 0
+        | frames = frames[['asid', 'frame_id', 'frame', 'stack_trace', 'count']]
+        |
+        | df = stack_traces.append(frames)
+        | df = df.merge(sample_period, how='inner', left_on=['asid'], right_on=['asid'])
+        | df = df.groupby(['profiler_sampling_period_ms']).agg(
+        |     pprof=('asid', 'frame_id', 'frame', 'stack_trace', 'count',
+        |            'profiler_sampling_period_ms', px.pprof_interned))
+        )doc")
+        .Arg("asid", "The ASID of the PEM that assigned the frame IDs.")
+        .Arg("frame_id", "The frame ID that frame stands for.")
+        .Arg("frame", "The frame (symbol), or empty.")
+        .Arg("stack_trace", "The stack trace of frame IDs, or empty.")
+        .Arg("count", "Count of the stack trace.")
+        .Arg("profiler_period_ms", "Profiler stack trace sampling period in ms.")
+        .Returns("A single row that aggregates all the stack traces and counts into pprof format.");
+  }
+
+  void Update(FunctionContext*, const Int64Value asid, const Int64Value frame_id,
+              const StringValue frame, const StringValue stack_trace, const Int64Value count,
+              const Int64Value profiler_period_ms) {
+    if (!frame.empty()) {
+      builder_.AddFrame(asid.val, frame_id.val, frame);
+    }
+    if (!stack_trace.empty()) {
+      UpdateOrCheckSamplingPeriod(profiler_period_ms.val);
+      builder_.AddInternedStackTrace(asid.val, stack_trace, count.val);
+    }
+  }
+
+  void Merge(FunctionContext*, const CreateInternedPProfRowAggregate& other) {
+    UpdateOrCheckSamplingPeriod(other.profiler_period_ms_);
+
+    builder_.Merge(other.builder_);
+  }
+
+  // The frames of the interned stack traces are resolved once all of them have been seen, i.e.
+  // a serialized (partial) aggregate is a plain pprof profile.
+  StringValue Serialize(FunctionContext* ctx) {
+    builder_.ResolveFrames();
+    return CreatePProfRowAggregate::Serialize(ctx);
+  }
+
+  StringValue Finalize(FunctionContext* ctx) { return Serialize(ctx); }
+};
+
 void RegisterPProfOpsOrDie(udf::Registry* registry);
 
 }  // namespace builtins
@@ -79,6 +79,11 @@ TEST(PProf, profiling_rows_to_pprof_test) {
 
   // Expect the deserialized result to be equal to our expected value.
   EXPECT_EQ(actual, expected);
+
+  // Each distinct symbol is stored once: foo, bar, baz, qux, main, compute, map & reduce.
+  EXPECT_EQ(pprof.location_size(), 8);
+  EXPECT_EQ(pprof.function_size(), 8);
+  EXPECT_EQ(pprof.string_table_size(), 5 + 8);
 }
 
 TEST(PProf, pprof_merge_test) {
@@ -137,6 +142,19 @@ TEST(PProf, pprof_merge_test) {
   EXPECT_EQ(actual, expected);
 }
 
+TEST(PProf, deserialize_invalid_pprof) {
+  auto pprof_uda_tester = udf::UDATester<CreatePProfRowAggregate>();
+  pprof_uda_tester.ForInput("foo;bar;baz", 1, profiler_period_ms);
+
+  // A sample that refers to a location that doesn't exist.
+  PProfProfile pprof;
+  ASSERT_TRUE(pprof.ParseFromString(pprof_uda_tester.Serialize()));
+  pprof.mutable_sample(0)->add_location_id(pprof.location_size() + 1);
+
+  auto pprof_uda_tester_merge = udf::UDATester<CreatePProfRowAggregate>();
+  EXPECT_NOT_OK(pprof_uda_tester_merge.Deserialize(pprof.SerializeAsString()));
+}
+
 TEST(PProf, uda_fails_with_multiple_sample_periods) {
   // Create our UDA tester.
   auto pprof_uda_tester = udf::UDATester<CreatePProfRowAggregate>();
@@ -153,6 +171,38 @@ TEST(PProf, uda_fails_with_multiple_sample_periods) {
   EXPECT_FALSE(pprof.ParseFromString(result));
 }
 
+TEST(PProf, interned_rows_to_pprof_test) {
+  auto pprof_uda_tester_a = udf::UDATester<CreateInternedPProfRowAggregate>();
+  auto pprof_uda_tester_b = udf::UDATester<CreateInternedPProfRowAggregate>();
+  auto pprof_uda_tester_merge = udf::UDATester<CreateInternedPProfRowAggregate>();
+
+  // Stack trace rows may come before the rows of their frames. The frame IDs of different ASIDs
+  // are unrelated, and frame ID 4 of ASID 1 is never named.
+  constexpr int64_t kNoFrameID = -1;
+  pprof_uda_tester_a.ForInput(1, kNoFrameID, "", "1;2;3", 1, profiler_period_ms);
+  pprof_uda_tester_a.ForInput(1, kNoFrameID, "", "1;2;3", 2, profiler_period_ms);
+  pprof_uda_tester_a.ForInput(1, kNoFrameID, "", "1;4", 5, profiler_period_ms);
+  pprof_uda_tester_a.ForInput(1, 1, "foo", "", 0, profiler_period_ms);
+  pprof_uda_tester_a.ForInput(1, 2, "bar", "", 0, profiler_period_ms);
+  pprof_uda_tester_a.ForInput(1, 3, "baz", "", 0, profiler_period_ms);
+  pprof_uda_tester_b.ForInput(2, 1, "main", "", 0, profiler_period_ms);
+  pprof_uda_tester_b.ForInput(2, 2, "compute", "", 0, profiler_period_ms);
+  pprof_uda_tester_b.ForInput(2, kNoFrameID, "", "1;2", 4, profiler_period_ms);
+
+  const absl::flat_hash_map<std::string, uint64_t> expected = {
+      {"foo;bar;baz", 1 + 2},
+      {"foo;<unknown frame 4>", 5},
+      {"main;compute", 4},
+  };
+
+  EXPECT_OK(pprof_uda_tester_merge.Deserialize(pprof_uda_tester_a.Serialize()));
+  EXPECT_OK(pprof_uda_tester_merge.Deserialize(pprof_uda_tester_b.Serialize()));
+
+  PProfProfile pprof;
+  EXPECT_TRUE(pprof.ParseFromString(pprof_uda_tester_merge.Result()));
+  EXPECT_EQ(DeserializePProfProfile(pprof), expected);
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
@@ -17,6 +17,10 @@
  */
 
 #include "src/carnot/funcs/builtins/regex_ops.h"
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/base.h"
 
@@ -24,6 +28,117 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
+namespace {
+
+// The caches are cleared when they grow past this many entries, so that queries with generated
+// patterns can't grow them without bound. Entries that are still in use stay alive through their
+// shared_ptrs.
+constexpr size_t kMaxCachedPatterns = 1024;
+
+template <typename TKey, typename TValue>
+class PatternCache {
+ public:
+  std::shared_ptr<const TValue> Get(const TKey& key) {
+    absl::MutexLock lock(&mu_);
+    auto it = cache_.find(key);
+    return it == cache_.end() ? nullptr : it->second;
+  }
+
+  void Put(const TKey& key, std::shared_ptr<const TValue> value) {
+    absl::MutexLock lock(&mu_);
+    if (cache_.size() >= kMaxCachedPatterns) {
+      cache_.clear();
+    }
+    cache_.emplace(key, std::move(value));
+  }
+
+ private:
+  absl::Mutex mu_;
+  absl::flat_hash_map<TKey, std::shared_ptr<const TValue>> cache_ ABSL_GUARDED_BY(mu_);
+};
+
+re2::RE2::Options RegexOptions(bool dot_nl) {
+  re2::RE2::Options opts;
+  opts.set_dot_nl(dot_nl);
+  opts.set_log_errors(false);
+  return opts;
+}
+
+}  // namespace
+
+std::shared_ptr<const re2::RE2> CompiledRegex(std::string_view pattern, bool dot_nl) {
+  static auto* cache = new PatternCache<std::pair<std::string, bool>, re2::RE2>();
+  auto key = std::make_pair(std::string(pattern), dot_nl);
+  auto regex = cache->Get(key);
+  if (regex == nullptr) {
+    // Compile outside of the lock, two threads racing on the same pattern just compile it twice.
+    regex = std::make_shared<const re2::RE2>(pattern, RegexOptions(dot_nl));
+    cache->Put(key, regex);
+  }
+  return regex;
+}
+
+StatusOr<std::shared_ptr<const RegexRuleSet>> RegexRuleSet::Compile(
+    std::string_view encoded_rules) {
+  static auto* cache = new PatternCache<std::string, RegexRuleSet>();
+  std::string key(encoded_rules);
+  auto cached = cache->Get(key);
+  if (cached != nullptr) {
+    return cached;
+  }
+
+  rapidjson::Document regex_rules_json;
+  rapidjson::ParseResult parse_result = regex_rules_json.Parse(key.data(), key.size());
+  if (!parse_result || !regex_rules_json.IsObject()) {
+    return Status(statuspb::Code::INVALID_ARGUMENT, "unable to parse string as json");
+  }
+
+  auto rules = std::make_shared<RegexRuleSet>();
+  rules->set_ = std::make_unique<re2::RE2::Set>(RegexOptions(/*dot_nl*/ true), RE2::ANCHOR_BOTH);
+  for (auto itr = regex_rules_json.MemberBegin(); itr != regex_rules_json.MemberEnd(); ++itr) {
+    if (!itr->value.IsString()) {
+      return error::InvalidArgument("regex rule '$0' must be a string", itr->name.GetString());
+    }
+    std::string_view pattern(itr->value.GetString(), itr->value.GetStringLength());
+    auto regex = CompiledRegex(pattern, /*dot_nl*/ true);
+    // Invalid patterns never match, so they are left out of the set.
+    if (regex->error_code() != RE2::NoError) {
+      continue;
+    }
+    if (rules->set_->Add(pattern, /*error*/ nullptr) < 0) {
+      continue;
+    }
+    rules->names_.emplace_back(itr->name.GetString(), itr->name.GetStringLength());
+    rules->regexes_.push_back(std::move(regex));
+  }
+  if (rules->names_.empty() || !rules->set_->Compile()) {
+    // Without a set, Match falls back to checking the rules one by one.
+    rules->set_ = nullptr;
+  }
+  cache->Put(key, rules);
+  return std::shared_ptr<const RegexRuleSet>(std::move(rules));
+}
+
+std::string_view RegexRuleSet::Match(std::string_view value) const {
+  if (set_ != nullptr) {
+    std::vector<int> matches;
+    re2::RE2::Set::ErrorInfo error_info;
+    if (set_->Match(value, &matches, &error_info)) {
+      // The set indexes follow the order of the rules, and the first rule wins.
+      return names_[*std::min_element(matches.begin(), matches.end())];
+    }
+    if (error_info.kind == re2::RE2::Set::kNoError) {
+      return "";
+    }
+  }
+  for (size_t i = 0; i < regexes_.size(); ++i) {
+    if (RE2::FullMatch(value, *regexes_[i])) {
+      return names_[i];
+    }
+  }
+  return "";
+}
+
 void RegisterRegexOpsOrDie(udf::Registry* registry) {
   CHECK(registry != nullptr);
   /*****************************************
@@ -24,11 +24,14 @@
 
 #include <algorithm>
 #include <memory>
+#include <optional>
 #include <regex>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 #include "re2/re2.h"
+#include "re2/set.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/utils.h"
 #include "src/shared/types/types.h"
@@ -37,16 +40,57 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
+/**
+ * Returns the compiled regex for the pattern. The patterns are constant arguments, so they are
+ * compiled when the UDFs are initialized. The compiled regexes are cached and shared by all of the
+ * UDF instances (there is one per query thread) and queries that use the same pattern, which is
+ * safe since matching against a RE2 doesn't modify it.
+ *
+ * @param dot_nl whether '.' also matches new lines.
+ */
+std::shared_ptr<const re2::RE2> CompiledRegex(std::string_view pattern, bool dot_nl);
+
+/**
+ * The rules of MatchRegexRule compiled into a single RE2::Set, so that a value is matched against
+ * all of the rules in one pass instead of one pass per rule.
+ */
+class RegexRuleSet {
+ public:
+  /**
+   * Compiles the rules from a json map of rule name to regex pattern. Rules with invalid patterns
+   * never match. The result is cached like CompiledRegex.
+   */
+  static StatusOr<std::shared_ptr<const RegexRuleSet>> Compile(std::string_view encoded_rules);
+
+  /**
+   * Returns the name of the first rule whose pattern matches the full value, or an empty string
+   * if none of them match.
+   */
+  std::string_view Match(std::string_view value) const;
+
+ private:
+  std::unique_ptr<re2::RE2::Set> set_;
+  // The name and regex of each pattern of the set. The regexes are only used if matching
+  // against the set fails, which happens when it runs out of memory.
+  std::vector<std::string> names_;
+  std::vector<std::shared_ptr<const re2::RE2>> regexes_;
+};
+
 class RegexMatchUDF : public udf::ScalarUDF {
  public:
   Status Init(FunctionContext*, StringValue regex) {
-    re2::RE2::Options opts;
-    opts.set_dot_nl(true);
-    opts.set_log_errors(false);
-    regex_ = std::make_unique<re2::RE2>(regex, opts);
+    regex_ = CompiledRegex(regex, /*dot_nl*/ true);
     return Status::OK();
   }
-  BoolValue Exec(FunctionContext*, StringValue input) {
+  BoolValue Exec(FunctionContext*, StringValue input) { return Match(input); }
+
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<StringValue>& input,
+                   udf::OutputColumn<BoolValue>* out) {
+    return udf::ExecBatchElementwise(
+        out, [this](const StringValue& val) -> BoolValue { return Match(val); }, input);
+  }
+
+  bool Match(std::string_view input) const {
     if (regex_->error_code() != RE2::NoError) {
       return false;
     }
@@ -69,24 +113,30 @@ class RegexMatchUDF : public udf::ScalarUDF {
   }
 
  private:
-  std::unique_ptr<re2::RE2> regex_;
+  std::shared_ptr<const re2::RE2> regex_;
 };
 
 class RegexReplaceUDF : public udf::ScalarUDF {
  public:
   Status Init(FunctionContext*, StringValue regex_pattern) {
-    re2::RE2::Options opts;
-    opts.set_log_errors(false);
-    regex_ = std::make_unique<re2::RE2>(regex_pattern, opts);
+    regex_ = CompiledRegex(regex_pattern, /*dot_nl*/ false);
+    checked_sub_.reset();
     return Status::OK();
   }
   StringValue Exec(FunctionContext*, StringValue input, StringValue sub) {
     if (regex_->error_code() != RE2::NoError) {
       return absl::Substitute("Invalid regex expr: $0", regex_->error());
     }
-    std::string err_str;
-    if (!regex_->CheckRewriteString(sub, &err_str)) {
-      return absl::Substitute("Invalid regex in substitution string: $0", err_str);
+    // The substitution is almost always a constant, so only check it when it changes.
+    if (!checked_sub_.has_value() || *checked_sub_ != sub) {
+      sub_error_.clear();
+      if (!regex_->CheckRewriteString(sub, &sub_error_)) {
+        sub_error_ = absl::Substitute("Invalid regex in substitution string: $0", sub_error_);
+      }
+      checked_sub_ = sub;
+    }
+    if (!sub_error_.empty()) {
+      return sub_error_;
     }
     RE2::GlobalReplace(&input, *regex_, sub);
     return input;
@@ -114,38 +164,29 @@ class RegexReplaceUDF : public udf::ScalarUDF {
   }
 
  private:
-  std::unique_ptr<re2::RE2> regex_;
+  std::shared_ptr<const re2::RE2> regex_;
+  // The last substitution string checked, and the error message if it's invalid.
+  std::optional<std::string> checked_sub_;
+  std::string sub_error_;
 };
 
 class MatchRegexRule : public udf::ScalarUDF {
  public:
-  Status Init(FunctionContext* ctx, StringValue encodedRegexRules) {
-    // Parse encodedRegexRules as json.
-    rapidjson::Document regex_rules_json;
-    rapidjson::ParseResult parse_result = regex_rules_json.Parse(encodedRegexRules.data());
-    if (!parse_result) {
-      return Status(statuspb::Code::INVALID_ARGUMENT, "unable to parse string as json");
-    }
-    // Populate the parse regular expressions into self::regex_rules.
-    for (rapidjson::Value::ConstMemberIterator itr = regex_rules_json.MemberBegin();
-         itr != regex_rules_json.MemberEnd(); ++itr) {
-      RegexMatchUDF regex_match_udf;
-      std::string name = itr->name.GetString();
-      std::string regex_pattern = itr->value.GetString();
-      PX_RETURN_IF_ERROR(regex_match_udf.Init(ctx, regex_pattern));
-      regex_rules.emplace_back(make_pair(name, std::move(regex_match_udf)));
-      regex_rules_length++;
-    }
+  Status Init(FunctionContext*, StringValue encodedRegexRules) {
+    PX_ASSIGN_OR_RETURN(regex_rules_, RegexRuleSet::Compile(encodedRegexRules));
     return Status::OK();
   }
 
-  types::StringValue Exec(FunctionContext* ctx, StringValue value) {
-    for (int i = 0; i < regex_rules_length; i++) {
-      if (regex_rules[i].second.Exec(ctx, value).val) {
-        return regex_rules[i].first;
-      }
+  types::StringValue Exec(FunctionContext*, StringValue value) {
+    return std::string(regex_rules_->Match(value));
+  }
+
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<StringValue>& value,
+                   udf::OutputColumn<StringValue>* out) {
+    for (size_t i = 0; i < out->size(); ++i) {
+      (*out)[i].assign(regex_rules_->Match(value[i]));
     }
-    return "";
+    return Status::OK();
   }
 
   static udf::ScalarUDFDocBuilder Doc() {
@@ -170,8 +211,7 @@ class MatchRegexRule : public udf::ScalarUDF {
   }
 
  private:
-  int regex_rules_length = 0;
-  std::vector<std::pair<std::string, RegexMatchUDF> > regex_rules;
+  std::shared_ptr<const RegexRuleSet> regex_rules_;
 };
 
 void RegisterRegexOpsOrDie(udf::Registry* registry);
@@ -96,6 +96,41 @@ TEST(RegexOps, regex_match_rules) {
   EXPECT_NOT_OK(MatchRegexRule().Init(nullptr, "(?i).*onpointerenter.*"));
 }
 
+TEST(RegexOps, regex_match_rules_first_match) {
+  auto udf_tester = udf::UDFTester<MatchRegexRule>();
+  constexpr char kRules[] = R"json({"invalid":"\\K","users":"/users/.*","api":"/api/.*",
+                                     "user_api":"/api/users/.*","any_api":".*api.*"})json";
+  udf_tester.Init(kRules).ForInput("/api/users/1").Expect("api");
+  udf_tester.Init(kRules).ForInput("/users/api").Expect("users");
+  udf_tester.Init(kRules).ForInput("/v1/api").Expect("any_api");
+  udf_tester.Init(kRules).ForInput("/v1/users").Expect("");
+  udf_tester.Init(kRules).ForInput("\\K").Expect("");
+  // Rules must be strings.
+  EXPECT_NOT_OK(MatchRegexRule().Init(nullptr, R"json({"users":1})json"));
+}
+
+TEST(RegexOps, regex_cache) {
+  auto regex = CompiledRegex("abc.*", /*dot_nl*/ true);
+  EXPECT_EQ(regex, CompiledRegex("abc.*", /*dot_nl*/ true));
+  EXPECT_NE(regex, CompiledRegex("abc.*", /*dot_nl*/ false));
+  EXPECT_TRUE(RE2::FullMatch("abc\nd", *regex));
+
+  ASSERT_OK_AND_ASSIGN(auto rules, RegexRuleSet::Compile(R"json({"a":"a.*"})json"));
+  ASSERT_OK_AND_ASSIGN(auto same_rules, RegexRuleSet::Compile(R"json({"a":"a.*"})json"));
+  EXPECT_EQ(rules, same_rules);
+  EXPECT_EQ("a", rules->Match("abc"));
+}
+
+TEST(RegexOps, regex_replace_changing_sub) {
+  auto udf_tester = udf::UDFTester<RegexReplaceUDF>();
+  udf_tester.Init("([a-z]+)").ForInput("abc 123", R"regex(<\1>)regex").Expect("<abc> 123");
+  udf_tester.ForInput("abc 123", R"regex(\2)regex")
+      .Expect(
+          "Invalid regex in substitution string: Rewrite schema requests 2 matches, but the "
+          "regexp only has 1 parenthesized subexpressions.");
+  udf_tester.ForInput("abc 123", "_").Expect("_ 123");
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
@@ -17,6 +17,9 @@
  */
 
 #include "src/carnot/funcs/builtins/request_path_ops.h"
+#include <absl/strings/str_split.h>
+#include <absl/strings/strip.h>
+#include <memory>
 #include <string_view>
 #include <vector>
 #include "src/carnot/udf/registry.h"
@@ -37,6 +40,7 @@ void RegisterRequestPathOpsOrDie(udf::Registry* registry) {
    * Aggregate UDFs.
    *****************************************/
   registry->RegisterOrDie<RequestPathClusteringFitUDA>("_build_request_path_clusters");
+  registry->RegisterOrDie<RequestPathClusteringUpdateUDA>("_update_request_path_clusters");
 }
 
 RequestPath::RequestPath(std::string request_path) {
@@ -140,6 +144,23 @@ bool RequestPath::Matches(const RequestPath& templ) const {
   return true;
 }
 
+bool RequestPath::Matches(std::string_view request_path, const RequestPath& templ) {
+  // Split the request path the same way as the constructor does.
+  request_path = request_path.substr(0, request_path.find('?'));
+  absl::ConsumePrefix(&request_path, "/");
+  size_t i = 0;
+  for (std::string_view path_component : absl::StrSplit(request_path, '/')) {
+    if (i >= templ.path_components_.size()) {
+      return false;
+    }
+    const auto& templ_component = templ.path_components_[i++];
+    if (templ_component != kAnyToken && templ_component != path_component) {
+      return false;
+    }
+  }
+  return i == templ.path_components_.size();
+}
+
 void RequestPathCluster::Merge(const RequestPathCluster& other_cluster) {
   MergeCentroids(other_cluster.centroid_);
   MergeMembers(other_cluster.members_);
@@ -247,12 +268,17 @@ StatusOr<RequestPathClustering> RequestPathClustering::FromJSON(const std::strin
   if (ok == nullptr) {
     return error::InvalidArgument("RequestPathClustering::FromJSON: invalid json");
   }
-  if (!d.IsArray()) {
+  return RequestPathClustering::FromJSON(d);
+}
+
+StatusOr<RequestPathClustering> RequestPathClustering::FromJSON(
+    const rapidjson::Document::ValueType& doc) {
+  if (!doc.IsArray()) {
     return error::InvalidArgument("RequestPathClustering::FromJSON: expected array");
   }
 
   RequestPathClustering clustering;
-  for (rapidjson::Value::ConstValueIterator itr = d.Begin(); itr != d.End(); ++itr) {
+  for (rapidjson::Value::ConstValueIterator itr = doc.Begin(); itr != doc.End(); ++itr) {
     const rapidjson::Value& val = *itr;
     PX_ASSIGN_OR_RETURN(auto cluster, RequestPathCluster::FromJSON(val));
     clustering.AddNewCluster(cluster);
@@ -263,14 +289,18 @@ StatusOr<RequestPathClustering> RequestPathClustering::FromJSON(const std::strin
 std::string RequestPathClustering::ToJSON() const {
   rapidjson::StringBuffer sb;
   rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-  writer.StartArray();
-  for (auto cluster : clusters_) {
-    cluster.ToJSON(&writer);
-  }
-  writer.EndArray();
+  ToJSON(&writer);
   return sb.GetString();
 }
 
+void RequestPathClustering::ToJSON(rapidjson::Writer<rapidjson::StringBuffer>* writer) const {
+  writer->StartArray();
+  for (const auto& cluster : clusters_) {
+    cluster.ToJSON(writer);
+  }
+  writer->EndArray();
+}
+
 const RequestPath& RequestPathClustering::Predict(const RequestPath& request_path) {
   int64_t closest_cluster_index;
   MaxSimilarity(request_path, &closest_cluster_index);
@@ -332,6 +362,108 @@ void RequestPathClustering::Merge(const RequestPathClustering& other_clustering)
   }
 }
 
+bool RequestPathClustering::Covers(const RequestPath& request_path) const {
+  int64_t closest_cluster_index;
+  auto similarity = MaxSimilarity(request_path, &closest_cluster_index);
+  if (closest_cluster_index == -1 || similarity < thresh_) {
+    return false;
+  }
+  const auto& cluster = clusters_[closest_cluster_index];
+  return cluster.members().empty() && request_path.Matches(cluster.centroid());
+}
+
+RequestPathClusteringStore* RequestPathClusteringStore::GetInstance() {
+  static auto* store = new RequestPathClusteringStore();
+  return store;
+}
+
+std::shared_ptr<const RequestPathClustering> RequestPathClusteringStore::Get(
+    const std::string& service) const {
+  absl::MutexLock lock(&mu_);
+  auto it = clusterings_.find(service);
+  if (it == clusterings_.end()) {
+    return std::make_shared<RequestPathClustering>();
+  }
+  return it->second;
+}
+
+std::shared_ptr<const RequestPathClustering> RequestPathClusteringStore::Update(
+    const std::string& service, const RequestPathClustering& clustering) {
+  auto stored_clustering = Get(service);
+  if (clustering.clusters().empty()) {
+    return stored_clustering;
+  }
+  // Merge outside of the lock, on a copy, since readers may still hold the stored clustering.
+  // Concurrent updates of the same service are rare, and the last one wins.
+  auto updated_clustering = std::make_shared<RequestPathClustering>(*stored_clustering);
+  updated_clustering->Merge(clustering);
+
+  absl::MutexLock lock(&mu_);
+  clusterings_[service] = updated_clustering;
+  return updated_clustering;
+}
+
+void RequestPathClusteringStore::Clear() {
+  absl::MutexLock lock(&mu_);
+  clusterings_.clear();
+}
+
+void RequestPathClusteringUpdateUDA::Update(FunctionContext*, StringValue service,
+                                            StringValue request_path_str) {
+  if (stored_clustering_ == nullptr) {
+    service_ = std::move(service);
+    stored_clustering_ = RequestPathClusteringStore::GetInstance()->Get(service_);
+  }
+  if (!seen_request_paths_.insert(request_path_str).second) {
+    return;
+  }
+  auto request_path = RequestPath(std::move(request_path_str));
+  if (stored_clustering_->Covers(request_path)) {
+    return;
+  }
+  clustering_.Update(RequestPathCluster(request_path));
+}
+
+void RequestPathClusteringUpdateUDA::Merge(FunctionContext*,
+                                           const RequestPathClusteringUpdateUDA& other) {
+  if (service_.empty()) {
+    service_ = other.service_;
+  }
+  clustering_.Merge(other.clustering_);
+}
+
+StringValue RequestPathClusteringUpdateUDA::Finalize(FunctionContext*) {
+  if (service_.empty()) {
+    return clustering_.ToJSON();
+  }
+  return RequestPathClusteringStore::GetInstance()->Update(service_, clustering_)->ToJSON();
+}
+
+StringValue RequestPathClusteringUpdateUDA::Serialize(FunctionContext*) {
+  rapidjson::StringBuffer sb;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+  writer.StartObject();
+  writer.Key(kServiceKey);
+  writer.String(service_.data(), service_.size());
+  writer.Key(kClustersKey);
+  clustering_.ToJSON(&writer);
+  writer.EndObject();
+  return sb.GetString();
+}
+
+Status RequestPathClusteringUpdateUDA::Deserialize(FunctionContext*, const StringValue& data) {
+  rapidjson::Document d;
+  rapidjson::ParseResult ok = d.Parse(data.data());
+  if (ok == nullptr || !d.IsObject() || !d.HasMember(kServiceKey) || !d[kServiceKey].IsString() ||
+      !d.HasMember(kClustersKey)) {
+    return error::InvalidArgument(
+        "RequestPathClusteringUpdateUDA::Deserialize: expected object with service and clusters");
+  }
+  service_ = std::string(d[kServiceKey].GetString(), d[kServiceKey].GetStringLength());
+  PX_ASSIGN_OR_RETURN(clustering_, RequestPathClustering::FromJSON(d[kClustersKey]));
+  return Status::OK();
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
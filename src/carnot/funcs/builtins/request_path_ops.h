@@ -20,11 +20,16 @@
 #include <rapidjson/document.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include <absl/synchronization/mutex.h>
+
 #include "src/carnot/udf/registry.h"
 #include "src/shared/types/types.h"
 
@@ -83,6 +88,11 @@ class RequestPath {
    */
   bool Matches(const RequestPath& templ) const;
 
+  /**
+   * Same as RequestPath(request_path).Matches(templ), but without building the RequestPath.
+   */
+  static bool Matches(std::string_view request_path, const RequestPath& templ);
+
   template <typename H>
   friend H AbslHashValue(H h, const RequestPath& request_path) {
     return H::combine(std::move(h), request_path.ToString());
@@ -177,8 +187,10 @@ class RequestPathCluster {
 class RequestPathClustering {
  public:
   static StatusOr<RequestPathClustering> FromJSON(const std::string& json);
+  static StatusOr<RequestPathClustering> FromJSON(const rapidjson::Document::ValueType& doc);
 
   std::string ToJSON() const;
+  void ToJSON(rapidjson::Writer<rapidjson::StringBuffer>* writer) const;
 
   /**
    * @param request_path request path to get prediction for.
@@ -195,6 +207,13 @@ class RequestPathClustering {
 
   void Merge(const RequestPathClustering& other_clustering);
 
+  /**
+   * Returns whether the clustering already covers the request path, i.e. updating the clustering
+   * with it would not change the clustering. This is the case when the closest cluster has
+   * reached the minimum cardinality and its centroid matches the request path.
+   */
+  bool Covers(const RequestPath& request_path) const;
+
   const std::vector<RequestPathCluster>& clusters() const { return clusters_; }
 
  private:
@@ -207,6 +226,36 @@ class RequestPathClustering {
   double thresh_ = 0.5;
 };
 
+/**
+ * RequestPathClusteringStore keeps the request path clustering of each service in this process
+ * (PEM or Kelvin) across queries, so that a query only has to cluster the request paths that the
+ * stored clustering doesn't cover yet, instead of re-clustering all of them on every run.
+ */
+class RequestPathClusteringStore {
+ public:
+  static RequestPathClusteringStore* GetInstance();
+
+  /**
+   * Returns the stored clustering of the service. The clustering is never modified, updates
+   * replace it instead.
+   */
+  std::shared_ptr<const RequestPathClustering> Get(const std::string& service) const;
+
+  /**
+   * Merges the clustering into the stored clustering of the service.
+   * @return the updated clustering of the service.
+   */
+  std::shared_ptr<const RequestPathClustering> Update(const std::string& service,
+                                                      const RequestPathClustering& clustering);
+
+  void Clear();
+
+ private:
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<std::string, std::shared_ptr<const RequestPathClustering>> clusterings_
+      ABSL_GUARDED_BY(mu_);
+};
+
 class RequestPathClusteringPredictUDF : public udf::ScalarUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue request_path_str,
@@ -249,11 +298,48 @@ class RequestPathClusteringFitUDA : public udf::UDA {
   RequestPathClustering clustering_;
 };
 
+/**
+ * Incremental version of RequestPathClusteringFitUDA, meant to be grouped by service. The
+ * clustering of each service is kept in the RequestPathClusteringStore of the process that
+ * finalizes the UDA, and the request paths that it already covers, as well as repeated request
+ * paths, are skipped instead of being clustered again. Finalize merges the new clusters into the
+ * stored clustering, and returns the result.
+ */
+class RequestPathClusteringUpdateUDA : public udf::UDA {
+ public:
+  void Update(FunctionContext*, StringValue service, StringValue request_path_str);
+  void Merge(FunctionContext*, const RequestPathClusteringUpdateUDA& other);
+  StringValue Finalize(FunctionContext*);
+  StringValue Serialize(FunctionContext*);
+  Status Deserialize(FunctionContext*, const StringValue& data);
+
+ private:
+  inline static constexpr char kServiceKey[] = "s";
+  inline static constexpr char kClustersKey[] = "c";
+
+  std::string service_;
+  // The stored clustering of the service, when the first request path was added.
+  std::shared_ptr<const RequestPathClustering> stored_clustering_;
+  absl::flat_hash_set<std::string> seen_request_paths_;
+  RequestPathClustering clustering_;
+};
+
 class RequestPathEndpointMatcherUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, StringValue request_path, StringValue endpoint) {
-    return RequestPath(request_path).Matches(RequestPath(endpoint));
+    // The endpoint is almost always a constant, so it's only parsed when it changes.
+    if (!endpoint_init_ || endpoint != endpoint_str_) {
+      endpoint_ = RequestPath(endpoint);
+      endpoint_str_ = std::move(endpoint);
+      endpoint_init_ = true;
+    }
+    return RequestPath::Matches(request_path, endpoint_);
   }
+
+ private:
+  bool endpoint_init_ = false;
+  std::string endpoint_str_;
+  RequestPath endpoint_;
 };
 
 }  // namespace builtins
@@ -97,6 +97,78 @@ TEST(RequestPathEndpointMatcher, basic) {
   udf_tester.ForInput("/a/c/c", "/a/b/*").Expect(false);
 }
 
+TEST(RequestPathEndpointMatcher, changing_endpoints) {
+  auto udf_tester = udf::UDFTester<RequestPathEndpointMatcherUDF>();
+  udf_tester.ForInput("a/b/c?k=v", "/a/b/*").Expect(true);
+  udf_tester.ForInput("/a/b/c/d", "/a/b/*").Expect(false);
+  udf_tester.ForInput("/a/b", "/a/b/*").Expect(false);
+  udf_tester.ForInput("/a/b/c/d", "/a/*/c/d").Expect(true);
+  udf_tester.ForInput("/a/b/c/", "/a/*/c/d").Expect(false);
+  udf_tester.ForInput("/a/b/c/", "/a/*/c/").Expect(true);
+  udf_tester.ForInput("", "/").Expect(true);
+}
+
+TEST(RequestPathClusteringUpdate, reuses_stored_clustering) {
+  RequestPathClusteringStore::GetInstance()->Clear();
+  auto uda1 = udf::UDATester<RequestPathClusteringUpdateUDA>();
+  auto clustering1_or_s = RequestPathClustering::FromJSON(uda1.ForInput("svc", "/a/b/a")
+                                                              .ForInput("svc", "/a/b/b")
+                                                              .ForInput("svc", "/a/b/c")
+                                                              .ForInput("svc", "/a/b/c")
+                                                              .ForInput("svc", "/a/b/d")
+                                                              .ForInput("svc", "/a/b/e")
+                                                              .ForInput("svc", "/a/b/f")
+                                                              .ForInput("svc", "/c/d")
+                                                              .Result());
+  ASSERT_OK(clustering1_or_s);
+  EXPECT_THAT(clustering1_or_s.ConsumeValueOrDie(),
+              HasCentroids(std::vector<std::string>({"/a/b/*", "/c/d"})));
+
+  // A later query only adds the paths that aren't covered yet, the result includes the clusters
+  // of the earlier query.
+  auto uda2 = udf::UDATester<RequestPathClusteringUpdateUDA>();
+  auto clustering2_or_s = RequestPathClustering::FromJSON(
+      uda2.ForInput("svc", "/a/b/g").ForInput("svc", "/e/f/g").Result());
+  ASSERT_OK(clustering2_or_s);
+  EXPECT_THAT(clustering2_or_s.ConsumeValueOrDie(),
+              HasCentroids(std::vector<std::string>({"/a/b/*", "/c/d", "/e/f/g"})));
+
+  // Other services have their own clustering.
+  auto uda3 = udf::UDATester<RequestPathClusteringUpdateUDA>();
+  auto clustering3_or_s = RequestPathClustering::FromJSON(uda3.ForInput("svc2", "/a/b/g").Result());
+  ASSERT_OK(clustering3_or_s);
+  EXPECT_THAT(clustering3_or_s.ConsumeValueOrDie(),
+              HasCentroids(std::vector<std::string>({"/a/b/g"})));
+  RequestPathClusteringStore::GetInstance()->Clear();
+}
+
+TEST(RequestPathClusteringUpdate, serialization) {
+  RequestPathClusteringStore::GetInstance()->Clear();
+  auto uda = udf::UDATester<RequestPathClusteringUpdateUDA>();
+  uda.ForInput("svc", "/a/b/a").ForInput("svc", "/c/d");
+
+  RequestPathClusteringUpdateUDA other;
+  ASSERT_OK(other.Deserialize(nullptr, uda.Serialize()));
+  auto clustering_or_s = RequestPathClustering::FromJSON(other.Finalize(nullptr));
+  ASSERT_OK(clustering_or_s);
+  EXPECT_THAT(clustering_or_s.ConsumeValueOrDie(),
+              HasCentroids(std::vector<std::string>({"/a/b/a", "/c/d"})));
+  EXPECT_NOT_OK(other.Deserialize(nullptr, "[]"));
+  RequestPathClusteringStore::GetInstance()->Clear();
+}
+
+TEST(RequestPathClustering, covers) {
+  RequestPathClustering clustering;
+  for (const auto& path : {"/a/b/a", "/a/b/b", "/a/b/c", "/a/b/d", "/a/b/e", "/a/b/f", "/c/d"}) {
+    clustering.Update(RequestPathCluster(RequestPath(path)));
+  }
+  EXPECT_TRUE(clustering.Covers(RequestPath("/a/b/z")));
+  // Clusters that haven't reached the minimum cardinality don't cover their members.
+  EXPECT_FALSE(clustering.Covers(RequestPath("/c/d")));
+  EXPECT_FALSE(clustering.Covers(RequestPath("/a/c/z")));
+  EXPECT_FALSE(clustering.Covers(RequestPath("/a/b/z/y")));
+}
+
 // This tests the case where different PEMs have different clusterings of their own data, such that
 // at merge time some of the individual points in not yet fully formed clusters on one PEM should've
 // been clustered into one of the clusters on the other PEM. This should be handled by the logic in
@@ -54,8 +54,31 @@ void RegisterSQLOpsOrDie(udf::Registry* registry) {
    *****************************************/
 }
 
+template <typename TCmdCode, typename TNormalizeFn>
+static types::StringValue CachedNormalize(
+    LRUCache<std::pair<std::string, TCmdCode>, std::string>* cache, std::string sql_str,
+    TCmdCode cmd_code, TNormalizeFn normalize_fn) {
+  if (sql_str.size() > kMaxCachedSQLSize) {
+    return normalize_fn(sql_str, cmd_code);
+  }
+  auto key = std::make_pair(std::move(sql_str), std::move(cmd_code));
+  if (const auto* cached = cache->Get(key); cached != nullptr) {
+    return *cached;
+  }
+  types::StringValue result = normalize_fn(key.first, key.second);
+  cache->Put(key, result);
+  return result;
+}
+
 types::StringValue NormalizePostgresSQLUDF::Exec(FunctionContext*, StringValue sql_str,
                                                  StringValue cmd_code) {
+  return CachedNormalize<std::string>(
+      &cache_, std::move(sql_str), std::move(cmd_code),
+      [this](const std::string& sql, const std::string& code) { return Normalize(sql, code); });
+}
+
+types::StringValue NormalizePostgresSQLUDF::Normalize(const std::string& sql_str,
+                                                      const std::string& cmd_code) {
   std::string query;
   std::vector<std::string> param_values;
 
@@ -86,6 +109,12 @@ types::StringValue NormalizePostgresSQLUDF::Exec(FunctionContext*, StringValue s
 
 types::StringValue NormalizeMySQLUDF::Exec(FunctionContext*, StringValue sql_str,
                                            Int64Value cmd_code) {
+  return CachedNormalize<int64_t>(
+      &cache_, std::move(sql_str), cmd_code.val,
+      [this](const std::string& sql, int64_t code) { return Normalize(sql, code); });
+}
+
+types::StringValue NormalizeMySQLUDF::Normalize(const std::string& sql_str, int64_t cmd_code) {
   std::string query;
   std::vector<std::string> param_values;
 
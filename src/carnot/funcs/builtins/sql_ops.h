@@ -21,8 +21,10 @@
 #include <absl/strings/strip.h>
 #include <regex>
 #include <string>
+#include <utility>
 #include "src/carnot/funcs/builtins/sql_parsing/normalization.h"
 #include "src/carnot/udf/registry.h"
+#include "src/common/base/lru_cache.h"
 #include "src/common/base/status.h"
 #include "src/common/base/utils.h"
 #include "src/shared/types/types.h"
@@ -36,6 +38,12 @@ static constexpr char kPgQueryCmdCode[] = "Query";
 static constexpr int64_t kMySQLQueryCmdCode = 0x03;
 static constexpr int64_t kMySQLExecuteCmdCode = 0x17;
 
+// Applications send a small set of distinct statements over and over, so each UDF instance caches
+// the normalization of the most recently used ones. Long queries aren't cached, to bound the size
+// of the cache.
+static constexpr size_t kSQLNormalizationCacheSize = 512;
+static constexpr size_t kMaxCachedSQLSize = 2048;
+
 class NormalizePostgresSQLUDF : public udf::ScalarUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue sql_str, StringValue cmd_code);
@@ -62,6 +70,11 @@ class NormalizePostgresSQLUDF : public udf::ScalarUDF {
             "as JSON. Available keys: ['query', 'params', 'error']. Error will be non-empty if "
             "the query could not be normalized.");
   }
+
+ private:
+  StringValue Normalize(const std::string& sql_str, const std::string& cmd_code);
+
+  LRUCache<std::pair<std::string, std::string>, std::string> cache_{kSQLNormalizationCacheSize};
 };
 
 class NormalizeMySQLUDF : public udf::ScalarUDF {
@@ -91,6 +104,11 @@ class NormalizeMySQLUDF : public udf::ScalarUDF {
             "as JSON. Available keys: ['query', 'params', 'error']. Error will be non-empty if "
             "the query could not be normalized.");
   }
+
+ private:
+  StringValue Normalize(const std::string& sql_str, int64_t cmd_code);
+
+  LRUCache<std::pair<std::string, int64_t>, std::string> cache_{kSQLNormalizationCacheSize};
 };
 
 void RegisterSQLOpsOrDie(udf::Registry* registry);
@@ -199,6 +199,26 @@ TEST(NormMySQL, invalid_utf8) {
   udf_tester.ForInput(invalid, kMySQLQueryCmdCode).Expect(expected_result.ToJSON());
 }
 
+TEST(NormPGSQL, repeated_query) {
+  auto expected_result = NormalizeResult{
+      "SELECT * FROM test WHERE name=$1",
+      {"'abcd'"},
+  };
+  auto udf_tester = udf::UDFTester<NormalizePostgresSQLUDF>();
+  for (int i = 0; i < 3; ++i) {
+    udf_tester.ForInput("SELECT * FROM test WHERE name='abcd'", kPgQueryCmdCode)
+        .Expect(expected_result.ToJSON());
+  }
+}
+
+TEST(NormMySQL, repeated_query_with_different_cmd_code) {
+  auto udf_tester = udf::UDFTester<NormalizeMySQLUDF>();
+  udf_tester.ForInput("SELECT * FROM test WHERE name='abcd'", kMySQLQueryCmdCode)
+      .Expect(NormalizeResult{"SELECT * FROM test WHERE name=?", {"'abcd'"}}.ToJSON());
+  udf_tester.ForInput("SELECT * FROM test WHERE name='abcd'", 0)
+      .Expect(NormalizeResult{"", {}, "cmd_code must be one of '3' or '23'"}.ToJSON());
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
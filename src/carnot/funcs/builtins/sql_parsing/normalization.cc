@@ -18,6 +18,9 @@
 
 #include <string>
 
+#include <absl/strings/ascii.h>
+#include <absl/strings/match.h>
+
 #include "mysql_parser/MySQLLexer.h"
 #include "mysql_parser/MySQLParser.h"
 #include "pgsql_parser/PostgresSQLLexer.h"
@@ -116,6 +119,38 @@ NormalizeResult NormalizeResult::FromJSON(std::string json_str) {
   return result;
 }
 
+bool CannotContainConstants(std::string_view sql) {
+  size_t word_start = 0;
+  for (size_t i = 0; i <= sql.size(); ++i) {
+    // Treat the end of the query as a separator, to check the last word.
+    char c = i < sql.size() ? sql[i] : ' ';
+    if (!absl::ascii_isascii(c) || absl::ascii_isdigit(c)) {
+      return false;
+    }
+    switch (c) {
+      case '\'':
+      case '"':
+      case '$':
+      case '?':
+      case '@':
+      case '\\':
+        return false;
+      default:
+        break;
+    }
+    if (absl::ascii_isalpha(c) || c == '_') {
+      continue;
+    }
+    std::string_view word = sql.substr(word_start, i - word_start);
+    if (absl::EqualsIgnoreCase(word, "TRUE") || absl::EqualsIgnoreCase(word, "FALSE") ||
+        absl::EqualsIgnoreCase(word, "NULL")) {
+      return false;
+    }
+    word_start = i + 1;
+  }
+  return true;
+}
+
 void SQLFragmentHandler::ReplaceFragmentWithPlaceholder(const SQLFragment& fragment,
                                                         absl::string_view placeholder) {
   result_->normalized_query.replace(state_->line_start_offsets[fragment.line - 1] +
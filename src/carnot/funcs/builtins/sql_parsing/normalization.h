@@ -33,6 +33,7 @@
 #include <numeric>
 #include <ostream>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -218,6 +219,14 @@ class ConstantFragmentHandler : public SQLFragmentHandler {
   }
 };
 
+/**
+ * Returns whether the query can't contain any constants or parameter placeholders, in which case
+ * normalizing it leaves it as is. This is a conservative character scan: any digit, quote,
+ * placeholder character, backslash, non-ASCII character or TRUE/FALSE/NULL keyword means the query
+ * has to be parsed. Statements such as BEGIN, COMMIT or SELECT * FROM x take this path.
+ */
+bool CannotContainConstants(std::string_view sql);
+
 /**
  * normalize_sql replaces table names and constants in a sql query with placeholders, inplace.
  * @param sql: Unnormalized SQL query.
@@ -229,6 +238,13 @@ class ConstantFragmentHandler : public SQLFragmentHandler {
 template <typename TParser, typename TLexer, typename TCharStream = antlr4::ANTLRInputStream>
 StatusOr<NormalizeResult> normalize_sql(std::string sql,
                                         const std::vector<std::string>& param_values) {
+  if (CannotContainConstants(sql)) {
+    // Skip the lexer and parser, they can't find anything to replace.
+    NormalizeResult result;
+    result.normalized_query = std::move(sql);
+    return result;
+  }
+
   AntlrParser<TParser, TLexer, TCharStream> parser(sql);
   ParserRuleFragmentListener listener({ParserTypeTraits<TParser>::constant_rule_index,
                                        ParserTypeTraits<TParser>::param_placeholder_rule_index},
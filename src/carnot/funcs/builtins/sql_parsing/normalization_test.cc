@@ -237,6 +237,19 @@ INSTANTIATE_TEST_SUITE_P(
             },
         }));
 
+TEST(CannotContainConstants, basic) {
+  EXPECT_TRUE(CannotContainConstants("BEGIN;"));
+  EXPECT_TRUE(CannotContainConstants("SELECT * FROM test"));
+  EXPECT_TRUE(CannotContainConstants("SELECT nullable_col FROM test_true"));
+
+  EXPECT_FALSE(CannotContainConstants("SELECT 1"));
+  EXPECT_FALSE(CannotContainConstants("SELECT * FROM test WHERE name='abcd'"));
+  EXPECT_FALSE(CannotContainConstants("SELECT * FROM test WHERE name=$1"));
+  EXPECT_FALSE(CannotContainConstants("SELECT * FROM test WHERE name IS null"));
+  EXPECT_FALSE(CannotContainConstants("UPDATE test SET flag=TRUE"));
+  EXPECT_FALSE(CannotContainConstants("SELECT * FROM caf\xc3\xa9"));
+}
+
 }  // namespace sql_parsing
 }  // namespace builtins
 }  // namespace carnot
@@ -17,6 +17,13 @@
  */
 
 #include "src/carnot/funcs/builtins/string_ops.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <emmintrin.h>
+#endif
+
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/base.h"
 
@@ -24,6 +31,57 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
+namespace internal {
+
+size_t FindSubstring(std::string_view haystack, std::string_view needle) {
+#if defined(__x86_64__)
+  // SSE2 is part of x86_64, so this needs no runtime dispatch.
+  constexpr size_t kBlockSize = sizeof(__m128i);
+  const size_t n = needle.size();
+  if (n < 2) {
+    return haystack.find(needle);
+  }
+  const __m128i first = _mm_set1_epi8(needle.front());
+  const __m128i last = _mm_set1_epi8(needle.back());
+  const char* data = haystack.data();
+  size_t pos = 0;
+  // Checks the needle at the kBlockSize starting positions from pos.
+  for (; pos + n - 1 + kBlockSize <= haystack.size(); pos += kBlockSize) {
+    __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+    __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + n - 1));
+    uint32_t mask = _mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last)));
+    while (mask != 0) {
+      size_t start = pos + __builtin_ctz(mask);
+      if (std::memcmp(data + start + 1, needle.data() + 1, n - 2) == 0) {
+        return start;
+      }
+      mask &= mask - 1;
+    }
+  }
+  size_t tail_pos = haystack.substr(pos).find(needle);
+  return tail_pos == std::string_view::npos ? tail_pos : pos + tail_pos;
+#else
+  return haystack.find(needle);
+#endif
+}
+
+void ToLowerASCII(std::string_view in, char* out) {
+  for (size_t i = 0; i < in.size(); ++i) {
+    char c = in[i];
+    out[i] = static_cast<char>(c + (static_cast<unsigned char>(c - 'A') < 26 ? 'a' - 'A' : 0));
+  }
+}
+
+void ToUpperASCII(std::string_view in, char* out) {
+  for (size_t i = 0; i < in.size(); ++i) {
+    char c = in[i];
+    out[i] = static_cast<char>(c - (static_cast<unsigned char>(c - 'a') < 26 ? 'a' - 'A' : 0));
+  }
+}
+
+}  // namespace internal
+
 void RegisterStringOpsOrDie(udf::Registry* registry) {
   CHECK(registry != nullptr);
   /*****************************************
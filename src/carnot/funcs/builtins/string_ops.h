@@ -18,9 +18,11 @@
 
 #pragma once
 
+#include <absl/strings/ascii.h>
 #include <absl/strings/strip.h>
 #include <algorithm>
 #include <string>
+#include <string_view>
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/utils.h"
 #include "src/shared/types/types.h"
@@ -29,11 +31,35 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
+namespace internal {
+/**
+ * Returns the index of the first occurrence of needle in haystack, or std::string_view::npos.
+ * On x86_64 it compares the first and the last byte of the needle against 16 positions of the
+ * haystack at once and only compares the whole needle at the positions where both match.
+ */
+size_t FindSubstring(std::string_view haystack, std::string_view needle);
+
+// Writes the lowercase/uppercase of the ascii letters of in to out, which can be in.data(). Other
+// bytes are copied as is, like ::tolower and ::toupper in the "C" locale. Unlike them the loop
+// has no calls, so that it can be vectorized.
+void ToLowerASCII(std::string_view in, char* out);
+void ToUpperASCII(std::string_view in, char* out);
+}  // namespace internal
+
 class ContainsUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, StringValue b1, StringValue b2) {
     return absl::StrContains(b1, b2);
   }
+  // The needle is nearly always a constant, e.g. px.contains(df.req_path, '/api/'). The batch
+  // version doesn't copy both strings of every record and uses the vectorized search.
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<StringValue>& b1,
+                   const udf::ColumnView<StringValue>& b2, udf::OutputColumn<BoolValue>* out) {
+    for (size_t idx = 0; idx < out->size(); ++idx) {
+      (*out)[idx] = internal::FindSubstring(b1[idx], b2[idx]) != std::string_view::npos;
+    }
+    return Status::OK();
+  }
 
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns whether the first string contains the second string.")
@@ -47,6 +73,11 @@ class ContainsUDF : public udf::ScalarUDF {
 class LengthUDF : public udf::ScalarUDF {
  public:
   Int64Value Exec(FunctionContext*, StringValue b1) { return b1.length(); }
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<StringValue>& b1,
+                   udf::OutputColumn<Int64Value>* out) {
+    return udf::ExecBatchElementwise(
+        out, [](const StringValue& s) -> Int64Value { return s.length(); }, b1);
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns the length of the string")
         .Example(R"doc(df.service = 'checkout'
@@ -62,6 +93,14 @@ class FindUDF : public udf::ScalarUDF {
   Int64Value Exec(FunctionContext*, StringValue src, StringValue substr) {
     return src.find(substr);
   }
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<StringValue>& src,
+                   const udf::ColumnView<StringValue>& substr, udf::OutputColumn<Int64Value>* out) {
+    for (size_t idx = 0; idx < out->size(); ++idx) {
+      // npos converts to -1, same as Exec.
+      (*out)[idx] = static_cast<int64_t>(internal::FindSubstring(src[idx], substr[idx]));
+    }
+    return Status::OK();
+  }
 
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Find the index of the first occurrence of the substring.")
@@ -85,6 +124,22 @@ class SubstringUDF : public udf::ScalarUDF {
     }
     return b1.substr(static_cast<size_t>(pos.val), static_cast<size_t>(length.val));
   }
+  // The batch versions of the string UDFs assign to the strings of the output column, which are
+  // recycled across batches, so they usually don't allocate.
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<StringValue>& b1,
+                   const udf::ColumnView<Int64Value>& pos,
+                   const udf::ColumnView<Int64Value>& length,
+                   udf::OutputColumn<StringValue>* out) {
+    for (size_t idx = 0; idx < out->size(); ++idx) {
+      if (pos[idx] < 0 || pos[idx] > static_cast<int64_t>(b1[idx].length()) || length[idx] < 0) {
+        (*out)[idx].clear();
+        continue;
+      }
+      (*out)[idx].assign(b1[idx], static_cast<size_t>(pos[idx].val),
+                         static_cast<size_t>(length[idx].val));
+    }
+    return Status::OK();
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns the specified substring from the string")
         .Details(
@@ -105,9 +160,17 @@ class SubstringUDF : public udf::ScalarUDF {
 class ToLowerUDF : public udf::ScalarUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue b1) {
-    transform(b1.begin(), b1.end(), b1.begin(), ::tolower);
+    internal::ToLowerASCII(b1, b1.data());
     return b1;
   }
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<StringValue>& b1,
+                   udf::OutputColumn<StringValue>* out) {
+    for (size_t idx = 0; idx < out->size(); ++idx) {
+      (*out)[idx].resize(b1[idx].size());
+      internal::ToLowerASCII(b1[idx], (*out)[idx].data());
+    }
+    return Status::OK();
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Transforms all uppercase ascii characters in the string to lowercase.")
@@ -122,9 +185,17 @@ class ToLowerUDF : public udf::ScalarUDF {
 class ToUpperUDF : public udf::ScalarUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue b1) {
-    transform(b1.begin(), b1.end(), b1.begin(), ::toupper);
+    internal::ToUpperASCII(b1, b1.data());
     return b1;
   }
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<StringValue>& b1,
+                   udf::OutputColumn<StringValue>* out) {
+    for (size_t idx = 0; idx < out->size(); ++idx) {
+      (*out)[idx].resize(b1[idx].size());
+      internal::ToUpperASCII(b1[idx], (*out)[idx].data());
+    }
+    return Status::OK();
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Transforms all lowercase ascii characters in the string to uppercase.")
@@ -143,6 +214,14 @@ class TrimUDF : public udf::ScalarUDF {
     absl::StripAsciiWhitespace(&val);
     return val;
   }
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<StringValue>& s,
+                   udf::OutputColumn<StringValue>* out) {
+    for (size_t idx = 0; idx < out->size(); ++idx) {
+      std::string_view trimmed = absl::StripAsciiWhitespace(std::string_view(s[idx]));
+      (*out)[idx].assign(trimmed.data(), trimmed.size());
+    }
+    return Status::OK();
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Trim ascii whitespace from before and after the string content.")
@@ -162,6 +241,14 @@ class StripPrefixUDF : public udf::ScalarUDF {
   StringValue Exec(FunctionContext*, StringValue prefix, StringValue s) {
     return StringValue(absl::StripPrefix(s, prefix));
   }
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<StringValue>& prefix,
+                   const udf::ColumnView<StringValue>& s, udf::OutputColumn<StringValue>* out) {
+    for (size_t idx = 0; idx < out->size(); ++idx) {
+      std::string_view stripped = absl::StripPrefix(s[idx], prefix[idx]);
+      (*out)[idx].assign(stripped.data(), stripped.size());
+    }
+    return Status::OK();
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Strips the specified prefix from the string.")
         .Details(
@@ -18,6 +18,8 @@
 
 #include <gtest/gtest.h>
 #include <numeric>
+#include <string>
+#include <string_view>
 #include <type_traits>
 #include <vector>
 
@@ -33,6 +35,20 @@ TEST(StringOps, basic_string_contains_test) {
   auto udf_tester = udf::UDFTester<ContainsUDF>();
   udf_tester.ForInput("apple", "pl").Expect(true);
   udf_tester.ForInput("apple", "z").Expect(false);
+  udf_tester.ForInput("apple", "").Expect(true);
+  udf_tester.ForInput("GET /api/v1/users/1234/orders?limit=10", "/api/").Expect(true);
+  udf_tester.ForInput("GET /healthz HTTP/1.1 from kube-probe/1.27", "/api/").Expect(false);
+}
+
+TEST(StringOps, find_substring_matches_string_find) {
+  std::string haystack = "GET /apx/v1/ap/api/users/1234/orders/api?limit=10&offset=/api/";
+  for (std::string needle : {"", "G", "/", "/api/", "api?", "/api/users/1234/orders", "zzz",
+                             "/api/ ", haystack}) {
+    for (size_t start = 0; start <= haystack.size(); ++start) {
+      std::string_view h = std::string_view(haystack).substr(start);
+      EXPECT_EQ(internal::FindSubstring(h, needle), h.find(needle)) << h << " " << needle;
+    }
+  }
 }
 
 TEST(StringOps, basic_string_length_test) {
@@ -67,11 +83,13 @@ TEST(StringOps, substring_edge_cases) {
 TEST(StringOps, basic_string_tolower_test) {
   auto udf_tester = udf::UDFTester<ToLowerUDF>();
   udf_tester.ForInput("pIXiE").Expect("pixie");
+  udf_tester.ForInput("@[`{ AZ az \xc3\x89").Expect("@[`{ az az \xc3\x89");
 }
 
 TEST(StringOps, basic_string_toupper_test) {
   auto udf_tester = udf::UDFTester<ToUpperUDF>();
   udf_tester.ForInput("pIXiE").Expect("PIXIE");
+  udf_tester.ForInput("@[`{ AZ az \xc3\xa9").Expect("@[`{ AZ AZ \xc3\xa9");
 }
 
 TEST(StringOps, basic_string_trim_test) {
@@ -111,6 +111,13 @@ class PodIDToPodNameUDF : public ScalarUDF {
 
     return "";
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_id);
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<PodIDToPodNameUDF>(types::ST_POD_NAME, {types::ST_NONE})};
   }
@@ -135,6 +142,12 @@ class PodIDToPodLabelsUDF : public ScalarUDF {
     return "";
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_id);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get labels of a pod from its pod ID.")
         .Details("Gets the kubernetes pod labels for the pod from its pod ID.")
@@ -151,6 +164,12 @@ class PodNameToPodIDUDF : public ScalarUDF {
     return GetPodID(md, pod_name);
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_name);
+  }
+
   static StringValue GetPodID(const px::md::AgentMetadataState* md, StringValue pod_name) {
     // This UDF expects the pod name to be in the format of "<ns>/<pod-name>".
     PX_ASSIGN_OR(auto pod_name_view, internal::K8sName(pod_name), return "");
@@ -179,6 +198,12 @@ class PodNameToPodIPUDF : public ScalarUDF {
     return pod_info->pod_ip();
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_name);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the IP address of a pod from its name.")
         .Details("Gets the IP address for the pod from its name.")
@@ -200,6 +225,13 @@ class PodIDToNamespaceUDF : public ScalarUDF {
 
     return "";
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_id);
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
         udf::ExplicitRule::Create<PodIDToNamespaceUDF>(types::ST_NAMESPACE_NAME, {types::ST_NONE})};
@@ -221,6 +253,12 @@ class PodNameToNamespaceUDF : public ScalarUDF {
     return std::string(k8s_name_view.first);
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_name);
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<PodNameToNamespaceUDF>(types::ST_NAMESPACE_NAME,
                                                              {types::ST_NONE})};
@@ -248,6 +286,12 @@ class UPIDToContainerIDUDF : public ScalarUDF {
     return pid->cid();
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<UInt128Value>& upid_value,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        &memo_, out, [this, ctx](const UInt128Value& val) { return Exec(ctx, val); }, upid_value);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Kubernetes container ID from a UPID.")
         .Details(
@@ -262,6 +306,9 @@ class UPIDToContainerIDUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+ private:
+  udf::UPIDMemo<StringValue> memo_;
 };
 
 inline const md::ContainerInfo* UPIDToContainer(const px::md::AgentMetadataState* md,
@@ -286,6 +333,12 @@ class UPIDToContainerNameUDF : public ScalarUDF {
     return std::string(container_info->name());
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<UInt128Value>& upid_value,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        &memo_, out, [this, ctx](const UInt128Value& val) { return Exec(ctx, val); }, upid_value);
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<UPIDToContainerNameUDF>(types::ST_CONTAINER_NAME,
                                                               {types::ST_NONE})};
@@ -305,6 +358,9 @@ class UPIDToContainerNameUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+ private:
+  udf::UPIDMemo<StringValue> memo_;
 };
 
 inline const px::md::PodInfo* UPIDtoPod(const px::md::AgentMetadataState* md,
@@ -328,6 +384,12 @@ class UPIDToNamespaceUDF : public ScalarUDF {
     return pod_info->ns();
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<UInt128Value>& upid_value,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        &memo_, out, [this, ctx](const UInt128Value& val) { return Exec(ctx, val); }, upid_value);
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
         udf::ExplicitRule::Create<UPIDToNamespaceUDF>(types::ST_NAMESPACE_NAME, {types::ST_NONE})};
@@ -347,6 +409,9 @@ class UPIDToNamespaceUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+ private:
+  udf::UPIDMemo<StringValue> memo_;
 };
 
 class UPIDToPodIDUDF : public ScalarUDF {
@@ -360,6 +425,12 @@ class UPIDToPodIDUDF : public ScalarUDF {
     return std::string(container_info->pod_id());
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<UInt128Value>& upid_value,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        &memo_, out, [this, ctx](const UInt128Value& val) { return Exec(ctx, val); }, upid_value);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Kubernetes Pod ID from a UPID.")
         .Details(
@@ -374,6 +445,9 @@ class UPIDToPodIDUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+ private:
+  udf::UPIDMemo<StringValue> memo_;
 };
 
 class UPIDToPodNameUDF : public ScalarUDF {
@@ -387,6 +461,12 @@ class UPIDToPodNameUDF : public ScalarUDF {
     return absl::Substitute("$0/$1", pod_info->ns(), pod_info->name());
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<UInt128Value>& upid_value,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        &memo_, out, [this, ctx](const UInt128Value& val) { return Exec(ctx, val); }, upid_value);
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<UPIDToPodNameUDF>(types::ST_POD_NAME, {types::ST_NONE})};
   }
@@ -405,6 +485,9 @@ class UPIDToPodNameUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+ private:
+  udf::UPIDMemo<StringValue> memo_;
 };
 
 class ServiceIDToServiceNameUDF : public ScalarUDF {
@@ -419,6 +502,13 @@ class ServiceIDToServiceNameUDF : public ScalarUDF {
 
     return "";
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& service_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, service_id);
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<ServiceIDToServiceNameUDF>(types::ST_SERVICE_NAME,
                                                                  {types::ST_NONE})};
@@ -445,6 +535,13 @@ class ServiceIDToClusterIPUDF : public ScalarUDF {
     }
     return "";
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& service_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, service_id);
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
         udf::ExplicitRule::Create<ServiceIDToClusterIPUDF>(types::ST_IP_ADDRESS, {types::ST_NONE})};
@@ -470,6 +567,13 @@ class ServiceIDToExternalIPsUDF : public ScalarUDF {
     }
     return "";
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& service_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, service_id);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Convert the Kubernetes service ID to its external IP addresses.")
@@ -492,6 +596,13 @@ class ServiceNameToServiceIDUDF : public ScalarUDF {
     auto service_id = md->k8s_metadata_state().ServiceIDByName(service_name_view);
     return service_id;
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& service_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, service_name);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Convert the service name to the service ID.")
         .Details(
@@ -514,6 +625,12 @@ class ServiceNameToNamespaceUDF : public ScalarUDF {
     return std::string(service_name_view.first);
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& service_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, service_name);
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<ServiceNameToNamespaceUDF>(types::ST_NAMESPACE_NAME,
                                                                  {types::ST_NONE})};
@@ -557,6 +674,12 @@ class UPIDToServiceIDUDF : public ScalarUDF {
     return StringifyVector(running_service_ids);
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<UInt128Value>& upid_value,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        &memo_, out, [this, ctx](const UInt128Value& val) { return Exec(ctx, val); }, upid_value);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Service ID from a UPID.")
         .Details(
@@ -572,6 +695,9 @@ class UPIDToServiceIDUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+ private:
+  udf::UPIDMemo<StringValue> memo_;
 };
 
 /**
@@ -598,6 +724,13 @@ class UPIDToServiceNameUDF : public ScalarUDF {
     }
     return StringifyVector(running_service_names);
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<UInt128Value>& upid_value,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        &memo_, out, [this, ctx](const UInt128Value& val) { return Exec(ctx, val); }, upid_value);
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
         udf::ExplicitRule::Create<UPIDToServiceNameUDF>(types::ST_SERVICE_NAME, {types::ST_NONE})};
@@ -618,6 +751,9 @@ class UPIDToServiceNameUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+ private:
+  udf::UPIDMemo<StringValue> memo_;
 };
 
 /**
@@ -634,6 +770,13 @@ class UPIDToNodeNameUDF : public ScalarUDF {
     std::string foo = std::string(pod_info->node_name());
     return foo;
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<UInt128Value>& upid_value,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        &memo_, out, [this, ctx](const UInt128Value& val) { return Exec(ctx, val); }, upid_value);
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<UPIDToNodeNameUDF>(types::ST_NODE_NAME, {types::ST_NONE})};
   }
@@ -650,6 +793,9 @@ class UPIDToNodeNameUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+ private:
+  udf::UPIDMemo<StringValue> memo_;
 };
 
 /**
@@ -807,6 +953,12 @@ class ReplicaSetIDToReplicaSetNameUDF : public ScalarUDF {
     return absl::Substitute("$0/$1", rs_info->ns(), rs_info->name());
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& replica_set_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, replica_set_id);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Replica Set Name from a Replica Set ID.")
         .Details(
@@ -882,6 +1034,12 @@ class ReplicaSetIDToNamespaceUDF : public ScalarUDF {
     return rs_info->ns();
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& replica_set_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, replica_set_id);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the namespace of a Replica Set from its ID.")
         .Details("Gets the namespace of a Replica Set from its ID.")
@@ -911,6 +1069,12 @@ class ReplicaSetIDToOwnerReferencesUDF : public ScalarUDF {
     return VectorToStringArray(owner_references);
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& replica_set_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, replica_set_id);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the owner references of a Replica Set from its ID.")
         .Details("Gets the owner references of a Replica Set from its ID.")
@@ -936,6 +1100,12 @@ class ReplicaSetIDToStatusUDF : public ScalarUDF {
     return ReplicaSetInfoToStatus(rs_info);
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& replica_set_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, replica_set_id);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the status of a Replica Set from its ID.")
         .Details("Gets the status of a Replica Set from its ID.")
@@ -965,6 +1135,12 @@ class ReplicaSetIDToDeploymentNameUDF : public ScalarUDF {
     return absl::Substitute("$0/$1", dep_info->ns(), dep_info->name());
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& replica_set_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, replica_set_id);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Deployment name of a Replica Set from its ID.")
         .Details("Gets the Deployment name of a Replica Set from its ID.")
@@ -995,6 +1171,12 @@ class ReplicaSetIDToDeploymentIDUDF : public ScalarUDF {
     return dep_info->uid();
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& replica_set_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, replica_set_id);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Deployment ID of a Replica Set from its ID.")
         .Details("Gets the Deployment ID of a Replica Set from its ID.")
@@ -1020,6 +1202,12 @@ class ReplicaSetNameToReplicaSetIDUDF : public ScalarUDF {
     return replica_set_id;
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& replica_set_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, replica_set_name);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Replica Set ID from a Replica Set name.")
         .Details(
@@ -1116,6 +1304,12 @@ class ReplicaSetNameToNamespaceUDF : public ScalarUDF {
     return rs_info->ns();
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& replica_set_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, replica_set_name);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the namespace of a Replica Set from its name.")
         .Details("Gets the namespace of a Replica Set from its name.")
@@ -1152,6 +1346,12 @@ class ReplicaSetNameToOwnerReferencesUDF : public ScalarUDF {
     return VectorToStringArray(owner_references);
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& replica_set_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, replica_set_name);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the owner references of a Replica Set from its name.")
         .Details("Gets the owner references of a Replica Set from its name.")
@@ -1183,6 +1383,12 @@ class ReplicaSetNameToStatusUDF : public ScalarUDF {
     return ReplicaSetInfoToStatus(rs_info);
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& replica_set_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, replica_set_name);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the status of a Replica Set from its name.")
         .Details("Gets the status of a Replica Set from its name.")
@@ -1219,6 +1425,12 @@ class ReplicaSetNameToDeploymentNameUDF : public ScalarUDF {
     return absl::Substitute("$0/$1", dep_info->ns(), dep_info->name());
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& replica_set_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, replica_set_name);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Deployment name of a Replica Set from its name.")
         .Details("Gets the Deployment name of a Replica Set from its name.")
@@ -1254,6 +1466,12 @@ class ReplicaSetNameToDeploymentIDUDF : public ScalarUDF {
     return dep_info->uid();
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& replica_set_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, replica_set_name);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Deployment ID of a Replica Set from its name.")
         .Details("Gets the Deployment ID of a Replica Set from its name.")
@@ -1279,6 +1497,12 @@ class DeploymentIDToDeploymentNameUDF : public ScalarUDF {
     return absl::Substitute("$0/$1", dep_info->ns(), dep_info->name());
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& deployment_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, deployment_id);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Deployment Name from a Deployment ID.")
         .Details(
@@ -1353,6 +1577,12 @@ class DeploymentIDToNamespaceUDF : public ScalarUDF {
     return dep_info->ns();
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& deployment_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, deployment_id);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the namespace of a Deployment from its ID.")
         .Details("Gets the namespace of a Deployment from its ID.")
@@ -1377,6 +1607,12 @@ class DeploymentIDToStatusUDF : public ScalarUDF {
     return DeploymentInfoToStatus(dep_info);
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& deployment_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, deployment_id);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the status of a Deployment from its ID.")
         .Details("Gets the status of a Deployment from its ID.")
@@ -1401,6 +1637,12 @@ class DeploymentNameToDeploymentIDUDF : public ScalarUDF {
     return deployment_id;
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& deployment_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, deployment_name);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Deployment ID from a Deployment name.")
         .Details(
@@ -1497,6 +1739,12 @@ class DeploymentNameToNamespaceUDF : public ScalarUDF {
     return dep_info->ns();
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& deployment_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, deployment_name);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the namespace of a Deployment from its name.")
         .Details("Gets the namespace of a Deployment from its name.")
@@ -1528,6 +1776,12 @@ class DeploymentNameToStatusUDF : public ScalarUDF {
     return DeploymentInfoToStatus(dep_info);
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& deployment_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, deployment_name);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the status of a Deployment from its name.")
         .Details("Gets the status of a Deployment from its name.")
@@ -1563,6 +1817,12 @@ class UPIDToReplicaSetNameUDF : public ScalarUDF {
     return absl::Substitute("$0/$1", rs_info->ns(), rs_info->name());
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<UInt128Value>& upid_value,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        &memo_, out, [this, ctx](const UInt128Value& val) { return Exec(ctx, val); }, upid_value);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Replica Set Name from a UPID.")
         .Details(
@@ -1578,6 +1838,9 @@ class UPIDToReplicaSetNameUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+ private:
+  udf::UPIDMemo<StringValue> memo_;
 };
 
 /**
@@ -1603,6 +1866,12 @@ class UPIDToReplicaSetIDUDF : public ScalarUDF {
     return rs_info->uid();
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<UInt128Value>& upid_value,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        &memo_, out, [this, ctx](const UInt128Value& val) { return Exec(ctx, val); }, upid_value);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Replica Set ID from a UPID.")
         .Details(
@@ -1618,6 +1887,9 @@ class UPIDToReplicaSetIDUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+ private:
+  udf::UPIDMemo<StringValue> memo_;
 };
 
 /**
@@ -1640,6 +1912,12 @@ class UPIDToReplicaSetStatusUDF : public ScalarUDF {
     return ReplicaSetInfoToStatus(rs_info);
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<UInt128Value>& upid_value,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        &memo_, out, [this, ctx](const UInt128Value& val) { return Exec(ctx, val); }, upid_value);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Replica Set Status from a UPID.")
         .Details(
@@ -1656,6 +1934,9 @@ class UPIDToReplicaSetStatusUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+ private:
+  udf::UPIDMemo<StringValue> memo_;
 };
 
 /**
@@ -1687,6 +1968,12 @@ class UPIDToDeploymentNameUDF : public ScalarUDF {
     return absl::Substitute("$0/$1", dep_info->ns(), dep_info->name());
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<UInt128Value>& upid_value,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        &memo_, out, [this, ctx](const UInt128Value& val) { return Exec(ctx, val); }, upid_value);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Deployment Name from a UPID.")
         .Details(
@@ -1702,6 +1989,9 @@ class UPIDToDeploymentNameUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+ private:
+  udf::UPIDMemo<StringValue> memo_;
 };
 
 /**
@@ -1732,6 +2022,12 @@ class UPIDToDeploymentIDUDF : public ScalarUDF {
     return dep_info->uid();
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<UInt128Value>& upid_value,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        &memo_, out, [this, ctx](const UInt128Value& val) { return Exec(ctx, val); }, upid_value);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Deployment ID from a UPID.")
         .Details(
@@ -1747,6 +2043,9 @@ class UPIDToDeploymentIDUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+ private:
+  udf::UPIDMemo<StringValue> memo_;
 };
 
 /**
@@ -1762,6 +2061,13 @@ class UPIDToHostnameUDF : public ScalarUDF {
     }
     return pod_info->hostname();
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<UInt128Value>& upid_value,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        &memo_, out, [this, ctx](const UInt128Value& val) { return Exec(ctx, val); }, upid_value);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Hostname from a UPID.")
         .Details(
@@ -1775,6 +2081,9 @@ class UPIDToHostnameUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+ private:
+  udf::UPIDMemo<StringValue> memo_;
 };
 
 /**
@@ -1803,6 +2112,13 @@ class PodIDToServiceNameUDF : public ScalarUDF {
     }
     return StringifyVector(running_service_names);
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_id);
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
         udf::ExplicitRule::Create<PodIDToServiceNameUDF>(types::ST_SERVICE_NAME, {types::ST_NONE})};
@@ -1844,6 +2160,13 @@ class PodIDToServiceIDUDF : public ScalarUDF {
     }
     return StringifyVector(running_service_ids);
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_id);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the service ID for a given pod ID.")
         .Details(
@@ -1874,6 +2197,13 @@ class PodIDToOwnerReferencesUDF : public ScalarUDF {
     }
     return VectorToStringArray(owner_references);
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_id);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the owner references for a given pod ID.")
         .Details(
@@ -1905,6 +2235,13 @@ class PodNameToOwnerReferencesUDF : public ScalarUDF {
     }
     return VectorToStringArray(owner_references);
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_name);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the owner references for a given pod name.")
         .Details(
@@ -1931,6 +2268,13 @@ class PodIDToNodeNameUDF : public ScalarUDF {
     std::string foo = std::string(pod_info->node_name());
     return foo;
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_id);
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<PodIDToNodeNameUDF>(types::ST_NODE_NAME, {types::ST_NONE})};
   }
@@ -1966,6 +2310,12 @@ class PodIDToReplicaSetNameUDF : public ScalarUDF {
     return absl::Substitute("$0/$1", rs_info->ns(), rs_info->name());
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_id);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Get the name of the Replica Set which controls the pod with pod ID.")
@@ -1999,6 +2349,12 @@ class PodIDToReplicaSetIDUDF : public ScalarUDF {
     return rs_info->uid();
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_id);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Get the ID of the Replica Set which controls the pod with pod ID.")
@@ -2037,6 +2393,12 @@ class PodIDToDeploymentNameUDF : public ScalarUDF {
     return absl::Substitute("$0/$1", dep_info->ns(), dep_info->name());
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_id);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Get the name of the Deployment which controls the pod with pod ID.")
@@ -2075,6 +2437,12 @@ class PodIDToDeploymentIDUDF : public ScalarUDF {
     return dep_info->uid();
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_id);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Get the ID of the Deployment which controls the pod with pod ID.")
@@ -2111,6 +2479,13 @@ class PodNameToReplicaSetNameUDF : public ScalarUDF {
 
     return absl::Substitute("$0/$1", rs_info->ns(), rs_info->name());
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_name);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Get the name of the Replica Set which controls the pod with the specified pod "
@@ -2149,6 +2524,13 @@ class PodNameToReplicaSetIDUDF : public ScalarUDF {
 
     return rs_info->uid();
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_name);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Get the ID of the Replica Set which controls the pod with the specified pod "
@@ -2192,6 +2574,13 @@ class PodNameToDeploymentNameUDF : public ScalarUDF {
 
     return absl::Substitute("$0/$1", dep_info->ns(), dep_info->name());
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_name);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Get the name of the Deployment which controls the pod with the specified pod "
@@ -2235,6 +2624,13 @@ class PodNameToDeploymentIDUDF : public ScalarUDF {
 
     return dep_info->uid();
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_name);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Get the ID of the Deployment which controls the pod with the specified pod "
@@ -2279,6 +2675,13 @@ class PodNameToServiceNameUDF : public ScalarUDF {
     }
     return StringifyVector(running_service_names);
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_name);
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<PodNameToServiceNameUDF>(types::ST_SERVICE_NAME,
                                                                {types::ST_POD_NAME})};
@@ -2324,6 +2727,13 @@ class PodNameToServiceIDUDF : public ScalarUDF {
     }
     return StringifyVector(running_service_ids);
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_name);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the service ID for a given pod name.")
         .Details(
@@ -2480,6 +2890,12 @@ class ContainerNameToContainerIDUDF : public ScalarUDF {
     return md->k8s_metadata_state().ContainerIDByName(container_name);
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& container_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, container_name);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the id of a container from its name.")
         .Details("Gets the kubernetes ID for the container from its name.")
@@ -2640,6 +3056,12 @@ class PodNameToPodStatusUDF : public ScalarUDF {
     return PodInfoToPodStatus(pod_info);
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_name);
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
         udf::ExplicitRule::Create<PodNameToPodStatusUDF>(types::ST_POD_STATUS, {types::ST_NONE})};
@@ -2711,6 +3133,13 @@ class PodNameToPodStatusMessageUDF : public ScalarUDF {
     }
     return pod_info->phase_message();
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_name);
+  }
+
 };
 
 class PodNameToPodStatusReasonUDF : public ScalarUDF {
@@ -2731,6 +3160,13 @@ class PodNameToPodStatusReasonUDF : public ScalarUDF {
     }
     return pod_info->phase_reason();
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_name);
+  }
+
 };
 
 inline std::string ContainerStateToString(const px::md::ContainerState& container_state) {
@@ -2779,6 +3215,12 @@ class ContainerIDToContainerStatusUDF : public ScalarUDF {
     return sb.GetString();
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& container_id,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, container_id);
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<ContainerIDToContainerStatusUDF>(types::ST_CONTAINER_STATUS,
                                                                        {types::ST_NONE})};
@@ -2811,6 +3253,12 @@ class UPIDToPodStatusUDF : public ScalarUDF {
     return PodInfoToPodStatus(UPIDtoPod(md, upid_value));
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<UInt128Value>& upid_value,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        &memo_, out, [this, ctx](const UInt128Value& val) { return Exec(ctx, val); }, upid_value);
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<UPIDToPodStatusUDF>(types::ST_POD_STATUS, {types::ST_NONE})};
   }
@@ -2834,6 +3282,9 @@ class UPIDToPodStatusUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+ private:
+  udf::UPIDMemo<StringValue> memo_;
 };
 
 class UPIDToCmdLineUDF : public ScalarUDF {
@@ -2856,6 +3307,12 @@ class UPIDToCmdLineUDF : public ScalarUDF {
     return pid_info->cmdline();
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<UInt128Value>& upid_value,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        &memo_, out, [this, ctx](const UInt128Value& val) { return Exec(ctx, val); }, upid_value);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the command line arguments used to start a UPID.")
         .Details(
@@ -2868,6 +3325,9 @@ class UPIDToCmdLineUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+ private:
+  udf::UPIDMemo<StringValue> memo_;
 };
 
 inline std::string PodInfoToPodQoS(const px::md::PodInfo* pod_info) {
@@ -2890,6 +3350,13 @@ class UPIDToPodQoSUDF : public ScalarUDF {
     auto md = GetMetadataState(ctx);
     return PodInfoToPodQoS(UPIDtoPod(md, upid_value));
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<UInt128Value>& upid_value,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        &memo_, out, [this, ctx](const UInt128Value& val) { return Exec(ctx, val); }, upid_value);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Kubernetes QOS class for the UPID.")
         .Details(
@@ -2905,6 +3372,9 @@ class UPIDToPodQoSUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+ private:
+  udf::UPIDMemo<StringValue> memo_;
 };
 
 class HostnameUDF : public ScalarUDF {
@@ -2953,6 +3423,13 @@ class IPToPodIDUDF : public ScalarUDF {
     auto md = GetMetadataState(ctx);
     return md->k8s_metadata_state().PodIDByIP(pod_ip);
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_ip,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, pod_ip);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Convert IP address to the kubernetes pod ID that runs the backing service.")
@@ -2986,6 +3463,24 @@ class IPToPodIDAtTimeUDF : public ScalarUDF {
     auto md = GetMetadataState(ctx);
     return md->k8s_metadata_state().PodIDByIPAtTime(pod_ip, time.val);
   }
+
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& pod_ip,
+                   const udf::ColumnView<Time64NSValue>& time,
+                   udf::OutputColumn<StringValue>* out) {
+    auto md = GetMetadataState(ctx);
+    // The views point into the argument column, which outlives the batch.
+    std::vector<std::string_view> pod_ips(pod_ip.data(), pod_ip.data() + pod_ip.size());
+    std::vector<int64_t> timestamps_ns(time.size());
+    for (size_t idx = 0; idx < time.size(); ++idx) {
+      timestamps_ns[idx] = time[idx].val;
+    }
+    std::vector<std::string> pod_ids;
+    md->k8s_metadata_state().PodIDsByIPAtTime(pod_ips, timestamps_ns, &pod_ids);
+    for (size_t idx = 0; idx < out->size(); ++idx) {
+      (*out)[idx] = std::move(pod_ids[idx]);
+    }
+    return Status::OK();
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Convert IP address to the kubernetes pod ID that runs the backing service "
@@ -3030,6 +3525,12 @@ class IPToServiceIDUDF : public ScalarUDF {
     return udf.Exec(ctx, pod_id);
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& ip,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, ip);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the service ID for a given IP.")
         .Details(
@@ -3271,6 +3772,12 @@ class NamespaceNameToNamespaceIDUDF : public ScalarUDF {
     return namespace_id;
   }
 
+  Status ExecBatch(FunctionContext* ctx, const udf::ColumnView<StringValue>& namespace_name,
+                   udf::OutputColumn<StringValue>* out) {
+    return udf::ExecBatchMemoized(
+        out, [this, ctx](const StringValue& val) { return Exec(ctx, val); }, namespace_name);
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Kubernetes UID of the given namespace name.")
         .Details("Get the Kubernetes UID of the given namespace name.")
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/funcs/net/cidr_trie.h"
+
+#include <arpa/inet.h>
+
+#include <algorithm>
+
+namespace px {
+namespace carnot {
+namespace funcs {
+namespace net {
+
+namespace {
+
+constexpr int kKeyBits = 128;
+// The bits before the IPv4 address in an IPv4-mapped IPv6 address.
+constexpr int kIPv4MappedPrefixLength = 96;
+
+absl::uint128 Mask(absl::uint128 key, int length) {
+  return length == 0 ? 0 : key & (~absl::uint128(0) << (kKeyBits - length));
+}
+
+int Bit(absl::uint128 key, int idx) {
+  return static_cast<int>((key >> (kKeyBits - 1 - idx)) & 1);
+}
+
+int CommonPrefixLength(absl::uint128 a, absl::uint128 b) {
+  absl::uint128 diff = a ^ b;
+  uint64_t high = absl::Uint128High64(diff);
+  if (high != 0) {
+    return __builtin_clzll(high);
+  }
+  uint64_t low = absl::Uint128Low64(diff);
+  return low == 0 ? kKeyBits : 64 + __builtin_clzll(low);
+}
+
+}  // namespace
+
+absl::uint128 CIDRTrie::ToKey(const InetAddr& addr) {
+  if (addr.family == InetAddrFamily::kIPv4) {
+    uint32_t v4 = ntohl(std::get<struct in_addr>(addr.addr).s_addr);
+    return absl::MakeUint128(0, 0xffff00000000ULL | v4);
+  }
+  const struct in6_addr& v6 = std::get<struct in6_addr>(addr.addr);
+  uint64_t high = 0;
+  uint64_t low = 0;
+  for (int i = 0; i < 8; ++i) {
+    high = (high << 8) | v6.s6_addr[i];
+    low = (low << 8) | v6.s6_addr[8 + i];
+  }
+  return absl::MakeUint128(high, low);
+}
+
+int CIDRTrie::AddNode(absl::uint128 prefix, int prefix_length, bool terminal) {
+  nodes_.push_back(Node{prefix, prefix_length, terminal});
+  return static_cast<int>(nodes_.size()) - 1;
+}
+
+void CIDRTrie::Insert(const CIDRBlock& block) {
+  int length = static_cast<int>(block.prefix_length);
+  if (block.ip_addr.family == InetAddrFamily::kIPv4) {
+    length += kIPv4MappedPrefixLength;
+  }
+  length = std::min(length, kKeyBits);
+  absl::uint128 key = Mask(ToKey(block.ip_addr), length);
+
+  if (nodes_.empty()) {
+    AddNode(key, length, true);
+    return;
+  }
+  // Nodes are referred to by index, since adding nodes moves them.
+  int idx = 0;
+  while (true) {
+    int node_length = nodes_[idx].prefix_length;
+    int common = std::min({CommonPrefixLength(nodes_[idx].prefix, key), node_length, length});
+    if (common < node_length) {
+      // The block diverges from the node (or ends) inside its prefix: split the node at the
+      // common prefix. The split node takes the place of the node, which moves to a new index.
+      int moved = AddNode(0, 0, false);
+      nodes_[moved] = nodes_[idx];
+      nodes_[idx] = Node{Mask(key, common), common, false};
+      nodes_[idx].children[Bit(nodes_[moved].prefix, common)] = moved;
+      if (common == length) {
+        nodes_[idx].terminal = true;
+        nodes_[idx].children = {kNoChild, kNoChild};
+      } else {
+        int leaf = AddNode(key, length, true);
+        nodes_[idx].children[Bit(key, common)] = leaf;
+      }
+      return;
+    }
+    if (nodes_[idx].terminal) {
+      // Already contained in an inserted block.
+      return;
+    }
+    if (length == node_length) {
+      nodes_[idx].terminal = true;
+      nodes_[idx].children = {kNoChild, kNoChild};
+      return;
+    }
+    int bit = Bit(key, node_length);
+    if (nodes_[idx].children[bit] == kNoChild) {
+      int leaf = AddNode(key, length, true);
+      nodes_[idx].children[bit] = leaf;
+      return;
+    }
+    idx = nodes_[idx].children[bit];
+  }
+}
+
+bool CIDRTrie::Contains(const InetAddr& addr) const {
+  if (nodes_.empty()) {
+    return false;
+  }
+  absl::uint128 key = ToKey(addr);
+  int idx = 0;
+  while (idx != kNoChild) {
+    const Node& node = nodes_[idx];
+    if (Mask(key, node.prefix_length) != node.prefix) {
+      return false;
+    }
+    if (node.terminal) {
+      return true;
+    }
+    idx = node.children[Bit(key, node.prefix_length)];
+  }
+  return false;
+}
+
+}  // namespace net
+}  // namespace funcs
+}  // namespace carnot
+}  // namespace px
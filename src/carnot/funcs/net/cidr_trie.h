@@ -0,0 +1,73 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <absl/numeric/int128.h>
+#include <array>
+#include <vector>
+
+#include "src/common/base/inet_utils.h"
+
+namespace px {
+namespace carnot {
+namespace funcs {
+namespace net {
+
+/**
+ * A set of CIDR blocks that checks whether an IP address is in any of them in one walk down a
+ * path-compressed binary trie, rather than by checking every block.
+ *
+ * Addresses are kept as 128 bit integers. IPv4 addresses and blocks are mapped to IPv4-mapped
+ * IPv6 ones, so that IPv4 and IPv6 addresses and blocks can be mixed like in CIDRContainsIPAddr.
+ */
+class CIDRTrie {
+ public:
+  void Insert(const CIDRBlock& block);
+  bool Contains(const InetAddr& addr) const;
+
+  bool empty() const { return nodes_.empty(); }
+  void clear() { nodes_.clear(); }
+
+  // The 128 bit integer of an address, with IPv4 addresses mapped to IPv6.
+  static absl::uint128 ToKey(const InetAddr& addr);
+
+ private:
+  static constexpr int kNoChild = -1;
+
+  struct Node {
+    // The first prefix_length bits of the addresses below this node. The other bits are zero.
+    absl::uint128 prefix;
+    int prefix_length;
+    // Whether prefix is one of the inserted blocks. Blocks inside it aren't kept, since it
+    // already contains all of their addresses.
+    bool terminal;
+    // The index in nodes_ of the node of the addresses whose next bit is 0 or 1.
+    std::array<int, 2> children = {kNoChild, kNoChild};
+  };
+
+  int AddNode(absl::uint128 prefix, int prefix_length, bool terminal);
+
+  // The root is at index 0.
+  std::vector<Node> nodes_;
+};
+
+}  // namespace net
+}  // namespace funcs
+}  // namespace carnot
+}  // namespace px
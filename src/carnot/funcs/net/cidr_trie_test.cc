@@ -0,0 +1,132 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <absl/strings/substitute.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "src/carnot/funcs/net/cidr_trie.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace funcs {
+namespace net {
+
+class CIDRTrieTest : public ::testing::Test {
+ protected:
+  void Insert(std::string_view cidr_str) {
+    CIDRBlock block;
+    ASSERT_OK(ParseCIDRBlock(cidr_str, &block));
+    trie_.Insert(block);
+    blocks_.push_back(block);
+  }
+
+  bool Contains(std::string_view addr_str) {
+    InetAddr addr;
+    EXPECT_OK(ParseIPAddress(addr_str, &addr));
+    return trie_.Contains(addr);
+  }
+
+  // Whether any inserted block contains the address, checked block by block.
+  bool ContainedInAnyBlock(std::string_view addr_str) {
+    InetAddr addr;
+    EXPECT_OK(ParseIPAddress(addr_str, &addr));
+    for (const auto& block : blocks_) {
+      if (CIDRContainsIPAddr(block, addr)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  CIDRTrie trie_;
+  std::vector<CIDRBlock> blocks_;
+};
+
+TEST_F(CIDRTrieTest, empty) {
+  EXPECT_TRUE(trie_.empty());
+  EXPECT_FALSE(Contains("10.0.0.1"));
+  EXPECT_FALSE(Contains("::1"));
+}
+
+TEST_F(CIDRTrieTest, ipv4) {
+  Insert("10.0.0.0/24");
+  Insert("10.8.0.0/14");
+  Insert("192.168.1.7/32");
+  EXPECT_TRUE(Contains("10.0.0.0"));
+  EXPECT_TRUE(Contains("10.0.0.255"));
+  EXPECT_FALSE(Contains("10.0.1.0"));
+  EXPECT_TRUE(Contains("10.11.255.255"));
+  EXPECT_FALSE(Contains("10.12.0.0"));
+  EXPECT_TRUE(Contains("192.168.1.7"));
+  EXPECT_FALSE(Contains("192.168.1.8"));
+  EXPECT_FALSE(Contains("::1"));
+}
+
+TEST_F(CIDRTrieTest, nested_blocks) {
+  Insert("10.0.1.0/24");
+  Insert("10.0.0.0/8");
+  Insert("10.2.3.4/32");
+  EXPECT_TRUE(Contains("10.0.1.1"));
+  EXPECT_TRUE(Contains("10.255.0.0"));
+  EXPECT_TRUE(Contains("10.2.3.5"));
+  EXPECT_FALSE(Contains("11.0.0.0"));
+}
+
+TEST_F(CIDRTrieTest, ipv6_and_mixed) {
+  Insert("2001:db8::/32");
+  Insert("fd00::/8");
+  Insert("::ffff:172.16.0.0/108");
+  EXPECT_TRUE(Contains("2001:db8::1"));
+  EXPECT_FALSE(Contains("2001:db9::1"));
+  EXPECT_TRUE(Contains("fdab::1"));
+  // IPv4 addresses are checked against the IPv4-mapped IPv6 block.
+  EXPECT_TRUE(Contains("172.16.3.4"));
+  EXPECT_FALSE(Contains("172.32.0.0"));
+}
+
+TEST_F(CIDRTrieTest, all_addresses) {
+  Insert("0.0.0.0/0");
+  EXPECT_TRUE(Contains("1.2.3.4"));
+  EXPECT_FALSE(Contains("2001:db8::1"));
+  Insert("::/0");
+  EXPECT_TRUE(Contains("2001:db8::1"));
+}
+
+TEST_F(CIDRTrieTest, matches_linear_check) {
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> octet(0, 3);
+  std::uniform_int_distribution<int> prefix(8, 32);
+  auto random_addr = [&]() {
+    return absl::Substitute("10.$0.$1.$2", octet(gen), octet(gen), octet(gen));
+  };
+  for (int i = 0; i < 20; ++i) {
+    Insert(absl::Substitute("$0/$1", random_addr(), prefix(gen)));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    std::string addr = random_addr();
+    EXPECT_EQ(Contains(addr), ContainedInAnyBlock(addr)) << addr;
+  }
+}
+
+}  // namespace net
+}  // namespace funcs
+}  // namespace carnot
+}  // namespace px
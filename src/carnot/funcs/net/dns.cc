@@ -0,0 +1,127 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/funcs/net/dns.h"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+#include <cstring>
+#include <utility>
+
+namespace px {
+namespace carnot {
+namespace funcs {
+namespace net {
+namespace internal {
+
+std::string DNSLookup(const std::string& addr) {
+  struct sockaddr_in sa;
+
+  char node[kMaxHostnameSize];
+
+  memset(&sa, 0, sizeof sa);
+  sa.sin_family = AF_INET;
+
+  inet_pton(AF_INET, addr.c_str(), &sa.sin_addr);
+
+  int res =
+      getnameinfo((struct sockaddr*)&sa, sizeof(sa), node, sizeof(node), NULL, 0, NI_NAMEREQD);
+
+  if (res) {
+    return res == EAI_NONAME ? addr : gai_strerror(res);
+  }
+  return node;
+}
+
+bool DNSCache::Get(std::string_view addr, Clock::time_point now, std::string* hostname) {
+  auto it = entries_.find(addr);
+  if (it == entries_.end() || it->second.expiry <= now) {
+    return false;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second.lru_it);
+  *hostname = it->second.hostname;
+  return true;
+}
+
+void DNSCache::Put(const std::string& addr, std::string hostname, Clock::time_point now) {
+  auto it = entries_.find(addr);
+  if (it != entries_.end()) {
+    lru_.splice(lru_.begin(), lru_, it->second.lru_it);
+    it->second.hostname = std::move(hostname);
+    it->second.expiry = now + ttl_;
+    return;
+  }
+  if (entries_.size() >= capacity_ && !lru_.empty()) {
+    entries_.erase(lru_.back());
+    lru_.pop_back();
+  }
+  lru_.push_front(addr);
+  entries_.emplace(addr, Entry{std::move(hostname), now + ttl_, lru_.begin()});
+}
+
+std::string DNSCache::Lookup(std::string_view addr) {
+  return std::move(LookupBatch({addr})[0]);
+}
+
+std::vector<std::string> DNSCache::LookupBatch(const std::vector<std::string_view>& addrs) {
+  std::vector<std::string> hostnames(addrs.size());
+  // The distinct addresses that aren't cached, and the records that wait on each of them.
+  std::vector<std::string> missing;
+  absl::flat_hash_map<std::string_view, std::vector<size_t>> waiting;
+  {
+    absl::MutexLock lock(&lock_);
+    auto now = Clock::now();
+    for (size_t i = 0; i < addrs.size(); ++i) {
+      auto waiting_it = waiting.find(addrs[i]);
+      if (waiting_it != waiting.end()) {
+        waiting_it->second.push_back(i);
+        continue;
+      }
+      if (!Get(addrs[i], now, &hostnames[i])) {
+        missing.emplace_back(addrs[i]);
+        waiting[addrs[i]].push_back(i);
+      }
+    }
+  }
+  if (missing.empty()) {
+    return hostnames;
+  }
+
+  // The lookups run without the lock, so that other queries can use the cache meanwhile.
+  std::vector<std::string> resolved(missing.size());
+  resolver_pool_.ParallelFor(missing.size(),
+                             [&](size_t i) { resolved[i] = resolver_(missing[i]); });
+
+  absl::MutexLock lock(&lock_);
+  auto now = Clock::now();
+  for (size_t i = 0; i < missing.size(); ++i) {
+    for (size_t idx : waiting[missing[i]]) {
+      hostnames[idx] = resolved[i];
+    }
+    Put(missing[i], std::move(resolved[i]), now);
+  }
+  return hostnames;
+}
+
+}  // namespace internal
+}  // namespace net
+}  // namespace funcs
+}  // namespace carnot
+}  // namespace px
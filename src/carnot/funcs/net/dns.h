@@ -18,10 +18,17 @@
 
 #pragma once
 
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include <chrono>
+#include <functional>
+#include <list>
 #include <string>
+#include <string_view>
+#include <vector>
 
-#define TBB_PREVIEW_CONCURRENT_LRU_CACHE 1
-#include "tbb/concurrent_lru_cache.h"
+#include "src/common/base/thread_pool.h"
 
 namespace px {
 namespace carnot {
@@ -31,44 +38,71 @@ namespace internal {
 
 constexpr size_t kMaxHostnameSize = 512;
 constexpr size_t kLRUCacheSize = 1024;
+// Hostnames are looked up again after this long, so that queries see changes of the DNS records.
+constexpr std::chrono::seconds kDNSCacheTTL{300};
+// Reverse lookups mostly wait on the DNS server, so a batch resolves this many at once.
+constexpr size_t kNumResolverThreads = 8;
 
-inline std::string DNSLookup(const std::string& addr) {
-  struct sockaddr_in sa;
-
-  char node[kMaxHostnameSize];
-
-  memset(&sa, 0, sizeof sa);
-  sa.sin_family = AF_INET;
-
-  inet_pton(AF_INET, addr.c_str(), &sa.sin_addr);
-
-  int res =
-      getnameinfo((struct sockaddr*)&sa, sizeof(sa), node, sizeof(node), NULL, 0, NI_NAMEREQD);
-
-  if (res) {
-    return res == EAI_NONAME ? addr : gai_strerror(res);
-  }
-  return node;
-}
+// Returns the hostname of the IPv4 address, the address itself if it has none or the error.
+std::string DNSLookup(const std::string& addr);
 
+/**
+ * A cache of the hostnames of IP addresses, shared by all the queries of the process. Entries
+ * expire after a TTL and the least recently used ones are evicted past the capacity.
+ *
+ * LookupBatch resolves the distinct addresses of a batch that are missing from the cache
+ * concurrently on a thread pool, since getnameinfo blocks on the DNS server and has no
+ * asynchronous version.
+ */
 class DNSCache {
  public:
+  using Resolver = std::function<std::string(const std::string& addr)>;
+
   static DNSCache& GetInstance() {
-    static DNSCache cache;
+    static DNSCache cache(DNSLookup, kLRUCacheSize, kDNSCacheTTL, kNumResolverThreads);
     return cache;
   }
 
-  std::string Lookup(std::string addr) { return cache_[addr].value(); }
+  DNSCache(Resolver resolver, size_t capacity, std::chrono::nanoseconds ttl,
+           size_t num_resolver_threads)
+      : resolver_(std::move(resolver)),
+        capacity_(capacity),
+        ttl_(ttl),
+        resolver_pool_(num_resolver_threads) {}
 
- private:
-  DNSCache()
-      : cache_([](std::string addr) -> std::string { return DNSLookup(addr); }, kLRUCacheSize) {}
+  std::string Lookup(std::string_view addr);
 
-  tbb::concurrent_lru_cache<std::string, std::string> cache_;
+  // Returns the hostnames of addrs, in the same order.
+  std::vector<std::string> LookupBatch(const std::vector<std::string_view>& addrs);
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Entry {
+    std::string hostname;
+    Clock::time_point expiry;
+    // The position of the address in lru_.
+    std::list<std::string>::iterator lru_it;
+  };
+
+  // Returns whether addr has an unexpired entry, and if so sets hostname and marks it as used.
+  bool Get(std::string_view addr, Clock::time_point now, std::string* hostname)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void Put(const std::string& addr, std::string hostname, Clock::time_point now)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const Resolver resolver_;
+  const size_t capacity_;
+  const std::chrono::nanoseconds ttl_;
+  ThreadPool resolver_pool_;
+
+  absl::Mutex lock_;
+  absl::flat_hash_map<std::string, Entry> entries_ ABSL_GUARDED_BY(lock_);
+  // The addresses of entries_, most recently used first.
+  std::list<std::string> lru_ ABSL_GUARDED_BY(lock_);
 };
 
 }  // namespace internal
-
 }  // namespace net
 }  // namespace funcs
 }  // namespace carnot
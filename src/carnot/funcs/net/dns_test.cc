@@ -0,0 +1,85 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "src/carnot/funcs/net/dns.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace funcs {
+namespace net {
+namespace internal {
+
+class DNSCacheTest : public ::testing::Test {
+ protected:
+  DNSCache::Resolver CountingResolver() {
+    return [this](const std::string& addr) {
+      ++num_lookups_;
+      return "host-" + addr;
+    };
+  }
+
+  std::atomic<int> num_lookups_ = 0;
+};
+
+TEST_F(DNSCacheTest, batch_resolves_each_missing_addr_once) {
+  DNSCache cache(CountingResolver(), 16, std::chrono::seconds(60), 4);
+  EXPECT_EQ(cache.Lookup("10.0.0.1"), "host-10.0.0.1");
+  EXPECT_EQ(num_lookups_, 1);
+
+  std::vector<std::string_view> addrs = {"10.0.0.2", "10.0.0.1", "10.0.0.3", "10.0.0.2"};
+  EXPECT_THAT(cache.LookupBatch(addrs),
+              ::testing::ElementsAre("host-10.0.0.2", "host-10.0.0.1", "host-10.0.0.3",
+                                     "host-10.0.0.2"));
+  EXPECT_EQ(num_lookups_, 3);
+
+  EXPECT_THAT(cache.LookupBatch(addrs), ::testing::SizeIs(4));
+  EXPECT_EQ(num_lookups_, 3);
+}
+
+TEST_F(DNSCacheTest, expired_entries_are_resolved_again) {
+  DNSCache cache(CountingResolver(), 16, std::chrono::seconds(0), 0);
+  EXPECT_EQ(cache.Lookup("10.0.0.1"), "host-10.0.0.1");
+  EXPECT_EQ(cache.Lookup("10.0.0.1"), "host-10.0.0.1");
+  EXPECT_EQ(num_lookups_, 2);
+}
+
+TEST_F(DNSCacheTest, evicts_least_recently_used) {
+  DNSCache cache(CountingResolver(), 2, std::chrono::seconds(60), 0);
+  cache.Lookup("10.0.0.1");
+  cache.Lookup("10.0.0.2");
+  // Makes 10.0.0.2 the least recently used.
+  cache.Lookup("10.0.0.1");
+  cache.Lookup("10.0.0.3");
+  EXPECT_EQ(num_lookups_, 3);
+
+  cache.Lookup("10.0.0.1");
+  EXPECT_EQ(num_lookups_, 3);
+  cache.Lookup("10.0.0.2");
+  EXPECT_EQ(num_lookups_, 4);
+}
+
+}  // namespace internal
+}  // namespace net
+}  // namespace funcs
+}  // namespace carnot
+}  // namespace px
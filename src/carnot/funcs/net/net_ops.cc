@@ -34,9 +34,14 @@ void RegisterNetOpsOrDie(px::carnot::udf::Registry* registry) {
    *****************************************/
   registry->RegisterOrDie<NSLookupUDF>("nslookup");
   registry->RegisterOrDie<CIDRsContainIPUDF>("cidrs_contain_ip");
+  registry->RegisterOrDie<DNSHostnameUDF>("dns_hostname");
   /*****************************************
    * Aggregate UDFs.
    *****************************************/
+  /*****************************************
+   * UDTFs.
+   *****************************************/
+  registry->RegisterOrDie<DNSHostnamesUDTF>("GetDNSHostnames");
 }
 
 }  // namespace net
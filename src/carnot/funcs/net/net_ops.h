@@ -24,13 +24,17 @@
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "src/carnot/funcs/net/cidr_trie.h"
 #include "src/carnot/funcs/net/dns.h"
 #include "src/carnot/udf/registry.h"
 #include "src/carnot/udf/type_inference.h"
+#include "src/carnot/udf/udtf.h"
 #include "src/common/base/inet_utils.h"
+#include "src/shared/dns/hostname_cache.h"
 #include "src/shared/metadata/metadata_state.h"
 #include "src/shared/types/types.h"
 
@@ -45,6 +49,18 @@ class NSLookupUDF : public ScalarUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue addr) { return cache_.Lookup(addr); }
 
+  // Resolves the addresses of the batch that aren't cached concurrently, rather than blocking on
+  // each of them in turn.
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<StringValue>& addr,
+                   udf::OutputColumn<StringValue>* out) {
+    std::vector<std::string_view> addrs(addr.data(), addr.data() + addr.size());
+    std::vector<std::string> hostnames = cache_.LookupBatch(addrs);
+    for (size_t idx = 0; idx < out->size(); ++idx) {
+      (*out)[idx] = std::move(hostnames[idx]);
+    }
+    return Status::OK();
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Perform a DNS lookup for the value (experimental).")
         .Details("Experimental UDF to perform a DNS lookup for a given value.")
@@ -57,47 +73,96 @@ class NSLookupUDF : public ScalarUDF {
   internal::DNSCache& cache_ = internal::DNSCache::GetInstance();
 };
 
-class CIDRsContainIPUDF : public ScalarUDF {
+class DNSHostnameUDF : public ScalarUDF {
  public:
-  BoolValue Exec(FunctionContext*, StringValue cidrs_str, StringValue ip_addr) {
-    // The expectation is that users will call this UDF with a constant cidrs_str, so cache to
-    // prevent unnecessary parsing.
-    if (cidrs_str != parsed_cidr_str_) {
-      parsed_cidr_str_ = cidrs_str;
+  StringValue Exec(FunctionContext*, StringValue addr) {
+    std::string hostname = cache_.Lookup(addr);
+    return hostname.empty() ? addr : hostname;
+  }
 
-      rapidjson::Document doc;
-      rapidjson::ParseResult ok = doc.Parse(cidrs_str.data());
-      if (ok == nullptr) {
-        return false;
-      }
-      if (!doc.IsArray()) {
-        return false;
-      }
-      cidrs_.clear();
-      for (rapidjson::Value::ConstValueIterator itr = doc.Begin(); itr != doc.End(); ++itr) {
-        if (!itr->IsString()) {
-          return false;
-        }
-        cidrs_.emplace_back();
-        auto s = px::ParseCIDRBlock(itr->GetString(), &cidrs_.back());
-        if (!s.ok()) {
-          cidrs_.pop_back();
-        }
-      }
-    }
+  // Only the PEMs see the DNS answers.
+  static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
 
-    px::InetAddr addr = {};
-    auto s = px::ParseIPAddress(ip_addr, &addr);
-    if (!s.ok()) {
+  static udf::ScalarUDFDocBuilder Doc() {
+    return udf::ScalarUDFDocBuilder("Get the hostname of an IP address from traced DNS answers.")
+        .Details(
+            "Looks up the hostname that a recent DNS answer, received by any pod on the node, "
+            "resolved to the given address. Unlike nslookup, it makes no DNS queries, and it "
+            "returns the name the pods looked up rather than the name of the reverse lookup. "
+            "Addresses without a recent answer are returned unchanged.")
+        .Arg("addr", "An IP address")
+        .Example("df.hostname = px.dns_hostname(df.remote_addr)")
+        .Returns("The hostname, or the address if it isn't known.");
+  }
+
+ private:
+  const px::dns::HostnameCache& cache_ = px::dns::HostnameCache::GetInstance();
+};
+
+/**
+ * The hostnames that the DNS answers received by the pods on each node resolved addresses from,
+ * per network namespace.
+ */
+class DNSHostnamesUDTF final : public udf::UDTF<DNSHostnamesUDTF> {
+ public:
+  static constexpr auto Executor() { return udfspb::UDTFSourceExecutor::UDTF_ALL_PEM; }
+
+  static constexpr auto OutputRelation() {
+    return MakeArray(
+        ColInfo("asid", types::DataType::INT64, types::PatternType::GENERAL,
+                "The short ID of the agent", types::SemanticType::ST_ASID),
+        ColInfo("netns", types::DataType::INT64, types::PatternType::GENERAL,
+                "The inode number of the network namespace that received the answer"),
+        ColInfo("addr", types::DataType::STRING, types::PatternType::GENERAL, "The IP address"),
+        ColInfo("hostname", types::DataType::STRING, types::PatternType::GENERAL,
+                "The hostname that was resolved to the address"),
+        ColInfo("expires_in", types::DataType::INT64, types::PatternType::METRIC_GAUGE,
+                "How long until the entry expires", types::SemanticType::ST_DURATION_NS));
+  }
+
+  Status Init(FunctionContext*) {
+    entries_ = px::dns::HostnameCache::GetInstance().Entries();
+    now_ = px::dns::HostnameCache::Clock::now();
+    return Status::OK();
+  }
+
+  bool NextRecord(FunctionContext* ctx, RecordWriter* rw) {
+    if (idx_ >= entries_.size()) {
       return false;
     }
-    for (const auto& cidr : cidrs_) {
-      if (px::CIDRContainsIPAddr(cidr, addr)) {
-        return true;
-      }
-    }
-    return false;
+    const auto& entry = entries_[idx_];
+    rw->Append<IndexOf("asid")>(ctx->metadata_state()->asid());
+    rw->Append<IndexOf("netns")>(entry.netns);
+    rw->Append<IndexOf("addr")>(entry.addr);
+    rw->Append<IndexOf("hostname")>(entry.hostname);
+    rw->Append<IndexOf("expires_in")>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(entry.expiry - now_).count());
+    ++idx_;
+    return idx_ < entries_.size();
+  }
+
+ private:
+  std::vector<px::dns::HostnameCache::Entry> entries_;
+  px::dns::HostnameCache::Clock::time_point now_;
+  size_t idx_ = 0;
+};
+
+class CIDRsContainIPUDF : public ScalarUDF {
+ public:
+  BoolValue Exec(FunctionContext*, StringValue cidrs_str, StringValue ip_addr) {
+    return ContainsIP(cidrs_str, ip_addr);
+  }
+
+  Status ExecBatch(FunctionContext*, const udf::ColumnView<StringValue>& cidrs_str,
+                   const udf::ColumnView<StringValue>& ip_addr, udf::OutputColumn<BoolValue>* out) {
+    return udf::ExecBatchElementwise(
+        out,
+        [this](const StringValue& cidrs, const StringValue& ip) -> BoolValue {
+          return ContainsIP(cidrs, ip);
+        },
+        cidrs_str, ip_addr);
   }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Determine whether an IP is contained in a set of CIDR ranges.")
         .Details(
@@ -115,8 +180,48 @@ class CIDRsContainIPUDF : public ScalarUDF {
   }
 
  private:
+  bool ContainsIP(const std::string& cidrs_str, std::string_view ip_addr) {
+    // The expectation is that users will call this UDF with a constant cidrs_str, so the trie is
+    // only built once per query.
+    if (cidrs_str != parsed_cidr_str_) {
+      parsed_cidr_str_ = cidrs_str;
+      ParseCIDRs(cidrs_str);
+    }
+    if (cidrs_.empty()) {
+      return false;
+    }
+
+    px::InetAddr addr = {};
+    auto s = px::ParseIPAddress(ip_addr, &addr);
+    if (!s.ok()) {
+      return false;
+    }
+    return cidrs_.Contains(addr);
+  }
+
+  // Invalid json leaves the trie empty, so that no IP is contained. Invalid CIDR ranges in the
+  // array are skipped.
+  void ParseCIDRs(const std::string& cidrs_str) {
+    cidrs_.clear();
+    rapidjson::Document doc;
+    rapidjson::ParseResult ok = doc.Parse(cidrs_str.data());
+    if (ok == nullptr || !doc.IsArray()) {
+      return;
+    }
+    for (rapidjson::Value::ConstValueIterator itr = doc.Begin(); itr != doc.End(); ++itr) {
+      if (!itr->IsString()) {
+        cidrs_.clear();
+        return;
+      }
+      px::CIDRBlock cidr;
+      if (px::ParseCIDRBlock(itr->GetString(), &cidr).ok()) {
+        cidrs_.Insert(cidr);
+      }
+    }
+  }
+
   std::string parsed_cidr_str_ = "";
-  std::vector<px::CIDRBlock> cidrs_;
+  CIDRTrie cidrs_;
 };
 
 void RegisterNetOpsOrDie(px::carnot::udf::Registry* registry);
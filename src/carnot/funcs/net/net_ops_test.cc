@@ -27,6 +27,14 @@ namespace carnot {
 namespace funcs {
 namespace net {
 
+TEST(NetOps, DNSHostnameUDF_uses_traced_answers) {
+  px::dns::HostnameCache::GetInstance().Insert(1, "10.0.0.1", "svc.default.svc.cluster.local",
+                                           std::chrono::seconds(60));
+  auto udf_tester = px::carnot::udf::UDFTester<DNSHostnameUDF>();
+  udf_tester.ForInput("10.0.0.1").Expect("svc.default.svc.cluster.local");
+  udf_tester.ForInput("10.0.0.2").Expect("10.0.0.2");
+}
+
 TEST(NetOps, CIDRsContainIPUDF_basic) {
   auto udf_tester = px::carnot::udf::UDFTester<CIDRsContainIPUDF>();
   std::string cidrs(R"(["10.0.0.1/31"])");
@@ -35,6 +43,17 @@ TEST(NetOps, CIDRsContainIPUDF_basic) {
   udf_tester.ForInput(cidrs, "10.0.0.2").Expect(false);
 }
 
+TEST(NetOps, CIDRsContainIPUDF_many_cidrs) {
+  auto udf_tester = px::carnot::udf::UDFTester<CIDRsContainIPUDF>();
+  std::string cidrs(R"(["10.0.0.0/16", "not a cidr", "192.168.0.0/24", "fd00::/8"])");
+  udf_tester.ForInput(cidrs, "10.0.255.1").Expect(true);
+  udf_tester.ForInput(cidrs, "10.1.0.1").Expect(false);
+  udf_tester.ForInput(cidrs, "192.168.0.42").Expect(true);
+  udf_tester.ForInput(cidrs, "fd12::1").Expect(true);
+  udf_tester.ForInput(cidrs, "fe80::1").Expect(false);
+  udf_tester.ForInput(cidrs, "not an ip").Expect(false);
+}
+
 TEST(NetOps, CIDRsContainIPUDF_invalid_json) {
   auto udf_tester = px::carnot::udf::UDFTester<CIDRsContainIPUDF>();
 
@@ -43,6 +62,9 @@ TEST(NetOps, CIDRsContainIPUDF_invalid_json) {
   udf_tester.ForInput(R"([1, 3])", "10.0.0.1").Expect(false);
   udf_tester.ForInput(R"([{"1":1}])", "10.0.0.1").Expect(false);
   udf_tester.ForInput(R"(;{})", "10.0.0.1").Expect(false);
+  // A non string element invalidates the whole array, also on later calls.
+  udf_tester.ForInput(R"(["10.0.0.0/8", 1])", "10.0.0.1").Expect(false);
+  udf_tester.ForInput(R"(["10.0.0.0/8", 1])", "10.0.0.1").Expect(false);
 }
 
 }  // namespace net
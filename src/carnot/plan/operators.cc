@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <iterator>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <string_view>
 #include <utility>
@@ -37,6 +38,7 @@
 #include "src/carnot/udf/udf_definition.h"
 #include "src/carnot/udf/udtf.h"
 #include "src/common/base/base.h"
+#include "src/shared/types/type_utils.h"
 #include "src/table_store/table_store.h"
 
 namespace px {
@@ -79,12 +81,18 @@ std::unique_ptr<Operator> Operator::FromProto(const planpb::Operator& pb, int64_
       return CreateOperator<UnionOperator>(id, pb.union_op());
     case planpb::JOIN_OPERATOR:
       return CreateOperator<JoinOperator>(id, pb.join_op());
+    case planpb::TOP_K_OPERATOR:
+      return CreateOperator<TopKOperator>(id, pb.top_k_op());
+    case planpb::AS_OF_JOIN_OPERATOR:
+      return CreateOperator<AsOfJoinOperator>(id, pb.as_of_join_op());
     case planpb::UDTF_SOURCE_OPERATOR:
       return CreateOperator<UDTFSourceOperator>(id, pb.udtf_source_op());
     case planpb::EMPTY_SOURCE_OPERATOR:
       return CreateOperator<EmptySourceOperator>(id, pb.empty_source_op());
     case planpb::OTEL_EXPORT_SINK_OPERATOR:
       return CreateOperator<OTelExportSinkOperator>(id, pb.otel_sink_op());
+    case planpb::FILE_EXPORT_SINK_OPERATOR:
+      return CreateOperator<FileExportSinkOperator>(id, pb.file_export_sink_op());
     default:
       LOG(FATAL) << absl::Substitute("Unknown operator type: $0",
                                      magic_enum::enum_name(pb.op_type()));
@@ -96,8 +104,10 @@ std::unique_ptr<Operator> Operator::FromProto(const planpb::Operator& pb, int64_
  */
 
 std::string MemorySourceOperator::DebugString() const {
-  return absl::Substitute("Op:MemorySource($0, [$1], start=$2, end=$3, streaming=$4)", TableName(),
-                          absl::StrJoin(Columns(), ","), start_time(), stop_time(), streaming());
+  return absl::Substitute(
+      "Op:MemorySource($0, [$1], start=$2, end=$3, streaming=$4, predicates=$5, sample_rate=$6)",
+      TableName(), absl::StrJoin(Columns(), ","), start_time(), stop_time(), streaming(),
+      pb_.predicates_size(), sample_rate());
 }
 
 Status MemorySourceOperator::Init(const planpb::MemorySourceOperator& pb) {
@@ -221,6 +231,11 @@ Status AggregateOperator::Init(const planpb::AggregateOperator& pb) {
   for (int idx = 0; idx < pb_.groups_size(); ++idx) {
     groups_.emplace_back(GroupInfo{pb_.group_names(idx), pb_.groups(idx).index()});
   }
+  if (time_windowed() &&
+      (pb_.time_window_group() < 0 || pb_.time_window_group() >= pb_.groups_size())) {
+    return error::InvalidArgument("Time window group $0 is out of bounds for $1 groups",
+                                  pb_.time_window_group(), pb_.groups_size());
+  }
 
   is_initialized_ = true;
   return Status::OK();
@@ -454,6 +469,59 @@ StatusOr<table_store::schema::Relation> LimitOperator::OutputRelation(
   return output_relation;
 }
 
+/**
+ * TopK Operator Implementation.
+ */
+std::string TopKOperator::DebugString() const {
+  std::vector<std::string> sort_strs;
+  for (size_t i = 0; i < sort_cols_.size(); ++i) {
+    sort_strs.push_back(absl::Substitute("$0 $1", sort_cols_[i], descending_[i] ? "desc" : "asc"));
+  }
+  return absl::Substitute("Op:TopK($0, sort: [$1])", pb_.limit(), absl::StrJoin(sort_strs, ","));
+}
+
+Status TopKOperator::Init(const planpb::TopKOperator& pb) {
+  pb_ = pb;
+  if (pb_.limit() < 0) {
+    return error::InvalidArgument("TopK operator limit must be non-negative, got $0", pb_.limit());
+  }
+  if (pb_.sort_columns_size() == 0) {
+    return error::InvalidArgument("TopK operator must have at least one sort column");
+  }
+  sort_cols_.reserve(pb_.sort_columns_size());
+  descending_.reserve(pb_.sort_columns_size());
+  for (const auto& sort_col : pb_.sort_columns()) {
+    sort_cols_.push_back(sort_col.column_index());
+    descending_.push_back(sort_col.descending());
+  }
+  is_initialized_ = true;
+  return Status::OK();
+}
+
+StatusOr<table_store::schema::Relation> TopKOperator::OutputRelation(
+    const table_store::schema::Schema& schema, const PlanState& /*state*/,
+    const std::vector<int64_t>& input_ids) const {
+  DCHECK(is_initialized_) << "Not initialized";
+
+  if (input_ids.size() != 1) {
+    return error::InvalidArgument("TopK operator must have exactly one input");
+  }
+  if (!schema.HasRelation(input_ids[0])) {
+    return error::NotFound("Missing relation ($0) for input of TopKOperator", input_ids[0]);
+  }
+  PX_ASSIGN_OR_RETURN(const table_store::schema::Relation& input_relation,
+                      schema.GetRelation(input_ids[0]));
+  for (auto sort_col : sort_cols_) {
+    if (sort_col < 0 || sort_col >= static_cast<int64_t>(input_relation.NumColumns())) {
+      return error::InvalidArgument(
+          "Sort column index $0 is out of bounds, number of columns is $1", sort_col,
+          input_relation.NumColumns());
+    }
+  }
+  // Output relation is the same as the input relation.
+  return input_relation;
+}
+
 /**
  * Zip Operator Implementation.
  */
@@ -649,6 +717,93 @@ planpb::JoinOperator::ParentColumn JoinOperator::time_column() const {
   return output_columns()[pos];
 }
 
+/**
+ * AsOfJoin Operator Implementation.
+ */
+std::string AsOfJoinOperator::DebugString() const {
+  return absl::Substitute(
+      "Op:AsOfJoinOperator(type='$0', time=(parent[0][$1] >= parent[1][$2]), condition=($3), "
+      "output_columns=($4))",
+      magic_enum::enum_name(type()), left_time_column_index(), right_time_column_index(),
+      JoinOperator::DebugString(equality_conditions()), absl::StrJoin(column_names_, ","));
+}
+
+Status AsOfJoinOperator::Init(const planpb::AsOfJoinOperator& pb) {
+  pb_ = pb;
+  if (pb_.type() == planpb::JoinOperator::FULL_OUTER) {
+    return error::InvalidArgument("AsOfJoin operator doesn't support full outer joins");
+  }
+  if (pb_.column_names_size() != pb_.output_columns_size()) {
+    return error::InvalidArgument("AsOfJoin operator has $0 column names for $1 output columns",
+                                  pb_.column_names_size(), pb_.output_columns_size());
+  }
+  if (pb_.tolerance_ns() < 0) {
+    return error::InvalidArgument("AsOfJoin operator tolerance must be non-negative, got $0",
+                                  pb_.tolerance_ns());
+  }
+  column_names_.assign(pb_.column_names().begin(), pb_.column_names().end());
+  output_columns_.assign(pb_.output_columns().begin(), pb_.output_columns().end());
+  equality_conditions_.assign(pb_.equality_conditions().begin(), pb_.equality_conditions().end());
+  is_initialized_ = true;
+  return Status::OK();
+}
+
+StatusOr<table_store::schema::Relation> AsOfJoinOperator::OutputRelation(
+    const table_store::schema::Schema& schema, const PlanState&,
+    const std::vector<int64_t>& input_ids) const {
+  DCHECK(is_initialized_) << "Not initialized";
+  if (input_ids.size() != 2) {
+    return error::InvalidArgument("AsOfJoin operator must have two input tables.");
+  }
+  std::vector<table_store::schema::Relation> input_relations;
+  for (auto input_id : input_ids) {
+    if (!schema.HasRelation(input_id)) {
+      return error::NotFound("Missing relation ($0) for input of AsOfJoin operator", input_id);
+    }
+    PX_ASSIGN_OR_RETURN(const auto& relation, schema.GetRelation(input_id));
+    input_relations.push_back(relation);
+  }
+
+  auto check_column = [&](size_t parent_index, int64_t column_index,
+                          std::optional<types::DataType> expected_type) -> Status {
+    const auto& relation = input_relations[parent_index];
+    if (column_index < 0 || column_index >= static_cast<int64_t>(relation.NumColumns())) {
+      return error::InvalidArgument("Column index $0 is out of bounds for parent $1 of AsOfJoin",
+                                    column_index, parent_index);
+    }
+    if (expected_type.has_value() && relation.GetColumnType(column_index) != *expected_type) {
+      return error::InvalidArgument("Column $0 of parent $1 of AsOfJoin has type $2, expected $3",
+                                    relation.GetColumnName(column_index), parent_index,
+                                    types::ToString(relation.GetColumnType(column_index)),
+                                    types::ToString(*expected_type));
+    }
+    return Status::OK();
+  };
+  PX_RETURN_IF_ERROR(check_column(0, left_time_column_index(), types::TIME64NS));
+  PX_RETURN_IF_ERROR(check_column(1, right_time_column_index(), types::TIME64NS));
+  for (const auto& condition : equality_conditions_) {
+    PX_RETURN_IF_ERROR(check_column(0, condition.left_column_index(), std::nullopt));
+    PX_RETURN_IF_ERROR(check_column(
+        1, condition.right_column_index(),
+        input_relations[0].GetColumnType(condition.left_column_index())));
+  }
+
+  table_store::schema::Relation r;
+  for (size_t i = 0; i < output_columns_.size(); ++i) {
+    const auto& input_column = output_columns_[i];
+    if (input_column.parent_index() > 1) {
+      return error::InvalidArgument("AsOfJoin output column has invalid parent index $0",
+                                    input_column.parent_index());
+    }
+    PX_RETURN_IF_ERROR(check_column(input_column.parent_index(), input_column.column_index(),
+                                    std::nullopt));
+    r.AddColumn(input_relations[input_column.parent_index()].GetColumnType(
+                    input_column.column_index()),
+                column_names_[i]);
+  }
+  return r;
+}
+
 Status UDTFSourceOperator::Init(const planpb::UDTFSourceOperator& pb) {
   pb_ = pb;
 
@@ -739,6 +894,45 @@ StatusOr<table_store::schema::Relation> OTelExportSinkOperator::OutputRelation(
   return table_store::schema::Relation();
 }
 
+/**
+ * File Export Sink Operator Implementation.
+ */
+
+std::string FileExportSinkOperator::DebugString() const {
+  return absl::Substitute("Op:FileExportSink($0, $1)", pb_.table_name(), pb_.path());
+}
+
+Status FileExportSinkOperator::Init(const planpb::FileExportSinkOperator& pb) {
+  pb_ = pb;
+  if (pb_.path().empty()) {
+    return error::InvalidArgument("FileExportSink requires a path");
+  }
+  if (pb_.table_name().empty()) {
+    return error::InvalidArgument("FileExportSink requires a table name");
+  }
+  column_idxs_.assign(pb_.column_idxs().begin(), pb_.column_idxs().end());
+  if (column_idxs_.empty()) {
+    for (int64_t i = 0; i < pb_.column_names_size(); ++i) {
+      column_idxs_.push_back(i);
+    }
+  }
+  for (int64_t idx : column_idxs_) {
+    if (idx < 0 || idx >= pb_.column_names_size()) {
+      return error::InvalidArgument("FileExportSink column index $0 is out of range [0, $1)", idx,
+                                    pb_.column_names_size());
+    }
+  }
+  is_initialized_ = true;
+  return Status::OK();
+}
+
+StatusOr<table_store::schema::Relation> FileExportSinkOperator::OutputRelation(
+    const table_store::schema::Schema&, const PlanState&, const std::vector<int64_t>&) const {
+  DCHECK(is_initialized_) << "Not initialized";
+  // There are no outputs.
+  return table_store::schema::Relation();
+}
+
 }  // namespace plan
 }  // namespace carnot
 }  // namespace px
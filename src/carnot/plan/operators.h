@@ -97,6 +97,12 @@ class MemorySourceOperator : public Operator {
   std::vector<int64_t> Columns() const { return column_idxs_; }
   const types::TabletID& Tablet() const { return pb_.tablet(); }
   bool streaming() const { return pb_.streaming(); }
+  bool reverse() const { return pb_.reverse(); }
+  // The fraction of the rows to read, 1 if the source isn't sampled.
+  double sample_rate() const { return pb_.sample_rate() > 0 ? pb_.sample_rate() : 1.0; }
+  const google::protobuf::RepeatedPtrField<planpb::ColumnPredicate>& predicates() const {
+    return pb_.predicates();
+  }
 
  private:
   planpb::MemorySourceOperator pb_;
@@ -146,6 +152,10 @@ class AggregateOperator : public Operator {
   bool windowed() const { return pb_.windowed(); }
   bool partial_agg() const { return pb_.partial_agg(); }
   bool finalize_results() const { return pb_.finalize_results(); }
+  // Whether this aggregate emits each tumbling time window once it is complete.
+  bool time_windowed() const { return pb_.time_window_size_ns() > 0; }
+  int64_t time_window_size_ns() const { return pb_.time_window_size_ns(); }
+  int64_t time_window_group() const { return pb_.time_window_group(); }
 
  private:
   std::vector<std::shared_ptr<AggregateExpression>> values_;
@@ -264,6 +274,27 @@ class LimitOperator : public Operator {
   planpb::LimitOperator pb_;
 };
 
+class TopKOperator : public Operator {
+ public:
+  explicit TopKOperator(int64_t id) : Operator(id, planpb::TOP_K_OPERATOR) {}
+  ~TopKOperator() override = default;
+
+  StatusOr<table_store::schema::Relation> OutputRelation(
+      const table_store::schema::Schema& schema, const PlanState& state,
+      const std::vector<int64_t>& input_ids) const override;
+  Status Init(const planpb::TopKOperator& pb);
+  std::string DebugString() const override;
+
+  int64_t limit() const { return pb_.limit(); }
+  const std::vector<int64_t>& sort_cols() const { return sort_cols_; }
+  const std::vector<bool>& descending() const { return descending_; }
+
+ private:
+  std::vector<int64_t> sort_cols_;
+  std::vector<bool> descending_;
+  planpb::TopKOperator pb_;
+};
+
 class UnionOperator : public Operator {
  public:
   explicit UnionOperator(int64_t id) : Operator(id, planpb::UNION_OPERATOR) {}
@@ -327,6 +358,38 @@ class JoinOperator : public Operator {
   planpb::JoinOperator pb_;
 };
 
+class AsOfJoinOperator : public Operator {
+ public:
+  explicit AsOfJoinOperator(int64_t id) : Operator(id, planpb::AS_OF_JOIN_OPERATOR) {}
+  ~AsOfJoinOperator() override = default;
+
+  StatusOr<table_store::schema::Relation> OutputRelation(
+      const table_store::schema::Schema& schema, const PlanState& state,
+      const std::vector<int64_t>& input_ids) const override;
+  Status Init(const planpb::AsOfJoinOperator& pb);
+  std::string DebugString() const override;
+
+  const std::vector<std::string>& column_names() const { return column_names_; }
+  planpb::JoinOperator::JoinType type() const { return pb_.type(); }
+  int64_t left_time_column_index() const { return pb_.left_time_column_index(); }
+  int64_t right_time_column_index() const { return pb_.right_time_column_index(); }
+  const std::vector<planpb::JoinOperator::EqualityCondition>& equality_conditions() const {
+    return equality_conditions_;
+  }
+  const std::vector<planpb::JoinOperator::ParentColumn>& output_columns() const {
+    return output_columns_;
+  }
+  int64_t tolerance_ns() const { return pb_.tolerance_ns(); }
+  size_t rows_per_batch() const { return pb_.rows_per_batch(); }
+
+ private:
+  std::vector<std::string> column_names_;
+  std::vector<planpb::JoinOperator::EqualityCondition> equality_conditions_;
+  std::vector<planpb::JoinOperator::ParentColumn> output_columns_;
+
+  planpb::AsOfJoinOperator pb_;
+};
+
 class UDTFSourceOperator : public Operator {
  public:
   explicit UDTFSourceOperator(int64_t id) : Operator(id, planpb::UDTF_SOURCE_OPERATOR) {}
@@ -394,6 +457,8 @@ class OTelExportSinkOperator : public Operator {
 
   int64_t timeout() { return pb_.endpoint_config().timeout(); }
 
+  const std::string& export_state_key() const { return pb_.export_state_key(); }
+
  private:
   std::vector<std::pair<std::string, std::string>> headers_;
   std::vector<planpb::OTelAttribute> resource_attributes_optional_json_encoded_;
@@ -401,6 +466,34 @@ class OTelExportSinkOperator : public Operator {
   planpb::OTelExportSinkOperator pb_;
 };
 
+class FileExportSinkOperator : public Operator {
+ public:
+  static constexpr int64_t kDefaultRowGroupRows = 1024 * 1024;
+
+  explicit FileExportSinkOperator(int64_t id) : Operator(id, planpb::FILE_EXPORT_SINK_OPERATOR) {}
+  ~FileExportSinkOperator() override = default;
+
+  StatusOr<table_store::schema::Relation> OutputRelation(
+      const table_store::schema::Schema& schema, const PlanState& state,
+      const std::vector<int64_t>& input_ids) const override;
+  Status Init(const planpb::FileExportSinkOperator& pb);
+  std::string DebugString() const override;
+
+  const std::string& path() const { return pb_.path(); }
+  const std::string& table_name() const { return pb_.table_name(); }
+  const std::string& node_name() const { return pb_.node_name(); }
+  // The indexes of the exported input columns.
+  const std::vector<int64_t>& column_idxs() const { return column_idxs_; }
+  const std::string& ColumnName(int64_t i) const { return pb_.column_names(i); }
+  int64_t row_group_rows() const {
+    return pb_.row_group_rows() > 0 ? pb_.row_group_rows() : kDefaultRowGroupRows;
+  }
+
+ private:
+  std::vector<int64_t> column_idxs_;
+  planpb::FileExportSinkOperator pb_;
+};
+
 }  // namespace plan
 }  // namespace carnot
 }  // namespace px
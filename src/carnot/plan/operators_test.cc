@@ -283,6 +283,57 @@ TEST_F(OperatorTest, from_proto_join_no_time) {
   EXPECT_FALSE(join_op->order_by_time());
 }
 
+TEST_F(OperatorTest, from_proto_as_of_join) {
+  auto join_pb = planpb::testutils::CreateTestAsOfJoin1PB();
+  auto join_op = Operator::FromProto(join_pb, 1);
+  EXPECT_EQ(1, join_op->id());
+  EXPECT_TRUE(join_op->is_initialized());
+  EXPECT_EQ(planpb::OperatorType::AS_OF_JOIN_OPERATOR, join_op->op_type());
+
+  auto typed_op = static_cast<AsOfJoinOperator*>(join_op.get());
+  EXPECT_EQ(planpb::JoinOperator::LEFT_OUTER, typed_op->type());
+  EXPECT_EQ(1000, typed_op->tolerance_ns());
+  EXPECT_EQ(10, typed_op->rows_per_batch());
+  EXPECT_THAT(typed_op->column_names(), ElementsAre("time_", "cpu"));
+}
+
+TEST_F(OperatorTest, from_proto_as_of_join_negative_tolerance) {
+  auto join_pb = planpb::testutils::CreateTestAsOfJoin1PB();
+  join_pb.mutable_as_of_join_op()->set_tolerance_ns(-1);
+  auto join_op = std::make_unique<AsOfJoinOperator>(1);
+  EXPECT_NOT_OK(join_op->Init(join_pb.as_of_join_op()));
+}
+
+TEST_F(OperatorTest, from_proto_as_of_join_full_outer) {
+  auto join_pb = planpb::testutils::CreateTestAsOfJoin1PB();
+  join_pb.mutable_as_of_join_op()->set_type(planpb::JoinOperator::FULL_OUTER);
+  auto join_op = std::make_unique<AsOfJoinOperator>(1);
+  EXPECT_NOT_OK(join_op->Init(join_pb.as_of_join_op()));
+}
+
+TEST_F(OperatorTest, output_relation_as_of_join) {
+  Relation left;
+  left.AddColumn(types::TIME64NS, "time_");
+  left.AddColumn(types::STRING, "pod");
+  Relation right;
+  right.AddColumn(types::TIME64NS, "time_");
+  right.AddColumn(types::STRING, "pod");
+  right.AddColumn(types::FLOAT64, "cpu");
+  schema_.AddRelation(10, left);
+  schema_.AddRelation(11, right);
+
+  auto join_op = Operator::FromProto(planpb::testutils::CreateTestAsOfJoin1PB(), 12);
+  auto rel = join_op->OutputRelation(schema_, *state_, std::vector<int64_t>({10, 11}))
+                 .ConsumeValueOrDie();
+  Relation expected_relation;
+  expected_relation.AddColumn(types::TIME64NS, "time_");
+  expected_relation.AddColumn(types::FLOAT64, "cpu");
+  EXPECT_EQ(expected_relation, rel);
+
+  // The time columns of both inputs have to be TIME64NS.
+  EXPECT_NOT_OK(join_op->OutputRelation(schema_, *state_, std::vector<int64_t>({0, 11})));
+}
+
 TEST_F(OperatorTest, output_relation_source) {
   auto src_pb = planpb::testutils::CreateTestSource1PB();
   auto src_op = Operator::FromProto(src_pb, 1);
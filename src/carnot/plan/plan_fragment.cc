@@ -83,6 +83,12 @@ Status PlanFragmentWalker::CallWalkFn(const Operator& op) {
     case planpb::OperatorType::UNION_OPERATOR:
       PX_RETURN_IF_ERROR(CallAs<UnionOperator>(on_union_walk_fn_, op));
       break;
+    case planpb::OperatorType::TOP_K_OPERATOR:
+      PX_RETURN_IF_ERROR(CallAs<TopKOperator>(on_top_k_walk_fn_, op));
+      break;
+    case planpb::OperatorType::AS_OF_JOIN_OPERATOR:
+      PX_RETURN_IF_ERROR(CallAs<AsOfJoinOperator>(on_as_of_join_walk_fn_, op));
+      break;
     case planpb::OperatorType::GRPC_SINK_OPERATOR:
       PX_RETURN_IF_ERROR(CallAs<GRPCSinkOperator>(on_grpc_sink_walk_fn_, op));
       break;
@@ -98,6 +104,9 @@ Status PlanFragmentWalker::CallWalkFn(const Operator& op) {
     case planpb::OperatorType::OTEL_EXPORT_SINK_OPERATOR:
       PX_RETURN_IF_ERROR(CallAs<OTelExportSinkOperator>(on_otel_sink_walk_fn_, op));
       break;
+    case planpb::OperatorType::FILE_EXPORT_SINK_OPERATOR:
+      PX_RETURN_IF_ERROR(CallAs<FileExportSinkOperator>(on_file_export_sink_walk_fn_, op));
+      break;
     default:
       LOG(FATAL) << absl::Substitute("Operator does not exist: $0", magic_enum::enum_name(op_type));
       return error::InvalidArgument("Operator does not exist: $0", magic_enum::enum_name(op_type));
@@ -71,11 +71,14 @@ class PlanFragmentWalker {
   using LimitWalkFn = std::function<Status(const LimitOperator&)>;
   using UnionWalkFn = std::function<Status(const UnionOperator&)>;
   using JoinWalkFn = std::function<Status(const JoinOperator&)>;
+  using TopKWalkFn = std::function<Status(const TopKOperator&)>;
+  using AsOfJoinWalkFn = std::function<Status(const AsOfJoinOperator&)>;
   using GRPCSinkWalkFn = std::function<Status(const GRPCSinkOperator&)>;
   using GRPCSourceWalkFn = std::function<Status(const GRPCSourceOperator&)>;
   using UDTFSourceWalkFn = std::function<Status(const UDTFSourceOperator&)>;
   using EmptySourceWalkFn = std::function<Status(const EmptySourceOperator&)>;
   using OTelSinkWalkFn = std::function<Status(const OTelExportSinkOperator&)>;
+  using FileExportSinkWalkFn = std::function<Status(const FileExportSinkOperator&)>;
 
   /**
    * Register callback for when a memory source operator is encountered.
@@ -157,6 +160,26 @@ class PlanFragmentWalker {
     return *this;
   }
 
+  /**
+   * Register callback for when a top k operator is encountered.
+   * @param fn The function to call when a TopKOperator is encountered.
+   * @return self to allow chaining
+   */
+  PlanFragmentWalker& OnTopK(const TopKWalkFn& fn) {
+    on_top_k_walk_fn_ = fn;
+    return *this;
+  }
+
+  /**
+   * Register callback for when an as of join operator is encountered.
+   * @param fn The function to call when an AsOfJoinOperator is encountered.
+   * @return self to allow chaining
+   */
+  PlanFragmentWalker& OnAsOfJoin(const AsOfJoinWalkFn& fn) {
+    on_as_of_join_walk_fn_ = fn;
+    return *this;
+  }
+
   PlanFragmentWalker& OnGRPCSource(const GRPCSourceWalkFn& fn) {
     on_grpc_source_walk_fn_ = fn;
     return *this;
@@ -181,6 +204,11 @@ class PlanFragmentWalker {
     on_otel_sink_walk_fn_ = fn;
     return *this;
   }
+
+  PlanFragmentWalker& OnFileExportSink(const FileExportSinkWalkFn& fn) {
+    on_file_export_sink_walk_fn_ = fn;
+    return *this;
+  }
   /**
    * Perform a walk of the plan fragment operators in a topologically-sorted order.
    * @param plan_fragment The plan fragment to walk.
@@ -201,11 +229,14 @@ class PlanFragmentWalker {
   LimitWalkFn on_limit_walk_fn_;
   UnionWalkFn on_union_walk_fn_;
   JoinWalkFn on_join_walk_fn_;
+  TopKWalkFn on_top_k_walk_fn_;
+  AsOfJoinWalkFn on_as_of_join_walk_fn_;
   GRPCSinkWalkFn on_grpc_sink_walk_fn_;
   GRPCSourceWalkFn on_grpc_source_walk_fn_;
   UDTFSourceWalkFn on_udtf_source_walk_fn_;
   EmptySourceWalkFn on_empty_source_walk_fn_;
   OTelSinkWalkFn on_otel_sink_walk_fn_;
+  FileExportSinkWalkFn on_file_export_sink_walk_fn_;
 };
 
 }  // namespace plan
@@ -28,6 +28,7 @@
 #include "src/carnot/planner/compiler/analyzer/convert_metadata_rule.h"
 #include "src/carnot/planner/compiler/analyzer/drop_to_map_rule.h"
 #include "src/carnot/planner/compiler/analyzer/merge_group_by_into_group_acceptor_rule.h"
+#include "src/carnot/planner/compiler/analyzer/merge_sort_and_limit_into_top_k_rule.h"
 #include "src/carnot/planner/compiler/analyzer/nested_blocking_agg_fn_check_rule.h"
 #include "src/carnot/planner/compiler/analyzer/propagate_expression_annotations_rule.h"
 #include "src/carnot/planner/compiler/analyzer/remove_group_by_rule.h"
@@ -65,7 +66,7 @@ class Analyzer : public RuleExecutor<IR> {
         CreateRuleBatch<FailOnMax>("TableAndMetadataResolution", 2);
     source_and_metadata_resolution_batch->AddRule<ResolveMetadataPropertyRule>(compiler_state_,
                                                                                md_handler_.get());
-    source_and_metadata_resolution_batch->AddRule<SetupJoinTypeRule>();
+    source_and_metadata_resolution_batch->AddRule<SetupJoinTypeRule>(compiler_state_);
     source_and_metadata_resolution_batch->AddRule<MergeGroupByIntoGroupAcceptorRule>(
         IRNodeType::kBlockingAgg);
     source_and_metadata_resolution_batch->AddRule<MergeGroupByIntoGroupAcceptorRule>(
@@ -84,6 +85,12 @@ class Analyzer : public RuleExecutor<IR> {
     limit_to_res_sink->AddRule<AddLimitToBatchResultSinkRule>(compiler_state_);
   }
 
+  // Runs after the limits of the batch result sinks are added, as they can follow a sort().
+  void CreateMergeSortAndLimitIntoTopKBatch() {
+    RuleBatch* top_k = CreateRuleBatch<FailOnMax>("MergeSortAndLimitIntoTopK", 2);
+    top_k->AddRule<MergeSortAndLimitIntoTopKRule>();
+  }
+
   // TODO(philkuz) need to add a new optimization that combines maps.
   void CreateCombineConsecutiveMapsRule() {
     RuleBatch* consecutive_maps = CreateRuleBatch<FailOnMax>("CombineConsecutiveMapsRule", 2);
@@ -123,6 +130,7 @@ class Analyzer : public RuleExecutor<IR> {
     CreateSourceAndMetadataResolutionBatch();
     CreateUniqueSinkNamesBatch();
     CreateAddLimitToBatchResultSinkBatch();
+    CreateMergeSortAndLimitIntoTopKBatch();
     CreateCombineConsecutiveMapsRule();
     CreateDataTypeResolutionBatch();
     CreateManageColumnAccessBatch();
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/compiler/analyzer/merge_sort_and_limit_into_top_k_rule.h"
+#include "src/carnot/planner/ir/top_k_ir.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+StatusOr<bool> MergeSortAndLimitIntoTopKRule::Apply(IRNode* ir_node) {
+  if (Match(ir_node, Sort())) {
+    return MergeIntoTopK(static_cast<SortIR*>(ir_node));
+  }
+  return false;
+}
+
+StatusOr<bool> MergeSortAndLimitIntoTopKRule::MergeIntoTopK(SortIR* sort_ir) {
+  IR* ir_graph = sort_ir->graph();
+  DCHECK_EQ(sort_ir->parents().size(), 1UL);
+  OperatorIR* parent_op = sort_ir->parents()[0];
+
+  for (OperatorIR* child : sort_ir->Children()) {
+    if (!Match(child, Limit()) || static_cast<LimitIR*>(child)->tail() ||
+        static_cast<LimitIR*>(child)->pem_only()) {
+      return sort_ir->CreateIRNodeError("sort() must be followed by head()");
+    }
+    auto limit_ir = static_cast<LimitIR*>(child);
+    DCHECK(limit_ir->limit_value_set());
+    PX_ASSIGN_OR_RETURN(TopKIR * top_k_ir,
+                        ir_graph->CreateNode<TopKIR>(limit_ir->ast(), parent_op,
+                                                     sort_ir->sort_columns(),
+                                                     limit_ir->limit_value()));
+    for (OperatorIR* limit_child : limit_ir->Children()) {
+      PX_RETURN_IF_ERROR(limit_child->ReplaceParent(limit_ir, top_k_ir));
+    }
+    PX_RETURN_IF_ERROR(limit_ir->RemoveParent(sort_ir));
+    PX_RETURN_IF_ERROR(ir_graph->DeleteNode(limit_ir->id()));
+  }
+  PX_RETURN_IF_ERROR(sort_ir->RemoveParent(parent_op));
+  PX_RETURN_IF_ERROR(ir_graph->DeleteNode(sort_ir->id()));
+  return true;
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
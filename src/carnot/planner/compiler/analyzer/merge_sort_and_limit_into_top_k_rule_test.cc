@@ -0,0 +1,110 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "src/carnot/planner/compiler/analyzer/merge_sort_and_limit_into_top_k_rule.h"
+#include "src/carnot/planner/compiler/test_utils.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+using ::testing::ElementsAre;
+
+using MergeSortAndLimitIntoTopKRuleTest = RulesTest;
+
+TEST_F(MergeSortAndLimitIntoTopKRuleTest, basic) {
+  MemorySourceIR* src = MakeMemSource(cpu_relation);
+  SortIR* sort = MakeSort(src, {{"cpu0", /*descending*/ true}, {"count", false}});
+  LimitIR* limit = MakeLimit(sort, 10);
+  MemorySinkIR* sink = MakeMemSink(limit, "sink");
+  int64_t sort_id = sort->id();
+  int64_t limit_id = limit->id();
+
+  MergeSortAndLimitIntoTopKRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ValueOrDie());
+
+  EXPECT_FALSE(graph->HasNode(sort_id));
+  EXPECT_FALSE(graph->HasNode(limit_id));
+  auto top_k_nodes = graph->FindNodesThatMatch(TopK());
+  ASSERT_EQ(1, top_k_nodes.size());
+  auto top_k = static_cast<TopKIR*>(top_k_nodes[0]);
+  EXPECT_EQ(10, top_k->limit());
+  ASSERT_EQ(2, top_k->sort_columns().size());
+  EXPECT_EQ("cpu0", top_k->sort_columns()[0].col_name);
+  EXPECT_TRUE(top_k->sort_columns()[0].descending);
+  EXPECT_EQ("count", top_k->sort_columns()[1].col_name);
+  EXPECT_FALSE(top_k->sort_columns()[1].descending);
+  EXPECT_THAT(top_k->parents(), ElementsAre(src));
+  EXPECT_THAT(sink->parents(), ElementsAre(top_k));
+}
+
+TEST_F(MergeSortAndLimitIntoTopKRuleTest, each_limit_becomes_a_top_k) {
+  MemorySourceIR* src = MakeMemSource(cpu_relation);
+  SortIR* sort = MakeSort(src, {{"cpu0", /*descending*/ true}});
+  MemorySinkIR* sink1 = MakeMemSink(MakeLimit(sort, 10), "sink1");
+  MemorySinkIR* sink2 = MakeMemSink(MakeLimit(sort, 20), "sink2");
+
+  MergeSortAndLimitIntoTopKRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ValueOrDie());
+
+  EXPECT_EQ(0, graph->FindNodesThatMatch(Sort()).size());
+  EXPECT_EQ(0, graph->FindNodesThatMatch(Limit()).size());
+  ASSERT_EQ(1, sink1->parents().size());
+  ASSERT_EQ(1, sink2->parents().size());
+  ASSERT_TRUE(Match(sink1->parents()[0], TopK()));
+  ASSERT_TRUE(Match(sink2->parents()[0], TopK()));
+  EXPECT_EQ(10, static_cast<TopKIR*>(sink1->parents()[0])->limit());
+  EXPECT_EQ(20, static_cast<TopKIR*>(sink2->parents()[0])->limit());
+  EXPECT_THAT(sink1->parents()[0]->parents(), ElementsAre(src));
+  EXPECT_THAT(sink2->parents()[0]->parents(), ElementsAre(src));
+}
+
+TEST_F(MergeSortAndLimitIntoTopKRuleTest, sort_without_limit) {
+  MemorySourceIR* src = MakeMemSource(cpu_relation);
+  SortIR* sort = MakeSort(src, {{"cpu0", /*descending*/ true}});
+  MakeMemSink(sort, "sink");
+
+  MergeSortAndLimitIntoTopKRule rule;
+  EXPECT_THAT(rule.Execute(graph.get()).status(),
+              HasCompilerError("sort\\(\\) must be followed by head\\(\\)"));
+}
+
+TEST_F(MergeSortAndLimitIntoTopKRuleTest, sort_followed_by_tail) {
+  MemorySourceIR* src = MakeMemSource(cpu_relation);
+  SortIR* sort = MakeSort(src, {{"cpu0", /*descending*/ true}});
+  LimitIR* tail = MakeLimit(sort, 10);
+  tail->set_tail(true);
+  MakeMemSink(tail, "sink");
+
+  MergeSortAndLimitIntoTopKRule rule;
+  EXPECT_THAT(rule.Execute(graph.get()).status(),
+              HasCompilerError("sort\\(\\) must be followed by head\\(\\)"));
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
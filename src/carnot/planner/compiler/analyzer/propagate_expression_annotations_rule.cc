@@ -65,6 +65,12 @@ StatusOr<bool> PropagateExpressionAnnotationsRule::Apply(IRNode* ir_node) {
       operator_output_annotations_[op][out_col_name] =
           join->output_columns()[output_col_idx]->annotations();
     }
+  } else if (Match(op, AsOfJoin())) {
+    auto join = static_cast<AsOfJoinIR*>(op);
+    for (const auto& [output_col_idx, out_col_name] : Enumerate(join->column_names())) {
+      operator_output_annotations_[op][out_col_name] =
+          join->output_columns()[output_col_idx]->annotations();
+    }
   } else if (Match(op, Union())) {
     // For each of the union output columns, compute the annotation that is comprised of
     // all of the fields that every parent shares.
@@ -100,7 +106,7 @@ StatusOr<bool> PropagateExpressionAnnotationsRule::Apply(IRNode* ir_node) {
     for (const ColumnExpression& expr : agg->aggregate_expressions()) {
       operator_output_annotations_[op][expr.name] = expr.node->annotations();
     }
-  } else if (Match(op, Filter()) || Match(op, Limit())) {
+  } else if (Match(op, Filter()) || Match(op, Limit()) || Match(op, TopK())) {
     DCHECK_EQ(1U, op->parents().size());
     operator_output_annotations_[op] = operator_output_annotations_.at(op->parents()[0]);
   }
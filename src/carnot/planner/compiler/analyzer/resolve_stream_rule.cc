@@ -19,6 +19,7 @@
 #include <queue>
 
 #include "src/carnot/planner/compiler/analyzer/resolve_stream_rule.h"
+#include "src/carnot/planner/ir/map_ir.h"
 #include "src/carnot/planner/ir/stream_ir.h"
 
 namespace px {
@@ -26,6 +27,32 @@ namespace carnot {
 namespace planner {
 namespace compiler {
 
+bool ResolveStreamRule::SetTimeWindow(BlockingAggIR* agg) {
+  if (agg->parents().size() != 1 || !Match(agg->parents()[0], Map())) {
+    return false;
+  }
+  auto map = static_cast<MapIR*>(agg->parents()[0]);
+  for (const auto& [group_idx, group] : Enumerate(agg->groups())) {
+    for (const auto& col_expr : map->col_exprs()) {
+      if (col_expr.name != group->col_name() || !Match(col_expr.node, Func("bin"))) {
+        continue;
+      }
+      auto bin = static_cast<FuncIR*>(col_expr.node);
+      if (bin->args().size() != 2 || !Match(bin->args()[0], ColumnNode("time_")) ||
+          !Match(bin->args()[1], Int())) {
+        continue;
+      }
+      int64_t window_size_ns = static_cast<IntIR*>(bin->args()[1])->val();
+      if (window_size_ns <= 0) {
+        continue;
+      }
+      agg->SetTimeWindow(window_size_ns, group_idx);
+      return true;
+    }
+  }
+  return false;
+}
+
 StatusOr<bool> ResolveStreamRule::Apply(IRNode* ir_node) {
   if (!Match(ir_node, Stream())) {
     return false;
@@ -44,7 +71,10 @@ StatusOr<bool> ResolveStreamRule::Apply(IRNode* ir_node) {
     auto node = nodes.front();
     nodes.pop();
 
-    if (node->IsBlocking()) {
+    // A time window aggregate emits each window once it is complete, so it can be streamed.
+    bool window_agg =
+        Match(node, BlockingAgg()) && SetTimeWindow(static_cast<BlockingAggIR*>(node));
+    if (node->IsBlocking() && !window_agg) {
       return error::Unimplemented("df.stream() not yet supported with the operator $0",
                                   node->DebugString());
     }
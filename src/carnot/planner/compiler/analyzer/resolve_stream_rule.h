@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include "src/carnot/planner/ir/blocking_agg_ir.h"
 #include "src/carnot/planner/rules/rules.h"
 
 namespace px {
@@ -28,6 +29,8 @@ namespace compiler {
 class ResolveStreamRule : public Rule {
   /**
    * @brief Resolves StreamIRs by setting their ancestor MemorySource nodes to streaming mode.
+   * Aggregates are only allowed above the stream when they group by a tumbling time window,
+   * px.bin(df.time_, window), which turns them into incremental window aggregates.
    */
  public:
   ResolveStreamRule()
@@ -36,6 +39,11 @@ class ResolveStreamRule : public Rule {
 
  protected:
   StatusOr<bool> Apply(IRNode* ir_node) override;
+
+ private:
+  // Sets up agg as a time window aggregate, if one of its groups is a tumbling time window
+  // computed by its parent map. Returns false if it is not a window aggregate.
+  static bool SetTimeWindow(BlockingAggIR* agg);
 };
 
 }  // namespace compiler
@@ -72,6 +72,44 @@ TEST_F(RulesTest, resolve_stream_blocking_ancestor) {
   ASSERT_NOT_OK(rule.Execute(graph.get()));
 }
 
+TEST_F(RulesTest, resolve_stream_time_window_agg) {
+  MemorySourceIR* mem_source = MakeMemSource();
+  MapIR* map = MakeMap(
+      mem_source,
+      {{"service", MakeColumn("service", 0)},
+       {"window", MakeFunc("bin", {MakeColumn("time_", 0), MakeInt(10 * 1000 * 1000 * 1000LL)})},
+       {"count", MakeColumn("count", 0)}});
+  BlockingAggIR* agg =
+      MakeBlockingAgg(map, {MakeColumn("service", 0), MakeColumn("window", 0)},
+                      {{"outcount", MakeMeanFunc(MakeColumn("count", 0))}});
+  StreamIR* stream = graph->CreateNode<StreamIR>(ast, agg).ValueOrDie();
+  MemorySinkIR* sink = MakeMemSink(stream, "");
+
+  ResolveStreamRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ValueOrDie());
+  EXPECT_TRUE(mem_source->streaming());
+  EXPECT_THAT(sink->parents(), ElementsAre(agg));
+  EXPECT_TRUE(agg->time_windowed());
+  EXPECT_EQ(10 * 1000 * 1000 * 1000LL, agg->time_window_size_ns());
+  EXPECT_EQ(1, agg->time_window_group());
+}
+
+TEST_F(RulesTest, resolve_stream_non_time_window_agg) {
+  MemorySourceIR* mem_source = MakeMemSource();
+  MapIR* map = MakeMap(mem_source, {{"window", MakeFunc("bin", {MakeColumn("count", 0),
+                                                                MakeInt(10)})},
+                                    {"count", MakeColumn("count", 0)}});
+  BlockingAggIR* agg = MakeBlockingAgg(map, {MakeColumn("window", 0)},
+                                       {{"outcount", MakeMeanFunc(MakeColumn("count", 0))}});
+  StreamIR* stream = graph->CreateNode<StreamIR>(ast, agg).ValueOrDie();
+  MakeMemSink(stream, "");
+
+  ResolveStreamRule rule;
+  ASSERT_NOT_OK(rule.Execute(graph.get()));
+}
+
 TEST_F(RulesTest, resolve_stream_non_mem_sink_child) {
   MemorySourceIR* mem_source = MakeMemSource();
   GroupByIR* group_by = MakeGroupBy(mem_source, {MakeColumn("col1", 0), MakeColumn("col2", 0)});
@@ -16,6 +16,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
 #include <string>
 
 #include "src/carnot/planner/compiler/analyzer/setup_join_type_rule.h"
@@ -32,9 +33,74 @@ StatusOr<bool> SetupJoinTypeRule::Apply(IRNode* ir_node) {
     PX_RETURN_IF_ERROR(ConvertRightJoinToLeftJoin(static_cast<JoinIR*>(ir_node)));
     return true;
   }
+  if (compiler_state_ != nullptr && (Match(ir_node, InnerJoin()) || Match(ir_node, OuterJoin()))) {
+    return SwapToSmallerBuildSide(static_cast<JoinIR*>(ir_node));
+  }
   return false;
 }
 
+std::optional<TableSizeEstimate> SetupJoinTypeRule::EstimateSize(OperatorIR* op) const {
+  if (Match(op, MemorySource())) {
+    const auto& table_stats = compiler_state_->table_stats();
+    auto it = table_stats.find(static_cast<MemorySourceIR*>(op)->table_name());
+    if (it == table_stats.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+  if (op->parents().empty()) {
+    return std::nullopt;
+  }
+
+  std::vector<TableSizeEstimate> parent_estimates;
+  for (OperatorIR* parent : op->parents()) {
+    auto estimate = EstimateSize(parent);
+    if (!estimate.has_value()) {
+      return std::nullopt;
+    }
+    parent_estimates.push_back(estimate.value());
+  }
+
+  TableSizeEstimate estimate;
+  if (Match(op, Join())) {
+    // Assume a key lookup join, which outputs at most as many rows as its larger input.
+    for (const auto& parent_estimate : parent_estimates) {
+      estimate.num_rows = std::max(estimate.num_rows, parent_estimate.num_rows);
+      estimate.bytes = std::max(estimate.bytes, parent_estimate.bytes);
+    }
+    return estimate;
+  }
+  for (const auto& parent_estimate : parent_estimates) {
+    estimate.num_rows += parent_estimate.num_rows;
+    estimate.bytes += parent_estimate.bytes;
+  }
+  if (Match(op, Limit())) {
+    auto limit = static_cast<LimitIR*>(op);
+    if (limit->limit_value_set() && limit->limit_value() < estimate.num_rows) {
+      estimate.bytes = estimate.bytes / estimate.num_rows * limit->limit_value();
+      estimate.num_rows = limit->limit_value();
+    }
+  }
+  return estimate;
+}
+
+StatusOr<bool> SetupJoinTypeRule::SwapToSmallerBuildSide(JoinIR* join_ir) {
+  DCHECK_EQ(join_ir->parents().size(), 2UL) << "There should be exactly two parents.";
+  auto left = EstimateSize(join_ir->parents()[0]);
+  auto right = EstimateSize(join_ir->parents()[1]);
+  if (!left.has_value() || !right.has_value()) {
+    return false;
+  }
+  bool right_is_smaller = right->num_rows != left->num_rows ? right->num_rows < left->num_rows
+                                                            : right->bytes < left->bytes;
+  if (!right_is_smaller) {
+    return false;
+  }
+  PX_RETURN_IF_ERROR(SwapParents(join_ir));
+  join_ir->ToggleBuildSideSwapped();
+  return true;
+}
+
 void SetupJoinTypeRule::FlipColumns(const std::vector<ColumnIR*>& columns) {
   // Update the columns in the output_columns
   for (ColumnIR* col : columns) {
@@ -45,8 +111,13 @@ void SetupJoinTypeRule::FlipColumns(const std::vector<ColumnIR*>& columns) {
 }
 
 Status SetupJoinTypeRule::ConvertRightJoinToLeftJoin(JoinIR* join_ir) {
-  DCHECK_EQ(join_ir->parents().size(), 2UL) << "There should be exactly two parents.";
   DCHECK(join_ir->join_type() == JoinIR::JoinType::kRight);
+  PX_RETURN_IF_ERROR(SwapParents(join_ir));
+  return join_ir->SetJoinType(JoinIR::JoinType::kLeft);
+}
+
+Status SetupJoinTypeRule::SwapParents(JoinIR* join_ir) {
+  DCHECK_EQ(join_ir->parents().size(), 2UL) << "There should be exactly two parents.";
 
   std::vector<OperatorIR*> old_parents = join_ir->parents();
   for (OperatorIR* parent : old_parents) {
@@ -67,8 +138,7 @@ Status SetupJoinTypeRule::ConvertRightJoinToLeftJoin(JoinIR* join_ir) {
     std::string right = join_ir->suffix_strs()[1];
     join_ir->SetSuffixStrs({right, left});
   }
-
-  return join_ir->SetJoinType(JoinIR::JoinType::kLeft);
+  return Status::OK();
 }
 
 }  // namespace compiler
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <optional>
 #include <vector>
 
 #include "src/carnot/planner/rules/rules.h"
@@ -31,10 +32,14 @@ class SetupJoinTypeRule : public Rule {
   /**
    * @brief Converts a right join into a left join.
    *
+   * When the compiler state has table stats, also swaps the parents of inner and outer joins so
+   * that the smaller estimated input is the left parent, which the join builds its hash table on.
    */
  public:
   SetupJoinTypeRule()
       : Rule(nullptr, /*use_topo*/ false, /*reverse_topological_execution*/ false) {}
+  explicit SetupJoinTypeRule(CompilerState* compiler_state)
+      : Rule(compiler_state, /*use_topo*/ false, /*reverse_topological_execution*/ false) {}
 
  protected:
   StatusOr<bool> Apply(IRNode* ir_node) override;
@@ -44,6 +49,18 @@ class SetupJoinTypeRule : public Rule {
    * @brief Swaps the parents and updates any parent references within Join's children nodes.
    */
   Status ConvertRightJoinToLeftJoin(JoinIR* join_ir);
+  /**
+   * @brief Swaps the parents of an inner or outer join if the right parent is estimated to be
+   * smaller than the left one.
+   */
+  StatusOr<bool> SwapToSmallerBuildSide(JoinIR* join_ir);
+  /**
+   * @brief Estimates the size of the output of op from the stats of the tables it reads, or
+   * nullopt if any of them has no stats. Operators other than joins and unions are assumed not
+   * to grow their input, so the estimate is an upper bound for them.
+   */
+  std::optional<TableSizeEstimate> EstimateSize(OperatorIR* op) const;
+  Status SwapParents(JoinIR* join_ir);
   void FlipColumns(const std::vector<ColumnIR*>& cols);
 };
 
@@ -19,6 +19,7 @@
 #include <string>
 #include <vector>
 
+#include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
 #include "src/carnot/planner/compiler/analyzer/setup_join_type_rule.h"
@@ -30,6 +31,7 @@ namespace planner {
 namespace compiler {
 
 using table_store::schema::Relation;
+using ::testing::ElementsAre;
 
 TEST_F(RulesTest, setup_join_type_rule) {
   Relation relation0({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64,
@@ -55,6 +57,71 @@ TEST_F(RulesTest, setup_join_type_rule) {
   EXPECT_EQ(join_op->parents()[1], mem_src1);
 }
 
+TEST_F(RulesTest, setup_join_type_rule_swaps_to_smaller_build_side) {
+  Relation relation0({types::DataType::INT64, types::DataType::INT64}, {"upid", "small_col"});
+  auto small_src = MakeMemSource("small_table", relation0);
+  Relation relation1({types::DataType::INT64, types::DataType::INT64}, {"upid", "large_col"});
+  auto large_src = MakeMemSource("large_table", relation1);
+
+  auto join_op = MakeJoin({large_src, small_src}, "inner", relation1, relation0,
+                          std::vector<std::string>{"upid"}, std::vector<std::string>{"upid"},
+                          std::vector<std::string>{"_x", "_y"});
+
+  compiler_state_->set_table_stats({{"small_table", {10, 1000}}, {"large_table", {1000, 100000}}});
+  SetupJoinTypeRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ConsumeValueOrDie());
+
+  EXPECT_EQ(join_op->parents()[0], small_src);
+  EXPECT_EQ(join_op->parents()[1], large_src);
+  EXPECT_EQ(join_op->left_on_columns()[0]->container_op_parent_idx(), 1);
+  EXPECT_EQ(join_op->right_on_columns()[0]->container_op_parent_idx(), 0);
+  EXPECT_THAT(join_op->suffix_strs(), ElementsAre("_y", "_x"));
+  EXPECT_TRUE(join_op->parents_reversed());
+  EXPECT_EQ(join_op->join_type(), JoinIR::JoinType::kInner);
+
+  // The smaller side is already on the left, so running again doesn't swap back.
+  result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+}
+
+TEST_F(RulesTest, setup_join_type_rule_no_swap_without_stats) {
+  Relation relation0({types::DataType::INT64, types::DataType::INT64}, {"upid", "small_col"});
+  auto small_src = MakeMemSource("small_table", relation0);
+  Relation relation1({types::DataType::INT64, types::DataType::INT64}, {"upid", "large_col"});
+  auto large_src = MakeMemSource("large_table", relation1);
+
+  auto join_op = MakeJoin({large_src, small_src}, "inner", relation1, relation0,
+                          std::vector<std::string>{"upid"}, std::vector<std::string>{"upid"});
+
+  // Only one of the tables has stats.
+  compiler_state_->set_table_stats({{"small_table", {10, 1000}}});
+  SetupJoinTypeRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+  EXPECT_EQ(join_op->parents()[0], large_src);
+}
+
+TEST_F(RulesTest, setup_join_type_rule_no_swap_for_left_join) {
+  Relation relation0({types::DataType::INT64, types::DataType::INT64}, {"upid", "small_col"});
+  auto small_src = MakeMemSource("small_table", relation0);
+  Relation relation1({types::DataType::INT64, types::DataType::INT64}, {"upid", "large_col"});
+  auto large_src = MakeMemSource("large_table", relation1);
+
+  auto join_op = MakeJoin({large_src, small_src}, "left", relation1, relation0,
+                          std::vector<std::string>{"upid"}, std::vector<std::string>{"upid"});
+
+  compiler_state_->set_table_stats({{"small_table", {10, 1000}}, {"large_table", {1000, 100000}}});
+  SetupJoinTypeRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+  EXPECT_EQ(join_op->parents()[0], large_src);
+}
+
 }  // namespace compiler
 }  // namespace planner
 }  // namespace carnot
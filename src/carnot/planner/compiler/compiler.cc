@@ -71,21 +71,30 @@ StatusOr<std::shared_ptr<IR>> Compiler::CompileToIR(const std::string& query,
 }
 
 Status Compiler::Analyze(IR* ir, CompilerState* compiler_state) {
+  ScopedPlannerTimer timer(PhaseTimings(compiler_state->planner_timings()), "analyze");
   PX_ASSIGN_OR_RETURN(std::unique_ptr<Analyzer> analyzer, Analyzer::Create(compiler_state));
+  analyzer->set_planner_timings(compiler_state->planner_timings());
   return analyzer->Execute(ir);
 }
 
 Status Compiler::Optimize(IR* ir, CompilerState* compiler_state) {
+  ScopedPlannerTimer timer(PhaseTimings(compiler_state->planner_timings()), "optimize");
   PX_ASSIGN_OR_RETURN(std::unique_ptr<Optimizer> optimizer, Optimizer::Create(compiler_state));
+  optimizer->set_planner_timings(compiler_state->planner_timings());
   return optimizer->Execute(ir);
 }
 
 StatusOr<std::shared_ptr<IR>> Compiler::QueryToIR(const std::string& query,
                                                   CompilerState* compiler_state,
                                                   const ExecFuncs& exec_funcs) {
-  Parser parser;
-  PX_ASSIGN_OR_RETURN(pypa::AstModulePtr ast, parser.Parse(query));
+  pypa::AstModulePtr ast;
+  {
+    ScopedPlannerTimer timer(PhaseTimings(compiler_state->planner_timings()), "parse");
+    Parser parser;
+    PX_ASSIGN_OR_RETURN(ast, parser.Parse(query));
+  }
 
+  ScopedPlannerTimer timer(PhaseTimings(compiler_state->planner_timings()), "ast_to_ir");
   std::shared_ptr<IR> ir = std::make_shared<IR>();
   bool func_based_exec = exec_funcs.size() > 0;
   absl::flat_hash_set<std::string> reserved_names;
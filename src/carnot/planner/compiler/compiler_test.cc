@@ -2892,6 +2892,116 @@ TEST_F(CompilerTest, pem_only_limit) {
   EXPECT_TRUE(static_cast<LimitIR*>(limit_nodes[0])->pem_only());
 }
 
+constexpr char kSortHeadQuery[] = R"pxl(
+import px
+df = px.DataFrame(table='http_events')
+df = df.sort(['req_path', 'resp_latency_ns'], ascending=[True, False]).head(10)
+df = df[['req_path', 'resp_status']]
+px.display(df)
+)pxl";
+
+TEST_F(CompilerTest, sort_head_to_top_k) {
+  ExecFuncs exec_funcs;
+
+  auto graph_or_s = compiler_.CompileToIR(kSortHeadQuery, compiler_state_.get(), exec_funcs);
+  ASSERT_OK(graph_or_s);
+  auto graph = graph_or_s.ConsumeValueOrDie();
+  EXPECT_EQ(0UL, graph->FindNodesThatMatch(Sort()).size());
+  EXPECT_EQ(0UL, graph->FindNodesThatMatch(Limit()).size());
+  auto top_k_nodes = graph->FindNodesThatMatch(TopK());
+  ASSERT_EQ(1UL, top_k_nodes.size());
+  auto top_k = static_cast<TopKIR*>(top_k_nodes[0]);
+  EXPECT_EQ(10, top_k->limit());
+  ASSERT_EQ(2UL, top_k->sort_columns().size());
+  EXPECT_EQ("req_path", top_k->sort_columns()[0].col_name);
+  EXPECT_FALSE(top_k->sort_columns()[0].descending);
+  EXPECT_EQ("resp_latency_ns", top_k->sort_columns()[1].col_name);
+  EXPECT_TRUE(top_k->sort_columns()[1].descending);
+  // The sort columns stay in the output of the TopK even though nothing after it reads them.
+  EXPECT_TRUE(top_k->resolved_table_type()->HasColumn("resp_latency_ns"));
+
+  ASSERT_OK(compiler_.Compile(kSortHeadQuery, compiler_state_.get()));
+}
+
+constexpr char kSortWithoutHeadQuery[] = R"pxl(
+import px
+df = px.DataFrame(table='http_events')
+df = df.sort('resp_latency_ns')
+px.display(df)
+)pxl";
+
+TEST_F(CompilerTest, sort_without_head) {
+  auto graph_or_s = compiler_.CompileToIR(kSortWithoutHeadQuery, compiler_state_.get());
+  EXPECT_THAT(graph_or_s.status(),
+              HasCompilerError("sort\\(\\) must be followed by head\\(\\)"));
+}
+
+constexpr char kSortUnknownColumnQuery[] = R"pxl(
+import px
+df = px.DataFrame(table='http_events')
+df = df.sort('latency').head(10)
+px.display(df)
+)pxl";
+
+TEST_F(CompilerTest, sort_unknown_column) {
+  auto graph_or_s = compiler_.CompileToIR(kSortUnknownColumnQuery, compiler_state_.get());
+  EXPECT_THAT(graph_or_s.status(),
+              HasCompilerError("Column 'latency' not found in parent dataframe"));
+}
+
+constexpr char kMergeAsOfQuery[] = R"pxl(
+import px
+requests = px.DataFrame(table='http_events', select=['time_', 'upid', 'resp_latency_ns'])
+stats = px.DataFrame(table='process_stats', select=['time_', 'upid', 'rss_bytes'])
+df = requests.merge_asof(stats, on='time_', by='upid', how='left', tolerance='30s')
+px.display(df)
+)pxl";
+
+TEST_F(CompilerTest, merge_asof) {
+  auto graph_or_s = compiler_.CompileToIR(kMergeAsOfQuery, compiler_state_.get());
+  ASSERT_OK(graph_or_s);
+  auto graph = graph_or_s.ConsumeValueOrDie();
+
+  auto join_nodes = graph->FindNodesThatMatch(AsOfJoin());
+  ASSERT_EQ(1UL, join_nodes.size());
+  auto join = static_cast<AsOfJoinIR*>(join_nodes[0]);
+  EXPECT_EQ(AsOfJoinIR::JoinType::kLeft, join->join_type());
+  EXPECT_EQ(join->tolerance_ns(),
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::seconds(30)).count());
+  Relation join_relation({types::TIME64NS, types::UINT128, types::INT64, types::INT64},
+                         {"time_", "upid", "resp_latency_ns", "rss_bytes"});
+  EXPECT_THAT(*join->resolved_table_type(), IsTableType(join_relation));
+
+  ASSERT_OK(compiler_.Compile(kMergeAsOfQuery, compiler_state_.get()));
+}
+
+constexpr char kMergeAsOfOuterQuery[] = R"pxl(
+import px
+requests = px.DataFrame(table='http_events', select=['time_', 'upid', 'resp_latency_ns'])
+stats = px.DataFrame(table='process_stats', select=['time_', 'upid', 'rss_bytes'])
+df = requests.merge_asof(stats, by='upid', how='outer')
+px.display(df)
+)pxl";
+
+TEST_F(CompilerTest, merge_asof_outer) {
+  auto graph_or_s = compiler_.CompileToIR(kMergeAsOfOuterQuery, compiler_state_.get());
+  EXPECT_THAT(graph_or_s.status(), HasCompilerError("'outer' join type not supported"));
+}
+
+constexpr char kMergeAsOfNonTimeColumnQuery[] = R"pxl(
+import px
+requests = px.DataFrame(table='http_events', select=['time_', 'upid', 'resp_latency_ns'])
+stats = px.DataFrame(table='process_stats', select=['time_', 'upid', 'rss_bytes'])
+df = requests.merge_asof(stats, on='upid')
+px.display(df)
+)pxl";
+
+TEST_F(CompilerTest, merge_asof_non_time_column) {
+  auto graph_or_s = compiler_.CompileToIR(kMergeAsOfNonTimeColumnQuery, compiler_state_.get());
+  EXPECT_THAT(graph_or_s.status(),
+              HasCompilerError("merge_asof\\(\\) 'on' column 'upid' must be TIME64NS"));
+}
+
 constexpr char kCastQuery[] = R"pxl(
 import px
 df = px.DataFrame(table='process_stats', select=['vsize_bytes'])
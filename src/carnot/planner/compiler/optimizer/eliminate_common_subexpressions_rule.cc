@@ -0,0 +1,135 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string>
+#include <vector>
+
+#include "src/carnot/planner/compiler/optimizer/eliminate_common_subexpressions_rule.h"
+#include "src/carnot/planner/ir/column_ir.h"
+#include "src/carnot/planner/ir/filter_ir.h"
+#include "src/carnot/planner/ir/func_ir.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+EliminateCommonSubexpressionsRule::ParentExpressions
+EliminateCommonSubexpressionsRule::GetParentExpressions(MapIR* parent) {
+  ParentExpressions parent_exprs;
+  absl::flat_hash_set<std::string> output_names;
+  for (const ColumnExpression& col_expr : parent->col_exprs()) {
+    output_names.insert(col_expr.name);
+    if (Match(col_expr.node, Func())) {
+      parent_exprs.exprs.push_back(col_expr);
+    }
+    if (Match(col_expr.node, ColumnNode(col_expr.name))) {
+      parent_exprs.passthrough_columns.insert(col_expr.name);
+    }
+  }
+  if (parent->keep_input_columns()) {
+    for (const std::string& input_col :
+         parent->parents()[0]->resolved_table_type()->ColumnNames()) {
+      if (!output_names.contains(input_col)) {
+        parent_exprs.passthrough_columns.insert(input_col);
+      }
+    }
+  }
+  return parent_exprs;
+}
+
+StatusOr<bool> EliminateCommonSubexpressionsRule::ReplaceExpression(
+    OperatorIR* op, IRNode* container, ExpressionIR* expr, const ParentExpressions& parent_exprs) {
+  if (!Match(expr, Func())) {
+    return false;
+  }
+  auto func = static_cast<FuncIR*>(expr);
+
+  PX_ASSIGN_OR_RETURN(auto input_columns, func->InputColumnNames());
+  // Expressions without column inputs don't depend on the row, and there is nothing to share.
+  bool reads_passthrough_columns = !input_columns.empty();
+  for (const std::string& input_col : input_columns) {
+    reads_passthrough_columns &= parent_exprs.passthrough_columns.contains(input_col);
+  }
+
+  if (reads_passthrough_columns) {
+    for (const ColumnExpression& parent_expr : parent_exprs.exprs) {
+      if (!parent_expr.node->Equals(func)) {
+        continue;
+      }
+      PX_ASSIGN_OR_RETURN(ColumnIR * col, func->graph()->CreateNode<ColumnIR>(
+                                              func->ast(), parent_expr.name, /*parent_op_idx*/ 0));
+      // Keep the metadata annotations so that agent pruning still recognizes the expression.
+      col->set_annotations(func->annotations());
+      PX_RETURN_IF_ERROR(ResolveExpressionType(col, compiler_state_, op->parent_types()));
+
+      if (Match(container, Map())) {
+        PX_RETURN_IF_ERROR(static_cast<MapIR*>(container)->UpdateColExpr(func, col));
+      } else if (Match(container, Filter())) {
+        PX_RETURN_IF_ERROR(static_cast<FilterIR*>(container)->SetFilterExpr(col));
+      } else {
+        PX_RETURN_IF_ERROR(static_cast<FuncIR*>(container)->UpdateArg(func, col));
+      }
+      return true;
+    }
+  }
+
+  bool changed = false;
+  // Copy the args, since replacing one modifies the func's arg list.
+  std::vector<ExpressionIR*> args = func->all_args();
+  for (ExpressionIR* arg : args) {
+    PX_ASSIGN_OR_RETURN(bool arg_changed, ReplaceExpression(op, func, arg, parent_exprs));
+    changed |= arg_changed;
+  }
+  return changed;
+}
+
+StatusOr<bool> EliminateCommonSubexpressionsRule::Apply(IRNode* ir_node) {
+  if (!Match(ir_node, Map()) && !Match(ir_node, Filter())) {
+    return false;
+  }
+  auto op = static_cast<OperatorIR*>(ir_node);
+  if (op->parents().size() != 1 || !Match(op->parents()[0], Map())) {
+    return false;
+  }
+  ParentExpressions parent_exprs = GetParentExpressions(static_cast<MapIR*>(op->parents()[0]));
+  if (parent_exprs.exprs.empty()) {
+    return false;
+  }
+
+  if (Match(op, Filter())) {
+    auto filter = static_cast<FilterIR*>(op);
+    return ReplaceExpression(op, filter, filter->filter_expr(), parent_exprs);
+  }
+
+  bool changed = false;
+  std::vector<ExpressionIR*> exprs;
+  for (const ColumnExpression& col_expr : static_cast<MapIR*>(op)->col_exprs()) {
+    exprs.push_back(col_expr.node);
+  }
+  for (ExpressionIR* expr : exprs) {
+    PX_ASSIGN_OR_RETURN(bool expr_changed, ReplaceExpression(op, op, expr, parent_exprs));
+    changed |= expr_changed;
+  }
+  return changed;
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
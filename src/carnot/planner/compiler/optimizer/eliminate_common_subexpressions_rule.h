@@ -0,0 +1,67 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "src/carnot/planner/ir/map_ir.h"
+#include "src/carnot/planner/rules/rules.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+/**
+ * @brief This rule reuses expressions that a parent Map already computes. Generated scripts often
+ * recompute the same expression in consecutive operators, for example:
+ *
+ * df.window = px.bin(df.time_, px.DurationNanos(10 * 1000 * 1000 * 1000))
+ * df = df[px.bin(df.time_, px.DurationNanos(10 * 1000 * 1000 * 1000)) > start]
+ *
+ * When a Map or Filter contains a function expression that is equal to an output expression of
+ * its parent Map, and every column the expression reads passes through the parent unchanged, the
+ * expression is replaced with a reference to the parent's output column.
+ */
+class EliminateCommonSubexpressionsRule : public Rule {
+ public:
+  explicit EliminateCommonSubexpressionsRule(CompilerState* compiler_state)
+      : Rule(compiler_state, /*use_topo*/ true, /*reverse_topological_execution*/ false) {}
+
+ protected:
+  StatusOr<bool> Apply(IRNode* ir_node) override;
+
+ private:
+  struct ParentExpressions {
+    // The output expressions of the parent Map that are worth reusing.
+    std::vector<ColumnExpression> exprs;
+    // Columns that the parent Map outputs unchanged from its input.
+    absl::flat_hash_set<std::string> passthrough_columns;
+  };
+
+  static ParentExpressions GetParentExpressions(MapIR* parent);
+  StatusOr<bool> ReplaceExpression(OperatorIR* op, IRNode* container, ExpressionIR* expr,
+                                   const ParentExpressions& parent_exprs);
+};
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include "src/carnot/planner/compiler/optimizer/eliminate_common_subexpressions_rule.h"
+#include "src/carnot/planner/compiler/test_utils.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+using EliminateCommonSubexpressionsRuleTest = RulesTest;
+
+TEST_F(EliminateCommonSubexpressionsRuleTest, reuse_parent_map_expression) {
+  MemorySourceIR* mem_src = MakeMemSource(MakeRelation());
+  compiler_state_->relation_map()->emplace("table", MakeRelation());
+
+  auto parent_map = MakeMap(
+      mem_src, {{"cpu_sum", MakeAddFunc(MakeColumn("cpu0", 0), MakeColumn("cpu1", 0))}},
+      /*keep_input_columns*/ true);
+  auto repeated_sum = MakeAddFunc(MakeColumn("cpu0", 0), MakeColumn("cpu1", 0));
+  auto doubled = MakeMultFunc(repeated_sum, MakeInt(2));
+  auto child_map = MakeMap(parent_map, {{"doubled", doubled}}, /*keep_input_columns*/ true);
+  MakeMemSink(child_map, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  EliminateCommonSubexpressionsRule rule(compiler_state_.get());
+  ASSERT_OK_AND_ASSIGN(bool changed, rule.Execute(graph.get()));
+  EXPECT_TRUE(changed);
+
+  EXPECT_FALSE(graph->HasNode(repeated_sum->id()));
+  ASSERT_MATCH(doubled->all_args()[0], ColumnNode("cpu_sum", 0));
+  EXPECT_EQ(types::FLOAT64, doubled->all_args()[0]->EvaluatedDataType());
+}
+
+TEST_F(EliminateCommonSubexpressionsRuleTest, reuse_in_filter) {
+  MemorySourceIR* mem_src = MakeMemSource(MakeRelation());
+  compiler_state_->relation_map()->emplace("table", MakeRelation());
+
+  auto parent_map = MakeMap(
+      mem_src, {{"cpu_sum", MakeAddFunc(MakeColumn("cpu0", 0), MakeColumn("cpu1", 0))}},
+      /*keep_input_columns*/ true);
+  auto repeated_sum = MakeAddFunc(MakeColumn("cpu0", 0), MakeColumn("cpu1", 0));
+  auto filter_expr = MakeEqualsFunc(repeated_sum, MakeFloat(1.0));
+  auto filter = MakeFilter(parent_map, filter_expr);
+  MakeMemSink(filter, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  EliminateCommonSubexpressionsRule rule(compiler_state_.get());
+  ASSERT_OK_AND_ASSIGN(bool changed, rule.Execute(graph.get()));
+  EXPECT_TRUE(changed);
+
+  EXPECT_EQ(filter_expr, filter->filter_expr());
+  ASSERT_MATCH(filter_expr->all_args()[0], ColumnNode("cpu_sum", 0));
+}
+
+TEST_F(EliminateCommonSubexpressionsRuleTest, overwritten_input_not_reused) {
+  MemorySourceIR* mem_src = MakeMemSource(MakeRelation());
+  compiler_state_->relation_map()->emplace("table", MakeRelation());
+
+  // cpu0 is overwritten by the parent, so the child's cpu0 + cpu1 is a different value.
+  auto parent_map =
+      MakeMap(mem_src,
+              {{"cpu0", MakeMultFunc(MakeColumn("cpu0", 0), MakeInt(2))},
+               {"cpu_sum", MakeAddFunc(MakeColumn("cpu0", 0), MakeColumn("cpu1", 0))}},
+              /*keep_input_columns*/ true);
+  auto repeated_sum = MakeAddFunc(MakeColumn("cpu0", 0), MakeColumn("cpu1", 0));
+  auto child_map = MakeMap(parent_map, {{"sum", repeated_sum}}, /*keep_input_columns*/ true);
+  MakeMemSink(child_map, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  EliminateCommonSubexpressionsRule rule(compiler_state_.get());
+  ASSERT_OK_AND_ASSIGN(bool changed, rule.Execute(graph.get()));
+  EXPECT_FALSE(changed);
+  EXPECT_TRUE(graph->HasNode(repeated_sum->id()));
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
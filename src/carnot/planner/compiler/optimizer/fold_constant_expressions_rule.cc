@@ -0,0 +1,148 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string>
+#include <vector>
+
+#include "src/carnot/planner/compiler/optimizer/fold_constant_expressions_rule.h"
+#include "src/carnot/planner/ir/filter_ir.h"
+#include "src/carnot/planner/ir/float_ir.h"
+#include "src/carnot/planner/ir/func_ir.h"
+#include "src/carnot/planner/ir/int_ir.h"
+#include "src/carnot/planner/ir/map_ir.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+namespace {
+
+bool IsNumericLiteral(ExpressionIR* expr) { return Match(expr, Int()) || Match(expr, Float()); }
+
+double LiteralAsDouble(ExpressionIR* expr) {
+  if (Match(expr, Int())) {
+    return static_cast<double>(static_cast<IntIR*>(expr)->val());
+  }
+  return static_cast<FloatIR*>(expr)->val();
+}
+
+}  // namespace
+
+StatusOr<ExpressionIR*> FoldConstantExpressionsRule::FoldFunc(FuncIR* func) {
+  const std::string& name = func->func_name();
+  if (name != "add" && name != "subtract" && name != "multiply" && name != "divide") {
+    return nullptr;
+  }
+  if (func->all_args().size() != 2) {
+    return nullptr;
+  }
+  ExpressionIR* lhs = func->all_args()[0];
+  ExpressionIR* rhs = func->all_args()[1];
+  if (!IsNumericLiteral(lhs) || !IsNumericLiteral(rhs)) {
+    return nullptr;
+  }
+
+  IR* graph = func->graph();
+  // Integer division returns a float in Carnot, so only the other ops keep integer operands
+  // integral.
+  if (Match(lhs, Int()) && Match(rhs, Int()) && name != "divide") {
+    int64_t a = static_cast<IntIR*>(lhs)->val();
+    int64_t b = static_cast<IntIR*>(rhs)->val();
+    int64_t result;
+    bool overflow;
+    if (name == "add") {
+      overflow = __builtin_add_overflow(a, b, &result);
+    } else if (name == "subtract") {
+      overflow = __builtin_sub_overflow(a, b, &result);
+    } else {
+      overflow = __builtin_mul_overflow(a, b, &result);
+    }
+    if (overflow) {
+      return nullptr;
+    }
+    return graph->CreateNode<IntIR>(func->ast(), result);
+  }
+
+  double a = LiteralAsDouble(lhs);
+  double b = LiteralAsDouble(rhs);
+  double result;
+  if (name == "add") {
+    result = a + b;
+  } else if (name == "subtract") {
+    result = a - b;
+  } else if (name == "multiply") {
+    result = a * b;
+  } else {
+    result = a / b;
+  }
+  return graph->CreateNode<FloatIR>(func->ast(), result);
+}
+
+Status FoldConstantExpressionsRule::ReplaceInContainer(IRNode* container, ExpressionIR* old_expr,
+                                                       ExpressionIR* new_expr) {
+  if (Match(container, Func())) {
+    return static_cast<FuncIR*>(container)->UpdateArg(old_expr, new_expr);
+  }
+  if (Match(container, Map())) {
+    return static_cast<MapIR*>(container)->UpdateColExpr(old_expr, new_expr);
+  }
+  if (Match(container, Filter())) {
+    return static_cast<FilterIR*>(container)->SetFilterExpr(new_expr);
+  }
+  return error::Internal("Unsupported IRNode container for folded expression: $0",
+                         container->DebugString());
+}
+
+StatusOr<bool> FoldConstantExpressionsRule::Apply(IRNode* ir_node) {
+  if (!Match(ir_node, Func())) {
+    return false;
+  }
+  auto func = static_cast<FuncIR*>(ir_node);
+  IR* graph = func->graph();
+
+  // Only fold expressions whose containers we know how to update, so that we never leave a
+  // dangling literal in the graph.
+  std::vector<IRNode*> containers;
+  for (int64_t parent_id : graph->dag().ParentsOf(func->id())) {
+    IRNode* container = graph->Get(parent_id);
+    if (!Match(container, Func()) && !Match(container, Map()) && !Match(container, Filter())) {
+      return false;
+    }
+    containers.push_back(container);
+  }
+
+  PX_ASSIGN_OR_RETURN(ExpressionIR * folded, FoldFunc(func));
+  if (folded == nullptr) {
+    return false;
+  }
+  if (func->HasTypeCast()) {
+    folded->SetTypeCast(func->type_cast());
+  }
+  PX_RETURN_IF_ERROR(ResolveExpressionType(folded, compiler_state_, {}));
+
+  for (IRNode* container : containers) {
+    PX_RETURN_IF_ERROR(ReplaceInContainer(container, func, folded));
+  }
+  return true;
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
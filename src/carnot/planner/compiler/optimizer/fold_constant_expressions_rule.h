@@ -0,0 +1,55 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "src/carnot/planner/rules/rules.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+/**
+ * @brief This rule replaces arithmetic on numeric literals with the literal result, so that
+ * expressions such as the following are not evaluated for every row at execution time:
+ *
+ * df.latency_ms = px.duration_nanos(df.latency) / (1000 * 1000)
+ *
+ * Only add, subtract, multiply and divide over Int and Float literals are folded. Integer
+ * arithmetic that would overflow is left for the executor.
+ */
+class FoldConstantExpressionsRule : public Rule {
+ public:
+  explicit FoldConstantExpressionsRule(CompilerState* compiler_state)
+      : Rule(compiler_state, /*use_topo*/ true, /*reverse_topological_execution*/ true) {}
+
+ protected:
+  StatusOr<bool> Apply(IRNode* ir_node) override;
+  /**
+   * @brief Creates the literal that `func` evaluates to, or returns nullptr if `func` can't be
+   * folded.
+   */
+  StatusOr<ExpressionIR*> FoldFunc(FuncIR* func);
+  Status ReplaceInContainer(IRNode* container, ExpressionIR* old_expr, ExpressionIR* new_expr);
+};
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <limits>
+
+#include <gtest/gtest.h>
+
+#include "src/carnot/planner/compiler/optimizer/fold_constant_expressions_rule.h"
+#include "src/carnot/planner/compiler/test_utils.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+using FoldConstantExpressionsRuleTest = RulesTest;
+
+TEST_F(FoldConstantExpressionsRuleTest, nested_arithmetic) {
+  MemorySourceIR* mem_src = MakeMemSource(MakeRelation());
+  compiler_state_->relation_map()->emplace("table", MakeRelation());
+
+  // count * (1000 * 1000)
+  auto int_product = MakeMultFunc(MakeInt(1000), MakeInt(1000));
+  auto scaled = MakeMultFunc(MakeColumn("count", 0), int_product);
+  // cpu0 + ((1 + 0.5) * 2)
+  auto float_sum = MakeAddFunc(MakeInt(1), MakeFloat(0.5));
+  auto float_product = MakeMultFunc(float_sum, MakeInt(2));
+  auto shifted = MakeAddFunc(MakeColumn("cpu0", 0), float_product);
+
+  auto map = MakeMap(mem_src, {{"scaled", scaled}, {"shifted", shifted}});
+  MakeMemSink(map, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  FoldConstantExpressionsRule rule(compiler_state_.get());
+  ASSERT_OK_AND_ASSIGN(bool changed, rule.Execute(graph.get()));
+  EXPECT_TRUE(changed);
+
+  EXPECT_FALSE(graph->HasNode(int_product->id()));
+  EXPECT_FALSE(graph->HasNode(float_sum->id()));
+  EXPECT_FALSE(graph->HasNode(float_product->id()));
+
+  ASSERT_MATCH(scaled->all_args()[1], Int(1000 * 1000));
+  EXPECT_EQ(types::INT64, scaled->all_args()[1]->EvaluatedDataType());
+  ASSERT_MATCH(shifted->all_args()[1], Float());
+  EXPECT_EQ(3.0, static_cast<FloatIR*>(shifted->all_args()[1])->val());
+  EXPECT_EQ(types::FLOAT64, shifted->all_args()[1]->EvaluatedDataType());
+}
+
+TEST_F(FoldConstantExpressionsRuleTest, integer_division_folds_to_float) {
+  MemorySourceIR* mem_src = MakeMemSource(MakeRelation());
+  compiler_state_->relation_map()->emplace("table", MakeRelation());
+
+  auto quotient = MakeFunc("divide", {MakeInt(3), MakeInt(2)});
+  auto filter = MakeFilter(mem_src, MakeEqualsFunc(MakeColumn("cpu0", 0), quotient));
+  MakeMemSink(filter, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  FoldConstantExpressionsRule rule(compiler_state_.get());
+  ASSERT_OK_AND_ASSIGN(bool changed, rule.Execute(graph.get()));
+  EXPECT_TRUE(changed);
+
+  auto equals = static_cast<FuncIR*>(filter->filter_expr());
+  ASSERT_MATCH(equals->all_args()[1], Float());
+  EXPECT_EQ(1.5, static_cast<FloatIR*>(equals->all_args()[1])->val());
+}
+
+TEST_F(FoldConstantExpressionsRuleTest, overflow_not_folded) {
+  MemorySourceIR* mem_src = MakeMemSource(MakeRelation());
+  compiler_state_->relation_map()->emplace("table", MakeRelation());
+
+  auto product = MakeMultFunc(MakeInt(std::numeric_limits<int64_t>::max()), MakeInt(2));
+  auto map = MakeMap(mem_src, {{"product", product}});
+  MakeMemSink(map, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  FoldConstantExpressionsRule rule(compiler_state_.get());
+  ASSERT_OK_AND_ASSIGN(bool changed, rule.Execute(graph.get()));
+  EXPECT_FALSE(changed);
+  EXPECT_TRUE(graph->HasNode(product->id()));
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -23,10 +23,13 @@
 #include <unordered_set>
 #include <vector>
 
+#include "src/carnot/planner/compiler/optimizer/eliminate_common_subexpressions_rule.h"
+#include "src/carnot/planner/compiler/optimizer/fold_constant_expressions_rule.h"
 #include "src/carnot/planner/compiler/optimizer/merge_nodes_rule.h"
 #include "src/carnot/planner/compiler/optimizer/prune_unconnected_operators_rule.h"
 #include "src/carnot/planner/compiler/optimizer/prune_unused_columns_rule.h"
 #include "src/carnot/planner/compiler/optimizer/prune_unused_contains_rule.h"
+#include "src/carnot/planner/compiler/optimizer/resolve_metadata_after_agg_rule.h"
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/compiler_state/registry_info.h"
 #include "src/carnot/planner/ir/ir.h"
@@ -58,6 +61,17 @@ class Optimizer : public RuleExecutor<IR> {
     merge_nodes_batch->AddRule<MergeNodesRule>(compiler_state_);
   }
 
+  void CreateResolveMetadataAfterAggBatch() {
+    RuleBatch* resolve_metadata_after_agg = CreateRuleBatch<DoOnce>("ResolveMetadataAfterAgg");
+    resolve_metadata_after_agg->AddRule<ResolveMetadataAfterAggRule>(compiler_state_);
+  }
+
+  void CreateSimplifyExpressionsBatch() {
+    RuleBatch* simplify_exprs = CreateRuleBatch<TryUntilMax>("SimplifyExpressions", 2);
+    simplify_exprs->AddRule<FoldConstantExpressionsRule>(compiler_state_);
+    simplify_exprs->AddRule<EliminateCommonSubexpressionsRule>(compiler_state_);
+  }
+
   void CreatePruneUnusedColumnsBatch() {
     RuleBatch* prune_unused_columns = CreateRuleBatch<FailOnMax>("PruneUnusedColumns", 2);
     prune_unused_columns->AddRule<PruneUnusedColumnsRule>();
@@ -71,6 +85,8 @@ class Optimizer : public RuleExecutor<IR> {
   Status Init() {
     CreatePruneUnconnectedOpsBatch();
     CreateMergeNodesBatch();
+    CreateResolveMetadataAfterAggBatch();
+    CreateSimplifyExpressionsBatch();
     CreatePruneUnusedColumnsBatch();
     CreatePruneUnusedContainsBatch();
     return Status::OK();
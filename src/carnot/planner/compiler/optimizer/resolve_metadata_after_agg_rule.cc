@@ -0,0 +1,157 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/compiler/optimizer/resolve_metadata_after_agg_rule.h"
+
+#include <algorithm>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+StatusOr<FuncIR*> ResolveMetadataAfterAggRule::FindHoistableConversion(
+    MapIR* map, ColumnIR* group, const std::vector<ColumnIR*>& groups) const {
+  FuncIR* conversion = nullptr;
+  for (const auto& col_expr : map->col_exprs()) {
+    if (col_expr.name == group->col_name() && Match(col_expr.node, Func())) {
+      conversion = static_cast<FuncIR*>(col_expr.node);
+    }
+  }
+  if (conversion == nullptr || !conversion->annotations().metadata_type_set() ||
+      conversion->all_args().size() != 1 || !conversion->all_args()[0]->IsColumn()) {
+    return nullptr;
+  }
+
+  // The conversion is only a function of the group if its key is also a group.
+  std::string key_col_name = static_cast<ColumnIR*>(conversion->all_args()[0])->col_name();
+  if (key_col_name == group->col_name() ||
+      std::none_of(groups.begin(), groups.end(),
+                   [&](ColumnIR* g) { return g->col_name() == key_col_name; })) {
+    return nullptr;
+  }
+
+  // The key must reach the aggregate unchanged for the conversion to be recomputed after it.
+  bool key_passes_through = map->keep_input_columns();
+  for (const auto& col_expr : map->col_exprs()) {
+    if (col_expr.name == key_col_name) {
+      key_passes_through = Match(col_expr.node, ColumnNode(key_col_name));
+    }
+  }
+  if (!key_passes_through) {
+    return nullptr;
+  }
+
+  if (!conversion->HasRegistryArgTypes()) {
+    return error::Internal("func '$0' doesn't have RegistryArgTypes set.",
+                           conversion->func_name());
+  }
+  PX_ASSIGN_OR_RETURN(auto executor,
+                      compiler_state_->registry_info()->GetUDFSourceExecutor(
+                          conversion->func_name(), conversion->registry_arg_types()));
+  if (executor == udfspb::UDFSourceExecutor::UDF_PEM) {
+    return nullptr;
+  }
+  return conversion;
+}
+
+Status ResolveMetadataAfterAggRule::ResolveAfterAgg(BlockingAggIR* agg,
+                                                    const std::vector<HoistedGroup>& hoisted) {
+  IR* graph = agg->graph();
+  absl::flat_hash_map<std::string, FuncIR*> conversions;
+  for (const auto& h : hoisted) {
+    conversions[h.group->col_name()] = h.conversion;
+  }
+
+  // The new Map reproduces the original output of the aggregate, column for column.
+  ColExpressionVector col_exprs;
+  for (ColumnIR* group : agg->groups()) {
+    ExpressionIR* expr;
+    auto it = conversions.find(group->col_name());
+    if (it != conversions.end()) {
+      PX_ASSIGN_OR_RETURN(expr, graph->CopyNode(it->second));
+    } else {
+      PX_ASSIGN_OR_RETURN(expr, graph->CreateNode<ColumnIR>(agg->ast(), group->col_name(),
+                                                            /*parent_op_idx*/ 0));
+    }
+    col_exprs.emplace_back(group->col_name(), expr);
+  }
+  for (const auto& agg_expr : agg->aggregate_expressions()) {
+    PX_ASSIGN_OR_RETURN(ColumnIR * col, graph->CreateNode<ColumnIR>(agg->ast(), agg_expr.name,
+                                                                    /*parent_op_idx*/ 0));
+    col_exprs.emplace_back(agg_expr.name, col);
+  }
+
+  // Grab the children before the new Map becomes one of them.
+  std::vector<OperatorIR*> children = agg->Children();
+  PX_ASSIGN_OR_RETURN(MapIR * map, graph->CreateNode<MapIR>(agg->ast(), agg, col_exprs,
+                                                            /*keep_input_columns*/ false));
+  for (OperatorIR* child : children) {
+    PX_RETURN_IF_ERROR(child->ReplaceParent(agg, map));
+  }
+  for (const auto& h : hoisted) {
+    PX_RETURN_IF_ERROR(agg->RemoveGroup(h.group));
+  }
+  return PropagateTypeChangesFromNode(graph, agg, compiler_state_);
+}
+
+StatusOr<bool> ResolveMetadataAfterAggRule::Apply(IRNode* ir_node) {
+  if (!Match(ir_node, FullAgg())) {
+    return false;
+  }
+  auto agg = static_cast<BlockingAggIR*>(ir_node);
+  // Removing a group would shift the index of the window group.
+  if (agg->time_windowed() || !Match(agg->parents()[0], Map())) {
+    return false;
+  }
+  auto map = static_cast<MapIR*>(agg->parents()[0]);
+
+  absl::flat_hash_set<std::string> aggregated_columns;
+  for (const auto& agg_expr : agg->aggregate_expressions()) {
+    for (ExpressionIR* arg : static_cast<FuncIR*>(agg_expr.node)->all_args()) {
+      if (arg->IsColumn()) {
+        aggregated_columns.insert(static_cast<ColumnIR*>(arg)->col_name());
+      }
+    }
+  }
+
+  std::vector<ColumnIR*> groups = agg->groups();
+  std::vector<HoistedGroup> hoisted;
+  for (ColumnIR* group : groups) {
+    if (aggregated_columns.contains(group->col_name())) {
+      continue;
+    }
+    PX_ASSIGN_OR_RETURN(FuncIR * conversion, FindHoistableConversion(map, group, groups));
+    if (conversion != nullptr) {
+      hoisted.push_back({group, conversion});
+    }
+  }
+  if (hoisted.empty()) {
+    return false;
+  }
+  PX_RETURN_IF_ERROR(ResolveAfterAgg(agg, hoisted));
+  return true;
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
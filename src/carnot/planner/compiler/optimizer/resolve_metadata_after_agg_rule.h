@@ -0,0 +1,72 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "src/carnot/planner/rules/rules.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+/**
+ * @brief This rule moves metadata conversions that are only used as aggregate groups to after the
+ * aggregate when the aggregate also groups by the key the metadata is converted from:
+ *
+ * df.pod = df.ctx['pod']
+ * df = df.groupby(['upid', 'pod']).agg(...)
+ *
+ * The pod name is a function of the upid, so grouping by it is redundant. The rule drops the pod
+ * group and recomputes it in a new Map on the aggregated output, which is usually much smaller
+ * than the input. The output relation of the aggregate (as seen by its children) is unchanged.
+ * The now unused conversion in the parent Map is removed by PruneUnusedColumnsRule.
+ *
+ * Aggregates are finalized on Kelvin in distributed plans, so only conversions that can run on
+ * Kelvin are moved. PEM-only conversions (ie upid_to_pod_name) stay before the aggregate.
+ */
+class ResolveMetadataAfterAggRule : public Rule {
+ public:
+  explicit ResolveMetadataAfterAggRule(CompilerState* compiler_state)
+      : Rule(compiler_state, /*use_topo*/ true, /*reverse_topological_execution*/ false) {}
+
+ protected:
+  StatusOr<bool> Apply(IRNode* ir_node) override;
+
+ private:
+  struct HoistedGroup {
+    ColumnIR* group;
+    FuncIR* conversion;
+  };
+
+  /**
+   * @brief Returns the metadata conversion that produces `group` in `map` if it's a function of
+   * another group column that passes through the map unchanged, nullptr otherwise.
+   */
+  StatusOr<FuncIR*> FindHoistableConversion(MapIR* map, ColumnIR* group,
+                                            const std::vector<ColumnIR*>& groups) const;
+  Status ResolveAfterAgg(BlockingAggIR* agg, const std::vector<HoistedGroup>& hoisted);
+};
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "src/carnot/planner/compiler/analyzer/analyzer.h"
+#include "src/carnot/planner/compiler/optimizer/resolve_metadata_after_agg_rule.h"
+#include "src/carnot/planner/compiler/test_utils.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+using table_store::schema::Relation;
+using ::testing::ElementsAre;
+
+class ResolveMetadataAfterAggRuleTest : public RulesTest {
+ protected:
+  void SetUp() override {
+    RulesTest::SetUp();
+    relation_ = Relation({types::UINT128, types::STRING, types::INT64},
+                         {"upid", "pod_id", "latency"},
+                         {types::ST_UPID, types::ST_NONE, types::ST_NONE});
+    compiler_state_->relation_map()->emplace("table", relation_);
+  }
+
+  // Builds df.pod = <conversion>(df.<key_col>); df.groupby(groups).agg(latency=mean(latency)).
+  BlockingAggIR* MakeConvertAndAgg(const std::string& conversion, const std::string& key_col,
+                                   const std::vector<std::string>& groups) {
+    auto mem_src = MakeMemSource("table", relation_);
+    auto func = MakeFunc(conversion, {MakeColumn(key_col, 0)});
+    func->set_annotations(ExpressionIR::Annotations(MetadataType::POD_NAME));
+    auto map = MakeMap(mem_src, {{"pod", func}}, /*keep_input_columns*/ true);
+    std::vector<ColumnIR*> group_cols;
+    for (const auto& group : groups) {
+      group_cols.push_back(MakeColumn(group, 0));
+    }
+    return MakeBlockingAgg(map, group_cols, {{"latency", MakeMeanFunc(MakeColumn("latency", 0))}});
+  }
+
+  Relation relation_;
+};
+
+TEST_F(ResolveMetadataAfterAggRuleTest, moves_conversion_after_agg) {
+  auto agg = MakeConvertAndAgg("pod_id_to_pod_name", "pod_id", {"pod", "pod_id"});
+  auto sink = MakeMemSink(agg, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+  auto expected_type = agg->resolved_table_type()->Copy();
+
+  ResolveMetadataAfterAggRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  ASSERT_TRUE(result.ConsumeValueOrDie());
+
+  ASSERT_EQ(agg->groups().size(), 1);
+  EXPECT_MATCH(agg->groups()[0], ColumnNode("pod_id"));
+
+  ASSERT_EQ(sink->parents().size(), 1);
+  ASSERT_MATCH(sink->parents()[0], Map());
+  auto new_map = static_cast<MapIR*>(sink->parents()[0]);
+  EXPECT_EQ(new_map->parents()[0], agg);
+  ASSERT_EQ(new_map->col_exprs().size(), 3);
+  EXPECT_EQ(new_map->col_exprs()[0].name, "pod");
+  EXPECT_MATCH(new_map->col_exprs()[0].node, Func("pod_id_to_pod_name"));
+  EXPECT_EQ(new_map->col_exprs()[1].name, "pod_id");
+  EXPECT_EQ(new_map->col_exprs()[2].name, "latency");
+  EXPECT_THAT(new_map->resolved_table_type()->ColumnNames(),
+              ElementsAre("pod", "pod_id", "latency"));
+  EXPECT_TRUE(new_map->resolved_table_type()->Equals(expected_type));
+}
+
+TEST_F(ResolveMetadataAfterAggRuleTest, keeps_conversion_without_key_group) {
+  auto agg = MakeConvertAndAgg("pod_id_to_pod_name", "pod_id", {"pod"});
+  MakeMemSink(agg, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  ResolveMetadataAfterAggRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+  EXPECT_EQ(agg->groups().size(), 1);
+}
+
+TEST_F(ResolveMetadataAfterAggRuleTest, keeps_pem_only_conversion) {
+  auto agg = MakeConvertAndAgg("upid_to_pod_name", "upid", {"upid", "pod"});
+  MakeMemSink(agg, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  ResolveMetadataAfterAggRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+  EXPECT_EQ(agg->groups().size(), 2);
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -560,6 +560,17 @@ class OperatorTests : public ::testing::Test {
     return limit;
   }
 
+  SortIR* MakeSort(OperatorIR* parent, const std::vector<SortColumn>& sort_columns) {
+    SortIR* sort = graph->CreateNode<SortIR>(ast, parent, sort_columns).ConsumeValueOrDie();
+    return sort;
+  }
+
+  TopKIR* MakeTopK(OperatorIR* parent, const std::vector<SortColumn>& sort_columns,
+                   int64_t limit) {
+    TopKIR* top_k = graph->CreateNode<TopKIR>(ast, parent, sort_columns, limit).ConsumeValueOrDie();
+    return top_k;
+  }
+
   BlockingAggIR* MakeBlockingAgg(OperatorIR* parent, const std::vector<ColumnIR*>& columns,
                                  const ColExpressionVector& col_agg) {
     BlockingAggIR* agg =
@@ -761,6 +772,23 @@ class OperatorTests : public ::testing::Test {
         .ConsumeValueOrDie();
   }
 
+  AsOfJoinIR* MakeAsOfJoin(const std::vector<OperatorIR*>& parents, const std::string& join_type,
+                           const std::string& on_col_name,
+                           const std::vector<std::string>& by_col_names, int64_t tolerance_ns = 0,
+                           const std::vector<std::string>& suffix_strs = {"_x", "_y"}) {
+    std::vector<ColumnIR*> left_by_cols;
+    std::vector<ColumnIR*> right_by_cols;
+    for (const auto& by_name : by_col_names) {
+      left_by_cols.push_back(MakeColumn(by_name, 0));
+      right_by_cols.push_back(MakeColumn(by_name, 1));
+    }
+    return graph
+        ->CreateNode<AsOfJoinIR>(ast, parents, join_type, MakeColumn(on_col_name, 0),
+                                 MakeColumn(on_col_name, 1), left_by_cols, right_by_cols,
+                                 tolerance_ns, suffix_strs)
+        .ConsumeValueOrDie();
+  }
+
   // Use this if you need a relation but don't care about the contents.
   table_store::schema::Relation MakeRelation() {
     return table_store::schema::Relation(
@@ -1417,6 +1445,16 @@ void CompareCloneNode(LimitIR* new_ir, LimitIR* old_ir, const std::string& err_s
   EXPECT_EQ(new_ir->limit_value_set(), old_ir->limit_value_set()) << err_string;
 }
 
+template <>
+void CompareCloneNode(TopKIR* new_ir, TopKIR* old_ir, const std::string& err_string) {
+  EXPECT_EQ(new_ir->limit(), old_ir->limit()) << err_string;
+  ASSERT_EQ(new_ir->sort_columns().size(), old_ir->sort_columns().size()) << err_string;
+  for (const auto& [idx, sort_col] : Enumerate(new_ir->sort_columns())) {
+    EXPECT_EQ(sort_col.col_name, old_ir->sort_columns()[idx].col_name) << err_string;
+    EXPECT_EQ(sort_col.descending, old_ir->sort_columns()[idx].descending) << err_string;
+  }
+}
+
 template <>
 void CompareCloneNode(FuncIR* new_ir, FuncIR* old_ir, const std::string& err_string) {
   EXPECT_TRUE(new_ir->Equals(old_ir)) << err_string;
@@ -1481,6 +1519,36 @@ void CompareCloneNode(JoinIR* new_ir, JoinIR* old_ir, const std::string& err_str
   }
 }
 
+template <>
+void CompareCloneNode(AsOfJoinIR* new_ir, AsOfJoinIR* old_ir, const std::string& err_string) {
+  ASSERT_EQ(new_ir->join_type(), old_ir->join_type());
+  EXPECT_EQ(new_ir->tolerance_ns(), old_ir->tolerance_ns()) << err_string;
+  EXPECT_THAT(new_ir->column_names(), ::testing::ElementsAreArray(old_ir->column_names()))
+      << err_string;
+  EXPECT_THAT(new_ir->suffix_strs(), ::testing::ElementsAreArray(old_ir->suffix_strs()))
+      << err_string;
+  bool same_graph = new_ir->graph() == old_ir->graph();
+  std::string col_err_string = absl::Substitute("$0; in AsOfJoin operator.", err_string);
+
+  auto output_columns_new = new_ir->output_columns();
+  auto output_columns_old = old_ir->output_columns();
+  ASSERT_EQ(output_columns_new.size(), output_columns_old.size()) << err_string;
+  for (size_t i = 0; i < output_columns_new.size(); ++i) {
+    CompareClone(output_columns_new[i], output_columns_old[i], same_graph, col_err_string);
+  }
+  CompareClone(new_ir->left_time_column(), old_ir->left_time_column(), same_graph,
+               col_err_string);
+  CompareClone(new_ir->right_time_column(), old_ir->right_time_column(), same_graph,
+               col_err_string);
+  ASSERT_EQ(new_ir->left_by_columns().size(), old_ir->left_by_columns().size()) << err_string;
+  for (size_t i = 0; i < new_ir->left_by_columns().size(); ++i) {
+    CompareClone(new_ir->left_by_columns()[i], old_ir->left_by_columns()[i], same_graph,
+                 col_err_string);
+    CompareClone(new_ir->right_by_columns()[i], old_ir->right_by_columns()[i], same_graph,
+                 col_err_string);
+  }
+}
+
 void CompareClone(IRNode* new_ir, IRNode* old_ir, const std::string& err_string) {
   ASSERT_NE(new_ir, nullptr);
   ASSERT_NE(old_ir, nullptr);
@@ -25,6 +25,7 @@
 #include <utility>
 #include <vector>
 
+#include "src/carnot/planner/compiler_state/planner_timings.h"
 #include "src/carnot/planner/compiler_state/registry_info.h"
 
 #include "src/common/base/base.h"
@@ -105,7 +106,14 @@ struct DebugInfo {
   std::vector<OTelDebugAttribute> otel_debug_attrs;
 };
 
+// Size estimates for a table, used for cost-based planning decisions.
+struct TableSizeEstimate {
+  int64_t num_rows = 0;
+  int64_t bytes = 0;
+};
+
 using RelationMap = std::unordered_map<std::string, table_store::schema::Relation>;
+using TableStatsMap = absl::flat_hash_map<std::string, TableSizeEstimate>;
 using SensitiveColumnMap = absl::flat_hash_map<std::string, absl::flat_hash_set<std::string>>;
 class CompilerState : public NotCopyable {
  public:
@@ -139,7 +147,12 @@ class CompilerState : public NotCopyable {
     return &table_names_to_sensitive_columns_;
   }
   RegistryInfo* registry_info() const { return registry_info_; }
-  types::Time64NSValue time_now() const { return time_now_; }
+  types::Time64NSValue time_now() const {
+    time_now_read_ = true;
+    return time_now_;
+  }
+  // Whether the compilation read the current time, in which case the plan depends on it.
+  bool time_now_read() const { return time_now_read_; }
   const std::string& result_address() const { return result_address_; }
   const std::string& result_ssl_targetname() const { return result_ssl_targetname_; }
 
@@ -176,11 +189,21 @@ class CompilerState : public NotCopyable {
   PluginConfig* plugin_config() { return plugin_config_.get(); }
   const DebugInfo& debug_info() { return debug_info_; }
 
+  // Size estimates of the tables in relation_map, keyed by table name. Tables without estimates
+  // are missing from the map.
+  const TableStatsMap& table_stats() const { return table_stats_; }
+  void set_table_stats(TableStatsMap table_stats) { table_stats_ = std::move(table_stats); }
+
+  // Where to record planning time, or nullptr (the default) to skip timing.
+  PlannerTimings* planner_timings() const { return planner_timings_; }
+  void set_planner_timings(PlannerTimings* planner_timings) { planner_timings_ = planner_timings; }
+
  private:
   std::unique_ptr<RelationMap> relation_map_;
   SensitiveColumnMap table_names_to_sensitive_columns_;
   RegistryInfo* registry_info_;
   types::Time64NSValue time_now_;
+  mutable bool time_now_read_ = false;
   std::map<IDRegistryKey, int64_t> udf_to_id_map_;
   std::map<IDRegistryKey, int64_t> uda_to_id_map_;
 
@@ -191,6 +214,8 @@ class CompilerState : public NotCopyable {
   std::unique_ptr<planpb::OTelEndpointConfig> endpoint_config_ = nullptr;
   std::unique_ptr<PluginConfig> plugin_config_ = nullptr;
   DebugInfo debug_info_;
+  TableStatsMap table_stats_;
+  PlannerTimings* planner_timings_ = nullptr;
 };
 
 }  // namespace planner
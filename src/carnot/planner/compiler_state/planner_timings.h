@@ -0,0 +1,91 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <string_view>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+/**
+ * @brief Wall time spent in each planning phase and compiler rule. The planner only records
+ * timings when one of these is attached to the CompilerState, which the planner benchmarks do.
+ */
+struct PlannerTimings {
+  struct Entry {
+    int64_t num_calls = 0;
+    int64_t total_ns = 0;
+  };
+  using EntryMap = absl::flat_hash_map<std::string, Entry>;
+
+  // Keyed by phase: "parse", "ast_to_ir", "analyze", "optimize", "split", "coordinate" and
+  // "stitch".
+  EntryMap phases;
+  // Keyed by "<rule batch>/<rule>".
+  EntryMap rules;
+};
+
+inline PlannerTimings::EntryMap* PhaseTimings(PlannerTimings* timings) {
+  return timings == nullptr ? nullptr : &timings->phases;
+}
+
+inline PlannerTimings::EntryMap* RuleTimings(PlannerTimings* timings) {
+  return timings == nullptr ? nullptr : &timings->rules;
+}
+
+/**
+ * @brief Adds the wall time of its scope to the named entry. Does nothing if `entries` is null.
+ */
+class ScopedPlannerTimer : public NotCopyable {
+ public:
+  ScopedPlannerTimer(PlannerTimings::EntryMap* entries, std::string_view name)
+      : entries_(entries) {
+    if (entries_ != nullptr) {
+      name_ = std::string(name);
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~ScopedPlannerTimer() {
+    if (entries_ == nullptr) {
+      return;
+    }
+    PlannerTimings::Entry& entry = (*entries_)[name_];
+    ++entry.num_calls;
+    entry.total_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - start_)
+                          .count();
+  }
+
+ private:
+  PlannerTimings::EntryMap* entries_;
+  std::string name_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -31,9 +31,14 @@
 #include "src/carnot/planner/distributed/splitter/splitter.h"
 #include "src/carnot/planner/rules/rules.h"
 #include "src/carnot/udfspb/udfs.pb.h"
+#include "src/common/base/thread_pool.h"
 #include "src/common/uuid/uuid.h"
 #include "src/shared/upid/upid.h"
 
+DEFINE_int32(planner_num_threads, gflags::Int32FromEnv("PL_PLANNER_NUM_THREADS", 4),
+             "The number of threads used to create the plans of the different groups of agents "
+             "in a distributed query. 1 creates them on the calling thread.");
+
 namespace px {
 namespace carnot {
 namespace planner {
@@ -105,6 +110,15 @@ const distributedpb::CarnotInfo& CoordinatorImpl::GetRemoteProcessor() const {
   return remote_processor_nodes_[0];
 }
 
+namespace {
+// The pool is shared by all of the planners in this process. The calling thread always
+// participates in the work, so the pool holds one thread less than requested.
+ThreadPool* PlannerThreadPool() {
+  static ThreadPool pool(std::max(0, FLAGS_planner_num_threads - 1));
+  return &pool;
+}
+}  // namespace
+
 /**
  * A mapping of agent IDs to the corresponding plan.
  */
@@ -114,19 +128,18 @@ struct AgentToPlanMap {
   absl::flat_hash_map<IR*, absl::flat_hash_set<int64_t>> plan_to_agents;
 };
 
-StatusOr<AgentToPlanMap> GetUniquePEMPlans(IR* query, DistributedPlan* plan,
+StatusOr<AgentToPlanMap> GetUniquePEMPlans(std::unique_ptr<IR> query, DistributedPlan* plan,
                                            const std::vector<int64_t>& carnot_instances,
                                            const SchemaToAgentsMap& schema_map) {
   absl::flat_hash_set<int64_t> all_agents(carnot_instances.begin(), carnot_instances.end());
-  PX_ASSIGN_OR_RETURN(
-      OperatorToAgentSet removable_ops_to_agents,
-      MapRemovableOperatorsRule::GetRemovableOperators(plan, schema_map, all_agents, query));
+  PX_ASSIGN_OR_RETURN(OperatorToAgentSet removable_ops_to_agents,
+                      MapRemovableOperatorsRule::GetRemovableOperators(plan, schema_map, all_agents,
+                                                                       query.get()));
   AgentToPlanMap agent_to_plan_map;
   if (removable_ops_to_agents.empty()) {
-    // Create the default single PEM map.
-    PX_ASSIGN_OR_RETURN(auto default_ir_uptr, query->Clone());
-    auto default_ir = default_ir_uptr.get();
-    agent_to_plan_map.plan_pool.push_back(std::move(default_ir_uptr));
+    // Create the default single PEM map. Every agent shares the query itself.
+    auto default_ir = query.get();
+    agent_to_plan_map.plan_pool.push_back(std::move(query));
     for (int64_t carnot_i : carnot_instances) {
       agent_to_plan_map.agent_to_plan_map[carnot_i] = default_ir;
     }
@@ -135,18 +148,35 @@ StatusOr<AgentToPlanMap> GetUniquePEMPlans(IR* query, DistributedPlan* plan,
   }
 
   std::vector<PlanCluster> clusters = ClusterOperators(removable_ops_to_agents);
-  // Cluster representing the original plan if any exist.
+  // Pruning the operators of a cluster only reads the query, so the clusters are planned in
+  // parallel. The ops_to_remove point into the query, so it must outlive all of them.
+  std::vector<std::unique_ptr<IR>> cluster_plans(clusters.size());
+  std::vector<Status> cluster_statuses(clusters.size());
+  PlannerThreadPool()->ParallelFor(clusters.size(), [&](size_t i) {
+    auto plan_or_s = clusters[i].CreatePlan(query.get());
+    if (!plan_or_s.ok()) {
+      cluster_statuses[i] = plan_or_s.status();
+      return;
+    }
+    cluster_plans[i] = plan_or_s.ConsumeValueOrDie();
+  });
+  for (const auto& s : cluster_statuses) {
+    PX_RETURN_IF_ERROR(s);
+  }
+
+  // Cluster representing the original plan if any exist. Nothing is pruned from it, so it takes
+  // the query instead of a clone.
   auto remaining_agents = RemainingAgents(removable_ops_to_agents, all_agents);
   if (!remaining_agents.empty()) {
     clusters.emplace_back(remaining_agents, absl::flat_hash_set<OperatorIR*>{});
+    cluster_plans.push_back(std::move(query));
   }
-  for (const auto& c : clusters) {
-    PX_ASSIGN_OR_RETURN(auto cluster_plan_uptr, c.CreatePlan(query));
-    auto cluster_plan = cluster_plan_uptr.get();
+  for (const auto& [i, c] : Enumerate(clusters)) {
+    auto cluster_plan = cluster_plans[i].get();
     if (cluster_plan->FindNodesThatMatch(Operator()).empty()) {
       continue;
     }
-    agent_to_plan_map.plan_pool.push_back(std::move(cluster_plan_uptr));
+    agent_to_plan_map.plan_pool.push_back(std::move(cluster_plans[i]));
     // TODO(philkuz) enable this when we move over the Distributed analyzer.
     // plan->AddPlan(std::move(cluster_plan_uptr));
     for (const auto& agent : c.agent_set) {
@@ -178,10 +208,15 @@ StatusOr<SchemaToAgentsMap> LoadSchemaMap(
 }
 
 StatusOr<std::unique_ptr<DistributedPlan>> CoordinatorImpl::CoordinateImpl(const IR* logical_plan) {
-  PX_ASSIGN_OR_RETURN(std::unique_ptr<Splitter> splitter,
-                      Splitter::Create(compiler_state_, /* support_partial_agg */ false));
-  PX_ASSIGN_OR_RETURN(std::unique_ptr<BlockingSplitPlan> split_plan,
-                      splitter->SplitKelvinAndAgents(logical_plan));
+  std::unique_ptr<BlockingSplitPlan> split_plan;
+  {
+    ScopedPlannerTimer timer(PhaseTimings(compiler_state_->planner_timings()), "split");
+    PX_ASSIGN_OR_RETURN(std::unique_ptr<Splitter> splitter,
+                        Splitter::Create(compiler_state_, /* support_partial_agg */ false));
+    PX_ASSIGN_OR_RETURN(split_plan, splitter->SplitKelvinAndAgents(logical_plan));
+  }
+
+  ScopedPlannerTimer timer(PhaseTimings(compiler_state_->planner_timings()), "coordinate");
   auto distributed_plan = std::make_unique<DistributedPlan>();
   PX_ASSIGN_OR_RETURN(int64_t remote_node_id, distributed_plan->AddCarnot(GetRemoteProcessor()));
   // TODO(philkuz) Need to update the Blocking Split Plan to better represent what we expect.
@@ -204,9 +239,10 @@ StatusOr<std::unique_ptr<DistributedPlan>> CoordinatorImpl::CoordinateImpl(const
   PX_ASSIGN_OR_RETURN(auto agent_schema_map,
                       LoadSchemaMap(*distributed_state_, distributed_plan->uuid_to_id_map()));
 
-  PX_ASSIGN_OR_RETURN(auto agent_to_plan_map,
-                      GetUniquePEMPlans(split_plan->before_blocking.get(), distributed_plan.get(),
-                                        source_node_ids, agent_schema_map));
+  PX_ASSIGN_OR_RETURN(
+      auto agent_to_plan_map,
+      GetUniquePEMPlans(std::move(split_plan->before_blocking), distributed_plan.get(),
+                        source_node_ids, agent_schema_map));
 
   // Add the PEM plans to the distributed plan.
   for (const auto carnot_id : source_node_ids) {
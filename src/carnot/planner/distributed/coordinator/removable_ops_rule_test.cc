@@ -277,6 +277,43 @@ TEST_F(RemovableOpsRuleTest, filter_or_with_nonexistant) {
   EXPECT_THAT(removable_ops_to_agents[filter], UnorderedElementsAre(1, 2));
 }
 
+constexpr char kRemoveFilterNamespace[] = R"pxl(
+import px
+
+# namespace (only agent 1)
+t1 = px.DataFrame(table='http_events')
+t1 = t1[t1.ctx['namespace'] == 'agent1_ns']
+px.display(t1, 't1')
+)pxl";
+
+TEST_F(RemovableOpsRuleTest, filter_namespace) {
+  auto distributed_state = ThreeAgentOneKelvinStateWithMetadataInfo();
+  auto logical_plan = CompileSingleNodePlan(kRemoveFilterNamespace);
+  auto distributed_plan = AssembleDistributedPlan(distributed_state);
+  auto split_plan = SplitPlan(logical_plan.get());
+
+  absl::flat_hash_set<int64_t> source_node_ids = SourceNodeIds(distributed_plan.get());
+
+  ASSERT_OK_AND_ASSIGN(auto agent_schema_map,
+                       LoadSchemaMap(distributed_state, distributed_plan->uuid_to_id_map()));
+
+  ASSERT_OK_AND_ASSIGN(OperatorToAgentSet removable_ops_to_agents,
+                       MapRemovableOperatorsRule::GetRemovableOperators(
+                           distributed_plan.get(), agent_schema_map, source_node_ids,
+                           split_plan->before_blocking.get()));
+
+  EXPECT_EQ(removable_ops_to_agents.size(), 1);
+
+  FilterIR* filter = nullptr;
+  for (const auto& [op, agents] : removable_ops_to_agents) {
+    ASSERT_MATCH(op, Filter());
+    filter = static_cast<FilterIR*>(op);
+  }
+  ASSERT_NE(filter, nullptr);
+  // Only agent 1 has a pod in the namespace.
+  EXPECT_THAT(removable_ops_to_agents[filter], UnorderedElementsAre(1, 2));
+}
+
 constexpr char kASIDFilterExpression[] = R"pxl(
 import px
 df = px.DataFrame(table='http_events')
@@ -78,6 +78,7 @@ StatusOr<std::unique_ptr<DistributedPlan>> DistributedPlanner::Plan(
   PX_ASSIGN_OR_RETURN(std::unique_ptr<DistributedPlan> distributed_plan,
                       coordinator->Coordinate(logical_plan));
 
+  ScopedPlannerTimer timer(PhaseTimings(compiler_state->planner_timings()), "stitch");
   PX_RETURN_IF_ERROR(StitchPlan(distributed_plan.get()));
 
   AnnotateAbortableSourcesForLimitsRule rule;
@@ -22,6 +22,11 @@
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+
+#include "src/carnot/planner/distributed/splitter/executor_utils.h"
+
 namespace px {
 namespace carnot {
 namespace planner {
@@ -44,6 +49,23 @@ StatusOr<OperatorIR*> LimitOperatorMgr::CreateMergeOperator(IR* plan, OperatorIR
   return new_limit;
 }
 
+StatusOr<OperatorIR*> TopKOperatorMgr::CreatePrepareOperator(IR* plan, OperatorIR* op) const {
+  DCHECK(Matches(op));
+  TopKIR* top_k = static_cast<TopKIR*>(op);
+  PX_ASSIGN_OR_RETURN(TopKIR * new_top_k, plan->CopyNode(top_k));
+  PX_RETURN_IF_ERROR(new_top_k->CopyParentsFrom(top_k));
+  return new_top_k;
+}
+
+StatusOr<OperatorIR*> TopKOperatorMgr::CreateMergeOperator(IR* plan, OperatorIR* new_parent,
+                                                           OperatorIR* op) const {
+  DCHECK(Matches(op));
+  TopKIR* top_k = static_cast<TopKIR*>(op);
+  PX_ASSIGN_OR_RETURN(TopKIR * new_top_k, plan->CopyNode(top_k));
+  PX_RETURN_IF_ERROR(new_top_k->AddParent(new_parent));
+  return new_top_k;
+}
+
 StatusOr<OperatorIR*> AggOperatorMgr::CreatePrepareOperator(IR* plan, OperatorIR* op) const {
   DCHECK(Matches(op));
   BlockingAggIR* agg = static_cast<BlockingAggIR*>(op);
@@ -83,6 +105,247 @@ StatusOr<OperatorIR*> AggOperatorMgr::CreateMergeOperator(IR* plan, OperatorIR*
   DCHECK(Match(new_agg, FinalizeAgg()));
   return new_agg;
 }
+
+namespace {
+void CollectInputColumns(ExpressionIR* expr, std::vector<std::string>* input_columns) {
+  if (Match(expr, ColumnNode())) {
+    input_columns->push_back(static_cast<ColumnIR*>(expr)->col_name());
+  } else if (Match(expr, Func())) {
+    for (ExpressionIR* arg : static_cast<FuncIR*>(expr)->all_args()) {
+      CollectInputColumns(arg, input_columns);
+    }
+  }
+}
+
+// Identifies what a column on the PEM side of the split holds, so that two columns with the same
+// name are only shared when they hold the same thing.
+std::string ColumnSourceKey(ExpressionIR* expr, const std::string& name) {
+  if (expr == nullptr) {
+    return absl::StrCat("input:", name);
+  }
+  if (Match(expr, ColumnNode())) {
+    return absl::StrCat("input:", static_cast<ColumnIR*>(expr)->col_name());
+  }
+  return absl::StrCat("expr:", expr->id());
+}
+}  // namespace
+
+ExpressionIR* MapAggOperatorMgr::MapOutputExpr(MapIR* map, const std::string& name) {
+  for (const auto& col_expr : map->col_exprs()) {
+    if (col_expr.name == name) {
+      return col_expr.node;
+    }
+  }
+  return nullptr;
+}
+
+StatusOr<std::vector<MapAggOperatorMgr::GroupSource>> MapAggOperatorMgr::GetGroupSources(
+    MapIR* map, BlockingAggIR* agg) const {
+  // The name of each column of the PEM Map, mapped to what it holds.
+  absl::flat_hash_map<std::string, std::string> pem_columns;
+  auto add_pem_column = [&](const std::string& name, const std::string& source) -> Status {
+    auto [it, inserted] = pem_columns.emplace(name, source);
+    if (!inserted && it->second != source) {
+      return error::InvalidArgument("Column '$0' would be computed twice before the split", name);
+    }
+    return Status::OK();
+  };
+
+  std::vector<GroupSource> groups;
+  for (ColumnIR* group : agg->groups()) {
+    GroupSource source{group->col_name(), MapOutputExpr(map, group->col_name()), false, {}};
+    if (source.expr == nullptr && !map->keep_input_columns()) {
+      return error::Internal("Map doesn't output group '$0'", source.name);
+    }
+    if (source.expr != nullptr) {
+      PX_ASSIGN_OR_RETURN(source.kelvin_only,
+                          HasFuncWithExecutor(compiler_state_, source.expr,
+                                              udfspb::UDFSourceExecutor::UDF_KELVIN));
+    }
+    if (source.kelvin_only) {
+      CollectInputColumns(source.expr, &source.input_columns);
+      for (const auto& input_col : source.input_columns) {
+        PX_RETURN_IF_ERROR(add_pem_column(input_col, absl::StrCat("input:", input_col)));
+      }
+    } else {
+      PX_RETURN_IF_ERROR(add_pem_column(source.name, ColumnSourceKey(source.expr, source.name)));
+    }
+    groups.push_back(std::move(source));
+  }
+
+  for (const auto& agg_expr : agg->aggregate_expressions()) {
+    for (ExpressionIR* arg : static_cast<FuncIR*>(agg_expr.node)->all_args()) {
+      if (!Match(arg, ColumnNode())) {
+        continue;
+      }
+      std::string arg_name = static_cast<ColumnIR*>(arg)->col_name();
+      ExpressionIR* expr = MapOutputExpr(map, arg_name);
+      if (expr != nullptr && !Match(expr, ColumnNode())) {
+        return error::InvalidArgument("Aggregate argument '$0' is computed by the Map", arg_name);
+      }
+      PX_RETURN_IF_ERROR(add_pem_column(arg_name, ColumnSourceKey(expr, arg_name)));
+    }
+  }
+  return groups;
+}
+
+std::vector<std::string> MapAggOperatorMgr::PartialGroupNames(
+    const std::vector<GroupSource>& groups) {
+  std::vector<std::string> names;
+  absl::flat_hash_set<std::string> seen;
+  for (const auto& group : groups) {
+    const std::vector<std::string>& group_names =
+        group.kelvin_only ? group.input_columns : std::vector<std::string>{group.name};
+    for (const auto& name : group_names) {
+      if (seen.insert(name).second) {
+        names.push_back(name);
+      }
+    }
+  }
+  return names;
+}
+
+bool MapAggOperatorMgr::Matches(OperatorIR* op) const {
+  if (!Match(op, Map()) || op->parents().size() != 1 || op->Children().size() != 1) {
+    return false;
+  }
+  OperatorIR* child = op->Children()[0];
+  if (!Match(child, BlockingAgg())) {
+    return false;
+  }
+  auto agg = static_cast<BlockingAggIR*>(child);
+  // The window group is referenced by index, which the split changes.
+  if (agg->time_windowed() || !AggOperatorMgr::AllUDAsSupportPartial(agg)) {
+    return false;
+  }
+  auto groups_or_s = GetGroupSources(static_cast<MapIR*>(op), agg);
+  if (!groups_or_s.ok()) {
+    return false;
+  }
+  // Only worth it if something has to run on Kelvin, otherwise the Map runs on the PEM and the
+  // aggregate is split by AggOperatorMgr.
+  for (const auto& group : groups_or_s.ConsumeValueOrDie()) {
+    if (group.kelvin_only) {
+      return true;
+    }
+  }
+  return false;
+}
+
+StatusOr<OperatorIR*> MapAggOperatorMgr::CreatePrepareOperator(IR* plan, OperatorIR* op) const {
+  DCHECK(Matches(op));
+  MapIR* map = static_cast<MapIR*>(op);
+  BlockingAggIR* agg = static_cast<BlockingAggIR*>(map->Children()[0]);
+  OperatorIR* parent = map->parents()[0];
+  PX_ASSIGN_OR_RETURN(std::vector<GroupSource> groups, GetGroupSources(map, agg));
+
+  // The PEM Map outputs the columns that the partial aggregate groups by, then the columns it
+  // aggregates.
+  ColExpressionVector pem_exprs;
+  absl::flat_hash_set<std::string> pem_names;
+  auto add_pem_expr = [&](const std::string& name, ExpressionIR* expr) -> Status {
+    if (!pem_names.insert(name).second) {
+      return Status::OK();
+    }
+    if (expr == nullptr) {
+      PX_ASSIGN_OR_RETURN(expr, plan->CreateNode<ColumnIR>(map->ast(), name, /*parent_op_idx*/ 0));
+    } else {
+      PX_ASSIGN_OR_RETURN(expr, plan->CopyNode(expr));
+    }
+    pem_exprs.emplace_back(name, expr);
+    return Status::OK();
+  };
+  for (const auto& group : groups) {
+    if (group.kelvin_only) {
+      for (const auto& input_col : group.input_columns) {
+        PX_RETURN_IF_ERROR(add_pem_expr(input_col, nullptr));
+      }
+    } else {
+      PX_RETURN_IF_ERROR(add_pem_expr(group.name, group.expr));
+    }
+  }
+  for (const auto& agg_expr : agg->aggregate_expressions()) {
+    for (ExpressionIR* arg : static_cast<FuncIR*>(agg_expr.node)->all_args()) {
+      if (Match(arg, ColumnNode())) {
+        std::string arg_name = static_cast<ColumnIR*>(arg)->col_name();
+        PX_RETURN_IF_ERROR(add_pem_expr(arg_name, MapOutputExpr(map, arg_name)));
+      }
+    }
+  }
+  PX_ASSIGN_OR_RETURN(MapIR * pem_map, plan->CreateNode<MapIR>(map->ast(), parent, pem_exprs,
+                                                               /*keep_input_columns*/ false));
+  PX_RETURN_IF_ERROR(ResolveOperatorType(pem_map, compiler_state_));
+
+  std::vector<ColumnIR*> partial_groups;
+  auto new_type = TableType::Create();
+  for (const auto& name : PartialGroupNames(groups)) {
+    PX_ASSIGN_OR_RETURN(ColumnIR * group,
+                        plan->CreateNode<ColumnIR>(map->ast(), name, /*parent_op_idx*/ 0));
+    PX_RETURN_IF_ERROR(
+        ResolveExpressionType(group, compiler_state_, {pem_map->resolved_table_type()}));
+    new_type->AddColumn(name, group->resolved_type());
+    partial_groups.push_back(group);
+  }
+  ColExpressionVector partial_exprs;
+  for (const auto& agg_expr : agg->aggregate_expressions()) {
+    PX_ASSIGN_OR_RETURN(ExpressionIR * expr, plan->CopyNode(agg_expr.node));
+    partial_exprs.emplace_back(agg_expr.name, expr);
+    new_type->AddColumn("serialized_" + agg_expr.name,
+                        ValueType::Create(types::STRING, types::ST_NONE));
+  }
+
+  PX_ASSIGN_OR_RETURN(BlockingAggIR * partial_agg,
+                      plan->CreateNode<BlockingAggIR>(agg->ast(), pem_map, partial_groups,
+                                                      partial_exprs));
+  partial_agg->SetPartialAgg(true);
+  partial_agg->SetFinalizeResults(false);
+  PX_RETURN_IF_ERROR(partial_agg->SetResolvedType(new_type));
+  DCHECK(Match(partial_agg, PartialAgg()));
+  return partial_agg;
+}
+
+StatusOr<OperatorIR*> MapAggOperatorMgr::CreateMergeOperator(IR* plan, OperatorIR* new_parent,
+                                                             OperatorIR* op) const {
+  DCHECK(Matches(op));
+  MapIR* map = static_cast<MapIR*>(op);
+  BlockingAggIR* agg = static_cast<BlockingAggIR*>(map->Children()[0]);
+  PX_ASSIGN_OR_RETURN(std::vector<GroupSource> groups, GetGroupSources(map, agg));
+
+  // The Kelvin Map outputs the groups, then the serialized partial aggregates, which is the input
+  // a finalize aggregate expects.
+  ColExpressionVector kelvin_exprs;
+  for (const auto& group : groups) {
+    ExpressionIR* expr;
+    if (group.kelvin_only) {
+      PX_ASSIGN_OR_RETURN(expr, plan->CopyNode(group.expr));
+    } else {
+      PX_ASSIGN_OR_RETURN(expr,
+                          plan->CreateNode<ColumnIR>(map->ast(), group.name, /*parent_op_idx*/ 0));
+    }
+    kelvin_exprs.emplace_back(group.name, expr);
+  }
+  for (const auto& agg_expr : agg->aggregate_expressions()) {
+    std::string name = "serialized_" + agg_expr.name;
+    PX_ASSIGN_OR_RETURN(ColumnIR * col,
+                        plan->CreateNode<ColumnIR>(map->ast(), name, /*parent_op_idx*/ 0));
+    kelvin_exprs.emplace_back(name, col);
+  }
+  PX_ASSIGN_OR_RETURN(MapIR * kelvin_map,
+                      plan->CreateNode<MapIR>(map->ast(), new_parent, kelvin_exprs,
+                                              /*keep_input_columns*/ false));
+  PX_RETURN_IF_ERROR(ResolveOperatorType(kelvin_map, compiler_state_));
+
+  // The aggregate itself becomes the finalize aggregate. The splitter moves it onto kelvin_map
+  // when it replaces the original Map.
+  planpb::Operator pb;
+  PX_RETURN_IF_ERROR(agg->ToProto(&pb));
+  agg->SetPreSplitProto(pb.agg_op());
+  agg->SetPartialAgg(false);
+  agg->SetFinalizeResults(true);
+  DCHECK(Match(agg, FinalizeAgg()));
+  return kelvin_map;
+}
+
 }  // namespace distributed
 }  // namespace planner
 }  // namespace carnot
@@ -18,6 +18,10 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
+#include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/ir/ir.h"
 #include "src/carnot/planner/ir/pattern_match.h"
 
@@ -87,6 +91,19 @@ class LimitOperatorMgr : public PartialOperatorMgr {
                                             OperatorIR* op) const override;
 };
 
+/**
+ * @brief TopKOperatorMgr manages splitting top ks over the boundary. The top k rows of all the
+ * agents are among the top k rows of each one, so each agent sends at most k rows to be merged by
+ * the same TopK.
+ */
+class TopKOperatorMgr : public PartialOperatorMgr {
+ public:
+  bool Matches(OperatorIR* op) const override { return Match(op, TopK()); }
+  StatusOr<OperatorIR*> CreatePrepareOperator(IR* plan, OperatorIR* op) const override;
+  StatusOr<OperatorIR*> CreateMergeOperator(IR* plan, OperatorIR* new_parent,
+                                            OperatorIR* op) const override;
+};
+
 /**
  * @brief AggOperatorMgr manages splitting aggregates into partial aggregate and the merging node
  * over a network boundary.
@@ -97,7 +114,13 @@ class AggOperatorMgr : public PartialOperatorMgr {
     if (!Match(op, BlockingAgg())) {
       return false;
     }
-    BlockingAggIR* agg = static_cast<BlockingAggIR*>(op);
+    return AllUDAsSupportPartial(static_cast<BlockingAggIR*>(op));
+  }
+  StatusOr<OperatorIR*> CreatePrepareOperator(IR* plan, OperatorIR* op) const override;
+  StatusOr<OperatorIR*> CreateMergeOperator(IR* plan, OperatorIR* new_parent,
+                                            OperatorIR* op) const override;
+
+  static bool AllUDAsSupportPartial(BlockingAggIR* agg) {
     for (const auto& col_expr : agg->aggregate_expressions()) {
       if (!Match(col_expr.node, PartialUDA())) {
         return false;
@@ -105,9 +128,64 @@ class AggOperatorMgr : public PartialOperatorMgr {
     }
     return true;
   }
+};
+
+/**
+ * @brief MapAggOperatorMgr splits a Map that has to run on Kelvin (because it calls Kelvin-only
+ * UDFs) together with the aggregate it feeds. Without it, the raw rows are sent to Kelvin:
+ *
+ * MemSrc -> [Map(service=kelvin_fn(upid), window=px.bin(time_, 10s)) -> Agg(by service, window)]
+ *
+ * The Prepare portion runs on the PEM. It is a Map that computes every group that doesn't need a
+ * Kelvin-only UDF (ie px.bin windows) and passes through the inputs of the groups that do, followed
+ * by a partial aggregate grouped by those columns. The Merge portion is a Map on Kelvin that
+ * computes the remaining groups from the partial aggregate output, followed by the original
+ * aggregate turned into a finalize aggregate. Partial aggregates that end up in the same group
+ * after the Kelvin-only UDF are merged by the finalize aggregate, the same way partial aggregates
+ * of the same group from different PEMs are.
+ *
+ * Aggregate arguments must pass through the Map unchanged, so that they can be aggregated on the
+ * PEM before the Map runs.
+ */
+class MapAggOperatorMgr : public PartialOperatorMgr {
+ public:
+  explicit MapAggOperatorMgr(CompilerState* compiler_state) : compiler_state_(compiler_state) {}
+
+  bool Matches(OperatorIR* op) const override;
   StatusOr<OperatorIR*> CreatePrepareOperator(IR* plan, OperatorIR* op) const override;
   StatusOr<OperatorIR*> CreateMergeOperator(IR* plan, OperatorIR* new_parent,
                                             OperatorIR* op) const override;
+
+ private:
+  /**
+   * @brief How the Map computes a group of the aggregate.
+   */
+  struct GroupSource {
+    std::string name;
+    // The Map expression that computes the group, nullptr if the Map passes the input column of
+    // the same name through.
+    ExpressionIR* expr;
+    // Whether expr calls a Kelvin-only UDF, in which case the group is computed after the split.
+    bool kelvin_only;
+    // The Map input columns that expr reads, for groups computed after the split.
+    std::vector<std::string> input_columns;
+  };
+
+  /**
+   * @brief Returns the expression that map outputs as the column `name`, or nullptr if the map
+   * passes the input column of the same name through.
+   */
+  static ExpressionIR* MapOutputExpr(MapIR* map, const std::string& name);
+  /**
+   * @brief Returns the groups of agg as computed by map, or an error if the pair can't be split.
+   */
+  StatusOr<std::vector<GroupSource>> GetGroupSources(MapIR* map, BlockingAggIR* agg) const;
+  /**
+   * @brief Returns the names of the columns that the partial aggregate on the PEM groups by.
+   */
+  static std::vector<std::string> PartialGroupNames(const std::vector<GroupSource>& groups);
+
+  CompilerState* compiler_state_;
 };
 }  // namespace distributed
 }  // namespace planner
@@ -68,6 +68,38 @@ TEST_F(PartialOpMgrTest, limit_test) {
   EXPECT_NE(merge_limit, limit);
 }
 
+TEST_F(PartialOpMgrTest, top_k_test) {
+  auto mem_src = MakeMemSource(MakeRelation());
+  auto top_k = MakeTopK(mem_src, {{"count", /*descending*/ true}}, 10);
+  MakeMemSink(top_k, "out");
+
+  TopKOperatorMgr mgr;
+  EXPECT_TRUE(mgr.Matches(top_k));
+  auto prepare_top_k_or_s = mgr.CreatePrepareOperator(graph.get(), top_k);
+  ASSERT_OK(prepare_top_k_or_s);
+  OperatorIR* prepare_top_k_uncasted = prepare_top_k_or_s.ConsumeValueOrDie();
+  ASSERT_MATCH(prepare_top_k_uncasted, TopK());
+  TopKIR* prepare_top_k = static_cast<TopKIR*>(prepare_top_k_uncasted);
+  EXPECT_EQ(prepare_top_k->limit(), top_k->limit());
+  ASSERT_EQ(prepare_top_k->sort_columns().size(), 1);
+  EXPECT_EQ(prepare_top_k->sort_columns()[0].col_name, "count");
+  EXPECT_TRUE(prepare_top_k->sort_columns()[0].descending);
+  EXPECT_EQ(prepare_top_k->parents(), top_k->parents());
+  EXPECT_NE(prepare_top_k, top_k);
+
+  auto mem_src2 = MakeMemSource(MakeRelation());
+  auto merge_top_k_or_s = mgr.CreateMergeOperator(graph.get(), mem_src2, top_k);
+  ASSERT_OK(merge_top_k_or_s);
+  OperatorIR* merge_top_k_uncasted = merge_top_k_or_s.ConsumeValueOrDie();
+  ASSERT_MATCH(merge_top_k_uncasted, TopK());
+  TopKIR* merge_top_k = static_cast<TopKIR*>(merge_top_k_uncasted);
+  EXPECT_EQ(merge_top_k->limit(), top_k->limit());
+  ASSERT_EQ(merge_top_k->sort_columns().size(), 1);
+  EXPECT_EQ(merge_top_k->sort_columns()[0].col_name, "count");
+  EXPECT_EQ(merge_top_k->parents()[0], mem_src2);
+  EXPECT_NE(merge_top_k, top_k);
+}
+
 TEST_F(PartialOpMgrTest, agg_test) {
   auto relation = MakeRelation();
   relation.AddColumn(types::STRING, "service");
@@ -0,0 +1,252 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/distributed/splitter/presplit_optimizer/memory_source_predicate_push_down_rule.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/strings/match.h>
+
+#include "src/carnot/planner/ir/int_ir.h"
+#include "src/carnot/planner/ir/time_ir.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+namespace {
+
+constexpr char kTimeColumnName[] = "time_";
+
+void SplitConjuncts(ExpressionIR* expr, std::vector<ExpressionIR*>* conjuncts) {
+  if (Match(expr, Func("logicalAnd"))) {
+    for (ExpressionIR* arg : static_cast<FuncIR*>(expr)->all_args()) {
+      SplitConjuncts(arg, conjuncts);
+    }
+    return;
+  }
+  conjuncts->push_back(expr);
+}
+
+// Evaluates times and durations, and sums and differences of them, e.g. px.now() - px.minutes(5).
+std::optional<int64_t> ConstantTimeValue(ExpressionIR* expr) {
+  if (Match(expr, Time())) {
+    return static_cast<TimeIR*>(expr)->val();
+  }
+  if (Match(expr, Int())) {
+    return static_cast<IntIR*>(expr)->val();
+  }
+  if (!Match(expr, Func())) {
+    return std::nullopt;
+  }
+  auto func = static_cast<FuncIR*>(expr);
+  const auto& args = func->all_args();
+  bool is_add = func->func_name() == "add";
+  if (args.size() != 2 || (!is_add && func->func_name() != "subtract")) {
+    return std::nullopt;
+  }
+  auto lhs = ConstantTimeValue(args[0]);
+  auto rhs = ConstantTimeValue(args[1]);
+  if (!lhs.has_value() || !rhs.has_value()) {
+    return std::nullopt;
+  }
+  int64_t result;
+  bool overflow = is_add ? __builtin_add_overflow(lhs.value(), rhs.value(), &result)
+                         : __builtin_sub_overflow(lhs.value(), rhs.value(), &result);
+  if (overflow) {
+    return std::nullopt;
+  }
+  return result;
+}
+
+}  // namespace
+
+bool MemorySourcePredicatePushdownRule::NarrowTimeRange(MemorySourceIR* source,
+                                                        ExpressionIR* conjunct) {
+  if (!Match(conjunct, Func())) {
+    return false;
+  }
+  auto func = static_cast<FuncIR*>(conjunct);
+  const auto& args = func->all_args();
+  if (args.size() != 2) {
+    return false;
+  }
+  bool col_first = Match(args[0], ColumnNode());
+  if (col_first == Match(args[1], ColumnNode())) {
+    return false;
+  }
+  auto col = static_cast<ColumnIR*>(args[col_first ? 0 : 1]);
+  if (col->col_name() != kTimeColumnName || !col->IsDataTypeEvaluated() ||
+      col->EvaluatedDataType() != types::TIME64NS) {
+    return false;
+  }
+  auto value = ConstantTimeValue(args[col_first ? 1 : 0]);
+  if (!value.has_value()) {
+    return false;
+  }
+
+  // The source reads the inclusive range [start, stop]. Strict comparisons keep their bound, the
+  // conjunct itself still drops the rows on the bound.
+  const std::string& name = func->func_name();
+  bool lower_bound = name == "equal" || (col_first ? absl::StartsWith(name, "greaterThan")
+                                                   : absl::StartsWith(name, "lessThan"));
+  bool upper_bound = name == "equal" || (col_first ? absl::StartsWith(name, "lessThan")
+                                                   : absl::StartsWith(name, "greaterThan"));
+  bool narrowed = false;
+  if (lower_bound && (!source->IsTimeStartSet() || value.value() > source->time_start_ns())) {
+    source->SetTimeStartNS(value.value());
+    narrowed = true;
+  }
+  // A stop time would end a streaming source, instead of letting it wait for new data.
+  if (upper_bound && !source->streaming() &&
+      (!source->IsTimeStopSet() || value.value() < source->time_stop_ns())) {
+    source->SetTimeStopNS(value.value());
+    narrowed = true;
+  }
+  return narrowed;
+}
+
+std::optional<planpb::ColumnPredicate> MemorySourcePredicatePushdownRule::FoldablePredicate(
+    MemorySourceIR* source, ExpressionIR* conjunct) {
+  using Predicate = planpb::ColumnPredicate;
+  if (!Match(conjunct, Func())) {
+    return std::nullopt;
+  }
+  auto func = static_cast<FuncIR*>(conjunct);
+  const auto& args = func->all_args();
+  if (args.size() != 2) {
+    return std::nullopt;
+  }
+
+  static const absl::flat_hash_map<std::string, std::pair<Predicate::Op, Predicate::Op>> kOps = {
+      // The op for `col <op> value`, and for `value <op> col`.
+      {"equal", {Predicate::EQUAL, Predicate::EQUAL}},
+      {"lessThan", {Predicate::LESS_THAN, Predicate::GREATER_THAN}},
+      {"lessThanEqual", {Predicate::LESS_THAN_EQUAL, Predicate::GREATER_THAN_EQUAL}},
+      {"greaterThan", {Predicate::GREATER_THAN, Predicate::LESS_THAN}},
+      {"greaterThanEqual", {Predicate::GREATER_THAN_EQUAL, Predicate::LESS_THAN_EQUAL}},
+  };
+  bool col_first = Match(args[0], ColumnNode()) && Match(args[1], DataNode());
+  bool col_second = Match(args[1], ColumnNode()) && Match(args[0], DataNode());
+  Predicate::Op op;
+  if (func->func_name() == "contains") {
+    // px.contains(col, value).
+    if (!col_first) {
+      return std::nullopt;
+    }
+    op = Predicate::CONTAINS;
+  } else {
+    auto op_it = kOps.find(func->func_name());
+    if (op_it == kOps.end() || (!col_first && !col_second)) {
+      return std::nullopt;
+    }
+    op = col_first ? op_it->second.first : op_it->second.second;
+  }
+
+  auto col = static_cast<ColumnIR*>(args[col_first ? 0 : 1]);
+  auto val = static_cast<DataIR*>(args[col_first ? 1 : 0]);
+  if (col->annotations().metadata_type_set() || !col->IsDataTypeEvaluated()) {
+    return std::nullopt;
+  }
+  // Only same-typed comparisons, so that the source compares like the UDF does. Float equality is
+  // approximate in the UDF, so it stays in the filter.
+  auto data_type = col->EvaluatedDataType();
+  if (val->EvaluatedDataType() != data_type ||
+      (op == Predicate::EQUAL && data_type == types::FLOAT64) ||
+      (op == Predicate::CONTAINS && data_type != types::STRING)) {
+    return std::nullopt;
+  }
+
+  const auto& col_names = source->resolved_table_type()->ColumnNames();
+  auto col_it = std::find(col_names.begin(), col_names.end(), col->col_name());
+  if (col_it == col_names.end()) {
+    return std::nullopt;
+  }
+  planpb::ColumnPredicate predicate;
+  predicate.set_column_index(source->column_index_map()[col_it - col_names.begin()]);
+  predicate.set_op(op);
+  if (!val->ToProto(predicate.mutable_value()).ok()) {
+    return std::nullopt;
+  }
+  return predicate;
+}
+
+StatusOr<bool> MemorySourcePredicatePushdownRule::Apply(IRNode* ir_node) {
+  if (!Match(ir_node, Filter())) {
+    return false;
+  }
+  auto filter = static_cast<FilterIR*>(ir_node);
+  if (filter->parents().size() != 1 || !Match(filter->parents()[0], MemorySource())) {
+    return false;
+  }
+  auto source = static_cast<MemorySourceIR*>(filter->parents()[0]);
+  // The predicates apply to everything the source reads, so the filter has to be its only child.
+  if (source->Children().size() != 1 || !source->is_type_resolved() ||
+      !source->column_index_map_set()) {
+    return false;
+  }
+
+  std::vector<ExpressionIR*> conjuncts;
+  SplitConjuncts(filter->filter_expr(), &conjuncts);
+  bool narrowed_time_range = false;
+  std::vector<planpb::ColumnPredicate> predicates;
+  std::vector<ExpressionIR*> remaining;
+  for (ExpressionIR* conjunct : conjuncts) {
+    narrowed_time_range |= NarrowTimeRange(source, conjunct);
+    auto predicate = FoldablePredicate(source, conjunct);
+    if (predicate.has_value()) {
+      predicates.push_back(std::move(predicate.value()));
+    } else {
+      remaining.push_back(conjunct);
+    }
+  }
+  if (predicates.empty()) {
+    return narrowed_time_range;
+  }
+  for (auto& predicate : predicates) {
+    source->AddPredicate(std::move(predicate));
+  }
+
+  if (remaining.size() == 1) {
+    PX_RETURN_IF_ERROR(filter->SetFilterExpr(remaining[0]));
+    return true;
+  }
+  if (!remaining.empty()) {
+    // Rebuilding the conjunction of the rest isn't worth it, the filter evaluates all of it.
+    return true;
+  }
+
+  // Every conjunct is applied by the source, so the filter can go.
+  auto graph = filter->graph();
+  for (OperatorIR* child : filter->Children()) {
+    PX_RETURN_IF_ERROR(child->ReplaceParent(filter, source));
+  }
+  auto expr_id = filter->filter_expr()->id();
+  PX_RETURN_IF_ERROR(graph->DeleteNode(filter->id()));
+  PX_RETURN_IF_ERROR(graph->DeleteOrphansInSubtree(expr_id));
+  return true;
+}
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "src/carnot/planner/ir/filter_ir.h"
+#include "src/carnot/planner/ir/memory_source_ir.h"
+#include "src/carnot/planner/rules/rules.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+/**
+ * @brief This rule folds the simple conjuncts of a filter that directly follows a MemorySource
+ * (comparisons and px.contains of a source column against a constant) into the MemorySource, so
+ * that rows are dropped before the source builds its row batches. The filter is removed if all of
+ * its conjuncts fold. It should run after FilterPushdownRule has moved filters up to the sources.
+ *
+ * Conjuncts on metadata columns aren't folded, so that the filters that PEM pruning relies on
+ * stay in the plan.
+ *
+ * Comparisons of the time_ column against constant times, e.g. `df.time_ > px.now() -
+ * px.minutes(5)`, also narrow the start and stop times of the source, so that its cursor starts at
+ * the first batch in the range instead of scanning the whole window of the DataFrame.
+ */
+class MemorySourcePredicatePushdownRule : public Rule {
+ public:
+  explicit MemorySourcePredicatePushdownRule(CompilerState* compiler_state)
+      : Rule(compiler_state, /*use_topo*/ false, /*reverse_topological_execution*/ false) {}
+
+ protected:
+  StatusOr<bool> Apply(IRNode* ir_node) override;
+
+ private:
+  // Returns the predicate that is equivalent to the conjunct, if it can be folded into the source.
+  std::optional<planpb::ColumnPredicate> FoldablePredicate(MemorySourceIR* source,
+                                                           ExpressionIR* conjunct);
+  // Narrows the time range of the source to the one allowed by the conjunct, if it compares the
+  // time_ column against a constant. Returns whether the range changed.
+  bool NarrowTimeRange(MemorySourceIR* source, ExpressionIR* conjunct);
+};
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
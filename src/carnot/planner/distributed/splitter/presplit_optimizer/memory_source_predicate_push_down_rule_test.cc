@@ -0,0 +1,173 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "src/carnot/planner/compiler/analyzer/resolve_types_rule.h"
+#include "src/carnot/planner/distributed/splitter/presplit_optimizer/memory_source_predicate_push_down_rule.h"
+#include "src/carnot/planner/test_utils.h"
+#include "src/carnot/udf_exporter/udf_exporter.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+using compiler::ResolveTypesRule;
+using ::testing::ElementsAre;
+
+using MemorySourcePredicatePushdownTest = testutils::DistributedRulesTest;
+TEST_F(MemorySourcePredicatePushdownTest, folds_all_conjuncts) {
+  Relation relation({types::DataType::INT64, types::DataType::STRING, types::DataType::INT64},
+                    {"abc", "svc", "xyz"});
+  MemorySourceIR* src = MakeMemSource("source", relation);
+  compiler_state_->relation_map()->emplace("source", relation);
+
+  auto equals = MakeEqualsFunc(MakeColumn("abc", 0), MakeInt(2));
+  auto contains = MakeFunc("contains", {MakeColumn("svc", 0), MakeString("cart")});
+  // 5 < xyz
+  auto less_than = MakeFunc("lessThan", {MakeInt(5), MakeColumn("xyz", 0)});
+  FilterIR* filter = MakeFilter(src, MakeAndFunc(MakeAndFunc(equals, contains), less_than));
+  MemorySinkIR* sink = MakeMemSink(filter, "foo", {});
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  MemorySourcePredicatePushdownRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ValueOrDie());
+  EXPECT_FALSE(graph->HasNode(filter->id()));
+  EXPECT_THAT(sink->parents(), ElementsAre(src));
+
+  ASSERT_EQ(3UL, src->predicates().size());
+  EXPECT_EQ(0, src->predicates()[0].column_index());
+  EXPECT_EQ(planpb::ColumnPredicate::EQUAL, src->predicates()[0].op());
+  EXPECT_EQ(2, src->predicates()[0].value().int64_value());
+  EXPECT_EQ(1, src->predicates()[1].column_index());
+  EXPECT_EQ(planpb::ColumnPredicate::CONTAINS, src->predicates()[1].op());
+  EXPECT_EQ("cart", src->predicates()[1].value().string_value());
+  EXPECT_EQ(2, src->predicates()[2].column_index());
+  EXPECT_EQ(planpb::ColumnPredicate::GREATER_THAN, src->predicates()[2].op());
+  EXPECT_EQ(5, src->predicates()[2].value().int64_value());
+
+  planpb::Operator op;
+  ASSERT_OK(src->ToProto(&op));
+  EXPECT_EQ(3, op.mem_source_op().predicates_size());
+}
+
+TEST_F(MemorySourcePredicatePushdownTest, keeps_unfoldable_conjunct) {
+  Relation relation({types::DataType::INT64, types::DataType::INT64}, {"abc", "xyz"});
+  MemorySourceIR* src = MakeMemSource("source", relation);
+  compiler_state_->relation_map()->emplace("source", relation);
+
+  auto col_equals = MakeEqualsFunc(MakeColumn("abc", 0), MakeColumn("xyz", 0));
+  auto equals = MakeEqualsFunc(MakeColumn("abc", 0), MakeInt(2));
+  FilterIR* filter = MakeFilter(src, MakeAndFunc(col_equals, equals));
+  MemorySinkIR* sink = MakeMemSink(filter, "foo", {});
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  MemorySourcePredicatePushdownRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ValueOrDie());
+  EXPECT_THAT(sink->parents(), ElementsAre(filter));
+  EXPECT_THAT(filter->parents(), ElementsAre(src));
+  EXPECT_MATCH(filter->filter_expr(), Equals(ColumnNode("abc"), ColumnNode("xyz")));
+  ASSERT_EQ(1UL, src->predicates().size());
+  EXPECT_EQ(planpb::ColumnPredicate::EQUAL, src->predicates()[0].op());
+}
+
+TEST_F(MemorySourcePredicatePushdownTest, source_with_other_children) {
+  Relation relation({types::DataType::INT64, types::DataType::INT64}, {"abc", "xyz"});
+  MemorySourceIR* src = MakeMemSource("source", relation);
+  compiler_state_->relation_map()->emplace("source", relation);
+
+  FilterIR* filter = MakeFilter(src, MakeEqualsFunc(MakeColumn("abc", 0), MakeInt(2)));
+  MakeMemSink(filter, "foo", {});
+  MakeMemSink(src, "bar", {});
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  MemorySourcePredicatePushdownRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ValueOrDie());
+  EXPECT_TRUE(src->predicates().empty());
+}
+
+TEST_F(MemorySourcePredicatePushdownTest, narrows_time_range) {
+  Relation relation({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "xyz"});
+  MemorySourceIR* src = MakeMemSource("source", relation);
+  src->SetTimeStartNS(100);
+  compiler_state_->relation_map()->emplace("source", relation);
+
+  // time_ > now - 50, with now = 1000.
+  auto after = MakeFunc("greaterThan",
+                        {MakeColumn("time_", 0), MakeSubFunc(MakeTime(1000), MakeInt(50))});
+  // 2000 >= time_
+  auto before = MakeFunc("greaterThanEqual", {MakeTime(2000), MakeColumn("time_", 0)});
+  FilterIR* filter = MakeFilter(src, MakeAndFunc(after, before));
+  MakeMemSink(filter, "foo", {});
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  MemorySourcePredicatePushdownRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ValueOrDie());
+  ASSERT_TRUE(src->IsTimeStartSet());
+  EXPECT_EQ(950, src->time_start_ns());
+  ASSERT_TRUE(src->IsTimeStopSet());
+  EXPECT_EQ(2000, src->time_stop_ns());
+  // The conjunct that isn't a plain constant still filters the rows after the start time.
+  EXPECT_THAT(filter->parents(), ElementsAre(src));
+  EXPECT_EQ(filter->filter_expr(), after);
+}
+
+TEST_F(MemorySourcePredicatePushdownTest, keeps_tighter_time_range) {
+  Relation relation({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "xyz"});
+  MemorySourceIR* src = MakeMemSource("source", relation);
+  src->SetTimeStartNS(500);
+  src->set_streaming(true);
+  compiler_state_->relation_map()->emplace("source", relation);
+
+  auto after = MakeFunc("greaterThanEqual", {MakeColumn("time_", 0), MakeTime(100)});
+  auto before = MakeFunc("lessThan", {MakeColumn("time_", 0), MakeTime(2000)});
+  MakeMemSink(MakeFilter(src, MakeAndFunc(after, before)), "foo", {});
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  MemorySourcePredicatePushdownRule rule(compiler_state_.get());
+  ASSERT_OK(rule.Execute(graph.get()));
+  EXPECT_EQ(500, src->time_start_ns());
+  // Streaming sources keep running past the filter's stop time.
+  EXPECT_FALSE(src->IsTimeStopSet());
+}
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
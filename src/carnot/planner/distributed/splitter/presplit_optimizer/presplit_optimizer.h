@@ -22,6 +22,8 @@
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/distributed/splitter/presplit_optimizer/filter_push_down_rule.h"
 #include "src/carnot/planner/distributed/splitter/presplit_optimizer/limit_push_down_rule.h"
+#include "src/carnot/planner/distributed/splitter/presplit_optimizer/memory_source_predicate_push_down_rule.h"
+#include "src/carnot/planner/distributed/splitter/presplit_optimizer/reverse_source_for_tail_rule.h"
 #include "src/carnot/planner/rules/rule_executor.h"
 
 namespace px {
@@ -54,15 +56,28 @@ class PreSplitOptimizer : public RuleExecutor<IR> {
     limit_pushdown->AddRule<LimitPushdownRule>(compiler_state_);
   }
 
+  void CreateReverseSourceForTailBatch() {
+    RuleBatch* reverse_source = CreateRuleBatch<DoOnce>("ReverseSourceForTail");
+    reverse_source->AddRule<ReverseSourceForTailRule>(compiler_state_);
+  }
+
   void CreateFilterPushdownBatch() {
     // Use TryUntilMax here to avoid swapping the positions of "equal" filters endlessly.
     RuleBatch* filter_pushdown = CreateRuleBatch<TryUntilMax>("FilterPushdown", 1);
     filter_pushdown->AddRule<FilterPushdownRule>(compiler_state_);
   }
 
+  void CreateMemorySourcePredicatePushdownBatch() {
+    // Runs once, the predicates are added to the sources rather than replacing anything.
+    RuleBatch* predicate_pushdown = CreateRuleBatch<DoOnce>("MemorySourcePredicatePushdown");
+    predicate_pushdown->AddRule<MemorySourcePredicatePushdownRule>(compiler_state_);
+  }
+
   Status Init() {
     CreateLimitPushdownBatch();
+    CreateReverseSourceForTailBatch();
     CreateFilterPushdownBatch();
+    CreateMemorySourcePredicatePushdownBatch();
     return Status::OK();
   }
 
@@ -82,10 +82,14 @@ TEST_F(PreSplitOptimizerTest, filter_pushdown) {
   auto optimizer = PreSplitOptimizer::Create(compiler_state_.get()).ConsumeValueOrDie();
   ASSERT_OK(optimizer->Execute(graph.get()));
 
+  // The filter is pushed up to the source, then folded into it.
   EXPECT_THAT(sink->parents(), ElementsAre(map));
-  EXPECT_THAT(map->parents(), ElementsAre(filter));
-  EXPECT_THAT(filter->parents(), ElementsAre(src));
-  EXPECT_MATCH(filter->filter_expr(), Equals(ColumnNode("abc"), Int(2)));
+  EXPECT_THAT(map->parents(), ElementsAre(src));
+  EXPECT_FALSE(graph->HasNode(filter->id()));
+  ASSERT_EQ(1UL, src->predicates().size());
+  EXPECT_EQ(0, src->predicates()[0].column_index());
+  EXPECT_EQ(planpb::ColumnPredicate::EQUAL, src->predicates()[0].op());
+  EXPECT_EQ(2, src->predicates()[0].value().int64_value());
 }
 
 }  // namespace distributed
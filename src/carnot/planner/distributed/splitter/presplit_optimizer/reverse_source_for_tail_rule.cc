@@ -0,0 +1,78 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/distributed/splitter/presplit_optimizer/reverse_source_for_tail_rule.h"
+#include "src/carnot/planner/ir/limit_ir.h"
+#include "src/carnot/planner/ir/memory_source_ir.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+StatusOr<bool> ReverseSourceForTailRule::Apply(IRNode* ir_node) {
+  if (!Match(ir_node, Limit()) || !static_cast<LimitIR*>(ir_node)->tail()) {
+    return false;
+  }
+  auto limit = static_cast<LimitIR*>(ir_node);
+  DCHECK_EQ(1U, limit->parents().size());
+  OperatorIR* op = limit->parents()[0];
+  // Reversing the source reverses everything that reads from it, so every operator on the way has
+  // to feed only the Limit.
+  while (Match(op, Map()) || Match(op, Filter()) || Match(op, Drop())) {
+    if (op->Children().size() != 1) {
+      return limit->CreateIRNodeError(
+          "tail() isn't supported on a DataFrame that is also used by other operations");
+    }
+    op = op->parents()[0];
+  }
+
+  if (Match(op, Union())) {
+    // The branches of the union are handled by their own tail Limits.
+    for (OperatorIR* parent : op->parents()) {
+      if (!Match(parent, Limit()) || !static_cast<LimitIR*>(parent)->tail()) {
+        return limit->CreateIRNodeError(
+            "tail() is only supported on DataFrames read directly from a table");
+      }
+    }
+    return false;
+  }
+  if (!Match(op, MemorySource())) {
+    return limit->CreateIRNodeError(
+        "tail() is only supported on DataFrames read directly from a table, optionally through "
+        "map, filter and drop operations");
+  }
+  auto source = static_cast<MemorySourceIR*>(op);
+  if (source->streaming()) {
+    return limit->CreateIRNodeError("tail() isn't supported on streaming DataFrames");
+  }
+  if (source->Children().size() != 1) {
+    return limit->CreateIRNodeError(
+        "tail() isn't supported on a DataFrame that is also used by other operations");
+  }
+  if (source->reverse()) {
+    return false;
+  }
+  source->set_reverse(true);
+  return true;
+}
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include "src/carnot/planner/compiler/test_utils.h"
+#include "src/carnot/planner/distributed/splitter/presplit_optimizer/reverse_source_for_tail_rule.h"
+#include "src/carnot/planner/test_utils.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+using ReverseSourceForTailRuleTest = testutils::DistributedRulesTest;
+
+TEST_F(ReverseSourceForTailRuleTest, reverses_source) {
+  Relation relation({types::DataType::INT64, types::DataType::INT64}, {"abc", "xyz"});
+  MemorySourceIR* src = MakeMemSource(relation);
+  FilterIR* filter = MakeFilter(src, MakeEqualsFunc(MakeColumn("abc", 0), MakeColumn("xyz", 0)));
+  MapIR* map = MakeMap(filter, {{"abc", MakeColumn("abc", 0)}}, false);
+  LimitIR* limit = MakeLimit(map, 10);
+  limit->set_tail(true);
+  MakeMemSink(limit, "foo", {});
+
+  ReverseSourceForTailRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ValueOrDie());
+  EXPECT_TRUE(src->reverse());
+
+  // The source is only reversed once.
+  result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ValueOrDie());
+}
+
+TEST_F(ReverseSourceForTailRuleTest, head_is_no_op) {
+  Relation relation({types::DataType::INT64, types::DataType::INT64}, {"abc", "xyz"});
+  MemorySourceIR* src = MakeMemSource(relation);
+  LimitIR* limit = MakeLimit(src, 10);
+  MakeMemSink(limit, "foo", {});
+
+  ReverseSourceForTailRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ValueOrDie());
+  EXPECT_FALSE(src->reverse());
+}
+
+TEST_F(ReverseSourceForTailRuleTest, union_of_tails) {
+  Relation relation({types::DataType::INT64}, {"abc"});
+  MemorySourceIR* src1 = MakeMemSource(relation);
+  LimitIR* limit1 = MakeLimit(src1, 10);
+  limit1->set_tail(true);
+  MemorySourceIR* src2 = MakeMemSource(relation);
+  LimitIR* limit2 = MakeLimit(src2, 10);
+  limit2->set_tail(true);
+  UnionIR* union_node = MakeUnion({limit1, limit2});
+  LimitIR* limit = MakeLimit(union_node, 10);
+  limit->set_tail(true);
+  MakeMemSink(limit, "foo", {});
+
+  ReverseSourceForTailRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ValueOrDie());
+  EXPECT_TRUE(src1->reverse());
+  EXPECT_TRUE(src2->reverse());
+}
+
+TEST_F(ReverseSourceForTailRuleTest, shared_source) {
+  Relation relation({types::DataType::INT64, types::DataType::INT64}, {"abc", "xyz"});
+  MemorySourceIR* src = MakeMemSource(relation);
+  LimitIR* limit = MakeLimit(src, 10);
+  limit->set_tail(true);
+  MakeMemSink(limit, "foo", {});
+  MakeMemSink(src, "bar", {});
+
+  ReverseSourceForTailRule rule(compiler_state_.get());
+  EXPECT_THAT(rule.Execute(graph.get()).status(),
+              HasCompilerError("tail\\(\\) isn't supported on a DataFrame that is also used"));
+  EXPECT_FALSE(src->reverse());
+}
+
+TEST_F(ReverseSourceForTailRuleTest, streaming_source) {
+  Relation relation({types::DataType::INT64, types::DataType::INT64}, {"abc", "xyz"});
+  MemorySourceIR* src = MakeMemSource(relation);
+  src->set_streaming(true);
+  LimitIR* limit = MakeLimit(src, 10);
+  limit->set_tail(true);
+  MakeMemSink(limit, "foo", {});
+
+  ReverseSourceForTailRule rule(compiler_state_.get());
+  EXPECT_THAT(rule.Execute(graph.get()).status(),
+              HasCompilerError("tail\\(\\) isn't supported on streaming DataFrames"));
+}
+
+TEST_F(ReverseSourceForTailRuleTest, after_agg) {
+  Relation relation({types::DataType::INT64, types::DataType::INT64}, {"abc", "xyz"});
+  MemorySourceIR* src = MakeMemSource(relation);
+  BlockingAggIR* agg = MakeBlockingAgg(src, {MakeColumn("abc", 0)}, {});
+  LimitIR* limit = MakeLimit(agg, 10);
+  limit->set_tail(true);
+  MakeMemSink(limit, "foo", {});
+
+  ReverseSourceForTailRule rule(compiler_state_.get());
+  EXPECT_THAT(rule.Execute(graph.get()).status(),
+              HasCompilerError("tail\\(\\) is only supported on DataFrames read directly"));
+}
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -33,12 +33,74 @@ namespace carnot {
 namespace planner {
 namespace distributed {
 
-StatusOr<bool> OperatorMustRunOnKelvin(CompilerState* compiler_state, OperatorIR* op) {
-  // If the operator can't run on a PEM, or is a blocking operator, we should
-  // schedule this node to run on a Kelvin.
-  PX_ASSIGN_OR_RETURN(bool runs_on_pem,
-                      ScalarUDFsRunOnPEMRule::OperatorUDFsRunOnPEM(compiler_state, op));
-  return !runs_on_pem || op->IsBlocking();
+bool IsUPIDColumn(const ColumnIR* col) {
+  return col->is_type_resolved() && col->resolved_value_type()->semantic_type() == types::ST_UPID;
+}
+
+StatusOr<bool> OperatorCanRunOnPEM(CompilerState* compiler_state, OperatorIR* op);
+
+// Whether the operator and all of its ancestors run on the PEMs, reading only local tables.
+StatusOr<bool> AncestorsRunOnPEM(CompilerState* compiler_state, OperatorIR* op) {
+  if (Match(op, SourceOperator())) {
+    return Match(op, MemorySource());
+  }
+  PX_ASSIGN_OR_RETURN(bool on_pem, OperatorCanRunOnPEM(compiler_state, op));
+  if (!on_pem) {
+    return false;
+  }
+  for (OperatorIR* parent : op->parents()) {
+    PX_ASSIGN_OR_RETURN(bool parent_on_pem, AncestorsRunOnPEM(compiler_state, parent));
+    if (!parent_on_pem) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// A UPID contains the ASID of the agent that collected it, so an equijoin on the UPIDs of two
+// local tables only ever matches rows of the same PEM. Such a join runs on every PEM, instead of
+// pulling both of its inputs to the Kelvin.
+StatusOr<bool> IsColocatedJoin(CompilerState* compiler_state, OperatorIR* op) {
+  if (!Match(op, Join())) {
+    return false;
+  }
+  auto join = static_cast<JoinIR*>(op);
+  // The PEMs that don't have one of the tables prune the join, which only keeps the result
+  // correct for inner joins.
+  if (join->join_type() != JoinIR::JoinType::kInner) {
+    return false;
+  }
+  const auto& left_on = join->left_on_columns();
+  const auto& right_on = join->right_on_columns();
+  bool joins_on_upid = false;
+  for (size_t i = 0; i < left_on.size() && i < right_on.size(); ++i) {
+    joins_on_upid |= IsUPIDColumn(left_on[i]) && IsUPIDColumn(right_on[i]);
+  }
+  if (!joins_on_upid) {
+    return false;
+  }
+  for (OperatorIR* parent : op->parents()) {
+    PX_ASSIGN_OR_RETURN(bool parent_on_pem, AncestorsRunOnPEM(compiler_state, parent));
+    if (!parent_on_pem) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// An as-of join needs its inputs in time order, which only the rows of a single PEM are, so it
+// runs on every PEM when both of its inputs are read there.
+StatusOr<bool> IsPEMAsOfJoin(CompilerState* compiler_state, OperatorIR* op) {
+  if (!Match(op, AsOfJoin())) {
+    return false;
+  }
+  for (OperatorIR* parent : op->parents()) {
+    PX_ASSIGN_OR_RETURN(bool parent_on_pem, AncestorsRunOnPEM(compiler_state, parent));
+    if (!parent_on_pem) {
+      return false;
+    }
+  }
+  return true;
 }
 
 StatusOr<bool> OperatorCanRunOnPEM(CompilerState* compiler_state, OperatorIR* op) {
@@ -46,7 +108,24 @@ StatusOr<bool> OperatorCanRunOnPEM(CompilerState* compiler_state, OperatorIR* op
   // schedule this node to run on a PEM.
   PX_ASSIGN_OR_RETURN(bool runs_on_pem,
                       ScalarUDFsRunOnPEMRule::OperatorUDFsRunOnPEM(compiler_state, op));
-  return runs_on_pem && !op->IsBlocking();
+  if (!runs_on_pem) {
+    return false;
+  }
+  if (!op->IsBlocking()) {
+    return true;
+  }
+  PX_ASSIGN_OR_RETURN(bool is_pem_as_of_join, IsPEMAsOfJoin(compiler_state, op));
+  if (is_pem_as_of_join) {
+    return true;
+  }
+  return IsColocatedJoin(compiler_state, op);
+}
+
+StatusOr<bool> OperatorMustRunOnKelvin(CompilerState* compiler_state, OperatorIR* op) {
+  // If the operator can't run on a PEM, or is a blocking operator, we should
+  // schedule this node to run on a Kelvin.
+  PX_ASSIGN_OR_RETURN(bool can_run_on_pem, OperatorCanRunOnPEM(compiler_state, op));
+  return !can_run_on_pem;
 }
 
 BlockingSplitNodeIDGroups Splitter::GetSplitGroups(
@@ -432,8 +511,10 @@ Status Splitter::InsertGRPCBridge(IR* plan, OperatorIR* parent,
     PartialOperatorMgr* mgr = GetPartialOperatorMgr(c);
     DCHECK(mgr) << "mgr not found for " << c->DebugString();
     PX_ASSIGN_OR_RETURN(OperatorIR * prepare_op, mgr->CreatePrepareOperator(plan, c));
-    DCHECK(prepare_op->IsChildOf(parent)) << absl::Substitute(
-        "'$0' is not a child of '$1'", prepare_op->DebugString(), parent->DebugString());
+    // The prepare op may sit on top of operators of its own, ie the PEM Map of MapAggOperatorMgr.
+    DCHECK(prepare_op->IsChildOf(parent) || prepare_op->parents()[0]->IsChildOf(parent))
+        << absl::Substitute("'$0' is not a descendant of '$1'", prepare_op->DebugString(),
+                            parent->DebugString());
 
     // Create the GRPC Bridge from the prepare_op.
     PX_ASSIGN_OR_RETURN(GRPCSinkIR * grpc_sink, CreateGRPCSink(prepare_op, grpc_id_counter_));
@@ -122,8 +122,10 @@ class Splitter : public NotCopyable {
   Status Init(bool support_partial_agg) {
     if (support_partial_agg) {
       partial_operator_mgrs_.push_back(std::make_unique<AggOperatorMgr>());
+      partial_operator_mgrs_.push_back(std::make_unique<MapAggOperatorMgr>(compiler_state_));
     }
     partial_operator_mgrs_.push_back(std::make_unique<LimitOperatorMgr>());
+    partial_operator_mgrs_.push_back(std::make_unique<TopKOperatorMgr>());
     return Status::OK();
   }
   /**
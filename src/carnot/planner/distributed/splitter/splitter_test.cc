@@ -239,6 +239,56 @@ TEST_F(SplitterTest, limit_test) {
   EXPECT_EQ(grpc_sink->destination_id(), grpc_source_group->source_id());
 }
 
+TEST_F(SplitterTest, top_k_test) {
+  auto mem_src = MakeMemSource("cpu", cpu_relation);
+  auto top_k = MakeTopK(mem_src, {{"cpu0", /*descending*/ true}}, 10);
+  auto sink = MakeMemSink(top_k, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  auto splitter_or_s = Splitter::Create(compiler_state_.get(), /* perform_partial_agg */ false);
+  ASSERT_OK(splitter_or_s);
+  std::unique_ptr<Splitter> splitter = splitter_or_s.ConsumeValueOrDie();
+  std::unique_ptr<BlockingSplitPlan> split_plan =
+      splitter->SplitKelvinAndAgents(graph.get()).ConsumeValueOrDie();
+
+  auto before_blocking = split_plan->before_blocking.get();
+  auto after_blocking = split_plan->after_blocking.get();
+
+  // Each agent keeps its own top k rows.
+  MemorySourceIR* new_mem_src = GetEquivalentInNewPlan(before_blocking, mem_src);
+  ASSERT_EQ(new_mem_src->Children().size(), 1UL) << new_mem_src->ChildrenDebugString();
+  OperatorIR* mem_src_child = new_mem_src->Children()[0];
+
+  ASSERT_TRUE(Match(mem_src_child, TopK()))
+      << "Expected TopK, got " << mem_src_child->type_string();
+  TopKIR* prepare_top_k = static_cast<TopKIR*>(mem_src_child);
+  EXPECT_EQ(prepare_top_k->limit(), top_k->limit());
+  ASSERT_EQ(prepare_top_k->Children().size(), 1UL);
+
+  OperatorIR* before_blocking_top_k_child = prepare_top_k->Children()[0];
+  ASSERT_TRUE(Match(before_blocking_top_k_child, GRPCSink()))
+      << "Expected GRPCSink, got " << before_blocking_top_k_child->type_string();
+  GRPCSinkIR* grpc_sink = static_cast<GRPCSinkIR*>(before_blocking_top_k_child);
+
+  // Kelvin merges the rows of all the agents with the same TopK.
+  OperatorIR* sink_parent = GetEquivalentInNewPlan(after_blocking, sink)->parents()[0];
+  ASSERT_TRUE(Match(sink_parent, TopK())) << "Expected TopK, got " << sink_parent->type_string();
+  TopKIR* merge_top_k = static_cast<TopKIR*>(sink_parent);
+  EXPECT_EQ(merge_top_k->limit(), top_k->limit());
+  ASSERT_EQ(merge_top_k->sort_columns().size(), 1UL);
+  EXPECT_EQ(merge_top_k->sort_columns()[0].col_name, "cpu0");
+  EXPECT_TRUE(merge_top_k->sort_columns()[0].descending);
+
+  OperatorIR* top_k_parent = merge_top_k->parents()[0];
+  ASSERT_TRUE(Match(top_k_parent, GRPCSourceGroup()))
+      << "Expected GRPCSourceGroup, got " << top_k_parent->type_string();
+  GRPCSourceGroupIR* grpc_source_group = static_cast<GRPCSourceGroupIR*>(top_k_parent);
+
+  EXPECT_EQ(grpc_sink->destination_id(), grpc_source_group->source_id());
+}
+
 TEST_F(SplitterTest, limit_test_pem_only) {
   auto mem_src = MakeMemSource("cpu", cpu_relation);
   auto limit = MakeLimit(mem_src, 10, /* pem_only */ true);
@@ -567,6 +617,98 @@ TEST_F(SplitterTest, agg_join_children) {
   EXPECT_EQ(join_parent->source_id(), grpc_sink->destination_id());
 }
 
+// Joins on the UPIDs of two local tables only match rows of the same PEM, so they run on the PEMs.
+TEST_F(SplitterTest, upid_join_runs_on_pem) {
+  Relation left_relation({types::UINT128, types::INT64}, {"upid", "count"},
+                         {types::ST_UPID, types::ST_NONE});
+  Relation right_relation({types::UINT128, types::FLOAT64}, {"upid", "cpu0"},
+                          {types::ST_UPID, types::ST_NONE});
+  compiler_state_->relation_map()->emplace("left", left_relation);
+  compiler_state_->relation_map()->emplace("right", right_relation);
+  auto left_src = MakeMemSource("left", left_relation);
+  auto right_src = MakeMemSource("right", right_relation);
+  auto join = MakeJoin({left_src, right_src}, "inner", left_relation, right_relation, {"upid"},
+                       {"upid"}, {"", "_right"});
+  auto sink = MakeMemSink(join, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  auto splitter_or_s = Splitter::Create(compiler_state_.get(), /* perform_partial_agg */ false);
+  ASSERT_OK(splitter_or_s);
+  std::unique_ptr<Splitter> splitter = splitter_or_s.ConsumeValueOrDie();
+  std::unique_ptr<BlockingSplitPlan> split_plan =
+      splitter->SplitKelvinAndAgents(graph.get()).ConsumeValueOrDie();
+  auto before_blocking = split_plan->before_blocking.get();
+  auto after_blocking = split_plan->after_blocking.get();
+
+  auto new_join = GetEquivalentInNewPlan(before_blocking, join);
+  EXPECT_EQ(new_join->parents()[0], GetEquivalentInNewPlan(before_blocking, left_src));
+  EXPECT_EQ(new_join->parents()[1], GetEquivalentInNewPlan(before_blocking, right_src));
+  HasGRPCSinkChild(join->id(), before_blocking, "");
+  EXPECT_FALSE(HasEquivalentInNewPlan(after_blocking, join));
+  HasGRPCSourceGroupParent(sink->id(), after_blocking, "");
+}
+
+// Unmatched rows of outer joins may have a match on another PEM, so those stay on the Kelvin.
+TEST_F(SplitterTest, upid_left_join_runs_on_kelvin) {
+  Relation left_relation({types::UINT128, types::INT64}, {"upid", "count"},
+                         {types::ST_UPID, types::ST_NONE});
+  Relation right_relation({types::UINT128, types::FLOAT64}, {"upid", "cpu0"},
+                          {types::ST_UPID, types::ST_NONE});
+  compiler_state_->relation_map()->emplace("left", left_relation);
+  compiler_state_->relation_map()->emplace("right", right_relation);
+  auto left_src = MakeMemSource("left", left_relation);
+  auto right_src = MakeMemSource("right", right_relation);
+  auto join = MakeJoin({left_src, right_src}, "left", left_relation, right_relation, {"upid"},
+                       {"upid"}, {"", "_right"});
+  MakeMemSink(join, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  auto splitter_or_s = Splitter::Create(compiler_state_.get(), /* perform_partial_agg */ false);
+  ASSERT_OK(splitter_or_s);
+  std::unique_ptr<Splitter> splitter = splitter_or_s.ConsumeValueOrDie();
+  std::unique_ptr<BlockingSplitPlan> split_plan =
+      splitter->SplitKelvinAndAgents(graph.get()).ConsumeValueOrDie();
+
+  EXPECT_FALSE(HasEquivalentInNewPlan(split_plan->before_blocking.get(), join));
+  auto new_join = GetEquivalentInNewPlan(split_plan->after_blocking.get(), join);
+  EXPECT_MATCH(new_join->parents()[0], GRPCSourceGroup());
+  EXPECT_MATCH(new_join->parents()[1], GRPCSourceGroup());
+}
+
+// Only the rows of a single PEM are in time order, so as-of joins of local tables run on the PEMs.
+TEST_F(SplitterTest, as_of_join_runs_on_pem) {
+  Relation left_relation({types::TIME64NS, types::INT64}, {"time_", "count"});
+  Relation right_relation({types::TIME64NS, types::FLOAT64}, {"time_", "cpu0"});
+  compiler_state_->relation_map()->emplace("left", left_relation);
+  compiler_state_->relation_map()->emplace("right", right_relation);
+  auto left_src = MakeMemSource("left", left_relation);
+  auto right_src = MakeMemSource("right", right_relation);
+  auto join = MakeAsOfJoin({left_src, right_src}, "left", "time_", {});
+  auto sink = MakeMemSink(join, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  auto splitter_or_s = Splitter::Create(compiler_state_.get(), /* perform_partial_agg */ false);
+  ASSERT_OK(splitter_or_s);
+  std::unique_ptr<Splitter> splitter = splitter_or_s.ConsumeValueOrDie();
+  std::unique_ptr<BlockingSplitPlan> split_plan =
+      splitter->SplitKelvinAndAgents(graph.get()).ConsumeValueOrDie();
+  auto before_blocking = split_plan->before_blocking.get();
+  auto after_blocking = split_plan->after_blocking.get();
+
+  auto new_join = GetEquivalentInNewPlan(before_blocking, join);
+  EXPECT_EQ(new_join->parents()[0], GetEquivalentInNewPlan(before_blocking, left_src));
+  EXPECT_EQ(new_join->parents()[1], GetEquivalentInNewPlan(before_blocking, right_src));
+  HasGRPCSinkChild(join->id(), before_blocking, "");
+  EXPECT_FALSE(HasEquivalentInNewPlan(after_blocking, join));
+  HasGRPCSourceGroupParent(sink->id(), after_blocking, "");
+}
+
 TEST_F(SplitterTest, simple_split_test) {
   auto mem_src = MakeMemSource("cpu", cpu_relation);
   auto map1 = MakeMap(mem_src, {{"cpu0", MakeColumn("cpu0", 0)}, {"cpu1", MakeColumn("cpu1", 0)}});
@@ -1353,6 +1495,61 @@ TEST_F(SplitterTest, schedule_kelvin_only_func_on_kelvin) {
   EXPECT_EQ(sink_parent, new_agg);
 }
 
+TEST_F(SplitterTest, partial_agg_through_kelvin_only_map) {
+  auto mem_src = MakeMemSource("cpu", cpu_relation);
+  auto kelvin_func = MakeFunc("kelvin_only", {});
+  auto kelvin_only_map =
+      MakeMap(mem_src, {{"kelvin_only", kelvin_func}, {"count", MakeColumn("count", 0)}},
+              /*keep_input_columns*/ false);
+  auto mean_func = MakeMeanFuncWithFloatType(MakeColumn("count", 0, types::DataType::INT64));
+  auto agg = MakeBlockingAgg(kelvin_only_map,
+                             {MakeColumn("kelvin_only", 0), MakeColumn("count", 0)},
+                             {{"mean", mean_func}});
+  auto sink = MakeMemSink(agg, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  auto splitter_or_s = Splitter::Create(compiler_state_.get(), /* perform_partial_agg */ true);
+  ASSERT_OK(splitter_or_s);
+  std::unique_ptr<Splitter> splitter = splitter_or_s.ConsumeValueOrDie();
+
+  std::unique_ptr<BlockingSplitPlan> split_plan =
+      splitter->SplitKelvinAndAgents(graph.get()).ConsumeValueOrDie();
+  auto before_blocking = split_plan->before_blocking.get();
+  auto after_blocking = split_plan->after_blocking.get();
+
+  // The PEM aggregates by the columns that don't need the Kelvin-only UDF.
+  MemorySourceIR* new_mem_src = GetEquivalentInNewPlan(before_blocking, mem_src);
+  ASSERT_EQ(new_mem_src->Children().size(), 1UL);
+  ASSERT_MATCH(new_mem_src->Children()[0], Map());
+  auto pem_map = static_cast<MapIR*>(new_mem_src->Children()[0]);
+  ASSERT_EQ(pem_map->Children().size(), 1UL);
+  ASSERT_MATCH(pem_map->Children()[0], PartialAgg());
+  auto partial_agg = static_cast<BlockingAggIR*>(pem_map->Children()[0]);
+  ASSERT_EQ(partial_agg->groups().size(), 1UL);
+  EXPECT_EQ(partial_agg->groups()[0]->col_name(), "count");
+  EXPECT_THAT(*partial_agg->resolved_table_type(),
+              IsTableType(Relation({types::INT64, types::STRING}, {"count", "serialized_mean"})));
+  ASSERT_EQ(partial_agg->Children().size(), 1UL);
+  ASSERT_MATCH(partial_agg->Children()[0], GRPCSink());
+  auto grpc_sink = static_cast<GRPCSinkIR*>(partial_agg->Children()[0]);
+
+  // Kelvin computes the remaining group and merges the partial aggregates.
+  EXPECT_FALSE(HasEquivalentInNewPlan(after_blocking, kelvin_only_map));
+  BlockingAggIR* new_agg = GetEquivalentInNewPlan(after_blocking, agg);
+  EXPECT_MATCH(new_agg, FinalizeAgg());
+  ASSERT_MATCH(new_agg->parents()[0], Map());
+  auto kelvin_map = static_cast<MapIR*>(new_agg->parents()[0]);
+  EXPECT_THAT(*kelvin_map->resolved_table_type(),
+              IsTableType(Relation({types::STRING, types::INT64, types::STRING},
+                                   {"kelvin_only", "count", "serialized_mean"})));
+  ASSERT_MATCH(kelvin_map->parents()[0], GRPCSourceGroup());
+  auto grpc_source_group = static_cast<GRPCSourceGroupIR*>(kelvin_map->parents()[0]);
+  EXPECT_EQ(grpc_sink->destination_id(), grpc_source_group->source_id());
+  EXPECT_EQ(GetEquivalentInNewPlan(after_blocking, sink)->parents()[0], new_agg);
+}
+
 TEST_F(SplitterTest, errors_if_pem_func_on_kelvin) {
   auto mem_src = MakeMemSource("cpu", cpu_relation);
   auto mean_func = MakeMeanFuncWithFloatType(MakeColumn("count", 0, types::DataType::INT64));
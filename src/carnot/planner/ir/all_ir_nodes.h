@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include "src/carnot/planner/ir/as_of_join_ir.h"
 #include "src/carnot/planner/ir/blocking_agg_ir.h"
 #include "src/carnot/planner/ir/bool_ir.h"
 #include "src/carnot/planner/ir/column_ir.h"
@@ -44,10 +45,12 @@
 #include "src/carnot/planner/ir/operator_ir.h"
 #include "src/carnot/planner/ir/otel_export_sink_ir.h"
 #include "src/carnot/planner/ir/rolling_ir.h"
+#include "src/carnot/planner/ir/sort_ir.h"
 #include "src/carnot/planner/ir/stream_ir.h"
 #include "src/carnot/planner/ir/string_ir.h"
 #include "src/carnot/planner/ir/tablet_source_group_ir.h"
 #include "src/carnot/planner/ir/time_ir.h"
+#include "src/carnot/planner/ir/top_k_ir.h"
 #include "src/carnot/planner/ir/udtf_source_ir.h"
 #include "src/carnot/planner/ir/uint128_ir.h"
 #include "src/carnot/planner/ir/union_ir.h"
@@ -0,0 +1,299 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/ir/as_of_join_ir.h"
+#include "src/carnot/planner/ir/ir.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+Status AsOfJoinIR::Init(const std::vector<OperatorIR*>& parents, const std::string& how_type,
+                        ColumnIR* left_time_col, ColumnIR* right_time_col,
+                        const std::vector<ColumnIR*>& left_by_cols,
+                        const std::vector<ColumnIR*>& right_by_cols, int64_t tolerance_ns,
+                        const std::vector<std::string>& suffix_strs) {
+  if (left_by_cols.size() != right_by_cols.size()) {
+    return CreateIRNodeError("'left_by' and 'right_by' must contain the same number of elements.");
+  }
+  if (tolerance_ns < 0) {
+    return CreateIRNodeError("'tolerance' must be non-negative, got $0", tolerance_ns);
+  }
+  PX_ASSIGN_OR_RETURN(join_type_, GetJoinEnum(how_type));
+
+  // Support joining a table against itself by calling HandleDuplicateParents.
+  PX_ASSIGN_OR_RETURN(auto transformed_parents, HandleDuplicateParents(parents));
+  for (auto* p : transformed_parents) {
+    PX_RETURN_IF_ERROR(AddParent(p));
+  }
+
+  PX_RETURN_IF_ERROR(SetKeyColumns(left_time_col, right_time_col, left_by_cols, right_by_cols));
+  tolerance_ns_ = tolerance_ns;
+  suffix_strs_ = suffix_strs;
+  return Status::OK();
+}
+
+StatusOr<AsOfJoinIR::JoinType> AsOfJoinIR::GetJoinEnum(const std::string& join_type_str) const {
+  if (join_type_str == "inner") {
+    return JoinType::kInner;
+  }
+  if (join_type_str == "left") {
+    return JoinType::kLeft;
+  }
+  return CreateIRNodeError("'$0' join type not supported. Only {inner,left} are available.",
+                           join_type_str);
+}
+
+Status AsOfJoinIR::SetKeyColumns(ColumnIR* left_time_col, ColumnIR* right_time_col,
+                                 const std::vector<ColumnIR*>& left_by_cols,
+                                 const std::vector<ColumnIR*>& right_by_cols) {
+  PX_ASSIGN_OR_RETURN(left_time_column_, graph()->OptionallyCloneWithEdge(this, left_time_col));
+  PX_ASSIGN_OR_RETURN(right_time_column_, graph()->OptionallyCloneWithEdge(this, right_time_col));
+  left_by_columns_.resize(left_by_cols.size());
+  for (size_t i = 0; i < left_by_cols.size(); ++i) {
+    PX_ASSIGN_OR_RETURN(left_by_columns_[i],
+                        graph()->OptionallyCloneWithEdge(this, left_by_cols[i]));
+  }
+  right_by_columns_.resize(right_by_cols.size());
+  for (size_t i = 0; i < right_by_cols.size(); ++i) {
+    PX_ASSIGN_OR_RETURN(right_by_columns_[i],
+                        graph()->OptionallyCloneWithEdge(this, right_by_cols[i]));
+  }
+  return Status::OK();
+}
+
+Status AsOfJoinIR::SetOutputColumns(const std::vector<std::string>& column_names,
+                                    const std::vector<ColumnIR*>& columns) {
+  DCHECK_EQ(column_names.size(), columns.size());
+  auto old_output_cols = output_columns_;
+
+  output_columns_ = columns;
+  column_names_ = column_names;
+  output_columns_set_ = true;
+
+  for (auto old_col : old_output_cols) {
+    PX_RETURN_IF_ERROR(graph()->DeleteEdge(this, old_col));
+  }
+  for (auto new_col : output_columns_) {
+    PX_RETURN_IF_ERROR(graph()->AddEdge(this, new_col));
+  }
+  for (auto old_col : old_output_cols) {
+    PX_RETURN_IF_ERROR(graph()->DeleteOrphansInSubtree(old_col->id()));
+  }
+  return Status::OK();
+}
+
+Status AsOfJoinIR::CopyFromNodeImpl(const IRNode* node,
+                                    absl::flat_hash_map<const IRNode*, IRNode*>* copied_nodes_map) {
+  const AsOfJoinIR* join_node = static_cast<const AsOfJoinIR*>(node);
+  join_type_ = join_node->join_type_;
+
+  PX_ASSIGN_OR_RETURN(ColumnIR * new_left_time_col,
+                      graph()->CopyNode(join_node->left_time_column_, copied_nodes_map));
+  PX_ASSIGN_OR_RETURN(ColumnIR * new_right_time_col,
+                      graph()->CopyNode(join_node->right_time_column_, copied_nodes_map));
+  std::vector<ColumnIR*> new_left_by_cols;
+  for (const ColumnIR* col : join_node->left_by_columns_) {
+    PX_ASSIGN_OR_RETURN(ColumnIR * new_node, graph()->CopyNode(col, copied_nodes_map));
+    new_left_by_cols.push_back(new_node);
+  }
+  std::vector<ColumnIR*> new_right_by_cols;
+  for (const ColumnIR* col : join_node->right_by_columns_) {
+    PX_ASSIGN_OR_RETURN(ColumnIR * new_node, graph()->CopyNode(col, copied_nodes_map));
+    new_right_by_cols.push_back(new_node);
+  }
+  PX_RETURN_IF_ERROR(
+      SetKeyColumns(new_left_time_col, new_right_time_col, new_left_by_cols, new_right_by_cols));
+
+  if (join_node->output_columns_set_) {
+    std::vector<ColumnIR*> new_output_columns;
+    for (const ColumnIR* col : join_node->output_columns_) {
+      PX_ASSIGN_OR_RETURN(ColumnIR * new_node, graph()->CopyNode(col, copied_nodes_map));
+      new_output_columns.push_back(new_node);
+    }
+    PX_RETURN_IF_ERROR(SetOutputColumns(join_node->column_names_, new_output_columns));
+  }
+  tolerance_ns_ = join_node->tolerance_ns_;
+  suffix_strs_ = join_node->suffix_strs_;
+  return Status::OK();
+}
+
+Status AsOfJoinIR::UpdateOpAfterParentTypesResolvedImpl() {
+  // The output columns are chosen once, later resolutions keep the ones that weren't pruned.
+  if (output_columns_set_) {
+    return Status::OK();
+  }
+  DCHECK_EQ(2UL, parents().size());
+  auto left_type = parents()[0]->resolved_table_type();
+  auto right_type = parents()[1]->resolved_table_type();
+
+  // The right keys equal the left ones, so only the left keys are output.
+  absl::flat_hash_set<std::string> right_key_names{right_time_column_->col_name()};
+  for (ColumnIR* col : right_by_columns_) {
+    right_key_names.insert(col->col_name());
+  }
+  std::vector<std::string> right_column_names;
+  for (const auto& col_name : right_type->ColumnNames()) {
+    if (!right_key_names.contains(col_name)) {
+      right_column_names.push_back(col_name);
+    }
+  }
+  absl::flat_hash_set<std::string> left_names(left_type->ColumnNames().begin(),
+                                              left_type->ColumnNames().end());
+  absl::flat_hash_set<std::string> right_names(right_column_names.begin(),
+                                               right_column_names.end());
+
+  std::vector<std::string> output_column_names;
+  std::vector<ColumnIR*> output_columns;
+  auto add_column = [&](const std::string& col_name, int64_t parent_idx,
+                        const absl::flat_hash_set<std::string>& other_names) -> Status {
+    std::string out_name = col_name;
+    if (other_names.contains(col_name)) {
+      out_name = absl::StrCat(col_name, suffix_strs_[parent_idx]);
+    }
+    PX_ASSIGN_OR_RETURN(ColumnIR * col, graph()->CreateNode<ColumnIR>(ast(), col_name, parent_idx));
+    output_column_names.push_back(out_name);
+    output_columns.push_back(col);
+    return Status::OK();
+  };
+  for (const auto& col_name : left_type->ColumnNames()) {
+    PX_RETURN_IF_ERROR(add_column(col_name, 0, right_names));
+  }
+  for (const auto& col_name : right_column_names) {
+    PX_RETURN_IF_ERROR(add_column(col_name, 1, left_names));
+  }
+
+  absl::flat_hash_set<std::string> seen_names;
+  for (const auto& col_name : output_column_names) {
+    if (!seen_names.insert(col_name).second) {
+      return CreateIRNodeError(
+          "duplicate column '$0' after merge_asof. Change the specified suffixes ('$1','$2') to "
+          "fix this",
+          col_name, suffix_strs_[0], suffix_strs_[1]);
+    }
+  }
+  return SetOutputColumns(output_column_names, output_columns);
+}
+
+Status AsOfJoinIR::ResolveType(CompilerState* compiler_state) {
+  DCHECK_EQ(2U, parent_types().size());
+
+  for (ColumnIR* time_col : {left_time_column_, right_time_column_}) {
+    PX_RETURN_IF_ERROR(ResolveExpressionType(time_col, compiler_state, parent_types()));
+    auto time_col_dt = time_col->resolved_value_type()->data_type();
+    if (time_col_dt != types::TIME64NS) {
+      return CreateIRNodeError("merge_asof() 'on' column '$0' must be TIME64NS, got $1",
+                               time_col->col_name(), magic_enum::enum_name(time_col_dt));
+    }
+  }
+
+  // Check that the by columns have the same types.
+  for (const auto& [idx, left_col] : Enumerate(left_by_columns_)) {
+    // Init checks that the left and right by columns are the same length.
+    auto right_col = right_by_columns_[idx];
+    PX_RETURN_IF_ERROR(ResolveExpressionType(left_col, compiler_state, parent_types()));
+    PX_RETURN_IF_ERROR(ResolveExpressionType(right_col, compiler_state, parent_types()));
+    auto left_col_dt = left_col->resolved_value_type()->data_type();
+    auto right_col_dt = right_col->resolved_value_type()->data_type();
+    if (left_col_dt != right_col_dt) {
+      return CreateIRNodeError(
+          "merge_asof() 'by' columns must have the same datatype, but the $0-th columns "
+          "disagree. [\"$1\" ($2) vs \"$3\" ($4)]",
+          idx, left_col->col_name(), magic_enum::enum_name(left_col_dt), right_col->col_name(),
+          magic_enum::enum_name(right_col_dt));
+    }
+  }
+
+  auto new_table = TableType::Create();
+  for (const auto& [idx, col] : Enumerate(output_columns_)) {
+    PX_RETURN_IF_ERROR(ResolveExpressionType(col, compiler_state, parent_types()));
+    new_table->AddColumn(column_names_[idx], col->resolved_type());
+  }
+  return SetResolvedType(new_table);
+}
+
+StatusOr<std::vector<absl::flat_hash_set<std::string>>> AsOfJoinIR::RequiredInputColumns() const {
+  DCHECK(output_columns_set_);
+  std::vector<absl::flat_hash_set<std::string>> ret(2);
+  ret[0].insert(left_time_column_->col_name());
+  ret[1].insert(right_time_column_->col_name());
+  for (ColumnIR* col : left_by_columns_) {
+    ret[0].insert(col->col_name());
+  }
+  for (ColumnIR* col : right_by_columns_) {
+    ret[1].insert(col->col_name());
+  }
+  for (ColumnIR* col : output_columns_) {
+    DCHECK(col->container_op_parent_idx_set());
+    ret[col->container_op_parent_idx()].insert(col->col_name());
+  }
+  return ret;
+}
+
+StatusOr<absl::flat_hash_set<std::string>> AsOfJoinIR::PruneOutputColumnsToImpl(
+    const absl::flat_hash_set<std::string>& kept_columns) {
+  DCHECK(output_columns_set_);
+  std::vector<ColumnIR*> new_output_cols;
+  std::vector<std::string> new_output_names;
+  for (const auto& [col_idx, col_name] : Enumerate(column_names_)) {
+    if (kept_columns.contains(col_name)) {
+      new_output_names.push_back(col_name);
+      new_output_cols.push_back(output_columns_[col_idx]);
+    }
+  }
+  PX_RETURN_IF_ERROR(SetOutputColumns(new_output_names, new_output_cols));
+  return kept_columns;
+}
+
+Status AsOfJoinIR::ToProto(planpb::Operator* op) const {
+  auto pb = op->mutable_as_of_join_op();
+  op->set_op_type(planpb::AS_OF_JOIN_OPERATOR);
+  pb->set_type(join_type_ == JoinType::kInner ? planpb::JoinOperator_JoinType_INNER
+                                              : planpb::JoinOperator_JoinType_LEFT_OUTER);
+  PX_ASSIGN_OR_RETURN(auto left_time_index, left_time_column_->GetColumnIndex());
+  PX_ASSIGN_OR_RETURN(auto right_time_index, right_time_column_->GetColumnIndex());
+  pb->set_left_time_column_index(left_time_index);
+  pb->set_right_time_column_index(right_time_index);
+
+  DCHECK_EQ(left_by_columns_.size(), right_by_columns_.size());
+  for (const auto& [idx, left_col] : Enumerate(left_by_columns_)) {
+    auto eq_condition = pb->add_equality_conditions();
+    PX_ASSIGN_OR_RETURN(auto left_index, left_col->GetColumnIndex());
+    PX_ASSIGN_OR_RETURN(auto right_index, right_by_columns_[idx]->GetColumnIndex());
+    eq_condition->set_left_column_index(left_index);
+    eq_condition->set_right_column_index(right_index);
+  }
+  pb->set_tolerance_ns(tolerance_ns_);
+
+  for (ColumnIR* col : output_columns_) {
+    auto* parent_col = pb->add_output_columns();
+    DCHECK_LT(col->container_op_parent_idx(), 2);
+    parent_col->set_parent_index(col->container_op_parent_idx());
+    DCHECK(col->IsDataTypeEvaluated()) << "Column not evaluated";
+    PX_ASSIGN_OR_RETURN(auto index, col->GetColumnIndex());
+    parent_col->set_column_index(index);
+  }
+  for (const auto& col_name : column_names_) {
+    *(pb->add_column_names()) = col_name;
+  }
+  return Status::OK();
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
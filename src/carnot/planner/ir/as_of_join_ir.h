@@ -0,0 +1,117 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "src/carnot/planner/compiler_state/compiler_state.h"
+#include "src/carnot/planner/ir/column_ir.h"
+#include "src/carnot/planner/ir/operator_ir.h"
+#include "src/carnot/planner/types/types.h"
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+/**
+ * @brief The AsOfJoinIR joins each row of the left parent with the latest row of the right parent
+ * that has equal `by` keys and a time at or before the left row's time.
+ *
+ * Carnot streams through both inputs in time order, which only holds for the rows of a single
+ * agent, so the splitter runs the join on every PEM when both of its inputs are read there.
+ */
+class AsOfJoinIR : public OperatorIR {
+ public:
+  enum class JoinType { kInner, kLeft };
+
+  AsOfJoinIR() = delete;
+  explicit AsOfJoinIR(int64_t id) : OperatorIR(id, IRNodeType::kAsOfJoin) {}
+
+  bool IsBlocking() const override { return true; }
+
+  Status ToProto(planpb::Operator*) const override;
+
+  /**
+   * @brief AsOfJoinIR init to directly initialize the operator.
+   *
+   * @param parents the left and right parents.
+   * @param how_type 'inner' or 'left'.
+   * @param left_time_col the TIME64NS column that orders the left parent.
+   * @param right_time_col the TIME64NS column that orders the right parent.
+   * @param left_by_cols the keys of the left parent.
+   * @param right_by_cols the keys of the right parent, matched against left_by_cols in order.
+   * @param tolerance_ns how much older than the left row the right row can be, 0 for no limit.
+   * @param suffix_strs the suffixes to add to the left and right columns that share a name.
+   * @return Status
+   */
+  Status Init(const std::vector<OperatorIR*>& parents, const std::string& how_type,
+              ColumnIR* left_time_col, ColumnIR* right_time_col,
+              const std::vector<ColumnIR*>& left_by_cols,
+              const std::vector<ColumnIR*>& right_by_cols, int64_t tolerance_ns,
+              const std::vector<std::string>& suffix_strs);
+  Status CopyFromNodeImpl(const IRNode* node,
+                          absl::flat_hash_map<const IRNode*, IRNode*>* copied_nodes_map) override;
+
+  JoinType join_type() const { return join_type_; }
+  ColumnIR* left_time_column() const { return left_time_column_; }
+  ColumnIR* right_time_column() const { return right_time_column_; }
+  const std::vector<ColumnIR*>& left_by_columns() const { return left_by_columns_; }
+  const std::vector<ColumnIR*>& right_by_columns() const { return right_by_columns_; }
+  int64_t tolerance_ns() const { return tolerance_ns_; }
+  const std::vector<std::string>& suffix_strs() const { return suffix_strs_; }
+  const std::vector<ColumnIR*>& output_columns() const { return output_columns_; }
+  const std::vector<std::string>& column_names() const { return column_names_; }
+
+  StatusOr<std::vector<absl::flat_hash_set<std::string>>> RequiredInputColumns() const override;
+
+  Status ResolveType(CompilerState* compiler_state);
+
+  Status UpdateOpAfterParentTypesResolvedImpl() override;
+
+ protected:
+  StatusOr<absl::flat_hash_set<std::string>> PruneOutputColumnsToImpl(
+      const absl::flat_hash_set<std::string>& kept_columns) override;
+
+ private:
+  StatusOr<JoinType> GetJoinEnum(const std::string& join_type) const;
+  Status SetKeyColumns(ColumnIR* left_time_col, ColumnIR* right_time_col,
+                       const std::vector<ColumnIR*>& left_by_cols,
+                       const std::vector<ColumnIR*>& right_by_cols);
+  Status SetOutputColumns(const std::vector<std::string>& column_names,
+                          const std::vector<ColumnIR*>& columns);
+
+  JoinType join_type_;
+  ColumnIR* left_time_column_ = nullptr;
+  ColumnIR* right_time_column_ = nullptr;
+  std::vector<ColumnIR*> left_by_columns_;
+  std::vector<ColumnIR*> right_by_columns_;
+  int64_t tolerance_ns_ = 0;
+  // The suffixes to add to the left columns and to the right columns.
+  std::vector<std::string> suffix_strs_;
+  // The columns that are output by this join operator, set once the parent types are resolved.
+  std::vector<ColumnIR*> output_columns_;
+  std::vector<std::string> column_names_;
+  bool output_columns_set_ = false;
+};
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
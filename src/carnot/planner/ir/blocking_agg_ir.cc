@@ -138,6 +138,10 @@ Status BlockingAggIR::ToProto(planpb::Operator* op) const {
   pb->set_windowed(false);
   pb->set_partial_agg(partial_agg_);
   pb->set_finalize_results(finalize_results_);
+  if (time_windowed()) {
+    pb->set_time_window_size_ns(time_window_size_ns_);
+    pb->set_time_window_group(time_window_group_);
+  }
 
   op->set_op_type(planpb::AGGREGATE_OPERATOR);
   return Status::OK();
@@ -166,6 +170,8 @@ Status BlockingAggIR::CopyFromNodeImpl(
   finalize_results_ = blocking_agg->finalize_results_;
   partial_agg_ = blocking_agg->partial_agg_;
   pre_split_proto_ = blocking_agg->pre_split_proto_;
+  time_window_size_ns_ = blocking_agg->time_window_size_ns_;
+  time_window_group_ = blocking_agg->time_window_group_;
 
   return Status::OK();
 }
@@ -71,6 +71,17 @@ class BlockingAggIR : public GroupAcceptorIR {
 
   bool partial_agg() const { return partial_agg_; }
   bool finalize_results() const { return finalize_results_; }
+  /**
+   * @brief Makes this an incremental tumbling window aggregate. The group at window_group is the
+   * start of each window, which is emitted once a later window starts.
+   */
+  void SetTimeWindow(int64_t window_size_ns, int64_t window_group) {
+    time_window_size_ns_ = window_size_ns;
+    time_window_group_ = window_group;
+  }
+  bool time_windowed() const { return time_window_size_ns_ > 0; }
+  int64_t time_window_size_ns() const { return time_window_size_ns_; }
+  int64_t time_window_group() const { return time_window_group_; }
   void SetPreSplitProto(const planpb::AggregateOperator& pre_split_proto) {
     pre_split_proto_ = pre_split_proto;
   }
@@ -88,6 +99,9 @@ class BlockingAggIR : public GroupAcceptorIR {
   // Whether this finalizes the result of a partial aggregate.
   bool finalize_results_ = true;
   planpb::AggregateOperator pre_split_proto_;
+  // The size of the tumbling time window and the index of its window start group, if positive.
+  int64_t time_window_size_ns_ = 0;
+  int64_t time_window_group_ = 0;
 };
 }  // namespace planner
 }  // namespace carnot
@@ -53,6 +53,19 @@ class GroupAcceptorIR : public OperatorIR {
     return Status::OK();
   }
 
+  /**
+   * @brief Removes the group from this operator and deletes the column if nothing else uses it.
+   */
+  Status RemoveGroup(ColumnIR* group) {
+    auto it = std::find(groups_.begin(), groups_.end(), group);
+    if (it == groups_.end()) {
+      return error::Internal("$0 is not a group of $1", group->DebugString(), DebugString());
+    }
+    groups_.erase(it);
+    PX_RETURN_IF_ERROR(graph()->DeleteEdge(this, group));
+    return graph()->DeleteOrphansInSubtree(group->id());
+  }
+
  private:
   std::vector<ColumnIR*> groups_;
 };
@@ -511,6 +511,105 @@ TEST_F(ToProtoTest, limit_ir) {
   EXPECT_THAT(pb, EqualsProto(kExpectedLimitPb));
 }
 
+constexpr char kExpectedTopKPb[] = R"(
+  op_type: TOP_K_OPERATOR
+  top_k_op {
+    limit: 12
+    sort_columns {
+      column_index: 2
+      descending: true
+    }
+    sort_columns {
+      column_index: 0
+      descending: false
+    }
+  }
+)";
+
+TEST_F(ToProtoTest, top_k_ir) {
+  auto mem_src = graph
+                     ->CreateNode<MemorySourceIR>(
+                         ast, "source", std::vector<std::string>{"col1", "group1", "column"})
+                     .ValueOrDie();
+  table_store::schema::Relation src_rel({types::INT64, types::INT64, types::INT64},
+                                        {"col1", "group1", "column"});
+  compiler_state_->relation_map()->emplace("source", src_rel);
+
+  auto top_k = graph
+                   ->CreateNode<TopKIR>(
+                       ast, mem_src,
+                       std::vector<SortColumn>{{"column", /*descending*/ true}, {"col1", false}},
+                       12)
+                   .ValueOrDie();
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  planpb::Operator pb;
+  ASSERT_OK(top_k->ToProto(&pb));
+
+  EXPECT_THAT(pb, EqualsProto(kExpectedTopKPb));
+}
+
+constexpr char kExpectedAsOfJoinPb[] = R"(
+  op_type: AS_OF_JOIN_OPERATOR
+  as_of_join_op {
+    type: LEFT_OUTER
+    left_time_column_index: 0
+    right_time_column_index: 1
+    equality_conditions {
+      left_column_index: 1
+      right_column_index: 0
+    }
+    tolerance_ns: 1000
+    output_columns {
+      parent_index: 0
+      column_index: 0
+    }
+    output_columns {
+      parent_index: 0
+      column_index: 1
+    }
+    output_columns {
+      parent_index: 0
+      column_index: 2
+    }
+    output_columns {
+      parent_index: 1
+      column_index: 2
+    }
+    output_columns {
+      parent_index: 1
+      column_index: 3
+    }
+    column_names: "time_"
+    column_names: "upid"
+    column_names: "latency_x"
+    column_names: "latency_y"
+    column_names: "rss"
+  }
+)";
+
+TEST_F(ToProtoTest, as_of_join_ir) {
+  Relation left_rel({types::TIME64NS, types::UINT128, types::INT64}, {"time_", "upid", "latency"});
+  Relation right_rel({types::UINT128, types::TIME64NS, types::INT64, types::INT64},
+                     {"upid", "time_", "latency", "rss"});
+  compiler_state_->relation_map()->emplace("left", left_rel);
+  compiler_state_->relation_map()->emplace("right", right_rel);
+  auto left_src = MakeMemSource("left", left_rel);
+  auto right_src = MakeMemSource("right", right_rel);
+
+  auto join = MakeAsOfJoin({left_src, right_src}, "left", "time_", {"upid"}, 1000);
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  planpb::Operator pb;
+  ASSERT_OK(join->ToProto(&pb));
+
+  EXPECT_THAT(pb, EqualsProto(kExpectedAsOfJoinPb));
+}
+
 constexpr char kInt64PbTxt[] = R"proto(
 constant {
   data_type: INT64
@@ -892,13 +991,14 @@ TEST_F(CloneTests, all_op_clone) {
   auto eq_map = MakeMap(mem_source, {{{"equals_column", equals_fn}}});
   auto filter = MakeFilter(eq_map, MakeColumn("equals_column", 0));
   auto limit = MakeLimit(filter, 10);
+  auto top_k = MakeTopK(limit, {{"equals_column", /*descending*/ true}}, 5);
 
   auto mean_func = MakeMeanFunc(MakeColumn("equals_column", 0));
   auto property2 = std::make_unique<NameMetadataProperty>(
       MetadataType::SERVICE_NAME, std::vector<MetadataType>({MetadataType::UPID}));
   auto metadata2 = MakeMetadataIR("service", 0);
   metadata2->set_property(property2.get());
-  auto agg = MakeBlockingAgg(limit, {metadata2}, {{{"mean", mean_func}}, {}});
+  auto agg = MakeBlockingAgg(top_k, {metadata2}, {{{"mean", mean_func}}, {}});
   auto add_func = MakeAddFunc(MakeColumn("mean", 0), MakeInt(3));
   auto map = MakeMap(agg, {{{"mean_deux", add_func}, {"mean", MakeColumn("mean", 0)}}, {}});
   MakeMemSink(map, "sup");
@@ -1028,6 +1128,29 @@ TEST_F(CloneTests, join_clone) {
   CompareClone(join_clone, join_op, "");
 }
 
+TEST_F(CloneTests, as_of_join_clone) {
+  Relation left_rel({types::TIME64NS, types::UINT128, types::INT64}, {"time_", "upid", "latency"});
+  Relation right_rel({types::TIME64NS, types::UINT128, types::INT64}, {"time_", "upid", "rss"});
+  compiler_state_->relation_map()->emplace("left", left_rel);
+  compiler_state_->relation_map()->emplace("right", right_rel);
+  auto left_src = MakeMemSource("left", left_rel);
+  auto right_src = MakeMemSource("right", right_rel);
+
+  auto join_op = MakeAsOfJoin({left_src, right_src}, "inner", "time_", {"upid"}, 1000);
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<IR> cloned_ir, graph->Clone());
+
+  IRNode* maybe_join_clone = cloned_ir->Get(join_op->id());
+  ASSERT_MATCH(maybe_join_clone, AsOfJoin());
+  AsOfJoinIR* join_clone = static_cast<AsOfJoinIR*>(maybe_join_clone);
+  EXPECT_THAT(join_clone->column_names(), ElementsAre("time_", "upid", "latency", "rss"));
+
+  CompareClone(join_clone, join_op, "");
+}
+
 TEST_F(CloneTests, union_clone) {
   compiler_state_->relation_map()->emplace("table", MakeRelation());
   auto mem_src1 = MakeMemSource(MakeRelation());
@@ -52,6 +52,8 @@ Status JoinIR::CopyFromNodeImpl(const IRNode* node,
 
   PX_RETURN_IF_ERROR(SetJoinColumns(new_left_columns, new_right_columns));
   suffix_strs_ = join_node->suffix_strs_;
+  specified_as_right_ = join_node->specified_as_right_;
+  build_side_swapped_ = join_node->build_side_swapped_;
   return Status::OK();
 }
 
@@ -288,7 +290,7 @@ Status JoinIR::UpdateOpAfterParentTypesResolvedImpl() {
 
   int64_t left_idx = 0;
   int64_t right_idx = 1;
-  if (specified_as_right()) {
+  if (parents_reversed()) {
     left_idx = 1;
     right_idx = 0;
   }
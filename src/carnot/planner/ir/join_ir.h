@@ -89,6 +89,13 @@ class JoinIR : public OperatorIR {
   Status SetOutputColumns(const std::vector<std::string>& column_names,
                           const std::vector<ColumnIR*>& columns);
   bool specified_as_right() const { return specified_as_right_; }
+  /**
+   * @brief Marks the parents as swapped for the build side of the join, on top of any swap from
+   * converting a right join. Only valid for joins whose result doesn't depend on parent order.
+   */
+  void ToggleBuildSideSwapped() { build_side_swapped_ = !build_side_swapped_; }
+  // Whether the parents are in the reverse of the order they were written in.
+  bool parents_reversed() const { return specified_as_right_ != build_side_swapped_; }
 
   StatusOr<std::vector<absl::flat_hash_set<std::string>>> RequiredInputColumns() const override;
 
@@ -96,7 +103,7 @@ class JoinIR : public OperatorIR {
       const {
     auto left_idx = 0;
     auto right_idx = 1;
-    if (specified_as_right()) {
+    if (parents_reversed()) {
       left_idx = 1;
       right_idx = 0;
     }
@@ -108,7 +115,7 @@ class JoinIR : public OperatorIR {
   const std::tuple<std::string, std::string> left_right_suffixs() const {
     auto left_idx = 0;
     auto right_idx = 1;
-    if (specified_as_right()) {
+    if (parents_reversed()) {
       left_idx = 1;
       right_idx = 0;
     }
@@ -161,6 +168,8 @@ class JoinIR : public OperatorIR {
   // Whether this join was originally specified as a right join.
   // Used because we transform left joins into right joins but need to do some back transform.
   bool specified_as_right_ = false;
+  // Whether the planner swapped the parents so that the smaller input is the build side.
+  bool build_side_swapped_ = false;
 };
 
 }  // namespace planner
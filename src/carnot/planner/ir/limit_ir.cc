@@ -68,6 +68,7 @@ Status LimitIR::CopyFromNodeImpl(const IRNode* node, absl::flat_hash_map<const I
   limit_value_ = limit->limit_value_;
   limit_value_set_ = limit->limit_value_set_;
   pem_only_ = limit->pem_only_;
+  tail_ = limit->tail_;
   return Status::OK();
 }
 
@@ -48,6 +48,9 @@ class LimitIR : public OperatorIR {
   bool limit_value_set() const { return limit_value_set_; }
   int64_t limit_value() const { return limit_value_; }
   bool pem_only() const { return pem_only_; }
+  // Whether the Limit keeps the last rows of its input (df.tail()) rather than the first.
+  bool tail() const { return tail_; }
+  void set_tail(bool tail) { tail_ = tail; }
 
   void AddAbortableSource(int64_t src_id) { abortable_srcs_.insert(src_id); }
 
@@ -71,6 +74,7 @@ class LimitIR : public OperatorIR {
   int64_t limit_value_;
   bool limit_value_set_ = false;
   bool pem_only_ = false;
+  bool tail_ = false;
   std::unordered_set<int64_t> abortable_srcs_;
 };
 
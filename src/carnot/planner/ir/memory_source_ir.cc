@@ -24,8 +24,8 @@ namespace carnot {
 namespace planner {
 
 std::string MemorySourceIR::DebugString() const {
-  return absl::Substitute("$0(id=$1, table=$2, streaming=$3)", type_string(), id(), table_name_,
-                          streaming_);
+  return absl::Substitute("$0(id=$1, table=$2, streaming=$3, predicates=$4)", type_string(), id(),
+                          table_name_, streaming_, predicates_.size());
 }
 
 Status MemorySourceIR::ToProto(planpb::Operator* op) const {
@@ -64,6 +64,13 @@ Status MemorySourceIR::ToProto(planpb::Operator* op) const {
   }
 
   pb->set_streaming(streaming());
+  pb->set_reverse(reverse());
+  if (sampled()) {
+    pb->set_sample_rate(sample_rate_);
+  }
+  for (const auto& predicate : predicates_) {
+    *pb->add_predicates() = predicate;
+  }
   return Status::OK();
 }
 
@@ -106,6 +113,9 @@ Status MemorySourceIR::CopyFromNodeImpl(const IRNode* node,
   column_index_map_set_ = source_ir->column_index_map_set_;
   column_index_map_ = source_ir->column_index_map_;
   streaming_ = source_ir->streaming_;
+  reverse_ = source_ir->reverse_;
+  sample_rate_ = source_ir->sample_rate_;
+  predicates_ = source_ir->predicates_;
 
   return Status::OK();
 }
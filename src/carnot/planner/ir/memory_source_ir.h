@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "src/carnot/planner/compiler_state/compiler_state.h"
@@ -61,6 +62,15 @@ class MemorySourceIR : public OperatorIR {
   bool streaming() const { return streaming_; }
   void set_streaming(bool streaming) { streaming_ = streaming; }
 
+  // Whether the MemorySource reads its table newest row first.
+  bool reverse() const { return reverse_; }
+  void set_reverse(bool reverse) { reverse_ = reverse; }
+
+  // The fraction of the table's rows the MemorySource reads, for approximate queries.
+  double sample_rate() const { return sample_rate_; }
+  bool sampled() const { return sample_rate_ < 1.0; }
+  void set_sample_rate(double sample_rate) { sample_rate_ = sample_rate; }
+
   void SetTimeStartNS(int64_t time_start_ns) { time_start_ns_ = time_start_ns; }
   void SetTimeStopNS(int64_t time_stop_ns) { time_stop_ns_ = time_stop_ns; }
   bool IsTimeStartSet() const { return time_start_ns_.has_value(); }
@@ -102,6 +112,12 @@ class MemorySourceIR : public OperatorIR {
 
   void SetColumnNames(const std::vector<std::string>& col_names) { column_names_ = col_names; }
 
+  // Predicates on the table's columns that the source applies before producing row batches.
+  const std::vector<planpb::ColumnPredicate>& predicates() const { return predicates_; }
+  void AddPredicate(planpb::ColumnPredicate predicate) {
+    predicates_.push_back(std::move(predicate));
+  }
+
   bool IsSource() const override { return true; }
 
   Status ResolveType(CompilerState* compiler_state);
@@ -113,6 +129,8 @@ class MemorySourceIR : public OperatorIR {
  private:
   std::string table_name_;
   bool streaming_ = false;
+  bool reverse_ = false;
+  double sample_rate_ = 1.0;
 
   std::optional<int64_t> time_start_ns_;
   std::optional<int64_t> time_stop_ns_;
@@ -126,6 +144,8 @@ class MemorySourceIR : public OperatorIR {
 
   types::TabletID tablet_value_;
   bool has_tablet_value_ = false;
+
+  std::vector<planpb::ColumnPredicate> predicates_;
 };
 
 }  // namespace planner
@@ -37,5 +37,8 @@ PX_CARNOT_IR_NODE(Rolling)
 PX_CARNOT_IR_NODE(Stream)
 PX_CARNOT_IR_NODE(EmptySource)
 PX_CARNOT_IR_NODE(OTelExportSink)
+PX_CARNOT_IR_NODE(Sort)
+PX_CARNOT_IR_NODE(TopK)
+PX_CARNOT_IR_NODE(AsOfJoin)
 
 #endif
@@ -79,6 +79,7 @@ StatusOr<std::vector<absl::flat_hash_set<std::string>>> OTelExportSinkIR::Requir
 
 Status OTelExportSinkIR::ProcessConfig(const OTelData& data) {
   data_.endpoint_config = data.endpoint_config;
+  data_.export_state_key = data.export_state_key;
   for (const auto& attr : data.resource_attributes) {
     if (attr.column_reference == nullptr) {
       data_.resource_attributes.push_back({attr.name, nullptr, attr.string_value});
@@ -124,6 +125,11 @@ Status OTelExportSinkIR::ProcessConfig(const OTelData& data) {
               new_metric.metric = std::move(new_summary);
               return Status::OK();
             },
+            [&new_metric, this](const OTelMetricSum& sum) {
+              PX_ASSIGN_OR_RETURN(auto val, AddColumn(sum.value_column));
+              new_metric.metric = OTelMetricSum{val};
+              return Status::OK();
+            },
         },
         metric.metric));
 
@@ -167,6 +173,7 @@ Status OTelExportSinkIR::ToProto(planpb::Operator* op) const {
   op->set_op_type(planpb::OTEL_EXPORT_SINK_OPERATOR);
   auto otel_op = op->mutable_otel_sink_op();
   *otel_op->mutable_endpoint_config() = data_.endpoint_config;
+  otel_op->set_export_state_key(data_.export_state_key);
   auto resource = otel_op->mutable_resource();
   for (const auto& otel_attribute : data_.resource_attributes) {
     PX_RETURN_IF_ERROR(otel_attribute.ToProto(resource->add_attributes()));
@@ -249,6 +256,24 @@ Status OTelExportSinkIR::ToProto(planpb::Operator* op) const {
               }
               return Status::OK();
             },
+            [&metric_pb](const OTelMetricSum& sum) {
+              auto sum_pb = metric_pb->mutable_sum();
+              PX_ASSIGN_OR_RETURN(auto sum_index, sum.value_column->GetColumnIndex());
+              switch (sum.value_column->EvaluatedDataType()) {
+                case types::INT64:
+                  sum_pb->set_int_column_index(sum_index);
+                  break;
+                case types::FLOAT64:
+                  sum_pb->set_float_column_index(sum_index);
+                  break;
+                default:
+                  return sum.value_column->CreateIRNodeError(
+                      "Expected value column '$0' to be INT64 or FLOAT64, received $1",
+                      sum.value_column->col_name(),
+                      types::ToString(sum.value_column->EvaluatedDataType()));
+              }
+              return Status::OK();
+            },
         },
         metric.metric));
   }
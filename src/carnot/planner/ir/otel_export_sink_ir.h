@@ -86,6 +86,10 @@ struct OTelMetricGauge {
   ColumnIR* value_column;
 };
 
+struct OTelMetricSum {
+  ColumnIR* value_column;
+};
+
 struct OTelMetricSummary {
   struct QuantileValues {
     double quantile;
@@ -110,7 +114,7 @@ struct OTelMetric {
 
   std::vector<OTelAttribute> attributes;
 
-  std::variant<OTelMetricGauge, OTelMetricSummary> metric;
+  std::variant<OTelMetricGauge, OTelMetricSummary, OTelMetricSum> metric;
 };
 
 struct OTelSpan {
@@ -132,6 +136,8 @@ struct OTelData {
   std::vector<OTelAttribute> resource_attributes;
   std::vector<OTelMetric> metrics;
   std::vector<OTelSpan> spans;
+  // The key under which the running totals of the Sum metrics are kept between runs.
+  std::string export_state_key;
 };
 
 /**
@@ -164,6 +164,11 @@ inline ClassMatch<IRNodeType::kEmptySource> EmptySource() {
   return ClassMatch<IRNodeType::kEmptySource>();
 }
 inline ClassMatch<IRNodeType::kLimit> Limit() { return ClassMatch<IRNodeType::kLimit>(); }
+inline ClassMatch<IRNodeType::kSort> Sort() { return ClassMatch<IRNodeType::kSort>(); }
+inline ClassMatch<IRNodeType::kTopK> TopK() { return ClassMatch<IRNodeType::kTopK>(); }
+inline ClassMatch<IRNodeType::kAsOfJoin> AsOfJoin() {
+  return ClassMatch<IRNodeType::kAsOfJoin>();
+}
 
 inline ClassMatch<IRNodeType::kGRPCSource> GRPCSource() {
   return ClassMatch<IRNodeType::kGRPCSource>();
@@ -1027,6 +1032,14 @@ inline JoinMatch<JoinIR::JoinType::kRight> RightJoin() {
   return JoinMatch<JoinIR::JoinType::kRight>();
 }
 
+inline JoinMatch<JoinIR::JoinType::kInner> InnerJoin() {
+  return JoinMatch<JoinIR::JoinType::kInner>();
+}
+
+inline JoinMatch<JoinIR::JoinType::kOuter> OuterJoin() {
+  return JoinMatch<JoinIR::JoinType::kOuter>();
+}
+
 template <typename OpType, typename ParentType>
 struct ParentOfOpMatcher : public ParentMatch {
   explicit ParentOfOpMatcher(OpType op_matcher, ParentType parent_matcher)
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "src/carnot/planner/compiler_state/compiler_state.h"
+#include "src/carnot/planner/ir/operator_ir.h"
+#include "src/carnot/planner/types/types.h"
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+/**
+ * @brief A column that rows are sorted by, and in which direction.
+ */
+struct SortColumn {
+  std::string col_name;
+  // Whether larger values come first.
+  bool descending;
+};
+
+/**
+ * @brief The SortIR orders its input by the sort columns, compared on the first column, then the
+ * second one on ties, etc.
+ *
+ * Carnot has no operator that sorts a whole table, so the analyzer merges a Sort with the Limit
+ * that follows it into a TopK, and rejects a Sort that isn't followed by a Limit.
+ */
+class SortIR : public OperatorIR {
+ public:
+  SortIR() = delete;
+  explicit SortIR(int64_t id) : OperatorIR(id, IRNodeType::kSort) {}
+  Status Init(OperatorIR* parent, const std::vector<SortColumn>& sort_columns);
+
+  Status ToProto(planpb::Operator*) const override;
+
+  const std::vector<SortColumn>& sort_columns() const { return sort_columns_; }
+
+  Status CopyFromNodeImpl(const IRNode* node,
+                          absl::flat_hash_map<const IRNode*, IRNode*>* copied_nodes_map) override;
+
+  StatusOr<std::vector<absl::flat_hash_set<std::string>>> RequiredInputColumns() const override {
+    return error::Unimplemented("Unexpected call to SortIR::RequiredInputColumns");
+  }
+
+ protected:
+  StatusOr<absl::flat_hash_set<std::string>> PruneOutputColumnsToImpl(
+      const absl::flat_hash_set<std::string>& /*kept_columns*/) override {
+    return error::Unimplemented("Unexpected call to SortIR::PruneOutputColumnsTo.");
+  }
+
+ private:
+  std::vector<SortColumn> sort_columns_;
+};
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
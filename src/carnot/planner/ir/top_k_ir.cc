@@ -0,0 +1,86 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/ir/top_k_ir.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+Status TopKIR::Init(OperatorIR* parent, const std::vector<SortColumn>& sort_columns,
+                    int64_t limit) {
+  PX_RETURN_IF_ERROR(AddParent(parent));
+  sort_columns_ = sort_columns;
+  limit_ = limit;
+  return Status::OK();
+}
+
+StatusOr<std::vector<absl::flat_hash_set<std::string>>> TopKIR::RequiredInputColumns() const {
+  DCHECK(is_type_resolved());
+  return std::vector<absl::flat_hash_set<std::string>>{
+      {resolved_table_type()->ColumnNames().begin(), resolved_table_type()->ColumnNames().end()}};
+}
+
+StatusOr<absl::flat_hash_set<std::string>> TopKIR::PruneOutputColumnsToImpl(
+    const absl::flat_hash_set<std::string>& /*output_cols*/) {
+  DCHECK(is_type_resolved());
+  return absl::flat_hash_set<std::string>{resolved_table_type()->ColumnNames().begin(),
+                                          resolved_table_type()->ColumnNames().end()};
+}
+
+Status TopKIR::ResolveType(CompilerState* /* compiler_state */) {
+  DCHECK_EQ(1U, parent_types().size());
+  auto parent_table_type = std::static_pointer_cast<TableType>(parent_types()[0]);
+  for (const auto& sort_col : sort_columns_) {
+    if (!parent_table_type->HasColumn(sort_col.col_name)) {
+      return CreateIRNodeError("Column '$0' not found in parent dataframe", sort_col.col_name);
+    }
+  }
+  PX_ASSIGN_OR_RETURN(auto type_ptr, OperatorIR::DefaultResolveType(parent_types()));
+  return SetResolvedType(type_ptr);
+}
+
+Status TopKIR::ToProto(planpb::Operator* op) const {
+  auto pb = op->mutable_top_k_op();
+  op->set_op_type(planpb::TOP_K_OPERATOR);
+  DCHECK_EQ(parents().size(), 1UL);
+  DCHECK(parents()[0]->is_type_resolved());
+  auto parent_table_type = parents()[0]->resolved_table_type();
+
+  pb->set_limit(limit_);
+  for (const auto& sort_col : sort_columns_) {
+    if (!parent_table_type->HasColumn(sort_col.col_name)) {
+      return CreateIRNodeError("Column '$0' not found in parent dataframe", sort_col.col_name);
+    }
+    auto sort_col_pb = pb->add_sort_columns();
+    sort_col_pb->set_column_index(parent_table_type->GetColumnIndex(sort_col.col_name));
+    sort_col_pb->set_descending(sort_col.descending);
+  }
+  return Status::OK();
+}
+
+Status TopKIR::CopyFromNodeImpl(const IRNode* node, absl::flat_hash_map<const IRNode*, IRNode*>*) {
+  const TopKIR* top_k = static_cast<const TopKIR*>(node);
+  sort_columns_ = top_k->sort_columns_;
+  limit_ = top_k->limit_;
+  return Status::OK();
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -42,6 +42,7 @@ StatusOr<std::unique_ptr<RelationMap>> MakeRelationMapFromSchema(const Schema& s
 
   return rel_map;
 }
+
 StatusOr<std::unique_ptr<RelationMap>> MakeRelationMapFromDistributedState(
     const distributedpb::DistributedState& state_pb) {
   auto rel_map = std::make_unique<RelationMap>();
@@ -54,6 +55,18 @@ StatusOr<std::unique_ptr<RelationMap>> MakeRelationMapFromDistributedState(
   return rel_map;
 }
 
+TableStatsMap MakeTableStatsMapFromDistributedState(
+    const distributedpb::DistributedState& state_pb) {
+  TableStatsMap table_stats;
+  for (const auto& schema_info : state_pb.schema_info()) {
+    if (!schema_info.has_stats()) {
+      continue;
+    }
+    table_stats[schema_info.name()] = {schema_info.stats().num_rows(), schema_info.stats().bytes()};
+  }
+  return table_stats;
+}
+
 static inline RedactionOptions RedactionOptionsFromPb(
     const distributedpb::RedactionOptions& redaction_options) {
   RedactionOptions options;
@@ -65,6 +78,13 @@ static inline RedactionOptions RedactionOptionsFromPb(
 StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
     const distributedpb::LogicalPlannerState& logical_state, RegistryInfo* registry_info,
     int64_t max_output_rows_per_table) {
+  return CreateCompilerState(logical_state, registry_info, max_output_rows_per_table,
+                             px::CurrentTimeNS());
+}
+
+StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
+    const distributedpb::LogicalPlannerState& logical_state, RegistryInfo* registry_info,
+    int64_t max_output_rows_per_table, types::Time64NSValue time_now) {
   PX_ASSIGN_OR_RETURN(std::unique_ptr<RelationMap> rel_map,
                       MakeRelationMapFromDistributedState(logical_state.distributed_state()));
 
@@ -98,14 +118,17 @@ StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
     debug_info.otel_debug_attrs.push_back({debug_info_pb.name(), debug_info_pb.value()});
   }
   // Create a CompilerState obj using the relation map and grabbing the current time.
-  return std::make_unique<planner::CompilerState>(
-      std::move(rel_map), sensitive_columns, registry_info, px::CurrentTimeNS(),
+  auto compiler_state = std::make_unique<planner::CompilerState>(
+      std::move(rel_map), sensitive_columns, registry_info, time_now,
       max_output_rows_per_table, logical_state.result_address(),
       logical_state.result_ssl_targetname(),
       // TODO(philkuz) add an endpoint config to logical_state and pass that in here.
       RedactionOptionsFromPb(logical_state.redaction_options()), std::move(otel_endpoint_config),
       // TODO(philkuz) propagate the otel debug attributes here.
       std::move(plugin_config), debug_info);
+  compiler_state->set_table_stats(
+      MakeTableStatsMapFromDistributedState(logical_state.distributed_state()));
+  return compiler_state;
 }
 
 StatusOr<std::unique_ptr<LogicalPlanner>> LogicalPlanner::Create(const udfspb::UDFInfo& udf_info) {
@@ -125,13 +148,52 @@ Status LogicalPlanner::Init(const udfspb::UDFInfo& udf_info) {
 
 StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::Plan(
     const plannerpb::QueryRequest& query_request) {
+  bool time_dependent = false;
+  return Plan(query_request, px::CurrentTimeNS(), &time_dependent);
+}
+
+StatusOr<distributedpb::DistributedPlan> LogicalPlanner::PlanProto(
+    const plannerpb::QueryRequest& query_request) {
+  int64_t time_now = px::CurrentTimeNS();
+  auto key = PlanCache::Key(query_request);
+  auto cached_plan = plan_cache_.Get(key, time_now);
+  if (cached_plan.has_value()) {
+    return std::move(cached_plan.value());
+  }
+
+  bool time_dependent = false;
+  PX_ASSIGN_OR_RETURN(auto plan_pb, PlanToProto(query_request, time_now, &time_dependent));
+  if (!time_dependent) {
+    plan_cache_.Insert(key, plan_pb, time_now, nullptr);
+    return plan_pb;
+  }
+  // Plan the query again with the clock moved, to find the fields that depend on it.
+  auto probe_plan_pb_or_s =
+      PlanToProto(query_request, time_now + PlanCache::kProbeOffsetNS, &time_dependent);
+  if (probe_plan_pb_or_s.ok()) {
+    plan_cache_.Insert(key, plan_pb, time_now, &probe_plan_pb_or_s.ValueOrDie());
+  }
+  return plan_pb;
+}
+
+StatusOr<distributedpb::DistributedPlan> LogicalPlanner::PlanToProto(
+    const plannerpb::QueryRequest& query_request, types::Time64NSValue time_now,
+    bool* time_dependent) {
+  PX_ASSIGN_OR_RETURN(auto distributed_plan, Plan(query_request, time_now, time_dependent));
+  distributed_plan->SetPlanOptions(query_request.logical_planner_state().plan_options());
+  return distributed_plan->ToProto();
+}
+
+StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::Plan(
+    const plannerpb::QueryRequest& query_request, types::Time64NSValue time_now,
+    bool* time_dependent) {
   // Compile into the IR.
 
   auto ms = query_request.logical_planner_state().plan_options().max_output_rows_per_table();
   VLOG(1) << "Max output rows: " << ms;
-  PX_ASSIGN_OR_RETURN(
-      std::unique_ptr<CompilerState> compiler_state,
-      CreateCompilerState(query_request.logical_planner_state(), registry_info_.get(), ms));
+  PX_ASSIGN_OR_RETURN(std::unique_ptr<CompilerState> compiler_state,
+                      CreateCompilerState(query_request.logical_planner_state(),
+                                          registry_info_.get(), ms, time_now));
 
   std::vector<plannerpb::FuncToExecute> exec_funcs(query_request.exec_funcs().begin(),
                                                    query_request.exec_funcs().end());
@@ -146,6 +208,7 @@ StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::Plan(
   distributed_plan->SetExecutionCompleteAddress(
       query_request.logical_planner_state().result_address(),
       query_request.logical_planner_state().result_ssl_targetname());
+  *time_dependent = compiler_state->time_now_read();
   return distributed_plan;
 }
 
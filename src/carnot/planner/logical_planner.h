@@ -25,6 +25,7 @@
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/distributed/distributed_plan/distributed_plan.h"
 #include "src/carnot/planner/distributed/distributed_planner.h"
+#include "src/carnot/planner/plan_cache.h"
 #include "src/carnot/planner/plannerpb/service.pb.h"
 #include "src/carnot/planner/probes/probes.h"
 #include "src/shared/scriptspb/scripts.pb.h"
@@ -33,6 +34,9 @@ namespace px {
 namespace carnot {
 namespace planner {
 
+// The number of distributed plans a logical planner caches.
+constexpr size_t kDefaultPlanCacheSize = 64;
+
 /**
  * @brief The logical planner takes in queries and a Logical Planner State and
  *
@@ -57,6 +61,15 @@ class LogicalPlanner : public NotCopyable {
   StatusOr<std::unique_ptr<distributed::DistributedPlan>> Plan(
       const plannerpb::QueryRequest& query);
 
+  /**
+   * @brief Plans the query like Plan() and returns the distributed plan proto, with the plan
+   * options of the query set. Plans of repeated queries come from the plan cache.
+   *
+   * @param query: QueryRequest
+   * @return distributedpb::DistributedPlan or error if one occurs during compilation.
+   */
+  StatusOr<distributedpb::DistributedPlan> PlanProto(const plannerpb::QueryRequest& query);
+
   StatusOr<std::unique_ptr<compiler::MutationsIR>> CompileTrace(
       const plannerpb::CompileMutationsRequest& mutations_req);
 
@@ -70,14 +83,24 @@ class LogicalPlanner : public NotCopyable {
   LogicalPlanner() {}
 
  private:
+  StatusOr<std::unique_ptr<distributed::DistributedPlan>> Plan(
+      const plannerpb::QueryRequest& query, types::Time64NSValue time_now, bool* time_dependent);
+  StatusOr<distributedpb::DistributedPlan> PlanToProto(const plannerpb::QueryRequest& query,
+                                                       types::Time64NSValue time_now,
+                                                       bool* time_dependent);
+
   compiler::Compiler compiler_;
   std::unique_ptr<distributed::Planner> distributed_planner_;
   std::unique_ptr<planner::RegistryInfo> registry_info_;
+  PlanCache plan_cache_{kDefaultPlanCacheSize};
 };
 
 StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
     const distributedpb::LogicalPlannerState& logical_state, RegistryInfo* registry_info,
     int64_t max_output_rows_per_table);
+StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
+    const distributedpb::LogicalPlannerState& logical_state, RegistryInfo* registry_info,
+    int64_t max_output_rows_per_table, types::Time64NSValue time_now);
 
 }  // namespace planner
 }  // namespace carnot
@@ -43,7 +43,41 @@ void BM_Query(benchmark::State& state) {
   }
 }
 
+// Plans the query to a proto without the plan cache, which is what a cold PlanProto() call costs.
+// NOLINTNEXTLINE : runtime/references.
+void BM_QueryProtoCold(benchmark::State& state) {
+  auto info = udfexporter::ExportUDFInfo().ConsumeValueOrDie()->info_pb();
+  auto planner = LogicalPlanner::Create(info).ConsumeValueOrDie();
+  plannerpb::QueryRequest query_request;
+  query_request.set_query_str(testutils::kHttpRequestStats);
+  *query_request.mutable_logical_planner_state() =
+      testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema);
+  for (auto _ : state) {
+    auto plan_or_s = planner->Plan(query_request);
+    EXPECT_OK(plan_or_s);
+    auto plan_pb_or_s = plan_or_s.ConsumeValueOrDie()->ToProto();
+    EXPECT_OK(plan_pb_or_s);
+  }
+}
+
+// NOLINTNEXTLINE : runtime/references.
+void BM_QueryProtoWarm(benchmark::State& state) {
+  auto info = udfexporter::ExportUDFInfo().ConsumeValueOrDie()->info_pb();
+  auto planner = LogicalPlanner::Create(info).ConsumeValueOrDie();
+  plannerpb::QueryRequest query_request;
+  query_request.set_query_str(testutils::kHttpRequestStats);
+  *query_request.mutable_logical_planner_state() =
+      testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema);
+  EXPECT_OK(planner->PlanProto(query_request));
+  for (auto _ : state) {
+    auto plan_pb_or_s = planner->PlanProto(query_request);
+    EXPECT_OK(plan_pb_or_s);
+  }
+}
+
 BENCHMARK(BM_Query);
+BENCHMARK(BM_QueryProtoCold);
+BENCHMARK(BM_QueryProtoWarm);
 
 }  // namespace logical_planner
 }  // namespace planner
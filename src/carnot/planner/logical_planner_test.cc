@@ -108,6 +108,36 @@ TEST_F(LogicalPlannerTest, distributed_plan_test_basic_queries) {
   EXPECT_EQ(pem1_plan->second.execution_status_destinations()[0].ssl_targetname(), "kelvin.pl.svc");
 }
 
+TEST_F(LogicalPlannerTest, plan_proto_uses_cache) {
+  auto planner = LogicalPlanner::Create(info_).ConsumeValueOrDie();
+  auto ps = testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema);
+  auto query_request = MakeQueryRequest(ps, "import px\npx.display(px.DataFrame('http_events'))");
+  ASSERT_OK_AND_ASSIGN(auto plan, planner->Plan(query_request));
+  ASSERT_OK_AND_ASSIGN(auto expected_pb, plan->ToProto());
+
+  ASSERT_OK_AND_ASSIGN(auto cold_pb, planner->PlanProto(query_request));
+  EXPECT_THAT(cold_pb, EqualsProto(expected_pb.DebugString()));
+  ASSERT_OK_AND_ASSIGN(auto warm_pb, planner->PlanProto(query_request));
+  EXPECT_THAT(warm_pb, EqualsProto(expected_pb.DebugString()));
+
+  // Relative time ranges are planned again relative to the time of the request.
+  query_request.set_query_str(testutils::kHttpRequestStats);
+  ASSERT_OK_AND_ASSIGN(cold_pb, planner->PlanProto(query_request));
+  ASSERT_OK_AND_ASSIGN(warm_pb, planner->PlanProto(query_request));
+  auto start_time = [](const distributedpb::DistributedPlan& plan_pb) {
+    for (const auto& fragment : plan_pb.qb_address_to_plan().at("pem1").nodes()) {
+      for (const auto& node : fragment.nodes()) {
+        if (node.op().has_mem_source_op()) {
+          return node.op().mem_source_op().start_time().value();
+        }
+      }
+    }
+    return int64_t{0};
+  };
+  EXPECT_GT(start_time(cold_pb), 0);
+  EXPECT_GE(start_time(warm_pb), start_time(cold_pb));
+}
+
 constexpr char kSimpleQueryDefaultLimit[] = R"pxl(
 import px
 t1 = px.DataFrame(table='http_events', start_time='-120s', select=['time_'])
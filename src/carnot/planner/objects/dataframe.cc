@@ -124,6 +124,14 @@ StatusOr<QLObjectPtr> DataFrameConstructor(CompilerState* compiler_state, IR* gr
                         ParseAllTimeFormats(compiler_state->time_now().val, end_time));
     mem_source_op->SetTimeStopNS(end_time_ns);
   }
+  if (!NoneObject::IsNoneObject(args.GetArg("sample"))) {
+    PX_ASSIGN_OR_RETURN(FloatIR * sample, GetArgAs<FloatIR>(ast, args, "sample"));
+    if (sample->val() <= 0 || sample->val() > 1) {
+      return sample->CreateIRNodeError("sample must be greater than 0 and at most 1, received $0",
+                                       sample->val());
+    }
+    mem_source_op->set_sample_rate(sample->val());
+  }
   return Dataframe::Create(compiler_state, mem_source_op, visitor);
 }
 
@@ -177,6 +185,48 @@ StatusOr<QLObjectPtr> JoinHandler(CompilerState* compiler_state, IR* graph, Oper
   return Dataframe::Create(compiler_state, join_op, visitor);
 }
 
+// Handles the merge_asof() operator logic.
+StatusOr<QLObjectPtr> AsOfJoinHandler(CompilerState* compiler_state, IR* graph, OperatorIR* op,
+                                      const pypa::AstPtr& ast, const ParsedArgs& args,
+                                      ASTVisitor* visitor) {
+  PX_ASSIGN_OR_RETURN(OperatorIR * right, GetOperator(args.GetArg("right")));
+  PX_ASSIGN_OR_RETURN(StringIR * how, GetArgAs<StringIR>(ast, args, "how"));
+  PX_ASSIGN_OR_RETURN(StringIR * on, GetArgAs<StringIR>(ast, args, "on"));
+  PX_ASSIGN_OR_RETURN(ExpressionIR * tolerance_node,
+                      GetArgAs<ExpressionIR>(ast, args, "tolerance"));
+  // Set time_now to 0 because the tolerance is a duration.
+  PX_ASSIGN_OR_RETURN(int64_t tolerance_ns, ParseAllTimeFormats(/* time_now */ 0, tolerance_node));
+
+  PX_ASSIGN_OR_RETURN(ColumnIR * left_time_col,
+                      graph->CreateNode<ColumnIR>(ast, on->str(), /* parent_idx */ 0));
+  PX_ASSIGN_OR_RETURN(ColumnIR * right_time_col,
+                      graph->CreateNode<ColumnIR>(ast, on->str(), /* parent_idx */ 1));
+  PX_ASSIGN_OR_RETURN(std::vector<ColumnIR*> left_by_cols,
+                      ProcessCols(graph, ast, args.GetArg("by"), "by", 0));
+  PX_ASSIGN_OR_RETURN(std::vector<ColumnIR*> right_by_cols,
+                      ProcessCols(graph, ast, args.GetArg("by"), "by", 1));
+
+  QLObjectPtr suffixes_node = args.GetArg("suffixes");
+  if (!CollectionObject::IsCollection(suffixes_node)) {
+    return suffixes_node->CreateError(
+        "'suffixes' must be a list with 2 strings for the left and right suffixes. Received $0",
+        suffixes_node->name());
+  }
+  PX_ASSIGN_OR_RETURN(std::vector<std::string> suffix_strs,
+                      ParseAsListOfStrings(suffixes_node, "suffixes"));
+  if (suffix_strs.size() != 2) {
+    return suffixes_node->CreateError("'suffixes' must be a list with 2 elements. Received $0",
+                                      suffix_strs.size());
+  }
+
+  PX_ASSIGN_OR_RETURN(
+      AsOfJoinIR * join_op,
+      graph->CreateNode<AsOfJoinIR>(ast, std::vector<OperatorIR*>{op, right}, how->str(),
+                                    left_time_col, right_time_col, left_by_cols, right_by_cols,
+                                    tolerance_ns, suffix_strs));
+  return Dataframe::Create(compiler_state, join_op, visitor);
+}
+
 StatusOr<FuncIR*> ParseNameTuple(IR* ir, const pypa::AstPtr& ast,
                                  std::shared_ptr<TupleObject> tuple) {
   DCHECK_GE(tuple->items().size(), 2UL);
@@ -217,6 +267,46 @@ StatusOr<FuncIR*> ParseNameTuple(IR* ir, const pypa::AstPtr& ast,
   return func_ir;
 }
 
+// Returns the source that the rows of op are sampled from, if op reads a sampled MemorySource
+// through operators that keep its rows as they are.
+MemorySourceIR* SampledSource(OperatorIR* op) {
+  while (Match(op, Map()) || Match(op, Filter()) || Match(op, Drop()) || Match(op, GroupBy())) {
+    op = op->parents()[0];
+  }
+  if (!Match(op, MemorySource()) || !static_cast<MemorySourceIR*>(op)->sampled()) {
+    return nullptr;
+  }
+  return static_cast<MemorySourceIR*>(op);
+}
+
+// Scales the counts and sums that an aggregate computes over a sampled source up to estimates of
+// the counts and sums of the whole table.
+StatusOr<OperatorIR*> ScaleSampledAggregates(IR* graph, const pypa::AstPtr& ast,
+                                             BlockingAggIR* agg_op, MemorySourceIR* source) {
+  ColExpressionVector scaled_exprs;
+  for (const auto& agg_expr : agg_op->aggregate_expressions()) {
+    auto func = static_cast<FuncIR*>(agg_expr.node);
+    if (func->func_name() != "count" && func->func_name() != "sum") {
+      continue;
+    }
+    PX_ASSIGN_OR_RETURN(ColumnIR * column, graph->CreateNode<ColumnIR>(ast, agg_expr.name,
+                                                                       /* parent_op_idx */ 0));
+    PX_ASSIGN_OR_RETURN(FloatIR * scale,
+                        graph->CreateNode<FloatIR>(ast, 1 / source->sample_rate()));
+    PX_ASSIGN_OR_RETURN(
+        FuncIR * scaled,
+        graph->CreateNode<FuncIR>(ast, FuncIR::Op{FuncIR::Opcode::mult, "*", "multiply"},
+                                  std::vector<ExpressionIR*>{column, scale}));
+    scaled_exprs.push_back({agg_expr.name, scaled});
+  }
+  if (scaled_exprs.empty()) {
+    return agg_op;
+  }
+  PX_ASSIGN_OR_RETURN(MapIR * map_op, graph->CreateNode<MapIR>(ast, agg_op, scaled_exprs,
+                                                               /*keep_input_cols*/ true));
+  return map_op;
+}
+
 StatusOr<QLObjectPtr> AggHandler(CompilerState* compiler_state, IR* graph, OperatorIR* op,
                                  const pypa::AstPtr& ast, const ParsedArgs& args,
                                  ASTVisitor* visitor) {
@@ -235,7 +325,13 @@ StatusOr<QLObjectPtr> AggHandler(CompilerState* compiler_state, IR* graph, Opera
   PX_ASSIGN_OR_RETURN(
       BlockingAggIR * agg_op,
       graph->CreateNode<BlockingAggIR>(ast, op, std::vector<ColumnIR*>{}, aggregate_expressions));
-  return Dataframe::Create(compiler_state, agg_op, visitor);
+  MemorySourceIR* sampled_source = SampledSource(op);
+  if (sampled_source == nullptr) {
+    return Dataframe::Create(compiler_state, agg_op, visitor);
+  }
+  PX_ASSIGN_OR_RETURN(OperatorIR * scaled_op,
+                      ScaleSampledAggregates(graph, ast, agg_op, sampled_source));
+  return Dataframe::Create(compiler_state, scaled_op, visitor);
 }
 
 StatusOr<QLObjectPtr> MapAssignHandler(const pypa::AstPtr& ast, const ParsedArgs&, ASTVisitor*) {
@@ -270,6 +366,45 @@ StatusOr<QLObjectPtr> LimitHandler(CompilerState* compiler_state, IR* graph, Ope
   return Dataframe::Create(compiler_state, limit_op, visitor);
 }
 
+// Handles the sort() DataFrame logic.
+StatusOr<QLObjectPtr> SortHandler(CompilerState* compiler_state, IR* graph, OperatorIR* op,
+                                  const pypa::AstPtr& ast, const ParsedArgs& args,
+                                  ASTVisitor* visitor) {
+  PX_ASSIGN_OR_RETURN(std::vector<std::string> by, ParseAsListOfStrings(args.GetArg("by"), "by"));
+  if (by.empty()) {
+    return CreateAstError(ast, "'by' must name at least one column");
+  }
+  QLObjectPtr ascending_arg = args.GetArg("ascending");
+  PX_ASSIGN_OR_RETURN(std::vector<BoolIR*> ascending,
+                      ParseAsListOf<BoolIR>(ascending_arg, "ascending"));
+  // A single bool applies to every column.
+  if (!CollectionObject::IsCollection(ascending_arg)) {
+    ascending.resize(by.size(), ascending[0]);
+  }
+  if (ascending.size() != by.size()) {
+    return CreateAstError(ast, "'ascending' has $0 elements, but 'by' has $1", ascending.size(),
+                          by.size());
+  }
+
+  std::vector<SortColumn> sort_columns;
+  for (const auto& [idx, col_name] : Enumerate(by)) {
+    sort_columns.push_back({col_name, !ascending[idx]->val()});
+  }
+  PX_ASSIGN_OR_RETURN(SortIR * sort_op, graph->CreateNode<SortIR>(ast, op, sort_columns));
+  return Dataframe::Create(compiler_state, sort_op, visitor);
+}
+
+// Handles the tail() DataFrame logic.
+StatusOr<QLObjectPtr> TailHandler(CompilerState* compiler_state, IR* graph, OperatorIR* op,
+                                  const pypa::AstPtr& ast, const ParsedArgs& args,
+                                  ASTVisitor* visitor) {
+  PX_ASSIGN_OR_RETURN(IntIR * rows_node, GetArgAs<IntIR>(ast, args, "n"));
+  PX_ASSIGN_OR_RETURN(LimitIR * limit_op, graph->CreateNode<LimitIR>(ast, op, rows_node->val()));
+  // The source is reversed for the Limit when the plan is optimized.
+  limit_op->set_tail(true);
+  return Dataframe::Create(compiler_state, limit_op, visitor);
+}
+
 class SubscriptHandler {
  public:
   /**
@@ -423,8 +558,8 @@ Status Dataframe::Init() {
   PX_ASSIGN_OR_RETURN(
       std::shared_ptr<FuncObject> constructor_fn,
       FuncObject::Create(
-          name(), {"table", "select", "start_time", "end_time"},
-          {{"select", "[]"}, {"start_time", "None"}, {"end_time", "None"}},
+          name(), {"table", "select", "start_time", "end_time", "sample"},
+          {{"select", "[]"}, {"start_time", "None"}, {"end_time", "None"}, {"sample", "None"}},
           /* has_variable_len_args */ false,
           /* has_variable_len_kwargs */ false,
           std::bind(&DataFrameConstructor, compiler_state_, graph(), std::placeholders::_1,
@@ -456,6 +591,29 @@ Status Dataframe::Init() {
   PX_RETURN_IF_ERROR(mergefn->SetDocString(kMergeOpDocstring));
   AddMethod(kMergeOpID, mergefn);
 
+  /**
+   * # Equivalent to the python method method syntax:
+   * def merge_asof(self, right, on='time_', by=[], how='inner', tolerance=0,
+   *                suffixes=['_x', '_y']):
+   *     ...
+   */
+  PX_ASSIGN_OR_RETURN(
+      std::shared_ptr<FuncObject> merge_asof_fn,
+      FuncObject::Create(
+          kMergeAsOfOpID, {"right", "on", "by", "how", "tolerance", "suffixes"},
+          {{"on", "'time_'"},
+           {"by", "[]"},
+           {"how", "'inner'"},
+           {"tolerance", "0"},
+           {"suffixes", "['_x', '_y']"}},
+          /* has_variable_len_args */ false,
+          /* has_variable_len_kwargs */ false,
+          std::bind(&AsOfJoinHandler, compiler_state_, graph(), op(), std::placeholders::_1,
+                    std::placeholders::_2, std::placeholders::_3),
+          ast_visitor()));
+  PX_RETURN_IF_ERROR(merge_asof_fn->SetDocString(kMergeAsOfOpDocstring));
+  AddMethod(kMergeAsOfOpID, merge_asof_fn);
+
   /**
    * # Equivalent to the python method method syntax:
    * def agg(self, **kwargs):
@@ -515,6 +673,40 @@ Status Dataframe::Init() {
   PX_RETURN_IF_ERROR(limitfn->SetDocString(kLimitOpDocstring));
   AddMethod(kLimitOpID, limitfn);
 
+  /**
+   * # Equivalent to the python method method syntax:
+   * def tail(self, n=5):
+   *     ...
+   */
+  PX_ASSIGN_OR_RETURN(
+      std::shared_ptr<FuncObject> tailfn,
+      FuncObject::Create(
+          kTailOpID, {"n"}, {{"n", "5"}},
+          /* has_variable_len_args */ false,
+          /* has_variable_len_kwargs */ false,
+          std::bind(&TailHandler, compiler_state_, graph(), op(), std::placeholders::_1,
+                    std::placeholders::_2, std::placeholders::_3),
+          ast_visitor()));
+  PX_RETURN_IF_ERROR(tailfn->SetDocString(kTailOpDocstring));
+  AddMethod(kTailOpID, tailfn);
+
+  /**
+   * # Equivalent to the python method method syntax:
+   * def sort(self, by, ascending=True):
+   *     ...
+   */
+  PX_ASSIGN_OR_RETURN(
+      std::shared_ptr<FuncObject> sortfn,
+      FuncObject::Create(
+          kSortOpID, {"by", "ascending"}, {{"ascending", "True"}},
+          /* has_variable_len_args */ false,
+          /* has_variable_len_kwargs */ false,
+          std::bind(&SortHandler, compiler_state_, graph(), op(), std::placeholders::_1,
+                    std::placeholders::_2, std::placeholders::_3),
+          ast_visitor()));
+  PX_RETURN_IF_ERROR(sortfn->SetDocString(kSortOpDocstring));
+  AddMethod(kSortOpID, sortfn);
+
   /**
    *
    * # Equivalent to the python method method syntax:
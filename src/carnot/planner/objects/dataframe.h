@@ -94,6 +94,10 @@ class Dataframe : public QLObject {
     # Absolute time sepecification (nanoseconds). Note this format only works for PxL scripts;
     # The Live UI's `start_time` argument does not support this format.
     df = px.DataFrame('http_events', start_time=1646157769000000000)
+  Examples:
+    # Approximate request counts over the last day, from 5% of the requests.
+    df = px.DataFrame('http_events', start_time='-24h', sample=0.05)
+    df = df.agg(requests=('latency', px.count))
 
   Args:
     table (string): The table name to load.
@@ -109,6 +113,10 @@ class Dataframe : public QLObject {
       was not called on this DataFrame, then this DataFrame will process data until the last record that was in the table
       at the beginning of query execution. If `end_time` is `None` and `df.stream()` was called on this DataFrame,
       then this DataFrame will process data indefinitely.
+    sample (float): The fraction of the rows to load, for approximate answers over long time ranges.
+      Rows are picked at random. Counts and sums that are aggregated from a sampled DataFrame are
+      scaled up to estimates for the whole table, and are returned as floats. Defaults to `None`,
+      which loads every row.
 
   Returns:
     px.DataFrame: DataFrame loaded from the table with the specified columns and time period.
@@ -280,6 +288,58 @@ class Dataframe : public QLObject {
   Returns:
     px.DataFrame: DataFrame with the first n rows.
   )doc";
+  inline static constexpr char kSortOpID[] = "sort";
+  inline static constexpr char kSortOpDocstring[] = R"doc(
+  Sort the rows by the values of columns.
+
+  Returns a DataFrame with the rows ordered by the first column of `by`, ties broken by the
+  second one, etc. Must be followed by `head()`, which keeps the first n rows of the order, as
+  a table can't be sorted as a whole while data is still streaming in.
+
+  :topic: dataframe_ops
+  :opname: Sort
+
+  Examples:
+    df = px.DataFrame('http_events')
+    # Keep the 10 slowest http requests.
+    df = df.sort('latency', ascending=False).head(10)
+
+  Examples:
+    df = px.DataFrame('http_events')
+    # Keep the 10 slowest http requests of each service, in service order.
+    df = df.sort(['service', 'latency'], ascending=[True, False]).head(10)
+
+  Args:
+    by (Union[string, List[string]]): The column or columns to sort by.
+    ascending (Union[bool, List[bool]]): Whether to sort in ascending order. A list sets the
+      order of each column of `by`. If not set, default is True.
+
+  Returns:
+    px.DataFrame: DataFrame with the rows in sorted order.
+  )doc";
+  inline static constexpr char kTailOpID[] = "tail";
+  inline static constexpr char kTailOpDocstring[] = R"doc(
+  Return the last n rows.
+
+  Returns a DataFrame with the n most recently written rows of a table. Each agent returns its
+  own newest rows, so across several agents the result holds the newest rows of some of them.
+  Can only follow a DataFrame read from a table, with at most map, filter and drop operations
+  in between.
+
+  :topic: dataframe_ops
+  :opname: Tail
+
+  Examples:
+    df = px.DataFrame('http_events')
+    # Keep only the 100 most recent http requests.
+    df = df.tail(100)
+
+  Args:
+    n (int): The number of rows to return. If not set, default is 5.
+
+  Returns:
+    px.DataFrame: DataFrame with the last n rows.
+  )doc";
 
   inline static constexpr char kMergeOpID[] = "merge";
   inline static constexpr char kMergeOpDocstring[] = R"doc(
@@ -327,6 +387,44 @@ class Dataframe : public QLObject {
     px.DataFrame: Merged DataFrame with the relation
     [left_join_col, ...remaining_left_columns, ...remaining_right_columns].
   )doc";
+  inline static constexpr char kMergeAsOfOpID[] = "merge_asof";
+  inline static constexpr char kMergeAsOfOpDocstring[] = R"doc(
+  Merges the input DataFrame with this one on the nearest earlier time.
+
+  Joins each row of this DataFrame with the latest row of the right DataFrame that has the same
+  `by` keys and a time at or before the row's time, like pandas' merge_asof with the backward
+  direction. Rows are only matched within the data of a single agent, as both DataFrames must
+  be ordered by time. Both DataFrames should therefore be read from tables, with no operations
+  between the table and the merge that reorder rows, such as aggregates or other merges.
+
+  Examples:
+    # Annotate each http request with the latest memory usage of the process that served it.
+    requests = px.DataFrame('http_events', start_time='-5m')
+    stats = px.DataFrame('process_stats', start_time='-5m')
+    stats = stats[['time_', 'upid', 'rss_bytes']]
+    df = requests.merge_asof(stats, on='time_', by='upid', tolerance='30s')
+
+  :topic: dataframe_ops
+  :opname: AsOfJoin
+
+  Args:
+    right (px.DataFrame): The DataFrame to join with this DataFrame.
+    on (string, default 'time_'): The TIME64NS column that orders both DataFrames.
+    by (Union[string, List[string]], default []): The columns that both DataFrames must have
+      equal values for. Must have the same types in both DataFrames.
+    how (['inner', 'left'], default 'inner'): the type of merge (join) to perform.
+      * inner: drop the rows of this DataFrame without a matching right row.
+      * left: keep every row of this DataFrame, with default values for the right columns when
+        there isn't a matching right row.
+    tolerance (px.Duration, default 0): How much older than the row of this DataFrame a right
+      row can be to match it. 0 means no limit.
+    suffixes (Tuple[string, string], default ['_x', '_y']): The suffixes to apply to duplicate
+      columns.
+
+  Returns:
+    px.DataFrame: Merged DataFrame with the relation
+    [...left_columns, ...right_columns except `on` and `by`].
+  )doc";
   inline static constexpr char kGroupByOpID[] = "groupby";
   inline static constexpr char kGroupByOpDocstring[] = R"doc(
   Groups the data in preparation for an aggregate.
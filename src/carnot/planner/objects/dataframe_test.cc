@@ -197,6 +197,39 @@ TEST_F(DataframeTest, Agg) {
   ASSERT_THAT(col_names, UnorderedElementsAre("col1", "col2"));
 }
 
+TEST_F(DataframeTest, Agg_ScalesSampledCounts) {
+  src->set_sample_rate(0.25);
+  var_table->Add("count", FuncObject::Create(
+                              "count", {}, {},
+                              /* has_variable_len_args */ true,
+                              /* has_variable_len_kwargs */ false,
+                              std::bind(&UDFHandler, graph.get(), "count", std::placeholders::_1,
+                                        std::placeholders::_2, std::placeholders::_3),
+                              ast_visitor.get())
+                              .ConsumeValueOrDie());
+  std::string script = R"pxl(agg = df[df.col1 > 2].agg(
+  outcol1=('col1', mean),
+  outcol2=('col2', count),
+))pxl";
+  ASSERT_OK(ParseScript(var_table, script));
+  auto var = var_table->Lookup("agg");
+  OperatorIR* op = static_cast<Dataframe*>(var.get())->op();
+  // Only the count is scaled, by a map after the agg.
+  ASSERT_MATCH(op, Map());
+  MapIR* map = static_cast<MapIR*>(op);
+  EXPECT_TRUE(map->keep_input_columns());
+  ASSERT_EQ(map->col_exprs().size(), 1);
+  EXPECT_EQ(map->col_exprs()[0].name, "outcol2");
+  ASSERT_MATCH(map->col_exprs()[0].node, Func("multiply"));
+  auto scaled = static_cast<FuncIR*>(map->col_exprs()[0].node);
+  ASSERT_EQ(scaled->all_args().size(), 2);
+  EXPECT_MATCH(scaled->all_args()[0], ColumnNode("outcol2"));
+  ASSERT_MATCH(scaled->all_args()[1], Float());
+  EXPECT_EQ(static_cast<FloatIR*>(scaled->all_args()[1])->val(), 4.0);
+  ASSERT_EQ(map->parents().size(), 1);
+  EXPECT_MATCH(map->parents()[0], BlockingAgg());
+}
+
 TEST_F(DataframeTest, Agg_FailsWithPositionalArgs) {
   EXPECT_THAT(ParseScript(var_table, "df.agg(mean)"),
               HasCompilerError("agg.* takes 0 arguments but 1 .* given"));
@@ -229,11 +262,54 @@ TEST_F(DataframeTest, CreateLimit) {
   EXPECT_EQ(limit->limit_value(), 1234);
 }
 
+TEST_F(DataframeTest, CreateTail) {
+  ASSERT_OK(ParseScript(var_table, "tail = df.tail(10)"));
+  auto var = var_table->Lookup("tail");
+  ASSERT_EQ(var->type_descriptor().type(), QLObjectType::kDataframe);
+  auto tail_obj = std::static_pointer_cast<Dataframe>(var);
+
+  ASSERT_MATCH(tail_obj->op(), Limit());
+  LimitIR* limit = static_cast<LimitIR*>(tail_obj->op());
+  EXPECT_EQ(limit->limit_value(), 10);
+  EXPECT_TRUE(limit->tail());
+}
+
 TEST_F(DataframeTest, LimitNonIntArgument) {
   EXPECT_THAT(ParseScript(var_table, "df.head('foo')"),
               HasCompilerError("Expected arg 'n' as type 'Int', received 'String'"));
 }
 
+TEST_F(DataframeTest, CreateSort) {
+  ASSERT_OK(ParseScript(var_table, "sort = df.sort(['foo', 'bar'], ascending=[True, False])"));
+  auto var = var_table->Lookup("sort");
+  ASSERT_EQ(var->type_descriptor().type(), QLObjectType::kDataframe);
+  auto sort_obj = std::static_pointer_cast<Dataframe>(var);
+
+  ASSERT_MATCH(sort_obj->op(), Sort());
+  SortIR* sort = static_cast<SortIR*>(sort_obj->op());
+  ASSERT_EQ(sort->sort_columns().size(), 2);
+  EXPECT_EQ(sort->sort_columns()[0].col_name, "foo");
+  EXPECT_FALSE(sort->sort_columns()[0].descending);
+  EXPECT_EQ(sort->sort_columns()[1].col_name, "bar");
+  EXPECT_TRUE(sort->sort_columns()[1].descending);
+}
+
+TEST_F(DataframeTest, SortSingleAscendingAppliesToAllColumns) {
+  ASSERT_OK(ParseScript(var_table, "sort = df.sort(['foo', 'bar'], ascending=False)"));
+  auto sort_obj = std::static_pointer_cast<Dataframe>(var_table->Lookup("sort"));
+
+  ASSERT_MATCH(sort_obj->op(), Sort());
+  SortIR* sort = static_cast<SortIR*>(sort_obj->op());
+  ASSERT_EQ(sort->sort_columns().size(), 2);
+  EXPECT_TRUE(sort->sort_columns()[0].descending);
+  EXPECT_TRUE(sort->sort_columns()[1].descending);
+}
+
+TEST_F(DataframeTest, SortAscendingLengthMismatch) {
+  EXPECT_THAT(ParseScript(var_table, "df.sort(['foo', 'bar'], ascending=[True])"),
+              HasCompilerError("'ascending' has 1 elements, but 'by' has 2"));
+}
+
 TEST_F(DataframeTest, SubscriptFilterRows) {
   ASSERT_OK(ParseScript(var_table, "filter = df[df.service == 'blah']"));
   auto var = var_table->Lookup("filter");
@@ -367,6 +443,19 @@ TEST_F(DataframeTest, ConstructorTest) {
   EXPECT_EQ(mem_src->table_name(), "http_events");
 }
 
+TEST_F(DataframeTest, ConstructorSample) {
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<Dataframe> df,
+                       Dataframe::Create(compiler_state.get(), graph.get(), ast_visitor.get()));
+  var_table->Add("DataFrame", df);
+  ASSERT_OK(ParseScript(var_table, "http = DataFrame('http_events', sample=0.05)"));
+  auto df_obj = static_cast<Dataframe*>(var_table->Lookup("http").get());
+  ASSERT_MATCH(df_obj->op(), MemorySource());
+  EXPECT_EQ(static_cast<MemorySourceIR*>(df_obj->op())->sample_rate(), 0.05);
+
+  EXPECT_THAT(ParseScript(var_table, "http = DataFrame('http_events', sample=1.5)"),
+              HasCompilerError("sample must be greater than 0 and at most 1, received 1.5"));
+}
+
 TEST_F(DataframeTest, StreamTest) {
   ASSERT_OK(ParseScript(var_table, "s = df.stream()"));
   auto var = var_table->Lookup("s");
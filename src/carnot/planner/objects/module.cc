@@ -18,13 +18,24 @@
 
 #include "src/carnot/planner/objects/module.h"
 #include <memory>
+#include <string>
+
+#include <absl/synchronization/mutex.h>
+
 #include "src/carnot/planner/parser/parser.h"
+#include "src/common/base/lru_cache.h"
 
 namespace px {
 namespace carnot {
 namespace planner {
 namespace compiler {
 
+namespace {
+// Bounds the cache in case callers pass many distinct module texts. The bundled modules fit
+// comfortably.
+constexpr size_t kMaxCachedModuleASTs = 16;
+}  // namespace
+
 StatusOr<std::shared_ptr<Module>> Module::Create(std::string_view module_text,
                                                  ASTVisitor* visitor) {
   std::shared_ptr<Module> module(new Module(visitor));
@@ -40,10 +51,30 @@ StatusOr<std::shared_ptr<QLObject>> Module::GetAttributeImpl(const pypa::AstPtr&
   return var_table_->Lookup(name);
 }
 
-Status Module::Init(std::string_view module_text) {
+StatusOr<pypa::AstModulePtr> Module::ParseModuleText(std::string_view module_text) {
+  static absl::Mutex cache_lock;
+  static auto* cache =
+      new LRUCache<std::string, pypa::AstModulePtr>(kMaxCachedModuleASTs);
+
+  std::string key(module_text);
+  {
+    absl::MutexLock lock(&cache_lock);
+    const pypa::AstModulePtr* ast = cache->Get(key);
+    if (ast != nullptr) {
+      return *ast;
+    }
+  }
+  // Parse outside of the lock. Compiles racing on the first parse each store an equivalent AST.
   Parser parser;
   PX_ASSIGN_OR_RETURN(pypa::AstModulePtr ast,
-                      parser.Parse(module_text.data(), /* parse_doc_strings */ true));
+                      parser.Parse(module_text, /* parse_doc_strings */ true));
+  absl::MutexLock lock(&cache_lock);
+  cache->Put(key, ast);
+  return ast;
+}
+
+Status Module::Init(std::string_view module_text) {
+  PX_ASSIGN_OR_RETURN(pypa::AstModulePtr ast, ParseModuleText(module_text));
   var_table_ = VarTable::Create();
   module_visitor_ = ast_visitor()->CreateModuleVisitor(var_table_);
   PX_RETURN_IF_ERROR(module_visitor_->ProcessModuleNode(ast));
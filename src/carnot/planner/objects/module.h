@@ -55,6 +55,13 @@ class Module : public QLObject {
   static StatusOr<std::shared_ptr<Module>> Create(std::string_view module_text,
                                                   ASTVisitor* visitor);
 
+  /**
+   * @brief Parses the text of a module, reusing the AST of an earlier parse of the same text.
+   * Modules such as pxviews are bundled with the planner and loaded by every compile, so only
+   * their first load pays for the parse. The returned AST is shared and must not be modified.
+   */
+  static StatusOr<pypa::AstModulePtr> ParseModuleText(std::string_view module_text);
+
  protected:
   explicit Module(ASTVisitor* visitor) : QLObject(ModuleType, visitor) {}
   StatusOr<std::shared_ptr<QLObject>> GetAttributeImpl(const pypa::AstPtr& ast,
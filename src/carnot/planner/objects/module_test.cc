@@ -71,6 +71,16 @@ TEST_F(ModuleTest, load_and_use_modules) {
   EXPECT_MATCH(static_cast<ExprObject*>(free_var.get())->expr(), String("imfree"));
 }
 
+TEST_F(ModuleTest, module_text_is_parsed_once) {
+  ASSERT_OK_AND_ASSIGN(auto first, Module::ParseModuleText(kModulePxl));
+  ASSERT_OK_AND_ASSIGN(auto second, Module::ParseModuleText(kModulePxl));
+  EXPECT_EQ(first.get(), second.get());
+
+  // Errors aren't cached.
+  EXPECT_NOT_OK(Module::ParseModuleText("def bad(:"));
+  EXPECT_NOT_OK(Module::ParseModuleText("def bad(:"));
+}
+
 }  // namespace compiler
 }  // namespace planner
 }  // namespace carnot
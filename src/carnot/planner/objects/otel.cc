@@ -177,6 +177,35 @@ StatusOr<QLObjectPtr> GaugeDefinition(IR* graph, const pypa::AstPtr& ast, const
   return OTelDataContainer::Create(visitor, std::move(metric));
 }
 
+StatusOr<QLObjectPtr> SumDefinition(IR* graph, const pypa::AstPtr& ast, const ParsedArgs& args,
+                                    ASTVisitor* visitor) {
+  OTelMetric metric;
+  PX_ASSIGN_OR_RETURN(metric.name, ParseName(args.GetArg("name")));
+  PX_ASSIGN_OR_RETURN(metric.description, GetArgAsString(ast, args, "description"));
+  // We add the time_ column  automatically.
+  PX_ASSIGN_OR_RETURN(metric.time_column,
+                      graph->CreateNode<ColumnIR>(ast, "time_", /* parent_op_idx */ 0));
+
+  PX_ASSIGN_OR_RETURN(auto val, GetArgAs<ColumnIR>(ast, args, "value"));
+  metric.unit_column = val;
+  if (!NoneObject::IsNoneObject(args.GetArg("unit"))) {
+    PX_ASSIGN_OR_RETURN(auto unit, GetArgAsString(ast, args, "unit"));
+    metric.unit_str = unit;
+  }
+  metric.metric = OTelMetricSum{val};
+
+  QLObjectPtr attributes = args.GetArg("attributes");
+  if (!DictObject::IsDict(attributes)) {
+    return attributes->CreateError("Expected attributes to be a dictionary, received $0",
+                                   attributes->name());
+  }
+
+  PX_ASSIGN_OR_RETURN(metric.attributes,
+                      ParseAttributes(static_cast<DictObject*>(attributes.get())));
+
+  return OTelDataContainer::Create(visitor, std::move(metric));
+}
+
 StatusOr<QLObjectPtr> SummaryDefinition(IR* graph, const pypa::AstPtr& ast, const ParsedArgs& args,
                                         ASTVisitor* visitor) {
   OTelMetric metric;
@@ -226,11 +255,14 @@ StatusOr<QLObjectPtr> SummaryDefinition(IR* graph, const pypa::AstPtr& ast, cons
   return OTelDataContainer::Create(visitor, std::move(metric));
 }
 
-StatusOr<QLObjectPtr> OTelDataDefinition(CompilerState* compiler_state, const pypa::AstPtr&,
+StatusOr<QLObjectPtr> OTelDataDefinition(CompilerState* compiler_state, const pypa::AstPtr& ast,
                                          const ParsedArgs& args, ASTVisitor* visitor) {
   OTelData otel_data;
   PX_RETURN_IF_ERROR(
       ParseEndpointConfig(compiler_state, args.GetArg("endpoint"), &otel_data.endpoint_config));
+  if (!NoneObject::IsNoneObject(args.GetArg("state_key"))) {
+    PX_ASSIGN_OR_RETURN(otel_data.export_state_key, GetArgAsString(ast, args, "state_key"));
+  }
   QLObjectPtr data = args.GetArg("data");
   if (!CollectionObject::IsCollection(data)) {
     return data->CreateError("Expected data to be a collection, received $0", data->name());
@@ -311,7 +343,8 @@ Status OTelModule::Init(CompilerState* compiler_state, IR* ir) {
   // Setup methods.
   PX_ASSIGN_OR_RETURN(
       std::shared_ptr<FuncObject> data_fn,
-      FuncObject::Create(kDataOpID, {"resource", "data", "endpoint"}, {{"endpoint", "None"}},
+      FuncObject::Create(kDataOpID, {"resource", "data", "endpoint", "state_key"},
+                         {{"endpoint", "None"}, {"state_key", "None"}},
                          /* has_variable_len_args */ false,
                          /* has_variable_len_kwargs */ false,
                          std::bind(&OTelDataDefinition, compiler_state, std::placeholders::_1,
@@ -371,6 +404,18 @@ Status OTelMetrics::Init() {
   PX_RETURN_IF_ERROR(summary_fn->SetDocString(kSummaryOpDocstring));
   AddMethod(kSummaryOpID, summary_fn);
 
+  PX_ASSIGN_OR_RETURN(
+      std::shared_ptr<FuncObject> sum_fn,
+      FuncObject::Create(kSumOpID, {"name", "value", "description", "attributes", "unit"},
+                         {{"description", "\"\""}, {"attributes", "{}"}, {"unit", "None"}},
+                         /* has_variable_len_args */ false,
+                         /* has_variable_len_kwargs */ false,
+                         std::bind(&SumDefinition, graph_, std::placeholders::_1,
+                                   std::placeholders::_2, std::placeholders::_3),
+                         ast_visitor()));
+  PX_RETURN_IF_ERROR(sum_fn->SetDocString(kSumOpDocstring));
+  AddMethod(kSumOpID, sum_fn);
+
   return Status::OK();
 }
 
@@ -64,6 +64,9 @@ class OTelModule : public QLObject {
     endpoint (px.otel.Endpoint, optional): The endpoint configuration value. The endpoint
       can be omitted if this script is run in the OTel plugin context where an endpoint
       is configured.
+    state_key (string, optional): The key under which the running totals of the
+      `px.otel.metric.Sum` data are kept between the runs of the script. Rows that a previous
+      run already exported are skipped. The totals restart with every run if not specified.
   Returns:
     Exporter: the description of how to map a DataFrame to OpenTelemetry Data. Can be passed
       into `px.export`.
@@ -153,6 +156,32 @@ class OTelMetrics : public QLObject {
       into `px.otel.Data()` as the data argument.
   )doc";
 
+  inline static constexpr char kSumOpID[] = "Sum";
+  inline static constexpr char kSumOpDocstring[] = R"doc(
+  Defines the DataFrame mapping to a cumulative OpenTelemetry Metric Sum
+
+  [Sums](https://opentelemetry.io/docs/reference/specification/metrics/datamodel/#sums)
+  are monotonic counters. Each row of the DataFrame holds the increase of the counter since
+  the previous row of the same series, which Pixie adds to the running total of the series.
+  With a `state_key` set in `px.otel.Data()`, the totals are kept between the runs of the script,
+  so that each run only has to query the data since the previous run. The source DataFrame must
+  have a `time_` column of type `TIME64NS` or the compiler will throw an error.
+
+  :topic: otel
+
+  Args:
+    name (string): The name of the metric. Must adhere to [OpenTelemetry's naming conventions](https://opentelemetry.io/docs/reference/specification/metrics/api/#instrument)
+    value (Column): The column that contains the increase. Must be either an INT64 or a FLOAT64.
+    description (string, optional): A description of what the metric tracks.
+    attributes (Dict[string, Column|string], optional): A mapping of attribute name to a string or the column
+      that stores data about the attribute.
+    unit (string, optional): The unit string to use for the metric. If not specified, will attempt
+      to use the Semantic Type of the `value` to infer the unit string.
+  Returns:
+    OTelDataContainer: the mapping of DataFrame columns to OpenTelemetry Sum fields. Can be passed
+      into `px.otel.Data()` as the data argument.
+  )doc";
+
  protected:
   OTelMetrics(ASTVisitor* ast_visitor, IR* graph)
       : QLObject(OTelMetricsModuleType, ast_visitor), graph_(graph) {}
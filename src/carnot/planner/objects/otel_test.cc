@@ -278,6 +278,54 @@ otel_sink_op {
       }
     }
   }
+})pb"},
+        {"Sum",
+         R"pxl(
+otel.Data(
+  endpoint=otel.Endpoint(
+    url='0.0.0.0:55690',
+  ),
+  resource={
+      'service.name' : df.service,
+  },
+  data=[
+    otelmetric.Sum(
+      name='http.requests',
+      value=df.num_requests,
+    )
+  ],
+  state_key='http_requests',
+))pxl",
+         table_store::schema::Relation{
+             {types::TIME64NS, types::STRING, types::INT64},
+             {"time_", "service", "num_requests"},
+             {types::ST_NONE, types::ST_SERVICE_NAME, types::ST_NONE},
+         },
+         R"pb(
+op_type: OTEL_EXPORT_SINK_OPERATOR
+otel_sink_op {
+  endpoint_config {
+    url: "0.0.0.0:55690"
+    timeout: 5
+  }
+  resource {
+    attributes {
+      name: "service.name"
+      column {
+        column_type: STRING
+        column_index: 1
+        can_be_json_encoded_array: true
+      }
+    }
+  }
+  metrics {
+    name: "http.requests"
+    time_column_index: 0
+    sum {
+      int_column_index: 2
+    }
+  }
+  export_state_key: "http_requests"
 })pb"},
         {"Multiple_Data_Configs",
          R"pxl(
@@ -0,0 +1,255 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/plan_cache.h"
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/util/message_differencer.h>
+
+#include <absl/strings/ascii.h>
+#include <absl/strings/str_cat.h>
+#include <absl/strings/str_split.h>
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+using google::protobuf::FieldDescriptor;
+using google::protobuf::Message;
+
+namespace {
+
+// Returns whether the non-message, non-int64 field has the same value in both messages.
+bool SameValue(const Message& a, const Message& b, const FieldDescriptor* field, int index) {
+  const auto* ra = a.GetReflection();
+  const auto* rb = b.GetReflection();
+  bool repeated = index >= 0;
+  switch (field->cpp_type()) {
+    case FieldDescriptor::CPPTYPE_INT32:
+      return repeated
+                 ? ra->GetRepeatedInt32(a, field, index) == rb->GetRepeatedInt32(b, field, index)
+                 : ra->GetInt32(a, field) == rb->GetInt32(b, field);
+    case FieldDescriptor::CPPTYPE_UINT32:
+      return repeated
+                 ? ra->GetRepeatedUInt32(a, field, index) == rb->GetRepeatedUInt32(b, field, index)
+                 : ra->GetUInt32(a, field) == rb->GetUInt32(b, field);
+    case FieldDescriptor::CPPTYPE_UINT64:
+      return repeated
+                 ? ra->GetRepeatedUInt64(a, field, index) == rb->GetRepeatedUInt64(b, field, index)
+                 : ra->GetUInt64(a, field) == rb->GetUInt64(b, field);
+    case FieldDescriptor::CPPTYPE_DOUBLE:
+      return repeated
+                 ? ra->GetRepeatedDouble(a, field, index) == rb->GetRepeatedDouble(b, field, index)
+                 : ra->GetDouble(a, field) == rb->GetDouble(b, field);
+    case FieldDescriptor::CPPTYPE_FLOAT:
+      return repeated
+                 ? ra->GetRepeatedFloat(a, field, index) == rb->GetRepeatedFloat(b, field, index)
+                 : ra->GetFloat(a, field) == rb->GetFloat(b, field);
+    case FieldDescriptor::CPPTYPE_BOOL:
+      return repeated
+                 ? ra->GetRepeatedBool(a, field, index) == rb->GetRepeatedBool(b, field, index)
+                 : ra->GetBool(a, field) == rb->GetBool(b, field);
+    case FieldDescriptor::CPPTYPE_ENUM:
+      return repeated ? ra->GetRepeatedEnumValue(a, field, index) ==
+                            rb->GetRepeatedEnumValue(b, field, index)
+                      : ra->GetEnumValue(a, field) == rb->GetEnumValue(b, field);
+    case FieldDescriptor::CPPTYPE_STRING:
+      return repeated
+                 ? ra->GetRepeatedString(a, field, index) == rb->GetRepeatedString(b, field, index)
+                 : ra->GetString(a, field) == rb->GetString(b, field);
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+std::string PlanCache::Key(const plannerpb::QueryRequest& query_request) {
+  std::string key;
+  for (std::string_view line : absl::StrSplit(query_request.query_str(), '\n')) {
+    absl::StrAppend(&key, absl::StripTrailingAsciiWhitespace(line), "\n");
+  }
+  key = std::string(absl::StripTrailingAsciiWhitespace(key));
+  key.push_back('\0');
+
+  // The rest of the request is serialized deterministically, so that requests with the same maps
+  // produce the same key.
+  plannerpb::QueryRequest rest = query_request;
+  rest.clear_query_str();
+  // Table stats change on every agent heartbeat, so they're left out of the key. A cached plan
+  // keeps the join build sides picked with the stats it was compiled with.
+  for (auto& schema_info :
+       *rest.mutable_logical_planner_state()->mutable_distributed_state()->mutable_schema_info()) {
+    schema_info.clear_stats();
+  }
+  {
+    google::protobuf::io::StringOutputStream stream(&key);
+    google::protobuf::io::CodedOutputStream coded(&stream);
+    coded.SetSerializationDeterministic(true);
+    rest.SerializeToCodedStream(&coded);
+  }
+  return key;
+}
+
+std::optional<distributedpb::DistributedPlan> PlanCache::Get(const std::string& key,
+                                                             int64_t time_now_ns) {
+  if (max_entries_ == 0) {
+    return std::nullopt;
+  }
+  absl::MutexLock lock(&lock_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return std::nullopt;
+  }
+  auto& entry = it->second;
+  lru_.splice(lru_.begin(), lru_, entry.lru_it);
+
+  distributedpb::DistributedPlan plan = entry.plan;
+  int64_t shift_ns = time_now_ns - entry.time_now_ns;
+  for (const auto& time_field : entry.time_fields) {
+    ShiftTimeField(&(*plan.mutable_qb_address_to_plan())[time_field.qb_address], time_field.path,
+                   shift_ns);
+  }
+  return plan;
+}
+
+void PlanCache::Insert(const std::string& key, distributedpb::DistributedPlan plan,
+                       int64_t time_now_ns, const distributedpb::DistributedPlan* probe_plan) {
+  if (max_entries_ == 0) {
+    return;
+  }
+  std::vector<TimeField> time_fields;
+  if (probe_plan != nullptr) {
+    // Apart from the per agent plans, the probe plan has to be identical.
+    distributedpb::DistributedPlan layout = plan;
+    distributedpb::DistributedPlan probe_layout = *probe_plan;
+    layout.clear_qb_address_to_plan();
+    probe_layout.clear_qb_address_to_plan();
+    if (plan.qb_address_to_plan_size() != probe_plan->qb_address_to_plan_size() ||
+        !google::protobuf::util::MessageDifferencer::Equals(layout, probe_layout)) {
+      return;
+    }
+    for (const auto& [qb_address, agent_plan] : plan.qb_address_to_plan()) {
+      auto probe_it = probe_plan->qb_address_to_plan().find(qb_address);
+      if (probe_it == probe_plan->qb_address_to_plan().end()) {
+        return;
+      }
+      FieldPath prefix;
+      std::vector<FieldPath> paths;
+      if (!DiffTimeFields(agent_plan, probe_it->second, &prefix, &paths)) {
+        VLOG(1) << "Not caching plan, it depends on the current time in a way that can't be "
+                   "rebound.";
+        return;
+      }
+      for (auto& path : paths) {
+        time_fields.push_back({qb_address, std::move(path)});
+      }
+    }
+  }
+
+  absl::MutexLock lock(&lock_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    lru_.erase(it->second.lru_it);
+    entries_.erase(it);
+  }
+  while (entries_.size() >= max_entries_) {
+    entries_.erase(lru_.back());
+    lru_.pop_back();
+  }
+  lru_.push_front(key);
+  entries_.emplace(key, Entry{std::move(plan), time_now_ns, std::move(time_fields), lru_.begin()});
+}
+
+bool PlanCache::DiffTimeFields(const Message& plan, const Message& probe, FieldPath* prefix,
+                               std::vector<FieldPath>* time_fields) {
+  const auto* descriptor = plan.GetDescriptor();
+  const auto* reflection = plan.GetReflection();
+  for (int i = 0; i < descriptor->field_count(); ++i) {
+    const FieldDescriptor* field = descriptor->field(i);
+    bool repeated = field->is_repeated();
+    bool is_message = field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE;
+    int size = 1;
+    if (repeated) {
+      size = reflection->FieldSize(plan, field);
+      if (size != reflection->FieldSize(probe, field)) {
+        return false;
+      }
+    } else if (is_message) {
+      bool has_field = reflection->HasField(plan, field);
+      if (has_field != reflection->HasField(probe, field)) {
+        return false;
+      }
+      if (!has_field) {
+        continue;
+      }
+    }
+
+    for (int j = 0; j < size; ++j) {
+      int index = repeated ? j : -1;
+      prefix->emplace_back(field, index);
+      if (is_message) {
+        const Message& plan_msg = repeated ? reflection->GetRepeatedMessage(plan, field, index)
+                                           : reflection->GetMessage(plan, field);
+        const Message& probe_msg = repeated ? reflection->GetRepeatedMessage(probe, field, index)
+                                            : reflection->GetMessage(probe, field);
+        if (!DiffTimeFields(plan_msg, probe_msg, prefix, time_fields)) {
+          return false;
+        }
+      } else if (field->cpp_type() == FieldDescriptor::CPPTYPE_INT64) {
+        int64_t plan_val = repeated ? reflection->GetRepeatedInt64(plan, field, index)
+                                    : reflection->GetInt64(plan, field);
+        int64_t probe_val = repeated ? reflection->GetRepeatedInt64(probe, field, index)
+                                     : reflection->GetInt64(probe, field);
+        if (plan_val != probe_val) {
+          if (probe_val - plan_val != kProbeOffsetNS) {
+            return false;
+          }
+          time_fields->push_back(*prefix);
+        }
+      } else if (!SameValue(plan, probe, field, index)) {
+        return false;
+      }
+      prefix->pop_back();
+    }
+  }
+  return true;
+}
+
+void PlanCache::ShiftTimeField(Message* plan, const FieldPath& path, int64_t shift_ns) {
+  Message* msg = plan;
+  for (size_t i = 0; i + 1 < path.size(); ++i) {
+    const auto& [field, index] = path[i];
+    const auto* reflection = msg->GetReflection();
+    msg = index < 0 ? reflection->MutableMessage(msg, field)
+                    : reflection->MutableRepeatedMessage(msg, field, index);
+  }
+  const auto& [field, index] = path.back();
+  const auto* reflection = msg->GetReflection();
+  if (index < 0) {
+    reflection->SetInt64(msg, field, reflection->GetInt64(*msg, field) + shift_ns);
+  } else {
+    reflection->SetRepeatedInt64(msg, field, index,
+                                 reflection->GetRepeatedInt64(*msg, field, index) + shift_ns);
+  }
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
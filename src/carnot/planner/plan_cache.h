@@ -0,0 +1,119 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <list>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+#include <google/protobuf/descriptor.h>
+
+#include "src/carnot/planner/distributedpb/distributed_plan.pb.h"
+#include "src/carnot/planner/plannerpb/service.pb.h"
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+/**
+ * @brief PlanCache holds the distributed plans of recently planned queries, so that repeated
+ * queries skip parsing, analysis, optimization and splitting.
+ *
+ * Plans are keyed on everything that goes into planning besides the clock: the script, the exec
+ * funcs and their args, the schemas, the agents and the planner options. Plans that read the
+ * current time (i.e. relative time ranges) are rebound to the time of each lookup.
+ */
+class PlanCache : public NotCopyable {
+ public:
+  // The clock offset the probe plan of a time dependent query is compiled at. It is an odd prime
+  // number of nanoseconds, so that fields that were rounded to some time unit don't move by
+  // exactly this much.
+  static constexpr int64_t kProbeOffsetNS = 1000000007;
+
+  /**
+   * @param max_entries the number of plans to hold, the least recently used plan is evicted
+   * first. 0 disables the cache.
+   */
+  explicit PlanCache(size_t max_entries) : max_entries_(max_entries) {}
+
+  /**
+   * @brief Returns the cache key of the query request. Trailing whitespace in the script doesn't
+   * change the key.
+   */
+  static std::string Key(const plannerpb::QueryRequest& query_request);
+
+  /**
+   * @brief Returns the plan cached for the key, rebound to the given time, or std::nullopt.
+   */
+  std::optional<distributedpb::DistributedPlan> Get(const std::string& key, int64_t time_now_ns);
+
+  /**
+   * @brief Caches the plan that was compiled at time_now_ns.
+   *
+   * If the compilation read the current time, probe_plan must be the same query compiled at
+   * time_now_ns + kProbeOffsetNS. The integer fields that moved by exactly kProbeOffsetNS are
+   * rebound by later lookups. If the plans differ in any other way, the plan isn't cached.
+   */
+  void Insert(const std::string& key, distributedpb::DistributedPlan plan, int64_t time_now_ns,
+              const distributedpb::DistributedPlan* probe_plan);
+
+  size_t size() {
+    absl::MutexLock lock(&lock_);
+    return entries_.size();
+  }
+
+ private:
+  // A sequence of (field, index) pairs leading to an int64 field of a planpb::Plan. The index is
+  // -1 for fields that aren't repeated.
+  using FieldPath = std::vector<std::pair<const google::protobuf::FieldDescriptor*, int>>;
+
+  struct TimeField {
+    std::string qb_address;
+    FieldPath path;
+  };
+
+  struct Entry {
+    distributedpb::DistributedPlan plan;
+    int64_t time_now_ns;
+    std::vector<TimeField> time_fields;
+    std::list<std::string>::iterator lru_it;
+  };
+
+  static bool DiffTimeFields(const google::protobuf::Message& plan,
+                             const google::protobuf::Message& probe, FieldPath* prefix,
+                             std::vector<FieldPath>* time_fields);
+  static void ShiftTimeField(google::protobuf::Message* plan, const FieldPath& path,
+                             int64_t shift_ns);
+
+  const size_t max_entries_;
+  absl::Mutex lock_;
+  absl::flat_hash_map<std::string, Entry> entries_ ABSL_GUARDED_BY(lock_);
+  // The keys of the entries, most recently used first.
+  std::list<std::string> lru_ ABSL_GUARDED_BY(lock_);
+};
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
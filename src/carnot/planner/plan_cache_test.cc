@@ -0,0 +1,149 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <google/protobuf/text_format.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/planner/plan_cache.h"
+#include "src/common/testing/protobuf.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+using ::px::testing::proto::EqualsProto;
+
+constexpr char kPlanTmpl[] = R"proto(
+  qb_address_to_plan {
+    key: "pem"
+    value {
+      nodes {
+        id: 1
+        nodes {
+          id: 1
+          op {
+            op_type: MEMORY_SOURCE_OPERATOR
+            mem_source_op {
+              name: "$0"
+              start_time { value: $1 }
+              stop_time { value: $2 }
+            }
+          }
+        }
+      }
+    }
+  }
+  qb_address_to_dag_id { key: "pem" value: 0 }
+)proto";
+
+distributedpb::DistributedPlan MakePlan(const std::string& table, int64_t start_time,
+                                        int64_t stop_time) {
+  distributedpb::DistributedPlan plan;
+  EXPECT_TRUE(google::protobuf::TextFormat::MergeFromString(
+      absl::Substitute(kPlanTmpl, table, start_time, stop_time), &plan));
+  return plan;
+}
+
+plannerpb::QueryRequest MakeQueryRequest(const std::string& query) {
+  plannerpb::QueryRequest query_request;
+  query_request.set_query_str(query);
+  return query_request;
+}
+
+TEST(PlanCacheTest, key) {
+  auto query_request = MakeQueryRequest("import px\npx.display(px.DataFrame('t'))\n");
+  auto key = PlanCache::Key(query_request);
+  EXPECT_EQ(key,
+            PlanCache::Key(MakeQueryRequest("import px  \npx.display(px.DataFrame('t'))\n\n")));
+  EXPECT_NE(key, PlanCache::Key(MakeQueryRequest("import px\npx.display(px.DataFrame('u'))\n")));
+
+  auto exec_func = query_request.add_exec_funcs();
+  exec_func->set_func_name("f");
+  auto arg = exec_func->add_arg_values();
+  arg->set_name("start_time");
+  arg->set_value("-5m");
+  auto key_with_args = PlanCache::Key(query_request);
+  EXPECT_NE(key, key_with_args);
+  arg->set_value("-10m");
+  EXPECT_NE(key_with_args, PlanCache::Key(query_request));
+}
+
+TEST(PlanCacheTest, time_independent_plan) {
+  PlanCache cache(2);
+  auto plan = MakePlan("http_events", 100, 200);
+  EXPECT_FALSE(cache.Get("query", 1000).has_value());
+  cache.Insert("query", plan, 1000, nullptr);
+
+  auto cached_plan = cache.Get("query", 5000);
+  ASSERT_TRUE(cached_plan.has_value());
+  EXPECT_THAT(cached_plan.value(), EqualsProto(plan.DebugString()));
+}
+
+TEST(PlanCacheTest, rebinds_time_dependent_plan) {
+  PlanCache cache(2);
+  int64_t time_now = 1000000;
+  // The start time is relative to the current time, the stop time is absolute.
+  auto probe_plan = MakePlan("http_events", time_now + PlanCache::kProbeOffsetNS - 100, 200);
+  cache.Insert("query", MakePlan("http_events", time_now - 100, 200), time_now, &probe_plan);
+
+  auto cached_plan = cache.Get("query", time_now + 50);
+  ASSERT_TRUE(cached_plan.has_value());
+  EXPECT_THAT(cached_plan.value(),
+              EqualsProto(MakePlan("http_events", time_now - 50, 200).DebugString()));
+}
+
+TEST(PlanCacheTest, skips_plan_that_cant_be_rebound) {
+  PlanCache cache(2);
+  int64_t time_now = 1000000;
+  // A start time that was rounded doesn't move with the clock.
+  auto rounded_probe_plan = MakePlan("http_events", PlanCache::kProbeOffsetNS - 7, 200);
+  cache.Insert("rounded", MakePlan("http_events", 0, 200), time_now, &rounded_probe_plan);
+  // Anything besides ints moving with the clock isn't expected either.
+  auto string_probe_plan = MakePlan("other", PlanCache::kProbeOffsetNS, 200);
+  cache.Insert("string", MakePlan("http_events", 0, 200), time_now, &string_probe_plan);
+  EXPECT_EQ(cache.size(), 0U);
+}
+
+TEST(PlanCacheTest, evicts_least_recently_used) {
+  PlanCache cache(2);
+  cache.Insert("a", MakePlan("a", 0, 0), 0, nullptr);
+  cache.Insert("b", MakePlan("b", 0, 0), 0, nullptr);
+  EXPECT_TRUE(cache.Get("a", 0).has_value());
+  cache.Insert("c", MakePlan("c", 0, 0), 0, nullptr);
+
+  EXPECT_EQ(cache.size(), 2U);
+  EXPECT_TRUE(cache.Get("a", 0).has_value());
+  EXPECT_FALSE(cache.Get("b", 0).has_value());
+  EXPECT_TRUE(cache.Get("c", 0).has_value());
+}
+
+TEST(PlanCacheTest, disabled) {
+  PlanCache cache(0);
+  cache.Insert("a", MakePlan("a", 0, 0), 0, nullptr);
+  EXPECT_FALSE(cache.Get("a", 0).has_value());
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -17,8 +17,12 @@
  */
 
 #pragma once
+#include <cxxabi.h>
+
+#include <cstdlib>
 #include <memory>
 #include <string>
+#include <typeinfo>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -116,6 +120,19 @@ class BaseRuleBatch {
 
 using RuleBatch = BaseRuleBatch<Rule>;
 
+/**
+ * @brief Returns the unqualified class name of the rule, for reporting rule timings.
+ */
+template <typename TRule>
+std::string RuleName(const TRule& rule) {
+  int status = 0;
+  std::unique_ptr<char, decltype(&std::free)> demangled(
+      abi::__cxa_demangle(typeid(rule).name(), nullptr, nullptr, &status), &std::free);
+  std::string name = status == 0 ? demangled.get() : typeid(rule).name();
+  auto pos = name.rfind("::");
+  return pos == std::string::npos ? name : name.substr(pos + 2);
+}
+
 template <typename TPlan>
 class RuleExecutor {
   using TRule = BaseRule<TPlan>;
@@ -123,7 +140,6 @@ class RuleExecutor {
 
  public:
   virtual ~RuleExecutor() = default;
-  // TODO(philkuz) figure out how to collect stats on the execution.
   Status Execute(TPlan* ir_graph) {
     for (const auto& rb : rule_batches) {
       bool can_continue = true;
@@ -133,6 +149,11 @@ class RuleExecutor {
         iteration += 1;
         bool graph_is_updated = false;
         for (const auto& rule : rb->rules()) {
+          std::string timer_name;
+          if (planner_timings_ != nullptr) {
+            timer_name = absl::StrCat(rb->name(), "/", RuleName(*rule));
+          }
+          ScopedPlannerTimer timer(RuleTimings(planner_timings_), timer_name);
           PX_ASSIGN_OR_RETURN(bool rule_updates_graph, rule->Execute(ir_graph));
           graph_is_updated = graph_is_updated || rule_updates_graph;
         }
@@ -160,8 +181,12 @@ class RuleExecutor {
     return out_ptr;
   }
 
+  // Records the time spent in each rule into `planner_timings`, if it is not null.
+  void set_planner_timings(PlannerTimings* planner_timings) { planner_timings_ = planner_timings; }
+
  private:
   std::vector<std::unique_ptr<TRuleBatch>> rule_batches;
+  PlannerTimings* planner_timings_ = nullptr;
 };
 
 }  // namespace planner
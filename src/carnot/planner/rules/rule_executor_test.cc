@@ -182,6 +182,21 @@ TEST_F(RuleExecutorTest, exit_early) {
   EXPECT_NOT_OK(executor->Execute(graph.get()));
 }
 
+// Tests that rule timings are recorded per batch and rule when requested.
+TEST_F(RuleExecutorTest, records_rule_timings) {
+  std::unique_ptr<TestExecutor> executor = std::move(TestExecutor::Create().ValueOrDie());
+  PlannerTimings timings;
+  executor->set_planner_timings(&timings);
+  RuleBatch* rule_batch = executor->CreateRuleBatch<FailOnMax>("resolve", 10);
+  MockRule* rule1 = rule_batch->AddRule<MockRule>(compiler_state_.get());
+  EXPECT_CALL(*rule1, Execute(_)).Times(2).WillOnce(Return(true)).WillRepeatedly(Return(false));
+  ASSERT_OK(executor->Execute(graph.get()));
+
+  ASSERT_EQ(timings.rules.size(), 1);
+  ASSERT_TRUE(timings.rules.contains("resolve/MockRule"));
+  EXPECT_EQ(timings.rules["resolve/MockRule"].num_calls, 2);
+}
+
 }  // namespace planner
 }  // namespace carnot
 }  // namespace px
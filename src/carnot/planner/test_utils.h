@@ -2188,16 +2188,20 @@ class DistributedRulesTest : public OperatorTests {
   distributedpb::DistributedState ThreeAgentOneKelvinStateWithMetadataInfo() {
     auto ps = LoadDistributedStatePb(kThreePEMsOneKelvinDistributedState);
     auto agent1_filter =
-        AgentMetadataFilter::Create(100, 0.01, {MetadataType::POD_ID, MetadataType::SERVICE_ID})
+        AgentMetadataFilter::Create(
+            100, 0.01, {MetadataType::POD_ID, MetadataType::SERVICE_ID, MetadataType::NAMESPACE})
             .ConsumeValueOrDie();
     auto agent2_filter =
-        AgentMetadataFilter::Create(100, 0.01, {MetadataType::POD_ID, MetadataType::SERVICE_ID})
+        AgentMetadataFilter::Create(
+            100, 0.01, {MetadataType::POD_ID, MetadataType::SERVICE_ID, MetadataType::NAMESPACE})
             .ConsumeValueOrDie();
     auto agent3_filter =
-        AgentMetadataFilter::Create(100, 0.01, {MetadataType::POD_ID, MetadataType::SERVICE_ID})
+        AgentMetadataFilter::Create(
+            100, 0.01, {MetadataType::POD_ID, MetadataType::SERVICE_ID, MetadataType::NAMESPACE})
             .ConsumeValueOrDie();
 
     PX_CHECK_OK(agent1_filter->InsertEntity(MetadataType::POD_ID, "agent1_pod"));
+    PX_CHECK_OK(agent1_filter->InsertEntity(MetadataType::NAMESPACE, "agent1_ns"));
     PX_CHECK_OK(agent2_filter->InsertEntity(MetadataType::SERVICE_ID, "agent2_service"));
 
     absl::flat_hash_map<std::string, distributedpb::MetadataInfo> mds;
@@ -328,6 +328,39 @@ columns {
 }
 )";
 
+constexpr char kTopKOperator1[] = R"(
+limit: 3
+sort_columns {
+  column_index: 1
+  descending: true
+}
+sort_columns {
+  column_index: 0
+}
+)";
+
+constexpr char kAsOfJoinOperator1[] = R"(
+type: LEFT_OUTER
+left_time_column_index: 0
+right_time_column_index: 0
+equality_conditions {
+  left_column_index: 1
+  right_column_index: 1
+}
+tolerance_ns: 1000
+output_columns {
+  parent_index: 0
+  column_index: 0
+}
+output_columns {
+  parent_index: 1
+  column_index: 2
+}
+column_names: "time_"
+column_names: "cpu"
+rows_per_batch: 10
+)";
+
 constexpr char kLimitDropOperator1[] = R"(
 limit: 10
 columns {
@@ -1474,6 +1507,22 @@ planpb::Operator CreateTestLimit1PB() {
   return op;
 }
 
+planpb::Operator CreateTestTopK1PB() {
+  planpb::Operator op;
+  auto op_proto =
+      absl::Substitute(kOperatorProtoTmpl, "TOP_K_OPERATOR", "top_k_op", kTopKOperator1);
+  CHECK(google::protobuf::TextFormat::MergeFromString(op_proto, &op)) << "Failed to parse proto";
+  return op;
+}
+
+planpb::Operator CreateTestAsOfJoin1PB() {
+  planpb::Operator op;
+  auto op_proto = absl::Substitute(kOperatorProtoTmpl, "AS_OF_JOIN_OPERATOR", "as_of_join_op",
+                                   kAsOfJoinOperator1);
+  CHECK(google::protobuf::TextFormat::MergeFromString(op_proto, &op)) << "Failed to parse proto";
+  return op;
+}
+
 planpb::Operator CreateTestDropLimit1PB() {
   planpb::Operator op;
   auto op_proto =
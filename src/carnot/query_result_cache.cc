@@ -0,0 +1,139 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/query_result_cache.h"
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+#include <iterator>
+#include <utility>
+
+DEFINE_int64(carnot_query_result_cache_ttl_ms,
+             gflags::Int64FromEnv("PL_CARNOT_QUERY_RESULT_CACHE_TTL_MS", 0),
+             "How long the results of a plan are reused for identical plans, in milliseconds. "
+             "0 disables the query result cache.");
+DEFINE_int64(carnot_query_result_cache_max_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_QUERY_RESULT_CACHE_MAX_BYTES", 64 * 1024 * 1024),
+             "The maximum size of the results held by the query result cache.");
+
+namespace px {
+namespace carnot {
+
+std::string QueryResultCache::Key(const planpb::Plan& plan) {
+  if (plan.incoming_agent_ids_size() > 0) {
+    return "";
+  }
+  for (const auto& fragment : plan.nodes()) {
+    for (const auto& node : fragment.nodes()) {
+      switch (node.op().op_type()) {
+        case planpb::MEMORY_SOURCE_OPERATOR:
+          if (node.op().mem_source_op().streaming()) {
+            return "";
+          }
+          break;
+        case planpb::GRPC_SOURCE_OPERATOR:
+        case planpb::UDTF_SOURCE_OPERATOR:
+        case planpb::MEMORY_SINK_OPERATOR:
+        case planpb::OTEL_EXPORT_SINK_OPERATOR:
+        case planpb::FILE_EXPORT_SINK_OPERATOR:
+          return "";
+        default:
+          break;
+      }
+    }
+  }
+
+  std::string key;
+  {
+    google::protobuf::io::StringOutputStream stream(&key);
+    google::protobuf::io::CodedOutputStream coded_stream(&stream);
+    coded_stream.SetSerializationDeterministic(true);
+    plan.SerializeToCodedStream(&coded_stream);
+  }
+  return key;
+}
+
+std::shared_ptr<const QueryResultCache::SentBatches> QueryResultCache::Get(
+    const std::string& key) {
+  absl::MutexLock lock(&lock_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+  if (std::chrono::steady_clock::now() - it->second.create_time > ttl_) {
+    EraseUnlocked(it);
+    return nullptr;
+  }
+  return it->second.batches;
+}
+
+void QueryResultCache::Put(const std::string& key, SentBatches batches) {
+  Entry entry;
+  entry.create_time = std::chrono::steady_clock::now();
+  entry.bytes = key.size();
+  for (const auto& [fragment_id, sinks] : batches) {
+    for (const auto& [sink_id, sink_batches] : sinks) {
+      for (const auto& rb : sink_batches) {
+        entry.bytes += rb->NumBytes();
+      }
+    }
+  }
+  if (entry.bytes > max_bytes_) {
+    return;
+  }
+  entry.batches = std::make_shared<const SentBatches>(std::move(batches));
+
+  absl::MutexLock lock(&lock_);
+  auto existing = entries_.find(key);
+  if (existing != entries_.end()) {
+    EraseUnlocked(existing);
+  }
+  // Expired entries go first, then the oldest ones until the new entry fits.
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    auto next = std::next(it);
+    if (entry.create_time - it->second.create_time > ttl_) {
+      EraseUnlocked(it);
+    }
+    it = next;
+  }
+  while (size_bytes_ + entry.bytes > max_bytes_ && !entries_.empty()) {
+    auto oldest = entries_.begin();
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+      if (it->second.create_time < oldest->second.create_time) {
+        oldest = it;
+      }
+    }
+    EraseUnlocked(oldest);
+  }
+  size_bytes_ += entry.bytes;
+  entries_.emplace(key, std::move(entry));
+}
+
+void QueryResultCache::EraseUnlocked(absl::flat_hash_map<std::string, Entry>::iterator it) {
+  size_bytes_ -= it->second.bytes;
+  entries_.erase(it);
+}
+
+int64_t QueryResultCache::size_bytes() const {
+  absl::MutexLock lock(&lock_);
+  return size_bytes_;
+}
+
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/common/base/base.h"
+#include "src/table_store/schema/row_batch.h"
+
+DECLARE_int64(carnot_query_result_cache_ttl_ms);
+DECLARE_int64(carnot_query_result_cache_max_bytes);
+
+namespace px {
+namespace carnot {
+
+/**
+ * QueryResultCache holds the row batches that the GRPC sinks of a plan sent, so that a plan that
+ * is executed again shortly after, such as a live view refreshing for each of its viewers, can be
+ * answered by sending the same batches instead of re-executing it.
+ *
+ * Plans are keyed by their whole proto, including the absolute time range of each memory source,
+ * so an entry is only served to plans that read exactly the same windows. Entries are only served
+ * for the ttl after they are created, which bounds how stale the results get.
+ * Only plans whose results depend on nothing but the local tables can be cached: plans that
+ * read from other Carnot instances or UDTFs, stream, or write anywhere but GRPC sinks get no key.
+ */
+class QueryResultCache : public NotCopyable {
+ public:
+  using RowBatchPtr = std::unique_ptr<table_store::schema::RowBatch>;
+  // The batches sent by each GRPC sink, by plan fragment ID and then sink node ID.
+  using SentBatches = std::map<int64_t, std::map<int64_t, std::vector<RowBatchPtr>>>;
+
+  QueryResultCache(std::chrono::milliseconds ttl, int64_t max_bytes)
+      : ttl_(ttl), max_bytes_(max_bytes) {}
+
+  /**
+   * @return the cache key of the plan, or an empty string if its results can't be cached.
+   */
+  static std::string Key(const planpb::Plan& plan);
+
+  /**
+   * @return the batches cached for the key, or nullptr if there are none younger than the ttl.
+   */
+  std::shared_ptr<const SentBatches> Get(const std::string& key) ABSL_LOCKS_EXCLUDED(lock_);
+
+  /**
+   * Caches the batches for the key, evicting the oldest entries to stay within max_bytes.
+   * Results larger than max_bytes aren't cached.
+   */
+  void Put(const std::string& key, SentBatches batches) ABSL_LOCKS_EXCLUDED(lock_);
+
+  int64_t size_bytes() const ABSL_LOCKS_EXCLUDED(lock_);
+
+ private:
+  struct Entry {
+    std::chrono::steady_clock::time_point create_time;
+    int64_t bytes = 0;
+    std::shared_ptr<const SentBatches> batches;
+  };
+
+  void EraseUnlocked(absl::flat_hash_map<std::string, Entry>::iterator it)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const std::chrono::milliseconds ttl_;
+  const int64_t max_bytes_;
+
+  mutable absl::Mutex lock_;
+  absl::flat_hash_map<std::string, Entry> entries_ ABSL_GUARDED_BY(lock_);
+  int64_t size_bytes_ ABSL_GUARDED_BY(lock_) = 0;
+};
+
+}  // namespace carnot
+}  // namespace px
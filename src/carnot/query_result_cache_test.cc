@@ -0,0 +1,192 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/query_result_cache.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "src/carnot/carnot.h"
+#include "src/carnot/exec/local_grpc_result_server.h"
+#include "src/carnot/funcs/funcs.h"
+#include "src/common/testing/testing.h"
+#include "src/table_store/table_store.h"
+
+namespace px {
+namespace carnot {
+
+using table_store::Table;
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+constexpr char kCountQuery[] = R"pxl(
+import px
+df = px.DataFrame(table='requests', start_time='-5m')
+df = df.agg(count=('latency', px.count))
+px.display(df, 'out')
+)pxl";
+
+constexpr char kLongerWindowQuery[] = R"pxl(
+import px
+df = px.DataFrame(table='requests', start_time='-10m')
+df = df.agg(count=('latency', px.count))
+px.display(df, 'out')
+)pxl";
+
+constexpr int64_t kSecond = 1000 * 1000 * 1000;
+
+class QueryResultCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    FLAGS_carnot_query_result_cache_ttl_ms = 60 * 1000;
+    table_store_ = std::make_shared<table_store::TableStore>();
+    result_server_ = std::make_unique<exec::LocalGRPCResultSinkServer>();
+
+    auto func_registry = std::make_unique<udf::Registry>("default_registry");
+    funcs::RegisterFuncsOrDie(func_registry.get());
+    auto clients_config = std::make_unique<Carnot::ClientsConfig>(Carnot::ClientsConfig{
+        [this](const std::string& address, const std::string&) {
+          return result_server_->StubGenerator(address);
+        },
+        [](grpc::ClientContext*) {},
+    });
+    auto server_config = std::make_unique<Carnot::ServerConfig>();
+    server_config->grpc_server_creds = grpc::InsecureServerCredentials();
+    server_config->grpc_server_port = 0;
+    carnot_ = Carnot::Create(sole::uuid4(), std::move(func_registry), table_store_,
+                             std::move(clients_config), std::move(server_config))
+                  .ConsumeValueOrDie();
+
+    table_store::schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64},
+                                      {"time_", "latency"});
+    requests_table_ = std::make_shared<Table>("requests", rel, 1024 * 1024);
+    table_store_->AddTable("requests", requests_table_);
+  }
+
+  void TearDown() override { FLAGS_carnot_query_result_cache_ttl_ms = 0; }
+
+  // Writes 10 requests, one per second, starting at start_s.
+  void WriteRequests(int64_t start_s) {
+    std::vector<types::Time64NSValue> times;
+    std::vector<types::Int64Value> latencies;
+    for (int64_t i = 0; i < 10; ++i) {
+      times.push_back((start_s + i) * kSecond);
+      latencies.push_back(i);
+    }
+    RowBatch rb(RowDescriptor(requests_table_->GetRelation().col_types()), 10);
+    ASSERT_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+    ASSERT_OK(rb.AddColumn(types::ToArrow(latencies, arrow::default_memory_pool())));
+    ASSERT_OK(requests_table_->WriteRowBatch(rb));
+  }
+
+  int64_t RunCountQuery(const std::string& query, int64_t time_now_s) {
+    result_server_->ResetQueryResults();
+    EXPECT_OK(carnot_->ExecuteQuery(query, sole::uuid4(), time_now_s * kSecond));
+    int64_t count = 0;
+    for (const auto& rb : result_server_->query_results("out")) {
+      for (int64_t i = 0; i < rb.num_rows(); ++i) {
+        count += types::GetValueFromArrowArray<types::DataType::INT64>(rb.ColumnAt(0).get(), i);
+      }
+    }
+    return count;
+  }
+
+  std::shared_ptr<table_store::TableStore> table_store_;
+  std::unique_ptr<exec::LocalGRPCResultSinkServer> result_server_;
+  std::unique_ptr<Carnot> carnot_;
+  std::shared_ptr<Table> requests_table_;
+};
+
+TEST_F(QueryResultCacheTest, key) {
+  ASSERT_OK_AND_ASSIGN(auto plan, carnot_->CompileQuery(kCountQuery, 100 * kSecond));
+  ASSERT_OK_AND_ASSIGN(auto same_plan, carnot_->CompileQuery(kCountQuery, 100 * kSecond));
+  ASSERT_OK_AND_ASSIGN(auto later_plan, carnot_->CompileQuery(kCountQuery, 200 * kSecond));
+  ASSERT_OK_AND_ASSIGN(auto longer_plan, carnot_->CompileQuery(kLongerWindowQuery, 100 * kSecond));
+
+  auto key = QueryResultCache::Key(plan);
+  EXPECT_NE("", key);
+  EXPECT_EQ(key, QueryResultCache::Key(same_plan));
+  // Windows of the same length that end at different times read different data.
+  EXPECT_NE(key, QueryResultCache::Key(later_plan));
+  EXPECT_NE(key, QueryResultCache::Key(longer_plan));
+
+  // Plans that depend on other agents can't be cached.
+  auto distributed_plan = plan;
+  distributed_plan.add_incoming_agent_ids();
+  EXPECT_EQ("", QueryResultCache::Key(distributed_plan));
+}
+
+TEST_F(QueryResultCacheTest, put_get_evict) {
+  auto make_batches = [](int64_t num_rows) {
+    QueryResultCache::SentBatches batches;
+    RowDescriptor desc({types::DataType::INT64});
+    auto rb = RowBatch::WithZeroRows(desc, true, true).ConsumeValueOrDie();
+    if (num_rows > 0) {
+      rb = std::make_unique<RowBatch>(desc, num_rows);
+      std::vector<types::Int64Value> values(num_rows, 1);
+      PX_CHECK_OK(rb->AddColumn(types::ToArrow(values, arrow::default_memory_pool())));
+    }
+    batches[0][1].push_back(std::move(rb));
+    return batches;
+  };
+
+  QueryResultCache cache(std::chrono::seconds(60), /* max_bytes */ 1000);
+  EXPECT_EQ(nullptr, cache.Get("a"));
+  cache.Put("a", make_batches(50));
+  auto batches = cache.Get("a");
+  ASSERT_NE(nullptr, batches);
+  EXPECT_EQ(50, batches->at(0).at(1)[0]->num_rows());
+
+  // The oldest entry makes room for a new one.
+  cache.Put("b", make_batches(100));
+  EXPECT_EQ(nullptr, cache.Get("a"));
+  EXPECT_NE(nullptr, cache.Get("b"));
+  EXPECT_LE(cache.size_bytes(), 1000);
+
+  // Results larger than the cache aren't cached.
+  cache.Put("c", make_batches(200));
+  EXPECT_EQ(nullptr, cache.Get("c"));
+
+  QueryResultCache expiring_cache(std::chrono::milliseconds(1), /* max_bytes */ 1000);
+  expiring_cache.Put("a", make_batches(10));
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  EXPECT_EQ(nullptr, expiring_cache.Get("a"));
+  EXPECT_EQ(0, expiring_cache.size_bytes());
+}
+
+TEST_F(QueryResultCacheTest, serves_repeated_queries) {
+  WriteRequests(0);
+  EXPECT_EQ(10, RunCountQuery(kCountQuery, /* time_now_s */ 100));
+
+  // The same query over the same window gets the cached results, even though the table changed.
+  WriteRequests(10);
+  EXPECT_EQ(10, RunCountQuery(kCountQuery, /* time_now_s */ 100));
+
+  // The same query over a window that ends later is executed.
+  EXPECT_EQ(20, RunCountQuery(kCountQuery, /* time_now_s */ 105));
+
+  // A different plan is executed.
+  EXPECT_EQ(20, RunCountQuery(kLongerWindowQuery, /* time_now_s */ 105));
+}
+
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/table_rollup.h"
+
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+#include <sole.hpp>
+
+namespace px {
+namespace carnot {
+
+using table_store::Table;
+using table_store::schema::Relation;
+
+namespace {
+
+// Appends the rows of one table to another.
+Status AppendRows(const Table& from, Table* to) {
+  std::vector<int64_t> cols(from.GetRelation().NumColumns());
+  std::iota(cols.begin(), cols.end(), 0);
+  Table::Cursor cursor(&from);
+  while (!cursor.Done()) {
+    PX_ASSIGN_OR_RETURN(auto rb, cursor.GetNextRowBatch(cols));
+    if (rb->num_rows() > 0) {
+      PX_RETURN_IF_ERROR(to->WriteRowBatch(*rb));
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<TableRollup>> TableRollup::Create(Carnot* carnot,
+                                                           table_store::TableStore* table_store,
+                                                           Spec spec) {
+  auto rollup = std::unique_ptr<TableRollup>(new TableRollup(carnot, table_store, std::move(spec)));
+  PX_RETURN_IF_ERROR(rollup->Init());
+  return rollup;
+}
+
+TableRollup::~TableRollup() {
+  if (source_table_ != nullptr) {
+    source_table_->SetExpiryCallback(nullptr);
+  }
+}
+
+Status TableRollup::Init() {
+  PX_ASSIGN_OR_RETURN(plan_, carnot_->CompileQuery(spec_.query, CurrentTimeNS()));
+  PX_RETURN_IF_ERROR(RewritePlan());
+
+  source_table_ = table_store_->GetTable(source_table_name_);
+  if (source_table_ == nullptr) {
+    return error::NotFound("Source table '$0' of the rollup not found.", source_table_name_);
+  }
+  source_relation_ = source_table_->GetRelation();
+  for (auto& output : outputs_) {
+    output.table = std::make_shared<Table>(output.name, output.relation, spec_.max_table_size);
+  }
+  {
+    absl::MutexLock lock(&staging_->lock);
+    staging_->table = NewStagingTable();
+  }
+  source_table_->SetExpiryCallback([staging = staging_](const table_store::schema::RowBatch& rb) {
+    absl::MutexLock lock(&staging->lock);
+    auto s = staging->table->WriteRowBatch(rb);
+    LOG_IF_EVERY_N(ERROR, !s.ok(), 100) << "Failed to stage expired rows for a rollup: " << s.msg();
+  });
+  return Status::OK();
+}
+
+Status TableRollup::RewritePlan() {
+  for (auto& fragment : *plan_.mutable_nodes()) {
+    for (auto& node : *fragment.mutable_nodes()) {
+      auto* op = node.mutable_op();
+      switch (op->op_type()) {
+        case planpb::MEMORY_SOURCE_OPERATOR: {
+          auto* source = op->mutable_mem_source_op();
+          if (!source_table_name_.empty() && source->name() != source_table_name_) {
+            return error::InvalidArgument("Rollups can only read one table, got '$0' and '$1'.",
+                                          source_table_name_, source->name());
+          }
+          if (!source->tablet().empty()) {
+            return error::InvalidArgument("Rollups can't read tabletized tables.");
+          }
+          source_table_name_ = source->name();
+          staging_table_name_ = absl::Substitute("__$0_rollup_staging", source_table_name_);
+          source->set_name(staging_table_name_);
+          source->clear_start_time();
+          source->clear_stop_time();
+          source->set_streaming(false);
+          break;
+        }
+        case planpb::GRPC_SINK_OPERATOR: {
+          if (!op->grpc_sink_op().has_output_table()) {
+            return error::InvalidArgument("Rollups can only be executed locally.");
+          }
+          const auto& result = op->grpc_sink_op().output_table();
+          Output output;
+          output.name = result.table_name();
+          output.result_table_name = absl::Substitute("__$0_rollup_result", output.name);
+          planpb::MemorySinkOperator sink;
+          sink.set_name(output.result_table_name);
+          *sink.mutable_column_types() = result.column_types();
+          *sink.mutable_column_names() = result.column_names();
+          *sink.mutable_column_semantic_types() = result.column_semantic_types();
+          std::vector<types::DataType> col_types;
+          for (const auto& col_type : result.column_types()) {
+            col_types.push_back(static_cast<types::DataType>(col_type));
+          }
+          output.relation = Relation(
+              col_types, {result.column_names().begin(), result.column_names().end()});
+          op->set_op_type(planpb::MEMORY_SINK_OPERATOR);
+          *op->mutable_mem_sink_op() = std::move(sink);
+          outputs_.push_back(std::move(output));
+          break;
+        }
+        case planpb::GRPC_SOURCE_OPERATOR:
+        case planpb::UDTF_SOURCE_OPERATOR:
+        case planpb::EMPTY_SOURCE_OPERATOR:
+          return error::InvalidArgument("Rollups can only read from a table.");
+        default:
+          break;
+      }
+    }
+  }
+  if (source_table_name_.empty()) {
+    return error::InvalidArgument("Rollup doesn't read a table.");
+  }
+  if (outputs_.empty()) {
+    return error::InvalidArgument("Rollup doesn't display any results.");
+  }
+  return Status::OK();
+}
+
+std::shared_ptr<Table> TableRollup::NewStagingTable() const {
+  return std::make_shared<Table>(staging_table_name_, source_relation_, spec_.max_staging_size);
+}
+
+Status TableRollup::Run() {
+  std::shared_ptr<Table> staged;
+  {
+    absl::MutexLock lock(&staging_->lock);
+    if (staging_->table->GetTableStats().batches_added == 0) {
+      return Status::OK();
+    }
+    staged = std::move(staging_->table);
+    staging_->table = NewStagingTable();
+  }
+
+  table_store_->AddTable(staging_table_name_, staged);
+  auto s = carnot_->ExecutePlan(plan_, sole::uuid4());
+  // The staged rows are dropped even if the rollup failed, so that they don't fail every run.
+  table_store_->AddTable(staging_table_name_, NewStagingTable());
+  PX_RETURN_IF_ERROR(s);
+
+  for (const auto& output : outputs_) {
+    auto* result = table_store_->GetTable(output.result_table_name);
+    if (result == nullptr) {
+      return error::Internal("Result '$0' of the rollup not found.", output.name);
+    }
+    PX_RETURN_IF_ERROR(AppendRows(*result, output.table.get()));
+  }
+  return Status::OK();
+}
+
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <absl/synchronization/mutex.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/carnot.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/common/base/base.h"
+#include "src/table_store/table_store.h"
+
+namespace px {
+namespace carnot {
+
+/**
+ * TableRollup aggregates the rows that expire from a table into coarser rollup tables, so that
+ * queries over longer windows than the table holds can read the much smaller rollups instead.
+ *
+ * The rollups are defined by a PxL script that aggregates a single source table, with a rollup
+ * table per displayed result, for example per-minute request counts per service:
+ *
+ *   import px
+ *   df = px.DataFrame(table='http_events', select=['time_', 'service', 'latency'])
+ *   df.timestamp = px.bin(df.time_, px.minutes(1))
+ *   df = df.groupby(['timestamp', 'service']).agg(count=('latency', px.count))
+ *   px.display(df, 'http_events_1m')
+ *
+ * The rows that expire from the source table are staged, and each call to Run() executes the script
+ * over the staged rows and appends its results to the rollup tables. Since a table has a single
+ * expiry callback, there can only be one TableRollup per source table.
+ *
+ * The time range of the script is ignored, since the staged rows are all older than the rows in the
+ * source table. A time bucket whose rows expire across runs gets a row per run, so queries of the
+ * rollups should re-aggregate the buckets (e.g. sum the counts per timestamp).
+ */
+class TableRollup : public NotCopyable {
+ public:
+  struct Spec {
+    // The PxL script that defines the rollups.
+    std::string query;
+    // The maximum size of each rollup table.
+    int64_t max_table_size = 8 * 1024 * 1024;
+    // The maximum size of the expired rows staged between runs.
+    int64_t max_staging_size = 16 * 1024 * 1024;
+  };
+
+  /**
+   * Compiles the rollup and starts staging the rows that expire from its source table.
+   *
+   * @param carnot the Carnot instance that executes the rollup.
+   * @param table_store the table store of the source table, which has to outlive the rollup.
+   * @param spec the definition of the rollup.
+   */
+  static StatusOr<std::unique_ptr<TableRollup>> Create(Carnot* carnot,
+                                                       table_store::TableStore* table_store,
+                                                       Spec spec);
+
+  ~TableRollup();
+
+  struct Output {
+    // The name of the rollup table, i.e. the name of the result in the script.
+    std::string name;
+    table_store::schema::Relation relation;
+    // The rollup table, which is up to the caller to add to the table store.
+    std::shared_ptr<table_store::Table> table;
+    // The memory sink that the result is written to on each run, before it's appended to the
+    // rollup table.
+    std::string result_table_name;
+  };
+
+  /**
+   * Aggregates the rows that expired since the last run into the rollup tables.
+   */
+  Status Run();
+
+  const std::string& source_table_name() const { return source_table_name_; }
+  const std::vector<Output>& outputs() const { return outputs_; }
+
+ private:
+  // The staged rows are shared with the expiry callback of the source table, which can outlive
+  // the rollup while it's being called.
+  struct Staging {
+    absl::Mutex lock;
+    std::shared_ptr<table_store::Table> table ABSL_GUARDED_BY(lock);
+  };
+
+  TableRollup(Carnot* carnot, table_store::TableStore* table_store, Spec spec)
+      : carnot_(carnot), table_store_(table_store), spec_(std::move(spec)) {}
+
+  Status Init();
+  // Points the plan at the staging table, and its results at memory sinks.
+  Status RewritePlan();
+  std::shared_ptr<table_store::Table> NewStagingTable() const;
+
+  Carnot* carnot_;
+  table_store::TableStore* table_store_;
+  const Spec spec_;
+  planpb::Plan plan_;
+
+  std::string source_table_name_;
+  table_store::Table* source_table_ = nullptr;
+  table_store::schema::Relation source_relation_;
+  std::string staging_table_name_;
+  std::shared_ptr<Staging> staging_ = std::make_shared<Staging>();
+
+  std::vector<Output> outputs_;
+};
+
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/carnot.h"
+#include "src/carnot/exec/local_grpc_result_server.h"
+#include "src/carnot/funcs/funcs.h"
+#include "src/carnot/table_rollup.h"
+#include "src/common/testing/testing.h"
+#include "src/table_store/table_store.h"
+
+namespace px {
+namespace carnot {
+
+using table_store::Table;
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+using ::testing::ElementsAre;
+
+constexpr char kRollupQuery[] = R"pxl(
+import px
+df = px.DataFrame(table='requests', select=['time_', 'service', 'latency'], start_time='-5m')
+df.timestamp = px.bin(df.time_, px.minutes(1))
+df = df.groupby(['timestamp', 'service']).agg(count=('latency', px.count))
+px.display(df, 'requests_1m')
+)pxl";
+
+class TableRollupTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    table_store_ = std::make_shared<table_store::TableStore>();
+    result_server_ = std::make_unique<exec::LocalGRPCResultSinkServer>();
+
+    auto func_registry = std::make_unique<udf::Registry>("default_registry");
+    funcs::RegisterFuncsOrDie(func_registry.get());
+    auto clients_config = std::make_unique<Carnot::ClientsConfig>(Carnot::ClientsConfig{
+        [this](const std::string& address, const std::string&) {
+          return result_server_->StubGenerator(address);
+        },
+        [](grpc::ClientContext*) {},
+    });
+    auto server_config = std::make_unique<Carnot::ServerConfig>();
+    server_config->grpc_server_creds = grpc::InsecureServerCredentials();
+    server_config->grpc_server_port = 0;
+    carnot_ = Carnot::Create(sole::uuid4(), std::move(func_registry), table_store_,
+                             std::move(clients_config), std::move(server_config))
+                  .ConsumeValueOrDie();
+
+    table_store::schema::Relation rel(
+        {types::DataType::TIME64NS, types::DataType::STRING, types::DataType::INT64},
+        {"time_", "service", "latency"});
+    requests_table_ = std::make_shared<Table>("requests", rel, 1000);
+    table_store_->AddTable("requests", requests_table_);
+  }
+
+  // Writes batches of 10 requests a second apart, alternating between the services a and b.
+  void WriteRequests(int num_batches) {
+    for (int batch = 0; batch < num_batches; ++batch) {
+      std::vector<types::Time64NSValue> times;
+      std::vector<types::StringValue> services;
+      std::vector<types::Int64Value> latencies;
+      for (int i = 0; i < 10; ++i) {
+        times.push_back(static_cast<int64_t>(next_request_) * 1000 * 1000 * 1000);
+        services.push_back(next_request_ % 2 == 0 ? "a" : "b");
+        latencies.push_back(next_request_);
+        ++next_request_;
+      }
+      RowBatch rb(RowDescriptor(requests_table_->GetRelation().col_types()), 10);
+      ASSERT_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+      ASSERT_OK(rb.AddColumn(types::ToArrow(services, arrow::default_memory_pool())));
+      ASSERT_OK(rb.AddColumn(types::ToArrow(latencies, arrow::default_memory_pool())));
+      ASSERT_OK(requests_table_->WriteRowBatch(rb));
+    }
+  }
+
+  int64_t NumRows(Table* table, int64_t count_col = -1) {
+    int64_t num_rows = 0;
+    Table::Cursor cursor(table);
+    while (!cursor.Done()) {
+      auto rb = cursor.GetNextRowBatch({count_col == -1 ? 0 : count_col}).ConsumeValueOrDie();
+      for (int64_t i = 0; i < rb->num_rows(); ++i) {
+        num_rows += count_col == -1 ? 1
+                                    : types::GetValueFromArrowArray<types::DataType::INT64>(
+                                          rb->ColumnAt(0).get(), i);
+      }
+    }
+    return num_rows;
+  }
+
+  std::shared_ptr<table_store::TableStore> table_store_;
+  std::unique_ptr<exec::LocalGRPCResultSinkServer> result_server_;
+  std::unique_ptr<Carnot> carnot_;
+  std::shared_ptr<Table> requests_table_;
+  int next_request_ = 0;
+};
+
+TEST_F(TableRollupTest, rolls_up_expired_rows) {
+  auto rollup = TableRollup::Create(carnot_.get(), table_store_.get(), {kRollupQuery})
+                    .ConsumeValueOrDie();
+  EXPECT_EQ("requests", rollup->source_table_name());
+  ASSERT_THAT(rollup->outputs(), ::testing::SizeIs(1));
+  const auto& output = rollup->outputs()[0];
+  EXPECT_EQ("requests_1m", output.name);
+  EXPECT_THAT(output.relation.col_names(), ElementsAre("timestamp", "service", "count"));
+
+  // Nothing has expired yet.
+  ASSERT_OK(rollup->Run());
+  EXPECT_EQ(0, NumRows(output.table.get()));
+
+  WriteRequests(20);
+  ASSERT_OK(rollup->Run());
+  int64_t num_expired = 200 - NumRows(requests_table_.get());
+  ASSERT_LT(0, num_expired);
+  EXPECT_EQ(num_expired, NumRows(output.table.get(), 2));
+
+  // The next run only rolls up the rows that expired since.
+  WriteRequests(20);
+  ASSERT_OK(rollup->Run());
+  num_expired = 400 - NumRows(requests_table_.get());
+  EXPECT_EQ(num_expired, NumRows(output.table.get(), 2));
+
+  rollup.reset();
+  WriteRequests(1);
+}
+
+TEST_F(TableRollupTest, rollup_reads_one_table) {
+  table_store_->AddTable("other_requests", Table::Create("other_requests",
+                                                         requests_table_->GetRelation()));
+  auto query = R"pxl(
+import px
+df = px.DataFrame(table='requests')
+other = px.DataFrame(table='other_requests')
+px.display(df.append(other), 'requests_1m')
+)pxl";
+  EXPECT_NOT_OK(TableRollup::Create(carnot_.get(), table_store_.get(), {query}));
+}
+
+}  // namespace carnot
+}  // namespace px
@@ -18,7 +18,9 @@
 
 #pragma once
 
-#include <absl/base/internal/spinlock.h>
+#include <absl/synchronization/mutex.h>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <thread>
@@ -27,6 +29,7 @@
 
 #include "src/carnot/udf/borrow_pool.h"
 #include "src/carnot/udf/model_executor.h"
+#include "src/common/base/thread_pool.h"
 
 namespace px {
 namespace carnot {
@@ -37,17 +40,46 @@ class ModelPool {
   using PoolType = BorrowPool<ModelExecutor>;
   using PtrType = PoolType::BorrowedPtrType;
 
+  // The calling thread also runs inferences, so by default up to 3 batches of a query are
+  // inferred in parallel (given as many executors were loaded).
+  static constexpr size_t kDefaultNumInferenceThreads = 2;
+
   static std::unique_ptr<ModelPool> Create() { return std::make_unique<ModelPool>(); }
 
+  ModelPool() : ModelPool(kDefaultNumInferenceThreads) {}
+  explicit ModelPool(size_t num_inference_threads)
+      : inference_thread_pool_(num_inference_threads) {}
+
   template <typename TExecutor, typename... Args>
   void CreatePool(Args... args) {
     // TODO(james, PP-2594): currently if you ask for the same type of model with different args the
     // pool will return the first args asked for.
-    auto pool = std::make_unique<PoolType>();
-    pool->Add(std::make_unique<TExecutor>(args...));
-    pool_map_[TExecutor::Type()] = std::move(pool);
+    Prewarm<TExecutor>(1, args...);
+  }
+
+  /**
+   * Loads executors of the given type until the pool holds num_executors of them. Calling this
+   * at startup means the first query doesn't pay the model load time, and allows ParallelExecute
+   * to run up to num_executors inferences at once.
+   */
+  template <typename TExecutor, typename... Args>
+  void Prewarm(size_t num_executors, Args... args) {
+    absl::MutexLock lock(&pools_lock_);
+    auto& entry = pools_[TExecutor::Type()];
+    if (entry.pool == nullptr) {
+      entry.pool = std::make_unique<PoolType>();
+    }
+    for (; entry.num_executors < num_executors; ++entry.num_executors) {
+      entry.pool->Add(std::make_unique<TExecutor>(args...));
+    }
   }
 
+  /**
+   * The number of executors that can run in parallel, one per inference thread plus the calling
+   * thread. Prewarm with this many executors to make full use of ParallelExecute.
+   */
+  size_t max_parallelism() const { return inference_thread_pool_.num_threads() + 1; }
+
   template <typename TExecutor>
   struct DerivedDeleter {
     void operator()(TExecutor* ptr) { deleter_(ptr); }
@@ -56,19 +88,60 @@ class ModelPool {
 
   template <typename TExecutor, typename... Args>
   std::unique_ptr<TExecutor, DerivedDeleter<TExecutor>> GetModelExecutor(Args... args) {
-    if (pool_map_.find(TExecutor::Type()) == pool_map_.end()) {
-      CreatePool<TExecutor>(args...);
-    }
-    auto ptr = pool_map_[TExecutor::Type()]->Borrow();
+    return Borrow<TExecutor>(GetOrCreatePool<TExecutor>(args...));
+  }
+
+  /**
+   * Runs fn(executor, i) for every i in [0, n), spread over the inference threads and the calling
+   * thread, each of which borrows one of the executors of the given type for the duration of the
+   * call. Blocks until all of the calls returned.
+   */
+  template <typename TExecutor, typename TFn, typename... Args>
+  void ParallelExecute(size_t n, TFn fn, Args... args) {
+    PoolRef ref = GetOrCreatePool<TExecutor>(args...);
+    size_t parallelism = std::min({n, ref.num_executors, max_parallelism()});
+    std::atomic<size_t> next = 0;
+    inference_thread_pool_.ParallelFor(parallelism, [&](size_t) {
+      auto executor = Borrow<TExecutor>(ref);
+      for (size_t i = next++; i < n; i = next++) {
+        fn(executor.get(), i);
+      }
+    });
+  }
+
+ private:
+  struct PoolEntry {
+    std::unique_ptr<PoolType> pool;
+    size_t num_executors = 0;
+  };
+  struct PoolRef {
+    PoolType* pool;
+    size_t num_executors;
+  };
+
+  template <typename TExecutor, typename... Args>
+  PoolRef GetOrCreatePool(Args... args) {
+    Prewarm<TExecutor>(1, args...);
+    absl::MutexLock lock(&pools_lock_);
+    const auto& entry = pools_[TExecutor::Type()];
+    return {entry.pool.get(), entry.num_executors};
+  }
+
+  template <typename TExecutor>
+  std::unique_ptr<TExecutor, DerivedDeleter<TExecutor>> Borrow(PoolRef ref) {
+    auto ptr = ref.pool->Borrow();
     while (ptr == nullptr) {
-      ptr = pool_map_[TExecutor::Type()]->Borrow();
+      ptr = ref.pool->Borrow();
       std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
     return std::unique_ptr<TExecutor, DerivedDeleter<TExecutor>>(
         static_cast<TExecutor*>(ptr.release()), DerivedDeleter<TExecutor>{ptr.get_deleter()});
   }
 
-  std::unordered_map<ModelType, std::unique_ptr<PoolType>> pool_map_;
+  // Pools are never removed, so the pointers to them stay valid while executors are borrowed.
+  absl::Mutex pools_lock_;
+  std::unordered_map<ModelType, PoolEntry> pools_ ABSL_GUARDED_BY(pools_lock_);
+  ThreadPool inference_thread_pool_;
 };
 
 }  // namespace udf
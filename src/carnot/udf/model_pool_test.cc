@@ -15,7 +15,10 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#include <atomic>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include <gflags/gflags.h>
 #include <gtest/gtest.h>
@@ -39,6 +42,36 @@ TEST(ModelPool, basic) {
   EXPECT_EQ(kTransformer, executor->Type());
 }
 
+TEST(ModelPool, prewarm) {
+  auto p = udf::ModelPool::Create();
+  p->Prewarm<TestTransformExecutor>(p->max_parallelism(), FLAGS_embedding_dir);
+  using ExecutorPtr =
+      std::unique_ptr<TestTransformExecutor, ModelPool::DerivedDeleter<TestTransformExecutor>>;
+  std::vector<ExecutorPtr> executors;
+  for (size_t i = 0; i < p->max_parallelism(); ++i) {
+    executors.push_back(p->GetModelExecutor<TestTransformExecutor>(FLAGS_embedding_dir));
+  }
+  for (const auto& executor : executors) {
+    EXPECT_NE(nullptr, executor);
+  }
+}
+
+TEST(ModelPool, parallel_execute) {
+  ModelPool p(/*num_inference_threads*/ 3);
+  p.Prewarm<TestTransformExecutor>(p.max_parallelism(), FLAGS_embedding_dir);
+  std::vector<std::atomic<int>> calls(100);
+  p.ParallelExecute<TestTransformExecutor>(
+      calls.size(),
+      [&](TestTransformExecutor* executor, size_t i) {
+        ASSERT_NE(nullptr, executor);
+        ++calls[i];
+      },
+      FLAGS_embedding_dir);
+  for (const auto& c : calls) {
+    EXPECT_EQ(1, c.load());
+  }
+}
+
 }  // namespace udf
 }  // namespace carnot
 }  // namespace px
@@ -24,6 +24,7 @@
 #include <memory>
 #include <random>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -92,6 +93,11 @@ class UDFTester {
   UDFTester& ForInput(Args... args) {
     res_ = udf_.Exec(function_ctx_.get(), args...);
 
+    if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+      // Verify the batch execution computes the same result.
+      ExpectExecBatchEquality(std::index_sequence_for<Args...>{}, args...);
+    }
+
     return *this;
   }
 
@@ -108,6 +114,21 @@ class UDFTester {
   typename types::DataTypeTraits<udf_data_type>::value_type Result() { return res_; }
 
  private:
+  template <std::size_t... I, typename... Args>
+  void ExpectExecBatchEquality(std::index_sequence<I...>, Args... args) {
+    [[maybe_unused]] constexpr auto exec_argument_types = ScalarUDFTraits<TUDF>::ExecArguments();
+    std::tuple<typename types::DataTypeTraits<exec_argument_types[I]>::value_type...> values(
+        args...);
+    typename types::DataTypeTraits<udf_data_type>::value_type batch_res;
+    OutputColumn<typename types::DataTypeTraits<udf_data_type>::value_type> out(&batch_res, 1);
+    EXPECT_OK(udf_.ExecBatch(
+        function_ctx_.get(),
+        ColumnView<typename types::DataTypeTraits<exec_argument_types[I]>::value_type>(
+            &std::get<I>(values), 1)...,
+        &out));
+    internal::ExpectEquality(batch_res, res_);
+  }
+
   TUDF udf_;
   std::unique_ptr<udf::FunctionContext> function_ctx_ = nullptr;
   typename types::DataTypeTraits<udf_data_type>::value_type res_;
@@ -17,6 +17,7 @@
  */
 
 #pragma once
+#include <absl/container/flat_hash_map.h>
 #include <arrow/builder.h>
 #include <arrow/type.h>
 
@@ -25,6 +26,8 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -37,6 +40,7 @@
 #include "src/shared/types/column_wrapper.h"
 #include "src/shared/types/types.h"
 #include "src/shared/types/typespb/wrapper/types_pb_wrapper.h"
+#include "src/shared/upid/upid_dictionary.h"
 
 namespace px {
 namespace carnot {
@@ -74,12 +78,149 @@ class AnyUDA : public BaseFunc {
  *      Status Init(FunctionContext *ctx, UDFValue... init_args) {}
  *  This function is called once during initialization of each instance (many instances
  *  may exists in a given query). The arguments are as provided by the query.
+ *
+ * It can also _optionally_ implement a batch version of Exec:
+ *      Status ExecBatch(FunctionContext *ctx, const ColumnView<UDFValue>&... values,
+ *                       OutputColumn<UDFValue>* out) {}
+ *  Where the value types match the ones of Exec. When it exists it is called once per batch of
+ *  records instead of calling Exec for every record, so that the loop over the records can be
+ *  vectorized, work that doesn't change between records can be hoisted out of it and the
+ *  arguments aren't copied for each record. It must compute the same results as Exec.
  */
 class ScalarUDF : public AnyUDF {
  public:
   ~ScalarUDF() override = default;
 };
 
+/**
+ * A read only view of one of the argument columns of a batch passed to ExecBatch.
+ */
+template <typename TValue>
+class ColumnView {
+ public:
+  ColumnView(const TValue* data, size_t size) : data_(data), size_(size) {}
+
+  const TValue& operator[](size_t idx) const { return data_[idx]; }
+  const TValue* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  const TValue* data_;
+  size_t size_;
+};
+
+/**
+ * The output column of a batch passed to ExecBatch. It is already sized to the number of records
+ * of the batch.
+ */
+template <typename TValue>
+class OutputColumn {
+ public:
+  OutputColumn(TValue* data, size_t size) : data_(data), size_(size) {}
+
+  TValue& operator[](size_t idx) { return data_[idx]; }
+  TValue* data() { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  TValue* data_;
+  size_t size_;
+};
+
+/**
+ * Implements ExecBatch for UDFs whose output record only depends on the same record of the
+ * arguments, by setting out[idx] = fn(args[idx]...) for every record.
+ */
+template <typename TOutput, typename TFn, typename... TArgs>
+Status ExecBatchElementwise(OutputColumn<TOutput>* out, TFn fn, const ColumnView<TArgs>&... args) {
+  // The column pointers are passed as arguments so that the compiler knows they don't change in
+  // the loop and can vectorize it.
+  auto run = [size = out->size(), &fn](TOutput* out_data, const TArgs*... args_data) {
+    for (size_t idx = 0; idx < size; ++idx) {
+      out_data[idx] = fn(args_data[idx]...);
+    }
+  };
+  run(out->data(), args.data()...);
+  return Status::OK();
+}
+
+namespace internal {
+// The key under which ExecBatchMemoized stores the results of an argument value.
+inline absl::uint128 MemoizationKey(const types::UInt128Value& val) { return val.val; }
+inline int64_t MemoizationKey(const types::Int64Value& val) { return val.val; }
+// The column outlives the batch, so the view can be used as the key.
+inline std::string_view MemoizationKey(const types::StringValue& val) { return val; }
+}  // namespace internal
+
+/**
+ * Implements ExecBatch for UDFs of a single argument whose batches usually hold only a few
+ * distinct values, such as the UPIDs of a batch of events. fn is called once per distinct value
+ * of the batch, and the other records get a copy of its result.
+ */
+template <typename TOutput, typename TFn, typename TArg>
+Status ExecBatchMemoized(OutputColumn<TOutput>* out, TFn fn, const ColumnView<TArg>& arg) {
+  using TKey = decltype(internal::MemoizationKey(std::declval<TArg>()));
+  // Maps each distinct value to the first record that holds it.
+  absl::flat_hash_map<TKey, size_t> first_idx;
+  for (size_t idx = 0; idx < out->size(); ++idx) {
+    // Records of the same value are often next to each other, which skips the hash lookup.
+    if (idx > 0 && arg[idx] == arg[idx - 1]) {
+      (*out)[idx] = (*out)[idx - 1];
+      continue;
+    }
+    auto [it, inserted] = first_idx.try_emplace(internal::MemoizationKey(arg[idx]), idx);
+    (*out)[idx] = inserted ? fn(arg[idx]) : (*out)[it->second];
+  }
+  return Status::OK();
+}
+
+/**
+ * The results of a UDF of a UPID, kept by the UDF across the batches of a query. Metadata UDFs
+ * only depend on the UPID and on the metadata snapshot of the query, so they only need to resolve
+ * each UPID once per query, rather than once per batch.
+ */
+template <typename TOutput>
+class UPIDMemo {
+ public:
+  // Bounds the memory of long running queries over many processes: past this many UPIDs the memo
+  // starts over.
+  static constexpr size_t kMaxUPIDs = 1 << 16;
+
+ private:
+  template <typename TOut, typename TFn>
+  friend Status ExecBatchMemoized(UPIDMemo<TOut>* memo, OutputColumn<TOut>* out, TFn fn,
+                                  const ColumnView<types::UInt128Value>& arg);
+
+  md::UPIDDictionary upids_;
+  // Indexed by the UPID IDs of upids_.
+  std::vector<TOutput> results_;
+};
+
+/**
+ * Same as ExecBatchMemoized above, but for UDFs of a UPID whose results also hold across batches.
+ * fn is called once per distinct UPID for the lifetime of the memo.
+ */
+template <typename TOutput, typename TFn>
+Status ExecBatchMemoized(UPIDMemo<TOutput>* memo, OutputColumn<TOutput>* out, TFn fn,
+                         const ColumnView<types::UInt128Value>& arg) {
+  if (memo->upids_.size() > UPIDMemo<TOutput>::kMaxUPIDs) {
+    memo->upids_.Clear();
+    memo->results_.clear();
+  }
+  for (size_t idx = 0; idx < out->size(); ++idx) {
+    if (idx > 0 && arg[idx] == arg[idx - 1]) {
+      (*out)[idx] = (*out)[idx - 1];
+      continue;
+    }
+    size_t id = memo->upids_.GetOrInsert(arg[idx].val);
+    if (id == memo->results_.size()) {
+      memo->results_.push_back(fn(arg[idx]));
+    }
+    (*out)[idx] = memo->results_[id];
+  }
+  return Status::OK();
+}
+
 /**
  * UDA is a stateful function that updates internal state bases on the input
  * values. It must be Merge-able with other UDAs of the same type.
@@ -188,6 +329,32 @@ static constexpr types::DataType ReturnTypeHelper(ReturnType (TUDF::*)(Types...)
   return types::ValueTypeTraits<ReturnType>::data_type;
 }
 
+// SFINAE test for ExecBatch fn.
+template <typename T, typename = void>
+struct has_udf_exec_batch_fn : std::false_type {};
+
+template <typename T>
+struct has_udf_exec_batch_fn<T, std::void_t<decltype(&T::ExecBatch)>> : std::true_type {};
+
+/**
+ * Checks that the ExecBatch function of TUDF takes the same value types as the given Exec.
+ */
+template <typename TUDF, typename ReturnType, typename TExecUDF, typename... Types>
+static constexpr bool IsValidExecBatchFn(ReturnType (TExecUDF::*)(FunctionContext*, Types...)) {
+  return std::is_invocable_r_v<Status, decltype(&TUDF::ExecBatch), TUDF*, FunctionContext*,
+                               const ColumnView<Types>&..., OutputColumn<ReturnType>*>;
+}
+
+template <typename T, typename = void>
+struct check_exec_batch_fn {};
+
+template <typename T>
+struct check_exec_batch_fn<T, typename std::enable_if_t<has_udf_exec_batch_fn<T>::value>> {
+  static_assert(IsValidExecBatchFn<T>(&T::Exec),
+                "must have a valid ExecBatch fn, in form: Status ExecBatch(FunctionContext*, "
+                "const ColumnView<UDFValue>&..., OutputColumn<UDFValue>*)");
+};
+
 template <typename T, typename = void>
 struct check_init_fn {};
 
@@ -228,6 +395,12 @@ class ScalarUDFTraits {
    */
   static constexpr bool HasExecutor() { return has_udf_executor_fn<T>::value; }
 
+  /**
+   * Checks if the UDF has an ExecBatch function, which is then used instead of Exec.
+   * @return true if it has an ExecBatch function.
+   */
+  static constexpr bool HasExecBatch() { return has_udf_exec_batch_fn<T>::value; }
+
   template <typename Q = T, std::enable_if_t<ScalarUDFTraits<Q>::HasInit(), void>* = nullptr>
   static constexpr auto InitArguments() {
     return GetArgumentTypesHelper(&Q::Init);
@@ -247,6 +420,7 @@ class ScalarUDFTraits {
    private:
     static constexpr check_init_fn<T> check_init_{};
     static constexpr check_executor_fn<T> check_executor_{};
+    static constexpr check_exec_batch_fn<T> check_exec_batch_{};
   } check_;
 };
 
@@ -52,6 +52,23 @@ class AddUDF : public ScalarUDF {
   }
 };
 
+// Counts the calls to ExecBatch, to check that it's used instead of Exec.
+class AddBatchUDF : public AddUDF {
+ public:
+  Status ExecBatch(FunctionContext*, const ColumnView<types::Int64Value>& v1,
+                   const ColumnView<types::Int64Value>& v2, OutputColumn<types::Int64Value>* out) {
+    ++num_batches;
+    return ExecBatchElementwise(
+        out,
+        [](const types::Int64Value& a, const types::Int64Value& b) -> types::Int64Value {
+          return a.val + b.val;
+        },
+        v1, v2);
+  }
+
+  int num_batches = 0;
+};
+
 class InitArgUDF : public ScalarUDF {
  public:
   Status Init(FunctionContext*, types::StringValue str, types::Int64Value i) {
@@ -100,6 +117,26 @@ TEST(UDFDefinition, two_args) {
   EXPECT_EQ(8, out[2].val);
 }
 
+TEST(UDFDefinition, exec_batch) {
+  EXPECT_FALSE(ScalarUDFTraits<AddUDF>::HasExecBatch());
+  EXPECT_TRUE(ScalarUDFTraits<AddBatchUDF>::HasExecBatch());
+
+  auto ctx = FunctionContext(nullptr, nullptr);
+  ScalarUDFDefinition def("add");
+  EXPECT_OK(def.Init<AddBatchUDF>());
+
+  types::Int64ValueColumnWrapper v1({1, 2, 3});
+  types::Int64ValueColumnWrapper v2({3, 4, 5});
+
+  types::Int64ValueColumnWrapper out(v1.Size());
+  auto u = def.Make();
+  EXPECT_OK(def.ExecBatch(u.get(), &ctx, {&v1, &v2}, &out, v1.Size()));
+  EXPECT_EQ(1, static_cast<AddBatchUDF*>(u.get())->num_batches);
+  EXPECT_EQ(4, out[0].val);
+  EXPECT_EQ(6, out[1].val);
+  EXPECT_EQ(8, out[2].val);
+}
+
 TEST(UDFDefinition, str_args) {
   auto ctx = FunctionContext(nullptr, nullptr);
   ScalarUDFDefinition def("substr");
@@ -116,6 +153,89 @@ TEST(UDFDefinition, str_args) {
   EXPECT_EQ("el", out[2]);
 }
 
+// Counts the calls to Exec, to check that each distinct value of a batch is only computed once.
+class MemoizedSubStrUDF : public SubStrUDF {
+ public:
+  types::StringValue Exec(FunctionContext* ctx, types::StringValue str) {
+    ++num_calls;
+    return SubStrUDF::Exec(ctx, str);
+  }
+  Status ExecBatch(FunctionContext* ctx, const ColumnView<types::StringValue>& str,
+                   OutputColumn<types::StringValue>* out) {
+    return ExecBatchMemoized(
+        out, [this, ctx](const types::StringValue& val) { return Exec(ctx, val); }, str);
+  }
+
+  int num_calls = 0;
+};
+
+TEST(UDFDefinition, exec_batch_memoized) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  ScalarUDFDefinition def("substr");
+  EXPECT_OK(def.Init<MemoizedSubStrUDF>());
+
+  types::StringValueColumnWrapper v1({"abcd", "abcd", "defg", "abcd", "defg", "hello"});
+
+  types::StringValueColumnWrapper out(v1.Size());
+  auto u = def.Make();
+  EXPECT_OK(def.ExecBatch(u.get(), &ctx, {&v1}, &out, v1.Size()));
+
+  EXPECT_EQ(3, static_cast<MemoizedSubStrUDF*>(u.get())->num_calls);
+  EXPECT_EQ("bc", out[0]);
+  EXPECT_EQ("bc", out[1]);
+  EXPECT_EQ("ef", out[2]);
+  EXPECT_EQ("bc", out[3]);
+  EXPECT_EQ("ef", out[4]);
+  EXPECT_EQ("el", out[5]);
+}
+
+// Counts the calls to Exec, to check that each distinct UPID is only computed once across batches.
+class MemoizedUPIDToPIDUDF : public ScalarUDF {
+ public:
+  types::Int64Value Exec(FunctionContext*, types::UInt128Value upid) {
+    ++num_calls;
+    return static_cast<uint32_t>(upid.High64());
+  }
+  Status ExecBatch(FunctionContext* ctx, const ColumnView<types::UInt128Value>& upid,
+                   OutputColumn<types::Int64Value>* out) {
+    return ExecBatchMemoized(
+        &memo_, out, [this, ctx](const types::UInt128Value& val) { return Exec(ctx, val); },
+        upid);
+  }
+
+  int num_calls = 0;
+
+ private:
+  UPIDMemo<types::Int64Value> memo_;
+};
+
+TEST(UDFDefinition, exec_batch_upid_memoized) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  ScalarUDFDefinition def("upid_to_pid");
+  EXPECT_OK(def.Init<MemoizedUPIDToPIDUDF>());
+  auto u = def.Make();
+
+  types::UInt128ValueColumnWrapper batch1(
+      std::vector<types::UInt128Value>{{1, 10}, {1, 10}, {2, 10}, {1, 10}});
+  types::Int64ValueColumnWrapper out1(batch1.Size());
+  EXPECT_OK(def.ExecBatch(u.get(), &ctx, {&batch1}, &out1, batch1.Size()));
+  EXPECT_EQ(2, static_cast<MemoizedUPIDToPIDUDF*>(u.get())->num_calls);
+  EXPECT_EQ(1, out1[0].val);
+  EXPECT_EQ(1, out1[1].val);
+  EXPECT_EQ(2, out1[2].val);
+  EXPECT_EQ(1, out1[3].val);
+
+  // Only the UPID that wasn't in the first batch is computed.
+  types::UInt128ValueColumnWrapper batch2(
+      std::vector<types::UInt128Value>{{2, 10}, {3, 10}, {1, 10}});
+  types::Int64ValueColumnWrapper out2(batch2.Size());
+  EXPECT_OK(def.ExecBatch(u.get(), &ctx, {&batch2}, &out2, batch2.Size()));
+  EXPECT_EQ(3, static_cast<MemoizedUPIDToPIDUDF*>(u.get())->num_calls);
+  EXPECT_EQ(2, out2[0].val);
+  EXPECT_EQ(3, out2[1].val);
+  EXPECT_EQ(1, out2[2].val);
+}
+
 TEST(UDFDefinition, arrow_write) {
   auto ctx = FunctionContext(nullptr, nullptr);
   std::vector<types::Int64Value> v1 = {1, 2, 3};
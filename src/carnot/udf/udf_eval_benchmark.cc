@@ -31,11 +31,16 @@
 #include "src/shared/types/types.h"
 
 using px::Status;
+using px::carnot::udf::ColumnView;
 using px::carnot::udf::FunctionContext;
+using px::carnot::udf::OutputColumn;
 using px::carnot::udf::ScalarUDF;
 using px::carnot::udf::ScalarUDFDefinition;
 using px::carnot::udf::ScalarUDFWrapper;
+using px::carnot::udf::ExecBatchElementwise;
 using px::types::BaseValueType;
+using px::types::BoolValue;
+using px::types::BoolValueColumnWrapper;
 using px::types::Int64Value;
 using px::types::Int64ValueColumnWrapper;
 using px::types::StringValue;
@@ -62,6 +67,32 @@ class SubStrUDF : public ScalarUDF {
   StringValue Exec(FunctionContext*, StringValue v1) { return v1.substr(1, 2); }
 };
 
+// The same UDFs, executed a batch at a time.
+class AddBatchUDF : public AddUDF {
+ public:
+  Status ExecBatch(FunctionContext*, const ColumnView<Int64Value>& v1,
+                   const ColumnView<Int64Value>& v2, OutputColumn<Int64Value>* out) {
+    return ExecBatchElementwise(
+        out, [](const Int64Value& a, const Int64Value& b) -> Int64Value { return a.val + b.val; },
+        v1, v2);
+  }
+};
+
+class StringEqualUDF : public ScalarUDF {
+ public:
+  BoolValue Exec(FunctionContext*, StringValue v1, StringValue v2) { return v1 == v2; }
+};
+
+class StringEqualBatchUDF : public StringEqualUDF {
+ public:
+  Status ExecBatch(FunctionContext*, const ColumnView<StringValue>& v1,
+                   const ColumnView<StringValue>& v2, OutputColumn<BoolValue>* out) {
+    return ExecBatchElementwise(
+        out, [](const StringValue& a, const StringValue& b) -> BoolValue { return a == b; }, v1,
+        v2);
+  }
+};
+
 // This benchmark add two columns using Int64ValueVectors.
 // NOLINTNEXTLINE : runtime/references.
 static void BM_AddInt64Values(benchmark::State& state) {
@@ -244,12 +275,130 @@ static void BM_SubStrArrow(benchmark::State& state) {
   state.SetBytesProcessed(int64_t(state.iterations()) * width * data.size());
 }
 
+// Same as BM_SubStr, except that the output column (and each of its strings) is allocated for every
+// batch, the way the expression evaluators did before they recycled their columns. The difference
+// between the two is the cost of the per batch allocations.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_SubStrNewOutput(benchmark::State& state) {
+  int width = 10;
+  auto vec1 = GenerateStringValueVector(state.range(0), width);
+  auto wrapped_vec1 = StringValueColumnWrapper(vec1);
+
+  ScalarUDFDefinition def("substr");
+  CHECK(def.template Init<SubStrUDF>().ok());
+  auto u = def.Make();
+
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    auto out = px::types::ColumnWrapper::Make(px::types::STRING, vec1.size());
+    auto res = def.ExecBatch(u.get(), nullptr, {&wrapped_vec1}, out.get(), vec1.size());
+    PX_CHECK_OK(res);
+    benchmark::DoNotOptimize(out);
+  }
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * width * vec1.size());
+}
+
+// Same as BM_AddInt64Values, with a new output column for every batch.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_AddInt64ValuesNewOutput(benchmark::State& state) {
+  auto vec1 = CreateLargeData<Int64Value>(state.range(0));
+  auto vec2 = CreateLargeData<Int64Value>(state.range(0));
+  auto wrapped_vec1 = Int64ValueColumnWrapper(vec1);
+  auto wrapped_vec2 = Int64ValueColumnWrapper(vec2);
+
+  ScalarUDFDefinition def("add");
+  CHECK(def.template Init<AddUDF>().ok());
+  auto u = def.Make();
+
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    auto out = px::types::ColumnWrapper::Make(px::types::INT64, vec1.size());
+    auto res =
+        def.ExecBatch(u.get(), nullptr, {&wrapped_vec1, &wrapped_vec2}, out.get(), vec1.size());
+    CHECK(res.ok());
+    benchmark::DoNotOptimize(out);
+  }
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * 2 * vec1.size() * sizeof(int64_t));
+}
+
+// Compares calling Exec for every row (AddUDF, StringEqualUDF) against calling ExecBatch once for
+// the batch (AddBatchUDF, StringEqualBatchUDF).
+template <typename TUDF>
+// NOLINTNEXTLINE : runtime/references.
+static void BM_AddInt64ValuesExec(benchmark::State& state) {
+  auto vec1 = CreateLargeData<Int64Value>(state.range(0));
+  auto vec2 = CreateLargeData<Int64Value>(state.range(0));
+  auto wrapped_vec1 = Int64ValueColumnWrapper(vec1);
+  auto wrapped_vec2 = Int64ValueColumnWrapper(vec2);
+  Int64ValueColumnWrapper out(vec1.size());
+
+  ScalarUDFDefinition def("add");
+  CHECK(def.template Init<TUDF>().ok());
+  auto u = def.Make();
+
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    auto res = def.ExecBatch(u.get(), nullptr, {&wrapped_vec1, &wrapped_vec2}, &out, vec1.size());
+    CHECK(res.ok());
+    benchmark::DoNotOptimize(out);
+  }
+
+  for (size_t idx = 0; idx < vec1.size(); ++idx) {
+    CHECK((vec1[idx].val + vec2[idx].val) == out[idx].val);
+  }
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * 2 * vec1.size() * sizeof(int64_t));
+}
+
+template <typename TUDF>
+// NOLINTNEXTLINE : runtime/references.
+static void BM_StringEqualExec(benchmark::State& state) {
+  int width = 10;
+  auto vec1 = GenerateStringValueVector(state.range(0), width);
+  auto vec2 = vec1;
+  // Make every other row differ.
+  for (size_t idx = 0; idx < vec2.size(); idx += 2) {
+    vec2[idx][0] ^= 1;
+  }
+  auto wrapped_vec1 = StringValueColumnWrapper(vec1);
+  auto wrapped_vec2 = StringValueColumnWrapper(vec2);
+  BoolValueColumnWrapper out(vec1.size());
+
+  ScalarUDFDefinition def("equal");
+  CHECK(def.template Init<TUDF>().ok());
+  auto u = def.Make();
+
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    auto res = def.ExecBatch(u.get(), nullptr, {&wrapped_vec1, &wrapped_vec2}, &out, vec1.size());
+    CHECK(res.ok());
+    benchmark::DoNotOptimize(out);
+  }
+
+  for (size_t idx = 0; idx < vec1.size(); ++idx) {
+    CHECK_EQ(idx % 2 == 1, out[idx].val);
+  }
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * 2 * width * vec1.size());
+}
+
+BENCHMARK_TEMPLATE(BM_AddInt64ValuesExec, AddUDF)->RangeMultiplier(4)->Range(1, 1 << 16);
+BENCHMARK_TEMPLATE(BM_AddInt64ValuesExec, AddBatchUDF)->RangeMultiplier(4)->Range(1, 1 << 16);
+BENCHMARK_TEMPLATE(BM_StringEqualExec, StringEqualUDF)->RangeMultiplier(4)->Range(1, 1 << 16);
+BENCHMARK_TEMPLATE(BM_StringEqualExec, StringEqualBatchUDF)
+    ->RangeMultiplier(4)
+    ->Range(1, 1 << 16);
+
 BENCHMARK(BM_AddInt64ValueToArrow)->RangeMultiplier(2)->Range(1, 1 << 16);
 BENCHMARK(BM_AddTwoInt64sArrow)->RangeMultiplier(2)->Range(1, 1 << 16);
 BENCHMARK(BM_AddInt64Values)->RangeMultiplier(2)->Range(1, 1 << 16);
+BENCHMARK(BM_AddInt64ValuesNewOutput)->RangeMultiplier(2)->Range(1, 1 << 16);
 
 BENCHMARK(BM_ConvertToArrowString)->RangeMultiplier(2)->Range(1, 1 << 16);
 BENCHMARK(BM_ConvertToArrowInt64)->RangeMultiplier(2)->Range(1, 1 << 16);
 
 BENCHMARK(BM_SubStrArrow)->RangeMultiplier(2)->Range(1, 1 << 16);
 BENCHMARK(BM_SubStr)->RangeMultiplier(2)->Range(1, 1 << 16);
+BENCHMARK(BM_SubStrNewOutput)->RangeMultiplier(2)->Range(1, 1 << 16);
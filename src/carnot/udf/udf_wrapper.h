@@ -69,6 +69,25 @@ Status ExecWrapper(TUDF* udf, FunctionContext* ctx, size_t count, TOutput* out,
   return Status::OK();
 }
 
+/**
+ * This is the inner wrapper for UDFs that implement ExecBatch. It wraps the inputs and the output
+ * in column views and calls ExecBatch once for the whole batch.
+ *
+ * @return Status of execution.
+ */
+template <typename TUDF, typename TOutput, std::size_t... I>
+Status ExecBatchWrapper(TUDF* udf, FunctionContext* ctx, size_t count, TOutput* out,
+                        const std::vector<const types::BaseValueType*>& args,
+                        std::index_sequence<I...>) {
+  [[maybe_unused]] constexpr auto exec_argument_types = ScalarUDFTraits<TUDF>::ExecArguments();
+  OutputColumn<TOutput> out_column(out, count);
+  return udf->ExecBatch(
+      ctx,
+      ColumnView<typename types::DataTypeTraits<exec_argument_types[I]>::value_type>(
+          CastToUDFValueType<exec_argument_types[I]>(args[I]), count)...,
+      &out_column);
+}
+
 template <typename TUDF, std::size_t... I>
 Status InitWrapper(TUDF* udf, FunctionContext* ctx,
                    const std::vector<std::shared_ptr<types::BaseValueType>>& args,
@@ -179,6 +198,8 @@ struct ScalarUDFWrapper {
    * type will result in a crash!
    *
    * @note This function and underlying templates are fully expanded at compile time.
+   * The arrow inputs aren't stored as UDF values, so Exec is called for each record even if the
+   * UDF implements ExecBatch.
    *
    * @param udf a pointer to the UDF.
    * @param ctx The function context.
@@ -215,6 +236,8 @@ struct ScalarUDFWrapper {
    * type. This function is unsafe and will perform unsafe casts and using an incorrect
    * type will result in a crash!
    *
+   * The UDF's ExecBatch is used if it has one, otherwise Exec is called for each record.
+   *
    * @note This function and underlying templates are fully expanded at compile time.
    *
    * @param udf a pointer to the UDF.
@@ -242,9 +265,15 @@ struct ScalarUDFWrapper {
     // The outer wrapper just casts the output type and UDF type. We then pass in
     // the inputs with a sequence based on the number of arguments to iterate through and
     // cast the inputs.
-    return ExecWrapper<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output,
-                             input_as_base_value,
-                             std::make_index_sequence<exec_argument_types.size()>{});
+    if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+      return ExecBatchWrapper<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output,
+                                    input_as_base_value,
+                                    std::make_index_sequence<exec_argument_types.size()>{});
+    } else {
+      return ExecWrapper<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output,
+                               input_as_base_value,
+                               std::make_index_sequence<exec_argument_types.size()>{});
+    }
   }
 
   /**
@@ -20,6 +20,7 @@
 
 #include <cstring>
 #include <string>
+#include <type_traits>
 #include <utility>
 
 #include "src/common/base/logging.h"
@@ -188,6 +189,64 @@ TFloatType BEndianBytesToFloat(std::string_view buf) {
   return ReverseBytes<TFloatType>(ptr);
 }
 
+namespace internal {
+
+template <typename T>
+T ByteSwap(T x) {
+  using U = std::make_unsigned_t<T>;
+  auto u = static_cast<U>(x);
+  if constexpr (sizeof(T) == 8) {
+    u = __builtin_bswap64(u);
+  } else if constexpr (sizeof(T) == 4) {
+    u = __builtin_bswap32(u);
+  } else if constexpr (sizeof(T) == 2) {
+    // Spelled out, since GCC doesn't vectorize loops of __builtin_bswap16.
+    u = static_cast<U>((u >> 8) | (u << 8));
+  }
+  return static_cast<T>(u);
+}
+
+template <typename T, bool TBigEndian>
+void BytesToIntArray(const char* src, size_t n, T* dst) {
+  static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>,
+                "Only builtin integer types are supported; use the scalar functions for others.");
+  // A fixed size memcpy and a byte swap per value, rather than assembling each value byte by byte,
+  // lets the compiler turn the whole loop into vector loads and shuffles.
+  for (size_t i = 0; i < n; ++i) {
+    T val;
+    std::memcpy(&val, src + i * sizeof(T), sizeof(T));
+    if constexpr (TBigEndian == (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)) {
+      val = ByteSwap(val);
+    }
+    dst[i] = val;
+  }
+}
+
+}  // namespace internal
+
+/**
+ * Convert n consecutive big-endian ints to host order, as if by calling BEndianBytesToInt<T> on
+ * each sizeof(T) bytes of src.
+ *
+ * @tparam T The receiver int type, which must be a builtin integer type.
+ * @param src The sequence of bytes, which must hold at least n * sizeof(T) bytes.
+ * @param n The number of ints to convert.
+ * @param dst The destination array of n ints.
+ */
+template <typename T>
+void BEndianBytesToIntArray(const char* src, size_t n, T* dst) {
+  internal::BytesToIntArray<T, /*TBigEndian*/ true>(src, n, dst);
+}
+
+/**
+ * Convert n consecutive little-endian ints to host order, as if by calling LEndianBytesToInt<T> on
+ * each sizeof(T) bytes of src. See BEndianBytesToIntArray.
+ */
+template <typename T>
+void LEndianBytesToIntArray(const char* src, size_t n, T* dst) {
+  internal::BytesToIntArray<T, /*TBigEndian*/ false>(src, n, dst);
+}
+
 template <typename TValueType>
 TValueType MemCpy(const void* buf) {
   TValueType tmp;
@@ -270,6 +270,39 @@ TEST(UtilsTest, TestBEndianBytesToFloatUnAligned) {
   EXPECT_DOUBLE_EQ(BEndianBytesToFloat<double>(unaligned_double_bytes), 10.2);
 }
 
+TEST(UtilsTest, TestBytesToIntArray) {
+  // Starts at an odd offset, to check unaligned input.
+  constexpr char kBytes[] = "\xff\x01\x02\x03\x04\x05\x06\x07\x08\xfe\xfd\xfc\xfb\xfa\xf9\xf8\xf7";
+  const char* src = kBytes + 1;
+
+  {
+    int32_t vals[4];
+    BEndianBytesToIntArray<int32_t>(src, 4, vals);
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_EQ(vals[i], BEndianBytesToInt<int32_t>(std::string_view(src + 4 * i, 4)));
+    }
+    EXPECT_EQ(vals[0], 0x01020304);
+    LEndianBytesToIntArray<int32_t>(src, 4, vals);
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_EQ(vals[i], LEndianBytesToInt<int32_t>(std::string_view(src + 4 * i, 4)));
+    }
+    EXPECT_EQ(vals[0], 0x04030201);
+  }
+  {
+    uint64_t vals[2];
+    BEndianBytesToIntArray<uint64_t>(src, 2, vals);
+    EXPECT_EQ(vals[0], 0x0102030405060708);
+    EXPECT_EQ(vals[1], 0xfefdfcfbfaf9f8f7);
+  }
+  {
+    int16_t vals[3];
+    BEndianBytesToIntArray<int16_t>(src + 8, 3, vals);
+    EXPECT_EQ(vals[0], -259);
+    EXPECT_EQ(vals[1], -773);
+    EXPECT_EQ(vals[2], -1287);
+  }
+}
+
 TEST(UtilsTest, MemCpy) {
   constexpr char kCharArr[] = {'\x01', '\x02', '\x03', '\x04', '\x05', '\x00'};
   constexpr uint8_t kUint8Arr[] = {'\x01', '\x02', '\x03', '\x04', '\x05', '\x00'};
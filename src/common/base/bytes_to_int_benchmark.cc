@@ -18,6 +18,9 @@
 
 #include <benchmark/benchmark.h>
 
+#include <string>
+#include <vector>
+
 #include "src/common/base/base.h"
 
 // This benchmark measures the performance of various ways of converting byte strings into
@@ -184,6 +187,38 @@ static void BM_ByteLoopN(benchmark::State& state) {
   }
 }
 
+// The bulk benchmarks convert state.range(0) consecutive ints, as binary protocol parsers do for
+// arrays, either one at a time or with a single call to BEndianBytesToIntArray.
+template <typename T>
+// NOLINTNEXTLINE : runtime/references.
+static void BM_BEndianBytesToIntLoop(benchmark::State& state) {
+  const size_t n = state.range(0);
+  const std::string buf = InitBytes(n * sizeof(T));
+  std::vector<T> out(n);
+  for (auto _ : state) {
+    std::string_view remaining = buf;
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = px::utils::BEndianBytesToInt<T>(remaining);
+      remaining.remove_prefix(sizeof(T));
+    }
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename T>
+// NOLINTNEXTLINE : runtime/references.
+static void BM_BEndianBytesToIntArray(benchmark::State& state) {
+  const size_t n = state.range(0);
+  const std::string buf = InitBytes(n * sizeof(T));
+  std::vector<T> out(n);
+  for (auto _ : state) {
+    px::utils::BEndianBytesToIntArray<T>(buf.data(), n, out.data());
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
 // BM_MemCopy is provided as a reference as an upper bound.
 // It is not functionally correct on big-endian machines.
 BENCHMARK_TEMPLATE(BM_MemCopy, uint64_t);
@@ -220,3 +255,10 @@ BENCHMARK_TEMPLATE(BM_ByteLoop, uint32_t);
 BENCHMARK_TEMPLATE(BM_ByteLoop, uint32_t, 3);
 BENCHMARK_TEMPLATE(BM_ByteLoop, uint16_t);
 BENCHMARK_TEMPLATE(BM_ByteLoop, uint8_t);
+
+BENCHMARK_TEMPLATE(BM_BEndianBytesToIntLoop, uint64_t)->Range(8, 4096);
+BENCHMARK_TEMPLATE(BM_BEndianBytesToIntLoop, uint32_t)->Range(8, 4096);
+BENCHMARK_TEMPLATE(BM_BEndianBytesToIntLoop, uint16_t)->Range(8, 4096);
+BENCHMARK_TEMPLATE(BM_BEndianBytesToIntArray, uint64_t)->Range(8, 4096);
+BENCHMARK_TEMPLATE(BM_BEndianBytesToIntArray, uint32_t)->Range(8, 4096);
+BENCHMARK_TEMPLATE(BM_BEndianBytesToIntArray, uint16_t)->Range(8, 4096);
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <list>
+#include <utility>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/logging.h"
+#include "src/common/base/mixins.h"
+
+namespace px {
+
+/**
+ * LRUCache is a bounded map that evicts the least recently used entry once it's full.
+ * It's not thread-safe, it's meant to be owned by a single user (e.g. a UDF instance).
+ */
+template <typename TKey, typename TValue>
+class LRUCache : public NotCopyable {
+ public:
+  explicit LRUCache(size_t capacity) : capacity_(capacity) { DCHECK_GT(capacity_, 0U); }
+
+  /**
+   * Returns the value of the key and marks it as the most recently used, or nullptr if the key
+   * isn't cached. The pointer is valid until the next Put.
+   */
+  const TValue* Get(const TKey& key) {
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+      return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return &it->second->second;
+  }
+
+  /**
+   * Inserts or replaces the value of the key, evicting the least recently used entry if the cache
+   * is full.
+   */
+  void Put(const TKey& key, TValue value) {
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      it->second->second = std::move(value);
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return;
+    }
+    if (entries_.size() >= capacity_) {
+      index_.erase(entries_.back().first);
+      entries_.pop_back();
+    }
+    entries_.emplace_front(key, std::move(value));
+    index_.emplace(key, entries_.begin());
+  }
+
+  size_t size() const { return entries_.size(); }
+  size_t capacity() const { return capacity_; }
+
+ private:
+  using Entry = std::pair<TKey, TValue>;
+
+  size_t capacity_;
+  // Ordered from the most to the least recently used.
+  std::list<Entry> entries_;
+  absl::flat_hash_map<TKey, typename std::list<Entry>::iterator> index_;
+};
+
+}  // namespace px
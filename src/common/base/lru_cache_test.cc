@@ -0,0 +1,61 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "src/common/base/lru_cache.h"
+
+namespace px {
+
+TEST(LRUCacheTest, GetAndPut) {
+  LRUCache<std::string, int> cache(2);
+  EXPECT_EQ(cache.Get("a"), nullptr);
+  cache.Put("a", 1);
+  cache.Put("b", 2);
+  ASSERT_NE(cache.Get("a"), nullptr);
+  EXPECT_EQ(*cache.Get("a"), 1);
+  EXPECT_EQ(*cache.Get("b"), 2);
+
+  cache.Put("b", 3);
+  EXPECT_EQ(*cache.Get("b"), 3);
+  EXPECT_EQ(cache.size(), 2U);
+}
+
+TEST(LRUCacheTest, EvictsLeastRecentlyUsed) {
+  LRUCache<std::string, int> cache(2);
+  cache.Put("a", 1);
+  cache.Put("b", 2);
+  // Using a makes b the least recently used entry.
+  cache.Get("a");
+  cache.Put("c", 3);
+  EXPECT_EQ(cache.size(), 2U);
+  EXPECT_EQ(cache.Get("b"), nullptr);
+  EXPECT_EQ(*cache.Get("a"), 1);
+  EXPECT_EQ(*cache.Get("c"), 3);
+
+  // Replacing a value also counts as a use.
+  cache.Put("a", 4);
+  cache.Put("d", 5);
+  EXPECT_EQ(cache.Get("c"), nullptr);
+  EXPECT_EQ(*cache.Get("a"), 4);
+  EXPECT_EQ(*cache.Get("d"), 5);
+}
+
+}  // namespace px
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <absl/strings/str_cat.h>
+
+#include "src/common/base/mixins.h"
+
+namespace px {
+
+/**
+ * StrBuilder appends formatted pieces into a single buffer that keeps its capacity across
+ * Take()/Clear(), so that a builder reused for every record of a batch stops allocating once it
+ * has grown to the size of the largest record. It's not thread-safe.
+ */
+class StrBuilder : public NotCopyable {
+ public:
+  StrBuilder() = default;
+  explicit StrBuilder(size_t capacity) { buf_.reserve(capacity); }
+
+  /**
+   * Appends the arguments, accepting everything absl::StrAppend() does.
+   */
+  template <typename... Args>
+  StrBuilder& Append(const Args&... args) {
+    absl::StrAppend(&buf_, args...);
+    return *this;
+  }
+
+  StrBuilder& AppendChar(char c) {
+    buf_.push_back(c);
+    return *this;
+  }
+
+  /**
+   * Appends the elements of the range separated by sep. The formatter is called as
+   * formatter(StrBuilder*, element) and appends the element to the builder.
+   */
+  template <typename TRange, typename TFormatter>
+  StrBuilder& AppendJoin(const TRange& range, std::string_view sep, TFormatter&& formatter) {
+    bool first = true;
+    for (const auto& e : range) {
+      if (!first) {
+        buf_.append(sep);
+      }
+      first = false;
+      formatter(this, e);
+    }
+    return *this;
+  }
+
+  template <typename TRange>
+  StrBuilder& AppendJoin(const TRange& range, std::string_view sep) {
+    return AppendJoin(range, sep, [](StrBuilder* sb, const auto& e) { sb->Append(e); });
+  }
+
+  std::string_view view() const { return buf_; }
+  size_t size() const { return buf_.size(); }
+  bool empty() const { return buf_.empty(); }
+  size_t capacity() const { return buf_.capacity(); }
+
+  /**
+   * Drops the content but keeps the allocated buffer.
+   */
+  void Clear() { buf_.clear(); }
+
+  /**
+   * Returns a right-sized copy of the content and clears the builder, keeping its buffer for the
+   * next string.
+   */
+  std::string Take() {
+    std::string out(buf_);
+    buf_.clear();
+    return out;
+  }
+
+  /**
+   * Moves the buffer out. Use this for one-shot builders, where there's no buffer to keep.
+   */
+  std::string Release() { return std::move(buf_); }
+
+ private:
+  std::string buf_;
+};
+
+}  // namespace px
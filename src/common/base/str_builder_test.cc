@@ -0,0 +1,60 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "src/common/base/str_builder.h"
+
+namespace px {
+
+TEST(StrBuilderTest, AppendAndJoin) {
+  StrBuilder sb;
+  sb.Append("a=", 1, " b=", 2.5).AppendChar(' ');
+  std::vector<int> v = {1, 2, 3};
+  sb.AppendJoin(v, ",");
+  sb.Append(" [");
+  sb.AppendJoin(v, "] [", [](StrBuilder* out, int i) { out->Append("x", i); });
+  sb.Append("]");
+  EXPECT_EQ(sb.view(), "a=1 b=2.5 1,2,3 [x1] [x2] [x3]");
+}
+
+TEST(StrBuilderTest, TakeKeepsCapacity) {
+  StrBuilder sb;
+  sb.Append(std::string(100, 'a'));
+  size_t capacity = sb.capacity();
+
+  EXPECT_EQ(sb.Take(), std::string(100, 'a'));
+  EXPECT_TRUE(sb.empty());
+  EXPECT_EQ(sb.capacity(), capacity);
+
+  sb.Append("b");
+  std::string out = sb.Take();
+  EXPECT_EQ(out, "b");
+  EXPECT_EQ(sb.capacity(), capacity);
+}
+
+TEST(StrBuilderTest, Release) {
+  StrBuilder sb(16);
+  sb.Append("abc");
+  EXPECT_EQ(sb.Release(), "abc");
+}
+
+}  // namespace px
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/base/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace px {
+
+ThreadPool::ThreadPool(size_t num_threads) {
+  workers_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(&ThreadPool::WorkerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::Schedule(std::function<void()> fn) {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    tasks_.push_back(std::move(fn));
+  }
+  cv_.notify_one();
+}
+
+void ThreadPool::WorkerLoop() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(lock_);
+      cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        // Only reached when stopping, after the remaining tasks were drained.
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+void ThreadPool::ParallelFor(size_t n, const std::function<void(size_t)>& fn) {
+  if (n == 0) {
+    return;
+  }
+  if (workers_.empty() || n == 1) {
+    for (size_t i = 0; i < n; ++i) {
+      fn(i);
+    }
+    return;
+  }
+
+  // Indices are claimed dynamically, so uneven tasks are balanced across threads. Completion is
+  // tracked per index rather than per helper: a helper that only gets to run after all indices
+  // were claimed returns immediately, so waiting never depends on a free worker.
+  struct SharedState {
+    std::atomic<size_t> next = 0;
+    std::mutex lock;
+    std::condition_variable cv;
+    size_t done = 0;
+  };
+  auto state = std::make_shared<SharedState>();
+  auto run = [state, n, &fn]() {
+    size_t num_done = 0;
+    for (size_t i = state->next++; i < n; i = state->next++) {
+      fn(i);
+      ++num_done;
+    }
+    if (num_done == 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(state->lock);
+    state->done += num_done;
+    if (state->done == n) {
+      state->cv.notify_all();
+    }
+  };
+
+  size_t num_helpers = std::min(workers_.size(), n - 1);
+  for (size_t i = 0; i < num_helpers; ++i) {
+    Schedule(run);
+  }
+  run();
+
+  std::unique_lock<std::mutex> lock(state->lock);
+  state->cv.wait(lock, [&state, n] { return state->done == n; });
+}
+
+}  // namespace px
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "src/common/base/mixins.h"
+
+namespace px {
+
+/**
+ * A fixed-size pool of worker threads that execute scheduled tasks in FIFO order.
+ *
+ * The pool is intended for fork-join style parallelism inside a single component (e.g. a query
+ * operator): tasks are scheduled with ParallelFor(), which blocks until all of them completed.
+ */
+class ThreadPool : public NotCopyMoveable {
+ public:
+  /**
+   * Creates a pool with the given number of worker threads. A pool with zero threads is valid,
+   * in which case all work runs on the calling thread.
+   */
+  explicit ThreadPool(size_t num_threads);
+  ~ThreadPool();
+
+  /**
+   * Schedules fn to run on one of the worker threads.
+   */
+  void Schedule(std::function<void()> fn);
+
+  /**
+   * Runs fn(i) for every i in [0, n) and waits until all invocations returned.
+   * The calling thread participates in the work, so this never deadlocks even if every worker of
+   * the pool is busy.
+   */
+  void ParallelFor(size_t n, const std::function<void(size_t)>& fn);
+
+  size_t num_threads() const { return workers_.size(); }
+
+ private:
+  void WorkerLoop();
+
+  std::mutex lock_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  bool stopping_ = false;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace px
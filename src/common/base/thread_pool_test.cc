@@ -0,0 +1,62 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+#include "src/common/base/thread_pool.h"
+
+namespace px {
+
+TEST(ThreadPoolTest, ParallelForVisitsEveryIndexOnce) {
+  ThreadPool pool(4);
+  std::vector<std::atomic<int>> visits(1000);
+  pool.ParallelFor(visits.size(), [&](size_t i) { ++visits[i]; });
+  for (const auto& v : visits) {
+    EXPECT_EQ(v, 1);
+  }
+}
+
+TEST(ThreadPoolTest, NoWorkers) {
+  ThreadPool pool(0);
+  int sum = 0;
+  pool.ParallelFor(10, [&](size_t i) { sum += i; });
+  EXPECT_EQ(sum, 45);
+}
+
+TEST(ThreadPoolTest, ScheduleRunsBeforeDestruction) {
+  std::atomic<int> count = 0;
+  {
+    ThreadPool pool(2);
+    for (int i = 0; i < 100; ++i) {
+      pool.Schedule([&] { ++count; });
+    }
+  }
+  EXPECT_EQ(count, 100);
+}
+
+TEST(ThreadPoolTest, NestedParallelFor) {
+  ThreadPool pool(2);
+  std::atomic<int> count = 0;
+  pool.ParallelFor(4, [&](size_t) { pool.ParallelFor(4, [&](size_t) { ++count; }); });
+  EXPECT_EQ(count, 16);
+}
+
+}  // namespace px
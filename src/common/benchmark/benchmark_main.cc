@@ -18,6 +18,7 @@
 
 #include "benchmark/benchmark.h"
 #include "src/common/base/base.h"
+#include "src/common/benchmark/memory_manager.h"
 
 int main(int argc, char** argv) {
   // Initialize must come before env_guard otherwise the arguments are not declared and env_guard
@@ -25,6 +26,10 @@ int main(int argc, char** argv) {
   // consumed but doesn't affect other arguments.
   benchmark::Initialize(&argc, argv);
   px::EnvironmentGuard env_guard(&argc, argv);
+  // Adds allocation counters (allocs_per_iter, max_bytes_used, ...) to every benchmark result.
+  px::BenchmarkMemoryManager memory_manager;
+  benchmark::RegisterMemoryManager(&memory_manager);
   benchmark::RunSpecifiedBenchmarks();
+  benchmark::RegisterMemoryManager(nullptr);
   return 0;
 }
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/benchmark/memory_manager.h"
+
+#include <atomic>
+
+#ifdef TCMALLOC
+#include <gperftools/malloc_hook.h>
+#endif
+
+namespace px {
+
+namespace {
+
+std::atomic<int64_t> num_allocs{0};
+std::atomic<int64_t> allocated_bytes{0};
+
+#ifdef TCMALLOC
+void CountNew(const void* /*ptr*/, size_t size) {
+  num_allocs.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+}
+#endif
+
+}  // namespace
+
+void BenchmarkMemoryManager::Start() {
+  num_allocs = 0;
+  allocated_bytes = 0;
+  tracker_.Start();
+#ifdef TCMALLOC
+  MallocHook::AddNewHook(&CountNew);
+#endif
+}
+
+void BenchmarkMemoryManager::Stop(Result& result) {
+#ifdef TCMALLOC
+  MallocHook::RemoveNewHook(&CountNew);
+#endif
+  MemoryStats stats = tracker_.End();
+  auto delta = [](uint64_t to, uint64_t from) {
+    return static_cast<int64_t>(to) - static_cast<int64_t>(from);
+  };
+  result.num_allocs = num_allocs.load();
+  result.total_allocated_bytes = allocated_bytes.load();
+  result.max_bytes_used = delta(stats.max.allocated, stats.start.allocated);
+  result.net_heap_growth = delta(stats.end.allocated, stats.start.allocated);
+}
+
+}  // namespace px
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include "src/common/perf/memory_tracker.h"
+
+namespace px {
+
+/**
+ * BenchmarkMemoryManager reports allocation counters for every benchmark into the benchmark output
+ * (and thus the JSON written with --benchmark_out). Peak and net heap usage come from
+ * MemoryTracker; the number of allocations and the total bytes allocated are counted with
+ * tcmalloc's new hook. All counters are zero when not running with tcmalloc.
+ *
+ * Google benchmark runs the memory manager on a separate run after the timed runs, so the
+ * hooks don't perturb the reported timings.
+ */
+class BenchmarkMemoryManager : public ::benchmark::MemoryManager {
+ public:
+  BenchmarkMemoryManager() : tracker_(/*enable*/ true) {}
+
+  void Start() override;
+  void Stop(Result& result) override;
+  void Stop(Result* result) override { Stop(*result); }
+
+ private:
+  MemoryTracker tracker_;
+};
+
+}  // namespace px
@@ -17,7 +17,11 @@
  */
 #pragma once
 
-#include <deque>
+#include <absl/types/span.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <utility>
 #include "absl/base/internal/spinlock.h"
 
@@ -30,73 +34,169 @@ namespace clock {
  * InterpolatingLookupTable stores sorted key,value pairs in a circular buffer.
  * When accessing the map, if the key is not in the map, the closest key,value pairs are
  * interpolated to get a corresponding value.
+ *
+ * Lookups don't take a lock: the buffer is guarded by a sequence lock, so readers retry in the rare
+ * case they overlap with an Emplace(). Writers are serialized with a spinlock.
  */
 template <size_t TCapacity>
 class InterpolatingLookupTable {
   // The Map stores a mapping from key to offset (i.e from key to (value - key))
   using MapPairType = std::pair<uint64_t, int64_t>;
-  using CircularMap = std::deque<MapPairType>;
+  // The buffer holds up to TCapacity points plus the one being added.
+  static constexpr size_t kNumSlots = TCapacity + 1;
 
  public:
   void Emplace(uint64_t key, uint64_t val) {
-    absl::base_internal::SpinLockHolder lock(&buffer_lock_);
-    if (buffer_.size() > TCapacity) {
-      buffer_.pop_front();
+    absl::base_internal::SpinLockHolder lock(&write_lock_);
+    size_t head = head_.load(std::memory_order_relaxed);
+    size_t size = size_.load(std::memory_order_relaxed);
+
+    // Mark the buffer as being modified (odd sequence number), see Read(). The release stores
+    // below keep this store ordered before them.
+    uint64_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+
+    if (size == kNumSlots) {
+      head = (head + 1) % kNumSlots;
+      --size;
     }
-    buffer_.push_back(std::make_pair(key, static_cast<int64_t>(val) - key));
+    size_t slot = (head + size) % kNumSlots;
+    keys_[slot].store(key, std::memory_order_release);
+    offsets_[slot].store(static_cast<int64_t>(val) - key, std::memory_order_release);
+    head_.store(head, std::memory_order_release);
+    size_.store(size + 1, std::memory_order_release);
+
+    seq_.store(seq + 2, std::memory_order_release);
   }
 
   uint64_t Get(uint64_t key) const {
-    {
-      absl::base_internal::SpinLockHolder lock(&buffer_lock_);
-      if (buffer_.size() == 0) {
-        return key;
+    auto [segment, size] = Read([&]() {
+      const size_t head = head_.load(std::memory_order_acquire);
+      const size_t size = size_.load(std::memory_order_acquire);
+      auto point = [&](size_t i) { return PointAt(head, i); };
+      // Binary search for the first point with point.first >= key.
+      size_t lo = 0;
+      size_t hi = size;
+      while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (point(mid).first < key) {
+          lo = mid + 1;
+        } else {
+          hi = mid;
+        }
+      }
+      return std::make_pair(size == 0 ? Segment{} : InterpolationSegment(point, size, lo, key),
+                            size);
+    });
+    if (size == 0) {
+      return key;
+    }
+    return Interpolate(key, segment);
+  }
+
+  /**
+   * Looks up a batch of keys, writing the results to vals (which may alias keys). The table is read
+   * once for the whole batch, and for sorted keys the interpolation points are found with a single
+   * linear walk. Unsorted keys are supported, but slower.
+   */
+  void GetBatch(absl::Span<const uint64_t> keys, absl::Span<uint64_t> vals) const {
+    DCHECK_EQ(keys.size(), vals.size());
+    std::array<MapPairType, kNumSlots> points;
+    const size_t size = Read([&]() {
+      const size_t head = head_.load(std::memory_order_acquire);
+      const size_t size = size_.load(std::memory_order_acquire);
+      for (size_t i = 0; i < size; ++i) {
+        points[i] = PointAt(head, i);
       }
+      return size;
+    });
+    if (size == 0) {
+      std::copy(keys.begin(), keys.end(), vals.begin());
+      return;
     }
 
-    MapPairType a;
-    MapPairType b;
-    auto found_two_points = GetLeftRightInterpolationPoints(key, &a, &b);
-    if (!found_two_points) {
-      // If we are before or after the history we have stored we just use the closest offset we can.
-      return key + a.second;
+    auto point = [&](size_t i) { return points[i]; };
+    size_t it = 0;
+    uint64_t prev_key = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+      uint64_t key = keys[i];
+      if (key < prev_key) {
+        // Out of order, restart the walk.
+        it = 0;
+      }
+      while (it < size && points[it].first < key) {
+        ++it;
+      }
+      prev_key = key;
+      vals[i] = Interpolate(key, InterpolationSegment(point, size, it, key));
     }
-    return key + LinearInterpolate(a.first, b.first, a.second, b.second, key);
   }
 
-  size_t size() const {
-    absl::base_internal::SpinLockHolder lock(&buffer_lock_);
-    return buffer_.size();
-  }
+  size_t size() const { return size_.load(std::memory_order_relaxed); }
 
  private:
-  mutable absl::base_internal::SpinLock buffer_lock_;
-  CircularMap buffer_ ABSL_GUARDED_BY(buffer_lock_);
-
-  bool GetLeftRightInterpolationPoints(uint64_t key, MapPairType* left, MapPairType* right) const {
-    absl::base_internal::SpinLockHolder lock(&buffer_lock_);
-    if (buffer_.size() == 1) {
-      *left = *buffer_.begin();
-      return false;
+  // The points to interpolate between. If right is not set, the offset of left is used as is.
+  struct Segment {
+    MapPairType left;
+    MapPairType right;
+    bool has_right = false;
+  };
+
+  MapPairType PointAt(size_t head, size_t i) const {
+    size_t slot = (head + i) % kNumSlots;
+    return {keys_[slot].load(std::memory_order_acquire),
+            offsets_[slot].load(std::memory_order_acquire)};
+  }
+
+  // Returns the segment for key, given the index of the first point with point.first >= key.
+  template <typename TPointFn>
+  static Segment InterpolationSegment(TPointFn point, size_t size, size_t it, uint64_t key) {
+    if (size == 1) {
+      return {point(0)};
     }
-    auto cmp = [](MapPairType a, uint64_t b) { return a.first < b; };
-    auto it = std::lower_bound(buffer_.begin(), buffer_.end(), key, cmp);
-    if (it == buffer_.end()) {
-      *left = *std::prev(buffer_.end());
-      return false;
+    // If we are before or after the history we have stored we just use the closest offset we can.
+    if (it == size) {
+      return {point(size - 1)};
     }
-    if (it == buffer_.begin()) {
-      *left = *buffer_.begin();
-      return false;
+    MapPairType right = point(it);
+    if (it == 0 || right.first == key) {
+      return {right};
     }
-    if (it->first == key) {
-      *left = *it;
-      return false;
+    return {point(it - 1), right, true};
+  }
+
+  static uint64_t Interpolate(uint64_t key, const Segment& s) {
+    if (!s.has_right) {
+      return key + s.left.second;
     }
-    *left = *std::prev(it);
-    *right = *it;
-    return true;
+    return key + LinearInterpolate(s.left.first, s.right.first, s.left.second, s.right.second, key);
   }
+
+  // Runs the read function until it ran without overlapping an Emplace(). The read function can
+  // see torn state, so it must only copy data out; its result is used once it has been validated.
+  // The read function must load with acquire semantics, which keeps the loads ordered before the
+  // final check of the sequence number. This is free on x86, and unlike fences supported by TSAN.
+  template <typename TReadFn>
+  auto Read(TReadFn read_fn) const {
+    while (true) {
+      uint64_t seq = seq_.load(std::memory_order_acquire);
+      if (seq & 1) {
+        continue;
+      }
+      auto result = read_fn();
+      if (seq_.load(std::memory_order_relaxed) == seq) {
+        return result;
+      }
+    }
+  }
+
+  absl::base_internal::SpinLock write_lock_;
+  std::atomic<uint64_t> seq_ = 0;
+  // Index of the oldest point in the circular buffer, and the number of points.
+  std::atomic<size_t> head_ = 0;
+  std::atomic<size_t> size_ = 0;
+  std::array<std::atomic<uint64_t>, kNumSlots> keys_ = {};
+  std::array<std::atomic<int64_t>, kNumSlots> offsets_ = {};
 };
 
 }  // namespace clock
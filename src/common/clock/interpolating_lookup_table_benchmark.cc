@@ -18,6 +18,8 @@
 
 #include <benchmark/benchmark.h>
 
+#include <vector>
+
 #include "src/common/clock/clock_conversion.h"
 
 namespace {
@@ -58,8 +60,52 @@ void BM_InterpolatingLookupTableEmplace(benchmark::State& state) {
   }
 }
 
+// Converts a sorted batch of keys spread over the whole table, one Get() per key.
+// NOLINTNEXTLINE : runtime/references.
+void BM_InterpolatingLookupTableGetLoop(benchmark::State& state) {
+  constexpr size_t capacity =
+      ClockConverter::BufferCapacity(DefaultMonoToRealtimeConverter::kUpdatePeriod);
+  uint64_t base_val = 1640000000271885073;
+  auto table = InitTable<capacity>(base_val);
+  std::vector<uint64_t> keys(state.range(0));
+  for (size_t i = 0; i < keys.size(); ++i) {
+    keys[i] = base_val + 100 * capacity * i / keys.size();
+  }
+  std::vector<uint64_t> vals(keys.size());
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < keys.size(); ++i) {
+      vals[i] = table->Get(keys[i]);
+    }
+    benchmark::DoNotOptimize(vals.data());
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+// Same as above, with a single GetBatch().
+// NOLINTNEXTLINE : runtime/references.
+void BM_InterpolatingLookupTableGetBatch(benchmark::State& state) {
+  constexpr size_t capacity =
+      ClockConverter::BufferCapacity(DefaultMonoToRealtimeConverter::kUpdatePeriod);
+  uint64_t base_val = 1640000000271885073;
+  auto table = InitTable<capacity>(base_val);
+  std::vector<uint64_t> keys(state.range(0));
+  for (size_t i = 0; i < keys.size(); ++i) {
+    keys[i] = base_val + 100 * capacity * i / keys.size();
+  }
+  std::vector<uint64_t> vals(keys.size());
+
+  for (auto _ : state) {
+    table->GetBatch(keys, absl::MakeSpan(vals));
+    benchmark::DoNotOptimize(vals.data());
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
 BENCHMARK(BM_InterpolatingLookupTableGet);
 BENCHMARK(BM_InterpolatingLookupTableEmplace);
+BENCHMARK(BM_InterpolatingLookupTableGetLoop)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BM_InterpolatingLookupTableGetBatch)->RangeMultiplier(8)->Range(8, 4096);
 
 }  // namespace clock
 }  // namespace px
@@ -16,6 +16,10 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include "src/common/testing/testing.h"
 
 #include "src/common/clock/clock_conversion.h"
@@ -86,5 +90,102 @@ TEST(InterpolatingLookupTable, mono_and_realtime) {
   EXPECT_EQ(offset, table.Get(query) - query);
 }
 
+TEST(InterpolatingLookupTable, get_batch_matches_get) {
+  InterpolatingLookupTable<64> table;
+
+  std::vector<uint64_t> keys = {0, 1, 2, 3, 50, 100, 150, 200, 250, 299, 300, 350};
+  std::vector<uint64_t> vals(keys.size());
+  // An empty table passes the keys through.
+  table.GetBatch(keys, absl::MakeSpan(vals));
+  EXPECT_EQ(vals, keys);
+
+  table.Emplace(0, 0);
+  table.Emplace(150, 200);
+  table.Emplace(250, 350);
+  table.Emplace(300, 300);
+
+  std::vector<uint64_t> expected;
+  for (uint64_t key : keys) {
+    expected.push_back(table.Get(key));
+  }
+  table.GetBatch(keys, absl::MakeSpan(vals));
+  EXPECT_EQ(vals, expected);
+
+  // Unsorted keys give the same results.
+  std::vector<uint64_t> unsorted_keys(keys.rbegin(), keys.rend());
+  std::vector<uint64_t> unsorted_expected(expected.rbegin(), expected.rend());
+  table.GetBatch(unsorted_keys, absl::MakeSpan(vals));
+  EXPECT_EQ(vals, unsorted_expected);
+
+  // In place.
+  table.GetBatch(keys, absl::MakeSpan(keys));
+  EXPECT_EQ(keys, expected);
+}
+
+TEST(InterpolatingLookupTable, wraps_around) {
+  InterpolatingLookupTable<4> table;
+  for (uint64_t i = 0; i < 10; ++i) {
+    table.Emplace(10 * i, 10 * i + i);
+  }
+  // The capacity, plus the point being added.
+  EXPECT_EQ(5, table.size());
+
+  // Only points 5 to 9 are left, so 15 uses the offset of point 5.
+  EXPECT_EQ(15 + 5, table.Get(15));
+  EXPECT_EQ(80 + 8, table.Get(80));
+  EXPECT_EQ(100 + 9, table.Get(100));
+
+  std::vector<uint64_t> keys = {15, 80, 100};
+  table.GetBatch(keys, absl::MakeSpan(keys));
+  EXPECT_THAT(keys, ::testing::ElementsAre(15 + 5, 80 + 8, 100 + 9));
+}
+
+// Readers must never see a half-written point. All points are on the line val = 2 * key, so a
+// lookup either interpolates to exactly 2 * key, or is outside the table and uses the offset of its
+// first or last point (a multiple of 100).
+TEST(InterpolatingLookupTable, concurrent_readers) {
+  InterpolatingLookupTable<8> table;
+  table.Emplace(0, 0);
+
+  constexpr uint64_t kNumPoints = 20000;
+  std::atomic<bool> done = false;
+  std::thread writer([&]() {
+    for (uint64_t i = 1; i < kNumPoints; ++i) {
+      table.Emplace(100 * i, 200 * i);
+    }
+    done = true;
+  });
+
+  auto check = [](uint64_t key, uint64_t val) {
+    uint64_t offset = val - key;
+    return offset == key || offset % 100 == 0;
+  };
+  std::vector<std::thread> readers;
+  std::atomic<int> num_bad = 0;
+  for (int r = 0; r < 2; ++r) {
+    readers.emplace_back([&]() {
+      std::vector<uint64_t> keys(16);
+      std::vector<uint64_t> vals(keys.size());
+      for (uint64_t j = 0; !done; j = (j + 7) % kNumPoints) {
+        uint64_t key = 100 * j + 37;
+        num_bad += !check(key, table.Get(key));
+
+        for (size_t k = 0; k < keys.size(); ++k) {
+          keys[k] = key + 100 * k;
+        }
+        table.GetBatch(keys, absl::MakeSpan(vals));
+        for (size_t k = 0; k < keys.size(); ++k) {
+          num_bad += !check(keys[k], vals[k]);
+        }
+      }
+    });
+  }
+  writer.join();
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(num_bad, 0);
+}
+
 }  // namespace clock
 }  // namespace px
@@ -22,6 +22,7 @@
 #include <functional>
 #include <memory>
 
+#include "src/common/base/base.h"
 #include "src/common/event/deferred_delete.h"
 #include "src/common/event/task.h"
 #include "src/common/event/time_system.h"
@@ -37,6 +38,12 @@ using PostCB = std::function<void()>;
 using PoolExecFunc = std::function<void()>;
 using PoolExecCompletionCB = std::function<void()>;
 
+/**
+ * Callback invoked on the dispatcher thread when an async file operation completes. Holds the
+ * number of bytes transferred, or the error.
+ */
+using FileIOCB = std::function<void(StatusOr<size_t>)>;
+
 /**
  * Dispatcher is the high level class for manging event dispatching (time sources, fs reads, etc.).
  */
@@ -104,6 +111,16 @@ class Dispatcher {
    */
   virtual RunnableAsyncTaskUPtr CreateAsyncTask(std::unique_ptr<AsyncTask> task) = 0;
 
+  /**
+   * Async file I/O. These are run with io_uring on kernels that support it (one submission syscall
+   * per loop iteration and no thread handoff), and on the libuv threadpool otherwise.
+   * The buffer must stay valid until the callback runs. Must be called from the dispatcher thread.
+   * An offset of -1 uses (and advances) the current file position.
+   */
+  virtual void ReadFile(int fd, void* buf, size_t len, int64_t offset, FileIOCB cb) = 0;
+  virtual void WriteFile(int fd, const void* buf, size_t len, int64_t offset, FileIOCB cb) = 0;
+  virtual void SyncFile(int fd, FileIOCB cb) = 0;
+
   /**
    * Returns a recently cached MonotonicTime value. Updates on every iteration of the event loop.
    */
@@ -0,0 +1,246 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/event/io_uring.h"
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace px {
+namespace event {
+
+namespace {
+
+int SysIOUringSetup(uint32_t entries, struct io_uring_params* p) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+}
+
+int SysIOUringEnter(int fd, uint32_t to_submit, uint32_t min_complete, uint32_t flags) {
+  return static_cast<int>(
+      syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int SysIOUringRegister(int fd, uint32_t opcode, void* arg, uint32_t nr_args) {
+  return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+template <typename T>
+T* RingPtr(void* ring, uint32_t offset) {
+  return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<IOUring>> IOUring::Create(uint32_t entries) {
+  std::unique_ptr<IOUring> ring(new IOUring());
+  PX_RETURN_IF_ERROR(ring->Init(entries));
+  return ring;
+}
+
+Status IOUring::Init(uint32_t entries) {
+  struct io_uring_params params = {};
+  ring_fd_ = SysIOUringSetup(entries, &params);
+  if (ring_fd_ < 0) {
+    return error::Unavailable("io_uring_setup failed: $0", std::strerror(errno));
+  }
+
+  // Make sure the kernel is recent enough to support the operations we use (5.6+).
+  constexpr uint8_t kRequiredOps[] = {IORING_OP_READ, IORING_OP_WRITE, IORING_OP_FSYNC};
+  std::vector<uint8_t> probe_buf(sizeof(struct io_uring_probe) +
+                                 IORING_OP_LAST * sizeof(struct io_uring_probe_op));
+  auto* probe = reinterpret_cast<struct io_uring_probe*>(probe_buf.data());
+  if (SysIOUringRegister(ring_fd_, IORING_REGISTER_PROBE, probe, IORING_OP_LAST) < 0) {
+    return error::Unavailable("io_uring probe failed: $0", std::strerror(errno));
+  }
+  for (uint8_t op : kRequiredOps) {
+    if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+      return error::Unavailable("io_uring doesn't support opcode $0", static_cast<int>(op));
+    }
+  }
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                  ring_fd_, IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    sq_ring_ = nullptr;
+    return error::Internal("Failed to mmap io_uring SQ ring: $0", std::strerror(errno));
+  }
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      cq_ring_ = nullptr;
+      return error::Internal("Failed to mmap io_uring CQ ring: $0", std::strerror(errno));
+    }
+  }
+  sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    ring_fd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    return error::Internal("Failed to mmap io_uring SQEs: $0", std::strerror(errno));
+  }
+  sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+  sq_head_ = RingPtr<std::atomic<uint32_t>>(sq_ring_, params.sq_off.head);
+  sq_tail_ = RingPtr<std::atomic<uint32_t>>(sq_ring_, params.sq_off.tail);
+  sq_mask_ = *RingPtr<uint32_t>(sq_ring_, params.sq_off.ring_mask);
+  sq_entries_ = *RingPtr<uint32_t>(sq_ring_, params.sq_off.ring_entries);
+  sq_array_ = RingPtr<uint32_t>(sq_ring_, params.sq_off.array);
+  cq_head_ = RingPtr<std::atomic<uint32_t>>(cq_ring_, params.cq_off.head);
+  cq_tail_ = RingPtr<std::atomic<uint32_t>>(cq_ring_, params.cq_off.tail);
+  cq_mask_ = *RingPtr<uint32_t>(cq_ring_, params.cq_off.ring_mask);
+  cqes_ = RingPtr<struct io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+
+  event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (event_fd_ < 0) {
+    return error::Internal("Failed to create eventfd: $0", std::strerror(errno));
+  }
+  if (SysIOUringRegister(ring_fd_, IORING_REGISTER_EVENTFD, &event_fd_, 1) < 0) {
+    return error::Internal("Failed to register io_uring eventfd: $0", std::strerror(errno));
+  }
+  return Status::OK();
+}
+
+IOUring::~IOUring() {
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  // Closing the ring makes the kernel cancel or finish any operation still in flight.
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+  }
+  if (event_fd_ >= 0) {
+    close(event_fd_);
+  }
+}
+
+struct io_uring_sqe* IOUring::NextSQE() {
+  // We are the only producer, so our own tail can be read relaxed. The head is advanced by the
+  // kernel as it consumes entries.
+  uint32_t tail = sq_tail_->load(std::memory_order_relaxed);
+  uint32_t head = sq_head_->load(std::memory_order_acquire);
+  if (tail - head >= sq_entries_) {
+    return nullptr;
+  }
+  uint32_t index = tail & sq_mask_;
+  struct io_uring_sqe* sqe = &sqes_[index];
+  std::memset(sqe, 0, sizeof(*sqe));
+  sq_array_[index] = index;
+  sq_tail_->store(tail + 1, std::memory_order_release);
+  ++num_queued_;
+  return sqe;
+}
+
+bool IOUring::QueueRead(int fd, void* buf, uint32_t len, int64_t offset, uint64_t user_data) {
+  struct io_uring_sqe* sqe = NextSQE();
+  if (sqe == nullptr) {
+    return false;
+  }
+  sqe->opcode = IORING_OP_READ;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(buf);
+  sqe->len = len;
+  sqe->off = static_cast<uint64_t>(offset);
+  sqe->user_data = user_data;
+  return true;
+}
+
+bool IOUring::QueueWrite(int fd, const void* buf, uint32_t len, int64_t offset,
+                         uint64_t user_data) {
+  struct io_uring_sqe* sqe = NextSQE();
+  if (sqe == nullptr) {
+    return false;
+  }
+  sqe->opcode = IORING_OP_WRITE;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(buf);
+  sqe->len = len;
+  sqe->off = static_cast<uint64_t>(offset);
+  sqe->user_data = user_data;
+  return true;
+}
+
+bool IOUring::QueueFsync(int fd, uint64_t user_data) {
+  struct io_uring_sqe* sqe = NextSQE();
+  if (sqe == nullptr) {
+    return false;
+  }
+  sqe->opcode = IORING_OP_FSYNC;
+  sqe->fd = fd;
+  sqe->user_data = user_data;
+  return true;
+}
+
+Status IOUring::Submit() {
+  while (num_queued_ > 0) {
+    int rc = SysIOUringEnter(ring_fd_, num_queued_, 0, 0);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // EAGAIN/EBUSY mean the kernel is out of resources for now; the entries stay queued.
+      return error::Unavailable("io_uring_enter failed: $0", std::strerror(errno));
+    }
+    num_queued_ -= std::min<uint32_t>(num_queued_, rc);
+  }
+  return Status::OK();
+}
+
+int IOUring::ReapCompletions(const CompletionFunc& fn) {
+  uint64_t counter;
+  // Clear the eventfd before reading the CQ, so completions that race with us re-arm it.
+  while (read(event_fd_, &counter, sizeof(counter)) > 0) {
+  }
+
+  int num_reaped = 0;
+  uint32_t head = cq_head_->load(std::memory_order_relaxed);
+  while (head != cq_tail_->load(std::memory_order_acquire)) {
+    const struct io_uring_cqe& cqe = cqes_[head & cq_mask_];
+    uint64_t user_data = cqe.user_data;
+    int32_t res = cqe.res;
+    ++head;
+    // Release the entry before the callback, which may queue more operations.
+    cq_head_->store(head, std::memory_order_release);
+    fn(user_data, res);
+    ++num_reaped;
+  }
+  return num_reaped;
+}
+
+}  // namespace event
+}  // namespace px
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <linux/io_uring.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace event {
+
+/**
+ * IOUring is a minimal wrapper around a Linux io_uring instance, talking to the kernel through the
+ * raw syscalls. Completions are signalled on event_fd(), so the ring can be driven from an existing
+ * event loop: queue operations, Submit() them (one syscall for the whole batch), and call
+ * ReapCompletions() when event_fd() becomes readable.
+ *
+ * Not thread-safe; all calls must come from the thread that owns the ring.
+ */
+class IOUring : public NotCopyable {
+ public:
+  using CompletionFunc = std::function<void(uint64_t user_data, int32_t res)>;
+
+  /**
+   * Sets up a ring with room for the given number of queued operations. Fails if the kernel
+   * doesn't support io_uring (or the file read/write/fsync operations), or if io_uring is blocked,
+   * e.g. by a seccomp profile.
+   */
+  static StatusOr<std::unique_ptr<IOUring>> Create(uint32_t entries);
+
+  ~IOUring();
+
+  /**
+   * Queue operations for the next Submit(). Return false if the submission queue is full, in which
+   * case the caller should Submit() and retry. The buffers must stay valid until the completion
+   * of the operation is reaped.
+   */
+  bool QueueRead(int fd, void* buf, uint32_t len, int64_t offset, uint64_t user_data);
+  bool QueueWrite(int fd, const void* buf, uint32_t len, int64_t offset, uint64_t user_data);
+  bool QueueFsync(int fd, uint64_t user_data);
+
+  /**
+   * Submits all queued operations to the kernel.
+   */
+  Status Submit();
+
+  /**
+   * Calls fn with the user_data and result (bytes transferred, or -errno) of every completed
+   * operation, and clears event_fd(). Returns the number of completions.
+   */
+  int ReapCompletions(const CompletionFunc& fn);
+
+  int event_fd() const { return event_fd_; }
+  uint32_t num_queued() const { return num_queued_; }
+
+ private:
+  IOUring() = default;
+
+  Status Init(uint32_t entries);
+  struct io_uring_sqe* NextSQE();
+
+  int ring_fd_ = -1;
+  int event_fd_ = -1;
+
+  void* sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  struct io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  // Pointers into the mmapped rings. The kernel updates sq_head_ and cq_tail_ concurrently.
+  std::atomic<uint32_t>* sq_head_ = nullptr;
+  std::atomic<uint32_t>* sq_tail_ = nullptr;
+  uint32_t sq_mask_ = 0;
+  uint32_t sq_entries_ = 0;
+  uint32_t* sq_array_ = nullptr;
+  std::atomic<uint32_t>* cq_head_ = nullptr;
+  std::atomic<uint32_t>* cq_tail_ = nullptr;
+  uint32_t cq_mask_ = 0;
+  struct io_uring_cqe* cqes_ = nullptr;
+
+  uint32_t num_queued_ = 0;
+};
+
+}  // namespace event
+}  // namespace px
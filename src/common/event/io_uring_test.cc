@@ -0,0 +1,114 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/event/io_uring.h"
+
+#include <poll.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace event {
+
+class IOUringTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    auto ring_or = IOUring::Create(4);
+    if (!ring_or.ok()) {
+      GTEST_SKIP() << ring_or.msg();
+    }
+    ring_ = ring_or.ConsumeValueOrDie();
+    file_ = std::tmpfile();
+    ASSERT_NE(file_, nullptr);
+  }
+
+  void TearDown() override {
+    if (file_ != nullptr) {
+      fclose(file_);
+    }
+  }
+
+  // Waits for the eventfd and reaps all completions into results_.
+  void WaitAndReap(size_t num_expected) {
+    while (results_.size() < num_expected) {
+      struct pollfd pfd = {ring_->event_fd(), POLLIN, 0};
+      ASSERT_EQ(poll(&pfd, 1, 5000), 1);
+      ring_->ReapCompletions(
+          [this](uint64_t user_data, int32_t res) { results_.emplace_back(user_data, res); });
+    }
+  }
+
+  std::unique_ptr<IOUring> ring_;
+  std::FILE* file_ = nullptr;
+  std::vector<std::pair<uint64_t, int32_t>> results_;
+};
+
+TEST_F(IOUringTest, write_fsync_read) {
+  int fd = fileno(file_);
+  const std::string data = "hello io_uring";
+
+  ASSERT_TRUE(ring_->QueueWrite(fd, data.data(), data.size(), 0, 1));
+  ASSERT_OK(ring_->Submit());
+  WaitAndReap(1);
+  EXPECT_EQ(results_[0], std::make_pair(uint64_t{1}, static_cast<int32_t>(data.size())));
+
+  std::string buf(data.size(), '\0');
+  ASSERT_TRUE(ring_->QueueFsync(fd, 2));
+  ASSERT_TRUE(ring_->QueueRead(fd, buf.data(), buf.size(), 0, 3));
+  EXPECT_EQ(ring_->num_queued(), 2);
+  ASSERT_OK(ring_->Submit());
+  EXPECT_EQ(ring_->num_queued(), 0);
+  WaitAndReap(3);
+
+  // Operations in the same batch can complete in any order.
+  EXPECT_THAT(results_, ::testing::UnorderedElementsAre(
+                            std::make_pair(1, data.size()), std::make_pair(2, 0),
+                            std::make_pair(3, data.size())));
+  EXPECT_EQ(buf, data);
+}
+
+TEST_F(IOUringTest, errors_are_returned_as_negative_errno) {
+  char buf[8];
+  ASSERT_TRUE(ring_->QueueRead(/*fd*/ -1, buf, sizeof(buf), 0, 7));
+  ASSERT_OK(ring_->Submit());
+  WaitAndReap(1);
+  EXPECT_EQ(results_[0], std::make_pair(uint64_t{7}, -EBADF));
+}
+
+TEST_F(IOUringTest, full_submission_queue) {
+  int fd = fileno(file_);
+  char buf[8];
+  int num_queued = 0;
+  while (ring_->QueueRead(fd, buf, sizeof(buf), 0, num_queued)) {
+    ++num_queued;
+  }
+  EXPECT_EQ(num_queued, 4);
+
+  // Submitting frees up the queue.
+  ASSERT_OK(ring_->Submit());
+  EXPECT_TRUE(ring_->QueueFsync(fd, num_queued++));
+  ASSERT_OK(ring_->Submit());
+  WaitAndReap(num_queued);
+}
+
+}  // namespace event
+}  // namespace px
@@ -20,6 +20,8 @@
 
 #include <uv.h>
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -27,10 +29,45 @@
 #include "src/common/base/base.h"
 #include "src/common/event/api.h"
 
+DEFINE_bool(event_io_uring, gflags::BoolFromEnv("PL_EVENT_IO_URING", true),
+            "Use io_uring for the async file I/O of event dispatchers when the kernel supports it, "
+            "instead of the libuv threadpool.");
+
 namespace px {
 namespace event {
 
 namespace {
+
+constexpr uint32_t kIOUringEntries = 256;
+
+StatusOr<size_t> FileIOResult(int64_t res) {
+  // Both io_uring and libuv return -errno on failure.
+  if (res < 0) {
+    return error::Internal("File I/O failed: $0", uv_strerror(static_cast<int>(res)));
+  }
+  return static_cast<size_t>(res);
+}
+
+// io_uring takes 32-bit lengths. Larger operations complete as a short read/write.
+uint32_t IOUringLen(size_t len) {
+  return static_cast<uint32_t>(std::min<size_t>(len, std::numeric_limits<int32_t>::max()));
+}
+
+/**
+ * A file operation on the libuv threadpool, used when io_uring is not available.
+ */
+struct LibuvFileIORequest {
+  uv_fs_t req;
+  uv_buf_t buf;
+  FileIOCB cb;
+
+  static void Done(uv_fs_t* req) {
+    std::unique_ptr<LibuvFileIORequest> self(static_cast<LibuvFileIORequest*>(req->data));
+    int64_t res = req->result;
+    uv_fs_req_cleanup(req);
+    self->cb(FileIOResult(res));
+  }
+};
 /**
  * LibuvRunnableAsyncTask is a wrapper that contains Libuv specific run loop.
  */
@@ -226,6 +263,7 @@ LibuvDispatcher::LibuvDispatcher(std::string_view name, const API& api, TimeSyst
       current_to_delete_(&to_delete_1_),
       deferred_delete_timer_(CreateTimer([this]() { DoDeferredDelete(); })) {
   UpdateMonotonicTime();
+  InitIOUring();
 
   post_async_handler_.data = this;
   uv_async_init(base_scheduler_.uv_loop(), &post_async_handler_, [](uv_async_t* h) {
@@ -265,6 +303,120 @@ RunnableAsyncTaskUPtr LibuvDispatcher::CreateAsyncTask(std::unique_ptr<AsyncTask
   return base_scheduler_.CreateAsyncTask(std::move(task));
 }
 
+void LibuvDispatcher::InitIOUring() {
+  if (!FLAGS_event_io_uring) {
+    return;
+  }
+  auto ring_or = IOUring::Create(kIOUringEntries);
+  if (!ring_or.ok()) {
+    LOG_FIRST_N(INFO, 1) << LogEntry(absl::Substitute(
+        "io_uring is unavailable, file I/O uses the libuv threadpool: $0", ring_or.msg()));
+    return;
+  }
+  io_uring_ = ring_or.ConsumeValueOrDie();
+
+  io_uring_poll_.data = this;
+  CHECK(uv_poll_init(uv_loop(), &io_uring_poll_, io_uring_->event_fd()) == 0);
+  CHECK(uv_poll_start(&io_uring_poll_, UV_READABLE, [](uv_poll_t* h, int /*status*/, int) {
+          reinterpret_cast<LibuvDispatcher*>(h->data)->ReapIOUring();
+        }) == 0);
+  io_uring_submit_.data = this;
+  CHECK(uv_prepare_init(uv_loop(), &io_uring_submit_) == 0);
+  CHECK(uv_prepare_start(&io_uring_submit_, [](uv_prepare_t* h) {
+          reinterpret_cast<LibuvDispatcher*>(h->data)->SubmitIOUring();
+        }) == 0);
+  // Only operations in flight keep the loop alive, see QueueIOUringOp.
+  uv_unref(reinterpret_cast<uv_handle_t*>(&io_uring_poll_));
+  uv_unref(reinterpret_cast<uv_handle_t*>(&io_uring_submit_));
+}
+
+void LibuvDispatcher::QueueIOUringOp(const std::function<bool(uint64_t)>& queue_fn,
+                                     FileIOCB cb) {
+  uint64_t id = next_io_uring_op_id_++;
+  if (!queue_fn(id)) {
+    SubmitIOUring();
+    if (!queue_fn(id)) {
+      Post([cb = std::move(cb)]() { cb(error::Unavailable("io_uring submission queue is full")); });
+      return;
+    }
+  }
+  io_uring_callbacks_.emplace(id, std::move(cb));
+  uv_ref(reinterpret_cast<uv_handle_t*>(&io_uring_poll_));
+}
+
+void LibuvDispatcher::SubmitIOUring() {
+  if (io_uring_->num_queued() == 0) {
+    return;
+  }
+  // On failure the operations stay queued and are retried on the next loop iteration.
+  Status s = io_uring_->Submit();
+  LOG_IF(WARNING, !s.ok()) << LogEntry(s.msg());
+}
+
+void LibuvDispatcher::ReapIOUring() {
+  io_uring_->ReapCompletions([this](uint64_t id, int32_t res) {
+    auto node = io_uring_callbacks_.extract(id);
+    DCHECK(!node.empty()) << "Unknown io_uring operation " << id;
+    if (!node.empty()) {
+      node.mapped()(FileIOResult(res));
+    }
+  });
+  if (io_uring_callbacks_.empty()) {
+    uv_unref(reinterpret_cast<uv_handle_t*>(&io_uring_poll_));
+  }
+}
+
+void LibuvDispatcher::ReadFile(int fd, void* buf, size_t len, int64_t offset, FileIOCB cb) {
+  CHECK(IsCorrectThread());
+  if (io_uring_ != nullptr) {
+    QueueIOUringOp(
+        [&](uint64_t id) { return io_uring_->QueueRead(fd, buf, IOUringLen(len), offset, id); },
+        std::move(cb));
+    return;
+  }
+  auto* r = new LibuvFileIORequest{};
+  r->req.data = r;
+  r->buf = uv_buf_init(static_cast<char*>(buf), len);
+  r->cb = std::move(cb);
+  if (int rc = uv_fs_read(uv_loop(), &r->req, fd, &r->buf, 1, offset, LibuvFileIORequest::Done);
+      rc < 0) {
+    Post([r, rc]() { std::unique_ptr<LibuvFileIORequest>(r)->cb(FileIOResult(rc)); });
+  }
+}
+
+void LibuvDispatcher::WriteFile(int fd, const void* buf, size_t len, int64_t offset,
+                                FileIOCB cb) {
+  CHECK(IsCorrectThread());
+  if (io_uring_ != nullptr) {
+    QueueIOUringOp(
+        [&](uint64_t id) { return io_uring_->QueueWrite(fd, buf, IOUringLen(len), offset, id); },
+        std::move(cb));
+    return;
+  }
+  auto* r = new LibuvFileIORequest{};
+  r->req.data = r;
+  r->buf = uv_buf_init(static_cast<char*>(const_cast<void*>(buf)), len);
+  r->cb = std::move(cb);
+  if (int rc = uv_fs_write(uv_loop(), &r->req, fd, &r->buf, 1, offset, LibuvFileIORequest::Done);
+      rc < 0) {
+    Post([r, rc]() { std::unique_ptr<LibuvFileIORequest>(r)->cb(FileIOResult(rc)); });
+  }
+}
+
+void LibuvDispatcher::SyncFile(int fd, FileIOCB cb) {
+  CHECK(IsCorrectThread());
+  if (io_uring_ != nullptr) {
+    QueueIOUringOp([&](uint64_t id) { return io_uring_->QueueFsync(fd, id); }, std::move(cb));
+    return;
+  }
+  auto* r = new LibuvFileIORequest{};
+  r->req.data = r;
+  r->cb = std::move(cb);
+  if (int rc = uv_fs_fsync(uv_loop(), &r->req, fd, LibuvFileIORequest::Done); rc < 0) {
+    Post([r, rc]() { std::unique_ptr<LibuvFileIORequest>(r)->cb(FileIOResult(rc)); });
+  }
+}
+
 std::string LibuvDispatcher::LogEntry(std::string_view entry) {
   return base_scheduler_.LogEntry(entry);
 }
@@ -31,9 +31,11 @@
 
 #include <absl/base/attributes.h>
 #include <absl/base/thread_annotations.h>
+#include <absl/container/flat_hash_map.h>
 #include <absl/synchronization/mutex.h>
 #include "src/common/event/dispatcher.h"
 #include "src/common/event/event.h"
+#include "src/common/event/io_uring.h"
 
 namespace px {
 namespace event {
@@ -90,10 +92,14 @@ class LibuvDispatcher : public Dispatcher {
   void DeferredDelete(DeferredDeletableUPtr&& to_delete) override;
   void Run(RunType type) override;
   RunnableAsyncTaskUPtr CreateAsyncTask(std::unique_ptr<AsyncTask> task) override;
+  void ReadFile(int fd, void* buf, size_t len, int64_t offset, FileIOCB cb) override;
+  void WriteFile(int fd, const void* buf, size_t len, int64_t offset, FileIOCB cb) override;
+  void SyncFile(int fd, FileIOCB cb) override;
   MonotonicTimePoint ApproximateMonotonicTime() const override;
   void UpdateMonotonicTime() override;
   std::string LogEntry(std::string_view entry);
   uv_loop_t* uv_loop() { return base_scheduler_.uv_loop(); }
+  bool io_uring_enabled() const { return io_uring_ != nullptr; }
 
  private:
   bool IsCorrectThread() {
@@ -105,6 +111,13 @@ class LibuvDispatcher : public Dispatcher {
   void RunPostCallbacks();
   void DoDeferredDelete();
 
+  void InitIOUring();
+  // Queues a file operation on the io_uring. queue_fn queues the operation with the given id and
+  // returns false if the submission queue is full.
+  void QueueIOUringOp(const std::function<bool(uint64_t)>& queue_fn, FileIOCB cb);
+  void SubmitIOUring();
+  void ReapIOUring();
+
   const std::string name_;
   std::thread::id run_tid_;
 
@@ -124,6 +137,15 @@ class LibuvDispatcher : public Dispatcher {
   std::vector<DeferredDeletableUPtr>* current_to_delete_ = nullptr;
   bool deferred_deleting_ = false;
   TimerUPtr deferred_delete_timer_;
+
+  // Set if file I/O goes through io_uring, otherwise it uses the libuv threadpool.
+  std::unique_ptr<IOUring> io_uring_;
+  // Watches the io_uring eventfd for completions.
+  uv_poll_t io_uring_poll_;
+  // Submits the operations queued during a loop iteration before the loop blocks.
+  uv_prepare_t io_uring_submit_;
+  uint64_t next_io_uring_op_id_ = 0;
+  absl::flat_hash_map<uint64_t, FileIOCB> io_uring_callbacks_;
 };
 
 }  // namespace event
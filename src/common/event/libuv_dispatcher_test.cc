@@ -17,11 +17,16 @@
  */
 
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
 #include <thread>
 #include "src/common/base/base.h"
 #include "src/common/event/api.h"
 #include "src/common/event/event.h"
 #include "src/common/event/nats.h"
+#include "src/common/testing/testing.h"
+
+DECLARE_bool(event_io_uring);
 
 using px::event::APIImpl;
 using px::event::RealTimeSystem;
@@ -150,5 +155,69 @@ TEST_F(LibuvDispatcherTest, threadpool) {
   dispatcher_->Exit();
 }
 
+class LibuvDispatcherFileIOTest : public ::testing::TestWithParam<bool> {
+ protected:
+  void SetUp() override {
+    file_ = std::tmpfile();
+    ASSERT_NE(file_, nullptr);
+    PX_SET_FOR_SCOPE(FLAGS_event_io_uring, GetParam());
+    dispatcher_ = api_.AllocateDispatcher("file_io_test");
+  }
+
+  void TearDown() override {
+    dispatcher_->Exit();
+    fclose(file_);
+  }
+
+  RealTimeSystem time_system_;
+  APIImpl api_{&time_system_};
+  std::unique_ptr<Dispatcher> dispatcher_;
+  std::FILE* file_ = nullptr;
+};
+
+TEST_P(LibuvDispatcherFileIOTest, write_sync_read) {
+  int fd = fileno(file_);
+  const std::string data = "px dispatcher file io";
+  std::string buf(data.size(), '\0');
+
+  std::vector<std::string> events;
+  auto record = [&events](std::string_view op, StatusOr<size_t> s) {
+    events.push_back(s.ok() ? absl::Substitute("$0:$1", op, s.ValueOrDie()) : std::string(op));
+  };
+  dispatcher_->WriteFile(fd, data.data(), data.size(), 0, [&](StatusOr<size_t> s) {
+    record("write", s);
+    dispatcher_->SyncFile(fd, [&](StatusOr<size_t> s) {
+      record("sync", s);
+      dispatcher_->ReadFile(fd, buf.data(), buf.size(), 0,
+                            [&](StatusOr<size_t> s) { record("read", s); });
+    });
+  });
+  while (events.size() < 3) {
+    dispatcher_->Run(Dispatcher::RunType::RunUntilExit);
+  }
+
+  EXPECT_THAT(events, ::testing::ElementsAre("write:21", "sync:0", "read:21"));
+  EXPECT_EQ(buf, data);
+}
+
+TEST_P(LibuvDispatcherFileIOTest, read_error) {
+  char buf[8];
+  bool done = false;
+  Status status;
+  dispatcher_->ReadFile(/*fd*/ -1, buf, sizeof(buf), 0, [&](StatusOr<size_t> s) {
+    status = s.status();
+    done = true;
+  });
+  while (!done) {
+    dispatcher_->Run(Dispatcher::RunType::RunUntilExit);
+  }
+
+  EXPECT_NOT_OK(status);
+}
+
+// Covers both the io_uring backend and the libuv threadpool fallback. The io_uring variant also
+// uses the fallback on kernels without io_uring.
+INSTANTIATE_TEST_SUITE_P(Backends, LibuvDispatcherFileIOTest, ::testing::Bool());
+
 }  // namespace event
 }  // namespace px
@@ -15,11 +15,15 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#include <limits>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include <prometheus/registry.h>
 
 #include "src/common/metrics/metrics.h"
+#include "src/common/perf/perf_probe.h"
 
 namespace {
 std::unique_ptr<prometheus::Registry> g_registry_instance;
@@ -35,3 +39,41 @@ prometheus::Registry& GetMetricsRegistry() {
 }
 
 void TestOnlyResetMetricsRegistry() { ResetMetricsRegistry(); }
+
+void CollectPerfProbeMetrics(std::vector<prometheus::MetricFamily>* families) {
+  // Export a fixed subset of the probe buckets, from ~1us to ~17s by factors of 4, so that every
+  // series has the same buckets.
+  constexpr size_t kFirstBucket = 10;
+  constexpr size_t kLastBucket = 34;
+  constexpr size_t kBucketStep = 2;
+  constexpr double kNanosPerSecond = 1e9;
+
+  std::vector<px::perf::ProbeStats> all_stats = px::perf::PerfProbe::AllStats();
+  if (all_stats.empty()) {
+    return;
+  }
+  prometheus::MetricFamily family;
+  family.name = "px_perf_probe_duration_seconds";
+  family.help = "Time spent in instrumented hot paths, by subsystem and probe.";
+  family.type = prometheus::MetricType::Histogram;
+  for (const auto& stats : all_stats) {
+    prometheus::ClientMetric metric;
+    metric.label = {{"subsystem", stats.subsystem}, {"probe", stats.name}};
+    metric.histogram.sample_count = stats.count;
+    metric.histogram.sample_sum = stats.sum_ns / kNanosPerSecond;
+    uint64_t cumulative_count = 0;
+    size_t next_bucket = 0;
+    for (size_t i = kFirstBucket; i <= kLastBucket; i += kBucketStep) {
+      for (; next_bucket <= i; ++next_bucket) {
+        cumulative_count += stats.buckets[next_bucket];
+      }
+      // Bucket i holds durations below its upper bound, so the count is of durations < bound,
+      // which is within Prometheus' <= bound.
+      metric.histogram.bucket.push_back(
+          {cumulative_count, px::perf::ProbeStats::BucketUpperBound(i) / kNanosPerSecond});
+    }
+    metric.histogram.bucket.push_back({stats.count, std::numeric_limits<double>::infinity()});
+    family.metric.push_back(std::move(metric));
+  }
+  families->push_back(std::move(family));
+}
@@ -19,8 +19,10 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include <prometheus/counter.h>
+#include <prometheus/metric_family.h>
 #include <prometheus/registry.h>
 
 // Returns the global metrics registry;
@@ -30,6 +32,10 @@ prometheus::Registry& GetMetricsRegistry();
 // This function should only be called by testing code.
 void TestOnlyResetMetricsRegistry();
 
+// Appends the latency histograms of the perf probes (see src/common/perf/perf_probe.h) to the
+// collected metrics, as the px_perf_probe_duration_seconds family.
+void CollectPerfProbeMetrics(std::vector<prometheus::MetricFamily>* families);
+
 // A convenience wrapper to return a counter with the specified name and help message when
 // dimensions aren't known at compile time. This should only be used when dimensional data is
 // very low cardinality.
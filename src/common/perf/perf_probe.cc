@@ -0,0 +1,145 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "src/common/perf/perf_probe.h"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/container/btree_map.h>
+#include <absl/numeric/bits.h>
+#include <absl/synchronization/mutex.h>
+
+namespace px {
+namespace perf {
+
+namespace {
+
+struct ProbeRegistry {
+  absl::Mutex lock;
+  std::vector<const PerfProbe*> probes ABSL_GUARDED_BY(lock);
+};
+
+ProbeRegistry& GetProbeRegistry() {
+  // Never destroyed, since static probes may be destroyed after any other static.
+  static auto* registry = new ProbeRegistry();
+  return *registry;
+}
+
+}  // namespace
+
+uint64_t ProbeStats::BucketUpperBound(size_t i) {
+  if (i + 1 >= kNumBuckets) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  return uint64_t{1} << i;
+}
+
+uint64_t ProbeStats::Quantile(double q) const {
+  if (count == 0) {
+    return 0;
+  }
+  // The rank of the quantile, counting from 1.
+  const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * count + 0.5));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      return BucketUpperBound(i);
+    }
+  }
+  return BucketUpperBound(kNumBuckets - 1);
+}
+
+PerfProbe::PerfProbe(std::string_view subsystem, std::string_view name)
+    : subsystem_(subsystem), name_(name) {
+  ProbeRegistry& registry = GetProbeRegistry();
+  absl::MutexLock lock(&registry.lock);
+  registry.probes.push_back(this);
+}
+
+PerfProbe::~PerfProbe() {
+  ProbeRegistry& registry = GetProbeRegistry();
+  absl::MutexLock lock(&registry.lock);
+  registry.probes.erase(std::find(registry.probes.begin(), registry.probes.end(), this));
+}
+
+size_t PerfProbe::ThreadShard() {
+  static std::atomic<size_t> next_shard = 0;
+  thread_local const size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+  return shard;
+}
+
+void PerfProbe::Record(uint64_t duration_ns) {
+  Shard& shard = shards_[ThreadShard()];
+  shard.sum_ns.fetch_add(duration_ns, std::memory_order_relaxed);
+  // The number of significant bits is the bucket: 0 for 0ns, i for [2^(i-1), 2^i) ns.
+  shard.buckets[absl::bit_width(duration_ns)].fetch_add(1, std::memory_order_relaxed);
+}
+
+ProbeStats PerfProbe::Stats() const {
+  ProbeStats stats;
+  stats.subsystem = subsystem_;
+  stats.name = name_;
+  for (const Shard& shard : shards_) {
+    stats.sum_ns += shard.sum_ns.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < ProbeStats::kNumBuckets; ++i) {
+      stats.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+    }
+  }
+  // Derive the count from the buckets, so that it is consistent with them even while samples
+  // are being recorded.
+  for (uint64_t bucket : stats.buckets) {
+    stats.count += bucket;
+  }
+  return stats;
+}
+
+std::vector<ProbeStats> PerfProbe::AllStats() {
+  // Probes with the same names, such as the ones of the instantiations of a template, are merged.
+  absl::btree_map<std::pair<std::string, std::string>, ProbeStats> stats_by_name;
+  {
+    ProbeRegistry& registry = GetProbeRegistry();
+    absl::MutexLock lock(&registry.lock);
+    for (const PerfProbe* probe : registry.probes) {
+      ProbeStats& stats = stats_by_name[{probe->subsystem_, probe->name_}];
+      ProbeStats probe_stats = probe->Stats();
+      if (stats.count == 0 && stats.sum_ns == 0) {
+        stats = std::move(probe_stats);
+        continue;
+      }
+      stats.count += probe_stats.count;
+      stats.sum_ns += probe_stats.sum_ns;
+      for (size_t i = 0; i < ProbeStats::kNumBuckets; ++i) {
+        stats.buckets[i] += probe_stats.buckets[i];
+      }
+    }
+  }
+  std::vector<ProbeStats> all_stats;
+  all_stats.reserve(stats_by_name.size());
+  for (auto& [name, stats] : stats_by_name) {
+    all_stats.push_back(std::move(stats));
+  }
+  return all_stats;
+}
+
+}  // namespace perf
+}  // namespace px
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace perf {
+
+/**
+ * A snapshot of the latency histogram of a probe point.
+ */
+struct ProbeStats {
+  // Bucket 0 counts durations of 0ns, and bucket i > 0 counts durations in [2^(i-1), 2^i) ns.
+  static constexpr size_t kNumBuckets = 65;
+
+  std::string subsystem;
+  std::string name;
+  uint64_t count = 0;
+  uint64_t sum_ns = 0;
+  std::array<uint64_t, kNumBuckets> buckets = {};
+
+  // The exclusive upper bound of bucket i in nanoseconds, saturated for the last bucket.
+  static uint64_t BucketUpperBound(size_t i);
+
+  // Estimates the q quantile (0 <= q <= 1) as the upper bound of the bucket that contains it.
+  uint64_t Quantile(double q) const;
+};
+
+/**
+ * A named, static probe point of a hot path, whose latencies are aggregated into a histogram.
+ *
+ * Recording is lock-free: each thread records into one of a few cache-line aligned shards with
+ * relaxed atomic increments, so threads rarely share a shard. The shards are only summed up when
+ * the stats are read. Probes register themselves for AllStats() while they exist, and are meant
+ * to be static; see PX_PERF_PROBE_SCOPE.
+ */
+class PerfProbe : public NotCopyable {
+ public:
+  PerfProbe(std::string_view subsystem, std::string_view name);
+  ~PerfProbe();
+
+  void Record(uint64_t duration_ns);
+
+  ProbeStats Stats() const;
+
+  // Returns the stats of all the probes that have been reached so far, by subsystem and name.
+  static std::vector<ProbeStats> AllStats();
+
+ private:
+  static constexpr size_t kNumShards = 16;
+
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> sum_ns = 0;
+    std::array<std::atomic<uint64_t>, ProbeStats::kNumBuckets> buckets = {};
+  };
+
+  static size_t ThreadShard();
+
+  const std::string subsystem_;
+  const std::string name_;
+  std::array<Shard, kNumShards> shards_;
+};
+
+/**
+ * Records the time spent in its scope to a probe.
+ */
+class ScopedProbeTimer : public NotCopyable {
+ public:
+  explicit ScopedProbeTimer(PerfProbe* probe)
+      : probe_(probe), start_(std::chrono::steady_clock::now()) {}
+
+  ~ScopedProbeTimer() {
+    probe_->Record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - start_)
+                       .count());
+  }
+
+ private:
+  PerfProbe* probe_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace perf
+}  // namespace px
+
+/**
+ * Times the rest of the enclosing scope into the probe named subsystem/name, e.g.
+ *   PX_PERF_PROBE_SCOPE("table_store", "compaction");
+ * Both names must be string literals. Builds with --define perf_probes=disabled compile the
+ * probes out entirely.
+ */
+#ifdef PL_DISABLE_PERF_PROBES
+#define PX_PERF_PROBE_SCOPE(subsystem, name)
+#else
+#define PX_PERF_PROBE_SCOPE(subsystem, name)                                                    \
+  static ::px::perf::PerfProbe PX_CONCAT_NAME(__perf_probe__, __LINE__)(subsystem, name);       \
+  ::px::perf::ScopedProbeTimer PX_CONCAT_NAME(__perf_probe_timer__, __LINE__)(                  \
+      &PX_CONCAT_NAME(__perf_probe__, __LINE__))
+#endif
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "src/common/perf/perf_probe.h"
+
+namespace px {
+namespace perf {
+
+TEST(PerfProbeTest, histogram_buckets) {
+  PerfProbe probe("test", "histogram_buckets");
+  probe.Record(0);
+  probe.Record(1);
+  probe.Record(1000);
+  probe.Record(1023);
+  probe.Record(1024);
+
+  ProbeStats stats = probe.Stats();
+  EXPECT_EQ(stats.subsystem, "test");
+  EXPECT_EQ(stats.name, "histogram_buckets");
+  EXPECT_EQ(stats.count, 5);
+  EXPECT_EQ(stats.sum_ns, 3048);
+  EXPECT_EQ(stats.buckets[0], 1);
+  EXPECT_EQ(stats.buckets[1], 1);
+  EXPECT_EQ(stats.buckets[10], 2);
+  EXPECT_EQ(stats.buckets[11], 1);
+
+  EXPECT_EQ(stats.Quantile(0), 1);
+  EXPECT_EQ(stats.Quantile(0.5), 1024);
+  EXPECT_EQ(stats.Quantile(1), 2048);
+  EXPECT_EQ(ProbeStats().Quantile(0.5), 0);
+}
+
+TEST(PerfProbeTest, aggregates_threads) {
+  static PerfProbe probe("test", "aggregates_threads");
+  constexpr int kNumThreads = 20;
+  constexpr int kNumRecords = 1000;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([] {
+      for (int i = 0; i < kNumRecords; ++i) {
+        probe.Record(10);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ProbeStats stats = probe.Stats();
+  EXPECT_EQ(stats.count, kNumThreads * kNumRecords);
+  EXPECT_EQ(stats.sum_ns, 10 * kNumThreads * kNumRecords);
+  EXPECT_EQ(stats.buckets[4], kNumThreads * kNumRecords);
+}
+
+TEST(PerfProbeTest, merges_probes_with_the_same_name) {
+  PerfProbe probe0("test", "merges_probes_with_the_same_name");
+  PerfProbe probe1("test", "merges_probes_with_the_same_name");
+  probe0.Record(10);
+  probe1.Record(20);
+
+  int num_found = 0;
+  for (const ProbeStats& stats : PerfProbe::AllStats()) {
+    if (stats.subsystem == "test" && stats.name == "merges_probes_with_the_same_name") {
+      ++num_found;
+      EXPECT_EQ(stats.count, 2);
+      EXPECT_EQ(stats.sum_ns, 30);
+      EXPECT_EQ(stats.buckets[4], 1);
+      EXPECT_EQ(stats.buckets[5], 1);
+    }
+  }
+  EXPECT_EQ(num_found, 1);
+}
+
+TEST(PerfProbeTest, scoped_probes_register) {
+  for (int i = 0; i < 3; ++i) {
+    PX_PERF_PROBE_SCOPE("test", "scoped_probes_register");
+  }
+
+  int num_found = 0;
+  for (const ProbeStats& stats : PerfProbe::AllStats()) {
+    if (stats.subsystem == "test" && stats.name == "scoped_probes_register") {
+      ++num_found;
+      EXPECT_EQ(stats.count, 3);
+    }
+  }
+  EXPECT_EQ(num_found, 1);
+}
+
+}  // namespace perf
+}  // namespace px
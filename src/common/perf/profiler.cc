@@ -23,6 +23,7 @@
 #ifdef PROFILER_AVAILABLE
 
 #include "gperftools/heap-profiler.h"
+#include "gperftools/malloc_extension.h"
 #include "gperftools/profiler.h"
 
 namespace px {
@@ -62,6 +63,12 @@ bool Heap::StopProfiler() {
   return true;
 }
 
+bool Heap::GetHeapSample(std::string* out) {
+  out->clear();
+  MallocExtension::instance()->GetHeapSample(out);
+  return !out->empty();
+}
+
 void Heap::ForceLink() {
   // Currently this is here to force the inclusion of the heap profiler during static linking.
   // Without this call the heap profiler will not be included and cannot be started via env
@@ -85,6 +92,7 @@ bool Heap::ProfilerAvailable() { return false; }
 bool Heap::IsProfilerStarted() { return false; }
 bool Heap::StartProfiler(const std::string& /*output_path*/) { return false; }
 bool Heap::StopProfiler() { return false; }
+bool Heap::GetHeapSample(std::string* /*out*/) { return false; }
 
 }  // namespace profiler
 }  // namespace px
@@ -87,6 +87,14 @@ class Heap {
    */
   static bool StopProfiler();
 
+  /**
+   * Write a snapshot of the sampled heap allocations, in pprof's heap profile format, to out.
+   * Unlike StartProfiler(), this needs no output file, but tcmalloc only samples allocations
+   * when TCMALLOC_SAMPLE_PARAMETER is set.
+   * @return bool whether the snapshot was taken.
+   */
+  static bool GetHeapSample(std::string* out);
+
  private:
   static void ForceLink();
 };
@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <cstddef>
+
 #ifdef TCMALLOC
 #include <gperftools/malloc_extension.h>
 #endif
@@ -25,10 +27,20 @@
 namespace px {
 
 // Call out to tcmalloc to request that previously freed memory is released to the OS.
-void ReleaseFreeMemory() {
+inline void ReleaseFreeMemory() {
 #ifdef TCMALLOC
   MallocExtension::instance()->ReleaseFreeMemory();
 #endif
 }
 
+// Returns the bytes of memory that tcmalloc holds free, which ReleaseFreeMemory() would give back
+// to the OS. Always 0 without tcmalloc.
+inline size_t FreeMemoryBytes() {
+  size_t bytes = 0;
+#ifdef TCMALLOC
+  MallocExtension::instance()->GetNumericProperty("tcmalloc.pageheap_free_bytes", &bytes);
+#endif
+  return bytes;
+}
+
 }  // namespace px
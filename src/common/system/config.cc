@@ -55,6 +55,10 @@ uint64_t Config::ConvertToRealTime(uint64_t monotonic_time) const {
   return clock_converter_->Convert(monotonic_time);
 }
 
+void Config::ConvertToRealTime(absl::Span<uint64_t> monotonic_times) const {
+  clock_converter_->ConvertBatch(monotonic_times);
+}
+
 std::filesystem::path Config::ToHostPath(const std::filesystem::path& p) const {
   // If we're running in a container, convert path to be relative to our host mount.
   // Note that we mount host '/' to '/host' inside container.
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <absl/types/span.h>
 #include <filesystem>
 #include <memory>
 #include <string>
@@ -72,6 +73,11 @@ class Config : public NotCopyable {
    */
   uint64_t ConvertToRealTime(uint64_t monotonic_time) const;
 
+  /**
+   * Converts a batch of `nsecs` from bpf to realtime in place. Cheapest when sorted.
+   */
+  void ConvertToRealTime(absl::Span<uint64_t> monotonic_times) const;
+
   /**
    * Converts a path to host relative path, for when this binary is running inside a container.
    */
@@ -16,8 +16,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <array>
 #include <fstream>
-#include <limits>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -25,6 +25,7 @@
 #include <vector>
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/strings/ascii.h>
 #include <absl/strings/numbers.h>
 #include <absl/strings/substitute.h>
 
@@ -83,6 +84,8 @@ constexpr int kProcNetDevTxDropField = 12;
 constexpr int kProcStatNumFields = 52;
 
 constexpr int kProcStatPIDField = 0;
+// The first field after the command name.
+constexpr int kProcStatStateField = 2;
 
 constexpr int kProcStatMinorFaultsField = 9;
 constexpr int kProcStatMajorFaultsField = 11;
@@ -96,8 +99,37 @@ constexpr int kProcStatStartTimeField = 21;
 constexpr int kProcStatVSizeField = 22;
 constexpr int kProcStatRSSField = 23;
 
+namespace {
+
+// Removes the first line from the text, and returns it without the newline.
+std::string_view ConsumeLine(std::string_view* text) {
+  const size_t end = text->find('\n');
+  std::string_view line = text->substr(0, end);
+  text->remove_prefix(end == std::string_view::npos ? text->size() : end + 1);
+  return line;
+}
+
+// Splits the line into fields separated by kFieldSeparators, without allocating.
+// Stores up to N fields, and returns the total number of fields in the line.
+template <size_t N>
+size_t SplitFields(std::string_view line, std::array<std::string_view, N>* fields) {
+  size_t num_fields = 0;
+  size_t pos = line.find_first_not_of(kFieldSeparators);
+  while (pos != std::string_view::npos) {
+    const size_t end = line.find_first_of(kFieldSeparators, pos);
+    if (num_fields < N) {
+      (*fields)[num_fields] = line.substr(pos, end - pos);
+    }
+    ++num_fields;
+    pos = line.find_first_not_of(kFieldSeparators, end);
+  }
+  return num_fields;
+}
+
+}  // namespace
+
 Status ProcParser::ParseNetworkStatAccumulateIFaceData(
-    const std::vector<std::string_view>& dev_stat_record, NetworkStats* out) {
+    absl::Span<const std::string_view> dev_stat_record, NetworkStats* out) {
   DCHECK(out != nullptr);
 
   int64_t val;
@@ -148,6 +180,13 @@ bool ShouldIncludeNetIFace(const std::string_view iface) {
 }
 
 Status ProcParser::ParseProcPIDNetDev(int32_t pid, NetworkStats* out) const {
+  DCHECK(out != nullptr);
+  const auto fpath = ProcPidPath(pid, "net", "dev");
+  PX_ASSIGN_OR_RETURN(std::string content, px::ReadFileToString(fpath));
+  return ParseProcPIDNetDevContent(content, out);
+}
+
+Status ProcParser::ParseProcPIDNetDevContent(std::string_view content, NetworkStats* out) {
   /**
    * Sample file:
    * Inter-|   Receive                                                | Transmit
@@ -160,24 +199,17 @@ Status ProcParser::ParseProcPIDNetDev(int32_t pid, NetworkStats* out) const {
    */
   DCHECK(out != nullptr);
 
-  const auto fpath = ProcPidPath(pid, "net", "dev");
-  std::ifstream ifs;
-  ifs.open(fpath);
-  if (!ifs) {
-    return error::Internal("Failed to open file: $0.", fpath.string());
-  }
-
   // Ignore the first two lines since they are just headers;
   const int kHeaderLines = 2;
   for (int i = 0; i < kHeaderLines; ++i) {
-    ifs.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    ConsumeLine(&content);
   }
 
-  std::string line;
-  while (std::getline(ifs, line)) {
-    std::vector<std::string_view> split = absl::StrSplit(line, " ", absl::SkipWhitespace());
+  std::array<std::string_view, kProcNetDevNumFields> split;
+  while (!content.empty()) {
+    const std::string_view line = ConsumeLine(&content);
     // We check less than in case more fields are added later.
-    if (split.size() < kProcNetDevNumFields) {
+    if (SplitFields(line, &split) < kProcNetDevNumFields) {
       return error::Internal("failed to parse net dev file, incorrect number of fields");
     }
 
@@ -198,6 +230,18 @@ Status ProcParser::ParseProcPIDNetDev(int32_t pid, NetworkStats* out) const {
 
 Status ProcParser::ParseProcPIDStat(int32_t pid, int64_t page_size_bytes,
                                     int64_t kernel_tick_time_ns, ProcessStats* out) const {
+  DCHECK(out != nullptr);
+  const auto fpath = ProcPidPath(pid, "stat");
+  PX_ASSIGN_OR_RETURN(std::string content, px::ReadFileToString(fpath));
+  auto s = ParseProcPIDStatContent(content, page_size_bytes, kernel_tick_time_ns, out);
+  if (!s.ok()) {
+    return error::Internal("Failed to parse stat file $0: $1", fpath.string(), s.msg());
+  }
+  return Status::OK();
+}
+
+Status ProcParser::ParseProcPIDStatContent(std::string_view content, int64_t page_size_bytes,
+                                           int64_t kernel_tick_time_ns, ProcessStats* out) {
   /**
    * Sample file:
    * 4602 (ibazel) S 3260 4602 3260 34818 4602 1077936128 1799 174589 \
@@ -207,65 +251,62 @@ Status ProcParser::ParseProcPIDStat(int32_t pid, int64_t page_size_bytes,
    * 140730842488200 140730842492896 0
    */
   DCHECK(out != nullptr);
-  const auto fpath = ProcPidPath(pid, "stat");
-  std::ifstream ifs;
-  ifs.open(fpath);
-  if (!ifs) {
-    return error::Internal("Failed to open file: $0.", fpath.string());
-  }
+  const std::string_view line = ConsumeLine(&content);
 
-  std::string line;
-  bool ok = true;
-  if (std::getline(ifs, line)) {
-    std::vector<std::string_view> split = absl::StrSplit(line, " ", absl::SkipWhitespace());
-    // We check less than in case more fields are added later.
-    if (split.size() < kProcStatNumFields) {
-      return error::Unknown("Incorrect number of fields in stat file: $0.", fpath.string());
-    }
-
-    // The name is surrounded by (). We remove it first.
-    size_t open_paren_idx = line.find_first_of('(');
-    size_t close_paren_idx = line.find_last_of(')');
-    if (open_paren_idx == std::string::npos || close_paren_idx == std::string::npos) {
-      return error::Internal("Invalid command name in file $0.", fpath.string());
-    }
-    out->process_name = line.substr(open_paren_idx + 1, close_paren_idx - open_paren_idx - 1);
-
-    // When split_size > kProcStatNumFields, there are spaces in the command we need to handle.
-    // command_offset adjusts index for the number of spaces in the command field.
-    int command_offset = std::count(out->process_name.begin(), out->process_name.end(), ' ');
+  // The name is surrounded by (), and may itself contain spaces and parentheses. So the fields
+  // after the name are split from the last ')' onwards.
+  const size_t open_paren_idx = line.find_first_of('(');
+  const size_t close_paren_idx = line.find_last_of(')');
+  if (open_paren_idx == std::string_view::npos || close_paren_idx == std::string_view::npos ||
+      close_paren_idx < open_paren_idx) {
+    return error::Internal("Invalid command name.");
+  }
+  out->process_name.assign(line.substr(open_paren_idx + 1, close_paren_idx - open_paren_idx - 1));
 
-    ok &= absl::SimpleAtoi(split[kProcStatPIDField], &out->pid);
+  std::array<std::string_view, kProcStatNumFields - kProcStatStateField> split;
+  const size_t num_fields = SplitFields(line.substr(close_paren_idx + 1), &split);
+  // We check less than in case more fields are added later.
+  if (num_fields + kProcStatStateField < kProcStatNumFields) {
+    return error::Unknown("Incorrect number of fields.");
+  }
+  auto field = [&split](int idx) { return split[idx - kProcStatStateField]; };
 
-    ok &= absl::SimpleAtoi(split[kProcStatMinorFaultsField + command_offset], &out->minor_faults);
-    ok &= absl::SimpleAtoi(split[kProcStatMajorFaultsField + command_offset], &out->major_faults);
+  bool ok = true;
+  ok &= absl::SimpleAtoi(line.substr(0, open_paren_idx), &out->pid);
+  static_assert(kProcStatPIDField == 0);
 
-    ok &= absl::SimpleAtoi(split[kProcStatUTimeField + command_offset], &out->utime_ns);
-    ok &= absl::SimpleAtoi(split[kProcStatKTimeField + command_offset], &out->ktime_ns);
-    // The kernel tracks utime and ktime in kernel ticks.
-    out->utime_ns *= kernel_tick_time_ns;
-    out->ktime_ns *= kernel_tick_time_ns;
+  ok &= absl::SimpleAtoi(field(kProcStatMinorFaultsField), &out->minor_faults);
+  ok &= absl::SimpleAtoi(field(kProcStatMajorFaultsField), &out->major_faults);
 
-    ok &= absl::SimpleAtoi(split[kProcStatNumThreadsField + command_offset], &out->num_threads);
-    ok &= absl::SimpleAtoi(split[kProcStatVSizeField + command_offset], &out->vsize_bytes);
-    ok &= absl::SimpleAtoi(std::string(split[kProcStatRSSField + command_offset]), &out->rss_bytes);
+  ok &= absl::SimpleAtoi(field(kProcStatUTimeField), &out->utime_ns);
+  ok &= absl::SimpleAtoi(field(kProcStatKTimeField), &out->ktime_ns);
+  // The kernel tracks utime and ktime in kernel ticks.
+  out->utime_ns *= kernel_tick_time_ns;
+  out->ktime_ns *= kernel_tick_time_ns;
 
-    // RSS is in pages.
-    out->rss_bytes *= page_size_bytes;
+  ok &= absl::SimpleAtoi(field(kProcStatNumThreadsField), &out->num_threads);
+  ok &= absl::SimpleAtoi(field(kProcStatVSizeField), &out->vsize_bytes);
+  ok &= absl::SimpleAtoi(field(kProcStatRSSField), &out->rss_bytes);
 
-  } else {
-    return error::Internal("Failed to read proc stat file: $0.", fpath.string());
-  }
+  // RSS is in pages.
+  out->rss_bytes *= page_size_bytes;
 
   if (!ok) {
     // This should never happen since it requires the file to be ill-formed
     // by the kernel.
-    return error::Internal("Failed to parse stat file: $0. ATOI failed.", fpath.string());
+    return error::Internal("ATOI failed.");
   }
   return Status::OK();
 }
 
 Status ProcParser::ParseProcPIDStatIO(int32_t pid, ProcessStats* out) const {
+  DCHECK(out != nullptr);
+  const auto fpath = ProcPidPath(pid, "io");
+  PX_ASSIGN_OR_RETURN(std::string content, px::ReadFileToString(fpath));
+  return ParseProcPIDStatIOContent(content, out);
+}
+
+Status ProcParser::ParseProcPIDStatIOContent(std::string_view content, ProcessStats* out) {
   /**
    * Sample file:
    *   rchar: 5405203
@@ -277,7 +318,6 @@ Status ProcParser::ParseProcPIDStatIO(int32_t pid, ProcessStats* out) const {
    *   cancelled_write_bytes: 192512
    */
   DCHECK(out != nullptr);
-  const auto fpath = ProcPidPath(pid, "io");
 
   // Just to be safe when using offsetof, make sure object is standard layout.
   static_assert(std::is_standard_layout<ProcessStats>::value);
@@ -289,7 +329,11 @@ Status ProcParser::ParseProcPIDStatIO(int32_t pid, ProcessStats* out) const {
       {"write_bytes", offsetof(ProcessStats, write_bytes)},
   };
 
-  return ParseFromKeyValueFile(fpath, field_name_to_offset_map, reinterpret_cast<uint8_t*>(out));
+  while (!content.empty()) {
+    ParseFromKeyValueLine(ConsumeLine(&content), field_name_to_offset_map,
+                          reinterpret_cast<uint8_t*>(out));
+  }
+  return Status::OK();
 }
 
 Status ProcParser::ParseProcStat(SystemStats* out) const {
@@ -536,13 +580,17 @@ Status ProcParser::ParseProcPIDSMaps(int32_t pid, std::vector<ProcessSMaps>* out
 }
 
 void ProcParser::ParseFromKeyValueLine(
-    const std::string& line,
+    std::string_view line,
     const absl::flat_hash_map<std::string_view, size_t>& field_name_to_value_map,
     uint8_t* out_base) {
-  std::vector<std::string_view> split = absl::StrSplit(line, ':', absl::SkipWhitespace());
-  if (split.size() >= 2) {
-    const auto& key = split[0];
-    const auto& val = split[1];
+  const size_t colon_idx = line.find(':');
+  if (colon_idx != std::string_view::npos) {
+    const std::string_view key = line.substr(0, colon_idx);
+    std::string_view val = line.substr(colon_idx + 1);
+    val = val.substr(0, val.find(':'));
+    if (absl::StripAsciiWhitespace(val).empty()) {
+      return;
+    }
 
     const auto& it = field_name_to_value_map.find(key);
     // Key not found in map, we can just go to next iteration of loop.
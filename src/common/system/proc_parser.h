@@ -22,12 +22,14 @@
 #include <istream>
 #include <map>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
+#include <absl/types/span.h>
 #include "src/common/base/base.h"
 #include "src/common/system/system.h"
 
@@ -226,6 +228,26 @@ class ProcParser {
    */
   Status ParseProcPIDNetDev(int32_t pid, NetworkStats* out) const;
 
+  /**
+   * Parses the contents of a /proc/<pid>/stat file, as read by ParseProcPIDStat().
+   * Does not allocate, other than for a process name that does not fit in the inline storage of
+   * the string, which the kernel's 16-byte limit on the name normally rules out.
+   */
+  static Status ParseProcPIDStatContent(std::string_view content, int64_t page_size_bytes,
+                                        int64_t kernel_tick_time_ns, ProcessStats* out);
+
+  /**
+   * Parses the contents of a /proc/<pid>/io file, as read by ParseProcPIDStatIO().
+   * Does not allocate.
+   */
+  static Status ParseProcPIDStatIOContent(std::string_view content, ProcessStats* out);
+
+  /**
+   * Parses the contents of a /proc/<pid>/net/dev file, as read by ParseProcPIDNetDev().
+   * Does not allocate.
+   */
+  static Status ParseProcPIDNetDevContent(std::string_view content, NetworkStats* out);
+
   /**
    * Parses /proc/stat
    * @param out a valid pointer to an output struct.
@@ -367,10 +389,10 @@ class ProcParser {
 
  private:
   static Status ParseNetworkStatAccumulateIFaceData(
-      const std::vector<std::string_view>& dev_stat_record, NetworkStats* out);
+      absl::Span<const std::string_view> dev_stat_record, NetworkStats* out);
 
   static void ParseFromKeyValueLine(
-      const std::string& line,
+      std::string_view line,
       const absl::flat_hash_map<std::string_view, size_t>& field_name_to_value_map,
       uint8_t* out_base);
 
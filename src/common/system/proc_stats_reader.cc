@@ -0,0 +1,138 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/system/proc_stats_reader.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <filesystem>
+
+#include "src/common/system/proc_pid_path.h"
+
+namespace px {
+namespace system {
+
+ProcStatsReader::~ProcStatsReader() {
+  for (auto& [pid, pid_files] : pid_files_) {
+    CloseFiles(&pid_files);
+  }
+}
+
+Status ProcStatsReader::ParseProcPIDStat(int32_t pid, int64_t page_size_bytes,
+                                         int64_t kernel_tick_time_ns,
+                                         ProcParser::ProcessStats* out) {
+  PX_ASSIGN_OR_RETURN(std::string_view content, ReadFile(pid, ProcFile::kStat));
+  return ProcParser::ParseProcPIDStatContent(content, page_size_bytes, kernel_tick_time_ns, out);
+}
+
+Status ProcStatsReader::ParseProcPIDStatIO(int32_t pid, ProcParser::ProcessStats* out) {
+  PX_ASSIGN_OR_RETURN(std::string_view content, ReadFile(pid, ProcFile::kIO));
+  return ProcParser::ParseProcPIDStatIOContent(content, out);
+}
+
+Status ProcStatsReader::ParseProcPIDNetDev(int32_t pid, ProcParser::NetworkStats* out) {
+  PX_ASSIGN_OR_RETURN(std::string_view content, ReadFile(pid, ProcFile::kNetDev));
+  return ProcParser::ParseProcPIDNetDevContent(content, out);
+}
+
+void ProcStatsReader::CloseUnusedFiles() {
+  for (auto iter = pid_files_.begin(); iter != pid_files_.end();) {
+    PIDFiles& pid_files = iter->second;
+    if (!pid_files.used) {
+      CloseFiles(&pid_files);
+      pid_files_.erase(iter++);
+    } else {
+      pid_files.used = false;
+      ++iter;
+    }
+  }
+}
+
+StatusOr<std::string_view> ProcStatsReader::ReadFile(int32_t pid, ProcFile file) {
+  PIDFiles& pid_files = pid_files_[pid];
+  pid_files.used = true;
+  int& fd = pid_files.fds[static_cast<size_t>(file)];
+
+  if (fd >= 0) {
+    auto content_or = PReadFromStart(fd);
+    if (content_or.ok()) {
+      return content_or;
+    }
+    // The process has exited, and the PID might have been reused since. Reopens the file below.
+    close(fd);
+    fd = -1;
+    --num_open_files_;
+  }
+
+  std::filesystem::path fpath;
+  switch (file) {
+    case ProcFile::kStat:
+      fpath = ProcPidPath(pid, "stat");
+      break;
+    case ProcFile::kIO:
+      fpath = ProcPidPath(pid, "io");
+      break;
+    case ProcFile::kNetDev:
+      fpath = ProcPidPath(pid, "net", "dev");
+      break;
+    case ProcFile::kNumFiles:
+      LOG(DFATAL) << "Invalid file.";
+      break;
+  }
+
+  const int new_fd = open(fpath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (new_fd < 0) {
+    return error::Internal("Failed to open file: $0.", fpath.string());
+  }
+  if (num_open_files_ >= max_open_files_) {
+    DEFER(close(new_fd));
+    return PReadFromStart(new_fd);
+  }
+  fd = new_fd;
+  ++num_open_files_;
+  return PReadFromStart(fd);
+}
+
+StatusOr<std::string_view> ProcStatsReader::PReadFromStart(int fd) {
+  while (true) {
+    const ssize_t n = pread(fd, buf_.data(), buf_.size(), 0);
+    if (n < 0) {
+      return error::Internal("Failed to read file: $0.", std::strerror(errno));
+    }
+    if (static_cast<size_t>(n) < buf_.size()) {
+      return std::string_view(buf_.data(), n);
+    }
+    // The contents might not have fit. Grows the buffer, which is kept for the following reads.
+    buf_.resize(2 * buf_.size());
+  }
+}
+
+void ProcStatsReader::CloseFiles(PIDFiles* pid_files) {
+  for (int& fd : pid_files->fds) {
+    if (fd >= 0) {
+      close(fd);
+      fd = -1;
+      --num_open_files_;
+    }
+  }
+}
+
+}  // namespace system
+}  // namespace px
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <string_view>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/base.h"
+#include "src/common/system/proc_parser.h"
+
+namespace px {
+namespace system {
+
+/**
+ * ProcStatsReader parses the same per-process files as the ProcParser functions of the same names,
+ * but is meant for reading the same processes over and over, like the stats connectors do every
+ * sampling period. It keeps the files open across calls, re-reads them with a single pread() at
+ * offset 0 into a reused buffer, and parses the contents without allocating.
+ *
+ * Files of processes that were not read since the previous call to CloseUnusedFiles() are closed by
+ * the next call, so callers should call it once per sampling iteration.
+ *
+ * Not thread-safe.
+ */
+class ProcStatsReader {
+ public:
+  // Beyond this many open files, files are opened and closed on every read, like ProcParser does.
+  static constexpr size_t kDefaultMaxOpenFiles = 4096;
+
+  explicit ProcStatsReader(size_t max_open_files = kDefaultMaxOpenFiles)
+      : max_open_files_(max_open_files) {}
+  ~ProcStatsReader();
+
+  /**
+   * See ProcParser::ParseProcPIDStat().
+   */
+  Status ParseProcPIDStat(int32_t pid, int64_t page_size_bytes, int64_t kernel_tick_time_ns,
+                          ProcParser::ProcessStats* out);
+
+  /**
+   * See ProcParser::ParseProcPIDStatIO().
+   */
+  Status ParseProcPIDStatIO(int32_t pid, ProcParser::ProcessStats* out);
+
+  /**
+   * See ProcParser::ParseProcPIDNetDev().
+   */
+  Status ParseProcPIDNetDev(int32_t pid, ProcParser::NetworkStats* out);
+
+  /**
+   * Closes the files of the processes that were not read since the previous call.
+   */
+  void CloseUnusedFiles();
+
+  size_t num_open_files() const { return num_open_files_; }
+
+ private:
+  enum class ProcFile { kStat = 0, kIO, kNetDev, kNumFiles };
+
+  struct PIDFiles {
+    std::array<int, static_cast<size_t>(ProcFile::kNumFiles)> fds = {-1, -1, -1};
+    // Whether any of the files was read since the last CloseUnusedFiles().
+    bool used = false;
+  };
+
+  // Returns the contents of the file of the process. The result refers to buf_, and is only valid
+  // until the next read.
+  StatusOr<std::string_view> ReadFile(int32_t pid, ProcFile file);
+
+  // Reads the whole file from offset 0 into buf_, growing buf_ as needed.
+  StatusOr<std::string_view> PReadFromStart(int fd);
+
+  void CloseFiles(PIDFiles* pid_files);
+
+  const size_t max_open_files_;
+  size_t num_open_files_ = 0;
+  absl::flat_hash_map<int32_t, PIDFiles> pid_files_;
+  std::vector<char> buf_ = std::vector<char>(4096);
+};
+
+}  // namespace system
+}  // namespace px
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/system/proc_stats_reader.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include "src/common/system/proc_pid_path.h"
+#include "src/common/testing/test_environment.h"
+#include "src/common/testing/testing.h"
+
+DECLARE_string(proc_path);
+
+namespace px {
+namespace system {
+
+constexpr char kTestDataBasePath[] = "src/common/system";
+
+namespace {
+std::string GetPathToTestDataFile(std::string_view fname) {
+  return testing::BazelRunfilePath(std::filesystem::path(kTestDataBasePath) / fname);
+}
+}  // namespace
+
+constexpr int kBytesPerPage = 4096;
+constexpr int kKernelTickTimeNS = 100;
+
+// Tests that the reader produces the same results as ProcParser, across repeated reads.
+TEST(ProcStatsReaderTest, MatchesProcParser) {
+  PX_SET_FOR_SCOPE(FLAGS_proc_path, GetPathToTestDataFile("testdata/proc"));
+
+  ProcParser parser;
+  ProcParser::ProcessStats expected_stats;
+  ASSERT_OK(parser.ParseProcPIDStat(123, kBytesPerPage, kKernelTickTimeNS, &expected_stats));
+  ASSERT_OK(parser.ParseProcPIDStatIO(123, &expected_stats));
+  ProcParser::NetworkStats expected_net_stats;
+  ASSERT_OK(parser.ParseProcPIDNetDev(123, &expected_net_stats));
+
+  ProcStatsReader reader;
+  for (int i = 0; i < 2; ++i) {
+    ProcParser::ProcessStats stats;
+    ASSERT_OK(reader.ParseProcPIDStat(123, kBytesPerPage, kKernelTickTimeNS, &stats));
+    ASSERT_OK(reader.ParseProcPIDStatIO(123, &stats));
+    EXPECT_EQ(stats.pid, 4602);
+    EXPECT_EQ(stats.process_name, "npm (start)");
+    EXPECT_EQ(stats.pid, expected_stats.pid);
+    EXPECT_EQ(stats.process_name, expected_stats.process_name);
+    EXPECT_EQ(stats.minor_faults, expected_stats.minor_faults);
+    EXPECT_EQ(stats.major_faults, expected_stats.major_faults);
+    EXPECT_EQ(stats.utime_ns, expected_stats.utime_ns);
+    EXPECT_EQ(stats.ktime_ns, expected_stats.ktime_ns);
+    EXPECT_EQ(stats.num_threads, expected_stats.num_threads);
+    EXPECT_EQ(stats.vsize_bytes, expected_stats.vsize_bytes);
+    EXPECT_EQ(stats.rss_bytes, expected_stats.rss_bytes);
+    EXPECT_EQ(stats.rchar_bytes, expected_stats.rchar_bytes);
+    EXPECT_EQ(stats.wchar_bytes, expected_stats.wchar_bytes);
+    EXPECT_EQ(stats.read_bytes, expected_stats.read_bytes);
+    EXPECT_EQ(stats.write_bytes, expected_stats.write_bytes);
+
+    ProcParser::NetworkStats net_stats;
+    ASSERT_OK(reader.ParseProcPIDNetDev(123, &net_stats));
+    EXPECT_EQ(net_stats.rx_bytes, expected_net_stats.rx_bytes);
+    EXPECT_EQ(net_stats.rx_packets, expected_net_stats.rx_packets);
+    EXPECT_EQ(net_stats.tx_bytes, expected_net_stats.tx_bytes);
+    EXPECT_EQ(net_stats.tx_packets, expected_net_stats.tx_packets);
+
+    // The files are kept open across reads.
+    EXPECT_EQ(reader.num_open_files(), 3);
+  }
+}
+
+// Tests that the files of the processes that are no longer read are closed.
+TEST(ProcStatsReaderTest, CloseUnusedFiles) {
+  ProcStatsReader reader;
+  ProcParser::ProcessStats stats;
+  ASSERT_OK(reader.ParseProcPIDStat(getpid(), kBytesPerPage, kKernelTickTimeNS, &stats));
+  EXPECT_EQ(stats.pid, getpid());
+  EXPECT_EQ(reader.num_open_files(), 1);
+
+  // Read since the previous call.
+  reader.CloseUnusedFiles();
+  EXPECT_EQ(reader.num_open_files(), 1);
+
+  // Not read since the previous call.
+  reader.CloseUnusedFiles();
+  EXPECT_EQ(reader.num_open_files(), 0);
+}
+
+// Tests that files are not kept open beyond the limit.
+TEST(ProcStatsReaderTest, MaxOpenFiles) {
+  ProcStatsReader reader(/*max_open_files*/ 1);
+  ProcParser::ProcessStats stats;
+  ASSERT_OK(reader.ParseProcPIDStat(getpid(), kBytesPerPage, kKernelTickTimeNS, &stats));
+  ASSERT_OK(reader.ParseProcPIDStatIO(getpid(), &stats));
+  ASSERT_OK(reader.ParseProcPIDStatIO(getpid(), &stats));
+  EXPECT_EQ(reader.num_open_files(), 1);
+}
+
+TEST(ProcStatsReaderTest, NonExistentPID) {
+  PX_SET_FOR_SCOPE(FLAGS_proc_path, GetPathToTestDataFile("testdata/proc"));
+  ProcStatsReader reader;
+  ProcParser::ProcessStats stats;
+  EXPECT_NOT_OK(reader.ParseProcPIDStat(999999, kBytesPerPage, kKernelTickTimeNS, &stats));
+  EXPECT_EQ(reader.num_open_files(), 0);
+}
+
+}  // namespace system
+}  // namespace px
@@ -461,58 +461,79 @@ void SocketProberManager::Update() {
 //-----------------------------------------------------------------------------
 
 StatusOr<std::unique_ptr<SocketInfoManager>> SocketInfoManager::Create(
-    std::filesystem::path proc_path, int conn_states) {
+    std::filesystem::path proc_path, int conn_states, std::chrono::milliseconds snapshot_ttl) {
   std::unique_ptr<SocketInfoManager> socket_info_db_ptr(
-      new SocketInfoManager(proc_path, conn_states));
+      new SocketInfoManager(proc_path, conn_states, snapshot_ttl));
   PX_ASSIGN_OR_RETURN(socket_info_db_ptr->socket_probers_, SocketProberManager::Create());
   return socket_info_db_ptr;
 }
 
-StatusOr<std::map<int, SocketInfo>*> SocketInfoManager::GetNamespaceConns(uint32_t pid) {
-  PX_ASSIGN_OR_RETURN(uint32_t net_ns, NetNamespace(cfg_proc_path_, pid));
+Status SocketInfoManager::ProbeNamespace(uint32_t net_ns, uint32_t pid,
+                                         NamespaceSnapshot* snapshot) {
+  PX_ASSIGN_OR_RETURN(NetlinkSocketProber * socket_prober,
+                      socket_probers_->GetOrCreateSocketProber(net_ns, {static_cast<int>(pid)}));
+  DCHECK(socket_prober != nullptr);
 
-  // Step 1: Get the map of connections for this network namespace.
-  // Create the map if it doesn't already exist.
-  std::map<int, SocketInfo>* namespace_conns;
+  snapshot->conns.clear();
+  snapshot->probe_time = std::chrono::steady_clock::now();
+  snapshot->probed_this_round = true;
 
-  auto ns_iter = connections_.find(net_ns);
-  if (ns_iter != connections_.end()) {
-    // Found a map of connections for this network namespace, so use it.
-    namespace_conns = &ns_iter->second;
-  } else {
-    // No map of connections for this network namespace, so use a socker prober to populate one.
-    PX_ASSIGN_OR_RETURN(NetlinkSocketProber * socket_prober,
-                        socket_probers_->GetOrCreateSocketProber(net_ns, {static_cast<int>(pid)}));
-    DCHECK(socket_prober != nullptr);
+  Status s;
 
-    ns_iter = connections_.insert(ns_iter, {static_cast<int>(net_ns), {}});
-    namespace_conns = &ns_iter->second;
+  s = socket_prober->InetConnections(&snapshot->conns, cfg_conn_states_);
+  LOG_IF(ERROR, !s.ok()) << absl::Substitute("Failed to probe InetConnections [net_ns=$0 msg=$1]",
+                                             net_ns, s.msg());
 
-    Status s;
+  s = socket_prober->UnixConnections(&snapshot->conns, cfg_conn_states_);
+  LOG_IF(ERROR, !s.ok()) << absl::Substitute("Failed to probe UnixConnections [net_ns=$0 msg=$1]",
+                                             net_ns, s.msg());
 
-    s = socket_prober->InetConnections(namespace_conns, cfg_conn_states_);
-    LOG_IF(ERROR, !s.ok()) << absl::Substitute("Failed to probe InetConnections [net_ns=$0 msg=$1]",
-                                               net_ns, s.msg());
+  ++num_socket_prober_calls_;
 
-    s = socket_prober->UnixConnections(namespace_conns, cfg_conn_states_);
-    LOG_IF(ERROR, !s.ok()) << absl::Substitute("Failed to probe UnixConnections [net_ns=$0 msg=$1]",
-                                               net_ns, s.msg());
+  return Status::OK();
+}
 
-    ++num_socket_prober_calls_;
+StatusOr<SocketInfoManager::NamespaceSnapshot*> SocketInfoManager::GetNamespaceSnapshot(
+    uint32_t pid) {
+  auto pid_iter = pid_net_ns_.find(pid);
+  if (pid_iter == pid_net_ns_.end()) {
+    PX_ASSIGN_OR_RETURN(uint32_t net_ns, NetNamespace(cfg_proc_path_, pid));
+    pid_iter = pid_net_ns_.emplace(pid, net_ns).first;
   }
+  const uint32_t net_ns = pid_iter->second;
+
+  // Get the snapshot of connections for this network namespace.
+  // Populate it if it doesn't already exist.
+  auto ns_iter = connections_.find(net_ns);
+  if (ns_iter == connections_.end()) {
+    NamespaceSnapshot snapshot;
+    PX_RETURN_IF_ERROR(ProbeNamespace(net_ns, pid, &snapshot));
+    ns_iter = connections_.emplace(net_ns, std::move(snapshot)).first;
+  }
+
+  return &ns_iter->second;
+}
 
-  return namespace_conns;
+StatusOr<std::map<int, SocketInfo>*> SocketInfoManager::GetNamespaceConns(uint32_t pid) {
+  PX_ASSIGN_OR_RETURN(NamespaceSnapshot * snapshot, GetNamespaceSnapshot(pid));
+  return &snapshot->conns;
 }
 
 StatusOr<SocketInfo*> SocketInfoManager::Lookup(uint32_t pid, uint32_t inode_num) {
-  // Step 1: Get the map of connections for this network namespace.
-  // Create the map if it doesn't already exist.
-  std::map<int, SocketInfo>* namespace_conns;
-  PX_ASSIGN_OR_RETURN(namespace_conns, GetNamespaceConns(pid));
+  // Step 1: Get the snapshot of connections for this network namespace.
+  NamespaceSnapshot* snapshot;
+  PX_ASSIGN_OR_RETURN(snapshot, GetNamespaceSnapshot(pid));
 
   // Step 2: Lookup the inode.
-  auto iter = namespace_conns->find(inode_num);
-  if (iter == namespace_conns->end()) {
+  auto iter = snapshot->conns.find(inode_num);
+
+  // A snapshot kept from a previous round may predate the connection, so refresh it once.
+  if (iter == snapshot->conns.end() && !snapshot->probed_this_round) {
+    PX_RETURN_IF_ERROR(ProbeNamespace(pid_net_ns_[pid], pid, snapshot));
+    iter = snapshot->conns.find(inode_num);
+  }
+
+  if (iter == snapshot->conns.end()) {
     return error::NotFound(
         "Likely not a TCP/Unix connection (might be some other socket type). Alternatively, might "
         "be looking in the wrong net namespace, which can happen if the target PID has connections "
@@ -524,8 +545,18 @@ StatusOr<SocketInfo*> SocketInfoManager::Lookup(uint32_t pid, uint32_t inode_num
 
 void SocketInfoManager::Flush() {
   socket_probers_->Update();
-  connections_.clear();
+  pid_net_ns_.clear();
   num_socket_prober_calls_ = 0;
+
+  const auto now = std::chrono::steady_clock::now();
+  for (auto iter = connections_.begin(); iter != connections_.end();) {
+    if (now - iter->second.probe_time >= cfg_snapshot_ttl_) {
+      connections_.erase(iter++);
+      continue;
+    }
+    iter->second.probed_this_round = false;
+    ++iter;
+  }
 }
 
 }  // namespace system
@@ -20,6 +20,7 @@
 
 #include <netinet/in.h>
 
+#include <chrono>
 #include <filesystem>
 #include <map>
 #include <memory>
@@ -27,6 +28,8 @@
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+
 #include "src/common/fs/fs_wrapper.h"
 #include "src/common/fs/inode_utils.h"
 
@@ -254,6 +257,11 @@ class SocketProberManager {
  * Note that no attempt is made to check if new connections have been created after the snapshot is
  * established. This responsibility is on the user, who must explicitly call Flush(), so that new
  * connections can be discovered.
+ *
+ * With a non-zero snapshot TTL, Flush() keeps the snapshots that are younger than the TTL, so that
+ * lookups across several rounds are served by a single dump of the namespace. A lookup that misses
+ * in a snapshot from a previous round re-probes the namespace, at most once per round, in case the
+ * connection was created after the snapshot.
  */
 class SocketInfoManager {
  public:
@@ -262,11 +270,13 @@ class SocketInfoManager {
    *
    * @param proc_path Path to the /proc filesystem
    * @param conn_states The connection states to probe for (established, listening, etc.).
+   * @param snapshot_ttl How long the snapshot of a network namespace is kept across Flush().
    * @return unique_ptr to the SocketInfoManager, or error if there were not enough privileges to
    * initialize the SocketInfoManager.
    */
   static StatusOr<std::unique_ptr<SocketInfoManager>> Create(
-      std::filesystem::path proc_path, int conn_states = kTCPEstablishedState);
+      std::filesystem::path proc_path, int conn_states = kTCPEstablishedState,
+      std::chrono::milliseconds snapshot_ttl = std::chrono::milliseconds{0});
 
   /**
    * Return all socket info for a given network namespace.
@@ -288,7 +298,8 @@ class SocketInfoManager {
   StatusOr<SocketInfo*> Lookup(uint32_t pid, uint32_t inode_num);
 
   /**
-   * Flushes the cache so new connections can be discovered.
+   * Flushes the cache so new connections can be discovered. Snapshots younger than the TTL are
+   * kept, but are re-probed on a lookup miss.
    */
   void Flush();
 
@@ -300,8 +311,24 @@ class SocketInfoManager {
   int num_socket_prober_calls() { return num_socket_prober_calls_; }
 
  private:
-  SocketInfoManager(std::filesystem::path proc_path, int conn_states)
-      : cfg_proc_path_(proc_path), cfg_conn_states_(conn_states) {}
+  SocketInfoManager(std::filesystem::path proc_path, int conn_states,
+                    std::chrono::milliseconds snapshot_ttl)
+      : cfg_proc_path_(proc_path),
+        cfg_conn_states_(conn_states),
+        cfg_snapshot_ttl_(snapshot_ttl) {}
+
+  struct NamespaceSnapshot {
+    // Socket inode to socket information.
+    std::map<int, SocketInfo> conns;
+    std::chrono::steady_clock::time_point probe_time;
+    // Whether the namespace was probed since the last Flush().
+    bool probed_this_round = false;
+  };
+
+  StatusOr<NamespaceSnapshot*> GetNamespaceSnapshot(uint32_t pid);
+
+  // Populates the snapshot of the network namespace, by dumping its connections.
+  Status ProbeNamespace(uint32_t net_ns, uint32_t pid, NamespaceSnapshot* snapshot);
 
   const std::filesystem::path cfg_proc_path_;
 
@@ -310,9 +337,14 @@ class SocketInfoManager {
   // See connection states at the top of this file.
   const int cfg_conn_states_;
 
-  // Two-level to socket information:
-  // First key is namespace inode; second key is socket inode.
-  std::map<int, std::map<int, SocketInfo>> connections_;
+  const std::chrono::milliseconds cfg_snapshot_ttl_;
+
+  // Snapshots of socket information, keyed by namespace inode.
+  std::map<int, NamespaceSnapshot> connections_;
+
+  // The network namespace of each PID looked up since the last Flush(), to save reading
+  // /proc/<pid>/ns/net for every connection of a process.
+  absl::flat_hash_map<uint32_t, uint32_t> pid_net_ns_;
 
   // Portal through which new connection information is gathered,
   // and populated into connections_.
@@ -178,5 +178,36 @@ TEST_F(NetNamespaceTest, SocketInfoManager) {
   }
 }
 
+TEST_F(NetNamespaceTest, SocketInfoManagerSnapshotTTL) {
+  const int kPID = container_.process_pid();
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<SocketInfoManager> socket_info_db,
+                       SocketInfoManager::Create(proc_path(),
+                                                 kTCPEstablishedState | kTCPListeningState,
+                                                 std::chrono::minutes(1)));
+
+  // See the SocketInfoManager test for FD 6.
+  constexpr pid_t kFD = 6;
+  const auto fd_path = ProcPidPath(kPID, "fd", std::to_string(kFD));
+  ASSERT_OK_AND_ASSIGN(std::filesystem::path fd_link, fs::ReadSymlink(fd_path));
+  ASSERT_OK_AND_ASSIGN(uint32_t inode_num,
+                       fs::ExtractInodeNum(fs::kSocketInodePrefix, fd_link.string()));
+
+  ASSERT_OK(socket_info_db->Lookup(kPID, inode_num));
+  EXPECT_EQ(socket_info_db->num_socket_prober_calls(), 1);
+
+  // The snapshot outlives the flush, so a hit doesn't probe again.
+  socket_info_db->Flush();
+  ASSERT_OK(socket_info_db->Lookup(kPID, inode_num));
+  EXPECT_EQ(socket_info_db->num_socket_prober_calls(), 0);
+
+  // A miss in a snapshot from a previous round probes again, but only once per round.
+  const uint32_t kUnusedInode = 3;
+  ASSERT_NOT_OK(socket_info_db->Lookup(kPID, kUnusedInode));
+  EXPECT_EQ(socket_info_db->num_socket_prober_calls(), 1);
+  ASSERT_NOT_OK(socket_info_db->Lookup(kPID, kUnusedInode));
+  EXPECT_EQ(socket_info_db->num_socket_prober_calls(), 1);
+}
+
 }  // namespace system
 }  // namespace px
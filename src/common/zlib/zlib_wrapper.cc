@@ -17,6 +17,7 @@
  */
 
 #include <zlib.h>
+#include <algorithm>
 #include <string>
 
 #include "src/common/base/base.h"
@@ -60,5 +61,117 @@ StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size) {
   return out;
 }
 
+namespace {
+
+// A z_stream that is initialized once per thread, and reset for every use, which avoids
+// allocating its ~40KB of state for every message.
+class ThreadLocalInflater {
+ public:
+  explicit ThreadLocalInflater(int window_bits) { ok_ = inflateInit2(&zs_, window_bits) == Z_OK; }
+  ~ThreadLocalInflater() {
+    if (ok_) {
+      inflateEnd(&zs_);
+    }
+  }
+
+  // Returns nullptr if the stream failed to initialize.
+  z_stream* Reset() {
+    if (!ok_ || inflateReset(&zs_) != Z_OK) {
+      return nullptr;
+    }
+    return &zs_;
+  }
+
+ private:
+  z_stream zs_ = {};
+  bool ok_ = false;
+};
+
+// Inflates in until max_output_bytes are produced, the stream ends, or the input runs out.
+// Returns the zlib return code of the last inflate() call.
+int InflateInto(z_stream* zs, std::string_view in, size_t max_output_bytes, std::string* out) {
+  zs->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+  zs->avail_in = in.size();
+
+  // Start with a guess of the compression ratio, and grow geometrically from there.
+  size_t capacity = std::min(max_output_bytes, std::max<size_t>(4 * in.size(), 256));
+  int ret = Z_OK;
+  while (true) {
+    out->resize(capacity);
+    zs->next_out = reinterpret_cast<Bytef*>(out->data() + zs->total_out);
+    zs->avail_out = capacity - zs->total_out;
+
+    ret = inflate(zs, Z_NO_FLUSH);
+    if (ret != Z_OK || zs->total_out < capacity || capacity == max_output_bytes) {
+      break;
+    }
+    capacity = std::min(max_output_bytes, 2 * capacity);
+  }
+  out->resize(zs->total_out);
+  return ret;
+}
+
+}  // namespace
+
+StatusOr<std::string> InflateBounded(std::string_view in, size_t max_output_bytes) {
+  // MAX_WBITS + 32 detects either of the gzip and zlib headers; -MAX_WBITS is raw deflate, which
+  // some servers send as Content-Encoding: deflate.
+  thread_local ThreadLocalInflater gzip_or_zlib_inflater(MAX_WBITS + 32);
+  thread_local ThreadLocalInflater raw_inflater(-MAX_WBITS);
+
+  std::string out;
+  if (max_output_bytes == 0) {
+    return out;
+  }
+
+  z_stream* zs = gzip_or_zlib_inflater.Reset();
+  if (zs == nullptr) {
+    return error::Internal("inflateInit2 failed while decompressing.");
+  }
+  int ret = InflateInto(zs, in, max_output_bytes, &out);
+  if (ret == Z_DATA_ERROR && zs->total_out == 0) {
+    zs = raw_inflater.Reset();
+    if (zs == nullptr) {
+      return error::Internal("inflateInit2 failed while decompressing.");
+    }
+    ret = InflateInto(zs, in, max_output_bytes, &out);
+  }
+
+  // Z_OK: Stopped at max_output_bytes. Z_BUF_ERROR: The input is truncated.
+  if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+    return error::Internal("Exception during zlib decompression: $0",
+                           zs->msg != nullptr ? zs->msg : "unknown error");
+  }
+  return out;
+}
+
+StatusOr<std::string> Gzip(std::string_view in, int level) {
+  z_stream zs = {};
+
+  // MAX_WBITS + 16 writes a gzip header and trailer around the deflate stream.
+  if (deflateInit2(&zs, level, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    return error::Internal("deflateInit2 failed while compressing.");
+  }
+
+  // deflateBound() is large enough to compress the whole input with a single deflate() call.
+  std::string out(deflateBound(&zs, in.size()), '\0');
+  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+  zs.avail_in = in.size();
+  zs.next_out = reinterpret_cast<Bytef*>(out.data());
+  zs.avail_out = out.size();
+
+  int ret = deflate(&zs, Z_FINISH);
+  out.resize(zs.total_out);
+
+  deflateEnd(&zs);
+
+  if (ret != Z_STREAM_END) {
+    return error::Internal("Exception during zlib compression: $0",
+                           zs.msg != nullptr ? zs.msg : "unknown error");
+  }
+
+  return out;
+}
+
 }  // namespace zlib
 }  // namespace px
@@ -35,5 +35,26 @@ namespace zlib {
  */
 StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size = 16384);
 
+/**
+ * @brief Inflates a gzip, zlib or raw deflate stream, and stops as soon as max_output_bytes have
+ * been produced, so the CPU and memory spent are bounded by max_output_bytes, not by the
+ * compression ratio. The input may also be truncated: the content decompressed up to that point
+ * is returned. The decompression state is reused across the calls on each thread.
+ *
+ * @param in A view into the source buffer.
+ * @param max_output_bytes The maximum size of the decompressed content.
+ * @return Status or the first max_output_bytes of the decompressed content.
+ */
+StatusOr<std::string> InflateBounded(std::string_view in, size_t max_output_bytes);
+
+/**
+ * @brief Compresses a buffer into the gzip format, which Inflate() decompresses.
+ *
+ * @param in A view into the source buffer.
+ * @param level The zlib compression level, from 1 (fastest) to 9 (smallest).
+ * @return Status or the compressed content.
+ */
+StatusOr<std::string> Gzip(std::string_view in, int level = 6);
+
 }  // namespace zlib
 }  // namespace px
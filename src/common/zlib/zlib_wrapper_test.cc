@@ -46,4 +46,66 @@ TEST_F(ZlibTest, inflate_test) {
   EXPECT_OK_AND_EQ(result, GetExpectedResult());
 }
 
+// Compresses in, with window_bits selecting the format as in deflateInit2().
+std::string Deflate(std::string_view in, int window_bits) {
+  z_stream zs = {};
+  CHECK_EQ(deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY),
+           Z_OK);
+  std::string out(deflateBound(&zs, in.size()) + 32, '\0');
+  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+  zs.avail_in = in.size();
+  zs.next_out = reinterpret_cast<Bytef*>(out.data());
+  zs.avail_out = out.size();
+  CHECK_EQ(deflate(&zs, Z_FINISH), Z_STREAM_END);
+  out.resize(zs.total_out);
+  deflateEnd(&zs);
+  return out;
+}
+
+TEST_F(ZlibTest, inflate_bounded_test) {
+  EXPECT_OK_AND_EQ(px::zlib::InflateBounded(GetCompressedString(), 1024), GetExpectedResult());
+  EXPECT_OK_AND_EQ(px::zlib::InflateBounded(GetCompressedString(), 4), "This");
+  EXPECT_OK_AND_EQ(px::zlib::InflateBounded(GetCompressedString(), 0), "");
+}
+
+TEST_F(ZlibTest, inflate_bounded_formats_test) {
+  const std::string text(100000, 'a');
+  for (int window_bits : {MAX_WBITS + 16, MAX_WBITS, -MAX_WBITS}) {
+    std::string compressed = Deflate(text, window_bits);
+    EXPECT_OK_AND_EQ(px::zlib::InflateBounded(compressed, text.size()), text) << window_bits;
+    // Stops at the bound, however much more the input would decompress to.
+    EXPECT_OK_AND_EQ(px::zlib::InflateBounded(compressed, 1000), text.substr(0, 1000))
+        << window_bits;
+  }
+}
+
+TEST_F(ZlibTest, inflate_bounded_truncated_input_test) {
+  std::string text;
+  for (int i = 0; i < 10000; ++i) {
+    text += std::to_string(i);
+  }
+  std::string compressed = Deflate(text, MAX_WBITS + 16);
+
+  ASSERT_OK_AND_ASSIGN(std::string result,
+                       px::zlib::InflateBounded(compressed.substr(0, compressed.size() / 2),
+                                                text.size()));
+  EXPECT_GT(result.size(), 0);
+  EXPECT_LT(result.size(), text.size());
+  EXPECT_EQ(result, text.substr(0, result.size()));
+}
+
+TEST_F(ZlibTest, inflate_bounded_invalid_input_test) {
+  EXPECT_NOT_OK(px::zlib::InflateBounded("not compressed at all", 1024));
+}
+
+TEST_F(ZlibTest, gzip_round_trip_test) {
+  const std::string text = "This is a test\n" + std::string(100000, 'a');
+  ASSERT_OK_AND_ASSIGN(std::string compressed, px::zlib::Gzip(text));
+  EXPECT_LT(compressed.size(), text.size());
+  EXPECT_OK_AND_EQ(px::zlib::Inflate(compressed), text);
+
+  ASSERT_OK_AND_ASSIGN(compressed, px::zlib::Gzip(""));
+  EXPECT_OK_AND_EQ(px::zlib::Inflate(compressed), "");
+}
+
 }  // namespace px
@@ -0,0 +1,294 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Plans every script in src/pxl_scripts against the schemas Stirling exports and a simulated
+// cluster of PEMs, reporting the time spent per planning phase. Run with --v=1 to also log the
+// rules that take the most time.
+
+#include <rapidjson/document.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <benchmark/benchmark.h>
+
+#include "src/carnot/planner/compiler/compiler.h"
+#include "src/carnot/planner/distributed/distributed_planner.h"
+#include "src/carnot/planner/logical_planner.h"
+#include "src/common/fs/fs_wrapper.h"
+#include "src/common/testing/test_environment.h"
+#include "src/common/uuid/uuid_utils.h"
+#include "src/e2e_test/vizier/planner/dump_schemas/dump_schemas.h"
+#include "src/vizier/funcs/funcs.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+namespace {
+
+constexpr char kScriptDir[] = "src/pxl_scripts";
+constexpr int64_t kMaxOutputRowsPerTable = 10000;
+
+struct Script {
+  std::string name;
+  plannerpb::QueryRequest query_request;
+};
+
+// Mirrors the argument defaults that src/e2e_test/vizier/planner/all_scripts_test.go uses.
+std::string DefaultForType(std::string_view px_type) {
+  if (px_type == "PX_BOOLEAN") return "True";
+  if (px_type == "PX_INT64") return "1";
+  if (px_type == "PX_FLOAT64") return "1.0";
+  if (px_type == "PX_SERVICE" || px_type == "PX_POD" || px_type == "PX_CONTAINER" ||
+      px_type == "PX_NAMESPACE" || px_type == "PX_NODE") {
+    return "pl";
+  }
+  if (px_type == "PX_LIST") return "[]";
+  if (px_type == "PX_STRING_LIST") return "[\"\"]";
+  return "";
+}
+
+void AddExecFunc(const rapidjson::Value& func,
+                 const absl::flat_hash_map<std::string, std::string>& variable_values,
+                 plannerpb::QueryRequest* query_request) {
+  auto exec_func = query_request->add_exec_funcs();
+  exec_func->set_func_name(func["name"].GetString());
+  exec_func->set_output_table_prefix(func["name"].GetString());
+  if (!func.HasMember("args")) {
+    return;
+  }
+  for (const auto& arg : func["args"].GetArray()) {
+    auto arg_value = exec_func->add_arg_values();
+    arg_value->set_name(arg["name"].GetString());
+    if (arg.HasMember("variable")) {
+      auto it = variable_values.find(arg["variable"].GetString());
+      if (it != variable_values.end()) {
+        arg_value->set_value(it->second);
+      }
+    } else if (arg.HasMember("value")) {
+      arg_value->set_value(arg["value"].GetString());
+    }
+  }
+}
+
+StatusOr<Script> LoadScript(const std::filesystem::path& pxl_path) {
+  Script script;
+  script.name = absl::StrCat(pxl_path.parent_path().parent_path().filename().string(), "/",
+                             pxl_path.parent_path().filename().string());
+  PX_ASSIGN_OR_RETURN(std::string query, ReadFileToString(pxl_path.string()));
+  script.query_request.set_query_str(query);
+
+  auto vis_path = pxl_path.parent_path() / "vis.json";
+  if (!fs::Exists(vis_path)) {
+    return script;
+  }
+  PX_ASSIGN_OR_RETURN(std::string vis_str, ReadFileToString(vis_path.string()));
+  rapidjson::Document vis;
+  vis.Parse(vis_str.c_str());
+  if (vis.HasParseError() || !vis.IsObject()) {
+    return error::InvalidArgument("Failed to parse $0", vis_path.string());
+  }
+
+  absl::flat_hash_map<std::string, std::string> variable_values;
+  if (vis.HasMember("variables")) {
+    for (const auto& variable : vis["variables"].GetArray()) {
+      std::string value;
+      if (variable.HasMember("defaultValue") &&
+          !std::string_view(variable["defaultValue"].GetString()).empty()) {
+        value = variable["defaultValue"].GetString();
+      } else if (variable.HasMember("validValues") && !variable["validValues"].Empty()) {
+        value = variable["validValues"][0].GetString();
+      } else if (variable.HasMember("type")) {
+        value = DefaultForType(variable["type"].GetString());
+      }
+      variable_values[variable["name"].GetString()] = value;
+    }
+  }
+  if (vis.HasMember("globalFuncs")) {
+    for (const auto& global_func : vis["globalFuncs"].GetArray()) {
+      AddExecFunc(global_func["func"], variable_values, &script.query_request);
+    }
+  }
+  if (vis.HasMember("widgets")) {
+    for (const auto& widget : vis["widgets"].GetArray()) {
+      if (widget.HasMember("func")) {
+        AddExecFunc(widget["func"], variable_values, &script.query_request);
+      }
+    }
+  }
+  return script;
+}
+
+const std::vector<Script>& Scripts() {
+  static const std::vector<Script>* scripts = [] {
+    auto scripts = new std::vector<Script>();
+    auto script_dir = testing::BazelRunfilePath(kScriptDir);
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(script_dir)) {
+      if (entry.path().extension() != ".pxl") {
+        continue;
+      }
+      auto script_or_s = LoadScript(entry.path());
+      if (!script_or_s.ok()) {
+        LOG(WARNING) << script_or_s.status().msg();
+        continue;
+      }
+      // Mutations deploy tracepoints rather than plan queries, so they are skipped.
+      if (absl::StrContains(script_or_s.ValueOrDie().query_request.query_str(), "pxtrace")) {
+        continue;
+      }
+      scripts->push_back(script_or_s.ConsumeValueOrDie());
+    }
+    std::sort(scripts->begin(), scripts->end(),
+              [](const Script& a, const Script& b) { return a.name < b.name; });
+    return scripts;
+  }();
+  return *scripts;
+}
+
+RegistryInfo* Registry() {
+  static RegistryInfo* registry_info = [] {
+    udf::Registry registry("benchmark_registry");
+    vizier::funcs::VizierFuncFactoryContext ctx;
+    vizier::funcs::RegisterFuncsOrDie(ctx, &registry);
+    auto registry_info = new RegistryInfo();
+    PX_CHECK_OK(registry_info->Init(registry.ToProto()));
+    return registry_info;
+  }();
+  return registry_info;
+}
+
+const table_store::schemapb::Schema& Schema() {
+  static const table_store::schemapb::Schema* schema = [] {
+    int len = 0;
+    char* schema_str = DumpSchemas(&len);
+    auto schema = new table_store::schemapb::Schema();
+    CHECK(schema->ParseFromArray(schema_str, len));
+    delete[] schema_str;
+    return schema;
+  }();
+  return *schema;
+}
+
+distributedpb::LogicalPlannerState MakePlannerState(int64_t num_pems) {
+  distributedpb::LogicalPlannerState state;
+  state.set_result_address("result_addr");
+  state.set_result_ssl_targetname("result_ssl_targetname");
+  state.mutable_plan_options()->set_max_output_rows_per_table(kMaxOutputRowsPerTable);
+
+  auto distributed_state = state.mutable_distributed_state();
+  std::vector<uuidpb::UUID> pem_ids;
+  for (int64_t i = 0; i < num_pems; ++i) {
+    auto pem = distributed_state->add_carnot_info();
+    ToProto(sole::uuid4(), pem->mutable_agent_id());
+    pem->set_query_broker_address(absl::StrCat("pem", i));
+    pem->set_has_data_store(true);
+    pem->set_processes_data(true);
+    pem_ids.push_back(pem->agent_id());
+  }
+  auto kelvin = distributed_state->add_carnot_info();
+  ToProto(sole::uuid4(), kelvin->mutable_agent_id());
+  kelvin->set_query_broker_address("kelvin");
+  kelvin->set_grpc_address("1.1.1.1");
+  kelvin->set_ssl_targetname("ssl_targetname");
+  kelvin->set_has_grpc_server(true);
+  kelvin->set_processes_data(true);
+  kelvin->set_accepts_remote_sources(true);
+
+  for (const auto& [name, relation] : Schema().relation_map()) {
+    auto schema_info = distributed_state->add_schema_info();
+    schema_info->set_name(name);
+    *schema_info->mutable_relation() = relation;
+    for (const auto& pem_id : pem_ids) {
+      *schema_info->add_agent_list() = pem_id;
+    }
+  }
+  return state;
+}
+
+void LogSlowestRules(const PlannerTimings& timings, int64_t iterations) {
+  std::vector<std::pair<std::string, PlannerTimings::Entry>> rules(timings.rules.begin(),
+                                                                   timings.rules.end());
+  std::sort(rules.begin(), rules.end(),
+            [](const auto& a, const auto& b) { return a.second.total_ns > b.second.total_ns; });
+  constexpr size_t kNumRulesToLog = 15;
+  for (size_t i = 0; i < std::min(kNumRulesToLog, rules.size()); ++i) {
+    VLOG(1) << absl::Substitute("$0: $1 calls, $2 us per iteration", rules[i].first,
+                                rules[i].second.num_calls / iterations,
+                                rules[i].second.total_ns / iterations / 1000);
+  }
+}
+
+}  // namespace
+
+// Plans every script once per iteration. state.range(0) is the number of PEMs.
+// NOLINTNEXTLINE : runtime/references.
+void BM_PlanAllScripts(benchmark::State& state) {
+  const auto& scripts = Scripts();
+  auto planner_state = MakePlannerState(state.range(0));
+  compiler::Compiler compiler;
+  auto distributed_planner = distributed::DistributedPlanner::Create().ConsumeValueOrDie();
+
+  PlannerTimings timings;
+  int64_t num_failed = 0;
+  for (auto _ : state) {
+    for (const auto& script : scripts) {
+      auto compiler_state =
+          CreateCompilerState(planner_state, Registry(), kMaxOutputRowsPerTable)
+              .ConsumeValueOrDie();
+      compiler_state->set_planner_timings(&timings);
+      std::vector<plannerpb::FuncToExecute> exec_funcs(script.query_request.exec_funcs().begin(),
+                                                       script.query_request.exec_funcs().end());
+      auto ir_or_s = compiler.CompileToIR(script.query_request.query_str(), compiler_state.get(),
+                                          exec_funcs);
+      if (!ir_or_s.ok()) {
+        ++num_failed;
+        VLOG(1) << absl::Substitute("$0 failed to compile: $1", script.name,
+                                    ir_or_s.status().msg());
+        continue;
+      }
+      auto plan_or_s = distributed_planner->Plan(planner_state.distributed_state(),
+                                                 compiler_state.get(), ir_or_s.ValueOrDie().get());
+      if (!plan_or_s.ok()) {
+        ++num_failed;
+        VLOG(1) << absl::Substitute("$0 failed to distribute: $1", script.name,
+                                    plan_or_s.status().msg());
+      }
+    }
+  }
+
+  const int64_t iterations = state.iterations();
+  state.counters["scripts"] = scripts.size();
+  state.counters["failed"] = static_cast<double>(num_failed) / iterations;
+  for (const auto& [phase, entry] : timings.phases) {
+    state.counters[absl::StrCat(phase, "_ms")] =
+        static_cast<double>(entry.total_ns) / iterations / 1000 / 1000;
+  }
+  LogSlowestRules(timings, iterations);
+}
+
+BENCHMARK(BM_PlanAllScripts)->Arg(100)->Arg(500)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -19,11 +19,14 @@
 #pragma once
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/strings/substitute.h>
+#include <absl/synchronization/mutex.h>
 #include <grpcpp/grpcpp.h>
 #include <algorithm>
 #include <memory>
 #include <queue>
 #include <string>
+#include <utility>
 
 #include "src/api/proto/vizierpb/vizierapi.pb.h"
 #include "src/carnot/carnotpb/carnot.grpc.pb.h"
@@ -42,6 +45,8 @@ using QueryExecStats = carnotpb::TransferResultChunkRequest_QueryExecutionAndTim
 // It is then responsible for forwarding the results to the proper consumer stream.
 class StandaloneResultSinkServer final : public carnotpb::ResultSinkService::Service {
  public:
+  using ResponseWriter = ::grpc::ServerWriter<::px::api::vizierpb::ExecuteScriptResponse>;
+
   // Implements the TransferResultChunkAPI of ResultSinkService.
   ::grpc::Status TransferResultChunk(
       ::grpc::ServerContext*,
@@ -50,18 +55,16 @@ class StandaloneResultSinkServer final : public carnotpb::ResultSinkService::Ser
     auto rb = std::make_unique<carnotpb::TransferResultChunkRequest>();
     sole::uuid query_id;
 
+    // Each chunk is forwarded to the client as soon as it is read. Writing to the client blocks
+    // while its stream is full, and the in-process channel only takes the next chunk once this one
+    // is read, so a slow client slows down the query instead of results piling up in memory.
     while (reader->Read(rb.get())) {
       query_id = ::px::ParseUUID(rb->query_id()).ConsumeValueOrDie();
 
-      ::grpc::ServerWriter<::px::api::vizierpb::ExecuteScriptResponse>* consumer;
-      {
-        absl::base_internal::SpinLockHolder lock(&id_to_query_consumer_map_lock_);
-        auto consumer_pair = consumer_map_.find(query_id);
-        if (consumer_pair == consumer_map_.end()) {
-          response->set_success(false);
-          return ::grpc::Status::CANCELLED;
-        }
-        consumer = consumer_pair->second;
+      std::shared_ptr<Consumer> consumer = GetConsumer(query_id);
+      if (consumer == nullptr) {
+        response->set_success(false);
+        return ::grpc::Status::CANCELLED;
       }
 
       ::px::api::vizierpb::ExecuteScriptResponse resp;
@@ -70,27 +73,28 @@ class StandaloneResultSinkServer final : public carnotpb::ResultSinkService::Ser
       if (rb->has_execution_and_timing_info()) {
         HandleExecutionAndTimingInfo(&resp, rb.get());
         consumer->Write(resp);
-        {
-          // Query is complete.
-          absl::base_internal::SpinLockHolder lock(&id_to_query_consumer_map_lock_);
-          consumer_map_.erase(query_id);
-        }
       }
 
       if (rb->has_query_result()) {
         HandleQueryResult(&resp, rb.get());
 
-        consumer->Write(resp);
+        if (!consumer->Write(resp)) {
+          // The client went away, so the rest of the results can't be delivered. Ask the sink to
+          // stop sending, which stops the query early instead of running it to completion.
+          LOG(INFO) << absl::Substitute("Client of query $0 is gone, stopping its results",
+                                        query_id.str());
+          RemoveConsumer(query_id);
+          response->set_success(true);
+          response->set_stop_sending(true);
+          return ::grpc::Status::OK;
+        }
       }
 
       if (rb->has_execution_error()) {
         auto exec_error = rb->execution_error();
         if (exec_error.err_code() == 0) {
           response->set_success(true);
-          {
-            absl::base_internal::SpinLockHolder lock(&id_to_query_consumer_map_lock_);
-            consumer_map_.erase(query_id);
-          }
+          RemoveConsumer(query_id);
           return ::grpc::Status::OK;
         }
         auto status = resp.mutable_status();
@@ -98,6 +102,10 @@ class StandaloneResultSinkServer final : public carnotpb::ResultSinkService::Ser
         consumer->Write(resp);
       }
 
+      if (rb->has_execution_and_timing_info()) {
+        // Query is complete.
+        RemoveConsumer(query_id);
+      }
       rb = std::make_unique<carnotpb::TransferResultChunkRequest>();
     }
 
@@ -109,7 +117,24 @@ class StandaloneResultSinkServer final : public carnotpb::ResultSinkService::Ser
                    ::grpc::ServerWriter<::px::api::vizierpb::ExecuteScriptResponse>* response) {
     absl::base_internal::SpinLockHolder lock(&id_to_query_consumer_map_lock_);
 
-    consumer_map_[query_id] = response;
+    consumer_map_[query_id] = std::make_shared<Consumer>(response);
+  }
+
+  // Removes the consumer of the query. Its stream must not be written once the ExecuteScript call
+  // that added it returns, so this is called when the query is done, whatever its outcome.
+  void RemoveConsumer(sole::uuid query_id) {
+    std::shared_ptr<Consumer> consumer;
+    {
+      absl::base_internal::SpinLockHolder lock(&id_to_query_consumer_map_lock_);
+      auto it = consumer_map_.find(query_id);
+      if (it == consumer_map_.end()) {
+        return;
+      }
+      consumer = std::move(it->second);
+      consumer_map_.erase(it);
+    }
+    // Wait for writes in flight, after which no one writes to the stream.
+    consumer->Close();
   }
 
  private:
@@ -179,8 +204,46 @@ class StandaloneResultSinkServer final : public carnotpb::ResultSinkService::Ser
     timing->set_compilation_time_ns(timing_info.execution_stats().timing().compilation_time_ns());
   }
 
-  absl::flat_hash_map<sole::uuid, ::grpc::ServerWriter<::px::api::vizierpb::ExecuteScriptResponse>*>
-      consumer_map_ GUARDED_BY(id_to_query_consumer_map_lock_);
+  // The client stream of a query. The results of a query can arrive on several sink streams at
+  // once, which are handled by different threads, so the writes to the client are serialized.
+  class Consumer {
+   public:
+    explicit Consumer(ResponseWriter* writer) : writer_(writer) {}
+
+    // Returns false if the client stream is closed.
+    bool Write(const ::px::api::vizierpb::ExecuteScriptResponse& resp) {
+      absl::MutexLock lock(&lock_);
+      if (writer_ == nullptr) {
+        return false;
+      }
+      if (!writer_->Write(resp)) {
+        writer_ = nullptr;
+        return false;
+      }
+      return true;
+    }
+
+    void Close() {
+      absl::MutexLock lock(&lock_);
+      writer_ = nullptr;
+    }
+
+   private:
+    absl::Mutex lock_;
+    ResponseWriter* writer_ ABSL_GUARDED_BY(lock_);
+  };
+
+  std::shared_ptr<Consumer> GetConsumer(sole::uuid query_id) {
+    absl::base_internal::SpinLockHolder lock(&id_to_query_consumer_map_lock_);
+    auto it = consumer_map_.find(query_id);
+    if (it == consumer_map_.end()) {
+      return nullptr;
+    }
+    return it->second;
+  }
+
+  absl::flat_hash_map<sole::uuid, std::shared_ptr<Consumer>> consumer_map_
+      GUARDED_BY(id_to_query_consumer_map_lock_);
   mutable absl::base_internal::SpinLock id_to_query_consumer_map_lock_;
 };
 
@@ -212,6 +275,8 @@ class StandaloneGRPCResultSinkServer {
     result_sink_server_.AddConsumer(query_id, response);
   }
 
+  void RemoveConsumer(sole::uuid query_id) { result_sink_server_.RemoveConsumer(query_id); }
+
  private:
   std::unique_ptr<grpc::Server> grpc_server_;
   StandaloneResultSinkServer result_sink_server_;
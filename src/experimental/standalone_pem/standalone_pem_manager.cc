@@ -16,6 +16,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -49,6 +50,24 @@ DEFINE_int32(table_store_proc_exit_events_limit_bytes,
              gflags::Int32FromEnv("PL_TABLE_STORE_PROC_EXIT_EVENTS_LIMIT_BYTES", 10 * 1024 * 1024),
              "The maximum amount of data to store in the proc_exit_events table.");
 
+DEFINE_bool(table_store_dynamic_retention,
+            gflags::BoolFromEnv("PL_TABLE_STORE_DYNAMIC_RETENTION", false),
+            "Split the table store data limit between the tables dynamically, by their weights and "
+            "how much they are written, instead of giving each table a fixed size.");
+
+DEFINE_string(table_store_table_weights, gflags::StringFromEnv("PL_TABLE_STORE_TABLE_WEIGHTS", ""),
+              "Comma separated table_name=weight pairs for the dynamic retention of the table "
+              "store. Tables default to a weight proportional to their fixed size.");
+
+DEFINE_string(table_store_table_min_retention_s,
+              gflags::StringFromEnv("PL_TABLE_STORE_TABLE_MIN_RETENTION_S", ""),
+              "Comma separated table_name=seconds pairs for the dynamic retention of the table "
+              "store. A table that holds less than this much data isn't shrunk for other tables.");
+
+DEFINE_int32(table_store_retention_rebalance_period_s,
+             gflags::Int32FromEnv("PL_TABLE_STORE_RETENTION_REBALANCE_PERIOD_S", 10),
+             "The period with which the dynamic retention of the table store is rebalanced.");
+
 namespace px {
 namespace vizier {
 namespace agent {
@@ -128,6 +147,9 @@ Status StandalonePEMManager::Init() {
   stirling_->RegisterUserDebugSignalHandlers();
 
   PX_RETURN_IF_ERROR(InitSchemas());
+  // Compaction keeps the memory of the table store close to its data limit, as in the PEM.
+  table_store_->StartCompactionScheduler(kTableStoreCompactionPeriod);
+  StartRetentionRebalancing();
 
   // Register the metadata update timer.
   std::chrono::seconds update_period(5);
@@ -168,6 +190,9 @@ Status StandalonePEMManager::InitSchemas() {
                               probe_status_table_size - proc_exit_events_table_size) /
                              (num_tables - 4);
 
+  // The fixed sizes are the initial sizes of the tables, and their default weights when the
+  // retention is dynamic.
+  table_store::TableRetentionSpecs retention_specs;
   for (const auto& relation_info : relation_info_vec) {
     std::shared_ptr<table_store::Table> table_ptr;
     if (relation_info.name == "http_events") {
@@ -190,12 +215,35 @@ Status StandalonePEMManager::InitSchemas() {
                                                        other_table_size);
     }
 
+    retention_specs[relation_info.name].weight = table_ptr->GetTableStats().max_table_size;
     table_store_->AddTable(std::move(table_ptr), relation_info.name, relation_info.id);
     // PX_RETURN_IF_ERROR(relation_info_manager_->AddRelationInfo(relation_info));
   }
+
+  if (FLAGS_table_store_dynamic_retention) {
+    PX_RETURN_IF_ERROR(table_store::RetentionBudget::ParseSpecs(
+        FLAGS_table_store_table_weights, FLAGS_table_store_table_min_retention_s,
+        &retention_specs));
+    table_store_->SetRetentionBudget(memory_limit, std::move(retention_specs));
+  }
   return Status::OK();
 }
 
+void StandalonePEMManager::StartRetentionRebalancing() {
+  if (!FLAGS_table_store_dynamic_retention) {
+    return;
+  }
+  auto period = std::chrono::seconds(std::max(FLAGS_table_store_retention_rebalance_period_s, 1));
+  retention_rebalance_timer_ = dispatcher_->CreateTimer([this, period]() {
+    auto s = table_store_->RebalanceRetention();
+    LOG_IF(ERROR, !s.ok()) << "Failed to rebalance the table store retention: " << s.msg();
+    if (retention_rebalance_timer_) {
+      retention_rebalance_timer_->EnableTimer(period);
+    }
+  });
+  retention_rebalance_timer_->EnableTimer(period);
+}
+
 Status StandalonePEMManager::Stop(std::chrono::milliseconds timeout) {
   // Already stopping, protect against multiple calls.
   if (stop_called_) {
@@ -204,6 +252,7 @@ Status StandalonePEMManager::Stop(std::chrono::milliseconds timeout) {
   stop_called_ = true;
 
   dispatcher_->Stop();
+  table_store_->StopCompactionScheduler();
   auto s = StopImpl(timeout);
 
   // Wait for a limited amount of time for main thread to stop processing.
@@ -56,8 +56,13 @@ class StandalonePEMManager : public BaseManager {
  private:
   int port_;
   Status InitSchemas();
+  // Periodically splits the table store data limit between the tables, if the retention is
+  // dynamic.
+  void StartRetentionRebalancing();
   Status StopImpl(std::chrono::milliseconds);
 
+  static constexpr auto kTableStoreCompactionPeriod = std::chrono::minutes(1);
+
   // The time system to use (real or simulated).
   std::unique_ptr<px::event::TimeSystem> time_system_;
 
@@ -84,6 +89,7 @@ class StandalonePEMManager : public BaseManager {
   std::unique_ptr<px::md::AgentMetadataStateManager> mds_manager_;
   // The timer to manage metadata updates.
   px::event::TimerUPtr metadata_update_timer_;
+  px::event::TimerUPtr retention_rebalance_timer_;
 
   // Tracepoints
   std::unique_ptr<TracepointManager> tracepoint_manager_;
@@ -177,6 +177,8 @@ class VizierServer final : public api::vizierpb::VizierService::Service {
 
     sink_server_->AddConsumer(query_id, response);
     auto s = carnot_->ExecuteQuery(reader->query_str(), query_id, px::CurrentTimeNS());
+    // The response stream is only valid for the duration of this call.
+    sink_server_->RemoveConsumer(query_id);
     if (s != Status::OK()) {
       return ::grpc::Status::CANCELLED;
     }
@@ -39,6 +39,7 @@ class GRPCClockConverter : public clock::ClockConverter {
   GRPCClockConverter();
 
   uint64_t Convert(uint64_t monotonic_time) const override;
+  void ConvertBatch(absl::Span<uint64_t> monotonic_times) const override;
   void Update() override;
   std::chrono::milliseconds UpdatePeriod() const override { return update_period_; }
 
@@ -26,6 +26,7 @@
 
 #include "src/datagen/datagen.h"
 #include "src/shared/bloomfilter/bloomfilter.h"
+#include "src/shared/bloomfilter/split_block_bloom_filter.h"
 
 namespace px {
 namespace bloomfilter {
@@ -74,10 +75,70 @@ BENCHMARK_DEFINE_F(BloomFilterBenchmark, LookupTest)(benchmark::State& state) {
   state.SetItemsProcessed(state.iterations() * random_strs_.size());
 }
 
+class SplitBlockBloomFilterBenchmark : public benchmark::Fixture {
+  void SetUp(const ::benchmark::State& state) {
+    auto num_items = state.range(0);
+    auto error_rate = 1.0 / state.range(1);
+    insert_bf_ = SplitBlockBloomFilter::Create(num_items * 2, error_rate).ConsumeValueOrDie();
+    lookup_bf_ = SplitBlockBloomFilter::Create(num_items * 2, error_rate).ConsumeValueOrDie();
+    // Look up an equal mix of present and absent keys.
+    hashes_.reserve(num_items);
+    for (auto i = 0; i < num_items; ++i) {
+      hashes_.push_back(SplitBlockBloomFilter::Hash(datagen::RandomString(16)));
+      if (i % 2 == 0) {
+        lookup_bf_->InsertHash(hashes_[i]);
+      }
+    }
+    results_.reset(new bool[num_items]);
+  }
+
+ protected:
+  std::vector<uint64_t> hashes_;
+  std::unique_ptr<bool[]> results_;
+  std::unique_ptr<SplitBlockBloomFilter> insert_bf_;
+  std::unique_ptr<SplitBlockBloomFilter> lookup_bf_;
+};
+
+// NOLINTNEXTLINE : runtime/references.
+BENCHMARK_DEFINE_F(SplitBlockBloomFilterBenchmark, InsertTest)(benchmark::State& state) {
+  for (auto _ : state) {
+    for (uint64_t hash : hashes_) {
+      insert_bf_->InsertHash(hash);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * hashes_.size());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+BENCHMARK_DEFINE_F(SplitBlockBloomFilterBenchmark, LookupTest)(benchmark::State& state) {
+  for (auto _ : state) {
+    for (size_t i = 0; i < hashes_.size(); ++i) {
+      results_[i] = lookup_bf_->ContainsHash(hashes_[i]);
+    }
+    benchmark::DoNotOptimize(results_.get());
+  }
+  state.SetItemsProcessed(state.iterations() * hashes_.size());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+BENCHMARK_DEFINE_F(SplitBlockBloomFilterBenchmark, ContainsManyTest)(benchmark::State& state) {
+  for (auto _ : state) {
+    lookup_bf_->ContainsMany(hashes_, absl::MakeSpan(results_.get(), hashes_.size()));
+    benchmark::DoNotOptimize(results_.get());
+  }
+  state.SetItemsProcessed(state.iterations() * hashes_.size());
+}
+
 BENCHMARK_REGISTER_F(BloomFilterBenchmark, InsertTest)
     ->Ranges({{1 << 10, 1 << 20}, {10, 100000}, {8, 256}});
 BENCHMARK_REGISTER_F(BloomFilterBenchmark, LookupTest)
     ->Ranges({{1 << 10, 1 << 20}, {10, 100000}, {8, 256}});
+BENCHMARK_REGISTER_F(SplitBlockBloomFilterBenchmark, InsertTest)
+    ->Ranges({{1 << 10, 1 << 20}, {10, 100000}});
+BENCHMARK_REGISTER_F(SplitBlockBloomFilterBenchmark, LookupTest)
+    ->Ranges({{1 << 10, 1 << 20}, {10, 100000}});
+BENCHMARK_REGISTER_F(SplitBlockBloomFilterBenchmark, ContainsManyTest)
+    ->Ranges({{1 << 10, 1 << 20}, {10, 100000}});
 
 }  // namespace bloomfilter
 }  // namespace px
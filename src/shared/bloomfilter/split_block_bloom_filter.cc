@@ -0,0 +1,171 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/shared/bloomfilter/split_block_bloom_filter.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+PX_SUPPRESS_WARNINGS_START()
+// NOLINTNEXTLINE: build/include_subdir
+#include "xxhash.h"
+PX_SUPPRESS_WARNINGS_END()
+
+namespace px {
+namespace bloomfilter {
+
+namespace {
+
+constexpr uint64_t kSeed = 3091990;
+
+// Odd constants from the Parquet spec, one per word of a block. The top 5 bits of key * salt pick
+// the bit that is set in the word.
+constexpr uint32_t kSalt[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                               0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+// Prefetching this many lookups ahead hides most of the cache miss latency of the batch lookups.
+constexpr size_t kPrefetchDistance = 8;
+
+#if defined(__x86_64__)
+bool HasAVX2() {
+  static const bool has_avx2 = []() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+  }();
+  return has_avx2;
+}
+
+__attribute__((target("avx2"))) inline __m256i MaskAVX2(uint32_t key) {
+  const __m256i salt = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(kSalt));
+  __m256i bit_idx = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(key), salt), 27);
+  return _mm256_sllv_epi32(_mm256_set1_epi32(1), bit_idx);
+}
+#endif
+
+}  // namespace
+
+StatusOr<std::unique_ptr<SplitBlockBloomFilter>> SplitBlockBloomFilter::Create(
+    int64_t max_entries, double error_rate) {
+  if (error_rate <= 0.0 || error_rate >= 1.0) {
+    return error::Internal(
+        "Bloom filter error rate must be greater than 0 and less than 1, received $0", error_rate);
+  }
+  if (max_entries <= 0) {
+    return error::Internal("Bloom filter must have a maximum of at least 1 entry, received $0",
+                           max_entries);
+  }
+
+  // From the Parquet spec: the bits needed for k = 8 bits per entry, spread over blocks.
+  double num_bits = -kWordsPerBlock * max_entries / std::log(1 - std::pow(error_rate, 1.0 / 8));
+  double num_blocks = std::ceil(num_bits / (8 * sizeof(Block)));
+  if (num_blocks > std::numeric_limits<uint32_t>::max()) {
+    return error::InvalidArgument("Bloom filter for $0 entries at error rate $1 is too large",
+                                  max_entries, error_rate);
+  }
+  return std::unique_ptr<SplitBlockBloomFilter>(
+      new SplitBlockBloomFilter(std::max<size_t>(1, static_cast<size_t>(num_blocks))));
+}
+
+StatusOr<std::unique_ptr<SplitBlockBloomFilter>> SplitBlockBloomFilter::FromProto(
+    const SplitBlockBloomFilterPB& pb) {
+  const std::string& data = pb.data();
+  if (data.empty() || data.size() % sizeof(Block) != 0) {
+    return error::Internal("Split block bloom filter data must be a multiple of $0 bytes, got $1",
+                           sizeof(Block), data.size());
+  }
+  std::unique_ptr<SplitBlockBloomFilter> bf(
+      new SplitBlockBloomFilter(data.size() / sizeof(Block)));
+  std::memcpy(bf->blocks_.data(), data.data(), data.size());
+  return bf;
+}
+
+SplitBlockBloomFilterPB SplitBlockBloomFilter::ToProto() const {
+  SplitBlockBloomFilterPB output;
+  output.set_data(reinterpret_cast<const char*>(blocks_.data()), buffer_size_bytes());
+  return output;
+}
+
+uint64_t SplitBlockBloomFilter::Hash(std::string_view item) {
+  return XXH64(item.data(), item.size(), kSeed);
+}
+
+void SplitBlockBloomFilter::InsertHash(uint64_t hash) {
+  Block& block = blocks_[BlockIndex(hash)];
+  const uint32_t key = static_cast<uint32_t>(hash);
+  for (int i = 0; i < kWordsPerBlock; ++i) {
+    block.words[i] |= 1U << ((key * kSalt[i]) >> 27);
+  }
+}
+
+bool SplitBlockBloomFilter::ContainsHash(uint64_t hash) const {
+  const Block& block = blocks_[BlockIndex(hash)];
+  const uint32_t key = static_cast<uint32_t>(hash);
+  // No early exit, so that the compiler can vectorize the loop.
+  uint32_t missing = 0;
+  for (int i = 0; i < kWordsPerBlock; ++i) {
+    uint32_t mask = 1U << ((key * kSalt[i]) >> 27);
+    missing |= ~block.words[i] & mask;
+  }
+  return missing == 0;
+}
+
+void SplitBlockBloomFilter::ContainsMany(absl::Span<const uint64_t> hashes,
+                                         absl::Span<bool> out) const {
+  DCHECK_EQ(hashes.size(), out.size());
+#if defined(__x86_64__)
+  if (HasAVX2()) {
+    ContainsManyAVX2(hashes, out);
+    return;
+  }
+#endif
+  ContainsManyScalar(hashes, out);
+}
+
+void SplitBlockBloomFilter::ContainsManyScalar(absl::Span<const uint64_t> hashes,
+                                               absl::Span<bool> out) const {
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    if (i + kPrefetchDistance < hashes.size()) {
+      __builtin_prefetch(&blocks_[BlockIndex(hashes[i + kPrefetchDistance])]);
+    }
+    out[i] = ContainsHash(hashes[i]);
+  }
+}
+
+#if defined(__x86_64__)
+__attribute__((target("avx2"))) void SplitBlockBloomFilter::ContainsManyAVX2(
+    absl::Span<const uint64_t> hashes, absl::Span<bool> out) const {
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    if (i + kPrefetchDistance < hashes.size()) {
+      __builtin_prefetch(&blocks_[BlockIndex(hashes[i + kPrefetchDistance])]);
+    }
+    const Block& block = blocks_[BlockIndex(hashes[i])];
+    __m256i words = _mm256_load_si256(reinterpret_cast<const __m256i*>(block.words));
+    // testc is set if all bits of the mask are set in the block.
+    out[i] = _mm256_testc_si256(words, MaskAVX2(static_cast<uint32_t>(hashes[i])));
+  }
+}
+#endif
+
+}  // namespace bloomfilter
+}  // namespace px
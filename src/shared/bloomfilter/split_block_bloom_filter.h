@@ -0,0 +1,97 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <absl/types/span.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/bloomfilterpb/bloomfilter.pb.h"
+
+namespace px {
+namespace bloomfilter {
+
+using SplitBlockBloomFilterPB = shared::bloomfilterpb::SplitBlockBloomFilter;
+
+/**
+ * SplitBlockBloomFilter is a cache friendly alternative to XXHash64BloomFilter. Each item maps to a
+ * single 32 byte block and sets one bit in each of its eight 32-bit words, so an insert or a lookup
+ * touches one cache line instead of k scattered ones, and the eight bits are checked with one
+ * vector instruction. The cost is ~20% more space for the same false positive rate.
+ *
+ * Items can be inserted and looked up either as strings or as precomputed 64-bit hashes (which
+ * must be well mixed, e.g. xxHash). The batch ContainsMany() is the fastest way to probe many
+ * hashes, e.g. one per row.
+ */
+class SplitBlockBloomFilter {
+ public:
+  /**
+   * Creates a filter sized for the maximum number of entries at the given false positive rate.
+   */
+  static StatusOr<std::unique_ptr<SplitBlockBloomFilter>> Create(int64_t max_entries,
+                                                                 double error_rate);
+  static StatusOr<std::unique_ptr<SplitBlockBloomFilter>> FromProto(
+      const SplitBlockBloomFilterPB& pb);
+  SplitBlockBloomFilterPB ToProto() const;
+
+  /**
+   * The hash of a string item, as used by Insert() and Contains().
+   */
+  static uint64_t Hash(std::string_view item);
+
+  void Insert(std::string_view item) { InsertHash(Hash(item)); }
+  bool Contains(std::string_view item) const { return ContainsHash(Hash(item)); }
+
+  void InsertHash(uint64_t hash);
+  bool ContainsHash(uint64_t hash) const;
+
+  /**
+   * Sets out[i] to ContainsHash(hashes[i]). Uses AVX2 when the CPU supports it.
+   */
+  void ContainsMany(absl::Span<const uint64_t> hashes, absl::Span<bool> out) const;
+
+  size_t buffer_size_bytes() const { return blocks_.size() * sizeof(Block); }
+  size_t num_blocks() const { return blocks_.size(); }
+
+ private:
+  static constexpr int kWordsPerBlock = 8;
+  struct alignas(32) Block {
+    uint32_t words[kWordsPerBlock];
+  };
+
+  explicit SplitBlockBloomFilter(size_t num_blocks) : blocks_(num_blocks, Block{}) {}
+
+  size_t BlockIndex(uint64_t hash) const {
+    // Maps the upper half of the hash onto [0, num_blocks) without a division.
+    return ((hash >> 32) * blocks_.size()) >> 32;
+  }
+
+  void ContainsManyScalar(absl::Span<const uint64_t> hashes, absl::Span<bool> out) const;
+#if defined(__x86_64__)
+  void ContainsManyAVX2(absl::Span<const uint64_t> hashes, absl::Span<bool> out) const;
+#endif
+
+  std::vector<Block> blocks_;
+};
+
+}  // namespace bloomfilter
+}  // namespace px
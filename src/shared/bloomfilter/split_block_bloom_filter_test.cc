@@ -0,0 +1,113 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "src/shared/bloomfilter/split_block_bloom_filter.h"
+
+namespace px {
+namespace bloomfilter {
+
+TEST(SplitBlockBloomFilter, create) {
+  auto bf1 = SplitBlockBloomFilter::Create(10, 0.1).ConsumeValueOrDie();
+  EXPECT_EQ(bf1->num_blocks(), 1);
+  EXPECT_EQ(bf1->buffer_size_bytes(), 32);
+
+  auto bf2 = SplitBlockBloomFilter::Create(100000, 0.01).ConsumeValueOrDie();
+  EXPECT_EQ(bf2->num_blocks(), 3782);
+
+  EXPECT_FALSE(SplitBlockBloomFilter::Create(0, 0.01).ok());
+  EXPECT_FALSE(SplitBlockBloomFilter::Create(10, 0).ok());
+  EXPECT_FALSE(SplitBlockBloomFilter::Create(10, 1).ok());
+}
+
+TEST(SplitBlockBloomFilter, insert_and_contains) {
+  auto bf = SplitBlockBloomFilter::Create(10, 0.01).ConsumeValueOrDie();
+  EXPECT_FALSE(bf->Contains("foo"));
+  EXPECT_FALSE(bf->Contains("bar"));
+  bf->Insert("foo");
+  bf->Insert("bar");
+  EXPECT_TRUE(bf->Contains("foo"));
+  EXPECT_TRUE(bf->Contains("bar"));
+  EXPECT_FALSE(bf->Contains("not_present"));
+  EXPECT_FALSE(bf->Contains(""));
+}
+
+TEST(SplitBlockBloomFilter, error_rate) {
+  constexpr int kNumEntries = 10000;
+  constexpr double kErrorRate = 0.01;
+  auto bf = SplitBlockBloomFilter::Create(kNumEntries, kErrorRate).ConsumeValueOrDie();
+  for (int i = 0; i < kNumEntries; ++i) {
+    bf->Insert(absl::StrCat("in_", i));
+  }
+  for (int i = 0; i < kNumEntries; ++i) {
+    EXPECT_TRUE(bf->Contains(absl::StrCat("in_", i)));
+  }
+
+  constexpr int kNumLookups = 100000;
+  int false_positives = 0;
+  for (int i = 0; i < kNumLookups; ++i) {
+    false_positives += bf->Contains(absl::StrCat("out_", i));
+  }
+  EXPECT_LT(false_positives, 1.5 * kErrorRate * kNumLookups);
+}
+
+TEST(SplitBlockBloomFilter, contains_many) {
+  auto bf = SplitBlockBloomFilter::Create(1000, 0.05).ConsumeValueOrDie();
+  std::vector<uint64_t> hashes;
+  for (int i = 0; i < 3000; ++i) {
+    hashes.push_back(SplitBlockBloomFilter::Hash(absl::StrCat(i)));
+    if (i % 3 == 0) {
+      bf->InsertHash(hashes.back());
+    }
+  }
+
+  std::unique_ptr<bool[]> out(new bool[hashes.size()]);
+  bf->ContainsMany(hashes, absl::MakeSpan(out.get(), hashes.size()));
+  int num_found = 0;
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    EXPECT_EQ(out[i], bf->ContainsHash(hashes[i])) << i;
+    num_found += out[i];
+  }
+  EXPECT_GE(num_found, 1000);
+  EXPECT_LT(num_found, 1200);
+}
+
+TEST(SplitBlockBloomFilter, proto_round_trip) {
+  auto bf = SplitBlockBloomFilter::Create(1000, 0.01).ConsumeValueOrDie();
+  bf->Insert("foo");
+  bf->Insert("bar");
+
+  auto proto = bf->ToProto();
+  EXPECT_EQ(proto.data().size(), bf->buffer_size_bytes());
+  auto reconstructed = SplitBlockBloomFilter::FromProto(proto).ConsumeValueOrDie();
+  EXPECT_EQ(reconstructed->num_blocks(), bf->num_blocks());
+  EXPECT_TRUE(reconstructed->Contains("foo"));
+  EXPECT_TRUE(reconstructed->Contains("bar"));
+  EXPECT_FALSE(reconstructed->Contains("abc"));
+
+  proto.mutable_data()->push_back('x');
+  EXPECT_FALSE(SplitBlockBloomFilter::FromProto(proto).ok());
+  EXPECT_FALSE(SplitBlockBloomFilter::FromProto(SplitBlockBloomFilterPB()).ok());
+}
+
+}  // namespace bloomfilter
+}  // namespace px
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/shared/dns/hostname_cache.h"
+
+#include <algorithm>
+
+namespace px {
+namespace dns {
+
+void HostnameCache::Insert(uint32_t netns, std::string_view addr, std::string_view hostname,
+                           std::chrono::nanoseconds ttl) {
+  auto now = Clock::now();
+  absl::MutexLock lock(&lock_);
+  auto it = names_.find(addr);
+  if (it != names_.end()) {
+    for (Name& name : it->second) {
+      if (name.netns == netns) {
+        name.hostname = hostname;
+        name.expiry = now + ttl;
+        return;
+      }
+    }
+  }
+  if (num_entries_ >= capacity_ && ExpireLocked(now) == 0) {
+    return;
+  }
+  // Expiring may have removed the address.
+  names_[std::string(addr)].push_back(Name{netns, std::string(hostname), now + ttl});
+  ++num_entries_;
+}
+
+std::string HostnameCache::Lookup(uint32_t netns, std::string_view addr) const {
+  auto now = Clock::now();
+  absl::MutexLock lock(&lock_);
+  auto it = names_.find(addr);
+  if (it == names_.end()) {
+    return "";
+  }
+  for (const Name& name : it->second) {
+    if (name.netns == netns && name.expiry > now) {
+      return name.hostname;
+    }
+  }
+  return "";
+}
+
+std::string HostnameCache::Lookup(std::string_view addr) const {
+  auto now = Clock::now();
+  absl::MutexLock lock(&lock_);
+  auto it = names_.find(addr);
+  if (it == names_.end()) {
+    return "";
+  }
+  // All the entries have the same TTL, so the one that expires last is the most recent answer.
+  const Name* latest = nullptr;
+  for (const Name& name : it->second) {
+    if (name.expiry > now && (latest == nullptr || name.expiry > latest->expiry)) {
+      latest = &name;
+    }
+  }
+  return latest == nullptr ? "" : latest->hostname;
+}
+
+size_t HostnameCache::Expire() {
+  auto now = Clock::now();
+  absl::MutexLock lock(&lock_);
+  return ExpireLocked(now);
+}
+
+size_t HostnameCache::ExpireLocked(Clock::time_point now) {
+  size_t num_expired = 0;
+  for (auto it = names_.begin(); it != names_.end();) {
+    Names& names = it->second;
+    auto expired = std::remove_if(names.begin(), names.end(),
+                                  [now](const Name& name) { return name.expiry <= now; });
+    num_expired += names.end() - expired;
+    names.erase(expired, names.end());
+    if (names.empty()) {
+      names_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  num_entries_ -= num_expired;
+  return num_expired;
+}
+
+std::vector<HostnameCache::Entry> HostnameCache::Entries() const {
+  auto now = Clock::now();
+  absl::MutexLock lock(&lock_);
+  std::vector<Entry> entries;
+  entries.reserve(num_entries_);
+  for (const auto& [addr, names] : names_) {
+    for (const Name& name : names) {
+      if (name.expiry > now) {
+        entries.push_back(Entry{name.netns, addr, name.hostname, name.expiry});
+      }
+    }
+  }
+  return entries;
+}
+
+size_t HostnameCache::size() const {
+  absl::MutexLock lock(&lock_);
+  return num_entries_;
+}
+
+}  // namespace dns
+}  // namespace px
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/inlined_vector.h>
+#include <absl/synchronization/mutex.h>
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace px {
+namespace dns {
+
+// Enough for the addresses that the pods of a node talk to, at well under 1MB.
+constexpr size_t kDefaultHostnameCacheCapacity = 8192;
+
+/**
+ * The hostnames of IP addresses, learned from the DNS answers that the pods of this node received,
+ * per network namespace. Stirling's socket tracer fills the process-wide instance from the DNS
+ * responses it traces, and queries read it back, so that they can name remote addresses without
+ * making DNS queries of their own.
+ *
+ * Entries expire after the TTL they were inserted with. Past the capacity, answers for new
+ * addresses are dropped until older entries expire.
+ */
+class HostnameCache {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Entry {
+    uint32_t netns;
+    std::string addr;
+    std::string hostname;
+    Clock::time_point expiry;
+  };
+
+  static HostnameCache& GetInstance() {
+    static HostnameCache cache(kDefaultHostnameCacheCapacity);
+    return cache;
+  }
+
+  explicit HostnameCache(size_t capacity) : capacity_(capacity) {}
+
+  // Records that addr resolved from hostname in the network namespace netns.
+  void Insert(uint32_t netns, std::string_view addr, std::string_view hostname,
+              std::chrono::nanoseconds ttl);
+
+  // Returns the hostname of addr in netns, or an empty string if there is none.
+  std::string Lookup(uint32_t netns, std::string_view addr) const;
+
+  // Returns the hostname of addr in any network namespace, preferring the most recent answer, or
+  // an empty string if there is none.
+  std::string Lookup(std::string_view addr) const;
+
+  // Removes the expired entries, and returns how many there were.
+  size_t Expire();
+
+  // Returns the unexpired entries.
+  std::vector<Entry> Entries() const;
+
+  size_t size() const;
+
+ private:
+  struct Name {
+    uint32_t netns;
+    std::string hostname;
+    Clock::time_point expiry;
+  };
+  // An address is almost always resolved in a single network namespace.
+  using Names = absl::InlinedVector<Name, 1>;
+
+  size_t ExpireLocked(Clock::time_point now) ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const size_t capacity_;
+
+  mutable absl::Mutex lock_;
+  absl::flat_hash_map<std::string, Names> names_ ABSL_GUARDED_BY(lock_);
+  // The number of Names in names_.
+  size_t num_entries_ ABSL_GUARDED_BY(lock_) = 0;
+};
+
+}  // namespace dns
+}  // namespace px
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/shared/dns/hostname_cache.h"
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace dns {
+
+using ::testing::UnorderedElementsAre;
+
+constexpr std::chrono::seconds kTTL{60};
+
+TEST(HostnameCacheTest, lookup_by_netns) {
+  HostnameCache cache(16);
+  cache.Insert(1, "10.0.0.1", "svc-a.default.svc.cluster.local", kTTL);
+  cache.Insert(2, "10.0.0.1", "svc-b.default.svc.cluster.local", kTTL);
+
+  EXPECT_EQ(cache.Lookup(1, "10.0.0.1"), "svc-a.default.svc.cluster.local");
+  EXPECT_EQ(cache.Lookup(2, "10.0.0.1"), "svc-b.default.svc.cluster.local");
+  EXPECT_EQ(cache.Lookup(3, "10.0.0.1"), "");
+  EXPECT_EQ(cache.Lookup(1, "10.0.0.2"), "");
+  // The answer in netns 2 is the most recent one.
+  EXPECT_EQ(cache.Lookup("10.0.0.1"), "svc-b.default.svc.cluster.local");
+
+  cache.Insert(1, "10.0.0.1", "svc-c.default.svc.cluster.local", kTTL);
+  EXPECT_EQ(cache.Lookup(1, "10.0.0.1"), "svc-c.default.svc.cluster.local");
+  EXPECT_EQ(cache.Lookup("10.0.0.1"), "svc-c.default.svc.cluster.local");
+  EXPECT_EQ(cache.size(), 2);
+}
+
+TEST(HostnameCacheTest, entries_expire) {
+  HostnameCache cache(16);
+  cache.Insert(1, "10.0.0.1", "a.com", std::chrono::seconds(0));
+  cache.Insert(1, "10.0.0.2", "b.com", kTTL);
+
+  EXPECT_EQ(cache.Lookup(1, "10.0.0.1"), "");
+  EXPECT_EQ(cache.Lookup("10.0.0.1"), "");
+  ASSERT_EQ(cache.Entries().size(), 1);
+  EXPECT_EQ(cache.Entries()[0].hostname, "b.com");
+
+  EXPECT_EQ(cache.Expire(), 1);
+  EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(HostnameCacheTest, drops_new_addrs_past_capacity) {
+  HostnameCache cache(2);
+  cache.Insert(1, "10.0.0.1", "a.com", kTTL);
+  cache.Insert(1, "10.0.0.2", "b.com", std::chrono::seconds(0));
+  // Makes room by expiring 10.0.0.2.
+  cache.Insert(1, "10.0.0.3", "c.com", kTTL);
+  cache.Insert(1, "10.0.0.4", "d.com", kTTL);
+  // Existing entries are still updated.
+  cache.Insert(1, "10.0.0.1", "e.com", kTTL);
+
+  std::vector<std::string> hostnames;
+  for (const auto& entry : cache.Entries()) {
+    hostnames.push_back(entry.hostname);
+  }
+  EXPECT_THAT(hostnames, UnorderedElementsAre("e.com", "c.com"));
+}
+
+}  // namespace dns
+}  // namespace px
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include <absl/synchronization/mutex.h>
+
+namespace px {
+namespace md {
+
+/**
+ * Holds the current version of an immutable object, which readers pin without locking while a
+ * writer publishes new versions, e.g. the AgentMetadataState that queries read while it is
+ * rebuilt.
+ *
+ * Pinning is RCU-like: a reader announces itself on the slot of the current version, checks that
+ * the version is still current, and copies the pointer. A publish fills the other slot, switches
+ * to it, then waits for the readers that are still copying from the old slot before dropping the
+ * old version. Readers never wait; a version is freed once nobody holds a pin on it.
+ */
+template <typename T>
+class AtomicSnapshot {
+ public:
+  AtomicSnapshot() = default;
+  explicit AtomicSnapshot(std::shared_ptr<const T> value) { slots_[0].value = std::move(value); }
+
+  /**
+   * Returns the current version. Holding the pointer keeps the version alive, so that it can be
+   * read any number of times without synchronization, e.g. for the whole duration of a query.
+   */
+  std::shared_ptr<const T> Pin() const {
+    while (true) {
+      int idx = current_.load();
+      Slot& slot = slots_[idx];
+      slot.readers.fetch_add(1);
+      // The publisher only writes the slot that is not current, after draining its readers.
+      if (current_.load() == idx) {
+        std::shared_ptr<const T> value = slot.value;
+        slot.readers.fetch_sub(1);
+        return value;
+      }
+      // A publish switched the slot in the meantime, so retry on the new one.
+      slot.readers.fetch_sub(1);
+    }
+  }
+
+  /**
+   * Makes value the current version. The previous version is released by the snapshot, and freed
+   * once the last reader that pinned it drops it.
+   */
+  void Publish(std::shared_ptr<const T> value) {
+    absl::MutexLock lock(&publish_lock_);
+    int old_idx = current_.load();
+    int new_idx = 1 - old_idx;
+    // The slot was emptied by the previous publish, and readers that announce themselves on it now
+    // back off without reading it, because it is not current.
+    slots_[new_idx].value = std::move(value);
+    current_.store(new_idx);
+
+    Slot& old_slot = slots_[old_idx];
+    while (old_slot.readers.load() != 0) {
+      std::this_thread::yield();
+    }
+    old_slot.value.reset();
+  }
+
+ private:
+  struct alignas(64) Slot {
+    std::shared_ptr<const T> value;
+    std::atomic<int> readers = 0;
+  };
+
+  mutable Slot slots_[2];
+  std::atomic<int> current_ = 0;
+  absl::Mutex publish_lock_;
+};
+
+}  // namespace md
+}  // namespace px
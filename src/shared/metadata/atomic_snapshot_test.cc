@@ -0,0 +1,81 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/shared/metadata/atomic_snapshot.h"
+
+namespace px {
+namespace md {
+
+TEST(AtomicSnapshotTest, PinnedVersionOutlivesPublish) {
+  AtomicSnapshot<int> snapshot(std::make_shared<const int>(1));
+
+  std::shared_ptr<const int> pinned = snapshot.Pin();
+  std::weak_ptr<const int> first = pinned;
+  snapshot.Publish(std::make_shared<const int>(2));
+
+  EXPECT_EQ(*pinned, 1);
+  EXPECT_EQ(*snapshot.Pin(), 2);
+
+  // Only the pin keeps the first version alive.
+  pinned.reset();
+  EXPECT_TRUE(first.expired());
+}
+
+TEST(AtomicSnapshotTest, ConcurrentPinsSeeMonotonicVersions) {
+  constexpr int kNumVersions = 10000;
+  constexpr int kNumReaders = 4;
+  AtomicSnapshot<int> snapshot(std::make_shared<const int>(0));
+
+  std::atomic<bool> done = false;
+  std::vector<std::thread> readers;
+  std::atomic<int> num_errors = 0;
+  for (int i = 0; i < kNumReaders; ++i) {
+    readers.emplace_back([&]() {
+      int last = 0;
+      while (!done) {
+        std::shared_ptr<const int> pinned = snapshot.Pin();
+        if (pinned == nullptr || *pinned < last) {
+          ++num_errors;
+          return;
+        }
+        last = *pinned;
+      }
+    });
+  }
+
+  for (int v = 1; v <= kNumVersions; ++v) {
+    snapshot.Publish(std::make_shared<const int>(v));
+  }
+  done = true;
+  for (auto& t : readers) {
+    t.join();
+  }
+
+  EXPECT_EQ(num_errors, 0);
+  EXPECT_EQ(*snapshot.Pin(), kNumVersions);
+}
+
+}  // namespace md
+}  // namespace px
@@ -16,11 +16,15 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <algorithm>
-#include <fstream>
 #include <memory>
 #include <string>
 
+#include <absl/strings/str_split.h>
+
 #include "src/common/base/base.h"
 #include "src/common/base/file.h"
 #include "src/shared/metadata/cgroup_metadata_reader.h"
@@ -80,19 +84,41 @@ Status CGroupMetadataReader::ReadPIDs(PodQOSClass qos_class, std::string_view po
   // The container files need to be recursively read and the PIDs needs be merge across all
   // containers.
 
-  PX_ASSIGN_OR_RETURN(std::string fpath, PodPath(qos_class, pod_id, container_id, container_type));
+  auto path_it = pod_path_cache_.find(container_id);
+  if (path_it == pod_path_cache_.end()) {
+    PX_ASSIGN_OR_RETURN(std::string fpath,
+                        PodPath(qos_class, pod_id, container_id, container_type));
+    if (pod_path_cache_.size() >= kMaxCachedPaths) {
+      pod_path_cache_.clear();
+    }
+    path_it = pod_path_cache_.try_emplace(container_id, std::move(fpath)).first;
+  }
+  const std::string& fpath = path_it->second;
 
-  std::ifstream ifs(fpath);
-  if (!ifs) {
+  int fd = open(fpath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
     // This might not be a real error since the pod could have disappeared.
-    return error::NotFound("Failed to open file $0", fpath);
+    Status s = error::NotFound("Failed to open file $0", fpath);
+    pod_path_cache_.erase(path_it);
+    return s;
   }
 
-  std::string line;
-  while (std::getline(ifs, line)) {
-    if (line.empty()) {
-      continue;
-    }
+  // Read the whole file with a few syscalls, rather than through a stream line by line.
+  constexpr size_t kReadSize = 4096;
+  read_buf_.clear();
+  ssize_t bytes_read;
+  do {
+    size_t offset = read_buf_.size();
+    read_buf_.resize(offset + kReadSize);
+    bytes_read = read(fd, read_buf_.data() + offset, kReadSize);
+    read_buf_.resize(offset + std::max<ssize_t>(bytes_read, 0));
+  } while (bytes_read > 0);
+  close(fd);
+  if (bytes_read < 0) {
+    return error::Internal("Failed to read file $0", fpath);
+  }
+
+  for (std::string_view line : absl::StrSplit(read_buf_, '\n', absl::SkipEmpty())) {
     int64_t pid;
     if (!absl::SimpleAtoi(line, &pid)) {
       LOG(WARNING) << absl::Substitute("Failed to parse pid file: $0", fpath);
@@ -25,6 +25,9 @@
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+
 #include "src/common/base/base.h"
 #include "src/common/system/system.h"
 #include "src/shared/metadata/cgroup_path_resolver.h"
@@ -50,17 +53,29 @@ class CGroupMetadataReader : public NotCopyable {
    *
    * Note: that since this function contains inherent races with the system state and can return
    * errors when files fail to read because they have been deleted while the read was in progress.
+   *
+   * The cgroup path of each container is resolved once and cached, until reading it fails.
+   * Not thread-safe: the metadata state update is the only caller.
    */
   virtual Status ReadPIDs(PodQOSClass qos_class, std::string_view pod_id,
                           std::string_view container_id, ContainerType container_type,
                           absl::flat_hash_set<uint32_t>* pid_set) const;
 
  private:
+  // The cache is dropped when it reaches this size, so that the paths of containers which are
+  // no longer read don't accumulate.
+  static constexpr size_t kMaxCachedPaths = 16384;
+
   StatusOr<std::string> PodPath(PodQOSClass qos_class, std::string_view pod_id,
                                 std::string_view container_id, ContainerType container_type) const;
 
   std::unique_ptr<LegacyCGroupPathResolver> legacy_path_resolver_;
   std::unique_ptr<CGroupPathResolver> path_resolver_;
+
+  // The cgroup.procs path of each container, by container ID.
+  mutable absl::flat_hash_map<std::string, std::string> pod_path_cache_;
+  // Reused across reads of cgroup.procs.
+  mutable std::string read_buf_;
 };
 
 }  // namespace md
@@ -43,5 +43,23 @@ TEST_F(CGroupMetadataReaderTest, read_pid_list) {
   EXPECT_THAT(pid_set, ::testing::UnorderedElementsAre(123, 456, 789));
 }
 
+TEST_F(CGroupMetadataReaderTest, read_pid_list_again) {
+  for (int i = 0; i < 2; ++i) {
+    absl::flat_hash_set<uint32_t> pid_set;
+    ASSERT_OK(md_reader_->ReadPIDs(PodQOSClass::kBestEffort, "abcd", "c123",
+                                   ContainerType::kDocker, &pid_set));
+    EXPECT_THAT(pid_set, ::testing::UnorderedElementsAre(123, 456, 789));
+  }
+}
+
+TEST_F(CGroupMetadataReaderTest, read_pid_list_missing_container) {
+  for (int i = 0; i < 2; ++i) {
+    absl::flat_hash_set<uint32_t> pid_set;
+    EXPECT_NOT_OK(md_reader_->ReadPIDs(PodQOSClass::kBestEffort, "abcd", "c456",
+                                       ContainerType::kDocker, &pid_set));
+    EXPECT_TRUE(pid_set.empty());
+  }
+}
+
 }  // namespace md
 }  // namespace px
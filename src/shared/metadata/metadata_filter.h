@@ -39,8 +39,8 @@ using shared::metadatapb::MetadataType;
 using shared::metadatapb::MetadataType_Name;
 
 const absl::flat_hash_set<MetadataType> kMetadataFilterEntities = {
-    MetadataType::SERVICE_ID, MetadataType::SERVICE_NAME, MetadataType::POD_ID,
-    MetadataType::POD_NAME, MetadataType::CONTAINER_ID};
+    MetadataType::SERVICE_ID,   MetadataType::SERVICE_NAME, MetadataType::POD_ID,
+    MetadataType::POD_NAME,     MetadataType::CONTAINER_ID, MetadataType::NAMESPACE};
 
 /**
  * An abstract class that keeps track of the various entities in this metadata state.
@@ -16,10 +16,15 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
 
+#include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
 
 #include "src/shared/metadata/metadata_state.h"
@@ -27,11 +32,104 @@
 namespace px {
 namespace md {
 
+namespace {
+
+// Sets (*map)[key] = value, without copying the map if it already has that value.
+template <typename TMap, typename TKey, typename TValue>
+void SetIfChanged(CopyOnWrite<TMap>* map, const TKey& key, const TValue& value) {
+  auto it = (*map)->find(key);
+  if (it != (*map)->end() && it->second == value) {
+    return;
+  }
+  (*map->Mutable())[key] = value;
+}
+
+// Packs the IP into *packed, returns false if it isn't a valid IP address.
+bool PackIP(std::string_view ip, PackedIP* packed) {
+  // inet_pton needs a null-terminated string.
+  char buf[INET6_ADDRSTRLEN];
+  if (ip.size() >= sizeof(buf)) {
+    return false;
+  }
+  std::memcpy(buf, ip.data(), ip.size());
+  buf[ip.size()] = '\0';
+
+  struct in_addr v4_addr;
+  if (inet_pton(AF_INET, buf, &v4_addr) == 1) {
+    *packed = (PackedIP(0xffff) << 32) | ntohl(v4_addr.s_addr);
+    return true;
+  }
+  struct in6_addr v6_addr;
+  if (inet_pton(AF_INET6, buf, &v6_addr) == 1) {
+    uint64_t high = 0;
+    uint64_t low = 0;
+    for (int i = 0; i < 8; ++i) {
+      high = (high << 8) | v6_addr.s6_addr[i];
+      low = (low << 8) | v6_addr.s6_addr[i + 8];
+    }
+    *packed = absl::MakeUint128(high, low);
+    return true;
+  }
+  return false;
+}
+
+std::string UnpackIP(PackedIP packed) {
+  char buf[INET6_ADDRSTRLEN] = {};
+  if (absl::Uint128High64(packed) == 0 && (absl::Uint128Low64(packed) >> 32) == 0xffff) {
+    struct in_addr v4_addr;
+    v4_addr.s_addr = htonl(static_cast<uint32_t>(absl::Uint128Low64(packed)));
+    inet_ntop(AF_INET, &v4_addr, buf, sizeof(buf));
+  } else {
+    struct in6_addr v6_addr;
+    uint64_t high = absl::Uint128High64(packed);
+    uint64_t low = absl::Uint128Low64(packed);
+    for (int i = 7; i >= 0; --i) {
+      v6_addr.s6_addr[i] = high & 0xff;
+      v6_addr.s6_addr[i + 8] = low & 0xff;
+      high >>= 8;
+      low >>= 8;
+    }
+    inet_ntop(AF_INET6, &v6_addr, buf, sizeof(buf));
+  }
+  return buf;
+}
+
+bool StartsBefore(const UIDAndStart& lhs, const UIDAndStart& rhs) {
+  return lhs.second < rhs.second;
+}
+
+}  // namespace
+
+bool PodIPHistory::Add(UIDAndStart pod) {
+  auto it = std::lower_bound(pods_.begin(), pods_.end(), pod, StartsBefore);
+  if (it != pods_.end() && it->second == pod.second) {
+    return false;
+  }
+  pods_.insert(it, std::move(pod));
+  return true;
+}
+
+bool PodIPHistory::HasPodStartedAt(int64_t start_time_ns) const {
+  size_t num_started = NumStartedBy(start_time_ns);
+  return num_started > 0 && pods_[num_started - 1].second == start_time_ns;
+}
+
+size_t PodIPHistory::NumStartedBy(int64_t timestamp_ns) const {
+  auto it = std::upper_bound(pods_.begin(), pods_.end(), UIDAndStart{"", timestamp_ns},
+                             StartsBefore);
+  return it - pods_.begin();
+}
+
+UID PodIPHistory::PodIDAtTime(int64_t timestamp_ns) const {
+  size_t num_started = NumStartedBy(timestamp_ns);
+  return (num_started == 0) ? "" : pods_[num_started - 1].first;
+}
+
 const K8sMetadataObject* K8sMetadataState::K8sMetadataObjectByID(UIDView id,
                                                                  K8sObjectType type) const {
-  auto it = k8s_objects_by_id_.find(id);
+  auto it = k8s_objects_by_id_->find(id);
 
-  if (it == k8s_objects_by_id_.end()) {
+  if (it == k8s_objects_by_id_->end()) {
     return nullptr;
   }
 
@@ -69,66 +167,118 @@ const DeploymentInfo* K8sMetadataState::DeploymentInfoByID(UIDView deployment_id
 }
 
 const ContainerInfo* K8sMetadataState::ContainerInfoByID(CIDView id) const {
-  auto it = containers_by_id_.find(id);
+  auto it = containers_by_id_->find(id);
+
+  if (it == containers_by_id_->end()) {
+    return nullptr;
+  }
+
+  return it->second.get();
+}
 
-  if (it == containers_by_id_.end()) {
+K8sMetadataObject* K8sMetadataState::MutableK8sMetadataObjectByID(UIDView id) {
+  auto* objects = k8s_objects_by_id_.Mutable();
+  auto it = objects->find(id);
+  if (it == objects->end()) {
     return nullptr;
   }
+  // The object may be shared with the state that this one was cloned from.
+  if (it->second.use_count() > 1) {
+    it->second = it->second->Clone();
+  }
+  return it->second.get();
+}
 
+ContainerInfo* K8sMetadataState::MutableContainerInfoByID(CIDView id) {
+  auto* containers = containers_by_id_.Mutable();
+  auto it = containers->find(id);
+  if (it == containers->end()) {
+    return nullptr;
+  }
+  // The container may be shared with the state that this one was cloned from.
+  if (it->second.use_count() > 1) {
+    it->second = it->second->Clone();
+  }
   return it->second.get();
 }
 
 UID K8sMetadataState::PodIDByName(K8sNameIdentView pod_name) const {
-  auto it = pods_by_name_.find(pod_name);
-  return (it == pods_by_name_.end()) ? "" : it->second;
+  auto it = pods_by_name_->find(pod_name);
+  return (it == pods_by_name_->end()) ? "" : it->second;
 }
 
 UID K8sMetadataState::PodIDByIP(std::string_view pod_ip) const {
-  auto it = pods_by_ip_.find(pod_ip);
-  return (it == pods_by_ip_.end()) ? "" : it->second;
+  auto it = pods_by_ip_->find(pod_ip);
+  return (it == pods_by_ip_->end()) ? "" : it->second;
 }
 
-UID K8sMetadataState::PodIDByIPAtTime(std::string_view pod_ip, int64_t ts) const {
-  auto it = pods_by_ip_and_start_time_.find(pod_ip);
-  if (it == pods_by_ip_and_start_time_.end()) {
-    return "";
+const PodIPHistory* K8sMetadataState::PodIPHistoryByIP(std::string_view pod_ip) const {
+  PackedIP packed_ip;
+  if (!PackIP(pod_ip, &packed_ip)) {
+    return nullptr;
   }
-  auto up = it->second.upper_bound({"", ts});
-  if (up == it->second.begin()) {
-    return "";
+  auto it = pods_by_ip_and_start_time_->find(packed_ip);
+  return (it == pods_by_ip_and_start_time_->end()) ? nullptr : &it->second;
+}
+
+UID K8sMetadataState::PodIDByIPAtTime(std::string_view pod_ip, int64_t ts) const {
+  const PodIPHistory* history = PodIPHistoryByIP(pod_ip);
+  return (history == nullptr) ? "" : history->PodIDAtTime(ts);
+}
+
+void K8sMetadataState::PodIDsByIPAtTime(absl::Span<const std::string_view> pod_ips,
+                                        absl::Span<const int64_t> timestamps_ns,
+                                        std::vector<UID>* pod_ids) const {
+  DCHECK_EQ(pod_ips.size(), timestamps_ns.size());
+  pod_ids->resize(pod_ips.size());
+
+  absl::flat_hash_map<std::string_view, const PodIPHistory*> histories;
+  const PodIPHistory* history = nullptr;
+  for (size_t i = 0; i < pod_ips.size(); ++i) {
+    // Records of the same IP are often next to each other, which skips the hash lookup.
+    if (i == 0 || pod_ips[i] != pod_ips[i - 1]) {
+      auto [it, inserted] = histories.try_emplace(pod_ips[i], nullptr);
+      if (inserted) {
+        it->second = PodIPHistoryByIP(pod_ips[i]);
+      }
+      history = it->second;
+    }
+    (*pod_ids)[i] = (history == nullptr) ? "" : history->PodIDAtTime(timestamps_ns[i]);
   }
-  --up;
-  return up->first;
 }
 
 UID K8sMetadataState::ServiceIDByClusterIP(std::string_view cluster_ip) const {
-  auto it = services_by_cluster_ip_.find(cluster_ip);
-  return (it == services_by_cluster_ip_.end()) ? "" : it->second;
+  PackedIP packed_ip;
+  if (!PackIP(cluster_ip, &packed_ip)) {
+    return "";
+  }
+  auto it = services_by_cluster_ip_->find(packed_ip);
+  return (it == services_by_cluster_ip_->end()) ? "" : it->second;
 }
 
 CID K8sMetadataState::ContainerIDByName(std::string_view container_name) const {
-  auto it = containers_by_name_.find(container_name);
-  return (it == containers_by_name_.end()) ? "" : it->second;
+  auto it = containers_by_name_->find(container_name);
+  return (it == containers_by_name_->end()) ? "" : it->second;
 }
 
 UID K8sMetadataState::ServiceIDByName(K8sNameIdentView service_name) const {
-  auto it = services_by_name_.find(service_name);
-  return (it == services_by_name_.end()) ? "" : it->second;
+  auto it = services_by_name_->find(service_name);
+  return (it == services_by_name_->end()) ? "" : it->second;
 }
 
 UID K8sMetadataState::NamespaceIDByName(K8sNameIdentView namespace_name) const {
-  auto it = namespaces_by_name_.find(namespace_name);
-  return (it == namespaces_by_name_.end()) ? "" : it->second;
+  auto it = namespaces_by_name_->find(namespace_name);
+  return (it == namespaces_by_name_->end()) ? "" : it->second;
 }
 
 UID K8sMetadataState::ReplicaSetIDByName(K8sNameIdentView replica_set_name) const {
-  auto it = replica_sets_by_name_.find(replica_set_name);
-  return (it == replica_sets_by_name_.end()) ? "" : it->second;
+  auto it = replica_sets_by_name_->find(replica_set_name);
+  return (it == replica_sets_by_name_->end()) ? "" : it->second;
 }
 
 UID K8sMetadataState::DeploymentIDByName(K8sNameIdentView deployment_name) const {
-  auto it = deployments_by_name_.find(deployment_name);
-  return (it == deployments_by_name_.end()) ? "" : it->second;
+  auto it = deployments_by_name_->find(deployment_name);
+  return (it == deployments_by_name_->end()) ? "" : it->second;
 }
 
 const ReplicaSetInfo* K8sMetadataState::OwnerReplicaSetInfo(
@@ -165,16 +315,9 @@ std::unique_ptr<K8sMetadataState> K8sMetadataState::Clone() const {
   other->pod_cidrs_ = pod_cidrs_;
   other->service_cidr_ = service_cidr_;
 
-  other->k8s_objects_by_id_.reserve(k8s_objects_by_id_.size());
-  for (const auto& [k, v] : k8s_objects_by_id_) {
-    other->k8s_objects_by_id_[k] = v->Clone();
-  }
-
-  other->containers_by_id_.reserve(containers_by_id_.size());
-  for (const auto& [k, v] : containers_by_id_) {
-    other->containers_by_id_[k] = v->Clone();
-  }
-
+  // The maps, and the objects in them, are shared until either state modifies them.
+  other->k8s_objects_by_id_ = k8s_objects_by_id_;
+  other->containers_by_id_ = containers_by_id_;
   other->pods_by_name_ = pods_by_name_;
   other->services_by_name_ = services_by_name_;
   other->namespaces_by_name_ = namespaces_by_name_;
@@ -193,49 +336,49 @@ std::string K8sMetadataState::DebugString(int indent_level) const {
   std::string prefix = Indent(indent_level);
 
   str += prefix + "K8s Objects:\n";
-  for (const auto& it : k8s_objects_by_id_) {
+  for (const auto& it : *k8s_objects_by_id_) {
     str += absl::Substitute("$0\n", it.second->DebugString(indent_level + 1));
   }
   str += "\n";
   str += prefix + "Containers:\n";
-  for (const auto& it : containers_by_id_) {
+  for (const auto& it : *containers_by_id_) {
     str += absl::Substitute("$0\n", it.second->DebugString(indent_level + 1));
   }
   str += "\n";
   str += prefix + "Name Based Maps:\n";
-  for (const auto& [k, v] : namespaces_by_name_) {
+  for (const auto& [k, v] : *namespaces_by_name_) {
     str += absl::Substitute("namespace_id: $0, ns: $1, name: $2\n", v, k.first, k.second);
   }
-  for (const auto& [k, v] : pods_by_name_) {
+  for (const auto& [k, v] : *pods_by_name_) {
     str += absl::Substitute("pod_id: $0, ns: $1, name: $2\n", v, k.first, k.second);
   }
-  for (const auto& [k, v] : services_by_name_) {
+  for (const auto& [k, v] : *services_by_name_) {
     str += absl::Substitute("service_id: $0, ns: $1, name: $2\n", v, k.first, k.second);
   }
-  for (const auto& [k, v] : replica_sets_by_name_) {
+  for (const auto& [k, v] : *replica_sets_by_name_) {
     str += absl::Substitute("replicaset_id: $0, ns: $1, name: $2\n", v, k.first, k.second);
   }
-  for (const auto& [k, v] : deployments_by_name_) {
+  for (const auto& [k, v] : *deployments_by_name_) {
     str += absl::Substitute("deployment_id: $0, ns: $1, name: $2\n", v, k.first, k.second);
   }
-  for (const auto& [k, v] : containers_by_name_) {
+  for (const auto& [k, v] : *containers_by_name_) {
     str += absl::Substitute("cid: $0, name: $1\n", v, k);
   }
   str += "\n";
   str += prefix + "IPs By Time:\n";
-  for (const auto& [k, v] : pods_by_ip_and_start_time_) {
-    str += absl::Substitute("ip: $0\n", k);
-    for (const auto& [id, ts] : v) {
+  for (const auto& [k, v] : *pods_by_ip_and_start_time_) {
+    str += absl::Substitute("ip: $0\n", UnpackIP(k));
+    for (const auto& [id, ts] : v.pods()) {
       str += absl::Substitute("\tpod_id: $0, start_time: $1\n", id, ts);
     }
   }
   str += "\n";
   str += prefix + "IPs:\n";
-  for (const auto& [k, v] : pods_by_ip_) {
+  for (const auto& [k, v] : *pods_by_ip_) {
     str += absl::Substitute("pod_id: $0, ip: $1\n", v, k);
   }
-  for (const auto& [k, v] : services_by_cluster_ip_) {
-    str += absl::Substitute("service_id: $0, cluster_ip: $1\n", v, k);
+  for (const auto& [k, v] : *services_by_cluster_ip_) {
+    str += absl::Substitute("service_id: $0, cluster_ip: $1\n", v, UnpackIP(k));
   }
   str += prefix + absl::Substitute("PodCIDRs($0): ", pod_cidrs_.size());
   for (const auto& cidr : pod_cidrs_) {
@@ -251,13 +394,12 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
   const std::string& name = update.name();
   const std::string& ns = update.namespace_();
 
-  auto it = k8s_objects_by_id_.find(object_uid);
-  if (it == k8s_objects_by_id_.end()) {
+  if (!k8s_objects_by_id_->contains(object_uid)) {
     auto pod = std::make_unique<PodInfo>(update);
     VLOG(1) << "Adding Pod: " << pod->DebugString();
-    it = k8s_objects_by_id_.try_emplace(object_uid, std::move(pod)).first;
+    k8s_objects_by_id_.Mutable()->try_emplace(object_uid, std::move(pod));
   }
-  auto pod_info = static_cast<PodInfo*>(it->second.get());
+  auto pod_info = static_cast<PodInfo*>(MutableK8sMetadataObjectByID(object_uid));
 
   // We always just add to the container set even if the container is stopped.
   // We expect all cleanup to happen periodically to allow stale objects to be queried for some
@@ -266,7 +408,8 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
   // state might be periodically inconsistent.
 
   for (const auto& cid : update.container_ids()) {
-    if (containers_by_id_.find(cid) == containers_by_id_.end()) {
+    const ContainerInfo* container_info = ContainerInfoByID(cid);
+    if (container_info == nullptr) {
       // We should be resilient to the case where we happened to miss a pod update
       // in the stream of events. If we did miss a pod update, just skip adding the
       // pod to this particular service to avoid dangling references.
@@ -275,7 +418,9 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
     }
 
     pod_info->AddContainer(cid);
-    containers_by_id_[cid]->set_pod_id(object_uid);
+    if (container_info->pod_id() != object_uid) {
+      MutableContainerInfoByID(cid)->set_pod_id(object_uid);
+    }
   }
 
   for (const auto& owner_ref : update.owner_references()) {
@@ -293,12 +438,20 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
   pod_info->set_phase_reason(update.reason());
   pod_info->set_pod_labels(update.labels());
 
-  pods_by_name_[{ns, name}] = object_uid;
+  SetIfChanged(&pods_by_name_, K8sNameIdent{ns, name}, object_uid);
   // Filter out daemonsets which don't have their own, unique podIP.
   if (update.host_ip() != update.pod_ip() && update.pod_ip() != "") {
-    pods_by_ip_[update.pod_ip()] = object_uid;
+    SetIfChanged(&pods_by_ip_, update.pod_ip(), object_uid);
     if (update.start_timestamp_ns() > 0) {
-      pods_by_ip_and_start_time_[update.pod_ip()].insert({object_uid, update.start_timestamp_ns()});
+      PackedIP packed_ip;
+      if (PackIP(update.pod_ip(), &packed_ip)) {
+        auto it = pods_by_ip_and_start_time_->find(packed_ip);
+        if (it == pods_by_ip_and_start_time_->end() ||
+            !it->second.HasPodStartedAt(update.start_timestamp_ns())) {
+          (*pods_by_ip_and_start_time_.Mutable())[packed_ip].Add(
+              {object_uid, update.start_timestamp_ns()});
+        }
+      }
     }
   }
 
@@ -308,21 +461,20 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
 Status K8sMetadataState::HandleContainerUpdate(const ContainerUpdate& update) {
   const CID& cid = update.cid();
 
-  auto it = containers_by_id_.find(cid);
-  if (it == containers_by_id_.end()) {
+  if (!containers_by_id_->contains(cid)) {
     auto container = std::make_unique<ContainerInfo>(update);
     VLOG(1) << "Adding Container: " << container->DebugString();
-    it = containers_by_id_.try_emplace(cid, std::move(container)).first;
+    containers_by_id_.Mutable()->try_emplace(cid, std::move(container));
   }
   VLOG(1) << "container update: " << update.name();
 
-  auto* container_info = it->second.get();
+  auto* container_info = MutableContainerInfoByID(cid);
   container_info->set_stop_time_ns(update.stop_timestamp_ns());
   container_info->set_state(ConvertToContainerState(update.container_state()));
   container_info->set_state_message(update.message());
   container_info->set_state_reason(update.reason());
 
-  containers_by_name_[update.name()] = cid;
+  SetIfChanged(&containers_by_name_, update.name(), cid);
 
   return Status::OK();
 }
@@ -332,26 +484,28 @@ Status K8sMetadataState::HandleServiceUpdate(const ServiceUpdate& update) {
   const std::string& name = update.name();
   const std::string& ns = update.namespace_();
 
-  auto it = k8s_objects_by_id_.find(service_uid);
-  if (it == k8s_objects_by_id_.end()) {
+  if (!k8s_objects_by_id_->contains(service_uid)) {
     auto service = std::make_unique<ServiceInfo>(service_uid, ns, name);
     VLOG(1) << "Adding Service: " << service->DebugString();
-    it = k8s_objects_by_id_.try_emplace(service_uid, std::move(service)).first;
+    k8s_objects_by_id_.Mutable()->try_emplace(service_uid, std::move(service));
   }
-  auto service_info = static_cast<ServiceInfo*>(it->second.get());
+  auto service_info = static_cast<ServiceInfo*>(MutableK8sMetadataObjectByID(service_uid));
 
   for (const auto& uid : update.pod_ids()) {
-    if (k8s_objects_by_id_.find(uid) == k8s_objects_by_id_.end()) {
+    auto pod_it = k8s_objects_by_id_->find(uid);
+    if (pod_it == k8s_objects_by_id_->end()) {
       // We should be resilient to the case where we happened to miss a pod update
       // in the stream of events. If we did miss a pod update, just skip adding the
       // pod to this particular service to avoid dangling references.
       LOG(INFO) << absl::Substitute("Didn't find pod UID $0 for service $1/$2", uid, ns, name);
       continue;
     }
-    ECHECK(k8s_objects_by_id_[uid]->type() == K8sObjectType::kPod);
+    ECHECK(pod_it->second->type() == K8sObjectType::kPod);
     // We add the service uid to the pod. Lifetime of service still handled by the service object.
-    PodInfo* pod_info = static_cast<PodInfo*>(k8s_objects_by_id_[uid].get());
-    pod_info->AddService(service_uid);
+    if (!static_cast<const PodInfo*>(pod_it->second.get())->services().contains(service_uid)) {
+      PodInfo* pod_info = static_cast<PodInfo*>(MutableK8sMetadataObjectByID(uid));
+      pod_info->AddService(service_uid);
+    }
   }
   if (update.start_timestamp_ns() != 0) {
     service_info->set_start_time_ns(update.start_timestamp_ns());
@@ -360,7 +514,10 @@ Status K8sMetadataState::HandleServiceUpdate(const ServiceUpdate& update) {
     service_info->set_stop_time_ns(update.stop_timestamp_ns());
   }
   if (update.cluster_ip() != "") {
-    services_by_cluster_ip_[update.cluster_ip()] = service_uid;
+    PackedIP packed_ip;
+    if (PackIP(update.cluster_ip(), &packed_ip)) {
+      SetIfChanged(&services_by_cluster_ip_, packed_ip, service_uid);
+    }
     service_info->set_cluster_ip(update.cluster_ip());
   }
   if (update.external_ips().size()) {
@@ -370,7 +527,7 @@ Status K8sMetadataState::HandleServiceUpdate(const ServiceUpdate& update) {
   }
 
   VLOG(1) << "service update: " << update.name();
-  services_by_name_[{ns, name}] = service_uid;
+  SetIfChanged(&services_by_name_, K8sNameIdent{ns, name}, service_uid);
   return Status::OK();
 }
 
@@ -379,20 +536,19 @@ Status K8sMetadataState::HandleNamespaceUpdate(const NamespaceUpdate& update) {
   const std::string& name = update.name();
   const std::string& ns = update.name();
 
-  auto it = k8s_objects_by_id_.find(namespace_uid);
-  if (it == k8s_objects_by_id_.end()) {
+  if (!k8s_objects_by_id_->contains(namespace_uid)) {
     auto ns_obj = std::make_unique<NamespaceInfo>(namespace_uid, ns, name);
     VLOG(1) << "Adding Namespace: " << ns_obj->DebugString();
-    it = k8s_objects_by_id_.try_emplace(namespace_uid, std::move(ns_obj)).first;
+    k8s_objects_by_id_.Mutable()->try_emplace(namespace_uid, std::move(ns_obj));
   }
-  auto ns_info = static_cast<NamespaceInfo*>(it->second.get());
+  auto ns_info = static_cast<NamespaceInfo*>(MutableK8sMetadataObjectByID(namespace_uid));
 
   ns_info->set_start_time_ns(update.start_timestamp_ns());
   ns_info->set_stop_time_ns(update.stop_timestamp_ns());
 
   VLOG(1) << "namespace update: " << update.name();
 
-  namespaces_by_name_[{ns, name}] = namespace_uid;
+  SetIfChanged(&namespaces_by_name_, K8sNameIdent{ns, name}, namespace_uid);
   return Status::OK();
 }
 
@@ -408,13 +564,13 @@ Status K8sMetadataState::HandleReplicaSetUpdate(const ReplicaSetUpdate& update)
   const std::string& name = update.name();
   const std::string& ns = update.namespace_();
 
-  auto it = k8s_objects_by_id_.find(replica_set_uid);
-  if (it == k8s_objects_by_id_.end()) {
+  if (!k8s_objects_by_id_->contains(replica_set_uid)) {
     auto replica_set = std::make_unique<ReplicaSetInfo>(update);
     VLOG(1) << "Adding ReplicaSet: " << replica_set->DebugString();
-    it = k8s_objects_by_id_.try_emplace(replica_set_uid, std::move(replica_set)).first;
+    k8s_objects_by_id_.Mutable()->try_emplace(replica_set_uid, std::move(replica_set));
   }
-  auto replica_set_info = static_cast<ReplicaSetInfo*>(it->second.get());
+  auto replica_set_info =
+      static_cast<ReplicaSetInfo*>(MutableK8sMetadataObjectByID(replica_set_uid));
 
   for (const auto& owner_ref : update.owner_references()) {
     replica_set_info->AddOwnerReference(owner_ref.uid(), owner_ref.name(), owner_ref.kind());
@@ -432,7 +588,7 @@ Status K8sMetadataState::HandleReplicaSetUpdate(const ReplicaSetUpdate& update)
 
   VLOG(1) << "replica set update: " << update.name();
 
-  replica_sets_by_name_[{ns, name}] = replica_set_uid;
+  SetIfChanged(&replica_sets_by_name_, K8sNameIdent{ns, name}, replica_set_uid);
   return Status::OK();
 }
 
@@ -441,13 +597,13 @@ Status K8sMetadataState::HandleDeploymentUpdate(const DeploymentUpdate& update)
   const std::string& name = update.name();
   const std::string& ns = update.namespace_();
 
-  auto it = k8s_objects_by_id_.find(deployment_uid);
-  if (it == k8s_objects_by_id_.end()) {
+  if (!k8s_objects_by_id_->contains(deployment_uid)) {
     auto deployment = std::make_unique<DeploymentInfo>(update);
     VLOG(1) << "Adding Deployment: " << deployment->DebugString();
-    it = k8s_objects_by_id_.try_emplace(deployment_uid, std::move(deployment)).first;
+    k8s_objects_by_id_.Mutable()->try_emplace(deployment_uid, std::move(deployment));
   }
-  auto deployment_info = static_cast<DeploymentInfo*>(it->second.get());
+  auto deployment_info =
+      static_cast<DeploymentInfo*>(MutableK8sMetadataObjectByID(deployment_uid));
 
   deployment_info->set_start_time_ns(update.start_timestamp_ns());
   deployment_info->set_stop_time_ns(update.stop_timestamp_ns());
@@ -462,7 +618,7 @@ Status K8sMetadataState::HandleDeploymentUpdate(const DeploymentUpdate& update)
 
   VLOG(1) << "deployment update: " << update.name();
 
-  deployments_by_name_[{ns, name}] = deployment_uid;
+  SetIfChanged(&deployments_by_name_, K8sNameIdent{ns, name}, deployment_uid);
   return Status::OK();
 }
 
@@ -478,7 +634,8 @@ bool IsExpired(const T& obj, int64_t retention_time, int64_t now) {
 }
 
 Status K8sMetadataState::CleanupExpiredMetadata(int64_t now, int64_t retention_time_ns) {
-  for (auto iter = k8s_objects_by_id_.begin(); iter != k8s_objects_by_id_.end();) {
+  auto* k8s_objects_by_id = k8s_objects_by_id_.Mutable();
+  for (auto iter = k8s_objects_by_id->begin(); iter != k8s_objects_by_id->end();) {
     const auto& k8s_object = iter->second;
 
     if (!IsExpired(*k8s_object, retention_time_ns, now)) {
@@ -490,58 +647,65 @@ Status K8sMetadataState::CleanupExpiredMetadata(int64_t now, int64_t retention_t
       case K8sObjectType::kPod: {
         if (PodIDByName(std::make_pair(k8s_object->ns(), k8s_object->name())) ==
             k8s_object->uid()) {
-          pods_by_name_.erase({k8s_object->ns(), k8s_object->name()});
+          pods_by_name_.Mutable()->erase({k8s_object->ns(), k8s_object->name()});
         }
-        auto pod_ip = static_cast<PodInfo*>(k8s_object.get())->pod_ip();
+        auto pod_ip = static_cast<const PodInfo*>(k8s_object.get())->pod_ip();
         // There could be a new pod assigned to the podIP now, we should only
         // delete the IP from the map if it belongs to the terminated pod.
         if (PodIDByIP(pod_ip) == k8s_object->uid()) {
-          pods_by_ip_.erase(pod_ip);
+          pods_by_ip_.Mutable()->erase(pod_ip);
         }
 
-        auto it = pods_by_ip_and_start_time_.find(pod_ip);
-        if (it != pods_by_ip_and_start_time_.end()) {
-          auto& pod_set = it->second;
-          auto erase_end = pod_set.upper_bound({"", now - retention_time_ns});
+        PackedIP packed_ip;
+        const PodIPHistory* history = PodIPHistoryByIP(pod_ip);
+        if (history != nullptr && PackIP(pod_ip, &packed_ip)) {
+          size_t num_erased = history->NumStartedBy(now - retention_time_ns);
 
-          if (erase_end != pod_set.begin()) {
+          if (num_erased > 0) {
             // Check if the last pod we might erase is still running.
             // If the last of the pods being erased is running though it's
             // before the expiration time, leave it alone.
-            auto prev_obj = k8s_objects_by_id_.find(std::prev(erase_end)->first);
-            if (prev_obj != k8s_objects_by_id_.end()) {
-              auto prev_pod = static_cast<PodInfo*>(prev_obj->second.get());
+            auto prev_obj = k8s_objects_by_id->find(history->pods()[num_erased - 1].first);
+            if (prev_obj != k8s_objects_by_id->end()) {
+              auto prev_pod = static_cast<const PodInfo*>(prev_obj->second.get());
               if (prev_pod->phase() == PodPhase::kRunning || prev_pod->stop_time_ns() == 0) {
-                --erase_end;
+                --num_erased;
               }
             }
           }
-          pod_set.erase(pod_set.begin(), erase_end);
+          if (num_erased > 0) {
+            auto* pods_by_ip_and_start_time = pods_by_ip_and_start_time_.Mutable();
+            auto it = pods_by_ip_and_start_time->find(packed_ip);
+            it->second.EraseFirst(num_erased);
+            if (it->second.empty()) {
+              pods_by_ip_and_start_time->erase(it);
+            }
+          }
         }
         break;
       }
       case K8sObjectType::kNamespace:
         if (NamespaceIDByName(std::make_pair(k8s_object->ns(), k8s_object->name())) ==
             k8s_object->uid()) {
-          namespaces_by_name_.erase({k8s_object->ns(), k8s_object->name()});
+          namespaces_by_name_.Mutable()->erase({k8s_object->ns(), k8s_object->name()});
         }
         break;
       case K8sObjectType::kService:
         if (ServiceIDByName(std::make_pair(k8s_object->ns(), k8s_object->name())) ==
             k8s_object->uid()) {
-          services_by_name_.erase({k8s_object->ns(), k8s_object->name()});
+          services_by_name_.Mutable()->erase({k8s_object->ns(), k8s_object->name()});
         }
         break;
       case K8sObjectType::kReplicaSet:
         if (ReplicaSetIDByName(std::make_pair(k8s_object->ns(), k8s_object->name())) ==
             k8s_object->uid()) {
-          replica_sets_by_name_.erase({k8s_object->ns(), k8s_object->name()});
+          replica_sets_by_name_.Mutable()->erase({k8s_object->ns(), k8s_object->name()});
         }
         break;
       case K8sObjectType::kDeployment:
         if (DeploymentIDByName(std::make_pair(k8s_object->ns(), k8s_object->name())) ==
             k8s_object->uid()) {
-          deployments_by_name_.erase({k8s_object->ns(), k8s_object->name()});
+          deployments_by_name_.Mutable()->erase({k8s_object->ns(), k8s_object->name()});
         }
         break;
       default:
@@ -549,10 +713,11 @@ Status K8sMetadataState::CleanupExpiredMetadata(int64_t now, int64_t retention_t
                                         static_cast<int>(k8s_object->type()));
     }
 
-    k8s_objects_by_id_.erase(iter++);
+    k8s_objects_by_id->erase(iter++);
   }
 
-  for (auto iter = containers_by_id_.begin(); iter != containers_by_id_.end();) {
+  auto* containers_by_id = containers_by_id_.Mutable();
+  for (auto iter = containers_by_id->begin(); iter != containers_by_id->end();) {
     const auto& cinfo = iter->second;
 
     if (!IsExpired(*cinfo, retention_time_ns, now)) {
@@ -560,8 +725,8 @@ Status K8sMetadataState::CleanupExpiredMetadata(int64_t now, int64_t retention_t
       continue;
     }
 
-    containers_by_name_.erase(cinfo->name());
-    containers_by_id_.erase(iter++);
+    containers_by_name_.Mutable()->erase(cinfo->name());
+    containers_by_id->erase(iter++);
   }
 
   return Status::OK();
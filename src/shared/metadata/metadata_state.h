@@ -20,13 +20,14 @@
 
 #include <cstdint>
 #include <memory>
-#include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
+#include <absl/numeric/int128.h>
+#include <absl/types/span.h>
 
 #include "src/common/base/base.h"
 #include "src/common/event/event.h"
@@ -40,20 +41,89 @@
 namespace px {
 namespace md {
 
-using K8sMetadataObjectUPtr = std::unique_ptr<K8sMetadataObject>;
-using ContainerInfoUPtr = std::unique_ptr<ContainerInfo>;
+using K8sMetadataObjectSPtr = std::shared_ptr<K8sMetadataObject>;
+using ContainerInfoSPtr = std::shared_ptr<ContainerInfo>;
 using PIDInfoUPtr = std::unique_ptr<PIDInfo>;
 using AgentID = sole::uuid;
 
 using UIDAndStart = std::pair<UID, int64_t>;
-struct SortByStart {
-  bool operator()(const UIDAndStart& lhs, const UIDAndStart& rhs) const {
-    return lhs.second < rhs.second;
+
+/**
+ * An IPv4 or IPv6 address packed into an integer, which is cheaper to store and hash than its
+ * string form. IPv4 addresses are packed in their IPv4-mapped IPv6 form (::ffff:a.b.c.d).
+ */
+using PackedIP = absl::uint128;
+
+/**
+ * PodIPHistory holds the pods that were assigned an IP, sorted by start time. A pod owns the IP
+ * from its start time until the start time of the next pod.
+ */
+class PodIPHistory {
+ public:
+  /**
+   * Adds a pod to the history, unless a pod with the same start time is already in it.
+   * @return true if the pod was added.
+   */
+  bool Add(UIDAndStart pod);
+
+  /**
+   * @return the ID of the pod that owned the IP at the given time, or empty string if none did.
+   */
+  UID PodIDAtTime(int64_t timestamp_ns) const;
+
+  /**
+   * @return true if a pod that started at the given time is in the history.
+   */
+  bool HasPodStartedAt(int64_t start_time_ns) const;
+
+  /**
+   * @return the number of pods that started at or before the given time.
+   */
+  size_t NumStartedBy(int64_t timestamp_ns) const;
+
+  /**
+   * Removes the n pods that started first.
+   */
+  void EraseFirst(size_t n) { pods_.erase(pods_.begin(), pods_.begin() + n); }
+
+  const std::vector<UIDAndStart>& pods() const { return pods_; }
+  bool empty() const { return pods_.empty(); }
+
+ private:
+  // Sorted by start time, so that lookups are a binary search over contiguous memory.
+  std::vector<UIDAndStart> pods_;
+};
+
+/**
+ * CopyOnWrite holds a value that is shared by the copies of the CopyOnWrite, until one of them
+ * modifies it through Mutable(), which first gives that copy a value of its own.
+ * Must not be modified concurrently with its copies; reading concurrently is fine.
+ */
+template <typename T>
+class CopyOnWrite {
+ public:
+  CopyOnWrite() : value_(std::make_shared<T>()) {}
+
+  const T& operator*() const { return *value_; }
+  const T* operator->() const { return value_.get(); }
+
+  T* Mutable() {
+    if (value_.use_count() > 1) {
+      value_ = std::make_shared<T>(*value_);
+    }
+    return value_.get();
   }
+
+ private:
+  std::shared_ptr<T> value_;
 };
 
 /**
  * This class contains all kubernetes relate metadata.
+ *
+ * Clone() is cheap: the clone shares the maps and the metadata objects with the original, and
+ * copies them only when it modifies them. So, a clone must be modified only through the methods
+ * of this class, which do the copying.
  */
 class K8sMetadataState : NotCopyable {
  public:
@@ -115,8 +185,8 @@ class K8sMetadataState : NotCopyable {
   using NamespacesByNameMap = K8sEntityByNameMap;
   using ContainersByNameMap = absl::flat_hash_map<std::string, CID>;
   using PodsByPodIPMap = absl::flat_hash_map<std::string, UID>;
-  using PodsByIPAndStartTime = absl::flat_hash_map<std::string, std::set<UIDAndStart, SortByStart>>;
-  using ServicesByServiceIpMap = absl::flat_hash_map<std::string, UID>;
+  using PodsByIPAndStartTime = absl::flat_hash_map<PackedIP, PodIPHistory>;
+  using ServicesByServiceIpMap = absl::flat_hash_map<PackedIP, UID>;
 
   void set_service_cidr(CIDRBlock cidr) {
     if (!service_cidr_.has_value() || service_cidr_.value() != cidr) {
@@ -130,7 +200,7 @@ class K8sMetadataState : NotCopyable {
 
   const std::vector<CIDRBlock>& pod_cidrs() const { return pod_cidrs_; }
 
-  const PodsByNameMap& pods_by_name() const { return pods_by_name_; }
+  const PodsByNameMap& pods_by_name() const { return *pods_by_name_; }
 
   /**
    * PodInfoByID gets an unowned pointer to the Pod. This pointer will remain active
@@ -162,6 +232,16 @@ class K8sMetadataState : NotCopyable {
    */
   UID PodIDByIPAtTime(std::string_view pod_ip, int64_t timestamp_ns) const;
 
+  /**
+   * PodIDsByIPAtTime is the batch version of PodIDByIPAtTime, for looking up a whole column of
+   * IPs. The history of each distinct IP is only looked up once.
+   * @param pod_ips strings of the pod IPs.
+   * @param timestamps_ns times at which the requests occurred, one per IP.
+   * @param pod_ids set to the pod_id of each IP, or empty string if the pod does not exist.
+   */
+  void PodIDsByIPAtTime(absl::Span<const std::string_view> pod_ips,
+                        absl::Span<const int64_t> timestamps_ns, std::vector<UID>* pod_ids) const;
+
   /**
    * ServiceIDByClusterIP returns the ServiceID for the service with the given Cluster IP.
    * @param cluster_ip string of the cluster IP.
@@ -273,12 +353,28 @@ class K8sMetadataState : NotCopyable {
 
   Status CleanupExpiredMetadata(int64_t now, int64_t retention_time_ns);
 
-  absl::flat_hash_map<CID, ContainerInfoUPtr>& containers_by_id() { return containers_by_id_; }
+  const absl::flat_hash_map<CID, ContainerInfoSPtr>& containers_by_id() const {
+    return *containers_by_id_;
+  }
+
+  /**
+   * MutableContainerInfoByID returns the container info by ID, for modification.
+   * @param id The ID of the container.
+   * @return ContainerInfo or nullptr if not found.
+   */
+  ContainerInfo* MutableContainerInfoByID(CIDView id);
+
   std::string DebugString(int indent_level = 0) const;
 
  private:
   const K8sMetadataObject* K8sMetadataObjectByID(UIDView id, K8sObjectType type) const;
 
+  // Returns the K8s object of the given ID for modification, or nullptr if not found.
+  K8sMetadataObject* MutableK8sMetadataObjectByID(UIDView id);
+
+  // Returns the history of the pods that were assigned the IP, or nullptr if there is none.
+  const PodIPHistory* PodIPHistoryByIP(std::string_view pod_ip) const;
+
   // The CIDR block used for services inside the cluster.
   std::optional<CIDRBlock> service_cidr_;
 
@@ -286,56 +382,55 @@ class K8sMetadataState : NotCopyable {
   std::vector<CIDRBlock> pod_cidrs_;
 
   // This stores K8s native objects (services, pods, etc).
-  absl::flat_hash_map<UID, K8sMetadataObjectUPtr> k8s_objects_by_id_;
+  CopyOnWrite<absl::flat_hash_map<UID, K8sMetadataObjectSPtr>> k8s_objects_by_id_;
 
   // This stores container objects, complementing k8s_objects_by_id_.
-  absl::flat_hash_map<CID, ContainerInfoUPtr> containers_by_id_;
+  CopyOnWrite<absl::flat_hash_map<CID, ContainerInfoSPtr>> containers_by_id_;
 
   /**
    * Mapping of pods by name.
    */
-  PodsByNameMap pods_by_name_;
+  CopyOnWrite<PodsByNameMap> pods_by_name_;
 
   /**
    * Mapping of services by name.
    */
-  ServicesByNameMap services_by_name_;
+  CopyOnWrite<ServicesByNameMap> services_by_name_;
 
   /**
    * Mapping of namespaces by name.
    */
-  NamespacesByNameMap namespaces_by_name_;
+  CopyOnWrite<NamespacesByNameMap> namespaces_by_name_;
 
   /**
    * Mapping of replica sets by name.
    */
-  ReplicaSetByNameMap replica_sets_by_name_;
+  CopyOnWrite<ReplicaSetByNameMap> replica_sets_by_name_;
 
   /**
    * Mapping of deployments by name.
    */
-  DeploymentByNameMap deployments_by_name_;
+  CopyOnWrite<DeploymentByNameMap> deployments_by_name_;
 
   /**
    * Mapping of containers by name.
    */
-  ContainersByNameMap containers_by_name_;
+  CopyOnWrite<ContainersByNameMap> containers_by_name_;
 
   /**
    * Mapping of Pods by host ip.
    */
-  PodsByPodIPMap pods_by_ip_;
+  CopyOnWrite<PodsByPodIPMap> pods_by_ip_;
 
   /**
-   * Mapping of Pods by host ip, to a set of UID,start_time pairs
-   * sorted by start_time.
+   * Mapping of Pods by packed host ip, to the history of the pods that were assigned the ip.
    */
-  PodsByIPAndStartTime pods_by_ip_and_start_time_;
+  CopyOnWrite<PodsByIPAndStartTime> pods_by_ip_and_start_time_;
 
   /**
-   * Mapping of Services by Cluster IP.
+   * Mapping of Services by packed Cluster IP.
    */
-  ServicesByServiceIpMap services_by_cluster_ip_;
+  CopyOnWrite<ServicesByServiceIpMap> services_by_cluster_ip_;
 };
 
 class AgentMetadataState : NotCopyable {
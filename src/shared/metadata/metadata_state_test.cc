@@ -27,6 +27,7 @@ namespace px {
 namespace md {
 
 using ::google::protobuf::TextFormat;
+using ::testing::ElementsAre;
 using ::testing::UnorderedElementsAre;
 
 constexpr char kPod0UpdatePbTxt[] = R"(
@@ -324,6 +325,50 @@ TEST(K8sMetadataStateTest, CloneCopiedCIDR) {
   EXPECT_EQ(service_cidr.prefix_length, state_copy->service_cidr()->prefix_length);
 }
 
+TEST(K8sMetadataStateTest, CloneIsCopyOnWrite) {
+  K8sMetadataState state;
+
+  K8sMetadataState::ContainerUpdate container_update;
+  ASSERT_TRUE(TextFormat::MergeFromString(kContainer0UpdatePbTxt, &container_update))
+      << "Failed to parse proto";
+  K8sMetadataState::PodUpdate pod0_update;
+  ASSERT_TRUE(TextFormat::MergeFromString(kPod0UpdatePbTxt, &pod0_update))
+      << "Failed to parse proto";
+  K8sMetadataState::PodUpdate pod1_update;
+  ASSERT_TRUE(TextFormat::MergeFromString(kPod1UpdatePbTxt, &pod1_update))
+      << "Failed to parse proto";
+
+  EXPECT_OK(state.HandleContainerUpdate(container_update));
+  EXPECT_OK(state.HandlePodUpdate(pod0_update));
+
+  auto state_copy = state.Clone();
+
+  // The objects are shared until they are modified.
+  EXPECT_EQ(state.PodInfoByID("pod0_uid"), state_copy->PodInfoByID("pod0_uid"));
+  EXPECT_EQ(state.ContainerInfoByID("container0_uid"),
+            state_copy->ContainerInfoByID("container0_uid"));
+
+  pod0_update.set_message("another pod message");
+  EXPECT_OK(state_copy->HandlePodUpdate(pod0_update));
+
+  EXPECT_NE(state.PodInfoByID("pod0_uid"), state_copy->PodInfoByID("pod0_uid"));
+  EXPECT_EQ("a pod message", state.PodInfoByID("pod0_uid")->phase_message());
+  EXPECT_EQ("another pod message", state_copy->PodInfoByID("pod0_uid")->phase_message());
+  EXPECT_EQ(state.ContainerInfoByID("container0_uid"),
+            state_copy->ContainerInfoByID("container0_uid"));
+
+  EXPECT_OK(state_copy->HandlePodUpdate(pod1_update));
+
+  EXPECT_EQ(nullptr, state.PodInfoByID("pod1_uid"));
+  EXPECT_EQ("", state.PodIDByName({"ns0", "pod1"}));
+  EXPECT_NE(nullptr, state_copy->PodInfoByID("pod1_uid"));
+  EXPECT_EQ("pod1_uid", state_copy->PodIDByName({"ns0", "pod1"}));
+
+  // pod1 took over container0.
+  EXPECT_EQ("pod0_uid", state.ContainerInfoByID("container0_uid")->pod_id());
+  EXPECT_EQ("pod1_uid", state_copy->ContainerInfoByID("container0_uid")->pod_id());
+}
+
 TEST(K8sMetadataStateTest, HandleContainerUpdate) {
   K8sMetadataState state;
 
@@ -445,6 +490,9 @@ TEST(K8sMetadataStateTest, HandleServiceUpdate) {
   EXPECT_OK(state.HandleServiceUpdate(service_update));
   EXPECT_EQ(std::vector<std::string>{"127.0.0.1"}, service_info->external_ips());
   EXPECT_EQ("127.0.0.2", service_info->cluster_ip());
+  EXPECT_EQ("service0_uid", state.ServiceIDByClusterIP("127.0.0.2"));
+  EXPECT_EQ("", state.ServiceIDByClusterIP("127.0.0.3"));
+  EXPECT_EQ("", state.ServiceIDByClusterIP("not an ip"));
 }
 
 TEST(K8sMetadataStateTest, HandleNamespaceUpdate) {
@@ -616,6 +664,36 @@ TEST(K8sMetadataStateTest, ReusedIPs) {
   ASSERT_EQ("pod2_uid", state.PodIDByIPAtTime("1.2.3.5", 107));  // still running
 }
 
+TEST(K8sMetadataStateTest, PodIDsByIPAtTime) {
+  K8sMetadataState state;
+
+  K8sMetadataState::PodUpdate pod_update;
+  ASSERT_TRUE(TextFormat::MergeFromString(kPod0UpdatePbTxt, &pod_update));
+
+  K8sMetadataState::PodUpdate terminated_ip_pod_update;
+  ASSERT_TRUE(TextFormat::MergeFromString(kPod1UpdatePbTxt, &terminated_ip_pod_update));
+
+  K8sMetadataState::PodUpdate running_ip_pod_update;
+  ASSERT_TRUE(TextFormat::MergeFromString(kPod2UpdatePbTxt, &running_ip_pod_update));
+
+  EXPECT_OK(state.HandlePodUpdate(pod_update));
+  EXPECT_OK(state.HandlePodUpdate(terminated_ip_pod_update));
+  EXPECT_OK(state.HandlePodUpdate(running_ip_pod_update));
+
+  std::vector<std::string_view> pod_ips = {"1.2.3.4", "1.2.3.5",   "1.2.3.5",       "1.2.3.4",
+                                           "1.2.3.4", "not an ip", "::ffff:1.2.3.4"};
+  std::vector<int64_t> timestamps_ns = {102, 101, 107, 99, 102, 102, 102};
+  std::vector<UID> pod_ids;
+  state.PodIDsByIPAtTime(pod_ips, timestamps_ns, &pod_ids);
+
+  // IPv4-mapped IPv6 addresses are the same IP as their IPv4 form.
+  EXPECT_THAT(pod_ids,
+              ElementsAre("pod0_uid", "pod1_uid", "pod2_uid", "", "pod0_uid", "", "pod0_uid"));
+  for (size_t i = 0; i < pod_ips.size(); ++i) {
+    EXPECT_EQ(state.PodIDByIPAtTime(pod_ips[i], timestamps_ns[i]), pod_ids[i]);
+  }
+}
+
 TEST(K8sMetadataStateTest, CleanupExpiredMetadata) {
   K8sMetadataState state;
 
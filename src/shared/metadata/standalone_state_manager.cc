@@ -20,7 +20,6 @@
 #include <string>
 #include <utility>
 
-#include <absl/base/internal/spinlock.h>
 #include "src/common/system/proc_pid_path.h"
 #include "src/shared/metadata/standalone_state_manager.h"
 
@@ -48,8 +47,7 @@ absl::flat_hash_set<md::UPID> ListUPIDs(const std::filesystem::path& proc_path,
 
 std::shared_ptr<const AgentMetadataState>
 StandaloneAgentMetadataStateManager::CurrentAgentMetadataState() {
-  absl::base_internal::SpinLockHolder lock(&agent_metadata_state_lock_);
-  return std::const_pointer_cast<const AgentMetadataState>(agent_metadata_state_);
+  return agent_metadata_state_.Pin();
 }
 
 Status StandaloneAgentMetadataStateManager::PerformMetadataStateUpdate() {
@@ -63,20 +61,15 @@ Status StandaloneAgentMetadataStateManager::PerformMetadataStateUpdate() {
    *   3. Set current update time and increment the epoch.
    *   4. Replace the current agent_metdata_state_ ptr.
    */
-  uint32_t asid = 0;
-  uint64_t epoch_id = 0;
-  std::shared_ptr<AgentMetadataState> shadow_state;
-  {
-    absl::base_internal::SpinLockHolder lock(&agent_metadata_state_lock_);
-    // Copy the current state into the shadow state.
-    shadow_state = agent_metadata_state_->CloneToShared();
-    epoch_id = agent_metadata_state_->epoch_id();
-    asid = agent_metadata_state_->asid();
-  }
+  std::shared_ptr<const AgentMetadataState> current_state = agent_metadata_state_.Pin();
+  // Copy the current state into the shadow state. Readers keep using the current state meanwhile.
+  std::shared_ptr<AgentMetadataState> shadow_state = current_state->CloneToShared();
+  uint64_t epoch_id = current_state->epoch_id();
+  uint32_t asid = current_state->asid();
 
-  int64_t ts = agent_metadata_state_->current_time();
+  int64_t ts = current_state->current_time();
   auto upids = ListUPIDs(px::system::proc_path(), asid);
-  for (const md::UPID& up : agent_metadata_state_->upids()) {
+  for (const md::UPID& up : current_state->upids()) {
     if (!upids.contains(up)) {
       // Pid has been stopped.
       shadow_state->MarkUPIDAsStopped(up, ts);
@@ -109,14 +102,10 @@ Status StandaloneAgentMetadataStateManager::PerformMetadataStateUpdate() {
   PX_RETURN_IF_ERROR(px::ParseCIDRBlock(pod_cidr_str, &pod_cidr));
   shadow_state->k8s_metadata_state()->set_pod_cidrs({pod_cidr});
 
-  {
-    absl::base_internal::SpinLockHolder lock(&agent_metadata_state_lock_);
-    agent_metadata_state_ = std::move(shadow_state);
-    shadow_state.reset();
-  }
+  agent_metadata_state_.Publish(shadow_state);
 
   VLOG(1) << "State Update Complete";
-  VLOG(2) << "New MDS State: " << agent_metadata_state_->DebugString();
+  VLOG(2) << "New MDS State: " << shadow_state->DebugString();
   return Status::OK();
 }
 
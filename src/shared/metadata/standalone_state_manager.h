@@ -21,10 +21,9 @@
 #include <memory>
 #include <vector>
 
-#include <absl/base/internal/spinlock.h>
-
 #include "src/common/base/error.h"
 #include "src/common/event/time_system.h"
+#include "src/shared/metadata/atomic_snapshot.h"
 #include "src/shared/metadata/state_manager.h"
 
 namespace px {
@@ -37,9 +36,9 @@ class StandaloneAgentMetadataStateManager : public AgentMetadataStateManager {
  public:
   StandaloneAgentMetadataStateManager(std::string_view hostname, uint32_t asid, uint32_t pid,
                                       sole::uuid agent_id, event::TimeSystem* time_system) {
-    agent_metadata_state_ = std::make_shared<AgentMetadataState>(hostname, asid, pid, agent_id,
-                                                                 /*pod_name=*/"", sole::uuid(),
-                                                                 "standalone_pem", "", time_system);
+    agent_metadata_state_.Publish(std::make_shared<AgentMetadataState>(
+        hostname, asid, pid, agent_id, /*pod_name=*/"", sole::uuid(), "standalone_pem", "",
+        time_system));
   }
   virtual ~StandaloneAgentMetadataStateManager() = default;
   AgentMetadataFilter* metadata_filter() const override { return nullptr; }
@@ -56,10 +55,9 @@ class StandaloneAgentMetadataStateManager : public AgentMetadataStateManager {
 
  private:
   // The metadata state stored here is immutable so that we can easily share a read only
-  // copy across threads. The pointer is atomically updated in PerformMetadataStateUpdate(),
-  // which is responsible for applying the queued updates.
-  std::shared_ptr<const AgentMetadataState> agent_metadata_state_;
-  absl::base_internal::SpinLock agent_metadata_state_lock_;
+  // copy across threads. A new version is published in PerformMetadataStateUpdate(),
+  // which is responsible for applying the queued updates; readers pin it without locking.
+  AtomicSnapshot<AgentMetadataState> agent_metadata_state_;
   std::mutex metadata_state_update_lock_;
 };
 
@@ -16,7 +16,10 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <chrono>
 #include <memory>
+#include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -40,8 +43,7 @@ constexpr uint64_t kMinObjectRetentionAfterDeathNS = 24ULL * 3600ULL * 1'000'000
 
 std::shared_ptr<const AgentMetadataState>
 AgentMetadataStateManagerImpl::CurrentAgentMetadataState() {
-  absl::base_internal::SpinLockHolder lock(&agent_metadata_state_lock_);
-  return std::const_pointer_cast<const AgentMetadataState>(agent_metadata_state_);
+  return agent_metadata_state_.Pin();
 }
 
 size_t AgentMetadataStateManagerImpl::NumPIDUpdates() const { return pid_updates_.size_approx(); }
@@ -70,27 +72,28 @@ Status AgentMetadataStateManagerImpl::PerformMetadataStateUpdate() {
    *   6. Update pod/service CIDR information if it has changed.
    *   7. Replace the current agent_metdata_state_ ptr.
    */
-  uint64_t epoch_id = 0;
-  std::shared_ptr<AgentMetadataState> shadow_state;
-  {
-    absl::base_internal::SpinLockHolder lock(&agent_metadata_state_lock_);
-    // Copy the current state into the shadow state.
-    shadow_state = agent_metadata_state_->CloneToShared();
-    epoch_id = agent_metadata_state_->epoch_id();
-  }
+  const auto start_time = std::chrono::steady_clock::now();
+  std::shared_ptr<const AgentMetadataState> current_state = agent_metadata_state_.Pin();
+  // Copy the current state into the shadow state. Readers keep using the current state meanwhile.
+  std::shared_ptr<AgentMetadataState> shadow_state = current_state->CloneToShared();
+  uint64_t epoch_id = current_state->epoch_id();
 
   VLOG(1) << absl::Substitute("Starting update of current MDS, epoch_id=$0", epoch_id);
   VLOG(2) << "Current State: \n" << shadow_state->DebugString(1 /* indent_level */);
 
   // Get timestamp so all updates happen at the same timestamp.
-  int64_t ts = agent_metadata_state_->current_time();
+  int64_t ts = current_state->current_time();
   PX_RETURN_IF_ERROR(
       ApplyK8sUpdates(ts, shadow_state.get(), metadata_filter_, &incoming_k8s_updates_));
 
   if (collects_data_) {
     // Update PID information.
+    const auto pid_refresh_start_time = std::chrono::steady_clock::now();
     PX_RETURN_IF_ERROR(
         ProcessPIDUpdates(ts, proc_parser_, shadow_state.get(), md_reader_.get(), &pid_updates_));
+    pid_refresh_duration_gauge_.Set(std::chrono::duration<double>(
+                                        std::chrono::steady_clock::now() - pid_refresh_start_time)
+                                        .count());
   }
 
   // Update the pod/service CIDRs if they have been updated.
@@ -116,25 +119,142 @@ Status AgentMetadataStateManagerImpl::PerformMetadataStateUpdate() {
   shadow_state->set_epoch_id(epoch_id);
   shadow_state->set_last_update_ts_ns(ts);
 
-  {
-    absl::base_internal::SpinLockHolder lock(&agent_metadata_state_lock_);
-    agent_metadata_state_ = std::move(shadow_state);
-    shadow_state.reset();
-  }
+  agent_metadata_state_.Publish(shadow_state);
+  update_duration_gauge_.Set(
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count());
 
   VLOG(1) << "State Update Complete";
-  VLOG(2) << "New MDS State: " << agent_metadata_state_->DebugString();
+  VLOG(2) << "New MDS State: " << shadow_state->DebugString();
   return Status::OK();
 }
 
+namespace {
+
+// Returns the ID of the object that the update is for.
+std::string_view K8sUpdateObjectID(const ResourceUpdate& update) {
+  switch (update.update_case()) {
+    case ResourceUpdate::kPodUpdate:
+      return update.pod_update().uid();
+    case ResourceUpdate::kContainerUpdate:
+      return update.container_update().cid();
+    case ResourceUpdate::kServiceUpdate:
+      return update.service_update().uid();
+    case ResourceUpdate::kNamespaceUpdate:
+      return update.namespace_update().uid();
+    case ResourceUpdate::kNodeUpdate:
+      return update.node_update().uid();
+    case ResourceUpdate::kReplicaSetUpdate:
+      return update.replica_set_update().uid();
+    case ResourceUpdate::kDeploymentUpdate:
+      return update.deployment_update().uid();
+    default:
+      return "";
+  }
+}
+
+// Returns true if every element of prev is also in next. Used for the fields whose elements are
+// added to the object, rather than replacing the elements of the previous update.
+template <typename TRepeated, typename TKeyFn>
+bool ContainsAll(const TRepeated& next, const TRepeated& prev, TKeyFn key_fn) {
+  absl::flat_hash_set<std::string_view> next_keys;
+  for (const auto& elem : next) {
+    next_keys.insert(key_fn(elem));
+  }
+  for (const auto& elem : prev) {
+    if (!next_keys.contains(key_fn(elem))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string_view Identity(const std::string& str) { return str; }
+
+std::string_view OwnerReferenceUID(const px::shared::k8s::metadatapb::OwnerReference& owner_ref) {
+  return owner_ref.uid();
+}
+
+// Returns true if applying prev then next has the same result as only applying next, which are
+// updates of the same object. This mirrors what the K8sMetadataState handlers keep from an update.
+bool SupersedesK8sUpdate(const ResourceUpdate& next, const ResourceUpdate& prev) {
+  switch (next.update_case()) {
+    case ResourceUpdate::kPodUpdate: {
+      const auto& next_pod = next.pod_update();
+      const auto& prev_pod = prev.pod_update();
+      // The pod IP of every update is added to the IP history.
+      bool prev_ip_indexed = prev_pod.pod_ip() != "" && prev_pod.pod_ip() != prev_pod.host_ip();
+      bool same_ip = prev_pod.pod_ip() == next_pod.pod_ip() &&
+                     prev_pod.host_ip() == next_pod.host_ip() &&
+                     prev_pod.start_timestamp_ns() == next_pod.start_timestamp_ns();
+      return (!prev_ip_indexed || same_ip) &&
+             ContainsAll(next_pod.container_ids(), prev_pod.container_ids(), Identity) &&
+             ContainsAll(next_pod.owner_references(), prev_pod.owner_references(),
+                         OwnerReferenceUID);
+    }
+    case ResourceUpdate::kServiceUpdate: {
+      const auto& next_service = next.service_update();
+      const auto& prev_service = prev.service_update();
+      // Fields that are left empty in an update don't overwrite the previous ones.
+      return (prev_service.start_timestamp_ns() == 0 || next_service.start_timestamp_ns() != 0) &&
+             (prev_service.stop_timestamp_ns() == 0 || next_service.stop_timestamp_ns() != 0) &&
+             (prev_service.cluster_ip() == "" || next_service.cluster_ip() != "") &&
+             (prev_service.external_ips().empty() || !next_service.external_ips().empty()) &&
+             ContainsAll(next_service.pod_ids(), prev_service.pod_ids(), Identity);
+    }
+    case ResourceUpdate::kReplicaSetUpdate:
+      return ContainsAll(next.replica_set_update().owner_references(),
+                         prev.replica_set_update().owner_references(), OwnerReferenceUID);
+    case ResourceUpdate::kContainerUpdate:
+    case ResourceUpdate::kNamespaceUpdate:
+    case ResourceUpdate::kNodeUpdate:
+    case ResourceUpdate::kDeploymentUpdate:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+std::vector<std::unique_ptr<ResourceUpdate>> CoalesceK8sUpdates(
+    std::vector<std::unique_ptr<ResourceUpdate>> updates) {
+  std::vector<std::unique_ptr<ResourceUpdate>> coalesced;
+  // The index in coalesced of the latest update of each object. The keys point into the updates,
+  // which are kept alive by coalesced.
+  absl::flat_hash_map<std::pair<ResourceUpdate::UpdateCase, std::string_view>, size_t> latest;
+  for (auto& update : updates) {
+    auto key = std::make_pair(update->update_case(), K8sUpdateObjectID(*update));
+    auto it = latest.find(key);
+    if (it != latest.end() && SupersedesK8sUpdate(*update, *coalesced[it->second])) {
+      size_t idx = it->second;
+      latest.erase(it);
+      coalesced[idx] = std::move(update);
+      latest.emplace(std::make_pair(key.first, K8sUpdateObjectID(*coalesced[idx])), idx);
+      continue;
+    }
+    latest.insert_or_assign(key, coalesced.size());
+    coalesced.push_back(std::move(update));
+  }
+  return coalesced;
+}
+
 Status ApplyK8sUpdates(
     int64_t ts, AgentMetadataState* state, AgentMetadataFilter* metadata_filter,
     moodycamel::BlockingConcurrentQueue<std::unique_ptr<ResourceUpdate>>* updates) {
-  std::unique_ptr<ResourceUpdate> update(nullptr);
   PX_UNUSED(ts);
 
+  std::vector<std::unique_ptr<ResourceUpdate>> batch;
+  std::unique_ptr<ResourceUpdate> next(nullptr);
   // Returns false when no more items.
-  while (updates->try_dequeue(update)) {
+  while (updates->try_dequeue(next)) {
+    batch.push_back(std::move(next));
+  }
+  size_t num_received = batch.size();
+  batch = CoalesceK8sUpdates(std::move(batch));
+  VLOG(1) << absl::Substitute("Applying $0 K8s updates, coalesced from $1", batch.size(),
+                              num_received);
+
+  for (const auto& update : batch) {
     switch (update->update_case()) {
       case ResourceUpdate::kPodUpdate:
         PX_RETURN_IF_ERROR(HandlePodUpdate(update->pod_update(), state, metadata_filter));
@@ -235,8 +355,11 @@ Status ProcessPIDUpdates(
     int64_t ts, const system::ProcParser& proc_parser, AgentMetadataState* md,
     CGroupMetadataReader* md_reader,
     moodycamel::BlockingConcurrentQueue<std::unique_ptr<PIDStatusEvent>>* pid_updates) {
-  const auto& k8s_md_state = md->k8s_metadata_state();
+  K8sMetadataState* k8s_md_state = md->k8s_metadata_state();
 
+  // The containers are modified through MutableContainerInfoByID(), which may give k8s_md_state its
+  // own copy of the containers map. If so, the loop keeps iterating the map it started with, which
+  // the previous state keeps alive.
   for (const auto& [cid, cinfo] : k8s_md_state->containers_by_id()) {
     if (cinfo->stop_time_ns() != 0) {
       // Ignore dead containers.
@@ -263,7 +386,7 @@ Status ProcessPIDUpdates(
     if (pod_info->stop_time_ns() != 0) {
       VLOG(1) << absl::Substitute("Found a running container in a deleted pod [cid=$0, pod_id=$1]",
                                   cid, pod_id);
-      cinfo->set_stop_time_ns(pod_info->stop_time_ns());
+      k8s_md_state->MutableContainerInfoByID(cid)->set_stop_time_ns(pod_info->stop_time_ns());
       continue;
     }
 
@@ -281,17 +404,24 @@ Status ProcessPIDUpdates(
       // NOTE: Currently, MDS sends pods that do no belong to this Agent, so this is actually
       // required to avoid repeatedly printing out the warning message above.
       if (error::IsNotFound(s)) {
-        cinfo->set_stop_time_ns(ts);
-        for (const auto& upid : cinfo->active_upids()) {
+        ContainerInfo* mutable_cinfo = k8s_md_state->MutableContainerInfoByID(cid);
+        mutable_cinfo->set_stop_time_ns(ts);
+        for (const auto& upid : mutable_cinfo->active_upids()) {
           md->MarkUPIDAsStopped(upid, ts);
         }
-        cinfo->mutable_active_upids()->clear();
+        mutable_cinfo->mutable_active_upids()->clear();
       }
       continue;
     }
 
-    ProcessContainerPIDUpdates(cid, ts, proc_parser, md, cinfo->mutable_active_upids(),
-                               &cgroups_active_pids, pid_updates);
+    // The container is only copied if its PIDs changed.
+    StartTimeOrderedUPIDSet active_upids = cinfo->active_upids();
+    ProcessContainerPIDUpdates(cid, ts, proc_parser, md, &active_upids, &cgroups_active_pids,
+                               pid_updates);
+    if (active_upids != cinfo->active_upids()) {
+      *k8s_md_state->MutableContainerInfoByID(cid)->mutable_active_upids() =
+          std::move(active_upids);
+    }
   }
 
   return Status::OK();
@@ -314,6 +444,9 @@ Status HandlePodUpdate(const PodUpdate& update, AgentMetadataState* state,
   PX_RETURN_IF_ERROR(md_filter->InsertEntity(MetadataType::POD_NAME, update.name()));
   PX_RETURN_IF_ERROR(md_filter->InsertEntity(
       MetadataType::POD_NAME, PrependK8sNamespace(update.namespace_(), update.name())));
+  // Namespace updates are broadcast to every agent, so the namespace is recorded from the pods
+  // that are actually scheduled here. This lets the planner skip agents for namespace filters.
+  PX_RETURN_IF_ERROR(md_filter->InsertEntity(MetadataType::NAMESPACE, update.namespace_()));
   return state->k8s_metadata_state()->HandlePodUpdate(update);
 }
 
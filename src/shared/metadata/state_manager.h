@@ -28,11 +28,14 @@
 #include <absl/base/internal/spinlock.h>
 #include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
+#include <prometheus/gauge.h>
 
 #include "src/common/base/base.h"
 #include "src/common/event/time_system.h"
+#include "src/common/metrics/metrics.h"
 #include "src/common/system/system.h"
 #include "src/shared/k8s/metadatapb/metadata.pb.h"
+#include "src/shared/metadata/atomic_snapshot.h"
 #include "src/shared/metadata/cgroup_metadata_reader.h"
 #include "src/shared/metadata/k8s_objects.h"
 #include "src/shared/metadata/metadata_filter.h"
@@ -125,11 +128,19 @@ class AgentMetadataStateManagerImpl : public AgentMetadataStateManager {
                                 AgentMetadataFilter* metadata_filter, sole::uuid vizier_id,
                                 std::string vizier_name, std::string vizier_namespace,
                                 event::TimeSystem* time_system)
-      : pod_name_(pod_name), collects_data_(collects_data), metadata_filter_(metadata_filter) {
+      : pod_name_(pod_name),
+        collects_data_(collects_data),
+        metadata_filter_(metadata_filter),
+        update_duration_gauge_(BuildGauge("metadata_state_update_seconds",
+                                          "Duration of the last build of a new metadata state "
+                                          "snapshot.")),
+        pid_refresh_duration_gauge_(BuildGauge("metadata_pid_refresh_seconds",
+                                               "Duration of the last refresh of the PIDs of the "
+                                               "containers on this node.")) {
     md_reader_ = std::make_unique<CGroupMetadataReader>(config);
-    agent_metadata_state_ =
+    agent_metadata_state_.Publish(
         std::make_shared<AgentMetadataState>(hostname, asid, pid, agent_id, pod_name, vizier_id,
-                                             vizier_name, vizier_namespace, time_system);
+                                             vizier_name, vizier_namespace, time_system));
   }
 
   AgentMetadataFilter* metadata_filter() const override { return metadata_filter_; }
@@ -165,10 +176,9 @@ class AgentMetadataStateManagerImpl : public AgentMetadataStateManager {
 
   std::unique_ptr<CGroupMetadataReader> md_reader_;
   // The metadata state stored here is immutable so that we can easily share a read only
-  // copy across threads. The pointer is atomically updated in PerformMetadataStateUpdate(),
-  // which is responsible for applying the queued updates.
-  std::shared_ptr<const AgentMetadataState> agent_metadata_state_;
-  absl::base_internal::SpinLock agent_metadata_state_lock_;
+  // copy across threads. A new version is published in PerformMetadataStateUpdate(),
+  // which is responsible for applying the queued updates; readers pin it without locking.
+  AtomicSnapshot<AgentMetadataState> agent_metadata_state_;
   bool collects_data_;
 
   std::mutex metadata_state_update_lock_;
@@ -181,10 +191,23 @@ class AgentMetadataStateManagerImpl : public AgentMetadataStateManager {
   std::optional<std::vector<CIDRBlock>> pod_cidrs_;
 
   AgentMetadataFilter* metadata_filter_;
+
+  prometheus::Gauge& update_duration_gauge_;
+  prometheus::Gauge& pid_refresh_duration_gauge_;
 };
 
 /**
- * Applies K8s updates to the current state.
+ * Coalesces the updates of the same K8s object, in the order they were received. An update
+ * replaces the previous update of its object when applying both would have the same result as
+ * applying only the latest. It takes the place of the first update of the object, so that the
+ * updates that follow and refer to the object find it.
+ */
+std::vector<std::unique_ptr<ResourceUpdate>> CoalesceK8sUpdates(
+    std::vector<std::unique_ptr<ResourceUpdate>> updates);
+
+/**
+ * Applies K8s updates to the current state. All queued updates are applied as one batch, after
+ * coalescing the updates of the same object.
  */
 Status ApplyK8sUpdates(
     int64_t ts, AgentMetadataState* state, AgentMetadataFilter* metadata_filter,
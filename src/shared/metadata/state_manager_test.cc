@@ -410,11 +410,11 @@ TEST_F(AgentMetadataStateTest, insert_into_filter) {
   EXPECT_THAT(md_filter_.metadata_types(),
               UnorderedElementsAre(MetadataType::SERVICE_ID, MetadataType::SERVICE_NAME,
                                    MetadataType::POD_ID, MetadataType::POD_NAME,
-                                   MetadataType::CONTAINER_ID));
+                                   MetadataType::CONTAINER_ID, MetadataType::NAMESPACE));
   EXPECT_THAT(md_filter_.inserted_entities(),
               ElementsAre("CONTAINER_ID=container_id1", "POD_ID=pod_id1", "POD_NAME=pod1",
-                          "POD_NAME=pl/pod1", "SERVICE_ID=service_id1", "SERVICE_NAME=service1",
-                          "SERVICE_NAME=pl/service1"));
+                          "POD_NAME=pl/pod1", "NAMESPACE=pl", "SERVICE_ID=service_id1",
+                          "SERVICE_NAME=service1", "SERVICE_NAME=pl/service1"));
 }
 
 TEST_F(AgentMetadataStateTest, cidr_test) {
@@ -456,5 +456,64 @@ TEST_F(AgentMetadataStateTest, cidr_test) {
   EXPECT_EQ(svc_cidr, md_svc_cidr.value());
 }
 
+std::unique_ptr<ResourceUpdate> ParseResourceUpdate(std::string_view pbtxt) {
+  auto update = std::make_unique<ResourceUpdate>();
+  CHECK(google::protobuf::TextFormat::MergeFromString(std::string(pbtxt), update.get()));
+  return update;
+}
+
+TEST(CoalesceK8sUpdatesTest, KeepsLatestUpdateOfEachObject) {
+  std::vector<std::unique_ptr<ResourceUpdate>> updates;
+  updates.push_back(ParseResourceUpdate(kUpdate1_0Pbtxt));
+  updates.push_back(ParseResourceUpdate(kUpdate1_1Pbtxt));
+
+  // Replaces the first container update.
+  auto container_stopped = ParseResourceUpdate(kUpdate1_0Pbtxt);
+  container_stopped->mutable_container_update()->set_container_state(
+      px::shared::k8s::metadatapb::CONTAINER_STATE_TERMINATED);
+  container_stopped->mutable_container_update()->set_stop_timestamp_ns(1100);
+  updates.push_back(std::move(container_stopped));
+
+  // Drops the container of the pod, which doesn't remove it from the pod when applied after the
+  // first pod update, so it can't replace it.
+  auto pod_no_containers = ParseResourceUpdate(kUpdate1_1Pbtxt);
+  pod_no_containers->mutable_pod_update()->clear_container_ids();
+  updates.push_back(std::move(pod_no_containers));
+
+  // Replaces the previous pod update.
+  auto pod_failed = ParseResourceUpdate(kUpdate1_1Pbtxt);
+  pod_failed->mutable_pod_update()->set_phase(px::shared::k8s::metadatapb::FAILED);
+  updates.push_back(std::move(pod_failed));
+
+  updates.push_back(ParseResourceUpdate(kUpdate1_2Pbtxt));
+
+  auto coalesced = CoalesceK8sUpdates(std::move(updates));
+  ASSERT_EQ(4, coalesced.size());
+  EXPECT_EQ(1100, coalesced[0]->container_update().stop_timestamp_ns());
+  EXPECT_EQ(px::shared::k8s::metadatapb::RUNNING, coalesced[1]->pod_update().phase());
+  EXPECT_EQ(px::shared::k8s::metadatapb::FAILED, coalesced[2]->pod_update().phase());
+  EXPECT_EQ("service_id1", coalesced[3]->service_update().uid());
+}
+
+TEST_F(AgentMetadataStateTest, coalesced_updates_match_sequential_updates) {
+  moodycamel::BlockingConcurrentQueue<std::unique_ptr<ResourceUpdate>> updates;
+  GenerateTestUpdateEvents(&updates);
+  // A later update of the pod which only moves it to a new phase.
+  auto pod_failed = ParseResourceUpdate(kUpdate1_1Pbtxt);
+  pod_failed->mutable_pod_update()->set_phase(px::shared::k8s::metadatapb::FAILED);
+  pod_failed->mutable_pod_update()->set_stop_timestamp_ns(1500);
+  updates.enqueue(std::move(pod_failed));
+
+  EXPECT_OK(ApplyK8sUpdates(2000 /*ts*/, &metadata_state_, &md_filter_, &updates));
+
+  K8sMetadataState* state = metadata_state_.k8s_metadata_state();
+  auto* pod_info = state->PodInfoByID("pod_id1");
+  ASSERT_NE(nullptr, pod_info);
+  EXPECT_EQ(PodPhase::kFailed, pod_info->phase());
+  EXPECT_EQ(1500, pod_info->stop_time_ns());
+  EXPECT_THAT(pod_info->containers(), UnorderedElementsAre("container_id1"));
+  EXPECT_EQ("pod_id1", state->ContainerInfoByID("container_id1")->pod_id());
+}
+
 }  // namespace md
 }  // namespace px
@@ -18,9 +18,12 @@
 
 #include "src/shared/pprof/pprof.h"
 
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_cat.h>
 #include <absl/strings/str_join.h>
 #include <absl/strings/str_split.h>
 
+#include <utility>
 #include <vector>
 
 #include "src/common/base/base.h"
@@ -28,16 +31,147 @@
 namespace px {
 namespace shared {
 
-PProfProfile CreatePProfProfile(const uint32_t period_ms, const PProfHisto& histo) {
+namespace {
+// The profile header fills the first string table entries, see Build().
+constexpr uint64_t kNumHeaderStrings = 5;
+}  // namespace
+
+uint64_t PProfBuilder::InternSymbol(std::string_view symbol) {
+  // New symbols get the next location id.
+  const auto [iter, inserted] = location_ids_.try_emplace(symbol, location_ids_.size() + 1);
+  return iter->second;
+}
+
+void PProfBuilder::AddStackTrace(std::string_view stack_trace, uint64_t count) {
+  // Our stack traces are symbolized like so: main;foo;bar
+  // thus, we split on ';' to iterate over the individual symbols.
+  const std::vector<std::string_view> symbols = absl::StrSplit(stack_trace, ";");
+
+  // Because of how we built the stack trace string and how the pprof profile is organized, we
+  // iterate in reverse order.
+  LocationIDs location_ids;
+  location_ids.reserve(symbols.size());
+  for (auto symbols_iter = symbols.rbegin(); symbols_iter != symbols.rend(); ++symbols_iter) {
+    location_ids.push_back(InternSymbol(*symbols_iter));
+  }
+  samples_[std::move(location_ids)] += count;
+}
+
+Status PProfBuilder::AddProfile(const PProfProfile& pprof) {
+  // Maps the location ids of pprof to the ones of this builder. PProf proto locations and
+  // functions are 1 indexed, and stored in the order of their ids.
+  std::vector<uint64_t> location_ids(pprof.location_size() + 1, 0);
+  for (const auto& location : pprof.location()) {
+    if (location.id() == 0 || location.id() > static_cast<uint64_t>(pprof.location_size()) ||
+        location.line_size() != 1) {
+      return error::Internal("Invalid location in pprof profile.");
+    }
+    // Each location points to a line, which points to a function, which points to a symbol.
+    const uint64_t function_id = location.line(0).function_id();
+    if (function_id == 0 || function_id > static_cast<uint64_t>(pprof.function_size())) {
+      return error::Internal("Invalid function id in pprof profile.");
+    }
+    const int64_t name = pprof.function(function_id - 1).name();
+    if (name < 0 || name >= pprof.string_table_size()) {
+      return error::Internal("Invalid function name in pprof profile.");
+    }
+    location_ids[location.id()] = InternSymbol(pprof.string_table(name));
+  }
+
+  for (const auto& sample : pprof.sample()) {
+    LocationIDs ids;
+    ids.reserve(sample.location_id_size());
+    for (const uint64_t id : sample.location_id()) {
+      if (id >= location_ids.size() || location_ids[id] == 0) {
+        return error::Internal("Invalid location id in pprof sample.");
+      }
+      ids.push_back(location_ids[id]);
+    }
+    // There are two values for each sample: count & nanos. The nanos are recomputed from the
+    // count and the period by Build().
+    if (sample.value_size() < 1) {
+      return error::Internal("Missing count in pprof sample.");
+    }
+    samples_[std::move(ids)] += sample.value(0);
+  }
+  return Status::OK();
+}
+
+void PProfBuilder::AddFrame(uint64_t source, uint64_t frame_id, std::string_view frame) {
+  frames_.try_emplace(FrameKey{source, frame_id}, frame);
+}
+
+void PProfBuilder::AddInternedStackTrace(uint64_t source, std::string_view frame_ids,
+                                         uint64_t count) {
+  const std::vector<std::string_view> ids = absl::StrSplit(frame_ids, ";");
+
+  // Leaf first, like the location ids of the samples.
+  InternedStackTrace stack_trace{source, {}};
+  stack_trace.second.reserve(ids.size());
+  for (auto ids_iter = ids.rbegin(); ids_iter != ids.rend(); ++ids_iter) {
+    // Frame ids start at 1, so an invalid frame id resolves to an unknown frame.
+    uint64_t frame_id = 0;
+    if (!absl::SimpleAtoi(*ids_iter, &frame_id)) {
+      frame_id = 0;
+    }
+    stack_trace.second.push_back(frame_id);
+  }
+  interned_samples_[std::move(stack_trace)] += count;
+}
+
+void PProfBuilder::ResolveFrames() {
+  for (const auto& [stack_trace, count] : interned_samples_) {
+    const auto& [source, frame_ids] = stack_trace;
+    LocationIDs location_ids;
+    location_ids.reserve(frame_ids.size());
+    for (const uint64_t frame_id : frame_ids) {
+      const auto iter = frames_.find(FrameKey{source, frame_id});
+      location_ids.push_back(iter != frames_.end()
+                                 ? InternSymbol(iter->second)
+                                 : InternSymbol(absl::StrCat("<unknown frame ", frame_id, ">")));
+    }
+    samples_[std::move(location_ids)] += count;
+  }
+  interned_samples_.clear();
+}
+
+std::vector<const std::string*> PProfBuilder::SymbolsByLocationID() const {
+  std::vector<const std::string*> symbols(location_ids_.size());
+  for (const auto& [symbol, location_id] : location_ids_) {
+    symbols[location_id - 1] = &symbol;
+  }
+  return symbols;
+}
+
+void PProfBuilder::Merge(const PProfBuilder& other) {
+  const auto other_symbols = other.SymbolsByLocationID();
+  std::vector<uint64_t> location_ids(other_symbols.size() + 1, 0);
+  for (const auto& [i, symbol] : Enumerate(other_symbols)) {
+    location_ids[i + 1] = InternSymbol(*symbol);
+  }
+  for (const auto& [other_ids, count] : other.samples_) {
+    LocationIDs ids;
+    ids.reserve(other_ids.size());
+    for (const uint64_t id : other_ids) {
+      ids.push_back(location_ids[id]);
+    }
+    samples_[std::move(ids)] += count;
+  }
+  for (const auto& [frame_key, frame] : other.frames_) {
+    frames_.try_emplace(frame_key, frame);
+  }
+  for (const auto& [stack_trace, count] : other.interned_samples_) {
+    interned_samples_[stack_trace] += count;
+  }
+}
+
+PProfProfile PProfBuilder::Build(uint32_t period_ms) const {
   // Info on the pprof proto format:
   // https://github.com/google/pprof/blob/main/proto/profile.proto
 
   // period_ms is the stack trace sampling period used by the eBPF stack trace sampling probe.
   // period_ns will be used when populating the nanos count.
-  const uint64_t period_ns = period_ms * 1000 * 1000;
-
-  // Tracks which strings have been inserted into the profile.
-  absl::flat_hash_map<std::string, uint64_t> strings;
+  const uint64_t period_ns = static_cast<uint64_t>(period_ms) * 1000 * 1000;
 
   // This is the pprof profile.
   ::perftools::profiles::Profile profile;
@@ -58,6 +192,7 @@ PProfProfile CreatePProfProfile(const uint32_t period_ms, const PProfHisto& hist
   sample_type->set_unit(4);
   profile.add_string_table("cpu");
   profile.add_string_table("nanoseconds");
+  DCHECK_EQ(static_cast<uint64_t>(profile.string_table_size()), kNumHeaderStrings);
 
   // Store the underlying stack trace sampling period.
   auto period_type = profile.mutable_period_type();
@@ -65,85 +200,49 @@ PProfProfile CreatePProfProfile(const uint32_t period_ms, const PProfHisto& hist
   period_type->set_unit(4);
   profile.set_period(period_ns);
 
-  // State variables useful as we build the pprof profile message.
-  // No locations messages exist (yet); next_location_id starts at 1.
-  // We already added some strings; next_string_id starts at 5.
-  uint64_t next_location_id = 1;
-  uint64_t next_string_id = 5;
+  // Each symbol is recorded as a "location" message, which in turn refers to a string in the
+  // strings table. Each location may include an address and a reference to a mapping (useful
+  // if symbols are not included in the profile, enables post-hoc symbolization). Lacking both
+  // address and mapping here, we skip those.
+  for (const auto& [i, symbol] : Enumerate(SymbolsByLocationID())) {
+    const uint64_t location_id = i + 1;
+    auto location = profile.add_location();
+    location->set_id(location_id);
+
+    // To connect a location to a symbol, we need to go through a "line" and a "function".
+    // In our usage, the line is essentially a pointer to a function message that points to a
+    // symbol. The function message may contain more information (e.g. starting line number).
+    auto line = location->add_line();
+    line->set_function_id(location_id);
+
+    auto function = profile.add_function();
+    function->set_id(location_id);
+    function->set_name(kNumHeaderStrings + i);
+    profile.add_string_table(*symbol);
+  }
 
-  // To build the profile, we iterate over the stack traces histogram.
-  for (const auto& [stack_trace_str, count] : histo) {
-    // Each histo entry will be recorded as a new sample.
+  // Each stack trace is recorded as a sample, which is a sequence of locations.
+  for (const auto& [location_ids, count] : samples_) {
     auto sample = profile.add_sample();
 
     // That sample will record its count and time in nanos.
-    const uint64_t nanos = count * period_ns;
     sample->add_value(count);
-    sample->add_value(nanos);
-
-    // Our stack traces are symbolized like so: main;foo;bar
-    // thus, we split on ';' to iterate over the individual symbols.
-    const std::vector<std::string_view> symbols = absl::StrSplit(stack_trace_str, ";");
-
-    // Iterate over the symbols in this stack trace.
-    // Each symbol will be added to the sample as a "location" message, which in turn refers to a
-    // string in the strings table (tracked in map "strings") (more details below).
-    // Note, because of how we built the stack trace string and how the pprof profile is
-    // organized, we iterate in reverse order.
-    for (auto symbols_iter = symbols.rbegin(); symbols_iter != symbols.rend(); ++symbols_iter) {
-      const auto& symbol = *symbols_iter;
-
-      // try_emplace() looks up an existing entry in the strings table, or creates a new entry
-      // with the key provided. Here a new entry maps from symbol to next_location_id.
-      const auto [strings_iter, inserted] = strings.try_emplace(symbol, next_location_id);
-
-      if (inserted) {
-        // New symbol: create a new location, add it to the sample, and create a new symbol.
-
-        const uint64_t location_id = next_location_id;
-        const uint64_t string_id = next_string_id;
-        ++next_location_id;
-        ++next_string_id;
-
-        // Add a new "location" to the profile.
-        // Each sample is a sequence of locations. The locations, in their sequence, represent a
-        // stack trace. Each location may include an address and a reference to a mapping (useful
-        // if symbols are not included in the profile, enables post-hoc symbolization).
-        // Lacking both address and mapping here, we skip those.
-        auto location = profile.add_location();
-        location->set_id(location_id);
-
-        // To connect a location to a symbol, we need to go through a "line" and a "function".
-
-        // Add a "line" message to the location message.
-        // In our usage, this is essentially a pointer to a function message that points to a
-        // symbol. The function message may contain more information (e.g. starting line number).
-        auto line = location->add_line();
-        line->set_function_id(location_id);
-
-        // Add a "function" to the profile (to point to the string table).
-        auto function = profile.add_function();
-        function->set_id(location_id);
-
-        // Add a reference to the string table entry in the function message.
-        function->set_name(string_id);
-
-        // Add the string to the string table in the profile.
-        profile.add_string_table(std::string(symbol));
-
-        // Add the new location-id into the sample in the profile.
-        sample->add_location_id(location_id);
-      } else {
-        // Existing symbol.
-        // Just place the pre-existing location id into the sample.
-        const uint64_t location_id = strings_iter->second;
-        sample->add_location_id(location_id);
-      }
+    sample->add_value(count * period_ns);
+    for (const uint64_t location_id : location_ids) {
+      sample->add_location_id(location_id);
     }
   }
   return profile;
 }
 
+PProfProfile CreatePProfProfile(const uint32_t period_ms, const PProfHisto& histo) {
+  PProfBuilder builder;
+  for (const auto& [stack_trace_str, count] : histo) {
+    builder.AddStackTrace(stack_trace_str, count);
+  }
+  return builder.Build(period_ms);
+}
+
 absl::flat_hash_map<std::string, uint64_t> DeserializePProfProfile(const PProfProfile& pprof) {
   // This function reads from the protobuf pprof to populate and return this stack trace histogram.
   absl::flat_hash_map<std::string, uint64_t> histo;
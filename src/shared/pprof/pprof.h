@@ -19,10 +19,14 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include <absl/container/flat_hash_map.h>
 
 #include "proto/profile.pb.h"
+#include "src/common/base/status.h"
 
 namespace px {
 namespace shared {
@@ -30,6 +34,65 @@ namespace shared {
 using PProfProfile = ::perftools::profiles::Profile;
 using PProfHisto = absl::flat_hash_map<std::string, uint64_t>;
 
+/**
+ * Builds a pprof profile incrementally out of folded stack traces (e.g. "main;foo;bar").
+ * Each distinct symbol is stored once and gets its own location id, and every distinct stack
+ * trace is stored as the vector of the location ids of its symbols. This takes much less
+ * memory than a histogram of the folded stack trace strings, and the profiles of several
+ * builders can be merged without going back to strings.
+ *
+ * It also builds profiles out of stack traces whose frames are interned, i.e. stack traces of
+ * frame ids (e.g. "1;2;3") along with the frames that the ids stand for. Frame ids are scoped by
+ * a source (e.g. the ASID of the PEM that assigned them), and may be added before or after the
+ * stack traces that use them.
+ */
+class PProfBuilder {
+ public:
+  // Adds count samples of a stack trace whose symbols are separated by ';', root first.
+  void AddStackTrace(std::string_view stack_trace, uint64_t count);
+
+  // Adds the samples of a profile created by Build().
+  Status AddProfile(const PProfProfile& pprof);
+
+  // Names the frame id of a source.
+  void AddFrame(uint64_t source, uint64_t frame_id, std::string_view frame);
+
+  // Adds count samples of a stack trace whose frame ids are separated by ';', root first.
+  // The stack trace is added to the samples by ResolveFrames().
+  void AddInternedStackTrace(uint64_t source, std::string_view frame_ids, uint64_t count);
+
+  // Adds the interned stack traces to the samples, with their frames named by AddFrame().
+  // Frames that were not named are kept, as "<unknown frame ID>".
+  void ResolveFrames();
+
+  void Merge(const PProfBuilder& other);
+
+  PProfProfile Build(uint32_t period_ms) const;
+
+  size_t num_symbols() const { return location_ids_.size(); }
+  size_t num_stack_traces() const { return samples_.size(); }
+
+ private:
+  // The location ids of a stack trace, leaf first like in the pprof samples.
+  using LocationIDs = std::vector<uint64_t>;
+
+  uint64_t InternSymbol(std::string_view symbol);
+  // Returns the symbols indexed by location id - 1.
+  std::vector<const std::string*> SymbolsByLocationID() const;
+
+  // Maps each symbol to its location id. Ids start at 1 since pprof reserves 0, and location i
+  // points to function i, which is named by the ith symbol string of the profile.
+  absl::flat_hash_map<std::string, uint64_t> location_ids_;
+  absl::flat_hash_map<LocationIDs, uint64_t> samples_;
+
+  // The frames by source & frame id, and the interned stack traces of frame ids (leaf first) by
+  // source; see AddFrame() and AddInternedStackTrace().
+  using FrameKey = std::pair<uint64_t, uint64_t>;
+  using InternedStackTrace = std::pair<uint64_t, std::vector<uint64_t>>;
+  absl::flat_hash_map<FrameKey, std::string> frames_;
+  absl::flat_hash_map<InternedStackTrace, uint64_t> interned_samples_;
+};
+
 // https://github.com/google/pprof/blob/main/proto/profile.proto
 PProfProfile CreatePProfProfile(const uint32_t period_ms, const PProfHisto& histo);
 PProfHisto DeserializePProfProfile(const PProfProfile& pprof);
@@ -58,6 +58,11 @@ class ColumnWrapper {
   // underlying arrow::Array is always of type INT64.
   static SharedColumnWrapper FromArrow(DataType data_type,
                                        const std::shared_ptr<arrow::Array>& arr);
+  // Like FromArrow, except that the values are copied into reuse when it is a column of the same
+  // type that nothing else holds on to. This lets callers recycle the column of the previous batch
+  // instead of allocating a new one for every batch.
+  static SharedColumnWrapper FromArrow(const std::shared_ptr<arrow::Array>& arr,
+                                       SharedColumnWrapper reuse);
 
   virtual BaseValueType* UnsafeRawData() = 0;
   virtual const BaseValueType* UnsafeRawData() const = 0;
@@ -67,9 +72,15 @@ class ColumnWrapper {
   virtual int64_t Bytes() const = 0;
 
   virtual void Reserve(size_t size) = 0;
+  virtual void Resize(size_t size) = 0;
   virtual void Clear() = 0;
   virtual void ShrinkToFit() = 0;
   virtual std::shared_ptr<arrow::Array> ConvertToArrow(arrow::MemoryPool* mem_pool) = 0;
+  // ShareAsArrow converts the column like ConvertToArrow, except that the values of fixed width
+  // columns (INT64, FLOAT64 and TIME64NS) aren't copied: the returned array points at the values
+  // of the column, and keeps the column alive. The column must not be modified once it's shared.
+  static std::shared_ptr<arrow::Array> ShareAsArrow(const SharedColumnWrapper& col,
+                                                    arrow::MemoryPool* mem_pool);
   // GetView returns an empty string view for all non-string columns.
   virtual std::string_view GetView(size_t idx) const = 0;
 
@@ -135,7 +146,7 @@ class ColumnWrapperTmpl : public ColumnWrapper {
 
   void ShrinkToFit() override { data_.shrink_to_fit(); }
 
-  void Resize(size_t size) { data_.resize(size); }
+  void Resize(size_t size) override { data_.resize(size); }
 
   void Clear() override { data_.clear(); }
 
@@ -204,11 +215,22 @@ using Float64ValueColumnWrapper = ColumnWrapperTmpl<Float64Value>;
 using StringValueColumnWrapper = ColumnWrapperTmpl<StringValue>;
 using Time64NSValueColumnWrapper = ColumnWrapperTmpl<Time64NSValue>;
 
+// Returns reuse resized to size if it can be written to, and a new column otherwise.
+template <types::DataType DType>
+inline SharedColumnWrapper ReuseOrMake(SharedColumnWrapper reuse, size_t size) {
+  if (reuse == nullptr || reuse->data_type() != DType || reuse.use_count() > 1) {
+    return ColumnWrapper::Make(DType, size);
+  }
+  reuse->Resize(size);
+  return reuse;
+}
+
 template <typename TColumnWrapper, types::DataType DType>
-inline SharedColumnWrapper FromArrowImpl(const std::shared_ptr<arrow::Array>& arr) {
+inline SharedColumnWrapper FromArrowImpl(const std::shared_ptr<arrow::Array>& arr,
+                                         SharedColumnWrapper reuse = nullptr) {
   CHECK_EQ(arr->type_id(), DataTypeTraits<DType>::arrow_type_id);
   size_t size = arr->length();
-  auto wrapper = TColumnWrapper::Make(DType, size);
+  auto wrapper = ReuseOrMake<DType>(std::move(reuse), size);
   auto arr_casted = static_cast<typename DataTypeTraits<DType>::arrow_array_type*>(arr.get());
   typename DataTypeTraits<DType>::value_type* out_data =
       static_cast<TColumnWrapper*>(wrapper.get())->UnsafeRawData();
@@ -220,14 +242,17 @@ inline SharedColumnWrapper FromArrowImpl(const std::shared_ptr<arrow::Array>& ar
 
 template <>
 inline SharedColumnWrapper FromArrowImpl<StringValueColumnWrapper, DataType::STRING>(
-    const std::shared_ptr<arrow::Array>& arr) {
+    const std::shared_ptr<arrow::Array>& arr, SharedColumnWrapper reuse) {
   CHECK_EQ(arr->type_id(), DataTypeTraits<types::STRING>::arrow_type_id);
   size_t size = arr->length();
-  auto wrapper = StringValueColumnWrapper::Make(types::STRING, size);
+  auto wrapper = ReuseOrMake<types::STRING>(std::move(reuse), size);
   auto arr_casted = static_cast<arrow::StringArray*>(arr.get());
   StringValue* out_data = static_cast<StringValueColumnWrapper*>(wrapper.get())->UnsafeRawData();
   for (size_t i = 0; i < size; ++i) {
-    out_data[i] = arr_casted->GetString(i);
+    // Assigning in place keeps the capacity of a reused string.
+    int32_t len;
+    const uint8_t* data = arr_casted->GetValue(i, &len);
+    out_data[i].assign(reinterpret_cast<const char*>(data), len);
   }
   return wrapper;
 }
@@ -248,6 +273,18 @@ inline SharedColumnWrapper ColumnWrapper::FromArrow(const std::shared_ptr<arrow:
 #undef TYPE_CASE
 }
 
+inline SharedColumnWrapper ColumnWrapper::FromArrow(const std::shared_ptr<arrow::Array>& arr,
+                                                    SharedColumnWrapper reuse) {
+  auto type_id = arr->type_id();
+#define EXPR_CASE(_dt_) DataTypeTraits<_dt_>::arrow_type_id
+#define TYPE_CASE(_dt_)                                                            \
+  return FromArrowImpl<ColumnWrapperTmpl<DataTypeTraits<_dt_>::value_type>, _dt_>( \
+      arr, std::move(reuse));
+  PX_SWITCH_FOREACH_DATATYPE_WITHEXPR(type_id, EXPR_CASE, TYPE_CASE);
+#undef EXPR_CASE
+#undef TYPE_CASE
+}
+
 inline SharedColumnWrapper ColumnWrapper::FromArrow(DataType data_type,
                                                     const std::shared_ptr<arrow::Array>& arr) {
 #define TYPE_CASE(_dt_) \
@@ -270,6 +307,50 @@ inline SharedColumnWrapper ColumnWrapper::Make(DataType data_type, size_t size)
 #undef TYPE_CASE
 }
 
+// An arrow buffer over the values of a column wrapper, which keeps the column wrapper alive.
+class ColumnWrapperBuffer : public arrow::Buffer {
+ public:
+  ColumnWrapperBuffer(SharedColumnWrapper col, const uint8_t* data, int64_t size)
+      : arrow::Buffer(data, size), col_(std::move(col)) {}
+
+ private:
+  SharedColumnWrapper col_;
+};
+
+template <DataType DType>
+inline std::shared_ptr<arrow::Array> ShareFixedWidthAsArrow(
+    const SharedColumnWrapper& col, const std::shared_ptr<arrow::DataType>& arrow_type) {
+  using TValueType = typename DataTypeTraits<DType>::value_type;
+  using TNativeType = typename DataTypeTraits<DType>::native_type;
+  static_assert(sizeof(TValueType) == sizeof(TNativeType),
+                "The value type must have the layout of the arrow values to be shared.");
+  const TValueType* values =
+      static_cast<const ColumnWrapperTmpl<TValueType>*>(col.get())->UnsafeRawData();
+  auto buffer = std::make_shared<ColumnWrapperBuffer>(
+      col, reinterpret_cast<const uint8_t*>(values), col->Size() * sizeof(TNativeType));
+  return arrow::MakeArray(arrow::ArrayData::Make(arrow_type, col->Size(), {nullptr, buffer},
+                                                 /* null_count */ 0));
+}
+
+inline std::shared_ptr<arrow::Array> ColumnWrapper::ShareAsArrow(const SharedColumnWrapper& col,
+                                                                 arrow::MemoryPool* mem_pool) {
+  if (col->Empty()) {
+    return col->ConvertToArrow(mem_pool);
+  }
+  switch (col->data_type()) {
+    case DataType::INT64:
+      return ShareFixedWidthAsArrow<DataType::INT64>(col, arrow::int64());
+    case DataType::FLOAT64:
+      return ShareFixedWidthAsArrow<DataType::FLOAT64>(col, arrow::float64());
+    case DataType::TIME64NS:
+      return ShareFixedWidthAsArrow<DataType::TIME64NS>(col,
+                                                        arrow::time64(arrow::TimeUnit::NANO));
+    default:
+      // Booleans are bit-packed, and strings need their offsets, so both are copied.
+      return col->ConvertToArrow(mem_pool);
+  }
+}
+
 template <class TValueType>
 inline void ColumnWrapper::Append(TValueType val) {
   CHECK_EQ(data_type(), ValueTypeTraits<TValueType>::data_type)
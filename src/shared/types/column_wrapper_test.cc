@@ -283,5 +283,55 @@ TEST(ColumnWrapperTest, MoveIndexes) {
   }
 }
 
+TEST(ColumnWrapperTest, ShareAsArrow) {
+  // Fixed width values are shared with the arrow array, which keeps them alive.
+  std::shared_ptr<arrow::Array> times;
+  const Time64NSValue* values = nullptr;
+  {
+    auto col = ColumnWrapper::Make(DataType::TIME64NS, 0);
+    col->AppendFromVector(std::vector<Time64NSValue>{5, 8, 1});
+    values = static_cast<const Time64NSValueColumnWrapper*>(col.get())->UnsafeRawData();
+    times = ColumnWrapper::ShareAsArrow(col, arrow::default_memory_pool());
+    EXPECT_TRUE(times->Equals(col->ConvertToArrow(arrow::default_memory_pool())));
+  }
+  auto times_casted = static_cast<arrow::Time64Array*>(times.get());
+  EXPECT_EQ(reinterpret_cast<const int64_t*>(values), times_casted->raw_values());
+  EXPECT_EQ(8, times_casted->Value(1));
+
+  // Other values are copied.
+  auto col = ColumnWrapper::Make(DataType::STRING, 0);
+  col->AppendFromVector(std::vector<StringValue>{"abc", "", "de"});
+  auto strings = ColumnWrapper::ShareAsArrow(col, arrow::default_memory_pool());
+  EXPECT_TRUE(strings->Equals(col->ConvertToArrow(arrow::default_memory_pool())));
+
+  auto empty = ColumnWrapper::Make(DataType::INT64, 0);
+  EXPECT_EQ(0, ColumnWrapper::ShareAsArrow(empty, arrow::default_memory_pool())->length());
+}
+
+TEST(ColumnWrapperTest, FromArrowReuse) {
+  auto strings = ToArrow(std::vector<StringValue>{"abc", "", "de"}, arrow::default_memory_pool());
+  auto col = ColumnWrapper::FromArrow(strings, nullptr);
+  const auto* data = col.get();
+
+  // A column that nothing else holds is written in place.
+  auto more_strings = ToArrow(std::vector<StringValue>{"f", "gh"}, arrow::default_memory_pool());
+  col = ColumnWrapper::FromArrow(more_strings, std::move(col));
+  EXPECT_EQ(data, col.get());
+  ASSERT_EQ(2, col->Size());
+  EXPECT_EQ("gh", col->Get<StringValue>(1));
+
+  // A column that is still held elsewhere, or that has another type, is not.
+  auto held = col;
+  col = ColumnWrapper::FromArrow(strings, std::move(col));
+  EXPECT_NE(data, col.get());
+  EXPECT_EQ(2, held->Size());
+  EXPECT_EQ(3, col->Size());
+
+  auto ints = ToArrow(std::vector<Int64Value>{1, 2}, arrow::default_memory_pool());
+  auto int_col = ColumnWrapper::FromArrow(ints, std::move(col));
+  EXPECT_EQ(DataType::INT64, int_col->data_type());
+  EXPECT_EQ(2, int_col->Get<Int64Value>(1).val);
+}
+
 }  // namespace types
 }  // namespace px
@@ -22,8 +22,10 @@
 #include <vector>
 #include "src/common/benchmark/benchmark.h"
 #include "src/datagen/datagen.h"
+#include "src/shared/types/column_wrapper.h"
 #include "src/shared/types/types.h"
 
+using px::types::ColumnWrapper;
 using px::types::Int64Value;
 
 // This is just a dummy function that does some work so we can use it in the benchmark.
@@ -65,3 +67,30 @@ static void BM_Int64Vector(benchmark::State& state) {  // NOLINT
 
 BENCHMARK_TEMPLATE(BM_Int64Vector, int64_t)->Arg(10000);
 BENCHMARK_TEMPLATE(BM_Int64Vector, Int64Value)->Arg(10000);
+
+// Converts a column the way hot table store batches used to be converted, copying every value.
+static void BM_ConvertToArrowInt64(benchmark::State& state) {  // NOLINT
+  auto col = ColumnWrapper::Make(px::types::DataType::INT64, 0);
+  col->AppendFromVector(px::datagen::CreateLargeData<Int64Value>(state.range(0), 1, 52));
+
+  for (auto _ : state) {
+    auto arr = col->ConvertToArrow(arrow::default_memory_pool());
+    benchmark::DoNotOptimize(arr);
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * col->Bytes());
+}
+
+// Converts a column the way hot table store batches are converted now, sharing the values.
+static void BM_ShareAsArrowInt64(benchmark::State& state) {  // NOLINT
+  auto col = ColumnWrapper::Make(px::types::DataType::INT64, 0);
+  col->AppendFromVector(px::datagen::CreateLargeData<Int64Value>(state.range(0), 1, 52));
+
+  for (auto _ : state) {
+    auto arr = ColumnWrapper::ShareAsArrow(col, arrow::default_memory_pool());
+    benchmark::DoNotOptimize(arr);
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * col->Bytes());
+}
+
+BENCHMARK(BM_ConvertToArrowInt64)->RangeMultiplier(4)->Range(1 << 8, 1 << 16);
+BENCHMARK(BM_ShareAsArrowInt64)->RangeMultiplier(4)->Range(1 << 8, 1 << 16);
@@ -16,14 +16,19 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
 #include <benchmark/benchmark.h>
+#include <map>
 #include <random>
+#include <vector>
 
 #include "src/common/benchmark/benchmark.h"
 #include "src/shared/upid/upid.h"
+#include "src/shared/upid/upid_dictionary.h"
 
 using ::px::md::UPID;
+using ::px::md::UPIDDictionary;
 
 template <typename UpidSetType>
 static void BM_set_insertion(benchmark::State& state) {  // NOLINT
@@ -37,3 +42,52 @@ static void BM_set_insertion(benchmark::State& state) {  // NOLINT
 
 BENCHMARK_TEMPLATE(BM_set_insertion, std::set<UPID>)->DenseRange(100, 1000, 100);
 BENCHMARK_TEMPLATE(BM_set_insertion, absl::flat_hash_set<UPID>)->DenseRange(100, 1000, 100);
+
+// A stream of records from state.range(0) distinct processes, as seen by a metadata UDF or a
+// group by on UPID.
+static std::vector<UPID> RandomUPIDStream(int64_t num_upids) {
+  std::mt19937 rng(37);
+  std::uniform_int_distribution<uint32_t> pid_dist(0, num_upids - 1);
+  std::vector<UPID> upids;
+  for (int i = 0; i < 4096; ++i) {
+    uint32_t pid = pid_dist(rng);
+    upids.emplace_back(1, pid, 1000 + pid);
+  }
+  return upids;
+}
+
+template <typename UpidMapType>
+static void BM_map_lookup(benchmark::State& state) {  // NOLINT
+  auto upids = RandomUPIDStream(state.range(0));
+  UpidMapType upid_map;
+  for (const auto& upid : upids) {
+    upid_map.try_emplace(upid, upid_map.size());
+  }
+  for (auto _ : state) {
+    int64_t sum = 0;
+    for (const auto& upid : upids) {
+      sum += upid_map.find(upid)->second;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * upids.size());
+}
+
+static void BM_dictionary_get_or_insert(benchmark::State& state) {  // NOLINT
+  auto upids = RandomUPIDStream(state.range(0));
+  UPIDDictionary dict;
+  for (auto _ : state) {
+    int64_t sum = 0;
+    for (const auto& upid : upids) {
+      sum += dict.GetOrInsert(upid);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * upids.size());
+}
+
+BENCHMARK_TEMPLATE(BM_map_lookup, std::map<UPID, int64_t>)->RangeMultiplier(10)->Range(10, 1000);
+BENCHMARK_TEMPLATE(BM_map_lookup, absl::flat_hash_map<UPID, int64_t>)
+    ->RangeMultiplier(10)
+    ->Range(10, 1000);
+BENCHMARK(BM_dictionary_get_or_insert)->RangeMultiplier(10)->Range(10, 1000);
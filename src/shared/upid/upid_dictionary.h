@@ -0,0 +1,78 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/numeric/int128.h>
+
+#include "src/shared/upid/upid.h"
+
+namespace px {
+namespace md {
+
+/**
+ * Assigns dense int32 IDs to UPIDs, in the order they are first seen. Per UPID state can then be
+ * kept in vectors indexed by ID, which is cheaper than maps keyed by the 128-bit UPID when the same
+ * few UPIDs repeat over many records.
+ *
+ * The dictionary only grows until Clear(), so owners that see an unbounded stream of UPIDs should
+ * clear it once size() gets too large.
+ */
+class UPIDDictionary {
+ public:
+  static constexpr int32_t kNotFound = -1;
+
+  /**
+   * Returns the ID of the UPID, assigning it the next ID if it wasn't seen before.
+   */
+  int32_t GetOrInsert(absl::uint128 upid) {
+    auto [it, inserted] = ids_.try_emplace(upid, static_cast<int32_t>(upids_.size()));
+    if (inserted) {
+      upids_.push_back(upid);
+    }
+    return it->second;
+  }
+  int32_t GetOrInsert(const UPID& upid) { return GetOrInsert(upid.value()); }
+
+  /**
+   * Returns the ID of the UPID, or kNotFound.
+   */
+  int32_t Find(absl::uint128 upid) const {
+    auto it = ids_.find(upid);
+    return it == ids_.end() ? kNotFound : it->second;
+  }
+  int32_t Find(const UPID& upid) const { return Find(upid.value()); }
+
+  UPID upid(int32_t id) const { return UPID(upids_[id]); }
+  size_t size() const { return upids_.size(); }
+
+  void Clear() {
+    ids_.clear();
+    upids_.clear();
+  }
+
+ private:
+  absl::flat_hash_map<absl::uint128, int32_t> ids_;
+  std::vector<absl::uint128> upids_;
+};
+
+}  // namespace md
+}  // namespace px
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include "src/shared/upid/upid_dictionary.h"
+
+namespace px {
+namespace md {
+
+TEST(UPIDDictionary, assigns_dense_ids) {
+  UPIDDictionary dict;
+  EXPECT_EQ(UPIDDictionary::kNotFound, dict.Find(UPID(1, 2, 3)));
+
+  EXPECT_EQ(0, dict.GetOrInsert(UPID(1, 2, 3)));
+  EXPECT_EQ(1, dict.GetOrInsert(UPID(1, 3, 3)));
+  EXPECT_EQ(0, dict.GetOrInsert(UPID(1, 2, 3)));
+  EXPECT_EQ(2, dict.GetOrInsert(UPID(2, 2, 3).value()));
+  EXPECT_EQ(3, dict.size());
+
+  EXPECT_EQ(1, dict.Find(UPID(1, 3, 3)));
+  EXPECT_EQ(2, dict.Find(UPID(2, 2, 3).value()));
+  EXPECT_EQ(UPID(1, 3, 3), dict.upid(1));
+}
+
+TEST(UPIDDictionary, clear) {
+  UPIDDictionary dict;
+  dict.GetOrInsert(UPID(1, 2, 3));
+  dict.GetOrInsert(UPID(1, 3, 3));
+  dict.Clear();
+  EXPECT_EQ(0, dict.size());
+  EXPECT_EQ(UPIDDictionary::kNotFound, dict.Find(UPID(1, 2, 3)));
+  EXPECT_EQ(0, dict.GetOrInsert(UPID(1, 3, 3)));
+}
+
+}  // namespace md
+}  // namespace px
@@ -278,7 +278,30 @@ int map_populate_uprobe(struct pt_regs* ctx) {
   }
 }
 
+// Reads a map with as many entries as the benchmark argument, with or without batched operations.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_get_table_offline(benchmark::State& state, bool batched) {
+  FLAGS_stirling_bpf_map_batch_ops = batched;
+  const int num_entries = state.range(0);
+
+  BCCWrapperImpl bcc_wrapper;
+  std::string_view kProgram = "BPF_HASH(map, int, int, kMaxEntries);";
+  PX_CHECK_OK(
+      bcc_wrapper.InitBPFProgram(kProgram, {absl::Substitute("-DkMaxEntries=$0", num_entries)}));
+  auto bpf_map = WrappedBCCMap<int, int>::Create(&bcc_wrapper, "map");
+  for (int i = 0; i < num_entries; ++i) {
+    PX_CHECK_OK(bpf_map->SetValue(i, 2 * i + 1));
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bpf_map->GetTableOffline());
+  }
+  state.SetItemsProcessed(state.iterations() * num_entries);
+}
+
 BENCHMARK(BM_userspace_update_remove);
 BENCHMARK(BM_bpf_triggered_update_remove);
 BENCHMARK(BM_userspace_update_get_remove);
 BENCHMARK(BM_bpf_triggered_update_get_remove);
+BENCHMARK_CAPTURE(BM_get_table_offline, unbatched, /*batched*/ false)->Range(1 << 10, 1 << 17);
+BENCHMARK_CAPTURE(BM_get_table_offline, batched, /*batched*/ true)->Range(1 << 10, 1 << 17);
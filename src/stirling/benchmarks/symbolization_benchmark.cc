@@ -88,6 +88,12 @@ std::vector<uintptr_t> CollectStackTrace(BCCWrapperImpl* bcc_wrapper,
   return stack_traces_table->GetStackAddr(val.stack_trace_id, /* clear_stack_id */ false);
 }
 
+// NOLINTNEXTLINE : runtime/references.
+void SetLookupsCounter(benchmark::State& state, size_t num_addrs) {
+  state.counters["lookups_per_sec"] =
+      benchmark::Counter(state.iterations() * num_addrs, benchmark::Counter::kIsRate);
+}
+
 // NOLINTNEXTLINE : runtime/references.
 static void BM_elf_reader_symbolization(benchmark::State& state) {
   BCCWrapperImpl bcc_wrapper;
@@ -108,6 +114,7 @@ static void BM_elf_reader_symbolization(benchmark::State& state) {
     }
     benchmark::DoNotOptimize(symbols);
   }
+  SetLookupsCounter(state, addrs.size());
 }
 
 // NOLINTNEXTLINE : runtime/references.
@@ -130,6 +137,10 @@ static void BM_elf_reader_symbolization_indexed(benchmark::State& state) {
     }
     benchmark::DoNotOptimize(symbols);
   }
+  SetLookupsCounter(state, addrs.size());
+  // The cost of the index, per binary.
+  state.counters["num_symbols"] = symbolizer->size();
+  state.counters["index_bytes"] = symbolizer->MemoryUsage();
 }
 
 // NOLINTNEXTLINE : runtime/references.
@@ -148,6 +159,7 @@ static void BM_bcc_symbolization(benchmark::State& state) {
     }
     benchmark::DoNotOptimize(symbols);
   }
+  SetLookupsCounter(state, addrs.size());
 }
 
 BENCHMARK(BM_bcc_symbolization);
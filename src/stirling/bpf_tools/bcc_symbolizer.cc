@@ -32,6 +32,7 @@ BCCSymbolizer::BCCSymbolizer()
                                   .use_symbol_type = ((1 << STT_FUNC) | (1 << STT_GNU_IFUNC))}) {}
 
 void* BCCSymbolizer::GetBCCSymbolCache(const int pid) {
+  absl::MutexLock lock(&symbol_caches_lock_);
   const auto [iter, inserted] = bcc_symbol_caches_by_pid_.try_emplace(pid, nullptr);
 
   if (inserted) {
@@ -43,23 +44,27 @@ void* BCCSymbolizer::GetBCCSymbolCache(const int pid) {
 std::string_view BCCSymbolizer::SymbolOrAddrIfUnknown(const int pid, const uintptr_t addr) {
   DCHECK(pid >= 0 || pid == -1);
 
+  // Information about the symbol found for the address. It may have a completely resolved symbol,
+  // just the module (i.e. memory region found from /proc/<pid>/maps), or neither of those.
+  bcc_symbol bcc_symbol_struct = {};
+
   void* bcc_symbol_cache = GetBCCSymbolCache(pid);
-  const bool resolved = 0 == bcc_symcache_resolve(bcc_symbol_cache, addr, &bcc_symbol_struct_);
+  const bool resolved = 0 == bcc_symcache_resolve(bcc_symbol_cache, addr, &bcc_symbol_struct);
 
   if (resolved) {
     // Symbol was resolved. Our work is done here.
-    symbol_ = bcc_symbol_struct_.demangle_name;
-    bcc_symbol_free_demangle_name(&bcc_symbol_struct_);
+    symbol_ = bcc_symbol_struct.demangle_name;
+    bcc_symbol_free_demangle_name(&bcc_symbol_struct);
 
     return symbol_;
   }
 
-  if (bcc_symbol_struct_.module != nullptr && strlen(bcc_symbol_struct_.module) > 0) {
+  if (bcc_symbol_struct.module != nullptr && strlen(bcc_symbol_struct.module) > 0) {
     // Module is known (from /proc/<pid>/maps), but symbol is not known.
     // We will create a string like this:
     // [m] /lib/ld-musl-x86_64.so.1 + 0x0000abcd
     // This is better than nothing, but not as nice as a symbol.
-    FormatModuleName(bcc_symbol_struct_.module, bcc_symbol_struct_.offset);
+    FormatModuleName(bcc_symbol_struct.module, bcc_symbol_struct.offset);
     return symbol_;
   }
 
@@ -71,6 +76,7 @@ std::string_view BCCSymbolizer::SymbolOrAddrIfUnknown(const int pid, const uintp
 }
 
 void BCCSymbolizer::ReleasePIDSymCache(uint32_t pid) {
+  absl::MutexLock lock(&symbol_caches_lock_);
   auto iter = bcc_symbol_caches_by_pid_.find(pid);
   if (iter != bcc_symbol_caches_by_pid_.end()) {
     bcc_free_symcache(iter->second, pid);
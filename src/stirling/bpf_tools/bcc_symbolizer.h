@@ -22,6 +22,7 @@
 
 #include <absl/container/flat_hash_map.h>
 #include <absl/strings/str_format.h>
+#include <absl/synchronization/mutex.h>
 
 // Including bcc/BPF.h creates some conflicts with our own code.
 #ifdef DECLARE_ERROR
@@ -48,6 +49,8 @@ class BCCSymbolizer {
 
   /**
    * Like Symbol(), but if the symbol is not resolved, returns a string of the address.
+   * May be called concurrently for different PIDs. The returned string_view is valid until the
+   * next call on the same thread.
    */
   std::string_view SymbolOrAddrIfUnknown(int pid, uintptr_t addr);
 
@@ -61,7 +64,7 @@ class BCCSymbolizer {
   /**
    * FormatModuleName(): populates symbol_ when the memory region is known, but symbol is not.
    */
-  void FormatModuleName(char const* const module, const uintptr_t offset) {
+  static void FormatModuleName(char const* const module, const uintptr_t offset) {
     symbol_ = absl::StrFormat("[m] %s + 0x%08llx", module, offset);
   }
 
@@ -69,7 +72,7 @@ class BCCSymbolizer {
    * FormatAddress(): populates symbol_ with a stringified addr. (64b hex).
    * used when no memory region or symbol known is known.
    */
-  void FormatAddress(const uintptr_t addr) { symbol_ = absl::StrFormat("0x%016llx", addr); }
+  static void FormatAddress(const uintptr_t addr) { symbol_ = absl::StrFormat("0x%016llx", addr); }
 
   /**
    * GetBCCSymbolCache() returns a pointer to a BCC symbol cache. Use of void* is inherited
@@ -84,26 +87,21 @@ class BCCSymbolizer {
    */
   bcc_symbol_option bcc_symbolization_options_;
 
+  absl::Mutex symbol_caches_lock_;
+
   /**
    * bcc_symbol_caches_by_pid_ maps from pid to BCC symbol cache. Use of void* is inherited
    * from the BCC library.
    */
-  absl::flat_hash_map<int, void*> bcc_symbol_caches_by_pid_;
-
-  /**
-   * bcc_symbol_struct_ contains information about the symbol found for a given virtual address.
-   * It may have a completely resolved symbol, just the module (i.e. memory region found from
-   * /proc/<pid>/maps), or neither of those. bcc_symbol_struct_ is populated when we call the
-   * bcc_symcache_resolve() method from the BCC library.
-   */
-  bcc_symbol bcc_symbol_struct_;
+  absl::flat_hash_map<int, void*> bcc_symbol_caches_by_pid_ ABSL_GUARDED_BY(symbol_caches_lock_);
 
   /**
    * symbol_ allocates a std::string where we populate the result
    * of calling BCCSymbolizer::SymbolOrAddrIfUnknown(), i.e. storage for the result of invoking
-   * the main public API of this class.
+   * the main public API of this class. It is per thread, so that different PIDs can be
+   * symbolized concurrently.
    */
-  std::string symbol_;
+  inline static thread_local std::string symbol_;
 };
 
 }  // namespace bpf_tools
@@ -21,9 +21,15 @@
 #include <linux/perf_event.h>
 #include <sys/mount.h>
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_split.h>
 #include <magic_enum.hpp>
 
 #include "src/common/base/base.h"
@@ -33,6 +39,7 @@
 #include "src/common/system/kernel_version.h"
 #include "src/stirling/bpf_tools/rr/rr.h"
 #include "src/stirling/bpf_tools/task_struct_resolver.h"
+#include "src/stirling/utils/kernel_cache.h"
 #include "src/stirling/utils/linux_headers.h"
 
 namespace px {
@@ -91,9 +98,32 @@ StatusOr<utils::TaskStructOffsets> BCCWrapper::ComputeTaskStructOffsets() {
     return task_struct_offsets_opt_.value();
   }
 
+  // The offsets only depend on the kernel build, so they are kept in the kernel cache, if enabled.
+  constexpr std::string_view kCacheFile = "task_struct_offsets";
+  StatusOr<std::string> cached = utils::ReadKernelCacheFile(kCacheFile);
+  if (cached.ok()) {
+    utils::TaskStructOffsets offsets;
+    std::vector<std::string_view> fields = absl::StrSplit(cached.ValueOrDie(), ' ');
+    if (fields.size() == 3 && absl::SimpleAtoi(fields[0], &offsets.real_start_time_offset) &&
+        absl::SimpleAtoi(fields[1], &offsets.group_leader_offset) &&
+        absl::SimpleAtoi(fields[2], &offsets.exit_code_offset)) {
+      LOG(INFO) << absl::Substitute("Using cached task_struct offsets: $0", offsets.ToString());
+      task_struct_offsets_opt_ = offsets;
+      return offsets;
+    }
+    LOG(WARNING) << absl::Substitute("Ignoring malformed cached task_struct offsets: $0",
+                                     cached.ValueOrDie());
+  }
+
   LOG(INFO) << "Resolving task_struct offsets.";
   PX_ASSIGN_OR_RETURN(task_struct_offsets_opt_, ResolveTaskStructOffsetsWithRetry());
 
+  const utils::TaskStructOffsets& offsets = task_struct_offsets_opt_.value();
+  Status s = utils::WriteKernelCacheFile(
+      kCacheFile, absl::Substitute("$0 $1 $2", offsets.real_start_time_offset,
+                                   offsets.group_leader_offset, offsets.exit_code_offset));
+  VLOG_IF(1, !s.ok()) << absl::Substitute("Did not cache task_struct offsets: $0", s.msg());
+
   LOG(INFO) << absl::Substitute("Successfully resolved task_struct offsets: $0",
                                 task_struct_offsets_opt_.value().ToString());
   return task_struct_offsets_opt_.value();
@@ -223,19 +253,38 @@ Status BCCWrapperImpl::AttachUProbe(const UProbeSpec& probe) {
   return Status::OK();
 }
 
-Status BCCWrapperImpl::AttachSamplingProbe(const SamplingProbeSpec& probe) {
+namespace {
+
+PerfEventSpec SamplingProbePerfEvent(const SamplingProbeSpec& probe) {
   constexpr uint64_t kNanosPerMilli = 1000 * 1000;
   const uint64_t sample_period = probe.period_millis * kNanosPerMilli;
   // A sampling probe is just a PerfEventProbe, where the perf event is a clock counter.
   // When a requisite number of clock samples occur, the kernel will trigger the BPF code.
   // By specifying a frequency, the kernel will attempt to adjust the threshold to achieve
   // the desired sampling frequency.
-  PerfEventSpec perf_event_spec{.type = PERF_TYPE_SOFTWARE,
-                                .config = PERF_COUNT_SW_CPU_CLOCK,
-                                .probe_fn = probe.probe_fn,
-                                .sample_period = sample_period};
+  return PerfEventSpec{.type = PERF_TYPE_SOFTWARE,
+                       .config = PERF_COUNT_SW_CPU_CLOCK,
+                       .probe_fn = probe.probe_fn,
+                       .sample_period = sample_period};
+}
+
+}  // namespace
 
-  return AttachPerfEvent(perf_event_spec);
+Status BCCWrapperImpl::AttachSamplingProbe(const SamplingProbeSpec& probe) {
+  return AttachPerfEvent(SamplingProbePerfEvent(probe));
+}
+
+Status BCCWrapperImpl::DetachSamplingProbe(const SamplingProbeSpec& probe) {
+  const PerfEventSpec perf_event = SamplingProbePerfEvent(probe);
+  PX_RETURN_IF_ERROR(DetachPerfEvent(perf_event));
+  // BCC identifies perf events by type and config, so that is what identifies the spec too.
+  perf_events_.erase(std::remove_if(perf_events_.begin(), perf_events_.end(),
+                                    [&perf_event](const PerfEventSpec& p) {
+                                      return p.type == perf_event.type &&
+                                             p.config == perf_event.config;
+                                    }),
+                     perf_events_.end());
+  return Status::OK();
 }
 
 Status BCCWrapperImpl::AttachKProbes(const ArrayView<KProbeSpec>& probes) {
@@ -342,6 +391,57 @@ void BCCWrapperImpl::DetachTracepoints() {
   tracepoints_.clear();
 }
 
+namespace {
+
+int RingBufferNumPages(const PerfBufferSpec& ring_buffer) {
+  const int page_size_bytes = system::Config::GetInstance().PageSizeBytes();
+  return IntRoundUpToPow2(IntRoundUpDivide(ring_buffer.size_bytes, page_size_bytes));
+}
+
+// Adapts the ring buffer callback to the perf buffer one of the spec.
+int HandleRingBufferEvent(void* ctx, void* data, size_t size) {
+  const auto* spec = static_cast<const PerfBufferSpec*>(ctx);
+  spec->probe_output_fn(spec->cb_cookie, data, static_cast<int>(size));
+  return 0;
+}
+
+}  // namespace
+
+bool KernelSupportsRingBuffers() {
+  const system::KernelVersion kRingBufferMinVersion = {5, 8, 0};
+  return system::GetCachedKernelVersion().code() >= kRingBufferMinVersion.code();
+}
+
+std::string RingBufferPagesDefine(const PerfBufferSpec& ring_buffer) {
+  return absl::StrCat("-DRINGBUF_PAGES_", ring_buffer.name, "=", RingBufferNumPages(ring_buffer));
+}
+
+Status BCCWrapperImpl::OpenRingBuffer(const PerfBufferSpec& ring_buffer) {
+  DCHECK(ring_buffer.cb_cookie != nullptr) << "ring_buffer.cb_cookie must be non-null.";
+  if (!KernelSupportsRingBuffers()) {
+    return error::FailedPrecondition("Ring buffer $0 requires kernel 5.8+, but running on $1.",
+                                     ring_buffer.name,
+                                     system::GetCachedKernelVersion().ToString());
+  }
+  VLOG(1) << absl::Substitute("Opening ring buffer: [$0] [allocated_num_pages=$1]",
+                              ring_buffer.ToString(), RingBufferNumPages(ring_buffer));
+  ring_buffer_specs_.push_back(ring_buffer);
+  const PerfBufferSpec* spec = &ring_buffer_specs_.back();
+  ebpf::StatusTuple s =
+      bpf_.open_ring_buffer(spec->name, &HandleRingBufferEvent, const_cast<PerfBufferSpec*>(spec));
+  if (!s.ok()) {
+    ring_buffer_specs_.pop_back();
+    return StatusAdapter(s);
+  }
+  ++num_open_perf_buffers_;
+  return Status::OK();
+}
+
+bool BCCWrapperImpl::IsRingBuffer(const std::string& name) const {
+  return std::any_of(ring_buffer_specs_.begin(), ring_buffer_specs_.end(),
+                     [&name](const PerfBufferSpec& spec) { return spec.name == name; });
+}
+
 int BCCWrapperImpl::CommonPerfBufferSetup(const PerfBufferSpec& perf_buffer_spec) {
   DCHECK(perf_buffer_spec.cb_cookie != nullptr) << "perf_buffer_spec.cb_cookie must be non-null.";
   DCHECK(perf_buffer_spec.size_bytes > 0) << "perf_buffer_spec.cb_cookie must greater than zero.";
@@ -361,6 +461,9 @@ int BCCWrapperImpl::CommonPerfBufferSetup(const PerfBufferSpec& perf_buffer_spec
 }
 
 Status BCCWrapperImpl::OpenPerfBuffer(const PerfBufferSpec& perf_buffer_spec) {
+  if (perf_buffer_spec.ring_buffer) {
+    return OpenRingBuffer(perf_buffer_spec);
+  }
   const int num_pages = CommonPerfBufferSetup(perf_buffer_spec);
 
   const std::string& name = perf_buffer_spec.name;
@@ -368,7 +471,8 @@ Status BCCWrapperImpl::OpenPerfBuffer(const PerfBufferSpec& perf_buffer_spec) {
   auto& data_fn = perf_buffer_spec.probe_output_fn;
   auto& loss_fn = perf_buffer_spec.probe_loss_fn;
 
-  PX_RETURN_IF_ERROR(bpf_.open_perf_buffer(name, data_fn, loss_fn, cb_cookie, num_pages));
+  PX_RETURN_IF_ERROR(bpf_.open_perf_buffer(name, data_fn, loss_fn, cb_cookie, num_pages,
+                                            perf_buffer_spec.wakeup_events));
 
   ++num_open_perf_buffers_;
   return Status::OK();
@@ -382,6 +486,14 @@ Status BCCWrapperImpl::OpenPerfBuffers(const ArrayView<PerfBufferSpec>& perf_buf
 }
 
 Status BCCWrapperImpl::ClosePerfBuffer(const PerfBufferSpec& perf_buffer) {
+  if (perf_buffer.ring_buffer) {
+    // BCC manages all ring buffers of a program as one, so they can only be closed together.
+    VLOG(1) << "Closing all ring buffers, for: " << perf_buffer.name;
+    PX_RETURN_IF_ERROR(bpf_.close_ring_buffer());
+    num_open_perf_buffers_ -= ring_buffer_specs_.size();
+    ring_buffer_specs_.clear();
+    return Status::OK();
+  }
   VLOG(1) << "Closing perf buffer: " << perf_buffer.name;
   PX_RETURN_IF_ERROR(bpf_.close_perf_buffer(std::string(perf_buffer.name)));
   --num_open_perf_buffers_;
@@ -394,6 +506,10 @@ void BCCWrapperImpl::ClosePerfBuffers() {
     LOG_IF(ERROR, !res.ok()) << res.msg();
   }
   perf_buffer_specs_.clear();
+  if (!ring_buffer_specs_.empty()) {
+    auto res = ClosePerfBuffer(ring_buffer_specs_.front());
+    LOG_IF(ERROR, !res.ok()) << res.msg();
+  }
 }
 
 Status BCCWrapperImpl::AttachPerfEvent(const PerfEventSpec& perf_event) {
@@ -439,6 +555,16 @@ std::string BCCWrapperImpl::GetKProbeTargetName(const KProbeSpec& probe) {
 }
 
 Status BCCWrapperImpl::PollPerfBuffer(const std::string& name, const int timeout_ms) {
+  if (IsRingBuffer(name)) {
+    // Consuming doesn't wait for the epoll notification, so events submitted with
+    // BPF_RB_NO_WAKEUP are read too.
+    if (timeout_ms > 0) {
+      bpf_.poll_ring_buffer(timeout_ms);
+    } else {
+      bpf_.consume_ring_buffer();
+    }
+    return Status::OK();
+  }
   auto perf_buffer = bpf_.get_perf_buffer(name);
   if (perf_buffer == nullptr) {
     return error::NotFound(absl::Substitute("Perf buffer \"$0\" not found.", name));
@@ -448,12 +574,48 @@ Status BCCWrapperImpl::PollPerfBuffer(const std::string& name, const int timeout
 }
 
 void BCCWrapperImpl::PollPerfBuffers(const int timeout_ms) {
+  auto poll_high_priority = [this]() {
+    for (const auto& spec : perf_buffer_specs_) {
+      if (spec.high_priority) {
+        const auto s = PollPerfBuffer(spec.name);
+        LOG_IF(ERROR, !s.ok()) << s.msg();
+      }
+    }
+  };
+
+  poll_high_priority();
   for (const auto& spec : perf_buffer_specs_) {
+    if (spec.high_priority) {
+      continue;
+    }
     const auto s = PollPerfBuffer(spec.name, timeout_ms);
     LOG_IF(ERROR, !s.ok()) << s.msg();
+    // Whatever arrived on the high priority buffers while this one was drained goes next, instead
+    // of waiting for the remaining buffers.
+    poll_high_priority();
+  }
+  if (!ring_buffer_specs_.empty()) {
+    const auto s = PollPerfBuffer(ring_buffer_specs_.front().name, timeout_ms);
+    LOG_IF(ERROR, !s.ok()) << s.msg();
   }
 }
 
+bool BCCWrapperImpl::WaitForPerfBuffers(const int timeout_ms) {
+  int num_events = 0;
+  if (!ring_buffer_specs_.empty()) {
+    num_events = bpf_.poll_ring_buffer(timeout_ms);
+  } else if (!perf_buffer_specs_.empty()) {
+    auto perf_buffer = bpf_.get_perf_buffer(perf_buffer_specs_.front().name);
+    if (perf_buffer != nullptr) {
+      num_events = perf_buffer->poll(timeout_ms);
+    }
+  } else {
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+  }
+  PollPerfBuffers();
+  return num_events > 0;
+}
+
 void BCCWrapperImpl::Close() {
   DetachPerfEvents();
   ClosePerfBuffers();
@@ -463,6 +625,10 @@ void BCCWrapperImpl::Close() {
 }
 
 Status RecordingBCCWrapperImpl::OpenPerfBuffer(const PerfBufferSpec& perf_buffer_spec) {
+  if (perf_buffer_spec.ring_buffer) {
+    return error::Unimplemented("Recording ring buffer $0 is not supported.",
+                                perf_buffer_spec.name);
+  }
   PerfBufferSpec pbs(perf_buffer_spec);
   pbs.recorder = recorder_.get();
 
@@ -473,7 +639,8 @@ Status RecordingBCCWrapperImpl::OpenPerfBuffer(const PerfBufferSpec& perf_buffer
   auto data_fn = &RecordPerfBufferEvent;
   auto loss_fn = &RecordPerfBufferLoss;
 
-  PX_RETURN_IF_ERROR(bpf_.open_perf_buffer(name, data_fn, loss_fn, cb_cookie, num_pages));
+  PX_RETURN_IF_ERROR(
+      bpf_.open_perf_buffer(name, data_fn, loss_fn, cb_cookie, num_pages, pbs.wakeup_events));
   ++num_open_perf_buffers_;
 
   return Status::OK();
@@ -35,6 +35,7 @@
 #include <absl/container/flat_hash_set.h>
 #include <gtest/gtest_prod.h>
 
+#include <deque>
 #include <filesystem>
 #include <map>
 #include <memory>
@@ -45,6 +46,7 @@
 
 #include "src/common/base/base.h"
 #include "src/common/json/json.h"
+#include "src/stirling/bpf_tools/bpf_map_batch.h"
 #include "src/stirling/bpf_tools/probe_specs/probe_specs.h"
 #include "src/stirling/bpf_tools/rr/rr.h"
 #include "src/stirling/bpf_tools/task_struct_resolver.h"
@@ -139,8 +141,17 @@ class BCCWrapper {
    */
   virtual Status AttachSamplingProbe(const SamplingProbeSpec& probe) = 0;
 
+  /**
+   * Detach a sampling probe that was attached with AttachSamplingProbe(), e.g. to attach it again
+   * with a different sampling period.
+   * @param probe Specifications of the probe.
+   * @return Error if probe fails to detach.
+   */
+  virtual Status DetachSamplingProbe(const SamplingProbeSpec& probe) = 0;
+
   /**
    * Open a perf buffer for reading events.
+   * If the spec is a ring buffer, all ring buffers are polled and closed together.
    * @param perf_buff Specifications of the perf buffer (name, callback function, etc.).
    * @return Error if perf buffer cannot be opened (e.g. perf buffer does not exist).
    */
@@ -215,7 +226,7 @@ class BCCWrapper {
                                       const uint64_t config) = 0;
 
   /**
-   * Drains a specific perf buffer.
+   * Drains a specific perf buffer. Draining a ring buffer drains all of the ring buffers.
    *
    * @param name The name of the perf buffer to drain.
    * @param timeout_ms If there's no event in the perf buffer, then timeout_ms specifies the
@@ -230,11 +241,24 @@ class BCCWrapper {
   /**
    * Drains all of the opened perf buffers, calling the handle function that was
    * specified in the PerfBufferSpec when OpenPerfBuffer was called.
+   * High priority perf buffers are drained first, and again after each of the other perf buffers.
    *
    * @param timeout_ms Pass through to PollPerfBuffer()
    */
   virtual void PollPerfBuffers(const int timeout_ms = 0) = 0;
 
+  /**
+   * Blocks until events are available, or until timeout_ms has passed, then drains all of the
+   * opened perf buffers like PollPerfBuffers().
+   *
+   * Ring buffers are all waited on together. BCC doesn't expose the file descriptors of perf
+   * buffers, so without ring buffers this waits only on the first opened perf buffer;
+   * callers should open their highest volume buffer first.
+   *
+   * @return true if the wait was woken up by events, false on timeout.
+   */
+  virtual bool WaitForPerfBuffers(const int timeout_ms) = 0;
+
   /**
    * Detaches all probes, and closes all perf buffers that are open.
    */
@@ -289,6 +313,7 @@ class BCCWrapperImpl : public BCCWrapper {
   Status AttachUProbe(const UProbeSpec& probe) override;
   Status AttachTracepoint(const TracepointSpec& probe) override;
   Status AttachSamplingProbe(const SamplingProbeSpec& probe) override;
+  Status DetachSamplingProbe(const SamplingProbeSpec& probe) override;
   Status OpenPerfBuffer(const PerfBufferSpec& perf_buffer) override;
   Status AttachPerfEvent(const PerfEventSpec& perf_event) override;
   Status AttachKProbes(const ArrayView<KProbeSpec>& probes) override;
@@ -305,6 +330,7 @@ class BCCWrapperImpl : public BCCWrapper {
   }
   void PollPerfBuffers(const int timeout_ms = 0) override;
   Status PollPerfBuffer(const std::string& name, const int timeout_ms = 0) override;
+  bool WaitForPerfBuffers(const int timeout_ms) override;
   void Close() override;
 
   Status ClosePerfBuffer(const PerfBufferSpec& perf_buffer) override;
@@ -325,6 +351,9 @@ class BCCWrapperImpl : public BCCWrapper {
   void ClosePerfBuffers();
   void DetachPerfEvents();
 
+  Status OpenRingBuffer(const PerfBufferSpec& ring_buffer);
+  bool IsRingBuffer(const std::string& name) const;
+
   // Returns the name that identifies the target to attach this k-probe.
   std::string GetKProbeTargetName(const KProbeSpec& probe);
 
@@ -333,6 +362,9 @@ class BCCWrapperImpl : public BCCWrapper {
   std::vector<TracepointSpec> tracepoints_;
   std::vector<PerfEventSpec> perf_events_;
 
+  // The ring buffer callbacks point to their spec, so the container must not move them.
+  std::deque<PerfBufferSpec> ring_buffer_specs_;
+
  protected:
   std::vector<PerfBufferSpec> perf_buffer_specs_;
 
@@ -395,6 +427,7 @@ class ReplayingBCCWrapperImpl : public BCCWrapper {
   Status AttachUProbe(const UProbeSpec&) override { return Status::OK(); }
   Status AttachTracepoint(const TracepointSpec&) override { return Status::OK(); }
   Status AttachSamplingProbe(const SamplingProbeSpec&) override { return Status::OK(); }
+  Status DetachSamplingProbe(const SamplingProbeSpec&) override { return Status::OK(); }
   Status AttachPerfEvent(const PerfEventSpec&) override { return Status::OK(); }
   Status AttachKProbes(const ArrayView<KProbeSpec>&) override { return Status::OK(); }
   Status AttachTracepoints(const ArrayView<TracepointSpec>&) override { return Status::OK(); }
@@ -436,6 +469,12 @@ class ReplayingBCCWrapperImpl : public BCCWrapper {
     }
   };
 
+  bool WaitForPerfBuffers(const int timeout_ms) override {
+    PX_UNUSED(timeout_ms);
+    PollPerfBuffers();
+    return true;
+  }
+
   void Close() override{};
 
   Status ClosePerfBuffer(const PerfBufferSpec&) override { return Status::OK(); }
@@ -451,6 +490,17 @@ class ReplayingBCCWrapperImpl : public BCCWrapper {
 
 std::unique_ptr<BCCWrapper> CreateBCC();
 
+/**
+ * Whether the kernel supports BPF ring buffers (5.8+).
+ */
+bool KernelSupportsRingBuffers();
+
+/**
+ * Returns the define that sizes a ring buffer in the probe code, which must declare it as
+ * BPF_RINGBUF_OUTPUT(<name>, RINGBUF_PAGES_<name>). The size is rounded up to a power of 2 pages.
+ */
+std::string RingBufferPagesDefine(const PerfBufferSpec& ring_buffer);
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Array Table.
@@ -553,12 +603,22 @@ class WrappedBCCMap {
   virtual std::vector<std::pair<K, V>> GetTableOffline(const bool clear_table = false) = 0;
 };
 
+// Exposes the fd of a BCC hash table, for the map operations that BCC doesn't wrap.
+template <typename K, typename V>
+class BPFHashTableWithFD : public ebpf::BPFHashTable<K, V> {
+ public:
+  explicit BPFHashTableWithFD(ebpf::BPFHashTable<K, V>&& table)
+      : ebpf::BPFHashTable<K, V>(std::move(table)) {}
+
+  int fd() const { return this->desc.fd; }
+};
+
 // Template parameter kUserSpaceManaged enables the "shadow keys" optimization.
 // Set to true iff the map is modified/updated from user space only.
 template <typename K, typename V, bool kUserSpaceManaged = false>
 class WrappedBCCMapImpl : public WrappedBCCMap<K, V, kUserSpaceManaged> {
  public:
-  using U = ebpf::BPFHashTable<K, V>;
+  using U = BPFHashTableWithFD<K, V>;
 
   size_t capacity() const override { return underlying_->capacity(); }
 
@@ -601,6 +661,16 @@ class WrappedBCCMapImpl : public WrappedBCCMap<K, V, kUserSpaceManaged> {
 
   std::vector<std::pair<K, V>> GetTableOffline(const bool clear_table = false) override {
     if constexpr (!kUserSpaceManaged) {
+      // Batched reads take a few syscalls for the whole map, instead of a few per entry.
+      if (FLAGS_stirling_bpf_map_batch_ops && batch_ops_supported_) {
+        auto r = BPFMapLookupAll<K, V>(underlying_->fd(), clear_table);
+        if (r.ok()) {
+          return r.ConsumeValueOrDie();
+        }
+        VLOG(1) << absl::Substitute("Falling back to unbatched reads of map $0: $1", name_,
+                                    r.msg());
+        batch_ops_supported_ = false;
+      }
       return underlying_->get_table_offline(clear_table);
     }
 
@@ -634,6 +704,8 @@ class WrappedBCCMapImpl : public WrappedBCCMap<K, V, kUserSpaceManaged> {
   char const* const err_msg_ = "BPF failed to $0 value for map: $1. $2.";
   std::unique_ptr<U> underlying_;
   absl::flat_hash_set<K> shadow_keys_;
+  // Cleared on the first failure of a batched operation, e.g. on kernels older than 5.6.
+  bool batch_ops_supported_ = true;
 };
 
 template <typename K, typename V, bool kUserSpaceManaged = false>
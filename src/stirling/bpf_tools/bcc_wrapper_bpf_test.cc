@@ -201,6 +201,34 @@ TEST(BCCWrapperTest, TestMapClearingAPIs) {
   ASSERT_THAT(alphabet->GetTableOffline(), IsEmpty());
 }
 
+// Tests that batched and unbatched reads of a map agree, with more entries than a batch holds.
+TEST(BCCWrapperTest, GetTableOfflineBatched) {
+  bpf_tools::BCCWrapperImpl bcc_wrapper;
+  std::string_view kProgram = "BPF_HASH(squares, uint32_t, uint64_t, 4096);";
+  ASSERT_OK(bcc_wrapper.InitBPFProgram(kProgram));
+  auto squares = WrappedBCCMap<uint32_t, uint64_t>::Create(&bcc_wrapper, "squares");
+
+  constexpr uint32_t kNumEntries = 3000;
+  for (uint32_t i = 0; i < kNumEntries; ++i) {
+    ASSERT_OK(squares->SetValue(i, i * i));
+  }
+
+  std::vector<std::pair<uint32_t, uint64_t>> unbatched;
+  {
+    PX_SET_FOR_SCOPE(FLAGS_stirling_bpf_map_batch_ops, false);
+    unbatched = squares->GetTableOffline();
+  }
+  ASSERT_EQ(unbatched.size(), kNumEntries);
+
+  using ::testing::IsEmpty;
+  using ::testing::UnorderedElementsAreArray;
+
+  EXPECT_THAT(squares->GetTableOffline(), UnorderedElementsAreArray(unbatched));
+  constexpr bool kClearTable = true;
+  EXPECT_THAT(squares->GetTableOffline(kClearTable), UnorderedElementsAreArray(unbatched));
+  EXPECT_THAT(squares->GetTableOffline(), IsEmpty());
+}
+
 // Tests that BCCWrapperImpl can load and attach UPD filter defined in the XDP program.
 TEST(BCCWrapperTest, LoadUPDFilterWithXDP) {
   bpf_tools::BCCWrapperImpl bcc_wrapper;
@@ -238,6 +266,98 @@ TEST(BCCWrapperTest, LoadUPDFilterWithXDP) {
   ASSERT_OK(bcc_wrapper.AttachXDP("lo", "udpfilter"));
 }
 
+TEST(BCCWrapperTest, RingBuffer) {
+  if (!KernelSupportsRingBuffers()) {
+    GTEST_SKIP() << "Ring buffers require kernel 5.8+.";
+  }
+
+  std::string_view program = R"BCC(
+    BPF_RINGBUF_OUTPUT(events, RINGBUF_PAGES_events);
+    int on_trigger(struct pt_regs* ctx) {
+      uint32_t tgid = bpf_get_current_pid_tgid() >> 32;
+      events.ringbuf_output(&tgid, sizeof(tgid), 0);
+      return 0;
+    }
+  )BCC";
+
+  std::vector<uint32_t> tgids;
+  PerfBufferSpec ring_buffer_spec = {
+      .name = "events",
+      .probe_output_fn =
+          [](void* cb_cookie, void* data, int data_size) {
+            ASSERT_EQ(data_size, static_cast<int>(sizeof(uint32_t)));
+            static_cast<std::vector<uint32_t>*>(cb_cookie)->push_back(
+                *static_cast<uint32_t*>(data));
+          },
+      .probe_loss_fn = [](void*, uint64_t) {},
+      .cb_cookie = &tgids,
+      .size_bytes = 4096,
+      .ring_buffer = true,
+  };
+
+  BCCWrapperImpl bcc_wrapper;
+  ASSERT_OK(bcc_wrapper.InitBPFProgram(program, {RingBufferPagesDefine(ring_buffer_spec)}));
+  ASSERT_OK(bcc_wrapper.AttachUProbe({
+      .binary_path = "/proc/self/exe",
+      .symbol = "BCCWrapperTestProbeTrigger",
+      .probe_fn = "on_trigger",
+  }));
+  ASSERT_OK(bcc_wrapper.OpenPerfBuffer(ring_buffer_spec));
+  EXPECT_EQ(1, bcc_wrapper.num_open_perf_buffers());
+
+  for (int i = 0; i < 3; ++i) {
+    BCCWrapperTestProbeTrigger();
+  }
+  bcc_wrapper.PollPerfBuffers();
+  EXPECT_EQ(tgids, std::vector<uint32_t>(3, getpid()));
+
+  bcc_wrapper.Close();
+  EXPECT_EQ(0, bcc_wrapper.num_open_perf_buffers());
+}
+
+TEST(BCCWrapperTest, WaitForPerfBuffers) {
+  std::string_view program = R"BCC(
+    BPF_PERF_OUTPUT(events);
+    int on_trigger(struct pt_regs* ctx) {
+      uint32_t tgid = bpf_get_current_pid_tgid() >> 32;
+      events.perf_submit(ctx, &tgid, sizeof(tgid));
+      return 0;
+    }
+  )BCC";
+
+  std::vector<uint32_t> tgids;
+  PerfBufferSpec perf_buffer_spec = {
+      .name = "events",
+      .probe_output_fn =
+          [](void* cb_cookie, void* data, int /*data_size*/) {
+            static_cast<std::vector<uint32_t>*>(cb_cookie)->push_back(
+                *static_cast<uint32_t*>(data));
+          },
+      .probe_loss_fn = [](void*, uint64_t) {},
+      .cb_cookie = &tgids,
+      .size_bytes = 4096,
+  };
+
+  BCCWrapperImpl bcc_wrapper;
+  ASSERT_OK(bcc_wrapper.InitBPFProgram(program));
+  ASSERT_OK(bcc_wrapper.AttachUProbe({
+      .binary_path = "/proc/self/exe",
+      .symbol = "BCCWrapperTestProbeTrigger",
+      .probe_fn = "on_trigger",
+  }));
+  ASSERT_OK(bcc_wrapper.OpenPerfBuffer(perf_buffer_spec));
+
+  // Nothing to read: times out.
+  EXPECT_FALSE(bcc_wrapper.WaitForPerfBuffers(/*timeout_ms*/ 10));
+  EXPECT_TRUE(tgids.empty());
+
+  BCCWrapperTestProbeTrigger();
+  EXPECT_TRUE(bcc_wrapper.WaitForPerfBuffers(/*timeout_ms*/ 1000));
+  EXPECT_EQ(tgids, std::vector<uint32_t>(1, getpid()));
+
+  bcc_wrapper.Close();
+}
+
 TEST(BCCWrapper, Tracepoint) {
   bpf_tools::BCCWrapperImpl bcc_wrapper;
 
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/stirling/bpf_tools/bpf_map_batch.h"
+
+#include <bpf/bpf.h>
+
+#include <linux/bpf.h>
+
+#include <cstring>
+
+DEFINE_bool(stirling_bpf_map_batch_ops, gflags::BoolFromEnv("PL_BPF_MAP_BATCH_OPS", true),
+            "If true, BPF maps are read with batched operations when the kernel supports them.");
+
+namespace px {
+namespace stirling {
+namespace bpf_tools {
+
+StatusOr<bool> BPFMapLookupBatch(int fd, void* in_batch, void* out_batch, void* keys, void* values,
+                                 uint32_t* count, bool delete_entries) {
+  DECLARE_LIBBPF_OPTS(bpf_map_batch_opts, opts);
+  const int ret = delete_entries ? bpf_map_lookup_and_delete_batch(fd, in_batch, out_batch, keys,
+                                                                   values, count, &opts)
+                                 : bpf_map_lookup_batch(fd, in_batch, out_batch, keys, values,
+                                                        count, &opts);
+  if (ret == 0) {
+    return false;
+  }
+  // The kernel signals the end of the map with ENOENT, along with the last entries.
+  if (errno == ENOENT) {
+    return true;
+  }
+  return error::Internal("Batched $0 of BPF map failed: $1",
+                         delete_entries ? "lookup and delete" : "lookup", std::strerror(errno));
+}
+
+StatusOr<std::vector<std::pair<std::vector<uint8_t>, std::vector<uint8_t>>>> BPFMapLookupAllRaw(
+    int fd, bool delete_entries) {
+  constexpr uint32_t kBatchSize = 1024;
+
+  struct bpf_map_info info = {};
+  uint32_t info_len = sizeof(info);
+  if (bpf_obj_get_info_by_fd(fd, &info, &info_len) != 0) {
+    return error::Internal("Could not get info of BPF map: $0", std::strerror(errno));
+  }
+  switch (info.type) {
+    case BPF_MAP_TYPE_PERCPU_HASH:
+    case BPF_MAP_TYPE_PERCPU_ARRAY:
+    case BPF_MAP_TYPE_LRU_PERCPU_HASH:
+      return error::Unimplemented("Batched reads of per-CPU BPF maps are not supported.");
+    default:
+      break;
+  }
+  const size_t key_size = info.key_size;
+  const size_t value_size = info.value_size;
+
+  // The position is a bucket index for hash maps, and a key for array maps.
+  std::vector<uint8_t> in_batch(std::max(key_size, sizeof(uint64_t)));
+  std::vector<uint8_t> out_batch(in_batch.size());
+
+  std::vector<uint8_t> keys(kBatchSize * key_size);
+  std::vector<uint8_t> values(kBatchSize * value_size);
+  std::vector<std::pair<std::vector<uint8_t>, std::vector<uint8_t>>> r;
+
+  bool done = false;
+  while (!done) {
+    uint32_t count = kBatchSize;
+    StatusOr<bool> s = BPFMapLookupBatch(fd, r.empty() ? nullptr : in_batch.data(),
+                                         out_batch.data(), keys.data(), values.data(), &count,
+                                         delete_entries);
+    if (!s.ok()) {
+      if (r.empty()) {
+        return s.status();
+      }
+      LOG(WARNING) << absl::Substitute("Batched read of BPF map stopped early: $0", s.msg());
+      break;
+    }
+    done = s.ValueOrDie();
+    for (uint32_t i = 0; i < count; ++i) {
+      auto key_begin = keys.begin() + i * key_size;
+      auto value_begin = values.begin() + i * value_size;
+      r.emplace_back(std::vector<uint8_t>(key_begin, key_begin + key_size),
+                     std::vector<uint8_t>(value_begin, value_begin + value_size));
+    }
+    if (!done && count == 0) {
+      break;
+    }
+    in_batch = out_batch;
+  }
+  return r;
+}
+
+}  // namespace bpf_tools
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+DECLARE_bool(stirling_bpf_map_batch_ops);
+
+namespace px {
+namespace stirling {
+namespace bpf_tools {
+
+/**
+ * Reads up to *count entries of a BPF map in one syscall (BPF_MAP_LOOKUP_BATCH), starting from
+ * the position in in_batch (nullptr for the first call), and writes the position for the next
+ * call to out_batch. With delete_entries, the entries are also deleted from the map
+ * (BPF_MAP_LOOKUP_AND_DELETE_BATCH).
+ *
+ * @param count In: number of entries that keys and values can hold. Out: number of entries read.
+ * @return true once the end of the map is reached, or an error, e.g. if the kernel
+ *         doesn't support batched operations (before Linux 5.6) for this type of map.
+ */
+StatusOr<bool> BPFMapLookupBatch(int fd, void* in_batch, void* out_batch, void* keys, void* values,
+                                 uint32_t* count, bool delete_entries);
+
+/**
+ * Reads (and optionally deletes) all the entries of a BPF map with batched operations,
+ * instead of the two or three syscalls per entry that iterating over the keys takes.
+ *
+ * @return error if the first batch fails, in which case the map is left untouched.
+ *         A failure after that ends the read early, and the entries read so far are returned.
+ */
+template <typename K, typename V>
+StatusOr<std::vector<std::pair<K, V>>> BPFMapLookupAll(int fd, bool delete_entries) {
+  constexpr uint32_t kBatchSize = 1024;
+
+  // The position is a bucket index for hash maps, and a key for array maps.
+  using Position = std::array<uint64_t, (std::max(sizeof(K), sizeof(uint64_t)) + 7) / 8>;
+  Position in_batch = {};
+  Position out_batch = {};
+
+  std::vector<K> keys(kBatchSize);
+  std::vector<V> values(kBatchSize);
+  std::vector<std::pair<K, V>> r;
+
+  bool done = false;
+  while (!done) {
+    uint32_t count = kBatchSize;
+    StatusOr<bool> s = BPFMapLookupBatch(fd, r.empty() ? nullptr : in_batch.data(),
+                                         out_batch.data(), keys.data(), values.data(), &count,
+                                         delete_entries);
+    if (!s.ok()) {
+      if (r.empty()) {
+        return s.status();
+      }
+      LOG(WARNING) << absl::Substitute("Batched read of BPF map stopped early: $0", s.msg());
+      break;
+    }
+    done = s.ValueOrDie();
+    for (uint32_t i = 0; i < count; ++i) {
+      r.emplace_back(keys[i], values[i]);
+    }
+    // An empty first batch that isn't the end can't happen, but would restart from the beginning.
+    if (!done && count == 0) {
+      break;
+    }
+    in_batch = out_batch;
+  }
+  return r;
+}
+
+/**
+ * Like BPFMapLookupAll(), for maps whose key and value sizes are only known at runtime,
+ * e.g. the maps of bpftrace programs. The sizes are read from the kernel, and entries are returned
+ * as raw bytes.
+ *
+ * @return error if the map is per-CPU, in which case the values would need aggregating,
+ *         or if the first batch fails.
+ */
+StatusOr<std::vector<std::pair<std::vector<uint8_t>, std::vector<uint8_t>>>> BPFMapLookupAllRaw(
+    int fd, bool delete_entries);
+
+}  // namespace bpf_tools
+}  // namespace stirling
+}  // namespace px
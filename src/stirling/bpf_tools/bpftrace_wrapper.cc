@@ -31,14 +31,25 @@
 #include <driver.h>
 #include <tracepoint_format_parser.h>
 
+#include <algorithm>
+#include <cstring>
 #include <limits>
 #include <sstream>
 #include <utility>
 
+#include <absl/synchronization/mutex.h>
+
 #include "src/common/base/base.h"
+#include "src/common/base/lru_cache.h"
 #include "src/common/system/config.h"
+#include "src/stirling/bpf_tools/bpf_map_batch.h"
 #include "src/stirling/utils/linux_headers.h"
 
+DEFINE_uint32(stirling_bpftrace_compile_cache_size,
+              gflags::Uint32FromEnv("PL_BPFTRACE_COMPILE_CACHE_SIZE", 32),
+              "The number of compiled bpftrace scripts to keep, keyed by script and parameters. "
+              "0 disables the cache.");
+
 namespace px {
 namespace stirling {
 namespace bpf_tools {
@@ -134,6 +145,78 @@ std::vector<std::string> ClangCompileFlags(bool has_btf, std::vector<std::string
   return extra_flags;
 }
 
+namespace {
+
+// The outputs of compiling a bpftrace script, which is all that Deploy() needs.
+struct CompiledScript {
+  bpftrace::RequiredResources resources;
+  bpftrace::BpfBytecode bytecode;
+};
+
+// Caches compiled scripts across BPFTraceWrapper instances, so that deploying the same script again
+// skips the parsing and the LLVM compilation. The bytecode is specific to the running kernel,
+// which is fixed for the lifetime of the process.
+class CompiledScriptCache {
+ public:
+  static CompiledScriptCache& Get() {
+    static auto* cache = new CompiledScriptCache(FLAGS_stirling_bpftrace_compile_cache_size);
+    return *cache;
+  }
+
+  static std::string Key(std::string_view script, const std::vector<std::string>& params) {
+    // The separators are control characters, which appear in neither params nor scripts.
+    return absl::StrCat(absl::StrJoin(params, "\x1f"), "\x1e", script);
+  }
+
+  std::shared_ptr<const CompiledScript> Lookup(const std::string& key) {
+    absl::MutexLock lock(&mu_);
+    if (scripts_ == nullptr) {
+      return nullptr;
+    }
+    const std::shared_ptr<const CompiledScript>* script = scripts_->Get(key);
+    return script == nullptr ? nullptr : *script;
+  }
+
+  void Insert(const std::string& key, std::shared_ptr<const CompiledScript> script) {
+    absl::MutexLock lock(&mu_);
+    if (scripts_ != nullptr) {
+      scripts_->Put(key, std::move(script));
+    }
+  }
+
+ private:
+  explicit CompiledScriptCache(size_t capacity) {
+    if (capacity > 0) {
+      scripts_ =
+          std::make_unique<LRUCache<std::string, std::shared_ptr<const CompiledScript>>>(capacity);
+    }
+  }
+
+  absl::Mutex mu_;
+  std::unique_ptr<LRUCache<std::string, std::shared_ptr<const CompiledScript>>> scripts_
+      ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace
+
+Status BPFTraceWrapper::Compile(std::string_view script, const std::vector<std::string>& params) {
+  const std::string key = CompiledScriptCache::Key(script, params);
+
+  std::shared_ptr<const CompiledScript> compiled = CompiledScriptCache::Get().Lookup(key);
+  if (compiled != nullptr) {
+    bpftrace_.resources = compiled->resources;
+    bytecode_ = compiled->bytecode;
+    compiled_ = true;
+    return Status::OK();
+  }
+
+  PX_RETURN_IF_ERROR(CompileUncached(script, params));
+
+  CompiledScriptCache::Get().Insert(
+      key, std::make_shared<const CompiledScript>(CompiledScript{bpftrace_.resources, bytecode_}));
+  return Status::OK();
+}
+
 // Redirects stderr and collect the output to a string.
 class CerrRedirect {
  public:
@@ -148,7 +231,8 @@ class CerrRedirect {
 
 // This compile function is inspired from the bpftrace project's main.cpp.
 // Changes to bpftrace may need to be reflected back to this function on a bpftrace update.
-Status BPFTraceWrapper::Compile(std::string_view script, const std::vector<std::string>& params) {
+Status BPFTraceWrapper::CompileUncached(std::string_view script,
+                                        const std::vector<std::string>& params) {
   // Because BPFTrace uses global state (related to clear_struct_list()),
   // multiple simultaneous compiles may not be safe. For now, introduce a lock for safety.
   // TODO(oazizi): Update BPFTrace repo to avoid use of global state if possible.
@@ -311,7 +395,40 @@ std::string_view BPFTraceWrapper::OutputFmtStr() const {
   return std::string_view(fmt_str.c_str(), fmt_str.length());
 }
 
+StatusOr<bpftrace::BPFTraceMap> BPFTraceWrapper::GetBPFMapBatched(const std::string& name) {
+  auto map = bpftrace_.maps.Lookup(name);
+  if (!map.has_value()) {
+    return error::NotFound("BPFTrace map $0 not found.", name);
+  }
+
+  PX_ASSIGN_OR_RETURN(bpftrace::BPFTraceMap entries,
+                      BPFMapLookupAllRaw((*map)->mapfd_, /*delete_entries*/ false));
+
+  // Keys up to 8 bytes are integers, compared by value; little-endian bytes do not sort that way.
+  auto key_value = [](const std::vector<uint8_t>& key) {
+    uint64_t v = 0;
+    std::memcpy(&v, key.data(), std::min(key.size(), sizeof(v)));
+    return v;
+  };
+  std::sort(entries.begin(), entries.end(), [&key_value](const auto& a, const auto& b) {
+    if (a.first.size() <= sizeof(uint64_t)) {
+      return key_value(a.first) < key_value(b.first);
+    }
+    return a.first < b.first;
+  });
+  return entries;
+}
+
 bpftrace::BPFTraceMap BPFTraceWrapper::GetBPFMap(const std::string& name) {
+  if (FLAGS_stirling_bpf_map_batch_ops && !unbatched_maps_.contains(name)) {
+    StatusOr<bpftrace::BPFTraceMap> entries = GetBPFMapBatched(name);
+    if (entries.ok()) {
+      return entries.ConsumeValueOrDie();
+    }
+    VLOG(1) << absl::Substitute("Falling back to unbatched reads of BPFTrace map $0: $1", name,
+                                entries.msg());
+    unbatched_maps_.insert(name);
+  }
   return bpftrace_.get_map(name);
 }
 
@@ -26,6 +26,8 @@
 #include <string>
 #include <vector>
 
+#include <absl/container/flat_hash_set.h>
+
 #include "src/common/base/base.h"
 
 namespace px {
@@ -97,6 +99,7 @@ class BPFTraceWrapper {
 
   /**
    * Gets the specified map name, using BPFTrace name. Map name should include the '@' prefix.
+   * The entries are sorted by key. Maps are read with batched operations where supported.
    */
   bpftrace::BPFTraceMap GetBPFMap(const std::string& name);
 
@@ -108,6 +111,12 @@ class BPFTraceWrapper {
  private:
   Status Compile(std::string_view script, const std::vector<std::string>& params);
 
+  // Parses and compiles the script into bpftrace_.resources and bytecode_.
+  Status CompileUncached(std::string_view script, const std::vector<std::string>& params);
+
+  // Reads the map with batched operations, sorted by key like bpftrace's own map reads.
+  StatusOr<bpftrace::BPFTraceMap> GetBPFMapBatched(const std::string& name);
+
   // Checks the output for dynamic tracing:
   //  1) There must be at least one printf.
   //  2) If there is more than one printf, all printfs have a consistent format string.
@@ -124,6 +133,9 @@ class BPFTraceWrapper {
 
   bool compiled_ = false;
   bool printf_to_table_ = false;
+
+  // Maps on which a batched read failed, e.g. per-CPU maps, or on kernels older than 5.6.
+  absl::flat_hash_set<std::string> unbatched_maps_;
 };
 
 }  // namespace bpf_tools
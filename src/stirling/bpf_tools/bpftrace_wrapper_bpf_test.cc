@@ -46,6 +46,34 @@ TEST(BPFTracerWrapperTest, MapRead) {
   bpftrace_wrapper.Stop();
 }
 
+// The second wrapper reuses the compiled script of the first, and must deploy all the same.
+TEST(BPFTracerWrapperTest, CachedCompile) {
+  constexpr std::string_view kScript = R"(
+  interval:ms:100 {
+      @retval[3] = nsecs;
+      @retval[1] = nsecs;
+      @retval[2] = nsecs;
+      @retval[256] = nsecs;
+  }
+  )";
+
+  for (int i = 0; i < 2; ++i) {
+    BPFTraceWrapper bpftrace_wrapper;
+    ASSERT_OK(bpftrace_wrapper.CompileForMapOutput(kScript));
+    ASSERT_OK(bpftrace_wrapper.Deploy());
+    sleep(1);
+
+    bpftrace::BPFTraceMap entries = bpftrace_wrapper.GetBPFMap("@retval");
+    std::vector<int64_t> keys;
+    for (const auto& [key, value] : entries) {
+      keys.push_back(*reinterpret_cast<const int64_t*>(key.data()));
+    }
+    EXPECT_THAT(keys, ::testing::ElementsAre(1, 2, 3, 256));
+
+    bpftrace_wrapper.Stop();
+  }
+}
+
 TEST(BPFTracerWrapperTest, PerfBufferPoll) {
   constexpr std::string_view kScript = R"(
     interval:ms:100 {
@@ -185,9 +185,29 @@ struct PerfBufferSpec {
   // This will be populated and used only if the BPF recording BCC wrapper is used.
   BPFRecorder* recorder = nullptr;
 
+  // Whether this is a BPF ring buffer (BPF_RINGBUF_OUTPUT in the probe code) rather than a per-CPU
+  // perf buffer (BPF_PERF_OUTPUT). A ring buffer is shared by all CPUs, which keeps the events in
+  // order, and lets a burst on one CPU use the whole buffer. Requires kernel 5.8 or newer.
+  // For ring buffers, size_bytes is the total size, and the probe code sets it, see
+  // RingBufferPagesDefine(). The loss callback is not used.
+  bool ring_buffer = false;
+
+  // Number of events a CPU writes to a perf buffer before a blocked reader is woken up, see
+  // BCCWrapper::WaitForPerfBuffers(). Values above 1 batch the wakeups under load.
+  // Ignored for ring buffers, whose wakeups are controlled by the probe code.
+  int wakeup_events = 1;
+
+  // High priority perf buffers are drained before the others, and again after each of the others,
+  // so that a busy buffer can't hold back their events until the next drain.
+  // Ignored for ring buffers, which are all drained together.
+  bool high_priority = false;
+
   std::string ToString() const {
-    return absl::Substitute("name=$0 size_bytes=$1 size_category=$2", name, size_bytes,
-                            magic_enum::enum_name(size_category));
+    return absl::Substitute(
+        "name=$0 size_bytes=$1 size_category=$2 ring_buffer=$3 wakeup_events=$4 "
+        "high_priority=$5",
+        name, size_bytes, magic_enum::enum_name(size_category), ring_buffer, wakeup_events,
+        high_priority);
   }
 };
 
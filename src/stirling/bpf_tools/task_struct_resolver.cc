@@ -18,11 +18,13 @@
 
 #include "src/stirling/bpf_tools/task_struct_resolver.h"
 
+#include <bpf/btf.h>
 #include <linux/sched.h>
 #include <poll.h>
 #include <sys/wait.h>
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -39,6 +41,11 @@
 // Creates a string_view to the BPF code loaded into memory.
 OBJ_STRVIEW(bcc_script, task_struct_mem_read);
 
+DEFINE_bool(stirling_resolve_task_struct_offsets_with_btf,
+            gflags::BoolFromEnv("PL_RESOLVE_TASK_STRUCT_OFFSETS_WITH_BTF", true),
+            "If true, the task_struct offsets are read from the kernel's BTF when it is available, "
+            "instead of being inferred with BPF probes.");
+
 // A function which we will uprobe on, to trigger our BPF code.
 // The function itself is irrelevant, but it must not be optimized away.
 // We declare this with C linkage (extern "C") so it has a simple symbol name.
@@ -403,7 +410,82 @@ StatusOr<uint64_t> ResolveTaskStructExitCodeOffset() {
 
 }  // namespace
 
+namespace {
+
+// Returns the offset in bytes of the named member of a struct or union.
+// Members of anonymous structs and unions (e.g. the randomized layout section of task_struct)
+// are searched too, since they are accessed as if they were members of the outer type.
+std::optional<uint64_t> FindBTFMemberOffset(const struct btf* btf, const struct btf_type* type,
+                                            std::string_view member_name) {
+  const struct btf_member* member = btf_members(type);
+  for (int i = 0; i < btf_vlen(type); ++i, ++member) {
+    const uint64_t offset = btf_member_bit_offset(type, i) / 8;
+    const char* name = btf__name_by_offset(btf, member->name_off);
+    if (name != nullptr && name[0] != '\0') {
+      if (member_name == name) {
+        return offset;
+      }
+      continue;
+    }
+    const struct btf_type* member_type = btf__type_by_id(btf, member->type);
+    if (member_type == nullptr || !btf_is_composite(member_type)) {
+      continue;
+    }
+    std::optional<uint64_t> nested_offset = FindBTFMemberOffset(btf, member_type, member_name);
+    if (nested_offset.has_value()) {
+      return offset + nested_offset.value();
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+StatusOr<TaskStructOffsets> ResolveTaskStructOffsetsFromBTF(const std::filesystem::path& btf_path) {
+  std::unique_ptr<struct btf, decltype(&btf__free)> btf(btf__parse(btf_path.c_str(), nullptr),
+                                                        &btf__free);
+  if (btf == nullptr) {
+    return error::NotFound("Could not parse BTF at $0: $1", btf_path.string(),
+                           std::strerror(errno));
+  }
+
+  const int type_id = btf__find_by_name_kind(btf.get(), "task_struct", BTF_KIND_STRUCT);
+  if (type_id < 0) {
+    return error::NotFound("Could not find task_struct in BTF at $0.", btf_path.string());
+  }
+  const struct btf_type* task_struct = btf__type_by_id(btf.get(), type_id);
+
+  auto find_offset = [&](std::string_view name) -> StatusOr<uint64_t> {
+    std::optional<uint64_t> offset = FindBTFMemberOffset(btf.get(), task_struct, name);
+    if (!offset.has_value()) {
+      return error::NotFound("Could not find task_struct::$0 in BTF.", name);
+    }
+    return offset.value();
+  };
+
+  TaskStructOffsets res;
+  // Linux 5.5 renamed real_start_time to start_boottime.
+  auto start_time_offset = find_offset("start_boottime");
+  if (!start_time_offset.ok()) {
+    start_time_offset = find_offset("real_start_time");
+  }
+  PX_ASSIGN_OR_RETURN(res.real_start_time_offset, start_time_offset);
+  PX_ASSIGN_OR_RETURN(res.group_leader_offset, find_offset("group_leader"));
+  PX_ASSIGN_OR_RETURN(res.exit_code_offset, find_offset("exit_code"));
+  return res;
+}
+
 StatusOr<TaskStructOffsets> ResolveTaskStructOffsets() {
+  if (FLAGS_stirling_resolve_task_struct_offsets_with_btf) {
+    StatusOr<TaskStructOffsets> btf_offsets = ResolveTaskStructOffsetsFromBTF();
+    if (btf_offsets.ok()) {
+      return btf_offsets;
+    }
+    LOG(INFO) << absl::Substitute(
+        "Could not read task_struct offsets from BTF, inferring them with BPF instead: $0",
+        btf_offsets.msg());
+  }
+
   PX_ASSIGN_OR_RETURN(TaskStructOffsets res, ResolveTaskStructStartTimeOffsets());
   PX_ASSIGN_OR_RETURN(uint64_t exit_code_offset, ResolveTaskStructExitCodeOffset());
   res.exit_code_offset = exit_code_offset;
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <filesystem>
 #include <string>
 
 #include "src/common/base/base.h"
@@ -63,6 +64,15 @@ struct TaskStructOffsets {
  */
 StatusOr<TaskStructOffsets> ResolveTaskStructOffsets();
 
+/**
+ * Reads the task struct offsets from the type information (BTF) that the kernel exposes
+ * at /sys/kernel/btf/vmlinux, when built with CONFIG_DEBUG_INFO_BTF.
+ * BTF describes the exact layout of task_struct, so no BPF program needs to be compiled and run,
+ * which is what makes ResolveTaskStructOffsets() slow. The latter uses this method first.
+ */
+StatusOr<TaskStructOffsets> ResolveTaskStructOffsetsFromBTF(
+    const std::filesystem::path& btf_path = "/sys/kernel/btf/vmlinux");
+
 /**
  * The core logic for ResolveTaskStructOffsets.
  * This is exposed for testing purposes only.
@@ -18,6 +18,7 @@
 
 #include <gtest/gtest.h>
 
+#include <filesystem>
 #include <future>
 #include <thread>
 
@@ -63,6 +64,24 @@ TEST(ResolveTaskStructOffsets, AsSubProcess) {
   EXPECT_NE(offsets.exit_code_offset, 0);
 }
 
+// Tests that the offsets read from BTF agree with the ones inferred by probing task_struct.
+TEST(ResolveTaskStructOffsets, FromBTF) {
+  if (!std::filesystem::exists("/sys/kernel/btf/vmlinux")) {
+    GTEST_SKIP() << "Kernel does not expose BTF.";
+  }
+  ASSERT_OK_AND_ASSIGN(TaskStructOffsets btf_offsets, ResolveTaskStructOffsetsFromBTF());
+  ASSERT_OK_AND_ASSIGN(TaskStructOffsets offsets, ResolveTaskStructOffsetsCore());
+
+  EXPECT_EQ(btf_offsets.real_start_time_offset, offsets.real_start_time_offset);
+  EXPECT_EQ(btf_offsets.group_leader_offset, offsets.group_leader_offset);
+  EXPECT_NE(btf_offsets.exit_code_offset, 0);
+}
+
+// The parse error is surfaced, so that callers can fall back to probing.
+TEST(ResolveTaskStructOffsets, FromMissingBTF) {
+  EXPECT_NOT_OK(ResolveTaskStructOffsetsFromBTF("/does/not/exist/vmlinux"));
+}
+
 }  // namespace utils
 }  // namespace stirling
 }  // namespace px
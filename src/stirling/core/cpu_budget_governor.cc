@@ -0,0 +1,71 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/core/cpu_budget_governor.h"
+
+#include <algorithm>
+
+#include <magic_enum.hpp>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+
+CPUBudgetGovernor::CPUBudgetGovernor(double budget, int ncpus, std::chrono::milliseconds window)
+    : budget_(budget), ncpus_(ncpus), window_(window) {}
+
+void CPUBudgetGovernor::AddCPUTime(std::chrono::nanoseconds cpu_time) {
+  window_cpu_ns_.fetch_add(cpu_time.count(), std::memory_order_relaxed);
+}
+
+bool CPUBudgetGovernor::Update(const time_point now) {
+  if (window_start_ == time_point{}) {
+    window_start_ = now;
+    window_cpu_ns_ = 0;
+    return false;
+  }
+  const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - window_start_);
+  if (elapsed < window_) {
+    return false;
+  }
+
+  usage_ = static_cast<double>(window_cpu_ns_.exchange(0)) /
+           (static_cast<double>(elapsed.count()) * ncpus_);
+  window_start_ = now;
+
+  const auto prev_level = level();
+  auto level = magic_enum::enum_integer(prev_level);
+  if (usage_ > budget_) {
+    level = std::min(level + 1, magic_enum::enum_integer(DegradationLevel::kSlowProfiler));
+  } else if (usage_ < budget_ * kRecoveryFraction) {
+    level = std::max(level - 1, magic_enum::enum_integer(DegradationLevel::kNone));
+  }
+  level_ = static_cast<DegradationLevel>(level);
+
+  if (level_ == prev_level) {
+    return false;
+  }
+  LOG(INFO) << absl::Substitute("CPU usage $0% of budget $1%: degradation level $2 -> $3.",
+                                100 * usage_, 100 * budget_, magic_enum::enum_name(prev_level),
+                                magic_enum::enum_name(level()));
+  return true;
+}
+
+}  // namespace stirling
+}  // namespace px
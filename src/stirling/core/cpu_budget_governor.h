@@ -0,0 +1,90 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+namespace px {
+namespace stirling {
+
+/**
+ * What sources give up to stay within the CPU budget, in the order they give it up.
+ * Each level includes the ones before it.
+ */
+enum class DegradationLevel {
+  kNone,
+  // Only trace a sample of the connections.
+  kSampleConnections,
+  // Drop the request and response bodies of traced messages.
+  kDropBodies,
+  // Stop tracing low priority protocols.
+  kDisableLowPriorityProtocols,
+  // Take fewer profiler samples.
+  kSlowProfiler,
+};
+
+/**
+ * Keeps the CPU that Stirling spends in its sources within a budget, by raising the degradation
+ * level while over budget, and lowering it back once well under budget. The level moves by one
+ * step per window, so that the effect of a step is measured before taking the next one.
+ */
+class CPUBudgetGovernor {
+  using time_point = std::chrono::steady_clock::time_point;
+
+ public:
+  /**
+   * @param budget The CPU budget, as a fraction of the total CPU of the node.
+   * @param ncpus Number of CPUs of the node.
+   * @param window The period over which CPU usage is compared to the budget.
+   */
+  CPUBudgetGovernor(double budget, int ncpus, std::chrono::milliseconds window);
+
+  /**
+   * Accounts CPU time spent by Stirling. Thread-safe.
+   */
+  void AddCPUTime(std::chrono::nanoseconds cpu_time);
+
+  /**
+   * Updates the degradation level, if the current window has ended.
+   * @return true if the level changed.
+   */
+  bool Update(time_point now);
+
+  DegradationLevel level() const { return level_.load(std::memory_order_relaxed); }
+
+  // The CPU usage of the last complete window, as a fraction of the total CPU of the node.
+  double usage() const { return usage_; }
+
+  // Once over budget, the level only goes down when usage falls below this fraction of the budget.
+  static constexpr double kRecoveryFraction = 0.7;
+
+ private:
+  const double budget_;
+  const int ncpus_;
+  const std::chrono::milliseconds window_;
+
+  time_point window_start_ = {};
+  double usage_ = 0;
+  std::atomic<int64_t> window_cpu_ns_ = 0;
+  std::atomic<DegradationLevel> level_ = DegradationLevel::kNone;
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/core/cpu_budget_governor.h"
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+namespace px {
+namespace stirling {
+
+TEST(CPUBudgetGovernorTest, DegradesOverBudgetAndRecovers) {
+  // 5% of 2 cpus, i.e. 100ms of CPU per second.
+  CPUBudgetGovernor governor(0.05, 2, std::chrono::seconds{1});
+  auto now = std::chrono::steady_clock::time_point{} + std::chrono::hours{1};
+
+  EXPECT_FALSE(governor.Update(now));
+  EXPECT_EQ(governor.level(), DegradationLevel::kNone);
+
+  // Window not over yet.
+  governor.AddCPUTime(std::chrono::milliseconds{500});
+  now += std::chrono::milliseconds{500};
+  EXPECT_FALSE(governor.Update(now));
+  EXPECT_EQ(governor.level(), DegradationLevel::kNone);
+
+  // Over budget: one step per window.
+  now += std::chrono::milliseconds{500};
+  EXPECT_TRUE(governor.Update(now));
+  EXPECT_DOUBLE_EQ(governor.usage(), 0.25);
+  EXPECT_EQ(governor.level(), DegradationLevel::kSampleConnections);
+
+  governor.AddCPUTime(std::chrono::milliseconds{150});
+  now += std::chrono::seconds{1};
+  EXPECT_TRUE(governor.Update(now));
+  EXPECT_EQ(governor.level(), DegradationLevel::kDropBodies);
+
+  // Under budget, but not by enough to recover.
+  governor.AddCPUTime(std::chrono::milliseconds{90});
+  now += std::chrono::seconds{1};
+  EXPECT_FALSE(governor.Update(now));
+  EXPECT_EQ(governor.level(), DegradationLevel::kDropBodies);
+
+  // Well under budget: recovers one step per window.
+  governor.AddCPUTime(std::chrono::milliseconds{10});
+  now += std::chrono::seconds{1};
+  EXPECT_TRUE(governor.Update(now));
+  EXPECT_EQ(governor.level(), DegradationLevel::kSampleConnections);
+
+  now += std::chrono::seconds{1};
+  EXPECT_TRUE(governor.Update(now));
+  EXPECT_EQ(governor.level(), DegradationLevel::kNone);
+
+  now += std::chrono::seconds{1};
+  EXPECT_FALSE(governor.Update(now));
+  EXPECT_EQ(governor.level(), DegradationLevel::kNone);
+}
+
+TEST(CPUBudgetGovernorTest, LevelIsCapped) {
+  CPUBudgetGovernor governor(0.01, 1, std::chrono::seconds{1});
+  auto now = std::chrono::steady_clock::time_point{} + std::chrono::hours{1};
+  governor.Update(now);
+  for (int i = 0; i < 10; ++i) {
+    governor.AddCPUTime(std::chrono::milliseconds{500});
+    now += std::chrono::seconds{1};
+    governor.Update(now);
+  }
+  EXPECT_EQ(governor.level(), DegradationLevel::kSlowProfiler);
+}
+
+}  // namespace stirling
+}  // namespace px
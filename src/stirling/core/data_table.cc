@@ -21,40 +21,164 @@
 #include <utility>
 #include <vector>
 
+#include <arrow/builder.h>
+#include <arrow/memory_pool.h>
+
 #include "src/common/base/base.h"
 #include "src/shared/types/type_utils.h"
 #include "src/stirling/core/data_table.h"
 #include "src/stirling/core/types.h"
 #include "src/stirling/utils/index_sorted_vector.h"
 
+DEFINE_bool(stirling_data_table_arrow_buffers,
+            gflags::BoolFromEnv("PL_STIRLING_DATA_TABLE_ARROW_BUFFERS", false),
+            "If true, the records of untabletized tables are appended directly into Arrow "
+            "builders, so that in-order batches are pushed in the table store format without "
+            "a conversion.");
+
 namespace px {
 namespace stirling {
 
 using types::ColumnWrapper;
 using types::DataType;
 
-DataTable::DataTable(uint64_t id, const DataTableSchema& schema) : id_(id), table_schema_(schema) {}
+DataTable::DataTable(uint64_t id, const DataTableSchema& schema)
+    : id_(id), table_schema_(schema), unused_columns_(schema.elements().size(), false) {
+  // Tabletized tables are pushed through the DataPushCallback, which takes column wrappers.
+  if (FLAGS_stirling_data_table_arrow_buffers && !schema.tabletized()) {
+    arrow_pool_ = arrow::default_memory_pool();
+    arrow_data_capacity_.resize(schema.elements().size(), 0);
+  }
+}
+
+void DataTable::SetUnusedColumns(const std::vector<size_t>& unused_columns) {
+  consumer_unused_columns_ = unused_columns;
+  UpdateUnusedColumns();
+}
+
+void DataTable::SetDroppedColumns(const std::vector<size_t>& dropped_columns) {
+  dropped_columns_ = dropped_columns;
+  UpdateUnusedColumns();
+}
+
+void DataTable::UpdateUnusedColumns() {
+  std::fill(unused_columns_.begin(), unused_columns_.end(), false);
+  for (const auto* columns : {&consumer_unused_columns_, &dropped_columns_}) {
+    for (size_t index : *columns) {
+      DCHECK_LT(index, unused_columns_.size());
+      if (index < unused_columns_.size()) {
+        unused_columns_[index] = true;
+      }
+    }
+  }
+}
 
 void DataTable::InitBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr) {
   DCHECK(record_batch_ptr != nullptr);
   DCHECK(record_batch_ptr->empty());
 
+  if (!recycled_buffers_.empty()) {
+    *record_batch_ptr = std::move(recycled_buffers_.back());
+    recycled_buffers_.pop_back();
+    for (auto& col : *record_batch_ptr) {
+      col->Reserve(reserve_capacity_);
+    }
+    return;
+  }
+
   for (const auto& element : table_schema_.elements()) {
     px::types::DataType type = element.type();
 
 #define TYPE_CASE(_dt_)                           \
   auto col = types::ColumnWrapper::Make(_dt_, 0); \
-  col->Reserve(kTargetCapacity);                  \
+  col->Reserve(reserve_capacity_);                \
   record_batch_ptr->push_back(col);
     PX_SWITCH_FOREACH_DATATYPE(type, TYPE_CASE);
 #undef TYPE_CASE
   }
 }
 
+void DataTable::RecycleBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr) {
+  // A few batches are enough to cover the tablets that come and go between two consumptions.
+  constexpr size_t kMaxRecycledBuffers = 4;
+  if (record_batch_ptr->empty() || recycled_buffers_.size() >= kMaxRecycledBuffers) {
+    return;
+  }
+  for (auto& col : *record_batch_ptr) {
+    col->Clear();
+  }
+  recycled_buffers_.push_back(std::move(*record_batch_ptr));
+}
+
+void DataTable::UpdateReserveCapacity(size_t num_records) {
+  // Follow peaks right away, but decay slowly, so that bursts don't cause repeated growth.
+  constexpr size_t kMinReserveCapacity = 16;
+  constexpr size_t kMaxReserveCapacity = 64 * kTargetCapacity;
+  reserve_capacity_ = std::clamp(std::max(num_records, reserve_capacity_ * 3 / 4),
+                                 kMinReserveCapacity, kMaxReserveCapacity);
+}
+
+void DataTable::InitArrowBuilders(Tablet* tablet) {
+  DCHECK(tablet->builders.empty());
+
+  if (!recycled_builders_.empty()) {
+    tablet->builders = std::move(recycled_builders_);
+    recycled_builders_.clear();
+  } else {
+    for (const auto& element : table_schema_.elements()) {
+      tablet->builders.push_back(types::MakeArrowBuilder(element.type(), arrow_pool_));
+    }
+  }
+
+  for (size_t i = 0; i < tablet->builders.size(); ++i) {
+    PX_CHECK_OK(tablet->builders[i]->Reserve(reserve_capacity_));
+    if (arrow_data_capacity_[i] > 0) {
+      auto* builder = static_cast<arrow::StringBuilder*>(tablet->builders[i].get());
+      PX_CHECK_OK(builder->ReserveData(arrow_data_capacity_[i]));
+    }
+  }
+}
+
+ArrowRecordBatch DataTable::FinishArrowBuilders(Tablet* tablet) {
+  ArrowRecordBatch arrays(tablet->builders.size());
+  for (size_t i = 0; i < tablet->builders.size(); ++i) {
+    if (table_schema_.elements()[i].type() == DataType::STRING) {
+      auto* builder = static_cast<arrow::StringBuilder*>(tablet->builders[i].get());
+      arrow_data_capacity_[i] = builder->value_data_length();
+    }
+    // Finish() also resets the builder, so it can be reused.
+    PX_CHECK_OK(tablet->builders[i]->Finish(&arrays[i]));
+  }
+  recycled_builders_ = std::move(tablet->builders);
+  tablet->builders.clear();
+  return arrays;
+}
+
+void DataTable::set_dirty_tables(std::vector<DataTable*>* dirty_tables) {
+  dirty_tables_ = dirty_tables;
+  dirty_ = false;
+  if (Occupancy() > 0) {
+    MarkDirty();
+  }
+}
+
+bool DataTable::ClearDirtyIfEmpty() {
+  if (Occupancy() > 0) {
+    return false;
+  }
+  dirty_ = false;
+  return true;
+}
+
 Tablet* DataTable::GetTablet(types::TabletIDView tablet_id) {
+  MarkDirty();
   auto& tablet = tablets_[tablet_id];
-  if (tablet.records.empty()) {
-    InitBuffers(&tablet.records);
+  if (tablet.records.empty() && tablet.builders.empty()) {
+    if (uses_arrow_buffers()) {
+      InitArrowBuilders(&tablet);
+    } else {
+      InitBuffers(&tablet.records);
+    }
   }
   return &tablet;
 }
@@ -65,6 +189,8 @@ std::vector<TaggedRecordBatch> DataTable::ConsumeRecords() {
   uint64_t next_start_time = start_time_;
 
   for (auto& [tablet_id, tablet] : tablets_) {
+    UpdateReserveCapacity(tablet.times.size());
+
     // Sort based on times.
     std::vector<size_t> sort_indexes = utils::SortedIndexes(tablet.times);
 
@@ -92,6 +218,27 @@ std::vector<TaggedRecordBatch> DataTable::ConsumeRecords() {
         num_expired, table_schema_.name(), end_time, tablet.times[sort_indexes[0]]);
 
     // Case 2: Pushable records. Copy to output.
+    if (num_pushable > 0 && num_expired == 0 && num_carryover == 0 &&
+        std::is_sorted(tablet.times.begin(), tablet.times.end())) {
+      // Common case: all records are pushed, and they are already in order,
+      // so the columns are handed over as they are.
+      next_start_time = std::max(next_start_time, tablet.times.back());
+      if (!tablet.builders.empty()) {
+        tablets_out.push_back(TaggedRecordBatch{tablet_id, {}, FinishArrowBuilders(&tablet)});
+      } else {
+        tablets_out.push_back(TaggedRecordBatch{tablet_id, std::move(tablet.records)});
+      }
+      continue;
+    }
+    if (!tablet.builders.empty()) {
+      // The records must be reordered or split, which the column wrappers support.
+      // Any carryover records stay in column wrappers until they are consumed.
+      ArrowRecordBatch arrays = FinishArrowBuilders(&tablet);
+      for (size_t i = 0; i < arrays.size(); ++i) {
+        tablet.records.push_back(
+            ColumnWrapper::FromArrow(table_schema_.elements()[i].type(), arrays[i]));
+      }
+    }
     if (num_pushable > 0) {
       // TODO(oazizi): Consider VectorView to avoid copying.
       std::vector<size_t> push_indexes(sort_indexes.begin() + num_expired,
@@ -122,6 +269,9 @@ std::vector<TaggedRecordBatch> DataTable::ConsumeRecords() {
       carryover_tablets[tablet_id] =
           Tablet{tablet_id, std::move(times), std::move(carryover_records)};
     }
+
+    // All the records were moved out, so the columns can be reused.
+    RecycleBuffers(&tablet.records);
   }
   tablets_ = std::move(carryover_tablets);
 
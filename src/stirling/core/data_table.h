@@ -25,6 +25,9 @@
 #include <vector>
 
 #include <absl/container/flat_hash_map.h>
+#include <arrow/array.h>
+#include <arrow/builder.h>
+#include <arrow/memory_pool.h>
 
 #include "src/common/base/base.h"
 #include "src/common/base/mixins.h"
@@ -39,6 +42,9 @@ namespace stirling {
 struct TaggedRecordBatch {
   types::TabletID tablet_id;
   types::ColumnWrapperRecordBatch records;
+  // Set instead of records for the tables that buffer their records in Arrow builders,
+  // see --stirling_data_table_arrow_buffers.
+  ArrowRecordBatch arrow_records;
 };
 
 struct Tablet {
@@ -46,6 +52,8 @@ struct Tablet {
   // TODO(oazizi): Convert this vector into a heap of {time, index} objects.
   std::vector<uint64_t> times;
   types::ColumnWrapperRecordBatch records;
+  // Set instead of records when the records are appended directly into Arrow builders.
+  std::vector<std::unique_ptr<arrow::ArrayBuilder>> builders;
 };
 
 class DataTable : public NotCopyable {
@@ -91,9 +99,8 @@ class DataTable : public NotCopyable {
   size_t Occupancy() const {
     size_t occupancy = 0;
     for (auto& [tablet_id, tablet] : tablets_) {
-      if (!tablet.records.empty()) {
-        occupancy += tablet.records[0]->Size();
-      }
+      // Every record has a time, whether its values are in records or in builders.
+      occupancy += tablet.times.size();
     }
     return occupancy;
   }
@@ -105,6 +112,32 @@ class DataTable : public NotCopyable {
    */
   double OccupancyPct() const { return 1.0 * Occupancy() / kTargetCapacity; }
 
+  /**
+   * Marks the columns that no consumer of the table reads. The record builders store an empty
+   * value in unused string columns instead of the collected one, so that heavy columns such as
+   * message bodies don't take up memory in the table store. All other columns are always kept.
+   *
+   * @param unused_columns Indexes of the unused columns in the table schema.
+   */
+  void SetUnusedColumns(const std::vector<size_t>& unused_columns);
+
+  /**
+   * Marks the columns that the data source itself gives up, e.g. to stay within a CPU budget.
+   * They are handled like unused columns, independently of SetUnusedColumns().
+   *
+   * @param dropped_columns Indexes of the dropped columns in the table schema.
+   */
+  void SetDroppedColumns(const std::vector<size_t>& dropped_columns);
+
+  /**
+   * Whether the column at the index is read by any consumer of the table.
+   * Data sources can use this to skip gathering data that would be dropped anyway.
+   */
+  bool IsColumnUsed(size_t index) const {
+    DCHECK_LT(index, unused_columns_.size());
+    return !unused_columns_[index];
+  }
+
   // Example usage:
   // DataTable::RecordBuilder<&kTable> r(data_table, time);
   // r.Append<r.ColIndex("field0")>(val0);
@@ -129,14 +162,14 @@ class DataTable : public NotCopyable {
   class RecordBuilder {
    public:
     RecordBuilder(DataTable* data_table, types::TabletIDView tablet_id, uint64_t time = 0)
-        : tablet_(*data_table->GetTablet(tablet_id)) {
+        : tablet_(*data_table->GetTablet(tablet_id)), unused_columns_(data_table->unused_columns_) {
       static_assert(schema->tabletized());
       tablet_id_ = tablet_id;
       Init(time);
     }
 
     explicit RecordBuilder(DataTable* data_table, uint64_t time = 0)
-        : tablet_(*data_table->GetTablet("")) {
+        : tablet_(*data_table->GetTablet("")), unused_columns_(data_table->unused_columns_) {
       static_assert(!schema->tabletized());
       Init(time);
     }
@@ -158,14 +191,23 @@ class DataTable : public NotCopyable {
       }
 
       if constexpr (std::is_same_v<TDataType, types::StringValue>) {
-        if (val.size() > max_string_bytes) {
-          val.resize(max_string_bytes);
-          val.append(kTruncatedMsg);
+        if (unused_columns_[TIndex]) {
+          val.clear();
+          val.shrink_to_fit();
+        } else {
+          if (val.size() > max_string_bytes) {
+            val.resize(max_string_bytes);
+            val.append(kTruncatedMsg);
+          }
+          TrimExcessCapacity(&val);
         }
-        val.shrink_to_fit();
       }
 
-      tablet_.records[TIndex]->Append(std::move(val));
+      if (tablet_.builders.empty()) {
+        tablet_.records[TIndex]->Append(std::move(val));
+      } else {
+        AppendToBuilder(tablet_.builders[TIndex].get(), val);
+      }
       DCHECK(!signature_[TIndex]) << absl::Substitute(
           "Attempt to Append() to column $0 (name=$1) multiple times", TIndex,
           schema->ColName(TIndex));
@@ -190,11 +232,13 @@ class DataTable : public NotCopyable {
 
    private:
     void Init(uint64_t time) {
-      DCHECK_EQ(schema->elements().size(), tablet_.records.size());
+      DCHECK_EQ(schema->elements().size(),
+                std::max(tablet_.records.size(), tablet_.builders.size()));
       tablet_.times.push_back(time);
     }
 
     Tablet& tablet_;
+    const std::vector<bool>& unused_columns_;
     std::bitset<schema->elements().size()> signature_;
     types::TabletIDView tablet_id_ = "";
   };
@@ -208,14 +252,18 @@ class DataTable : public NotCopyable {
   class DynamicRecordBuilder {
    public:
     DynamicRecordBuilder(DataTable* data_table, types::TabletIDView tablet_id, uint64_t time = 0)
-        : schema_(data_table->table_schema_), tablet_(*data_table->GetTablet(tablet_id)) {
+        : schema_(data_table->table_schema_),
+          tablet_(*data_table->GetTablet(tablet_id)),
+          unused_columns_(data_table->unused_columns_) {
       DCHECK(schema_.tabletized());
       tablet_id_ = tablet_id;
       Init(time);
     }
 
     explicit DynamicRecordBuilder(DataTable* data_table, uint64_t time = 0)
-        : schema_(data_table->table_schema_), tablet_(*data_table->GetTablet("")) {
+        : schema_(data_table->table_schema_),
+          tablet_(*data_table->GetTablet("")),
+          unused_columns_(data_table->unused_columns_) {
       DCHECK(!schema_.tabletized());
       Init(time);
     }
@@ -224,13 +272,25 @@ class DataTable : public NotCopyable {
     template <typename TValueType>
     void Append(size_t col_index, TValueType val, size_t max_string_bytes = 1024) {
       if constexpr (std::is_same_v<TValueType, types::StringValue>) {
-        if (val.size() > max_string_bytes) {
-          val.resize(max_string_bytes);
-          val.append(kTruncatedMsg);
+        if (unused_columns_[col_index]) {
+          val.clear();
+          val.shrink_to_fit();
+        } else {
+          if (val.size() > max_string_bytes) {
+            val.resize(max_string_bytes);
+            val.append(kTruncatedMsg);
+          }
+          TrimExcessCapacity(&val);
         }
       }
 
-      tablet_.records[col_index]->Append(std::move(val));
+      if (tablet_.builders.empty()) {
+        tablet_.records[col_index]->Append(std::move(val));
+      } else {
+        DCHECK_EQ(schema_.elements()[col_index].type(),
+                  types::ValueTypeTraits<TValueType>::data_type);
+        AppendToBuilder(tablet_.builders[col_index].get(), val);
+      }
 
       DCHECK(!signature_[col_index])
           << absl::Substitute("Attempt to Append() to column $0 (name=$1) multiple times",
@@ -246,7 +306,8 @@ class DataTable : public NotCopyable {
 
    private:
     void Init(uint64_t time) {
-      DCHECK_EQ(schema_.elements().size(), tablet_.records.size());
+      DCHECK_EQ(schema_.elements().size(),
+                std::max(tablet_.records.size(), tablet_.builders.size()));
       tablet_.times.push_back(time);
       LOG_IF(DFATAL, schema_.elements().size() > kMaxSupportedColumns) << absl::Substitute(
           "Tables with more than $0 columns are not supported.", kMaxSupportedColumns);
@@ -256,27 +317,135 @@ class DataTable : public NotCopyable {
     const DataTableSchema& schema_;
     std::bitset<kMaxSupportedColumns> signature_ = 0;
     Tablet& tablet_;
+    const std::vector<bool>& unused_columns_;
     types::TabletIDView tablet_id_ = "";
   };
 
   uint64_t id() const { return id_; }
+  const DataTableSchema& table_schema() const { return table_schema_; }
+
+  /**
+   * Sets the sink that PushData() uses for the untabletized records of this table,
+   * see DataPushSinkFactory.
+   */
+  void set_push_sink(DataPushSink sink) { push_sink_ = std::move(sink); }
+  const DataPushSink& push_sink() const { return push_sink_; }
+
+  /**
+   * Sets the sink that PushData() uses for the records that are consumed as Arrow arrays,
+   * see ArrowDataPushSinkFactory.
+   */
+  void set_arrow_push_sink(ArrowDataPushSink sink) { arrow_push_sink_ = std::move(sink); }
+  const ArrowDataPushSink& arrow_push_sink() const { return arrow_push_sink_; }
+
+  /**
+   * Whether the untabletized records are appended directly into Arrow builders,
+   * and consumed as Arrow arrays when possible.
+   */
+  bool uses_arrow_buffers() const { return arrow_pool_ != nullptr; }
+
+  /**
+   * Registers the list of dirty tables of the source: the table adds itself to it when records are
+   * appended while it is not listed, so that the source only consumes and checks the tables that
+   * may hold records, see SourceConnector::PushData().
+   */
+  void set_dirty_tables(std::vector<DataTable*>* dirty_tables);
+
+  /**
+   * Unmarks the table if it holds no records, e.g. after ConsumeRecords() emptied it.
+   *
+   * @return true if the table was unmarked, and should be removed from the list of dirty tables.
+   */
+  bool ClearDirtyIfEmpty();
 
  protected:
   // ColumnWrapper specific members
   static constexpr size_t kTargetCapacity = 1024;
 
+  // Strings that go into the table store keep their capacity, which saves a reallocation per
+  // string, unless a lot of it is unused (e.g. after truncation), since it is held until the
+  // record expires from the table store.
+  static void TrimExcessCapacity(std::string* str) {
+    constexpr size_t kMaxExcessCapacity = 256;
+    if (str->capacity() - str->size() > kMaxExcessCapacity) {
+      str->shrink_to_fit();
+    }
+  }
+
+  template <typename TValueType>
+  static void AppendToBuilder(arrow::ArrayBuilder* builder, const TValueType& val) {
+    constexpr types::DataType kDataType = types::ValueTypeTraits<TValueType>::data_type;
+    // The builders are made by types::MakeArrowBuilder(), so this is the type they have.
+    auto* typed_builder =
+        static_cast<typename types::DataTypeTraits<kDataType>::arrow_builder_type*>(builder);
+    if constexpr (std::is_same_v<TValueType, types::StringValue>) {
+      PX_CHECK_OK(typed_builder->Append(val));
+    } else {
+      PX_CHECK_OK(typed_builder->Append(val.val));
+    }
+  }
+
   // Unique ID set by InfoClassManager.
   const uint64_t id_;
 
-  // Initialize a new Active record batch.
+  // Initialize a new Active record batch, with recycled columns if possible, and with capacity for
+  // reserve_capacity_ records.
   void InitBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr);
 
+  // Keeps the columns of a batch whose records were all moved out, for InitBuffers() to reuse.
+  void RecycleBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr);
+
+  // Updates reserve_capacity_ with the number of records that a tablet held at consumption.
+  void UpdateReserveCapacity(size_t num_records);
+
+  // Emptied column batches, reused by InitBuffers() instead of allocating new ones.
+  std::vector<types::ColumnWrapperRecordBatch> recycled_buffers_;
+
+  // The number of records to reserve space for in new buffers. Follows the recent peaks of
+  // occupancy, so that busy tables don't grow their columns repeatedly, and idle tables release
+  // memory.
+  size_t reserve_capacity_ = kTargetCapacity;
+
+  // Sets up Arrow builders in the tablet, reserved for reserve_capacity_ records.
+  void InitArrowBuilders(Tablet* tablet);
+
+  // Finishes the Arrow builders of the tablet into arrays, and keeps the builders for reuse.
+  ArrowRecordBatch FinishArrowBuilders(Tablet* tablet);
+
+  // Set when --stirling_data_table_arrow_buffers is on and the table is untabletized.
+  arrow::MemoryPool* arrow_pool_ = nullptr;
+
+  // The builders of the last consumed tablet, reused by InitArrowBuilders().
+  std::vector<std::unique_ptr<arrow::ArrayBuilder>> recycled_builders_;
+
+  // Indexed by column. The number of string bytes last consumed from the column, reserved up front
+  // in its next builder.
+  std::vector<int64_t> arrow_data_capacity_;
+
   // Get a pointer to the Tablet, for appending. Used by RecordBuilder.
   Tablet* GetTablet(types::TabletIDView tablet_id);
 
+  // Adds the table to dirty_tables_, if it is not already listed.
+  void MarkDirty() {
+    if (!dirty_ && dirty_tables_ != nullptr) {
+      dirty_ = true;
+      dirty_tables_->push_back(this);
+    }
+  }
+
   // Table schema: a DataElement to describe each column.
   const DataTableSchema& table_schema_;
 
+  // Combines consumer_unused_columns_ and dropped_columns_ into unused_columns_.
+  void UpdateUnusedColumns();
+
+  // See SetUnusedColumns() and SetDroppedColumns().
+  std::vector<size_t> consumer_unused_columns_;
+  std::vector<size_t> dropped_columns_;
+
+  // Indexed by column. Set for the columns that are either unused or dropped.
+  std::vector<bool> unused_columns_;
+
   // Key is tablet id, value is tablet records.
   absl::flat_hash_map<types::TabletID, Tablet> tablets_;
 
@@ -287,6 +456,14 @@ class DataTable : public NotCopyable {
   // Used particularly by the socket tracer which receives asynchronous
   // events from BPF.
   std::optional<uint64_t> cutoff_time_;
+
+  // Resolved once by PushData(), empty until then.
+  DataPushSink push_sink_;
+  ArrowDataPushSink arrow_push_sink_;
+
+  // Owned by the source, see set_dirty_tables(). A table that holds records is always listed.
+  std::vector<DataTable*>* dirty_tables_ = nullptr;
+  bool dirty_ = false;
 };
 
 }  // namespace stirling
@@ -20,9 +20,12 @@
 #include <random>
 #include <string>
 
+#include "src/common/testing/testing.h"
 #include "src/stirling/core/data_table.h"
 #include "src/stirling/source_connectors/seq_gen/sequence_generator.h"
 
+DECLARE_bool(stirling_data_table_arrow_buffers);
+
 namespace px {
 namespace stirling {
 
@@ -72,6 +75,197 @@ TEST_F(DataTableTest, ResultIsSorted) {
 // No time passed to RecordBuilder, so all timestamps should be zero.
 // That means there should never be any expired or carry-over records.
 // Also, nothing should be sorted in any way.
+// Tests that the records stay correct when the columns are handed over as they are (in order)
+// or recycled (out of order), across several rounds.
+TEST_F(DataTableTest, ConsumeRecordsReusesBuffers) {
+  for (int round = 0; round < 4; ++round) {
+    const bool in_order = round % 2 == 0;
+    const int base = 100 * round;
+    std::vector<int> offsets = in_order ? std::vector<int>{0, 1, 2} : std::vector<int>{2, 0, 1};
+    for (int offset : offsets) {
+      DataTable::RecordBuilder<&kSchema> r(data_table_.get(), base + offset);
+      r.Append<r.ColIndex("time_")>(base + offset);
+      r.Append<r.ColIndex("x")>(offset);
+      r.Append<r.ColIndex("s")>(std::string(2000, 'a' + offset), /*max_string_bytes*/ 10);
+    }
+
+    std::vector<TaggedRecordBatch> record_batches = data_table_->ConsumeRecords();
+    ASSERT_EQ(record_batches.size(), 1);
+    types::ColumnWrapperRecordBatch& rb = record_batches[0].records;
+    ASSERT_EQ(rb[0]->Size(), 3);
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(i), base + i);
+      EXPECT_EQ(rb[1]->Get<types::Int64Value>(i), i);
+      const types::StringValue& s = rb[2]->Get<types::StringValue>(i);
+      EXPECT_EQ(s, absl::StrCat(std::string(10, 'a' + i), DataTable::kTruncatedMsg));
+      // The truncated strings don't hold on to their original capacity.
+      EXPECT_LT(s.capacity(), 1000);
+    }
+  }
+}
+
+// Tests that in-order records are consumed as Arrow arrays, across several rounds.
+TEST_F(DataTableTest, ArrowBuffers) {
+  PX_SET_FOR_SCOPE(FLAGS_stirling_data_table_arrow_buffers, true);
+  data_table_ = std::make_unique<DataTable>(/*id*/ 0, kSchema);
+  ASSERT_TRUE(data_table_->uses_arrow_buffers());
+
+  for (int round = 0; round < 3; ++round) {
+    const int base = 100 * round;
+    for (int i = 0; i < 3; ++i) {
+      DataTable::RecordBuilder<&kSchema> r(data_table_.get(), base + i);
+      r.Append<r.ColIndex("time_")>(base + i);
+      r.Append<r.ColIndex("x")>(i);
+      r.Append<r.ColIndex("s")>(std::string(20, 'a' + i), /*max_string_bytes*/ 10);
+    }
+    {
+      DataTable::DynamicRecordBuilder r(data_table_.get(), base + 3);
+      r.Append(0, types::Time64NSValue(base + 3));
+      r.Append(1, types::Int64Value(3));
+      r.Append(2, types::StringValue("d"));
+    }
+    EXPECT_EQ(data_table_->Occupancy(), 4);
+
+    std::vector<TaggedRecordBatch> record_batches = data_table_->ConsumeRecords();
+    ASSERT_EQ(record_batches.size(), 1);
+    EXPECT_TRUE(record_batches[0].records.empty());
+    const ArrowRecordBatch& arrays = record_batches[0].arrow_records;
+    ASSERT_EQ(arrays.size(), 3);
+    ASSERT_EQ(arrays[0]->length(), 4);
+
+    auto* times = static_cast<arrow::Time64Array*>(arrays[0].get());
+    auto* xs = static_cast<arrow::Int64Array*>(arrays[1].get());
+    auto* strs = static_cast<arrow::StringArray*>(arrays[2].get());
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_EQ(times->Value(i), base + i);
+      EXPECT_EQ(xs->Value(i), i);
+      EXPECT_EQ(strs->GetString(i),
+                absl::StrCat(std::string(10, 'a' + i), DataTable::kTruncatedMsg));
+    }
+    EXPECT_EQ(times->Value(3), base + 3);
+    EXPECT_EQ(xs->Value(3), 3);
+    EXPECT_EQ(strs->GetString(3), "d");
+    EXPECT_EQ(data_table_->Occupancy(), 0);
+  }
+}
+
+// Tests that the records that must be reordered or carried over fall back to column wrappers.
+TEST_F(DataTableTest, ArrowBuffersOutOfOrder) {
+  PX_SET_FOR_SCOPE(FLAGS_stirling_data_table_arrow_buffers, true);
+  data_table_ = std::make_unique<DataTable>(/*id*/ 0, kSchema);
+
+  for (int t : {20, 0, 10, 30}) {
+    DataTable::RecordBuilder<&kSchema> r(data_table_.get(), t);
+    r.Append<r.ColIndex("time_")>(t);
+    r.Append<r.ColIndex("x")>(t / 10);
+    r.Append<r.ColIndex("s")>(std::to_string(t));
+  }
+  data_table_->SetConsumeRecordsCutoffTime(20);
+
+  std::vector<TaggedRecordBatch> record_batches = data_table_->ConsumeRecords();
+  ASSERT_EQ(record_batches.size(), 1);
+  EXPECT_TRUE(record_batches[0].arrow_records.empty());
+  types::ColumnWrapperRecordBatch& rb = record_batches[0].records;
+  ASSERT_EQ(rb[0]->Size(), 3);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(i), 10 * i);
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(i), i);
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(i), std::to_string(10 * i));
+  }
+
+  // The carried over record is consumed with the ones appended after it.
+  {
+    DataTable::RecordBuilder<&kSchema> r(data_table_.get(), 40);
+    r.Append<r.ColIndex("time_")>(40);
+    r.Append<r.ColIndex("x")>(4);
+    r.Append<r.ColIndex("s")>("40");
+  }
+  data_table_->SetConsumeRecordsCutoffTime(40);
+  record_batches = data_table_->ConsumeRecords();
+  ASSERT_EQ(record_batches.size(), 1);
+  types::ColumnWrapperRecordBatch& rb2 = record_batches[0].records;
+  ASSERT_EQ(rb2[0]->Size(), 2);
+  EXPECT_EQ(rb2[0]->Get<types::Time64NSValue>(0), 30);
+  EXPECT_EQ(rb2[0]->Get<types::Time64NSValue>(1), 40);
+  EXPECT_EQ(rb2[2]->Get<types::StringValue>(1), "40");
+}
+
+// Tests the records appended after the fallback to column wrappers, with both record builders,
+// and that the table returns to Arrow buffers once the carried over records are consumed.
+TEST_F(DataTableTest, ArrowBuffersAppendAfterFallback) {
+  PX_SET_FOR_SCOPE(FLAGS_stirling_data_table_arrow_buffers, true);
+  data_table_ = std::make_unique<DataTable>(/*id*/ 0, kSchema);
+
+  auto append = [this](int t) {
+    DataTable::RecordBuilder<&kSchema> r(data_table_.get(), t);
+    r.Append<r.ColIndex("time_")>(t);
+    r.Append<r.ColIndex("x")>(t / 10);
+    r.Append<r.ColIndex("s")>(std::to_string(t));
+  };
+  auto expect_records = [](const TaggedRecordBatch& batch, const std::vector<int>& times) {
+    EXPECT_TRUE(batch.arrow_records.empty());
+    const types::ColumnWrapperRecordBatch& rb = batch.records;
+    ASSERT_EQ(rb.size(), 3);
+    ASSERT_EQ(rb[0]->Size(), times.size());
+    for (size_t i = 0; i < times.size(); ++i) {
+      EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(i), times[i]);
+      EXPECT_EQ(rb[1]->Get<types::Int64Value>(i), times[i] / 10);
+      EXPECT_EQ(rb[2]->Get<types::StringValue>(i), std::to_string(times[i]));
+    }
+  };
+
+  // The builders are finished into column wrappers, and 30 and 50 are carried over.
+  for (int t : {20, 50, 0, 30, 10}) {
+    append(t);
+  }
+  data_table_->SetConsumeRecordsCutoffTime(20);
+  std::vector<TaggedRecordBatch> record_batches = data_table_->ConsumeRecords();
+  ASSERT_EQ(record_batches.size(), 1);
+  expect_records(record_batches[0], {0, 10, 20});
+  EXPECT_EQ(data_table_->Occupancy(), 2);
+
+  // These are appended into the carried over column wrappers.
+  append(40);
+  {
+    DataTable::DynamicRecordBuilder r(data_table_.get(), 60);
+    r.Append(0, types::Time64NSValue(60));
+    r.Append(1, types::Int64Value(6));
+    r.Append(2, types::StringValue("60"));
+  }
+  EXPECT_EQ(data_table_->Occupancy(), 4);
+  data_table_->SetConsumeRecordsCutoffTime(50);
+  record_batches = data_table_->ConsumeRecords();
+  ASSERT_EQ(record_batches.size(), 1);
+  expect_records(record_batches[0], {30, 40, 50});
+  EXPECT_EQ(data_table_->Occupancy(), 1);
+
+  // The last carried over record is in order, so its column wrappers are handed over as they are.
+  data_table_->SetConsumeRecordsCutoffTime(60);
+  record_batches = data_table_->ConsumeRecords();
+  ASSERT_EQ(record_batches.size(), 1);
+  expect_records(record_batches[0], {60});
+  EXPECT_EQ(data_table_->Occupancy(), 0);
+
+  // With nothing left in column wrappers, new records go into the Arrow builders again.
+  append(70);
+  append(80);
+  data_table_->SetConsumeRecordsCutoffTime(80);
+  record_batches = data_table_->ConsumeRecords();
+  ASSERT_EQ(record_batches.size(), 1);
+  EXPECT_TRUE(record_batches[0].records.empty());
+  const ArrowRecordBatch& arrays = record_batches[0].arrow_records;
+  ASSERT_EQ(arrays.size(), 3);
+  ASSERT_EQ(arrays[0]->length(), 2);
+  auto* times = static_cast<arrow::Time64Array*>(arrays[0].get());
+  auto* xs = static_cast<arrow::Int64Array*>(arrays[1].get());
+  auto* strs = static_cast<arrow::StringArray*>(arrays[2].get());
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(times->Value(i), 70 + 10 * i);
+    EXPECT_EQ(xs->Value(i), 7 + i);
+    EXPECT_EQ(strs->GetString(i), std::to_string(70 + 10 * i));
+  }
+}
+
 TEST_F(DataTableTest, FixedTimeMode) {
   std::vector<int> time_vals = {0, 10, 40, 20, 30, 50, 90, 70, 60, 80};
   std::vector<int> x_vals = {0, 1, 4, 2, 3, 5, 9, 7, 6, 8};
@@ -122,6 +316,61 @@ TEST_F(DataTableTest, FixedTimeModeV2) {
   }
 }
 
+TEST_F(DataTableTest, UnusedColumns) {
+  data_table_->SetUnusedColumns({kSchema.ColIndex("s")});
+  EXPECT_TRUE(data_table_->IsColumnUsed(kSchema.ColIndex("x")));
+  EXPECT_FALSE(data_table_->IsColumnUsed(kSchema.ColIndex("s")));
+
+  {
+    DataTable::RecordBuilder<&kSchema> r(data_table_.get(), 0);
+    r.Append<r.ColIndex("time_")>(0);
+    r.Append<r.ColIndex("x")>(1);
+    r.Append<r.ColIndex("s")>("a long body that nobody reads");
+  }
+  {
+    DataTable::DynamicRecordBuilder r(data_table_.get(), 1);
+    r.Append(0, types::Time64NSValue(1));
+    r.Append(1, types::Int64Value(2));
+    r.Append(2, types::StringValue("another long body"));
+  }
+
+  // Integer columns are kept even if they are unused.
+  data_table_->SetUnusedColumns({kSchema.ColIndex("x")});
+  {
+    DataTable::RecordBuilder<&kSchema> r(data_table_.get(), 2);
+    r.Append<r.ColIndex("time_")>(2);
+    r.Append<r.ColIndex("x")>(3);
+    r.Append<r.ColIndex("s")>("c");
+  }
+
+  std::vector<TaggedRecordBatch> record_batches = data_table_->ConsumeRecords();
+  ASSERT_EQ(record_batches.size(), 1);
+  types::ColumnWrapperRecordBatch& rb = record_batches[0].records;
+  ASSERT_EQ(rb[0]->Size(), 3);
+
+  EXPECT_EQ(rb[1]->Get<types::Int64Value>(0), 1);
+  EXPECT_EQ(rb[2]->Get<types::StringValue>(0), "");
+  EXPECT_EQ(rb[1]->Get<types::Int64Value>(1), 2);
+  EXPECT_EQ(rb[2]->Get<types::StringValue>(1), "");
+  EXPECT_EQ(rb[1]->Get<types::Int64Value>(2), 3);
+  EXPECT_EQ(rb[2]->Get<types::StringValue>(2), "c");
+}
+
+TEST_F(DataTableTest, DroppedColumns) {
+  data_table_->SetUnusedColumns({kSchema.ColIndex("x")});
+  data_table_->SetDroppedColumns({kSchema.ColIndex("s")});
+  EXPECT_FALSE(data_table_->IsColumnUsed(kSchema.ColIndex("x")));
+  EXPECT_FALSE(data_table_->IsColumnUsed(kSchema.ColIndex("s")));
+
+  // Dropped columns are independent from the unused ones.
+  data_table_->SetUnusedColumns({});
+  EXPECT_TRUE(data_table_->IsColumnUsed(kSchema.ColIndex("x")));
+  EXPECT_FALSE(data_table_->IsColumnUsed(kSchema.ColIndex("s")));
+
+  data_table_->SetDroppedColumns({});
+  EXPECT_TRUE(data_table_->IsColumnUsed(kSchema.ColIndex("s")));
+}
+
 TEST_F(DataTableTest, Expiry) {
   std::vector<int> time_vals = {0, 10, 40, 20, 30, 50, 90, 70, 60, 80};
   std::vector<int> x_vals = {0, 1, 4, 2, 3, 5, 9, 7, 6, 8};
@@ -18,6 +18,8 @@
 
 #include "src/stirling/core/frequency_manager.h"
 
+#include <algorithm>
+
 namespace px {
 namespace stirling {
 
@@ -26,5 +28,23 @@ void FrequencyManager::Reset(const time_point now) {
   ++count_;
 }
 
+void FrequencyManager::SetAdaptiveBounds(std::chrono::milliseconds min_period,
+                                         std::chrono::milliseconds max_period) {
+  min_period_ = min_period;
+  max_period_ = std::max(min_period, max_period);
+  period_ = std::clamp(period_, min_period_, max_period_);
+}
+
+void FrequencyManager::UpdateLoad(double load) {
+  if (!adaptive()) {
+    return;
+  }
+  if (load > kHighLoad) {
+    period_ = std::max(min_period_, period_ / 2);
+  } else if (load < kLowLoad) {
+    period_ = std::min(max_period_, period_ + std::max(period_ / 4, std::chrono::milliseconds{1}));
+  }
+}
+
 }  // namespace stirling
 }  // namespace px
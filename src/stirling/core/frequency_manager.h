@@ -42,6 +42,26 @@ class FrequencyManager {
    */
   void Reset(const time_point now);
 
+  /**
+   * Makes the period adaptive, between min_period and max_period, see UpdateLoad().
+   * The current period is clamped into the bounds.
+   */
+  void SetAdaptiveBounds(std::chrono::milliseconds min_period,
+                         std::chrono::milliseconds max_period);
+
+  /**
+   * Adapts the period to the load of the cycle that just ended, given as the fraction of the
+   * capacity that was used (1 or more if data was lost). Above kHighLoad the period is halved to
+   * catch up quickly with a burst; below kLowLoad it grows by a quarter to back off gradually
+   * when idle. Does nothing if the period is not adaptive.
+   */
+  void UpdateLoad(double load);
+
+  static constexpr double kHighLoad = 0.5;
+  static constexpr double kLowLoad = 0.1;
+
+  bool adaptive() const { return max_period_ != std::chrono::milliseconds::zero(); }
+
   void set_period(std::chrono::milliseconds period) { period_ = period; }
   const auto& period() const { return period_; }
   const auto& next() const { return next_; }
@@ -51,6 +71,10 @@ class FrequencyManager {
   // The cycle's period.
   std::chrono::milliseconds period_ = {};
 
+  // Bounds of the period, if adaptive.
+  std::chrono::milliseconds min_period_ = {};
+  std::chrono::milliseconds max_period_ = {};
+
   // When the current cycle should end.
   std::chrono::steady_clock::time_point next_ = {};
 
@@ -49,5 +49,40 @@ TEST(FrequencyManagerTest, SetPeriodEndAndCheck) {
   EXPECT_GE(computed_period, std::chrono::milliseconds{9990});
 }
 
+// Tests that an adaptive period shrinks under load and grows when idle, within its bounds.
+TEST(FrequencyManagerTest, AdaptivePeriod) {
+  FrequencyManager mgr;
+  mgr.set_period(std::chrono::milliseconds{200});
+
+  // Not adaptive yet.
+  mgr.UpdateLoad(1.0);
+  EXPECT_FALSE(mgr.adaptive());
+  EXPECT_EQ(mgr.period(), std::chrono::milliseconds{200});
+
+  mgr.SetAdaptiveBounds(std::chrono::milliseconds{50}, std::chrono::milliseconds{400});
+  EXPECT_TRUE(mgr.adaptive());
+
+  mgr.UpdateLoad(0.3);
+  EXPECT_EQ(mgr.period(), std::chrono::milliseconds{200});
+
+  mgr.UpdateLoad(0.8);
+  EXPECT_EQ(mgr.period(), std::chrono::milliseconds{100});
+  mgr.UpdateLoad(2.0);
+  EXPECT_EQ(mgr.period(), std::chrono::milliseconds{50});
+  mgr.UpdateLoad(2.0);
+  EXPECT_EQ(mgr.period(), std::chrono::milliseconds{50});
+
+  mgr.UpdateLoad(0.0);
+  EXPECT_EQ(mgr.period(), std::chrono::milliseconds{62});
+  for (int i = 0; i < 20; ++i) {
+    mgr.UpdateLoad(0.0);
+  }
+  EXPECT_EQ(mgr.period(), std::chrono::milliseconds{400});
+
+  // The current period is clamped into new bounds.
+  mgr.SetAdaptiveBounds(std::chrono::milliseconds{10}, std::chrono::milliseconds{100});
+  EXPECT_EQ(mgr.period(), std::chrono::milliseconds{100});
+}
+
 }  // namespace stirling
 }  // namespace px
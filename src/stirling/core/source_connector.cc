@@ -16,10 +16,12 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
 #include <cstring>
 #include <ctime>
 #include <memory>
 
+#include <arrow/array.h>
 #include <magic_enum.hpp>
 
 #include "src/stirling/core/source_connector.h"
@@ -51,19 +53,62 @@ void SourceConnector::TransferData(ConnectorContext* ctx) {
   TransferDataImpl(ctx);
 }
 
-void SourceConnector::PushData(DataPushCallback agent_callback) {
+void SourceConnector::set_data_tables(std::vector<DataTable*> data_tables) {
+  data_tables_ = std::move(data_tables);
+  dirty_tables_.clear();
   for (auto* data_table : data_tables_) {
+    if (data_table != nullptr) {
+      data_table->set_dirty_tables(&dirty_tables_);
+    }
+  }
+}
+
+void SourceConnector::PushData(DataPushCallback agent_callback,
+                               const DataPushSinkFactory& sink_factory,
+                               const ArrowDataPushSinkFactory& arrow_sink_factory) {
+  for (auto* data_table : dirty_tables_) {
     auto record_batches = data_table->ConsumeRecords();
+    if (record_batches.empty()) {
+      continue;
+    }
+    // The agent may not have created the table yet (e.g. for dynamic tracing), so the sink
+    // is looked up until it is found.
+    if (!data_table->push_sink() && sink_factory) {
+      data_table->set_push_sink(sink_factory(data_table->id()));
+    }
+    if (data_table->uses_arrow_buffers() && !data_table->arrow_push_sink() && arrow_sink_factory) {
+      data_table->set_arrow_push_sink(arrow_sink_factory(data_table->id()));
+    }
     for (auto& record_batch : record_batches) {
+      if (!record_batch.arrow_records.empty()) {
+        if (data_table->arrow_push_sink()) {
+          Status s = data_table->arrow_push_sink()(std::move(record_batch.arrow_records));
+          LOG_IF(DFATAL, !s.ok()) << absl::Substitute("Failed to push data. Message = $0",
+                                                      s.msg());
+          continue;
+        }
+        const auto& elements = data_table->table_schema().elements();
+        for (size_t i = 0; i < record_batch.arrow_records.size(); ++i) {
+          record_batch.records.push_back(
+              types::ColumnWrapper::FromArrow(elements[i].type(), record_batch.arrow_records[i]));
+        }
+      }
       if (record_batch.records.empty()) {
         continue;
       }
-      Status s = agent_callback(
-          data_table->id(), record_batch.tablet_id,
-          std::make_unique<types::ColumnWrapperRecordBatch>(std::move(record_batch.records)));
+      auto records =
+          std::make_unique<types::ColumnWrapperRecordBatch>(std::move(record_batch.records));
+      Status s = (record_batch.tablet_id.empty() && data_table->push_sink())
+                     ? data_table->push_sink()(std::move(records))
+                     : agent_callback(data_table->id(), record_batch.tablet_id,
+                                      std::move(records));
       LOG_IF(DFATAL, !s.ok()) << absl::Substitute("Failed to push data. Message = $0", s.msg());
     }
   }
+  // Tables that still hold records past their cutoff time stay dirty until a later push.
+  dirty_tables_.erase(std::remove_if(dirty_tables_.begin(), dirty_tables_.end(),
+                                     [](DataTable* t) { return t->ClearDirtyIfEmpty(); }),
+                      dirty_tables_.end());
 }
 
 Status SourceConnector::Stop() {
@@ -18,8 +18,10 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -28,6 +30,7 @@
 #include "src/shared/types/types.h"
 #include "src/stirling/bpf_tools/bcc_wrapper.h"
 #include "src/stirling/core/connector_context.h"
+#include "src/stirling/core/cpu_budget_governor.h"
 #include "src/stirling/core/data_table.h"
 #include "src/stirling/core/frequency_manager.h"
 #include "src/stirling/core/info_class_manager.h"
@@ -74,8 +77,22 @@ class SourceConnector : public NotCopyable {
 
   /**
    * Pushes data in data tables into table store.
+   * The untabletized records of a table go to its sink, if sink_factory resolves one,
+   * rather than through agent_callback. The same holds for the records consumed as Arrow arrays
+   * and arrow_sink_factory; without an Arrow sink, they are converted to column wrappers.
    */
-  void PushData(DataPushCallback agent_callback);
+  void PushData(DataPushCallback agent_callback, const DataPushSinkFactory& sink_factory = {},
+                const ArrowDataPushSinkFactory& arrow_sink_factory = {});
+
+  /**
+   * Blocks until the source has new data, or until the timeout expires.
+   * Sources that don't have a way to be notified of new data just sleep.
+   * @return true if woken up by new data, in which case TransferData() should run early.
+   */
+  virtual bool WaitForData(std::chrono::milliseconds timeout) {
+    std::this_thread::sleep_for(timeout);
+    return false;
+  }
 
   /**
    * Stops the source connector and releases any acquired resources.
@@ -118,17 +135,42 @@ class SourceConnector : public NotCopyable {
   // in the exact same way.
   uint64_t AdjustedSteadyClockNowNS() const { return ConvertToRealTime(CurrentSteadyTimeNS()); }
 
+  /**
+   * Sets what the source gives up to keep Stirling within its CPU budget, see CPUBudgetGovernor.
+   * Sources that can't degrade just record the level.
+   */
+  virtual void SetDegradationLevel(DegradationLevel level) { degradation_level_ = level; }
+  DegradationLevel degradation_level() const { return degradation_level_; }
+
+  /**
+   * Tells the source whether the process is short of memory, in which case it should hold on to
+   * less data between transfers. Sources that buffer little just record it.
+   */
+  virtual void SetMemoryPressure(bool under_pressure) { memory_pressure_ = under_pressure; }
+  bool memory_pressure() const { return memory_pressure_; }
+
   virtual void SetDebugLevel(int level) { debug_level_ = level; }
   virtual void EnablePIDTrace(int pid) { pids_to_trace_.insert(pid); }
   virtual void DisablePIDTrace(int pid) { pids_to_trace_.erase(pid); }
 
+  /**
+   * The load seen by the last TransferData(), as the fraction of what the source can buffer
+   * between two transfers that was used; 1 or more if data was lost.
+   * Negative if the source doesn't measure it, in which case its periods don't adapt to load.
+   */
+  double transfer_load() const { return transfer_load_; }
+
   FrequencyManager& sampling_freq_mgr() { return sampling_freq_mgr_; }
   FrequencyManager& push_freq_mgr() { return push_freq_mgr_; }
   const std::vector<DataTable*>& data_tables() const { return data_tables_; }
 
-  void set_data_tables(std::vector<DataTable*> data_tables) {
-    data_tables_ = std::move(data_tables);
-  }
+  /**
+   * The data tables that were appended to since they were last consumed empty by PushData().
+   * The other tables hold no records, so there is nothing to push or check for them.
+   */
+  const std::vector<DataTable*>& dirty_tables() const { return dirty_tables_; }
+
+  void set_data_tables(std::vector<DataTable*> data_tables);
 
  protected:
   explicit SourceConnector(std::string_view source_name,
@@ -162,7 +204,14 @@ class SourceConnector : public NotCopyable {
   FrequencyManager sampling_freq_mgr_;
   FrequencyManager push_freq_mgr_;
 
+  // Set by sources that measure their load, see transfer_load().
+  double transfer_load_ = -1;
+
+  DegradationLevel degradation_level_ = DegradationLevel::kNone;
+  bool memory_pressure_ = false;
+
   std::vector<DataTable*> data_tables_;
+  std::vector<DataTable*> dirty_tables_;
 
   // Debug members.
   int debug_level_ = 0;
@@ -179,6 +228,11 @@ class BCCSourceConnector : public SourceConnector {
  public:
   bpf_tools::BCCWrapper& BCC() { return *bcc_; }
 
+  // Waits on the perf buffers, which also drains them into the source's callbacks.
+  bool WaitForData(std::chrono::milliseconds timeout) override {
+    return bcc_->WaitForPerfBuffers(timeout.count());
+  }
+
  protected:
   explicit BCCSourceConnector(std::string_view source_name,
                               const ArrayView<DataTableSchema>& table_schemas)
@@ -16,6 +16,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <limits>
+
 #include <absl/strings/str_split.h>
 
 #include "src/common/testing/testing.h"
@@ -82,5 +84,87 @@ TEST_F(SourceToTableTest, source_to_table) {
   }
 }
 
+// Untabletized data goes to the sink of the table once the factory resolves one,
+// instead of the push callback.
+TEST_F(SourceToTableTest, push_data_to_sink) {
+  EXPECT_OK(source_->Init());
+  source_->set_data_tables({table_.get(), nullptr});
+  SystemWideStandaloneContext ctx;
+
+  int num_callback_pushes = 0;
+  auto push_callback = [&](uint32_t, types::TabletID,
+                           std::unique_ptr<types::ColumnWrapperRecordBatch>) {
+    ++num_callback_pushes;
+    return Status::OK();
+  };
+
+  bool sink_available = false;
+  int num_sink_pushes = 0;
+  int num_sink_lookups = 0;
+  auto sink_factory = [&](uint32_t table_id) -> DataPushSink {
+    EXPECT_EQ(table_id, table_->id());
+    ++num_sink_lookups;
+    if (!sink_available) {
+      return nullptr;
+    }
+    return [&](std::unique_ptr<types::ColumnWrapperRecordBatch> record_batch) {
+      EXPECT_EQ(record_batch->at(0)->Size(), 1U);
+      ++num_sink_pushes;
+      return Status::OK();
+    };
+  };
+
+  source_->TransferData(&ctx);
+  source_->PushData(push_callback, sink_factory);
+  EXPECT_EQ(num_callback_pushes, 1);
+  EXPECT_EQ(num_sink_pushes, 0);
+
+  sink_available = true;
+  for (int i = 0; i < 2; ++i) {
+    source_->TransferData(&ctx);
+    source_->PushData(push_callback, sink_factory);
+  }
+  EXPECT_EQ(num_callback_pushes, 1);
+  EXPECT_EQ(num_sink_pushes, 2);
+  EXPECT_EQ(num_sink_lookups, 2);
+}
+
+// PushData() only visits the tables that were appended to, and keeps the ones that still hold
+// records past their cutoff time.
+TEST_F(SourceToTableTest, push_data_dirty_tables) {
+  EXPECT_OK(source_->Init());
+  source_->set_data_tables({table_.get(), nullptr});
+  SystemWideStandaloneContext ctx;
+
+  int num_pushes = 0;
+  auto push_callback = [&](uint32_t, types::TabletID,
+                           std::unique_ptr<types::ColumnWrapperRecordBatch>) {
+    ++num_pushes;
+    return Status::OK();
+  };
+
+  EXPECT_TRUE(source_->dirty_tables().empty());
+
+  source_->TransferData(&ctx);
+  EXPECT_THAT(source_->dirty_tables(), ::testing::ElementsAre(table_.get()));
+  source_->TransferData(&ctx);
+  EXPECT_EQ(source_->dirty_tables().size(), 1U);
+
+  // The records are past the cutoff time, so they remain buffered and the table stays dirty.
+  table_->SetConsumeRecordsCutoffTime(0);
+  source_->PushData(push_callback);
+  EXPECT_EQ(num_pushes, 0);
+  EXPECT_THAT(source_->dirty_tables(), ::testing::ElementsAre(table_.get()));
+
+  table_->SetConsumeRecordsCutoffTime(std::numeric_limits<uint64_t>::max() - 1);
+  source_->PushData(push_callback);
+  EXPECT_EQ(num_pushes, 1);
+  EXPECT_TRUE(source_->dirty_tables().empty());
+
+  // Nothing was appended, so there is nothing to push.
+  source_->PushData(push_callback);
+  EXPECT_EQ(num_pushes, 1);
+}
+
 }  // namespace stirling
 }  // namespace px
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <functional>
 #include <limits>
 #include <map>
 #include <memory>
@@ -25,6 +26,8 @@
 #include <utility>
 #include <vector>
 
+#include <arrow/array.h>
+
 #include "src/shared/metadata/metadata_state.h"
 #include "src/shared/types/column_wrapper.h"
 #include "src/shared/types/type_utils.h"
@@ -36,6 +39,34 @@ namespace stirling {
 using DataPushCallback = std::function<Status(uint32_t, types::TabletID,
                                               std::unique_ptr<types::ColumnWrapperRecordBatch>)>;
 
+/**
+ * Appends data to the untabletized destination of one table, bound ahead of time so that pushes
+ * skip the lookups of DataPushCallback.
+ */
+using DataPushSink = std::function<Status(std::unique_ptr<types::ColumnWrapperRecordBatch>)>;
+
+/**
+ * Returns the sink of the table with the given ID, or an empty function if it has none (yet),
+ * in which case its data goes through the DataPushCallback.
+ */
+using DataPushSinkFactory = std::function<DataPushSink(uint32_t)>;
+
+/**
+ * The columns of a record batch, in the Arrow format of the table store.
+ */
+using ArrowRecordBatch = std::vector<std::shared_ptr<arrow::Array>>;
+
+/**
+ * Like DataPushSink, for the tables that buffer their records in Arrow builders
+ * (see --stirling_data_table_arrow_buffers), so that their batches are stored as they are.
+ */
+using ArrowDataPushSink = std::function<Status(ArrowRecordBatch)>;
+
+/**
+ * Like DataPushSinkFactory, for ArrowDataPushSink.
+ */
+using ArrowDataPushSinkFactory = std::function<ArrowDataPushSink(uint32_t)>;
+
 using AgentMetadataType = std::shared_ptr<const px::md::AgentMetadataState>;
 
 /**
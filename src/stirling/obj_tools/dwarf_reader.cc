@@ -19,12 +19,15 @@
 #include <llvm/BinaryFormat/Dwarf.h>
 #include <llvm/Config/llvm-config.h>
 #include <llvm/DebugInfo/DWARF/DWARFExpression.h>
+#include <llvm/Demangle/Demangle.h>
+#include <llvm/Support/Endian.h>
 #include <llvm/Support/ScopedPrinter.h>
 
 #include "src/stirling/obj_tools/dwarf_reader.h"
 
 #include <absl/container/flat_hash_set.h>
 #include <algorithm>
+#include <cctype>
 
 #include <llvm/DebugInfo/DIContext.h>
 #include <llvm/Object/ObjectFile.h>
@@ -89,8 +92,9 @@ StatusOr<std::unique_ptr<DwarfReader>> DwarfReader::CreateWithoutIndexing(
     return error::Internal("Could not create DWARFContext.");
   }
 
+  std::unique_ptr<llvm::DWARFContext> dwarf_context = DWARFContext::create(*obj_file);
   auto dwarf_reader = std::unique_ptr<DwarfReader>(
-      new DwarfReader(std::move(buffer), DWARFContext::create(*obj_file)));
+      new DwarfReader(std::move(buffer), std::move(bin_or_err.get()), std::move(dwarf_context)));
 
   PX_RETURN_IF_ERROR(dwarf_reader->DetectSourceLanguage());
 
@@ -111,9 +115,19 @@ StatusOr<std::unique_ptr<DwarfReader>> DwarfReader::CreateWithSelectiveIndexing(
   return dwarf_reader;
 }
 
+StatusOr<std::unique_ptr<DwarfReader>> DwarfReader::CreateWithLazyIndexing(
+    const std::filesystem::path& path) {
+  PX_ASSIGN_OR_RETURN(auto dwarf_reader, CreateWithoutIndexing(path));
+  dwarf_reader->lazy_indexing_ = true;
+  return dwarf_reader;
+}
+
 DwarfReader::DwarfReader(std::unique_ptr<llvm::MemoryBuffer> buffer,
+                         std::unique_ptr<llvm::object::Binary> binary,
                          std::unique_ptr<llvm::DWARFContext> dwarf_context)
-    : memory_buffer_(std::move(buffer)), dwarf_context_(std::move(dwarf_context)) {
+    : memory_buffer_(std::move(buffer)),
+      binary_(std::move(binary)),
+      dwarf_context_(std::move(dwarf_context)) {
   // Only very first call will actually perform initialization.
   InitLLVMOnce();
 }
@@ -188,68 +202,85 @@ Status DwarfReader::DetectSourceLanguage() {
 
 void DwarfReader::IndexDIEs(
     const std::optional<std::vector<SymbolSearchPattern>>& symbol_search_patterns_opt) {
-  absl::flat_hash_map<const llvm::DWARFDebugInfoEntry*, std::string> dwarf_entry_names;
-
   // Map from DW_AT_specification to DIE. Only DW_TAG_subprogram can have this attribute.
   // Also only applies to CPP binaries.
   absl::flat_hash_map<uint64_t, DWARFDie> fn_spec_offsets;
 
   DWARFContext::unit_iterator_range units = dwarf_context_->normal_units();
   for (const std::unique_ptr<llvm::DWARFUnit>& unit : units) {
-    for (const llvm::DWARFDebugInfoEntry& entry : unit->dies()) {
-      DWARFDie die = {unit.get(), &entry};
+    IndexUnit(unit.get(), symbol_search_patterns_opt, &fn_spec_offsets);
+  }
 
-      if (die.isSubprogramDIE()) {
-        auto spec_or =
-            AdaptLLVMOptional(llvm::dwarf::toReference(die.find(llvm::dwarf::DW_AT_specification)),
-                              "Could not find attribute DW_AT_specification");
-        if (spec_or.ok()) {
-          fn_spec_offsets[spec_or.ValueOrDie()] = die;
-        }
-      }
+  ResolveFunctionSpecifications(fn_spec_offsets);
+}
 
-      // TODO(oazizi/yzhao): Change to use the demangled name of DW_AT_linkage_name as the key to
-      // index the function DIE. That removes the need of using manually-assembled names (through
-      // parent DIE).
+void DwarfReader::IndexUnit(
+    llvm::DWARFUnit* unit,
+    const std::optional<std::vector<SymbolSearchPattern>>& symbol_search_patterns_opt,
+    absl::flat_hash_map<uint64_t, DWARFDie>* fn_spec_offsets) {
+  // Parent DIEs always belong to the same unit, so the names can be assembled per unit.
+  absl::flat_hash_map<const llvm::DWARFDebugInfoEntry*, std::string> dwarf_entry_names;
 
-      auto name = std::string(GetShortName(die));
+  for (const llvm::DWARFDebugInfoEntry& entry : unit->dies()) {
+    DWARFDie die = {unit, &entry};
 
-      if (name.empty()) {
-        continue;
+    if (die.isSubprogramDIE()) {
+      auto spec_or =
+          AdaptLLVMOptional(llvm::dwarf::toReference(die.find(llvm::dwarf::DW_AT_specification)),
+                            "Could not find attribute DW_AT_specification");
+      if (spec_or.ok()) {
+        (*fn_spec_offsets)[spec_or.ValueOrDie()] = die;
       }
+    }
 
-      // Only check matching if patterns are provided.
-      if (symbol_search_patterns_opt.has_value() &&
-          !MatchesSymbolAny(name, symbol_search_patterns_opt.value())) {
-        continue;
-      }
+    // TODO(oazizi/yzhao): Change to use the demangled name of DW_AT_linkage_name as the key to
+    // index the function DIE. That removes the need of using manually-assembled names (through
+    // parent DIE).
 
-      llvm::dwarf::Tag tag = die.getTag();
+    auto name = std::string(GetShortName(die));
 
-      if (IsIndexedType(tag) ||
-          // Namespace entry is processed here so that the name components can be generated.
-          IsNamespace(tag)) {
-        llvm::DWARFDie parent_die = die.getParent();
+    if (name.empty()) {
+      continue;
+    }
+
+    // Only check matching if patterns are provided.
+    if (symbol_search_patterns_opt.has_value() &&
+        !MatchesSymbolAny(name, symbol_search_patterns_opt.value())) {
+      continue;
+    }
 
-        if (parent_die.isValid()) {
-          const llvm::DWARFDebugInfoEntry* entry = parent_die.getDebugInfoEntry();
+    llvm::dwarf::Tag tag = die.getTag();
 
-          if (entry != nullptr) {
-            auto iter = dwarf_entry_names.find(entry);
-            if (iter != dwarf_entry_names.end()) {
-              std::string_view parent_name = iter->second;
-              name = absl::StrCat(parent_name, "::", name);
-            }
+    if (IsIndexedType(tag) ||
+        // Namespace entry is processed here so that the name components can be generated.
+        IsNamespace(tag)) {
+      llvm::DWARFDie parent_die = die.getParent();
+
+      if (parent_die.isValid()) {
+        const llvm::DWARFDebugInfoEntry* entry = parent_die.getDebugInfoEntry();
+
+        if (entry != nullptr) {
+          auto iter = dwarf_entry_names.find(entry);
+          if (iter != dwarf_entry_names.end()) {
+            std::string_view parent_name = iter->second;
+            name = absl::StrCat(parent_name, "::", name);
           }
-          dwarf_entry_names[die.getDebugInfoEntry()] = name;
         }
+        dwarf_entry_names[die.getDebugInfoEntry()] = name;
+      }
 
-        if (IsIndexedType(tag)) {
-          InsertToDIEMap(std::move(name), tag, die);
-        }
+      if (IsIndexedType(tag)) {
+        InsertToDIEMap(std::move(name), tag, die);
       }
     }
   }
+}
+
+void DwarfReader::ResolveFunctionSpecifications(
+    const absl::flat_hash_map<uint64_t, DWARFDie>& fn_spec_offsets) {
+  if (fn_spec_offsets.empty()) {
+    return;
+  }
 
   auto& fn_dies = die_map_[llvm::dwarf::DW_TAG_subprogram];
 
@@ -264,13 +295,233 @@ void DwarfReader::IndexDIEs(
   }
 }
 
+namespace {
+
+// Looks up a symbol in a .gdb_index section, and returns the .debug_info offsets of the compile
+// units that the index attributes it to. Returns nothing if the section is absent or malformed.
+// Format: https://sourceware.org/gdb/onlinedocs/gdb/Index-Section-Format.html
+std::vector<uint64_t> LookupGdbIndex(llvm::StringRef section, std::string_view name) {
+  using llvm::support::endian::read32le;
+  using llvm::support::endian::read64le;
+
+  constexpr size_t kHeaderSize = 6 * sizeof(uint32_t);
+  constexpr size_t kCUEntrySize = 2 * sizeof(uint64_t);
+  constexpr size_t kSlotSize = 2 * sizeof(uint32_t);
+  constexpr uint32_t kCUIndexMask = (1 << 24) - 1;
+
+  std::vector<uint64_t> cu_offsets;
+
+  if (section.size() < kHeaderSize) {
+    return cu_offsets;
+  }
+  const uint8_t* data = section.bytes_begin();
+
+  // Older versions use a different symbol hash function.
+  const uint32_t version = read32le(data);
+  if (version < 7) {
+    return cu_offsets;
+  }
+  const uint32_t cu_list_offset = read32le(data + 4);
+  const uint32_t types_cu_list_offset = read32le(data + 8);
+  const uint32_t symbol_table_offset = read32le(data + 16);
+  const uint32_t constant_pool_offset = read32le(data + 20);
+  if (cu_list_offset > types_cu_list_offset || symbol_table_offset > constant_pool_offset ||
+      constant_pool_offset > section.size()) {
+    return cu_offsets;
+  }
+
+  const uint32_t num_cus = (types_cu_list_offset - cu_list_offset) / kCUEntrySize;
+  const uint32_t num_slots = (constant_pool_offset - symbol_table_offset) / kSlotSize;
+  if (num_slots == 0 || (num_slots & (num_slots - 1)) != 0) {
+    return cu_offsets;
+  }
+  const uint32_t mask = num_slots - 1;
+
+  uint32_t hash = 0;
+  for (char c : name) {
+    hash = hash * 67 + std::tolower(static_cast<unsigned char>(c)) - 113;
+  }
+  const uint32_t step = ((hash * 17) & mask) | 1;
+
+  llvm::StringRef constant_pool = section.drop_front(constant_pool_offset);
+
+  uint32_t slot = hash & mask;
+  for (uint32_t i = 0; i < num_slots; ++i, slot = (slot + step) & mask) {
+    const uint8_t* slot_data = data + symbol_table_offset + slot * kSlotSize;
+    const uint32_t name_offset = read32le(slot_data);
+    const uint32_t cu_vector_offset = read32le(slot_data + 4);
+    if (name_offset == 0 && cu_vector_offset == 0) {
+      // Empty slot: the symbol is not in the index.
+      break;
+    }
+    if (name_offset >= constant_pool.size() ||
+        cu_vector_offset + sizeof(uint32_t) > constant_pool.size()) {
+      break;
+    }
+
+    llvm::StringRef slot_name = constant_pool.drop_front(name_offset);
+    slot_name = slot_name.substr(0, slot_name.find('\0'));
+    if (slot_name != llvm::StringRef(name.data(), name.size())) {
+      continue;
+    }
+
+    const uint8_t* cu_vector = constant_pool.bytes_begin() + cu_vector_offset;
+    const uint32_t count = read32le(cu_vector);
+    if (cu_vector_offset + (1 + uint64_t{count}) * sizeof(uint32_t) > constant_pool.size()) {
+      break;
+    }
+    for (uint32_t j = 0; j < count; ++j) {
+      // The upper bits hold symbol attributes. Indexes past the CU list refer to type units.
+      const uint32_t cu_index = read32le(cu_vector + (1 + j) * sizeof(uint32_t)) & kCUIndexMask;
+      if (cu_index < num_cus) {
+        cu_offsets.push_back(read64le(data + cu_list_offset + cu_index * kCUEntrySize));
+      }
+    }
+    break;
+  }
+
+  return cu_offsets;
+}
+
+// Accelerator tables key DIEs by DW_AT_name, which excludes the enclosing scopes.
+std::string_view ShortName(std::string_view name) {
+  size_t pos = name.rfind("::");
+  return pos == std::string_view::npos ? name : name.substr(pos + 2);
+}
+
+}  // namespace
+
+const absl::flat_hash_map<std::string, uint64_t>& DwarfReader::ELFFunctionAddrs() {
+  if (elf_function_addrs_.has_value()) {
+    return elf_function_addrs_.value();
+  }
+  elf_function_addrs_.emplace();
+
+  const llvm::object::ObjectFile* obj_file = dwarf_context_->getDWARFObj().getFile();
+  if (obj_file == nullptr) {
+    return elf_function_addrs_.value();
+  }
+
+  for (const llvm::object::SymbolRef& sym : obj_file->symbols()) {
+    llvm::Expected<llvm::object::SymbolRef::Type> type = sym.getType();
+    if (!type || type.get() != llvm::object::SymbolRef::ST_Function) {
+      llvm::consumeError(type.takeError());
+      continue;
+    }
+    llvm::Expected<llvm::StringRef> name = sym.getName();
+    llvm::Expected<uint64_t> addr = sym.getAddress();
+    if (!name || !addr || addr.get() == 0) {
+      llvm::consumeError(name.takeError());
+      llvm::consumeError(addr.takeError());
+      continue;
+    }
+
+    std::string fn_name = name.get().str();
+    if (absl::StartsWith(fn_name, "_Z")) {
+      // Match the names assembled by IndexUnit(), which carry no parameter list.
+      fn_name = llvm::demangle(fn_name);
+      fn_name.erase(std::min(fn_name.find('('), fn_name.size()));
+    }
+    elf_function_addrs_->try_emplace(std::move(fn_name), addr.get());
+  }
+
+  return elf_function_addrs_.value();
+}
+
+std::vector<llvm::DWARFUnit*> DwarfReader::FindCandidateUnits(const std::string& name,
+                                                              llvm::dwarf::Tag tag) {
+  std::vector<llvm::DWARFUnit*> units;
+  auto add_unit_at_offset = [this, &units](uint64_t offset) {
+    llvm::DWARFUnit* unit = dwarf_context_->getCompileUnitForOffset(offset);
+    if (unit != nullptr) {
+      units.push_back(unit);
+    }
+  };
+
+  std::string_view short_name = ShortName(name);
+  for (const auto& entry : dwarf_context_->getDebugNames().equal_range(
+           llvm::StringRef(short_name.data(), short_name.size()))) {
+    if (entry.tag() != tag) {
+      continue;
+    }
+    auto cu_offset = entry.getCUOffset();
+    if (cu_offset) {
+      add_unit_at_offset(*cu_offset);
+    }
+  }
+
+  llvm::StringRef gdb_index = dwarf_context_->getDWARFObj().getGdbIndexSection();
+  for (uint64_t offset : LookupGdbIndex(gdb_index, name)) {
+    add_unit_at_offset(offset);
+  }
+
+  if (tag == llvm::dwarf::DW_TAG_subprogram) {
+    const auto& fn_addrs = ELFFunctionAddrs();
+    auto iter = fn_addrs.find(name);
+    if (iter != fn_addrs.end()) {
+#if LLVM_VERSION_MAJOR >= 16
+      llvm::DWARFUnit* unit = dwarf_context_->getCompileUnitForCodeAddress(iter->second);
+#else
+      llvm::DWARFUnit* unit = dwarf_context_->getCompileUnitForAddress(iter->second);
+#endif
+      if (unit != nullptr) {
+        units.push_back(unit);
+      }
+    }
+  }
+
+  return units;
+}
+
+bool DwarfReader::LazyIndexUnit(llvm::DWARFUnit* unit) {
+  if (!indexed_units_.insert(unit).second) {
+    return false;
+  }
+  IndexUnit(unit, std::nullopt, &fn_spec_offsets_);
+  return true;
+}
+
+void DwarfReader::IndexUnitsContaining(const std::string& name, llvm::dwarf::Tag tag) {
+  if (all_units_indexed_) {
+    return;
+  }
+
+  bool indexed_any = false;
+  for (llvm::DWARFUnit* unit : FindCandidateUnits(name, tag)) {
+    indexed_any |= LazyIndexUnit(unit);
+  }
+  if (indexed_any) {
+    ResolveFunctionSpecifications(fn_spec_offsets_);
+    if (FindInDIEMap(name, tag).has_value()) {
+      return;
+    }
+  }
+
+  // No accelerator table or ELF symbol located the symbol, so fall back to indexing the remaining
+  // units in order, stopping as soon as the symbol is found.
+  for (const std::unique_ptr<llvm::DWARFUnit>& unit : dwarf_context_->normal_units()) {
+    if (LazyIndexUnit(unit.get()) && FindInDIEMap(name, tag).has_value()) {
+      ResolveFunctionSpecifications(fn_spec_offsets_);
+      return;
+    }
+  }
+  all_units_indexed_ = true;
+  ResolveFunctionSpecifications(fn_spec_offsets_);
+}
+
 StatusOr<std::vector<DWARFDie>> DwarfReader::GetMatchingDIEs(
     std::string_view name, std::optional<llvm::dwarf::Tag> type_opt) {
   DCHECK(dwarf_context_ != nullptr);
 
   // Special case for types that are indexed.
-  if (type_opt.has_value() && IsIndexedType(type_opt.value()) && !die_map_.empty()) {
-    auto die_opt = FindInDIEMap(std::string(name), type_opt.value());
+  if (type_opt.has_value() && IsIndexedType(type_opt.value()) &&
+      (lazy_indexing_ || !die_map_.empty())) {
+    std::string name_str(name);
+    auto die_opt = FindInDIEMap(name_str, type_opt.value());
+    if (!die_opt.has_value() && lazy_indexing_) {
+      IndexUnitsContaining(name_str, type_opt.value());
+      die_opt = FindInDIEMap(name_str, type_opt.value());
+    }
     if (die_opt.has_value()) {
       return std::vector<DWARFDie>{die_opt.value()};
     }
@@ -19,9 +19,11 @@
 #pragma once
 
 #include <llvm/DebugInfo/DWARF/DWARFContext.h>
+#include <llvm/Object/Binary.h>
 #include <llvm/Support/TargetSelect.h>
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
 
 #include <filesystem>
 #include <limits>
@@ -150,9 +152,18 @@ class DwarfReader {
   /**
    * Creates a DwarfReader that provides access to DWARF Debugging information entries (DIEs).
    * @param obj_filename The object file from which to read DWARF information.
-   * @param index If true, creates an index to speed up accesses when called more than once.
    * @return error if file does not exist or is not a valid object file. Otherwise returns
    * a unique pointer to a DwarfReader.
+   *
+   * The variants differ in how struct, class and function DIEs are indexed:
+   *  - CreateWithoutIndexing: no index; every lookup scans all DIEs.
+   *  - CreateIndexingAll: indexes all DIEs up front.
+   *  - CreateWithSelectiveIndexing: indexes up front only the DIEs matching the patterns.
+   *  - CreateWithLazyIndexing: indexes compile units on demand, as lookups need them.
+   *    The units holding a symbol are located with the .debug_names or .gdb_index accelerator
+   *    tables when present, and with the ELF symbol table for functions. Remaining units are only
+   *    indexed when those do not resolve the symbol. This is much cheaper than CreateIndexingAll
+   *    when only a handful of symbols are looked up in a large binary.
    */
   static StatusOr<std::unique_ptr<DwarfReader>> CreateWithoutIndexing(
       const std::filesystem::path& path);
@@ -160,6 +171,8 @@ class DwarfReader {
       const std::filesystem::path& path);
   static StatusOr<std::unique_ptr<DwarfReader>> CreateWithSelectiveIndexing(
       const std::filesystem::path& path, const std::vector<SymbolSearchPattern>& symbol_patterns);
+  static StatusOr<std::unique_ptr<DwarfReader>> CreateWithLazyIndexing(
+      const std::filesystem::path& path);
 
   /**
    * Searches the debug information for Debugging information entries (DIEs)
@@ -296,6 +309,7 @@ class DwarfReader {
 
  private:
   DwarfReader(std::unique_ptr<llvm::MemoryBuffer> buffer,
+              std::unique_ptr<llvm::object::Binary> binary,
               std::unique_ptr<llvm::DWARFContext> dwarf_context);
 
   // Detects the source language of the dwarf content being read.
@@ -308,6 +322,29 @@ class DwarfReader {
   // Otherwise, only the ones whose names match are indexed.
   void IndexDIEs(const std::optional<std::vector<SymbolSearchPattern>>& symbol_search_patterns_opt);
 
+  // Indexes the DIEs of a single unit. Subprogram DIEs with DW_AT_specification are collected
+  // into fn_spec_offsets, to be applied by ResolveFunctionSpecifications().
+  void IndexUnit(llvm::DWARFUnit* unit,
+                 const std::optional<std::vector<SymbolSearchPattern>>& symbol_search_patterns_opt,
+                 absl::flat_hash_map<uint64_t, llvm::DWARFDie>* fn_spec_offsets);
+
+  // Replaces indexed function declaration DIEs with their DW_AT_specification definitions.
+  void ResolveFunctionSpecifications(
+      const absl::flat_hash_map<uint64_t, llvm::DWARFDie>& fn_spec_offsets);
+
+  // For lazy indexing: indexes units until the symbol is in die_map_, or all units are indexed.
+  void IndexUnitsContaining(const std::string& name, llvm::dwarf::Tag tag);
+
+  // For lazy indexing: indexes the unit if not already done. Returns true if it was indexed now.
+  bool LazyIndexUnit(llvm::DWARFUnit* unit);
+
+  // Returns the units that the accelerator tables or ELF symbols attribute the symbol to.
+  std::vector<llvm::DWARFUnit*> FindCandidateUnits(const std::string& name, llvm::dwarf::Tag tag);
+
+  // Returns a map from function names (demangled, without parameters) to their ELF addresses.
+  // Built on first use.
+  const absl::flat_hash_map<std::string, uint64_t>& ELFFunctionAddrs();
+
   // Walks the struct_die for all members, recursively visiting any members which are also structs,
   // to capture information of all base type members of the struct in a flattened form.
   // See GetStructSpec() for the public interface, and the output format.
@@ -324,10 +361,19 @@ class DwarfReader {
   std::string compiler_;
 
   std::unique_ptr<llvm::MemoryBuffer> memory_buffer_;
+  // The DWARFContext refers to the object file, so it must be kept alive.
+  std::unique_ptr<llvm::object::Binary> binary_;
   std::unique_ptr<llvm::DWARFContext> dwarf_context_;
 
   // Nested map: [tag][symbol_name] -> DWARFDie
   absl::flat_hash_map<llvm::dwarf::Tag, absl::flat_hash_map<std::string, llvm::DWARFDie>> die_map_;
+
+  // State of lazy indexing. Unused by the other modes.
+  bool lazy_indexing_ = false;
+  bool all_units_indexed_ = false;
+  absl::flat_hash_set<const llvm::DWARFUnit*> indexed_units_;
+  absl::flat_hash_map<uint64_t, llvm::DWARFDie> fn_spec_offsets_;
+  std::optional<absl::flat_hash_map<std::string, uint64_t>> elf_function_addrs_;
 };
 
 }  // namespace obj_tools
@@ -19,6 +19,7 @@
 #include <benchmark/benchmark.h>
 
 #include "src/common/base/base.h"
+#include "src/common/fs/fs_wrapper.h"
 #include "src/common/testing/test_environment.h"
 #include "src/stirling/obj_tools/dwarf_reader.h"
 
@@ -71,6 +72,28 @@ void GetSymAddrs(DwarfReader* dwarf_reader, SymAddrs* symaddrs) {
               "Fields");
 }
 
+// Functions and classes looked up in the large binary, which is this benchmark itself.
+// Its DWARF information includes all of LLVM, so building a full index is expensive.
+constexpr std::string_view kLargeBinaryFunctions[] = {
+    "px::stirling::obj_tools::DwarfReader::GetMatchingDIEs",
+    "px::stirling::obj_tools::DwarfReader::GetStructMemberInfo",
+    "px::stirling::obj_tools::DwarfReader::GetFunctionArgInfo",
+};
+constexpr std::string_view kLargeBinaryClasses[] = {
+    "px::stirling::obj_tools::DwarfReader",
+};
+
+void LookupLargeBinarySymbols(DwarfReader* dwarf_reader) {
+  for (std::string_view fn : kLargeBinaryFunctions) {
+    auto dies = dwarf_reader->GetMatchingDIEs(fn, llvm::dwarf::DW_TAG_subprogram);
+    benchmark::DoNotOptimize(dies);
+  }
+  for (std::string_view cls : kLargeBinaryClasses) {
+    auto dies = dwarf_reader->GetMatchingDIEs(cls, llvm::dwarf::DW_TAG_class_type);
+    benchmark::DoNotOptimize(dies);
+  }
+}
+
 // NOLINTNEXTLINE : runtime/references.
 static void BM_noindex(benchmark::State& state) {
   size_t num_lookup_iterations = state.range(0);
@@ -105,5 +128,56 @@ static void BM_indexed(benchmark::State& state) {
   }
 }
 
+// NOLINTNEXTLINE : runtime/references.
+static void BM_lazy_indexed(benchmark::State& state) {
+  size_t num_lookup_iterations = state.range(0);
+
+  for (auto _ : state) {
+    SymAddrs symaddrs;
+
+    PX_ASSIGN_OR_EXIT(std::unique_ptr<DwarfReader> dwarf_reader,
+                      DwarfReader::CreateWithLazyIndexing(kBinary));
+
+    for (size_t i = 0; i < num_lookup_iterations; ++i) {
+      GetSymAddrs(dwarf_reader.get(), &symaddrs);
+      benchmark::DoNotOptimize(symaddrs);
+    }
+  }
+}
+
+template <typename TCreateFn>
+void BenchmarkLargeBinary(benchmark::State& state, TCreateFn create_fn) {
+  PX_ASSIGN_OR_EXIT(std::filesystem::path self_path, ::px::fs::ReadSymlink("/proc/self/exe"));
+
+  for (auto _ : state) {
+    auto dwarf_reader_or = create_fn(self_path);
+    if (!dwarf_reader_or.ok()) {
+      state.SkipWithError("Benchmark binary has no DWARF information; build with debug info.");
+      return;
+    }
+    std::unique_ptr<DwarfReader> dwarf_reader = dwarf_reader_or.ConsumeValueOrDie();
+    LookupLargeBinarySymbols(dwarf_reader.get());
+  }
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_large_binary_noindex(benchmark::State& state) {
+  BenchmarkLargeBinary(state, DwarfReader::CreateWithoutIndexing);
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_large_binary_indexed(benchmark::State& state) {
+  BenchmarkLargeBinary(state, DwarfReader::CreateIndexingAll);
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_large_binary_lazy_indexed(benchmark::State& state) {
+  BenchmarkLargeBinary(state, DwarfReader::CreateWithLazyIndexing);
+}
+
 BENCHMARK(BM_noindex)->RangeMultiplier(2)->Range(1, 16);
 BENCHMARK(BM_indexed)->RangeMultiplier(2)->Range(1, 16);
+BENCHMARK(BM_lazy_indexed)->RangeMultiplier(2)->Range(1, 16);
+BENCHMARK(BM_large_binary_noindex)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_large_binary_indexed)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_large_binary_lazy_indexed)->Unit(benchmark::kMillisecond);
@@ -64,14 +64,21 @@ using ::testing::UnorderedElementsAre;
 // Automatically converts ToString() to stream operator for gtest.
 using ::px::operator<<;
 
+enum class IndexMode { kNone, kAll, kLazy };
+
 struct DwarfReaderTestParam {
   std::string binary_path;
-  bool index;
+  IndexMode index;
 };
 
-auto CreateDwarfReader(const std::filesystem::path& path, bool indexing) {
-  if (indexing) {
-    return DwarfReader::CreateIndexingAll(path);
+auto CreateDwarfReader(const std::filesystem::path& path, IndexMode index) {
+  switch (index) {
+    case IndexMode::kAll:
+      return DwarfReader::CreateIndexingAll(path);
+    case IndexMode::kLazy:
+      return DwarfReader::CreateWithLazyIndexing(path);
+    case IndexMode::kNone:
+      break;
   }
   return DwarfReader::CreateWithoutIndexing(path);
 }
@@ -108,7 +115,7 @@ class GolangDwarfReaderTest : public ::testing::TestWithParam<DwarfReaderTestPar
   std::unique_ptr<DwarfReader> dwarf_reader;
 };
 
-class GolangDwarfReaderIndexTest : public ::testing::TestWithParam<bool> {
+class GolangDwarfReaderIndexTest : public ::testing::TestWithParam<IndexMode> {
   std::unique_ptr<DwarfReader> dwarf_reader;
 };
 
@@ -520,7 +527,7 @@ TEST_P(GolangDwarfReaderTest, DISABLED_FunctionVarLocationConsistency) {
 
 // Inspired from a real life case.
 TEST_P(GolangDwarfReaderIndexTest, UnconventionalGetStructMemberOffset) {
-  bool index = GetParam();
+  IndexMode index = GetParam();
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
                        CreateDwarfReader(kGoBinaryUnconventionalPath, index));
 
@@ -528,7 +535,7 @@ TEST_P(GolangDwarfReaderIndexTest, UnconventionalGetStructMemberOffset) {
 }
 
 TEST_P(GolangDwarfReaderIndexTest, FunctionArgInfo) {
-  bool index = GetParam();
+  IndexMode index = GetParam();
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
                        CreateDwarfReader(kGoServerBinaryPath, index));
 
@@ -558,24 +565,32 @@ TEST_P(GolangDwarfReaderIndexTest, FunctionArgInfo) {
                        true})));
 }
 
-INSTANTIATE_TEST_SUITE_P(CppDwarfReaderParameterizedTest, CppDwarfReaderTest,
-                         ::testing::Values(DwarfReaderTestParam{kCPPBinaryPath, true},
-                                           DwarfReaderTestParam{kCPPBinaryPath, false}));
-
-INSTANTIATE_TEST_SUITE_P(GolangDwarfReaderParameterizedTest, GolangDwarfReaderTest,
-                         ::testing::Values(DwarfReaderTestParam{kGo1_17BinaryPath, true},
-                                           DwarfReaderTestParam{kGo1_17BinaryPath, false},
-                                           DwarfReaderTestParam{kGo1_18BinaryPath, true},
-                                           DwarfReaderTestParam{kGo1_18BinaryPath, false},
-                                           DwarfReaderTestParam{kGo1_19BinaryPath, true},
-                                           DwarfReaderTestParam{kGo1_19BinaryPath, false},
-                                           DwarfReaderTestParam{kGo1_20BinaryPath, true},
-                                           DwarfReaderTestParam{kGo1_20BinaryPath, false},
-                                           DwarfReaderTestParam{kGo1_21BinaryPath, true},
-                                           DwarfReaderTestParam{kGo1_21BinaryPath, false}));
+INSTANTIATE_TEST_SUITE_P(
+    CppDwarfReaderParameterizedTest, CppDwarfReaderTest,
+    ::testing::Values(DwarfReaderTestParam{kCPPBinaryPath, IndexMode::kAll},
+                      DwarfReaderTestParam{kCPPBinaryPath, IndexMode::kLazy},
+                      DwarfReaderTestParam{kCPPBinaryPath, IndexMode::kNone}));
+
+INSTANTIATE_TEST_SUITE_P(
+    GolangDwarfReaderParameterizedTest, GolangDwarfReaderTest,
+    ::testing::Values(DwarfReaderTestParam{kGo1_17BinaryPath, IndexMode::kAll},
+                      DwarfReaderTestParam{kGo1_17BinaryPath, IndexMode::kLazy},
+                      DwarfReaderTestParam{kGo1_17BinaryPath, IndexMode::kNone},
+                      DwarfReaderTestParam{kGo1_18BinaryPath, IndexMode::kAll},
+                      DwarfReaderTestParam{kGo1_18BinaryPath, IndexMode::kLazy},
+                      DwarfReaderTestParam{kGo1_18BinaryPath, IndexMode::kNone},
+                      DwarfReaderTestParam{kGo1_19BinaryPath, IndexMode::kAll},
+                      DwarfReaderTestParam{kGo1_19BinaryPath, IndexMode::kLazy},
+                      DwarfReaderTestParam{kGo1_19BinaryPath, IndexMode::kNone},
+                      DwarfReaderTestParam{kGo1_20BinaryPath, IndexMode::kAll},
+                      DwarfReaderTestParam{kGo1_20BinaryPath, IndexMode::kLazy},
+                      DwarfReaderTestParam{kGo1_20BinaryPath, IndexMode::kNone},
+                      DwarfReaderTestParam{kGo1_21BinaryPath, IndexMode::kAll},
+                      DwarfReaderTestParam{kGo1_21BinaryPath, IndexMode::kLazy},
+                      DwarfReaderTestParam{kGo1_21BinaryPath, IndexMode::kNone}));
 
 INSTANTIATE_TEST_SUITE_P(GolangDwarfReaderParameterizedIndexTest, GolangDwarfReaderIndexTest,
-                         ::testing::Values(true, false));
+                         ::testing::Values(IndexMode::kAll, IndexMode::kLazy, IndexMode::kNone));
 }  // namespace obj_tools
 }  // namespace stirling
 }  // namespace px
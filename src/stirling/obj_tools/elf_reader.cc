@@ -24,6 +24,7 @@
 #include <llvm/Support/TargetSelect.h>
 
 #include <absl/container/flat_hash_set.h>
+#include <algorithm>
 #include <set>
 #include <utility>
 
@@ -81,6 +82,7 @@ Status ElfReader::LocateDebugSymbols(const std::filesystem::path& debug_file_dir
       std::string_view desc = std::string_view(psec->get_data() + desc_pos, desc_size);
 
       build_id = BytesToString<LowercaseHex>(desc);
+      build_id_ = build_id;
       VLOG(1) << absl::Substitute("Found build-id: $0", build_id);
     }
 
@@ -395,24 +397,52 @@ StatusOr<std::unique_ptr<ElfReader::Symbolizer>> ElfReader::GetSymbolizer() {
     symbols.get_symbol(j, name, addr, size, bind, type, section_index, other);
 
     if (type == ELFIO::STT_FUNC) {
-      symbolizer->AddEntry(addr, size, llvm::demangle(name));
+      symbolizer->AppendEntry(addr, size, llvm::demangle(name));
     }
   }
+  symbolizer->SortEntries();
 
   return symbolizer;
 }
 
-void ElfReader::Symbolizer::AddEntry(size_t addr, size_t size, std::string name) {
-  symbols_.emplace(addr, SymbolAddrInfo{size, std::move(name)});
+void ElfReader::Symbolizer::AppendEntry(uintptr_t addr, size_t size, std::string_view name) {
+  entries_.push_back(Entry{addr, size, static_cast<uint32_t>(names_.size()),
+                           static_cast<uint32_t>(name.size())});
+  names_.append(name);
 }
 
-std::string_view ElfReader::Symbolizer::Lookup(size_t addr) const {
-  static std::string symbol_str;
+void ElfReader::Symbolizer::SortEntries() {
+  // Stable, so that the first entry at an address is the one kept, as with AddEntry().
+  std::stable_sort(entries_.begin(), entries_.end(),
+                   [](const Entry& a, const Entry& b) { return a.addr < b.addr; });
+  auto last = std::unique(entries_.begin(), entries_.end(),
+                          [](const Entry& a, const Entry& b) { return a.addr == b.addr; });
+  entries_.erase(last, entries_.end());
+  entries_.shrink_to_fit();
+  names_.shrink_to_fit();
+}
+
+void ElfReader::Symbolizer::AddEntry(uintptr_t addr, size_t size, std::string_view name) {
+  auto iter = std::lower_bound(
+      entries_.begin(), entries_.end(), addr,
+      [](const Entry& entry, uintptr_t addr) { return entry.addr < addr; });
+  if (iter != entries_.end() && iter->addr == addr) {
+    return;
+  }
+  entries_.insert(iter, Entry{addr, size, static_cast<uint32_t>(names_.size()),
+                              static_cast<uint32_t>(name.size())});
+  names_.append(name);
+}
+
+std::string_view ElfReader::Symbolizer::Lookup(uintptr_t addr) const {
+  static thread_local std::string symbol_str;
 
   // Find the first symbol for which the address_range_start > addr.
-  auto iter = symbols_.upper_bound(addr);
+  auto iter = std::upper_bound(
+      entries_.begin(), entries_.end(), addr,
+      [](uintptr_t addr, const Entry& entry) { return addr < entry.addr; });
 
-  if (iter == symbols_.begin() || symbols_.empty()) {
+  if (iter == entries_.begin()) {
     symbol_str = absl::StrFormat("0x%016llx", addr);
     return symbol_str;
   }
@@ -420,8 +450,8 @@ std::string_view ElfReader::Symbolizer::Lookup(size_t addr) const {
   // std::upper_bound will make us overshoot our potential match,
   // so go back by one, and check if it is indeed a match.
   --iter;
-  if (addr >= iter->first && addr < iter->first + iter->second.size) {
-    return iter->second.name;
+  if (addr >= iter->addr && addr < iter->addr + iter->size) {
+    return name(*iter);
   }
 
   // Couldn't find the address.
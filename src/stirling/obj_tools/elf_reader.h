@@ -21,9 +21,9 @@
 #include <filesystem>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
-#include <absl/container/btree_map.h>
 #include <absl/container/flat_hash_map.h>
 
 #include <elfio/elfio.hpp>
@@ -55,6 +55,11 @@ class ElfReader {
 
   std::filesystem::path& debug_symbols_path() { return debug_symbols_path_; }
 
+  /**
+   * The GNU build-id of the binary, as a lowercase hex string, or empty if it has none.
+   */
+  const std::string& build_id() const { return build_id_; }
+
   struct SymbolInfo {
     std::string name;
     int type = -1;
@@ -125,27 +130,64 @@ class ElfReader {
    */
   StatusOr<std::optional<std::string>> InstrAddrToSymbol(size_t addr);
 
+  /**
+   * An address index of the function symbols: a single array of entries sorted by address,
+   * searched by binary search, with the names packed into one string.
+   */
   class Symbolizer {
    public:
     /**
      * Associate the address range [addr, addr+size] with the provided symbol name.
      * No checking is performed for overlapping regions, which will result in undefined behavior.
+     * If there already is an entry at addr, it is kept.
      */
-    void AddEntry(uintptr_t addr, size_t size, std::string name);
+    void AddEntry(uintptr_t addr, size_t size, std::string_view name);
 
     /**
      * Lookup the symbol for the specified address.
      */
     std::string_view Lookup(uintptr_t addr) const;
 
+    /**
+     * Calls fn(addr, size, name) for each entry, in increasing order of address.
+     */
+    template <typename TFn>
+    void ForEachEntry(TFn fn) const {
+      for (const Entry& entry : entries_) {
+        fn(entry.addr, entry.size, name(entry));
+      }
+    }
+
+    size_t size() const { return entries_.size(); }
+
+    /**
+     * The number of bytes held by the index.
+     */
+    size_t MemoryUsage() const {
+      return sizeof(*this) + entries_.capacity() * sizeof(Entry) + names_.capacity();
+    }
+
    private:
-    struct SymbolAddrInfo {
+    friend class ElfReader;
+
+    struct Entry {
+      uintptr_t addr;
       size_t size;
-      std::string name;
+      uint32_t name_offset;
+      uint32_t name_size;
     };
 
-    // Key is an address.
-    absl::btree_map<uintptr_t, SymbolAddrInfo> symbols_;
+    // Appends an entry without keeping the order; SortEntries() must be called once done.
+    void AppendEntry(uintptr_t addr, size_t size, std::string_view name);
+    void SortEntries();
+
+    std::string_view name(const Entry& entry) const {
+      return std::string_view(names_).substr(entry.name_offset, entry.name_size);
+    }
+
+    // Sorted by address, without duplicate addresses.
+    std::vector<Entry> entries_;
+    std::string names_;
   };
 
   StatusOr<std::unique_ptr<Symbolizer>> GetSymbolizer();
@@ -217,6 +259,8 @@ class ElfReader {
 
   std::filesystem::path debug_symbols_path_;
 
+  std::string build_id_;
+
   // Set up an elf reader, so we can extract debug symbols.
   ELFIO::elfio elf_reader_;
 };
@@ -182,6 +182,37 @@ TEST(ElfReaderTest, InstrAddrToSymbol) {
   }
 }
 
+TEST(ElfReaderTest, Symbolizer) {
+  const std::string path = kTestExeFixture.Path().string();
+  const std::string kSymbolName = "CanYouFindThis";
+  ASSERT_OK_AND_ASSIGN(const int64_t kSymbolAddr, NmSymbolNameToAddr(path, kSymbolName));
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(path));
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader::Symbolizer> symbolizer,
+                       elf_reader->GetSymbolizer());
+
+  EXPECT_EQ(symbolizer->Lookup(kSymbolAddr), kSymbolName);
+  EXPECT_EQ(symbolizer->Lookup(kSymbolAddr + 4), kSymbolName);
+  EXPECT_NE(symbolizer->Lookup(kSymbolAddr + 1000), kSymbolName);
+  EXPECT_EQ(symbolizer->Lookup(0), "0x0000000000000000");
+}
+
+TEST(ElfReaderTest, SymbolizerAddEntry) {
+  ElfReader::Symbolizer symbolizer;
+  symbolizer.AddEntry(0x2000, 0x10, "bar");
+  symbolizer.AddEntry(0x1000, 0x10, "foo");
+  symbolizer.AddEntry(0x3000, 0x10, "baz");
+  // The first entry at an address is kept.
+  symbolizer.AddEntry(0x2000, 0x20, "qux");
+
+  EXPECT_EQ(symbolizer.size(), 3);
+  EXPECT_EQ(symbolizer.Lookup(0xfff), "0x0000000000000fff");
+  EXPECT_EQ(symbolizer.Lookup(0x1000), "foo");
+  EXPECT_EQ(symbolizer.Lookup(0x200f), "bar");
+  EXPECT_EQ(symbolizer.Lookup(0x2010), "0x0000000000002010");
+  EXPECT_EQ(symbolizer.Lookup(0x3008), "baz");
+}
+
 TEST(ElfReaderTest, ExternalDebugSymbolsBuildID) {
   const std::string stripped_bin =
       px::testing::BazelRunfilePath("src/stirling/obj_tools/testdata/cc/stripped_test_exe");
@@ -191,6 +222,7 @@ TEST(ElfReaderTest, ExternalDebugSymbolsBuildID) {
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader> elf_reader,
                        ElfReader::Create(stripped_bin, debug_dir));
 
+  EXPECT_EQ(elf_reader->build_id(), "7deb0e3f89deba61");
   EXPECT_OK_AND_THAT(elf_reader->ListFuncSymbols("CanYouFindThis", SymbolMatchType::kExact),
                      ElementsAre(SymbolNameIs("CanYouFindThis")));
 }
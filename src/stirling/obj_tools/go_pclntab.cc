@@ -0,0 +1,417 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/obj_tools/go_pclntab.h"
+
+#include <optional>
+#include <utility>
+
+#include <absl/strings/str_format.h>
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+// The layout of the table is described in
+// https://github.com/golang/go/blob/go1.21.0/src/runtime/symtab.go and
+// https://github.com/golang/go/blob/go1.21.0/src/debug/gosym/pclntab.go.
+
+namespace {
+
+constexpr std::string_view kGoPclntabSection = ".gopclntab";
+// The name in position independent executables.
+constexpr std::string_view kGoPclntabPIESection = ".data.rel.ro.gopclntab";
+constexpr std::string_view kRodataSection = ".rodata";
+
+constexpr uint32_t kGo12Magic = 0xfffffffb;
+constexpr uint32_t kGo116Magic = 0xfffffffa;
+constexpr uint32_t kGo118Magic = 0xfffffff0;
+constexpr uint32_t kGo120Magic = 0xfffffff1;
+
+// Indexes in the pcdata and funcdata arrays of a _func.
+constexpr uint32_t kPCDataInlTreeIndex = 2;
+constexpr uint32_t kFuncDataInlTree = 3;
+
+// A bound on the inlining depth, in case of a corrupt table.
+constexpr int kMaxInlineDepth = 64;
+
+bool ReadUVarint(std::string_view buf, size_t* pos, uint64_t* val) {
+  *val = 0;
+  for (int shift = 0; shift < 64 && *pos < buf.size(); shift += 7) {
+    const uint8_t byte = buf[(*pos)++];
+    *val |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string_view CString(std::string_view buf, uint64_t pos) {
+  if (pos >= buf.size()) {
+    return {};
+  }
+  const size_t end = buf.find('\0', pos);
+  return buf.substr(pos, end == std::string_view::npos ? std::string_view::npos : end - pos);
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<GoPclntab>> GoPclntab::Create(ElfReader* elf_reader) {
+  auto pclntab_section_or = elf_reader->SectionWithName(kGoPclntabSection);
+  if (!pclntab_section_or.ok()) {
+    pclntab_section_or = elf_reader->SectionWithName(kGoPclntabPIESection);
+  }
+  PX_ASSIGN_OR_RETURN(ELFIO::section * pclntab_section, pclntab_section_or);
+  if (pclntab_section->get_data() == nullptr) {
+    return error::Internal("$0 has no data.", kGoPclntabSection);
+  }
+  std::string pclntab(pclntab_section->get_data(), pclntab_section->get_size());
+
+  uint64_t rodata_addr = 0;
+  std::string rodata;
+  auto rodata_section = elf_reader->SectionWithName(kRodataSection);
+  if (rodata_section.ok() && rodata_section.ValueOrDie()->get_data() != nullptr) {
+    rodata_addr = rodata_section.ValueOrDie()->get_address();
+    rodata.assign(rodata_section.ValueOrDie()->get_data(),
+                  rodata_section.ValueOrDie()->get_size());
+  }
+
+  std::optional<int64_t> gofunc_addr = elf_reader->SymbolAddress("go:func.*");
+  if (!gofunc_addr.has_value()) {
+    gofunc_addr = elf_reader->SymbolAddress("go.func.*");
+  }
+
+  return Create(std::move(pclntab), rodata_addr, std::move(rodata), gofunc_addr.value_or(0));
+}
+
+StatusOr<std::unique_ptr<GoPclntab>> GoPclntab::Create(std::string pclntab, uint64_t rodata_addr,
+                                                       std::string rodata, uint64_t gofunc_addr) {
+  auto table = std::unique_ptr<GoPclntab>(new GoPclntab());
+  table->data_ = std::move(pclntab);
+  table->rodata_addr_ = rodata_addr;
+  table->rodata_ = std::move(rodata);
+  table->gofunc_addr_ = gofunc_addr;
+  PX_RETURN_IF_ERROR(table->Init());
+  return table;
+}
+
+Status GoPclntab::Init() {
+  const std::string_view data(data_);
+  if (data.size() < 8) {
+    return error::Internal("$0 is truncated.", kGoPclntabSection);
+  }
+
+  switch (ReadUint32(data, 0)) {
+    case kGo12Magic:
+      version_ = Version::kGo12;
+      break;
+    case kGo116Magic:
+      version_ = Version::kGo116;
+      break;
+    case kGo118Magic:
+      version_ = Version::kGo118;
+      break;
+    case kGo120Magic:
+      version_ = Version::kGo120;
+      break;
+    default:
+      return error::NotFound("Unsupported $0 magic $1.", kGoPclntabSection,
+                             absl::StrFormat("0x%x", ReadUint32(data, 0)));
+  }
+
+  pc_quantum_ = data[6];
+  ptr_size_ = data[7];
+  if (data[4] != 0 || data[5] != 0 || (ptr_size_ != 4 && ptr_size_ != 8) ||
+      (pc_quantum_ != 1 && pc_quantum_ != 2 && pc_quantum_ != 4)) {
+    return error::Internal("Invalid $0 header.", kGoPclntabSection);
+  }
+
+  // The header words after the magic; offsets are relative to the start of the table.
+  auto word = [this, data](int i) { return ReadWord(data, 8 + i * ptr_size_); };
+  auto subtable = [data](uint64_t offset) {
+    return offset <= data.size() ? data.substr(offset) : std::string_view();
+  };
+
+  num_funcs_ = word(0);
+  switch (version_) {
+    case Version::kGo12: {
+      // Everything is relative to the start of the table, and the function table follows the
+      // header.
+      funcnametab_ = data;
+      pctab_ = data;
+      functab_ = subtable(8 + ptr_size_);
+      funcdata_base_ = data;
+      const uint64_t filetab_offset_pos = 8 + ptr_size_ + (2 * num_funcs_ + 1) * ptr_size_;
+      if (filetab_offset_pos >= data.size()) {
+        return error::Internal("Invalid $0 function table.", kGoPclntabSection);
+      }
+      // The file table is an array of offsets of the file names from the start of the table.
+      filetab_ = subtable(ReadUint32(data, filetab_offset_pos));
+      break;
+    }
+    case Version::kGo116:
+      funcnametab_ = subtable(word(2));
+      cutab_ = subtable(word(3));
+      filetab_ = subtable(word(4));
+      pctab_ = subtable(word(5));
+      functab_ = subtable(word(6));
+      funcdata_base_ = functab_;
+      break;
+    case Version::kGo118:
+    case Version::kGo120:
+      text_start_ = word(2);
+      funcnametab_ = subtable(word(3));
+      cutab_ = subtable(word(4));
+      filetab_ = subtable(word(5));
+      pctab_ = subtable(word(6));
+      functab_ = subtable(word(7));
+      funcdata_base_ = functab_;
+      break;
+  }
+
+  // The function table has an entry per function, then the end address of the last one.
+  if (num_funcs_ == 0 ||
+      num_funcs_ >= functab_.size() / FunctabEntrySize() ||
+      num_funcs_ * FunctabEntrySize() + FunctabEntrySize() / 2 > functab_.size()) {
+    return error::Internal("Invalid $0 function table.", kGoPclntabSection);
+  }
+  text_begin_ = FuncEntry(0);
+  text_end_ = FuncEntry(num_funcs_);
+  return Status::OK();
+}
+
+uint64_t GoPclntab::ReadUint(std::string_view buf, size_t pos, size_t size) const {
+  if (pos > buf.size() || size > buf.size() - pos) {
+    return 0;
+  }
+  // Go binaries of the architectures we support are little-endian.
+  uint64_t val = 0;
+  for (size_t i = 0; i < size; ++i) {
+    val |= static_cast<uint64_t>(static_cast<uint8_t>(buf[pos + i])) << (8 * i);
+  }
+  return val;
+}
+
+size_t GoPclntab::FunctabEntrySize() const {
+  // Since Go 1.18, the entries are 32-bit offsets from the start of the text.
+  return version_ >= Version::kGo118 ? 8 : 2 * ptr_size_;
+}
+
+uint64_t GoPclntab::FuncEntry(size_t i) const {
+  if (version_ >= Version::kGo118) {
+    return text_start_ + ReadUint32(functab_, i * FunctabEntrySize());
+  }
+  return ReadWord(functab_, i * FunctabEntrySize());
+}
+
+bool GoPclntab::FindFunc(uint64_t addr, Func* func) const {
+  if (!Contains(addr)) {
+    return false;
+  }
+
+  // Find the last function that starts at or before addr.
+  size_t begin = 0;
+  size_t end = num_funcs_;
+  while (end - begin > 1) {
+    const size_t mid = begin + (end - begin) / 2;
+    if (FuncEntry(mid) <= addr) {
+      begin = mid;
+    } else {
+      end = mid;
+    }
+  }
+
+  const size_t func_offset_pos = begin * FunctabEntrySize() + FunctabEntrySize() / 2;
+  func->offset = version_ >= Version::kGo118 ? ReadUint32(functab_, func_offset_pos)
+                                             : ReadWord(functab_, func_offset_pos);
+  func->entry = FuncEntry(begin);
+  return func->offset < funcdata_base_.size();
+}
+
+uint32_t GoPclntab::FuncField(const Func& func, int n) const {
+  const size_t entry_size = version_ >= Version::kGo118 ? 4 : ptr_size_;
+  return ReadUint32(funcdata_base_, func.offset + entry_size + (n - 1) * 4);
+}
+
+size_t GoPclntab::FuncPCDataOffset() const {
+  switch (version_) {
+    case Version::kGo116:
+      // entry, 8 32-bit fields, then funcID, 2 bytes of padding and nfuncdata.
+      return ptr_size_ + 36;
+    case Version::kGo118:
+      // As in Go 1.16, with a 32-bit entry; funcID, flag, padding and nfuncdata.
+      return 40;
+    case Version::kGo120:
+      // As in Go 1.18, with startLine.
+      return 44;
+    case Version::kGo12:
+      break;
+  }
+  // Go 1.2 to 1.15 are not read for inlined frames.
+  return 0;
+}
+
+int32_t GoPclntab::PCValue(uint32_t table_offset, uint64_t entry, uint64_t pc) const {
+  if (table_offset == 0) {
+    return -1;
+  }
+
+  // A sequence of (value delta, pc delta) varint pairs; the value applies until the pc.
+  size_t pos = table_offset;
+  int32_t val = -1;
+  uint64_t cur_pc = entry;
+  for (bool first = true;; first = false) {
+    uint64_t uvdelta = 0;
+    if (!ReadUVarint(pctab_, &pos, &uvdelta) || (uvdelta == 0 && !first)) {
+      return -1;
+    }
+    // Zig-zag encoded.
+    val += (uvdelta & 1) != 0 ? ~static_cast<int32_t>(uvdelta >> 1)
+                              : static_cast<int32_t>(uvdelta >> 1);
+    uint64_t pcdelta = 0;
+    if (!ReadUVarint(pctab_, &pos, &pcdelta)) {
+      return -1;
+    }
+    cur_pc += pcdelta * pc_quantum_;
+    if (pc < cur_pc) {
+      return val;
+    }
+  }
+}
+
+std::string_view GoPclntab::FuncName(uint32_t name_offset) const {
+  return CString(funcnametab_, name_offset);
+}
+
+std::string_view GoPclntab::FileName(const Func& func, uint64_t pc) const {
+  constexpr std::string_view kUnknownFile = "?";
+  constexpr int kPCFileField = 5;
+  constexpr int kCUOffsetField = 8;
+
+  const int32_t file_index = PCValue(FuncField(func, kPCFileField), func.entry, pc);
+  if (file_index < 0) {
+    return kUnknownFile;
+  }
+  if (version_ == Version::kGo12) {
+    return CString(data_, ReadUint32(filetab_, 4 * file_index));
+  }
+  // Since Go 1.16, files are indexed per compilation unit.
+  const uint32_t file_offset =
+      ReadUint32(cutab_, 4 * (static_cast<uint64_t>(FuncField(func, kCUOffsetField)) + file_index));
+  if (file_offset == static_cast<uint32_t>(-1)) {
+    return kUnknownFile;
+  }
+  return CString(filetab_, file_offset);
+}
+
+int64_t GoPclntab::InlineTreeOffset(const Func& func) const {
+  constexpr int kNPCDataField = 7;
+
+  if (version_ == Version::kGo12 || rodata_.empty()) {
+    return -1;
+  }
+  const size_t pcdata_pos = func.offset + FuncPCDataOffset();
+  // nfuncdata is the byte just before the pcdata array.
+  const uint8_t num_funcdata = ReadUint(funcdata_base_, pcdata_pos - 1, 1);
+  if (num_funcdata <= kFuncDataInlTree) {
+    return -1;
+  }
+  size_t funcdata_pos = pcdata_pos + 4 * FuncField(func, kNPCDataField);
+
+  uint64_t addr = 0;
+  if (version_ == Version::kGo116) {
+    // Pointers, aligned in the binary.
+    const size_t abs_pos = funcdata_base_.data() - data_.data() + funcdata_pos;
+    funcdata_pos += (ptr_size_ - abs_pos % ptr_size_) % ptr_size_;
+    addr = ReadWord(funcdata_base_, funcdata_pos + kFuncDataInlTree * ptr_size_);
+    if (addr == 0) {
+      return -1;
+    }
+  } else {
+    // Offsets from go:func.*.
+    const uint32_t offset = ReadUint32(funcdata_base_, funcdata_pos + kFuncDataInlTree * 4);
+    if (offset == static_cast<uint32_t>(-1) || gofunc_addr_ == 0) {
+      return -1;
+    }
+    addr = gofunc_addr_ + offset;
+  }
+
+  if (addr < rodata_addr_ || addr - rodata_addr_ >= rodata_.size()) {
+    return -1;
+  }
+  return addr - rodata_addr_;
+}
+
+int32_t GoPclntab::InlineTreeIndex(const Func& func, uint64_t pc) const {
+  constexpr int kNPCDataField = 7;
+
+  if (FuncField(func, kNPCDataField) <= kPCDataInlTreeIndex) {
+    return -1;
+  }
+  const uint32_t table_offset = ReadUint32(
+      funcdata_base_, func.offset + FuncPCDataOffset() + 4 * kPCDataInlTreeIndex);
+  return PCValue(table_offset, func.entry, pc);
+}
+
+std::vector<GoPclntab::Frame> GoPclntab::LookupFrames(uint64_t addr) const {
+  constexpr int kNameOffField = 1;
+  constexpr int kPCLineField = 6;
+
+  Func func;
+  if (!FindFunc(addr, &func)) {
+    return {};
+  }
+
+  // The inlined calls, since Go 1.20: funcID, padding, nameOff, parentPc, startLine.
+  // Before: parent, funcID, padding, file, line, nameOff, parentPc.
+  const size_t inlined_call_size = version_ == Version::kGo120 ? 16 : 20;
+  const size_t name_off_pos = version_ == Version::kGo120 ? 4 : 12;
+  const size_t parent_pc_pos = version_ == Version::kGo120 ? 8 : 16;
+  const int64_t inline_tree = InlineTreeOffset(func);
+
+  // Stack traces hold return addresses, which are just past the calls, and it is the calls that
+  // the line and inlining information is about.
+  uint64_t pc = addr > func.entry ? addr - 1 : addr;
+
+  std::vector<Frame> frames;
+  for (int depth = 0; depth < kMaxInlineDepth; ++depth) {
+    Frame frame;
+    frame.file = FileName(func, pc);
+    frame.line = PCValue(FuncField(func, kPCLineField), func.entry, pc);
+
+    const int32_t index = inline_tree >= 0 ? InlineTreeIndex(func, pc) : -1;
+    if (index < 0) {
+      frame.function = FuncName(FuncField(func, kNameOffField));
+      frames.push_back(frame);
+      break;
+    }
+
+    // The function inlined at pc, then continue from the call site in the function it was
+    // inlined into.
+    const size_t inlined_call = inline_tree + index * inlined_call_size;
+    frame.function = FuncName(ReadUint32(rodata_, inlined_call + name_off_pos));
+    frames.push_back(frame);
+    pc = func.entry + static_cast<int32_t>(ReadUint32(rodata_, inlined_call + parent_pc_pos));
+  }
+  return frames;
+}
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/stirling/obj_tools/elf_reader.h"
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+/**
+ * Reads the function table of a Go binary (.gopclntab), which is what the Go runtime itself uses
+ * to print stack traces. It maps addresses to functions, files and lines, including the frames of
+ * inlined calls, without needing the symbol table or DWARF.
+ *
+ * The layouts of Go 1.2 to 1.15 are read for functions, files and lines only; the ones of Go 1.16
+ * and later also for inlined frames.
+ */
+class GoPclntab : public NotCopyMoveable {
+ public:
+  struct Frame {
+    std::string_view function;
+    std::string_view file;
+    int32_t line = 0;
+  };
+
+  /**
+   * Reads the function table of the binary read by the ElfReader. Since Go 1.18, inlined frames
+   * also need the go:func.* symbol, which the inline trees are located relative to.
+   */
+  static StatusOr<std::unique_ptr<GoPclntab>> Create(ElfReader* elf_reader);
+
+  /**
+   * @param pclntab The contents of .gopclntab.
+   * @param rodata_addr The address of .rodata, where the inline trees are.
+   * @param rodata The contents of .rodata; empty to not report inlined frames.
+   * @param gofunc_addr The address of go:func.* (go.func.* in Go 1.18 and 1.19), or 0.
+   */
+  static StatusOr<std::unique_ptr<GoPclntab>> Create(std::string pclntab, uint64_t rodata_addr,
+                                                     std::string rodata, uint64_t gofunc_addr);
+
+  size_t num_funcs() const { return num_funcs_; }
+
+  /**
+   * Returns whether a Go function of the table contains the binary address.
+   */
+  bool Contains(uint64_t addr) const { return addr >= text_begin_ && addr < text_end_; }
+
+  /**
+   * Returns the frames at the binary address, innermost first: the functions inlined at the
+   * address, if any, then the function that contains it. Empty if no function contains it.
+   * The views point into the table.
+   */
+  std::vector<Frame> LookupFrames(uint64_t addr) const;
+
+ private:
+  enum class Version { kGo12, kGo116, kGo118, kGo120 };
+
+  // A _func entry of the table: its offset from funcdata_base_, and its entry address.
+  struct Func {
+    size_t offset = 0;
+    uint64_t entry = 0;
+  };
+
+  GoPclntab() = default;
+
+  Status Init();
+
+  uint64_t ReadUint(std::string_view buf, size_t pos, size_t size) const;
+  uint64_t ReadWord(std::string_view buf, size_t pos) const {
+    return ReadUint(buf, pos, ptr_size_);
+  }
+  uint32_t ReadUint32(std::string_view buf, size_t pos) const { return ReadUint(buf, pos, 4); }
+
+  size_t FunctabEntrySize() const;
+  uint64_t FuncEntry(size_t i) const;
+  bool FindFunc(uint64_t addr, Func* func) const;
+  // The nth 32-bit field of the _func, after the entry, as in Go's debug/gosym.
+  uint32_t FuncField(const Func& func, int n) const;
+  // The offset of the pcdata array in the _func.
+  size_t FuncPCDataOffset() const;
+  int32_t PCValue(uint32_t table_offset, uint64_t entry, uint64_t pc) const;
+  std::string_view FuncName(uint32_t name_offset) const;
+  std::string_view FileName(const Func& func, uint64_t pc) const;
+  // Returns the offset of the inline tree of the function in rodata_, or -1 if it has none.
+  int64_t InlineTreeOffset(const Func& func) const;
+  int32_t InlineTreeIndex(const Func& func, uint64_t pc) const;
+
+  std::string data_;
+  uint64_t rodata_addr_ = 0;
+  std::string rodata_;
+  uint64_t gofunc_addr_ = 0;
+
+  Version version_ = Version::kGo12;
+  uint8_t pc_quantum_ = 1;
+  uint8_t ptr_size_ = 8;
+  uint64_t num_funcs_ = 0;
+  uint64_t text_start_ = 0;
+  uint64_t text_begin_ = 0;
+  uint64_t text_end_ = 0;
+
+  // Subtables of data_, which the _func fields are offsets into.
+  std::string_view funcnametab_;
+  std::string_view cutab_;
+  std::string_view filetab_;
+  std::string_view pctab_;
+  // The table of (entry, _func offset) pairs, and the base of the _func offsets.
+  std::string_view functab_;
+  std::string_view funcdata_base_;
+};
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
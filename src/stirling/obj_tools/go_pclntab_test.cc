@@ -0,0 +1,122 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/obj_tools/go_pclntab.h"
+
+#include <memory>
+#include <string>
+
+#include <absl/strings/match.h>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+using ::testing::SizeIs;
+
+constexpr std::string_view kGo1_13I386Binary =
+    "src/stirling/obj_tools/testdata/go/test_go1_13_i386_binary";
+constexpr std::string_view kGoSockshopBinary =
+    "src/stirling/obj_tools/testdata/go/sockshop_payments_service";
+constexpr std::string_view kGo1_17Binary = "src/stirling/obj_tools/testdata/go/test_go_1_17_binary";
+constexpr std::string_view kGo1_18Binary = "src/stirling/obj_tools/testdata/go/test_go_1_18_binary";
+constexpr std::string_view kGo1_19Binary = "src/stirling/obj_tools/testdata/go/test_go_1_19_binary";
+constexpr std::string_view kGo1_20Binary = "src/stirling/obj_tools/testdata/go/test_go_1_20_binary";
+constexpr std::string_view kGo1_21Binary = "src/stirling/obj_tools/testdata/go/test_go_1_21_binary";
+
+struct GoPclntabTestParam {
+  std::string_view binary;
+  // Whether the table layout of the Go version has inlined frames.
+  bool has_inlined_frames;
+};
+
+class GoPclntabTest : public ::testing::TestWithParam<GoPclntabTestParam> {
+ protected:
+  void SetUp() override {
+    const std::string path = px::testing::BazelRunfilePath(GetParam().binary);
+    ASSERT_OK_AND_ASSIGN(elf_reader_, ElfReader::Create(path));
+    ASSERT_OK_AND_ASSIGN(pclntab_, GoPclntab::Create(elf_reader_.get()));
+  }
+
+  std::unique_ptr<ElfReader> elf_reader_;
+  std::unique_ptr<GoPclntab> pclntab_;
+};
+
+TEST_P(GoPclntabTest, FunctionsMatchSymbols) {
+  EXPECT_GT(pclntab_->num_funcs(), 0);
+
+  for (std::string_view function : {"main.main", "runtime.main", "runtime.gopark"}) {
+    ASSERT_OK_AND_ASSIGN(ElfReader::SymbolInfo symbol, elf_reader_->SearchTheOnlySymbol(function));
+    ASSERT_TRUE(pclntab_->Contains(symbol.address));
+
+    // Nothing is inlined at the entry of a function.
+    const std::vector<GoPclntab::Frame> frames = pclntab_->LookupFrames(symbol.address);
+    ASSERT_THAT(frames, SizeIs(1));
+    EXPECT_EQ(frames[0].function, function);
+    EXPECT_TRUE(absl::EndsWith(frames[0].file, ".go")) << frames[0].file;
+    EXPECT_GT(frames[0].line, 0);
+  }
+
+  EXPECT_FALSE(pclntab_->Contains(0));
+  EXPECT_THAT(pclntab_->LookupFrames(0), SizeIs(0));
+}
+
+TEST_P(GoPclntabTest, InlinedFrames) {
+  ASSERT_OK_AND_ASSIGN(ElfReader::SymbolInfo symbol,
+                       elf_reader_->SearchTheOnlySymbol("runtime.main"));
+
+  // The runtime is built with inlining, even if the test binary itself is not.
+  int num_inlined = 0;
+  for (uint64_t addr = symbol.address; addr < symbol.address + symbol.size; ++addr) {
+    const std::vector<GoPclntab::Frame> frames = pclntab_->LookupFrames(addr);
+    ASSERT_FALSE(frames.empty());
+    EXPECT_EQ(frames.back().function, "runtime.main");
+    if (frames.size() > 1) {
+      ++num_inlined;
+      EXPECT_NE(frames.front().function, "runtime.main");
+      EXPECT_GT(frames.front().line, 0);
+    }
+  }
+
+  if (GetParam().has_inlined_frames) {
+    EXPECT_GT(num_inlined, 0);
+  } else {
+    EXPECT_EQ(num_inlined, 0);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(GoPclntabParameterizedTest, GoPclntabTest,
+                         ::testing::Values(GoPclntabTestParam{kGo1_13I386Binary, false},
+                                           GoPclntabTestParam{kGoSockshopBinary, false},
+                                           GoPclntabTestParam{kGo1_17Binary, true},
+                                           GoPclntabTestParam{kGo1_18Binary, true},
+                                           GoPclntabTestParam{kGo1_19Binary, true},
+                                           GoPclntabTestParam{kGo1_20Binary, true},
+                                           GoPclntabTestParam{kGo1_21Binary, true}));
+
+TEST(GoPclntabTest, RejectsInvalidTables) {
+  EXPECT_NOT_OK(GoPclntab::Create("", 0, "", 0));
+  EXPECT_NOT_OK(GoPclntab::Create(std::string("\xfb\xff\xff\xff\x00\x00\x01\x08", 8), 0, "", 0));
+  EXPECT_NOT_OK(GoPclntab::Create(std::string(64, '\0'), 0, "", 0));
+}
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
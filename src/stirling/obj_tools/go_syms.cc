@@ -19,6 +19,7 @@
 #include "src/stirling/obj_tools/go_syms.h"
 #include "src/stirling/utils/binary_decoder.h"
 
+#include <cstring>
 #include <utility>
 
 namespace px {
@@ -73,6 +74,25 @@ StatusOr<std::string> ReadGoString(ElfReader* elf_reader, uint64_t ptr_size, uin
 
 // Reads the buildinfo header embedded in the .go.buildinfo ELF section in order to determine the go
 // toolchain version. This function emulates what the go version cli performs as seen
+std::string ReadGoBuildID(ElfReader* elf_reader) {
+  constexpr std::string_view kGoBuildIDSection = ".note.go.buildid";
+  // namesz, descsz, type, then the name "Go\0\0" and the build ID.
+  constexpr size_t kNoteHeaderSize = 16;
+
+  auto section_or = elf_reader->SectionWithName(kGoBuildIDSection);
+  if (!section_or.ok() || section_or.ValueOrDie()->get_data() == nullptr) {
+    return "";
+  }
+  std::string_view note(section_or.ValueOrDie()->get_data(),
+                        section_or.ValueOrDie()->get_size());
+  if (note.size() < kNoteHeaderSize) {
+    return "";
+  }
+  uint32_t desc_size = 0;
+  std::memcpy(&desc_size, note.data() + 4, sizeof(desc_size));
+  return std::string(note.substr(kNoteHeaderSize, desc_size));
+}
+
 // https://github.com/golang/go/blob/cb7a091d729eab75ccfdaeba5a0605f05addf422/src/debug/buildinfo/buildinfo.go#L151-L221
 StatusOr<std::string> ReadGoBuildVersion(ElfReader* elf_reader) {
   PX_ASSIGN_OR_RETURN(ELFIO::section * section, elf_reader->SectionWithName(kGoBuildInfoSection));
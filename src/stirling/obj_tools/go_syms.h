@@ -39,6 +39,10 @@ bool IsGoExecutable(ElfReader* elf_reader);
 // structures and their offsets.
 StatusOr<std::string> ReadGoBuildVersion(ElfReader* elf_reader);
 
+// Returns the Go build ID of the binary, from its .note.go.buildid note, or empty if it has none.
+// Go binaries usually lack a GNU build-id, so this is what identifies them instead.
+std::string ReadGoBuildID(ElfReader* elf_reader);
+
 // Describes a Golang type that implement an interface.
 struct IntfImplTypeInfo {
   // The name of the type that implements a given interface.
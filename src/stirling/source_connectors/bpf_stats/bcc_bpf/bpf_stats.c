@@ -0,0 +1,269 @@
+/*
+ * This code runs using bpf in the Linux kernel.
+ * Copyright 2018- The Pixie Authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * SPDX-License-Identifier: GPL-2.0
+ */
+
+// LINT_C_FILE: Do not remove this line. It ensures cpplint treats this as a C file.
+
+#include <linux/mm_types.h>
+#include <linux/sched/signal.h>
+#include <linux/version.h>
+#include <net/sock.h>
+
+#include "src/stirling/bpf_tools/bcc_bpf/task_struct_utils.h"
+#include "src/stirling/source_connectors/bpf_stats/bcc_bpf_intf/bpf_stats.h"
+#include "src/stirling/upid/upid.h"
+
+// The per-process stats, read by user-space in one batched dump per sampling period.
+BPF_HASH(proc_stats, struct upid_t, struct bpf_proc_stats_t, BPF_STATS_MAX_PROCESSES);
+
+// The counters of each thread when it was last accounted. The difference to the current counters
+// is what gets added to the process stats.
+BPF_HASH(thread_counters, uint32_t, struct task_counters_t, BPF_STATS_MAX_THREADS);
+
+static __inline void read_task_counters(const struct task_struct* task,
+                                        struct task_counters_t* counters) {
+  BPF_PROBE_READ_KERNEL_VAR(counters->utime_ns, &task->utime);
+  BPF_PROBE_READ_KERNEL_VAR(counters->stime_ns, &task->stime);
+  BPF_PROBE_READ_KERNEL_VAR(counters->min_flt, &task->min_flt);
+  BPF_PROBE_READ_KERNEL_VAR(counters->maj_flt, &task->maj_flt);
+#ifdef CONFIG_TASK_XACCT
+  BPF_PROBE_READ_KERNEL_VAR(counters->rchar, &task->ioac.rchar);
+  BPF_PROBE_READ_KERNEL_VAR(counters->wchar, &task->ioac.wchar);
+#endif
+#ifdef CONFIG_TASK_IO_ACCOUNTING
+  BPF_PROBE_READ_KERNEL_VAR(counters->read_bytes, &task->ioac.read_bytes);
+  BPF_PROBE_READ_KERNEL_VAR(counters->write_bytes, &task->ioac.write_bytes);
+#endif
+}
+
+// Reads the counters that the kernel has accumulated from the already exited threads.
+static __inline void read_signal_counters(const struct signal_struct* signal,
+                                          struct task_counters_t* counters) {
+  BPF_PROBE_READ_KERNEL_VAR(counters->utime_ns, &signal->utime);
+  BPF_PROBE_READ_KERNEL_VAR(counters->stime_ns, &signal->stime);
+  BPF_PROBE_READ_KERNEL_VAR(counters->min_flt, &signal->min_flt);
+  BPF_PROBE_READ_KERNEL_VAR(counters->maj_flt, &signal->maj_flt);
+#ifdef CONFIG_TASK_XACCT
+  BPF_PROBE_READ_KERNEL_VAR(counters->rchar, &signal->ioac.rchar);
+  BPF_PROBE_READ_KERNEL_VAR(counters->wchar, &signal->ioac.wchar);
+#endif
+#ifdef CONFIG_TASK_IO_ACCOUNTING
+  BPF_PROBE_READ_KERNEL_VAR(counters->read_bytes, &signal->ioac.read_bytes);
+  BPF_PROBE_READ_KERNEL_VAR(counters->write_bytes, &signal->ioac.write_bytes);
+#endif
+}
+
+static __inline struct signal_struct* read_signal(const struct task_struct* task) {
+  struct signal_struct* signal = NULL;
+  BPF_PROBE_READ_KERNEL_VAR(signal, &task->signal);
+  return signal;
+}
+
+static __inline bool is_kernel_thread(const struct task_struct* task) {
+  unsigned int flags = 0;
+  BPF_PROBE_READ_KERNEL_VAR(flags, &task->flags);
+  return flags & PF_KTHREAD;
+}
+
+// Returns the stats entry of the process, creating it if this is the first time the process is
+// seen. A new entry starts from the counters of the threads that exited before then.
+static __inline struct bpf_proc_stats_t* get_or_create_proc_stats(const struct task_struct* task,
+                                                                  const struct upid_t* upid) {
+  struct bpf_proc_stats_t* stats = proc_stats.lookup(upid);
+  if (stats != NULL) {
+    return stats;
+  }
+
+  struct bpf_proc_stats_t new_stats = {};
+  read_signal_counters(read_signal(task), &new_stats.counters);
+  // Fails if another CPU created the entry in the meantime, in which case that one is used.
+  proc_stats.insert(upid, &new_stats);
+  return proc_stats.lookup(upid);
+}
+
+#define ACCUMULATE_COUNTER(field) \
+  __sync_fetch_and_add(&stats->counters.field, curr.field - prev.field)
+
+// Adds to the process stats what the current thread has accumulated since it was last accounted.
+static __inline struct bpf_proc_stats_t* account_current_thread(const struct task_struct* task) {
+  uint64_t id = bpf_get_current_pid_tgid();
+  uint32_t tgid = id >> 32;
+  uint32_t tid = id;
+
+  struct upid_t upid = {};
+  upid.tgid = tgid;
+  upid.start_time_ticks = read_start_boottime(task);
+
+  struct bpf_proc_stats_t* stats = get_or_create_proc_stats(task, &upid);
+  if (stats == NULL) {
+    return NULL;
+  }
+
+  struct task_counters_t curr = {};
+  read_task_counters(task, &curr);
+
+  struct task_counters_t prev = {};
+  struct task_counters_t* last = thread_counters.lookup(&tid);
+  if (last == NULL) {
+    // If the thread cannot be tracked, do not account any of it, rather than accounting its
+    // whole history at each context switch.
+    if (thread_counters.insert(&tid, &curr) != 0) {
+      return stats;
+    }
+  } else {
+    prev = *last;
+    *last = curr;
+  }
+
+  ACCUMULATE_COUNTER(utime_ns);
+  ACCUMULATE_COUNTER(stime_ns);
+  ACCUMULATE_COUNTER(min_flt);
+  ACCUMULATE_COUNTER(maj_flt);
+  ACCUMULATE_COUNTER(rchar);
+  ACCUMULATE_COUNTER(wchar);
+  ACCUMULATE_COUNTER(read_bytes);
+  ACCUMULATE_COUNTER(write_bytes);
+
+  stats->last_update_ns = bpf_ktime_get_ns();
+  return stats;
+}
+
+#undef ACCUMULATE_COUNTER
+
+// Effectively returns the sum of get_mm_counter() for file, anon and shmem pages, in bytes.
+static __inline int64_t read_rss_bytes(const struct mm_struct* mm) {
+  int64_t file_pages = 0;
+  int64_t anon_pages = 0;
+  int64_t shmem_pages = 0;
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 2, 0)
+  // Since Linux 6.2, rss_stat is an array of percpu_counter. Their count does not include the
+  // deltas that are still cached per CPU, same as get_mm_counter().
+  BPF_PROBE_READ_KERNEL_VAR(file_pages, &mm->rss_stat[MM_FILEPAGES].count);
+  BPF_PROBE_READ_KERNEL_VAR(anon_pages, &mm->rss_stat[MM_ANONPAGES].count);
+  BPF_PROBE_READ_KERNEL_VAR(shmem_pages, &mm->rss_stat[MM_SHMEMPAGES].count);
+#else
+  BPF_PROBE_READ_KERNEL_VAR(file_pages, &mm->rss_stat.count[MM_FILEPAGES].counter);
+  BPF_PROBE_READ_KERNEL_VAR(anon_pages, &mm->rss_stat.count[MM_ANONPAGES].counter);
+  BPF_PROBE_READ_KERNEL_VAR(shmem_pages, &mm->rss_stat.count[MM_SHMEMPAGES].counter);
+#endif
+  int64_t pages = file_pages + anon_pages + shmem_pages;
+  return pages > 0 ? pages * PAGE_SIZE : 0;
+}
+
+// At sched_switch, the current task is the one being switched out. Its counters are up to date at
+// this point, which makes this the place where CPU time and page faults are accounted, and where
+// the memory gauges are sampled.
+TRACEPOINT_PROBE(sched, sched_switch) {
+  struct task_struct* task = (struct task_struct*)bpf_get_current_task();
+
+  unsigned int flags = 0;
+  BPF_PROBE_READ_KERNEL_VAR(flags, &task->flags);
+  // Exiting tasks are accounted by the sched_process_exit probe.
+  if (flags & (PF_KTHREAD | PF_EXITING)) {
+    return 0;
+  }
+
+  struct mm_struct* mm = NULL;
+  BPF_PROBE_READ_KERNEL_VAR(mm, &task->mm);
+  if (mm == NULL) {
+    return 0;
+  }
+
+  struct bpf_proc_stats_t* stats = account_current_thread(task);
+  if (stats == NULL) {
+    return 0;
+  }
+
+  int nr_threads = 0;
+  BPF_PROBE_READ_KERNEL_VAR(nr_threads, &read_signal(task)->nr_threads);
+  unsigned long total_vm = 0;
+  BPF_PROBE_READ_KERNEL_VAR(total_vm, &mm->total_vm);
+
+  stats->num_threads = nr_threads;
+  stats->vsize_bytes = total_vm * PAGE_SIZE;
+  stats->rss_bytes = read_rss_bytes(mm);
+
+  return 0;
+}
+
+// Accounts the final counters of an exiting thread, and marks the process as exited when the last
+// of its threads exits.
+TRACEPOINT_PROBE(sched, sched_process_exit) {
+  struct task_struct* task = (struct task_struct*)bpf_get_current_task();
+  if (is_kernel_thread(task)) {
+    return 0;
+  }
+
+  struct bpf_proc_stats_t* stats = account_current_thread(task);
+
+  uint32_t tid = bpf_get_current_pid_tgid();
+  thread_counters.delete(&tid);
+
+  if (stats == NULL) {
+    return 0;
+  }
+
+  // signal->live is decremented before this tracepoint, and reaches 0 for the last thread.
+  int live = 0;
+  BPF_PROBE_READ_KERNEL_VAR(live, &read_signal(task)->live.counter);
+  if (live == 0) {
+    stats->num_threads = 0;
+    stats->exit_timestamp_ns = bpf_ktime_get_ns();
+  }
+
+  return 0;
+}
+
+static __inline struct bpf_proc_stats_t* get_current_proc_stats() {
+  struct task_struct* task = (struct task_struct*)bpf_get_current_task();
+  if (is_kernel_thread(task)) {
+    return NULL;
+  }
+
+  struct upid_t upid = {};
+  upid.tgid = bpf_get_current_pid_tgid() >> 32;
+  upid.start_time_ticks = read_start_boottime(task);
+  return get_or_create_proc_stats(task, &upid);
+}
+
+int probe_ret_tcp_sendmsg(struct pt_regs* ctx) {
+  int size = PT_REGS_RC(ctx);
+  if (size <= 0) {
+    return 0;
+  }
+
+  struct bpf_proc_stats_t* stats = get_current_proc_stats();
+  if (stats != NULL) {
+    __sync_fetch_and_add(&stats->tcp_tx_bytes, size);
+  }
+  return 0;
+}
+
+int probe_entry_tcp_cleanup_rbuf(struct pt_regs* ctx, struct sock* sk, int copied) {
+  if (copied <= 0) {
+    return 0;
+  }
+
+  struct bpf_proc_stats_t* stats = get_current_proc_stats();
+  if (stats != NULL) {
+    __sync_fetch_and_add(&stats->tcp_rx_bytes, copied);
+  }
+  return 0;
+}
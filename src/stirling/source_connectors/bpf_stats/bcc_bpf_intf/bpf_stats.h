@@ -0,0 +1,60 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "src/stirling/upid/upid.h"
+
+// Capacity of the BPF maps. Processes and threads beyond these limits are not accounted.
+#define BPF_STATS_MAX_PROCESSES 65536
+#define BPF_STATS_MAX_THREADS 262144
+
+// The cumulative counters of a task, as read from task_struct (or signal_struct for the threads
+// that have already exited). These mirror the counters reported in /proc/<pid>/stat and
+// /proc/<pid>/io.
+struct task_counters_t {
+  uint64_t utime_ns;
+  uint64_t stime_ns;
+  uint64_t min_flt;
+  uint64_t maj_flt;
+  uint64_t rchar;
+  uint64_t wchar;
+  uint64_t read_bytes;
+  uint64_t write_bytes;
+};
+
+// The per-process stats, aggregated over all threads of a process inside BPF.
+struct bpf_proc_stats_t {
+  // Sum of the counters of all threads of the process, including the exited ones.
+  struct task_counters_t counters;
+
+  // Gauges, sampled when a thread of the process is switched out of a CPU.
+  int64_t num_threads;
+  int64_t vsize_bytes;
+  int64_t rss_bytes;
+
+  // Payload bytes sent and received on the TCP sockets of the process.
+  uint64_t tcp_tx_bytes;
+  uint64_t tcp_rx_bytes;
+
+  // The BPF time of the last update of this entry.
+  uint64_t last_update_ns;
+
+  // The BPF time at which the last thread of the process exited, or 0 if the process is alive.
+  uint64_t exit_timestamp_ns;
+};
@@ -0,0 +1,218 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/bpf_stats/bpf_stats_connector.h"
+
+#include <string>
+#include <utility>
+
+#include "src/common/base/base.h"
+#include "src/common/system/proc_parser.h"
+#include "src/common/system/proc_pid_path.h"
+#include "src/shared/metadata/metadata.h"
+#include "src/stirling/bpf_tools/macros.h"
+
+OBJ_STRVIEW(bpf_stats_bcc_script, bpf_stats);
+
+namespace px {
+namespace stirling {
+
+using ProbeType = bpf_tools::BPFProbeAttachType;
+
+namespace {
+
+const auto kTracepointSpecs = MakeArray<bpf_tools::TracepointSpec>(
+    {{std::string("sched:sched_switch"), std::string("tracepoint__sched__sched_switch")},
+     {std::string("sched:sched_process_exit"),
+      std::string("tracepoint__sched__sched_process_exit")}});
+
+const auto kProbeSpecs = MakeArray<bpf_tools::KProbeSpec>(
+    {{"tcp_sendmsg", ProbeType::kReturn, "probe_ret_tcp_sendmsg", /*is_syscall*/ false},
+     {"tcp_cleanup_rbuf", ProbeType::kEntry, "probe_entry_tcp_cleanup_rbuf",
+      /*is_syscall*/ false}});
+
+// Processes normally leave the BPF map through the sched_process_exit probe. As a safety net,
+// every this many transfers, the entries of the processes that no longer exist are removed.
+constexpr int kStaleEntriesCheckInterval = 60;
+
+}  // namespace
+
+Status BPFStatsConnector::InitImpl() {
+  sampling_freq_mgr_.set_period(kSamplingPeriod);
+  push_freq_mgr_.set_period(kPushPeriod);
+
+  PX_RETURN_IF_ERROR(bcc_->InitBPFProgram(bpf_stats_bcc_script));
+  PX_RETURN_IF_ERROR(bcc_->AttachTracepoints(kTracepointSpecs));
+  PX_RETURN_IF_ERROR(bcc_->AttachKProbes(kProbeSpecs));
+
+  proc_stats_map_ = ProcStatsMap::Create(bcc_.get(), "proc_stats");
+  return Status::OK();
+}
+
+Status BPFStatsConnector::StopImpl() {
+  bcc_->Close();
+  return Status::OK();
+}
+
+void BPFStatsConnector::TransferDataImpl(ConnectorContext* ctx) {
+  DCHECK_EQ(data_tables_.size(), 2U);
+
+  DataTable* process_table = data_tables_[kProcessStatsTableNum];
+  DataTable* network_table = data_tables_[kNetworkStatsTableNum];
+
+  const uint32_t asid = ctx->GetASID();
+  const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& pid_info_by_upid = ctx->GetPIDInfoMap();
+  const bool check_stale_entries = ++num_transfers_ % kStaleEntriesCheckInterval == 0;
+
+  int64_t timestamp = AdjustedSteadyClockNowNS();
+
+  // The stats of the live processes, used for the per-pod network stats.
+  absl::flat_hash_map<md::UPID, struct bpf_proc_stats_t> stats_by_upid;
+
+  // The whole map is read with a single batched dump (see BPFMapLookupAll()).
+  for (const auto& [bpf_upid, stats] : proc_stats_map_->GetTableOffline()) {
+    md::UPID upid = bpf_upid.ToMetadataUPID(asid);
+
+    if (process_table != nullptr &&
+        (ctx->UPIDIsInContext(upid) || pid_info_by_upid.contains(upid))) {
+      AppendProcessStats(timestamp, upid, stats, process_table);
+    }
+
+    if (stats.exit_timestamp_ns == 0 && check_stale_entries) {
+      auto start_time_ticks = system::GetPIDStartTimeTicks(system::ProcPidPath(upid.pid()));
+      if (!start_time_ticks.ok() || start_time_ticks.ValueOrDie() != upid.start_ts()) {
+        PX_UNUSED(proc_stats_map_->RemoveValue(bpf_upid));
+        continue;
+      }
+    }
+
+    // The exited processes are reported one last time above, with their final counters.
+    if (stats.exit_timestamp_ns != 0) {
+      RecordExitedProcessTCPBytes(ctx, upid, stats);
+      PX_UNUSED(proc_stats_map_->RemoveValue(bpf_upid));
+      continue;
+    }
+
+    stats_by_upid.emplace(upid, stats);
+  }
+
+  if (network_table != nullptr) {
+    TransferNetworkStatsTable(ctx, timestamp, stats_by_upid, network_table);
+  }
+}
+
+void BPFStatsConnector::AppendProcessStats(int64_t timestamp, const md::UPID& upid,
+                                           const struct bpf_proc_stats_t& stats,
+                                           DataTable* data_table) {
+  DataTable::RecordBuilder<&kBPFProcessStatsTable> r(data_table, timestamp);
+  r.Append<r.ColIndex("time_")>(timestamp);
+  r.Append<r.ColIndex("upid")>(upid.value());
+  r.Append<r.ColIndex("major_faults")>(stats.counters.maj_flt);
+  r.Append<r.ColIndex("minor_faults")>(stats.counters.min_flt);
+  r.Append<r.ColIndex("cpu_utime_ns")>(stats.counters.utime_ns);
+  r.Append<r.ColIndex("cpu_ktime_ns")>(stats.counters.stime_ns);
+  r.Append<r.ColIndex("num_threads")>(stats.num_threads);
+  r.Append<r.ColIndex("vsize_bytes")>(stats.vsize_bytes);
+  r.Append<r.ColIndex("rss_bytes")>(stats.rss_bytes);
+  r.Append<r.ColIndex("rchar_bytes")>(stats.counters.rchar);
+  r.Append<r.ColIndex("wchar_bytes")>(stats.counters.wchar);
+  r.Append<r.ColIndex("read_bytes")>(stats.counters.read_bytes);
+  r.Append<r.ColIndex("write_bytes")>(stats.counters.write_bytes);
+}
+
+void BPFStatsConnector::RecordExitedProcessTCPBytes(ConnectorContext* ctx, const md::UPID& upid,
+                                                    const struct bpf_proc_stats_t& stats) {
+  if (stats.tcp_rx_bytes == 0 && stats.tcp_tx_bytes == 0) {
+    return;
+  }
+
+  const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& pid_info_by_upid = ctx->GetPIDInfoMap();
+  auto iter = pid_info_by_upid.find(upid);
+  if (iter == pid_info_by_upid.end() || iter->second == nullptr) {
+    return;
+  }
+
+  const md::ContainerInfo* container_info =
+      ctx->GetK8SMetadata().ContainerInfoByID(iter->second->cid());
+  if (container_info == nullptr || container_info->pod_id().empty()) {
+    return;
+  }
+
+  TCPBytes& bytes = exited_tcp_bytes_by_pod_[container_info->pod_id()];
+  bytes.rx_bytes += stats.tcp_rx_bytes;
+  bytes.tx_bytes += stats.tcp_tx_bytes;
+}
+
+void BPFStatsConnector::TransferNetworkStatsTable(
+    ConnectorContext* ctx, int64_t timestamp,
+    const absl::flat_hash_map<md::UPID, struct bpf_proc_stats_t>& stats_by_upid,
+    DataTable* data_table) {
+  const md::K8sMetadataState& k8s_md = ctx->GetK8SMetadata();
+
+  for (const auto& [pod_name, pod_id] : k8s_md.pods_by_name()) {
+    PX_UNUSED(pod_name);
+
+    auto* pod_info = k8s_md.PodInfoByID(pod_id);
+    if (pod_info == nullptr || pod_info->stop_time_ns() > 0) {
+      continue;
+    }
+
+    TCPBytes bytes;
+    auto exited_iter = exited_tcp_bytes_by_pod_.find(pod_id);
+    if (exited_iter != exited_tcp_bytes_by_pod_.end()) {
+      bytes = exited_iter->second;
+    }
+
+    for (const auto& container_id : pod_info->containers()) {
+      auto* container_info = k8s_md.ContainerInfoByID(container_id);
+      if (container_info == nullptr) {
+        continue;
+      }
+      for (const auto& upid : container_info->active_upids()) {
+        auto iter = stats_by_upid.find(upid);
+        if (iter == stats_by_upid.end()) {
+          continue;
+        }
+        bytes.rx_bytes += iter->second.tcp_rx_bytes;
+        bytes.tx_bytes += iter->second.tcp_tx_bytes;
+      }
+    }
+
+    DataTable::RecordBuilder<&kBPFNetworkStatsTable> r(data_table, timestamp);
+    r.Append<r.ColIndex("time_")>(timestamp);
+    r.Append<r.ColIndex("pod_id")>(std::string(pod_id));
+    r.Append<r.ColIndex("rx_bytes")>(bytes.rx_bytes);
+    // Only the TCP payload is accounted in BPF, so there is no packet, error or drop count.
+    r.Append<r.ColIndex("rx_packets")>(0);
+    r.Append<r.ColIndex("rx_errors")>(0);
+    r.Append<r.ColIndex("rx_drops")>(0);
+    r.Append<r.ColIndex("tx_bytes")>(bytes.tx_bytes);
+    r.Append<r.ColIndex("tx_packets")>(0);
+    r.Append<r.ColIndex("tx_errors")>(0);
+    r.Append<r.ColIndex("tx_drops")>(0);
+  }
+
+  // Forgets the pods that have stopped.
+  absl::erase_if(exited_tcp_bytes_by_pod_, [&k8s_md](const auto& kv) {
+    auto* pod_info = k8s_md.PodInfoByID(kv.first);
+    return pod_info == nullptr || pod_info->stop_time_ns() > 0;
+  });
+}
+
+}  // namespace stirling
+}  // namespace px
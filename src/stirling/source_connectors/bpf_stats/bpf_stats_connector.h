@@ -0,0 +1,93 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/stirling/bpf_tools/bcc_wrapper.h"
+#include "src/stirling/core/source_connector.h"
+#include "src/stirling/source_connectors/bpf_stats/bcc_bpf_intf/bpf_stats.h"
+#include "src/stirling/source_connectors/bpf_stats/bpf_stats_table.h"
+
+namespace px {
+namespace stirling {
+
+/**
+ * BPFStatsConnector produces the process_stats and network_stats data, without polling /proc.
+ *
+ * The counters are aggregated per process in a BPF map, as the processes run: CPU time, page
+ * faults and IO counters are accounted when a thread is switched out or exits, and the TCP
+ * payload bytes when they are sent or received. Each sampling period reads the whole map with
+ * one batched dump, instead of reading a few /proc files for every process.
+ */
+class BPFStatsConnector : public BCCSourceConnector {
+ public:
+  static constexpr std::string_view kName = "bpf_stats";
+  static constexpr auto kSamplingPeriod = std::chrono::milliseconds{1000};
+  static constexpr auto kPushPeriod = std::chrono::milliseconds{1000};
+
+  static constexpr auto kTables = MakeArray(kBPFProcessStatsTable, kBPFNetworkStatsTable);
+  static constexpr uint32_t kProcessStatsTableNum = TableNum(kTables, kBPFProcessStatsTable);
+  static constexpr uint32_t kNetworkStatsTableNum = TableNum(kTables, kBPFNetworkStatsTable);
+
+  static std::unique_ptr<SourceConnector> Create(std::string_view name) {
+    return std::unique_ptr<SourceConnector>(new BPFStatsConnector(name));
+  }
+
+  BPFStatsConnector() = delete;
+  ~BPFStatsConnector() override = default;
+
+ protected:
+  explicit BPFStatsConnector(std::string_view name) : BCCSourceConnector(name, kTables) {}
+
+  Status InitImpl() override;
+  Status StopImpl() override;
+  void TransferDataImpl(ConnectorContext* ctx) override;
+
+ private:
+  struct TCPBytes {
+    uint64_t rx_bytes = 0;
+    uint64_t tx_bytes = 0;
+  };
+
+  using ProcStatsMap = bpf_tools::WrappedBCCMap<struct upid_t, struct bpf_proc_stats_t>;
+
+  void AppendProcessStats(int64_t timestamp, const md::UPID& upid,
+                          const struct bpf_proc_stats_t& stats, DataTable* data_table);
+  void TransferNetworkStatsTable(
+      ConnectorContext* ctx, int64_t timestamp,
+      const absl::flat_hash_map<md::UPID, struct bpf_proc_stats_t>& stats_by_upid,
+      DataTable* data_table);
+  // Keeps the TCP bytes of an exited process in the total of its pod, so that the counters of
+  // the pod do not go backwards once the process is removed from the BPF map.
+  void RecordExitedProcessTCPBytes(ConnectorContext* ctx, const md::UPID& upid,
+                                   const struct bpf_proc_stats_t& stats);
+
+  std::unique_ptr<ProcStatsMap> proc_stats_map_;
+  int num_transfers_ = 0;
+
+  // The TCP bytes of the exited processes, keyed by pod ID.
+  absl::flat_hash_map<std::string, TCPBytes> exited_tcp_bytes_by_pod_;
+};
+
+}  // namespace stirling
+}  // namespace px
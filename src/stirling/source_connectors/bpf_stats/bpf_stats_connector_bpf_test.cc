@@ -0,0 +1,74 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/bpf_stats/bpf_stats_connector.h"
+
+#include "src/common/exec/subprocess.h"
+#include "src/common/system/proc_parser.h"
+#include "src/common/system/proc_pid_path.h"
+#include "src/common/testing/testing.h"
+#include "src/stirling/core/connector_context.h"
+#include "src/stirling/core/data_tables.h"
+#include "src/stirling/testing/common.h"
+
+namespace px {
+namespace stirling {
+
+using ::px::SubProcess;
+using ::px::stirling::testing::RecordBatchSizeIs;
+
+// Tests that the stats of a short-lived process are reported after it exits.
+TEST(BPFStatsConnectorTest, ReportsExitedProcess) {
+  auto connector = BPFStatsConnector::Create("test_bpf_stats_connector");
+  ASSERT_TRUE(connector != nullptr);
+  ASSERT_OK(connector->Init());
+
+  DataTables data_tables{BPFStatsConnector::kTables};
+  DataTable* data_table = data_tables.tables()[BPFStatsConnector::kProcessStatsTableNum];
+  connector->set_data_tables(data_tables.tables());
+
+  // Burns some CPU, so that the process accumulates CPU time.
+  SubProcess proc;
+  ASSERT_OK(proc.Start({"sh", "-c", "i=0; while [ $i -lt 300000 ]; do i=$((i+1)); done"}));
+  ASSERT_OK_AND_ASSIGN(int64_t start_time_ticks,
+                       system::GetPIDStartTimeTicks(system::ProcPidPath(proc.child_pid())));
+  StandaloneContext context({md::UPID(0, proc.child_pid(), start_time_ticks)});
+  EXPECT_EQ(proc.Wait(), 0);
+
+  connector->TransferData(&context);
+
+  types::ColumnWrapperRecordBatch result = testing::ExtractRecordsMatchingPID(
+      data_table, kBPFProcessStatsTable.ColIndex("upid"), proc.child_pid());
+  ASSERT_THAT(result, RecordBatchSizeIs(1));
+  const int64_t cpu_time_ns =
+      result[kBPFProcessStatsTable.ColIndex("cpu_utime_ns")]->Get<types::Int64Value>(0).val +
+      result[kBPFProcessStatsTable.ColIndex("cpu_ktime_ns")]->Get<types::Int64Value>(0).val;
+  EXPECT_GT(cpu_time_ns, 0);
+  EXPECT_EQ(result[kBPFProcessStatsTable.ColIndex("num_threads")]->Get<types::Int64Value>(0), 0);
+
+  // Exited processes are removed from the BPF map once reported.
+  connector->TransferData(&context);
+  result = testing::ExtractRecordsMatchingPID(data_table, kBPFProcessStatsTable.ColIndex("upid"),
+                                              proc.child_pid());
+  EXPECT_THAT(result, RecordBatchSizeIs(0));
+
+  ASSERT_OK(connector->Stop());
+}
+
+}  // namespace stirling
+}  // namespace px
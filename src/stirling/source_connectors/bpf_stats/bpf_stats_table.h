@@ -0,0 +1,52 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "src/stirling/core/output.h"
+#include "src/stirling/core/source_connector.h"
+#include "src/stirling/source_connectors/network_stats/network_stats_table.h"
+#include "src/stirling/source_connectors/process_stats/process_stats_table.h"
+
+namespace px {
+namespace stirling {
+
+// These tables have the same columns as process_stats and network_stats, so that queries written
+// against those work with these as well. They have different names so that both the /proc-based
+// and the BPF-based connectors can be deployed side by side.
+
+// clang-format off
+constexpr DataTableSchema kBPFProcessStatsTable(
+    "bpf_process_stats",
+    "CPU, memory and IO stats for all K8s processes in your cluster, aggregated in BPF. "
+    "Same columns as the process_stats table.",
+    kProcessStatsElements
+);
+
+constexpr DataTableSchema kBPFNetworkStatsTable(
+    "bpf_network_stats",
+    "TCP RX/TX stats, grouped by pod, aggregated in BPF. Same columns as the network_stats table. "
+    "Only the bytes of TCP payload are counted; the packet, error and drop counts are always 0.",
+    kNetworkStatsElements
+);
+// clang-format on
+DEFINE_PRINT_TABLE(BPFProcessStats);
+DEFINE_PRINT_TABLE(BPFNetworkStats);
+
+}  // namespace stirling
+}  // namespace px
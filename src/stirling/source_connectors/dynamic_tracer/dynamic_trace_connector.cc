@@ -23,6 +23,7 @@
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
+#include <algorithm>
 #include <map>
 
 #include "src/common/base/base.h"
@@ -43,21 +44,19 @@ using ::px::utils::MemCpy;
 namespace {
 
 // A generic callback function to be invoked to push a piece of data polled from the perf buffer
-// to the DynamicTraceConnector.
+// to the DynamicTraceConnector. The input cb_cookie has to be DynamicTraceConnector::OutputBuffer*.
 void GenericHandleEvent(void* cb_cookie, void* data, int data_size) {
   DCHECK_NE(cb_cookie, nullptr);
   DCHECK_EQ(data_size % 4, 0)
       << "Perf buffer data items are aligned with 8 bytes. "
          "The first 4 bytes are size, therefore data size must be a multiple of 4.";
 
-  auto* parser = static_cast<DynamicTraceConnector*>(cb_cookie);
-  std::string buf(static_cast<const char*>(data), data_size);
-
-  parser->AcceptDataEvents(std::move(buf));
+  auto* output_buffer = static_cast<DynamicTraceConnector::OutputBuffer*>(cb_cookie);
+  output_buffer->data_items.emplace_back(static_cast<const char*>(data), data_size);
 }
 
 // A generic callback function to be invoked to process data item loss.
-// The input cb_cookie has to be DynamicTraceConnector*.
+// The input cb_cookie has to be DynamicTraceConnector::OutputBuffer*.
 void GenericHandleEventLoss(void* cb_cookie, uint64_t lost) {
   DCHECK_NE(cb_cookie, nullptr);
   VLOG(1) << absl::Substitute("Lost $0 events", lost);
@@ -152,21 +151,25 @@ StatusOr<std::unique_ptr<SourceConnector>> DynamicTraceConnector::Create(
 
   LOG(INFO) << "BCCProgram:\n" << bcc_program.ToString();
 
-  if (bcc_program.perf_buffer_specs.size() != 1) {
-    return error::Internal("Only a single output table is allowed for now.");
+  if (bcc_program.perf_buffer_specs.empty()) {
+    return error::Internal("At least one output table is required.");
   }
 
-  const auto& output = bcc_program.perf_buffer_specs[0];
-
-  // Could consider making a better description, but may require more user input,
-  // so punting on that for now.
-  std::string desc = absl::StrCat("Dynamic table for ", output.name);
-
-  std::unique_ptr<DynamicDataTableSchema> table_schema =
-      DynamicDataTableSchema::Create(output.name, desc, ConvertFields(output.output.fields()));
+  // Each output of the program is demultiplexed into its own table.
+  std::vector<std::unique_ptr<DynamicDataTableSchema>> dynamic_schemas;
+  std::vector<DataTableSchema> table_schemas;
+  for (const auto& output : bcc_program.perf_buffer_specs) {
+    // Could consider making a better description, but may require more user input,
+    // so punting on that for now.
+    std::string desc = absl::StrCat("Dynamic table for ", output.name);
+
+    dynamic_schemas.push_back(
+        DynamicDataTableSchema::Create(output.name, desc, ConvertFields(output.output.fields())));
+    table_schemas.push_back(dynamic_schemas.back()->Get());
+  }
 
-  return std::unique_ptr<SourceConnector>(
-      new DynamicTraceConnector(name, std::move(table_schema), std::move(bcc_program)));
+  return std::unique_ptr<SourceConnector>(new DynamicTraceConnector(
+      name, std::move(dynamic_schemas), std::move(table_schemas), std::move(bcc_program)));
 }
 
 Status DynamicTraceConnector::InitImpl() {
@@ -179,15 +182,21 @@ Status DynamicTraceConnector::InitImpl() {
     PX_RETURN_IF_ERROR(bcc_->AttachUProbe(uprobe_spec));
   }
 
-  // TODO(yzhao/oazizi): Might need to change this if we need to support multiple perf buffers.
-  bpf_tools::PerfBufferSpec spec = {
-      .name = bcc_program_.perf_buffer_specs.front().name,
-      .probe_output_fn = &GenericHandleEvent,
-      .probe_loss_fn = &GenericHandleEventLoss,
-      .cb_cookie = this,
-  };
+  // All outputs share the perf buffer memory of the connector.
+  const int num_outputs = bcc_program_.perf_buffer_specs.size();
+  const int size_bytes = std::max(kPerfBufferSizeBytes / num_outputs, kMinPerfBufferSizeBytes);
+
+  for (int i = 0; i < num_outputs; ++i) {
+    bpf_tools::PerfBufferSpec spec = {
+        .name = bcc_program_.perf_buffer_specs[i].name,
+        .probe_output_fn = &GenericHandleEvent,
+        .probe_loss_fn = &GenericHandleEventLoss,
+        .cb_cookie = &output_buffers_[i],
+        .size_bytes = size_bytes,
+    };
 
-  PX_RETURN_IF_ERROR(bcc_->OpenPerfBuffer(spec));
+    PX_RETURN_IF_ERROR(bcc_->OpenPerfBuffer(spec));
+  }
 
   return Status::OK();
 }
@@ -487,24 +496,28 @@ Status DynamicTraceConnector::AppendRecord(const Struct& st, uint32_t asid, std:
 }
 
 void DynamicTraceConnector::TransferDataImpl(ConnectorContext* ctx) {
-  DCHECK_EQ(data_tables_.size(), 1U)
-      << "Now only support having exactly one table per DynamicTraceConnector";
-
-  auto* data_table = data_tables_[0];
-  if (data_table == nullptr) {
-    return;
-  }
+  DCHECK_EQ(data_tables_.size(), output_buffers_.size());
 
+  // A single poll drains the perf buffers of all outputs.
   bcc_->PollPerfBuffers();
 
-  for (const auto& item : data_items_) {
-    // TODO(yzhao): Right now only support scalar types. We should replace type with ScalarType
-    // in Struct::Field.
-    ECHECK_OK(AppendRecord(bcc_program_.perf_buffer_specs.front().output, ctx->GetASID(), item,
-                           data_table));
-  }
+  for (size_t i = 0; i < output_buffers_.size(); ++i) {
+    auto& data_items = output_buffers_[i].data_items;
+    auto* data_table = data_tables_[i];
+    if (data_table == nullptr) {
+      data_items.clear();
+      continue;
+    }
 
-  data_items_.clear();
+    for (const auto& item : data_items) {
+      // TODO(yzhao): Right now only support scalar types. We should replace type with ScalarType
+      // in Struct::Field.
+      ECHECK_OK(AppendRecord(bcc_program_.perf_buffer_specs[i].output, ctx->GetASID(), item,
+                             data_table));
+    }
+
+    data_items.clear();
+  }
 }
 
 }  // namespace stirling
@@ -37,23 +37,36 @@ class DynamicTraceConnector : public BCCSourceConnector {
   static constexpr auto kSamplingPeriod = std::chrono::milliseconds{100};
   static constexpr auto kPushPeriod = std::chrono::milliseconds{1000};
 
+  // The perf buffer memory of a connector, which is split among the outputs of its tracepoints,
+  // so that deploying several tracepoints together locks no more memory than deploying one.
+  static constexpr int kPerfBufferSizeBytes = 1024 * 1024;
+  static constexpr int kMinPerfBufferSizeBytes = 64 * 1024;
+
   ~DynamicTraceConnector() override = default;
 
   static StatusOr<std::unique_ptr<SourceConnector>> Create(
       std::string_view name, dynamic_tracing::ir::logical::TracepointDeployment* program);
 
-  // Accepts a piece of data from the perf buffer.
-  void AcceptDataEvents(std::string data) { data_items_.push_back(std::move(data)); }
+  // Raw data items polled from the perf buffer of one output, which is also the output's table.
+  // The address of the buffer is the cookie of the perf buffer callbacks.
+  struct OutputBuffer {
+    std::deque<std::string> data_items;
+  };
 
  protected:
-  // TODO(oazizi): This constructor only works with a single table,
-  //               since the ArrayView creation only works for a single schema.
-  //               Consider how to expand to multiple tables if/when needed.
-  DynamicTraceConnector(std::string_view name, std::unique_ptr<DynamicDataTableSchema> table_schema,
+  // Takes one table schema per perf buffer of the program, in the same order.
+  // The ArrayView passed to the base class points into the heap storage of table_schemas,
+  // which is preserved when moving the vector into table_schema_copies_.
+  DynamicTraceConnector(std::string_view name,
+                        std::vector<std::unique_ptr<DynamicDataTableSchema>> dynamic_schemas,
+                        std::vector<DataTableSchema> table_schemas,
                         dynamic_tracing::BCCProgram bcc_program)
-      : BCCSourceConnector(name, ArrayView<DataTableSchema>(&table_schema->Get(), 1)),
-        table_schema_(std::move(table_schema)),
-        bcc_program_(std::move(bcc_program)) {}
+      : BCCSourceConnector(name,
+                           ArrayView<DataTableSchema>(table_schemas.data(), table_schemas.size())),
+        dynamic_schemas_(std::move(dynamic_schemas)),
+        table_schema_copies_(std::move(table_schemas)),
+        bcc_program_(std::move(bcc_program)),
+        output_buffers_(bcc_program_.perf_buffer_specs.size()) {}
 
   Status InitImpl() override;
 
@@ -65,14 +78,17 @@ class DynamicTraceConnector : public BCCSourceConnector {
   Status AppendRecord(const ::px::stirling::dynamic_tracing::ir::physical::Struct& st,
                       uint32_t asid, std::string_view buf, DataTable* data_table);
 
-  // Describes the output table column types.
-  std::unique_ptr<DynamicDataTableSchema> table_schema_;
+  // Describes the output table column types, one per output.
+  std::vector<std::unique_ptr<DynamicDataTableSchema>> dynamic_schemas_;
+
+  // The schemas of dynamic_schemas_ laid out contiguously, as required by table_schemas().
+  std::vector<DataTableSchema> table_schema_copies_;
 
   // The actual dynamic trace program.
   dynamic_tracing::BCCProgram bcc_program_;
 
-  // A buffer to hold raw data items from the perf buffer.
-  std::deque<std::string> data_items_;
+  // Buffers to hold raw data items from the perf buffers, indexed like the tables.
+  std::vector<OutputBuffer> output_buffers_;
 };
 
 // Converts proto specification of columns into the form that is used by TableSchema.
@@ -26,6 +26,7 @@
 #include <vector>
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
 #include <absl/strings/str_replace.h>
 #include <google/protobuf/repeated_field.h>
 
@@ -161,9 +162,8 @@ class Dwarvifier {
 StatusOr<ir::physical::Program> GeneratePhysicalProgram(
     const ir::logical::TracepointDeployment& input, obj_tools::DwarfReader* dwarf_reader,
     obj_tools::ElfReader* elf_reader) {
-  if (input.tracepoints_size() != 1) {
-    return error::InvalidArgument("Right now only support exactly 1 Tracepoint, got '$0'",
-                                  input.tracepoints_size());
+  if (input.tracepoints().empty()) {
+    return error::InvalidArgument("Must have at least 1 Tracepoint");
   }
 
   ir::physical::Program output_program;
@@ -171,12 +171,35 @@ StatusOr<ir::physical::Program> GeneratePhysicalProgram(
   output_program.mutable_deployment_spec()->CopyFrom(input.deployment_spec());
   output_program.set_language(input.tracepoints(0).program().language());
 
+  // All tracepoints are compiled into one BPF program, so they must agree on the language,
+  // and must not declare maps, outputs or probes of the same name.
   for (const auto& input_tracepoint : input.tracepoints()) {
+    if (input_tracepoint.program().language() != output_program.language()) {
+      return error::InvalidArgument("Tracepoints of one program must have the same language");
+    }
+
     // Transform tracepoint program.
     Dwarvifier dwarvifier(dwarf_reader, elf_reader, input_tracepoint.program().language());
     PX_RETURN_IF_ERROR(dwarvifier.Generate(input_tracepoint.program(), &output_program));
   }
 
+  absl::flat_hash_set<std::string_view> names;
+  for (const auto& map : output_program.maps()) {
+    if (!names.insert(map.name()).second) {
+      return error::InvalidArgument("Map '$0' is declared more than once", map.name());
+    }
+  }
+  for (const auto& output : output_program.outputs()) {
+    if (!names.insert(output.name()).second) {
+      return error::InvalidArgument("Output '$0' is declared more than once", output.name());
+    }
+  }
+  for (const auto& probe : output_program.probes()) {
+    if (!names.insert(probe.name()).second) {
+      return error::InvalidArgument("Probe '$0' is declared more than once", probe.name());
+    }
+  }
+
   return output_program;
 }
 
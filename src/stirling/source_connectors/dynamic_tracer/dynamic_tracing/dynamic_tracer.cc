@@ -18,13 +18,17 @@
 
 #include "src/stirling/source_connectors/dynamic_tracer/dynamic_tracing/dynamic_tracer.h"
 
+#include <absl/synchronization/mutex.h>
+
 #include <algorithm>
 #include <memory>
+#include <optional>
 #include <regex>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "src/common/base/lru_cache.h"
 #include "src/common/fs/fs_wrapper.h"
 #include "src/common/system/proc_pid_path.h"
 #include "src/common/system/system.h"
@@ -35,6 +39,7 @@
 #include "src/stirling/bpf_tools/utils.h"
 #include "src/stirling/obj_tools/dwarf_reader.h"
 #include "src/stirling/obj_tools/elf_reader.h"
+#include "src/stirling/obj_tools/go_syms.h"
 #include "src/stirling/source_connectors/dynamic_tracer/dynamic_tracing/autogen.h"
 #include "src/stirling/source_connectors/dynamic_tracer/dynamic_tracing/code_gen.h"
 #include "src/stirling/source_connectors/dynamic_tracer/dynamic_tracing/dwarvifier.h"
@@ -43,6 +48,10 @@
 #include "src/stirling/utils/proc_path_tools.h"
 
 DEFINE_bool(debug_dt_pipeline, false, "Enable logging of the Dynamic Tracing pipeline IR graphs.");
+DEFINE_uint32(stirling_dt_program_cache_size,
+              gflags::Uint32FromEnv("PL_STIRLING_DT_PROGRAM_CACHE_SIZE", 64),
+              "The number of compiled dynamic tracing programs to keep, keyed by the tracepoint "
+              "and the build ID of the target binary. 0 disables the cache.");
 
 namespace px {
 namespace stirling {
@@ -103,39 +112,23 @@ struct ObjInfo {
   std::unique_ptr<DwarfReader> dwarf_reader;
 };
 
-// Prepares the input program for compilation by:
-// 1) Resolving the tracepoint target specification into an object path (e.g. UPID->path).
-// 2) Preparing the Elf and Dwarf info for the binary.
-StatusOr<ObjInfo> Prepare(const ir::logical::TracepointDeployment& input_program) {
+// Prepares the input program for compilation by preparing the Elf and Dwarf info for the binary.
+ObjInfo Prepare(std::unique_ptr<ElfReader> elf_reader) {
   ObjInfo obj_info;
-
-  const auto& binary_path = input_program.deployment_spec().path_list().paths(0);
-  LOG(INFO) << absl::Substitute("Tracepoint binary: $0", binary_path);
-
-  PX_ASSIGN_OR_RETURN(obj_info.elf_reader, ElfReader::Create(binary_path));
+  obj_info.elf_reader = std::move(elf_reader);
 
   const auto& debug_symbols_path = obj_info.elf_reader->debug_symbols_path().string();
 
   obj_info.dwarf_reader =
-      DwarfReader::CreateIndexingAll(debug_symbols_path).ConsumeValueOr(nullptr);
+      DwarfReader::CreateWithLazyIndexing(debug_symbols_path).ConsumeValueOr(nullptr);
 
   return obj_info;
 }
 
-}  // namespace
-
-StatusOr<BCCProgram> CompileProgram(ir::logical::TracepointDeployment* input_program) {
-  if (input_program->deployment_spec().path_list().paths_size() == 0) {
-    return error::InvalidArgument("Must have path resolved before compiling program");
-  }
-
-  if (input_program->tracepoints_size() != 1) {
-    return error::InvalidArgument("Only one tracepoint currently supported, got '$0'",
-                                  input_program->tracepoints_size());
-  }
-
+StatusOr<BCCProgram> CompileProgramUncached(std::unique_ptr<ElfReader> elf_reader,
+                                            ir::logical::TracepointDeployment* input_program) {
   // Get the ELF and DWARF readers for the program.
-  PX_ASSIGN_OR_RETURN(ObjInfo obj_info, Prepare(*input_program));
+  ObjInfo obj_info = Prepare(std::move(elf_reader));
 
   // --------------------------
   // Pre-processing pipeline
@@ -207,6 +200,114 @@ StatusOr<BCCProgram> CompileProgram(ir::logical::TracepointDeployment* input_pro
   return bcc_program;
 }
 
+// The output of compiling a tracepoint against a binary. Includes the pre-processed tracepoints,
+// which CompileProgram() writes back into its input.
+struct CompiledProgram {
+  google::protobuf::RepeatedPtrField<ir::logical::TracepointDeployment::Tracepoint> tracepoints;
+  BCCProgram bcc_program;
+};
+
+// Caches compiled programs, so that deploying a tracepoint to many processes running the same
+// binary, or redeploying it when its TTL is refreshed, skips the DWARF lookups and code generation.
+// The program only depends on the binary through its symbols, so programs are keyed by build ID
+// rather than path; the uprobes are re-targeted to the path of each deployment.
+class CompiledProgramCache {
+ public:
+  static CompiledProgramCache& Get() {
+    static auto* cache = new CompiledProgramCache(FLAGS_stirling_dt_program_cache_size);
+    return *cache;
+  }
+
+  std::optional<CompiledProgram> Lookup(const std::string& key) {
+    absl::MutexLock lock(&mu_);
+    if (programs_ == nullptr) {
+      return std::nullopt;
+    }
+    const CompiledProgram* program = programs_->Get(key);
+    if (program == nullptr) {
+      return std::nullopt;
+    }
+    return *program;
+  }
+
+  void Insert(const std::string& key, CompiledProgram program) {
+    absl::MutexLock lock(&mu_);
+    if (programs_ != nullptr) {
+      programs_->Put(key, std::move(program));
+    }
+  }
+
+ private:
+  explicit CompiledProgramCache(size_t capacity) {
+    if (capacity > 0) {
+      programs_ = std::make_unique<LRUCache<std::string, CompiledProgram>>(capacity);
+    }
+  }
+
+  absl::Mutex mu_;
+  std::unique_ptr<LRUCache<std::string, CompiledProgram>> programs_ ABSL_GUARDED_BY(mu_);
+};
+
+// Returns the cache key of compiling the tracepoints of the program against the binary,
+// or an empty string if the binary has no build ID to identify it by.
+std::string CompiledProgramCacheKey(ElfReader* elf_reader,
+                                    const ir::logical::TracepointDeployment& program) {
+  std::string build_id = elf_reader->build_id();
+  if (build_id.empty()) {
+    build_id = obj_tools::ReadGoBuildID(elf_reader);
+  }
+  if (build_id.empty()) {
+    return "";
+  }
+  // The name, TTL and deployment target of the program do not affect the compiled output.
+  std::string key = build_id;
+  for (const auto& tracepoint : program.tracepoints()) {
+    absl::StrAppend(&key, "\n", tracepoint.ShortDebugString());
+  }
+  return key;
+}
+
+}  // namespace
+
+StatusOr<BCCProgram> CompileProgram(ir::logical::TracepointDeployment* input_program) {
+  if (input_program->deployment_spec().path_list().paths_size() == 0) {
+    return error::InvalidArgument("Must have path resolved before compiling program");
+  }
+
+  if (input_program->tracepoints().empty()) {
+    return error::InvalidArgument("Must have at least one tracepoint");
+  }
+
+  const auto& binary_path = input_program->deployment_spec().path_list().paths(0);
+  LOG(INFO) << absl::Substitute("Tracepoint binary: $0", binary_path);
+
+  PX_ASSIGN_OR_RETURN(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(binary_path));
+
+  const std::string cache_key = CompiledProgramCacheKey(elf_reader.get(), *input_program);
+
+  if (!cache_key.empty()) {
+    std::optional<CompiledProgram> cached = CompiledProgramCache::Get().Lookup(cache_key);
+    if (cached.has_value()) {
+      VLOG(1) << absl::Substitute("Reusing compiled program for tracepoint binary: $0",
+                                  binary_path);
+      *input_program->mutable_tracepoints() = std::move(cached->tracepoints);
+      for (auto& spec : cached->bcc_program.uprobe_specs) {
+        spec.binary_path = binary_path;
+      }
+      return std::move(cached->bcc_program);
+    }
+  }
+
+  PX_ASSIGN_OR_RETURN(BCCProgram bcc_program,
+                      CompileProgramUncached(std::move(elf_reader), input_program));
+
+  if (!cache_key.empty()) {
+    CompiledProgramCache::Get().Insert(cache_key, {input_program->tracepoints(), bcc_program});
+  }
+
+  return bcc_program;
+}
+
 namespace {
 
 Status CheckPIDStartTime(const ProcParser& proc_parser, int32_t pid, int64_t spec_start_time) {
@@ -44,6 +44,8 @@ Status ResolveTargetObjPaths(const md::K8sMetadataState& k8s_mds,
 /**
  * Transforms any logical probes inside a program into entry and return probes.
  * Also automatically adds any required supporting maps and implicit outputs.
+ * All tracepoints of the deployment are compiled into a single BPF program, with one perf buffer
+ * per output.
  */
 StatusOr<BCCProgram> CompileProgram(ir::logical::TracepointDeployment* input_program);
 
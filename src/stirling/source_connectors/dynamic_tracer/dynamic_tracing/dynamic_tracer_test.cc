@@ -140,9 +140,9 @@ class ResolveTargetObjPathTest : public ::testing::Test {
     ASSERT_OK(k8s_mds_.HandlePodUpdate(pod0_update));
     ASSERT_OK(k8s_mds_.HandlePodUpdate(pod1_update));
 
-    k8s_mds_.containers_by_id()["pod0_container0"]->mutable_active_upids()->emplace(
+    k8s_mds_.MutableContainerInfoByID("pod0_container0")->mutable_active_upids()->emplace(
         PIDToUPID(server_.child_pid()));
-    k8s_mds_.containers_by_id()["pod1_container0"]->mutable_active_upids()->emplace(
+    k8s_mds_.MutableContainerInfoByID("pod1_container0")->mutable_active_upids()->emplace(
         PIDToUPID(client_.child_pid()));
 
     // On some machines, apparently it can take some time for /proc/<pid>/cmdline
@@ -520,6 +520,38 @@ TEST(DynamicTracerTest, Compile) {
   EXPECT_THAT(code_lines, ElementsAreArray(kExpectedBCC));
 }
 
+// Compiling the same tracepoint against another path to the same binary reuses the compiled
+// program, re-targeted to the new path.
+TEST(DynamicTracerTest, CompileReusesProgramAcrossPaths) {
+  const std::filesystem::path binary_path = px::testing::BazelRunfilePath(kBinaryPath);
+  px::testing::TempDir temp_dir;
+  const std::filesystem::path binary_link = temp_dir.path() / "binary_link";
+  ASSERT_OK(fs::CreateSymlink(binary_path, binary_link));
+
+  ir::logical::TracepointDeployment input_program;
+  ASSERT_TRUE(TextFormat::ParseFromString(
+      absl::Substitute(kLogicalProgramSpec, binary_path.string()), &input_program));
+  ASSERT_OK_AND_ASSIGN(BCCProgram bcc_program, CompileProgram(&input_program));
+
+  ir::logical::TracepointDeployment link_input_program;
+  ASSERT_TRUE(TextFormat::ParseFromString(
+      absl::Substitute(kLogicalProgramSpec, binary_link.string()), &link_input_program));
+  ASSERT_OK_AND_ASSIGN(BCCProgram link_bcc_program, CompileProgram(&link_input_program));
+
+  EXPECT_EQ(link_bcc_program.code, bcc_program.code);
+  ASSERT_THAT(link_bcc_program.uprobe_specs, SizeIs(bcc_program.uprobe_specs.size()));
+  for (size_t i = 0; i < bcc_program.uprobe_specs.size(); ++i) {
+    EXPECT_EQ(link_bcc_program.uprobe_specs[i].binary_path, binary_link.string());
+    EXPECT_EQ(link_bcc_program.uprobe_specs[i].symbol, bcc_program.uprobe_specs[i].symbol);
+    EXPECT_EQ(link_bcc_program.uprobe_specs[i].probe_fn, bcc_program.uprobe_specs[i].probe_fn);
+  }
+
+  // The pre-processed tracepoints are written back to the input either way.
+  ASSERT_THAT(link_input_program.tracepoints(), SizeIs(1));
+  EXPECT_THAT(link_input_program.tracepoints(0),
+              EqualsProto(input_program.tracepoints(0).DebugString()));
+}
+
 }  // namespace dynamic_tracing
 }  // namespace stirling
 }  // namespace px
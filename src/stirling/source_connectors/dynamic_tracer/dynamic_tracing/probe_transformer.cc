@@ -194,6 +194,9 @@ StatusOr<ir::logical::TracepointDeployment> TransformLogicalProgram(
 
   std::map<std::string_view, ir::logical::Output*> outputs;
 
+  // Tracepoints compiled into the same program share a single GOID map and probe.
+  bool goid_probe_added = false;
+
   // Copy the binary path.
   out.mutable_deployment_spec()->CopyFrom(input_program.deployment_spec());
 
@@ -223,7 +226,8 @@ StatusOr<ir::logical::TracepointDeployment> TransformLogicalProgram(
     }
 
     if (!input_tracepoint_spec.probes().empty()) {
-      if (input_tracepoint_spec.language() == ir::shared::GOLANG) {
+      if (input_tracepoint_spec.language() == ir::shared::GOLANG && !goid_probe_added) {
+        goid_probe_added = true;
         out_tracepoint_spec->add_maps()->CopyFrom(GenGOIDMap());
         out_tracepoint_spec->add_probes()->CopyFrom(GenGOIDProbe());
       }
@@ -296,6 +296,33 @@ TEST_F(ProbeGenTest, ErrorCases) {
   // TODO(oazizi): Add more.
 }
 
+TEST_F(ProbeGenTest, TracepointsShareGOIDProbe) {
+  std::string input_program_str = absl::Substitute(kLogicalProgram, binary_path_);
+  ir::logical::TracepointDeployment input_program;
+  ASSERT_TRUE(TextFormat::ParseFromString(input_program_str, &input_program));
+
+  auto* second = input_program.add_tracepoints();
+  second->CopyFrom(input_program.tracepoints(0));
+  second->mutable_program()->mutable_outputs(0)->set_name("probe1_table");
+  second->mutable_program()->mutable_probes(0)->set_name("probe1");
+  second->mutable_program()->mutable_probes(0)->mutable_output_actions(0)->set_output_name(
+      "probe1_table");
+
+  ASSERT_OK_AND_ASSIGN(ir::logical::TracepointDeployment output,
+                       TransformLogicalProgram(input_program));
+  ASSERT_EQ(output.tracepoints_size(), 2);
+
+  int num_goid_probes = 0;
+  for (const auto& tracepoint : output.tracepoints()) {
+    for (const auto& probe : tracepoint.program().probes()) {
+      if (probe.name() == "probe_entry_runtime_casgstatus") {
+        ++num_goid_probes;
+      }
+    }
+  }
+  EXPECT_EQ(num_goid_probes, 1);
+}
+
 }  // namespace dynamic_tracing
 }  // namespace stirling
 }  // namespace px
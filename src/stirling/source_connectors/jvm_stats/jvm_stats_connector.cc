@@ -69,21 +69,19 @@ void JVMStatsConnector::FindJavaUPIDs(const ConnectorContext& ctx) {
   }
 }
 
-Status JVMStatsConnector::ExportStats(const md::UPID& upid,
-                                      const std::filesystem::path& hsperf_data_path,
+Status JVMStatsConnector::ExportStats(const md::UPID& upid, JavaProcInfo* java_proc,
                                       DataTable* data_table) const {
-  PX_ASSIGN_OR_RETURN(std::string hsperf_data_str, ReadFileToString(hsperf_data_path));
-
-  if (hsperf_data_str.empty()) {
-    // Assume this is a transient failure.
-    return Status::OK();
+  if (java_proc->mapped_stats == nullptr || java_proc->mapped_stats->Stale()) {
+    java_proc->mapped_stats.reset();
+    auto mapped_stats_or = java::MappedStats::Create(java_proc->hsperf_data_path);
+    if (error::IsInvalidArgument(mapped_stats_or.status())) {
+      // Assumes this is a transient failure, e.g. the JVM has not finished initializing the file.
+      return Status::OK();
+    }
+    PX_ASSIGN_OR_RETURN(java_proc->mapped_stats, std::move(mapped_stats_or));
   }
 
-  java::Stats stats(std::move(hsperf_data_str));
-  if (!stats.Parse().ok()) {
-    // Assumes this is a transient failure.
-    return Status::OK();
-  }
+  const java::Stats stats = java_proc->mapped_stats->Read();
 
   uint64_t time = AdjustedSteadyClockNowNS();
 
@@ -114,7 +112,7 @@ void JVMStatsConnector::TransferDataImpl(ConnectorContext* ctx) {
     JavaProcInfo& java_proc = iter->second;
 
     md::UPID upid_with_asid(ctx->GetASID(), upid.pid(), upid.start_ts());
-    auto status = ExportStats(upid_with_asid, java_proc.hsperf_data_path, data_table);
+    auto status = ExportStats(upid_with_asid, &java_proc, data_table);
     if (!status.ok()) {
       ++java_proc.export_failure_count;
     }
@@ -18,13 +18,21 @@
 
 #include "src/stirling/source_connectors/jvm_stats/utils/java.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <absl/strings/match.h>
 
+#include <array>
+#include <cstring>
 #include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "src/common/base/base.h"
 #include "src/common/base/byte_utils.h"
 #include "src/common/base/statusor.h"
 #include "src/common/fs/fs_wrapper.h"
@@ -43,6 +51,44 @@ using ::px::system::ProcParser;
 using ::px::system::ProcPidRootPath;
 using ::px::utils::LEndianBytesToInt;
 
+namespace {
+
+constexpr std::string_view kYoungGCTimeSuffix = "gc.collector.0.time";
+constexpr std::string_view kFullGCTimeSuffix = "gc.collector.1.time";
+constexpr std::array<std::string_view, 4> kUsedHeapSizeSuffixes = {
+    "gc.generation.0.space.0.used",
+    "gc.generation.0.space.1.used",
+    "gc.generation.0.space.2.used",
+    "gc.generation.1.space.0.used",
+};
+constexpr std::array<std::string_view, 4> kTotalHeapSizeSuffixes = {
+    "gc.generation.0.space.0.capacity",
+    "gc.generation.0.space.1.capacity",
+    "gc.generation.0.space.2.capacity",
+    "gc.generation.1.space.0.capacity",
+};
+constexpr std::array<std::string_view, 2> kMaxHeapSizeSuffixes = {
+    "gc.generation.0.maxCapacity",
+    "gc.generation.1.maxCapacity",
+};
+
+// Returns true if the named stat is used to compute any of the values exported by Stats.
+bool IsUsedStat(std::string_view name) {
+  auto ends_with_any = [name](absl::Span<const std::string_view> suffixes) {
+    for (const auto& suffix : suffixes) {
+      if (absl::EndsWith(name, suffix)) {
+        return true;
+      }
+    }
+    return false;
+  };
+  return absl::EndsWith(name, kYoungGCTimeSuffix) || absl::EndsWith(name, kFullGCTimeSuffix) ||
+         ends_with_any(kUsedHeapSizeSuffixes) || ends_with_any(kTotalHeapSizeSuffixes) ||
+         ends_with_any(kMaxHeapSizeSuffixes);
+}
+
+}  // namespace
+
 Stats::Stats(std::vector<Stat> stats) : stats_(std::move(stats)) {}
 
 Stats::Stats(std::string hsperf_data_str) : hsperf_data_(std::move(hsperf_data_str)) {}
@@ -60,34 +106,15 @@ Status Stats::Parse() {
   return Status::OK();
 }
 
-uint64_t Stats::YoungGCTimeNanos() const { return StatForSuffix("gc.collector.0.time"); }
+uint64_t Stats::YoungGCTimeNanos() const { return StatForSuffix(kYoungGCTimeSuffix); }
 
-uint64_t Stats::FullGCTimeNanos() const { return StatForSuffix("gc.collector.1.time"); }
+uint64_t Stats::FullGCTimeNanos() const { return StatForSuffix(kFullGCTimeSuffix); }
 
-uint64_t Stats::UsedHeapSizeBytes() const {
-  return SumStatsForSuffixes({
-      "gc.generation.0.space.0.used",
-      "gc.generation.0.space.1.used",
-      "gc.generation.0.space.2.used",
-      "gc.generation.1.space.0.used",
-  });
-}
+uint64_t Stats::UsedHeapSizeBytes() const { return SumStatsForSuffixes(kUsedHeapSizeSuffixes); }
 
-uint64_t Stats::TotalHeapSizeBytes() const {
-  return SumStatsForSuffixes({
-      "gc.generation.0.space.0.capacity",
-      "gc.generation.0.space.1.capacity",
-      "gc.generation.0.space.2.capacity",
-      "gc.generation.1.space.0.capacity",
-  });
-}
+uint64_t Stats::TotalHeapSizeBytes() const { return SumStatsForSuffixes(kTotalHeapSizeSuffixes); }
 
-uint64_t Stats::MaxHeapSizeBytes() const {
-  return SumStatsForSuffixes({
-      "gc.generation.0.maxCapacity",
-      "gc.generation.1.maxCapacity",
-  });
-}
+uint64_t Stats::MaxHeapSizeBytes() const { return SumStatsForSuffixes(kMaxHeapSizeSuffixes); }
 
 uint64_t Stats::StatForSuffix(std::string_view suffix) const {
   for (const auto& stat : stats_) {
@@ -98,7 +125,7 @@ uint64_t Stats::StatForSuffix(std::string_view suffix) const {
   return 0;
 }
 
-uint64_t Stats::SumStatsForSuffixes(const std::vector<std::string_view>& suffixes) const {
+uint64_t Stats::SumStatsForSuffixes(absl::Span<const std::string_view> suffixes) const {
   uint64_t sum = 0;
   for (const auto& suffix : suffixes) {
     sum += StatForSuffix(suffix);
@@ -106,6 +133,86 @@ uint64_t Stats::SumStatsForSuffixes(const std::vector<std::string_view>& suffixe
   return sum;
 }
 
+StatusOr<std::unique_ptr<MappedStats>> MappedStats::Create(const std::filesystem::path& path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return error::NotFound("Could not open $0: $1", path.string(), std::strerror(errno));
+  }
+  DEFER(close(fd));
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    return error::Internal("Could not stat $0: $1", path.string(), std::strerror(errno));
+  }
+  const size_t file_size = st.st_size;
+  if (file_size < sizeof(hsperf::Prologue)) {
+    return error::InvalidArgument("Not enough data");
+  }
+
+  // Shared, so that the updates made by the JVM are visible through the mapping.
+  void* addr = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    return error::Internal("Could not mmap $0: $1", path.string(), std::strerror(errno));
+  }
+
+  // From here on, the destructor unmaps the file.
+  auto mapped_stats = std::unique_ptr<MappedStats>(new MappedStats());
+  mapped_stats->path_ = path;
+  mapped_stats->data_ = static_cast<const char*>(addr);
+  mapped_stats->data_size_ = file_size;
+  mapped_stats->dev_ = st.st_dev;
+  mapped_stats->inode_ = st.st_ino;
+
+  const std::string_view buf(mapped_stats->data_, mapped_stats->data_size_);
+  hsperf::HsperfData hsperf_data = {};
+  PX_RETURN_IF_ERROR(ParseHsperfData(buf, &hsperf_data));
+  mapped_stats->num_entries_ = hsperf_data.prologue->num_entries;
+  for (const auto& entry : hsperf_data.data_entries) {
+    if (entry.header->data_type != static_cast<uint8_t>(hsperf::DataType::kLong) ||
+        entry.data.size() != sizeof(uint64_t) || !IsUsedStat(entry.name)) {
+      continue;
+    }
+    mapped_stats->counters_.push_back(
+        {entry.name, static_cast<size_t>(entry.data.data() - mapped_stats->data_)});
+  }
+  return mapped_stats;
+}
+
+MappedStats::~MappedStats() {
+  if (data_ != nullptr) {
+    munmap(const_cast<char*>(data_), data_size_);
+  }
+}
+
+uint32_t MappedStats::NumEntries() const {
+  uint32_t num_entries;
+  std::memcpy(&num_entries, data_ + offsetof(hsperf::Prologue, num_entries), sizeof(num_entries));
+  return num_entries;
+}
+
+bool MappedStats::Stale() const {
+  struct stat st;
+  if (stat(path_.c_str(), &st) != 0) {
+    return true;
+  }
+  if (st.st_dev != dev_ || st.st_ino != inode_ || static_cast<size_t>(st.st_size) != data_size_) {
+    return true;
+  }
+  // The JVM creates counters lazily, some of which might not have existed at Create().
+  return NumEntries() != num_entries_;
+}
+
+Stats MappedStats::Read() const {
+  std::vector<Stats::Stat> stats;
+  stats.reserve(counters_.size());
+  for (const auto& counter : counters_) {
+    auto value = LEndianBytesToInt<uint64_t>(
+        std::string_view(data_ + counter.offset, sizeof(uint64_t)));
+    stats.push_back({counter.name, value});
+  }
+  return Stats(std::move(stats));
+}
+
 StatusOr<std::filesystem::path> HsperfdataPath(pid_t pid) {
   ProcParser parser;
 
@@ -18,12 +18,17 @@
 
 #pragma once
 
+#include <sys/types.h>
+
 #include <filesystem>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include <absl/types/span.h>
+
 #include "src/common/base/statusor.h"
 
 namespace px {
@@ -58,12 +63,58 @@ class Stats {
 
  private:
   uint64_t StatForSuffix(std::string_view suffix) const;
-  uint64_t SumStatsForSuffixes(const std::vector<std::string_view>& suffixes) const;
+  uint64_t SumStatsForSuffixes(absl::Span<const std::string_view> suffixes) const;
 
   std::string hsperf_data_;
   std::vector<Stat> stats_;
 };
 
+/**
+ * MappedStats memory-maps a hsperfdata file, and resolves the offsets of the counters used by
+ * Stats once. The JVM updates these counters in place, so each sample then only reads a few words
+ * from the mapping, instead of reading and parsing the whole file.
+ */
+class MappedStats {
+ public:
+  /**
+   * Maps the hsperfdata file at the path, and resolves the offsets of the counters.
+   * Returns InvalidArgument if the file is not (yet) a valid hsperfdata file.
+   */
+  static StatusOr<std::unique_ptr<MappedStats>> Create(const std::filesystem::path& path);
+
+  ~MappedStats();
+
+  /**
+   * Returns true if the file at the path is no longer the mapped file, or if the JVM has created
+   * new counters since the offsets were resolved. The mapping should then be re-created.
+   */
+  bool Stale() const;
+
+  /**
+   * Returns the current values of the counters. The returned Stats refers to the mapping, and must
+   * not outlive this object.
+   */
+  Stats Read() const;
+
+ private:
+  MappedStats() = default;
+
+  uint32_t NumEntries() const;
+
+  struct Counter {
+    std::string_view name;
+    size_t offset;
+  };
+
+  std::filesystem::path path_;
+  const char* data_ = nullptr;
+  size_t data_size_ = 0;
+  dev_t dev_ = 0;
+  ino_t inode_ = 0;
+  uint32_t num_entries_ = 0;
+  std::vector<Counter> counters_;
+};
+
 /**
  * Returns the path of the hsperfdata for a JVM process.
  */
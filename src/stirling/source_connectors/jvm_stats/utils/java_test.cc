@@ -22,14 +22,17 @@
 #include <gtest/gtest.h>
 
 #include <filesystem>
+#include <fstream>
 #include <string>
 #include <string_view>
 
 #include <absl/strings/match.h>
 
 #include "src/common/exec/subprocess.h"
+#include "src/common/testing/temp_dir.h"
 #include "src/common/testing/test_environment.h"
 #include "src/common/testing/testing.h"
+#include "src/stirling/source_connectors/jvm_stats/utils/hsperfdata.h"
 
 namespace px {
 namespace stirling {
@@ -59,6 +62,66 @@ TEST(StatsTest, CommonValues) {
   EXPECT_EQ(2, stats.MaxHeapSizeBytes());
 }
 
+// Tests that MappedStats reads the same values as parsing the file, follows in-place updates of
+// the counters, and detects that the file was replaced.
+TEST(MappedStatsTest, ReadsCountersFromMapping) {
+  const std::filesystem::path test_hsperfdata_path =
+      testing::BazelRunfilePath("src/stirling/source_connectors/jvm_stats/utils/test_hsperfdata");
+  ASSERT_OK_AND_ASSIGN(std::string content, ReadFileToString(test_hsperfdata_path));
+
+  testing::TempDir temp_dir;
+  const std::filesystem::path hsperf_data_path = temp_dir.path() / "1234";
+  std::filesystem::copy_file(test_hsperfdata_path, hsperf_data_path);
+
+  Stats parsed_stats(content);
+  ASSERT_OK(parsed_stats.Parse());
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<MappedStats> mapped_stats,
+                       MappedStats::Create(hsperf_data_path));
+  EXPECT_FALSE(mapped_stats->Stale());
+  {
+    const Stats stats = mapped_stats->Read();
+    EXPECT_EQ(stats.YoungGCTimeNanos(), parsed_stats.YoungGCTimeNanos());
+    EXPECT_EQ(stats.FullGCTimeNanos(), parsed_stats.FullGCTimeNanos());
+    EXPECT_EQ(stats.UsedHeapSizeBytes(), parsed_stats.UsedHeapSizeBytes());
+    EXPECT_EQ(stats.TotalHeapSizeBytes(), parsed_stats.TotalHeapSizeBytes());
+    EXPECT_EQ(stats.MaxHeapSizeBytes(), parsed_stats.MaxHeapSizeBytes());
+  }
+
+  // Updates the young GC time in place, like the JVM does.
+  hsperf::HsperfData hsperf_data = {};
+  ASSERT_OK(hsperf::ParseHsperfData(content, &hsperf_data));
+  size_t young_gc_time_offset = 0;
+  for (const auto& entry : hsperf_data.data_entries) {
+    if (absl::EndsWith(entry.name, "gc.collector.0.time")) {
+      young_gc_time_offset = entry.data.data() - content.data();
+    }
+  }
+  ASSERT_NE(young_gc_time_offset, 0U);
+  const uint64_t young_gc_time = parsed_stats.YoungGCTimeNanos() + 1000;
+  {
+    std::fstream file(hsperf_data_path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(young_gc_time_offset);
+    file.write(reinterpret_cast<const char*>(&young_gc_time), sizeof(young_gc_time));
+  }
+  EXPECT_FALSE(mapped_stats->Stale());
+  EXPECT_EQ(mapped_stats->Read().YoungGCTimeNanos(), young_gc_time);
+
+  // Replaces the file, like a restarted JVM with the same PID would.
+  const std::filesystem::path new_hsperf_data_path = temp_dir.path() / "new";
+  std::filesystem::copy_file(test_hsperfdata_path, new_hsperf_data_path);
+  std::filesystem::rename(new_hsperf_data_path, hsperf_data_path);
+  EXPECT_TRUE(mapped_stats->Stale());
+}
+
+// Tests that an empty file, as seen before the JVM initializes it, is reported as such.
+TEST(MappedStatsTest, EmptyFile) {
+  testing::TempDir temp_dir;
+  const std::filesystem::path hsperf_data_path = temp_dir.path() / "1234";
+  ASSERT_OK(WriteFileFromString(hsperf_data_path.string(), ""));
+  EXPECT_TRUE(error::IsInvalidArgument(MappedStats::Create(hsperf_data_path).status()));
+}
+
 TEST(HsperfdataPathTest, ResultIsAsExpected) {
   const std::string javaBinPath =
       testing::BazelRunfilePath("src/stirling/source_connectors/jvm_stats/testing/HelloWorld");
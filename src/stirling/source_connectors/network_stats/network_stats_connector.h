@@ -57,19 +57,17 @@ class NetworkStatsConnector : public SourceConnector {
 
  protected:
   explicit NetworkStatsConnector(std::string_view source_name)
-      : SourceConnector(source_name, kTables) {
-    proc_parser_ = std::make_unique<system::ProcParser>();
-  }
+      : SourceConnector(source_name, kTables) {}
 
  private:
   void TransferNetworkStatsTable(ConnectorContext* ctx, DataTable* data_table);
 
-  static Status GetNetworkStatsForPod(const system::ProcParser& proc_parser,
+  static Status GetNetworkStatsForPod(system::ProcStatsReader* proc_stats_reader,
                                       const md::PodInfo& pod_info,
                                       const md::K8sMetadataState& k8s_metadata_state,
                                       system::ProcParser::NetworkStats* stats);
 
-  std::unique_ptr<system::ProcParser> proc_parser_;
+  system::ProcStatsReader proc_stats_reader_;
 };
 
 }  // namespace stirling
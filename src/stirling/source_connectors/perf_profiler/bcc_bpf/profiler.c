@@ -115,3 +115,100 @@ int sample_call_stack(struct bpf_perf_event_data* ctx) {
 
   return 0;
 }
+
+#if CFG_OFF_CPU_PROFILING
+// Off-CPU profiling: instead of sampling the threads that are running, account the time that
+// threads spend switched out by the scheduler (blocked on I/O, locks, sleeps, or waiting to run)
+// to the stack trace at which they were switched out. The blocked time is aggregated in BPF,
+// per stack-trace-key, into off_cpu_histogram_a/b. The stack-ids index into the same
+// stack_traces_a/b maps as the on-CPU samples, and follow the same double buffering scheme.
+//
+// A thread that is switched back in after user space has switched map sets is not accounted
+// here: its stack-ids belong to the map set that user space has drained. User space instead
+// accounts such threads, up to the switch over, from off_cpu_starts.
+BPF_HASH(off_cpu_histogram_a, struct stack_trace_key_t, struct off_cpu_value_t,
+         CFG_STACK_TRACE_ENTRIES);
+BPF_HASH(off_cpu_histogram_b, struct stack_trace_key_t, struct off_cpu_value_t,
+         CFG_STACK_TRACE_ENTRIES);
+
+// Map from thread id to where and when the thread was switched out.
+BPF_HASH(off_cpu_starts, uint32_t, struct off_cpu_start_t, CFG_OFF_CPU_MAX_THREADS);
+
+// The switched out thread is the current task, so its stack trace is collected here.
+static __inline void record_off_cpu_start(void* ctx, uint32_t tid, uint64_t transfer_count,
+                                          uint64_t now_ns) {
+  struct off_cpu_start_t start = {};
+  start.key.upid.tgid = bpf_get_current_pid_tgid() >> 32;
+  start.key.upid.start_time_ticks = get_tgid_start_time();
+  start.start_ns = now_ns;
+  start.transfer_count = transfer_count;
+
+  if (transfer_count % 2 == 0) {
+    start.key.user_stack_id = stack_traces_a.get_stackid(ctx, BPF_F_USER_STACK);
+    start.key.kernel_stack_id = stack_traces_a.get_stackid(ctx, 0);
+  } else {
+    start.key.user_stack_id = stack_traces_b.get_stackid(ctx, BPF_F_USER_STACK);
+    start.key.kernel_stack_id = stack_traces_b.get_stackid(ctx, 0);
+  }
+
+  off_cpu_starts.update(&tid, &start);
+}
+
+static __inline void record_off_cpu_end(uint32_t tid, uint64_t transfer_count, uint64_t now_ns) {
+  struct off_cpu_start_t* start = off_cpu_starts.lookup(&tid);
+  if (start == NULL) {
+    return;
+  }
+
+  struct stack_trace_key_t key = start->key;
+  const uint64_t blocked_ns = now_ns - start->start_ns;
+  const bool is_current_map_set = start->transfer_count == transfer_count;
+  off_cpu_starts.delete(&tid);
+
+  if (!is_current_map_set) {
+    return;
+  }
+
+  struct off_cpu_value_t zero = {};
+  struct off_cpu_value_t* value = NULL;
+  if (transfer_count % 2 == 0) {
+    value = off_cpu_histogram_a.lookup_or_init(&key, &zero);
+  } else {
+    value = off_cpu_histogram_b.lookup_or_init(&key, &zero);
+  }
+  if (value == NULL) {
+    return;
+  }
+  lock_xadd(&value->blocked_ns, blocked_ns);
+  lock_xadd(&value->count, 1);
+}
+
+TRACEPOINT_PROBE(sched, sched_switch) {
+  int transfer_count_idx = kTransferCountIdx;
+  uint64_t* transfer_count_ptr = profiler_state.lookup(&transfer_count_idx);
+  if (transfer_count_ptr == NULL) {
+    int error_status_idx = kErrorStatusIdx;
+    uint64_t rd_fail_status_code = kMapReadFailureError;
+    profiler_state.update(&error_status_idx, &rd_fail_status_code);
+    return 0;
+  }
+
+  const uint64_t transfer_count = *transfer_count_ptr;
+  const uint64_t now_ns = bpf_ktime_get_ns();
+
+  // Thread id 0 is the idle task of each CPU. Exiting threads are switched out one last time,
+  // and are never switched back in.
+  const uint32_t prev_tid = args->prev_pid;
+  const bool prev_is_exiting = args->prev_state & (EXIT_DEAD | EXIT_ZOMBIE | TASK_DEAD);
+  if (prev_tid != 0 && !prev_is_exiting) {
+    record_off_cpu_start(args, prev_tid, transfer_count, now_ns);
+  }
+
+  const uint32_t next_tid = args->next_pid;
+  if (next_tid != 0) {
+    record_off_cpu_end(next_tid, transfer_count, now_ns);
+  }
+
+  return 0;
+}
+#endif
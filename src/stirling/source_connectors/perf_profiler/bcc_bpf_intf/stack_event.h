@@ -71,6 +71,21 @@ struct stack_trace_key_t {
 #endif
 };
 
+// The off-CPU histogram value: the time that a stack trace spent blocked (switched out by the
+// scheduler), and the number of times that it blocked.
+struct off_cpu_value_t {
+  uint64_t blocked_ns;
+  uint64_t count;
+};
+
+// Where and when a thread was switched out; kept until the thread is switched back in.
+// The stack-ids index into the stack-traces map of the set that transfer_count selected.
+struct off_cpu_start_t {
+  struct stack_trace_key_t key;
+  uint64_t start_ns;
+  uint64_t transfer_count;
+};
+
 // Bit positions in the error status bitfield:
 static const uint32_t kOverflowBitPos = 0;
 static const uint32_t kMapReadFailureBitPos = 1;
@@ -85,4 +100,10 @@ static const uint64_t kMapReadFailureError = 1ULL << kMapReadFailureBitPos;
 static const std::string kHistogramAName = "histogram_a";
 // NOLINTNEXTLINE : runtime/string
 static const std::string kHistogramBName = "histogram_b";
+// NOLINTNEXTLINE : runtime/string
+static const std::string kOffCPUHistogramAName = "off_cpu_histogram_a";
+// NOLINTNEXTLINE : runtime/string
+static const std::string kOffCPUHistogramBName = "off_cpu_histogram_b";
+// NOLINTNEXTLINE : runtime/string
+static const std::string kOffCPUStartsName = "off_cpu_starts";
 #endif
@@ -17,15 +17,20 @@
  */
 
 #include "src/stirling/source_connectors/perf_profiler/perf_profile_connector.h"
+#include "src/stirling/source_connectors/perf_profiler/shared/symbolization.h"
+#include "src/stirling/source_connectors/perf_profiler/symbolizers/go_symbolizer.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/java_symbolizer.h"
 
 #include <sys/sysinfo.h>
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <absl/strings/str_split.h>
+
 #include "src/stirling/bpf_tools/macros.h"
 
 OBJ_STRVIEW(profiler_bcc_script, profiler);
@@ -51,13 +56,44 @@ DEFINE_double(stirling_profiler_stack_trace_size_factor, 3.0,
 DEFINE_double(stirling_profiler_perf_buffer_size_factor, 1.2,
               "Scaling factor to apply to Profiler's eBPF perf buffer sizes");
 
+DEFINE_uint32(stirling_cpu_budget_profiler_slowdown_factor, 4,
+              "When over the CPU budget (see --stirling_cpu_budget_pct), the profiler takes stack "
+              "trace samples this many times less often.");
+
+DEFINE_uint32(stirling_profiler_symbolization_threads,
+              gflags::Uint32FromEnv("PL_STIRLING_PROFILER_SYMBOLIZATION_THREADS", 4),
+              "The number of threads, including the Stirling thread, that symbolize the stack "
+              "traces of different processes concurrently on each profiler table update.");
+
+DEFINE_bool(stirling_profiler_off_cpu, gflags::BoolFromEnv("PL_PROFILER_OFF_CPU", false),
+            "Whether to also profile where threads wait off-CPU, i.e. blocked or waiting to be "
+            "scheduled, into the stack_traces_off_cpu.beta table. Adds a probe to every context "
+            "switch.");
+
+DEFINE_bool(stirling_profiler_intern_frames,
+            gflags::BoolFromEnv("PL_PROFILER_INTERN_FRAMES", false),
+            "Whether to report stack traces as lists of frame IDs, with each frame reported once "
+            "(per few minutes) into the stack_trace_frames.beta table, instead of as lists of "
+            "symbols. Reduces the size of the stack trace tables.");
+
 namespace px {
 namespace stirling {
 
+namespace {
+constexpr std::string_view kSampleCallStackFn = "sample_call_stack";
+
+const auto kOffCPUTracepointSpecs = MakeArray<bpf_tools::TracepointSpec>(
+    {{std::string("sched:sched_switch"), std::string("tracepoint__sched__sched_switch")}});
+
+// The number of threads that can be switched out at once and accounted for.
+constexpr int32_t kOffCPUMaxThreads = 65536;
+}  // namespace
+
 PerfProfileConnector::PerfProfileConnector(std::string_view source_name)
     : BCCSourceConnector(source_name, kTables),
       stack_trace_sampling_period_(
           std::chrono::milliseconds{FLAGS_stirling_profiler_stack_trace_sample_period_ms}),
+      attached_stack_trace_sampling_period_(stack_trace_sampling_period_),
       sampling_period_(
           std::chrono::milliseconds{1000 * FLAGS_stirling_profiler_table_update_period_seconds}),
       push_period_(sampling_period_ / 2),
@@ -75,6 +111,9 @@ PerfProfileConnector::PerfProfileConnector(std::string_view source_name)
                        "Count of times the perf profiler encountered a map lookup error")),
       stats_log_interval_(std::chrono::minutes(FLAGS_stirling_profiler_log_period_minutes) /
                           sampling_period_) {
+  symbolization_thread_pool_ = std::make_unique<ThreadPool>(
+      std::max(1U, FLAGS_stirling_profiler_symbolization_threads) - 1);
+
   constexpr auto kMaxSamplingPeriod = std::chrono::milliseconds{30000};
   DCHECK(sampling_period_ <= kMaxSamplingPeriod) << "Sampling period set too high.";
   DCHECK(sampling_period_ >= stack_trace_sampling_period_);
@@ -129,13 +168,19 @@ Status PerfProfileConnector::InitImpl() {
       sizeof(struct perf_event_header) + sizeof(uint32_t) + sizeof(stack_trace_key_t);
   const int32_t perf_buffer_size = perf_buffer_entry_size * num_perf_buffer_entries;
 
+  // Off-CPU stack traces share the stack traces maps with the sampled ones.
+  const int32_t stack_trace_entries =
+      FLAGS_stirling_profiler_off_cpu ? 2 * provisioned_stack_traces : provisioned_stack_traces;
+
   const std::vector<std::string> defines = {
-      absl::Substitute("-DCFG_STACK_TRACE_ENTRIES=$0", provisioned_stack_traces),
+      absl::Substitute("-DCFG_STACK_TRACE_ENTRIES=$0", stack_trace_entries),
       absl::Substitute("-DCFG_OVERRUN_THRESHOLD=$0", overrun_threshold),
+      absl::Substitute("-DCFG_OFF_CPU_PROFILING=$0", FLAGS_stirling_profiler_off_cpu ? 1 : 0),
+      absl::Substitute("-DCFG_OFF_CPU_MAX_THREADS=$0", kOffCPUMaxThreads),
   };
 
   const auto probe_specs = MakeArray<bpf_tools::SamplingProbeSpec>(
-      {"sample_call_stack", static_cast<uint64_t>(stack_trace_sampling_period_.count())});
+      {kSampleCallStackFn, static_cast<uint64_t>(stack_trace_sampling_period_.count())});
 
   const auto perf_buffer_specs = MakeArray<bpf_tools::PerfBufferSpec>(
       {{kHistogramAName, HandleHistoEvent, HandleHistoLoss, this, perf_buffer_size},
@@ -152,6 +197,15 @@ Status PerfProfileConnector::InitImpl() {
 
   LOG(INFO) << "PerfProfiler: Stack trace profiling sampling probe successfully deployed.";
 
+  if (FLAGS_stirling_profiler_off_cpu) {
+    PX_RETURN_IF_ERROR(bcc_->AttachTracepoints(kOffCPUTracepointSpecs));
+    off_cpu_histogram_a_ = OffCPUHistogramMap::Create(bcc_.get(), kOffCPUHistogramAName);
+    off_cpu_histogram_b_ = OffCPUHistogramMap::Create(bcc_.get(), kOffCPUHistogramBName);
+    off_cpu_starts_ =
+        WrappedBCCMap<uint32_t, off_cpu_start_t>::Create(bcc_.get(), kOffCPUStartsName);
+    LOG(INFO) << "PerfProfiler: Off-CPU profiling probe successfully deployed.";
+  }
+
   // Create a symbolizer for user symbols.
   if (FLAGS_stirling_profiler_symbolizer == "bcc") {
     PX_ASSIGN_OR_RETURN(u_symbolizer_, BCCSymbolizer::Create());
@@ -165,6 +219,13 @@ Status PerfProfileConnector::InitImpl() {
   // Kernel symbolizer always uses BCC symbolizer.
   PX_ASSIGN_OR_RETURN(k_symbolizer_, BCCSymbolizer::Create());
 
+  if (FLAGS_stirling_profiler_go_symbols) {
+    LOG(INFO) << "PerfProfiler: Go symbolization enabled.";
+    PX_ASSIGN_OR_RETURN(u_symbolizer_, GoSymbolizer::Create(std::move(u_symbolizer_)));
+  } else {
+    LOG(INFO) << "PerfProfiler: Go symbolization disabled.";
+  }
+
   if (FLAGS_stirling_profiler_java_symbols) {
     LOG(INFO) << "PerfProfiler: Java symbolization enabled.";
     PX_ASSIGN_OR_RETURN(u_symbolizer_, JavaSymbolizer::Create(std::move(u_symbolizer_)));
@@ -189,6 +250,36 @@ Status PerfProfileConnector::StopImpl() {
   return Status::OK();
 }
 
+void PerfProfileConnector::SetDegradationLevel(DegradationLevel level) {
+  SourceConnector::SetDegradationLevel(level);
+  if (state() != State::kActive) {
+    return;
+  }
+
+  auto period = stack_trace_sampling_period_;
+  if (level >= DegradationLevel::kSlowProfiler) {
+    period *= std::max(1U, FLAGS_stirling_cpu_budget_profiler_slowdown_factor);
+  }
+  if (period == attached_stack_trace_sampling_period_) {
+    return;
+  }
+
+  // The maps are sized for stack_trace_sampling_period_, so a longer period only leaves them
+  // emptier.
+  Status s = bcc_->DetachSamplingProbe(
+      {kSampleCallStackFn, static_cast<uint64_t>(attached_stack_trace_sampling_period_.count())});
+  if (s.ok()) {
+    s = bcc_->AttachSamplingProbe({kSampleCallStackFn, static_cast<uint64_t>(period.count())});
+  }
+  if (!s.ok()) {
+    LOG(ERROR) << absl::Substitute("Failed to change the stack trace sampling period to $0ms: $1",
+                                   period.count(), s.msg());
+    return;
+  }
+  LOG(INFO) << absl::Substitute("Stack trace sampling period changed to $0ms.", period.count());
+  attached_stack_trace_sampling_period_ = period;
+}
+
 void PerfProfileConnector::AcceptStackTraceKey(stack_trace_key_t* data) {
   raw_histo_data_.push_back(*data);
 }
@@ -228,7 +319,7 @@ void PerfProfileConnector::CleanupSymbolizers(const absl::flat_hash_set<md::UPID
 }
 
 PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces(
-    ConnectorContext* ctx, WrappedBCCStackTable* stack_traces) {
+    ConnectorContext* ctx, WrappedBCCStackTable* stack_traces, OffCPUHisto* off_cpu_histogram) {
   // TODO(jps): switch from using get_table_offline() to directly stepping through
   // the histogram data structure. Inline populating our own data structures with this.
   // Avoid an unnecessary copy of the information in local stack_trace_keys_and_counts.
@@ -244,9 +335,26 @@ PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces
   // Create a new stringifier for this iteration of the continuous perf profiler.
   Stringifier stringifier(u_symbolizer_.get(), k_symbolizer_.get(), stack_traces);
 
+  // Symbolize the stack traces of the processes in context up front, one process per task, so that
+  // the Stirling thread does not stall on all of them. The loops below find them memoized.
+  std::vector<stack_trace_key_t> keys_in_context;
+  auto add_if_in_context = [&](const stack_trace_key_t& stack_trace_key) {
+    const md::UPID upid(asid, stack_trace_key.upid.pid, stack_trace_key.upid.start_time_ticks);
+    if (ctx->UPIDIsInContext(upid)) {
+      keys_in_context.push_back(stack_trace_key);
+    }
+  };
+  for (const auto& stack_trace_key : raw_histo_data_) {
+    add_if_in_context(stack_trace_key);
+  }
+  for (const auto& [stack_trace_key, value] : raw_off_cpu_data_) {
+    add_if_in_context(stack_trace_key);
+  }
+  stringifier.BuildStackTraceStrings(keys_in_context, symbolization_thread_pool_.get());
+
   absl::flat_hash_set<int> k_stack_ids_to_remove;
 
-  for (const auto& stack_trace_key : raw_histo_data_) {
+  auto symbolic_stack_trace = [&](const stack_trace_key_t& stack_trace_key) {
     std::string stack_trace_str;
 
     const md::UPID upid(asid, stack_trace_key.upid.pid, stack_trace_key.upid.start_time_ticks);
@@ -273,9 +381,11 @@ PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces
       stack_trace_str = std::string(profiler::kNotSymbolizedMessage);
     }
 
-    profiler::SymbolicStackTrace symbolic_stack_trace = {upid, std::move(stack_trace_str)};
+    return profiler::SymbolicStackTrace{upid, std::move(stack_trace_str)};
+  };
 
-    ++symbolic_histogram[symbolic_stack_trace];
+  for (const auto& stack_trace_key : raw_histo_data_) {
+    ++symbolic_histogram[symbolic_stack_trace(stack_trace_key)];
     ++cum_sum_count;
 
     // TODO(jps): If we see a perf. issue with having two maps keyed by symbolic-stack-trace,
@@ -290,6 +400,12 @@ PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces
     // alternate impl. is a map from "stack-trace-id" => "count & symbolic-stack-trace"
   }
 
+  for (const auto& [stack_trace_key, value] : raw_off_cpu_data_) {
+    off_cpu_value_t& aggregate = (*off_cpu_histogram)[symbolic_stack_trace(stack_trace_key)];
+    aggregate.blocked_ns += value.blocked_ns;
+    aggregate.count += value.count;
+  }
+
   // Clear any kernel stack-ids, that were potentially not already cleared,
   // out of the stack traces table.
   for (const int k_stack_id : k_stack_ids_to_remove) {
@@ -297,14 +413,57 @@ PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces
   }
 
   raw_histo_data_.clear();
+  raw_off_cpu_data_.clear();
 
   VLOG(1) << "PerfProfileConnector::AggregateStackTraces(): cum_sum_count: " << cum_sum_count;
   stats_.Increment(StatKey::kCumulativeSumOfAllStackTraces, cum_sum_count);
   return symbolic_histogram;
 }
 
+void PerfProfileConnector::ReadOffCPUData(OffCPUHistogramMap* off_cpu_histogram) {
+  // Drain the histogram, so that BPF starts from an empty one when it switches back to it.
+  constexpr bool kClearTable = true;
+  raw_off_cpu_data_ = off_cpu_histogram->GetTableOffline(kClearTable);
+
+  // BPF does not account threads that are switched back in after the switch over of the map sets,
+  // because their stack-ids belong to the map set consumed here. Account them up to now instead;
+  // bpf_ktime_get_ns() is the monotonic clock, like the steady clock.
+  const uint64_t now_ns = CurrentSteadyTimeNS();
+  for (const auto& [tid, start] : off_cpu_starts_->GetTableOffline()) {
+    if (start.transfer_count == transfer_count_) {
+      continue;
+    }
+    const uint64_t blocked_ns = now_ns > start.start_ns ? now_ns - start.start_ns : 0;
+    raw_off_cpu_data_.push_back({start.key, {blocked_ns, 1}});
+    PX_UNUSED(off_cpu_starts_->RemoveValue(tid));
+  }
+}
+
+std::string PerfProfileConnector::InternFrames(std::string_view stack_trace_str,
+                                              uint64_t timestamp_ns) {
+  constexpr size_t kMaxSymbolSize = 512;
+
+  DataTable* frames_data_table = data_tables_[kFramesTableNum];
+
+  std::string frame_ids_str;
+  for (const std::string_view frame : absl::StrSplit(stack_trace_str, symbolization::kSeparator)) {
+    const auto [frame_id, is_new] = frame_ids_.LookupOrInsert(std::string(frame));
+    if (is_new && frames_data_table != nullptr) {
+      DataTable::RecordBuilder<&kStackTraceFramesTable> r(frames_data_table, timestamp_ns);
+      r.Append<r.ColIndex("time_")>(timestamp_ns);
+      r.Append<r.ColIndex("frame_id")>(frame_id);
+      r.Append<r.ColIndex("frame")>(std::string(frame), kMaxSymbolSize);
+    }
+    if (!frame_ids_str.empty()) {
+      frame_ids_str.append(symbolization::kSeparator);
+    }
+    absl::StrAppend(&frame_ids_str, frame_id);
+  }
+  return frame_ids_str;
+}
+
 void PerfProfileConnector::CreateRecords(WrappedBCCStackTable* stack_traces, ConnectorContext* ctx,
-                                         DataTable* data_table) {
+                                         DataTable* data_table, DataTable* off_cpu_data_table) {
   constexpr size_t kMaxSymbolSize = 512;
   constexpr size_t kMaxStackDepth = 64;
   constexpr size_t kMaxStackTraceSize = kMaxStackDepth * kMaxSymbolSize;
@@ -317,25 +476,49 @@ void PerfProfileConnector::CreateRecords(WrappedBCCStackTable* stack_traces, Con
   // p0, p1, p2 => main;qux;baz   # both p2 & p3 point into baz.
   // p0, p1, p3 => main;qux;baz
 
-  StackTraceHisto stack_trace_histogram = AggregateStackTraces(ctx, stack_traces);
+  OffCPUHisto off_cpu_histogram;
+  StackTraceHisto stack_trace_histogram =
+      AggregateStackTraces(ctx, stack_traces, &off_cpu_histogram);
 
   constexpr auto age_tick_period = std::chrono::minutes(5);
   if (sampling_freq_mgr_.count() % (age_tick_period / sampling_period_) == 0) {
     stack_trace_ids_.AgeTick();
+    frame_ids_.AgeTick();
   }
 
+  auto stack_trace_str = [&](const profiler::SymbolicStackTrace& key) {
+    return FLAGS_stirling_profiler_intern_frames ? InternFrames(key.stack_trace_str, timestamp_ns)
+                                                 : key.stack_trace_str;
+  };
+
   for (const auto& [key, count] : stack_trace_histogram) {
     DataTable::RecordBuilder<&kStackTraceTable> r(data_table, timestamp_ns);
 
     r.Append<r.ColIndex("time_")>(timestamp_ns);
     r.Append<r.ColIndex("upid")>(key.upid.value());
     r.Append<r.ColIndex("stack_trace_id")>(stack_trace_ids_.Lookup(key));
-    r.Append<r.ColIndex("stack_trace")>(key.stack_trace_str, kMaxStackTraceSize);
+    r.Append<r.ColIndex("stack_trace")>(stack_trace_str(key), kMaxStackTraceSize);
     r.Append<r.ColIndex("count")>(count);
   }
+
+  if (off_cpu_data_table == nullptr) {
+    return;
+  }
+
+  for (const auto& [key, value] : off_cpu_histogram) {
+    DataTable::RecordBuilder<&kStackTraceOffCPUTable> r(off_cpu_data_table, timestamp_ns);
+
+    r.Append<r.ColIndex("time_")>(timestamp_ns);
+    r.Append<r.ColIndex("upid")>(key.upid.value());
+    r.Append<r.ColIndex("stack_trace_id")>(stack_trace_ids_.Lookup(key));
+    r.Append<r.ColIndex("stack_trace")>(stack_trace_str(key), kMaxStackTraceSize);
+    r.Append<r.ColIndex("blocked_time")>(value.blocked_ns);
+    r.Append<r.ColIndex("count")>(value.count);
+  }
 }
 
-void PerfProfileConnector::ProcessBPFStackTraces(ConnectorContext* ctx, DataTable* data_table) {
+void PerfProfileConnector::ProcessBPFStackTraces(ConnectorContext* ctx, DataTable* data_table,
+                                                 DataTable* off_cpu_data_table) {
   // Choose the maps to consume.
   const bool using_map_set_a = transfer_count_ % 2 == 0;
   auto& stack_traces = using_map_set_a ? stack_traces_a_ : stack_traces_b_;
@@ -354,8 +537,12 @@ void PerfProfileConnector::ProcessBPFStackTraces(ConnectorContext* ctx, DataTabl
   const auto map_status = profiler_state_->SetValue(kTransferCountIdx, transfer_count_);
   LOG_IF(ERROR, !map_status.ok()) << "Error writing transfer_count_: " << map_status.msg();
 
+  if (FLAGS_stirling_profiler_off_cpu) {
+    ReadOffCPUData(using_map_set_a ? off_cpu_histogram_a_.get() : off_cpu_histogram_b_.get());
+  }
+
   // Read BPF stack traces & histogram, build records, incorporate records to data table.
-  CreateRecords(stack_traces.get(), ctx, data_table);
+  CreateRecords(stack_traces.get(), ctx, data_table, off_cpu_data_table);
 
   const uint64_t num_stack_traces_sampled = profiler_state_->GetValue(sample_count_idx).ValueOr(0);
   CheckProfilerState(num_stack_traces_sampled);
@@ -408,15 +595,15 @@ void PerfProfileConnector::CheckProfilerState(const uint64_t num_stack_traces) {
 }
 
 void PerfProfileConnector::TransferDataImpl(ConnectorContext* ctx) {
-  DCHECK_EQ(data_tables_.size(), 1U);
+  DCHECK_EQ(data_tables_.size(), kTables.size());
 
-  auto* data_table = data_tables_[0];
+  auto* data_table = data_tables_[kPerfProfileTableNum];
 
   if (data_table == nullptr) {
     return;
   }
 
-  ProcessBPFStackTraces(ctx, data_table);
+  ProcessBPFStackTraces(ctx, data_table, data_tables_[kOffCPUTableNum]);
 
   // Cleanup the symbolizer so we don't leak memory.
   proc_tracker_.Update(ctx->GetUPIDs());
@@ -43,6 +43,7 @@ namespace px {
 namespace stirling {
 
 using bpf_tools::WrappedBCCArrayTable;
+using bpf_tools::WrappedBCCMap;
 using bpf_tools::WrappedBCCStackTable;
 
 namespace profiler {
@@ -52,8 +53,11 @@ static constexpr std::string_view kNotSymbolizedMessage = "<not symbolized>";
 class PerfProfileConnector : public BCCSourceConnector {
  public:
   static constexpr std::string_view kName = "perf_profiler";
-  static constexpr auto kTables = MakeArray(kStackTraceTable);
+  static constexpr auto kTables =
+      MakeArray(kStackTraceTable, kStackTraceOffCPUTable, kStackTraceFramesTable);
   static constexpr uint32_t kPerfProfileTableNum = TableNum(kTables, kStackTraceTable);
+  static constexpr uint32_t kOffCPUTableNum = TableNum(kTables, kStackTraceOffCPUTable);
+  static constexpr uint32_t kFramesTableNum = TableNum(kTables, kStackTraceFramesTable);
 
   static std::unique_ptr<PerfProfileConnector> Create(std::string_view name) {
     return std::unique_ptr<PerfProfileConnector>(new PerfProfileConnector(name));
@@ -63,6 +67,9 @@ class PerfProfileConnector : public BCCSourceConnector {
   Status StopImpl() override;
   void TransferDataImpl(ConnectorContext* ctx) override;
 
+  // Takes stack trace samples less often at DegradationLevel::kSlowProfiler.
+  void SetDegradationLevel(DegradationLevel level) override;
+
   std::chrono::milliseconds SamplingPeriod() const { return sampling_period_; }
   std::chrono::milliseconds StackTraceSamplingPeriod() const {
     return stack_trace_sampling_period_;
@@ -80,6 +87,10 @@ class PerfProfileConnector : public BCCSourceConnector {
   // The time interval between stack trace samples, i.e. the sample rate used inside of BPF.
   const std::chrono::milliseconds stack_trace_sampling_period_;
 
+  // The stack trace sampling period that the probe is attached with. Longer than the above when
+  // slowed down to stay within the CPU budget, see SetDegradationLevel().
+  std::chrono::milliseconds attached_stack_trace_sampling_period_;
+
   // Push period is set to 1/2 of the sample period such that we push each new
   // sample when it becomes available. This is a UX decision so that the user
   // gets fresh profiler data every 30 seconds (or worst case w/in 45 seconds).
@@ -92,15 +103,35 @@ class PerfProfileConnector : public BCCSourceConnector {
   // RawHistoData: a list of stack trace keys that will need to be histogrammed.
   using RawHistoData = std::vector<stack_trace_key_t>;
 
+  // OffCPUHisto: SymbolicStackTrace => blocked time & count.
+  using OffCPUHisto = absl::flat_hash_map<profiler::SymbolicStackTrace, off_cpu_value_t>;
+
+  // RawOffCPUData: the off-CPU histogram read from BPF; a stack trace key may appear repeatedly.
+  using RawOffCPUData = std::vector<std::pair<stack_trace_key_t, off_cpu_value_t>>;
+
+  using OffCPUHistogramMap = WrappedBCCMap<stack_trace_key_t, off_cpu_value_t>;
+
   explicit PerfProfileConnector(std::string_view source_name);
 
-  void ProcessBPFStackTraces(ConnectorContext* ctx, DataTable* data_table);
+  void ProcessBPFStackTraces(ConnectorContext* ctx, DataTable* data_table,
+                             DataTable* off_cpu_data_table);
 
-  // Read BPF data structures, build & incorporate records to the table.
+  // Read BPF data structures, build & incorporate records to the tables.
+  // The off-CPU table is only populated with --stirling_profiler_off_cpu.
   void CreateRecords(WrappedBCCStackTable* stack_traces, ConnectorContext* ctx,
-                     DataTable* data_table);
+                     DataTable* data_table, DataTable* off_cpu_data_table);
+
+  // Symbolizes and aggregates raw_histo_data_, and raw_off_cpu_data_ into off_cpu_histogram.
+  // Both share the stack traces map, and therefore one Stringifier.
+  StackTraceHisto AggregateStackTraces(ConnectorContext* ctx, WrappedBCCStackTable* stack_traces,
+                                       OffCPUHisto* off_cpu_histogram);
 
-  StackTraceHisto AggregateStackTraces(ConnectorContext* ctx, WrappedBCCStackTable* stack_traces);
+  // Returns the frame IDs of a folded stack trace string, in the same format. Reports the frames
+  // that are new to the current generation of frame_ids_ into the frames table.
+  std::string InternFrames(std::string_view stack_trace_str, uint64_t timestamp_ns);
+
+  // Drains the off-CPU histogram of the map set being consumed into raw_off_cpu_data_.
+  void ReadOffCPUData(OffCPUHistogramMap* off_cpu_histogram);
 
   void CleanupSymbolizers(const absl::flat_hash_set<md::UPID>& deleted_upids);
 
@@ -112,6 +143,11 @@ class PerfProfileConnector : public BCCSourceConnector {
   std::unique_ptr<WrappedBCCStackTable> stack_traces_b_;
 
   std::unique_ptr<WrappedBCCArrayTable<uint64_t>> profiler_state_;
+
+  // Only created with --stirling_profiler_off_cpu.
+  std::unique_ptr<OffCPUHistogramMap> off_cpu_histogram_a_;
+  std::unique_ptr<OffCPUHistogramMap> off_cpu_histogram_b_;
+  std::unique_ptr<WrappedBCCMap<uint32_t, off_cpu_start_t>> off_cpu_starts_;
   prometheus::Gauge& profiler_state_overflow_gauge_;
   prometheus::Counter& profiler_transfer_data_counter_;
   prometheus::Counter& profiler_state_overflow_counter_;
@@ -126,13 +162,23 @@ class PerfProfileConnector : public BCCSourceConnector {
   // Tracks unique stack trace ids, for the lifetime of Stirling:
   StackTraceIDCache stack_trace_ids_;
 
+  // Tracks the IDs of stack frames, with --stirling_profiler_intern_frames.
+  FrameIDCache frame_ids_;
+
   // The raw histogram from BPF; it is populated on each iteration by a call to PollPerfBuffer().
   RawHistoData raw_histo_data_;
 
+  // The off-CPU histogram from BPF; it is populated on each iteration by ReadOffCPUData().
+  RawOffCPUData raw_off_cpu_data_;
+
   // For converting stack trace addresses to symbols.
   std::unique_ptr<Symbolizer> k_symbolizer_;
   std::unique_ptr<Symbolizer> u_symbolizer_;
 
+  // Symbolizes the stack traces of different processes concurrently.
+  // See --stirling_profiler_symbolization_threads.
+  std::unique_ptr<ThreadPool> symbolization_thread_pool_;
+
   // Keeps track of processes. Used to find destroyed processes on which to perform clean-up.
   // TODO(oazizi): Investigate ways of sharing across source_connectors.
   ProcTracker proc_tracker_;
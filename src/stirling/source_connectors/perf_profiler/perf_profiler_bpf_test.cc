@@ -34,6 +34,7 @@
 #include "src/stirling/core/unit_connector.h"
 #include "src/stirling/source_connectors/perf_profiler/java/attach.h"
 #include "src/stirling/source_connectors/perf_profiler/perf_profile_connector.h"
+#include "src/stirling/source_connectors/perf_profiler/shared/symbolization.h"
 #include "src/stirling/source_connectors/perf_profiler/stack_traces_table.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/java_symbolizer.h"
 #include "src/stirling/source_connectors/perf_profiler/testing/testing.h"
@@ -43,6 +44,7 @@ DEFINE_uint32(test_run_time, 10, "Number of seconds to run the test.");
 DEFINE_string(test_java_image_names, JDK_IMAGE_NAMES,
               "Java docker images to use as Java test cases.");
 DECLARE_bool(stirling_profiler_java_symbols);
+DECLARE_bool(stirling_profiler_off_cpu);
 DECLARE_string(stirling_profiler_java_agent_libs);
 DECLARE_uint32(stirling_profiler_table_update_period_seconds);
 DECLARE_uint32(stirling_profiler_stack_trace_sample_period_ms);
@@ -214,6 +216,7 @@ class PerfProfileBPFTest : public ::testing::TestWithParam<std::filesystem::path
  protected:
   void SetUp() override {
     FLAGS_stirling_profiler_java_symbols = true;
+    FLAGS_stirling_profiler_off_cpu = false;
     FLAGS_number_attach_attempts_per_iteration = kNumSubProcs;
 
     if constexpr (FastTest) {
@@ -417,6 +420,42 @@ TEST_F(FastPerfProfileBPFTest, PerfProfilerCppTest) {
   ASSERT_NO_FATAL_FAILURE(CheckExpectedProfile(leaf_histo, key1x, key2x));
 }
 
+TEST_F(FastPerfProfileBPFTest, PerfProfilerOffCPUTest) {
+  FLAGS_stirling_profiler_off_cpu = true;
+
+  // The shell spends nearly all of its time switched out, waiting for its sleeping child.
+  SubProcess sub_process;
+  ASSERT_OK(sub_process.Start({"/bin/sh", "-c", "while true; do sleep 0.1; done"}));
+  const int pid = sub_process.child_pid();
+  ASSERT_OK_AND_ASSIGN(const uint64_t ts, system::ProcParser().GetPIDStartTimeTicks(pid));
+
+  ASSERT_OK(source_.Init({md::UPID(0, pid, ts)}));
+  ASSERT_OK(source_.Start());
+  std::this_thread::sleep_for(test_run_time_);
+  ASSERT_OK(source_.Stop());
+  sub_process.Kill();
+
+  // The off-CPU stack traces go to their own table.
+  ASSERT_OK_AND_ASSIGN(columns_, source_.ConsumeRecords(PerfProfileConnector::kOffCPUTableNum));
+  const auto target_row_idxs = FindRecordIdxMatchesPIDs(columns_, kStackTraceOffCPUUPIDIdx, {pid});
+  ASSERT_THAT(target_row_idxs, Not(SizeIs(0)));
+
+  int64_t blocked_ns = 0;
+  for (const auto row_idx : target_row_idxs) {
+    const std::string stack_trace_str =
+        columns_[kStackTraceOffCPUStackTraceStrIdx]->Get<types::StringValue>(row_idx);
+    EXPECT_TRUE(absl::StrContains(stack_trace_str, symbolization::kKernelPrefix))
+        << stack_trace_str;
+    EXPECT_GT(columns_[kStackTraceOffCPUCountIdx]->Get<types::Int64Value>(row_idx).val, 0);
+    blocked_ns += columns_[kStackTraceOffCPUBlockedTimeIdx]->Get<types::Int64Value>(row_idx).val;
+  }
+
+  // Data of the last table period may not have been transferred.
+  const int64_t run_time_ns = std::chrono::nanoseconds(test_run_time_).count();
+  EXPECT_GT(blocked_ns, run_time_ns / 4);
+  EXPECT_LT(blocked_ns, run_time_ns);
+}
+
 TEST_F(FastPerfProfileBPFTest, GraalVM_AOT_Test) {
   const std::string app_path = "ProfilerTest";
   const std::filesystem::path bazel_app_path = BazelJavaTestAppPath(app_path);
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <string>
+#include <utility>
 
 #include <absl/container/flat_hash_map.h>
 
@@ -27,36 +28,71 @@
 namespace px {
 namespace stirling {
 
-// The StackTraceIDCache maintains a mapping of stack trace strings to stack trace IDs.
-// We maintain these IDs for a number of reasons:
+// The GenerationalIDCache maintains a mapping of keys to integer IDs, e.g. of stack trace
+// strings to stack trace IDs. We maintain these IDs for a number of reasons:
 //  1) The IDs enable more efficient aggregations across time samples in Carnot:
 //     aggregations with integers are more efficient than aggregations with strings.
-//  2) The IDs enable table normalization (future work).
+//  2) The IDs enable table normalization: the stack traces are reported as lists of frame IDs,
+//     and each frame string is reported once per generation (see FrameIDCache).
 //
-// As a cache, it should be noted that no guarantee is made that a stack trace from one time
-// period is assigned the same stack trace ID. Any consumer of the data can only assume that
-// two records with identical stack trace IDs will have identical stack trace strings. The
-// reverse, however, is not true: Two records with identical stack trace strings may not have
-// the same stack trace ID.
+// As a cache, it should be noted that no guarantee is made that a key from one time
+// period is assigned the same ID. Any consumer of the data can only assume that
+// two records with identical IDs will have identical keys. The reverse, however, is not true:
+// Two records with identical keys may not have the same ID.
 //
-// We allow identical stack trace strings to map to different stack trace id integers to bound
-// the total memory consumed by this map. Otherwise the map's memory usage grows unbounded.
+// We allow identical keys to map to different ID integers to bound the total memory consumed by
+// this map: an ID is kept as long as its key is looked up at least once every other generation
+// (see AgeTick()). Otherwise the map's memory usage grows unbounded.
 //
-// For cases where the same stack trace ID shows up with different IDs,
+// For cases where the same stack trace shows up with different IDs,
 // the UI will aggregate the identical stack traces for us in the visualization.
-class StackTraceIDCache {
+template <typename TKey>
+class GenerationalIDCache {
  public:
-  uint64_t Lookup(const profiler::SymbolicStackTrace& stack_trace);
-  void AgeTick();
+  uint64_t Lookup(const TKey& key) { return LookupOrInsert(key).first; }
+
+  // Returns the ID of the key, and whether this is the first lookup of the key in the current
+  // generation.
+  std::pair<uint64_t, bool> LookupOrInsert(const TKey& key) {
+    // Case 1: ID is in the current set. Just return it.
+    const auto it = ids_.find(key);
+    if (it != ids_.end()) {
+      return {it->second, false};
+    }
+
+    // Case 2: ID is in the previous set. Copy it to current set, and return it.
+    const auto it2 = prev_ids_.find(key);
+    if (it2 != prev_ids_.end()) {
+      const uint64_t id = it2->second;
+      ids_[key] = id;
+      return {id, true};
+    }
+
+    // Case 3: ID is not in the current nor the previous set. Create a new ID.
+    const uint64_t id = ++next_id_;
+    ids_[key] = id;
+    return {id, true};
+  }
+
+  void AgeTick() {
+    prev_ids_ = std::move(ids_);
+    ids_.clear();
+  }
 
  private:
-  absl::flat_hash_map<profiler::SymbolicStackTrace, uint64_t> stack_trace_ids_;
-  absl::flat_hash_map<profiler::SymbolicStackTrace, uint64_t> prev_stack_trace_ids_;
+  absl::flat_hash_map<TKey, uint64_t> ids_;
+  absl::flat_hash_map<TKey, uint64_t> prev_ids_;
 
-  // Tracks the next stack-trace-id to be assigned;
+  // Tracks the next ID to be assigned;
   // incremented by 1 for each such assignment.
-  uint64_t next_stack_trace_id_ = 0;
+  uint64_t next_id_ = 0;
 };
 
+// TODO(jps): Add profiler namespace for all profiler code.
+using StackTraceIDCache = GenerationalIDCache<profiler::SymbolicStackTrace>;
+
+// Maps stack frame (symbol) strings to frame IDs.
+using FrameIDCache = GenerationalIDCache<std::string>;
+
 }  // namespace stirling
 }  // namespace px
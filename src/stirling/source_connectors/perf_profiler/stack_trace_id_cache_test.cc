@@ -18,6 +18,8 @@
 
 #include <gtest/gtest.h>
 
+#include <utility>
+
 #include "src/stirling/source_connectors/perf_profiler/stack_trace_id_cache.h"
 
 namespace px {
@@ -51,5 +53,24 @@ TEST(StackTraceIDCache, Basic) {
   EXPECT_NE(stack_trace_ids.Lookup(kStackTrace2), id2);
 }
 
+TEST(FrameIDCache, LookupOrInsert) {
+  FrameIDCache frame_ids;
+
+  const auto [id1, new1] = frame_ids.LookupOrInsert("main");
+  const auto [id2, new2] = frame_ids.LookupOrInsert("foo()");
+  EXPECT_TRUE(new1);
+  EXPECT_TRUE(new2);
+  EXPECT_NE(id1, id2);
+
+  // Only the first lookup in a generation reports the frame as new.
+  EXPECT_EQ(frame_ids.LookupOrInsert("main"), std::make_pair(id1, false));
+
+  frame_ids.AgeTick();
+
+  // The ID is kept, and reported again as new to the generation.
+  EXPECT_EQ(frame_ids.LookupOrInsert("main"), std::make_pair(id1, true));
+  EXPECT_EQ(frame_ids.LookupOrInsert("main"), std::make_pair(id1, false));
+}
+
 }  // namespace stirling
 }  // namespace px
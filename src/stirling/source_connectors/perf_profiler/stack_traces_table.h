@@ -38,7 +38,9 @@ static constexpr DataElement kElements[] = {
     {"stack_trace",
      "A stack trace within the sampled process, in folded format. "
      "The call stack symbols are separated by semicolons. "
-     "If symbols cannot be resolved, addresses are populated instead.",
+     "If symbols cannot be resolved, addresses are populated instead. "
+     "With --stirling_profiler_intern_frames, the symbols are replaced by their frame IDs, "
+     "see the stack_trace_frames.beta table.",
      types::DataType::STRING, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
     {"count",
      "Number of times the stack trace has been sampled.",
@@ -60,5 +62,67 @@ constexpr int kStackTraceStackTraceIDIdx = kStackTraceTable.ColIndex("stack_trac
 constexpr int kStackTraceStackTraceStrIdx = kStackTraceTable.ColIndex("stack_trace");
 constexpr int kStackTraceCountIdx = kStackTraceTable.ColIndex("count");
 
+// clang-format off
+static constexpr DataElement kOffCPUElements[] = {
+    canonical_data_elements::kTime,
+    canonical_data_elements::kUPID,
+    {"stack_trace_id",
+     "A unique identifier of the stack trace, for script-writing convenience. "
+     "String representation is in the `stack_trace` column.",
+     types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+    {"stack_trace",
+     "A stack trace at which threads of the process were switched out by the scheduler, "
+     "in folded format. The call stack symbols are separated by semicolons. "
+     "If symbols cannot be resolved, addresses are populated instead.",
+     types::DataType::STRING, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+    {"blocked_time",
+     "Total time that threads spent switched out at the stack trace.",
+     types::DataType::INT64, types::SemanticType::ST_DURATION_NS,
+     types::PatternType::METRIC_GAUGE},
+    {"count",
+     "Number of times that threads were switched out at the stack trace.",
+     types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::METRIC_GAUGE}
+};
+
+constexpr auto kStackTraceOffCPUTable = DataTableSchema(
+        "stack_traces_off_cpu.beta",
+        "Stack traces at which application threads wait off-CPU (blocked or waiting to be "
+        "scheduled), weighted by the time spent waiting. Only collected when the profiler runs "
+        "with --stirling_profiler_off_cpu.",
+        kOffCPUElements
+);
+// clang-format on
+DEFINE_PRINT_TABLE(StackTraceOffCPU)
+
+constexpr int kStackTraceOffCPUUPIDIdx = kStackTraceOffCPUTable.ColIndex("upid");
+constexpr int kStackTraceOffCPUStackTraceStrIdx = kStackTraceOffCPUTable.ColIndex("stack_trace");
+constexpr int kStackTraceOffCPUBlockedTimeIdx = kStackTraceOffCPUTable.ColIndex("blocked_time");
+constexpr int kStackTraceOffCPUCountIdx = kStackTraceOffCPUTable.ColIndex("count");
+
+// clang-format off
+static constexpr DataElement kFrameElements[] = {
+    canonical_data_elements::kTime,
+    {"frame_id",
+     "The ID of the stack frame in the `stack_trace` columns of this PEM's stack trace tables. "
+     "A frame is reported again when its ID is reused after some time.",
+     types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+    {"frame",
+     "The symbol of the stack frame. If the symbol cannot be resolved, the address is "
+     "populated instead.",
+     types::DataType::STRING, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+};
+
+constexpr auto kStackTraceFramesTable = DataTableSchema(
+        "stack_trace_frames.beta",
+        "The stack frames of the stack trace tables, by frame ID. Only populated when the profiler "
+        "runs with --stirling_profiler_intern_frames.",
+        kFrameElements
+);
+// clang-format on
+DEFINE_PRINT_TABLE(StackTraceFrames)
+
+constexpr int kStackTraceFramesFrameIDIdx = kStackTraceFramesTable.ColIndex("frame_id");
+constexpr int kStackTraceFramesFrameIdx = kStackTraceFramesTable.ColIndex("frame");
+
 }  // namespace stirling
 }  // namespace px
@@ -101,6 +101,70 @@ std::string Stringifier::FindOrBuildStackTraceString(const int stack_id,
   return iter->second;
 }
 
+void Stringifier::BuildStackTraceStrings(const std::vector<stack_trace_key_t>& keys,
+                                         ThreadPool* thread_pool) {
+  struct Partition {
+    struct upid_t upid;
+    Symbolizer* symbolizer;
+    std::string_view prefix;
+    profiler::SymbolizerFn symbolize_fn;
+    std::vector<int> stack_ids;
+    std::vector<std::vector<uintptr_t>> addrs;
+    std::vector<std::string> stack_trace_strs;
+  };
+
+  // The kernel stack traces are symbolized by one partition, because they share a symbolizer.
+  std::vector<Partition> partitions;
+  partitions.push_back({.upid = profiler::kKernelUPID,
+                        .symbolizer = k_symbolizer_,
+                        .prefix = symbolization::kKernelPrefix});
+  absl::flat_hash_map<struct upid_t, size_t> partition_idxs;
+
+  // Reading the stack traces table, and creating the symbolizer functions, stay on this thread.
+  // As in FindOrBuildStackTraceString(), a user stack-id is symbolized for the first UPID that
+  // references it.
+  constexpr bool kClearStackId = true;
+  for (const auto& key : keys) {
+    if (key.user_stack_id >= 0 && !stack_trace_strs_.contains(key.user_stack_id)) {
+      const auto [iter, inserted] = partition_idxs.try_emplace(key.upid, partitions.size());
+      if (inserted) {
+        partitions.push_back(
+            {.upid = key.upid, .symbolizer = u_symbolizer_, .prefix = symbolization::kUserPrefix});
+      }
+      Partition& partition = partitions[iter->second];
+      stack_trace_strs_[key.user_stack_id];
+      partition.stack_ids.push_back(key.user_stack_id);
+      partition.addrs.push_back(stack_traces_->GetStackAddr(key.user_stack_id, kClearStackId));
+    }
+    if (key.kernel_stack_id >= 0 && !stack_trace_strs_.contains(key.kernel_stack_id)) {
+      Partition& partition = partitions[0];
+      stack_trace_strs_[key.kernel_stack_id];
+      partition.stack_ids.push_back(key.kernel_stack_id);
+      partition.addrs.push_back(stack_traces_->GetStackAddr(key.kernel_stack_id, kClearStackId));
+    }
+  }
+  for (auto& partition : partitions) {
+    if (!partition.stack_ids.empty()) {
+      partition.symbolize_fn = partition.symbolizer->GetSymbolizerFn(partition.upid);
+    }
+    partition.stack_trace_strs.resize(partition.stack_ids.size());
+  }
+
+  thread_pool->ParallelFor(partitions.size(), [&](size_t i) {
+    Partition& partition = partitions[i];
+    for (size_t j = 0; j < partition.stack_ids.size(); ++j) {
+      partition.stack_trace_strs[j] =
+          BuildStackTraceString(partition.addrs[j], partition.symbolize_fn, partition.prefix);
+    }
+  });
+
+  for (auto& partition : partitions) {
+    for (size_t j = 0; j < partition.stack_ids.size(); ++j) {
+      stack_trace_strs_[partition.stack_ids[j]] = std::move(partition.stack_trace_strs[j]);
+    }
+  }
+}
+
 std::string Stringifier::FoldedStackTraceString(const stack_trace_key_t& key) {
   using symbolization::kKernelPrefix;
   using symbolization::kUserPrefix;
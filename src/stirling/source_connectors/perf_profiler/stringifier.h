@@ -21,6 +21,7 @@
 #include <string>
 #include <vector>
 
+#include "src/common/base/thread_pool.h"
 #include "src/stirling/bpf_tools/bcc_wrapper.h"
 #include "src/stirling/source_connectors/perf_profiler/bcc_bpf_intf/stack_event.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/symbolizer.h"
@@ -69,6 +70,17 @@ class Stringifier {
   // passed into FindOrBuildStackTraceString().
   std::string FoldedStackTraceString(const stack_trace_key_t& key);
 
+  /**
+   * Reads and symbolizes the stack traces of the keys ahead of FoldedStackTraceString(), which
+   * then finds them memoized. The stack traces are partitioned by UPID (all kernel stack traces
+   * are one partition), and the partitions are symbolized concurrently on the thread pool.
+   * Symbolizer functions of different UPIDs must be safe to run concurrently.
+   *
+   * @param keys The stack trace keys that are going to be stringified.
+   * @param thread_pool The threads to symbolize on, along with the calling thread.
+   */
+  void BuildStackTraceStrings(const std::vector<stack_trace_key_t>& keys, ThreadPool* thread_pool);
+
  private:
   std::string BuildStackTraceString(const std::vector<uintptr_t>& addrs,
                                     profiler::SymbolizerFn symbolize_fn,
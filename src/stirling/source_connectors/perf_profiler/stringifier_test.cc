@@ -0,0 +1,125 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/perf_profiler/stringifier.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/stirling/source_connectors/perf_profiler/shared/symbolization.h"
+
+namespace px {
+namespace stirling {
+
+namespace {
+
+class FakeStackTable : public WrappedBCCStackTable {
+ public:
+  explicit FakeStackTable(absl::flat_hash_map<int, std::vector<uintptr_t>> stacks)
+      : stacks_(std::move(stacks)) {}
+
+  std::vector<uintptr_t> GetStackAddr(const int stack_id, const bool clear_stack_id) override {
+    auto iter = stacks_.find(stack_id);
+    if (iter == stacks_.end()) {
+      return {};
+    }
+    std::vector<uintptr_t> addrs = iter->second;
+    if (clear_stack_id) {
+      stacks_.erase(iter);
+    }
+    return addrs;
+  }
+
+  std::string GetAddrSymbol(const uintptr_t, const int) override { return ""; }
+
+  void ClearStackID(const int stack_id) override { stacks_.erase(stack_id); }
+
+  size_t size() const { return stacks_.size(); }
+
+ private:
+  absl::flat_hash_map<int, std::vector<uintptr_t>> stacks_;
+};
+
+// Symbolizes an address as "<pid>_<addr>".
+class FakeSymbolizer : public Symbolizer {
+ public:
+  profiler::SymbolizerFn GetSymbolizerFn(const struct upid_t& upid) override {
+    const int32_t pid = static_cast<int32_t>(upid.pid);
+    return [pid](const uintptr_t addr) -> std::string_view {
+      static thread_local std::string symbol;
+      symbol = absl::StrCat(pid, "_", addr);
+      return symbol;
+    };
+  }
+  void IterationPreTick() override {}
+  void DeleteUPID(const struct upid_t&) override {}
+  bool Uncacheable(const struct upid_t&) override { return false; }
+};
+
+stack_trace_key_t MakeKey(uint32_t pid, int user_stack_id, int kernel_stack_id) {
+  stack_trace_key_t key = {};
+  key.upid.pid = pid;
+  key.upid.start_time_ticks = pid;
+  key.user_stack_id = user_stack_id;
+  key.kernel_stack_id = kernel_stack_id;
+  return key;
+}
+
+}  // namespace
+
+TEST(StringifierTest, BuildStackTraceStringsMatchesSerial) {
+  const absl::flat_hash_map<int, std::vector<uintptr_t>> kStacks = {
+      {1, {0x10, 0x11}}, {2, {0x20}}, {3, {0x30, 0x31, 0x32}}, {4, {0x40}},
+      {100, {0xf0}},     {101, {0xf1, 0xf2}},
+  };
+  const std::vector<stack_trace_key_t> kKeys = {
+      MakeKey(1, 1, 100),     MakeKey(2, 2, 100),       MakeKey(3, 3, 101),
+      MakeKey(1, 4, -EFAULT), MakeKey(2, -EFAULT, 101), MakeKey(3, -EEXIST, -EEXIST),
+  };
+
+  FakeSymbolizer symbolizer;
+
+  FakeStackTable serial_table(kStacks);
+  Stringifier serial_stringifier(&symbolizer, &symbolizer, &serial_table);
+
+  FakeStackTable parallel_table(kStacks);
+  Stringifier parallel_stringifier(&symbolizer, &symbolizer, &parallel_table);
+  ThreadPool thread_pool(3);
+  parallel_stringifier.BuildStackTraceStrings(kKeys, &thread_pool);
+
+  // All stack traces were consumed from the table up front.
+  EXPECT_EQ(parallel_table.size(), 0);
+
+  for (const auto& key : kKeys) {
+    EXPECT_EQ(parallel_stringifier.FoldedStackTraceString(key),
+              serial_stringifier.FoldedStackTraceString(key));
+  }
+  EXPECT_EQ(parallel_stringifier.FoldedStackTraceString(kKeys[0]),
+            absl::StrCat(symbolization::kUserPrefix, "1_17", symbolization::kSeparator,
+                         symbolization::kUserPrefix, "1_16", symbolization::kSeparator,
+                         symbolization::kKernelPrefix, "-1_240"));
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 
 #include "src/stirling/source_connectors/perf_profiler/symbol_cache/symbol_cache.h"
@@ -55,8 +56,9 @@ class CachingSymbolizer : public Symbolizer {
 
   absl::flat_hash_map<struct upid_t, std::unique_ptr<SymbolCache>> symbol_caches_;
 
-  int64_t stat_accesses_ = 0;
-  int64_t stat_hits_ = 0;
+  // Atomic, because the symbolizer functions of different UPIDs may run concurrently.
+  std::atomic<int64_t> stat_accesses_ = 0;
+  std::atomic<int64_t> stat_hits_ = 0;
 };
 
 }  // namespace stirling
@@ -0,0 +1,279 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/perf_profiler/symbolizers/elf_symbol_table.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+#include <absl/strings/str_format.h>
+
+#include "src/common/base/file.h"
+#include "src/common/fs/fs_wrapper.h"
+
+DEFINE_string(stirling_profiler_elf_symbols_cache_dir,
+              gflags::StringFromEnv("PL_STIRLING_PROFILER_ELF_SYMBOLS_CACHE_DIR", ""),
+              "Directory where the profiler keeps the symbol tables of the ELF binaries it "
+              "symbolized, keyed by build-id, across restarts. Should be on a host path. "
+              "Empty keeps the tables in memory only.");
+DEFINE_uint32(stirling_profiler_elf_symbols_cache_max_entries,
+              gflags::Uint32FromEnv("PL_STIRLING_PROFILER_ELF_SYMBOLS_CACHE_MAX_ENTRIES", 256),
+              "The maximum number of binaries in --stirling_profiler_elf_symbols_cache_dir.");
+
+namespace px {
+namespace stirling {
+
+namespace {
+
+// Bump when the layout of the table changes.
+constexpr uint32_t kFormatVersion = 1;
+constexpr char kMagic[8] = {'P', 'X', 'E', 'L', 'F', 'S', 'Y', 'M'};
+constexpr char kFileSuffix[] = ".symtab";
+
+// Removes the least recently used tables, so that at most max_entries remain.
+void EvictCacheEntries(const std::filesystem::path& dir, size_t max_entries) {
+  std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> entries;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+    if (entry.path().extension() != kFileSuffix) {
+      continue;
+    }
+    auto mtime = entry.last_write_time(ec);
+    if (!ec) {
+      entries.emplace_back(mtime, entry.path());
+    }
+  }
+  if (entries.size() <= max_entries) {
+    return;
+  }
+
+  size_t num_evicted = entries.size() - max_entries;
+  std::partial_sort(entries.begin(), entries.begin() + num_evicted, entries.end());
+  for (size_t i = 0; i < num_evicted; ++i) {
+    PX_UNUSED(fs::Remove(entries[i].second));
+  }
+}
+
+}  // namespace
+
+// The cache is local to the node, so the native byte order is the one of the reader.
+struct ElfSymbolTable::Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t num_entries;
+  uint64_t names_size;
+};
+
+struct ElfSymbolTable::Entry {
+  uint64_t addr;
+  uint64_t size;
+  uint64_t name_offset;
+  uint64_t name_size;
+};
+
+std::unique_ptr<ElfSymbolTable> ElfSymbolTable::Create(
+    const obj_tools::ElfReader::Symbolizer& symbols) {
+  std::vector<Entry> entries;
+  std::string names;
+  symbols.ForEachEntry([&entries, &names](uintptr_t addr, size_t size, std::string_view name) {
+    entries.push_back({addr, size, names.size(), name.size()});
+    names.append(name);
+  });
+
+  Header header = {};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kFormatVersion;
+  header.num_entries = entries.size();
+  header.names_size = names.size();
+
+  auto table = std::unique_ptr<ElfSymbolTable>(new ElfSymbolTable());
+  std::string& data = table->owned_data_;
+  data.reserve(sizeof(Header) + entries.size() * sizeof(Entry) + names.size());
+  data.append(reinterpret_cast<const char*>(&header), sizeof(Header));
+  data.append(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Entry));
+  data.append(names);
+  table->data_ = data.data();
+  table->data_size_ = data.size();
+  return table;
+}
+
+StatusOr<std::unique_ptr<ElfSymbolTable>> ElfSymbolTable::Open(
+    const std::filesystem::path& path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return error::NotFound("Could not open $0: $1", path.string(), std::strerror(errno));
+  }
+  DEFER(close(fd));
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    return error::Internal("Could not stat $0: $1", path.string(), std::strerror(errno));
+  }
+  const size_t file_size = st.st_size;
+  if (file_size < sizeof(Header)) {
+    return error::Internal("Symbol table $0 is truncated.", path.string());
+  }
+
+  void* addr = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (addr == MAP_FAILED) {
+    return error::Internal("Could not mmap $0: $1", path.string(), std::strerror(errno));
+  }
+
+  // From here on, the destructor unmaps the file.
+  auto table = std::unique_ptr<ElfSymbolTable>(new ElfSymbolTable());
+  table->data_ = static_cast<const char*>(addr);
+  table->data_size_ = file_size;
+  table->mapped_ = true;
+
+  const Header& header = table->header();
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kFormatVersion) {
+    return error::NotFound("Incompatible symbol table $0.", path.string());
+  }
+  // Checked piecewise, so that corrupt sizes cannot overflow the sum.
+  const size_t max_entries = (file_size - sizeof(Header)) / sizeof(Entry);
+  if (header.num_entries > max_entries ||
+      header.names_size != file_size - sizeof(Header) - header.num_entries * sizeof(Entry)) {
+    return error::Internal("Symbol table $0 has an invalid size.", path.string());
+  }
+  for (size_t i = 0; i < header.num_entries; ++i) {
+    const Entry& entry = table->entries()[i];
+    if (entry.name_offset > header.names_size ||
+        entry.name_size > header.names_size - entry.name_offset) {
+      return error::Internal("Symbol table $0 has an invalid entry.", path.string());
+    }
+  }
+  return table;
+}
+
+ElfSymbolTable::~ElfSymbolTable() {
+  if (mapped_) {
+    munmap(const_cast<char*>(data_), data_size_);
+  }
+}
+
+Status ElfSymbolTable::Write(const std::filesystem::path& path) const {
+  // Written under a temporary name first, so that readers never see a partial file, even if the
+  // process dies while writing.
+  const std::filesystem::path tmp_path = absl::StrCat(path.string(), ".tmp");
+  PX_RETURN_IF_ERROR(WriteFileFromString(tmp_path.string(), std::string_view(data_, data_size_)));
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path, ec);
+  if (ec) {
+    return error::Internal("Could not rename $0 to $1: $2", tmp_path.string(), path.string(),
+                           ec.message());
+  }
+  return Status::OK();
+}
+
+const ElfSymbolTable::Entry* ElfSymbolTable::entries() const {
+  return reinterpret_cast<const Entry*>(data_ + sizeof(Header));
+}
+
+std::string_view ElfSymbolTable::names() const {
+  const size_t offset = sizeof(Header) + header().num_entries * sizeof(Entry);
+  return std::string_view(data_ + offset, header().names_size);
+}
+
+size_t ElfSymbolTable::size() const { return header().num_entries; }
+
+std::string_view ElfSymbolTable::Lookup(uintptr_t addr) const {
+  static thread_local std::string symbol_str;
+
+  // Find the first symbol that starts after addr; the one before it is the candidate.
+  const Entry* begin = entries();
+  const Entry* end = begin + size();
+  const Entry* iter = std::upper_bound(
+      begin, end, addr, [](uintptr_t addr, const Entry& entry) { return addr < entry.addr; });
+
+  if (iter != begin) {
+    --iter;
+    if (addr >= iter->addr && addr < iter->addr + iter->size) {
+      return names().substr(iter->name_offset, iter->name_size);
+    }
+  }
+
+  // Couldn't find the address.
+  symbol_str = absl::StrFormat("0x%016llx", addr);
+  return symbol_str;
+}
+
+StatusOr<std::shared_ptr<const ElfSymbolTable>> ElfSymbolTableCache::GetSymbolTable(
+    obj_tools::ElfReader* elf_reader) {
+  const std::string& build_id = elf_reader->build_id();
+  if (build_id.empty()) {
+    PX_ASSIGN_OR_RETURN(auto symbolizer, elf_reader->GetSymbolizer());
+    return std::shared_ptr<const ElfSymbolTable>(ElfSymbolTable::Create(*symbolizer));
+  }
+
+  std::weak_ptr<const ElfSymbolTable>& cached = tables_[build_id];
+  if (std::shared_ptr<const ElfSymbolTable> table = cached.lock()) {
+    return table;
+  }
+
+  // Drop the tables of binaries that no process runs anymore, since there is a miss anyway.
+  absl::erase_if(tables_, [](const auto& kv) { return kv.second.expired(); });
+
+  std::shared_ptr<const ElfSymbolTable> table;
+  const std::filesystem::path path = dir_.empty()
+                                         ? std::filesystem::path()
+                                         : dir_ / absl::StrCat(build_id, kFileSuffix);
+  if (!path.empty()) {
+    auto table_or = ElfSymbolTable::Open(path);
+    if (table_or.ok()) {
+      table = table_or.ConsumeValueOrDie();
+      // Keeps the table from being evicted as least recently used.
+      std::error_code ec;
+      std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+    }
+  }
+
+  if (table == nullptr) {
+    PX_ASSIGN_OR_RETURN(auto symbolizer, elf_reader->GetSymbolizer());
+    std::unique_ptr<ElfSymbolTable> new_table = ElfSymbolTable::Create(*symbolizer);
+    if (!path.empty()) {
+      Status s = fs::CreateDirectories(dir_);
+      if (s.ok()) {
+        s = new_table->Write(path);
+      }
+      if (s.ok()) {
+        EvictCacheEntries(dir_, FLAGS_stirling_profiler_elf_symbols_cache_max_entries);
+      } else {
+        VLOG(1) << absl::Substitute("Failed to persist the symbol table of $0 [error=$1]",
+                                    build_id, s.ToString());
+      }
+    }
+    table = std::move(new_table);
+  }
+
+  // tables_ may have been rehashed by the purge above.
+  tables_[build_id] = table;
+  return table;
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/base.h"
+#include "src/stirling/obj_tools/elf_reader.h"
+
+DECLARE_string(stirling_profiler_elf_symbols_cache_dir);
+DECLARE_uint32(stirling_profiler_elf_symbols_cache_max_entries);
+
+namespace px {
+namespace stirling {
+
+/**
+ * The function symbols of an ELF binary, as a table sorted by address, for ElfSymbolizer.
+ *
+ * The in-memory layout is also the file format: a header, the fixed-size entries sorted by
+ * address, then the names. A table read back from a file is mmap'ed as is, without parsing.
+ */
+class ElfSymbolTable : public NotCopyMoveable {
+ public:
+  /**
+   * Builds the table from the symbols found by the ElfReader.
+   */
+  static std::unique_ptr<ElfSymbolTable> Create(const obj_tools::ElfReader::Symbolizer& symbols);
+
+  /**
+   * Maps a table written by Write(). Returns an error if the file is not a valid table.
+   */
+  static StatusOr<std::unique_ptr<ElfSymbolTable>> Open(const std::filesystem::path& path);
+
+  ~ElfSymbolTable();
+
+  /**
+   * Writes the table to the file, atomically replacing it.
+   */
+  Status Write(const std::filesystem::path& path) const;
+
+  /**
+   * Looks up the symbol for the specified binary address, like ElfReader::Symbolizer::Lookup().
+   * Safe to call concurrently.
+   */
+  std::string_view Lookup(uintptr_t addr) const;
+
+  size_t size() const;
+
+ private:
+  struct Header;
+  struct Entry;
+
+  ElfSymbolTable() = default;
+
+  const Header& header() const { return *reinterpret_cast<const Header*>(data_); }
+  const Entry* entries() const;
+  std::string_view names() const;
+
+  // Backed either by owned_data_, or by a read-only mapping of a file.
+  std::string owned_data_;
+  const char* data_ = nullptr;
+  size_t data_size_ = 0;
+  bool mapped_ = false;
+};
+
+/**
+ * Shares the symbol tables of ELF binaries, keyed by build-id, between the processes that run the
+ * same binary. With --stirling_profiler_elf_symbols_cache_dir, tables are also persisted, so that
+ * they outlive the processes, and survive restarts.
+ */
+class ElfSymbolTableCache : public NotCopyMoveable {
+ public:
+  /**
+   * @param dir Where tables are persisted; empty to only share them in memory.
+   */
+  explicit ElfSymbolTableCache(std::filesystem::path dir) : dir_(std::move(dir)) {}
+
+  /**
+   * Returns the symbol table of the binary read by the ElfReader. The table is found in memory,
+   * on disk, or built from the ELF symbols, in that order. Binaries without a build-id are not
+   * cached.
+   */
+  StatusOr<std::shared_ptr<const ElfSymbolTable>> GetSymbolTable(obj_tools::ElfReader* elf_reader);
+
+ private:
+  const std::filesystem::path dir_;
+
+  // Build-id to symbol table. The tables are owned by the symbolizers of the processes.
+  absl::flat_hash_map<std::string, std::weak_ptr<const ElfSymbolTable>> tables_;
+};
+
+}  // namespace stirling
+}  // namespace px
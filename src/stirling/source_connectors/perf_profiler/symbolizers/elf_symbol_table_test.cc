@@ -0,0 +1,142 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/perf_profiler/symbolizers/elf_symbol_table.h"
+
+#include <string>
+
+#include "src/common/testing/temp_dir.h"
+#include "src/common/testing/test_environment.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+using ::px::stirling::obj_tools::ElfReader;
+
+ElfReader::Symbolizer TestSymbols() {
+  ElfReader::Symbolizer symbols;
+  symbols.AddEntry(0x1000, 0x10, "foo");
+  symbols.AddEntry(0x1010, 0x20, "bar");
+  symbols.AddEntry(0x2000, 0x8, "");
+  symbols.AddEntry(0x3000, 0x100, "baz");
+  return symbols;
+}
+
+// Expects the table to resolve every address like the ElfReader::Symbolizer it was built from.
+void ExpectSameLookups(const ElfReader::Symbolizer& symbols, const ElfSymbolTable& table) {
+  const uintptr_t kAddrs[] = {0x0,    0xfff,  0x1000, 0x100f, 0x1010, 0x102f, 0x1030,
+                              0x2000, 0x2007, 0x2008, 0x3000, 0x30ff, 0x3100, 0xffffffff};
+  for (uintptr_t addr : kAddrs) {
+    EXPECT_EQ(std::string(table.Lookup(addr)), std::string(symbols.Lookup(addr)))
+        << absl::StrFormat("addr=0x%x", addr);
+  }
+}
+
+TEST(ElfSymbolTableTest, LookupMatchesSymbolizer) {
+  const ElfReader::Symbolizer symbols = TestSymbols();
+  std::unique_ptr<ElfSymbolTable> table = ElfSymbolTable::Create(symbols);
+  EXPECT_EQ(table->size(), 4);
+  EXPECT_EQ(table->Lookup(0x1018), "bar");
+  EXPECT_EQ(table->Lookup(0x1030), "0x0000000000001030");
+  ExpectSameLookups(symbols, *table);
+}
+
+TEST(ElfSymbolTableTest, Empty) {
+  std::unique_ptr<ElfSymbolTable> table = ElfSymbolTable::Create(ElfReader::Symbolizer());
+  EXPECT_EQ(table->size(), 0);
+  EXPECT_EQ(table->Lookup(0x1000), "0x0000000000001000");
+}
+
+TEST(ElfSymbolTableTest, WriteAndOpen) {
+  px::testing::TempDir temp_dir;
+  const std::filesystem::path path = temp_dir.path() / "table.symtab";
+
+  const ElfReader::Symbolizer symbols = TestSymbols();
+  ASSERT_OK(ElfSymbolTable::Create(symbols)->Write(path));
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfSymbolTable> table, ElfSymbolTable::Open(path));
+  EXPECT_EQ(table->size(), 4);
+  ExpectSameLookups(symbols, *table);
+}
+
+TEST(ElfSymbolTableTest, OpenRejectsInvalidFiles) {
+  px::testing::TempDir temp_dir;
+  const std::filesystem::path path = temp_dir.path() / "table.symtab";
+
+  EXPECT_NOT_OK(ElfSymbolTable::Open(path));
+
+  ASSERT_OK(WriteFileFromString(path.string(), "not a symbol table"));
+  EXPECT_NOT_OK(ElfSymbolTable::Open(path));
+
+  // Truncated.
+  ASSERT_OK(ElfSymbolTable::Create(TestSymbols())->Write(path));
+  ASSERT_OK_AND_ASSIGN(std::string data, ReadFileToString(path.string()));
+  ASSERT_OK(WriteFileFromString(path.string(), data.substr(0, data.size() - 1)));
+  EXPECT_NOT_OK(ElfSymbolTable::Open(path));
+}
+
+class ElfSymbolTableCacheTest : public ::testing::Test {
+ protected:
+  StatusOr<std::unique_ptr<ElfReader>> CreateElfReader() {
+    const std::string bin =
+        px::testing::BazelRunfilePath("src/stirling/obj_tools/testdata/cc/stripped_test_exe");
+    const std::string debug_dir =
+        px::testing::BazelRunfilePath("src/stirling/obj_tools/testdata/cc/usr/lib/debug");
+    return ElfReader::Create(bin, debug_dir);
+  }
+
+  px::testing::TempDir temp_dir_;
+};
+
+TEST_F(ElfSymbolTableCacheTest, SharedByBuildID) {
+  ElfSymbolTableCache cache(temp_dir_.path());
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader> elf_reader1, CreateElfReader());
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader> elf_reader2, CreateElfReader());
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<const ElfSymbolTable> table1,
+                       cache.GetSymbolTable(elf_reader1.get()));
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<const ElfSymbolTable> table2,
+                       cache.GetSymbolTable(elf_reader2.get()));
+  EXPECT_EQ(table1, table2);
+  EXPECT_GT(table1->size(), 0);
+  EXPECT_TRUE(std::filesystem::exists(temp_dir_.path() / "7deb0e3f89deba61.symtab"));
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader::Symbolizer> symbols,
+                       elf_reader1->GetSymbolizer());
+  ExpectSameLookups(*symbols, *table1);
+}
+
+TEST_F(ElfSymbolTableCacheTest, ReadFromDisk) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader> elf_reader, CreateElfReader());
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader::Symbolizer> symbols,
+                       elf_reader->GetSymbolizer());
+
+  // Stands in for the table persisted by a previous instance.
+  ElfReader::Symbolizer fake_symbols;
+  fake_symbols.AddEntry(0, 0x100000, "from_disk");
+  ASSERT_OK(ElfSymbolTable::Create(fake_symbols)->Write(temp_dir_.path() /
+                                                        "7deb0e3f89deba61.symtab"));
+
+  ElfSymbolTableCache cache(temp_dir_.path());
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<const ElfSymbolTable> table,
+                       cache.GetSymbolTable(elf_reader.get()));
+  EXPECT_EQ(table->Lookup(0x1000), "from_disk");
+}
+
+}  // namespace stirling
+}  // namespace px
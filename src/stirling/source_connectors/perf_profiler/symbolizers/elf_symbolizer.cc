@@ -42,22 +42,22 @@ StatusOr<std::unique_ptr<Symbolizer>> ElfSymbolizer::Create() {
 
 void ElfSymbolizer::DeleteUPID(const struct upid_t& upid) { symbolizers_.erase(upid); }
 
-StatusOr<std::unique_ptr<ElfSymbolizer::SymbolizerWithConverter>> CreateUPIDSymbolizer(
-    const struct upid_t& upid) {
+StatusOr<std::unique_ptr<ElfSymbolizer::SymbolizerWithConverter>>
+ElfSymbolizer::CreateUPIDSymbolizer(const struct upid_t& upid) {
   const pid_t pid = upid.pid;
   const system::ProcParser proc_parser;
   PX_ASSIGN_OR_RETURN(const auto proc_exe, proc_parser.GetExePath(pid));
   PX_ASSIGN_OR_RETURN(auto elf_reader, ElfReader::Create(ProcPidRootPath(pid, proc_exe.string())));
 
-  PX_ASSIGN_OR_RETURN(auto symbolizer, elf_reader->GetSymbolizer());
+  PX_ASSIGN_OR_RETURN(auto symbol_table, symbol_tables_.GetSymbolTable(elf_reader.get()));
   PX_ASSIGN_OR_RETURN(auto converter,
                       obj_tools::ElfAddressConverter::Create(elf_reader.get(), pid));
-  return std::make_unique<ElfSymbolizer::SymbolizerWithConverter>(std::move(symbolizer),
+  return std::make_unique<ElfSymbolizer::SymbolizerWithConverter>(std::move(symbol_table),
                                                                   std::move(converter));
 }
 
 std::string_view EmptySymbolizerFn(const uintptr_t addr) {
-  static std::string symbol;
+  static thread_local std::string symbol;
   symbol = absl::StrFormat("0x%016llx", addr);
   return symbol;
 }
@@ -87,7 +87,7 @@ profiler::SymbolizerFn ElfSymbolizer::GetSymbolizerFn(const struct upid_t& upid)
 
 std::string_view ElfSymbolizer::SymbolizerWithConverter::Lookup(uint64_t virtual_addr) const {
   auto binary_addr = converter_->VirtualAddrToBinaryAddr(virtual_addr);
-  return symbolizer_->Lookup(binary_addr);
+  return symbol_table_->Lookup(binary_addr);
 }
 
 }  // namespace stirling
@@ -22,6 +22,7 @@
 #include <utility>
 
 #include "src/stirling/obj_tools/address_converter.h"
+#include "src/stirling/source_connectors/perf_profiler/symbolizers/elf_symbol_table.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/symbolizer.h"
 
 namespace px {
@@ -41,18 +42,24 @@ class ElfSymbolizer : public Symbolizer, public NotCopyMoveable {
 
   class SymbolizerWithConverter {
    public:
-    SymbolizerWithConverter(std::unique_ptr<obj_tools::ElfReader::Symbolizer> symbolizer,
+    SymbolizerWithConverter(std::shared_ptr<const ElfSymbolTable> symbol_table,
                             std::unique_ptr<obj_tools::ElfAddressConverter> converter)
-        : symbolizer_(std::move(symbolizer)), converter_(std::move(converter)) {}
+        : symbol_table_(std::move(symbol_table)), converter_(std::move(converter)) {}
     std::string_view Lookup(uintptr_t addr) const;
 
    private:
-    std::unique_ptr<obj_tools::ElfReader::Symbolizer> symbolizer_;
+    // Shared with the other processes running the same binary.
+    std::shared_ptr<const ElfSymbolTable> symbol_table_;
     std::unique_ptr<obj_tools::ElfAddressConverter> converter_;
   };
 
  private:
-  ElfSymbolizer() = default;
+  ElfSymbolizer() : symbol_tables_(FLAGS_stirling_profiler_elf_symbols_cache_dir) {}
+
+  StatusOr<std::unique_ptr<SymbolizerWithConverter>> CreateUPIDSymbolizer(
+      const struct upid_t& upid);
+
+  ElfSymbolTableCache symbol_tables_;
 
   // A symbolizer per UPID.
   absl::flat_hash_map<struct upid_t, std::unique_ptr<SymbolizerWithConverter>> symbolizers_;
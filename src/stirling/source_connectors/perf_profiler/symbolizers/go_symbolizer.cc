@@ -0,0 +1,138 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/perf_profiler/symbolizers/go_symbolizer.h"
+
+#include <utility>
+#include <vector>
+
+#include <absl/functional/bind_front.h>
+
+#include "src/common/system/proc_parser.h"
+#include "src/common/system/proc_pid_path.h"
+#include "src/stirling/obj_tools/elf_reader.h"
+#include "src/stirling/obj_tools/go_syms.h"
+#include "src/stirling/source_connectors/perf_profiler/shared/symbolization.h"
+
+DEFINE_bool(stirling_profiler_go_symbols, gflags::BoolFromEnv("PL_PROFILER_GO_SYMBOLS", true),
+            "Whether to symbolize Go binaries from their function tables, with inlined frames.");
+
+using ::px::stirling::obj_tools::ElfReader;
+using ::px::stirling::obj_tools::GoPclntab;
+using ::px::system::ProcPidRootPath;
+
+namespace px {
+namespace stirling {
+
+StatusOr<std::unique_ptr<Symbolizer>> GoSymbolizer::Create(
+    std::unique_ptr<Symbolizer> native_symbolizer) {
+  auto go_symbolizer = std::unique_ptr<GoSymbolizer>(new GoSymbolizer());
+  go_symbolizer->native_symbolizer_ = std::move(native_symbolizer);
+  return std::unique_ptr<Symbolizer>(go_symbolizer.release());
+}
+
+void GoSymbolizer::DeleteUPID(const struct upid_t& upid) {
+  symbolizer_functions_.erase(upid);
+  symbolization_contexts_.erase(upid);
+  native_symbolizer_->DeleteUPID(upid);
+}
+
+StatusOr<std::unique_ptr<GoSymbolizer::GoSymbolizationContext>>
+GoSymbolizer::CreateGoSymbolizationContext(const struct upid_t& upid,
+                                           profiler::SymbolizerFn native_symbolizer_fn) {
+  const pid_t pid = upid.pid;
+  const system::ProcParser proc_parser;
+  PX_ASSIGN_OR_RETURN(const auto proc_exe, proc_parser.GetExePath(pid));
+  PX_ASSIGN_OR_RETURN(auto elf_reader, ElfReader::Create(ProcPidRootPath(pid, proc_exe.string())));
+  if (!obj_tools::IsGoExecutable(elf_reader.get())) {
+    return error::NotFound("Not a Go executable.");
+  }
+
+  std::string build_id = elf_reader->build_id();
+  if (build_id.empty()) {
+    build_id = obj_tools::ReadGoBuildID(elf_reader.get());
+  }
+
+  std::shared_ptr<const GoPclntab> pclntab;
+  if (!build_id.empty()) {
+    pclntab = pclntabs_[build_id].lock();
+  }
+  if (pclntab == nullptr) {
+    PX_ASSIGN_OR_RETURN(pclntab, GoPclntab::Create(elf_reader.get()));
+    if (!build_id.empty()) {
+      // Drop the tables of binaries that no process runs anymore, since there is a miss anyway.
+      absl::erase_if(pclntabs_, [](const auto& kv) { return kv.second.expired(); });
+      pclntabs_[build_id] = pclntab;
+    }
+  }
+
+  PX_ASSIGN_OR_RETURN(auto converter,
+                      obj_tools::ElfAddressConverter::Create(elf_reader.get(), pid));
+  return std::make_unique<GoSymbolizationContext>(std::move(pclntab), std::move(converter),
+                                                  std::move(native_symbolizer_fn));
+}
+
+profiler::SymbolizerFn GoSymbolizer::GetSymbolizerFn(const struct upid_t& upid) {
+  auto fn_it = symbolizer_functions_.find(upid);
+  if (fn_it != symbolizer_functions_.end()) {
+    return fn_it->second;
+  }
+
+  // The native symbolizer is the fallback for processes that are not Go, and for the addresses
+  // of Go processes that are not in Go code.
+  profiler::SymbolizerFn native_symbolizer_fn = native_symbolizer_->GetSymbolizerFn(upid);
+
+  auto ctx_or = CreateGoSymbolizationContext(upid, native_symbolizer_fn);
+  if (!ctx_or.ok()) {
+    VLOG(1) << absl::Substitute("Using the native symbolizer for pid $0 [reason=$1]", upid.pid,
+                                ctx_or.ToString());
+    symbolizer_functions_[upid] = native_symbolizer_fn;
+    return native_symbolizer_fn;
+  }
+
+  std::unique_ptr<GoSymbolizationContext>& ctx = symbolization_contexts_[upid];
+  ctx = ctx_or.ConsumeValueOrDie();
+  auto fn = absl::bind_front(&GoSymbolizationContext::Symbolize, ctx.get());
+  symbolizer_functions_[upid] = fn;
+  return fn;
+}
+
+std::string_view GoSymbolizer::GoSymbolizationContext::Symbolize(uintptr_t addr) const {
+  const uint64_t binary_addr = converter_->VirtualAddrToBinaryAddr(addr);
+  const std::vector<GoPclntab::Frame> frames = pclntab_->LookupFrames(binary_addr);
+  if (frames.empty()) {
+    return native_symbolizer_fn_(addr);
+  }
+  if (frames.size() == 1) {
+    return frames[0].function;
+  }
+
+  // The inlined calls become frames of their own, outermost first as in the folded stack traces.
+  static thread_local std::string symbol;
+  symbol.clear();
+  for (auto iter = frames.rbegin(); iter != frames.rend(); ++iter) {
+    if (!symbol.empty()) {
+      symbol.append(symbolization::kSeparator);
+    }
+    symbol.append(iter->function);
+  }
+  return symbol;
+}
+
+}  // namespace stirling
+}  // namespace px
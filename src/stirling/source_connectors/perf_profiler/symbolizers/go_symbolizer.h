@@ -0,0 +1,86 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/stirling/obj_tools/address_converter.h"
+#include "src/stirling/obj_tools/go_pclntab.h"
+#include "src/stirling/source_connectors/perf_profiler/symbolizers/symbolizer.h"
+
+DECLARE_bool(stirling_profiler_go_symbols);
+
+namespace px {
+namespace stirling {
+
+/**
+ * Symbolizes Go processes from the function table of their binary (.gopclntab), which does not
+ * need DWARF, and expands inlined calls into their own frames. Other processes, and the addresses
+ * of Go processes outside of the Go code (e.g. in libc), go to the native symbolizer.
+ */
+class GoSymbolizer : public Symbolizer, public NotCopyMoveable {
+ public:
+  static StatusOr<std::unique_ptr<Symbolizer>> Create(
+      std::unique_ptr<Symbolizer> native_symbolizer);
+
+  profiler::SymbolizerFn GetSymbolizerFn(const struct upid_t& upid) override;
+  void IterationPreTick() override { native_symbolizer_->IterationPreTick(); }
+  void DeleteUPID(const struct upid_t& upid) override;
+  bool Uncacheable(const struct upid_t& upid) override {
+    return native_symbolizer_->Uncacheable(upid);
+  }
+
+  class GoSymbolizationContext {
+   public:
+    GoSymbolizationContext(std::shared_ptr<const obj_tools::GoPclntab> pclntab,
+                           std::unique_ptr<obj_tools::ElfAddressConverter> converter,
+                           profiler::SymbolizerFn native_symbolizer_fn)
+        : pclntab_(std::move(pclntab)),
+          converter_(std::move(converter)),
+          native_symbolizer_fn_(std::move(native_symbolizer_fn)) {}
+
+    std::string_view Symbolize(uintptr_t addr) const;
+
+   private:
+    // Shared with the other processes running the same binary.
+    std::shared_ptr<const obj_tools::GoPclntab> pclntab_;
+    std::unique_ptr<obj_tools::ElfAddressConverter> converter_;
+    profiler::SymbolizerFn native_symbolizer_fn_;
+  };
+
+ private:
+  GoSymbolizer() = default;
+
+  StatusOr<std::unique_ptr<GoSymbolizationContext>> CreateGoSymbolizationContext(
+      const struct upid_t& upid, profiler::SymbolizerFn native_symbolizer_fn);
+
+  std::unique_ptr<Symbolizer> native_symbolizer_;
+  absl::flat_hash_map<struct upid_t, profiler::SymbolizerFn> symbolizer_functions_;
+  absl::flat_hash_map<struct upid_t, std::unique_ptr<GoSymbolizationContext>>
+      symbolization_contexts_;
+
+  // Build ID to function table. The tables are owned by the symbolization contexts.
+  absl::flat_hash_map<std::string, std::weak_ptr<const obj_tools::GoPclntab>> pclntabs_;
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -16,8 +16,16 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
 #include <string>
 
+#include <absl/container/flat_hash_map.h>
 #include <absl/functional/bind_front.h>
 #include <prometheus/counter.h>
 
@@ -105,89 +113,112 @@ void JavaSymbolizationContext::RemoveArtifacts() const {
   }
 }
 
+bool JavaSymbolizationContext::MapSymbolFile(size_t file_size) {
+  if (file_size <= mapped_size_) {
+    return true;
+  }
+  // The symbol file only grows, so the mapping is replaced by a larger one as it does.
+  void* mapped = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, symbol_fd_, 0);
+  if (mapped == MAP_FAILED) {
+    LOG(WARNING) << absl::Substitute("Could not map the Java symbol file in $0: $1.",
+                                     host_artifacts_path_.string(), std::strerror(errno));
+    return false;
+  }
+  if (mapped_file_ != nullptr) {
+    munmap(const_cast<char*>(mapped_file_), mapped_size_);
+  }
+  mapped_file_ = static_cast<const char*>(mapped);
+  mapped_size_ = file_size;
+  return true;
+}
+
 void JavaSymbolizationContext::UpdateSymbolMap() {
-  auto reset_symbol_file = [&](const auto pos) {
-    symbol_file_->seekg(pos);
-    symbol_file_->clear();
-    DCHECK(symbol_file_->good());
-  };
+  struct stat file_stat;
+  if (fstat(symbol_fd_, &file_stat) != 0) {
+    return;
+  }
+  const size_t file_size = static_cast<size_t>(file_stat.st_size);
+  if (file_size <= read_offset_ || !MapSymbolFile(file_size)) {
+    return;
+  }
 
+  // The offset of the last update of each address in the new part of the file. Only the last one
+  // matters, so the earlier ones are neither demangled nor inserted.
+  absl::flat_hash_map<uint64_t, size_t> latest_updates;
   java::RawSymbolUpdate update;
-
-  std::string buffer;
-  std::string symbol;
-  std::string fn_sig;
-  std::string class_sig;
-
-  buffer.reserve(300);
-  symbol.reserve(100);
-  fn_sig.reserve(100);
-  class_sig.reserve(100);
-
-  while (true) {
-    const auto pos = symbol_file_->tellg();
-
-    symbol_file_->read(reinterpret_cast<char*>(&update), sizeof(java::RawSymbolUpdate));
-    if (!symbol_file_->good()) {
-      // No data to be read. Break from the loop. Pedantically reset file pos so that when we
-      // return here, we are in the correct state.
-      reset_symbol_file(pos);
+  while (read_offset_ + sizeof(java::RawSymbolUpdate) <= file_size) {
+    std::memcpy(&update, mapped_file_ + read_offset_, sizeof(java::RawSymbolUpdate));
+    const size_t update_end =
+        read_offset_ + sizeof(java::RawSymbolUpdate) + update.TotalNumSymbolBytes();
+    if (update_end > file_size) {
+      // The agent is still writing this update. It is parsed on a later refresh.
       break;
     }
+    latest_updates[update.addr] = read_offset_;
+    read_offset_ = update_end;
+  }
+  if (latest_updates.empty()) {
+    return;
+  }
 
-    const uint64_t n = update.TotalNumSymbolBytes();
-
-    if (buffer.capacity() < n) {
-      buffer.resize(n);
-    }
-
-    symbol_file_->read(buffer.data(), n);
-    if (!symbol_file_->good()) {
-      // If the read fails, then the symbol file was left in a partially written state.
-      // Reset the file position back to the beginning of a symbol, and break out of this loop.
-      reset_symbol_file(pos);
-      break;
+  // Drop the symbols that were unloaded or replaced.
+  bool has_stale_symbols = false;
+  for (const auto& [addr, offset] : latest_updates) {
+    auto it = std::lower_bound(
+        symbols_.begin(), symbols_.end(), addr,
+        [](const JavaSymbol& symbol, uint64_t a) { return symbol.addr < a; });
+    if (it != symbols_.end() && it->addr == addr) {
+      it->size = 0;
+      has_stale_symbols = true;
     }
+  }
+  if (has_stale_symbols) {
+    symbols_.erase(std::remove_if(symbols_.begin(), symbols_.end(),
+                                  [](const JavaSymbol& symbol) { return symbol.size == 0; }),
+                   symbols_.end());
+  }
 
-    // At this point, we have consumed an entire udpate from the symbol file.
-    // We either put a new symbol into the symbol map (common case) or remove a symbol.
-
-    if (update.method_unload) {
-      // Handle remove symbol scenario.
-      // NB: if we go back to caching Java symbols, we will need to invalidate
-      // any cached instances of this symbol.
-      symbol_map_.erase(update.addr);
+  const size_t num_old_symbols = symbols_.size();
+  for (const auto& [addr, offset] : latest_updates) {
+    std::memcpy(&update, mapped_file_ + offset, sizeof(java::RawSymbolUpdate));
+    // NB: if we go back to caching Java symbols, we will need to invalidate any cached instances
+    // of unloaded symbols.
+    if (update.method_unload || update.code_size == 0) {
       continue;
     }
-
-    // TODO(jps): Make the interface to the demangler consume string_view only, then
-    // convert symbol, fn_sig, and class_sig to string_view (reduces copying).
     // TODO(jps): Remove null terminating character from java::RawSymbolUpdate.
-    symbol.assign(buffer.data() + update.SymbolOffset(), update.symbol_size - 1);
-    fn_sig.assign(buffer.data() + update.FnSigOffset(), update.fn_sig_size - 1);
-    class_sig.assign(buffer.data() + update.ClassSigOffset(), update.class_sig_size - 1);
+    const char* data = mapped_file_ + offset + sizeof(java::RawSymbolUpdate);
+    const std::string symbol(data + update.SymbolOffset(), update.symbol_size - 1);
+    const std::string fn_sig(data + update.FnSigOffset(), update.fn_sig_size - 1);
+    const std::string class_sig(data + update.ClassSigOffset(), update.class_sig_size - 1);
 
     using symbolization::kJavaPrefix;
-    const auto demangled = absl::StrCat(kJavaPrefix, java::Demangle(symbol, class_sig, fn_sig));
-
     // TODO(jps): Change to uint32_t in java::RawSymbolUpdate.
-    const uint32_t code_size = static_cast<uint32_t>(update.code_size);
-    symbol_map_.try_emplace(update.addr, demangled, code_size);
+    symbols_.push_back(JavaSymbol{update.addr, static_cast<uint32_t>(update.code_size),
+                                  absl::StrCat(kJavaPrefix, java::Demangle(symbol, class_sig,
+                                                                           fn_sig))});
   }
-  DCHECK(symbol_file_->good());
+  auto by_addr = [](const JavaSymbol& a, const JavaSymbol& b) { return a.addr < b.addr; };
+  std::sort(symbols_.begin() + num_old_symbols, symbols_.end(), by_addr);
+  std::inplace_merge(symbols_.begin(), symbols_.begin() + num_old_symbols, symbols_.end(),
+                     by_addr);
 }
 
 JavaSymbolizationContext::JavaSymbolizationContext(const struct upid_t& target_upid,
                                                    profiler::SymbolizerFn native_symbolizer_fn,
-                                                   std::unique_ptr<std::ifstream> symbol_file)
-    : native_symbolizer_fn_(native_symbolizer_fn), symbol_file_(std::move(symbol_file)) {
-  DCHECK(symbol_file_->good());
+                                                   int symbol_fd)
+    : native_symbolizer_fn_(native_symbolizer_fn),
+      host_artifacts_path_(java::AgentArtifactsPath(target_upid)),
+      symbol_fd_(symbol_fd) {
   UpdateSymbolMap();
-
-  host_artifacts_path_ = java::AgentArtifactsPath(target_upid);
 }
 
-JavaSymbolizationContext::~JavaSymbolizationContext() { symbol_file_->close(); }
+JavaSymbolizationContext::~JavaSymbolizationContext() {
+  if (mapped_file_ != nullptr) {
+    munmap(const_cast<char*>(mapped_file_), mapped_size_);
+  }
+  close(symbol_fd_);
+}
 
 std::string_view JavaSymbolizationContext::Symbolize(const uintptr_t addr) {
   if (requires_refresh_) {
@@ -200,18 +231,16 @@ std::string_view JavaSymbolizationContext::Symbolize(const uintptr_t addr) {
     requires_refresh_ = false;
   }
 
-  static std::string symbol;
+  static thread_local std::string symbol;
 
-  if (symbol_map_.size() > 0) {
-    auto it = symbol_map_.upper_bound(addr);
-    if (it != symbol_map_.begin()) {
-      it--;
-      const uint64_t addr_lower = it->first;
-      const uint64_t addr_upper = addr_lower + it->second.size;
-      if ((addr_lower <= addr) && (addr < addr_upper)) {
-        symbol = it->second.symbol;
-        return symbol;
-      }
+  auto it = std::upper_bound(
+      symbols_.begin(), symbols_.end(), addr,
+      [](uint64_t a, const JavaSymbol& symbol) { return a < symbol.addr; });
+  if (it != symbols_.begin()) {
+    --it;
+    if (addr < it->addr + it->size) {
+      symbol = it->symbol;
+      return symbol;
     }
   }
   return native_symbolizer_fn_(addr);
@@ -274,11 +303,10 @@ std::string_view JavaSymbolizer::Symbolize(JavaSymbolizationContext* ctx, const
 }
 
 Status JavaSymbolizer::CreateNewJavaSymbolizationContext(const struct upid_t& upid) {
-  constexpr auto kIOFlags = std::ios::in | std::ios::binary;
   const std::filesystem::path symbol_file_path = java::StirlingSymbolFilePath(upid);
-  auto symbol_file = std::make_unique<std::ifstream>(symbol_file_path, kIOFlags);
+  const int symbol_fd = open(symbol_file_path.c_str(), O_RDONLY | O_CLOEXEC);
 
-  if (symbol_file->fail()) {
+  if (symbol_fd < 0) {
     char const* const fmt = "Java attacher [pid=$0]: Could not open symbol file: $1.";
     return error::Internal(fmt, upid.pid, symbol_file_path.string());
   }
@@ -289,8 +317,8 @@ Status JavaSymbolizer::CreateNewJavaSymbolizationContext(const struct upid_t& up
   DCHECK(inserted);
   if (inserted) {
     auto native_symbolizer_fn = native_symbolizer_->GetSymbolizerFn(upid);
-    iter->second = std::make_unique<JavaSymbolizationContext>(upid, native_symbolizer_fn,
-                                                              std::move(symbol_file));
+    iter->second =
+        std::make_unique<JavaSymbolizationContext>(upid, native_symbolizer_fn, symbol_fd);
   }
   auto& ctx = iter->second;
 
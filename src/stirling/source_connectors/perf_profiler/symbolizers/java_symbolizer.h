@@ -36,17 +36,15 @@ namespace stirling {
 
 class JavaSymbolizationContext {
  public:
-  struct SymbolAndCodeSize {
-    std::string symbol;
+  struct JavaSymbol {
+    uint64_t addr;
     uint32_t size;
-    SymbolAndCodeSize() {}
-    SymbolAndCodeSize(const std::string sym, const uint32_t sz) : symbol(sym), size(sz) {}
+    std::string symbol;
   };
-  using SymbolMapType = absl::btree_map<uint64_t, SymbolAndCodeSize>;
 
+  // Takes ownership of symbol_fd, the open symbol file that the injected agent appends to.
   JavaSymbolizationContext(const struct upid_t& target_upid,
-                           profiler::SymbolizerFn native_symbolizer_fn,
-                           std::unique_ptr<std::ifstream> symbol_file);
+                           profiler::SymbolizerFn native_symbolizer_fn, int symbol_fd);
   ~JavaSymbolizationContext();
 
   std::string_view Symbolize(const uintptr_t addr);
@@ -56,13 +54,23 @@ class JavaSymbolizationContext {
   void set_requires_refresh() { requires_refresh_ = true; }
 
  private:
+  // Parses the updates that were appended to the symbol file since the last call, and applies
+  // them to symbols_.
   void UpdateSymbolMap();
+  // Maps the first file_size bytes of the symbol file, if they aren't already.
+  bool MapSymbolFile(size_t file_size);
 
   bool requires_refresh_ = false;
-  SymbolMapType symbol_map_;
+  // Sorted by address. Updates are merged in once per refresh, rather than inserted one by one.
+  std::vector<JavaSymbol> symbols_;
   profiler::SymbolizerFn native_symbolizer_fn_;
-  std::unique_ptr<std::ifstream> symbol_file_;
   std::filesystem::path host_artifacts_path_;
+
+  int symbol_fd_ = -1;
+  const char* mapped_file_ = nullptr;
+  size_t mapped_size_ = 0;
+  // The offset of the first update in the symbol file that hasn't been parsed yet.
+  size_t read_offset_ = 0;
 };
 
 class JavaSymbolizer : public Symbolizer {
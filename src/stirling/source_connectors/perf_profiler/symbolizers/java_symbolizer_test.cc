@@ -0,0 +1,106 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <fcntl.h>
+
+#include <fstream>
+#include <string>
+
+#include "src/common/fs/temp_file.h"
+#include "src/common/testing/testing.h"
+#include "src/stirling/source_connectors/perf_profiler/java/agent/raw_symbol_update.h"
+#include "src/stirling/source_connectors/perf_profiler/symbolizers/java_symbolizer.h"
+
+namespace px {
+namespace stirling {
+
+class JavaSymbolizationContextTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    symbol_file_ = fs::TempFile::Create();
+    out_.open(symbol_file_->path(), std::ios::out | std::ios::binary | std::ios::app);
+  }
+
+  // Appends a symbol update to the symbol file, like the injected agent does.
+  void WriteUpdate(uint64_t addr, uint64_t code_size, std::string_view method, bool unload,
+                   bool partial = false) {
+    const std::string symbol = absl::StrCat(method, std::string(1, '\0'));
+    const std::string fn_sig = absl::StrCat("()V", std::string(1, '\0'));
+    const std::string class_sig = absl::StrCat("LFoo;", std::string(1, '\0'));
+    java::RawSymbolUpdate update = {};
+    update.addr = addr;
+    update.code_size = code_size;
+    update.symbol_size = symbol.size();
+    update.fn_sig_size = fn_sig.size();
+    update.class_sig_size = class_sig.size();
+    update.method_unload = unload;
+    out_.write(reinterpret_cast<const char*>(&update), sizeof(update));
+    out_ << symbol;
+    if (!partial) {
+      out_ << fn_sig << class_sig;
+    }
+    out_.flush();
+  }
+
+  std::unique_ptr<JavaSymbolizationContext> CreateContext() {
+    const int fd = open(symbol_file_->path().c_str(), O_RDONLY | O_CLOEXEC);
+    CHECK_GE(fd, 0);
+    struct upid_t upid = {};
+    return std::make_unique<JavaSymbolizationContext>(
+        upid, [](const uintptr_t) -> std::string_view { return "native"; }, fd);
+  }
+
+  std::unique_ptr<fs::TempFile> symbol_file_;
+  std::ofstream out_;
+};
+
+TEST_F(JavaSymbolizationContextTest, applies_appended_updates) {
+  WriteUpdate(0x2000, 0x100, "b", /*unload*/ false);
+  WriteUpdate(0x1000, 0x100, "a", /*unload*/ false);
+  auto ctx = CreateContext();
+
+  EXPECT_EQ(ctx->Symbolize(0x1000), "[j] void Foo::a()");
+  EXPECT_EQ(ctx->Symbolize(0x20ff), "[j] void Foo::b()");
+  EXPECT_EQ(ctx->Symbolize(0x2100), "native");
+  EXPECT_EQ(ctx->Symbolize(0x0fff), "native");
+
+  WriteUpdate(0x3000, 0x100, "c", /*unload*/ false);
+  WriteUpdate(0x1000, 0x100, "a", /*unload*/ true);
+  // The code of b was replaced.
+  WriteUpdate(0x2000, 0x80, "d", /*unload*/ false);
+  WriteUpdate(0x4000, 0x100, "e", /*unload*/ false, /*partial*/ true);
+
+  // Updates are only parsed once per refresh.
+  EXPECT_EQ(ctx->Symbolize(0x3000), "native");
+  ctx->set_requires_refresh();
+  EXPECT_EQ(ctx->Symbolize(0x3000), "[j] void Foo::c()");
+  EXPECT_EQ(ctx->Symbolize(0x1000), "native");
+  EXPECT_EQ(ctx->Symbolize(0x2000), "[j] void Foo::d()");
+  EXPECT_EQ(ctx->Symbolize(0x2080), "native");
+  EXPECT_EQ(ctx->Symbolize(0x4000), "native");
+
+  // The rest of the partially written update.
+  out_ << absl::StrCat("()V", std::string(1, '\0'), "LFoo;", std::string(1, '\0'));
+  out_.flush();
+  ctx->set_requires_refresh();
+  EXPECT_EQ(ctx->Symbolize(0x4000), "[j] void Foo::e()");
+  EXPECT_EQ(ctx->Symbolize(0x3000), "[j] void Foo::c()");
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -21,12 +21,18 @@
 
 // LINT_C_FILE: Do not remove this line. It ensures cpplint treats this as a C file.
 
+#include <linux/signal.h>
+
 #include "src/stirling/bpf_tools/bcc_bpf/task_struct_utils.h"
 #include "src/stirling/source_connectors/proc_exit/bcc_bpf_intf/proc_exit.h"
 #include "src/stirling/upid/upid.h"
 
 BPF_PERF_OUTPUT(proc_exit_events);
 
+// Exit counts in summary mode. The probe writes to one map while user space drains the other.
+BPF_HASH(proc_exit_summary_a, struct proc_exit_summary_key_t, uint64_t, PROC_EXIT_SUMMARY_MAP_SIZE);
+BPF_HASH(proc_exit_summary_b, struct proc_exit_summary_key_t, uint64_t, PROC_EXIT_SUMMARY_MAP_SIZE);
+
 // This array records singular values that are used by probes. We group them together to reduce the
 // number of arrays with only 1 element. Use of per-cpu array shall be the most efficient way,
 // compared to using hash table.
@@ -45,6 +51,37 @@ static __inline uint64_t read_exit_code(const struct task_struct* task) {
   return exit_code;
 }
 
+static __inline uint64_t read_control_value(int idx) {
+  uint64_t* value = control_values.lookup(&idx);
+  return value == NULL ? 0 : *value;
+}
+
+// Crashes are still submitted in summary mode, as they are rare, and each of them matters.
+static __inline bool is_crash(uint32_t exit_code) {
+  uint32_t signal = exit_code & 0x7F;
+  return signal == SIGABRT || signal == SIGSEGV || signal == SIGFPE || signal == SIGILL ||
+         signal == SIGBUS;
+}
+
+static __inline void summarize_exit(const struct task_struct* task, uint32_t exit_code) {
+  struct task_struct* parent = task->real_parent;
+
+  // The whole key, including its padding, is hashed.
+  struct proc_exit_summary_key_t key;
+  __builtin_memset(&key, 0, sizeof(key));
+  key.parent_upid.tgid = parent->tgid;
+  key.parent_upid.start_time_ticks = read_start_boottime(parent);
+  key.exit_code = exit_code;
+
+  uint64_t zero = 0;
+  uint64_t* count = read_control_value(TRANSFER_COUNT_INDEX) % 2 == 0
+                        ? proc_exit_summary_a.lookup_or_init(&key, &zero)
+                        : proc_exit_summary_b.lookup_or_init(&key, &zero);
+  if (count != NULL) {
+    lock_xadd(count, 1);
+  }
+}
+
 // A probe for the sched:sched_process_exit tracepoint.
 // This probe is primarily intended for performing BPF map clean-up after a process terminates.
 TRACEPOINT_PROBE(sched, sched_process_exit) {
@@ -54,13 +91,19 @@ TRACEPOINT_PROBE(sched, sched_process_exit) {
 
   bool is_thread_group_leader = tgid == tid;
   if (is_thread_group_leader) {
-    struct proc_exit_event_t event = {};
     struct task_struct* task = (struct task_struct*)bpf_get_current_task();
+    uint32_t exit_code = read_exit_code(task);
+
+    if (read_control_value(SUMMARY_MODE_INDEX) != 0 && !is_crash(exit_code)) {
+      summarize_exit(task, exit_code);
+      return 0;
+    }
 
+    struct proc_exit_event_t event = {};
     event.timestamp_ns = bpf_ktime_get_ns();
     event.upid.tgid = tgid;
     event.upid.start_time_ticks = read_start_boottime(task);
-    event.exit_code = read_exit_code(task);
+    event.exit_code = exit_code;
     bpf_get_current_comm(&event.comm, sizeof(event.comm));
 
     proc_exit_events.perf_submit(args, &event, sizeof(event));
@@ -39,9 +39,25 @@ struct proc_exit_event_t {
   char comm[MAX_CMD_SIZE];
 };
 
+#define PROC_EXIT_SUMMARY_MAP_SIZE 8192
+
+// In summary mode, the exits are counted in BPF per parent process and exit code, instead of
+// being submitted one by one.
+struct proc_exit_summary_key_t {
+  // The parent of the exited processes.
+  struct upid_t parent_upid;
+
+  // The exit_code from the task_struct object.
+  uint32_t exit_code;
+};
+
 // Specifies the corresponding indexes of the entries of a per-cpu array.
 enum proc_exit_trace_control_value_index_t {
   TASK_STRUCT_EXIT_CODE_OFFSET_INDEX,
+  // Non-zero if the exits are summarized, instead of being submitted.
+  SUMMARY_MODE_INDEX,
+  // Selects the summary map that the probe writes to, see ProcExitConnector::DrainSummary().
+  TRANSFER_COUNT_INDEX,
   NUM_CONTROL_VALUES,
 };
 
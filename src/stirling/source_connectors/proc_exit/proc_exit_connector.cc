@@ -21,6 +21,7 @@
 #include <signal.h>
 
 #include <utility>
+#include <vector>
 
 #include "src/common/base/base.h"
 #include "src/common/metrics/metrics.h"
@@ -33,6 +34,13 @@
 
 OBJ_STRVIEW(proc_exit_trace_bcc_script, proc_exit_trace);
 
+DEFINE_uint32(stirling_proc_exit_summary_threshold,
+              gflags::Uint32FromEnv("PL_STIRLING_PROC_EXIT_SUMMARY_THRESHOLD", 1000),
+              "The rate of process exits per second above which the exits are counted in BPF per "
+              "parent process and exit code, and recorded in proc_exit_summary, instead of being "
+              "recorded one by one in proc_exit_events. Crashes are always recorded one by one. "
+              "0 disables the summary mode.");
+
 namespace px {
 namespace stirling {
 namespace proc_exit_tracer {
@@ -79,6 +87,11 @@ Status ProcExitConnector::InitImpl() {
 
   PX_RETURN_IF_ERROR(bcc_->InitBPFProgram(proc_exit_trace_bcc_script));
 
+  control_values_ = bpf_tools::WrappedBCCPerCPUArrayTable<uint64_t>::Create(
+      bcc_.get(), kProcExitControlValuesArrayName);
+  summary_a_ = SummaryMap::Create(bcc_.get(), "proc_exit_summary_a");
+  summary_b_ = SummaryMap::Create(bcc_.get(), "proc_exit_summary_b");
+
   // Writes exit_code_offset to BPF array. Note that the other offsets are injected into BCC code
   // through macros.
   const auto& offset_opt = bpf_tools::BCCWrapper::task_struct_offsets_opt();
@@ -87,10 +100,8 @@ Status ProcExitConnector::InitImpl() {
         "Writing exit_code's offset to BPF array: offset=$0 bpf_array=$1 index=$2",
         offset_opt.value().exit_code_offset, kProcExitControlValuesArrayName,
         TASK_STRUCT_EXIT_CODE_OFFSET_INDEX);
-    auto control_table = bpf_tools::WrappedBCCPerCPUArrayTable<uint64_t>::Create(
-        bcc_.get(), kProcExitControlValuesArrayName);
-    PX_RETURN_IF_ERROR(control_table->SetValues(TASK_STRUCT_EXIT_CODE_OFFSET_INDEX,
-                                                offset_opt.value().exit_code_offset));
+    PX_RETURN_IF_ERROR(control_values_->SetValues(TASK_STRUCT_EXIT_CODE_OFFSET_INDEX,
+                                                  offset_opt.value().exit_code_offset));
   }
 
   const auto perf_buffer_specs = MakeArray<bpf_tools::PerfBufferSpec>({
@@ -101,6 +112,8 @@ Status ProcExitConnector::InitImpl() {
   PX_RETURN_IF_ERROR(bcc_->AttachTracepoints(kTracepointSpecs));
   PX_RETURN_IF_ERROR(bcc_->OpenPerfBuffers(perf_buffer_specs));
 
+  last_transfer_time_ = std::chrono::steady_clock::now();
+
   return Status::OK();
 }
 
@@ -111,16 +124,36 @@ uint8_t GetExitSignal(uint32_t exit_code) { return exit_code & 0x7F; }
 }  // namespace
 
 void ProcExitConnector::TransferDataImpl(ConnectorContext* ctx) {
-  DCHECK(data_tables_.size() == 1) << "Expect only one data table for proc_exit tracer";
-
   bcc_->PollPerfBuffers();
 
-  DataTable* data_table = data_tables_[0];
+  uint64_t num_exits = events_.size();
+  TransferEvents(ctx, data_tables_[kEventsTableNum]);
+
+  if (summary_mode_ || summary_drains_left_ > 0) {
+    num_exits += TransferSummary(ctx, data_tables_[kSummaryTableNum]);
+    if (!summary_mode_) {
+      --summary_drains_left_;
+    }
+  }
+
+  UpdateSummaryMode(num_exits);
+}
+
+void ProcExitConnector::TransferEvents(ConnectorContext* ctx, DataTable* data_table) {
+  if (data_table == nullptr) {
+    events_.clear();
+    return;
+  }
+
+  // The metadata is looked up once for the whole batch of events.
+  const uint32_t asid = ctx->GetASID();
+  const auto& upid_pid_info_map = ctx->GetPIDInfoMap();
+
   for (auto& event : events_) {
     event.timestamp_ns = ConvertToRealTime(event.timestamp_ns);
     DataTable::RecordBuilder<&kProcExitEventsTable> r(data_table, event.timestamp_ns);
     r.Append<proc_exit_tracer::kTimeIdx>(event.timestamp_ns);
-    md::UPID upid(ctx->GetASID(), event.upid.pid, event.upid.start_time_ticks);
+    md::UPID upid(asid, event.upid.pid, event.upid.start_time_ticks);
     r.Append<proc_exit_tracer::kUPIDIdx>(upid.value());
     // Exit code and signals are encoded in the exit_code field of the task_struct of the process.
     // See the description below:
@@ -129,11 +162,81 @@ void ProcExitConnector::TransferDataImpl(ConnectorContext* ctx) {
     r.Append<proc_exit_tracer::kSignalIdx>(GetExitSignal(event.exit_code));
     r.Append<proc_exit_tracer::kCommIdx>(std::move(event.comm));
 
-    UpdateCrashedJavaProcCounters(ctx->GetASID(), event, ctx->GetPIDInfoMap());
+    UpdateCrashedJavaProcCounters(asid, event, upid_pid_info_map);
   }
   events_.clear();
 }
 
+uint64_t ProcExitConnector::TransferSummary(ConnectorContext* ctx, DataTable* data_table) {
+  const uint32_t asid = ctx->GetASID();
+  const uint64_t time = AdjustedSteadyClockNowNS();
+
+  uint64_t num_exits = 0;
+  for (const auto& [key, count] : DrainSummary()) {
+    num_exits += count;
+    if (data_table == nullptr) {
+      continue;
+    }
+    DataTable::RecordBuilder<&kProcExitSummaryTable> r(data_table, time);
+    r.Append<proc_exit_tracer::kSummaryTimeIdx>(time);
+    md::UPID parent_upid(asid, key.parent_upid.pid, key.parent_upid.start_time_ticks);
+    r.Append<proc_exit_tracer::kSummaryUPIDIdx>(parent_upid.value());
+    r.Append<proc_exit_tracer::kSummaryExitCodeIdx>(key.exit_code >> 8);
+    r.Append<proc_exit_tracer::kSummarySignalIdx>(GetExitSignal(key.exit_code));
+    r.Append<proc_exit_tracer::kSummaryCountIdx>(count);
+  }
+  return num_exits;
+}
+
+std::vector<std::pair<struct proc_exit_summary_key_t, uint64_t>>
+ProcExitConnector::DrainSummary() {
+  // The probe counts into map A on even transfer counts, and into map B on odd ones. Switching the
+  // probe to the other map before reading this one means that no exit is lost between reading and
+  // clearing the map.
+  const bool using_map_a = transfer_count_ % 2 == 0;
+  ++transfer_count_;
+  const auto s = control_values_->SetValues(TRANSFER_COUNT_INDEX, transfer_count_);
+  LOG_IF(ERROR, !s.ok()) << "Error writing transfer_count_: " << s.msg();
+
+  SummaryMap* summary = using_map_a ? summary_a_.get() : summary_b_.get();
+  return summary->GetTableOffline(/*clear_table*/ true);
+}
+
+void ProcExitConnector::UpdateSummaryMode(uint64_t num_exits) {
+  const auto now = std::chrono::steady_clock::now();
+  const double elapsed_secs = std::chrono::duration<double>(now - last_transfer_time_).count();
+  last_transfer_time_ = now;
+
+  const uint32_t threshold = FLAGS_stirling_proc_exit_summary_threshold;
+  if (threshold == 0 || elapsed_secs <= 0) {
+    return;
+  }
+
+  // The summary mode is left at half the threshold, so that it doesn't flap around it.
+  const double rate = num_exits / elapsed_secs;
+  bool summary_mode = summary_mode_;
+  if (!summary_mode_ && rate > threshold) {
+    summary_mode = true;
+  } else if (summary_mode_ && rate < threshold / 2.0) {
+    summary_mode = false;
+  }
+  if (summary_mode == summary_mode_) {
+    return;
+  }
+
+  const auto s = control_values_->SetValues(SUMMARY_MODE_INDEX, summary_mode ? 1 : 0);
+  if (!s.ok()) {
+    LOG(ERROR) << "Error switching the summary mode: " << s.msg();
+    return;
+  }
+  LOG(INFO) << absl::Substitute("$0 the summary mode of the process exits at $1 exits/s.",
+                                summary_mode ? "Entering" : "Leaving", rate);
+  summary_mode_ = summary_mode;
+  if (summary_mode_) {
+    summary_drains_left_ = 2;
+  }
+}
+
 void ProcExitConnector::UpdateCrashedJavaProcCounters(
     uint32_t asid, const proc_exit_event_t& event,
     const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& upid_pid_info_map) {
@@ -22,6 +22,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "src/stirling/bpf_tools/bcc_wrapper.h"
@@ -30,6 +31,8 @@
 #include "src/stirling/source_connectors/proc_exit/proc_exit_events_table.h"
 #include "src/stirling/utils/monitor.h"
 
+DECLARE_uint32(stirling_proc_exit_summary_threshold);
+
 namespace px {
 namespace stirling {
 namespace proc_exit_tracer {
@@ -42,7 +45,9 @@ class ProcExitConnector : public BCCSourceConnector {
   static constexpr auto kSamplingPeriod = std::chrono::milliseconds{100};
   static constexpr auto kPushPeriod = std::chrono::milliseconds{1000};
 
-  static constexpr auto kTables = MakeArray(kProcExitEventsTable);
+  static constexpr auto kTables = MakeArray(kProcExitEventsTable, kProcExitSummaryTable);
+  static constexpr uint32_t kEventsTableNum = TableNum(kTables, kProcExitEventsTable);
+  static constexpr uint32_t kSummaryTableNum = TableNum(kTables, kProcExitSummaryTable);
 
   static std::unique_ptr<SourceConnector> Create(std::string_view name) {
     return std::unique_ptr<SourceConnector>(new ProcExitConnector(name));
@@ -61,9 +66,32 @@ class ProcExitConnector : public BCCSourceConnector {
   Status StopImpl() override { return Status::OK(); }
 
  private:
+  using SummaryMap = bpf_tools::WrappedBCCMap<struct proc_exit_summary_key_t, uint64_t>;
+
   std::vector<struct proc_exit_event_t> events_;
 
+  // The exits are summarized in BPF while their rate is above
+  // --stirling_proc_exit_summary_threshold. The summary maps are drained for a couple of
+  // transfers after that, to pick up the exits that raced with the switch.
+  bool summary_mode_ = false;
+  int summary_drains_left_ = 0;
+  uint64_t transfer_count_ = 0;
+  std::chrono::steady_clock::time_point last_transfer_time_;
+  std::unique_ptr<bpf_tools::WrappedBCCPerCPUArrayTable<uint64_t>> control_values_;
+  std::unique_ptr<SummaryMap> summary_a_;
+  std::unique_ptr<SummaryMap> summary_b_;
+
  private:
+  void TransferEvents(ConnectorContext* ctx, DataTable* data_table);
+
+  // Returns the number of exits that were summarized.
+  uint64_t TransferSummary(ConnectorContext* ctx, DataTable* data_table);
+
+  std::vector<std::pair<struct proc_exit_summary_key_t, uint64_t>> DrainSummary();
+
+  // Switches the summary mode on or off based on the exit rate of the last transfer.
+  void UpdateSummaryMode(uint64_t num_exits);
+
   // Update counters related to java process.
   void UpdateCrashedJavaProcCounters(
       uint32_t asid, const proc_exit_event_t& event,
@@ -63,6 +63,49 @@ constexpr int kExitCodeIdx = kProcExitEventsTable.ColIndex(kExitCodeColName);
 constexpr int kSignalIdx = kProcExitEventsTable.ColIndex(kSignalColName);
 constexpr int kCommIdx = kProcExitEventsTable.ColIndex(kCommColName);
 
+constexpr std::string_view kProcExitSummaryName = "proc_exit_summary";
+constexpr std::string_view kCountColName = "count";
+
+// clang-format off
+constexpr DataElement kSummaryElements[] = {
+    canonical_data_elements::kTime,
+    {canonical_data_elements::kUPIDColName,
+    "The parent of the exited processes.",
+    types::DataType::UINT128,
+    types::SemanticType::ST_UPID,
+    types::PatternType::GENERAL},
+    {kExitCodeColName,
+    "The exit code of the processes.",
+    types::DataType::INT64,
+    types::SemanticType::ST_NONE,
+    types::PatternType::GENERAL},
+    {kSignalColName,
+    "The signal received by the processes.",
+    types::DataType::INT64,
+    types::SemanticType::ST_NONE,
+    types::PatternType::GENERAL},
+    {kCountColName,
+    "The number of processes that exited since the previous record.",
+    types::DataType::INT64,
+    types::SemanticType::ST_NONE,
+    types::PatternType::GENERAL},
+};
+// clang-format on
+
+constexpr auto kProcExitSummaryTable =
+    DataTableSchema(kProcExitSummaryName,
+                    "Counts of the process exits per parent process and exit code, recorded "
+                    "instead of proc_exit_events when the exit rate is too high",
+                    kSummaryElements);
+
+constexpr int kSummaryTimeIdx =
+    kProcExitSummaryTable.ColIndex(canonical_data_elements::kTimeColName);
+constexpr int kSummaryUPIDIdx =
+    kProcExitSummaryTable.ColIndex(canonical_data_elements::kUPIDColName);
+constexpr int kSummaryExitCodeIdx = kProcExitSummaryTable.ColIndex(kExitCodeColName);
+constexpr int kSummarySignalIdx = kProcExitSummaryTable.ColIndex(kSignalColName);
+constexpr int kSummaryCountIdx = kProcExitSummaryTable.ColIndex(kCountColName);
+
 }  // namespace proc_exit_tracer
 }  // namespace stirling
 }  // namespace px
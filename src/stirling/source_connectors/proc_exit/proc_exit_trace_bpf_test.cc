@@ -18,6 +18,8 @@
 
 #include "src/stirling/source_connectors/proc_exit/proc_exit_connector.h"
 
+#include <unistd.h>
+
 #include "src/common/exec/subprocess.h"
 #include "src/common/testing/testing.h"
 #include "src/stirling/core/connector_context.h"
@@ -65,6 +67,46 @@ TEST(ProcExitConnectorTest, TransferData) {
   EXPECT_EQ(result[proc_exit_tracer::kCommIdx]->Get<types::StringValue>(0), "sleep");
 }
 
+// Tests that the exits are summarized per parent process once their rate is above the threshold.
+TEST(ProcExitConnectorTest, SummaryMode) {
+  PX_SET_FOR_SCOPE(FLAGS_stirling_proc_exit_summary_threshold, 1);
+
+  auto connector = ProcExitConnector::Create("test_proc_exit_connector");
+  ASSERT_TRUE(connector != nullptr);
+  EXPECT_OK(connector->Init());
+  StandaloneContext context({md::UPID{0, 1, 1}});
+
+  DataTables data_tables{ProcExitConnector::kTables};
+  DataTable* summary_table = data_tables.tables()[ProcExitConnector::kSummaryTableNum];
+
+  connector->set_data_tables(data_tables.tables());
+
+  const std::filesystem::path sleep_path =
+      BazelRunfilePath("src/stirling/source_connectors/proc_exit/testing/sleep");
+  auto run_and_kill = [&sleep_path](int num_procs) {
+    for (int i = 0; i < num_procs; ++i) {
+      SubProcess proc;
+      ASSERT_OK(proc.Start({sleep_path.string()}));
+      proc.Kill();
+      EXPECT_EQ(proc.Wait(), 9);
+    }
+  };
+
+  // These exits are still recorded one by one, but their rate enters the summary mode.
+  run_and_kill(5);
+  connector->TransferData(&context);
+
+  run_and_kill(3);
+  connector->TransferData(&context);
+
+  types::ColumnWrapperRecordBatch result =
+      testing::ExtractRecordsMatchingPID(summary_table, kSummaryUPIDIdx, getpid());
+  ASSERT_THAT(result, RecordBatchSizeIs(1));
+  EXPECT_EQ(result[kSummarySignalIdx]->Get<types::Int64Value>(0), 9);
+  EXPECT_EQ(result[kSummaryExitCodeIdx]->Get<types::Int64Value>(0), 0);
+  EXPECT_EQ(result[kSummaryCountIdx]->Get<types::Int64Value>(0), 3);
+}
+
 }  // namespace proc_exit_tracer
 }  // namespace stirling
 }  // namespace px
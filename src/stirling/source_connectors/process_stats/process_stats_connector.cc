@@ -57,16 +57,16 @@ void ProcessStatsConnector::TransferProcessStatsTable(ConnectorContext* ctx,
     int32_t pid = upid.pid();
     // TODO(zasgar): We should double check the process start time to make sure it still the same
     // PID.
-    auto s1 =
-        proc_parser_->ParseProcPIDStat(pid, system::Config::GetInstance().PageSizeBytes(),
-                                       system::Config::GetInstance().KernelTickTimeNS(), &stats);
+    auto s1 = proc_stats_reader_.ParseProcPIDStat(
+        pid, system::Config::GetInstance().PageSizeBytes(),
+        system::Config::GetInstance().KernelTickTimeNS(), &stats);
     if (!s1.ok()) {
       VLOG(1) << absl::Substitute(
           "Failed to fetch cpu stat info for PID ($0). Error=\"$1\" skipping.", pid, s1.msg());
       continue;
     }
 
-    auto s2 = proc_parser_->ParseProcPIDStatIO(pid, &stats);
+    auto s2 = proc_stats_reader_.ParseProcPIDStatIO(pid, &stats);
     if (!s2.ok()) {
       VLOG(1) << absl::Substitute(
           "Failed to fetch IO stat info for PID ($0). Error=\"$1\" skipping.", pid, s2.msg());
@@ -92,6 +92,9 @@ void ProcessStatsConnector::TransferProcessStatsTable(ConnectorContext* ctx,
     r.Append<r.ColIndex("read_bytes")>(stats.read_bytes);
     r.Append<r.ColIndex("write_bytes")>(stats.write_bytes);
   }
+
+  // Closes the files of the processes that have exited.
+  proc_stats_reader_.CloseUnusedFiles();
 }
 
 void ProcessStatsConnector::TransferDataImpl(ConnectorContext* ctx) {
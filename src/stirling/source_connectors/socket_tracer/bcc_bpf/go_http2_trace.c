@@ -755,6 +755,7 @@ int probe_http_http2writeResHeaders_write_frame(struct pt_regs* ctx) {
   }
 
   struct go_grpc_event_attr_t attr = {};
+  attr.timestamp_ns = bpf_ktime_get_ns();
   attr.conn_id = conn_info->conn_id;
   attr.stream_id = stream_id;
 
@@ -787,6 +788,7 @@ int probe_http_http2writeResHeaders_write_frame(struct pt_regs* ctx) {
 
   // TODO(oazizi): We are leaking BPF map entries until this line is activated,
   // which can only happen once we have return probes enabled.
+  // Until then, UProbeManager compacts the entries that were not updated for a while.
   // active_write_headers_frame_map.update(&henc_addr, &attr);
 
   return 0;
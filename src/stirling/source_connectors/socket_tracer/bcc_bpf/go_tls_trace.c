@@ -23,25 +23,17 @@
 
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf/go_trace_common.h"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf/macros.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/go_tls_types.h"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/symaddrs.h"
 
 // Key: TGID
 // Value: Symbol addresses for the binary with that TGID.
 BPF_HASH(go_tls_symaddrs_map, uint32_t, struct go_tls_symaddrs_t);
 
-struct tgid_goid_t {
-  uint32_t tgid;
-  int64_t goid;
-};
-
-struct go_tls_conn_args {
-  void* conn_ptr;
-  char* plaintext_ptr;
-};
-
 // Key is tgid + goid (goroutine id).
 // Value is a pointer to the argument to the crypto/tls.(*Conn) Write and Read functions.
 // This map is used to connect arguments to return values.
+// Entries of goroutines that never return are compacted by UProbeManager, using the timestamp.
 BPF_HASH(active_tls_conn_op_map, struct tgid_goid_t, struct go_tls_conn_args);
 
 // Probe for the crypto/tls library's write.
@@ -86,6 +78,7 @@ int probe_entry_tls_conn_write(struct pt_regs* ctx) {
   struct go_tls_conn_args args = {};
   assign_arg(&args.conn_ptr, sizeof(args.conn_ptr), symaddrs->Write_c_loc, sp, regs);
   assign_arg(&args.plaintext_ptr, sizeof(args.plaintext_ptr), symaddrs->Write_b_loc, sp, regs);
+  args.timestamp_ns = bpf_ktime_get_ns();
 
   active_tls_conn_op_map.update(&tgid_goid, &args);
 
@@ -213,6 +206,7 @@ int probe_entry_tls_conn_read(struct pt_regs* ctx) {
   struct go_tls_conn_args args = {};
   assign_arg(&args.conn_ptr, sizeof(args.conn_ptr), symaddrs->Read_c_loc, sp, regs);
   assign_arg(&args.plaintext_ptr, sizeof(args.plaintext_ptr), symaddrs->Read_b_loc, sp, regs);
+  args.timestamp_ns = bpf_ktime_get_ns();
 
   active_tls_conn_op_map.update(&tgid_goid, &args);
 
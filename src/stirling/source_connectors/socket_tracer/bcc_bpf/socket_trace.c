@@ -44,13 +44,67 @@ const int32_t kInvalidFD = -1;
 // is reported to user-space. It applies to read and write traffic combined.
 const int kConnStatsDataThreshold = 65536;
 
-// This is the perf buffer for BPF program to export data from kernel to user space.
+// These are the outputs for BPF program to export data from kernel to user space.
+// With USE_RINGBUF (kernels 5.8+), they are ring buffers shared by all CPUs, sized by the
+// RINGBUF_PAGES_<name> defines from user-space. Otherwise they are per-CPU perf buffers.
+// mmap_events is used to export notification of processes that have performed an mmap.
+// proc_events is used to export notification of processes that have exec'ed or exited.
+#if USE_RINGBUF
+BPF_RINGBUF_OUTPUT(socket_data_events, RINGBUF_PAGES_socket_data_events);
+BPF_RINGBUF_OUTPUT(socket_control_events, RINGBUF_PAGES_socket_control_events);
+BPF_RINGBUF_OUTPUT(conn_stats_events, RINGBUF_PAGES_conn_stats_events);
+BPF_RINGBUF_OUTPUT(mmap_events, RINGBUF_PAGES_mmap_events);
+BPF_RINGBUF_OUTPUT(proc_events, RINGBUF_PAGES_proc_events);
+#else
 BPF_PERF_OUTPUT(socket_data_events);
 BPF_PERF_OUTPUT(socket_control_events);
 BPF_PERF_OUTPUT(conn_stats_events);
-
-// This output is used to export notification of processes that have performed an mmap.
 BPF_PERF_OUTPUT(mmap_events);
+BPF_PERF_OUTPUT(proc_events);
+#endif
+
+// The submit functions below hide which kind of output is used.
+// A full ring buffer drops the event, which user-space doesn't get a loss callback for.
+
+static __inline void submit_socket_data_event(struct pt_regs* ctx, void* data, size_t size) {
+#if USE_RINGBUF
+  socket_data_events.ringbuf_output(data, size, 0);
+#else
+  socket_data_events.perf_submit(ctx, data, size);
+#endif
+}
+
+static __inline void submit_socket_control_event(struct pt_regs* ctx, void* data, size_t size) {
+#if USE_RINGBUF
+  socket_control_events.ringbuf_output(data, size, 0);
+#else
+  socket_control_events.perf_submit(ctx, data, size);
+#endif
+}
+
+static __inline void submit_conn_stats_event(struct pt_regs* ctx, void* data, size_t size) {
+#if USE_RINGBUF
+  conn_stats_events.ringbuf_output(data, size, 0);
+#else
+  conn_stats_events.perf_submit(ctx, data, size);
+#endif
+}
+
+static __inline void submit_mmap_event(struct pt_regs* ctx, void* data, size_t size) {
+#if USE_RINGBUF
+  mmap_events.ringbuf_output(data, size, 0);
+#else
+  mmap_events.perf_submit(ctx, data, size);
+#endif
+}
+
+static __inline void submit_proc_event(void* ctx, void* data, size_t size) {
+#if USE_RINGBUF
+  proc_events.ringbuf_output(data, size, 0);
+#else
+  proc_events.perf_submit(ctx, data, size);
+#endif
+}
 
 // This control_map is a bit-mask that controls which endpoints are traced in a connection.
 // The bits are defined in endpoint_role_t enum, kRoleClient or kRoleServer. kRoleUnknown is not
@@ -58,6 +112,20 @@ BPF_PERF_OUTPUT(mmap_events);
 // There is a control map element for each protocol.
 BPF_PERCPU_ARRAY(control_map, uint64_t, kNumProtocols);
 
+// Per-protocol connection sampling. Only one in this many connections of a protocol send their data
+// to user-space; the others still report conn stats. Values of 0 and 1 trace all connections.
+BPF_PERCPU_ARRAY(conn_sampling_map, uint32_t, kNumProtocols);
+
+// Per-protocol limit on the bytes of each message that are copied to user-space. The rest of the
+// message is only accounted for in attr.msg_size, which user-space turns into a filler event,
+// so that the byte positions of the data stream stay intact. A value of 0 means no limit.
+BPF_PERCPU_ARRAY(capture_limit_map, uint32_t, kNumProtocols);
+
+// Protocol verdicts of client connections, keyed by {upid, remote port}. Only written from
+// user-space, once it confirmed or rejected the protocol inferred for a connection. New connections
+// of the same process to the same remote port take the verdict instead of relying on inference.
+BPF_HASH(protocol_verdict_map, struct protocol_verdict_key_t, struct protocol_verdict_t, 16384);
+
 // Map from user-space file descriptors to the connections obtained from accept() syscall.
 // Tracks connection from accept() -> close().
 // Key is {tgid, fd}.
@@ -123,6 +191,26 @@ BPF_PERCPU_ARRAY(conn_stats_event_buffer_heap, struct conn_stats_event_t, 1);
 // number of arrays with only 1 element.
 BPF_PERCPU_ARRAY(control_values, int64_t, kNumControlValues);
 
+#if ENABLE_CONN_STATS_BPF_AGG
+// The conn_stats of all connections, aggregated per local process, remote endpoint and role.
+// Replaces conn_stats_events, and is read by user-space with a single batched dump per
+// conn_stats transfer. Entries are removed by user-space once their process has exited.
+BPF_HASH(conn_stats_agg_map, struct conn_stats_agg_key_t, struct conn_stats_agg_t, 65536);
+#endif
+
+#if ENABLE_SSL_COALESCING
+// The TLS data that is being coalesced, keyed by tgid_fd. See coalesce_ssl_data().
+// User-space also drains this map on every transfer, so that the data of idle connections is not
+// held back for longer than that.
+BPF_HASH(ssl_coalesce_map, uint64_t, struct ssl_coalesce_buf_t, 4096);
+BPF_PERCPU_ARRAY(ssl_coalesce_buf_heap, struct ssl_coalesce_buf_t, 1);
+#endif
+
+// The TGIDs to trace, when filtering is enabled by control_values[kTracedTGIDsFilterIndex].
+// Populated by user-space from the K8s metadata, to avoid sending the data of the processes that
+// are not of interest.
+BPF_HASH(traced_tgids_map, uint32_t, uint8_t, 65536);
+
 /***********************************************************
  * General helper functions
  ***********************************************************/
@@ -238,6 +326,55 @@ static __inline struct conn_stats_event_t* fill_conn_stats_event(
   return event;
 }
 
+#if ENABLE_CONN_STATS_BPF_AGG
+// Adds the activity of a connection to its conn_stats_agg_map entry.
+// A connection is counted once its role and remote endpoint are known. At that point it is counted
+// as opened, along with all the bytes it has transferred so far.
+static __inline void aggregate_conn_stats(struct conn_info_t* conn_info, int64_t bytes_sent,
+                                          int64_t bytes_recv, bool close) {
+  sa_family_t family = conn_info->raddr.sa.sa_family;
+  if (conn_info->role == kRoleUnknown || !(family == AF_INET || family == AF_INET6)) {
+    return;
+  }
+
+  struct conn_stats_agg_key_t key;
+  // Zero the padding too, because the whole key is hashed.
+  __builtin_memset(&key, 0, sizeof(key));
+  key.upid.tgid = conn_info->conn_id.upid.tgid;
+  key.upid.start_time_ticks = conn_info->conn_id.upid.start_time_ticks;
+  key.raddr = conn_info->raddr;
+  key.role = conn_info->role;
+  if (key.role == kRoleServer) {
+    // sin_port and sin6_port are at the same offset.
+    key.raddr.in6.sin6_port = 0;
+  }
+
+  struct conn_stats_agg_t zero = {};
+  struct conn_stats_agg_t* stats = conn_stats_agg_map.lookup_or_init(&key, &zero);
+  if (stats == NULL) {
+    return;
+  }
+
+  if (!conn_info->conn_stats_aggregated) {
+    conn_info->conn_stats_aggregated = true;
+    lock_xadd(&stats->conn_open, 1);
+    bytes_sent = conn_info->wr_bytes;
+    bytes_recv = conn_info->rd_bytes;
+  }
+  if (bytes_sent != 0) {
+    lock_xadd(&stats->bytes_sent, bytes_sent);
+  }
+  if (bytes_recv != 0) {
+    lock_xadd(&stats->bytes_recv, bytes_recv);
+  }
+  if (close) {
+    lock_xadd(&stats->conn_close, 1);
+  }
+  stats->protocol = conn_info->protocol;
+  stats->ssl = conn_info->ssl;
+}
+#endif
+
 /***********************************************************
  * Trace filtering functions
  ***********************************************************/
@@ -268,6 +405,27 @@ static __inline bool should_trace_protocol_data(const struct conn_info_t* conn_i
   return control & conn_info->role;
 }
 
+static __inline bool is_sampled_conn(const struct conn_info_t* conn_info) {
+  uint32_t protocol = conn_info->protocol;
+  uint32_t* sampling_ratio = conn_sampling_map.lookup(&protocol);
+  if (sampling_ratio == NULL || *sampling_ratio <= 1) {
+    return true;
+  }
+  // The TSID is the creation time of the connection, so it gives a stable decision for the
+  // lifetime of the connection, and a roughly uniform one across connections.
+  return conn_info->conn_id.tsid % *sampling_ratio == 0;
+}
+
+// Returns how many bytes of a message of the given size are copied to user-space.
+static __inline size_t get_capture_size(const struct conn_info_t* conn_info, size_t msg_size) {
+  uint32_t protocol = conn_info->protocol;
+  uint32_t* capture_limit = capture_limit_map.lookup(&protocol);
+  if (capture_limit == NULL || *capture_limit == 0) {
+    return msg_size;
+  }
+  return min_size_t(*capture_limit, msg_size);
+}
+
 static __inline bool is_stirling_tgid(const uint32_t tgid) {
   int idx = kStirlingTGIDIndex;
   int64_t* stirling_tgid = control_values.lookup(&idx);
@@ -284,17 +442,27 @@ enum target_tgid_match_result_t {
   TARGET_TGID_UNMATCHED,
 };
 
+// Returns true if the TGID filter is enabled, and the TGID is not in it.
+static __inline bool is_filtered_out_tgid(uint32_t tgid) {
+  int idx = kTracedTGIDsFilterIndex;
+  int64_t* filter_enabled = control_values.lookup(&idx);
+  if (filter_enabled == NULL || *filter_enabled == 0) {
+    return false;
+  }
+  return traced_tgids_map.lookup(&tgid) == NULL;
+}
+
 static __inline enum target_tgid_match_result_t match_trace_tgid(const uint32_t tgid) {
   // TODO(yzhao): Use externally-defined macro to replace BPF_MAP. Since this function is called for
   // all PIDs, this optimization is useful.
   int idx = kTargetTGIDIndex;
   int64_t* target_tgid = control_values.lookup(&idx);
   if (target_tgid == NULL) {
-    return TARGET_TGID_UNSPECIFIED;
+    return is_filtered_out_tgid(tgid) ? TARGET_TGID_UNMATCHED : TARGET_TGID_UNSPECIFIED;
   }
   if (*target_tgid < 0) {
-    // Negative value means trace all.
-    return TARGET_TGID_ALL;
+    // Negative value means trace all, subject to the TGID filter.
+    return is_filtered_out_tgid(tgid) ? TARGET_TGID_UNMATCHED : TARGET_TGID_ALL;
   }
   if (*target_tgid == tgid) {
     return TARGET_TGID_MATCHED;
@@ -302,14 +470,50 @@ static __inline enum target_tgid_match_result_t match_trace_tgid(const uint32_t
   return TARGET_TGID_UNMATCHED;
 }
 
+// Applies the protocol verdict that user-space reached for earlier connections of the same process
+// to the same remote port, if there is one.
+static __inline void apply_protocol_verdict(struct conn_info_t* conn_info) {
+  struct protocol_verdict_key_t key = {};
+  key.start_time_ticks = conn_info->conn_id.upid.start_time_ticks;
+  key.tgid = conn_info->conn_id.upid.tgid;
+  if (conn_info->raddr.sa.sa_family == AF_INET) {
+    key.remote_port = conn_info->raddr.in4.sin_port;
+  } else if (conn_info->raddr.sa.sa_family == AF_INET6) {
+    key.remote_port = conn_info->raddr.in6.sin6_port;
+  } else {
+    return;
+  }
+
+  struct protocol_verdict_t* verdict = protocol_verdict_map.lookup(&key);
+  if (verdict == NULL) {
+    return;
+  }
+
+  if (verdict->protocol == kProtocolUnknown) {
+    conn_info->protocol_inference_disabled = true;
+    return;
+  }
+
+  conn_info->protocol = verdict->protocol;
+  conn_info->role = verdict->role;
+}
+
 static __inline void update_traffic_class(struct conn_info_t* conn_info,
                                           enum traffic_direction_t direction, const char* buf,
                                           size_t count) {
   if (conn_info == NULL) {
     return;
   }
+
+  if (conn_info->protocol_total_count == 0) {
+    apply_protocol_verdict(conn_info);
+  }
   conn_info->protocol_total_count += 1;
 
+  if (conn_info->protocol_inference_disabled) {
+    return;
+  }
+
   // Try to infer connection type (protocol) based on data.
   struct protocol_message_t inferred_protocol = infer_protocol(buf, count, conn_info);
 
@@ -387,6 +591,9 @@ static __inline void submit_new_conn(struct pt_regs* ctx, uint32_t tgid, int32_t
     conn_info.raddr = *((union sockaddr_t*)addr);
   }
   conn_info.role = role;
+#if ENABLE_CONN_STATS_BPF_AGG
+  aggregate_conn_stats(&conn_info, 0, 0, /*close*/ false);
+#endif
 
   uint64_t tgid_fd = gen_tgid_fd(tgid, fd);
   conn_info_map.update(&tgid_fd, &conn_info);
@@ -407,7 +614,7 @@ static __inline void submit_new_conn(struct pt_regs* ctx, uint32_t tgid, int32_t
   control_event.open.laddr = conn_info.laddr;
   control_event.open.role = conn_info.role;
 
-  socket_control_events.perf_submit(ctx, &control_event, sizeof(struct socket_control_event_t));
+  submit_socket_control_event(ctx, &control_event, sizeof(struct socket_control_event_t));
 }
 
 static __inline void submit_close_event(struct pt_regs* ctx, struct conn_info_t* conn_info,
@@ -420,19 +627,30 @@ static __inline void submit_close_event(struct pt_regs* ctx, struct conn_info_t*
   control_event.close.rd_bytes = conn_info->rd_bytes;
   control_event.close.wr_bytes = conn_info->wr_bytes;
 
-  socket_control_events.perf_submit(ctx, &control_event, sizeof(struct socket_control_event_t));
+  submit_socket_control_event(ctx, &control_event, sizeof(struct socket_control_event_t));
 }
 
 // Writes the input buf to event, and submits the event to the corresponding perf buffer.
 // Returns the bytes output from the input buf. Note that is not the total bytes submitted to the
 // perf buffer, which includes additional metadata.
+// Only the first capture_size bytes of buf are copied; see capture_limit_map.
 static __inline void perf_submit_buf(struct pt_regs* ctx, const enum traffic_direction_t direction,
-                                     const char* buf, size_t buf_size,
+                                     const char* buf, size_t buf_size, size_t capture_size,
                                      struct conn_info_t* conn_info,
                                      struct socket_data_event_t* event) {
   // Record original size of packet. This may get truncated below before submit.
   event->attr.msg_size = buf_size;
 
+  if (buf_size > capture_size) {
+    buf_size = capture_size;
+    if (buf_size == 0) {
+      // Nothing left to copy, but user-space still needs the size to account for the bytes.
+      event->attr.msg_buf_size = 0;
+      submit_socket_data_event(ctx, event, sizeof(event->attr));
+      return;
+    }
+  }
+
   // This rest of this function has been written carefully to keep the BPF verifier happy in older
   // kernels, so please take care when modifying.
   //
@@ -493,13 +711,14 @@ static __inline void perf_submit_buf(struct pt_regs* ctx, const enum traffic_dir
   // If-statement is redundant, but is required to keep the 4.14 verifier happy.
   if (amount_copied > 0) {
     event->attr.msg_buf_size = amount_copied;
-    socket_data_events.perf_submit(ctx, event, sizeof(event->attr) + amount_copied);
+    submit_socket_data_event(ctx, event, sizeof(event->attr) + amount_copied);
   }
 }
 
 static __inline void perf_submit_wrapper(struct pt_regs* ctx,
                                          const enum traffic_direction_t direction, const char* buf,
-                                         const size_t buf_size, struct conn_info_t* conn_info,
+                                         const size_t buf_size, size_t capture_size,
+                                         struct conn_info_t* conn_info,
                                          struct socket_data_event_t* event) {
   int bytes_sent = 0;
   unsigned int i;
@@ -509,8 +728,11 @@ static __inline void perf_submit_wrapper(struct pt_regs* ctx,
     const int bytes_remaining = buf_size - bytes_sent;
     const size_t current_size =
         (bytes_remaining > MAX_MSG_SIZE && (i != CHUNK_LIMIT - 1)) ? MAX_MSG_SIZE : bytes_remaining;
-    perf_submit_buf(ctx, direction, buf + bytes_sent, current_size, conn_info, event);
+    const size_t current_capture_size = min_size_t(current_size, capture_size);
+    perf_submit_buf(ctx, direction, buf + bytes_sent, current_size, current_capture_size, conn_info,
+                    event);
     bytes_sent += current_size;
+    capture_size -= current_capture_size;
 
     // Move the position for the next event.
     event->attr.pos += current_size;
@@ -520,7 +742,8 @@ static __inline void perf_submit_wrapper(struct pt_regs* ctx,
 static __inline void perf_submit_iovecs(struct pt_regs* ctx,
                                         const enum traffic_direction_t direction,
                                         const struct iovec* iov, const size_t iovlen,
-                                        const size_t total_size, struct conn_info_t* conn_info,
+                                        const size_t total_size, size_t capture_size,
+                                        struct conn_info_t* conn_info,
                                         struct socket_data_event_t* event) {
   // NOTE: The syscalls for scatter buffers, {send,recv}msg()/{write,read}v(), access buffers in
   // array order. That means they read or fill iov[0], then iov[1], and so on. They return the total
@@ -537,8 +760,11 @@ static __inline void perf_submit_iovecs(struct pt_regs* ctx,
 
     // TODO(oazizi/yzhao): Should switch this to go through perf_submit_wrapper.
     //                     We don't have the BPF instruction count to do so right now.
-    perf_submit_buf(ctx, direction, iov_cpy.iov_base, iov_size, conn_info, event);
+    const size_t iov_capture_size = min_size_t(iov_size, capture_size);
+    perf_submit_buf(ctx, direction, iov_cpy.iov_base, iov_size, iov_capture_size, conn_info,
+                    event);
     bytes_sent += iov_size;
+    capture_size -= iov_capture_size;
 
     // Move the position for the next event.
     event->attr.pos += iov_size;
@@ -548,6 +774,85 @@ static __inline void perf_submit_iovecs(struct pt_regs* ctx,
   //               with a data-less event.
 }
 
+#if ENABLE_SSL_COALESCING
+static __inline void flush_ssl_coalesce_buf(struct pt_regs* ctx, struct ssl_coalesce_buf_t* buf) {
+  size_t size = buf->attr.msg_buf_size;
+  if (size > 0 && size <= SSL_COALESCE_BUF_SIZE) {
+    submit_socket_data_event(ctx, buf, sizeof(buf->attr) + size);
+  }
+  buf->attr.msg_size = 0;
+  buf->attr.msg_buf_size = 0;
+}
+
+static __inline void close_ssl_coalesce_buf(struct pt_regs* ctx, uint64_t tgid_fd) {
+  struct ssl_coalesce_buf_t* buf = ssl_coalesce_map.lookup(&tgid_fd);
+  if (buf != NULL) {
+    flush_ssl_coalesce_buf(ctx, buf);
+    ssl_coalesce_map.delete(&tgid_fd);
+  }
+}
+
+// TLS libraries are often called with small records, so the data of consecutive calls in the same
+// direction of a connection is coalesced into a single event. The event is submitted when the
+// direction changes, when it is full, or when the connection is closed.
+// Returns true if the data was coalesced; otherwise, the caller submits it as usual, after any
+// previously coalesced data.
+static __inline bool coalesce_ssl_data(struct pt_regs* ctx, uint64_t tgid_fd,
+                                       const struct socket_data_event_t* event, const char* buf,
+                                       size_t buf_size, size_t capture_size) {
+  struct ssl_coalesce_buf_t* pending = ssl_coalesce_map.lookup(&tgid_fd);
+  if (pending != NULL && pending->attr.msg_buf_size > 0 &&
+      (pending->attr.direction != event->attr.direction ||
+       pending->attr.pos + pending->attr.msg_size != event->attr.pos ||
+       pending->attr.msg_buf_size + buf_size > SSL_COALESCE_BUF_SIZE)) {
+    flush_ssl_coalesce_buf(ctx, pending);
+  }
+
+  // Truncated data keeps its own event, which records the original size.
+  if (buf_size == 0 || buf_size > SSL_COALESCE_BUF_SIZE || capture_size < buf_size) {
+    return false;
+  }
+
+  if (pending == NULL) {
+    uint32_t kZero = 0;
+    struct ssl_coalesce_buf_t* empty = ssl_coalesce_buf_heap.lookup(&kZero);
+    if (empty == NULL) {
+      return false;
+    }
+    empty->attr.msg_size = 0;
+    empty->attr.msg_buf_size = 0;
+    ssl_coalesce_map.update(&tgid_fd, empty);
+    pending = ssl_coalesce_map.lookup(&tgid_fd);
+    if (pending == NULL) {
+      // The map is full.
+      return false;
+    }
+  }
+
+  if (pending->attr.msg_buf_size == 0) {
+    // The coalesced event keeps the attributes of its first data, including its timestamp.
+    pending->attr = event->attr;
+  }
+
+  // The flush above guarantees that offset + buf_size <= SSL_COALESCE_BUF_SIZE. The masks only
+  // make the bounds explicit to the verifier.
+  size_t offset = pending->attr.msg_buf_size & (SSL_COALESCE_BUF_SIZE - 1);
+  size_t size = buf_size & (2 * SSL_COALESCE_BUF_SIZE - 1);
+  if (size > 0 && size <= SSL_COALESCE_BUF_SIZE) {
+    bpf_probe_read(&pending->msg[offset], size, buf);
+  }
+  pending->attr.msg_size += buf_size;
+  pending->attr.msg_buf_size += buf_size;
+  pending->attr.protocol = event->attr.protocol;
+  pending->attr.role = event->attr.role;
+
+  if (pending->attr.msg_buf_size == SSL_COALESCE_BUF_SIZE) {
+    flush_ssl_coalesce_buf(ctx, pending);
+  }
+  return true;
+}
+#endif
+
 /***********************************************************
  * Map cleanup functions
  ***********************************************************/
@@ -705,8 +1010,9 @@ static __inline bool should_send_data(uint32_t tgid, uint64_t conn_disabled_tsid
     return false;
   }
 
-  // Only trace data for protocols of interest, or if forced on.
-  return (force_trace_tgid || should_trace_protocol_data(conn_info));
+  // Only trace data for protocols of interest on sampled connections, or if forced on.
+  return force_trace_tgid ||
+         (should_trace_protocol_data(conn_info) && is_sampled_conn(conn_info));
 }
 
 static __inline void update_conn_stats(struct pt_regs* ctx, struct conn_info_t* conn_info,
@@ -721,6 +1027,12 @@ static __inline void update_conn_stats(struct pt_regs* ctx, struct conn_info_t*
       break;
   }
 
+#if ENABLE_CONN_STATS_BPF_AGG
+  aggregate_conn_stats(conn_info, direction == kEgress ? bytes_count : 0,
+                       direction == kIngress ? bytes_count : 0, /*close*/ false);
+  return;
+#endif
+
   // Only send event if there's been enough of a change.
   // TODO(oazizi): Add elapsed time since last send as a triggering condition too.
   uint64_t total_bytes = conn_info->wr_bytes + conn_info->rd_bytes;
@@ -729,7 +1041,7 @@ static __inline void update_conn_stats(struct pt_regs* ctx, struct conn_info_t*
   if (meets_activity_threshold) {
     struct conn_stats_event_t* event = fill_conn_stats_event(conn_info);
     if (event != NULL) {
-      conn_stats_events.perf_submit(ctx, event, sizeof(struct conn_stats_event_t));
+      submit_conn_stats_event(ctx, event, sizeof(struct conn_stats_event_t));
     }
 
     conn_info->last_reported_bytes = conn_info->rd_bytes + conn_info->wr_bytes;
@@ -809,14 +1121,25 @@ static __inline void process_data(const bool vecs, struct pt_regs* ctx, uint64_t
         return;
       }
 
+      const size_t capture_size = get_capture_size(conn_info, bytes_count);
+
+      bool coalesced = false;
+#if ENABLE_SSL_COALESCING
+      coalesced = ssl && !vecs &&
+                  coalesce_ssl_data(ctx, tgid_fd, event, args->buf, bytes_count, capture_size);
+#endif
+
       // TODO(yzhao): Same TODO for split the interface.
-      if (!vecs) {
-        perf_submit_wrapper(ctx, direction, args->buf, bytes_count, conn_info, event);
+      if (coalesced) {
+        // The data is submitted later, together with the data that follows it.
+      } else if (!vecs) {
+        perf_submit_wrapper(ctx, direction, args->buf, bytes_count, capture_size, conn_info, event);
       } else {
         // TODO(yzhao): iov[0] is copied twice, once in calling update_traffic_class(), and here.
         // This happens to the write probes as well, but the calls are placed in the entry and
         // return probes respectively. Consider remove one copy.
-        perf_submit_iovecs(ctx, direction, args->iov, args->iovlen, bytes_count, conn_info, event);
+        perf_submit_iovecs(ctx, direction, args->iov, args->iovlen, bytes_count, capture_size,
+                           conn_info, event);
       }
     }
   }
@@ -899,7 +1222,7 @@ static __inline void process_syscall_sendfile(struct pt_regs* ctx, uint64_t id,
     event->attr.pos = conn_info->wr_bytes;
     event->attr.msg_size = bytes_count;
     event->attr.msg_buf_size = 0;
-    socket_data_events.perf_submit(ctx, event, sizeof(event->attr));
+    submit_socket_data_event(ctx, event, sizeof(event->attr));
   }
 
   update_conn_stats(ctx, conn_info, kEgress, bytes_count);
@@ -935,14 +1258,21 @@ static __inline void process_syscall_close(struct pt_regs* ctx, uint64_t id,
   // This is to avoid polluting the perf buffer.
   if (should_trace_sockaddr_family(conn_info->raddr.sa.sa_family) || conn_info->wr_bytes != 0 ||
       conn_info->rd_bytes != 0) {
+#if ENABLE_SSL_COALESCING
+    close_ssl_coalesce_buf(ctx, tgid_fd);
+#endif
     submit_close_event(ctx, conn_info, kSyscallClose);
 
+#if ENABLE_CONN_STATS_BPF_AGG
+    aggregate_conn_stats(conn_info, 0, 0, /*close*/ true);
+#else
     // Report final conn stats event for this connection.
     struct conn_stats_event_t* event = fill_conn_stats_event(conn_info);
     if (event != NULL) {
       event->conn_events = event->conn_events | CONN_CLOSE;
-      conn_stats_events.perf_submit(ctx, event, sizeof(struct conn_stats_event_t));
+      submit_conn_stats_event(ctx, event, sizeof(struct conn_stats_event_t));
     }
+#endif
   }
 
   conn_info_map.delete(&tgid_fd);
@@ -1610,7 +1940,40 @@ int syscall__probe_entry_mmap(struct pt_regs* ctx) {
   upid.tgid = id >> 32;
   upid.start_time_ticks = get_tgid_start_time();
 
-  mmap_events.perf_submit(ctx, &upid, sizeof(upid));
+  submit_mmap_event(ctx, &upid, sizeof(upid));
+
+  return 0;
+}
+
+// Fires after a successful exec, in the context of the process, which by then is its own thread
+// group leader.
+TRACEPOINT_PROBE(sched, sched_process_exec) {
+  uint64_t id = bpf_get_current_pid_tgid();
+  struct proc_event_t event = {};
+  event.type = kProcExec;
+  event.upid.tgid = id >> 32;
+  event.upid.start_time_ticks = get_tgid_start_time();
+
+  submit_proc_event(args, &event, sizeof(event));
+
+  return 0;
+}
+
+// Fires for every exiting thread; only the exit of the thread group leader ends the process.
+TRACEPOINT_PROBE(sched, sched_process_exit) {
+  uint64_t id = bpf_get_current_pid_tgid();
+  uint32_t tgid = id >> 32;
+  uint32_t tid = id;
+  if (tgid != tid) {
+    return 0;
+  }
+
+  struct proc_event_t event = {};
+  event.type = kProcExit;
+  event.upid.tgid = tgid;
+  event.upid.start_time_ticks = get_tgid_start_time();
+
+  submit_proc_event(args, &event, sizeof(event));
 
   return 0;
 }
@@ -89,6 +89,8 @@ enum control_value_index_t {
   // * Support efficient lookup inside bpf to minimize overhead.
   kTargetTGIDIndex = 0,
   kStirlingTGIDIndex,
+  // When non-zero, only the TGIDs in traced_tgids_map are traced.
+  kTracedTGIDsFilterIndex,
   kNumControlValues,
 };
 
@@ -0,0 +1,37 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+#include <cstdint>
+#endif
+
+// Key of the BPF maps that stash state between the entry and return probes of a goroutine.
+struct tgid_goid_t {
+  uint32_t tgid;
+  int64_t goid;
+};
+
+struct go_tls_conn_args {
+  void* conn_ptr;
+  char* plaintext_ptr;
+  // When the entry probe stashed the arguments, from bpf_ktime_get_ns().
+  // Lets user space find entries whose return probe never fired.
+  uint64_t timestamp_ns;
+};
@@ -28,6 +28,8 @@
 
 const char kControlMapName[] = "control_map";
 const char kControlValuesArrayName[] = "control_values";
+const char kConnSamplingMapName[] = "conn_sampling_map";
+const char kCaptureLimitMapName[] = "capture_limit_map";
 
 const int64_t kTraceAllTGIDs = -1;
 
@@ -89,6 +91,14 @@ struct conn_info_t {
   size_t prev_count;
   char prev_buf[4];
   bool prepend_length_header;
+
+  // Set when user-space rejected the protocol inferred for earlier connections of this process to
+  // the same remote port. Protocol inference is skipped, so the connection's data is never traced.
+  bool protocol_inference_disabled;
+
+  // Set once the connection has been counted as opened in conn_stats_agg_map.
+  // Only used with ENABLE_CONN_STATS_BPF_AGG.
+  bool conn_stats_aggregated;
 };
 
 // This struct is a subset of conn_info_t. It is used to communicate connect/accept events.
@@ -99,6 +109,23 @@ struct conn_event_t {
   enum endpoint_role_t role;
 };
 
+// Key of protocol_verdict_map. Client connections of a process to the same remote port are
+// expected to carry the same protocol.
+struct protocol_verdict_key_t {
+  uint64_t start_time_ticks;
+  uint32_t tgid;
+  // The remote port, in network byte order (as in conn_info_t::raddr).
+  uint32_t remote_port;
+};
+
+// Value of protocol_verdict_map, written by user-space after it checked the protocol inferred for
+// a connection against the records it produced.
+struct protocol_verdict_t {
+  // The confirmed protocol, or kProtocolUnknown if the inferred protocol was a false positive.
+  enum traffic_protocol_t protocol;
+  enum endpoint_role_t role;
+};
+
 // This struct is a subset of conn_info_t. It is used to communicate close events.
 // See conn_info_t for descriptions of the members.
 struct close_event_t {
@@ -216,6 +243,18 @@ struct socket_data_event_t {
   char msg[MAX_MSG_SIZE];
 };
 
+// Consecutive TLS data in the same direction of a connection is coalesced up to this size before
+// being submitted. Must be a power of 2.
+#define SSL_COALESCE_BUF_SIZE 4096
+
+// The TLS data that is being coalesced on a connection. It is submitted as a socket_data_event_t,
+// so it has the same layout, with a smaller msg. Only the first half of msg is used, the second
+// half lets the BPF verifier prove that any append at an offset in the first half is in bounds.
+struct ssl_coalesce_buf_t {
+  __typeof__(((struct socket_data_event_t*)0)->attr) attr;
+  char msg[2 * SSL_COALESCE_BUF_SIZE];
+};
+
 #define CONN_OPEN (1 << 0)
 #define CONN_CLOSE (1 << 1)
 
@@ -242,6 +281,27 @@ struct conn_stats_event_t {
   uint32_t conn_events;
 };
 
+// Key of conn_stats_agg_map, which aggregates conn_stats in BPF instead of conn_stats_event_t.
+// It matches ConnStats::AggKey: one entry per local process, remote endpoint and role.
+struct conn_stats_agg_key_t {
+  struct upid_t upid;
+  // The port is 0 for server-side connections, to collapse the connections of a client.
+  union sockaddr_t raddr;
+  enum endpoint_role_t role;
+};
+
+// Value of conn_stats_agg_map. The counters are cumulative since the entry was created.
+struct conn_stats_agg_t {
+  int64_t conn_open;
+  int64_t conn_close;
+  int64_t bytes_sent;
+  int64_t bytes_recv;
+
+  // Of the most recently updated connection.
+  enum traffic_protocol_t protocol;
+  bool ssl;
+};
+
 enum control_event_type_t {
   kConnOpen,
   kConnClose,
@@ -261,6 +321,18 @@ struct socket_control_event_t {
   };
 };
 
+enum proc_event_type_t {
+  kProcExec,
+  kProcExit,
+};
+
+// Notifies user-space of a process that exec'ed or exited, so it can find processes to attach
+// uprobes to, and clean up after, without rescanning /proc.
+struct proc_event_t {
+  enum proc_event_type_t type;
+  struct upid_t upid;
+};
+
 struct connect_args_t {
   const struct sockaddr* addr;
   int32_t fd;
@@ -83,5 +83,56 @@ absl::flat_hash_map<ConnStats::AggKey, ConnStats::Stats>& ConnStats::UpdateStats
   return agg_stats_;
 }
 
+absl::flat_hash_map<ConnStats::AggKey, ConnStats::Stats>& ConnStats::UpdateStats(
+    const std::vector<std::pair<conn_stats_agg_key_t, conn_stats_agg_t>>& bpf_agg_stats) {
+  ++update_counter_;
+
+  // Different BPF keys can map to the same AggKey, e.g. with different bytes in the unused parts
+  // of the sockaddr, so their counters are summed before being compared to the current values.
+  absl::flat_hash_map<AggKey, Stats> totals;
+  for (const auto& [bpf_key, bpf_stats] : bpf_agg_stats) {
+    SockAddr remote_endpoint;
+    PopulateSockAddr(&bpf_key.raddr.sa, &remote_endpoint);
+    if (!(remote_endpoint.family == SockAddrFamily::kIPv4 ||
+          remote_endpoint.family == SockAddrFamily::kIPv6) ||
+        bpf_key.role == kRoleUnknown) {
+      continue;
+    }
+
+    auto& total = totals[BuildAggKey(bpf_key.upid, bpf_key.role, remote_endpoint)];
+    total.addr_family = remote_endpoint.family;
+    total.role = bpf_key.role;
+    total.protocol = bpf_stats.protocol;
+    total.ssl = bpf_stats.ssl;
+    total.conn_open += bpf_stats.conn_open;
+    total.conn_close += bpf_stats.conn_close;
+    total.bytes_sent += bpf_stats.bytes_sent;
+    total.bytes_recv += bpf_stats.bytes_recv;
+  }
+
+  for (const auto& [key, total] : totals) {
+    auto& stats = agg_stats_[key];
+    const bool changed = stats.conn_open != total.conn_open ||
+                         stats.conn_close != total.conn_close ||
+                         stats.bytes_sent != total.bytes_sent ||
+                         stats.bytes_recv != total.bytes_recv;
+
+    stats.addr_family = total.addr_family;
+    stats.role = total.role;
+    stats.protocol = total.protocol;
+    stats.ssl = total.ssl;
+    stats.conn_open = total.conn_open;
+    stats.conn_close = total.conn_close;
+    stats.bytes_sent = total.bytes_sent;
+    stats.bytes_recv = total.bytes_recv;
+
+    if (changed) {
+      stats.last_update = update_counter_;
+    }
+  }
+
+  return agg_stats_;
+}
+
 }  // namespace stirling
 }  // namespace px
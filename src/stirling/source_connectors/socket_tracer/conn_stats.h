@@ -20,6 +20,7 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
@@ -102,6 +103,14 @@ class ConnStats {
    */
   absl::flat_hash_map<AggKey, Stats>& UpdateStats();
 
+  /**
+   * Same as above, but with the stats that were aggregated in BPF (see conn_stats_agg_map in
+   * socket_trace.c), instead of the trackers. The BPF counters are cumulative, so they replace
+   * the current values of the stats.
+   */
+  absl::flat_hash_map<AggKey, Stats>& UpdateStats(
+      const std::vector<std::pair<conn_stats_agg_key_t, conn_stats_agg_t>>& bpf_agg_stats);
+
   bool Active(const Stats& stats) { return update_counter_ == stats.last_update; }
 
  private:
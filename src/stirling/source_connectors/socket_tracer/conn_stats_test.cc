@@ -396,5 +396,58 @@ TEST_F(ConnStatsTest, DisabledConnTracker) {
               ElementsAre(Pair(AggKeyIs(11111, "1.1.1.1", 80), StatsIs(1, 1, 200, 100))));
 }
 
+// Tests that the stats aggregated in BPF replace the current values, and that only the changed
+// stats are marked as active.
+TEST_F(ConnStatsTest, BPFAggregatedStats) {
+  struct conn_stats_agg_key_t client_key = {};
+  client_key.upid = {.pid = 11111, .start_time_ticks = 1000};
+  client_key.role = kRoleClient;
+  client_key.raddr.in4.sin_family = AF_INET;
+  client_key.raddr.in4.sin_port = htons(80);
+  client_key.raddr.in4.sin_addr.s_addr = 0x01010101;  // 1.1.1.1
+
+  struct conn_stats_agg_key_t server_key = {};
+  server_key.upid = {.pid = 22222, .start_time_ticks = 1000};
+  server_key.role = kRoleServer;
+  server_key.raddr.in4.sin_family = AF_INET;
+  server_key.raddr.in4.sin_port = 0;
+  server_key.raddr.in4.sin_addr.s_addr = 0x02020202;  // 2.2.2.2
+
+  // A key with an unknown remote endpoint is ignored.
+  struct conn_stats_agg_key_t unknown_key = {};
+  unknown_key.upid = {.pid = 33333, .start_time_ticks = 1000};
+  unknown_key.role = kRoleClient;
+
+  struct conn_stats_agg_t client_stats = {};
+  client_stats.conn_open = 1;
+  client_stats.bytes_sent = 200;
+  client_stats.bytes_recv = 100;
+  client_stats.protocol = kProtocolHTTP;
+
+  struct conn_stats_agg_t server_stats = {};
+  server_stats.conn_open = 2;
+  server_stats.conn_close = 1;
+  server_stats.bytes_sent = 20;
+  server_stats.bytes_recv = 10;
+
+  auto& agg_stats = conn_stats_.UpdateStats(
+      {{client_key, client_stats}, {server_key, server_stats}, {unknown_key, client_stats}});
+  EXPECT_THAT(agg_stats,
+              UnorderedElementsAre(Pair(AggKeyIs(11111, "1.1.1.1", 80), StatsIs(1, 0, 200, 100)),
+                                   Pair(AggKeyIs(22222, "2.2.2.2", 0), StatsIs(2, 1, 20, 10))));
+  for (const auto& [key, stats] : agg_stats) {
+    EXPECT_TRUE(conn_stats_.Active(stats)) << key.ToString();
+  }
+
+  client_stats.conn_close = 1;
+  client_stats.bytes_recv = 150;
+  EXPECT_THAT(conn_stats_.UpdateStats({{client_key, client_stats}, {server_key, server_stats}}),
+              UnorderedElementsAre(Pair(AggKeyIs(11111, "1.1.1.1", 80), StatsIs(1, 1, 200, 150)),
+                                   Pair(AggKeyIs(22222, "2.2.2.2", 0), StatsIs(2, 1, 20, 10))));
+  for (const auto& [key, stats] : agg_stats) {
+    EXPECT_EQ(conn_stats_.Active(stats), key.upid.tgid == 11111) << key.ToString();
+  }
+}
+
 }  // namespace stirling
 }  // namespace px
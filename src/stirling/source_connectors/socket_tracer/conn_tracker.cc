@@ -52,6 +52,10 @@ DEFINE_int64(stirling_conn_trace_fd, kUnsetPIDFD, "Trace activity on this fd.");
 DEFINE_bool(
     stirling_conn_disable_to_bpf, true,
     "Send information about connection tracking disablement to BPF, so it can stop sending data.");
+DEFINE_bool(stirling_conn_protocol_verdict_to_bpf, true,
+            "Send the confirmed or rejected protocols of client connections to BPF, so that new "
+            "connections of the same process to the same remote port skip protocol inference, "
+            "or are not traced at all if the protocol was rejected.");
 DEFINE_int64(
     stirling_check_proc_for_conn_close, true,
     "If enabled, Stirling will check Linux /proc on idle connections to see if they are closed.");
@@ -69,6 +73,9 @@ using ::px::system::ProcPidPath;
 constexpr double kParseFailureRateThreshold = 0.4;
 constexpr double kStitchFailureRateThreshold = 0.5;
 
+// Number of valid records after which the protocol of a connection is considered confirmed.
+constexpr int kProtocolConfirmationRecords = 10;
+
 //--------------------------------------------------------------
 // ConnTracker
 //--------------------------------------------------------------
@@ -317,7 +324,7 @@ void ConnTracker::AddHTTP2Header(std::unique_ptr<HTTP2HeaderEvent> hdr) {
     return;
   }
 
-  half_stream_ptr->AddHeader(std::string(hdr->name), std::string(hdr->value));
+  half_stream_ptr->AddHeader(hdr->name, hdr->value);
   half_stream_ptr->UpdateTimestamp(hdr->attr.timestamp_ns);
 }
 
@@ -612,6 +619,9 @@ void ConnTracker::MarkForDeath(int32_t countdown) {
 
   if (death_countdown_ == -1) {
     CONN_TRACE(2) << absl::Substitute("Marked for death, countdown=$0", countdown);
+    if (manager_ != nullptr) {
+      manager_->ScheduleDestructionCheck(this, countdown);
+    }
   }
 
   // We received the close event.
@@ -795,8 +805,14 @@ void ConnTracker::IterationPreTick(
     return;
   }
 
-  // If remote_addr is missing, it means the connect/accept syscall was not traced.
-  // Attempt to infer the connection information, to populate remote_addr and local_addr.
+  // If remote_addr is missing, the conn_open event was lost, or the connect/accept syscall was not
+  // traced. BPF may still know the endpoints of the former, which is far cheaper than inference.
+  if (open_info_.remote_addr.family == SockAddrFamily::kUnspecified && !bpf_conn_info_checked_) {
+    RecoverConnInfoFromBPF();
+  }
+
+  // Otherwise, attempt to infer the connection information, to populate remote_addr and
+  // local_addr.
   if (open_info_.remote_addr.family == SockAddrFamily::kUnspecified && socket_info_mgr != nullptr) {
     InferConnInfo(proc_parser, socket_info_mgr);
 
@@ -834,16 +850,44 @@ void ConnTracker::IterationPostTick() {
       send_data().stat_raw_data_gaps(), recv_data().stat_invalid_frames(),
       recv_data().stat_valid_frames(), recv_data().stat_raw_data_gaps());
 
+  bool protocol_rejected = false;
+
   if ((send_data().ParseFailureRate() > kParseFailureRateThreshold) ||
       (recv_data().ParseFailureRate() > kParseFailureRateThreshold)) {
     Disable(absl::Substitute("Connection does not appear parseable as protocol $0",
                              magic_enum::enum_name(protocol())));
+    protocol_rejected = true;
   }
 
   if (StitchFailureRate() > kStitchFailureRateThreshold) {
     Disable(absl::Substitute("Connection does not appear to produce valid records of protocol $0",
                              magic_enum::enum_name(protocol())));
+    protocol_rejected = true;
   }
+
+  UpdateProtocolVerdict(protocol_rejected);
+}
+
+void ConnTracker::UpdateProtocolVerdict(bool protocol_rejected) {
+  if (protocol_verdict_sent_ || conn_info_map_mgr_ == nullptr ||
+      !FLAGS_stirling_conn_protocol_verdict_to_bpf) {
+    return;
+  }
+
+  // Verdicts are keyed by the remote port, which only identifies the service for clients.
+  if (role_ != kRoleClient || protocol_ == kProtocolUnknown) {
+    return;
+  }
+
+  if (!protocol_rejected && stats_.Get(StatKey::kValidRecords) < kProtocolConfirmationRecords) {
+    return;
+  }
+
+  CONN_TRACE(1) << absl::Substitute("Sending protocol verdict protocol=$0 rejected=$1",
+                                    magic_enum::enum_name(protocol_), protocol_rejected);
+  conn_info_map_mgr_->SetProtocolVerdict(conn_id_, open_info_.remote_addr,
+                                         protocol_rejected ? kProtocolUnknown : protocol_, role_);
+  protocol_verdict_sent_ = true;
 }
 
 void ConnTracker::CheckProcForConnClose() {
@@ -944,6 +988,17 @@ endpoint_role_t TranslateRole(system::ClientServerRole role) {
 
 }  // namespace
 
+void ConnTracker::RecoverConnInfoFromBPF() {
+  bpf_conn_info_checked_ = true;
+  if (conn_info_map_mgr_ == nullptr) {
+    return;
+  }
+  PX_ASSIGN_OR(struct conn_info_t conn_info, conn_info_map_mgr_->GetConnInfo(conn_id_), return);
+  SetRemoteAddr(conn_info.raddr, "recovered from conn_info_map");
+  SetLocalAddr(conn_info.laddr, "recovered from conn_info_map");
+  SetRole(conn_info.role, "recovered from conn_info_map");
+}
+
 void ConnTracker::InferConnInfo(system::ProcParser* proc_parser,
                                 system::SocketInfoManager* socket_info_mgr) {
   DCHECK(proc_parser != nullptr);
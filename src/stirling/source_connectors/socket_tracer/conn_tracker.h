@@ -20,10 +20,12 @@
 
 #include <absl/container/flat_hash_map.h>
 #include <any>
+#include <chrono>
 #include <deque>
 #include <list>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <variant>
@@ -31,12 +33,14 @@
 
 #include <magic_enum.hpp>
 
+#include "src/common/perf/perf_probe.h"
 #include "src/common/system/proc_parser.h"
 #include "src/common/system/socket_info.h"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/go_grpc_types.hpp"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/socket_trace.hpp"
 #include "src/stirling/source_connectors/socket_tracer/data_stream.h"
 #include "src/stirling/source_connectors/socket_tracer/fd_resolver.h"
+#include "src/stirling/source_connectors/socket_tracer/protocol_costs.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/interface.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/http2/http2_streams_container.h"
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_bpf_tables.h"
@@ -249,6 +253,14 @@ class ConnTracker : NotCopyMoveable {
    */
   void InferConnInfo(system::ProcParser* proc_parser, system::SocketInfoManager* socket_info_mgr);
 
+  /**
+   * Attempts to recover the endpoints and role of a connection from the BPF conn_info_map.
+   *
+   * Intended for cases where the conn_open event was lost. Unlike InferConnInfo(), this is a
+   * single map lookup, and it is attempted only once per tracker.
+   */
+  void RecoverConnInfoFromBPF();
+
   /**
    * Processes the connection tracker, parsing raw events into frames,
    * and frames into record.
@@ -263,9 +275,12 @@ class ConnTracker : NotCopyMoveable {
     using TStateType = typename TProtocolTraits::state_type;
     using TKey = typename TProtocolTraits::key_type;
 
+    PX_PERF_PROBE_SCOPE("socket_tracer", "process_to_records");
     InitProtocolState<TStateType>();
 
+    auto parse_start = std::chrono::steady_clock::now();
     DataStreamsToFrames<TKey, TFrameType, TStateType>();
+    auto stitch_start = std::chrono::steady_clock::now();
 
     auto& req_frames = req_data()->Frames<TKey, TFrameType>();
     auto& resp_frames = resp_data()->Frames<TKey, TFrameType>();
@@ -290,6 +305,13 @@ class ConnTracker : NotCopyMoveable {
 
     CONN_TRACE(2) << absl::Substitute("records=$0", result.records.size());
 
+    processing_cost_.parse_ns +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stitch_start - parse_start).count();
+    processing_cost_.stitch_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      std::chrono::steady_clock::now() - stitch_start)
+                                      .count();
+    processing_cost_.num_records += result.records.size();
+
     UpdateResultStats(result);
 
     return std::move(result.records);
@@ -556,9 +578,13 @@ class ConnTracker : NotCopyMoveable {
     if constexpr (std::is_same_v<TFrameType, protocols::http2::Stream>) {
       http2_client_streams_.Cleanup(frame_size_limit_bytes, frame_expiry_timestamp);
       http2_server_streams_.Cleanup(frame_size_limit_bytes, frame_expiry_timestamp);
+      processing_cost_.frame_bytes = 0;
     } else {
-      send_data_.CleanupFrames<TKey, TFrameType>(frame_size_limit_bytes, frame_expiry_timestamp);
-      recv_data_.CleanupFrames<TKey, TFrameType>(frame_size_limit_bytes, frame_expiry_timestamp);
+      processing_cost_.frame_bytes =
+          send_data_.CleanupFrames<TKey, TFrameType>(frame_size_limit_bytes,
+                                                     frame_expiry_timestamp) +
+          recv_data_.CleanupFrames<TKey, TFrameType>(frame_size_limit_bytes,
+                                                     frame_expiry_timestamp);
     }
 
     auto* state = protocol_state<TStateType>();
@@ -574,8 +600,16 @@ class ConnTracker : NotCopyMoveable {
         state->recv = {};
       }
     }
+
+    processing_cost_.buffer_bytes =
+        send_data_.data_buffer().capacity() + recv_data_.data_buffer().capacity();
   }
 
+  /**
+   * Returns the processing cost of this tracker since the last call, and resets it.
+   */
+  ProcessingCost ConsumeProcessingCost() { return std::exchange(processing_cost_, {}); }
+
   static void SetConnInfoMapManager(const std::shared_ptr<ConnInfoMapManager>& conn_info_map_mgr) {
     conn_info_map_mgr_ = conn_info_map_mgr;
   }
@@ -664,6 +698,9 @@ class ConnTracker : NotCopyMoveable {
 
   void CheckProcForConnClose();
   void HandleInactivity();
+  // Sends the confirmed or rejected (if protocol_rejected) protocol of a client connection to BPF,
+  // to be reused for new connections of the same process to the same remote port.
+  void UpdateProtocolVerdict(bool protocol_rejected);
   bool IsRemoteAddrInCluster(const std::vector<CIDRBlock>& cluster_cidrs);
   void UpdateState(const std::vector<CIDRBlock>& cluster_cidrs);
 
@@ -695,6 +732,7 @@ class ConnTracker : NotCopyMoveable {
   // Used to identify the remove endpoint in case the accept/connect was not traced.
   std::unique_ptr<FDResolver> conn_resolver_ = nullptr;
   bool conn_resolution_failed_ = false;
+  bool bpf_conn_info_checked_ = false;
 
   struct conn_id_t conn_id_ = {};
 
@@ -756,6 +794,12 @@ class ConnTracker : NotCopyMoveable {
 
   std::string disable_reason_;
 
+  // Whether the protocol verdict of this connection was sent to BPF.
+  bool protocol_verdict_sent_ = false;
+
+  // Filled in by ProcessToRecords() and Cleanup(), see ConsumeProcessingCost().
+  ProcessingCost processing_cost_;
+
   // Iterations before the tracker can be killed.
   int32_t death_countdown_ = -1;
 
@@ -783,7 +827,12 @@ class ConnTracker : NotCopyMoveable {
   // A pointer to the conn trackers manager, used for notifying a protocol change.
   ConnTrackersManager* manager_ = nullptr;
 
+  // The position of this tracker in the manager's active trackers, until it is removed from there
+  // on its way to destruction.
+  std::optional<std::list<ConnTracker*>::iterator> active_trackers_iter_;
+
   friend class ConnTrackersManager;
+  friend class ConnTrackerGenerations;
   // A subclass expose private member as public.
   friend class ConnTrackerTestDouble;
 };
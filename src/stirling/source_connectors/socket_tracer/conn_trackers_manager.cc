@@ -17,15 +17,63 @@
  */
 
 #include "src/stirling/source_connectors/socket_tracer/conn_trackers_manager.h"
+
+#include <algorithm>
+
 #include "src/common/metrics/metrics.h"
 
 DEFINE_double(
     stirling_conn_tracker_cleanup_threshold, 0.2,
     "Percentage of trackers that are ready for destruction that will trigger a memory cleanup");
+DEFINE_uint32(stirling_conn_tracker_pool_size,
+              gflags::Uint32FromEnv("PL_STIRLING_CONN_TRACKER_POOL_SIZE", 2048),
+              "The maximum number of destroyed connection trackers kept for reuse.");
 
 namespace px {
 namespace stirling {
 
+//-----------------------------------------------------------------------------
+// ConnTrackerPool
+//-----------------------------------------------------------------------------
+
+std::unique_ptr<ConnTracker> ConnTrackerPool::Pop() {
+  std::unique_ptr<ConnTracker> tracker = trackers_.Pop();
+  ReuseDataBuffer(&tracker->send_data().data_buffer());
+  ReuseDataBuffer(&tracker->recv_data().data_buffer());
+  return tracker;
+}
+
+void ConnTrackerPool::Recycle(std::unique_ptr<ConnTracker> tracker) {
+  RecycleDataBuffer(&tracker->send_data().data_buffer());
+  RecycleDataBuffer(&tracker->recv_data().data_buffer());
+  trackers_.Recycle(std::move(tracker));
+}
+
+void ConnTrackerPool::RecycleDataBuffer(protocols::DataStreamBuffer* data_buffer) {
+  // Data buffers are shrunk to their contents every iteration, so most of them have no memory left
+  // by the time their tracker is destroyed.
+  data_buffer->Clear();
+  if (data_buffer->capacity() == 0 || data_buffers_.size() >= 2 * capacity_) {
+    return;
+  }
+  // This leaves the tracker's data buffer moved-from, which is fine since the tracker is destroyed.
+  data_buffers_.push_back(std::move(*data_buffer));
+}
+
+void ConnTrackerPool::ReuseDataBuffer(protocols::DataStreamBuffer* data_buffer) {
+  if (data_buffers_.empty()) {
+    return;
+  }
+  *data_buffer = std::move(data_buffers_.back());
+  data_buffers_.pop_back();
+  ++num_reused_data_buffers_;
+}
+
+std::string ConnTrackerPool::StatsString() const {
+  return absl::Substitute("kPoolPopped=$0 kPoolReused=$1 kPoolDataBuffersReused=$2 ",
+                          trackers_.num_popped(), trackers_.num_reused(), num_reused_data_buffers_);
+}
+
 //-----------------------------------------------------------------------------
 // ConnTrackerGenerations
 //-----------------------------------------------------------------------------
@@ -81,7 +129,7 @@ int ConnTrackerGenerations::CleanupGenerations(ConnTrackerPool* tracker_pool) {
     auto& tracker = iter->second;
 
     // Remove any trackers that are no longer required.
-    if (tracker->ReadyForDestruction()) {
+    if (tracker->ReadyForDestruction() && !tracker->active_trackers_iter_.has_value()) {
       if (tracker.get() == oldest_generation_) {
         oldest_generation_ = nullptr;
       }
@@ -104,14 +152,12 @@ int ConnTrackerGenerations::CleanupGenerations(ConnTrackerPool* tracker_pool) {
 
 namespace {
 
-constexpr size_t kMaxConnTrackerPoolSize = 2048;
-
 uint64_t GetConnMapKey(uint32_t pid, int32_t fd) { return (static_cast<uint64_t>(pid) << 32) | fd; }
 
 }  // namespace
 
 ConnTrackersManager::ConnTrackersManager()
-    : trackers_pool_(kMaxConnTrackerPoolSize),
+    : trackers_pool_(FLAGS_stirling_conn_tracker_pool_size),
       conn_tracker_created_(BuildCounter("conn_tracker_created",
                                          "Counter that tracks when a conn tracker is created")),
       conn_tracker_destroyed_(BuildCounter("conn_tracker_destroyed",
@@ -127,8 +173,13 @@ ConnTracker& ConnTrackersManager::GetOrCreateConnTracker(struct conn_id_t conn_i
   auto [conn_tracker_ptr, created] = conn_trackers.GetOrCreate(conn_id, &trackers_pool_);
 
   if (created) {
-    active_trackers_.push_back(conn_tracker_ptr);
+    conn_tracker_ptr->active_trackers_iter_ =
+        active_trackers_.insert(active_trackers_.end(), conn_tracker_ptr);
     conn_tracker_ptr->manager_ = this;
+    // A new tracker of an older generation is marked for death right away.
+    if (conn_tracker_ptr->IsZombie()) {
+      ScheduleDestructionCheck(conn_tracker_ptr, conn_tracker_ptr->death_countdown_);
+    }
 
     stats_.Increment(StatKey::kTotal);
     stats_.Increment(StatKey::kCreated);
@@ -159,20 +210,24 @@ StatusOr<const ConnTracker*> ConnTrackersManager::GetConnTracker(uint32_t pid, i
   return tracker_generations.GetActive();
 }
 
+void ConnTrackersManager::ScheduleDestructionCheck(ConnTracker* tracker, int32_t countdown) {
+  destruction_checks_.Schedule(num_cleanups_ + countdown, tracker);
+}
+
 void ConnTrackersManager::CleanupTrackers() {
-  {
-    auto iter = active_trackers_.begin();
-    while (iter != active_trackers_.end()) {
-      const auto& tracker = *iter;
-      if (tracker->ReadyForDestruction()) {
-        active_trackers_.erase(iter++);
-
-        stats_.Increment(StatKey::kReadyForDestruction);
-      } else {
-        ++iter;
-      }
+  ++num_cleanups_;
+  destruction_checks_.Advance(num_cleanups_, [this](ConnTracker* tracker) {
+    if (tracker->ReadyForDestruction()) {
+      active_trackers_.erase(*tracker->active_trackers_iter_);
+      tracker->active_trackers_iter_.reset();
+
+      stats_.Increment(StatKey::kReadyForDestruction);
+    } else {
+      // Still counting down, or waiting for its final conn stats to be reported.
+      destruction_checks_.Schedule(num_cleanups_ + std::max(tracker->death_countdown_, 1),
+                                   tracker);
     }
-  }
+  });
 
   // As a performance optimization, we only clean up trackers once we reach a certain threshold
   // of trackers that are ready for destruction.
@@ -229,7 +284,7 @@ std::string ConnTrackersManager::DebugInfo() const {
 }
 
 std::string ConnTrackersManager::StatsString() const {
-  return absl::StrCat(stats_.Print(), protocol_stats_.Print());
+  return absl::StrCat(stats_.Print(), trackers_pool_.StatsString(), protocol_stats_.Print());
 }
 
 void ConnTrackersManager::ComputeProtocolStats() {
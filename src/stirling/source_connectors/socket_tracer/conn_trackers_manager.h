@@ -32,13 +32,49 @@
 #include "src/stirling/source_connectors/socket_tracer/conn_tracker.h"
 #include "src/stirling/utils/obj_pool.h"
 #include "src/stirling/utils/stat_counter.h"
+#include "src/stirling/utils/timer_wheel.h"
 
 DECLARE_double(stirling_conn_tracker_cleanup_threshold);
+DECLARE_uint32(stirling_conn_tracker_pool_size);
 
 namespace px {
 namespace stirling {
 
-using ConnTrackerPool = ObjPool<ConnTracker>;
+/**
+ * ConnTrackerPool recycles ConnTrackers, so that connection churn doesn't reallocate them.
+ * The data buffers of recycled trackers that still hold allocated memory are kept as well,
+ * and handed to new trackers.
+ */
+class ConnTrackerPool {
+ public:
+  explicit ConnTrackerPool(size_t capacity) : trackers_(capacity), capacity_(capacity) {}
+
+  /**
+   * Returns a new or recycled tracker.
+   */
+  std::unique_ptr<ConnTracker> Pop();
+
+  /**
+   * Submits a tracker for recycling. The pool may keep it or deallocate it.
+   */
+  void Recycle(std::unique_ptr<ConnTracker> tracker);
+
+  /**
+   * Returns a string with the reuse statistics of the pool.
+   */
+  std::string StatsString() const;
+
+ private:
+  void RecycleDataBuffer(protocols::DataStreamBuffer* data_buffer);
+  void ReuseDataBuffer(protocols::DataStreamBuffer* data_buffer);
+
+  ObjPool<ConnTracker> trackers_;
+  const size_t capacity_;
+
+  // Emptied data buffers that kept their allocated memory.
+  std::vector<protocols::DataStreamBuffer> data_buffers_;
+  size_t num_reused_data_buffers_ = 0;
+};
 
 /**
  * ConnTrackersGenerations is a container of tracker generations,
@@ -70,8 +106,8 @@ class ConnTrackerGenerations {
   bool empty() const { return generations_.empty(); }
 
   /**
-   * Removes all trackers that are ReadyForDestruction().
-   * Removed trackers are pushed into the tracker pool for recycling.
+   * Removes all trackers that are ReadyForDestruction() and no longer in the manager's active
+   * trackers. Removed trackers are pushed into the tracker pool for recycling.
    */
   int CleanupGenerations(ConnTrackerPool* tracker_pool);
 
@@ -118,8 +154,8 @@ class ConnTrackersManager {
 
   /**
    * Deletes trackers that are ReadyForDestruction().
-   * Call this only after accumulating enough trackers to clean-up, to avoid the performance
-   * impact of scanning through all trackers every iteration.
+   * Only the trackers whose death countdown has run out are checked, so this can be called every
+   * iteration. The trackers are destroyed once enough of them have accumulated.
    */
   void CleanupTrackers();
 
@@ -142,6 +178,10 @@ class ConnTrackersManager {
   // Simple consistency DCHECKs meant for enforcing invariants.
   void DebugChecks() const;
 
+  // Called by a tracker when it is marked for death, to be checked by CleanupTrackers() once its
+  // countdown runs out.
+  void ScheduleDestructionCheck(ConnTracker* tracker, int32_t countdown);
+
   // A map from conn_id (PID+FD+TSID) to tracker. This is for easy update on BPF events.
   // Structured as two nested maps to be explicit about "generations" of trackers per PID+FD.
   // Key is {PID, FD} for outer map, and tsid for inner map.
@@ -149,6 +189,12 @@ class ConnTrackersManager {
 
   std::list<ConnTracker*> active_trackers_;
 
+  // Trackers marked for death, keyed by the CleanupTrackers() call at which to check whether they
+  // are ReadyForDestruction(). Each tracker is in here at most once, until it leaves
+  // active_trackers_.
+  utils::TimerWheel<ConnTracker*> destruction_checks_;
+  uint64_t num_cleanups_ = 0;
+
   // A pool of unused trackers that can be recycled.
   // This is useful for avoiding memory reallocations.
   ConnTrackerPool trackers_pool_;
@@ -160,6 +206,8 @@ class ConnTrackersManager {
   prometheus::Counter& conn_tracker_created_;
   prometheus::Counter& conn_tracker_destroyed_;
   prometheus::Counter& destroyed_gens_;
+
+  friend class ConnTracker;
 };
 
 }  // namespace stirling
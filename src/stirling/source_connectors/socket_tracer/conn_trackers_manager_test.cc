@@ -112,6 +112,49 @@ TEST_F(ConnTrackersManagerTest, DebugInfo) {
   EXPECT_THAT(debug_info, HasSubstr("conn_tracker=conn_id=[upid=1:1 fd=1 gen=1]"));
 }
 
+// Tests that trackers are destroyed once their death countdown has run out, without scanning the
+// trackers that are still alive.
+TEST_F(ConnTrackersManagerTest, CleanupTrackersMarkedForDeath) {
+  FLAGS_stirling_check_proc_for_conn_close = false;
+
+  struct conn_id_t conn_id = {};
+  conn_id.upid.pid = 1;
+  conn_id.upid.start_time_ticks = 1;
+  conn_id.fd = 1;
+  conn_id.tsid = 1;
+  ConnTracker& tracker = trackers_mgr_.GetOrCreateConnTracker(conn_id);
+  conn_id.fd = 2;
+  trackers_mgr_.GetOrCreateConnTracker(conn_id);
+
+  tracker.MarkForDeath(1);
+  CleanupTrackers();
+  EXPECT_EQ(trackers_mgr_.active_trackers().size(), 2U);
+
+  tracker.IterationPostTick();
+  tracker.MarkFinalConnStatsReported();
+  CleanupTrackers();
+  EXPECT_EQ(trackers_mgr_.active_trackers().size(), 1U);
+  EXPECT_THAT(trackers_mgr_.StatsString(),
+              HasSubstr("kTotal=1 kReadyForDestruction=0 kCreated=2 kDestroyed=1"));
+}
+
+TEST(ConnTrackerPoolTest, ReusesTrackersAndDataBuffers) {
+  ConnTrackerPool tracker_pool(4);
+
+  std::unique_ptr<ConnTracker> tracker = tracker_pool.Pop();
+  ConnTracker* tracker_ptr = tracker.get();
+  tracker->send_data().data_buffer().Add(0, "data", 0);
+  tracker_pool.Recycle(std::move(tracker));
+
+  tracker = tracker_pool.Pop();
+  EXPECT_EQ(tracker.get(), tracker_ptr);
+  // The data buffer comes back empty, but with its memory.
+  EXPECT_TRUE(tracker->send_data().data_buffer().empty());
+  EXPECT_GT(tracker->send_data().data_buffer().capacity(), 0U);
+  EXPECT_THAT(tracker_pool.StatsString(),
+              HasSubstr("kPoolPopped=2 kPoolReused=1 kPoolDataBuffersReused=1"));
+}
+
 class ConnTrackerGenerationsTest : public ::testing::Test {
  protected:
   ConnTrackerGenerationsTest() : tracker_pool(1024) {
@@ -103,6 +103,14 @@ void DataStream::ProcessBytesToFrames(message_type_t type, TStateType* state) {
 
   bool keep_processing = has_new_events_ || attempt_sync || conn_closed();
 
+  // The head is an incomplete frame of known size, and not enough bytes have arrived to complete
+  // it. Parsing now would only merge the new events into the head and scan it again.
+  if (keep_processing && !attempt_sync && !conn_closed() &&
+      data_buffer_.position() == incomplete_frame_pos_ &&
+      data_buffer_.size() < incomplete_frame_size_) {
+    keep_processing = false;
+  }
+
   protocols::ParseResult<TKey> parse_result;
   parse_result.state = ParseState::kNeedsMoreData;
   parse_result.end_position = 0;
@@ -121,6 +129,7 @@ void DataStream::ProcessBytesToFrames(message_type_t type, TStateType* state) {
       // Drop all events up to this point, and then try to resume.
       data_buffer_.RemovePrefix(contiguous_bytes);
       data_buffer_.Trim();
+      incomplete_frame_size_ = 0;
 
       keep_processing = (parse_result.state != ParseState::kEOS);
     } else {
@@ -130,6 +139,10 @@ void DataStream::ProcessBytesToFrames(message_type_t type, TStateType* state) {
       if (parse_result.end_position != 0) {
         data_buffer_.RemovePrefix(parse_result.end_position);
       }
+      if (parse_result.state == ParseState::kNeedsMoreData) {
+        incomplete_frame_pos_ = data_buffer_.position();
+        incomplete_frame_size_ = parse_result.incomplete_frame_size;
+      }
 
       keep_processing = false;
     }
@@ -218,6 +231,7 @@ template void DataStream::ProcessBytesToFrames<
 void DataStream::Reset() {
   data_buffer_.Reset();
   has_new_events_ = false;
+  incomplete_frame_size_ = 0;
   UpdateLastProgressTime();
 
   frames_ = std::monostate();
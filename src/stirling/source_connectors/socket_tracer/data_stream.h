@@ -231,10 +231,11 @@ class DataStream : NotCopyMoveable {
 
   /**
    * Cleanup frames that are parsed from the BPF events, when the condition is right.
+   * Returns the approximate size of the frames that are kept; expired frames are not accounted.
    */
   template <typename TKey, typename TFrameType>
-  void CleanupFrames(size_t size_limit_bytes,
-                     std::chrono::time_point<std::chrono::steady_clock> expiry_timestamp) {
+  size_t CleanupFrames(size_t size_limit_bytes,
+                       std::chrono::time_point<std::chrono::steady_clock> expiry_timestamp) {
     size_t size = FramesSize<TKey, TFrameType>();
     if (size > size_limit_bytes) {
       VLOG(1) << absl::Substitute("Messages cleared due to size limit ($0 > $1).", size,
@@ -242,8 +243,11 @@ class DataStream : NotCopyMoveable {
       for (auto& [_, frame_deque] : Frames<TKey, TFrameType>()) {
         frame_deque.clear();
       }
+      size = 0;
     }
     EraseExpiredFrames(expiry_timestamp, &Frames<TKey, TFrameType>());
+    EraseIdleStreams(&Frames<TKey, TFrameType>());
+    return size;
   }
 
   /**
@@ -255,6 +259,7 @@ class DataStream : NotCopyMoveable {
     if (last_progress_time_ < expiry_timestamp) {
       data_buffer_.Reset();
       has_new_events_ = false;
+      incomplete_frame_size_ = 0;
       UpdateLastProgressTime();
       return true;
     }
@@ -293,6 +298,28 @@ class DataStream : NotCopyMoveable {
     }
   }
 
+  // Streams whose frames have all been consumed keep their (empty) deque in the map, so that a
+  // reused stream ID (CQL and MongoDB clients recycle a small set of them) finds its deque with the
+  // allocated block still in place. Past this many idle streams, the rest are released, since each
+  // empty std::deque still holds on to its node map and a 512-byte block. Protocols without
+  // streams only ever have stream 0, so they are not affected.
+  static constexpr size_t kMaxIdleStreams = 16;
+
+  template <typename TKey, typename TFrameType>
+  static void EraseIdleStreams(absl::flat_hash_map<TKey, std::deque<TFrameType>>* frames) {
+    if (frames->size() <= kMaxIdleStreams) {
+      return;
+    }
+    size_t num_idle = 0;
+    for (auto iter = frames->begin(); iter != frames->end();) {
+      if (iter->second.empty() && ++num_idle > kMaxIdleStreams) {
+        frames->erase(iter++);
+      } else {
+        ++iter;
+      }
+    }
+  }
+
   // Raw data events from BPF.
   protocols::DataStreamBuffer data_buffer_;
 
@@ -313,6 +340,12 @@ class DataStream : NotCopyMoveable {
   // changed.
   bool has_new_events_ = false;
 
+  // The position and size of the incomplete frame at the head of the buffer, as reported by the
+  // last call to ParseFrames(). ProcessBytesToFrames() doesn't parse again until the buffer holds
+  // enough bytes to complete it. A size of 0 means unknown.
+  size_t incomplete_frame_pos_ = 0;
+  size_t incomplete_frame_size_ = 0;
+
   // The current_time_ is the time the tracker should assume to be "now" during its processing.
   // The value is set by set_current_time().
   // This approach helps to avoid repeated calls to get the clock, and improves testability.
@@ -31,6 +31,7 @@
 namespace px {
 namespace stirling {
 
+namespace cass = protocols::cass;
 namespace http = protocols::http;
 namespace mysql = protocols::mysql;
 
@@ -429,6 +430,27 @@ TEST_F(DataStreamTest, CannotSwitchType) {
 #endif
 }
 
+TEST_F(DataStreamTest, IdleStreamsAreReleased) {
+  DataStream stream;
+  stream.set_protocol(kProtocolCQL);
+
+  auto& frames = stream.Frames<cass::stream_id_t, cass::Frame>();
+  for (cass::stream_id_t i = 0; i < 100; ++i) {
+    frames[i].emplace_back().timestamp_ns = 1000;
+  }
+  // Consume the frames of all streams but one.
+  for (cass::stream_id_t i = 0; i < 99; ++i) {
+    frames[i].clear();
+  }
+
+  stream.CleanupFrames<cass::stream_id_t, cass::Frame>(/* size_limit_bytes */ 1 << 20,
+                                                       std::chrono::steady_clock::time_point{});
+
+  // Up to 16 idle streams are kept, alongside the one that still has a frame.
+  EXPECT_THAT(frames, SizeIs(17));
+  EXPECT_THAT(frames[99], SizeIs(1));
+}
+
 TEST_F(DataStreamTest, SpikeCapacityWithLargeDataChunk) {
   int spike_capacity_bytes = 1024;
   int retention_capacity_bytes = 16;
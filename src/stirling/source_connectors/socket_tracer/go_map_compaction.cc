@@ -0,0 +1,80 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/go_map_compaction.h"
+
+#include <algorithm>
+
+#include <absl/container/flat_hash_map.h>
+
+namespace px {
+namespace stirling {
+
+StashedEntriesCompaction SelectStashedEntriesToCompact(
+    const std::vector<StashedEntry>& entries, uint64_t now_ns, uint64_t ttl_ns,
+    size_t high_watermark, size_t low_watermark, const std::function<bool(uint32_t)>& tgid_alive) {
+  StashedEntriesCompaction result;
+
+  absl::flat_hash_map<uint32_t, bool> tgid_exists;
+  std::vector<size_t> kept;
+  kept.reserve(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const StashedEntry& entry = entries[i];
+
+    auto [iter, inserted] = tgid_exists.try_emplace(entry.tgid, false);
+    if (inserted) {
+      iter->second = tgid_alive(entry.tgid);
+    }
+
+    if (!iter->second) {
+      result.evicted.push_back(i);
+      ++result.num_exited;
+    } else if (entry.timestamp_ns < now_ns && now_ns - entry.timestamp_ns > ttl_ns) {
+      result.evicted.push_back(i);
+      ++result.num_stale;
+    } else {
+      kept.push_back(i);
+    }
+  }
+
+  if (kept.size() > high_watermark) {
+    size_t num_over_capacity = kept.size() - std::min(low_watermark, high_watermark);
+    std::nth_element(kept.begin(), kept.begin() + num_over_capacity, kept.end(),
+                     [&entries](size_t a, size_t b) {
+                       return entries[a].timestamp_ns < entries[b].timestamp_ns;
+                     });
+    result.evicted.insert(result.evicted.end(), kept.begin(), kept.begin() + num_over_capacity);
+    kept.erase(kept.begin(), kept.begin() + num_over_capacity);
+    result.num_over_capacity = num_over_capacity;
+  }
+
+  absl::flat_hash_map<uint32_t, size_t> entries_per_tgid;
+  for (size_t i : kept) {
+    size_t count = ++entries_per_tgid[entries[i].tgid];
+    if (count > result.max_entries_per_tgid) {
+      result.max_entries_per_tgid = count;
+      result.max_entries_tgid = entries[i].tgid;
+    }
+  }
+  result.num_remaining = kept.size();
+
+  return result;
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace px {
+namespace stirling {
+
+// The parts of a BPF map entry that decide whether it is compacted.
+struct StashedEntry {
+  uint32_t tgid;
+  // From bpf_ktime_get_ns(), when BPF stashed the entry.
+  uint64_t timestamp_ns;
+};
+
+struct StashedEntriesCompaction {
+  // Indices of the entries to remove from the map.
+  std::vector<size_t> evicted;
+
+  int num_exited = 0;
+  int num_stale = 0;
+  int num_over_capacity = 0;
+
+  // The number of entries left in the map, and the most held by a single process.
+  size_t num_remaining = 0;
+  size_t max_entries_per_tgid = 0;
+  uint32_t max_entries_tgid = 0;
+};
+
+/**
+ * Selects the entries of a BPF map of stashed probe state to remove. These maps are keyed by
+ * goroutine or by Go object, and BPF only removes an entry when the traced function returns.
+ *
+ * Removes the entries of processes that have exited, and the entries older than ttl_ns.
+ * If more than high_watermark entries are left, the oldest ones are evicted down to
+ * low_watermark entries, so that BPF can keep stashing state for new calls.
+ *
+ * @param tgid_alive Returns whether the process with the TGID is still running.
+ *                   Called once per TGID.
+ */
+StashedEntriesCompaction SelectStashedEntriesToCompact(
+    const std::vector<StashedEntry>& entries, uint64_t now_ns, uint64_t ttl_ns,
+    size_t high_watermark, size_t low_watermark, const std::function<bool(uint32_t)>& tgid_alive);
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/go_map_compaction.h"
+
+#include <vector>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+constexpr uint64_t kTTLNs = 1000;
+
+bool AllAlive(uint32_t) { return true; }
+
+TEST(SelectStashedEntriesToCompactTest, KeepsFreshEntriesOfRunningProcesses) {
+  std::vector<StashedEntry> entries = {{1, 900}, {1, 950}, {2, 1000}};
+  StashedEntriesCompaction result =
+      SelectStashedEntriesToCompact(entries, /*now_ns*/ 1500, kTTLNs, 10, 5, AllAlive);
+  EXPECT_THAT(result.evicted, IsEmpty());
+  EXPECT_EQ(result.num_remaining, 3);
+  EXPECT_EQ(result.max_entries_per_tgid, 2);
+  EXPECT_EQ(result.max_entries_tgid, 1);
+}
+
+TEST(SelectStashedEntriesToCompactTest, EvictsEntriesOfExitedProcesses) {
+  std::vector<StashedEntry> entries = {{1, 900}, {2, 950}, {1, 1000}, {3, 1000}};
+  int num_calls = 0;
+  StashedEntriesCompaction result = SelectStashedEntriesToCompact(
+      entries, /*now_ns*/ 1500, kTTLNs, 10, 5, [&num_calls](uint32_t tgid) {
+        ++num_calls;
+        return tgid != 1;
+      });
+  EXPECT_THAT(result.evicted, ElementsAre(0, 2));
+  EXPECT_EQ(result.num_exited, 2);
+  EXPECT_EQ(result.num_remaining, 2);
+  // Each process is only checked once.
+  EXPECT_EQ(num_calls, 3);
+}
+
+TEST(SelectStashedEntriesToCompactTest, EvictsStaleEntries) {
+  std::vector<StashedEntry> entries = {{1, 100}, {1, 2000}, {2, 1500}, {2, 3000}};
+  StashedEntriesCompaction result =
+      SelectStashedEntriesToCompact(entries, /*now_ns*/ 2500, kTTLNs, 10, 5, AllAlive);
+  // An entry stashed after now_ns was read is not stale.
+  EXPECT_THAT(result.evicted, ElementsAre(0));
+  EXPECT_EQ(result.num_stale, 1);
+  EXPECT_EQ(result.num_remaining, 3);
+}
+
+TEST(SelectStashedEntriesToCompactTest, EvictsOldestEntriesAboveHighWatermark) {
+  std::vector<StashedEntry> entries = {{1, 1400}, {1, 1100}, {2, 1300}, {2, 1200}, {3, 1500}};
+  StashedEntriesCompaction result =
+      SelectStashedEntriesToCompact(entries, /*now_ns*/ 1500, kTTLNs, 4, 2, AllAlive);
+  EXPECT_THAT(result.evicted, UnorderedElementsAre(1, 2, 3));
+  EXPECT_EQ(result.num_over_capacity, 3);
+  EXPECT_EQ(result.num_remaining, 2);
+  EXPECT_EQ(result.max_entries_per_tgid, 1);
+}
+
+TEST(SelectStashedEntriesToCompactTest, KeepsEntriesAtHighWatermark) {
+  std::vector<StashedEntry> entries = {{1, 1400}, {1, 1100}, {2, 1300}, {2, 1200}};
+  StashedEntriesCompaction result =
+      SelectStashedEntriesToCompact(entries, /*now_ns*/ 1500, kTTLNs, 4, 2, AllAlive);
+  EXPECT_THAT(result.evicted, IsEmpty());
+  EXPECT_EQ(result.num_remaining, 4);
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -271,5 +271,34 @@ TYPED_TEST(OpenSSLTraceTest, ssl_capture_node_client) {
   EXPECT_THAT(records.remote_address, UnorderedElementsAre(StrEq("127.0.0.1")));
 }
 
+// Runs with the TLS data coalesced in BPF, see --stirling_socket_tracer_ssl_coalescing.
+class OpenSSLCoalescingTraceTest : public OpenSSLTraceTest<NginxOpenSSL_1_1_1_ContainerWrapper> {
+ protected:
+  void SetUp() override {
+    FLAGS_stirling_socket_tracer_ssl_coalescing = true;
+    OpenSSLTraceTest::SetUp();
+  }
+
+  void TearDown() override {
+    OpenSSLTraceTest::TearDown();
+    FLAGS_stirling_socket_tracer_ssl_coalescing = false;
+  }
+};
+
+TEST_F(OpenSSLCoalescingTraceTest, ssl_capture_curl_client) {
+  StartTransferDataThread();
+
+  ::px::stirling::testing::CurlContainer client;
+  constexpr bool kHostPid = false;
+  ASSERT_OK(client.Run(std::chrono::seconds{60},
+                       {absl::Substitute("--network=container:$0", server_.container_name())},
+                       {"--insecure", "-s", "-S", "https://127.0.0.1:443/index.html"}, kHostPid));
+  client.Wait();
+  StopTransferDataThread();
+
+  TraceRecords records = GetTraceRecords(server_.PID());
+  EXPECT_THAT(records.http_records, UnorderedElementsAre(EqHTTPRecord(GetExpectedHTTPRecord())));
+}
+
 }  // namespace stirling
 }  // namespace px
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocol_costs.h"
+
+#include <string>
+
+#include <magic_enum.hpp>
+
+namespace px {
+namespace stirling {
+
+ProtocolCosts::ProtocolCosts(prometheus::Registry* registry) {
+  auto& processing_ns = prometheus::BuildCounter()
+                            .Name("socket_tracer_processing_ns")
+                            .Help("Total time spent by the socket tracer in each processing stage "
+                                  "of the connections of this protocol.")
+                            .Register(*registry);
+  auto& held_bytes = prometheus::BuildGauge()
+                         .Name("socket_tracer_held_bytes")
+                         .Help("Bytes held by the socket tracer for the connections of this "
+                               "protocol, either as raw data or as parsed frames.")
+                         .Register(*registry);
+
+  metrics_.reserve(kNumProtocols);
+  for (int i = 0; i < kNumProtocols; ++i) {
+    std::string protocol(magic_enum::enum_name(static_cast<traffic_protocol_t>(i)));
+    metrics_.push_back({
+        processing_ns.Add({{"protocol", protocol}, {"stage", "parse"}}),
+        processing_ns.Add({{"protocol", protocol}, {"stage", "stitch"}}),
+        processing_ns.Add({{"protocol", protocol}, {"stage", "append"}}),
+        held_bytes.Add({{"protocol", protocol}, {"kind", "data_stream_buffer"}}),
+        held_bytes.Add({{"protocol", protocol}, {"kind", "frames"}}),
+    });
+  }
+}
+
+void ProtocolCosts::BeginIteration() {
+  for (auto& stats : stats_) {
+    stats.num_conns = 0;
+    stats.buffer_bytes = 0;
+    stats.frame_bytes = 0;
+  }
+}
+
+void ProtocolCosts::Add(traffic_protocol_t protocol, const ProcessingCost& cost) {
+  Stats& stats = stats_[protocol];
+  stats.parse_ns += cost.parse_ns;
+  stats.stitch_ns += cost.stitch_ns;
+  stats.append_ns += cost.append_ns;
+  stats.num_records += cost.num_records;
+  stats.num_conns += 1;
+  stats.buffer_bytes += cost.buffer_bytes;
+  stats.frame_bytes += cost.frame_bytes;
+
+  Metrics& metrics = metrics_[protocol];
+  metrics.parse_ns.Increment(cost.parse_ns);
+  metrics.stitch_ns.Increment(cost.stitch_ns);
+  metrics.append_ns.Increment(cost.append_ns);
+}
+
+void ProtocolCosts::EndIteration() {
+  for (int i = 0; i < kNumProtocols; ++i) {
+    metrics_[i].buffer_bytes.Set(stats_[i].buffer_bytes);
+    metrics_[i].frame_bytes.Set(stats_[i].frame_bytes);
+  }
+}
+
+void ProtocolCosts::ClearTimes() {
+  for (auto& stats : stats_) {
+    stats.parse_ns = 0;
+    stats.stitch_ns = 0;
+    stats.append_ns = 0;
+    stats.num_records = 0;
+  }
+}
+
+}  // namespace stirling
+}  // namespace px
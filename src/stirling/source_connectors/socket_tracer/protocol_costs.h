@@ -0,0 +1,99 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <prometheus/counter.h>
+#include <prometheus/gauge.h>
+#include <prometheus/registry.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/common.hpp"
+
+namespace px {
+namespace stirling {
+
+/**
+ * The user-space processing cost of one connection in one iteration of the socket tracer.
+ */
+struct ProcessingCost {
+  // Time spent parsing the data streams into frames.
+  int64_t parse_ns = 0;
+  // Time spent stitching the frames into records.
+  int64_t stitch_ns = 0;
+  // Time spent appending the records to the data table.
+  int64_t append_ns = 0;
+  int64_t num_records = 0;
+  // Bytes held by the data stream buffers and by the parsed frames, after cleanup.
+  int64_t buffer_bytes = 0;
+  int64_t frame_bytes = 0;
+};
+
+/**
+ * Accumulates the processing costs of the connections per protocol, so that the CPU and memory
+ * used by the socket tracer can be attributed to the protocols that use them.
+ *
+ * Times and record counts accumulate until ClearTimes(). Held bytes and connection counts are those
+ * of the last iteration. Both are also exported as Prometheus metrics.
+ */
+class ProtocolCosts {
+ public:
+  struct Stats {
+    int64_t parse_ns = 0;
+    int64_t stitch_ns = 0;
+    int64_t append_ns = 0;
+    int64_t num_records = 0;
+    int64_t num_conns = 0;
+    int64_t buffer_bytes = 0;
+    int64_t frame_bytes = 0;
+  };
+
+  explicit ProtocolCosts(prometheus::Registry* registry);
+
+  // Starts an iteration, in which the held bytes and the connections are counted anew.
+  void BeginIteration();
+
+  void Add(traffic_protocol_t protocol, const ProcessingCost& cost);
+
+  // Publishes the held bytes of the iteration to the Prometheus gauges.
+  void EndIteration();
+
+  const Stats& stats(traffic_protocol_t protocol) const { return stats_[protocol]; }
+
+  // Resets the accumulated times and record counts, after they were exported.
+  void ClearTimes();
+
+ private:
+  struct Metrics {
+    prometheus::Counter& parse_ns;
+    prometheus::Counter& stitch_ns;
+    prometheus::Counter& append_ns;
+    prometheus::Gauge& buffer_bytes;
+    prometheus::Gauge& frame_bytes;
+  };
+
+  std::array<Stats, kNumProtocols> stats_ = {};
+  // Indexed by protocol.
+  std::vector<Metrics> metrics_;
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "src/stirling/core/output.h"
+#include "src/stirling/core/types.h"
+#include "src/stirling/source_connectors/socket_tracer/canonical_types.h"
+
+namespace px {
+namespace stirling {
+
+// clang-format off
+constexpr DataElement kProtocolCostsElements[] = {
+        canonical_data_elements::kTime,
+        {"protocol", "The protocol of the connections.",
+         types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::GENERAL_ENUM,
+         &kTrafficProtocolDecoder},
+        {"interval", "The duration of the interval that the costs were accumulated over.",
+         types::DataType::INT64, types::SemanticType::ST_DURATION_NS,
+         types::PatternType::METRIC_GAUGE},
+        {"parse_time", "Time spent parsing the traced data into frames in the interval.",
+         types::DataType::INT64, types::SemanticType::ST_DURATION_NS,
+         types::PatternType::METRIC_GAUGE},
+        {"stitch_time", "Time spent stitching frames into records in the interval.",
+         types::DataType::INT64, types::SemanticType::ST_DURATION_NS,
+         types::PatternType::METRIC_GAUGE},
+        {"append_time", "Time spent appending records to the tables in the interval.",
+         types::DataType::INT64, types::SemanticType::ST_DURATION_NS,
+         types::PatternType::METRIC_GAUGE},
+        {"num_records", "The number of records produced in the interval.",
+         types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::METRIC_GAUGE},
+        {"num_conns", "The number of connections being processed at the end of the interval.",
+         types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::METRIC_GAUGE},
+        {"buffer_bytes", "Bytes of traced data held in the data stream buffers at the end of the "
+         "interval.",
+         types::DataType::INT64, types::SemanticType::ST_BYTES, types::PatternType::METRIC_GAUGE},
+        {"frame_bytes", "Approximate bytes of parsed frames held at the end of the interval.",
+         types::DataType::INT64, types::SemanticType::ST_BYTES, types::PatternType::METRIC_GAUGE},
+};
+// clang-format on
+
+constexpr DataTableSchema kProtocolCostsTable(
+    "socket_tracer_costs",
+    "The CPU time and memory that the socket tracer spends on each protocol, per interval. Use it "
+    "to find which protocols make the socket tracer busy.",
+    kProtocolCostsElements);
+DEFINE_PRINT_TABLE(ProtocolCosts)
+
+namespace protocol_costs_idx {
+
+constexpr int kTime = kProtocolCostsTable.ColIndex("time_");
+constexpr int kProtocol = kProtocolCostsTable.ColIndex("protocol");
+constexpr int kInterval = kProtocolCostsTable.ColIndex("interval");
+constexpr int kParseTime = kProtocolCostsTable.ColIndex("parse_time");
+constexpr int kStitchTime = kProtocolCostsTable.ColIndex("stitch_time");
+constexpr int kAppendTime = kProtocolCostsTable.ColIndex("append_time");
+constexpr int kNumRecords = kProtocolCostsTable.ColIndex("num_records");
+constexpr int kNumConns = kProtocolCostsTable.ColIndex("num_conns");
+constexpr int kBufferBytes = kProtocolCostsTable.ColIndex("buffer_bytes");
+constexpr int kFrameBytes = kProtocolCostsTable.ColIndex("frame_bytes");
+
+}  // namespace protocol_costs_idx
+
+}  // namespace stirling
+}  // namespace px
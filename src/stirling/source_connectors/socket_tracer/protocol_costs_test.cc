@@ -0,0 +1,81 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocol_costs.h"
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+TEST(ProtocolCostsTest, AccumulatesPerProtocol) {
+  prometheus::Registry registry;
+  ProtocolCosts costs(&registry);
+
+  costs.BeginIteration();
+  costs.Add(kProtocolHTTP, {.parse_ns = 10,
+                            .stitch_ns = 20,
+                            .append_ns = 30,
+                            .num_records = 1,
+                            .buffer_bytes = 100,
+                            .frame_bytes = 200});
+  costs.Add(kProtocolHTTP, {.parse_ns = 1, .num_records = 2, .buffer_bytes = 5});
+  costs.Add(kProtocolMongo, {.parse_ns = 1000, .frame_bytes = 4096});
+  costs.EndIteration();
+
+  const ProtocolCosts::Stats& http = costs.stats(kProtocolHTTP);
+  EXPECT_EQ(http.parse_ns, 11);
+  EXPECT_EQ(http.stitch_ns, 20);
+  EXPECT_EQ(http.append_ns, 30);
+  EXPECT_EQ(http.num_records, 3);
+  EXPECT_EQ(http.num_conns, 2);
+  EXPECT_EQ(http.buffer_bytes, 105);
+  EXPECT_EQ(http.frame_bytes, 200);
+
+  const ProtocolCosts::Stats& mongo = costs.stats(kProtocolMongo);
+  EXPECT_EQ(mongo.parse_ns, 1000);
+  EXPECT_EQ(mongo.num_conns, 1);
+  EXPECT_EQ(mongo.frame_bytes, 4096);
+
+  EXPECT_EQ(costs.stats(kProtocolMySQL).num_conns, 0);
+}
+
+TEST(ProtocolCostsTest, HeldBytesAreOfTheLastIteration) {
+  prometheus::Registry registry;
+  ProtocolCosts costs(&registry);
+
+  costs.BeginIteration();
+  costs.Add(kProtocolHTTP, {.parse_ns = 10, .buffer_bytes = 100});
+  costs.EndIteration();
+
+  costs.BeginIteration();
+  costs.Add(kProtocolHTTP, {.parse_ns = 5, .buffer_bytes = 40});
+  costs.EndIteration();
+
+  // Times accumulate across iterations, held bytes don't.
+  EXPECT_EQ(costs.stats(kProtocolHTTP).parse_ns, 15);
+  EXPECT_EQ(costs.stats(kProtocolHTTP).buffer_bytes, 40);
+  EXPECT_EQ(costs.stats(kProtocolHTTP).num_conns, 1);
+
+  costs.ClearTimes();
+  EXPECT_EQ(costs.stats(kProtocolHTTP).parse_ns, 0);
+  EXPECT_EQ(costs.stats(kProtocolHTTP).buffer_bytes, 40);
+}
+
+}  // namespace stirling
+}  // namespace px
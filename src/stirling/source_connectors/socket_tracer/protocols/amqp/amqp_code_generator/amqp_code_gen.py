@@ -56,9 +56,9 @@ class FieldType(Enum):
             FieldType.short: "uint16_t",
             FieldType.long: "uint32_t",
             FieldType.longlong: "uint64_t",
-            FieldType.shortstr: "std::string",
-            FieldType.longstr: "std::string",
-            FieldType.table: "std::string",
+            FieldType.shortstr: "std::string_view",
+            FieldType.longstr: "std::string_view",
+            FieldType.table: "std::string_view",
             FieldType.timestamp: "time_t",
         }
 
@@ -265,18 +265,18 @@ class AMQPMethod:
         """
         return f"k{self.c_struct_name} = {self.method_id}"
 
-    def gen_method_enum_select_case(self, constant_enum_name):
+    def gen_method_extractor_entry(self, class_name):
         """
-        Case used to Select the correct method to extract. The generated form will be
-        switch (static_cast<AMQPChannelMethods>(method_id))
-            case AMQPChannelMethods::kAMQPChannelOpen:
-                return ExtractAMQPChannelOpen(decoder, req);
+        Entry of the method extractor table used to look up the method to extract. The generated
+        form will be
+        constexpr MethodExtractor kMethodExtractors[] = {
+            {AMQPClasses::kChannel, kAMQPChannelOpen, ExtractAMQPChannelOpen},
             ...
         """
-        return f"""
-            case {constant_enum_name}::k{self.c_struct_name}:
-                return Extract{self.c_struct_name}(decoder, req);
-        """
+        return (
+            f"{{AMQPClasses::k{class_name}, k{self.c_struct_name}, "
+            f"Extract{self.c_struct_name}}},"
+        )
 
     def get_class_buffer_extract(self):
         """
@@ -367,42 +367,26 @@ class AMQPClass:
             }};
             """
 
-    def gen_content_header_enum_select(self):
-        """
-        This will be included to easily select the extraction methods given class_id
-        switch (method_id) {
-            case AMQPConnectionMethods::kAMQPConnectionStart:
-                return ExtractAMQPConnectionStart(decoder, req);
+    def gen_content_header_extractor_entry(self):
         """
-        return f"""
-            case AMQPClasses::k{self.class_name}:
-                return Extract{self.content_header_method.c_struct_name}(decoder, req);
+        This will be included in the content header extractor table to look up the extraction
+        method given class_id
+        constexpr ContentHeaderExtractor kContentHeaderExtractors[] = {
+            {AMQPClasses::kConnection, ExtractAMQPConnectionContentHeader},
+            ...
         """
+        content_header_struct_name = self.content_header_method.c_struct_name
+        return f"{{AMQPClasses::k{self.class_name}, Extract{content_header_struct_name}}},"
 
-    def gen_method_select(self):
+    def gen_method_extractor_entries(self):
         """
-        This will select the relevant method to extract from the buffer for a specific class.
-        switch (static_cast<AMQPChannelMethods>(method_id))
-            case AMQPChannelMethods::kAMQPChannelOpen:
-                return ExtractAMQPChannelOpen(decoder, req);
+        The entries of the method extractor table for the methods of this class.
+            {AMQPClasses::kChannel, kAMQPChannelOpen, ExtractAMQPChannelOpen},
             ...
         """
-        method_cases = "\n".join(
-            [
-                method.gen_method_enum_select_case(self.constant_enum_name)
-                for method in self.methods
-            ]
+        return "\n".join(
+            [method.gen_method_extractor_entry(self.class_name) for method in self.methods]
         )
-        return f"""
-            Status Process{self.class_name}(BinaryDecoder *decoder, Frame *req, uint16_t  method_id) {{
-                switch(static_cast<{self.constant_enum_name}>(method_id)) {{
-                    {method_cases}
-                    default:
-                        VLOG(1) << absl::Substitute("Invalid {self.class_name} frame method $0", method_id);
-                }}
-                return Status::OK();
-            }}
-        """
 
     def gen_class_enum_declr(self):
         """
@@ -414,18 +398,6 @@ class AMQPClass:
         """
         return f"k{self.class_name} = {self.class_id}"
 
-    def gen_class_enum_select_case(self):
-        """
-        This will be included to easily select the extraction methods given class_id for Content Header Frame Type
-        switch (class_id) {
-            case AMQPConnectionMethods::kAMQPConnectionStart:
-                return ExtractAMQPConnectionStart(decoder, req);
-        """
-        return f"""
-            case AMQPClasses::k{self.class_name}:
-                return Process{self.class_name}(decoder, req, method_id);
-        """
-
 
 class CodeGenerator:
     """
@@ -649,42 +621,47 @@ class CodeGenerator:
             )
         return "\n".join(buffer_extract_methods)
 
-    def gen_method_select(self):
+    def gen_method_extractors(self):
         """
-        Generates all the method selectors for the AMQPClasses
+        Generates the entries of the table the method extraction methods are looked up in by
+        class_id and method_id.
         """
-        class_select_methods = []
-        for amqp_class in self.amqp_classes:
-            class_select_methods.append(amqp_class.gen_method_select())
-        return "\n".join(class_select_methods)
+        return "\n".join(
+            [amqp_class.gen_method_extractor_entries() for amqp_class in self.amqp_classes]
+        )
 
-    def gen_class_select(self):
+    def gen_content_header_extractors(self):
         """
-        Given a buffer, uses the class_id to find list of functions that can extract the buffer.
-        Given the class_id, a list of relevant methods to the AMQP class can be found via method_id.
+        Generates the entries of the table the content header extraction methods are looked up in
+        by class_id.
         """
+        return "\n".join(
+            [
+                amqp_class.gen_content_header_extractor_entry()
+                for amqp_class in self.amqp_classes
+            ]
+        )
 
-        amqp_extract_class_case = []
-        for amqp_class in self.amqp_classes:
-            amqp_extract_class_case.append(amqp_class.gen_class_enum_select_case())
-
-        amqp_extract_class_case_str = "\n".join(amqp_extract_class_case)
-        return f"""
-        Status ProcessFrameMethod(BinaryDecoder* decoder, Frame* req) {{
+    def gen_process_frame_method(self):
+        """
+        Given a buffer, uses the class_id and method_id to look up the method that can extract the
+        buffer.
+        """
+        return """
+        Status ProcessFrameMethod(BinaryDecoder* decoder, Frame* req) {
             PX_ASSIGN_OR_RETURN(uint16_t class_id, decoder->ExtractBEInt<uint16_t>());
             PX_ASSIGN_OR_RETURN(uint16_t method_id, decoder->ExtractBEInt<uint16_t>());
 
             req->class_id = class_id;
             req->method_id = method_id;
 
-            switch(static_cast<AMQPClasses>(class_id)) {{
-                {amqp_extract_class_case_str}
-                default:
-                    VLOG(1) << absl::Substitute("Unparsed frame method class $0 method $1", class_id, method_id);
-            }}
-
-            return Status::OK();
-        }}
+            Extractor extract = LookupMethodExtractor(class_id, method_id);
+            if (extract == nullptr) {
+                VLOG(1) << absl::Substitute("Unparsed frame method class $0 method $1", class_id, method_id);
+                return Status::OK();
+            }
+            return extract(decoder, req);
+        }
         """
 
     def gen_process_frame_type(self):
@@ -714,32 +691,27 @@ class CodeGenerator:
             return Status::OK();
         }"""
 
-    def gen_process_content_header_select(self):
+    def gen_process_content_header(self):
         """
-        Process the content header frame type by selecting the relevant content header extract method
+        Process the content header frame type by looking up the relevant content header extract
+        method
         """
-        amqp_extract_class_case = []
-        for amqp_class in self.amqp_classes:
-            amqp_class_case = amqp_class.gen_content_header_enum_select()
-            amqp_extract_class_case.append(amqp_class_case)
-
-        amqp_extract_class_case_str = "\n".join(amqp_extract_class_case)
-        return f"""
-        Status ProcessContentHeader(BinaryDecoder* decoder, Frame* req) {{
+        return """
+        Status ProcessContentHeader(BinaryDecoder* decoder, Frame* req) {
             PX_ASSIGN_OR_RETURN(uint16_t class_id, decoder->ExtractBEInt<uint16_t>());
             PX_ASSIGN_OR_RETURN(uint16_t weight, decoder->ExtractBEInt<uint16_t>());
             req->class_id = class_id;
 
-            if(weight != 0) {{
+            if(weight != 0) {
                 return error::Internal("AMQP content header weight should be 0");
-            }}
-            switch(static_cast<AMQPClasses>(class_id)) {{
-                {amqp_extract_class_case_str}
-                default:
-                    VLOG(1) << absl::Substitute("Unparsed content header class $0", class_id);
-            }}
-            return Status::OK();
-        }}
+            }
+            Extractor extract = LookupContentHeaderExtractor(class_id);
+            if (extract == nullptr) {
+                VLOG(1) << absl::Substitute("Unparsed content header class $0", class_id);
+                return Status::OK();
+            }
+            return extract(decoder, req);
+        }
         """
 
     def gen_class_id_to_class_name(self):
@@ -880,10 +852,10 @@ class CodeGeneratorWriter:
         Writes the buffer decoding in decoding.cc
         """
         process_class_methods = self.generator.gen_buffer_extract()
-        process_content_header = self.generator.gen_process_content_header_select()
-
-        process_method_type = self.generator.gen_method_select()
-        process_class_type = self.generator.gen_class_select()
+        method_extractors = self.generator.gen_method_extractors()
+        content_header_extractors = self.generator.gen_content_header_extractors()
+        process_content_header = self.generator.gen_process_content_header()
+        process_frame_method = self.generator.gen_process_frame_method()
         process_frame_type = self.generator.gen_process_frame_type()
 
         template = self.env.get_template("decode.cc.jinja_template")
@@ -891,11 +863,12 @@ class CodeGeneratorWriter:
         with self.decode_gen_path.open("w") as f:
             f.write(
                 template.render(
+                    process_class_methods=process_class_methods,
+                    method_extractors=method_extractors,
+                    content_header_extractors=content_header_extractors,
                     process_content_header=process_content_header,
+                    process_frame_method=process_frame_method,
                     process_frame_type=process_frame_type,
-                    process_class_type=process_class_type,
-                    process_method_type=process_method_type,
-                    process_class_methods=process_class_methods,
                 )
             )
 
@@ -165,14 +165,12 @@ class TestAMQPMethod(BaseTestCase):
             self.amqp_method.gen_method_enum_declr(), "kAMQPSampleClassSampleMethod = 1"
         )
 
-    def test_gen_method_enum_select_case(self):
+    def test_gen_method_extractor_entry(self):
         self.assertEqualGenStr(
-            self.amqp_method.gen_method_enum_select_case(
-                "Connection"
-            ),  # TODO PASS CLASS NAME HERE
+            self.amqp_method.gen_method_extractor_entry("SampleClass"),
             """
-            case Connection::kAMQPSampleClassSampleMethod:
-                return ExtractAMQPSampleClassSampleMethod(decoder, req);
+            {AMQPClasses::kSampleClass, kAMQPSampleClassSampleMethod,
+                ExtractAMQPSampleClassSampleMethod},
             """,
         )
 
@@ -211,40 +209,23 @@ class TestAMQPClass(BaseTestCase):
             """,
         )
 
-    def test_gen_method_select(self):
+    def test_gen_method_extractor_entries(self):
         self.assertEqualGenStr(
-            self.sample_class.gen_method_select(),
+            self.sample_class.gen_method_extractor_entries(),
             """
-            Status ProcessSampleClass(BinaryDecoder *decoder, Frame *req, uint16_t  method_id) {
-                switch(static_cast<AMQPSampleClassMethods>(method_id)) {
-                    case AMQPSampleClassMethods::kAMQPSampleclassSampleMethod:
-                        return ExtractAMQPSampleclassSampleMethod(decoder, req);
-                    default:
-                        VLOG(1)<<absl::Substitute("Invalid Sample Class frame method $0", method_id);
-                }
-                return Status::OK();
-            }
+            {AMQPClasses::kSampleClass, kAMQPSampleclassSampleMethod,
+                ExtractAMQPSampleclassSampleMethod},
             """,
         )
 
     def test_gen_class_enum_declr(self):
         self.assertEqual(self.sample_class.gen_class_enum_declr(), "kSampleClass = 0")
 
-    def test_gen_content_header_enum_select(self):
+    def test_gen_content_header_extractor_entry(self):
         self.assertEqualGenStr(
-            self.sample_class.gen_content_header_enum_select(),
+            self.sample_class.gen_content_header_extractor_entry(),
             """
-            case AMQPClasses::kSampleClass:
-                return ExtractAMQPSampleclassContentHeader(decoder, req);
-            """,
-        )
-
-    def test_gen_class_enum_select_case(self):
-        self.assertEqualGenStr(
-            self.sample_class.gen_class_enum_select_case(),
-            """
-            case AMQPClasses::kSampleClass:
-                return ProcessSampleClass(decoder, req, method_id);
+            {AMQPClasses::kSampleClass, ExtractAMQPSampleclassContentHeader},
             """,
         )
 
@@ -558,25 +539,25 @@ class TestAMQPCodeGeneratorGen(BaseTestCase):
             """,
         )
 
-    def test_gen_method_select(self):
+    def test_gen_method_extractors(self):
         self.assertEqualGenStr(
-            self.code_generator_single_class.gen_method_select(),
+            self.code_generator_single_class.gen_method_extractors(),
             """
-            Status ProcessConnection(BinaryDecoder *decoder, Frame *req, uint16_t  method_id) {
-                switch(static_cast<AMQPConnectionMethods>(method_id)) {
-                    case AMQPConnectionMethods::kAMQPConnectionStart:
-                        return ExtractAMQPConnectionStart(decoder, req);
-                    default:
-                        VLOG(1)<<absl::Substitute("Invalid Connection frame method $0", method_id);
-                }
-                returnStatus::OK();
-            }
+            {AMQPClasses::kConnection, kAMQPConnectionStart, ExtractAMQPConnectionStart},
+            """,
+        )
+
+    def test_gen_content_header_extractors(self):
+        self.assertEqualGenStr(
+            self.code_generator_single_class.gen_content_header_extractors(),
+            """
+            {AMQPClasses::kConnection, ExtractAMQPConnectionContentHeader},
             """,
         )
 
-    def test_gen_class_select(self):
+    def test_gen_process_frame_method(self):
         self.assertEqualGenStr(
-            self.code_generator_single_class.gen_class_select(),
+            self.code_generator_single_class.gen_process_frame_method(),
             """
             Status ProcessFrameMethod(BinaryDecoder* decoder, Frame* req) {
                 PX_ASSIGN_OR_RETURN(uint16_t class_id, decoder->ExtractBEInt<uint16_t>());
@@ -585,21 +566,20 @@ class TestAMQPCodeGeneratorGen(BaseTestCase):
                 req->class_id = class_id;
                 req->method_id = method_id;
 
-                switch(static_cast<AMQPClasses>(class_id)) {
-                    case AMQPClasses::kConnection:
-                        return ProcessConnection(decoder, req, method_id);
-                    default:
-                        VLOG(1)<<absl::Substitute("Unparsed frame method class $0 method $1", class_id, method_id);
+                Extractor extract = LookupMethodExtractor(class_id, method_id);
+                if (extract == nullptr) {
+                    VLOG(1)<<absl::Substitute("Unparsed frame method class $0 method $1", class_id, method_id);
+                    return Status::OK();
                 }
-                return Status::OK();
+                return extract(decoder, req);
             }
             """,
         )
 
-    def test_gen_process_content_header_select(self):
+    def test_gen_process_content_header(self):
         self.maxDiff = None
         self.assertEqualGenStr(
-            self.code_generator_single_class.gen_process_content_header_select(),
+            self.code_generator_single_class.gen_process_content_header(),
             """
             Status ProcessContentHeader(BinaryDecoder* decoder, Frame* req) {
                 PX_ASSIGN_OR_RETURN(uint16_t class_id, decoder->ExtractBEInt<uint16_t>());
@@ -608,13 +588,12 @@ class TestAMQPCodeGeneratorGen(BaseTestCase):
                 if(weight != 0) {
                     return error::Internal("AMQP content header weight should be 0");
                 }
-                switch(static_cast<AMQPClasses>(class_id)) {
-                    case AMQPClasses::kConnection:
-                        return ExtractAMQPConnectionContentHeader(decoder, req);
-                    default:
-                        VLOG(1)<<absl::Substitute("Unparsed content header class $0", class_id);
+                Extractor extract = LookupContentHeaderExtractor(class_id);
+                if (extract == nullptr) {
+                    VLOG(1)<<absl::Substitute("Unparsed content header class $0", class_id);
+                    return Status::OK();
                 }
-                return Status::OK();
+                return extract(decoder, req);
             }
             """,
         )
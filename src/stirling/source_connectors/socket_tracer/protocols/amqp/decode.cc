@@ -18,7 +18,9 @@
 // Code generated by AMQP protocol generator. DO NOT EDIT.
 #include "src/stirling/source_connectors/socket_tracer/protocols/amqp/decode.h"
 
+#include <array>
 #include <string>
+#include <string_view>
 
 #include "src/common/base/base.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/amqp/types_gen.h"
@@ -29,13 +31,15 @@ namespace stirling {
 namespace protocols {
 namespace amqp {
 
-StatusOr<std::string> ExtractShortString(BinaryDecoder* decoder) {
+// The strings are views into the frame being decoded, which outlives the decoded fields: they are
+// formatted into the frame's msg before the decoding of the frame returns.
+StatusOr<std::string_view> ExtractShortString(BinaryDecoder* decoder) {
   // Short string defined as 2*OCTET(short-uint)
   PX_ASSIGN_OR_RETURN(uint8_t len, decoder->ExtractBEInt<uint8_t>());
   return decoder->ExtractString(len);
 }
 
-StatusOr<std::string> ExtractLongString(BinaryDecoder* decoder) {
+StatusOr<std::string_view> ExtractLongString(BinaryDecoder* decoder) {
   // Long string defined as 4*OCTET(short-uint)
   PX_ASSIGN_OR_RETURN(uint32_t len, decoder->ExtractBEInt<uint32_t>());
   return decoder->ExtractString(len);
@@ -43,6 +47,9 @@ StatusOr<std::string> ExtractLongString(BinaryDecoder* decoder) {
 
 StatusOr<bool> ExtractNthBit(BinaryDecoder* decoder, int n) {
   // Extract Value at Nth bit
+  if (decoder->BufSize() == 0) {
+    return error::ResourceUnavailable("Not enough bytes for the AMQP bit field.");
+  }
   return decoder->Buf()[0] >> n & 1;
 }
 
@@ -695,244 +702,146 @@ Status ExtractAMQPTxContentHeader(BinaryDecoder* decoder, Frame* frame) {
   return Status::OK();
 }
 
-Status ProcessContentHeader(BinaryDecoder* decoder, Frame* req) {
-  PX_ASSIGN_OR_RETURN(uint16_t class_id, decoder->ExtractBEInt<uint16_t>());
-  PX_ASSIGN_OR_RETURN(uint16_t weight, decoder->ExtractBEInt<uint16_t>());
-  req->class_id = class_id;
-
-  if (weight != 0) {
-    return error::Internal("AMQP content header weight should be 0");
+// The decoding of method frames and content headers is table driven: the extractor of a frame is
+// looked up by its class and method ids, rather than going through a switch per class.
+namespace {
+
+using Extractor = Status (*)(BinaryDecoder* decoder, Frame* frame);
+
+struct MethodExtractor {
+  AMQPClasses class_id;
+  uint8_t method_id;
+  Extractor extract;
+};
+
+constexpr MethodExtractor kMethodExtractors[] = {
+    {AMQPClasses::kConnection, kAMQPConnectionStart, ExtractAMQPConnectionStart},
+    {AMQPClasses::kConnection, kAMQPConnectionStartOk, ExtractAMQPConnectionStartOk},
+    {AMQPClasses::kConnection, kAMQPConnectionSecure, ExtractAMQPConnectionSecure},
+    {AMQPClasses::kConnection, kAMQPConnectionSecureOk, ExtractAMQPConnectionSecureOk},
+    {AMQPClasses::kConnection, kAMQPConnectionTune, ExtractAMQPConnectionTune},
+    {AMQPClasses::kConnection, kAMQPConnectionTuneOk, ExtractAMQPConnectionTuneOk},
+    {AMQPClasses::kConnection, kAMQPConnectionOpen, ExtractAMQPConnectionOpen},
+    {AMQPClasses::kConnection, kAMQPConnectionOpenOk, ExtractAMQPConnectionOpenOk},
+    {AMQPClasses::kConnection, kAMQPConnectionClose, ExtractAMQPConnectionClose},
+    {AMQPClasses::kConnection, kAMQPConnectionCloseOk, ExtractAMQPConnectionCloseOk},
+    {AMQPClasses::kChannel, kAMQPChannelOpen, ExtractAMQPChannelOpen},
+    {AMQPClasses::kChannel, kAMQPChannelOpenOk, ExtractAMQPChannelOpenOk},
+    {AMQPClasses::kChannel, kAMQPChannelFlow, ExtractAMQPChannelFlow},
+    {AMQPClasses::kChannel, kAMQPChannelFlowOk, ExtractAMQPChannelFlowOk},
+    {AMQPClasses::kChannel, kAMQPChannelClose, ExtractAMQPChannelClose},
+    {AMQPClasses::kChannel, kAMQPChannelCloseOk, ExtractAMQPChannelCloseOk},
+    {AMQPClasses::kExchange, kAMQPExchangeDeclare, ExtractAMQPExchangeDeclare},
+    {AMQPClasses::kExchange, kAMQPExchangeDeclareOk, ExtractAMQPExchangeDeclareOk},
+    {AMQPClasses::kExchange, kAMQPExchangeDelete, ExtractAMQPExchangeDelete},
+    {AMQPClasses::kExchange, kAMQPExchangeDeleteOk, ExtractAMQPExchangeDeleteOk},
+    {AMQPClasses::kQueue, kAMQPQueueDeclare, ExtractAMQPQueueDeclare},
+    {AMQPClasses::kQueue, kAMQPQueueDeclareOk, ExtractAMQPQueueDeclareOk},
+    {AMQPClasses::kQueue, kAMQPQueueBind, ExtractAMQPQueueBind},
+    {AMQPClasses::kQueue, kAMQPQueueBindOk, ExtractAMQPQueueBindOk},
+    {AMQPClasses::kQueue, kAMQPQueueUnbind, ExtractAMQPQueueUnbind},
+    {AMQPClasses::kQueue, kAMQPQueueUnbindOk, ExtractAMQPQueueUnbindOk},
+    {AMQPClasses::kQueue, kAMQPQueuePurge, ExtractAMQPQueuePurge},
+    {AMQPClasses::kQueue, kAMQPQueuePurgeOk, ExtractAMQPQueuePurgeOk},
+    {AMQPClasses::kQueue, kAMQPQueueDelete, ExtractAMQPQueueDelete},
+    {AMQPClasses::kQueue, kAMQPQueueDeleteOk, ExtractAMQPQueueDeleteOk},
+    {AMQPClasses::kBasic, kAMQPBasicQos, ExtractAMQPBasicQos},
+    {AMQPClasses::kBasic, kAMQPBasicQosOk, ExtractAMQPBasicQosOk},
+    {AMQPClasses::kBasic, kAMQPBasicConsume, ExtractAMQPBasicConsume},
+    {AMQPClasses::kBasic, kAMQPBasicConsumeOk, ExtractAMQPBasicConsumeOk},
+    {AMQPClasses::kBasic, kAMQPBasicCancel, ExtractAMQPBasicCancel},
+    {AMQPClasses::kBasic, kAMQPBasicCancelOk, ExtractAMQPBasicCancelOk},
+    {AMQPClasses::kBasic, kAMQPBasicPublish, ExtractAMQPBasicPublish},
+    {AMQPClasses::kBasic, kAMQPBasicReturn, ExtractAMQPBasicReturn},
+    {AMQPClasses::kBasic, kAMQPBasicDeliver, ExtractAMQPBasicDeliver},
+    {AMQPClasses::kBasic, kAMQPBasicGet, ExtractAMQPBasicGet},
+    {AMQPClasses::kBasic, kAMQPBasicGetOk, ExtractAMQPBasicGetOk},
+    {AMQPClasses::kBasic, kAMQPBasicGetEmpty, ExtractAMQPBasicGetEmpty},
+    {AMQPClasses::kBasic, kAMQPBasicAck, ExtractAMQPBasicAck},
+    {AMQPClasses::kBasic, kAMQPBasicReject, ExtractAMQPBasicReject},
+    {AMQPClasses::kBasic, kAMQPBasicRecoverAsync, ExtractAMQPBasicRecoverAsync},
+    {AMQPClasses::kBasic, kAMQPBasicRecover, ExtractAMQPBasicRecover},
+    {AMQPClasses::kBasic, kAMQPBasicRecoverOk, ExtractAMQPBasicRecoverOk},
+    {AMQPClasses::kTx, kAMQPTxSelect, ExtractAMQPTxSelect},
+    {AMQPClasses::kTx, kAMQPTxSelectOk, ExtractAMQPTxSelectOk},
+    {AMQPClasses::kTx, kAMQPTxCommit, ExtractAMQPTxCommit},
+    {AMQPClasses::kTx, kAMQPTxCommitOk, ExtractAMQPTxCommitOk},
+    {AMQPClasses::kTx, kAMQPTxRollback, ExtractAMQPTxRollback},
+    {AMQPClasses::kTx, kAMQPTxRollbackOk, ExtractAMQPTxRollbackOk},
+};
+
+struct ContentHeaderExtractor {
+  AMQPClasses class_id;
+  Extractor extract;
+};
+
+constexpr ContentHeaderExtractor kContentHeaderExtractors[] = {
+    {AMQPClasses::kConnection, ExtractAMQPConnectionContentHeader},
+    {AMQPClasses::kChannel, ExtractAMQPChannelContentHeader},
+    {AMQPClasses::kExchange, ExtractAMQPExchangeContentHeader},
+    {AMQPClasses::kQueue, ExtractAMQPQueueContentHeader},
+    {AMQPClasses::kBasic, ExtractAMQPBasicContentHeader},
+    {AMQPClasses::kTx, ExtractAMQPTxContentHeader},
+};
+
+// Class ids are multiples of 10 below 100, and method ids are below 128.
+constexpr uint16_t kClassIdStep = 10;
+constexpr size_t kNumClassSlots = 10;
+constexpr size_t kNumMethodSlots = 128;
+
+// Returns the slot of the class id in the lookup tables, or kNumClassSlots if it has none.
+size_t ClassSlot(uint16_t class_id) {
+  if (class_id % kClassIdStep != 0 || class_id / kClassIdStep >= kNumClassSlots) {
+    return kNumClassSlots;
   }
-  switch (static_cast<AMQPClasses>(class_id)) {
-    case AMQPClasses::kConnection:
-      return ExtractAMQPConnectionContentHeader(decoder, req);
-
-    case AMQPClasses::kChannel:
-      return ExtractAMQPChannelContentHeader(decoder, req);
-
-    case AMQPClasses::kExchange:
-      return ExtractAMQPExchangeContentHeader(decoder, req);
-
-    case AMQPClasses::kQueue:
-      return ExtractAMQPQueueContentHeader(decoder, req);
-
-    case AMQPClasses::kBasic:
-      return ExtractAMQPBasicContentHeader(decoder, req);
-
-    case AMQPClasses::kTx:
-      return ExtractAMQPTxContentHeader(decoder, req);
-
-    default:
-      VLOG(1) << absl::Substitute("Unparsed content header class $0", class_id);
-  }
-  return Status::OK();
+  return class_id / kClassIdStep;
 }
 
-Status ProcessConnection(BinaryDecoder* decoder, Frame* req, uint16_t method_id) {
-  switch (static_cast<AMQPConnectionMethods>(method_id)) {
-    case AMQPConnectionMethods::kAMQPConnectionStart:
-      return ExtractAMQPConnectionStart(decoder, req);
-
-    case AMQPConnectionMethods::kAMQPConnectionStartOk:
-      return ExtractAMQPConnectionStartOk(decoder, req);
-
-    case AMQPConnectionMethods::kAMQPConnectionSecure:
-      return ExtractAMQPConnectionSecure(decoder, req);
-
-    case AMQPConnectionMethods::kAMQPConnectionSecureOk:
-      return ExtractAMQPConnectionSecureOk(decoder, req);
-
-    case AMQPConnectionMethods::kAMQPConnectionTune:
-      return ExtractAMQPConnectionTune(decoder, req);
-
-    case AMQPConnectionMethods::kAMQPConnectionTuneOk:
-      return ExtractAMQPConnectionTuneOk(decoder, req);
-
-    case AMQPConnectionMethods::kAMQPConnectionOpen:
-      return ExtractAMQPConnectionOpen(decoder, req);
-
-    case AMQPConnectionMethods::kAMQPConnectionOpenOk:
-      return ExtractAMQPConnectionOpenOk(decoder, req);
-
-    case AMQPConnectionMethods::kAMQPConnectionClose:
-      return ExtractAMQPConnectionClose(decoder, req);
-
-    case AMQPConnectionMethods::kAMQPConnectionCloseOk:
-      return ExtractAMQPConnectionCloseOk(decoder, req);
-
-    default:
-      VLOG(1) << absl::Substitute("Invalid Connection frame method $0", method_id);
-  }
-  return Status::OK();
-}
-
-Status ProcessChannel(BinaryDecoder* decoder, Frame* req, uint16_t method_id) {
-  switch (static_cast<AMQPChannelMethods>(method_id)) {
-    case AMQPChannelMethods::kAMQPChannelOpen:
-      return ExtractAMQPChannelOpen(decoder, req);
-
-    case AMQPChannelMethods::kAMQPChannelOpenOk:
-      return ExtractAMQPChannelOpenOk(decoder, req);
-
-    case AMQPChannelMethods::kAMQPChannelFlow:
-      return ExtractAMQPChannelFlow(decoder, req);
-
-    case AMQPChannelMethods::kAMQPChannelFlowOk:
-      return ExtractAMQPChannelFlowOk(decoder, req);
-
-    case AMQPChannelMethods::kAMQPChannelClose:
-      return ExtractAMQPChannelClose(decoder, req);
-
-    case AMQPChannelMethods::kAMQPChannelCloseOk:
-      return ExtractAMQPChannelCloseOk(decoder, req);
-
-    default:
-      VLOG(1) << absl::Substitute("Invalid Channel frame method $0", method_id);
-  }
-  return Status::OK();
-}
-
-Status ProcessExchange(BinaryDecoder* decoder, Frame* req, uint16_t method_id) {
-  switch (static_cast<AMQPExchangeMethods>(method_id)) {
-    case AMQPExchangeMethods::kAMQPExchangeDeclare:
-      return ExtractAMQPExchangeDeclare(decoder, req);
-
-    case AMQPExchangeMethods::kAMQPExchangeDeclareOk:
-      return ExtractAMQPExchangeDeclareOk(decoder, req);
-
-    case AMQPExchangeMethods::kAMQPExchangeDelete:
-      return ExtractAMQPExchangeDelete(decoder, req);
-
-    case AMQPExchangeMethods::kAMQPExchangeDeleteOk:
-      return ExtractAMQPExchangeDeleteOk(decoder, req);
-
-    default:
-      VLOG(1) << absl::Substitute("Invalid Exchange frame method $0", method_id);
+Extractor LookupMethodExtractor(uint16_t class_id, uint16_t method_id) {
+  using Table = std::array<std::array<Extractor, kNumMethodSlots>, kNumClassSlots>;
+  static const Table kTable = []() {
+    Table table = {};
+    for (const auto& entry : kMethodExtractors) {
+      table[ClassSlot(static_cast<uint16_t>(entry.class_id))][entry.method_id] = entry.extract;
+    }
+    return table;
+  }();
+  size_t slot = ClassSlot(class_id);
+  if (slot == kNumClassSlots || method_id >= kNumMethodSlots) {
+    return nullptr;
   }
-  return Status::OK();
+  return kTable[slot][method_id];
 }
 
-Status ProcessQueue(BinaryDecoder* decoder, Frame* req, uint16_t method_id) {
-  switch (static_cast<AMQPQueueMethods>(method_id)) {
-    case AMQPQueueMethods::kAMQPQueueDeclare:
-      return ExtractAMQPQueueDeclare(decoder, req);
-
-    case AMQPQueueMethods::kAMQPQueueDeclareOk:
-      return ExtractAMQPQueueDeclareOk(decoder, req);
-
-    case AMQPQueueMethods::kAMQPQueueBind:
-      return ExtractAMQPQueueBind(decoder, req);
-
-    case AMQPQueueMethods::kAMQPQueueBindOk:
-      return ExtractAMQPQueueBindOk(decoder, req);
-
-    case AMQPQueueMethods::kAMQPQueueUnbind:
-      return ExtractAMQPQueueUnbind(decoder, req);
-
-    case AMQPQueueMethods::kAMQPQueueUnbindOk:
-      return ExtractAMQPQueueUnbindOk(decoder, req);
-
-    case AMQPQueueMethods::kAMQPQueuePurge:
-      return ExtractAMQPQueuePurge(decoder, req);
-
-    case AMQPQueueMethods::kAMQPQueuePurgeOk:
-      return ExtractAMQPQueuePurgeOk(decoder, req);
-
-    case AMQPQueueMethods::kAMQPQueueDelete:
-      return ExtractAMQPQueueDelete(decoder, req);
-
-    case AMQPQueueMethods::kAMQPQueueDeleteOk:
-      return ExtractAMQPQueueDeleteOk(decoder, req);
-
-    default:
-      VLOG(1) << absl::Substitute("Invalid Queue frame method $0", method_id);
-  }
-  return Status::OK();
+Extractor LookupContentHeaderExtractor(uint16_t class_id) {
+  using Table = std::array<Extractor, kNumClassSlots>;
+  static const Table kTable = []() {
+    Table table = {};
+    for (const auto& entry : kContentHeaderExtractors) {
+      table[ClassSlot(static_cast<uint16_t>(entry.class_id))] = entry.extract;
+    }
+    return table;
+  }();
+  size_t slot = ClassSlot(class_id);
+  return slot == kNumClassSlots ? nullptr : kTable[slot];
 }
 
-Status ProcessBasic(BinaryDecoder* decoder, Frame* req, uint16_t method_id) {
-  switch (static_cast<AMQPBasicMethods>(method_id)) {
-    case AMQPBasicMethods::kAMQPBasicQos:
-      return ExtractAMQPBasicQos(decoder, req);
-
-    case AMQPBasicMethods::kAMQPBasicQosOk:
-      return ExtractAMQPBasicQosOk(decoder, req);
-
-    case AMQPBasicMethods::kAMQPBasicConsume:
-      return ExtractAMQPBasicConsume(decoder, req);
-
-    case AMQPBasicMethods::kAMQPBasicConsumeOk:
-      return ExtractAMQPBasicConsumeOk(decoder, req);
+}  // namespace
 
-    case AMQPBasicMethods::kAMQPBasicCancel:
-      return ExtractAMQPBasicCancel(decoder, req);
-
-    case AMQPBasicMethods::kAMQPBasicCancelOk:
-      return ExtractAMQPBasicCancelOk(decoder, req);
-
-    case AMQPBasicMethods::kAMQPBasicPublish:
-      return ExtractAMQPBasicPublish(decoder, req);
-
-    case AMQPBasicMethods::kAMQPBasicReturn:
-      return ExtractAMQPBasicReturn(decoder, req);
-
-    case AMQPBasicMethods::kAMQPBasicDeliver:
-      return ExtractAMQPBasicDeliver(decoder, req);
-
-    case AMQPBasicMethods::kAMQPBasicGet:
-      return ExtractAMQPBasicGet(decoder, req);
-
-    case AMQPBasicMethods::kAMQPBasicGetOk:
-      return ExtractAMQPBasicGetOk(decoder, req);
-
-    case AMQPBasicMethods::kAMQPBasicGetEmpty:
-      return ExtractAMQPBasicGetEmpty(decoder, req);
-
-    case AMQPBasicMethods::kAMQPBasicAck:
-      return ExtractAMQPBasicAck(decoder, req);
-
-    case AMQPBasicMethods::kAMQPBasicReject:
-      return ExtractAMQPBasicReject(decoder, req);
-
-    case AMQPBasicMethods::kAMQPBasicRecoverAsync:
-      return ExtractAMQPBasicRecoverAsync(decoder, req);
-
-    case AMQPBasicMethods::kAMQPBasicRecover:
-      return ExtractAMQPBasicRecover(decoder, req);
-
-    case AMQPBasicMethods::kAMQPBasicRecoverOk:
-      return ExtractAMQPBasicRecoverOk(decoder, req);
+Status ProcessContentHeader(BinaryDecoder* decoder, Frame* req) {
+  PX_ASSIGN_OR_RETURN(uint16_t class_id, decoder->ExtractBEInt<uint16_t>());
+  PX_ASSIGN_OR_RETURN(uint16_t weight, decoder->ExtractBEInt<uint16_t>());
+  req->class_id = class_id;
 
-    default:
-      VLOG(1) << absl::Substitute("Invalid Basic frame method $0", method_id);
+  if (weight != 0) {
+    return error::Internal("AMQP content header weight should be 0");
   }
-  return Status::OK();
-}
-
-Status ProcessTx(BinaryDecoder* decoder, Frame* req, uint16_t method_id) {
-  switch (static_cast<AMQPTxMethods>(method_id)) {
-    case AMQPTxMethods::kAMQPTxSelect:
-      return ExtractAMQPTxSelect(decoder, req);
-
-    case AMQPTxMethods::kAMQPTxSelectOk:
-      return ExtractAMQPTxSelectOk(decoder, req);
-
-    case AMQPTxMethods::kAMQPTxCommit:
-      return ExtractAMQPTxCommit(decoder, req);
-
-    case AMQPTxMethods::kAMQPTxCommitOk:
-      return ExtractAMQPTxCommitOk(decoder, req);
-
-    case AMQPTxMethods::kAMQPTxRollback:
-      return ExtractAMQPTxRollback(decoder, req);
-
-    case AMQPTxMethods::kAMQPTxRollbackOk:
-      return ExtractAMQPTxRollbackOk(decoder, req);
-
-    default:
-      VLOG(1) << absl::Substitute("Invalid Tx frame method $0", method_id);
+  Extractor extract = LookupContentHeaderExtractor(class_id);
+  if (extract == nullptr) {
+    VLOG(1) << absl::Substitute("Unparsed content header class $0", class_id);
+    return Status::OK();
   }
-  return Status::OK();
+  return extract(decoder, req);
 }
 
 Status ProcessFrameMethod(BinaryDecoder* decoder, Frame* req) {
@@ -942,30 +851,12 @@ Status ProcessFrameMethod(BinaryDecoder* decoder, Frame* req) {
   req->class_id = class_id;
   req->method_id = method_id;
 
-  switch (static_cast<AMQPClasses>(class_id)) {
-    case AMQPClasses::kConnection:
-      return ProcessConnection(decoder, req, method_id);
-
-    case AMQPClasses::kChannel:
-      return ProcessChannel(decoder, req, method_id);
-
-    case AMQPClasses::kExchange:
-      return ProcessExchange(decoder, req, method_id);
-
-    case AMQPClasses::kQueue:
-      return ProcessQueue(decoder, req, method_id);
-
-    case AMQPClasses::kBasic:
-      return ProcessBasic(decoder, req, method_id);
-
-    case AMQPClasses::kTx:
-      return ProcessTx(decoder, req, method_id);
-
-    default:
-      VLOG(1) << absl::Substitute("Unparsed frame method class $0 method $1", class_id, method_id);
+  Extractor extract = LookupMethodExtractor(class_id, method_id);
+  if (extract == nullptr) {
+    VLOG(1) << absl::Substitute("Unparsed frame method class $0 method $1", class_id, method_id);
+    return Status::OK();
   }
-
-  return Status::OK();
+  return extract(decoder, req);
 }
 
 Status ProcessPayload(Frame* req, BinaryDecoder* decoder) {
@@ -55,6 +55,10 @@ INSTANTIATE_TEST_SUITE_P(
                                                "\x6e\x66\x67\x44\x73\x63\x32\xce"),
                         "frame_type=[3] channel=[1] payload_size=[10] msg=[]"),
 
+        std::make_tuple("unknown_basic_method",
+                        CreateStringView<char>("\x01\x00\x01\x00\x00\x00\x04\x00\x3c\x00\x63\xce"),
+                        "frame_type=[1] channel=[1] payload_size=[4] msg=[]"),
+
         std::make_tuple(
             "content_header_basic",
             CreateStringView<char>("\x02\x00\x01\x00\x00\x00\x19\x00\x3c\x00\x00\x00\x00"
@@ -18,6 +18,10 @@
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/always_contiguous_data_stream_buffer_impl.h"
 
+#include <string>
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/double_mapped_ring_buffer.h"
+
 namespace px {
 namespace stirling {
 namespace protocols {
@@ -38,7 +42,8 @@ typename TMapType::const_iterator MapLE(const TMapType& map, size_t key) {
 
 }  // namespace
 
-void AlwaysContiguousDataStreamBufferImpl::Reset() {
+template <typename TBuffer>
+void BasicAlwaysContiguousDataStreamBufferImpl<TBuffer>::Reset() {
   buffer_.clear();
   chunks_.clear();
   timestamps_.clear();
@@ -46,7 +51,17 @@ void AlwaysContiguousDataStreamBufferImpl::Reset() {
   ShrinkToFit();
 }
 
-bool AlwaysContiguousDataStreamBufferImpl::CheckOverlap(size_t pos, size_t size) {
+template <typename TBuffer>
+void BasicAlwaysContiguousDataStreamBufferImpl<TBuffer>::Clear() {
+  buffer_.clear();
+  chunks_.clear();
+  timestamps_.clear();
+  position_ = 0;
+  prev_timestamp_ = 0;
+}
+
+template <typename TBuffer>
+bool BasicAlwaysContiguousDataStreamBufferImpl<TBuffer>::CheckOverlap(size_t pos, size_t size) {
   bool left_overlap = false;
   bool right_overlap = false;
 
@@ -85,7 +100,8 @@ bool AlwaysContiguousDataStreamBufferImpl::CheckOverlap(size_t pos, size_t size)
   return left_overlap || right_overlap;
 }
 
-void AlwaysContiguousDataStreamBufferImpl::AddNewChunk(size_t pos, size_t size) {
+template <typename TBuffer>
+void BasicAlwaysContiguousDataStreamBufferImpl<TBuffer>::AddNewChunk(size_t pos, size_t size) {
   // Look for the chunks to the left and right of this new chunk.
   auto r_iter = chunks_.lower_bound(pos);
   auto l_iter = r_iter;
@@ -131,12 +147,15 @@ void AlwaysContiguousDataStreamBufferImpl::AddNewChunk(size_t pos, size_t size)
   }
 }
 
-void AlwaysContiguousDataStreamBufferImpl::AddNewTimestamp(size_t pos, uint64_t timestamp) {
+template <typename TBuffer>
+void BasicAlwaysContiguousDataStreamBufferImpl<TBuffer>::AddNewTimestamp(size_t pos,
+                                                                         uint64_t timestamp) {
   timestamps_[pos] = timestamp;
 }
 
-void AlwaysContiguousDataStreamBufferImpl::Add(size_t pos, std::string_view data,
-                                               uint64_t timestamp) {
+template <typename TBuffer>
+void BasicAlwaysContiguousDataStreamBufferImpl<TBuffer>::Add(size_t pos, std::string_view data,
+                                                             uint64_t timestamp) {
   if (data.size() > capacity_) {
     size_t oversize_amount = data.size() - capacity_;
     data.remove_prefix(oversize_amount);
@@ -244,8 +263,9 @@ void AlwaysContiguousDataStreamBufferImpl::Add(size_t pos, std::string_view data
   }
 }
 
-std::map<size_t, size_t>::const_iterator AlwaysContiguousDataStreamBufferImpl::GetChunkForPos(
-    size_t pos) const {
+template <typename TBuffer>
+std::map<size_t, size_t>::const_iterator
+BasicAlwaysContiguousDataStreamBufferImpl<TBuffer>::GetChunkForPos(size_t pos) const {
   // Get chunk which is <= pos.
   auto iter = MapLE(chunks_, pos);
   if (iter == chunks_.cend()) {
@@ -263,8 +283,9 @@ std::map<size_t, size_t>::const_iterator AlwaysContiguousDataStreamBufferImpl::G
   return iter;
 }
 
-void AlwaysContiguousDataStreamBufferImpl::EnforceTimestampMonotonicity(size_t pos,
-                                                                        size_t chunk_end) {
+template <typename TBuffer>
+void BasicAlwaysContiguousDataStreamBufferImpl<TBuffer>::EnforceTimestampMonotonicity(
+    size_t pos, size_t chunk_end) {
   // Get timestamp for chunk which is <= pos.
   auto it = timestamps_.upper_bound(pos);
   if (it == timestamps_.begin()) {
@@ -287,7 +308,8 @@ void AlwaysContiguousDataStreamBufferImpl::EnforceTimestampMonotonicity(size_t p
   }
 }
 
-std::string_view AlwaysContiguousDataStreamBufferImpl::Get(size_t pos) {
+template <typename TBuffer>
+std::string_view BasicAlwaysContiguousDataStreamBufferImpl<TBuffer>::Get(size_t pos) {
   auto iter = GetChunkForPos(pos);
   if (iter == chunks_.cend()) {
     return {};
@@ -309,7 +331,9 @@ std::string_view AlwaysContiguousDataStreamBufferImpl::Get(size_t pos) {
   return std::string_view(buffer_.data() + ppos, bytes_available);
 }
 
-StatusOr<uint64_t> AlwaysContiguousDataStreamBufferImpl::GetTimestamp(size_t pos) const {
+template <typename TBuffer>
+StatusOr<uint64_t> BasicAlwaysContiguousDataStreamBufferImpl<TBuffer>::GetTimestamp(
+    size_t pos) const {
   // Ensure the specified time corresponds to a real chunk.
   if (GetChunkForPos(pos) == chunks_.cend()) {
     return error::Internal("Specified position not found");
@@ -330,12 +354,14 @@ StatusOr<uint64_t> AlwaysContiguousDataStreamBufferImpl::GetTimestamp(size_t pos
   return iter->second;
 }
 
-void AlwaysContiguousDataStreamBufferImpl::CleanupMetadata() {
+template <typename TBuffer>
+void BasicAlwaysContiguousDataStreamBufferImpl<TBuffer>::CleanupMetadata() {
   CleanupChunks();
   CleanupTimestamps();
 }
 
-void AlwaysContiguousDataStreamBufferImpl::CleanupChunks() {
+template <typename TBuffer>
+void BasicAlwaysContiguousDataStreamBufferImpl<TBuffer>::CleanupChunks() {
   // Find and remove irrelevant metadata in `chunks_`.
 
   // Get chunk which is <= position_.
@@ -373,7 +399,8 @@ void AlwaysContiguousDataStreamBufferImpl::CleanupChunks() {
   }
 }
 
-void AlwaysContiguousDataStreamBufferImpl::CleanupTimestamps() {
+template <typename TBuffer>
+void BasicAlwaysContiguousDataStreamBufferImpl<TBuffer>::CleanupTimestamps() {
   // Find and remove irrelevant metadata in `timestamps_`.
 
   // Get timestamp which is <= position_.
@@ -389,7 +416,8 @@ void AlwaysContiguousDataStreamBufferImpl::CleanupTimestamps() {
   DCHECK(!timestamps_.empty());
 }
 
-void AlwaysContiguousDataStreamBufferImpl::RemovePrefix(ssize_t n) {
+template <typename TBuffer>
+void BasicAlwaysContiguousDataStreamBufferImpl<TBuffer>::RemovePrefix(ssize_t n) {
   // Check for positive values of n.
   // For safety in production code, just return.
   DCHECK_GE(n, 0);
@@ -403,7 +431,8 @@ void AlwaysContiguousDataStreamBufferImpl::RemovePrefix(ssize_t n) {
   CleanupMetadata();
 }
 
-void AlwaysContiguousDataStreamBufferImpl::Trim() {
+template <typename TBuffer>
+void BasicAlwaysContiguousDataStreamBufferImpl<TBuffer>::Trim() {
   if (chunks_.empty()) {
     return;
   }
@@ -416,7 +445,8 @@ void AlwaysContiguousDataStreamBufferImpl::Trim() {
   position_ += trim_size;
 }
 
-size_t AlwaysContiguousDataStreamBufferImpl::EndPosition() {
+template <typename TBuffer>
+size_t BasicAlwaysContiguousDataStreamBufferImpl<TBuffer>::EndPosition() {
   size_t end_position = position_;
   if (!chunks_.empty()) {
     auto last_chunk = std::prev(chunks_.end());
@@ -425,7 +455,8 @@ size_t AlwaysContiguousDataStreamBufferImpl::EndPosition() {
   return end_position;
 }
 
-std::string AlwaysContiguousDataStreamBufferImpl::DebugInfo() const {
+template <typename TBuffer>
+std::string BasicAlwaysContiguousDataStreamBufferImpl<TBuffer>::DebugInfo() const {
   std::string s;
 
   absl::StrAppend(&s, absl::Substitute("Position: $0\n", position_));
@@ -438,11 +469,16 @@ std::string AlwaysContiguousDataStreamBufferImpl::DebugInfo() const {
   for (const auto& [pos, timestamp] : timestamps_) {
     absl::StrAppend(&s, absl::Substitute("  position:$0 timestamp:$1\n", pos, timestamp));
   }
-  absl::StrAppend(&s, absl::Substitute("Buffer: $0\n", buffer_));
+  absl::StrAppend(&s, absl::Substitute("Buffer: $0\n",
+                                       std::string_view(buffer_.data(), buffer_.size())));
 
   return s;
 }
 
+// Explicitly instantiate the backing stores in use, so the definitions can stay out of the header.
+template class BasicAlwaysContiguousDataStreamBufferImpl<std::string>;
+template class BasicAlwaysContiguousDataStreamBufferImpl<DoubleMappedRingBuffer>;
+
 }  // namespace protocols
 }  // namespace stirling
 }  // namespace px
@@ -27,10 +27,15 @@ namespace px {
 namespace stirling {
 namespace protocols {
 
-class AlwaysContiguousDataStreamBufferImpl : public DataStreamBufferImpl {
+// DataStreamBufferImpl that keeps all data, including gaps, in a single contiguous buffer.
+// TBuffer is the backing store, and must provide the subset of the std::string interface used here.
+// With std::string, RemovePrefix() and Trim() shift the remaining data to the front of the buffer;
+// with DoubleMappedRingBuffer they only advance the head.
+template <typename TBuffer>
+class BasicAlwaysContiguousDataStreamBufferImpl : public DataStreamBufferImpl {
  public:
-  AlwaysContiguousDataStreamBufferImpl(size_t max_capacity, size_t max_gap_size,
-                                       size_t allow_before_gap_size)
+  BasicAlwaysContiguousDataStreamBufferImpl(size_t max_capacity, size_t max_gap_size,
+                                            size_t allow_before_gap_size)
       : capacity_(max_capacity),
         max_gap_size_(max_gap_size),
         allow_before_gap_size_(allow_before_gap_size) {}
@@ -57,6 +62,8 @@ class AlwaysContiguousDataStreamBufferImpl : public DataStreamBufferImpl {
 
   void Reset() override;
 
+  void Clear() override;
+
   void ShrinkToFit() override { buffer_.shrink_to_fit(); }
 
  private:
@@ -92,8 +99,7 @@ class AlwaysContiguousDataStreamBufferImpl : public DataStreamBufferImpl {
   size_t position_ = 0;
 
   // Buffer where all data is stored.
-  // TODO(oazizi): Investigate buffer that is better suited to the rolling buffer (slinky) model.
-  std::string buffer_;
+  TBuffer buffer_;
 
   // Map of chunk start positions to chunk sizes.
   // A chunk is a contiguous sequence of bytes.
@@ -107,6 +113,8 @@ class AlwaysContiguousDataStreamBufferImpl : public DataStreamBufferImpl {
   size_t prev_timestamp_ = 0;
 };
 
+using AlwaysContiguousDataStreamBufferImpl = BasicAlwaysContiguousDataStreamBufferImpl<std::string>;
+
 }  // namespace protocols
 }  // namespace stirling
 }  // namespace px
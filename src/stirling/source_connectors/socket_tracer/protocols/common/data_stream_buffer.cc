@@ -21,6 +21,7 @@
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/always_contiguous_data_stream_buffer_impl.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/data_stream_buffer.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/lazy_contiguous_data_stream_buffer_impl.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/ring_data_stream_buffer_impl.h"
 
 #include <algorithm>
 #include <deque>
@@ -34,6 +35,11 @@
 DEFINE_bool(stirling_data_stream_buffer_always_contiguous_buffer,
             gflags::BoolFromEnv("PL_STIRLING_DATA_STREAM_BUFFER_ALWAYS_CONTIGUOUS_BUFFER", true),
             "Flip flag to use alternative DataStreamBuffer implementation");
+DEFINE_bool(stirling_data_stream_buffer_ring_buffer,
+            gflags::BoolFromEnv("PL_STIRLING_DATA_STREAM_BUFFER_RING_BUFFER", false),
+            "If true, use the DataStreamBuffer implementation backed by a double-mapped ring "
+            "buffer, which consumes data without copying. Takes precedence over "
+            "--stirling_data_stream_buffer_always_contiguous_buffer.");
 
 namespace px {
 namespace stirling {
@@ -41,7 +47,10 @@ namespace protocols {
 
 DataStreamBuffer::DataStreamBuffer(size_t max_capacity, size_t max_gap_size,
                                    size_t allow_before_gap_size) {
-  if (FLAGS_stirling_data_stream_buffer_always_contiguous_buffer) {
+  if (FLAGS_stirling_data_stream_buffer_ring_buffer) {
+    impl_ = std::unique_ptr<DataStreamBufferImpl>(
+        new RingDataStreamBufferImpl(max_capacity, max_gap_size, allow_before_gap_size));
+  } else if (FLAGS_stirling_data_stream_buffer_always_contiguous_buffer) {
     impl_ = std::unique_ptr<DataStreamBufferImpl>(new AlwaysContiguousDataStreamBufferImpl(
         max_capacity, max_gap_size, allow_before_gap_size));
   } else {
@@ -27,6 +27,7 @@
 #include "src/common/base/base.h"
 
 DECLARE_bool(stirling_data_stream_buffer_always_contiguous_buffer);
+DECLARE_bool(stirling_data_stream_buffer_ring_buffer);
 
 namespace px {
 namespace stirling {
@@ -48,6 +49,7 @@ class DataStreamBufferImpl {
   virtual size_t position() const = 0;
   virtual std::string DebugInfo() const = 0;
   virtual void Reset() = 0;
+  virtual void Clear() = 0;
   virtual void ShrinkToFit() = 0;
 };
 
@@ -140,6 +142,12 @@ class DataStreamBuffer {
    */
   void Reset() { impl_->Reset(); }
 
+  /**
+   * Empties the buffer as though it were newly constructed, but keeps its allocated memory.
+   * Used to recycle the buffer for another connection.
+   */
+  void Clear() { impl_->Clear(); }
+
   /**
    * Shrink the internal buffer, so that the allocated memory matches its size.
    * Note this has to be an external API, because `RemovePrefix` is called in situations where it
@@ -19,11 +19,14 @@
 #include <benchmark/benchmark.h>
 
 #include <random>
+#include <string>
+#include <vector>
 
 #include "src/common/base/base.h"
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/always_contiguous_data_stream_buffer_impl.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/lazy_contiguous_data_stream_buffer_impl.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/ring_data_stream_buffer_impl.h"
 
 template <typename TDataStreamBufferImpl>
 // NOLINTNEXTLINE : runtime/references.
@@ -229,8 +232,112 @@ static void BM_RemovePrefix(benchmark::State& state) {
   }
 }
 
+// A stream of frames, as a parser would consume them.
+struct Traffic {
+  std::string data;
+  std::vector<size_t> frame_sizes;
+};
+
+// HTTP/1.1 responses with chunked bodies of varying sizes, typical of streaming JSON APIs.
+static Traffic GenChunkedHTTPTraffic(size_t total_size) {
+  std::minstd_rand0 gen(0);
+  std::uniform_int_distribution<size_t> num_chunks_dist(1, 16);
+  std::uniform_int_distribution<size_t> chunk_size_dist(64, 8 * 1024);
+
+  Traffic traffic;
+  while (traffic.data.size() < total_size) {
+    std::string msg =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/json\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n";
+    size_t num_chunks = num_chunks_dist(gen);
+    for (size_t i = 0; i < num_chunks; ++i) {
+      size_t chunk_size = chunk_size_dist(gen);
+      absl::StrAppend(&msg, absl::Hex(chunk_size), "\r\n", std::string(chunk_size, 'x'), "\r\n");
+    }
+    absl::StrAppend(&msg, "0\r\n\r\n");
+
+    traffic.data += msg;
+    traffic.frame_sizes.push_back(msg.size());
+  }
+  return traffic;
+}
+
+// Kafka requests: a 4-byte length prefix followed by the payload. Mostly small metadata and fetch
+// requests, with occasional large produce batches.
+static Traffic GenKafkaTraffic(size_t total_size) {
+  std::minstd_rand0 gen(0);
+  std::uniform_int_distribution<size_t> small_size_dist(32, 512);
+  std::uniform_int_distribution<size_t> large_size_dist(16 * 1024, 256 * 1024);
+  std::uniform_int_distribution<int> large_dist(0, 9);
+
+  Traffic traffic;
+  while (traffic.data.size() < total_size) {
+    size_t payload_size = large_dist(gen) == 0 ? large_size_dist(gen) : small_size_dist(gen);
+    uint32_t len = payload_size;
+    char len_bytes[] = {static_cast<char>(len >> 24), static_cast<char>(len >> 16),
+                        static_cast<char>(len >> 8), static_cast<char>(len)};
+    traffic.data.append(len_bytes, sizeof(len_bytes));
+    traffic.data.append(payload_size, 'k');
+    traffic.frame_sizes.push_back(sizeof(len_bytes) + payload_size);
+  }
+  return traffic;
+}
+
+// Feeds the traffic into the buffer in writes of state.range(0) bytes, as they would arrive from
+// BPF, and after every write consumes all the complete frames at the head, as the parsers would.
+template <typename TDataStreamBufferImpl>
+// NOLINTNEXTLINE : runtime/references.
+static void RunTraffic(benchmark::State& state, const Traffic& traffic) {
+  size_t capacity = 50 * 1024 * 1024;
+  size_t max_gap_size = 10 * 1024 * 1024;
+  size_t allow_before_gap_size = 1 * 1024 * 1024;
+
+  size_t write_size = state.range(0);
+  std::string_view data = traffic.data;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    TDataStreamBufferImpl stream_buffer(capacity, max_gap_size, allow_before_gap_size);
+    state.ResumeTiming();
+
+    size_t frame_idx = 0;
+    uint64_t ts = 0;
+    for (size_t pos = 0; pos < data.size(); pos += write_size) {
+      stream_buffer.Add(pos, data.substr(pos, write_size), ts++);
+
+      std::string_view head = stream_buffer.Head();
+      while (frame_idx < traffic.frame_sizes.size() &&
+             head.size() >= traffic.frame_sizes[frame_idx]) {
+        size_t frame_size = traffic.frame_sizes[frame_idx];
+        benchmark::DoNotOptimize(head.substr(0, frame_size));
+        stream_buffer.RemovePrefix(frame_size);
+        head = stream_buffer.Head();
+        ++frame_idx;
+      }
+    }
+  }
+  state.SetBytesProcessed(static_cast<uint64_t>(state.iterations()) * data.size());
+}
+
+template <typename TDataStreamBufferImpl>
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ChunkedHTTPTraffic(benchmark::State& state) {
+  static const Traffic traffic = GenChunkedHTTPTraffic(16 * 1024 * 1024);
+  RunTraffic<TDataStreamBufferImpl>(state, traffic);
+}
+
+template <typename TDataStreamBufferImpl>
+// NOLINTNEXTLINE : runtime/references.
+static void BM_KafkaTraffic(benchmark::State& state) {
+  static const Traffic traffic = GenKafkaTraffic(16 * 1024 * 1024);
+  RunTraffic<TDataStreamBufferImpl>(state, traffic);
+}
+
 using px::stirling::protocols::AlwaysContiguousDataStreamBufferImpl;
 using px::stirling::protocols::LazyContiguousDataStreamBufferImpl;
+using px::stirling::protocols::RingDataStreamBufferImpl;
 
 BENCHMARK_TEMPLATE(BM_ContiguousBytes, LazyContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
@@ -238,9 +345,13 @@ BENCHMARK_TEMPLATE(BM_ContiguousBytes, LazyContiguousDataStreamBufferImpl)
 BENCHMARK_TEMPLATE(BM_ContiguousBytes, AlwaysContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
     ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ContiguousBytes, RingDataStreamBufferImpl)
+    ->Range(1024, 32 * 1024)
+    ->Unit(benchmark::kMillisecond);
 
 BENCHMARK_TEMPLATE(BM_SingleAdd, LazyContiguousDataStreamBufferImpl)->Range(1024, 32 * 1024);
 BENCHMARK_TEMPLATE(BM_SingleAdd, AlwaysContiguousDataStreamBufferImpl)->Range(1024, 32 * 1024);
+BENCHMARK_TEMPLATE(BM_SingleAdd, RingDataStreamBufferImpl)->Range(1024, 32 * 1024);
 
 BENCHMARK_TEMPLATE(BM_OoOBytes, LazyContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
@@ -248,6 +359,9 @@ BENCHMARK_TEMPLATE(BM_OoOBytes, LazyContiguousDataStreamBufferImpl)
 BENCHMARK_TEMPLATE(BM_OoOBytes, AlwaysContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
     ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_OoOBytes, RingDataStreamBufferImpl)
+    ->Range(1024, 32 * 1024)
+    ->Unit(benchmark::kMillisecond);
 
 BENCHMARK_TEMPLATE(BM_OverrunCapacity, LazyContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
@@ -255,6 +369,9 @@ BENCHMARK_TEMPLATE(BM_OverrunCapacity, LazyContiguousDataStreamBufferImpl)
 BENCHMARK_TEMPLATE(BM_OverrunCapacity, AlwaysContiguousDataStreamBufferImpl)
     ->Range(32 * 1024, 32 * 1024)
     ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_OverrunCapacity, RingDataStreamBufferImpl)
+    ->Range(32 * 1024, 32 * 1024)
+    ->Unit(benchmark::kMillisecond);
 
 BENCHMARK_TEMPLATE(BM_LargeGap, LazyContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
@@ -262,6 +379,9 @@ BENCHMARK_TEMPLATE(BM_LargeGap, LazyContiguousDataStreamBufferImpl)
 BENCHMARK_TEMPLATE(BM_LargeGap, AlwaysContiguousDataStreamBufferImpl)
     ->Range(32 * 1024, 32 * 1024)
     ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_LargeGap, RingDataStreamBufferImpl)
+    ->Range(32 * 1024, 32 * 1024)
+    ->Unit(benchmark::kMillisecond);
 
 BENCHMARK_TEMPLATE(BM_RemovePrefix, LazyContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
@@ -269,3 +389,26 @@ BENCHMARK_TEMPLATE(BM_RemovePrefix, LazyContiguousDataStreamBufferImpl)
 BENCHMARK_TEMPLATE(BM_RemovePrefix, AlwaysContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
     ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_RemovePrefix, RingDataStreamBufferImpl)
+    ->Range(1024, 32 * 1024)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_ChunkedHTTPTraffic, LazyContiguousDataStreamBufferImpl)
+    ->Range(512, 16 * 1024)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ChunkedHTTPTraffic, AlwaysContiguousDataStreamBufferImpl)
+    ->Range(512, 16 * 1024)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ChunkedHTTPTraffic, RingDataStreamBufferImpl)
+    ->Range(512, 16 * 1024)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_KafkaTraffic, LazyContiguousDataStreamBufferImpl)
+    ->Range(512, 16 * 1024)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_KafkaTraffic, AlwaysContiguousDataStreamBufferImpl)
+    ->Range(512, 16 * 1024)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_KafkaTraffic, RingDataStreamBufferImpl)
+    ->Range(512, 16 * 1024)
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,165 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/double_mapped_ring_buffer.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+namespace {
+
+size_t RoundUpToPageSize(size_t n) {
+  static const size_t kPageSize = sysconf(_SC_PAGESIZE);
+  return (n + kPageSize - 1) / kPageSize * kPageSize;
+}
+
+// Maps the same ring_size bytes of a memfd twice, back-to-back.
+// Returns nullptr if any step fails.
+char* MapDoubleRing(size_t ring_size) {
+  int fd = memfd_create("stirling_data_stream_buffer", MFD_CLOEXEC);
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  char* base = nullptr;
+  if (ftruncate(fd, ring_size) == 0) {
+    // Reserve a contiguous address range for both views first, so the fixed mappings below
+    // cannot clobber anything else.
+    void* addr =
+        mmap(nullptr, 2 * ring_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, /*fd*/ -1, 0);
+    if (addr != MAP_FAILED) {
+      base = static_cast<char*>(addr);
+      void* first =
+          mmap(base, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, /*offset*/ 0);
+      void* second = mmap(base + ring_size, ring_size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_FIXED, fd, /*offset*/ 0);
+      if (first == MAP_FAILED || second == MAP_FAILED) {
+        munmap(base, 2 * ring_size);
+        base = nullptr;
+      }
+    }
+  }
+
+  // The mappings keep the memory alive; the descriptor is no longer needed.
+  close(fd);
+  return base;
+}
+
+}  // namespace
+
+DoubleMappedRingBuffer::~DoubleMappedRingBuffer() { Release(); }
+
+DoubleMappedRingBuffer::DoubleMappedRingBuffer(DoubleMappedRingBuffer&& other) noexcept {
+  *this = std::move(other);
+}
+
+DoubleMappedRingBuffer& DoubleMappedRingBuffer::operator=(DoubleMappedRingBuffer&& other) noexcept {
+  if (this != &other) {
+    Release();
+    base_ = std::exchange(other.base_, nullptr);
+    ring_size_ = std::exchange(other.ring_size_, 0);
+    double_mapped_ = std::exchange(other.double_mapped_, false);
+    head_ = std::exchange(other.head_, 0);
+    size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
+void DoubleMappedRingBuffer::resize(size_t n) {
+  if (n > ring_size_) {
+    Reallocate(n);
+  } else if (!double_mapped_ && head_ + n > 2 * ring_size_) {
+    // Without the aliased second view, the head eventually runs off the end of the allocation.
+    // Compacting only then keeps removal from the front amortized O(1).
+    memmove(base_, data(), size_);
+    head_ = 0;
+  }
+  size_ = n;
+}
+
+void DoubleMappedRingBuffer::erase(size_t pos, size_t n) {
+  DCHECK_EQ(pos, 0U);
+  n = std::min(n, size_);
+  size_ -= n;
+  if (size_ == 0) {
+    head_ = 0;
+    return;
+  }
+  head_ += n;
+  if (double_mapped_ && head_ >= ring_size_) {
+    head_ -= ring_size_;
+  }
+}
+
+void DoubleMappedRingBuffer::shrink_to_fit() {
+  if (size_ == 0) {
+    Release();
+  }
+}
+
+void DoubleMappedRingBuffer::Reallocate(size_t min_size) {
+  size_t ring_size = RoundUpToPageSize(std::max(min_size, 2 * ring_size_));
+
+  char* base = MapDoubleRing(ring_size);
+  bool double_mapped = (base != nullptr);
+  if (!double_mapped) {
+    LOG_FIRST_N(WARNING, 1) << "Could not double-map ring buffer, falling back to flat buffer.";
+    void* addr = mmap(nullptr, 2 * ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                      /*fd*/ -1, 0);
+    CHECK(addr != MAP_FAILED) << "Failed to allocate ring buffer of size " << ring_size;
+    base = static_cast<char*>(addr);
+  }
+
+  if (size_ > 0) {
+    memcpy(base, data(), size_);
+  }
+  size_t size = size_;
+  Release();
+
+  base_ = base;
+  ring_size_ = ring_size;
+  double_mapped_ = double_mapped;
+  head_ = 0;
+  size_ = size;
+}
+
+void DoubleMappedRingBuffer::Release() {
+  if (base_ != nullptr) {
+    munmap(base_, 2 * ring_size_);
+  }
+  base_ = nullptr;
+  ring_size_ = 0;
+  double_mapped_ = false;
+  head_ = 0;
+  size_ = 0;
+}
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <string_view>
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+/**
+ * A byte buffer with O(1) removal from the front, built on a ring of pages that is mapped twice,
+ * back-to-back, in virtual memory. Since the second mapping aliases the first, any range of up to
+ * capacity() bytes starting anywhere in the ring is contiguous, so data() can always be handed out
+ * as a single string_view, even after the data has wrapped around.
+ *
+ * The interface mirrors the subset of std::string used by the DataStreamBuffer implementations,
+ * so it can be dropped in as their backing store. Growing beyond capacity() remaps into a larger
+ * ring; bytes exposed by resize() are uninitialized.
+ *
+ * If the double mapping cannot be set up (e.g. memfd_create is unavailable), the buffer falls back
+ * to a flat allocation of twice the ring size, which is compacted only when the head runs off the
+ * end of it.
+ */
+class DoubleMappedRingBuffer {
+ public:
+  DoubleMappedRingBuffer() = default;
+  ~DoubleMappedRingBuffer();
+
+  DoubleMappedRingBuffer(DoubleMappedRingBuffer&& other) noexcept;
+  DoubleMappedRingBuffer& operator=(DoubleMappedRingBuffer&& other) noexcept;
+  DoubleMappedRingBuffer(const DoubleMappedRingBuffer&) = delete;
+  DoubleMappedRingBuffer& operator=(const DoubleMappedRingBuffer&) = delete;
+
+  char* data() { return base_ + head_; }
+  const char* data() const { return base_ + head_; }
+
+  size_t size() const { return size_; }
+  size_t capacity() const { return ring_size_; }
+  bool empty() const { return size_ == 0; }
+
+  /**
+   * Changes the number of bytes held. When growing, the new bytes are uninitialized.
+   */
+  void resize(size_t n);
+
+  /**
+   * Removes n bytes from the front of the buffer in O(1). Only pos == 0 is supported.
+   */
+  void erase(size_t pos, size_t n);
+
+  void clear() { size_ = 0; }
+
+  /**
+   * Returns the ring to the OS if the buffer is empty.
+   */
+  void shrink_to_fit();
+
+  operator std::string_view() const { return std::string_view(data(), size_); }
+
+  bool double_mapped() const { return double_mapped_; }
+
+ private:
+  // Maps a new ring of at least min_size bytes, and moves the current contents to its front.
+  void Reallocate(size_t min_size);
+  void Release();
+
+  // Start of the mapping. With double mapping, [base_, base_ + ring_size_) and
+  // [base_ + ring_size_, base_ + 2 * ring_size_) are views of the same pages.
+  char* base_ = nullptr;
+  size_t ring_size_ = 0;
+  bool double_mapped_ = false;
+
+  // Offset of the first byte in the buffer, relative to base_.
+  size_t head_ = 0;
+  size_t size_ = 0;
+};
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
@@ -81,6 +81,9 @@ struct ParseResult {
   int invalid_frames;
   // Total number of bytes parsed into valid frames.
   size_t frame_bytes;
+  // If state is kNeedsMoreData, the size of the incomplete frame at end_position, if known
+  // (see FrameSizeHint()), otherwise 0.
+  size_t incomplete_frame_size = 0;
 };
 
 /**
@@ -124,6 +127,7 @@ ParseResult<TKey> ParseFrames(message_type_t type, DataStreamBuffer* data_stream
 
   // Maintain a map of previous sizes.
   absl::flat_hash_map<TKey, size_t> prev_sizes;
+  prev_sizes.reserve(frames->size());
   for (const auto& [stream_id, deque] : *frames) {
     prev_sizes[stream_id] = deque.size();
   }
@@ -144,13 +148,14 @@ ParseResult<TKey> ParseFrames(message_type_t type, DataStreamBuffer* data_stream
   // Match timestamps with the parsed frames.
   for (auto& [stream_id, positions] : result.frame_positions) {
     size_t offset = prev_sizes[stream_id];  // Retrieve the initial offset for this stream_id
+    std::deque<TFrameType>& stream_frames = (*frames)[stream_id];
 
     for (auto& f : positions) {
       f.start += start_pos;
       f.end += start_pos;
 
       // Retrieve the message using the current offset
-      auto& msg = (*frames)[stream_id][offset];
+      auto& msg = stream_frames[offset];
       offset++;
       StatusOr<uint64_t> timestamp_ns_status =
           data_stream_buffer->GetTimestamp(data_stream_buffer->position() + f.end);
@@ -185,11 +190,22 @@ ParseResult<TKey> ParseFramesLoop(message_type_t type, std::string_view buf,
   ParseState s = ParseState::kSuccess;
   size_t bytes_processed = 0;
   size_t frame_bytes = 0;
+  size_t incomplete_frame_size = 0;
   int invalid_count = 0;
 
+  // Consecutive frames mostly belong to the same stream (always, for protocols without streams),
+  // so the containers of the last stream are kept at hand instead of being looked up in both maps
+  // for every frame. Both are looked up again whenever the stream changes, which is also the only
+  // time either map is inserted into.
+  TKey stream_key{};
+  std::deque<TFrameType>* stream_frames = nullptr;
+  std::vector<StartEndPos>* stream_positions = nullptr;
+
   while (!buf.empty() && s != ParseState::kEOS) {
     TFrameType frame;
 
+    // ParseFrame() may consume part of the frame before finding out it needs more data.
+    const std::string_view frame_buf = buf;
     s = ParseFrame(type, &buf, &frame, state);
 
     bool stop = false;
@@ -197,6 +213,7 @@ ParseResult<TKey> ParseFramesLoop(message_type_t type, std::string_view buf,
     switch (s) {
       case ParseState::kNeedsMoreData:
         // Can't process any more frames.
+        incomplete_frame_size = FrameSizeHint<TFrameType>(type, frame_buf);
         stop = true;
         break;
       case ParseState::kInvalid: {
@@ -240,13 +257,18 @@ ParseResult<TKey> ParseFramesLoop(message_type_t type, std::string_view buf,
     if (push) {
       // GetStreamID returns 0 by default if not implemented in protocol.
       TKey key = GetStreamID<TKey, TFrameType>(&frame);
-      frame_positions[key].push_back({start_position, end_position});
-      (*frames)[key].push_back(std::move(frame));
+      if (stream_frames == nullptr || key != stream_key) {
+        stream_key = key;
+        stream_frames = &(*frames)[key];
+        stream_positions = &frame_positions[key];
+      }
+      stream_positions->push_back({start_position, end_position});
+      stream_frames->push_back(std::move(frame));
       frame_bytes += (end_position - start_position) + 1;
     }
   }
   return ParseResult<TKey>{std::move(frame_positions), bytes_processed, s, invalid_count,
-                           frame_bytes};
+                           frame_bytes, incomplete_frame_size};
 }
 
 }  // namespace protocols
@@ -112,6 +112,23 @@ template <typename TFrameType, typename TStateType = NoState>
 ParseState ParseFrame(message_type_t type, std::string_view* buf, TFrameType* frame,
                       TStateType* state = nullptr);
 
+/**
+ * Returns the total size of the frame at the start of buf, once its header tells it. After a
+ * ParseFrame() that needs more data, the frame is not parsed again until the stream has buffered
+ * that many bytes, instead of on every new event. The size must never exceed the bytes that
+ * ParseFrame() needs to succeed.
+ *
+ * @tparam TFrameType Type of frame to parse.
+ * @param type Whether the frame is a request or a response.
+ * @param buf The raw data, starting at the frame.
+ * @return The size of the frame, or 0 if it is unknown. Protocols that don't specialize this
+ * always return 0, so their incomplete frames are parsed again on every new event.
+ */
+template <typename TFrameType>
+size_t FrameSizeHint(message_type_t /*type*/, std::string_view /*buf*/) {
+  return 0;
+}
+
 /**
  * Returns the stream ID of the given frame.
  *
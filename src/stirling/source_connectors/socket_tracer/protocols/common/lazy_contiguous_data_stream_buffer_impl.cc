@@ -269,6 +269,12 @@ void LazyContiguousDataStreamBufferImpl::Reset() {
   events_size_ = 0;
 }
 
+void LazyContiguousDataStreamBufferImpl::Clear() {
+  Reset();
+  head_position_ = 0;
+  prev_timestamp_ = 0;
+}
+
 void LazyContiguousDataStreamBufferImpl::ShrinkToFit() {
   if (head_ == nullptr) {
     return;
@@ -87,6 +87,9 @@ class LazyContiguousDataStreamBufferImpl : public DataStreamBufferImpl {
 
   void Reset() override;
 
+  // The head buffer is sized to its contents, so there is no memory worth keeping.
+  void Clear() override;
+
   void Trim() override {}
 
   void ShrinkToFit() override;
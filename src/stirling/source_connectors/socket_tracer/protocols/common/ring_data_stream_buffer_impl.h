@@ -0,0 +1,36 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/always_contiguous_data_stream_buffer_impl.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/double_mapped_ring_buffer.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+// Same semantics as AlwaysContiguousDataStreamBufferImpl, but backed by a double-mapped ring,
+// so consuming data with RemovePrefix() or Trim() is O(1) instead of shifting the remaining bytes,
+// and Head() still returns a single view across the ring's wraparound point.
+using RingDataStreamBufferImpl = BasicAlwaysContiguousDataStreamBufferImpl<DoubleMappedRingBuffer>;
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
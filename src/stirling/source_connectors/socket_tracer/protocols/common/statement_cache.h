@@ -0,0 +1,149 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <limits>
+#include <list>
+#include <utility>
+
+#include <absl/container/flat_hash_map.h>
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+/**
+ * StatementCache holds the prepared statements of a connection, keyed by statement ID (MySQL) or
+ * name (PgSQL). Applications that prepare statements dynamically, without closing them, would
+ * otherwise grow the state of their connections without bound. So the least recently used
+ * statements are evicted once there are more than max_statements, or once their byte size, as
+ * given to Put(), exceeds max_bytes. Executing an evicted statement is then handled like executing
+ * one whose prepare was missed.
+ *
+ * Unlike px::LRUCache, it's copyable, as the protocol states are held in a std::any.
+ */
+template <typename TKey, typename TValue>
+class StatementCache {
+ public:
+  static constexpr size_t kDefaultMaxStatements = 1024;
+  static constexpr size_t kDefaultMaxBytes = 1024 * 1024;
+
+  explicit StatementCache(size_t max_statements = kDefaultMaxStatements,
+                          size_t max_bytes = kDefaultMaxBytes)
+      : max_statements_(max_statements), max_bytes_(max_bytes) {}
+
+  StatementCache(const StatementCache& other)
+      : max_statements_(other.max_statements_), max_bytes_(other.max_bytes_) {
+    *this = other;
+  }
+
+  StatementCache& operator=(const StatementCache& other) {
+    if (this == &other) {
+      return *this;
+    }
+    max_statements_ = other.max_statements_;
+    max_bytes_ = other.max_bytes_;
+    clear();
+    // Insert from the least recently used, to keep the order.
+    for (auto it = other.entries_.rbegin(); it != other.entries_.rend(); ++it) {
+      Put(it->key, it->value, it->byte_size);
+    }
+    num_evicted_ = other.num_evicted_;
+    return *this;
+  }
+
+  /**
+   * Returns the statement and marks it as the most recently used, or nullptr if it isn't cached.
+   * The pointer is valid until the next Put() or Erase().
+   */
+  const TValue* Get(const TKey& key) {
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+      return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return &it->second->value;
+  }
+
+  bool Contains(const TKey& key) const { return index_.contains(key); }
+
+  /**
+   * Inserts or replaces the statement, then evicts the least recently used statements beyond the
+   * limits. A statement larger than max_bytes by itself is not cached.
+   */
+  void Put(const TKey& key, TValue value, size_t byte_size) {
+    Erase(key);
+    if (byte_size > max_bytes_) {
+      ++num_evicted_;
+      return;
+    }
+    entries_.push_front(Entry{key, std::move(value), byte_size});
+    index_.emplace(key, entries_.begin());
+    byte_size_ += byte_size;
+
+    while (entries_.size() > max_statements_ || byte_size_ > max_bytes_) {
+      byte_size_ -= entries_.back().byte_size;
+      index_.erase(entries_.back().key);
+      entries_.pop_back();
+      ++num_evicted_;
+    }
+  }
+
+  bool Erase(const TKey& key) {
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+      return false;
+    }
+    byte_size_ -= it->second->byte_size;
+    entries_.erase(it->second);
+    index_.erase(it);
+    return true;
+  }
+
+  void clear() {
+    entries_.clear();
+    index_.clear();
+    byte_size_ = 0;
+  }
+
+  size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+  size_t byte_size() const { return byte_size_; }
+  size_t num_evicted() const { return num_evicted_; }
+
+ private:
+  struct Entry {
+    TKey key;
+    TValue value;
+    size_t byte_size;
+  };
+
+  size_t max_statements_;
+  size_t max_bytes_;
+
+  // Ordered from the most to the least recently used.
+  std::list<Entry> entries_;
+  absl::flat_hash_map<TKey, typename std::list<Entry>::iterator> index_;
+  size_t byte_size_ = 0;
+  size_t num_evicted_ = 0;
+};
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
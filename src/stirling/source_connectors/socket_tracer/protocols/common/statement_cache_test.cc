@@ -0,0 +1,86 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/statement_cache.h"
+
+#include <string>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+TEST(StatementCacheTest, EvictsLeastRecentlyUsed) {
+  StatementCache<int, std::string> cache(/*max_statements*/ 2);
+  cache.Put(1, "SELECT 1", 8);
+  cache.Put(2, "SELECT 2", 8);
+  // Using 1 makes 2 the least recently used statement.
+  ASSERT_NE(cache.Get(1), nullptr);
+  cache.Put(3, "SELECT 3", 8);
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.Get(2), nullptr);
+  EXPECT_EQ(*cache.Get(1), "SELECT 1");
+  EXPECT_EQ(*cache.Get(3), "SELECT 3");
+  EXPECT_EQ(cache.num_evicted(), 1);
+}
+
+TEST(StatementCacheTest, BoundedBytes) {
+  StatementCache<std::string, std::string> cache(/*max_statements*/ 100, /*max_bytes*/ 20);
+  cache.Put("a", "SELECT a", 9);
+  cache.Put("b", "SELECT b", 9);
+  EXPECT_EQ(cache.byte_size(), 18);
+
+  // Replacing a statement accounts for the new size.
+  cache.Put("b", "SELECT bb", 10);
+  EXPECT_EQ(cache.byte_size(), 19);
+
+  cache.Put("c", "SELECT c", 9);
+  EXPECT_FALSE(cache.Contains("a"));
+  EXPECT_EQ(cache.byte_size(), 19);
+
+  // Statements larger than the whole cache are not cached.
+  cache.Put("d", std::string(21, 'd'), 21);
+  EXPECT_FALSE(cache.Contains("d"));
+  EXPECT_EQ(cache.size(), 2);
+
+  EXPECT_TRUE(cache.Erase("b"));
+  EXPECT_FALSE(cache.Erase("b"));
+  EXPECT_EQ(cache.byte_size(), 9);
+}
+
+TEST(StatementCacheTest, Copy) {
+  StatementCache<int, std::string> cache(/*max_statements*/ 2);
+  cache.Put(1, "SELECT 1", 8);
+  cache.Put(2, "SELECT 2", 8);
+
+  StatementCache<int, std::string> copy = cache;
+  cache.clear();
+  EXPECT_EQ(copy.size(), 2);
+  EXPECT_EQ(copy.byte_size(), 16);
+
+  // The copy keeps the order of use, and the limits.
+  copy.Put(3, "SELECT 3", 8);
+  EXPECT_FALSE(copy.Contains(1));
+  EXPECT_TRUE(copy.Contains(2));
+}
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
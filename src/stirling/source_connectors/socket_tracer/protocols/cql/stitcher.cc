@@ -24,6 +24,7 @@
 #include <utility>
 
 #include "src/common/base/base.h"
+#include "src/common/base/str_builder.h"
 #include "src/common/json/json.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/cql/frame_body_decoder.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/cql/types.h"
@@ -39,6 +40,16 @@ namespace {
 std::string BytesToString(std::basic_string_view<uint8_t> x) {
   return px::BytesToString<bytes_format::HexCompact>(CreateStringView<char>(x));
 }
+
+// Appends the values as a JSON array of hex strings. This is what ToJSONString() makes of a
+// vector of the BytesToString() values, without building the vector. Hex digits need no escaping.
+void AppendHexValues(const std::vector<NameValuePair>& values, StrBuilder* sb) {
+  sb->Append("[");
+  sb->AppendJoin(values, ",", [](StrBuilder* out, const NameValuePair& v) {
+    out->Append("\"", BytesToString(v.value), "\"");
+  });
+  sb->Append("]");
+}
 }  // namespace
 
 Status ProcessStartupReq(Frame* req_frame, Request* req) {
@@ -82,22 +93,20 @@ Status ProcessRegisterReq(Frame* req_frame, Request* req) {
 Status ProcessQueryReq(Frame* req_frame, Request* req) {
   PX_ASSIGN_OR_RETURN(QueryReq r, ParseQueryReq(req_frame));
 
+  CTX_DCHECK(req->msg.empty());
+  if (r.qp.values.empty()) {
+    req->msg = std::move(r.query);
+    return Status::OK();
+  }
+
   // TODO(oazizi): This is just a placeholder.
   // Real implementation should figure out what type each value is, and cast into the appropriate
   // type. This, however, will be hard unless we have observed the preceding Prepare request.
-  std::vector<std::string> hex_values;
-  for (const auto& value_i : r.qp.values) {
-    hex_values.push_back(BytesToString(value_i.value));
-  }
-
-  CTX_DCHECK(req->msg.empty());
-  req->msg = r.query;
-
   // For now, just tag the parameter values to the end.
-  if (!hex_values.empty()) {
-    absl::StrAppend(&req->msg, "\n");
-    absl::StrAppend(&req->msg, ToJSONString(hex_values));
-  }
+  StrBuilder sb;
+  sb.Append(r.query, "\n");
+  AppendHexValues(r.qp.values, &sb);
+  req->msg = sb.Release();
 
   return Status::OK();
 }
@@ -117,13 +126,10 @@ Status ProcessExecuteReq(Frame* req_frame, Request* req) {
   // TODO(oazizi): This is just a placeholder.
   // Real implementation should figure out what type each value is, and cast into the appropriate
   // type. This, however, will be hard unless we have observed the preceding Prepare request.
-  std::vector<std::string> hex_values;
-  for (const auto& value_i : r.qp.values) {
-    hex_values.push_back(BytesToString(value_i.value));
-  }
-
   CTX_DCHECK(req->msg.empty());
-  req->msg = ToJSONString(hex_values);
+  StrBuilder sb;
+  AppendHexValues(r.qp.values, &sb);
+  req->msg = sb.Release();
 
   return Status::OK();
 }
@@ -177,6 +177,20 @@ StatusOr<Record> ProcessReqRespPair(const Frame& req_frame, const Frame& resp_fr
   ProcessReq(req_frame, &r.req);
   ProcessResp(resp_frame, &r.resp);
 
+  // Answers that follow CNAMEs are for the alias, so name the addresses after what was asked for.
+  // The first answer is for the queried name when the request's question wasn't parsed.
+  if (!req_frame.records().empty()) {
+    r.query_name = req_frame.records().front().name;
+  } else if (!resp_frame.records().empty()) {
+    r.query_name = resp_frame.records().front().name;
+  }
+  for (const auto& record : resp_frame.records()) {
+    if (record.cname.empty() && (record.addr.family == InetAddrFamily::kIPv4 ||
+                                 record.addr.family == InetAddrFamily::kIPv6)) {
+      r.resolved_addrs.push_back(record.addr);
+    }
+  }
+
   return r;
 }
 
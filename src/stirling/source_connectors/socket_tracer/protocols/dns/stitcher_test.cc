@@ -110,6 +110,36 @@ TEST(DnsStitcherTest, RecordOutput) {
             R"({"txid":0,"qr":1,"opcode":0,"aa":0,"tc":0,"rd":1,"ra":1,"ad":0,"cd":0,"rcode":0,)"
             R"("num_queries":1,"num_answers":1,"num_auth":0,"num_addl":0})");
   EXPECT_EQ(record.resp.msg, R"({"answers":[{"name":"pixie.ai","type":"A","addr":"1.2.3.4"}]})");
+
+  EXPECT_EQ(record.query_name, "pixie.ai");
+  ASSERT_EQ(record.resolved_addrs.size(), 1);
+  EXPECT_EQ(record.resolved_addrs[0].AddrStr(), "1.2.3.4");
+}
+
+TEST(DnsStitcherTest, ResolvedAddrsAreNamedAfterQuery) {
+  std::deque<Frame> req_frames;
+  std::deque<Frame> resp_frames;
+
+  InetAddr ip_addr;
+  ip_addr.family = InetAddrFamily::kIPv4;
+  struct in_addr addr_tmp;
+  PX_CHECK_OK(ParseIPv4Addr("1.2.3.4", &addr_tmp));
+  ip_addr.addr = addr_tmp;
+
+  Frame req_frame = CreateReqFrame(1, 0);
+  req_frame.AddRecords({DNSRecord{"www.pixie.ai", "", {}}});
+  req_frames.push_back(req_frame);
+  resp_frames.push_back(CreateRespFrame(2, 0,
+                                        {DNSRecord{"www.pixie.ai", "pixie.ai", {}},
+                                         DNSRecord{"pixie.ai", "", ip_addr}}));
+
+  RecordsWithErrorCount<Record> result =
+      StitchFrames(&req_frames, &resp_frames, FLAGS_include_respless_dns_requests);
+  ASSERT_EQ(result.records.size(), 1);
+  const Record& record = result.records.front();
+  EXPECT_EQ(record.query_name, "www.pixie.ai");
+  ASSERT_EQ(record.resolved_addrs.size(), 1);
+  EXPECT_EQ(record.resolved_addrs[0].AddrStr(), "1.2.3.4");
 }
 
 TEST(DnsStitcherTest, OutOfOrderMatching) {
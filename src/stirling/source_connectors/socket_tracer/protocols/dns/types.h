@@ -153,6 +153,11 @@ struct Record {
   Request req;
   Response resp;
 
+  // The name that was looked up, and the addresses that the answers resolved it to. They aren't
+  // exported to the table, but fill the hostname cache that queries name addresses with.
+  std::string query_name;
+  std::vector<InetAddr> resolved_addrs;
+
   std::string ToString() const {
     return absl::Substitute("req=[$0] resp=[$1]", req.ToString(), resp.ToString());
   }
@@ -24,6 +24,8 @@
 #include <utility>
 #include <vector>
 
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/scan.h"
+
 DEFINE_bool(use_pico_chunked_decoder, false,
             "If true, uses picohttpparser's chunked decoder; otherwise uses our custom decoder.");
 
@@ -62,7 +64,7 @@ ParseState ExtractChunkLength(std::string_view* data, size_t* out) {
   // (e.g. Apache sets an 8K limit for headers).
   constexpr int kSearchWindow = 2048;
 
-  size_t delimiter_pos = data->substr(0, kSearchWindow).find("\r\n");
+  size_t delimiter_pos = FindCRLF(data->substr(0, kSearchWindow));
   if (delimiter_pos == data->npos) {
     return data->length() > kSearchWindow ? ParseState::kInvalid : ParseState::kNeedsMoreData;
   }
@@ -177,7 +179,7 @@ ParseState CustomParseChunked(std::string_view* buf, size_t body_size_limit_byte
     // so use that as a proxy of the maximum trailer size we can expect.
     constexpr int kSearchWindow = 8192;
 
-    size_t pos = data.substr(0, kSearchWindow).find("\r\n\r\n");
+    size_t pos = FindHeaderEnd(data.substr(0, kSearchWindow));
     if (pos == data.npos) {
       return data.length() > kSearchWindow ? ParseState::kInvalid : ParseState::kNeedsMoreData;
     }
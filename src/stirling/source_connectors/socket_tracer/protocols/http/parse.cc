@@ -18,6 +18,7 @@
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/http/parse.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/http/body_decoder.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/scan.h"
 
 #include <picohttpparser.h>
 
@@ -199,7 +200,9 @@ ParseState ParseResponseBody(std::string_view* buf, Message* result, State* stat
   // TODO(yzhao): For now we just accumulate messages, let probe_close() submit a message to
   // perf buffer, so that we can terminate such messages.
   if (state->conn_closed) {
-    result->body = *buf;
+    // Like the other cases, only copy as much of the body as will be kept.
+    result->body = buf->substr(0, FLAGS_http_body_limit_bytes);
+    result->body_size = buf->size();
     buf->remove_prefix(buf->size());
 
     LOG_FIRST_N(WARNING, 10)
@@ -324,7 +327,7 @@ size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start
   // Note that we don't search forwards for HTTP/1.1 directly, because it could result in matches
   // inside the request/response body.
   while (true) {
-    size_t marker_pos = buf.find(kBoundaryMarker, start_pos);
+    size_t marker_pos = FindHeaderEnd(buf, start_pos);
 
     if (marker_pos == std::string::npos) {
       return std::string::npos;
@@ -332,27 +335,71 @@ size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start
 
     std::string_view buf_substr = buf.substr(start_pos, marker_pos - start_pos);
 
-    size_t substr_pos = std::string::npos;
-    for (auto& start_pattern : *start_patterns) {
-      size_t current_substr_pos = buf_substr.rfind(start_pattern);
-      if (current_substr_pos != std::string::npos) {
-        // Found a match. Check if it is closer to the marker than our previous match.
-        // We want to return the match that is closest to the marker, so we aren't
-        // matching to something in a previous message's body.
-        substr_pos = (substr_pos == std::string::npos) ? current_substr_pos
-                                                       : std::max(substr_pos, current_substr_pos);
+    // We want the match that is closest to the marker, so we aren't matching to something in a
+    // previous message's body. So search backwards, in one pass for all patterns, and only compare
+    // the patterns at the positions that hold the first byte of one of them.
+    for (size_t substr_pos = buf_substr.size(); substr_pos-- > 0;) {
+      char c = buf_substr[substr_pos];
+      for (auto& start_pattern : *start_patterns) {
+        if (c == start_pattern.front() &&
+            buf_substr.substr(substr_pos, start_pattern.size()) == start_pattern) {
+          return start_pos + substr_pos;
+        }
       }
     }
 
-    if (substr_pos != std::string::npos) {
-      return start_pos + substr_pos;
-    }
-
     // Couldn't find a start position. Move to the marker, and search for another marker.
     start_pos = marker_pos + kBoundaryMarker.size();
   }
 }
 
+// Only messages with a Content-Length have a known size; chunked bodies are left to the parser.
+size_t FrameSizeHint(message_type_t type, std::string_view buf) {
+  int headers_size = -1;
+  const phr_header* headers = nullptr;
+  size_t num_headers = 0;
+  pico_wrapper::HTTPRequest req;
+  pico_wrapper::HTTPResponse resp;
+  switch (type) {
+    case message_type_t::kRequest:
+      headers_size = pico_wrapper::ParseRequest(buf, &req);
+      headers = req.headers;
+      num_headers = req.num_headers;
+      break;
+    case message_type_t::kResponse:
+      headers_size = pico_wrapper::ParseResponse(buf, &resp);
+      headers = resp.headers;
+      num_headers = resp.num_headers;
+      break;
+    default:
+      return 0;
+  }
+  if (headers_size < 0) {
+    return 0;
+  }
+
+  // A response to a HEAD request has no body, which ParseResponseBody() detects when the next
+  // response arrives. So wait for enough of the body to tell it apart from the next response.
+  std::string_view body = buf.substr(headers_size);
+  if (type == message_type_t::kResponse &&
+      (body.size() < std::string_view("HTTP").size() || absl::StartsWith(body, "HTTP"))) {
+    return 0;
+  }
+
+  for (size_t i = 0; i < num_headers; ++i) {
+    std::string_view name(headers[i].name, headers[i].name_len);
+    if (absl::EqualsIgnoreCase(name, kContentLength)) {
+      size_t content_length;
+      if (!absl::SimpleAtoi(std::string_view(headers[i].value, headers[i].value_len),
+                            &content_length)) {
+        return 0;
+      }
+      return headers_size + content_length;
+    }
+  }
+  return 0;
+}
+
 }  // namespace http
 
 template <>
@@ -367,6 +414,11 @@ size_t FindFrameBoundary<http::Message>(message_type_t type, std::string_view bu
   return http::FindFrameBoundary(type, buf, start_pos);
 }
 
+template <>
+size_t FrameSizeHint<http::Message>(message_type_t type, std::string_view buf) {
+  return http::FrameSizeHint(type, buf);
+}
+
 }  // namespace protocols
 }  // namespace stirling
 }  // namespace px
@@ -41,6 +41,9 @@ template <>
 size_t FindFrameBoundary<http::Message>(message_type_t type, std::string_view buf, size_t start_pos,
                                         http::StateWrapper* state);
 
+template <>
+size_t FrameSizeHint<http::Message>(message_type_t type, std::string_view buf);
+
 }  // namespace protocols
 }  // namespace stirling
 }  // namespace px
@@ -335,9 +335,42 @@ TEST_F(HTTPParserTest, PartialBody) {
 
   EXPECT_EQ(ParseState::kNeedsMoreData, result.state);
   EXPECT_EQ(0, result.end_position);
+  // Too little of the body to rule out a response to a HEAD request.
+  EXPECT_EQ(0, result.incomplete_frame_size);
   EXPECT_THAT(parsed_messages[0], IsEmpty());
 }
 
+TEST_F(HTTPParserTest, FrameSizeHint) {
+  const std::string_view resp_headers =
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Length: 40\r\n"
+      "\r\n";
+  const std::string_view req_headers =
+      "POST /foo HTTP/1.1\r\n"
+      "content-length: 40\r\n"
+      "\r\n";
+
+  EXPECT_EQ(FrameSizeHint<http::Message>(message_type_t::kRequest, req_headers),
+            req_headers.size() + 40);
+  EXPECT_EQ(FrameSizeHint<http::Message>(message_type_t::kRequest, req_headers.substr(0, 10)), 0);
+
+  EXPECT_EQ(FrameSizeHint<http::Message>(message_type_t::kResponse, resp_headers), 0);
+  EXPECT_EQ(FrameSizeHint<http::Message>(message_type_t::kResponse,
+                                         absl::StrCat(resp_headers, "HTTP/1.1 200 OK")),
+            0);
+  EXPECT_EQ(
+      FrameSizeHint<http::Message>(message_type_t::kResponse, absl::StrCat(resp_headers, "Foobar")),
+      resp_headers.size() + 40);
+
+  const std::string chunked_resp =
+      "HTTP/1.1 200 OK\r\n"
+      "Transfer-Encoding: chunked\r\n"
+      "\r\n"
+      "9\r\n"
+      "pixielabs";
+  EXPECT_EQ(FrameSizeHint<http::Message>(message_type_t::kResponse, chunked_resp), 0);
+}
+
 TEST_F(HTTPParserTest, Status101) {
   StateWrapper state{};
   std::string switch_protocol_msg =
@@ -717,6 +750,7 @@ TEST_F(HTTPParserTest, ParseResponseWithoutLengthOrChunking) {
 
   Message expected_message = EmptyHTTPResp();
   expected_message.body = "pixielabs is aweso";
+  expected_message.body_size = 18;
 
   absl::flat_hash_map<stream_id_t, std::deque<Message>> parsed_messages;
   state.global.conn_closed = false;
@@ -729,6 +763,27 @@ TEST_F(HTTPParserTest, ParseResponseWithoutLengthOrChunking) {
   EXPECT_THAT(parsed_messages[0], ElementsAre(expected_message));
 }
 
+// A body delimited by the connection close is held to the body limit, like any other body.
+TEST_F(HTTPParserTest, ParseResponseWithoutLengthOrChunkingOverBodyLimit) {
+  StateWrapper state{};
+  state.global.conn_closed = true;
+
+  std::string body(FLAGS_http_body_limit_bytes * 4, 'x');
+  std::string msg1 = absl::StrCat(
+      "HTTP/1.1 200 OK\r\n"
+      "\r\n",
+      body);
+
+  absl::flat_hash_map<stream_id_t, std::deque<Message>> parsed_messages;
+  ParseResult<stream_id_t> result =
+      ParseFramesLoop(message_type_t::kResponse, msg1, &parsed_messages, &state);
+
+  EXPECT_EQ(ParseState::kSuccess, result.state);
+  ASSERT_EQ(parsed_messages[0].size(), 1);
+  EXPECT_EQ(parsed_messages[0][0].body, body.substr(0, FLAGS_http_body_limit_bytes));
+  EXPECT_EQ(parsed_messages[0][0].body_size, body.size());
+}
+
 TEST_F(HTTPParserTest, MessagePartialHeaders) {
   StateWrapper state{};
   std::string msg1 =
@@ -0,0 +1,199 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/scan.h"
+
+#include <cstdint>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace px {
+namespace stirling {
+namespace protocols {
+namespace http {
+namespace scan_internal {
+
+namespace {
+
+constexpr std::string_view kCRLF = "\r\n";
+constexpr std::string_view kHeaderEnd = "\r\n\r\n";
+
+#if defined(__x86_64__)
+
+// SSE2 is part of the x86-64 baseline, so it needs no runtime check.
+// Each vector of the loops below holds the bytes at an offset from the candidate positions; a
+// position matches if all of the offsets hold the expected byte. The tail that is too short for
+// a full load is left to std::string_view::find().
+
+size_t FindCRLFSSE2(std::string_view buf, size_t pos) {
+  const char* data = buf.data();
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i lf = _mm_set1_epi8('\n');
+  for (; pos + 16 + kCRLF.size() - 1 <= buf.size(); pos += 16) {
+    __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+    __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + 1));
+    int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(v0, cr), _mm_cmpeq_epi8(v1, lf)));
+    if (mask != 0) {
+      return pos + __builtin_ctz(mask);
+    }
+  }
+  return buf.find(kCRLF, pos);
+}
+
+size_t FindHeaderEndSSE2(std::string_view buf, size_t pos) {
+  const char* data = buf.data();
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i lf = _mm_set1_epi8('\n');
+  for (; pos + 16 + kHeaderEnd.size() - 1 <= buf.size(); pos += 16) {
+    __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+    __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + 1));
+    __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + 2));
+    __m128i v3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + 3));
+    __m128i match = _mm_and_si128(
+        _mm_and_si128(_mm_cmpeq_epi8(v0, cr), _mm_cmpeq_epi8(v1, lf)),
+        _mm_and_si128(_mm_cmpeq_epi8(v2, cr), _mm_cmpeq_epi8(v3, lf)));
+    int mask = _mm_movemask_epi8(match);
+    if (mask != 0) {
+      return pos + __builtin_ctz(mask);
+    }
+  }
+  return buf.find(kHeaderEnd, pos);
+}
+
+__attribute__((target("avx2"))) size_t FindCRLFAVX2(std::string_view buf, size_t pos) {
+  const char* data = buf.data();
+  const __m256i cr = _mm256_set1_epi8('\r');
+  const __m256i lf = _mm256_set1_epi8('\n');
+  for (; pos + 32 + kCRLF.size() - 1 <= buf.size(); pos += 32) {
+    __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+    __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos + 1));
+    uint32_t mask = _mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(v0, cr), _mm256_cmpeq_epi8(v1, lf)));
+    if (mask != 0) {
+      return pos + __builtin_ctz(mask);
+    }
+  }
+  return FindCRLFSSE2(buf, pos);
+}
+
+__attribute__((target("avx2"))) size_t FindHeaderEndAVX2(std::string_view buf, size_t pos) {
+  const char* data = buf.data();
+  const __m256i cr = _mm256_set1_epi8('\r');
+  const __m256i lf = _mm256_set1_epi8('\n');
+  for (; pos + 32 + kHeaderEnd.size() - 1 <= buf.size(); pos += 32) {
+    __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+    __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos + 1));
+    __m256i v2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos + 2));
+    __m256i v3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos + 3));
+    __m256i match = _mm256_and_si256(
+        _mm256_and_si256(_mm256_cmpeq_epi8(v0, cr), _mm256_cmpeq_epi8(v1, lf)),
+        _mm256_and_si256(_mm256_cmpeq_epi8(v2, cr), _mm256_cmpeq_epi8(v3, lf)));
+    uint32_t mask = _mm256_movemask_epi8(match);
+    if (mask != 0) {
+      return pos + __builtin_ctz(mask);
+    }
+  }
+  return FindHeaderEndSSE2(buf, pos);
+}
+
+#endif
+
+ISA SelectISA() {
+#if defined(__x86_64__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return ISA::kAVX2;
+  }
+  return ISA::kSSE2;
+#else
+  return ISA::kScalar;
+#endif
+}
+
+}  // namespace
+
+bool IsSupported(ISA isa) {
+  switch (isa) {
+    case ISA::kScalar:
+      return true;
+    case ISA::kSSE2:
+      return SelectISA() != ISA::kScalar;
+    case ISA::kAVX2:
+      return SelectISA() == ISA::kAVX2;
+  }
+  return false;
+}
+
+size_t FindCRLF(ISA isa, std::string_view buf, size_t pos) {
+  if (pos >= buf.size()) {
+    return std::string::npos;
+  }
+  switch (isa) {
+#if defined(__x86_64__)
+    case ISA::kSSE2:
+      return FindCRLFSSE2(buf, pos);
+    case ISA::kAVX2:
+      return FindCRLFAVX2(buf, pos);
+#endif
+    default:
+      return buf.find(kCRLF, pos);
+  }
+}
+
+size_t FindHeaderEnd(ISA isa, std::string_view buf, size_t pos) {
+  if (pos >= buf.size()) {
+    return std::string::npos;
+  }
+  switch (isa) {
+#if defined(__x86_64__)
+    case ISA::kSSE2:
+      return FindHeaderEndSSE2(buf, pos);
+    case ISA::kAVX2:
+      return FindHeaderEndAVX2(buf, pos);
+#endif
+    default:
+      return buf.find(kHeaderEnd, pos);
+  }
+}
+
+}  // namespace scan_internal
+
+namespace {
+
+scan_internal::ISA SelectedISA() {
+  static const scan_internal::ISA kISA = scan_internal::SelectISA();
+  return kISA;
+}
+
+}  // namespace
+
+size_t FindCRLF(std::string_view buf, size_t pos) {
+  return scan_internal::FindCRLF(SelectedISA(), buf, pos);
+}
+
+size_t FindHeaderEnd(std::string_view buf, size_t pos) {
+  return scan_internal::FindHeaderEnd(SelectedISA(), buf, pos);
+}
+
+}  // namespace http
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
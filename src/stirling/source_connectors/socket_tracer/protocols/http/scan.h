@@ -0,0 +1,62 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace px {
+namespace stirling {
+namespace protocols {
+namespace http {
+
+/**
+ * Returns the position of the first "\r\n" in buf at or after pos, or std::string::npos.
+ * Equivalent to buf.find("\r\n", pos), but scans 16 or 32 bytes at a time on x86-64.
+ */
+size_t FindCRLF(std::string_view buf, size_t pos = 0);
+
+/**
+ * Returns the position of the first "\r\n\r\n" in buf at or after pos, or std::string::npos.
+ * This marks the end of the headers of an HTTP message.
+ * Equivalent to buf.find("\r\n\r\n", pos), but scans 16 or 32 bytes at a time on x86-64.
+ */
+size_t FindHeaderEnd(std::string_view buf, size_t pos = 0);
+
+namespace scan_internal {
+
+// The implementations that FindCRLF() and FindHeaderEnd() choose from at runtime, the widest
+// that the CPU supports. Exposed for testing.
+enum class ISA {
+  kScalar,
+  kSSE2,
+  kAVX2,
+};
+
+bool IsSupported(ISA isa);
+size_t FindCRLF(ISA isa, std::string_view buf, size_t pos);
+size_t FindHeaderEnd(ISA isa, std::string_view buf, size_t pos);
+
+}  // namespace scan_internal
+
+}  // namespace http
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/scan.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+namespace http {
+
+using scan_internal::ISA;
+
+class ScanTest : public ::testing::TestWithParam<ISA> {
+ protected:
+  void SetUp() override {
+    if (!scan_internal::IsSupported(GetParam())) {
+      GTEST_SKIP() << "Not supported by this CPU.";
+    }
+  }
+};
+
+INSTANTIATE_TEST_SUITE_P(ScanTestSuite, ScanTest,
+                         ::testing::Values(ISA::kScalar, ISA::kSSE2, ISA::kAVX2));
+
+TEST_P(ScanTest, Basic) {
+  const ISA isa = GetParam();
+  std::string_view buf =
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Type: application/json; charset=utf-8\r\n"
+      "Content-Length: 0\r\n"
+      "\r\n";
+
+  EXPECT_EQ(scan_internal::FindCRLF(isa, buf, 0), 15);
+  EXPECT_EQ(scan_internal::FindCRLF(isa, buf, 16), 62);
+  EXPECT_EQ(scan_internal::FindHeaderEnd(isa, buf, 0), 81);
+  EXPECT_EQ(scan_internal::FindHeaderEnd(isa, buf, 82), std::string::npos);
+  EXPECT_EQ(scan_internal::FindCRLF(isa, buf, buf.size()), std::string::npos);
+  EXPECT_EQ(scan_internal::FindCRLF(isa, "", 0), std::string::npos);
+}
+
+// Compares against std::string_view::find() on random buffers of '\r' and '\n', so that partial
+// matches straddle the vectors, and the tails that the vectors don't cover.
+TEST_P(ScanTest, MatchesStringViewFind) {
+  const ISA isa = GetParam();
+  std::default_random_engine rng(37);
+  constexpr char kAlphabet[] = "\r\nx";
+
+  for (int i = 0; i < 10000; ++i) {
+    std::string buf(rng() % 100, 'x');
+    for (char& c : buf) {
+      c = kAlphabet[rng() % 3];
+    }
+    std::string_view buf_view = buf;
+    size_t pos = rng() % (buf.size() + 2);
+
+    ASSERT_EQ(scan_internal::FindCRLF(isa, buf_view, pos), buf_view.find("\r\n", pos))
+        << buf << " " << pos;
+    ASSERT_EQ(scan_internal::FindHeaderEnd(isa, buf_view, pos), buf_view.find("\r\n\r\n", pos))
+        << buf << " " << pos;
+  }
+}
+
+}  // namespace http
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
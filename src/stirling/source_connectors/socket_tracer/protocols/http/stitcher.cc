@@ -23,6 +23,8 @@
 #include <string>
 #include <utility>
 
+#include <absl/strings/match.h>
+
 #include "src/common/base/base.h"
 #include "src/common/json/json.h"
 #include "src/common/zlib/zlib_wrapper.h"
@@ -43,7 +45,7 @@ namespace stirling {
 namespace protocols {
 namespace http {
 
-void PreProcessMessage(Message* message) {
+void PreProcessMessage(Message* message, size_t max_body_bytes) {
   // Parse the flags on the first time only.
   static const HTTPHeaderFilter kHTTPResponseHeaderFilter =
       ParseHTTPHeaderFilters(FLAGS_http_response_header_filters);
@@ -69,9 +71,21 @@ void PreProcessMessage(Message* message) {
   }
 
   auto content_encoding_iter = message->headers.find(kContentEncoding);
-  // Replace body with decompressed version, if required.
-  if (content_encoding_iter != message->headers.end() && content_encoding_iter->second == "gzip") {
-    message->body = px::zlib::Inflate(message->body).ConsumeValueOr("<Failed to gunzip body>");
+  if (content_encoding_iter == message->headers.end()) {
+    return;
+  }
+  // Replace body with decompressed version, if required. The body may have been truncated by
+  // --http_body_limit_bytes, in which case its decompressed prefix is kept.
+  std::string_view content_encoding = content_encoding_iter->second;
+  if (absl::EqualsIgnoreCase(content_encoding, "gzip") ||
+      absl::EqualsIgnoreCase(content_encoding, "x-gzip") ||
+      absl::EqualsIgnoreCase(content_encoding, "deflate")) {
+    message->body = px::zlib::InflateBounded(message->body, max_body_bytes)
+                        .ConsumeValueOr("<Failed to gunzip body>");
+  } else if (absl::EqualsIgnoreCase(content_encoding, "br") ||
+             absl::EqualsIgnoreCase(content_encoding, "zstd")) {
+    message->body =
+        absl::Substitute("<removed: unsupported content-encoding $0>", content_encoding);
   }
 }
 
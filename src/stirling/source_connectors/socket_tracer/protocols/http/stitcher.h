@@ -19,6 +19,7 @@
 #pragma once
 
 #include <deque>
+#include <limits>
 #include <map>
 #include <string>
 #include <vector>
@@ -45,7 +46,12 @@ namespace http {
 RecordsWithErrorCount<Record> ProcessMessages(std::deque<Message>* req_messages,
                                               std::deque<Message>* resp_messages);
 
-void PreProcessMessage(Message* message);
+/**
+ * Filters the body of the message by its Content-Type, and decompresses it according to its
+ * Content-Encoding, into at most max_body_bytes.
+ */
+void PreProcessMessage(Message* message,
+                       size_t max_body_bytes = std::numeric_limits<size_t>::max());
 
 }  // namespace http
 
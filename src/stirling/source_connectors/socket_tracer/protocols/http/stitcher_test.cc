@@ -45,6 +45,31 @@ TEST(PreProcessRecordTest, GzipCompressedContentIsDecompressed) {
   EXPECT_EQ("This is a test\n", message.body);
 }
 
+TEST(PreProcessRecordTest, CompressedContentIsDecompressedUpToLimit) {
+  Message message;
+  message.type = message_type_t::kResponse;
+  message.headers.insert({kContentEncoding, "gzip"});
+  message.headers.insert({kContentType, "json"});
+  const uint8_t compressed_bytes[] = {0x1f, 0x8b, 0x08, 0x00, 0x37, 0xf0, 0xbf, 0x5c, 0x00,
+                                      0x03, 0x0b, 0xc9, 0xc8, 0x2c, 0x56, 0x00, 0xa2, 0x44,
+                                      0x85, 0x92, 0xd4, 0xe2, 0x12, 0x2e, 0x00, 0x8c, 0x2d,
+                                      0xc0, 0xfa, 0x0f, 0x00, 0x00, 0x00};
+  message.body.assign(reinterpret_cast<const char*>(compressed_bytes), sizeof(compressed_bytes));
+  PreProcessMessage(&message, /*max_body_bytes*/ 7);
+  EXPECT_EQ("This is", message.body);
+}
+
+TEST(PreProcessRecordTest, UnsupportedContentEncodingIsRemoved) {
+  Message message;
+  message.type = message_type_t::kResponse;
+  message.headers.insert({kContentEncoding, "br"});
+  message.headers.insert({kContentType, "json"});
+  message.body = "\x1b\x0e\xf8";
+  message.body_size = message.body.size();
+  PreProcessMessage(&message);
+  EXPECT_EQ("<removed: unsupported content-encoding br>", message.body);
+}
+
 TEST(PreProcessRecordTest, ContentHeaderIsNotAdded) {
   Message message;
   message.type = message_type_t::kResponse;
@@ -23,12 +23,19 @@
 #include <google/protobuf/empty.pb.h>
 #include <google/protobuf/text_format.h>
 
+#include <absl/strings/escaping.h>
+
 #include "src/common/base/base.h"
 #include "src/common/zlib/zlib_wrapper.h"
 #include "src/stirling/utils/binary_decoder.h"
 
 DEFINE_bool(socket_tracer_enable_http2_gzip, false,
             "If true, decompress gzipped request and response bodies of HTTP2 messages.");
+DEFINE_bool(socket_tracer_grpc_raw_bodies,
+            gflags::BoolFromEnv("PL_SOCKET_TRACER_GRPC_RAW_BODIES", false),
+            "If true, record the gRPC request and response bodies base64-encoded in wire format, "
+            "instead of decoding them. They can then be decoded at query time, with "
+            "px.grpc_body_to_text() or px.grpc_body_to_json().");
 
 namespace px {
 namespace stirling {
@@ -138,6 +145,14 @@ std::string ParsePB(std::string_view str, bool is_gzipped,
 void ParseReqRespBody(px::stirling::protocols::http2::Stream* http2_stream,
                       std::string_view truncation_suffix,
                       std::optional<int> str_field_truncation_len) {
+  if (FLAGS_socket_tracer_grpc_raw_bodies && http2_stream->HasGRPCContentType()) {
+    // The truncation suffix is not appended, since it would make the body invalid base64. The body
+    // sizes tell whether the bodies were truncated.
+    *http2_stream->send.mutable_data() = absl::Base64Escape(http2_stream->send.data());
+    *http2_stream->recv.mutable_data() = absl::Base64Escape(http2_stream->recv.data());
+    return;
+  }
+
   bool has_grpc_encoding = http2_stream->HasGRPCEncodingHeader();
   bool is_gzipped = http2_stream->HasGZipGRPCEncoding();
   if (has_grpc_encoding && !is_gzipped) {
@@ -27,6 +27,7 @@
 #include "src/stirling/source_connectors/socket_tracer/protocols/http2/types.h"
 
 DECLARE_bool(socket_tracer_enable_http2_gzip);
+DECLARE_bool(socket_tracer_grpc_raw_bodies);
 
 namespace px {
 namespace stirling {
@@ -41,7 +42,8 @@ std::string ParsePB(std::string_view str, bool is_gzipped = false,
 
 /**
  * Parses the request & response body of the input HTTP2 Stream object.
- * Applies decompression & protobuf parsing if needed.
+ * Applies decompression & protobuf parsing if needed. If --socket_tracer_grpc_raw_bodies is set,
+ * gRPC bodies are instead only base64-encoded, for them to be decoded at query time.
  *
  * @param http2_stream The input HTTP2 record whose request & response bodies are to be parsed,
  *        the results are written to the request & response bodies as well.
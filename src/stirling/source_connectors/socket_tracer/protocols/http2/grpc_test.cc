@@ -149,6 +149,18 @@ TEST(ParseReqRespBodyTest, BodyUnchangedForUnsupportedCompressionAlgo) {
   EXPECT_THAT(http2_stream.recv.data(), StrEq("recv message"));
 }
 
+// Tests that gRPC bodies are only base64-encoded if --socket_tracer_grpc_raw_bodies is set.
+TEST(ParseReqRespBodyTest, RawBodies) {
+  FLAGS_socket_tracer_grpc_raw_bodies = true;
+  protocols::http2::Stream http2_stream;
+  http2_stream.send.AddHeader("content-type", "application/grpc");
+  http2_stream.send.AddData(CreateStringView<char>("\x00\x00\x00\x00\x02\x10\x03"));
+  ParseReqRespBody(&http2_stream, "... [TRUNCATED]");
+  EXPECT_THAT(http2_stream.send.data(), StrEq("AAAAAAIQAw=="));
+  EXPECT_THAT(http2_stream.recv.data(), StrEq(""));
+  FLAGS_socket_tracer_grpc_raw_bodies = false;
+}
+
 }  // namespace grpc
 }  // namespace stirling
 }  // namespace px
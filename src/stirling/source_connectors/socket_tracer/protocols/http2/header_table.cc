@@ -0,0 +1,139 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/http2/header_table.h"
+
+#include <algorithm>
+
+namespace px {
+namespace stirling {
+namespace protocols {
+namespace http2 {
+
+namespace {
+
+// The headers whose values repeat across streams. Other values, like those of "x-request-id",
+// would fill up the table with strings that are never seen again.
+constexpr std::string_view kInternedValueNames[] = {
+    ":authority",
+    ":method",
+    ":path",
+    ":scheme",
+    ":status",
+    "accept-encoding",
+    "content-encoding",
+    "content-type",
+    "grpc-accept-encoding",
+    "grpc-encoding",
+    "grpc-status",
+    "te",
+    "user-agent",
+};
+
+// Pre-populated from the HPACK static table (RFC 7541, Appendix A) and gRPC's common headers.
+constexpr std::string_view kStaticStrings[] = {
+    ":authority",
+    ":method",
+    "GET",
+    "POST",
+    ":path",
+    "/",
+    ":scheme",
+    "http",
+    "https",
+    ":status",
+    "200",
+    "204",
+    "206",
+    "304",
+    "400",
+    "404",
+    "500",
+    "accept-encoding",
+    "gzip, deflate",
+    "content-type",
+    "content-encoding",
+    "content-length",
+    "date",
+    "user-agent",
+    "te",
+    "trailers",
+    "application/grpc",
+    "grpc-accept-encoding",
+    "identity,deflate,gzip",
+    "grpc-encoding",
+    "gzip",
+    "grpc-status",
+    "grpc-message",
+    "0",
+};
+
+}  // namespace
+
+HeaderTable* HeaderTable::Global() {
+  static HeaderTable* table = new HeaderTable();
+  return table;
+}
+
+HeaderTable::HeaderTable() {
+  for (std::string_view str : kStaticStrings) {
+    Intern(str);
+  }
+}
+
+std::optional<std::string_view> HeaderTable::InternName(std::string_view name) {
+  return Intern(name);
+}
+
+std::optional<std::string_view> HeaderTable::InternValue(std::string_view name,
+                                                         std::string_view value) {
+  if (std::find(std::begin(kInternedValueNames), std::end(kInternedValueNames), name) ==
+      std::end(kInternedValueNames)) {
+    return std::nullopt;
+  }
+  return Intern(value);
+}
+
+std::optional<std::string_view> HeaderTable::Intern(std::string_view str) {
+  absl::MutexLock lock(&mu_);
+
+  auto iter = strings_.find(str);
+  if (iter != strings_.end()) {
+    return *iter;
+  }
+  if (str.size() > kMaxStringBytes || num_bytes_ + str.size() > kMaxBytes) {
+    return std::nullopt;
+  }
+  num_bytes_ += str.size();
+  return *strings_.emplace(str).first;
+}
+
+size_t HeaderTable::num_strings() const {
+  absl::MutexLock lock(&mu_);
+  return strings_.size();
+}
+
+size_t HeaderTable::num_bytes() const {
+  absl::MutexLock lock(&mu_);
+  return num_bytes_;
+}
+
+}  // namespace http2
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
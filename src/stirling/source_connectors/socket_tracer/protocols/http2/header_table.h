@@ -0,0 +1,73 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/container/node_hash_set.h>
+#include <absl/synchronization/mutex.h>
+
+namespace px {
+namespace stirling {
+namespace protocols {
+namespace http2 {
+
+/**
+ * HeaderTable interns the HTTP2 header names, and the values of the headers that take few
+ * distinct values (e.g. ":method", "content-type" and the gRPC method in ":path"), for all the
+ * streams of the process. The streams then only hold views of the interned strings, instead of a
+ * copy per header. This is similar to the HPACK tables, which the uprobes see past.
+ *
+ * Strings are never removed, so the views remain valid. Once the table holds kMaxBytes, strings
+ * that are not in it yet are not interned; the streams own copies of them instead.
+ */
+class HeaderTable {
+ public:
+  static constexpr size_t kMaxBytes = 1024 * 1024;
+  static constexpr size_t kMaxStringBytes = 256;
+
+  static HeaderTable* Global();
+
+  HeaderTable();
+
+  // Returns a view of the interned copy of the name, or std::nullopt if it is not interned.
+  std::optional<std::string_view> InternName(std::string_view name);
+
+  // Returns a view of the interned copy of the value, or std::nullopt if it is not interned,
+  // for example because the values of the header are all different.
+  std::optional<std::string_view> InternValue(std::string_view name, std::string_view value);
+
+  size_t num_strings() const;
+  size_t num_bytes() const;
+
+ private:
+  std::optional<std::string_view> Intern(std::string_view str);
+
+  mutable absl::Mutex mu_;
+  absl::node_hash_set<std::string> strings_ ABSL_GUARDED_BY(mu_);
+  size_t num_bytes_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace http2
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
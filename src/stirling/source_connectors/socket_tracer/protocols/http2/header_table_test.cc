@@ -0,0 +1,111 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/http2/header_table.h"
+
+#include <string>
+
+#include "src/common/testing/testing.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/http2/types.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+namespace http2 {
+
+using ::testing::ElementsAre;
+using ::testing::Optional;
+using ::testing::Pair;
+using ::testing::StrEq;
+
+TEST(HeaderTableTest, InternsNamesAndCommonValues) {
+  HeaderTable table;
+
+  std::string name = "x-custom-header";
+  std::optional<std::string_view> interned = table.InternName(name);
+  ASSERT_TRUE(interned.has_value());
+  EXPECT_EQ(interned.value(), "x-custom-header");
+  EXPECT_NE(interned->data(), name.data());
+  EXPECT_EQ(table.InternName("x-custom-header")->data(), interned->data());
+
+  EXPECT_THAT(table.InternValue(":method", "PUT"), Optional(StrEq("PUT")));
+  EXPECT_EQ(table.InternValue("x-request-id", "3f1b0a2c"), std::nullopt);
+}
+
+TEST(HeaderTableTest, BoundedSize) {
+  HeaderTable table;
+
+  EXPECT_EQ(table.InternName(std::string(HeaderTable::kMaxStringBytes + 1, 'a')), std::nullopt);
+
+  for (int i = 0; table.num_bytes() + HeaderTable::kMaxStringBytes <= HeaderTable::kMaxBytes; ++i) {
+    std::string path = absl::StrCat("/", i, std::string(HeaderTable::kMaxStringBytes - 16, 'p'));
+    ASSERT_TRUE(table.InternValue(":path", path).has_value());
+  }
+  EXPECT_EQ(table.InternValue(":path", std::string(HeaderTable::kMaxStringBytes, 'q')),
+            std::nullopt);
+  EXPECT_LE(table.num_bytes(), HeaderTable::kMaxBytes);
+}
+
+TEST(NVMapTest, KeepsHeadersOfEachStream) {
+  NVMap headers;
+  headers.emplace(":path", "/magic");
+  headers.emplace("x-request-id", "3f1b0a2c");
+  headers.emplace(":method", "post");
+  headers.emplace("x-request-id", "d0e4");
+
+  EXPECT_EQ(headers.ValueByKey("x-request-id"), "3f1b0a2c");
+  EXPECT_EQ(headers.ValueByKey(":status", "-1"), "-1");
+  EXPECT_EQ(headers.ByteSize(), 58);
+  EXPECT_EQ(headers.ToString(),
+            ":method:post, :path:/magic, x-request-id:3f1b0a2c, x-request-id:d0e4");
+  EXPECT_EQ(headers.ToJSONString(),
+            R"({":method":"post",":path":"/magic","x-request-id":"3f1b0a2c",)"
+            R"("x-request-id":"d0e4"})");
+
+  // Copies must not refer to the strings owned by the original.
+  NVMap copy;
+  {
+    NVMap original = headers;
+    copy = original;
+  }
+  EXPECT_EQ(copy, headers);
+  EXPECT_THAT(copy, ElementsAre(Pair(":path", "/magic"), Pair("x-request-id", "3f1b0a2c"),
+                                Pair(":method", "post"), Pair("x-request-id", "d0e4")));
+
+  NVMap moved = std::move(copy);
+  EXPECT_EQ(moved, (NVMap{{":method", "post"},
+                          {":path", "/magic"},
+                          {"x-request-id", "3f1b0a2c"},
+                          {"x-request-id", "d0e4"}}));
+}
+
+TEST(HalfStreamTest, BoundedHeaders) {
+  HalfStream half_stream;
+  half_stream.AddHeader(":method", "post");
+  for (int i = 0; i < 1000; ++i) {
+    half_stream.AddHeader("x-filler", std::string(100, 'f'));
+  }
+  EXPECT_TRUE(half_stream.headers_truncated());
+  EXPECT_EQ(half_stream.headers().ValueByKey(":method"), "post");
+  EXPECT_LT(half_stream.headers().ByteSize(), 100 * 1000);
+}
+
+}  // namespace http2
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
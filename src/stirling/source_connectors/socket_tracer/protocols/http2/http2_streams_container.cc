@@ -19,27 +19,15 @@
 #include "src/stirling/source_connectors/socket_tracer/protocols/http2/http2_streams_container.h"
 
 #include <algorithm>
+#include <chrono>
 
 namespace px {
 namespace stirling {
 
 namespace {
 
-void EraseExpiredStreams(std::chrono::time_point<std::chrono::steady_clock> expiry_timestamp,
-                         absl::flat_hash_map<uint32_t, protocols::http2::Stream>* streams) {
-  auto iter = streams->begin();
-  while (iter != streams->end()) {
-    const auto& stream = iter->second;
-    uint64_t timestamp_ns = std::max(stream.send.timestamp_ns, stream.recv.timestamp_ns);
-    auto last_activity =
-        std::chrono::time_point<std::chrono::steady_clock>(std::chrono::nanoseconds(timestamp_ns));
+constexpr uint64_t kNanosPerExpiryTick = 1000 * 1000;
 
-    if (expiry_timestamp < last_activity) {
-      break;
-    }
-    streams->erase(iter++);
-  }
-}
 }  // namespace
 
 size_t HTTP2StreamsContainer::StreamsSize() const {
@@ -57,14 +45,36 @@ void HTTP2StreamsContainer::Cleanup(
     VLOG(1) << absl::Substitute("HTTP2 streams cleared due to size limit ($0 > $1).", size,
                                 size_limit_bytes);
     streams_.clear();
+    expiry_checks_.Clear();
   }
 
-  EraseExpiredStreams(expiry_timestamp, &streams_);
+  const uint64_t expiry_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 expiry_timestamp.time_since_epoch())
+                                 .count();
+  expiry_checks_.Advance(expiry_ns / kNanosPerExpiryTick, [this, expiry_ns](uint32_t stream_id) {
+    auto iter = streams_.find(stream_id);
+    if (iter == streams_.end()) {
+      // Already consumed by the stitcher.
+      return;
+    }
+    const auto& stream = iter->second;
+    uint64_t timestamp_ns = std::max(stream.send.timestamp_ns, stream.recv.timestamp_ns);
+    if (expiry_ns < timestamp_ns) {
+      expiry_checks_.Schedule(timestamp_ns / kNanosPerExpiryTick, stream_id);
+      return;
+    }
+    streams_.erase(iter);
+  });
 }
 
 protocols::http2::HalfStream* HTTP2StreamsContainer::HalfStreamPtr(uint32_t stream_id,
                                                                    bool write_event) {
-  protocols::http2::Stream& stream = streams_[stream_id];
+  auto [iter, inserted] = streams_.try_emplace(stream_id);
+  protocols::http2::Stream& stream = iter->second;
+  if (inserted) {
+    // The stream has no timestamps yet, so check it at the next Cleanup().
+    expiry_checks_.Schedule(0, stream_id);
+  }
 
   if (stream.consumed) {
     // Don't expect this to happen, but log it just in case.
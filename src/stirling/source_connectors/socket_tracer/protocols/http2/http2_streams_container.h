@@ -25,6 +25,7 @@
 
 #include "src/common/base/mixins.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/http2/types.h"
+#include "src/stirling/utils/timer_wheel.h"
 
 namespace px {
 namespace stirling {
@@ -70,6 +71,10 @@ class HTTP2StreamsContainer : NotCopyMoveable {
  private:
   // Map of all HTTP2 streams. Key is stream ID.
   absl::flat_hash_map<uint32_t, protocols::http2::Stream> streams_;
+
+  // Stream IDs keyed by the millisecond of their last known activity, so that Cleanup() only
+  // looks at streams that may have expired. Streams that were active since are scheduled again.
+  utils::TimerWheel<uint32_t, 4> expiry_checks_;
 };
 
 }  // namespace stirling
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/http2/types.h"
+
+#include <algorithm>
+#include <optional>
+
+#include "src/common/json/json.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/http2/header_table.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+namespace http2 {
+
+NVMap& NVMap::operator=(const NVMap& other) {
+  if (this == &other) {
+    return *this;
+  }
+  headers_.clear();
+  owned_strings_.clear();
+  for (const auto& [name, value] : other.headers_) {
+    emplace(name, value);
+  }
+  return *this;
+}
+
+void NVMap::emplace(std::string_view name, std::string_view value) {
+  HeaderTable* table = HeaderTable::Global();
+
+  std::optional<std::string_view> interned_name = table->InternName(name);
+  if (!interned_name.has_value()) {
+    interned_name = owned_strings_.emplace_back(name);
+  }
+  std::optional<std::string_view> interned_value = table->InternValue(name, value);
+  if (!interned_value.has_value()) {
+    interned_value = owned_strings_.emplace_back(value);
+  }
+  headers_.emplace_back(interned_name.value(), interned_value.value());
+}
+
+NVMap::const_iterator NVMap::find(std::string_view key) const {
+  return std::find_if(headers_.begin(), headers_.end(),
+                      [key](const value_type& header) { return header.first == key; });
+}
+
+std::multimap<std::string_view, std::string_view> NVMap::Sorted() const {
+  return std::multimap<std::string_view, std::string_view>(headers_.begin(), headers_.end());
+}
+
+std::string NVMap::ToString() const {
+  return absl::StrJoin(Sorted(), ", ", absl::PairFormatter(":"));
+}
+
+std::string NVMap::ToJSONString() const { return utils::ToJSONString(Sorted()); }
+
+bool NVMap::operator==(const NVMap& other) const {
+  return size() == other.size() && Sorted() == other.Sorted();
+}
+
+}  // namespace http2
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
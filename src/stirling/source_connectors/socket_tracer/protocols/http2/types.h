@@ -20,9 +20,13 @@
 
 #include <algorithm>
 #include <chrono>
+#include <deque>
+#include <initializer_list>
 #include <map>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 #include <absl/strings/str_join.h>
 
@@ -53,29 +57,68 @@ constexpr char kGZip[] = "gzip";
 // ... header field names MUST be converted to lowercase prior to their encoding in HTTP/2.
 // A request or response containing uppercase header field names MUST be treated as malformed.
 //
-// TODO(yzhao): Change to hold a std::map<> object instead of deriving from std::multiplemap<>.
-class NVMap : public std::multimap<std::string, std::string> {
+// The headers are held in the order they were added, as views of the strings interned in
+// HeaderTable, and of copies owned by the NVMap for the rest. Like a std::multimap<>, lookups
+// return the first header added with the name, and ToString() and ToJSONString() are sorted by
+// name.
+class NVMap {
  public:
-  std::string ValueByKey(const std::string& key, const std::string& default_value = "") const {
+  using value_type = std::pair<std::string_view, std::string_view>;
+  using const_iterator = std::vector<value_type>::const_iterator;
+
+  NVMap() = default;
+  NVMap(std::initializer_list<value_type> headers) {
+    for (const auto& [name, value] : headers) {
+      emplace(name, value);
+    }
+  }
+  NVMap(const NVMap& other) { *this = other; }
+  NVMap& operator=(const NVMap& other);
+  // Moving a std::deque<> moves its blocks, not its strings, so the views remain valid.
+  NVMap(NVMap&& other) = default;
+  NVMap& operator=(NVMap&& other) = default;
+
+  void emplace(std::string_view name, std::string_view value);
+  void insert(const value_type& header) { emplace(header.first, header.second); }
+
+  const_iterator begin() const { return headers_.begin(); }
+  const_iterator end() const { return headers_.end(); }
+  size_t size() const { return headers_.size(); }
+  bool empty() const { return headers_.empty(); }
+  const_iterator find(std::string_view key) const;
+
+  std::string ValueByKey(std::string_view key, std::string_view default_value = "") const {
     const auto iter = find(key);
     if (iter != end()) {
-      return iter->second;
+      return std::string(iter->second);
     }
-    return default_value;
+    return std::string(default_value);
   }
 
   size_t ByteSize() const {
     size_t byte_size = 0;
-    for (const auto& [name, value] : *this) {
+    for (const auto& [name, value] : headers_) {
       byte_size += name.size();
       byte_size += value.size();
     }
     return byte_size;
   }
 
-  bool HasKey(const std::string& key) const { return find(key) != end(); }
+  bool HasKey(std::string_view key) const { return find(key) != end(); }
+
+  std::string ToString() const;
+  std::string ToJSONString() const;
+
+  // Compares the headers regardless of the order of the names, like std::multimap<> would.
+  bool operator==(const NVMap& other) const;
+  bool operator!=(const NVMap& other) const { return !(*this == other); }
 
-  std::string ToString() const { return absl::StrJoin(*this, ", ", absl::PairFormatter(":")); }
+ private:
+  // Sorted by name, keeping the order in which the headers of the same name were added.
+  std::multimap<std::string_view, std::string_view> Sorted() const;
+
+  std::vector<value_type> headers_;
+  std::deque<std::string> owned_strings_;
 };
 
 // This struct represents the frames of interest transmitted on an HTTP2 stream.
@@ -90,6 +133,7 @@ struct HalfStream {
   NVMap* mutable_headers() { return &headers_; }
   const NVMap& trailers() const { return trailers_; }
   bool end_stream() const { return end_stream_; }
+  bool headers_truncated() const { return headers_truncated_; }
   bool data_truncated() const { return data_truncated_; }
   size_t original_data_size() const { return original_data_size_; }
 
@@ -107,14 +151,22 @@ struct HalfStream {
     }
   }
 
-  void AddHeader(std::string key, std::string val) {
+  void AddHeader(std::string_view key, std::string_view val) {
+    // Bound the memory of each stream; the pseudo-headers, which are used the most, come first.
+    constexpr size_t kMaxHeadersBytes = 16384;
+
+    if (headers_byte_size_ + key.size() + val.size() > kMaxHeadersBytes) {
+      headers_truncated_ = true;
+      return;
+    }
+    headers_byte_size_ += key.size() + val.size();
     byte_size_ += key.size() + val.size();
-    headers_.emplace(std::move(key), std::move(val));
+    headers_.emplace(key, val);
   }
 
-  void AddTrailer(std::string key, std::string val) {
+  void AddTrailer(std::string_view key, std::string_view val) {
     byte_size_ += key.size() + val.size();
-    trailers_.emplace(std::move(key), std::move(val));
+    trailers_.emplace(key, val);
   }
 
   void AddData(std::string_view val) {
@@ -171,10 +223,14 @@ struct HalfStream {
   bool end_stream_ = false;
   size_t byte_size_ = 0;
 
+  size_t headers_byte_size_ = 0;
+
   // Record the size of data (excluding headers), which used for truncation.
   size_t original_data_size_ = 0;
   // If true, means data has been discarded to stay within the limit.
   bool data_truncated_ = false;
+  // If true, means headers have been discarded to stay within the limit.
+  bool headers_truncated_ = false;
 };
 
 // This class represents an HTTP2 stream (https://http2.github.io/http2-spec/#StreamsLayer).
@@ -128,6 +128,7 @@ StatusOr<FetchRespPartition> PacketDecoder::ExtractFetchRespPartition() {
 StatusOr<FetchRespTopic> PacketDecoder::ExtractFetchRespTopic() {
   FetchRespTopic r;
   PX_ASSIGN_OR_RETURN(r.name, ExtractString());
+  current_topic_ = r.name;
   PX_ASSIGN_OR_RETURN(r.partitions, ExtractArray(&PacketDecoder::ExtractFetchRespPartition));
   PX_RETURN_IF_ERROR(/* tag_section */ ExtractTagSection());
   return r;
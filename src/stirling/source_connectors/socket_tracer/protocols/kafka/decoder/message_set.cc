@@ -45,12 +45,12 @@ StatusOr<RecordMessage> PacketDecoder::ExtractRecordMessage() {
 }
 
 // Only supports Kafka version >= 0.11.0
-StatusOr<RecordBatch> PacketDecoder::ExtractRecordBatch(int32_t* offset) {
+StatusOr<RecordBatch> PacketDecoder::ExtractRecordBatch(int32_t* offset, bool decode_records) {
   constexpr int32_t kBaseOffsetLength = 8;
   constexpr int32_t kLengthLength = 4;
 
   RecordBatch r;
-  PX_ASSIGN_OR_RETURN(int64_t base_offset, ExtractInt64());
+  PX_ASSIGN_OR_RETURN(r.base_offset, ExtractInt64());
 
   PX_ASSIGN_OR_RETURN(int32_t length, ExtractInt32());
   PX_RETURN_IF_ERROR(MarkOffset(length));
@@ -74,7 +74,6 @@ StatusOr<RecordBatch> PacketDecoder::ExtractRecordBatch(int32_t* offset) {
   PX_ASSIGN_OR_RETURN(int16_t producer_epoch, ExtractInt16());
   PX_ASSIGN_OR_RETURN(int32_t base_sequence, ExtractInt32());
 
-  PX_UNUSED(base_offset);
   PX_UNUSED(partition_leader_epoch);
   PX_UNUSED(crc);
   PX_UNUSED(attributes);
@@ -85,7 +84,14 @@ StatusOr<RecordBatch> PacketDecoder::ExtractRecordBatch(int32_t* offset) {
   PX_UNUSED(producer_epoch);
   PX_UNUSED(base_sequence);
 
-  PX_ASSIGN_OR_RETURN(r.records, ExtractRegularArray(&PacketDecoder::ExtractRecordMessage));
+  if (decode_records) {
+    PX_ASSIGN_OR_RETURN(r.records, ExtractRegularArray(&PacketDecoder::ExtractRecordMessage));
+    r.num_records = static_cast<int32_t>(r.records.size());
+  } else {
+    // The records are skipped by jumping to the end of the batch below, so their keys and values
+    // are never copied out of the packet.
+    PX_ASSIGN_OR_RETURN(r.num_records, ExtractInt32());
+  }
   PX_RETURN_IF_ERROR(JumpToOffset());
 
   *offset += length + kBaseOffsetLength + kLengthLength;
@@ -96,6 +102,9 @@ StatusOr<MessageSet> PacketDecoder::ExtractMessageSet() {
   MessageSet message_set;
 
   int32_t offset = 0;
+  const bool decode_records =
+      record_topic_filter_ == nullptr || record_topic_filter_->Matches(current_topic_);
+  message_set.records_captured = record_topic_filter_ != nullptr && decode_records;
 
   if (is_flexible_) {
     PX_ASSIGN_OR_RETURN(message_set.size, ExtractUnsignedVarint());
@@ -119,7 +128,7 @@ StatusOr<MessageSet> PacketDecoder::ExtractMessageSet() {
   // correct offset and continue parsing.
 
   while (offset < message_set.size) {
-    auto record_batch_result = ExtractRecordBatch(&offset);
+    auto record_batch_result = ExtractRecordBatch(&offset, decode_records);
     if (record_batch_result.ok()) {
       message_set.record_batches.push_back(record_batch_result.ValueOrDie());
     } else {
@@ -17,6 +17,8 @@
  */
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/kafka/decoder/packet_decoder.h"
+#include <absl/strings/ascii.h>
+#include <absl/strings/str_split.h>
 #include <string>
 #include "src/common/base/byte_utils.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/kafka/common/types.h"
@@ -26,6 +28,17 @@ namespace stirling {
 namespace protocols {
 namespace kafka {
 
+RecordTopicFilter::RecordTopicFilter(std::string_view topics) {
+  for (std::string_view topic : absl::StrSplit(topics, ',', absl::SkipWhitespace())) {
+    topic = absl::StripAsciiWhitespace(topic);
+    if (topic == "*") {
+      match_all_ = true;
+    } else {
+      topics_.emplace(topic);
+    }
+  }
+}
+
 // TODO(chengruizhe): Many of the methods here are shareable with other protocols such as CQL.
 
 template <typename TCharType>
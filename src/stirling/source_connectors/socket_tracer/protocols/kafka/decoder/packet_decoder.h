@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <absl/container/flat_hash_set.h>
 #include <map>
 #include <stack>
 #include <string>
@@ -65,6 +66,22 @@ std::string ToString(T obj) {
   return json_object_builder.GetString();
 }
 
+// Selects the topics whose record payloads (keys and values) are decoded. Record batches of all
+// other topics are reduced to their metadata, and their payloads are skipped without copying.
+class RecordTopicFilter {
+ public:
+  // Takes a comma-separated list of topic names, or "*" to select all topics.
+  explicit RecordTopicFilter(std::string_view topics);
+
+  bool Matches(std::string_view topic) const { return match_all_ || topics_.contains(topic); }
+
+  bool empty() const { return !match_all_ && topics_.empty(); }
+
+ private:
+  bool match_all_ = false;
+  absl::flat_hash_set<std::string> topics_;
+};
+
 class PacketDecoder {
  public:
   explicit PacketDecoder(std::string_view buf) : marked_bufs_(), binary_decoder_(buf) {}
@@ -173,7 +190,8 @@ class PacketDecoder {
   // Messages (aka Records) are always written in batches. The technical term for a batch of
   // messages is a record batch, and a record batch contains one or more records.
   // https://kafka.apache.org/documentation/#recordbatch
-  StatusOr<RecordBatch> ExtractRecordBatch(int32_t* offset);
+  // If decode_records is false, only the batch metadata is extracted and the records are skipped.
+  StatusOr<RecordBatch> ExtractRecordBatch(int32_t* offset, bool decode_records = true);
 
   // A MessageSet contains multiple record batches.
   StatusOr<MessageSet> ExtractMessageSet();
@@ -244,6 +262,10 @@ class PacketDecoder {
     is_flexible_ = IsFlexible(api_key, api_version);
   }
 
+  // Restricts record payload decoding to the topics selected by the filter. With no filter (the
+  // default), the records of all topics are decoded. The filter must outlive the decoder.
+  void set_record_topic_filter(const RecordTopicFilter* filter) { record_topic_filter_ = filter; }
+
  private:
   // Represents a sequence of characters. First the length N is given as an INT16. Then N
   // bytes follow which are the UTF-8 encoding of the character sequence.
@@ -314,6 +336,9 @@ class PacketDecoder {
   APIKey api_key_;
   int16_t api_version_ = 0;
   bool is_flexible_ = false;
+  const RecordTopicFilter* record_topic_filter_ = nullptr;
+  // The topic whose partitions are being extracted, used to apply record_topic_filter_.
+  std::string current_topic_;
 };
 
 }  // namespace kafka
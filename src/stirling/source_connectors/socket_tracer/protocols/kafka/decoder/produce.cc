@@ -35,6 +35,7 @@ StatusOr<ProduceReqPartition> PacketDecoder::ExtractProduceReqPartition() {
 StatusOr<ProduceReqTopic> PacketDecoder::ExtractProduceReqTopic() {
   ProduceReqTopic r;
   PX_ASSIGN_OR_RETURN(r.name, ExtractString());
+  current_topic_ = r.name;
   PX_ASSIGN_OR_RETURN(r.partitions, ExtractArray(&PacketDecoder::ExtractProduceReqPartition));
   PX_RETURN_IF_ERROR(/* tag_section */ ExtractTagSection());
   return r;
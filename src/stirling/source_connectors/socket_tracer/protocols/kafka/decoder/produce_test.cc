@@ -171,6 +171,51 @@ TEST(KafkaPacketDecoderTest, ExtractProduceReqV7) {
   EXPECT_OK_AND_EQ(decoder.ExtractProduceReq(), expected_result);
 }
 
+TEST(KafkaPacketDecoderTest, ExtractProduceReqRecordTopicFilter) {
+  const std::string_view input = CreateStringView<char>(
+      "\xFF\xFF\x00\x01\x00\x00\x75\x30\x00\x00\x00\x01\x00\x08\x6D\x79\x2D\x74\x6F\x70\x69\x63\x00"
+      "\x00\x00\x01\x00\x00\x00\x00\x00\x00\x00\x5C\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x50"
+      "\x00\x00\x00\x00\x02\x76\x7C\xA6\x2F\x00\x00\x00\x00\x00\x01\x00\x00\x01\x7C\x29\x89\x9A\xA2"
+      "\x00\x00\x01\x7C\x29\x89\x9A\xA2\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x00"
+      "\x00\x00\x02\x14\x00\x00\x00\x01\x08\x74\x65\x73\x74\x00\x26\x00\x00\x02\x01\x1A\xC2\x48\x6F"
+      "\x6C\x61\x2C\x20\x6D\x75\x6E\x64\x6F\x21\x00");
+
+  {
+    // Records of unselected topics are skipped; only the batch metadata is decoded.
+    RecordTopicFilter filter("other-topic");
+    PacketDecoder decoder(input);
+    decoder.SetAPIInfo(APIKey::kProduce, 7);
+    decoder.set_record_topic_filter(&filter);
+    ASSERT_OK_AND_ASSIGN(ProduceReq req, decoder.ExtractProduceReq());
+    ASSERT_EQ(req.topics.size(), 1);
+    ASSERT_EQ(req.topics[0].partitions.size(), 1);
+    const MessageSet& message_set = req.topics[0].partitions[0].message_set;
+    EXPECT_EQ(message_set.size, 92);
+    EXPECT_FALSE(message_set.records_captured);
+    ASSERT_EQ(message_set.record_batches.size(), 1);
+    EXPECT_THAT(message_set.record_batches[0].records, IsEmpty());
+    EXPECT_EQ(message_set.record_batches[0].num_records, 2);
+    EXPECT_EQ(message_set.record_batches[0].base_offset, 0);
+  }
+
+  {
+    RecordTopicFilter filter("other-topic, my-topic");
+    PacketDecoder decoder(input);
+    decoder.SetAPIInfo(APIKey::kProduce, 7);
+    decoder.set_record_topic_filter(&filter);
+    ASSERT_OK_AND_ASSIGN(ProduceReq req, decoder.ExtractProduceReq());
+    ASSERT_EQ(req.topics.size(), 1);
+    ASSERT_EQ(req.topics[0].partitions.size(), 1);
+    const MessageSet& message_set = req.topics[0].partitions[0].message_set;
+    EXPECT_TRUE(message_set.records_captured);
+    ASSERT_EQ(message_set.record_batches.size(), 1);
+    EXPECT_THAT(message_set.record_batches[0].records,
+                ElementsAre(RecordMessage{.key = "", .value = "test"},
+                            RecordMessage{.key = "", .value = "\xc2Hola, mundo!"}));
+    EXPECT_EQ(message_set.record_batches[0].num_records, 2);
+  }
+}
+
 TEST(KafkaPacketDecoderTest, ExtractProduceReqV8) {
   const std::string_view input = CreateStringView<char>(
       "\xff\xff\x00\x01\x00\x00\x05\xdc\x00\x00\x00\x01\x00\x11\x71\x75\x69\x63\x6b\x73\x74\x61"
@@ -42,9 +42,14 @@ struct RecordMessage {
 };
 
 struct RecordBatch {
+  // Only populated when record payloads are decoded (see PacketDecoder::ExtractRecordBatch).
   std::vector<RecordMessage> records;
+  int64_t base_offset = 0;
+  int32_t num_records = 0;
 
   void ToJSON(utils::JSONObjectBuilder* builder) const {
+    builder->WriteKV("base_offset", base_offset);
+    builder->WriteKV("num_records", num_records);
     builder->WriteKVArrayRecursive<RecordMessage>("records", records);
   }
 };
@@ -52,10 +57,12 @@ struct RecordBatch {
 struct MessageSet {
   int64_t size = 0;
   std::vector<RecordBatch> record_batches;
+  // Set when record payloads were decoded because their topic was selected for capture.
+  bool records_captured = false;
 
   void ToJSON(utils::JSONObjectBuilder* builder, bool omit_record_batches = true) const {
     builder->WriteKV("size", size);
-    if (!omit_record_batches) {
+    if (!omit_record_batches || records_captured) {
       builder->WriteKVArrayRecursive<RecordBatch>("record_batchs", record_batches);
     }
   }
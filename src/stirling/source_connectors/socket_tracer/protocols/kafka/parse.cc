@@ -156,6 +156,17 @@ size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start
   return std::string::npos;
 }
 
+size_t FrameSizeHint(std::string_view buf) {
+  if (buf.size() < kMessageLengthBytes) {
+    return 0;
+  }
+  int32_t payload_length = utils::BEndianBytesToInt<int32_t, kMessageLengthBytes>(buf);
+  if (payload_length <= 0) {
+    return 0;
+  }
+  return kMessageLengthBytes + static_cast<size_t>(payload_length);
+}
+
 }  // namespace kafka
 
 template <>
@@ -173,6 +184,11 @@ size_t FindFrameBoundary<kafka::Packet, kafka::StateWrapper>(message_type_t type
   return kafka::FindFrameBoundary(type, buf, start_pos, &state->global);
 }
 
+template <>
+size_t FrameSizeHint<kafka::Packet>(message_type_t /*type*/, std::string_view buf) {
+  return kafka::FrameSizeHint(buf);
+}
+
 }  // namespace protocols
 }  // namespace stirling
 }  // namespace px
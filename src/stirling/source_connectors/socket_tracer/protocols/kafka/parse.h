@@ -32,6 +32,8 @@ namespace kafka {
 ParseState ParseFrame(message_type_t type, std::string_view* buf, Packet* result, State* state);
 
 size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start_pos, State* state);
+
+size_t FrameSizeHint(std::string_view buf);
 }  // namespace kafka
 
 template <>
@@ -42,6 +44,9 @@ template <>
 size_t FindFrameBoundary<kafka::Packet>(message_type_t type, std::string_view buf, size_t start_pos,
                                         kafka::StateWrapper* state);
 
+template <>
+size_t FrameSizeHint<kafka::Packet>(message_type_t type, std::string_view buf);
+
 }  // namespace protocols
 }  // namespace stirling
 }  // namespace px
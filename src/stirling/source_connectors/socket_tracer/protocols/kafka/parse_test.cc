@@ -124,6 +124,7 @@ TEST(KafkaParserTest, ParseIncompleteRequest) {
       ParseFramesLoop(message_type_t::kRequest, truncated_produce_frame, &parsed_messages, &state);
 
   EXPECT_EQ(ParseState::kNeedsMoreData, result.state);
+  EXPECT_EQ(result.incomplete_frame_size, produce_frame_view.size());
   EXPECT_THAT(parsed_messages[0], ElementsAre());
   EXPECT_TRUE(state.global.seen_correlation_ids.empty());
 }
@@ -27,6 +27,12 @@
 #include "src/stirling/source_connectors/socket_tracer/protocols/kafka/common/types.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/kafka/decoder/packet_decoder.h"
 
+DEFINE_string(socket_tracer_kafka_record_topics,
+              gflags::StringFromEnv("PL_SOCKET_TRACER_KAFKA_RECORD_TOPICS", ""),
+              "Comma-separated list of Kafka topics whose record keys and values are captured in "
+              "Produce requests and Fetch responses, or '*' for all topics. Only record batch "
+              "metadata is decoded for other topics.");
+
 namespace px {
 namespace stirling {
 namespace protocols {
@@ -95,9 +101,16 @@ Status ProcessMetadataReq(PacketDecoder* decoder, Request* req) {
   return Status::OK();
 }
 
+const RecordTopicFilter& KafkaRecordTopicFilter() {
+  // Parse the flag on the first time only.
+  static const RecordTopicFilter kFilter(FLAGS_socket_tracer_kafka_record_topics);
+  return kFilter;
+}
+
 Status ProcessReq(Packet* req_packet, Request* req) {
   req->timestamp_ns = req_packet->timestamp_ns;
   PacketDecoder decoder(*req_packet);
+  decoder.set_record_topic_filter(&KafkaRecordTopicFilter());
   // Extracts api_key, api_version, and correlation_id.
   PX_RETURN_IF_ERROR(decoder.ExtractReqHeader(req));
 
@@ -122,6 +135,7 @@ Status ProcessReq(Packet* req_packet, Request* req) {
 Status ProcessResp(Packet* resp_packet, Response* resp, APIKey api_key, int16_t api_version) {
   resp->timestamp_ns = resp_packet->timestamp_ns;
   PacketDecoder decoder(*resp_packet);
+  decoder.set_record_topic_filter(&KafkaRecordTopicFilter());
   decoder.SetAPIInfo(api_key, api_version);
 
   PX_RETURN_IF_ERROR(decoder.ExtractRespHeader(resp));
@@ -19,7 +19,9 @@
 #include <libbson-1.0/bson.h>
 
 #include <rapidjson/document.h>
+#include <algorithm>
 #include <string>
+#include <string_view>
 
 #include "src/common/base/base.h"
 #include "src/common/base/utils.h"
@@ -27,11 +29,75 @@
 #include "src/stirling/source_connectors/socket_tracer/protocols/mongodb/types.h"
 #include "src/stirling/utils/binary_decoder.h"
 
+DEFINE_uint32(mongodb_body_limit_bytes,
+              gflags::Uint32FromEnv("PX_STIRLING_MONGODB_BODY_LIMIT_BYTES", 1024),
+              "The amount of the documents of a MongoDB message that is converted to JSON on a "
+              "parse. The rest of the documents are only walked for the command type.");
+
 namespace px {
 namespace stirling {
 namespace protocols {
 namespace mongodb {
 
+namespace {
+
+// Sets the op_msg_type of the frame from the kind 0 section document. It walks the keys of the
+// document with a BSON iterator, instead of converting the whole document to JSON.
+ParseState ProcessOpMsgType(const bson_t* doc, Frame* frame) {
+  bson_iter_t iter;
+  if (!bson_iter_init(&iter, doc) || !bson_iter_next(&iter)) {
+    return ParseState::kInvalid;
+  }
+
+  // The type of all request commands and the response to all find command requests
+  // will always be the first key.
+  std::string_view op_msg_type = bson_iter_key(&iter);
+  if ((op_msg_type == kInsert || op_msg_type == kDelete || op_msg_type == kUpdate ||
+       op_msg_type == kFind || op_msg_type == kCursor)) {
+    frame->op_msg_type = op_msg_type;
+    return ParseState::kSuccess;
+  }
+  if (op_msg_type == kHello || op_msg_type == kIsMaster || op_msg_type == kIsMasterAlternate) {
+    // The frame is a handshaking message.
+    frame->op_msg_type = op_msg_type;
+    frame->is_handshake = true;
+    return ParseState::kSuccess;
+  }
+
+  // The frame is a response message, find the "ok" key and its value.
+  if (!bson_iter_init_find(&iter, doc, kOk.data())) {
+    return ParseState::kInvalid;
+  }
+  // Only the "ok" element is converted to JSON, which formats its value the same way as in the
+  // document's JSON, e.g. {"$numberDouble": "1.0"}.
+  bson_t ok_doc;
+  bson_init(&ok_doc);
+  DEFER(bson_destroy(&ok_doc));
+  if (!bson_append_iter(&ok_doc, kOk.data(), static_cast<int>(kOk.size()), &iter)) {
+    return ParseState::kInvalid;
+  }
+  char* json = bson_as_canonical_extended_json(&ok_doc, NULL);
+  DEFER(bson_free(json));
+  if (json == NULL) {
+    return ParseState::kInvalid;
+  }
+  rapidjson::Document ok_json;
+  ok_json.Parse(json);
+  if (ok_json.HasParseError() || !ok_json.IsObject()) {
+    return ParseState::kInvalid;
+  }
+  const rapidjson::Value& value = ok_json.MemberBegin()->value;
+  if (value.IsObject() && value.MemberCount() > 0 && value.MemberBegin()->value.IsString()) {
+    frame->op_msg_type = absl::Substitute("ok: {$0: $1}", value.MemberBegin()->name.GetString(),
+                                          value.MemberBegin()->value.GetString());
+  } else if (value.IsInt()) {
+    frame->op_msg_type = absl::Substitute("ok: $0", value.GetInt());
+  }
+  return ParseState::kSuccess;
+}
+
+}  // namespace
+
 ParseState ProcessOpMsg(BinaryDecoder* decoder, Frame* frame) {
   PX_ASSIGN_OR(uint32_t flag_bits, decoder->ExtractLEInt<uint32_t>(), return ParseState::kInvalid);
 
@@ -47,6 +113,9 @@ ParseState ProcessOpMsg(BinaryDecoder* decoder, Frame* frame) {
   // Determine the number of checksum bytes in the buffer.
   const size_t checksum_bytes = (frame->checksum_present) ? 4 : 0;
 
+  // The bytes of the documents' JSON still to be kept, including a separator for each document.
+  size_t body_budget = FLAGS_mongodb_body_limit_bytes;
+
   // Get the section(s) data from the buffer.
   auto all_sections_length = frame->length - kHeaderAndFlagSize - checksum_bytes;
   while (all_sections_length > 0) {
@@ -87,7 +156,7 @@ ParseState ProcessOpMsg(BinaryDecoder* decoder, Frame* frame) {
 
     // Extract the document(s) from the section and convert it from type BSON to a JSON string.
     while (remaining_section_length > 0) {
-      // We can't extract the length bytes since bson_new_from_data() expects those bytes in
+      // We can't extract the length bytes since bson_init_static() expects those bytes in
       // the data as well as the expected length in another parameter.
       auto document_length = utils::LEndianBytesToInt<int32_t, 4>(decoder->Buf());
       if (document_length > kMaxBSONObjSize) {
@@ -104,53 +173,35 @@ ParseState ProcessOpMsg(BinaryDecoder* decoder, Frame* frame) {
         continue;
       }
 
-      bson_t* bson_doc = bson_new_from_data(section_body.data(), document_length);
-      DEFER(bson_destroy(bson_doc));
-      if (bson_doc == NULL) {
-        return ParseState::kInvalid;
-      }
-      char* json = bson_as_canonical_extended_json(bson_doc, NULL);
-      DEFER(bson_free(json));
-      if (json == NULL) {
+      // The document is read in place, rather than copied.
+      bson_t bson_doc;
+      if (!bson_init_static(&bson_doc, section_body.data(), document_length)) {
         return ParseState::kInvalid;
       }
 
       // Find the type of command argument from the kind 0 section.
       if (static_cast<SectionKind>(section.kind) == SectionKind::kSectionKindZero) {
-        rapidjson::Document doc;
-        doc.Parse(json);
-
-        // The type of all request commands and the response to all find command requests
-        // will always be the first key.
-        auto op_msg_type = doc.MemberBegin()->name.GetString();
-        if ((op_msg_type == kInsert || op_msg_type == kDelete || op_msg_type == kUpdate ||
-             op_msg_type == kFind || op_msg_type == kCursor)) {
-          frame->op_msg_type = op_msg_type;
-
-        } else if (op_msg_type == kHello || op_msg_type == kIsMaster ||
-                   op_msg_type == kIsMasterAlternate) {
-          // The frame is a handshaking message.
-          frame->op_msg_type = op_msg_type;
-          frame->is_handshake = true;
-
-        } else {
-          // The frame is a response message, find the "ok" key and its value.
-          auto itr = doc.FindMember("ok");
-          if (itr == doc.MemberEnd()) {
-            return ParseState::kInvalid;
-          }
-
-          if (itr->value.IsObject()) {
-            frame->op_msg_type =
-                absl::Substitute("ok: {$0: $1}", itr->value.MemberBegin()->name.GetString(),
-                                 itr->value.MemberBegin()->value.GetString());
-          } else if (itr->value.IsNumber()) {
-            frame->op_msg_type = absl::Substitute("ok: $0", std::to_string(itr->value.GetInt()));
-          }
+        ParseState op_msg_type_state = ProcessOpMsgType(&bson_doc, frame);
+        if (op_msg_type_state != ParseState::kSuccess) {
+          return op_msg_type_state;
         }
       }
 
-      section.documents.push_back(json);
+      // Only the start of the body is recorded, so the documents past it are not converted.
+      if (body_budget > 0) {
+        // The JSON is truncated to max_len bytes.
+        bson_json_opts_t* json_opts = bson_json_opts_new(BSON_JSON_MODE_CANONICAL,
+                                                            static_cast<int32_t>(body_budget));
+        DEFER(bson_json_opts_destroy(json_opts));
+        size_t json_length = 0;
+        char* json = bson_as_json_with_opts(&bson_doc, &json_length, json_opts);
+        DEFER(bson_free(json));
+        if (json == NULL) {
+          return ParseState::kInvalid;
+        }
+        section.documents.emplace_back(json, json_length);
+        body_budget -= std::min(body_budget, json_length + 1);
+      }
       remaining_section_length -= document_length;
     }
     frame->sections.push_back(section);
@@ -18,9 +18,12 @@
 
 #pragma once
 
+#include "src/common/base/base.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/mongodb/types.h"
 #include "src/stirling/utils/binary_decoder.h"
 
+DECLARE_uint32(mongodb_body_limit_bytes);
+
 namespace px {
 namespace stirling {
 namespace protocols {
@@ -17,6 +17,7 @@
  */
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/mongodb/parse.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/mongodb/decode.h"
 
 #include <string>
 #include <utility>
@@ -29,6 +30,9 @@ namespace stirling {
 namespace protocols {
 namespace mongodb {
 
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+
 // clang-format off
 
 constexpr uint8_t mongoDBNeedMoreHeaderData[] = {
@@ -507,6 +511,26 @@ TEST_F(MongoDBParserTest, ParseFrameValidResponse) {
   EXPECT_EQ(state, ParseState::kSuccess);
 }
 
+TEST_F(MongoDBParserTest, ParseFrameTruncatesDocumentsPastBodyLimit) {
+  PX_SET_FOR_SCOPE(FLAGS_mongodb_body_limit_bytes, 10);
+  auto frame_view =
+      CreateStringView<char>(CharArrayStringView<uint8_t>(mongoDBValidRequestTwoSections));
+
+  mongodb::Frame frame;
+  StateWrapper state_order{};
+
+  ParseState state = ParseFrame(message_type_t::kRequest, &frame_view, &frame, &state_order);
+
+  EXPECT_EQ(state, ParseState::kSuccess);
+  // The command type still comes from the whole document.
+  EXPECT_EQ(frame.op_msg_type, "insert");
+  ASSERT_THAT(frame.sections, SizeIs(2));
+  ASSERT_THAT(frame.sections[0].documents, SizeIs(1));
+  EXPECT_EQ(frame.sections[0].documents[0].size(), 10);
+  // The budget is used up by the first document, so the second one isn't converted.
+  EXPECT_THAT(frame.sections[1].documents, IsEmpty());
+}
+
 TEST_F(MongoDBParserTest, ParseFrameValidRequestTwoSections) {
   auto frame_view =
       CreateStringView<char>(CharArrayStringView<uint8_t>(mongoDBValidRequestTwoSections));
@@ -115,10 +115,14 @@ RecordsWithErrorCount<mongodb::Record> StitchFrames(
     // Response deque for the stream ID.
     auto& resp_deque = resp_it->second;
 
-    // Find the stream ID's request deque.
+    // Find the stream ID's request deque. The state contained the stream ID, but its requests may
+    // have expired since, and an idle stream's deque is released by DataStream::CleanupFrames().
     auto req_it = reqs->find(stream_id);
-    // The request deque should exist in the reqs map since the state contained the stream ID.
-    CTX_DCHECK(req_it != reqs->end());
+    if (req_it == reqs->end() || req_it->second.empty()) {
+      VLOG(1) << absl::Substitute("Did not find any requests with the stream ID: $0", stream_id);
+      stream_id_pair.second = true;
+      continue;
+    }
 
     // Request deque for the stream ID.
     auto& req_deque = req_it->second;
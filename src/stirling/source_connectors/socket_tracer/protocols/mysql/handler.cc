@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "src/common/base/byte_utils.h"
+#include "src/common/base/str_builder.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/mysql/packet_utils.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/mysql/parse_utils.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/mysql/types.h"
@@ -190,15 +191,35 @@ StatusOr<ParseState> HandleResultsetResponse(DequeView<Packet> resp_packets, Rec
     resp_packets.pop_front();
   }
 
-  std::vector<ResultsetRow> results;
+  // Only the number of rows is kept, so only the first rows are checked to be valid, to confirm
+  // that this is a resultset. The rest are skipped over, up to the packet that ends the resultset.
+  constexpr size_t kMaxCheckedRows = 16;
+  size_t num_rows = 0;
 
   auto isLastPacket = [](const Packet& p) {
     return (IsErrPacket(p) || IsOKPacket(p) || IsEOFPacket(p));
   };
 
+  // Rows never start with the header of an EOF (0xfe) or ERR (0xff) packet, except text rows
+  // whose first value is longer than 2^24 bytes. The OK packets that end resultsets if
+  // CLIENT_DEPRECATE_EOF is set also use the EOF header, but older servers send the OK header,
+  // which binary rows start with too; these are only recognized as the last packet of the response.
+  auto isSkippedRow = [&isLastPacket, &resp_packets](const Packet& p) {
+    const uint8_t header = p.msg[0];
+    const bool maybe_last =
+        header == kRespHeaderEOF || header == kRespHeaderErr || resp_packets.size() == 1;
+    return !(maybe_last && isLastPacket(p));
+  };
+
   while (!resp_packets.empty()) {
     const Packet& row_packet = resp_packets.front();
 
+    if (num_rows >= kMaxCheckedRows && isSkippedRow(row_packet)) {
+      resp_packets.pop_front();
+      ++num_rows;
+      continue;
+    }
+
     Status s;
     // TODO(chengruizhe): Get actual results from the resultset row packets if needed.
     // Attempt to process it as a resultset row packet first. Process[Text/Binary]ResultRowPacket
@@ -212,8 +233,7 @@ StatusOr<ParseState> HandleResultsetResponse(DequeView<Packet> resp_packets, Rec
 
     if (s.ok()) {
       resp_packets.pop_front();
-      ResultsetRow row{row_packet.msg};
-      results.emplace_back(std::move(row));
+      ++num_rows;
     } else if (isLastPacket(row_packet)) {
       break;
     } else {
@@ -237,7 +257,7 @@ StatusOr<ParseState> HandleResultsetResponse(DequeView<Packet> resp_packets, Rec
   if (multi_resultset) {
     absl::StrAppend(&entry->resp.msg, ", ");
   }
-  absl::StrAppend(&entry->resp.msg, "Resultset rows = ", results.size());
+  absl::StrAppend(&entry->resp.msg, "Resultset rows = ", num_rows);
 
   // Check for another resultset in case this is a multi-resultset.
   if (MoreResultsExist(last_packet)) {
@@ -344,12 +364,13 @@ StatusOr<ParseState> HandleStmtPrepareOKResponse(DequeView<Packet> resp_packets,
   }
 
   // Update state.
-  state->prepared_statements.emplace(
-      stmt_id,
-      PreparedStatement{.request = entry->req.msg,
-                        .response = StmtPrepareOKResponse{.header = resp_header,
-                                                          .col_defs = std::move(col_defs),
-                                                          .param_defs = std::move(param_defs)}});
+  PreparedStatement prepared_stmt{
+      .request = entry->req.msg,
+      .response = StmtPrepareOKResponse{.header = resp_header,
+                                        .col_defs = std::move(col_defs),
+                                        .param_defs = std::move(param_defs)}};
+  const size_t byte_size = prepared_stmt.ByteSize();
+  state->prepared_statements.Put(stmt_id, std::move(prepared_stmt), byte_size);
 
   entry->resp.status = RespStatus::kOK;
   return ParseState::kSuccess;
@@ -380,18 +401,22 @@ StatusOr<ParseState> HandleNonStringRequest(const Packet& req_packet, Record* en
 namespace {
 std::string CombinePrepareExecute(std::string_view stmt_prepare_request,
                                   const std::vector<StmtExecuteParam>& params) {
-  std::string result = absl::Substitute("query=[$0] params=[", stmt_prepare_request);
-  // Implements absl::StrJoin manually to avoid the extra copies going from
-  // std::vector<StmtExecuteParam> to std::vector<std::string> and then std::string via
-  // absl::StrJoin.
-  for (const auto& [i, param] : Enumerate(params)) {
-    result += param.value;
-    if (i < params.size() - 1) {
-      result += ", ";
-    }
-  }
-  result += "]";
-  return result;
+  constexpr std::string_view kPrefix = "query=[";
+  constexpr std::string_view kInfix = "] params=[";
+  constexpr std::string_view kSep = ", ";
+
+  // Size the buffer up front, so that the query is formatted with a single allocation.
+  size_t size = kPrefix.size() + stmt_prepare_request.size() + kInfix.size() + 1;
+  for (const auto& param : params) {
+    size += param.value.size() + kSep.size();
+  }
+
+  StrBuilder sb(size);
+  sb.Append(kPrefix, stmt_prepare_request, kInfix);
+  sb.AppendJoin(params, kSep,
+                [](StrBuilder* out, const StmtExecuteParam& param) { out->Append(param.value); });
+  sb.Append("]");
+  return sb.Release();
 }
 
 // Spec on how to dissect params is here:
@@ -462,7 +487,7 @@ Status ProcessStmtExecuteParam(std::string_view msg, size_t* type_offset, size_t
 }  // namespace
 
 StatusOr<ParseState> HandleStmtExecuteRequest(const Packet& req_packet,
-                                              std::map<int, PreparedStatement>* prepare_map,
+                                              PreparedStatementCache* prepare_map,
                                               Record* entry) {
   if (req_packet.msg.size() < 1 + kStmtIDBytes) {
     return error::Internal("Insufficient number of bytes for STMT_EXECUTE");
@@ -474,11 +499,12 @@ StatusOr<ParseState> HandleStmtExecuteRequest(const Packet& req_packet,
   int stmt_id =
       utils::LEndianBytesToInt<int, kStmtIDBytes>(req_packet.msg.substr(kStmtIDStartOffset));
 
-  auto iter = prepare_map->find(stmt_id);
-  if (iter == prepare_map->end()) {
-    // There can be 2 possibilities in this case:
+  const PreparedStatement* prepared_stmt = prepare_map->Get(stmt_id);
+  if (prepared_stmt == nullptr) {
+    // There can be 3 possibilities in this case:
     // 1. The stitcher is confused/messed up and accidentally deleted wrong prepare event.
     // 2. Client sent a Stmt Exec for a deleted Stmt Prepare
+    // 3. The Stmt Prepare was evicted from the cache, to bound its memory.
     // We return -1 as stmt_id to indicate error and defer decision to the caller.
 
     // We can't determine whether the rest of this packet is valid or not, so just return success.
@@ -491,7 +517,7 @@ StatusOr<ParseState> HandleStmtExecuteRequest(const Packet& req_packet,
     return ParseState::kSuccess;
   }
 
-  int num_params = iter->second.response.header.num_params;
+  int num_params = prepared_stmt->response.header.num_params;
 
   size_t offset = kStmtIDStartOffset + kStmtIDBytes + kFlagsBytes + kIterationCountBytes;
 
@@ -520,14 +546,14 @@ StatusOr<ParseState> HandleStmtExecuteRequest(const Packet& req_packet,
     }
   }
 
-  std::string_view stmt_prepare_request = iter->second.request;
+  std::string_view stmt_prepare_request = prepared_stmt->request;
   entry->req.msg = CombinePrepareExecute(stmt_prepare_request, params);
 
   return ParseState::kSuccess;
 }
 
 StatusOr<ParseState> HandleStmtCloseRequest(const Packet& req_packet,
-                                            std::map<int, PreparedStatement>* prepare_map,
+                                            PreparedStatementCache* prepare_map,
                                             Record* entry) {
   if (req_packet.msg.size() < 1 + kStmtIDBytes) {
     return error::Internal("Insufficient number of bytes for STMT_CLOSE");
@@ -539,10 +565,7 @@ StatusOr<ParseState> HandleStmtCloseRequest(const Packet& req_packet,
 
   int stmt_id =
       utils::LEndianBytesToInt<int, kStmtIDBytes>(req_packet.msg.substr(kStmtIDStartOffset));
-  auto iter = prepare_map->find(stmt_id);
-  if (iter != prepare_map->end()) {
-    prepare_map->erase(iter);
-  } else {
+  if (!prepare_map->Erase(stmt_id)) {
     // We may have missed the prepare statement (e.g. due to the missing start of connection
     // problem), but we can still process the close, and continue on. Just print a warning.
     entry->px_info = absl::Substitute(
@@ -72,6 +72,34 @@ TEST(HandleResultsetResponse, ValidNoEOF) {
   EXPECT_EQ(entry.resp.msg, "Resultset rows = 2");
 }
 
+TEST(HandleResultsetResponse, ManyRows) {
+  // Rows past the first ones are counted without being parsed.
+  Resultset resultset = testdata::kQueryResultset;
+  for (int i = 0; i < 100; ++i) {
+    resultset.results.push_back(ResultsetRow{testutils::LengthEncodedString(std::to_string(i))});
+  }
+
+  for (bool client_eof_deprecate : {false, true}) {
+    std::deque<Packet> resp_packets = testutils::GenResultset(resultset, client_eof_deprecate);
+
+    Record entry;
+    EXPECT_OK_AND_EQ(HandleResultsetResponse(resp_packets, &entry, /* binaryresultset */ false,
+                                             /* multiresultset */ false),
+                     ParseState::kSuccess);
+    EXPECT_EQ(entry.resp.status, RespStatus::kOK);
+    EXPECT_EQ(entry.resp.msg, "Resultset rows = 103");
+
+    // Missing the end of the resultset still needs more data.
+    resp_packets = testutils::GenResultset(resultset, client_eof_deprecate);
+    resp_packets.pop_back();
+    Record partial_entry;
+    EXPECT_OK_AND_EQ(HandleResultsetResponse(resp_packets, &partial_entry,
+                                             /* binaryresultset */ false,
+                                             /* multiresultset */ false),
+                     ParseState::kNeedsMoreData);
+  }
+}
+
 TEST(HandleResultsetResponse, NeedsMoreData) {
   // Test for incomplete response.
   std::deque<Packet> resp_packets = testutils::GenResultset(testdata::kStmtExecuteResultset);
@@ -145,8 +173,8 @@ TEST(HandleStmtExecuteRequest, Basic) {
   Packet req_packet = testutils::GenStmtExecuteRequest(testdata::kStmtExecuteRequest);
   PreparedStatement prepared_stmt = testdata::kPreparedStatement;
   int stmt_id = prepared_stmt.response.header.stmt_id;
-  std::map<int, PreparedStatement> prepare_map;
-  prepare_map.emplace(stmt_id, std::move(prepared_stmt));
+  PreparedStatementCache prepare_map;
+  prepare_map.Put(stmt_id, prepared_stmt, prepared_stmt.ByteSize());
 
   Record entry;
   EXPECT_OK_AND_EQ(HandleStmtExecuteRequest(req_packet, &prepare_map, &entry),
@@ -114,6 +114,14 @@ size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start
   return std::string::npos;
 }
 
+size_t FrameSizeHint(std::string_view buf) {
+  if (buf.size() < kPacketHeaderLength) {
+    return 0;
+  }
+  int packet_length = utils::LEndianBytesToInt<int, kPayloadLengthLength>(buf);
+  return kPacketHeaderLength + packet_length;
+}
+
 }  // namespace mysql
 
 template <>
@@ -128,6 +136,11 @@ size_t FindFrameBoundary<mysql::Packet>(message_type_t type, std::string_view bu
   return mysql::FindFrameBoundary(type, buf, start_pos);
 }
 
+template <>
+size_t FrameSizeHint<mysql::Packet>(message_type_t /*type*/, std::string_view buf) {
+  return mysql::FrameSizeHint(buf);
+}
+
 }  // namespace protocols
 }  // namespace stirling
 }  // namespace px
@@ -291,6 +291,7 @@ TEST_F(MySQLParserTest, ParseIncompleteRequest) {
       ParseFramesLoop(message_type_t::kRequest, msg1, &parsed_messages, &state);
 
   EXPECT_EQ(ParseState::kNeedsMoreData, result.state);
+  EXPECT_EQ(result.incomplete_frame_size, kPacketHeaderLength + 0x24u);
   EXPECT_THAT(parsed_messages[0], ElementsAre());
 }
 
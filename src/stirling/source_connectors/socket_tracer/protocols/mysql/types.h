@@ -30,6 +30,7 @@
 
 #include "src/common/base/base.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/event_parser.h"  // For FrameBase
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/statement_cache.h"
 #include "src/stirling/utils/utils.h"
 
 namespace px {
@@ -345,14 +346,29 @@ struct StmtCloseRequest {
 struct PreparedStatement {
   std::string request;
   StmtPrepareOKResponse response;
+
+  // An estimate of the memory held by the statement.
+  size_t ByteSize() const {
+    size_t byte_size = sizeof(PreparedStatement) + request.size();
+    for (const auto* defs : {&response.col_defs, &response.param_defs}) {
+      for (const ColDefinition& def : *defs) {
+        byte_size += sizeof(ColDefinition) + def.catalog.size() + def.schema.size() +
+                     def.table.size() + def.org_table.size() + def.name.size() +
+                     def.org_name.size();
+      }
+    }
+    return byte_size;
+  }
 };
 
+using PreparedStatementCache = StatementCache<int, PreparedStatement>;
+
 /**
- * State stores a map of stmt_id to active StmtPrepare event. It's used to be looked up
+ * State stores the active StmtPrepare events by stmt_id. It's used to be looked up
  * for the StmtPrepare event when a StmtExecute is received.
  */
 struct State {
-  std::map<int, PreparedStatement> prepared_statements;
+  PreparedStatementCache prepared_statements;
   // To prevent pushing data on mis-classified connections,
   // we start off in inactive state, which means no data will be pushed out.
   // Only on certain conditions, which increase our confidence that the data is indeed MySQL,
@@ -48,6 +48,10 @@ RecordsWithErrorCount<nats::Record> StitchFrames(std::deque<nats::Message>* req_
                                                  std::deque<nats::Message>* resp_msgs,
                                                  NoState* /* state */) {
   std::vector<nats::Record> records;
+  // Nearly every message becomes its own record, so size the output for bursts of MSG messages
+  // upfront instead of growing it one record at a time.
+  records.reserve(req_msgs->size() + resp_msgs->size());
+
   auto req_iter = req_msgs->begin();
   auto resp_iter = resp_msgs->begin();
 
@@ -71,6 +71,18 @@ class DequeView {
 // TODO(yzhao): Format in JSON.
 // TODO(yzhao): Do not call parsing code inside.
 
+// Parses the data row into the response, or only counts it past QueryResp::kMaxDataRows.
+Status AddDataRow(const RegularMessage& msg, QueryReqResp::QueryResp* resp) {
+  if (resp->data_rows.size() >= QueryReqResp::QueryResp::kMaxDataRows) {
+    ++resp->num_skipped_data_rows;
+    return Status::OK();
+  }
+  DataRow data_row;
+  PX_RETURN_IF_ERROR(ParseDataRow(msg, &data_row));
+  resp->data_rows.push_back(std::move(data_row));
+  return Status::OK();
+}
+
 }  // namespace
 
 // Find the messages of query response. The result argument begin is advanced past the right most
@@ -123,9 +135,7 @@ Status FillQueryResp(MsgDeqIter* resp_iter, const MsgDeqIter& end, QueryReqResp:
     // CommandComplete. Therefore we should not break out of the for loop once the first DataRow
     // message is parsed.
     if (iter->tag == Tag::kDataRow) {
-      DataRow data_row;
-      PX_RETURN_IF_ERROR(ParseDataRow(*iter, &data_row));
-      resp->data_rows.push_back(std::move(data_row));
+      PX_RETURN_IF_ERROR(AddDataRow(*iter, resp));
       iter->consumed = true;
     }
   }
@@ -198,12 +208,10 @@ Status HandleQuery(const RegularMessage& msg, MsgDeqIter* resp_iter, const MsgDe
     // CommandComplete. Therefore we should not break out of the for loop once the first DataRow
     // message is parsed.
     if (iter->tag == Tag::kDataRow) {
-      DataRow data_row;
-      PX_RETURN_IF_ERROR(ParseDataRow(*iter, &data_row));
+      PX_RETURN_IF_ERROR(AddDataRow(*iter, &req_resp->resp));
 
       iter->consumed = true;
-      req_resp->resp.timestamp_ns = data_row.timestamp_ns;
-      req_resp->resp.data_rows.push_back(std::move(data_row));
+      req_resp->resp.timestamp_ns = iter->timestamp_ns;
     }
   }
 
@@ -244,7 +252,8 @@ Status HandleParse(const RegularMessage& msg, MsgDeqIter* resp_iter, const MsgDe
     if (parse.stmt_name.empty()) {
       state->unnamed_statement = parse.query;
     } else {
-      state->prepared_statements[parse.stmt_name] = parse.query;
+      const size_t byte_size = parse.stmt_name.size() + parse.query.size();
+      state->prepared_statements.Put(parse.stmt_name, parse.query, byte_size);
     }
     req_resp->resp.msg = CmdCmpl{.timestamp_ns = iter->timestamp_ns, .cmd_tag = kParseCmplText};
   }
@@ -280,13 +289,16 @@ Status HandleBind(const RegularMessage& bind_msg, MsgDeqIter* resp_iter, const M
     if (bind_req.src_prepared_stat_name.empty()) {
       state->bound_statement = state->unnamed_statement;
     } else {
-      if (!state->prepared_statements.contains(bind_req.src_prepared_stat_name)) {
+      const std::string* statement =
+          state->prepared_statements.Get(bind_req.src_prepared_stat_name);
+      if (statement == nullptr) {
         // TODO(yzhao): The code should handle the case where the previous Parse message was not
-        // seen, i.e., state->prepared_statements does not contain the requested statement name.
+        // seen, or was evicted, i.e., state->prepared_statements does not contain the requested
+        // statement name.
         return error::InvalidArgument("Statement [name=$0] is not recorded",
                                       bind_req.src_prepared_stat_name);
       }
-      state->bound_statement = state->prepared_statements[bind_req.src_prepared_stat_name];
+      state->bound_statement = *statement;
     }
     state->bound_params = bind_req.params;
     req_resp->resp.msg = CmdCmpl{.timestamp_ns = iter->timestamp_ns, .cmd_tag = "BIND COMPLETE"};
@@ -404,11 +416,13 @@ Status HandleExecute(const RegularMessage& msg, MsgDeqIter* resps_begin,
   if (status.ok()) {                                      \
     req.consumed = true;                                  \
     CTX_DCHECK_NE(req.timestamp_ns, 0U);                  \
-    req.payload = req_resp.req.ToString();                \
+    req_resp.req.AppendTo(&sb);                           \
+    req.payload = sb.Take();                              \
     RegularMessage resp;                                  \
     resp.timestamp_ns = req_resp.resp.timestamp_ns;       \
     CTX_DCHECK_NE(resp.timestamp_ns, 0U);                 \
-    resp.payload = req_resp.resp.ToString();              \
+    req_resp.resp.AppendTo(&sb);                          \
+    resp.payload = sb.Take();                             \
     records.push_back({std::move(req), std::move(resp)}); \
   } else {                                                \
     VLOG(2) << "Encountered error: " << status;           \
@@ -420,6 +434,8 @@ RecordsWithErrorCount<pgsql::Record> StitchFrames(std::deque<pgsql::RegularMessa
                                                   State* state) {
   std::vector<pgsql::Record> records;
   int error_count = 0;
+  // Formats the payloads of all records, so that its buffer is allocated once per call.
+  StrBuilder sb;
   auto req_iter = reqs->begin();
   auto resp_iter = resps->begin();
   // PostgreSQL query mode:
@@ -31,6 +31,7 @@ namespace pgsql {
 
 using ::testing::ElementsAre;
 using ::testing::ElementsAreArray;
+using ::testing::EndsWith;
 using ::testing::Field;
 using ::testing::IsEmpty;
 using ::testing::SizeIs;
@@ -68,6 +69,33 @@ TEST(PGSQLParseTest, FillQueryResp) {
   EXPECT_EQ(begin, resps.end());
 }
 
+// Tests that only the first rows of a large response are kept.
+TEST(PGSQLParseTest, FillQueryRespManyRows) {
+  auto row_desc_data = kRowDescTestData;
+  auto data_row_data = kDataRowTestData;
+
+  RegularMessage row_desc = {};
+  RegularMessage data_row = {};
+  RegularMessage cmd_cmpl = {};
+  cmd_cmpl.tag = Tag::kCmdComplete;
+  cmd_cmpl.payload = "SELECT 100";
+
+  EXPECT_EQ(ParseState::kSuccess, ParseRegularMessage(&row_desc_data, &row_desc));
+  EXPECT_EQ(ParseState::kSuccess, ParseRegularMessage(&data_row_data, &data_row));
+
+  std::deque<RegularMessage> resps = {row_desc};
+  resps.insert(resps.end(), 100, data_row);
+  resps.push_back(cmd_cmpl);
+
+  QueryReqResp::QueryResp query_resp;
+  auto begin = resps.begin();
+  ASSERT_OK(FillQueryResp(&begin, resps.end(), &query_resp));
+  EXPECT_EQ(query_resp.data_rows.size(), QueryReqResp::QueryResp::kMaxDataRows);
+  EXPECT_EQ(query_resp.num_skipped_data_rows, 100 - QueryReqResp::QueryResp::kMaxDataRows);
+  EXPECT_THAT(query_resp.ToString(), EndsWith("[36 more rows]\nSELECT 100"));
+  EXPECT_EQ(begin, resps.end());
+}
+
 TEST(PGSQLParseTest, FillQueryRespFailures) {
   std::deque<RegularMessage> resps;
   auto begin = resps.begin();
@@ -240,7 +268,7 @@ class HandleBindTest : public ::testing::TestWithParam<HandleBindTestCase> {
   void SetUp() override {
     constexpr char kStmt[] = "select $1, $2 from t";
     state_.unnamed_statement = kStmt;
-    state_.prepared_statements["foo"] = kStmt;
+    state_.prepared_statements.Put("foo", kStmt, sizeof(kStmt));
   }
 
   State state_;
@@ -38,4 +38,21 @@ static void BM_row_desc_tostring(benchmark::State& state) {
   }
 }
 
+// NOLINTNEXTLINE(runtime/references)
+static void BM_row_desc_append_to_reused_builder(benchmark::State& state) {
+  RowDesc::Field field = {"id", 18427, 1, 2950, 16, -1, FmtCode::kText};
+  RowDesc row_desc;
+  for (int i = 0; i < state.range(0); ++i) {
+    row_desc.fields.push_back(field);
+  }
+
+  px::StrBuilder sb;
+  for (auto _ : state) {
+    row_desc.AppendTo(&sb);
+    std::string out = sb.Take();
+    benchmark::DoNotOptimize(out);
+  }
+}
+
 BENCHMARK(BM_row_desc_tostring)->DenseRange(1, 10, 1);
+BENCHMARK(BM_row_desc_append_to_reused_builder)->DenseRange(1, 10, 1);
@@ -24,9 +24,10 @@
 #include <utility>
 #include <vector>
 
-#include <absl/container/flat_hash_map.h>
 
+#include "src/common/base/str_builder.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/event_parser.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/statement_cache.h"
 #include "src/stirling/utils/utils.h"
 
 namespace px {
@@ -166,9 +167,18 @@ struct RegularMessage : public FrameBase {
   }
 };
 
+// The formatting below appends into a StrBuilder, so that the stitcher can format all records
+// through one reused buffer. ToString() is kept for logging and tests.
 template <typename TValue>
-struct ToStringFormatter {
-  void operator()(std::string* out, const TValue& v) const { out->append(v.ToString()); }
+std::string AppendToString(const TValue& v) {
+  StrBuilder sb;
+  v.AppendTo(&sb);
+  return sb.Release();
+}
+
+template <typename TValue>
+struct AppendToFormatter {
+  void operator()(StrBuilder* sb, const TValue& v) const { v.AppendTo(sb); }
 };
 
 /**
@@ -222,9 +232,11 @@ struct Param {
     return "[NULL]";
   }
 
-  std::string ToString() const {
-    return absl::Substitute("[format=$0 value=$1]", magic_enum::enum_name(format_code), Value());
+  void AppendTo(StrBuilder* sb) const {
+    sb->Append("[format=", magic_enum::enum_name(format_code), " value=", Value(), "]");
   }
+
+  std::string ToString() const { return AppendToString(*this); }
 };
 
 inline bool operator==(const Param& lhs, const Param& rhs) {
@@ -242,17 +254,21 @@ struct BindRequest {
   std::vector<FmtCode> res_col_fmt_codes;
 
   struct FmtCodeFormatter {
-    void operator()(std::string* out, FmtCode fmt_code) const {
-      out->append(magic_enum::enum_name(fmt_code));
+    void operator()(StrBuilder* sb, FmtCode fmt_code) const {
+      sb->Append(magic_enum::enum_name(fmt_code));
     }
   };
 
-  std::string ToString() const {
-    return absl::Substitute("portal=$0 statement=$1 parameters=[$2] result_format_codes=[$3]",
-                            dest_portal_name, src_prepared_stat_name,
-                            absl::StrJoin(params, ", ", ToStringFormatter<Param>()),
-                            absl::StrJoin(res_col_fmt_codes, ", ", FmtCodeFormatter()));
+  void AppendTo(StrBuilder* sb) const {
+    sb->Append("portal=", dest_portal_name, " statement=", src_prepared_stat_name,
+               " parameters=[");
+    sb->AppendJoin(params, ", ", AppendToFormatter<Param>());
+    sb->Append("] result_format_codes=[");
+    sb->AppendJoin(res_col_fmt_codes, ", ", FmtCodeFormatter());
+    sb->Append("]");
   }
+
+  std::string ToString() const { return AppendToString(*this); }
 };
 
 struct ParamDesc {
@@ -268,6 +284,8 @@ struct Parse {
   std::string_view query;
   std::vector<int32_t> param_type_oids;
 
+  void AppendTo(StrBuilder* sb) const { sb->Append(query); }
+
   std::string ToString() const { return std::string(query); }
 };
 
@@ -284,14 +302,15 @@ struct RowDesc {
     int32_t type_modifier;
     FmtCode fmt_code;
 
-    std::string ToString() const {
-      // RowDesc::ToString() uses too much CPU time if absl::Substitute() is used, which costs
-      // ~200ns CPU time in benchmark. This form using absl::StrCat() uses ~120ns.
-      return absl::StrCat("name=", name, " table_oid=", table_oid, " attr_num=", attr_num,
-                          " type_oid=", type_oid, " type_size=", type_size,
-                          " type_modifier=", type_modifier,
-                          " fmt_code=", magic_enum::enum_name(fmt_code));
+    void AppendTo(StrBuilder* sb) const {
+      // absl::Substitute() costs ~200ns per field in tostring_benchmark, and a temporary
+      // absl::StrCat() string per field ~120ns. Appending in place avoids both.
+      sb->Append("name=", name, " table_oid=", table_oid, " attr_num=", attr_num,
+                 " type_oid=", type_oid, " type_size=", type_size);
+      sb->Append(" type_modifier=", type_modifier, " fmt_code=", magic_enum::enum_name(fmt_code));
     }
+
+    std::string ToString() const { return AppendToString(*this); }
   };
 
   uint64_t timestamp_ns = 0;
@@ -306,16 +325,13 @@ struct RowDesc {
     return result;
   }
 
-  std::string ToString() const {
-    return absl::StrCat(
-        "ROW DESCRIPTION [",
-        absl::StrJoin(fields,
-                      // Avoid one concatenation in Field::ToString(), which saves additional
-                      // 10ns. The version that appends "]" in Field::ToString() costs ~130ns,
-                      // and this version takes ~120ns.
-                      "] [", ToStringFormatter<Field>()),
-        "]");
+  void AppendTo(StrBuilder* sb) const {
+    sb->Append("ROW DESCRIPTION [");
+    sb->AppendJoin(fields, "] [", AppendToFormatter<Field>());
+    sb->Append("]");
   }
+
+  std::string ToString() const { return AppendToString(*this); }
 };
 
 struct Desc {
@@ -329,9 +345,11 @@ struct Desc {
   Type type = Type::kStatement;
   std::string name;
 
-  std::string ToString() const {
-    return absl::Substitute("type=$0 name=$1", magic_enum::enum_name(type), name);
+  void AppendTo(StrBuilder* sb) const {
+    sb->Append("type=", magic_enum::enum_name(type), " name=", name);
   }
+
+  std::string ToString() const { return AppendToString(*this); }
 };
 
 // See https://www.postgresql.org/docs/9.3/protocol-error-fields.html
@@ -364,31 +382,30 @@ struct ErrResp {
     ErrFieldCode code = ErrFieldCode::kUnknown;
     std::string_view value;
 
-    std::string ToString() const {
+    void AppendTo(StrBuilder* sb) const {
       std::string_view field_name = magic_enum::enum_name(code);
       if (field_name.empty()) {
-        std::string unknown_field_name = "Field:";
-        unknown_field_name.append(1, static_cast<char>(code));
-        return absl::StrCat(unknown_field_name, "=", value);
+        sb->Append("Field:").AppendChar(static_cast<char>(code));
       } else {
-        return absl::StrCat(field_name, "=", value);
+        sb->Append(field_name);
       }
+      sb->Append("=", value);
     }
+
+    std::string ToString() const { return AppendToString(*this); }
   };
 
   uint64_t timestamp_ns = 0;
 
   std::vector<Field> fields;
 
-  struct ErrFieldFormatter {
-    void operator()(std::string* out, const ErrResp::Field& err_field) const {
-      out->append(err_field.ToString());
-    }
-  };
-
-  std::string ToString() const {
-    return absl::Substitute("ERROR RESPONSE [$0]", absl::StrJoin(fields, " ", ErrFieldFormatter()));
+  void AppendTo(StrBuilder* sb) const {
+    sb->Append("ERROR RESPONSE [");
+    sb->AppendJoin(fields, " ", AppendToFormatter<Field>());
+    sb->Append("]");
   }
+
+  std::string ToString() const { return AppendToString(*this); }
 };
 
 struct DataRow {
@@ -396,11 +413,13 @@ struct DataRow {
 
   std::vector<std::optional<std::string_view>> cols;
 
-  std::string ToString() const {
-    return absl::StrJoin(cols, ",", [](std::string* out, const std::optional<std::string_view>& d) {
-      out->append(d.has_value() ? d.value() : "[NULL]");
+  void AppendTo(StrBuilder* sb) const {
+    sb->AppendJoin(cols, ",", [](StrBuilder* out, const std::optional<std::string_view>& d) {
+      out->Append(d.has_value() ? d.value() : "[NULL]");
     });
   }
+
+  std::string ToString() const { return AppendToString(*this); }
 };
 
 struct CmdCmpl {
@@ -413,16 +432,19 @@ struct ComboResp {
 
   std::variant<CmdCmpl, ErrResp> msg;
 
-  std::string ToString() const {
+  void AppendTo(StrBuilder* sb) const {
     if (std::holds_alternative<CmdCmpl>(msg)) {
-      return std::string(std::get<CmdCmpl>(msg).cmd_tag);
+      sb->Append(std::get<CmdCmpl>(msg).cmd_tag);
+      return;
     }
     if (std::holds_alternative<ErrResp>(msg)) {
-      return std::get<ErrResp>(msg).ToString();
+      std::get<ErrResp>(msg).AppendTo(sb);
+      return;
     }
     CTX_DCHECK("Impossible!");
-    return {};
   }
+
+  std::string ToString() const { return AppendToString(*this); }
 };
 
 struct QueryReqResp {
@@ -431,6 +453,8 @@ struct QueryReqResp {
 
     std::string_view query;
 
+    void AppendTo(StrBuilder* sb) const { sb->Append(query); }
+
     std::string ToString() const { return std::string(query); }
   };
 
@@ -441,33 +465,38 @@ struct QueryReqResp {
 
     bool is_err_resp = false;
 
+    // Only the first kMaxDataRows rows are kept, since the response is truncated to
+    // --max_body_bytes when it's recorded anyway. The number of rows is also in the command tag.
+    static constexpr size_t kMaxDataRows = 64;
     std::vector<DataRow> data_rows;
+    size_t num_skipped_data_rows = 0;
     CmdCmpl cmd_cmpl;
     ErrResp err_resp;
 
-    std::string ToString() const {
+    void AppendTo(StrBuilder* sb) const {
       if (is_err_resp) {
-        return err_resp.ToString();
+        err_resp.AppendTo(sb);
+        return;
       }
 
-      std::string res;
-
       if (!data_rows.empty()) {
-        std::vector<std::string_view> field_names = row_desc.FieldNames();
-
-        if (!field_names.empty()) {
-          absl::StrAppend(&res, absl::StrJoin(field_names, ","));
-          absl::StrAppend(&res, "\n");
+        if (!row_desc.fields.empty()) {
+          sb->AppendJoin(row_desc.fields, ",",
+                         [](StrBuilder* out, const RowDesc::Field& f) { out->Append(f.name); });
+          sb->Append("\n");
         }
 
-        absl::StrAppend(&res, absl::StrJoin(data_rows, "\n", ToStringFormatter<DataRow>()));
-        absl::StrAppend(&res, "\n");
+        sb->AppendJoin(data_rows, "\n", AppendToFormatter<DataRow>());
+        sb->Append("\n");
+        if (num_skipped_data_rows > 0) {
+          sb->Append("[", num_skipped_data_rows, " more rows]\n");
+        }
       }
 
-      absl::StrAppend(&res, cmd_cmpl.cmd_tag);
-
-      return res;
+      sb->Append(cmd_cmpl.cmd_tag);
     }
+
+    std::string ToString() const { return AppendToString(*this); }
   };
 
   Query req;
@@ -501,14 +530,17 @@ struct DescReqResp {
     // This is set if is_err_resp is true.
     ErrResp err_resp;
 
-    std::string ToString() const {
+    void AppendTo(StrBuilder* sb) const {
       if (is_err_resp) {
-        return err_resp.ToString();
+        err_resp.AppendTo(sb);
+        return;
       }
       // It does not seem useful to format type OIDs, so we only report row description's field
       // names.
-      return row_desc.ToString();
+      row_desc.AppendTo(sb);
     }
+
+    std::string ToString() const { return AppendToString(*this); }
   };
 
   Resp resp;
@@ -520,13 +552,13 @@ struct Exec {
   std::string_view query;
   std::vector<Param> params;
 
-  std::string ToString() const {
-    std::vector<std::string> param_strs;
-    for (const auto& p : params) {
-      param_strs.emplace_back(p.Value());
-    }
-    return absl::Substitute("query=[$0] params=[$1]", query, absl::StrJoin(param_strs, ", "));
+  void AppendTo(StrBuilder* sb) const {
+    sb->Append("query=[", query, "] params=[");
+    sb->AppendJoin(params, ", ", [](StrBuilder* out, const Param& p) { out->Append(p.Value()); });
+    sb->Append("]");
   }
+
+  std::string ToString() const { return AppendToString(*this); }
 };
 
 struct ExecReqResp {
@@ -544,7 +576,8 @@ struct Record {
 };
 
 struct State {
-  absl::flat_hash_map<std::string, std::string> prepared_statements;
+  // Prepared statement name to query.
+  StatementCache<std::string, std::string> prepared_statements;
 
   // One postgres session can only have at most one unnamed statement.
   std::string unnamed_statement;
@@ -33,10 +33,18 @@ constexpr std::string_view kEvalSHA = "EVALSHA";
 constexpr std::string_view kSet = "SET";
 constexpr std::string_view kSScan = "SSCAN";
 
-// Returns a JSON string that formats the input arguments as a JSON array.
+// Returns a JSON string that formats the input arguments as a JSON array. The arguments are
+// written straight into the output buffer, instead of going through a copied vector and a
+// rapidjson::Document like utils::ToJSONString() does.
 std::string FormatAsJSONArray(VectorView<std::string> args) {
-  std::vector<std::string_view> args_copy = {args.begin(), args.end()};
-  return utils::ToJSONString(args_copy);
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  writer.StartArray();
+  for (const auto& arg : args) {
+    writer.String(arg.data(), arg.size());
+  }
+  writer.EndArray();
+  return buffer.GetString();
 }
 
 // EVALSHA executes a previous cached script on Redis server:
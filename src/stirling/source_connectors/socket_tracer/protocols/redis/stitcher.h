@@ -19,12 +19,10 @@
 #pragma once
 
 #include <deque>
-#include <limits>
 #include <utility>
 #include <vector>
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/interface.h"
-#include "src/stirling/source_connectors/socket_tracer/protocols/common/timestamp_stitcher.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/redis/types.h"
 
 namespace px {
@@ -35,40 +33,47 @@ template <>
 inline RecordsWithErrorCount<redis::Record> StitchFrames(std::deque<redis::Message>* req_messages,
                                                          std::deque<redis::Message>* resp_messages,
                                                          NoState* /* state */) {
-  // NOTE: This cannot handle Redis pipelining if there is any missing message.
+  // Redis answers the commands of a connection in order, so a run of (pipelined) requests is
+  // paired with the responses that follow it in FIFO order.
   // See https://redis.io/topics/pipelining for Redis pipelining.
   //
-  // This is copied from StitchMessagesWithTimestampOrder() in timestamp_stitcher.h.
-  // With additionally always pushing published messages into records with a synthesized request.
-  // See below.
+  // A run ends when a request is sent after some of its responses were received. The requests
+  // left unanswered at that point are assumed to have lost their responses and are dropped, which
+  // bounds the effect of a lost response to the run it happened in. Requests that are still
+  // waiting for responses at the end are kept for the next invocation.
+  //
+  // Published messages, REPLCONF ACK commands, and commands replayed from leader to follower have
+  // no counterparts, and are always pushed into records on their own. See below.
 
   std::vector<redis::Record> records;
+  records.reserve(resp_messages->size());
 
-  redis::Record record;
-  record.req.timestamp_ns = 0;
-  record.resp.timestamp_ns = 0;
-
-  redis::Message placeholder_message;
-  placeholder_message.timestamp_ns = std::numeric_limits<int64_t>::max();
+  // The requests of the current run, in the order they were sent. Requests before pending_pos
+  // were already paired or dropped.
+  std::vector<redis::Message*> pending_reqs;
+  size_t pending_pos = 0;
+  bool run_has_resps = false;
 
   auto req_iter = req_messages->begin();
   auto resp_iter = resp_messages->begin();
   while (req_iter != req_messages->end() || resp_iter != resp_messages->end()) {
-    redis::Message& req = (req_iter == req_messages->end()) ? placeholder_message : *req_iter;
-    redis::Message& resp = (resp_iter == resp_messages->end()) ? placeholder_message : *resp_iter;
+    const bool has_req = req_iter != req_messages->end();
+    const bool has_resp = resp_iter != resp_messages->end();
+    // Whether the oldest remaining message is a request.
+    const bool req_first =
+        has_req && (!has_resp || req_iter->timestamp_ns < resp_iter->timestamp_ns);
 
-    // This if block is the added code to StitchMessagesWithTimestampOrder().
     // For Redis pub/sub, published messages have no corresponding `requests`, therefore we
     // forcefully turn them into records without requests.
-    if (resp_iter != resp_messages->end() && resp.is_published_message) {
+    if (has_resp && resp_iter->is_published_message) {
       // Synthesize the request message.
       redis::Record unstitched_record = {};
 
-      unstitched_record.req.timestamp_ns = resp.timestamp_ns;
+      unstitched_record.req.timestamp_ns = resp_iter->timestamp_ns;
       constexpr std::string_view kPubPushCmd = "PUSH PUB";
       unstitched_record.req.command = kPubPushCmd;
 
-      unstitched_record.resp = std::move(resp);
+      unstitched_record.resp = std::move(*resp_iter);
 
       records.push_back(std::move(unstitched_record));
       ++resp_iter;
@@ -77,13 +82,12 @@ inline RecordsWithErrorCount<redis::Record> StitchFrames(std::deque<redis::Messa
 
     // Handle REPLCONF ACK command sent from follower to leader.
     constexpr std::string_view kReplConfAck = "REPLCONF ACK";
-    if (req_iter != req_messages->end() && req.command == kReplConfAck &&
-        // Ensure the output order based on timestamps.
-        (resp_iter == resp_messages->end() || req.timestamp_ns < resp.timestamp_ns)) {
+    // Checking req_first ensures the output order based on timestamps.
+    if (req_first && req_iter->command == kReplConfAck) {
       redis::Record unstitched_record = {};
 
-      unstitched_record.req = std::move(req);
-      unstitched_record.resp.timestamp_ns = req.timestamp_ns;
+      unstitched_record.req = std::move(*req_iter);
+      unstitched_record.resp.timestamp_ns = unstitched_record.req.timestamp_ns;
 
       records.push_back(std::move(unstitched_record));
       ++req_iter;
@@ -91,11 +95,11 @@ inline RecordsWithErrorCount<redis::Record> StitchFrames(std::deque<redis::Messa
     }
 
     // Handle commands sent from leader to follower, which are replayed at the follower.
-    if (resp_iter != resp_messages->end() && !resp.command.empty()) {
+    if (has_resp && !resp_iter->command.empty()) {
       redis::Record unstitched_record = {};
 
-      unstitched_record.req = std::move(resp);
-      unstitched_record.resp.timestamp_ns = resp.timestamp_ns;
+      unstitched_record.req = std::move(*resp_iter);
+      unstitched_record.resp.timestamp_ns = unstitched_record.req.timestamp_ns;
       unstitched_record.role_swapped = true;
 
       records.push_back(std::move(unstitched_record));
@@ -103,24 +107,31 @@ inline RecordsWithErrorCount<redis::Record> StitchFrames(std::deque<redis::Messa
       continue;
     }
 
-    if (req.timestamp_ns < resp.timestamp_ns) {
-      record.req = std::move(req);
+    if (req_first) {
+      if (run_has_resps) {
+        // A new run starts; drop the requests of the previous run that got no responses.
+        pending_pos = pending_reqs.size();
+        run_has_resps = false;
+      }
+      pending_reqs.push_back(&*req_iter);
       ++req_iter;
     } else {
-      if (record.req.timestamp_ns != 0) {
-        record.resp = std::move(resp);
-
-        records.push_back(std::move(record));
-
-        record.req.timestamp_ns = 0;
-        record.resp.timestamp_ns = 0;
+      // A response without any earlier outstanding request is ignored.
+      if (pending_pos < pending_reqs.size()) {
+        records.push_back({std::move(*pending_reqs[pending_pos]), std::move(*resp_iter)});
+        ++pending_pos;
+        run_has_resps = true;
       }
       ++resp_iter;
     }
   }
 
-  req_messages->erase(req_messages->begin(), req_iter);
-  resp_messages->erase(resp_messages->begin(), resp_iter);
+  std::deque<redis::Message> unanswered_reqs;
+  for (size_t i = pending_pos; i < pending_reqs.size(); ++i) {
+    unanswered_reqs.push_back(std::move(*pending_reqs[i]));
+  }
+  *req_messages = std::move(unanswered_reqs);
+  resp_messages->clear();
 
   return {std::move(records), 0};
 }
@@ -100,6 +100,59 @@ TEST(StitchFramesTest, ReplConfAckAndMutationCommands) {
   EXPECT_THAT(resps, IsEmpty());
 }
 
+// Tests that pipelined requests are paired with their responses in order, and that requests
+// still waiting for responses are kept.
+TEST(StitchFramesTest, PipelinedRequests) {
+  std::deque<redis::Message> reqs = {
+      CreateMsg(1, R"(["a"])", "GET"),
+      CreateMsg(1, R"(["b"])", "GET"),
+      CreateMsg(1, R"(["c"])", "GET"),
+  };
+
+  std::deque<redis::Message> resps = {
+      CreateMsg(2, "1", ""),
+      CreateMsg(2, "2", ""),
+  };
+
+  NoState no_state;
+
+  RecordsWithErrorCount<redis::Record> res = StitchFrames<redis::Record>(&reqs, &resps, &no_state);
+  EXPECT_EQ(res.error_count, 0);
+  EXPECT_THAT(res.records, ElementsAre(EqualsRecord("GET", R"(["a"])", "1"),
+                                       EqualsRecord("GET", R"(["b"])", "2")));
+  EXPECT_THAT(reqs, ElementsAre(Field(&redis::Message::payload, R"(["c"])")));
+  EXPECT_THAT(resps, IsEmpty());
+
+  resps.push_back(CreateMsg(3, "3", ""));
+  res = StitchFrames<redis::Record>(&reqs, &resps, &no_state);
+  EXPECT_THAT(res.records, ElementsAre(EqualsRecord("GET", R"(["c"])", "3")));
+  EXPECT_THAT(reqs, IsEmpty());
+  EXPECT_THAT(resps, IsEmpty());
+}
+
+// Tests that requests left unanswered by a run are dropped once the next run starts.
+TEST(StitchFramesTest, LostResponseDroppedAtNextRun) {
+  std::deque<redis::Message> reqs = {
+      CreateMsg(1, R"(["a"])", "GET"),
+      CreateMsg(1, R"(["b"])", "GET"),
+      CreateMsg(3, R"(["c"])", "GET"),
+  };
+
+  std::deque<redis::Message> resps = {
+      CreateMsg(2, "1", ""),
+      CreateMsg(4, "3", ""),
+  };
+
+  NoState no_state;
+
+  RecordsWithErrorCount<redis::Record> res = StitchFrames<redis::Record>(&reqs, &resps, &no_state);
+  EXPECT_EQ(res.error_count, 0);
+  EXPECT_THAT(res.records, ElementsAre(EqualsRecord("GET", R"(["a"])", "1"),
+                                       EqualsRecord("GET", R"(["c"])", "3")));
+  EXPECT_THAT(reqs, IsEmpty());
+  EXPECT_THAT(resps, IsEmpty());
+}
+
 }  // namespace protocols
 }  // namespace stirling
 }  // namespace px
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/stirling/source_connectors/socket_tracer/red_metrics.h"
+
+#include <absl/strings/ascii.h>
+#include <absl/strings/str_join.h>
+#include <absl/strings/str_split.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+
+namespace {
+
+int64_t LatencyNS(uint64_t req_timestamp_ns, uint64_t resp_timestamp_ns) {
+  if (req_timestamp_ns == 0 || resp_timestamp_ns == 0) {
+    return 0;
+  }
+  return static_cast<int64_t>(resp_timestamp_ns - req_timestamp_ns);
+}
+
+}  // namespace
+
+std::string HTTPEndpoint(std::string_view method, std::string_view path) {
+  path = path.substr(0, path.find_first_of("?#"));
+
+  std::vector<std::string_view> segments = absl::StrSplit(path, '/');
+  for (auto& segment : segments) {
+    if (std::any_of(segment.begin(), segment.end(), absl::ascii_isdigit)) {
+      segment = "*";
+    }
+  }
+  return absl::StrCat(method, " ", absl::StrJoin(segments, "/"));
+}
+
+REDSample REDSampleOf(const protocols::http::Record& record) {
+  return {.endpoint = HTTPEndpoint(record.req.req_method, record.req.req_path),
+          .error = record.resp.resp_status >= 400,
+          .latency_ns = LatencyNS(record.req.timestamp_ns, record.resp.timestamp_ns)};
+}
+
+REDSample REDSampleOf(const protocols::mysql::Record& record) {
+  return {.endpoint = std::string(magic_enum::enum_name(record.req.cmd)),
+          .error = record.resp.status == protocols::mysql::RespStatus::kErr,
+          .latency_ns = LatencyNS(record.req.timestamp_ns, record.resp.timestamp_ns)};
+}
+
+REDSample REDSampleOf(const protocols::pgsql::Record& record) {
+  return {.endpoint = protocols::pgsql::ToString(record.req.tag, /* is_req */ true),
+          .error = record.resp.tag == protocols::pgsql::Tag::kErrResp,
+          .latency_ns = LatencyNS(record.req.timestamp_ns, record.resp.timestamp_ns)};
+}
+
+void REDMetrics::AddSample(const ConnTracker& tracker, REDSample sample) {
+  const SockAddr& remote_endpoint = tracker.remote_endpoint();
+  if (!(remote_endpoint.family == SockAddrFamily::kIPv4 ||
+        remote_endpoint.family == SockAddrFamily::kIPv6) ||
+      tracker.role() == kRoleUnknown) {
+    return;
+  }
+
+  AggKey key = {
+      .upid = tracker.conn_id().upid,
+      .remote_addr = remote_endpoint.AddrStr(),
+      .remote_port = tracker.role() == kRoleServer ? 0 : remote_endpoint.port(),
+      .role = tracker.role(),
+      .protocol = tracker.protocol(),
+      .endpoint = std::move(sample.endpoint),
+  };
+
+  // Bound the memory used for high cardinality endpoints, by lumping any new ones together.
+  if (agg_stats_.size() >= max_keys_ && !agg_stats_.contains(key)) {
+    key.endpoint = kOverflowEndpoint;
+  }
+
+  Stats& stats = agg_stats_[key];
+  ++stats.request_count;
+  if (sample.error) {
+    ++stats.error_count;
+  }
+  stats.latency_ns.Add(sample.latency_ns);
+}
+
+}  // namespace stirling
+}  // namespace px
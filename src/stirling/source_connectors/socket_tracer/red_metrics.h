@@ -0,0 +1,130 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/hash/hash.h>
+
+#include "src/stirling/source_connectors/socket_tracer/conn_tracker.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/types.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/mysql/types.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/pgsql/types.h"
+#include "src/stirling/utils/quantile_sketch.h"
+
+namespace px {
+namespace stirling {
+
+/**
+ * What a stitched record contributes to the RED metrics.
+ */
+struct REDSample {
+  // The class of the request, see HTTPEndpoint().
+  std::string endpoint;
+  bool error = false;
+  int64_t latency_ns = 0;
+};
+
+// Returns the HTTP endpoint of a request: its method and its path, without the query, and with any
+// segment that contains a digit replaced by '*', so that IDs don't each get their own endpoint.
+// For example, "GET /api/users/1234?verbose=1" becomes "GET /api/users/*".
+std::string HTTPEndpoint(std::string_view method, std::string_view path);
+
+// PROTOCOL_LIST: Requires update on new protocols that should be aggregated into RED metrics.
+REDSample REDSampleOf(const protocols::http::Record& record);
+REDSample REDSampleOf(const protocols::mysql::Record& record);
+REDSample REDSampleOf(const protocols::pgsql::Record& record);
+
+// Records of the other protocols are not aggregated.
+template <typename TRecordType>
+std::optional<REDSample> REDSampleOf(const TRecordType& /*record*/) {
+  return std::nullopt;
+}
+
+template <typename TRecordType>
+inline constexpr bool kHasREDSample =
+    std::is_same_v<decltype(REDSampleOf(std::declval<const TRecordType&>())), REDSample>;
+
+/**
+ * Aggregates stitched records into request rate, error rate and latency (RED) metrics, per
+ * process, remote endpoint, protocol and request class, until the aggregates are read and cleared
+ * at the end of each interval.
+ */
+class REDMetrics {
+ public:
+  // The endpoint under which requests are counted once max_keys aggregates exist.
+  static constexpr std::string_view kOverflowEndpoint = "<overflow>";
+
+  explicit REDMetrics(size_t max_keys) : max_keys_(max_keys) {}
+
+  // Like ConnStats::AggKey, the remote port is 0 for servers, to collapse the ports of clients.
+  struct AggKey {
+    struct upid_t upid;
+    std::string remote_addr;
+    int remote_port;
+    endpoint_role_t role;
+    traffic_protocol_t protocol;
+    std::string endpoint;
+
+    bool operator==(const AggKey& rhs) const {
+      return upid.pid == rhs.upid.pid && upid.start_time_ticks == rhs.upid.start_time_ticks &&
+             remote_addr == rhs.remote_addr && remote_port == rhs.remote_port &&
+             role == rhs.role && protocol == rhs.protocol && endpoint == rhs.endpoint;
+    }
+
+    template <typename H>
+    friend H AbslHashValue(H h, const AggKey& key) {
+      return H::combine(std::move(h), key.upid.pid, key.upid.start_time_ticks, key.remote_addr,
+                        key.remote_port, key.role, key.protocol, key.endpoint);
+    }
+  };
+
+  struct Stats {
+    uint64_t request_count = 0;
+    uint64_t error_count = 0;
+    utils::QuantileSketch latency_ns;
+  };
+
+  template <typename TRecordType>
+  void Add(const ConnTracker& tracker, const TRecordType& record) {
+    std::optional<REDSample> sample = REDSampleOf(record);
+    if (sample.has_value()) {
+      AddSample(tracker, std::move(sample.value()));
+    }
+  }
+
+  void AddSample(const ConnTracker& tracker, REDSample sample);
+
+  const absl::flat_hash_map<AggKey, Stats>& agg_stats() const { return agg_stats_; }
+
+  void Clear() { agg_stats_.clear(); }
+
+ private:
+  const size_t max_keys_;
+  absl::flat_hash_map<AggKey, Stats> agg_stats_;
+};
+
+}  // namespace stirling
+}  // namespace px
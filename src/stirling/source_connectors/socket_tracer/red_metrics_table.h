@@ -0,0 +1,86 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include "src/stirling/core/output.h"
+#include "src/stirling/core/types.h"
+#include "src/stirling/source_connectors/socket_tracer/canonical_types.h"
+
+namespace px {
+namespace stirling {
+
+// clang-format off
+constexpr DataElement kREDMetricsElements[] = {
+        canonical_data_elements::kTime,
+        canonical_data_elements::kUPID,
+        canonical_data_elements::kRemoteAddr,
+        canonical_data_elements::kRemotePort,
+        canonical_data_elements::kTraceRole,
+        {"protocol", "The protocol of the requests.",
+         types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::GENERAL_ENUM,
+         &kTrafficProtocolDecoder},
+        {"endpoint", "The class of the requests: the HTTP method and path, with any path segment "
+         "that contains a digit replaced by '*', or the MySQL or PostgreSQL command.",
+         types::DataType::STRING, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+        {"interval", "The duration of the interval that the requests were aggregated over.",
+         types::DataType::INT64, types::SemanticType::ST_DURATION_NS,
+         types::PatternType::METRIC_GAUGE},
+        {"request_count", "The number of requests in the interval.",
+         types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::METRIC_GAUGE},
+        {"error_count", "The number of requests in the interval that failed.",
+         types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::METRIC_GAUGE},
+        {"latency_quantiles", "The p50, p90 and p99 request-response latencies in the interval.",
+         types::DataType::STRING, types::SemanticType::ST_DURATION_NS_QUANTILES,
+         types::PatternType::GENERAL},
+#ifndef NDEBUG
+        canonical_data_elements::kPXInfo,
+#endif
+};
+// clang-format on
+
+constexpr DataTableSchema kREDMetricsTable(
+    "red_metrics",
+    "Request rate, error rate and latency (RED) metrics, aggregated by the socket tracer per "
+    "process, remote endpoint, protocol and request class. Unlike the per-protocol event tables, "
+    "this table has one row per interval, however many requests there were.",
+    kREDMetricsElements);
+DEFINE_PRINT_TABLE(REDMetrics)
+
+namespace red_metrics_idx {
+
+constexpr int kTime = kREDMetricsTable.ColIndex("time_");
+constexpr int kUPID = kREDMetricsTable.ColIndex("upid");
+constexpr int kRemoteAddr = kREDMetricsTable.ColIndex("remote_addr");
+constexpr int kRemotePort = kREDMetricsTable.ColIndex("remote_port");
+constexpr int kRole = kREDMetricsTable.ColIndex("trace_role");
+constexpr int kProtocol = kREDMetricsTable.ColIndex("protocol");
+constexpr int kEndpoint = kREDMetricsTable.ColIndex("endpoint");
+constexpr int kInterval = kREDMetricsTable.ColIndex("interval");
+constexpr int kRequestCount = kREDMetricsTable.ColIndex("request_count");
+constexpr int kErrorCount = kREDMetricsTable.ColIndex("error_count");
+constexpr int kLatencyQuantiles = kREDMetricsTable.ColIndex("latency_quantiles");
+#ifndef NDEBUG
+constexpr int kPxInfo = kREDMetricsTable.ColIndex("px_info_");
+#endif
+
+}  // namespace red_metrics_idx
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/stirling/source_connectors/socket_tracer/red_metrics.h"
+
+#include <string>
+
+#include "src/common/testing/testing.h"
+#include "src/stirling/source_connectors/socket_tracer/testing/event_generator.h"
+
+namespace px {
+namespace stirling {
+
+using ::testing::Field;
+using ::testing::Key;
+using ::testing::SizeIs;
+using ::testing::UnorderedElementsAre;
+
+TEST(HTTPEndpointTest, ReplacesIDsAndDropsQuery) {
+  EXPECT_EQ(HTTPEndpoint("GET", "/"), "GET /");
+  EXPECT_EQ(HTTPEndpoint("GET", "/api/users"), "GET /api/users");
+  EXPECT_EQ(HTTPEndpoint("GET", "/api/users/1234?verbose=1"), "GET /api/users/*");
+  EXPECT_EQ(HTTPEndpoint("PUT", "/api/v2/orders/7f3a9c/items/2"), "PUT /api/*/orders/*/items/*");
+  EXPECT_EQ(HTTPEndpoint("GET", "/index.html#top"), "GET /index.html");
+}
+
+TEST(REDSampleOfTest, OnlyAggregatedProtocolsHaveSamples) {
+  struct OtherRecord {};
+  EXPECT_FALSE(REDSampleOf(OtherRecord{}).has_value());
+
+  protocols::mysql::Record mysql_record;
+  mysql_record.req.cmd = protocols::mysql::Command::kQuery;
+  mysql_record.req.timestamp_ns = 100;
+  mysql_record.resp.status = protocols::mysql::RespStatus::kErr;
+  mysql_record.resp.timestamp_ns = 150;
+  REDSample sample = REDSampleOf(mysql_record);
+  EXPECT_EQ(sample.endpoint, "kQuery");
+  EXPECT_TRUE(sample.error);
+  EXPECT_EQ(sample.latency_ns, 50);
+}
+
+class REDMetricsTest : public ::testing::Test {
+ protected:
+  REDMetricsTest() : event_gen_(&mock_clock_) {
+    tracker_.AddControlEvent(event_gen_.InitConn(kRoleClient));
+  }
+
+  static protocols::http::Record HTTPRecord(std::string method, std::string path, int status,
+                                            uint64_t latency_ns) {
+    protocols::http::Record record;
+    record.req.req_method = std::move(method);
+    record.req.req_path = std::move(path);
+    record.req.timestamp_ns = 1000;
+    record.resp.resp_status = status;
+    record.resp.timestamp_ns = 1000 + latency_ns;
+    return record;
+  }
+
+  testing::MockClock mock_clock_;
+  testing::EventGenerator event_gen_;
+  ConnTracker tracker_;
+};
+
+TEST_F(REDMetricsTest, AggregatesPerEndpoint) {
+  REDMetrics red_metrics(/*max_keys*/ 100);
+  red_metrics.Add(tracker_, HTTPRecord("GET", "/users/1", 200, 100));
+  red_metrics.Add(tracker_, HTTPRecord("GET", "/users/2", 500, 200));
+  red_metrics.Add(tracker_, HTTPRecord("GET", "/users/3", 404, 300));
+  red_metrics.Add(tracker_, HTTPRecord("POST", "/login", 200, 1000));
+
+  const auto& agg_stats = red_metrics.agg_stats();
+  ASSERT_THAT(agg_stats, UnorderedElementsAre(Key(Field(&REDMetrics::AggKey::endpoint,
+                                                        "GET /users/*")),
+                                              Key(Field(&REDMetrics::AggKey::endpoint,
+                                                        "POST /login"))));
+
+  for (const auto& [key, stats] : agg_stats) {
+    EXPECT_EQ(key.role, kRoleClient);
+    if (key.endpoint == "GET /users/*") {
+      EXPECT_EQ(stats.request_count, 3U);
+      EXPECT_EQ(stats.error_count, 2U);
+      EXPECT_NEAR(stats.latency_ns.Quantile(0.5), 200, 2);
+    } else {
+      EXPECT_EQ(stats.request_count, 1U);
+      EXPECT_EQ(stats.error_count, 0U);
+      EXPECT_NEAR(stats.latency_ns.Quantile(0.5), 1000, 10);
+    }
+  }
+
+  red_metrics.Clear();
+  EXPECT_THAT(red_metrics.agg_stats(), SizeIs(0));
+}
+
+TEST_F(REDMetricsTest, OverflowEndpoint) {
+  REDMetrics red_metrics(/*max_keys*/ 1);
+  red_metrics.Add(tracker_, HTTPRecord("GET", "/a", 200, 100));
+  red_metrics.Add(tracker_, HTTPRecord("GET", "/b", 200, 100));
+  red_metrics.Add(tracker_, HTTPRecord("GET", "/c", 200, 100));
+  red_metrics.Add(tracker_, HTTPRecord("GET", "/a", 200, 100));
+
+  EXPECT_THAT(red_metrics.agg_stats(),
+              UnorderedElementsAre(
+                  Key(Field(&REDMetrics::AggKey::endpoint, "GET /a")),
+                  Key(Field(&REDMetrics::AggKey::endpoint, REDMetrics::kOverflowEndpoint))));
+}
+
+}  // namespace stirling
+}  // namespace px
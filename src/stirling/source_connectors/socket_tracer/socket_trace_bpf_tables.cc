@@ -18,6 +18,8 @@
 
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_bpf_tables.h"
 
+#include <arpa/inet.h>
+
 #include "src/common/fs/fs_wrapper.h"
 #include "src/common/system/proc_pid_path.h"
 #include "src/stirling/bpf_tools/macros.h"
@@ -49,7 +51,10 @@ using px::system::ProcPidPath;
 
 ConnInfoMapManager::ConnInfoMapManager(bpf_tools::BCCWrapper* bcc)
     : conn_info_map_(WrappedBCCMap<uint64_t, struct conn_info_t>::Create(bcc, "conn_info_map")),
-      conn_disabled_map_(WrappedBCCMap<uint64_t, uint64_t>::Create(bcc, "conn_disabled_map")) {
+      conn_disabled_map_(WrappedBCCMap<uint64_t, uint64_t>::Create(bcc, "conn_disabled_map")),
+      protocol_verdict_map_(
+          WrappedBCCMap<struct protocol_verdict_key_t, struct protocol_verdict_t>::Create(
+              bcc, "protocol_verdict_map")) {
   std::filesystem::path self_path = GetSelfPath().ValueOrDie();
   auto elf_reader_or_s = obj_tools::ElfReader::Create(self_path.string());
   if (!elf_reader_or_s.ok()) {
@@ -95,6 +100,36 @@ void ConnInfoMapManager::Disable(struct conn_id_t conn_id) {
   }
 }
 
+StatusOr<struct conn_info_t> ConnInfoMapManager::GetConnInfo(struct conn_id_t conn_id) const {
+  PX_ASSIGN_OR_RETURN(struct conn_info_t conn_info, conn_info_map_->GetValue(id(conn_id)));
+  if (conn_info.conn_id.tsid != conn_id.tsid) {
+    return error::NotFound("$0 BPF tracks another generation of the connection.",
+                           ToString(conn_id));
+  }
+  return conn_info;
+}
+
+void ConnInfoMapManager::SetProtocolVerdict(struct conn_id_t conn_id, const SockAddr& remote_addr,
+                                            traffic_protocol_t protocol, endpoint_role_t role) {
+  if (remote_addr.family != SockAddrFamily::kIPv4 && remote_addr.family != SockAddrFamily::kIPv6) {
+    return;
+  }
+
+  struct protocol_verdict_key_t key = {};
+  key.start_time_ticks = conn_id.upid.start_time_ticks;
+  key.tgid = conn_id.upid.tgid;
+  key.remote_port = htons(remote_addr.port());
+
+  struct protocol_verdict_t verdict = {};
+  verdict.protocol = protocol;
+  verdict.role = role;
+
+  if (!protocol_verdict_map_->SetValue(key, verdict).ok()) {
+    VLOG(1) << absl::Substitute("$0 Updating protocol_verdict_map entry failed.",
+                                ToString(conn_id));
+  }
+}
+
 void ConnInfoMapManager::CleanupBPFMapLeaks(ConnTrackersManager* conn_trackers_mgr) {
   for (const auto& [pid_fd, conn_info] : conn_info_map_->GetTableOffline()) {
     uint32_t pid = pid_fd >> 32;
@@ -116,6 +151,13 @@ void ConnInfoMapManager::CleanupBPFMapLeaks(ConnTrackersManager* conn_trackers_m
     VLOG(1) << absl::Substitute("Found conn_info_map leak: pid=$0 fd=$1 af=$2", pid, fd,
                                 conn_info.raddr.sa.sa_family);
   }
+
+  // Protocol verdicts are kept for the lifetime of their processes.
+  for (const auto& [key, verdict] : protocol_verdict_map_->GetTableOffline()) {
+    if (!fs::Exists(ProcPidPath(key.tgid))) {
+      PX_UNUSED(protocol_verdict_map_->RemoveValue(key));
+    }
+  }
 }
 
 }  // namespace stirling
@@ -22,6 +22,7 @@
 #include <string>
 #include <vector>
 
+#include "src/common/base/inet_utils.h"
 #include "src/stirling/bpf_tools/bcc_wrapper.h"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/socket_trace.hpp"
 
@@ -43,11 +44,23 @@ class ConnInfoMapManager {
 
   void Disable(struct conn_id_t conn_id);
 
+  // Returns the BPF side state of conn_id, as long as BPF still tracks the same generation of the
+  // connection (same tsid).
+  StatusOr<struct conn_info_t> GetConnInfo(struct conn_id_t conn_id) const;
+
+  // Records the protocol verdict for the client connections of the process of conn_id to
+  // remote_addr's port. BPF applies it to new connections instead of inferring their protocol.
+  // A protocol of kProtocolUnknown stops the tracing of such connections.
+  void SetProtocolVerdict(struct conn_id_t conn_id, const SockAddr& remote_addr,
+                          traffic_protocol_t protocol, endpoint_role_t role);
+
   void CleanupBPFMapLeaks(ConnTrackersManager* conn_trackers_mgr);
 
  private:
   std::unique_ptr<WrappedBCCMap<uint64_t, struct conn_info_t>> conn_info_map_;
   std::unique_ptr<WrappedBCCMap<uint64_t, uint64_t>> conn_disabled_map_;
+  std::unique_ptr<WrappedBCCMap<struct protocol_verdict_key_t, struct protocol_verdict_t>>
+      protocol_verdict_map_;
 
   std::vector<struct conn_id_t> pending_release_queue_;
 
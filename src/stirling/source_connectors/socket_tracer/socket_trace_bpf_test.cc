@@ -21,6 +21,8 @@
 #include <gtest/gtest.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <limits>
+#include <string>
 #include <string_view>
 #include <thread>
 
@@ -394,6 +396,48 @@ TEST_F(SocketTraceBPFTest, NoProtocolWritesNotCaptured) {
   EXPECT_TRUE(tracker->recv_data().data_buffer().empty());
 }
 
+// Tests that BPF copies only the first bytes of each message up to the capture limit,
+// and that the rest of the message is accounted for with filler bytes.
+TEST_F(SocketTraceBPFTest, CaptureLimit) {
+  constexpr uint32_t kCaptureLimitBytes = 16;
+  ConfigureBPFCapture(traffic_protocol_t::kProtocolHTTP, kRoleClient);
+  ASSERT_OK(source_->UpdateBPFProtocolCaptureLimit(kProtocolHTTP, kCaptureLimitBytes));
+
+  testing::SendRecvScript script({
+      {{kHTTPReqMsg1}, {kHTTPRespMsg1}},
+  });
+  testing::ClientServerSystem system;
+  system.RunClientServer<&TCPSocket::Read, &TCPSocket::Write>(script);
+
+  source_->BCC().PollPerfBuffers();
+
+  ASSERT_OK_AND_ASSIGN(const auto* tracker, GetConnTracker(system.ClientPID(), system.ClientFD()));
+  std::string expected_send_data(kHTTPReqMsg1.substr(0, kCaptureLimitBytes));
+  expected_send_data.resize(kHTTPReqMsg1.size(), '\0');
+  EXPECT_EQ(tracker->send_data().data_buffer().Head(), expected_send_data);
+}
+
+// Tests that BPF doesn't send the data of the connections left out by sampling.
+TEST_F(SocketTraceBPFTest, ConnSampling) {
+  ConfigureBPFCapture(traffic_protocol_t::kProtocolHTTP, kRoleClient);
+  // A connection is sampled when its TSID is a multiple of the ratio, so practically none is.
+  ASSERT_OK(source_->UpdateBPFProtocolConnSampling(kProtocolHTTP,
+                                                   std::numeric_limits<uint32_t>::max()));
+
+  testing::SendRecvScript script({
+      {{kHTTPReqMsg1}, {kHTTPRespMsg1}},
+  });
+  testing::ClientServerSystem system;
+  system.RunClientServer<&TCPSocket::Read, &TCPSocket::Write>(script);
+
+  source_->BCC().PollPerfBuffers();
+
+  // The connection is still tracked for its conn stats.
+  ASSERT_OK_AND_ASSIGN(const auto* tracker, GetConnTracker(system.ClientPID(), system.ClientFD()));
+  EXPECT_TRUE(tracker->send_data().data_buffer().empty());
+  EXPECT_TRUE(tracker->recv_data().data_buffer().empty());
+}
+
 TEST_F(SocketTraceBPFTest, MultipleConnections) {
   ConfigureBPFCapture(traffic_protocol_t::kProtocolHTTP, kRoleClient);
 
@@ -747,6 +791,40 @@ TEST_F(NullRemoteAddrTest, IPv6Accept4WithNullRemoteAddr) {
   EXPECT_EQ(records[kHTTPRemotePortIdx]->Get<types::Int64Value>(0), port);
 }
 
+// Traces only the processes of a namespace. The test has no K8s metadata, so no process is in it.
+class TracedNamespacesBPFTest : public SocketTraceBPFTest {
+ protected:
+  void SetUp() override {
+    FLAGS_stirling_socket_tracer_namespaces = "traced-namespace";
+    SocketTraceBPFTest::SetUp();
+  }
+
+  void TearDown() override {
+    SocketTraceBPFTest::TearDown();
+    FLAGS_stirling_socket_tracer_namespaces = "";
+  }
+};
+
+// Tests that the processes outside of the traced namespaces are filtered out inside BPF.
+TEST_F(TracedNamespacesBPFTest, ProcessesOutsideNamespacesNotTraced) {
+  ConfigureBPFCapture(traffic_protocol_t::kProtocolHTTP, kRoleClient);
+
+  StartTransferDataThread();
+
+  testing::SendRecvScript script({
+      {{kHTTPReqMsg1}, {kHTTPRespMsg1}},
+  });
+  testing::ClientServerSystem system;
+  system.RunClientServer<&TCPSocket::Read, &TCPSocket::Write>(script);
+
+  StopTransferDataThread();
+
+  EXPECT_NOT_OK(GetConnTracker(system.ClientPID(), system.ClientFD()));
+  EXPECT_NOT_OK(GetConnTracker(system.ServerPID(), system.ServerFD()));
+  std::vector<TaggedRecordBatch> tablets = ConsumeRecords(kHTTPTableNum);
+  EXPECT_TRUE(tablets.empty());
+}
+
 // Run a UDP-based client-server system.
 class UDPSocketTraceBPFTest : public SocketTraceBPFTest {
  protected:
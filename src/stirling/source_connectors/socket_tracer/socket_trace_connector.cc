@@ -24,10 +24,16 @@
 
 #include <algorithm>
 #include <filesystem>
+#include <memory>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/hash/hash.h>
 #include <absl/strings/match.h>
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_split.h>
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/delimited_message_util.h>
 #include <magic_enum.hpp>
@@ -38,10 +44,12 @@
 #include "src/common/json/json.h"
 #include "src/common/system/proc_pid_path.h"
 #include "src/common/system/socket_info.h"
+#include "src/shared/dns/hostname_cache.h"
 #include "src/shared/metadata/metadata.h"
 #include "src/stirling/bpf_tools/macros.h"
 #include "src/stirling/bpf_tools/utils.h"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/go_grpc_types.hpp"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/go_tls_types.h"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/socket_trace.hpp"
 #include "src/stirling/source_connectors/socket_tracer/conn_stats.h"
 #include "src/stirling/source_connectors/socket_tracer/proto/sock_event.pb.h"
@@ -56,6 +64,36 @@ DEFINE_uint32(
     stirling_conn_stats_sampling_ratio, 50,
     "Ratio of how frequently conn_stats_table is populated relative to the base sampling period.");
 
+DEFINE_bool(stirling_conn_stats_bpf_aggregation,
+            gflags::BoolFromEnv("PL_STIRLING_CONN_STATS_BPF_AGGREGATION", false),
+            "If true, conn_stats are aggregated per process, remote endpoint and role in a BPF "
+            "map, which is read once per conn_stats transfer, instead of being sent to user-space "
+            "as conn_stats events.");
+
+DEFINE_bool(stirling_socket_tracer_ssl_coalescing,
+            gflags::BoolFromEnv("PL_STIRLING_SOCKET_TRACER_SSL_COALESCING", false),
+            "If true, the TLS data of consecutive calls in the same direction of a connection is "
+            "coalesced in BPF into events of up to 4KiB, instead of being submitted call by call.");
+
+DEFINE_bool(stirling_enable_red_metrics,
+            gflags::BoolFromEnv("PL_STIRLING_ENABLE_RED_METRICS", false),
+            "If true, aggregates the HTTP, MySQL and PostgreSQL records into per-endpoint request "
+            "rate, error rate and latency quantiles in the red_metrics table.");
+DEFINE_bool(stirling_red_metrics_only, gflags::BoolFromEnv("PL_STIRLING_RED_METRICS_ONLY", false),
+            "If true, and --stirling_enable_red_metrics is set, the raw records of the aggregated "
+            "protocols are dropped and only the red_metrics table is populated.");
+DEFINE_uint32(stirling_red_metrics_interval_secs,
+              gflags::Uint32FromEnv("PL_STIRLING_RED_METRICS_INTERVAL_SECS", 10),
+              "The interval over which the red_metrics table rows are aggregated.");
+DEFINE_uint32(stirling_red_metrics_max_keys,
+              gflags::Uint32FromEnv("PL_STIRLING_RED_METRICS_MAX_KEYS", 10000),
+              "The maximum number of distinct (upid, remote endpoint, endpoint) keys aggregated "
+              "per interval. Samples with new endpoints beyond this are aggregated under "
+              "\"<overflow>\".");
+DEFINE_uint32(stirling_protocol_costs_interval_secs,
+              gflags::Uint32FromEnv("PL_STIRLING_PROTOCOL_COSTS_INTERVAL_SECS", 10),
+              "The interval over which the socket_tracer_costs table rows are accumulated.");
+
 DEFINE_uint32(stirling_socket_tracer_stats_logging_ratio,
               std::chrono::minutes(10) / px::stirling::SocketTraceConnector::kSamplingPeriod,
               "Ratio of how frequently summary logging information is displayed.");
@@ -97,6 +135,11 @@ DEFINE_int32(stirling_enable_cass_tracing,
 DEFINE_int32(stirling_enable_dns_tracing,
              gflags::Int32FromEnv("PX_STIRLING_ENABLE_DNS_TRACING", px::stirling::TraceMode::On),
              "If true, stirling will trace and process DNS messages.");
+DEFINE_int32(stirling_dns_hostname_ttl_seconds,
+             gflags::Int32FromEnv("PX_STIRLING_DNS_HOSTNAME_TTL_SECONDS", 30),
+             "How long the hostnames of the addresses in traced DNS answers are kept for queries "
+             "to look up. The DNS parser doesn't decode the TTLs of the answers, so this stands "
+             "in for them. Zero disables the hostname cache.");
 DEFINE_int32(stirling_enable_redis_tracing,
              gflags::Int32FromEnv("PX_STIRLING_ENABLE_REDIS_TRACING", px::stirling::TraceMode::On),
              "If true, stirling will trace and process Redis messages.");
@@ -164,6 +207,10 @@ DEFINE_uint32(
 DEFINE_uint32(datastream_buffer_retention_size,
               gflags::Uint32FromEnv("PL_DATASTREAM_BUFFER_SIZE", 1024 * 1024),
               "The maximum size of a data stream buffer retained between cycles.");
+DEFINE_uint32(datastream_buffer_memory_pressure_retention_size,
+              gflags::Uint32FromEnv("PL_DATASTREAM_BUFFER_MEMORY_PRESSURE_SIZE", 64 * 1024),
+              "The maximum size of a data stream buffer retained between cycles while the process "
+              "is under memory pressure.");
 
 DEFINE_uint64(max_body_bytes, gflags::Uint64FromEnv("PL_STIRLING_MAX_BODY_BYTES", 512),
               "The maximum number of bytes in the body of protocols like HTTP");
@@ -185,6 +232,66 @@ DEFINE_uint32(stirling_bpf_chunk_limit, 4,
               "The maximum number of chunks a perf_submit can support. "
               "This applies to messages that are over MAX_MSG_SIZE.");
 
+DEFINE_bool(stirling_socket_tracer_use_ring_buffers,
+            gflags::BoolFromEnv("PL_STIRLING_SOCKET_TRACER_USE_RING_BUFFERS", false),
+            "Use BPF ring buffers shared by all cpus, instead of per-cpu perf buffers, for the "
+            "socket data, control, conn stats and mmap events. Falls back to perf buffers on "
+            "kernels older than 5.8.");
+
+DEFINE_uint32(stirling_socket_tracer_data_wakeup_events,
+              gflags::Uint32FromEnv("PL_STIRLING_SOCKET_TRACER_DATA_WAKEUP_EVENTS", 32),
+              "The number of socket data events a cpu writes before waking up Stirling, when it "
+              "waits on the perf buffers (see --stirling_event_driven_wakeup).");
+
+DEFINE_uint32(stirling_cpu_budget_connection_sampling_ratio, 4,
+              "When over the CPU budget (see --stirling_cpu_budget_pct), trace only one in this "
+              "many connections.");
+DEFINE_string(stirling_cpu_budget_low_priority_protocols,
+              "kProtocolNATS,kProtocolMux,kProtocolAMQP,kProtocolMongo",
+              "Comma separated list of protocols that stop being traced when over the CPU budget "
+              "(see --stirling_cpu_budget_pct).");
+
+DEFINE_string(stirling_socket_tracer_namespaces,
+              gflags::StringFromEnv("PL_STIRLING_SOCKET_TRACER_NAMESPACES", ""),
+              "Comma separated list of K8s namespaces whose processes are traced by the socket "
+              "tracer. The others are filtered out inside BPF. Processes are traced once their "
+              "pod is known to the metadata, so their first connections may be missed. "
+              "Empty traces all processes.");
+
+DEFINE_string(stirling_socket_tracer_conn_sampling_ratios,
+              gflags::StringFromEnv("PL_STIRLING_SOCKET_TRACER_CONN_SAMPLING_RATIOS", ""),
+              "Comma separated list of <protocol>:<N> pairs, e.g. kProtocolHTTP:10. BPF only sends "
+              "the data of one in N connections of the protocol to user-space. The other "
+              "connections still report conn stats.");
+DEFINE_uint32(stirling_http_bpf_capture_limit_bytes,
+              gflags::Uint32FromEnv("PL_STIRLING_HTTP_BPF_CAPTURE_LIMIT_BYTES", 0),
+              "If non-zero, BPF only copies this many leading bytes of each HTTP message written "
+              "or read by a syscall to user-space, which should cover the headers and the first "
+              "--max_body_bytes of the body. The rest is accounted for as filler bytes. Chunked "
+              "bodies that don't fit fail to parse. 0 copies all bytes.");
+
+DEFINE_int32(stirling_socket_tracer_num_threads,
+             gflags::Int32FromEnv("PL_STIRLING_SOCKET_TRACER_NUM_THREADS", 1),
+             "The number of threads, including the Stirling thread, that parse and stitch the "
+             "data of the connections.");
+
+DEFINE_bool(stirling_enable_proc_events,
+            gflags::BoolFromEnv("PL_STIRLING_ENABLE_PROC_EVENTS", true),
+            "If true, processes to deploy uprobes on are discovered from exec and exit events "
+            "traced in BPF, and the full list of processes is only diffed every "
+            "--stirling_proc_full_scan_period_secs to catch up with lost events.");
+
+DEFINE_uint32(stirling_proc_full_scan_period_secs,
+              gflags::Uint32FromEnv("PL_STIRLING_PROC_FULL_SCAN_PERIOD_SECS", 30),
+              "With --stirling_enable_proc_events, the period at which the full list of processes "
+              "is diffed to discover processes to deploy uprobes on.");
+
+DEFINE_uint32(stirling_socket_info_snapshot_ttl_ms,
+              gflags::Uint32FromEnv("PL_STIRLING_SOCKET_INFO_SNAPSHOT_TTL_MS", 1000),
+              "How long the sock_diag dump of a network namespace is reused to infer the endpoints "
+              "of connections whose connect/accept was not traced. A lookup that misses re-dumps "
+              "the namespace. 0 dumps the namespaces again on every iteration.");
+
 OBJ_STRVIEW(socket_trace_bcc_script, socket_trace);
 
 namespace px {
@@ -213,12 +320,15 @@ constexpr char openssl_tls_source_help[] =
 SocketTraceConnector::SocketTraceConnector(std::string_view source_name)
     : BCCSourceConnector(source_name, kTables),
       conn_stats_(&conn_trackers_mgr_),
+      protocol_costs_(&GetMetricsRegistry()),
       openssl_trace_mismatched_fds_counter_family_(
           BuildCounterFamily(openssl_mismatched_fds_metric, openssl_mismatched_fds_help)),
       openssl_trace_tls_source_counter_family_(
           BuildCounterFamily(openssl_tls_source_metric, openssl_tls_source_help)),
       uprobe_mgr_(&this->BCC()) {
   proc_parser_ = std::make_unique<system::ProcParser>();
+  transfer_thread_pool_ =
+      std::make_unique<ThreadPool>(std::max(0, FLAGS_stirling_socket_tracer_num_threads - 1));
   InitProtocolTransferSpecs();
 }
 
@@ -347,6 +457,10 @@ const auto kProbeSpecs = MakeArray<bpf_tools::KProbeSpec>(
      {"security_socket_recvmsg", ProbeType::kEntry, "probe_entry_security_socket_recvmsg",
       /*is_syscall*/ false}});
 
+const auto kTracepointSpecs = MakeArray<bpf_tools::TracepointSpec>(
+    {{"sched:sched_process_exec", "tracepoint__sched__sched_process_exec"},
+     {"sched:sched_process_exit", "tracepoint__sched__sched_process_exit"}});
+
 using bpf_tools::PerfBufferSizeCategory;
 
 namespace {
@@ -427,6 +541,8 @@ auto SocketTraceConnector::InitPerfBufferSpecs() {
        kTargetControlBufferSize, PerfBufferSizeCategory::kControl},
       {"mmap_events", HandleMMapEvent, HandleMMapEventLoss, this, kTargetControlBufferSize / 10,
        PerfBufferSizeCategory::kControl},
+      {"proc_events", HandleProcEvent, HandleProcEventLoss, this, kTargetControlBufferSize / 10,
+       PerfBufferSizeCategory::kControl},
       {"go_grpc_events", HandleHTTP2Event, HandleHTTP2EventLoss, this, kTargetDataBufferSize,
        PerfBufferSizeCategory::kData},
       {"grpc_c_events", HandleGrpcCEvent, HandleGrpcCDataLoss, this, kTargetDataBufferSize,
@@ -436,10 +552,45 @@ auto SocketTraceConnector::InitPerfBufferSpecs() {
       {"grpc_c_close_events", HandleGrpcCCloseEvent, HandleGrpcCCloseDataLoss, this,
        kTargetDataBufferSize, PerfBufferSizeCategory::kData},
   });
+  // Opens and closes are drained ahead of the data events, and between the other buffers, so that
+  // a saturated data path doesn't leave the trackers without them.
+  specs[1].high_priority = true;
+  // socket_data_events is first, so it is the buffer that a wait for data blocks on.
+  specs[0].wakeup_events = static_cast<int>(FLAGS_stirling_socket_tracer_data_wakeup_events);
   ResizePerfBufferSpecs(&specs, category_maximums);
   return specs;
 }
 
+namespace {
+// The outputs of socket_trace.c that are declared as ring buffers with USE_RINGBUF.
+constexpr std::string_view kRingBufferOutputs[] = {"socket_data_events", "socket_control_events",
+                                                   "conn_stats_events", "mmap_events",
+                                                   "proc_events"};
+
+// Turns the outputs of socket_trace.c into ring buffers, and returns the defines that declare
+// them so in the BPF code.
+template <size_t N>
+std::vector<std::string> UseRingBuffers(std::array<bpf_tools::PerfBufferSpec, N>* specs) {
+  const size_t ncpus = get_nprocs_conf();
+  // A shared buffer absorbs bursts on any cpu, so it doesn't need the overprovisioning of the
+  // per-cpu buffers for unevenly distributed traffic.
+  const double overprovision_factor =
+      std::max(1.0, FLAGS_stirling_socket_tracer_max_total_bw_overprovision_factor);
+
+  std::vector<std::string> defines = {"-DUSE_RINGBUF=1"};
+  for (auto& spec : *specs) {
+    if (std::find(std::begin(kRingBufferOutputs), std::end(kRingBufferOutputs), spec.name) ==
+        std::end(kRingBufferOutputs)) {
+      continue;
+    }
+    spec.ring_buffer = true;
+    spec.size_bytes = static_cast<int>(spec.size_bytes * ncpus / overprovision_factor);
+    defines.push_back(bpf_tools::RingBufferPagesDefine(spec));
+  }
+  return defines;
+}
+}  // namespace
+
 Status SocketTraceConnector::InitBPF() {
   // set BPF loop limit and chunk limit based on kernel version
   auto kernel = system::GetCachedKernelVersion();
@@ -467,27 +618,48 @@ Status SocketTraceConnector::InitBPF() {
       absl::StrCat("-DENABLE_NATS_TRACING=", protocol_transfer_specs_[kProtocolNATS].enabled),
       absl::StrCat("-DENABLE_AMQP_TRACING=", protocol_transfer_specs_[kProtocolAMQP].enabled),
       absl::StrCat("-DENABLE_MONGO_TRACING=", protocol_transfer_specs_[kProtocolMongo].enabled),
+      absl::StrCat("-DENABLE_CONN_STATS_BPF_AGG=", FLAGS_stirling_conn_stats_bpf_aggregation),
+      absl::StrCat("-DENABLE_SSL_COALESCING=", FLAGS_stirling_socket_tracer_ssl_coalescing),
       absl::StrCat("-DBPF_LOOP_LIMIT=", FLAGS_stirling_bpf_loop_limit),
       absl::StrCat("-DBPF_CHUNK_LIMIT=", FLAGS_stirling_bpf_chunk_limit),
   };
+
+  auto perf_buffer_specs = InitPerfBufferSpecs();
+  if (FLAGS_stirling_socket_tracer_use_ring_buffers) {
+    if (!bpf_tools::KernelSupportsRingBuffers()) {
+      LOG(WARNING) << absl::Substitute(
+          "Ring buffers require kernel 5.8+, but running on $0. Using perf buffers instead.",
+          system::GetCachedKernelVersion().ToString());
+    } else if (bcc_->IsRecording() || bcc_->IsReplaying()) {
+      LOG(WARNING) << "Ring buffers can't be recorded or replayed. Using perf buffers instead.";
+    } else {
+      std::vector<std::string> ring_buffer_defines = UseRingBuffers(&perf_buffer_specs);
+      defines.insert(defines.end(), ring_buffer_defines.begin(), ring_buffer_defines.end());
+    }
+  }
+
+  const auto& data_buffer_spec = perf_buffer_specs[0];
+  data_buffer_capacity_ = data_buffer_spec.ring_buffer
+                              ? data_buffer_spec.size_bytes
+                              : int64_t{data_buffer_spec.size_bytes} * get_nprocs_conf();
+
   PX_RETURN_IF_ERROR(bcc_->InitBPFProgram(socket_trace_bcc_script, defines));
 
   PX_RETURN_IF_ERROR(bcc_->AttachKProbes(kProbeSpecs));
   LOG(INFO) << absl::Substitute("Number of kprobes deployed = $0", kProbeSpecs.size());
+  if (FLAGS_stirling_enable_proc_events) {
+    PX_RETURN_IF_ERROR(bcc_->AttachTracepoints(kTracepointSpecs));
+    LOG(INFO) << absl::Substitute("Number of tracepoints deployed = $0", kTracepointSpecs.size());
+  }
   LOG(INFO) << "Probes successfully deployed.";
 
-  const auto perf_buffer_specs = InitPerfBufferSpecs();
   PX_RETURN_IF_ERROR(bcc_->OpenPerfBuffers(perf_buffer_specs));
   LOG(INFO) << absl::Substitute("Number of perf buffers opened = $0", perf_buffer_specs.size());
 
   // Set trace role to BPF probes.
   for (const auto& p : magic_enum::enum_values<traffic_protocol_t>()) {
     if (protocol_transfer_specs_[p].enabled) {
-      uint64_t role_mask = 0;
-      for (auto role : protocol_transfer_specs_[p].trace_roles) {
-        role_mask |= role;
-      }
-      PX_RETURN_IF_ERROR(UpdateBPFProtocolTraceRole(p, role_mask));
+      PX_RETURN_IF_ERROR(UpdateBPFProtocolTraceRole(p, ProtocolTraceRoleMask(p)));
     }
   }
 
@@ -495,6 +667,8 @@ Status SocketTraceConnector::InitBPF() {
   if (FLAGS_stirling_disable_self_tracing) {
     PX_RETURN_IF_ERROR(DisableSelfTracing());
   }
+  PX_RETURN_IF_ERROR(EnableTracedTGIDsFilter());
+  PX_RETURN_IF_ERROR(InitBPFDataPolicies());
   if (!FLAGS_socket_trace_data_events_output_path.empty()) {
     SetupOutput(FLAGS_socket_trace_data_events_output_path);
   }
@@ -532,7 +706,8 @@ Status SocketTraceConnector::InitImpl() {
   PX_RETURN_IF_ERROR(InitBPF());
 
   auto s = system::SocketInfoManager::Create(
-      ProcPath(), system::kTCPEstablishedState | system::kTCPListeningState);
+      ProcPath(), system::kTCPEstablishedState | system::kTCPListeningState,
+      std::chrono::milliseconds(FLAGS_stirling_socket_info_snapshot_ttl_ms));
   if (!s.ok()) {
     LOG(WARNING) << absl::Substitute("Failed to set up SocketInfoManager. Message: $0", s.msg());
   } else {
@@ -546,6 +721,19 @@ Status SocketTraceConnector::InitImpl() {
                    protocol_transfer_specs_[kProtocolHTTP2].enabled,
                    FLAGS_stirling_disable_self_tracing);
 
+  traced_tgids_map_ = WrappedBCCMap<uint32_t, uint8_t>::Create(bcc_.get(), "traced_tgids_map");
+
+  if (FLAGS_stirling_conn_stats_bpf_aggregation) {
+    conn_stats_agg_map_ =
+        WrappedBCCMap<struct conn_stats_agg_key_t, struct conn_stats_agg_t>::Create(
+            bcc_.get(), "conn_stats_agg_map");
+  }
+
+  if (FLAGS_stirling_socket_tracer_ssl_coalescing) {
+    ssl_coalesce_map_ =
+        WrappedBCCMap<uint64_t, struct ssl_coalesce_buf_t>::Create(bcc_.get(), "ssl_coalesce_map");
+  }
+
   openssl_trace_state_ = WrappedBCCArrayTable<int>::Create(bcc_.get(), "openssl_trace_state");
   openssl_trace_state_debug_ = WrappedBCCMap<uint32_t, struct openssl_trace_state_debug_t>::Create(
       bcc_.get(), "openssl_trace_state_debug");
@@ -595,6 +783,41 @@ std::thread SocketTraceConnector::RunDeployUProbesThread(
   return {};
 }
 
+std::thread SocketTraceConnector::DeployUProbesOnNewUPIDs(ConnectorContext* ctx) {
+  // With process events, new and exited processes are known as they happen, and the full list of
+  // UPIDs is only diffed once in a while, to catch up with events that were lost.
+  const auto now = now_fn_();
+  if (!FLAGS_stirling_enable_proc_events || now >= next_proc_full_scan_time_) {
+    std::thread thread = RunDeployUProbesThread(ctx->GetUPIDs());
+    if (thread.joinable()) {
+      next_proc_full_scan_time_ =
+          now + std::chrono::seconds(FLAGS_stirling_proc_full_scan_period_secs);
+    }
+    return thread;
+  }
+
+  if (proc_exec_upids_.empty() && proc_exit_upids_.empty()) {
+    return {};
+  }
+  // Same conditions as RunDeployUProbesThread(). The events are kept for the next iteration.
+  if (state() == State::kUninitialized || uprobe_mgr_.ThreadsRunning()) {
+    return {};
+  }
+
+  const uint32_t asid = ctx->GetASID();
+  absl::flat_hash_set<md::UPID> exec_upids;
+  for (const auto& upid : proc_exec_upids_) {
+    exec_upids.emplace(asid, upid.pid, upid.start_time_ticks);
+  }
+  absl::flat_hash_set<md::UPID> exit_upids;
+  for (const auto& upid : proc_exit_upids_) {
+    exit_upids.emplace(asid, upid.pid, upid.start_time_ticks);
+  }
+  proc_exec_upids_.clear();
+  proc_exit_upids_.clear();
+  return uprobe_mgr_.RunDeployUProbesThread(std::move(exec_upids), std::move(exit_upids));
+}
+
 namespace {
 
 std::string DumpContext(ConnectorContext* ctx) {
@@ -629,8 +852,11 @@ std::string BPFMapsInfo(bpf_tools::BCCWrapper* bcc) {
   out += BPFMapInfo<uint32_t, struct go_tls_symaddrs_t>(bcc, "go_tls_symaddrs_map");
   out += BPFMapInfo<uint32_t, struct go_http2_symaddrs_t>(bcc, "http2_symaddrs_map");
   out += BPFMapInfo<void*, struct go_grpc_event_attr_t>(bcc, "active_write_headers_frame_map");
+  out += BPFMapInfo<struct tgid_goid_t, struct go_tls_conn_args>(bcc, "active_tls_conn_op_map");
   out += BPFMapInfo<uint64_t, struct conn_info_t>(bcc, "conn_info_map");
   out += BPFMapInfo<uint64_t, uint64_t>(bcc, "conn_disabled_map");
+  out += BPFMapInfo<struct protocol_verdict_key_t, struct protocol_verdict_t>(
+      bcc, "protocol_verdict_map");
   out += BPFMapInfo<uint64_t, struct accept_args_t>(bcc, "active_accept_args_map");
   out += BPFMapInfo<uint64_t, struct connect_args_t>(bcc, "active_connect_args_map");
   out += BPFMapInfo<uint64_t, struct data_args_t>(bcc, "active_write_args_map");
@@ -656,13 +882,32 @@ void SocketTraceConnector::UpdateCommonState(ConnectorContext* ctx) {
   // It may be worth noting during debug.
   bcc_->PollPerfBuffers();
 
+  // Report how full the data buffer got since the last drain, so that the sampling period can
+  // adapt to the load.
+  const int64_t data_event_bytes = stats_.Get(StatKey::kPollSocketDataEventSize);
+  const int64_t data_event_loss = stats_.Get(StatKey::kLossSocketDataEvent);
+  if (data_event_loss > prev_data_event_loss_) {
+    transfer_load_ = 1.0;
+  } else if (data_buffer_capacity_ > 0) {
+    transfer_load_ = static_cast<double>(data_event_bytes - prev_data_event_bytes_) /
+                     static_cast<double>(data_buffer_capacity_);
+  }
+  prev_data_event_bytes_ = data_event_bytes;
+  prev_data_event_loss_ = data_event_loss;
+
+  if (ssl_coalesce_map_ != nullptr) {
+    DrainSSLCoalesceMap();
+  }
+
   // Set-up current state for connection inference purposes.
   if (socket_info_mgr_ != nullptr) {
     socket_info_mgr_->Flush();
   }
 
+  UpdateTracedTGIDs(ctx);
+
   // Deploy uprobes on newly discovered PIDs.
-  std::thread thread = RunDeployUProbesThread(ctx->GetUPIDs());
+  std::thread thread = DeployUProbesOnNewUPIDs(ctx);
   // Let it run in the background.
   if (thread.joinable()) {
     thread.detach();
@@ -682,6 +927,22 @@ void SocketTraceConnector::UpdateCommonState(ConnectorContext* ctx) {
   }
 }
 
+void SocketTraceConnector::DrainSSLCoalesceMap() {
+  static_assert(offsetof(ssl_coalesce_buf_t, msg) == offsetof(socket_data_event_t, msg),
+                "ssl_coalesce_buf_t must be handled as a socket_data_event_t.");
+
+  // The probes submit the coalesced data when the direction of the connection changes, so the
+  // last data before a connection goes idle would otherwise wait for the connection's next call.
+  // Data that is coalesced after this read is submitted or read as usual; its position in the
+  // stream is recorded in its attributes, so the order in which it arrives doesn't matter.
+  for (auto& [tgid_fd, buf] : ssl_coalesce_map_->GetTableOffline(/*clear_table*/ true)) {
+    if (buf.attr.msg_buf_size == 0) {
+      continue;
+    }
+    HandleDataEvent(this, &buf, sizeof(buf.attr) + buf.attr.msg_buf_size);
+  }
+}
+
 void SocketTraceConnector::UpdateTrackerTraceLevel(ConnTracker* tracker) {
   if (pids_to_trace_.contains(tracker->conn_id().upid.pid)) {
     tracker->SetDebugTrace(2);
@@ -775,27 +1036,28 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx) {
     }
   }
 
+  // Lookups skip expired hostnames, so they only need to be removed to free their memory.
+  constexpr auto kDNSHostnameExpiryPeriod = std::chrono::seconds(10);
+  if (sampling_freq_mgr_.count() % (kDNSHostnameExpiryPeriod / kSamplingPeriod) == 0) {
+    dns::HostnameCache::GetInstance().Expire();
+  }
+
   std::vector<CIDRBlock> cluster_cidrs = ctx->GetClusterCIDRs();
 
   for (size_t i = 0; i < data_tables_.size(); ++i) {
     DataTable* data_table = data_tables_[i];
 
     // Ensure records are within the time window, in order to ensure the order between record
-    // batches. Exception: conn_stats table does not need cutoff time, because its timestamps
-    // are assigned artificially.
-    if (i != kConnStatsTableNum && data_table != nullptr) {
+    // batches. Exception: conn_stats, red_metrics and socket_tracer_costs tables do not need cutoff
+    // time, because their timestamps are assigned artificially.
+    if (i != kConnStatsTableNum && i != kREDMetricsTableNum && i != kProtocolCostsTableNum &&
+        data_table != nullptr) {
       data_table->SetConsumeRecordsCutoffTime(perf_buffer_drain_time_);
     }
   }
 
+  std::vector<ConnTracker*> conn_trackers;
   for (const auto& conn_tracker : conn_trackers_mgr_.active_trackers()) {
-    const auto& transfer_spec = protocol_transfer_specs_[conn_tracker->protocol()];
-
-    DataTable* data_table = nullptr;
-    if (transfer_spec.enabled) {
-      data_table = data_tables_[transfer_spec.table_num];
-    }
-
     UpdateTrackerTraceLevel(conn_tracker);
 
     // Once a known UPID, always a known UPID.
@@ -809,9 +1071,27 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx) {
 
     conn_tracker->IterationPreTick(iteration_time_, cluster_cidrs, proc_parser_.get(),
                                    socket_info_mgr_.get());
+    conn_trackers.push_back(conn_tracker);
+  }
+
+  // The trackers are parsed and stitched concurrently, each by one thread, into their own records.
+  // Everything that touches shared state, from the data tables to the BPF maps, stays on this
+  // thread.
+  DataTable* red_metrics_table =
+      FLAGS_stirling_enable_red_metrics ? data_tables_[kREDMetricsTableNum] : nullptr;
+  std::vector<AppendRecordsFn> append_records_fns(conn_trackers.size());
+  transfer_thread_pool_->ParallelFor(conn_trackers.size(), [&](size_t i) {
+    ConnTracker* conn_tracker = conn_trackers[i];
+    const auto& transfer_spec = protocol_transfer_specs_[conn_tracker->protocol()];
+
+    DataTable* data_table = nullptr;
+    if (transfer_spec.enabled) {
+      data_table = data_tables_[transfer_spec.table_num];
+    }
 
     if (transfer_spec.transfer_fn != nullptr) {
-      transfer_spec.transfer_fn(*this, ctx, conn_tracker, data_table);
+      append_records_fns[i] =
+          transfer_spec.transfer_fn(*this, ctx, conn_tracker, data_table, red_metrics_table);
     } else {
       // If there's no transfer function, then the tracker should not be holding any data.
       // http::ProtocolTraits is used as a placeholder; the frames deque is expected to be
@@ -819,8 +1099,29 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx) {
       DCHECK((conn_tracker->send_data().Empty<stream_id_t, message_t>()));
       DCHECK((conn_tracker->recv_data().Empty<stream_id_t, message_t>()));
     }
+  });
+
+  protocol_costs_.BeginIteration();
+  for (size_t i = 0; i < conn_trackers.size(); ++i) {
+    ProcessingCost cost = conn_trackers[i]->ConsumeProcessingCost();
+    if (append_records_fns[i] != nullptr) {
+      auto append_start = std::chrono::steady_clock::now();
+      append_records_fns[i]();
+      cost.append_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - append_start)
+                            .count();
+    }
+    protocol_costs_.Add(conn_trackers[i]->protocol(), cost);
+    conn_trackers[i]->IterationPostTick();
+  }
+  protocol_costs_.EndIteration();
 
-    conn_tracker->IterationPostTick();
+  if (red_metrics_table != nullptr) {
+    TransferREDMetrics(ctx, red_metrics_table);
+  }
+
+  if (data_tables_[kProtocolCostsTableNum] != nullptr) {
+    TransferProtocolCosts(data_tables_[kProtocolCostsTableNum]);
   }
 
   CheckTracerState();
@@ -835,6 +1136,86 @@ Status SocketTraceConnector::UpdateBPFProtocolTraceRole(traffic_protocol_t proto
   return control_map->SetValues(static_cast<int>(protocol), role_mask);
 }
 
+Status SocketTraceConnector::UpdateBPFProtocolConnSampling(traffic_protocol_t protocol,
+                                                           uint32_t sampling_ratio) {
+  auto sampling_map =
+      WrappedBCCPerCPUArrayTable<uint32_t>::Create(bcc_.get(), kConnSamplingMapName);
+  return sampling_map->SetValues(static_cast<int>(protocol), sampling_ratio);
+}
+
+Status SocketTraceConnector::UpdateBPFProtocolCaptureLimit(traffic_protocol_t protocol,
+                                                           uint32_t limit_bytes) {
+  auto capture_limit_map =
+      WrappedBCCPerCPUArrayTable<uint32_t>::Create(bcc_.get(), kCaptureLimitMapName);
+  return capture_limit_map->SetValues(static_cast<int>(protocol), limit_bytes);
+}
+
+uint64_t SocketTraceConnector::ProtocolTraceRoleMask(traffic_protocol_t protocol) const {
+  uint64_t role_mask = 0;
+  for (auto role : protocol_transfer_specs_[protocol].trace_roles) {
+    role_mask |= role;
+  }
+  return role_mask;
+}
+
+void SocketTraceConnector::SetDegradationLevel(DegradationLevel level) {
+  const DegradationLevel prev_level = degradation_level();
+  SourceConnector::SetDegradationLevel(level);
+
+  // Bodies are dropped through the data tables, like columns that no query reads.
+  const bool drop_bodies = level >= DegradationLevel::kDropBodies;
+  if (drop_bodies != (prev_level >= DegradationLevel::kDropBodies)) {
+    for (size_t i = 0; i < data_tables_.size(); ++i) {
+      if (data_tables_[i] == nullptr) {
+        continue;
+      }
+      std::vector<size_t> dropped_columns;
+      if (drop_bodies) {
+        const ArrayView<DataElement>& elements = table_schemas()[i].elements();
+        for (size_t j = 0; j < elements.size(); ++j) {
+          if (elements[j].name() == "req_body" || elements[j].name() == "resp_body") {
+            dropped_columns.push_back(j);
+          }
+        }
+      }
+      data_tables_[i]->SetDroppedColumns(dropped_columns);
+    }
+  }
+
+  const bool disable_protocols = level >= DegradationLevel::kDisableLowPriorityProtocols;
+  if (disable_protocols != (prev_level >= DegradationLevel::kDisableLowPriorityProtocols)) {
+    for (std::string_view name : absl::StrSplit(FLAGS_stirling_cpu_budget_low_priority_protocols,
+                                                ',', absl::SkipWhitespace())) {
+      auto protocol = magic_enum::enum_cast<traffic_protocol_t>(name);
+      if (!protocol.has_value()) {
+        LOG_FIRST_N(ERROR, 1) << absl::Substitute("Unknown protocol: $0", name);
+        continue;
+      }
+      if (!protocol_transfer_specs_[protocol.value()].enabled) {
+        continue;
+      }
+      // With a role mask of 0, the BPF probes stop sending the protocol's data to user-space.
+      const uint64_t role_mask = disable_protocols ? 0 : ProtocolTraceRoleMask(protocol.value());
+      Status s = UpdateBPFProtocolTraceRole(protocol.value(), role_mask);
+      LOG_IF(ERROR, !s.ok()) << absl::Substitute("Failed to update the trace role of $0: $1",
+                                                 name, s.msg());
+    }
+  }
+}
+
+void SocketTraceConnector::SampleTracker(ConnTracker* tracker) {
+  if (degradation_level() < DegradationLevel::kSampleConnections ||
+      tracker->state() == ConnTracker::State::kDisabled) {
+    return;
+  }
+  const struct conn_id_t& conn_id = tracker->conn_id();
+  const size_t hash = absl::Hash<std::tuple<uint32_t, uint64_t, int32_t, uint64_t>>{}(
+      {conn_id.upid.tgid, conn_id.upid.start_time_ticks, conn_id.fd, conn_id.tsid});
+  if (hash % std::max(1U, FLAGS_stirling_cpu_budget_connection_sampling_ratio) != 0) {
+    tracker->Disable("Not sampled, to stay within the CPU budget");
+  }
+}
+
 Status SocketTraceConnector::TestOnlySetTargetPID() {
   int64_t pid = FLAGS_test_only_socket_trace_target_pid;
   if (pid != kTraceAllTGIDs) {
@@ -858,6 +1239,90 @@ Status SocketTraceConnector::DisableSelfTracing() {
   return control_map->SetValues(kStirlingTGIDIndex, self_pid);
 }
 
+Status SocketTraceConnector::EnableTracedTGIDsFilter() {
+  traced_namespaces_ = absl::StrSplit(FLAGS_stirling_socket_tracer_namespaces, ',',
+                                      absl::SkipWhitespace());
+  if (traced_namespaces_.empty()) {
+    return Status::OK();
+  }
+  LOG(INFO) << absl::Substitute("Socket tracer only traces the processes of namespaces: $0",
+                                FLAGS_stirling_socket_tracer_namespaces);
+  auto control_map =
+      WrappedBCCPerCPUArrayTable<int64_t>::Create(bcc_.get(), kControlValuesArrayName);
+  return control_map->SetValues(kTracedTGIDsFilterIndex, 1);
+}
+
+Status SocketTraceConnector::InitBPFDataPolicies() {
+  for (std::string_view entry : absl::StrSplit(FLAGS_stirling_socket_tracer_conn_sampling_ratios,
+                                               ',', absl::SkipWhitespace())) {
+    std::vector<std::string_view> fields = absl::StrSplit(entry, ':');
+    uint32_t sampling_ratio = 0;
+    std::optional<traffic_protocol_t> protocol;
+    if (fields.size() == 2) {
+      protocol = magic_enum::enum_cast<traffic_protocol_t>(fields[0]);
+    }
+    if (!protocol.has_value() || !absl::SimpleAtoi(fields[1], &sampling_ratio)) {
+      return error::InvalidArgument("Invalid connection sampling ratio: $0", entry);
+    }
+    LOG(INFO) << absl::Substitute("BPF sends the data of one in $0 connections of $1.",
+                                  sampling_ratio, fields[0]);
+    PX_RETURN_IF_ERROR(UpdateBPFProtocolConnSampling(protocol.value(), sampling_ratio));
+  }
+
+  if (FLAGS_stirling_http_bpf_capture_limit_bytes > 0) {
+    LOG(INFO) << absl::Substitute("BPF copies the first $0 bytes of each HTTP message.",
+                                  FLAGS_stirling_http_bpf_capture_limit_bytes);
+    PX_RETURN_IF_ERROR(
+        UpdateBPFProtocolCaptureLimit(kProtocolHTTP, FLAGS_stirling_http_bpf_capture_limit_bytes));
+  }
+  return Status::OK();
+}
+
+namespace {
+
+// Returns the TGIDs of the processes that run in the pods of the given namespaces.
+absl::flat_hash_set<uint32_t> TGIDsInNamespaces(
+    ConnectorContext* ctx, const absl::flat_hash_set<std::string>& namespaces) {
+  const md::K8sMetadataState& k8s_md = ctx->GetK8SMetadata();
+  absl::flat_hash_set<uint32_t> tgids;
+  for (const auto& [upid, pid_info] : ctx->GetPIDInfoMap()) {
+    if (pid_info == nullptr) {
+      continue;
+    }
+    const auto* container_info = k8s_md.ContainerInfoByID(pid_info->cid());
+    if (container_info == nullptr) {
+      continue;
+    }
+    const auto* pod_info = k8s_md.PodInfoByID(container_info->pod_id());
+    if (pod_info != nullptr && namespaces.contains(pod_info->ns())) {
+      tgids.insert(upid.pid());
+    }
+  }
+  return tgids;
+}
+
+}  // namespace
+
+void SocketTraceConnector::UpdateTracedTGIDs(ConnectorContext* ctx) {
+  if (traced_namespaces_.empty()) {
+    return;
+  }
+
+  absl::flat_hash_set<uint32_t> tgids = TGIDsInNamespaces(ctx, traced_namespaces_);
+  for (const uint32_t tgid : traced_tgids_) {
+    if (!tgids.contains(tgid)) {
+      PX_UNUSED(traced_tgids_map_->RemoveValue(tgid));
+    }
+  }
+  for (const uint32_t tgid : tgids) {
+    if (!traced_tgids_.contains(tgid)) {
+      Status s = traced_tgids_map_->SetValue(tgid, 1);
+      LOG_IF(WARNING, !s.ok()) << absl::Substitute("Could not trace pid=$0: $1", tgid, s.msg());
+    }
+  }
+  traced_tgids_ = std::move(tgids);
+}
+
 //-----------------------------------------------------------------------------
 // Perf Buffer Polling and Callback functions.
 //-----------------------------------------------------------------------------
@@ -901,6 +1366,7 @@ void SocketTraceConnector::HandleDataEventLoss(void* cb_cookie, uint64_t lost) {
 void SocketTraceConnector::HandleControlEvent(void* cb_cookie, void* data, int /*data_size*/) {
   DCHECK(cb_cookie != nullptr) << "Perf buffer callback not set-up properly. Missing cb_cookie.";
   auto* connector = static_cast<SocketTraceConnector*>(cb_cookie);
+  connector->stats_.Increment(StatKey::kPollSocketControlEventCount);
   connector->AcceptControlEvent(*static_cast<const socket_control_event_t*>(data));
 }
 
@@ -933,6 +1399,25 @@ void SocketTraceConnector::HandleMMapEventLoss(void* cb_cookie, uint64_t lost) {
   static_cast<SocketTraceConnector*>(cb_cookie)->stats_.Increment(StatKey::kLossMMapEvent, lost);
 }
 
+void SocketTraceConnector::HandleProcEvent(void* cb_cookie, void* data, int /*data_size*/) {
+  DCHECK(cb_cookie != nullptr) << "Perf buffer callback not set-up properly. Missing cb_cookie.";
+  auto* connector = static_cast<SocketTraceConnector*>(cb_cookie);
+  const auto& event = *static_cast<const proc_event_t*>(data);
+  switch (event.type) {
+    case kProcExec:
+      connector->proc_exec_upids_.insert(event.upid);
+      break;
+    case kProcExit:
+      connector->proc_exit_upids_.insert(event.upid);
+      break;
+  }
+}
+
+void SocketTraceConnector::HandleProcEventLoss(void* cb_cookie, uint64_t lost) {
+  DCHECK(cb_cookie != nullptr) << "Perf buffer callback not set-up properly. Missing cb_cookie.";
+  static_cast<SocketTraceConnector*>(cb_cookie)->stats_.Increment(StatKey::kLossProcEvent, lost);
+}
+
 void SocketTraceConnector::HandleHTTP2Event(void* cb_cookie, void* data, int /*data_size*/) {
   DCHECK(cb_cookie != nullptr) << "Perf buffer callback not set-up properly. Missing cb_cookie.";
 
@@ -1040,6 +1525,7 @@ ConnTracker& SocketTraceConnector::GetOrCreateConnTracker(struct conn_id_t conn_
   ConnTracker& tracker = conn_trackers_mgr_.GetOrCreateConnTracker(conn_id);
   tracker.set_current_time(iteration_time_);
   UpdateTrackerTraceLevel(&tracker);
+  SampleTracker(&tracker);
   return tracker;
 }
 
@@ -1254,7 +1740,12 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
 
   // Currently decompresses gzip content, but could handle other transformations too.
   // Note that we do this after filtering to avoid burning CPU cycles unnecessarily.
-  protocols::http::PreProcessMessage(&resp_message);
+  // The body is dropped anyway if nobody reads it, so don't bother decompressing it then.
+  constexpr size_t kRespBodyIdx = kHTTPTable.ColIndex("resp_body");
+  if (data_table->IsColumnUsed(kRespBodyIdx)) {
+    // Decompress one more byte than is kept, so that the body is still marked as truncated.
+    protocols::http::PreProcessMessage(&resp_message, FLAGS_max_body_bytes + 1);
+  }
 
   md::UPID upid(ctx->GetASID(), conn_tracker.conn_id().upid.pid,
                 conn_tracker.conn_id().upid.start_time_ticks);
@@ -1341,9 +1832,9 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("major_version")>(2);
   // HTTP2 does not define minor version.
   r.Append<r.ColIndex("minor_version")>(0);
-  r.Append<r.ColIndex("req_headers")>(ToJSONString(req_stream->headers()), kMaxHTTPHeadersBytes);
+  r.Append<r.ColIndex("req_headers")>(req_stream->headers().ToJSONString(), kMaxHTTPHeadersBytes);
   r.Append<r.ColIndex("content_type")>(static_cast<uint64_t>(content_type));
-  r.Append<r.ColIndex("resp_headers")>(ToJSONString(resp_stream->headers()), kMaxHTTPHeadersBytes);
+  r.Append<r.ColIndex("resp_headers")>(resp_stream->headers().ToJSONString(), kMaxHTTPHeadersBytes);
   r.Append<r.ColIndex("req_method")>(
       req_stream->headers().ValueByKey(protocols::http2::headers::kMethod));
   r.Append<r.ColIndex("req_path")>(req_stream->headers().ValueByKey(":path"));
@@ -1417,11 +1908,33 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
 #endif
 }
 
+namespace {
+
+// Adds the addresses that a pod looked up to the hostname cache of its network namespace.
+void CacheDNSHostnames(const ConnTracker& conn_tracker, const protocols::dns::Record& entry) {
+  if (FLAGS_stirling_dns_hostname_ttl_seconds <= 0 || conn_tracker.role() != kRoleClient ||
+      entry.query_name.empty() || entry.resolved_addrs.empty()) {
+    return;
+  }
+  StatusOr<uint32_t> netns = system::NetNamespace(ProcPath(), conn_tracker.conn_id().upid.pid);
+  if (!netns.ok()) {
+    return;
+  }
+  auto& cache = dns::HostnameCache::GetInstance();
+  for (const auto& addr : entry.resolved_addrs) {
+    cache.Insert(netns.ValueOrDie(), addr.AddrStr(), entry.query_name,
+                 std::chrono::seconds(FLAGS_stirling_dns_hostname_ttl_seconds));
+  }
+}
+
+}  // namespace
+
 template <>
 void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracker& conn_tracker,
                                          protocols::dns::Record entry, DataTable* data_table) {
   md::UPID upid(ctx->GetASID(), conn_tracker.conn_id().upid.pid,
                 conn_tracker.conn_id().upid.start_time_ticks);
+  CacheDNSHostnames(conn_tracker, entry);
 
   DataTable::RecordBuilder<&kDNSTable> r(data_table, entry.resp.timestamp_ns);
   r.Append<r.ColIndex("time_")>(entry.resp.timestamp_ns);
@@ -1703,8 +2216,10 @@ void SocketTraceConnector::WriteDataEvent(const SocketDataEvent& event) {
 //-----------------------------------------------------------------------------
 
 template <typename TProtocolTraits>
-void SocketTraceConnector::TransferStream(ConnectorContext* ctx, ConnTracker* tracker,
-                                          DataTable* data_table) {
+SocketTraceConnector::AppendRecordsFn SocketTraceConnector::TransferStream(
+    ConnectorContext* ctx, ConnTracker* tracker, DataTable* data_table,
+    DataTable* red_metrics_table) {
+  using TRecordType = typename TProtocolTraits::record_type;
   using TFrameType = typename TProtocolTraits::frame_type;
   using TKey = typename TProtocolTraits::key_type;
 
@@ -1714,15 +2229,22 @@ void SocketTraceConnector::TransferStream(ConnectorContext* ctx, ConnTracker* tr
   // This is a nop if the containers are already of the right type.
   tracker->InitFrames<TKey, TFrameType>();
 
-  if (data_table != nullptr && tracker->state() == ConnTracker::State::kTransferring) {
+  if constexpr (!kHasREDSample<TRecordType>) {
+    red_metrics_table = nullptr;
+  }
+  if (red_metrics_table != nullptr && FLAGS_stirling_red_metrics_only) {
+    data_table = nullptr;
+  }
+
+  // The records are shared rather than moved into the returned function, because std::function
+  // requires a copyable target.
+  std::shared_ptr<std::vector<TRecordType>> records;
+  if ((data_table != nullptr || red_metrics_table != nullptr) &&
+      tracker->state() == ConnTracker::State::kTransferring) {
     // ProcessToRecords() parses raw events and produces messages in format that are expected by
     // table store. But those messages are not cached inside ConnTracker.
-    auto records = tracker->ProcessToRecords<TProtocolTraits>();
-    for (auto& record : records) {
-      TProtocolTraits::ConvertTimestamps(
-          &record, [&](uint64_t mono_time) { return ConvertToRealTime(mono_time); });
-      AppendMessage(ctx, *tracker, std::move(record), data_table);
-    }
+    records =
+        std::make_shared<std::vector<TRecordType>>(tracker->ProcessToRecords<TProtocolTraits>());
   }
 
   auto buffer_expiry_timestamp =
@@ -1730,9 +2252,30 @@ void SocketTraceConnector::TransferStream(ConnectorContext* ctx, ConnTracker* tr
   auto message_expiry_timestamp =
       iteration_time() - std::chrono::seconds(FLAGS_messages_expiry_duration_secs);
 
-  tracker->Cleanup<TProtocolTraits>(FLAGS_messages_size_limit_bytes,
-                                    FLAGS_datastream_buffer_retention_size,
+  const size_t buffer_retention_size =
+      memory_pressure() ? std::min(FLAGS_datastream_buffer_retention_size,
+                                   FLAGS_datastream_buffer_memory_pressure_retention_size)
+                        : FLAGS_datastream_buffer_retention_size;
+  tracker->Cleanup<TProtocolTraits>(FLAGS_messages_size_limit_bytes, buffer_retention_size,
                                     message_expiry_timestamp, buffer_expiry_timestamp);
+
+  if (records == nullptr || records->empty()) {
+    return nullptr;
+  }
+  return [this, ctx, tracker, data_table, red_metrics_table, records]() {
+    for (auto& record : *records) {
+      // Aggregated before the timestamps are converted; only their differences are used.
+      if (red_metrics_table != nullptr) {
+        red_metrics_.Add(*tracker, record);
+      }
+      if (data_table == nullptr) {
+        continue;
+      }
+      TProtocolTraits::ConvertTimestamps(
+          &record, [&](uint64_t mono_time) { return ConvertToRealTime(mono_time); });
+      AppendMessage(ctx, *tracker, std::move(record), data_table);
+    }
+  };
 }
 
 void SocketTraceConnector::TransferConnStats(ConnectorContext* ctx, DataTable* data_table) {
@@ -1741,7 +2284,9 @@ void SocketTraceConnector::TransferConnStats(ConnectorContext* ctx, DataTable* d
   absl::flat_hash_set<md::UPID> upids = ctx->GetUPIDs();
   uint64_t time = AdjustedSteadyClockNowNS();
 
-  auto& agg_stats = conn_stats_.UpdateStats();
+  auto& agg_stats = conn_stats_agg_map_ != nullptr
+                        ? conn_stats_.UpdateStats(ReadConnStatsAggMap())
+                        : conn_stats_.UpdateStats();
 
   auto iter = agg_stats.begin();
   while (iter != agg_stats.end()) {
@@ -1799,5 +2344,108 @@ void SocketTraceConnector::TransferConnStats(ConnectorContext* ctx, DataTable* d
   }
 }
 
+std::vector<std::pair<struct conn_stats_agg_key_t, struct conn_stats_agg_t>>
+SocketTraceConnector::ReadConnStatsAggMap() {
+  auto entries = conn_stats_agg_map_->GetTableOffline();
+
+  // The entries of the processes that have exited will not change anymore. They are read one last
+  // time, and removed from the map. ConnStats forgets them once they are reported.
+  absl::flat_hash_map<uint32_t, bool> tgid_exists;
+  for (const auto& [key, stats] : entries) {
+    auto [iter, inserted] = tgid_exists.try_emplace(key.upid.tgid, false);
+    if (inserted) {
+      iter->second = fs::Exists(ProcPidPath(key.upid.tgid));
+    }
+    if (!iter->second) {
+      PX_UNUSED(conn_stats_agg_map_->RemoveValue(key));
+    }
+  }
+  return entries;
+}
+
+void SocketTraceConnector::TransferREDMetrics(ConnectorContext* ctx, DataTable* data_table) {
+  namespace idx = ::px::stirling::red_metrics_idx;
+
+  auto now = std::chrono::steady_clock::now();
+  if (red_metrics_interval_start_ == std::chrono::steady_clock::time_point{}) {
+    red_metrics_interval_start_ = now;
+    return;
+  }
+  auto interval = now - red_metrics_interval_start_;
+  if (interval < std::chrono::seconds(FLAGS_stirling_red_metrics_interval_secs)) {
+    return;
+  }
+
+  uint64_t time = AdjustedSteadyClockNowNS();
+  int64_t interval_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count();
+
+  for (const auto& [key, stats] : red_metrics_.agg_stats()) {
+    md::UPID upid(ctx->GetASID(), key.upid.pid, key.upid.start_time_ticks);
+
+    DataTable::RecordBuilder<&kREDMetricsTable> r(data_table, time);
+    r.Append<idx::kTime>(time);
+    r.Append<idx::kUPID>(upid.value());
+    r.Append<idx::kRemoteAddr>(key.remote_addr);
+    r.Append<idx::kRemotePort>(key.remote_port);
+    r.Append<idx::kRole>(key.role);
+    r.Append<idx::kProtocol>(key.protocol);
+    r.Append<idx::kEndpoint>(key.endpoint);
+    r.Append<idx::kInterval>(interval_ns);
+    r.Append<idx::kRequestCount>(stats.request_count);
+    r.Append<idx::kErrorCount>(stats.error_count);
+    r.Append<idx::kLatencyQuantiles>(absl::Substitute(
+        R"({"p50":$0,"p90":$1,"p99":$2})", static_cast<int64_t>(stats.latency_ns.Quantile(0.5)),
+        static_cast<int64_t>(stats.latency_ns.Quantile(0.9)),
+        static_cast<int64_t>(stats.latency_ns.Quantile(0.99))));
+#ifndef NDEBUG
+    r.Append<idx::kPxInfo>("");
+#endif
+  }
+
+  red_metrics_.Clear();
+  red_metrics_interval_start_ = now;
+}
+
+void SocketTraceConnector::TransferProtocolCosts(DataTable* data_table) {
+  namespace idx = ::px::stirling::protocol_costs_idx;
+
+  auto now = std::chrono::steady_clock::now();
+  if (protocol_costs_interval_start_ == std::chrono::steady_clock::time_point{}) {
+    protocol_costs_.ClearTimes();
+    protocol_costs_interval_start_ = now;
+    return;
+  }
+  auto interval = now - protocol_costs_interval_start_;
+  if (interval < std::chrono::seconds(FLAGS_stirling_protocol_costs_interval_secs)) {
+    return;
+  }
+
+  uint64_t time = AdjustedSteadyClockNowNS();
+  int64_t interval_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count();
+
+  for (int i = 0; i < kNumProtocols; ++i) {
+    auto protocol = static_cast<traffic_protocol_t>(i);
+    const ProtocolCosts::Stats& stats = protocol_costs_.stats(protocol);
+    if (stats.num_conns == 0 && stats.num_records == 0) {
+      continue;
+    }
+
+    DataTable::RecordBuilder<&kProtocolCostsTable> r(data_table, time);
+    r.Append<idx::kTime>(time);
+    r.Append<idx::kProtocol>(protocol);
+    r.Append<idx::kInterval>(interval_ns);
+    r.Append<idx::kParseTime>(stats.parse_ns);
+    r.Append<idx::kStitchTime>(stats.stitch_ns);
+    r.Append<idx::kAppendTime>(stats.append_ns);
+    r.Append<idx::kNumRecords>(stats.num_records);
+    r.Append<idx::kNumConns>(stats.num_conns);
+    r.Append<idx::kBufferBytes>(stats.buffer_bytes);
+    r.Append<idx::kFrameBytes>(stats.frame_bytes);
+  }
+
+  protocol_costs_.ClearTimes();
+  protocol_costs_interval_start_ = now;
+}
+
 }  // namespace stirling
 }  // namespace px
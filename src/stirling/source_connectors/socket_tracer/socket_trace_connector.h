@@ -19,6 +19,7 @@
 #pragma once
 
 #include <fstream>
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
@@ -28,8 +29,10 @@
 #include <vector>
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
 #include <absl/synchronization/mutex.h>
 
+#include "src/common/base/thread_pool.h"
 #include "src/common/grpcutils/service_descriptor_database.h"
 #include "src/common/metrics/metrics.h"
 #include "src/common/system/kernel_version.h"
@@ -44,6 +47,8 @@
 #include "src/stirling/source_connectors/socket_tracer/conn_stats.h"
 #include "src/stirling/source_connectors/socket_tracer/conn_tracker.h"
 #include "src/stirling/source_connectors/socket_tracer/conn_trackers_manager.h"
+#include "src/stirling/source_connectors/socket_tracer/protocol_costs.h"
+#include "src/stirling/source_connectors/socket_tracer/red_metrics.h"
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_bpf_tables.h"
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_tables.h"
 #include "src/stirling/source_connectors/socket_tracer/uprobe_manager.h"
@@ -52,9 +57,20 @@
 #include "src/stirling/utils/proc_tracker.h"
 
 DECLARE_uint32(stirling_conn_stats_sampling_ratio);
+DECLARE_bool(stirling_conn_stats_bpf_aggregation);
+DECLARE_bool(stirling_socket_tracer_ssl_coalescing);
+DECLARE_bool(stirling_enable_red_metrics);
+DECLARE_bool(stirling_red_metrics_only);
+DECLARE_uint32(stirling_red_metrics_interval_secs);
+DECLARE_uint32(stirling_red_metrics_max_keys);
+DECLARE_uint32(stirling_protocol_costs_interval_secs);
 DECLARE_bool(stirling_enable_periodic_bpf_map_cleanup);
 DECLARE_int32(test_only_socket_trace_target_pid);
 DECLARE_string(socket_trace_data_events_output_path);
+DECLARE_string(stirling_socket_tracer_namespaces);
+DECLARE_string(stirling_socket_tracer_conn_sampling_ratios);
+DECLARE_uint32(stirling_http_bpf_capture_limit_bytes);
+DECLARE_int32(stirling_socket_tracer_num_threads);
 DECLARE_int32(stirling_enable_http_tracing);
 DECLARE_int32(stirling_enable_http2_tracing);
 DECLARE_int32(stirling_enable_mysql_tracing);
@@ -76,6 +92,7 @@ DECLARE_uint32(messages_expiry_duration_secs);
 DECLARE_uint32(messages_size_limit_bytes);
 DECLARE_uint32(datastream_buffer_expiry_duration_secs);
 DECLARE_uint32(datastream_buffer_retention_size);
+DECLARE_uint32(datastream_buffer_memory_pressure_retention_size);
 
 DECLARE_uint64(max_body_bytes);
 
@@ -96,7 +113,8 @@ class SocketTraceConnector : public BCCSourceConnector {
   static constexpr std::string_view kName = "socket_tracer";
   static constexpr auto kTables =
       MakeArray(kConnStatsTable, kHTTPTable, kMySQLTable, kCQLTable, kPGSQLTable, kDNSTable,
-                kRedisTable, kNATSTable, kKafkaTable, kMuxTable, kAMQPTable, kMongoDBTable);
+                kRedisTable, kNATSTable, kKafkaTable, kMuxTable, kAMQPTable, kMongoDBTable,
+                kREDMetricsTable, kProtocolCostsTable);
 
   static constexpr uint32_t kConnStatsTableNum = TableNum(kTables, kConnStatsTable);
   static constexpr uint32_t kHTTPTableNum = TableNum(kTables, kHTTPTable);
@@ -110,6 +128,8 @@ class SocketTraceConnector : public BCCSourceConnector {
   static constexpr uint32_t kMuxTableNum = TableNum(kTables, kMuxTable);
   static constexpr uint32_t kAMQPTableNum = TableNum(kTables, kAMQPTable);
   static constexpr uint32_t kMongoDBTableNum = TableNum(kTables, kMongoDBTable);
+  static constexpr uint32_t kREDMetricsTableNum = TableNum(kTables, kREDMetricsTable);
+  static constexpr uint32_t kProtocolCostsTableNum = TableNum(kTables, kProtocolCostsTable);
 
   static constexpr auto kSamplingPeriod = std::chrono::milliseconds{200};
   // TODO(yzhao): This is not used right now. Eventually use this to control data push frequency.
@@ -119,6 +139,10 @@ class SocketTraceConnector : public BCCSourceConnector {
     return std::unique_ptr<SocketTraceConnector>(new SocketTraceConnector(name));
   }
 
+  // Samples connections, drops message bodies and disables the protocols in
+  // --stirling_cpu_budget_low_priority_protocols, depending on the level.
+  void SetDegradationLevel(DegradationLevel level) override;
+
   Status InitImpl() override;
   Status StopImpl() override;
   void InitContextImpl(ConnectorContext* ctx) override;
@@ -140,11 +164,31 @@ class SocketTraceConnector : public BCCSourceConnector {
   // data from inside BPF to user-space.
   Status UpdateBPFProtocolTraceRole(traffic_protocol_t protocol, uint64_t role_mask);
 
+  // Returns the role mask to trace the protocol with, as configured by the flags.
+  uint64_t ProtocolTraceRoleMask(traffic_protocol_t protocol) const;
+
+  // Makes BPF send the data of only one in sampling_ratio connections of the protocol to
+  // user-space. A ratio of 0 or 1 sends the data of all connections.
+  Status UpdateBPFProtocolConnSampling(traffic_protocol_t protocol, uint32_t sampling_ratio);
+
+  // Makes BPF copy only the first limit_bytes bytes of each message of the protocol to user-space.
+  // The rest of the message reaches the data stream as filler bytes. A limit of 0 copies all bytes.
+  Status UpdateBPFProtocolCaptureLimit(traffic_protocol_t protocol, uint32_t limit_bytes);
+
   // Instructs Stirling to log detailed debug information about the traced events from the PID
   // specified by --test_only_socket_trace_target_pid.
   Status TestOnlySetTargetPID();
   Status DisableSelfTracing();
 
+  // Restricts tracing to the processes of the namespaces in --stirling_socket_tracer_namespaces,
+  // if any. UpdateTracedTGIDs() keeps the TGIDs of these processes in sync in BPF.
+  Status EnableTracedTGIDsFilter();
+  void UpdateTracedTGIDs(ConnectorContext* ctx);
+
+  // Applies --stirling_socket_tracer_conn_sampling_ratios and
+  // --stirling_http_bpf_capture_limit_bytes to BPF.
+  Status InitBPFDataPolicies();
+
   void DisablePIDTrace(int pid) override {
     SourceConnector::DisablePIDTrace(pid);
     pids_to_trace_disable_.insert(pid);
@@ -174,6 +218,8 @@ class SocketTraceConnector : public BCCSourceConnector {
   static void HandleConnStatsEventLoss(void* cb_cookie, uint64_t lost);
   static void HandleMMapEvent(void* cb_cookie, void* data, int data_size);
   static void HandleMMapEventLoss(void* cb_cookie, uint64_t lost);
+  static void HandleProcEvent(void* cb_cookie, void* data, int data_size);
+  static void HandleProcEventLoss(void* cb_cookie, uint64_t lost);
   static void HandleHTTP2Event(void* cb_cookie, void* data, int data_size);
   static void HandleHTTP2EventLoss(void* cb_cookie, uint64_t lost);
   static void HandleGrpcCEvent(void* cb_cookie, void* data, int data_size);
@@ -209,9 +255,26 @@ class SocketTraceConnector : public BCCSourceConnector {
       bool outgoing,
       /* OUT */ struct go_grpc_http2_header_event_t* header_event_data_go_style);
 
+  // Appends the records that TransferStream() produced for one tracker to its data table.
+  using AppendRecordsFn = std::function<void()>;
+
+  // Parses and stitches the data of the tracker into records. This only touches the state of the
+  // tracker, so trackers are processed concurrently. The records are appended to data_table
+  // through the returned function, which runs on the Stirling thread; it is empty if there are no
+  // records.
+  // When RED metrics are enabled, the records of the protocols that REDSampleOf() supports are
+  // also aggregated into red_metrics_.
   template <typename TProtocolTraits>
-  void TransferStream(ConnectorContext* ctx, ConnTracker* tracker, DataTable* data_table);
+  AppendRecordsFn TransferStream(ConnectorContext* ctx, ConnTracker* tracker,
+                                 DataTable* data_table, DataTable* red_metrics_table);
   void TransferConnStats(ConnectorContext* ctx, DataTable* data_table);
+  // Reads the conn_stats aggregated in BPF, see --stirling_conn_stats_bpf_aggregation.
+  std::vector<std::pair<struct conn_stats_agg_key_t, struct conn_stats_agg_t>>
+  ReadConnStatsAggMap();
+  // Flushes the RED metrics aggregated over the last --stirling_red_metrics_interval_secs.
+  void TransferREDMetrics(ConnectorContext* ctx, DataTable* data_table);
+  // Flushes the per-protocol processing costs of the last --stirling_protocol_costs_interval_secs.
+  void TransferProtocolCosts(DataTable* data_table);
 
   void set_iteration_time(std::chrono::time_point<std::chrono::steady_clock> time) {
     DCHECK(time >= iteration_time_);
@@ -221,12 +284,23 @@ class SocketTraceConnector : public BCCSourceConnector {
 
   void UpdateTrackerTraceLevel(ConnTracker* tracker);
 
+  // Handles the TLS data that is still being coalesced in BPF, and clears it from the BPF map.
+  // See --stirling_socket_tracer_ssl_coalescing.
+  void DrainSSLCoalesceMap();
+
+  // Disables the trackers of the connections that are not sampled, see SetDegradationLevel().
+  void SampleTracker(ConnTracker* tracker);
+
   template <typename TRecordType>
   static void AppendMessage(ConnectorContext* ctx, const ConnTracker& conn_tracker,
                             TRecordType record, DataTable* data_table);
 
   std::thread RunDeployUProbesThread(const absl::flat_hash_set<md::UPID>& pids);
 
+  // Deploys uprobes on the processes that exec'ed since the last call, or on all new processes
+  // when the periodic full scan is due. See --stirling_enable_proc_events.
+  std::thread DeployUProbesOnNewUPIDs(ConnectorContext* ctx);
+
   // Setups output file stream object writing to the input file path.
   void SetupOutput(const std::filesystem::path& file);
 
@@ -236,10 +310,27 @@ class SocketTraceConnector : public BCCSourceConnector {
   ConnTrackersManager conn_trackers_mgr_;
 
   ConnStats conn_stats_;
+  // Only set with --stirling_conn_stats_bpf_aggregation.
+  std::unique_ptr<WrappedBCCMap<struct conn_stats_agg_key_t, struct conn_stats_agg_t>>
+      conn_stats_agg_map_;
+
+  // Only set with --stirling_socket_tracer_ssl_coalescing.
+  std::unique_ptr<WrappedBCCMap<uint64_t, struct ssl_coalesce_buf_t>> ssl_coalesce_map_;
+
+  REDMetrics red_metrics_{FLAGS_stirling_red_metrics_max_keys};
+  std::chrono::steady_clock::time_point red_metrics_interval_start_;
+
+  ProtocolCosts protocol_costs_;
+  std::chrono::steady_clock::time_point protocol_costs_interval_start_;
 
   std::unique_ptr<WrappedBCCArrayTable<int>> openssl_trace_state_;
   std::unique_ptr<WrappedBCCMap<uint32_t, struct openssl_trace_state_debug_t>>
       openssl_trace_state_debug_;
+
+  // See EnableTracedTGIDsFilter(). traced_tgids_ mirrors the keys of traced_tgids_map_.
+  absl::flat_hash_set<std::string> traced_namespaces_;
+  std::unique_ptr<WrappedBCCMap<uint32_t, uint8_t>> traced_tgids_map_;
+  absl::flat_hash_set<uint32_t> traced_tgids_;
   prometheus::Family<prometheus::Counter>& openssl_trace_mismatched_fds_counter_family_;
   prometheus::Family<prometheus::Counter>& openssl_trace_tls_source_counter_family_;
 
@@ -253,7 +344,8 @@ class SocketTraceConnector : public BCCSourceConnector {
     int32_t trace_mode = TraceMode::Off;
     uint32_t table_num = 0;
     std::vector<endpoint_role_t> trace_roles;
-    std::function<void(SocketTraceConnector&, ConnectorContext*, ConnTracker*, DataTable*)>
+    std::function<AppendRecordsFn(SocketTraceConnector&, ConnectorContext*, ConnTracker*,
+                                  DataTable*, DataTable*)>
         transfer_fn = nullptr;
     bool enabled = false;
   };
@@ -280,6 +372,12 @@ class SocketTraceConnector : public BCCSourceConnector {
   //   Example: data_table->SetConsumeRecordsCutoffTime(perf_buffer_drain_time_);
   uint64_t perf_buffer_drain_time_ = 0;
 
+  // Total size of the socket data events buffer, across all cpus, and the counters of the
+  // data received and lost at the previous drain. Used to compute transfer_load_.
+  int64_t data_buffer_capacity_ = 0;
+  int64_t prev_data_event_bytes_ = 0;
+  int64_t prev_data_event_loss_ = 0;
+
   // If not a nullptr, writes the events received from perf buffers to this stream.
   std::unique_ptr<std::ofstream> perf_buffer_events_output_stream_;
   enum class OutputFormat {
@@ -293,15 +391,25 @@ class SocketTraceConnector : public BCCSourceConnector {
 
   std::unique_ptr<system::ProcParser> proc_parser_;
 
+  // Processes the trackers in TransferDataImpl(), see --stirling_socket_tracer_num_threads.
+  std::unique_ptr<ThreadPool> transfer_thread_pool_;
+
   std::shared_ptr<ConnInfoMapManager> conn_info_map_mgr_;
 
   UProbeManager uprobe_mgr_;
 
+  // The processes that exec'ed and exited since they were last handed to uprobe_mgr_, as reported
+  // through proc_events.
+  absl::flat_hash_set<struct upid_t> proc_exec_upids_;
+  absl::flat_hash_set<struct upid_t> proc_exit_upids_;
+  std::chrono::steady_clock::time_point next_proc_full_scan_time_;
+
   enum class StatKey {
     kLossSocketDataEvent,
     kLossSocketControlEvent,
     kLossConnStatsEvent,
     kLossMMapEvent,
+    kLossProcEvent,
     kLossHTTP2Event,
     kLossGrpcCEvent,
     kLossGrpcCHeaderEvent,
@@ -311,6 +419,7 @@ class SocketTraceConnector : public BCCSourceConnector {
     kPollSocketDataEventAttrSize,
     kPollSocketDataEventDataSize,
     kPollSocketDataEventSize,
+    kPollSocketControlEventCount,
   };
 
   utils::StatCounter<StatKey> stats_;
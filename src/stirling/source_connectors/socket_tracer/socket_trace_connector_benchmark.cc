@@ -16,6 +16,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <utility>
+
 #include <gflags/gflags.h>
 
 #include <absl/container/flat_hash_set.h>
@@ -220,6 +222,15 @@ static void BM_SocketTraceConnector(benchmark::State& state, BenchmarkDataGenera
 #undef MEM_COUNTER
 }
 
+// Shows how TransferData() scales with the threads that process the connections.
+// NOLINTNEXTLINE: runtime/references.
+static void BM_SocketTraceConnectorThreads(benchmark::State& state,
+                                           BenchmarkDataGenerationSpec spec) {
+  FLAGS_stirling_socket_tracer_num_threads = state.range(0);
+  BM_SocketTraceConnector(state, std::move(spec));
+  FLAGS_stirling_socket_tracer_num_threads = 1;
+}
+
 constexpr uint64_t kRecordSize = 128 * 1024;
 BENCHMARK_CAPTURE(BM_SocketTraceConnector, http1_no_gaps,
                   BenchmarkDataGenerationSpec{
@@ -397,3 +408,20 @@ BENCHMARK_CAPTURE(BM_SocketTraceConnector, http1_intra_iter_gaps,
                           },
                   })
     ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(BM_SocketTraceConnectorThreads, http1_many_conns,
+                  BenchmarkDataGenerationSpec{
+                      .num_conns = 1000,
+                      .num_poll_iterations = 1,
+                      .records_per_conn = 4,
+                      .protocol = kProtocolHTTP,
+                      .role = kRoleServer,
+                      .rec_gen_func =
+                          []() { return std::make_unique<HTTP1SingleReqRespGen>(16 * 1024); },
+                      .pos_gen_func = []() { return std::make_unique<NoGapsPosGenerator>(); },
+                  })
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Unit(benchmark::kMillisecond);
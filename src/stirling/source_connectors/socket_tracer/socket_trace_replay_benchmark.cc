@@ -0,0 +1,213 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+// Replays a capture of production traffic through the user-space pipeline of the socket tracer,
+// to reproduce performance problems that the synthetic traffic of
+// socket_trace_connector_benchmark does not.
+//
+// Capture with:
+//   --socket_trace_data_events_output_path=/tmp/capture.bin
+// Replay with:
+//   socket_trace_replay_benchmark --capture_path=/tmp/capture.bin [--replay_pace=max]
+//
+// A benchmark is registered for the whole capture, and one per protocol in the capture, which
+// only replays the events of that protocol.
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include <benchmark/benchmark.h>
+#include <magic_enum.hpp>
+
+#include "src/common/base/base.h"
+#include "src/common/perf/memory_tracker.h"
+#include "src/common/perf/tcmalloc.h"
+#include "src/stirling/core/connector_context.h"
+#include "src/stirling/core/data_tables.h"
+#include "src/stirling/source_connectors/socket_tracer/socket_trace_connector.h"
+#include "src/stirling/source_connectors/socket_tracer/testing/benchmark_data_gen/capture_replay.h"
+#include "src/stirling/source_connectors/socket_tracer/testing/socket_trace_connector_friend.h"
+
+DEFINE_string(capture_path, "",
+              "The capture to replay, written with --socket_trace_data_events_output_path=*.bin.");
+DEFINE_string(replay_pace, "recorded",
+              "How the events are grouped into poll iterations. 'recorded': by their captured "
+              "timestamps, one iteration per sampling period. 'max': --replay_events_per_iter "
+              "events per iteration.");
+DEFINE_uint64(replay_events_per_iter, 1000,
+              "The number of events per poll iteration, for --replay_pace=max.");
+
+using ::benchmark::Counter;
+using ::px::MemoryStats;
+using ::px::MemoryTracker;
+using ::px::stirling::SocketTraceConnector;
+using ::px::stirling::SocketTraceConnectorFriend;
+using ::px::stirling::SystemWideStandaloneContext;
+using ::px::stirling::testing::CaptureReplayData;
+using ::px::stirling::testing::CaptureReplaySpec;
+using ::px::stirling::testing::ReadCapture;
+using ::px::stirling::testing::ReplayPace;
+
+namespace {
+
+// Counts the records of each table, and their total size.
+void CountOutput(px::stirling::DataTables* tables, std::vector<uint64_t>* output_records,
+                 uint64_t* output_bytes) {
+  std::vector<px::stirling::DataTable*> data_tables = tables->tables();
+  for (size_t i = 0; i < data_tables.size(); ++i) {
+    for (auto tagged_record : data_tables[i]->ConsumeRecords()) {
+      if (tagged_record.records.size() > 0) {
+        (*output_records)[i] += tagged_record.records[0]->Size();
+      }
+      for (auto column_wrapper : tagged_record.records) {
+        *output_bytes += column_wrapper->Bytes();
+      }
+    }
+  }
+}
+
+px::StatusOr<CaptureReplaySpec> GetReplaySpec() {
+  CaptureReplaySpec spec;
+  if (FLAGS_replay_pace == "recorded") {
+    spec.pace = ReplayPace::kRecorded;
+    spec.sampling_period = SocketTraceConnector::kSamplingPeriod;
+  } else if (FLAGS_replay_pace == "max") {
+    spec.pace = ReplayPace::kMaxSpeed;
+    spec.events_per_iter = FLAGS_replay_events_per_iter;
+  } else {
+    return px::error::InvalidArgument("Invalid --replay_pace: $0", FLAGS_replay_pace);
+  }
+  return spec;
+}
+
+}  // namespace
+
+// Only benchmarks the path from receiving events from BPF to transferring those events to
+// DataTables, like BM_SocketTraceConnector.
+// NOLINTNEXTLINE: runtime/references.
+static void BM_ReplayCapture(benchmark::State& state, const CaptureReplayData& data) {
+  MemoryStats mem_stats;
+  uint64_t total_output_bytes = 0;
+  std::vector<uint64_t> total_output_records(SocketTraceConnector::kTables.size());
+
+  SystemWideStandaloneContext ctx;
+  bool is_first_iter = true;
+  for (auto _ : state) {
+    state.PauseTiming();
+    {
+      auto source_connector = SocketTraceConnectorFriend::Create("socket_trace_connector");
+      auto socket_trace_connector =
+          static_cast<SocketTraceConnectorFriend*>(source_connector.get());
+
+      px::stirling::DataTables tables(SocketTraceConnector::kTables);
+      source_connector->set_data_tables({tables.tables()});
+      for (socket_control_event_t control_event : data.control_events) {
+        socket_trace_connector->HandleControlEvent(&control_event, sizeof(control_event));
+      }
+      source_connector->TransferData(&ctx);
+
+      MemoryTracker mem_tracker(is_first_iter);
+      if (is_first_iter) {
+        mem_tracker.Start();
+      }
+      state.ResumeTiming();
+
+      // START timed part of benchmark.
+
+      for (const auto& iter_events : data.per_iter_data_events) {
+        for (const std::string& event : iter_events) {
+          // HandleDataEvent() copies the event, like it does from the perf buffer.
+          socket_trace_connector->HandleDataEvent(
+              reinterpret_cast<socket_data_event_t*>(const_cast<char*>(event.data())),
+              event.size());
+        }
+        source_connector->TransferData(&ctx);
+      }
+
+      // END timed part of benchmark.
+
+      state.PauseTiming();
+      if (is_first_iter) {
+        mem_stats = mem_tracker.End();
+      }
+      CountOutput(&tables, &total_output_records, &total_output_bytes);
+    }
+    px::ReleaseFreeMemory();
+    is_first_iter = false;
+    state.ResumeTiming();
+  }
+
+#define MEM_COUNTER(x) Counter(x, Counter::kDefaults, Counter::OneK::kIs1024)
+  state.SetBytesProcessed(data.data_size_bytes * state.iterations());
+  state.counters["PollIters"] = Counter(data.per_iter_data_events.size());
+  state.counters["NumEvents"] = Counter(data.num_data_events());
+  state.counters["AllocPeak"] = MEM_COUNTER(mem_stats.max.allocated - mem_stats.start.allocated);
+  state.counters["AllocMemEnd"] = MEM_COUNTER(mem_stats.end.allocated - mem_stats.start.allocated);
+  state.counters["BytesOutput"] = MEM_COUNTER(total_output_bytes / state.iterations());
+  for (const auto& [protocol, bytes] : data.data_size_bytes_by_protocol) {
+    state.counters[absl::StrCat("BytesInput_", magic_enum::enum_name(protocol))] =
+        MEM_COUNTER(bytes);
+  }
+  for (size_t i = 0; i < total_output_records.size(); ++i) {
+    if (total_output_records[i] > 0) {
+      state.counters[absl::StrCat("Rows_", SocketTraceConnector::kTables[i].name())] =
+          Counter(total_output_records[i] / state.iterations());
+    }
+  }
+#undef MEM_COUNTER
+}
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  px::EnvironmentGuard env_guard(&argc, argv);
+
+  if (FLAGS_capture_path.empty()) {
+    LOG(FATAL) << "--capture_path is required.";
+  }
+  CaptureReplaySpec spec = GetReplaySpec().ConsumeValueOrDie();
+
+  // The captures are read up front, so that reading them is not timed. They must outlive the
+  // benchmarks, which only capture references to them.
+  std::vector<std::unique_ptr<CaptureReplayData>> captures;
+  auto register_capture = [&](std::string name, const CaptureReplaySpec& capture_spec) {
+    captures.push_back(std::make_unique<CaptureReplayData>(
+        ReadCapture(FLAGS_capture_path, capture_spec).ConsumeValueOrDie()));
+    benchmark::RegisterBenchmark(name.c_str(), BM_ReplayCapture, std::cref(*captures.back()))
+        ->Unit(benchmark::kMillisecond);
+  };
+
+  register_capture("BM_ReplayCapture/all", spec);
+  std::map<traffic_protocol_t, uint64_t> data_size_bytes_by_protocol =
+      captures.front()->data_size_bytes_by_protocol;
+  for (const auto& [protocol, bytes] : data_size_bytes_by_protocol) {
+    CaptureReplaySpec protocol_spec = spec;
+    protocol_spec.protocol = protocol;
+    register_capture(absl::StrCat("BM_ReplayCapture/", magic_enum::enum_name(protocol)),
+                     protocol_spec);
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -19,6 +19,8 @@
 #pragma once
 
 #include "src/stirling/source_connectors/socket_tracer/conn_stats_table.h"
+#include "src/stirling/source_connectors/socket_tracer/protocol_costs_table.h"
+#include "src/stirling/source_connectors/socket_tracer/red_metrics_table.h"
 
 // PROTOCOL_LIST: Requires update on new protocols.
 #include "src/stirling/source_connectors/socket_tracer/amqp_table.h"
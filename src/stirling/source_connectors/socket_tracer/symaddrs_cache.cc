@@ -0,0 +1,259 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/symaddrs_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <type_traits>
+#include <utility>
+
+#include <absl/strings/str_cat.h>
+
+#include "src/common/base/file.h"
+#include "src/common/fs/fs_wrapper.h"
+#include "src/stirling/utils/binary_decoder.h"
+
+DEFINE_string(stirling_symaddrs_cache_dir,
+              gflags::StringFromEnv("PL_STIRLING_SYMADDRS_CACHE_DIR", ""),
+              "Directory where Stirling keeps the symbol addresses and uprobes of the Go binaries "
+              "it analyzed, keyed by binary contents, across restarts. Should be on a host path. "
+              "Empty disables the cache.");
+DEFINE_uint32(stirling_symaddrs_cache_max_entries,
+              gflags::Uint32FromEnv("PL_STIRLING_SYMADDRS_CACHE_MAX_ENTRIES", 4096),
+              "The maximum number of binaries in --stirling_symaddrs_cache_dir.");
+
+namespace px {
+namespace stirling {
+
+namespace {
+
+// Bump when the format, or what is computed for a binary (e.g. the symaddrs), changes.
+constexpr uint32_t kFormatVersion = 1;
+constexpr std::string_view kMagic = "PXSYMADDRS";
+constexpr std::string_view kGoFilePrefix = "go_";
+
+template <typename TIntType>
+void AppendInt(TIntType val, std::string* out) {
+  // The cache is local to the node, so the native byte order is the one of the reader.
+  out->append(reinterpret_cast<const char*>(&val), sizeof(val));
+}
+
+void AppendString(std::string_view str, std::string* out) {
+  AppendInt<uint32_t>(str.size(), out);
+  out->append(str);
+}
+
+StatusOr<std::string_view> ExtractString(BinaryDecoder* decoder) {
+  PX_ASSIGN_OR_RETURN(uint32_t size, decoder->ExtractLEInt<uint32_t>());
+  return decoder->ExtractString(size);
+}
+
+// An error is stored as its code and message.
+void AppendError(const Status& status, std::string* out) {
+  AppendInt<int32_t>(status.code(), out);
+  AppendString(status.msg(), out);
+}
+
+template <typename T>
+Status ExtractError(BinaryDecoder* decoder, StatusOr<T>* error) {
+  PX_ASSIGN_OR_RETURN(int32_t code, decoder->ExtractLEInt<int32_t>());
+  PX_ASSIGN_OR_RETURN(std::string_view msg, ExtractString(decoder));
+  if (code == statuspb::OK || !statuspb::Code_IsValid(code)) {
+    return error::Internal("Invalid error code $0.", code);
+  }
+  *error = Status(static_cast<statuspb::Code>(code), std::string(msg));
+  return Status::OK();
+}
+
+template <typename TSymAddrs>
+void AppendSymAddrs(const StatusOr<TSymAddrs>& symaddrs, std::string* out) {
+  static_assert(std::is_trivially_copyable_v<TSymAddrs>);
+  AppendInt<uint8_t>(symaddrs.ok(), out);
+  if (symaddrs.ok()) {
+    out->append(reinterpret_cast<const char*>(&symaddrs.ValueOrDie()), sizeof(TSymAddrs));
+  } else {
+    AppendError(symaddrs.status(), out);
+  }
+}
+
+template <typename TSymAddrs>
+Status ExtractSymAddrs(BinaryDecoder* decoder, StatusOr<TSymAddrs>* symaddrs) {
+  PX_ASSIGN_OR_RETURN(uint8_t ok, decoder->ExtractLEInt<uint8_t>());
+  if (!ok) {
+    return ExtractError(decoder, symaddrs);
+  }
+  PX_ASSIGN_OR_RETURN(std::string_view bytes, decoder->ExtractString(sizeof(TSymAddrs)));
+  TSymAddrs val;
+  std::memcpy(&val, bytes.data(), sizeof(TSymAddrs));
+  *symaddrs = val;
+  return Status::OK();
+}
+
+void AppendUProbes(const StatusOr<std::vector<bpf_tools::UProbeSpec>>& uprobes,
+                   std::string* out) {
+  AppendInt<uint8_t>(uprobes.ok(), out);
+  if (!uprobes.ok()) {
+    AppendError(uprobes.status(), out);
+    return;
+  }
+  AppendInt<uint32_t>(uprobes.ValueOrDie().size(), out);
+  for (const bpf_tools::UProbeSpec& spec : uprobes.ValueOrDie()) {
+    AppendString(spec.symbol, out);
+    AppendInt<uint64_t>(spec.address, out);
+    AppendInt<int32_t>(static_cast<int32_t>(spec.attach_type), out);
+    AppendString(spec.probe_fn, out);
+    AppendInt<uint8_t>(spec.is_optional, out);
+  }
+}
+
+Status ExtractUProbes(BinaryDecoder* decoder,
+                      StatusOr<std::vector<bpf_tools::UProbeSpec>>* uprobes) {
+  PX_ASSIGN_OR_RETURN(uint8_t ok, decoder->ExtractLEInt<uint8_t>());
+  if (!ok) {
+    return ExtractError(decoder, uprobes);
+  }
+  PX_ASSIGN_OR_RETURN(uint32_t num_specs, decoder->ExtractLEInt<uint32_t>());
+  std::vector<bpf_tools::UProbeSpec> specs;
+  for (uint32_t i = 0; i < num_specs; ++i) {
+    bpf_tools::UProbeSpec spec;
+    PX_ASSIGN_OR_RETURN(std::string_view symbol, ExtractString(decoder));
+    spec.symbol = symbol;
+    PX_ASSIGN_OR_RETURN(spec.address, decoder->ExtractLEInt<uint64_t>());
+    PX_ASSIGN_OR_RETURN(int32_t attach_type, decoder->ExtractLEInt<int32_t>());
+    spec.attach_type = static_cast<bpf_tools::BPFProbeAttachType>(attach_type);
+    PX_ASSIGN_OR_RETURN(std::string_view probe_fn, ExtractString(decoder));
+    spec.probe_fn = probe_fn;
+    PX_ASSIGN_OR_RETURN(uint8_t is_optional, decoder->ExtractLEInt<uint8_t>());
+    spec.is_optional = is_optional;
+    specs.push_back(std::move(spec));
+  }
+  *uprobes = std::move(specs);
+  return Status::OK();
+}
+
+// Entries of the same format version with other symaddrs layouts are not compatible.
+std::string FormatHeader(std::string_view fingerprint) {
+  std::string header(kMagic);
+  AppendInt<uint32_t>(kFormatVersion, &header);
+  AppendInt<uint32_t>(sizeof(struct go_common_symaddrs_t), &header);
+  AppendInt<uint32_t>(sizeof(struct go_tls_symaddrs_t), &header);
+  AppendInt<uint32_t>(sizeof(struct go_http2_symaddrs_t), &header);
+  AppendString(fingerprint, &header);
+  return header;
+}
+
+StatusOr<std::filesystem::path> GoCacheFilePath(std::string_view binary_hash) {
+  if (FLAGS_stirling_symaddrs_cache_dir.empty()) {
+    return error::NotFound("Symaddrs cache is disabled.");
+  }
+  return std::filesystem::path(FLAGS_stirling_symaddrs_cache_dir) /
+         absl::StrCat(kGoFilePrefix, binary_hash);
+}
+
+// Removes the least recently used entries, so that at most max_entries remain.
+void EvictCacheEntries(const std::filesystem::path& dir, size_t max_entries) {
+  std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> entries;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+    auto mtime = entry.last_write_time(ec);
+    if (!ec) {
+      entries.emplace_back(mtime, entry.path());
+    }
+  }
+  if (entries.size() <= max_entries) {
+    return;
+  }
+
+  size_t num_evicted = entries.size() - max_entries;
+  std::partial_sort(entries.begin(), entries.begin() + num_evicted, entries.end());
+  for (size_t i = 0; i < num_evicted; ++i) {
+    PX_UNUSED(fs::Remove(entries[i].second));
+  }
+}
+
+}  // namespace
+
+std::string SerializeGoBinaryAnalysis(const GoBinaryAnalysis& analysis,
+                                      std::string_view fingerprint) {
+  std::string out = FormatHeader(fingerprint);
+  AppendSymAddrs(analysis.common_symaddrs, &out);
+  AppendSymAddrs(analysis.tls_symaddrs, &out);
+  AppendUProbes(analysis.tls_uprobes, &out);
+  AppendSymAddrs(analysis.http2_symaddrs, &out);
+  AppendUProbes(analysis.http2_uprobes, &out);
+  return out;
+}
+
+StatusOr<GoBinaryAnalysis> ParseGoBinaryAnalysis(std::string_view data,
+                                                 std::string_view fingerprint) {
+  const std::string header = FormatHeader(fingerprint);
+  if (data.substr(0, header.size()) != header) {
+    return error::NotFound("Incompatible symaddrs cache entry.");
+  }
+
+  BinaryDecoder decoder(data.substr(header.size()));
+  GoBinaryAnalysis analysis;
+  PX_RETURN_IF_ERROR(ExtractSymAddrs(&decoder, &analysis.common_symaddrs));
+  PX_RETURN_IF_ERROR(ExtractSymAddrs(&decoder, &analysis.tls_symaddrs));
+  PX_RETURN_IF_ERROR(ExtractUProbes(&decoder, &analysis.tls_uprobes));
+  PX_RETURN_IF_ERROR(ExtractSymAddrs(&decoder, &analysis.http2_symaddrs));
+  PX_RETURN_IF_ERROR(ExtractUProbes(&decoder, &analysis.http2_uprobes));
+  if (!decoder.eof()) {
+    return error::Internal("Symaddrs cache entry has $0 trailing bytes.", decoder.BufSize());
+  }
+  return analysis;
+}
+
+StatusOr<GoBinaryAnalysis> ReadCachedGoBinaryAnalysis(std::string_view binary_hash,
+                                                      std::string_view fingerprint) {
+  PX_ASSIGN_OR_RETURN(const std::filesystem::path path, GoCacheFilePath(binary_hash));
+  PX_ASSIGN_OR_RETURN(const std::string data, ReadFileToString(path.string()));
+  PX_ASSIGN_OR_RETURN(GoBinaryAnalysis analysis, ParseGoBinaryAnalysis(data, fingerprint));
+
+  // Keeps the entry from being evicted as least recently used.
+  std::error_code ec;
+  std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+
+  return analysis;
+}
+
+Status WriteCachedGoBinaryAnalysis(std::string_view binary_hash, std::string_view fingerprint,
+                                   const GoBinaryAnalysis& analysis) {
+  PX_ASSIGN_OR_RETURN(const std::filesystem::path path, GoCacheFilePath(binary_hash));
+  PX_RETURN_IF_ERROR(fs::CreateDirectories(path.parent_path()));
+
+  // Written under a temporary name first, so that readers never see a partial file, even if the
+  // process dies while writing.
+  const std::filesystem::path tmp_path = absl::StrCat(path.string(), ".tmp");
+  PX_RETURN_IF_ERROR(
+      WriteFileFromString(tmp_path.string(), SerializeGoBinaryAnalysis(analysis, fingerprint)));
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path, ec);
+  if (ec) {
+    return error::Internal("Could not rename $0 to $1: $2", tmp_path.string(), path.string(),
+                           ec.message());
+  }
+
+  EvictCacheEntries(path.parent_path(), FLAGS_stirling_symaddrs_cache_max_entries);
+  return Status::OK();
+}
+
+}  // namespace stirling
+}  // namespace px
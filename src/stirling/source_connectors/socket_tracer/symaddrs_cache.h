@@ -0,0 +1,86 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/stirling/bpf_tools/probe_specs/probe_specs.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/common.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/symaddrs.h"
+
+DECLARE_string(stirling_symaddrs_cache_dir);
+DECLARE_uint32(stirling_symaddrs_cache_max_entries);
+
+namespace px {
+namespace stirling {
+
+/**
+ * What the UProbeManager needs to know to probe a Go binary. It only depends on the contents of
+ * the binary, and on the probes that Stirling deploys.
+ */
+struct GoBinaryAnalysis {
+  // An error if the binary is not a Go binary with the mandatory symbols, in which case the
+  // other fields are not set.
+  StatusOr<struct go_common_symaddrs_t> common_symaddrs;
+  StatusOr<struct go_tls_symaddrs_t> tls_symaddrs;
+  // The binary_path of the specs is not set.
+  StatusOr<std::vector<bpf_tools::UProbeSpec>> tls_uprobes;
+  StatusOr<struct go_http2_symaddrs_t> http2_symaddrs;
+  StatusOr<std::vector<bpf_tools::UProbeSpec>> http2_uprobes;
+};
+
+/**
+ * Serializes the analysis for the symaddrs cache.
+ *
+ * @param fingerprint Identifies what the analysis was made for, e.g. the probe templates. An entry
+ *                    is only read back with the same fingerprint.
+ */
+std::string SerializeGoBinaryAnalysis(const GoBinaryAnalysis& analysis,
+                                      std::string_view fingerprint);
+
+/**
+ * Parses the output of SerializeGoBinaryAnalysis(). Returns an error if the data is malformed,
+ * was written by an incompatible version, or for another fingerprint.
+ */
+StatusOr<GoBinaryAnalysis> ParseGoBinaryAnalysis(std::string_view data,
+                                                 std::string_view fingerprint);
+
+/**
+ * Reads the analysis of the Go binary with the given content hash from
+ * --stirling_symaddrs_cache_dir, so that the binaries of common images are only analyzed once
+ * per node, even across restarts.
+ *
+ * @return error if the cache is disabled (empty flag) or has no matching entry.
+ */
+StatusOr<GoBinaryAnalysis> ReadCachedGoBinaryAnalysis(std::string_view binary_hash,
+                                                      std::string_view fingerprint);
+
+/**
+ * Writes the analysis of the Go binary with the given content hash into
+ * --stirling_symaddrs_cache_dir. Evicts the least recently used entries beyond
+ * --stirling_symaddrs_cache_max_entries.
+ */
+Status WriteCachedGoBinaryAnalysis(std::string_view binary_hash, std::string_view fingerprint,
+                                   const GoBinaryAnalysis& analysis);
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/symaddrs_cache.h"
+
+#include <chrono>
+#include <filesystem>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+using ::px::testing::TempDir;
+
+namespace {
+
+GoBinaryAnalysis TestAnalysis() {
+  GoBinaryAnalysis analysis;
+
+  struct go_common_symaddrs_t common_symaddrs = {};
+  common_symaddrs.FD_Sysfd_offset = 16;
+  analysis.common_symaddrs = common_symaddrs;
+
+  struct go_tls_symaddrs_t tls_symaddrs = {};
+  tls_symaddrs.Write_b_loc = {.type = kLocationTypeRegisters, .offset = 8};
+  analysis.tls_symaddrs = tls_symaddrs;
+  analysis.tls_uprobes = std::vector<bpf_tools::UProbeSpec>{
+      {.symbol = "crypto/tls.(*Conn).Write", .probe_fn = "probe_entry_tls_conn_write"},
+      {.address = 0x4000,
+       .attach_type = bpf_tools::BPFProbeAttachType::kEntry,
+       .probe_fn = "probe_return_tls_conn_write"},
+  };
+
+  analysis.http2_symaddrs = error::NotFound("No HTTP2 symbols.");
+  analysis.http2_uprobes = error::Internal("Not analyzed.");
+  return analysis;
+}
+
+void ExpectTestAnalysis(const GoBinaryAnalysis& analysis) {
+  ASSERT_OK(analysis.common_symaddrs);
+  EXPECT_EQ(analysis.common_symaddrs.ValueOrDie().FD_Sysfd_offset, 16);
+
+  ASSERT_OK(analysis.tls_symaddrs);
+  EXPECT_EQ(analysis.tls_symaddrs.ValueOrDie().Write_b_loc.type, kLocationTypeRegisters);
+  EXPECT_EQ(analysis.tls_symaddrs.ValueOrDie().Write_b_loc.offset, 8);
+
+  ASSERT_OK(analysis.tls_uprobes);
+  const auto& specs = analysis.tls_uprobes.ValueOrDie();
+  ASSERT_EQ(specs.size(), 2);
+  EXPECT_EQ(specs[0].symbol, "crypto/tls.(*Conn).Write");
+  EXPECT_EQ(specs[0].address, 0);
+  EXPECT_EQ(specs[0].probe_fn, "probe_entry_tls_conn_write");
+  EXPECT_EQ(specs[1].symbol, "");
+  EXPECT_EQ(specs[1].address, 0x4000);
+  EXPECT_EQ(specs[1].probe_fn, "probe_return_tls_conn_write");
+
+  EXPECT_TRUE(error::IsNotFound(analysis.http2_symaddrs.status()));
+  EXPECT_EQ(analysis.http2_symaddrs.msg(), "No HTTP2 symbols.");
+  EXPECT_TRUE(error::IsInternal(analysis.http2_uprobes.status()));
+}
+
+}  // namespace
+
+TEST(SymAddrsCacheTest, SerializeAndParse) {
+  std::string data = SerializeGoBinaryAnalysis(TestAnalysis(), "probes-v1");
+  ASSERT_OK_AND_ASSIGN(GoBinaryAnalysis analysis, ParseGoBinaryAnalysis(data, "probes-v1"));
+  ExpectTestAnalysis(analysis);
+
+  EXPECT_NOT_OK(ParseGoBinaryAnalysis(data, "probes-v2"));
+  EXPECT_NOT_OK(ParseGoBinaryAnalysis(data.substr(0, data.size() - 1), "probes-v1"));
+  EXPECT_NOT_OK(ParseGoBinaryAnalysis(data + "x", "probes-v1"));
+}
+
+TEST(SymAddrsCacheTest, DisabledByDefault) {
+  PX_SET_FOR_SCOPE(FLAGS_stirling_symaddrs_cache_dir, "");
+  EXPECT_NOT_OK(WriteCachedGoBinaryAnalysis("0123abcd", "probes-v1", TestAnalysis()));
+  EXPECT_NOT_OK(ReadCachedGoBinaryAnalysis("0123abcd", "probes-v1"));
+}
+
+TEST(SymAddrsCacheTest, ReadWrite) {
+  TempDir tmp_dir;
+  PX_SET_FOR_SCOPE(FLAGS_stirling_symaddrs_cache_dir, tmp_dir.path().string());
+
+  EXPECT_NOT_OK(ReadCachedGoBinaryAnalysis("0123abcd", "probes-v1"));
+  ASSERT_OK(WriteCachedGoBinaryAnalysis("0123abcd", "probes-v1", TestAnalysis()));
+  ASSERT_OK_AND_ASSIGN(GoBinaryAnalysis analysis,
+                       ReadCachedGoBinaryAnalysis("0123abcd", "probes-v1"));
+  ExpectTestAnalysis(analysis);
+
+  EXPECT_NOT_OK(ReadCachedGoBinaryAnalysis("0123abcd", "probes-v2"));
+  EXPECT_NOT_OK(ReadCachedGoBinaryAnalysis("4567ef01", "probes-v1"));
+}
+
+TEST(SymAddrsCacheTest, EvictsLeastRecentlyUsed) {
+  TempDir tmp_dir;
+  PX_SET_FOR_SCOPE(FLAGS_stirling_symaddrs_cache_dir, tmp_dir.path().string());
+  PX_SET_FOR_SCOPE(FLAGS_stirling_symaddrs_cache_max_entries, 2);
+
+  ASSERT_OK(WriteCachedGoBinaryAnalysis("aa", "probes-v1", TestAnalysis()));
+  ASSERT_OK(WriteCachedGoBinaryAnalysis("bb", "probes-v1", TestAnalysis()));
+  // Make aa the oldest entry, regardless of the timestamp resolution of the file system.
+  std::filesystem::last_write_time(tmp_dir.path() / "go_aa",
+                                   std::filesystem::file_time_type::clock::now() -
+                                       std::chrono::hours(1));
+  ASSERT_OK(WriteCachedGoBinaryAnalysis("cc", "probes-v1", TestAnalysis()));
+
+  EXPECT_NOT_OK(ReadCachedGoBinaryAnalysis("aa", "probes-v1"));
+  EXPECT_OK(ReadCachedGoBinaryAnalysis("bb", "probes-v1"));
+  EXPECT_OK(ReadCachedGoBinaryAnalysis("cc", "probes-v1"));
+}
+
+}  // namespace stirling
+}  // namespace px
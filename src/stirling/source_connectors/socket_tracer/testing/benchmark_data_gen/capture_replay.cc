@@ -0,0 +1,156 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/stirling/source_connectors/socket_tracer/testing/benchmark_data_gen/capture_replay.h"
+
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/util/delimited_message_util.h>
+
+#include <cstring>
+#include <fstream>
+#include <tuple>
+
+#include <absl/container/flat_hash_set.h>
+
+#include "src/stirling/source_connectors/socket_tracer/proto/sock_event.pb.h"
+
+namespace px {
+namespace stirling {
+namespace testing {
+
+namespace {
+
+socket_control_event_t OpenConnEvent(uint64_t ts, const struct conn_id_t& conn_id,
+                                     endpoint_role_t role) {
+  struct socket_control_event_t conn_event {};
+  conn_event.type = kConnOpen;
+  conn_event.timestamp_ns = ts;
+  conn_event.conn_id = conn_id;
+  conn_event.open.raddr.sa.sa_family = AF_INET;
+  conn_event.open.laddr.sa.sa_family = AF_INET;
+  conn_event.open.role = role;
+  return conn_event;
+}
+
+// Serializes one chunk of the message of the data event, like BPF submits it to the perf buffer.
+std::string DataEvent(const sockeventpb::SocketDataEvent& pb, uint64_t pos, std::string_view msg) {
+  socket_data_event_t::attr_t attr = {};
+  attr.timestamp_ns = pb.attr().timestamp_ns();
+  attr.conn_id.upid.pid = pb.attr().conn_id().pid();
+  attr.conn_id.upid.start_time_ticks = pb.attr().conn_id().start_time_ns();
+  attr.conn_id.fd = pb.attr().conn_id().fd();
+  attr.conn_id.tsid = pb.attr().conn_id().generation();
+  attr.protocol = static_cast<traffic_protocol_t>(pb.attr().protocol());
+  attr.role = static_cast<endpoint_role_t>(pb.attr().role());
+  attr.direction = static_cast<traffic_direction_t>(pb.attr().direction());
+  attr.pos = pos;
+  attr.msg_size = msg.size();
+  attr.msg_buf_size = msg.size();
+
+  std::string event(offsetof(socket_data_event_t, msg) + msg.size(), '\0');
+  memcpy(event.data() + offsetof(socket_data_event_t, attr), &attr, sizeof(attr));
+  msg.copy(event.data() + offsetof(socket_data_event_t, msg), msg.size());
+  return event;
+}
+
+}  // namespace
+
+size_t CaptureReplayData::num_data_events() const {
+  size_t num_events = 0;
+  for (const auto& iter_events : per_iter_data_events) {
+    num_events += iter_events.size();
+  }
+  return num_events;
+}
+
+StatusOr<CaptureReplayData> ReadCapture(const std::filesystem::path& path,
+                                        const CaptureReplaySpec& spec) {
+  using ::google::protobuf::io::IstreamInputStream;
+  using ::google::protobuf::util::ParseDelimitedFromZeroCopyStream;
+
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs) {
+    return error::NotFound("Could not open capture $0.", path.string());
+  }
+  IstreamInputStream input(&ifs);
+
+  CaptureReplayData data;
+  auto conn_key = [](const struct conn_id_t& conn_id) {
+    return std::make_tuple(conn_id.upid.pid, conn_id.upid.start_time_ticks, conn_id.fd,
+                           conn_id.tsid);
+  };
+  absl::flat_hash_set<decltype(conn_key(conn_id_t{}))> conns;
+  std::optional<uint64_t> iter_start_ts;
+
+  sockeventpb::SocketDataEvent pb;
+  bool clean_eof = false;
+  while (ParseDelimitedFromZeroCopyStream(&pb, &input, &clean_eof)) {
+    auto protocol = static_cast<traffic_protocol_t>(pb.attr().protocol());
+    if (spec.protocol.has_value() && protocol != spec.protocol.value()) {
+      continue;
+    }
+    uint64_t ts = pb.attr().timestamp_ns();
+
+    // Start a new poll iteration, if this event does not belong in the current one.
+    bool new_iter = data.per_iter_data_events.empty();
+    switch (spec.pace) {
+      case ReplayPace::kRecorded:
+        if (!iter_start_ts.has_value() ||
+            ts >= iter_start_ts.value() + spec.sampling_period.count()) {
+          iter_start_ts = ts;
+          new_iter = true;
+        }
+        break;
+      case ReplayPace::kMaxSpeed:
+        new_iter = new_iter || data.per_iter_data_events.back().size() >= spec.events_per_iter;
+        break;
+    }
+    if (new_iter) {
+      data.per_iter_data_events.emplace_back();
+    }
+
+    struct conn_id_t conn_id = {};
+    conn_id.upid.pid = pb.attr().conn_id().pid();
+    conn_id.upid.start_time_ticks = pb.attr().conn_id().start_time_ns();
+    conn_id.fd = pb.attr().conn_id().fd();
+    conn_id.tsid = pb.attr().conn_id().generation();
+    if (conns.insert(conn_key(conn_id)).second) {
+      data.control_events.push_back(
+          OpenConnEvent(ts, conn_id, static_cast<endpoint_role_t>(pb.attr().role())));
+    }
+
+    // The captured events came from the perf buffer, so they should already fit, but split them
+    // like BPF would, just in case.
+    std::string_view msg = pb.msg();
+    for (size_t offset = 0; offset < msg.size(); offset += MAX_MSG_SIZE) {
+      data.per_iter_data_events.back().push_back(
+          DataEvent(pb, pb.attr().pos() + offset, msg.substr(offset, MAX_MSG_SIZE)));
+    }
+    data.data_size_bytes += msg.size();
+    data.data_size_bytes_by_protocol[protocol] += msg.size();
+  }
+  if (!clean_eof) {
+    return error::Internal("Capture $0 is truncated or not in the binary format.", path.string());
+  }
+  return data;
+}
+
+}  // namespace testing
+}  // namespace stirling
+}  // namespace px
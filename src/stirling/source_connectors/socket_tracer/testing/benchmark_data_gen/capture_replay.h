@@ -0,0 +1,88 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/socket_trace.hpp"
+
+namespace px {
+namespace stirling {
+namespace testing {
+
+enum class ReplayPace {
+  // Events are grouped into poll iterations by their captured timestamps, one poll iteration per
+  // sampling period of capture time, as they were polled when they were captured. Idle periods
+  // are skipped.
+  kRecorded,
+  // Events are grouped into poll iterations of a fixed number of events, regardless of their
+  // timestamps.
+  kMaxSpeed,
+};
+
+struct CaptureReplaySpec {
+  ReplayPace pace = ReplayPace::kRecorded;
+
+  // The capture time covered by each poll iteration, for ReplayPace::kRecorded.
+  std::chrono::nanoseconds sampling_period = std::chrono::milliseconds{200};
+
+  // The number of data events in each poll iteration, for ReplayPace::kMaxSpeed.
+  size_t events_per_iter = 1000;
+
+  // If set, only the data events of this protocol are replayed.
+  std::optional<traffic_protocol_t> protocol;
+};
+
+struct CaptureReplayData {
+  // Open events for each connection in the capture, which only records data events.
+  std::vector<socket_control_event_t> control_events;
+
+  // Data events per poll iteration. Each data event is serialized as it would arrive from the
+  // perf buffer: a socket_data_event_t that is truncated after its msg_buf_size bytes of msg.
+  std::vector<std::vector<std::string>> per_iter_data_events;
+
+  // Total size of all messages in per_iter_data_events, also broken down by protocol.
+  uint64_t data_size_bytes = 0;
+  std::map<traffic_protocol_t, uint64_t> data_size_bytes_by_protocol;
+
+  size_t num_data_events() const;
+};
+
+/**
+ * Reads the data events that SocketTraceConnector writes to
+ * --socket_trace_data_events_output_path, which must be in the binary (.bin) format, for replay
+ * through SocketTraceConnector::HandleDataEvent().
+ *
+ * The capture does not record the attributes that only matter to BPF (e.g. ssl and
+ * prepend_length_header), nor the control events; an open event is synthesized for each
+ * connection from the role of its first data event.
+ */
+StatusOr<CaptureReplayData> ReadCapture(const std::filesystem::path& path,
+                                        const CaptureReplaySpec& spec);
+
+}  // namespace testing
+}  // namespace stirling
+}  // namespace px
@@ -29,6 +29,7 @@
 #include <filesystem>
 #include <map>
 #include <tuple>
+#include <utility>
 
 #include "src/common/base/base.h"
 #include "src/common/base/utils.h"
@@ -39,6 +40,7 @@
 #include "src/stirling/obj_tools/dwarf_reader.h"
 #include "src/stirling/obj_tools/go_syms.h"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/symaddrs.h"
+#include "src/stirling/source_connectors/socket_tracer/go_map_compaction.h"
 #include "src/stirling/utils/linux_headers.h"
 #include "src/stirling/utils/proc_path_tools.h"
 
@@ -51,6 +53,18 @@ DEFINE_bool(stirling_enable_grpc_c_tracing,
 DEFINE_double(stirling_rescan_exp_backoff_factor, 2.0,
               "Exponential backoff factor used in decided how often to rescan binaries for "
               "dynamically loaded libraries");
+DEFINE_int32(stirling_uprobe_deploy_num_threads,
+             gflags::Int32FromEnv("PL_STIRLING_UPROBE_DEPLOY_NUM_THREADS", 4),
+             "The number of threads, including the uprobe deployment thread, that analyze new "
+             "binaries for uprobes. Each thread may hold the debug info of a binary in memory.");
+DEFINE_uint32(stirling_go_map_compaction_period_secs,
+              gflags::Uint32FromEnv("PL_STIRLING_GO_MAP_COMPACTION_PERIOD_SECS", 30),
+              "How often the BPF maps that stash the state of Go calls between their entry and "
+              "return probes are compacted.");
+DEFINE_uint32(stirling_go_map_entry_ttl_secs,
+              gflags::Uint32FromEnv("PL_STIRLING_GO_MAP_ENTRY_TTL_SECS", 600),
+              "The age after which a stashed Go call state, whose return probe never fired, is "
+              "removed from its BPF map.");
 
 namespace px {
 namespace stirling {
@@ -62,8 +76,51 @@ using ::px::system::KernelVersion;
 using ::px::system::KernelVersionOrder;
 using ::px::system::ProcPidRootPath;
 
-UProbeManager::UProbeManager(bpf_tools::BCCWrapper* bcc) : bcc_(bcc) {
+namespace {
+
+prometheus::Family<prometheus::Gauge>& GoStashMapEntriesFamily() {
+  static auto& family = prometheus::BuildGauge()
+                            .Name("socket_tracer_go_stash_map_entries")
+                            .Help("Entries of the BPF maps that stash the state of Go calls "
+                                  "between their entry and return probes, in total and the most "
+                                  "held by a single process.")
+                            .Register(GetMetricsRegistry());
+  return family;
+}
+
+prometheus::Family<prometheus::Counter>& GoStashMapEvictionsFamily() {
+  static auto& family = prometheus::BuildCounter()
+                            .Name("socket_tracer_go_stash_map_evictions")
+                            .Help("Entries removed by compaction from the BPF maps that stash the "
+                                  "state of Go calls, by reason.")
+                            .Register(GetMetricsRegistry());
+  return family;
+}
+
+}  // namespace
+
+UProbeManager::GoStashMapMetrics::GoStashMapMetrics(const std::string& map_name)
+    : entries(GoStashMapEntriesFamily().Add({{"map", map_name}, {"kind", "total"}})),
+      max_entries_per_pid(GoStashMapEntriesFamily().Add({{"map", map_name}, {"kind", "max_pid"}})),
+      evicted_exited(GoStashMapEvictionsFamily().Add({{"map", map_name}, {"reason", "exited"}})),
+      evicted_stale(GoStashMapEvictionsFamily().Add({{"map", map_name}, {"reason", "stale"}})),
+      evicted_over_capacity(
+          GoStashMapEvictionsFamily().Add({{"map", map_name}, {"reason", "over_capacity"}})) {}
+
+UProbeManager::UProbeManager(bpf_tools::BCCWrapper* bcc)
+    : bcc_(bcc),
+      deploy_duration_gauge_(BuildGauge("socket_tracer_uprobe_deploy_seconds",
+                                        "Duration of the last round of uprobe deployment on new "
+                                        "processes.")),
+      initial_coverage_gauge_(BuildGauge("socket_tracer_uprobe_initial_coverage_seconds",
+                                         "Time from the start of the socket tracer until the "
+                                         "processes running at that time had their uprobes "
+                                         "deployed.")),
+      tls_conn_op_map_metrics_("active_tls_conn_op_map"),
+      write_headers_frame_map_metrics_("active_write_headers_frame_map") {
   proc_parser_ = std::make_unique<system::ProcParser>();
+  analysis_thread_pool_ =
+      std::make_unique<ThreadPool>(std::max(0, FLAGS_stirling_uprobe_deploy_num_threads - 1));
 }
 
 void UProbeManager::Init(bool disable_go_tls_tracing, bool enable_http2_tracing,
@@ -71,6 +128,18 @@ void UProbeManager::Init(bool disable_go_tls_tracing, bool enable_http2_tracing,
   cfg_disable_go_tls_tracing_ = disable_go_tls_tracing;
   cfg_enable_http2_tracing_ = enable_http2_tracing;
   cfg_disable_self_probing_ = disable_self_probing;
+  init_time_ = std::chrono::steady_clock::now();
+
+  go_analysis_fingerprint_ = absl::StrCat("go_tls=", !cfg_disable_go_tls_tracing_,
+                                          " go_http2=", cfg_enable_http2_tracing_);
+  for (const auto& probe_tmpls : {ArrayView<UProbeTmpl>(kGoTLSUProbeTmpls),
+                                  ArrayView<UProbeTmpl>(kHTTP2ProbeTmpls)}) {
+    for (const UProbeTmpl& tmpl : probe_tmpls) {
+      absl::StrAppend(&go_analysis_fingerprint_, " ", tmpl.symbol, ":",
+                      static_cast<int>(tmpl.match_type), ":", tmpl.probe_fn, ":",
+                      static_cast<int>(tmpl.attach_type));
+    }
+  }
 
   openssl_source_map_ = MapT<ssl_source_t>::Create(bcc_, "openssl_source_map");
   openssl_symaddrs_map_ = MapT<struct openssl_symaddrs_t>::Create(bcc_, "openssl_symaddrs_map");
@@ -81,6 +150,10 @@ void UProbeManager::Init(bool disable_go_tls_tracing, bool enable_http2_tracing,
   node_tlswrap_symaddrs_map_ =
       MapT<struct node_tlswrap_symaddrs_t>::Create(bcc_, "node_tlswrap_symaddrs_map");
   grpc_c_versions_map_ = MapT<uint64_t>::Create(bcc_, "grpc_c_versions");
+  active_tls_conn_op_map_ = WrappedBCCMap<struct tgid_goid_t, struct go_tls_conn_args>::Create(
+      bcc_, "active_tls_conn_op_map");
+  active_write_headers_frame_map_ = WrappedBCCMap<void*, struct go_grpc_event_attr_t>::Create(
+      bcc_, "active_write_headers_frame_map");
 }
 
 void UProbeManager::NotifyMMapEvent(upid_t upid) {
@@ -100,9 +173,26 @@ Status UProbeManager::LogAndAttachUProbe(const bpf_tools::UProbeSpec& spec) {
 StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe_tmpls,
                                               const std::string& binary,
                                               obj_tools::ElfReader* elf_reader) {
+  PX_ASSIGN_OR_RETURN(std::vector<bpf_tools::UProbeSpec> specs,
+                      UProbeSpecsFromTmpl(probe_tmpls, binary, elf_reader));
+  return AttachUProbeSpecs(specs, binary);
+}
+
+StatusOr<int> UProbeManager::AttachUProbeSpecs(const std::vector<bpf_tools::UProbeSpec>& specs,
+                                               const std::string& binary) {
+  for (bpf_tools::UProbeSpec spec : specs) {
+    spec.binary_path = binary;
+    PX_RETURN_IF_ERROR(LogAndAttachUProbe(spec));
+  }
+  return static_cast<int>(specs.size());
+}
+
+StatusOr<std::vector<bpf_tools::UProbeSpec>> UProbeManager::UProbeSpecsFromTmpl(
+    const ArrayView<UProbeTmpl>& probe_tmpls, const std::string& binary,
+    obj_tools::ElfReader* elf_reader) {
   using bpf_tools::BPFProbeAttachType;
 
-  int uprobe_count = 0;
+  std::vector<bpf_tools::UProbeSpec> specs;
   for (const auto& tmpl : probe_tmpls) {
     bpf_tools::UProbeSpec spec = {binary,
                                   /*symbol*/ {},
@@ -123,8 +213,7 @@ StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe
         case BPFProbeAttachType::kEntry:
         case BPFProbeAttachType::kReturn: {
           spec.symbol = symbol_info.name;
-          PX_RETURN_IF_ERROR(LogAndAttachUProbe(spec));
-          ++uprobe_count;
+          specs.push_back(spec);
           break;
         }
         case BPFProbeAttachType::kReturnInsts: {
@@ -141,8 +230,7 @@ StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe
           for (const uint64_t& addr : ret_inst_addrs) {
             spec.attach_type = BPFProbeAttachType::kEntry;
             spec.address = addr;
-            PX_RETURN_IF_ERROR(LogAndAttachUProbe(spec));
-            ++uprobe_count;
+            specs.push_back(spec);
           }
           break;
         }
@@ -151,7 +239,7 @@ StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe
       }
     }
   }
-  return uprobe_count;
+  return specs;
 }
 
 Status UProbeManager::UpdateOpenSSLSymAddrs(obj_tools::RawFptrManager* fptr_manager,
@@ -164,36 +252,34 @@ Status UProbeManager::UpdateOpenSSLSymAddrs(obj_tools::RawFptrManager* fptr_mana
   return Status::OK();
 }
 
-Status UProbeManager::UpdateGoCommonSymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
-                                             const std::vector<int32_t>& pids) {
-  PX_ASSIGN_OR_RETURN(struct go_common_symaddrs_t symaddrs,
-                      GoCommonSymAddrs(elf_reader, dwarf_reader));
+Status UProbeManager::UpdateGoCommonSymAddrs(
+    const StatusOr<struct go_common_symaddrs_t>& symaddrs, const std::vector<int32_t>& pids) {
+  PX_RETURN_IF_ERROR(symaddrs.status());
 
   for (auto& pid : pids) {
-    PX_RETURN_IF_ERROR(go_common_symaddrs_map_->SetValue(pid, symaddrs));
+    PX_RETURN_IF_ERROR(go_common_symaddrs_map_->SetValue(pid, symaddrs.ValueOrDie()));
   }
 
   return Status::OK();
 }
 
-Status UProbeManager::UpdateGoHTTP2SymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
+Status UProbeManager::UpdateGoHTTP2SymAddrs(const StatusOr<struct go_http2_symaddrs_t>& symaddrs,
                                             const std::vector<int32_t>& pids) {
-  PX_ASSIGN_OR_RETURN(struct go_http2_symaddrs_t symaddrs,
-                      GoHTTP2SymAddrs(elf_reader, dwarf_reader));
+  PX_RETURN_IF_ERROR(symaddrs.status());
 
   for (auto& pid : pids) {
-    PX_RETURN_IF_ERROR(go_http2_symaddrs_map_->SetValue(pid, symaddrs));
+    PX_RETURN_IF_ERROR(go_http2_symaddrs_map_->SetValue(pid, symaddrs.ValueOrDie()));
   }
 
   return Status::OK();
 }
 
-Status UProbeManager::UpdateGoTLSSymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
+Status UProbeManager::UpdateGoTLSSymAddrs(const StatusOr<struct go_tls_symaddrs_t>& symaddrs,
                                           const std::vector<int32_t>& pids) {
-  PX_ASSIGN_OR_RETURN(struct go_tls_symaddrs_t symaddrs, GoTLSSymAddrs(elf_reader, dwarf_reader));
+  PX_RETURN_IF_ERROR(symaddrs.status());
 
   for (auto& pid : pids) {
-    PX_RETURN_IF_ERROR(go_tls_symaddrs_map_->SetValue(pid, symaddrs));
+    PX_RETURN_IF_ERROR(go_tls_symaddrs_map_->SetValue(pid, symaddrs.ValueOrDie()));
   }
 
   return Status::OK();
@@ -507,11 +593,10 @@ StatusOr<int> UProbeManager::AttachNodeJsOpenSSLUprobes(const uint32_t pid) {
 }
 
 StatusOr<int> UProbeManager::AttachGoTLSUProbes(const std::string& binary,
-                                                obj_tools::ElfReader* elf_reader,
-                                                obj_tools::DwarfReader* dwarf_reader,
+                                                const GoBinaryAnalysis& analysis,
                                                 const std::vector<int32_t>& pids) {
   // Step 1: Update BPF symbols_map on all new PIDs.
-  Status s = UpdateGoTLSSymAddrs(elf_reader, dwarf_reader, pids);
+  Status s = UpdateGoTLSSymAddrs(analysis.tls_symaddrs, pids);
   if (!s.ok()) {
     // Doesn't appear to be a binary with the mandatory symbols.
     // Might not even be a golang binary.
@@ -525,15 +610,15 @@ StatusOr<int> UProbeManager::AttachGoTLSUProbes(const std::string& binary,
     // This is not a new binary, so nothing more to do.
     return 0;
   }
-  return AttachUProbeTmpl(kGoTLSUProbeTmpls, binary, elf_reader);
+  PX_RETURN_IF_ERROR(analysis.tls_uprobes.status());
+  return AttachUProbeSpecs(analysis.tls_uprobes.ValueOrDie(), binary);
 }
 
 StatusOr<int> UProbeManager::AttachGoHTTP2UProbes(const std::string& binary,
-                                                  obj_tools::ElfReader* elf_reader,
-                                                  obj_tools::DwarfReader* dwarf_reader,
+                                                  const GoBinaryAnalysis& analysis,
                                                   const std::vector<int32_t>& pids) {
   // Step 1: Update BPF symaddrs for this binary.
-  Status s = UpdateGoHTTP2SymAddrs(elf_reader, dwarf_reader, pids);
+  Status s = UpdateGoHTTP2SymAddrs(analysis.http2_symaddrs, pids);
   if (!s.ok()) {
     return 0;
   }
@@ -544,7 +629,8 @@ StatusOr<int> UProbeManager::AttachGoHTTP2UProbes(const std::string& binary,
     // This is not a new binary, so nothing more to do.
     return 0;
   }
-  return AttachUProbeTmpl(kHTTP2ProbeTmpls, binary, elf_reader);
+  PX_RETURN_IF_ERROR(analysis.http2_uprobes.status());
+  return AttachUProbeSpecs(analysis.http2_uprobes.ValueOrDie(), binary);
 }
 
 namespace {
@@ -587,6 +673,16 @@ std::thread UProbeManager::RunDeployUProbesThread(const absl::flat_hash_set<md::
   return {};
 }
 
+std::thread UProbeManager::RunDeployUProbesThread(absl::flat_hash_set<md::UPID> exec_upids,
+                                                  absl::flat_hash_set<md::UPID> exit_upids) {
+  ++num_deploy_uprobes_threads_;
+  return std::thread(
+      [this, exec_upids = std::move(exec_upids), exit_upids = std::move(exit_upids)]() {
+        DeployUProbesOnEvents(exec_upids, exit_upids);
+        --num_deploy_uprobes_threads_;
+      });
+}
+
 void UProbeManager::CleanupPIDMaps(const absl::flat_hash_set<md::UPID>& deleted_upids) {
   for (const auto& pid : deleted_upids) {
     PX_UNUSED(openssl_source_map_->RemoveValue(pid.pid()));
@@ -598,6 +694,79 @@ void UProbeManager::CleanupPIDMaps(const absl::flat_hash_set<md::UPID>& deleted_
   }
 }
 
+namespace {
+
+// Removes the entries that SelectStashedEntriesToCompact() selects from the map,
+// and updates the metrics of the map.
+template <typename K, typename V, typename TEntryFn, typename TMetrics>
+void CompactStashMap(std::string_view name, WrappedBCCMap<K, V>* map, uint64_t now_ns,
+                     TEntryFn entry_fn, TMetrics* metrics) {
+  std::vector<std::pair<K, V>> table = map->GetTableOffline();
+
+  std::vector<StashedEntry> entries;
+  entries.reserve(table.size());
+  for (const auto& [key, value] : table) {
+    entries.push_back(entry_fn(key, value));
+  }
+
+  const size_t capacity = map->capacity();
+  const uint64_t ttl_ns = FLAGS_stirling_go_map_entry_ttl_secs * 1'000'000'000ULL;
+  StashedEntriesCompaction compaction = SelectStashedEntriesToCompact(
+      entries, now_ns, ttl_ns, /*high_watermark*/ capacity * 9 / 10,
+      /*low_watermark*/ capacity * 3 / 4,
+      [](uint32_t tgid) { return fs::Exists(system::ProcPidPath(tgid)); });
+
+  for (size_t i : compaction.evicted) {
+    PX_UNUSED(map->RemoveValue(table[i].first));
+  }
+
+  metrics->entries.Set(compaction.num_remaining);
+  metrics->max_entries_per_pid.Set(compaction.max_entries_per_tgid);
+  metrics->evicted_exited.Increment(compaction.num_exited);
+  metrics->evicted_stale.Increment(compaction.num_stale);
+  metrics->evicted_over_capacity.Increment(compaction.num_over_capacity);
+
+  VLOG_IF(1, !compaction.evicted.empty()) << absl::Substitute(
+      "Compacted BPF map $0: exited=$1 stale=$2 over_capacity=$3 remaining=$4/$5 "
+      "max_per_pid=$6 (pid=$7)",
+      name, compaction.num_exited, compaction.num_stale, compaction.num_over_capacity,
+      compaction.num_remaining, capacity, compaction.max_entries_per_tgid,
+      compaction.max_entries_tgid);
+}
+
+}  // namespace
+
+void UProbeManager::CompactGoStashMaps() {
+  const auto now = std::chrono::steady_clock::now();
+  if (now - last_go_stash_maps_compaction_ <
+      std::chrono::seconds(FLAGS_stirling_go_map_compaction_period_secs)) {
+    return;
+  }
+  last_go_stash_maps_compaction_ = now;
+
+  // BPF timestamps come from bpf_ktime_get_ns(), which is CLOCK_MONOTONIC like steady_clock.
+  const uint64_t now_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+
+  if (active_tls_conn_op_map_ != nullptr) {
+    CompactStashMap(
+        "active_tls_conn_op_map", active_tls_conn_op_map_.get(), now_ns,
+        [](const struct tgid_goid_t& key, const struct go_tls_conn_args& args) {
+          return StashedEntry{key.tgid, args.timestamp_ns};
+        },
+        &tls_conn_op_map_metrics_);
+  }
+
+  if (active_write_headers_frame_map_ != nullptr) {
+    CompactStashMap(
+        "active_write_headers_frame_map", active_write_headers_frame_map_.get(), now_ns,
+        [](void* /*encoder_ptr*/, const struct go_grpc_event_attr_t& attr) {
+          return StashedEntry{attr.conn_id.upid.pid, attr.timestamp_ns};
+        },
+        &write_headers_frame_map_metrics_);
+  }
+}
+
 int UProbeManager::DeployOpenSSLUProbes(const absl::flat_hash_set<md::UPID>& pids) {
   int uprobe_count = 0;
 
@@ -811,12 +980,98 @@ int UProbeManager::DeployGrpcCUProbes(const absl::flat_hash_set<md::UPID>& pids)
   return uprobe_count;
 }
 
-int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
-  int uprobe_count = 0;
+UProbeManager::GoBinaryAnalysis UProbeManager::AnalyzeGoBinary(const std::string& binary) const {
+  GoBinaryAnalysis analysis;
+
+  // Read binary's symbols.
+  StatusOr<std::unique_ptr<ElfReader>> elf_reader_status = ElfReader::Create(binary);
+  if (!elf_reader_status.ok()) {
+    LOG(WARNING) << absl::Substitute(
+        "Cannot analyze binary $0 for uprobe deployment. "
+        "If file is under /var/lib, container may have terminated. "
+        "Message = $1",
+        binary, elf_reader_status.msg());
+    analysis.common_symaddrs = elf_reader_status.status();
+    return analysis;
+  }
+  std::unique_ptr<ElfReader> elf_reader = elf_reader_status.ConsumeValueOrDie();
+
+  // Avoid going past this point if not a golang program.
+  // The DwarfReader is memory intensive, and the remaining probes are Golang specific.
+  if (!IsGoExecutable(elf_reader.get())) {
+    analysis.common_symaddrs = error::NotFound("$0 is not a Go executable.", binary);
+    return analysis;
+  }
+
+  StatusOr<std::unique_ptr<DwarfReader>> dwarf_reader_status =
+      DwarfReader::CreateWithLazyIndexing(binary);
+  if (!dwarf_reader_status.ok()) {
+    VLOG(1) << absl::Substitute(
+        "Failed to get binary $0 debug symbols. Cannot deploy uprobes. "
+        "Message = $1",
+        binary, dwarf_reader_status.msg());
+    analysis.common_symaddrs = dwarf_reader_status.status();
+    return analysis;
+  }
+  std::unique_ptr<DwarfReader> dwarf_reader = dwarf_reader_status.ConsumeValueOrDie();
+
+  analysis.common_symaddrs = GoCommonSymAddrs(elf_reader.get(), dwarf_reader.get());
+  if (!analysis.common_symaddrs.ok()) {
+    VLOG(1) << absl::Substitute(
+        "Golang binary $0 does not have the mandatory symbols (e.g. TCPConn).", binary);
+    analysis.common_symaddrs =
+        error::NotFound("Go binary $0 does not have the mandatory symbols: $1", binary,
+                        analysis.common_symaddrs.msg());
+    return analysis;
+  }
+
+  if (!cfg_disable_go_tls_tracing_) {
+    analysis.tls_symaddrs = GoTLSSymAddrs(elf_reader.get(), dwarf_reader.get());
+    if (analysis.tls_symaddrs.ok()) {
+      analysis.tls_uprobes = UProbeSpecsFromTmpl(kGoTLSUProbeTmpls, binary, elf_reader.get());
+    }
+  }
+
+  if (!cfg_disable_go_tls_tracing_ && cfg_enable_http2_tracing_) {
+    analysis.http2_symaddrs = GoHTTP2SymAddrs(elf_reader.get(), dwarf_reader.get());
+    if (analysis.http2_symaddrs.ok()) {
+      analysis.http2_uprobes = UProbeSpecsFromTmpl(kHTTP2ProbeTmpls, binary, elf_reader.get());
+    }
+  }
+
+  return analysis;
+}
 
+GoBinaryAnalysis UProbeManager::AnalyzeGoBinaryCached(const std::string& binary,
+                                                       const std::string& binary_hash) const {
+  if (!binary_hash.empty()) {
+    StatusOr<GoBinaryAnalysis> cached_or =
+        ReadCachedGoBinaryAnalysis(binary_hash, go_analysis_fingerprint_);
+    if (cached_or.ok()) {
+      VLOG(1) << absl::Substitute("Using cached analysis of binary $0 [hash=$1]", binary,
+                                  binary_hash);
+      return cached_or.ConsumeValueOrDie();
+    }
+  }
+
+  GoBinaryAnalysis analysis = AnalyzeGoBinary(binary);
+
+  // Only cache what depends on the contents of the binary. Failures to read the binary, e.g.
+  // because its container terminated, are retried on the next occurrence of the binary.
+  const Status& status = analysis.common_symaddrs.status();
+  if (!binary_hash.empty() && (status.ok() || error::IsNotFound(status))) {
+    Status s = WriteCachedGoBinaryAnalysis(binary_hash, go_analysis_fingerprint_, analysis);
+    LOG_IF(WARNING, !s.ok() && !FLAGS_stirling_symaddrs_cache_dir.empty())
+        << absl::Substitute("Failed to cache the analysis of binary $0: $1", binary, s.ToString());
+  }
+  return analysis;
+}
+
+int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
   static int32_t kPID = getpid();
 
-  for (const auto& [binary, pid_vec] : ConvertPIDsListToMap(pids)) {
+  std::vector<std::pair<std::string, std::vector<int32_t>>> binaries;
+  for (auto& [binary, pid_vec] : ConvertPIDsListToMap(pids)) {
     // Don't bother rescanning binaries that have been scanned before to avoid unnecessary work.
     if (!scanned_binaries_.insert(binary).second) {
       continue;
@@ -830,46 +1085,58 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
       }
     }
 
-    // Read binary's symbols.
-    StatusOr<std::unique_ptr<ElfReader>> elf_reader_status = ElfReader::Create(binary);
-    if (!elf_reader_status.ok()) {
-      LOG(WARNING) << absl::Substitute(
-          "Cannot analyze binary $0 for uprobe deployment. "
-          "If file is under /var/lib, container may have terminated. "
-          "Message = $1",
-          binary, elf_reader_status.msg());
-      continue;
-    }
-    std::unique_ptr<ElfReader> elf_reader = elf_reader_status.ConsumeValueOrDie();
+    binaries.emplace_back(binary, std::move(pid_vec));
+  }
 
-    // Avoid going past this point if not a golang program.
-    // The DwarfReader is memory intensive, and the remaining probes are Golang specific.
-    if (!IsGoExecutable(elf_reader.get())) {
-      continue;
+  // The same binary is typically found at many paths, one per container running its image.
+  // Hashing a binary is much cheaper than analyzing it, so the binaries are hashed to analyze each
+  // of them only once. The hashes also key the symaddrs cache, which keeps the analyses across
+  // restarts.
+  std::vector<std::string> binary_hashes(binaries.size());
+  analysis_thread_pool_->ParallelFor(binaries.size(), [&](size_t i) {
+    StatusOr<std::string> hash_or = MD5onFile(binaries[i].first);
+    if (hash_or.ok()) {
+      binary_hashes[i] = hash_or.ConsumeValueOrDie();
     }
+  });
 
-    StatusOr<std::unique_ptr<DwarfReader>> dwarf_reader_status =
-        DwarfReader::CreateIndexingAll(binary);
-    if (!dwarf_reader_status.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Failed to get binary $0 debug symbols. Cannot deploy uprobes. "
-          "Message = $1",
-          binary, dwarf_reader_status.msg());
-      continue;
+  absl::flat_hash_map<std::string, size_t> analysis_idx_by_hash;
+  std::vector<size_t> binaries_to_analyze;
+  std::vector<size_t> analysis_idx(binaries.size());
+  for (size_t i = 0; i < binaries.size(); ++i) {
+    // Binaries that could not be hashed are analyzed by themselves.
+    const std::string& identity =
+        binary_hashes[i].empty() ? binaries[i].first : binary_hashes[i];
+    auto [iter, inserted] = analysis_idx_by_hash.try_emplace(identity, binaries_to_analyze.size());
+    if (inserted) {
+      binaries_to_analyze.push_back(i);
     }
-    std::unique_ptr<DwarfReader> dwarf_reader = dwarf_reader_status.ConsumeValueOrDie();
-    Status s = UpdateGoCommonSymAddrs(elf_reader.get(), dwarf_reader.get(), pid_vec);
+    analysis_idx[i] = iter->second;
+  }
+
+  std::vector<GoBinaryAnalysis> analyses(binaries_to_analyze.size());
+  analysis_thread_pool_->ParallelFor(binaries_to_analyze.size(), [&](size_t i) {
+    const size_t binary_idx = binaries_to_analyze[i];
+    analyses[i] = AnalyzeGoBinaryCached(binaries[binary_idx].first, binary_hashes[binary_idx]);
+  });
+  VLOG(1) << absl::Substitute("Analyzed $0 distinct binaries out of $1", analyses.size(),
+                              binaries.size());
+
+  // Attach the uprobes of all binaries in one go; the BCCWrapper is not thread-safe.
+  int uprobe_count = 0;
+  for (size_t i = 0; i < binaries.size(); ++i) {
+    const auto& [binary, pid_vec] = binaries[i];
+    const GoBinaryAnalysis& analysis = analyses[analysis_idx[i]];
+
+    Status s = UpdateGoCommonSymAddrs(analysis.common_symaddrs, pid_vec);
     if (!s.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Golang binary $0 does not have the mandatory symbols (e.g. TCPConn).", binary);
       continue;
     }
 
     // GoTLS Probes.
     if (!cfg_disable_go_tls_tracing_) {
       VLOG(1) << absl::Substitute("Attempting to attach Go TLS uprobes to binary $0", binary);
-      StatusOr<int> attach_status =
-          AttachGoTLSUProbes(binary, elf_reader.get(), dwarf_reader.get(), pid_vec);
+      StatusOr<int> attach_status = AttachGoTLSUProbes(binary, analysis, pid_vec);
       if (!attach_status.ok()) {
         monitor_.AppendSourceStatusRecord("socket_tracer", attach_status.status(),
                                           "AttachGoTLSUProbes");
@@ -882,8 +1149,7 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
 
     // Go HTTP2 Probes.
     if (!cfg_disable_go_tls_tracing_ && cfg_enable_http2_tracing_) {
-      StatusOr<int> attach_status =
-          AttachGoHTTP2UProbes(binary, elf_reader.get(), dwarf_reader.get(), pid_vec);
+      StatusOr<int> attach_status = AttachGoHTTP2UProbes(binary, analysis, pid_vec);
       if (!attach_status.ok()) {
         monitor_.AppendSourceStatusRecord("socket_tracer", attach_status.status(),
                                           "AttachGoHTTP2UProbes");
@@ -958,10 +1224,28 @@ bool KernelVersionAllowsGRPCCTracing() {
 void UProbeManager::DeployUProbes(const absl::flat_hash_set<md::UPID>& pids) {
   const std::lock_guard<std::mutex> lock(deploy_uprobes_mutex_);
 
+  const auto start_time = std::chrono::steady_clock::now();
+
   proc_tracker_.Update(pids);
 
+  DeployUProbesOnTrackedUPIDs(start_time);
+}
+
+void UProbeManager::DeployUProbesOnEvents(const absl::flat_hash_set<md::UPID>& exec_upids,
+                                          const absl::flat_hash_set<md::UPID>& exit_upids) {
+  const std::lock_guard<std::mutex> lock(deploy_uprobes_mutex_);
+
+  const auto start_time = std::chrono::steady_clock::now();
+
+  proc_tracker_.UpdateFromEvents(exec_upids, exit_upids);
+
+  DeployUProbesOnTrackedUPIDs(start_time);
+}
+
+void UProbeManager::DeployUProbesOnTrackedUPIDs(std::chrono::steady_clock::time_point start_time) {
   // Before deploying new probes, clean-up map entries for old processes that are now dead.
   CleanupPIDMaps(proc_tracker_.deleted_upids());
+  CompactGoStashMaps();
 
   int uprobe_count = 0;
 
@@ -984,6 +1268,15 @@ void UProbeManager::DeployUProbes(const absl::flat_hash_set<md::UPID>& pids) {
   if (uprobe_count != 0) {
     LOG(INFO) << absl::Substitute("Number of uprobes deployed = $0", uprobe_count);
   }
+
+  const auto end_time = std::chrono::steady_clock::now();
+  deploy_duration_gauge_.Set(std::chrono::duration<double>(end_time - start_time).count());
+  if (!initial_deploy_done_) {
+    initial_deploy_done_ = true;
+    initial_coverage_gauge_.Set(std::chrono::duration<double>(end_time - init_time_).count());
+    LOG(INFO) << absl::Substitute("Initial uprobe deployment took $0 seconds",
+                                  initial_coverage_gauge_.Value());
+  }
 }
 
 }  // namespace stirling
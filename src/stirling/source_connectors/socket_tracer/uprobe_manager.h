@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <map>
 #include <memory>
 #include <string>
@@ -26,16 +27,21 @@
 
 #include <absl/synchronization/mutex.h>
 
+#include "src/common/base/thread_pool.h"
+#include "src/common/metrics/metrics.h"
 #include "src/common/system/proc_parser.h"
 #include "src/stirling/bpf_tools/bcc_wrapper.h"
 #include "src/stirling/obj_tools/dwarf_reader.h"
 #include "src/stirling/obj_tools/elf_reader.h"
 #include "src/stirling/obj_tools/raw_fptr_manager.h"
 
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/go_grpc_types.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/go_tls_types.h"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/grpc_c.h"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/socket_trace.hpp"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/symaddrs.h"
 
+#include "src/stirling/source_connectors/socket_tracer/symaddrs_cache.h"
 #include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs.h"
 #include "src/stirling/utils/detect_application.h"
 #include "src/stirling/utils/monitor.h"
@@ -46,6 +52,7 @@ DECLARE_bool(stirling_rescan_for_dlopen);
 DECLARE_bool(stirling_enable_grpc_c_tracing);
 DECLARE_double(stirling_rescan_exp_backoff_factor);
 DECLARE_bool(stirling_trace_static_tls_binaries);
+DECLARE_int32(stirling_uprobe_deploy_num_threads);
 
 namespace px {
 namespace stirling {
@@ -71,6 +78,18 @@ class UProbeManager {
   template <typename V>
   using MapT = WrappedBCCMap<uint32_t, V, /* user space managed */ true>;
 
+  // Occupancy and compaction metrics of a map of stashed Go call state.
+  struct GoStashMapMetrics {
+    explicit GoStashMapMetrics(const std::string& map_name);
+
+    prometheus::Gauge& entries;
+    // The most entries held by a single process.
+    prometheus::Gauge& max_entries_per_pid;
+    prometheus::Counter& evicted_exited;
+    prometheus::Counter& evicted_stale;
+    prometheus::Counter& evicted_over_capacity;
+  };
+
  public:
   /**
    * Construct a UProbeManager.
@@ -103,6 +122,17 @@ class UProbeManager {
    */
   std::thread RunDeployUProbesThread(const absl::flat_hash_set<md::UPID>& pids);
 
+  /**
+   * Runs the uprobe deployment code on the processes that exec'ed or exited since the last
+   * deployment, as a thread. Unlike the full set of PIDs, these don't need to be diffed against
+   * the previously known processes.
+   * @param exec_upids UPIDs of the processes that exec'ed, whose binaries are (re)analyzed.
+   * @param exit_upids UPIDs of the processes that exited, whose map entries are cleaned up.
+   * @return thread that handles the uprobe deployment work.
+   */
+  std::thread RunDeployUProbesThread(absl::flat_hash_set<md::UPID> exec_upids,
+                                     absl::flat_hash_set<md::UPID> exit_upids);
+
   /**
    * Returns true if a previously dispatched thread (via RunDeployUProbesThread is still running).
    */
@@ -465,6 +495,19 @@ class UProbeManager {
    */
   void DeployUProbes(const absl::flat_hash_set<md::UPID>& pids);
 
+  /**
+   * Same as DeployUProbes(), on the processes that exec'ed or exited.
+   */
+  void DeployUProbesOnEvents(const absl::flat_hash_set<md::UPID>& exec_upids,
+                             const absl::flat_hash_set<md::UPID>& exit_upids);
+
+  /**
+   * Deploys uprobes on the new UPIDs of proc_tracker_, after cleaning up after its deleted UPIDs.
+   * Must be called with deploy_uprobes_mutex_ held.
+   * @param start_time The time the deployment started, for the timing metrics.
+   */
+  void DeployUProbesOnTrackedUPIDs(std::chrono::steady_clock::time_point start_time);
+
   /**
    * Deploys all OpenSSL uprobes on new processes.
    * @param pids The list of pids to analyze and instrument with OpenSSL uprobes, if appropriate.
@@ -474,11 +517,26 @@ class UProbeManager {
 
   /**
    * Deploys all Go uprobes on new processes.
+   * The binaries are analyzed concurrently, once per distinct binary contents, and the uprobes
+   * are then attached on this thread.
    * @param pids The list of pids to analyze and instrument with Go uprobes, if appropriate.
    * @return Number of uprobes deployed.
    */
   int DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids);
 
+  /**
+   * Reads the symbols and debug info of the binary to compute its symbol addresses and uprobes.
+   * Does not touch the state of the UProbeManager, so it can run on any thread.
+   */
+  GoBinaryAnalysis AnalyzeGoBinary(const std::string& binary) const;
+
+  /**
+   * Like AnalyzeGoBinary(), but goes through the symaddrs cache, see ReadCachedGoBinaryAnalysis().
+   * @param binary_hash The MD5 hash of the binary, or empty if it is unknown.
+   */
+  GoBinaryAnalysis AnalyzeGoBinaryCached(const std::string& binary,
+                                         const std::string& binary_hash) const;
+
   /**
    * Sets up the BPF maps used for GOID tracking. Required for general Go tracing.
    *
@@ -492,16 +550,14 @@ class UProbeManager {
    * compatible Go binary.
    *
    * @param binary The path to the binary on which to deploy Go HTTP2 probes.
-   * @param elf_reader ELF reader for the binary.
-   * @param dwarf_reader DWARF reader for the binary.
+   * @param analysis The result of AnalyzeGoBinary() on the binary.
    * @param pids The list of PIDs that are new instances of the binary. Used to populate symbol
    *             addresses.
    * @return The number of uprobes deployed, or error. It is not considered an error if the binary
    *         is not a Go binary or doesn't use a Go HTTP2 library; instead the return value will be
    *         zero.
    */
-  StatusOr<int> AttachGoHTTP2UProbes(const std::string& binary, obj_tools::ElfReader* elf_reader,
-                                     obj_tools::DwarfReader* dwarf_reader,
+  StatusOr<int> AttachGoHTTP2UProbes(const std::string& binary, const GoBinaryAnalysis& analysis,
                                      const std::vector<int32_t>& pids);
 
   /**
@@ -509,15 +565,13 @@ class UProbeManager {
    * Go binary.
    *
    * @param binary The path to the binary on which to deploy Go HTTP2 probes.
-   * @param elf_reader ELF reader for the binary.
-   * @param dwarf_reader DWARF reader for the binary.
+   * @param analysis The result of AnalyzeGoBinary() on the binary.
    * @param pids The list of PIDs that are new instances of the binary. Used to populate symbol
    *             addresses.
    * @return The number of uprobes deployed, or error. It is not an error if the binary
    *         is not a Go binary or doesn't use Go TLS; instead the return value will be zero.
    */
-  StatusOr<int> AttachGoTLSUProbes(const std::string& binary, obj_tools::ElfReader* elf_reader,
-                                   obj_tools::DwarfReader* dwarf_reader,
+  StatusOr<int> AttachGoTLSUProbes(const std::string& binary, const GoBinaryAnalysis& analysis,
                                    const std::vector<int32_t>& new_pids);
 
   /**
@@ -573,18 +627,31 @@ class UProbeManager {
   StatusOr<int> AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe_tmpls,
                                  const std::string& binary, obj_tools::ElfReader* elf_reader);
 
+  /**
+   * Returns the uprobes that AttachUProbeTmpl() attaches, without attaching them.
+   */
+  static StatusOr<std::vector<bpf_tools::UProbeSpec>> UProbeSpecsFromTmpl(
+      const ArrayView<UProbeTmpl>& probe_tmpls, const std::string& binary,
+      obj_tools::ElfReader* elf_reader);
+
+  /**
+   * Attaches the uprobes to the binary, which replaces the binary path of the specs.
+   *
+   * @return Number of uprobes deployed, or error if any of them failed to deploy.
+   */
+  StatusOr<int> AttachUProbeSpecs(const std::vector<bpf_tools::UProbeSpec>& specs,
+                                  const std::string& binary);
+
   // Returns set of PIDs that have had mmap called on them since the last call.
   absl::flat_hash_set<md::UPID> PIDsToRescanForUProbes();
 
   Status UpdateOpenSSLSymAddrs(px::stirling::obj_tools::RawFptrManager* fptrManager,
                                std::filesystem::path container_lib, uint32_t pid);
-  Status UpdateGoCommonSymAddrs(obj_tools::ElfReader* elf_reader,
-                                obj_tools::DwarfReader* dwarf_reader,
+  Status UpdateGoCommonSymAddrs(const StatusOr<struct go_common_symaddrs_t>& symaddrs,
                                 const std::vector<int32_t>& pids);
-  Status UpdateGoHTTP2SymAddrs(obj_tools::ElfReader* elf_reader,
-                               obj_tools::DwarfReader* dwarf_reader,
+  Status UpdateGoHTTP2SymAddrs(const StatusOr<struct go_http2_symaddrs_t>& symaddrs,
                                const std::vector<int32_t>& pids);
-  Status UpdateGoTLSSymAddrs(obj_tools::ElfReader* elf_reader, obj_tools::DwarfReader* dwarf_reader,
+  Status UpdateGoTLSSymAddrs(const StatusOr<struct go_tls_symaddrs_t>& symaddrs,
                              const std::vector<int32_t>& pids);
   Status UpdateNodeTLSWrapSymAddrs(int32_t pid, const std::filesystem::path& node_exe,
                                    const SemVer& ver);
@@ -594,6 +661,11 @@ class UProbeManager {
   // Note that BPF maps can fill up if this is not done.
   void CleanupPIDMaps(const absl::flat_hash_set<md::UPID>& deleted_upids);
 
+  // Compacts the BPF maps that stash the state of Go calls between their entry and return probes,
+  // which are keyed by goroutine or by Go object rather than by PID.
+  // See SelectStashedEntriesToCompact(). Runs at most once per compaction period.
+  void CompactGoStashMaps();
+
   bpf_tools::BCCWrapper* bcc_;
 
   // Whether to try to uprobe ourself (e.g. for OpenSSL). Typically, we don't want to do that.
@@ -606,10 +678,24 @@ class UProbeManager {
   // Whether we want to enable HTTP2 tracing. When false, we don't deploy HTTP2 uprobes.
   bool cfg_enable_http2_tracing_;
 
+  // Identifies the Go probes and the config above in the symaddrs cache, so that cached analyses
+  // of other Stirling versions or configs are not used.
+  std::string go_analysis_fingerprint_;
+
   // Ensures DeployUProbes threads run sequentially.
   std::mutex deploy_uprobes_mutex_;
   std::atomic<int> num_deploy_uprobes_threads_ = 0;
 
+  // Analyzes the binaries in DeployGoUProbes(), along with the DeployUProbes thread.
+  std::unique_ptr<ThreadPool> analysis_thread_pool_;
+
+  // Time-to-coverage metrics. The first DeployUProbes() covers the processes that were running
+  // when Init() was called.
+  std::chrono::steady_clock::time_point init_time_;
+  bool initial_deploy_done_ = false;
+  prometheus::Gauge& deploy_duration_gauge_;
+  prometheus::Gauge& initial_coverage_gauge_;
+
   std::unique_ptr<system::ProcParser> proc_parser_;
   ProcTracker proc_tracker_;
 
@@ -644,6 +730,15 @@ class UProbeManager {
   // Key is python gRPC module's md5 hash, value is the corresponding version enum's numeric value.
   std::unique_ptr<MapT<uint64_t>> grpc_c_versions_map_;
 
+  // Maps of stashed Go call state, compacted by CompactGoStashMaps().
+  std::unique_ptr<WrappedBCCMap<struct tgid_goid_t, struct go_tls_conn_args>>
+      active_tls_conn_op_map_;
+  std::unique_ptr<WrappedBCCMap<void*, struct go_grpc_event_attr_t>>
+      active_write_headers_frame_map_;
+  std::chrono::steady_clock::time_point last_go_stash_maps_compaction_;
+  GoStashMapMetrics tls_conn_op_map_metrics_;
+  GoStashMapMetrics write_headers_frame_map_metrics_;
+
   const system::Config& syscfg_ = system::Config::GetInstance();
   StirlingMonitor& monitor_ = *StirlingMonitor::GetInstance();
 };
@@ -40,8 +40,21 @@
 // so default hash map size 10240 serves without conflicts.
 BPF_HASH(sock_store, uint32_t, struct sock*, 10240);
 
+// CFG_EVENT_MODE selects how the TCP events reach user space:
+//   1: each event is submitted to the tcp_events perf buffer, and aggregated in user space.
+//   0: the events are aggregated per connection in the tcp_agg_stats_a/b maps, which user space
+//      drains once per transfer. This keeps the cost independent of the event rate, e.g. during
+//      retransmission storms.
+#if CFG_EVENT_MODE
 // This is the perf buffer for BPF program to export TCP data from kernel to user space.
 BPF_PERF_OUTPUT(tcp_events);
+#else
+// tcp_stats_state: shared state vector between BPF & user space. See tcp_stats.h.
+BPF_ARRAY(tcp_stats_state, uint64_t, kTCPStatsStateVectorSize);
+
+BPF_HASH(tcp_agg_stats_a, struct tcp_agg_key_t, struct tcp_agg_stats_t, TCP_AGG_STATS_MAP_SIZE);
+BPF_HASH(tcp_agg_stats_b, struct tcp_agg_key_t, struct tcp_agg_stats_t, TCP_AGG_STATS_MAP_SIZE);
+#endif
 
 static bool valid_ip_family(int family) {
   if (family == AF_INET || family == AF_INET6) {
@@ -50,6 +63,57 @@ static bool valid_ip_family(int family) {
   return false;
 }
 
+#if !CFG_EVENT_MODE
+static __inline void aggregate_tcp_event(const struct tcp_event_t* event) {
+  int transfer_count_idx = kTCPStatsTransferCountIdx;
+  uint64_t* transfer_count = tcp_stats_state.lookup(&transfer_count_idx);
+  if (transfer_count == NULL) {
+    return;
+  }
+
+  struct tcp_agg_key_t key;
+  // Zero the padding too, because the whole key is hashed.
+  __builtin_memset(&key, 0, sizeof(key));
+  key.upid.tgid = event->upid.tgid;
+  key.upid.start_time_ticks = event->upid.start_time_ticks;
+  key.local_addr = event->local_addr;
+  key.remote_addr = event->remote_addr;
+
+  struct tcp_agg_stats_t zero = {};
+  struct tcp_agg_stats_t* stats = NULL;
+  if (*transfer_count % 2 == 0) {
+    stats = tcp_agg_stats_a.lookup_or_init(&key, &zero);
+  } else {
+    stats = tcp_agg_stats_b.lookup_or_init(&key, &zero);
+  }
+  if (stats == NULL) {
+    return;
+  }
+
+  switch (event->type) {
+    case kTCPTx:
+      lock_xadd(&stats->bytes_sent, event->size);
+      break;
+    case kTCPRx:
+      lock_xadd(&stats->bytes_recv, event->size);
+      break;
+    case kTCPRetransmissions:
+      lock_xadd(&stats->retransmissions, event->size);
+      break;
+    default:
+      break;
+  }
+}
+#endif
+
+static __inline void submit_tcp_event(struct pt_regs* ctx, struct tcp_event_t* event) {
+#if CFG_EVENT_MODE
+  tcp_events.perf_submit(ctx, event, sizeof(*event));
+#else
+  aggregate_tcp_event(event);
+#endif
+}
+
 static int tcp_sendstat(struct pt_regs* ctx, uint32_t tgid, uint32_t id, int size) {
   struct sock** sockpp;
   sockpp = sock_store.lookup(&id);
@@ -92,7 +156,7 @@ static int tcp_sendstat(struct pt_regs* ctx, uint32_t tgid, uint32_t id, int siz
 
   event.size = size;
   event.type = kTCPTx;
-  tcp_events.perf_submit(ctx, &event, sizeof(event));
+  submit_tcp_event(ctx, &event);
 
   sock_store.delete(&id);
   return 0;
@@ -174,7 +238,7 @@ int probe_entry_tcp_cleanup_rbuf(struct pt_regs* ctx, struct sock* sk, int copie
   event.upid.start_time_ticks = get_tgid_start_time();
   event.type = kTCPRx;
   event.size = copied;
-  tcp_events.perf_submit(ctx, &event, sizeof(event));
+  submit_tcp_event(ctx, &event);
   return 0;
 }
 
@@ -221,6 +285,6 @@ int probe_entry_tcp_retransmit_skb(struct pt_regs* ctx, struct sock* skp, struct
   event.upid.start_time_ticks = get_tgid_start_time();
   event.type = kTCPRetransmissions;
   event.size = 1;
-  tcp_events.perf_submit(ctx, &event, sizeof(event));
+  submit_tcp_event(ctx, &event);
   return 0;
 }
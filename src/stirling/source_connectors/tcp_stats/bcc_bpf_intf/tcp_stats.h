@@ -61,3 +61,26 @@ struct tcp_event_t {
   // Source of event.
   enum tcp_event_type_t type;
 };
+
+// The number of connections whose stats can be aggregated in each of the BPF maps per transfer.
+#define TCP_AGG_STATS_MAP_SIZE 16384
+
+// The key of the stats aggregated in BPF: one entry per local process and pair of endpoints.
+struct tcp_agg_key_t {
+  struct upid_t upid;
+  union sockaddress_t local_addr;
+  union sockaddress_t remote_addr;
+};
+
+// The stats of one connection, accumulated in BPF since the previous transfer.
+struct tcp_agg_stats_t {
+  uint64_t bytes_sent;
+  uint64_t bytes_recv;
+  uint64_t retransmissions;
+};
+
+// tcp_stats_state[0]: transfer count   # written on user side, read on BPF side
+// The parity of the transfer count selects the map that the probes aggregate into, while user
+// space drains the other one.
+static const uint32_t kTCPStatsTransferCountIdx = 0;
+static const uint32_t kTCPStatsStateVectorSize = 1;
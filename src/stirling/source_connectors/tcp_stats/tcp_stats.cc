@@ -27,8 +27,11 @@ namespace stirling {
 
 namespace {
 
-TCPStats::AggKey BuildAggKey(const upid_t& upid, const SockAddr& local_endpoint,
-                             const SockAddr& remote_endpoint) {
+TCPStats::AggKey BuildAggKey(const upid_t& upid, union sockaddress_t local_addr,
+                             union sockaddress_t remote_addr) {
+  SockAddr local_endpoint, remote_endpoint;
+  PopulateSockAddr(reinterpret_cast<struct sockaddr*>(&local_addr), &local_endpoint);
+  PopulateSockAddr(reinterpret_cast<struct sockaddr*>(&remote_addr), &remote_endpoint);
   return {
       .upid = upid,
       .local_addr = local_endpoint.AddrStr(),
@@ -41,14 +44,9 @@ TCPStats::AggKey BuildAggKey(const upid_t& upid, const SockAddr& local_endpoint,
 }  // namespace
 
 absl::flat_hash_map<TCPStats::AggKey, TCPStats::Stats>* TCPStats::UpdateStats(
-    const std::vector<tcp_event_t> events) {
+    const std::vector<tcp_event_t>& events) {
   for (auto& event : events) {
-    SockAddr laddr, raddr;
-    auto la = event.local_addr;
-    auto ra = event.remote_addr;
-    PopulateSockAddr(reinterpret_cast<struct sockaddr*>(&la), &laddr);
-    PopulateSockAddr(reinterpret_cast<struct sockaddr*>(&ra), &raddr);
-    TCPStats::AggKey key = BuildAggKey(event.upid, laddr, raddr);
+    TCPStats::AggKey key = BuildAggKey(event.upid, event.local_addr, event.remote_addr);
     auto& stats = tcp_agg_stats_[key];
 
     switch (event.type) {
@@ -70,5 +68,17 @@ absl::flat_hash_map<TCPStats::AggKey, TCPStats::Stats>* TCPStats::UpdateStats(
   return &tcp_agg_stats_;
 }
 
+absl::flat_hash_map<TCPStats::AggKey, TCPStats::Stats>* TCPStats::UpdateStats(
+    const std::vector<std::pair<tcp_agg_key_t, tcp_agg_stats_t>>& agg_stats) {
+  for (const auto& [agg_key, agg_stat] : agg_stats) {
+    TCPStats::AggKey key = BuildAggKey(agg_key.upid, agg_key.local_addr, agg_key.remote_addr);
+    auto& stats = tcp_agg_stats_[key];
+    stats.bytes_sent += agg_stat.bytes_sent;
+    stats.bytes_recv += agg_stat.bytes_recv;
+    stats.retransmissions += agg_stat.retransmissions;
+  }
+  return &tcp_agg_stats_;
+}
+
 }  // namespace stirling
 }  // namespace px
@@ -88,7 +88,13 @@ class TCPStats {
    * @return A mutable reference to all the aggregated connection stats. The reference is mutable
    *         for the purposes of removing stats that are no longer needed.
    */
-  absl::flat_hash_map<AggKey, Stats>* UpdateStats(const std::vector<tcp_event_t> events);
+  absl::flat_hash_map<AggKey, Stats>* UpdateStats(const std::vector<tcp_event_t>& events);
+
+  /**
+   * Same as above, but with the stats that have already been aggregated per connection in BPF.
+   */
+  absl::flat_hash_map<AggKey, Stats>* UpdateStats(
+      const std::vector<std::pair<tcp_agg_key_t, tcp_agg_stats_t>>& agg_stats);
 
  private:
   absl::flat_hash_map<AggKey, Stats> tcp_agg_stats_;
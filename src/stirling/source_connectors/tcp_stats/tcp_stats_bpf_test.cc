@@ -20,6 +20,7 @@
 #include <gtest/gtest.h>
 
 #include <string>
+#include <type_traits>
 
 #include "src/common/base/base.h"
 #include "src/common/exec/exec.h"
@@ -51,7 +52,13 @@ using tcp_stats::kTCPRetransmitsIdx;
 using ::testing::ContainsRegex;
 using ::testing::HasSubstr;
 
-class TcpTraceTest : public TcpTraceBPFTestFixture {};
+// Runs the tests with the events aggregated in BPF (the default), and with every event
+// submitted to user space.
+template <typename TEventMode>
+class TcpTraceTest : public TcpTraceBPFTestFixture<TEventMode::value> {};
+
+using EventModes = ::testing::Types<std::false_type, std::true_type>;
+TYPED_TEST_SUITE(TcpTraceTest, EventModes);
 
 //-----------------------------------------------------------------------------
 // Test Scenarios
@@ -81,7 +88,7 @@ std::vector<TcpStatsRecord> ToTcpStatsRecordVector(
   return result;
 }
 
-TEST_F(TcpTraceTest, Capture) {
+TYPED_TEST(TcpTraceTest, Capture) {
   SubProcess server_proc;
   std::thread server_thread([&] {
     std::vector<std::string> args = {
@@ -91,13 +98,13 @@ TEST_F(TcpTraceTest, Capture) {
   });
   server_thread.detach();
 
-  StartTransferDataThread();
+  this->StartTransferDataThread();
 
   // Send "hello" to 127.0.0.1, total 6 bytes of data
   std::string cmd1 = "echo \"hello\" | nc -w1 127.0.0.1 12345 -v";
   ASSERT_OK(px::Exec(cmd1));
 
-  StopTransferDataThread();
+  this->StopTransferDataThread();
 
   std::vector<TcpStatsRecord> expected = {
       {
@@ -111,11 +118,13 @@ TEST_F(TcpTraceTest, Capture) {
       },
   };
 
-  std::vector<TaggedRecordBatch> tablets = ConsumeRecords(TCPStatsConnector::kTCPStatsTableNum);
+  std::vector<TaggedRecordBatch> tablets =
+      this->ConsumeRecords(TCPStatsConnector::kTCPStatsTableNum);
   testing::Timeout t(std::chrono::minutes{1});
   auto records = ToTcpStatsRecordVector(tablets);
   while (!testing::RecordsContains(records, expected) && !t.TimedOut()) {
-    auto new_records = ToTcpStatsRecordVector(ConsumeRecords(TCPStatsConnector::kTCPStatsTableNum));
+    auto new_records =
+        ToTcpStatsRecordVector(this->ConsumeRecords(TCPStatsConnector::kTCPStatsTableNum));
     records.insert(records.end(), new_records.begin(), new_records.end());
     std::this_thread::sleep_for(std::chrono::milliseconds{200});
   }
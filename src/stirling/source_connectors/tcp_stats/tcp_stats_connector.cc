@@ -21,6 +21,7 @@
 #include <arpa/inet.h>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "src/common/base/base.h"
 #include "src/common/base/inet_utils.h"
@@ -29,6 +30,12 @@
 
 OBJ_STRVIEW(tcpstats_bcc_script, tcpstats);
 
+DEFINE_bool(stirling_tcp_stats_event_mode,
+            gflags::BoolFromEnv("PL_STIRLING_TCP_STATS_EVENT_MODE", false),
+            "If true, the TCP stats probes submit every TCP event to user space through a perf "
+            "buffer. Otherwise, the events are aggregated per connection in BPF maps, which are "
+            "read once per transfer.");
+
 namespace px {
 namespace stirling {
 
@@ -61,16 +68,30 @@ void HandleTcpEventLoss(void* /*cb_cookie*/, uint64_t /*lost*/) {
 }
 
 Status TCPStatsConnector::InitImpl() {
-  const auto perf_buffer_specs = MakeArray<bpf_tools::PerfBufferSpec>({
-      {"tcp_events", HandleTcpEvent, HandleTcpEventLoss, this, kPerfBufferPerCPUSizeBytes,
-       bpf_tools::PerfBufferSizeCategory::kData},
-  });
+  event_mode_ = FLAGS_stirling_tcp_stats_event_mode;
 
   sampling_freq_mgr_.set_period(kSamplingPeriod);
   push_freq_mgr_.set_period(kPushPeriod);
-  PX_RETURN_IF_ERROR(bcc_->InitBPFProgram(tcpstats_bcc_script));
+
+  const std::vector<std::string> defines = {
+      absl::Substitute("-DCFG_EVENT_MODE=$0", event_mode_ ? 1 : 0),
+  };
+  PX_RETURN_IF_ERROR(bcc_->InitBPFProgram(tcpstats_bcc_script, defines));
   PX_RETURN_IF_ERROR(bcc_->AttachKProbes(kProbeSpecs));
-  PX_RETURN_IF_ERROR(bcc_->OpenPerfBuffers(perf_buffer_specs));
+
+  if (event_mode_) {
+    const auto perf_buffer_specs = MakeArray<bpf_tools::PerfBufferSpec>({
+        {"tcp_events", HandleTcpEvent, HandleTcpEventLoss, this, kPerfBufferPerCPUSizeBytes,
+         bpf_tools::PerfBufferSizeCategory::kData},
+    });
+    PX_RETURN_IF_ERROR(bcc_->OpenPerfBuffers(perf_buffer_specs));
+  } else {
+    tcp_stats_state_ =
+        bpf_tools::WrappedBCCArrayTable<uint64_t>::Create(bcc_.get(), "tcp_stats_state");
+    agg_stats_a_ = AggStatsMap::Create(bcc_.get(), "tcp_agg_stats_a");
+    agg_stats_b_ = AggStatsMap::Create(bcc_.get(), "tcp_agg_stats_b");
+  }
+
   LOG(INFO) << absl::Substitute("Successfully deployed $0 kprobes.", kProbeSpecs.size());
   return Status::OK();
 }
@@ -83,10 +104,16 @@ Status TCPStatsConnector::StopImpl() {
 void TCPStatsConnector::TransferDataImpl(ConnectorContext* ctx) {
   DCHECK_EQ(data_tables_.size(), 1U) << "Only one table is allowed per TCPStatsConnector.";
 
-  bcc_->PollPerfBuffers();
-
   DataTable* data_table = data_tables_[0];
-  auto* agg_stats = tcp_stats_.UpdateStats(events_);
+  absl::flat_hash_map<TCPStats::AggKey, TCPStats::Stats>* agg_stats = nullptr;
+  if (event_mode_) {
+    bcc_->PollPerfBuffers();
+    agg_stats = tcp_stats_.UpdateStats(events_);
+    events_.clear();
+  } else {
+    agg_stats = tcp_stats_.UpdateStats(DrainAggStats());
+  }
+
   uint64_t time = AdjustedSteadyClockNowNS();
   absl::flat_hash_set<md::UPID> upids = ctx->GetUPIDs();
 
@@ -110,8 +137,21 @@ void TCPStatsConnector::TransferDataImpl(ConnectorContext* ctx) {
 
     agg_stats->erase(iter++);
   }
+}
 
-  events_.clear();
+std::vector<std::pair<struct tcp_agg_key_t, struct tcp_agg_stats_t>>
+TCPStatsConnector::DrainAggStats() {
+  // The probes aggregate into map A on even transfer counts, and into map B on odd ones.
+  // Switching the probes to the other map before reading this one means that no update is lost
+  // between reading and clearing the map. A probe that raced with the switch lands in this map
+  // after it was read, and is reported on the transfer after next.
+  const bool using_map_a = transfer_count_ % 2 == 0;
+  ++transfer_count_;
+  const auto s = tcp_stats_state_->SetValue(kTCPStatsTransferCountIdx, transfer_count_);
+  LOG_IF(ERROR, !s.ok()) << "Error writing transfer_count_: " << s.msg();
+
+  AggStatsMap* agg_stats = using_map_a ? agg_stats_a_.get() : agg_stats_b_.get();
+  return agg_stats->GetTableOffline(/*clear_table*/ true);
 }
 }  // namespace stirling
 }  // namespace px
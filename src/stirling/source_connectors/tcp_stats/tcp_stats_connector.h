@@ -20,8 +20,11 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <gflags/gflags.h>
+
 #include "src/common/base/base.h"
 #include "src/stirling/bpf_tools/bcc_wrapper.h"
 #include "src/stirling/core/canonical_types.h"
@@ -29,6 +32,8 @@
 #include "src/stirling/source_connectors/tcp_stats/tcp_stats.h"
 #include "src/stirling/source_connectors/tcp_stats/tcp_stats_table.h"
 
+DECLARE_bool(stirling_tcp_stats_event_mode);
+
 namespace px {
 namespace stirling {
 
@@ -57,7 +62,23 @@ class TCPStatsConnector : public BCCSourceConnector {
   explicit TCPStatsConnector(std::string_view name) : BCCSourceConnector(name, kTables) {}
 
  private:
+  using AggStatsMap = bpf_tools::WrappedBCCMap<struct tcp_agg_key_t, struct tcp_agg_stats_t>;
+
+  // Reads and clears the stats that the probes have aggregated since the previous transfer.
+  std::vector<std::pair<struct tcp_agg_key_t, struct tcp_agg_stats_t>> DrainAggStats();
+
+  // Whether the probes submit every event to user space; see --stirling_tcp_stats_event_mode.
+  bool event_mode_ = false;
+
+  // Used when event_mode_ is set.
   std::vector<struct tcp_event_t> events_;
+
+  // Used when event_mode_ is not set.
+  uint64_t transfer_count_ = 0;
+  std::unique_ptr<bpf_tools::WrappedBCCArrayTable<uint64_t>> tcp_stats_state_;
+  std::unique_ptr<AggStatsMap> agg_stats_a_;
+  std::unique_ptr<AggStatsMap> agg_stats_b_;
+
   TCPStats tcp_stats_;
 };
 }  // namespace stirling
@@ -35,9 +35,12 @@ namespace px {
 namespace stirling {
 namespace testing {
 
+template <bool TEventMode = false>
 class TcpTraceBPFTestFixture : public ::testing::Test {
  protected:
   void SetUp() override {
+    // The connector reads the mode when it is initialized.
+    PX_SET_FOR_SCOPE(FLAGS_stirling_tcp_stats_event_mode, TEventMode);
     auto source_connector = TCPStatsConnector::Create("tcp_stats");
     source_.reset(dynamic_cast<TCPStatsConnector*>(source_connector.release()));
     ASSERT_OK(source_->Init());
@@ -18,31 +18,41 @@
 
 #include "src/stirling/stirling.h"
 
+#include <sys/sysinfo.h>
+#include <time.h>
+
 #include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <utility>
 #include <vector>
 
 #include <absl/base/internal/spinlock.h>
+#include <absl/container/flat_hash_set.h>
+#include <absl/strings/str_join.h>
+#include <absl/strings/str_split.h>
 
 #include "src/common/base/base.h"
 #include "src/common/json/json.h"
 #include "src/common/perf/elapsed_timer.h"
+#include "src/common/perf/perf_probe.h"
 #include "src/stirling/utils/run_core_stats.h"
 #include "src/stirling/utils/system_info.h"
 
 #include "src/stirling/bpf_tools/probe_cleaner.h"
+#include "src/stirling/core/cpu_budget_governor.h"
 #include "src/stirling/core/data_table.h"
 #include "src/stirling/core/pub_sub_manager.h"
 #include "src/stirling/core/source_connector.h"
 #include "src/stirling/core/source_registry.h"
 #include "src/stirling/proto/stirling.pb.h"
 
+#include "src/stirling/source_connectors/bpf_stats/bpf_stats_connector.h"
 #include "src/stirling/source_connectors/dynamic_bpftrace/dynamic_bpftrace_connector.h"
 #include "src/stirling/source_connectors/dynamic_bpftrace/utils.h"
 #include "src/stirling/source_connectors/dynamic_tracer/dynamic_trace_connector.h"
@@ -66,6 +76,31 @@ DEFINE_string(stirling_sources, gflags::StringFromEnv("PL_STIRLING_SOURCES", "kP
               "comma separated list of "
               "sources (find them the header files of source connector classes).");
 
+DEFINE_string(stirling_dedicated_thread_sources,
+              gflags::StringFromEnv("PL_STIRLING_DEDICATED_THREAD_SOURCES", ""),
+              "Comma separated list of sources that run on a thread of their own, instead of the "
+              "main Stirling loop, so that their slow iterations (e.g. perf_profiler "
+              "symbolization) don't delay the polling of the other sources.");
+
+DEFINE_bool(stirling_adaptive_periods, gflags::BoolFromEnv("PL_STIRLING_ADAPTIVE_PERIODS", false),
+            "Shorten the sampling and push periods of the sources that measure their load (e.g. "
+            "socket_tracer) when their buffers fill up or lose data, and lengthen them when idle.");
+DEFINE_double(stirling_adaptive_periods_min_ratio, 0.25,
+              "With --stirling_adaptive_periods, the shortest period, as a ratio of the default.");
+DEFINE_double(stirling_adaptive_periods_max_ratio, 4.0,
+              "With --stirling_adaptive_periods, the longest period, as a ratio of the default.");
+
+DEFINE_double(stirling_cpu_budget_pct, gflags::DoubleFromEnv("PL_STIRLING_CPU_BUDGET_PCT", 0),
+              "The CPU that Stirling's sources may use, in percent of the node's total CPU. "
+              "While over budget, the sources degrade step by step: sample connections, drop "
+              "bodies, disable low priority protocols, and slow down the profiler. 0 disables it.");
+
+DEFINE_bool(stirling_event_driven_wakeup,
+            gflags::BoolFromEnv("PL_STIRLING_EVENT_DRIVEN_WAKEUP", false),
+            "Instead of sleeping until their next sampling period, sources on dedicated threads "
+            "(see --stirling_dedicated_thread_sources) block on their perf/ring buffers and "
+            "transfer data as soon as it arrives.");
+
 namespace px {
 namespace stirling {
 
@@ -80,6 +115,7 @@ const std::vector<SourceRegistry::RegistryElement> kAllSources = {
     REGISTRY_PAIR(NetworkStatsConnector),      REGISTRY_PAIR(PerfProfileConnector),
     REGISTRY_PAIR(PIDCPUUseBPFTraceConnector), REGISTRY_PAIR(proc_exit_tracer::ProcExitConnector),
     REGISTRY_PAIR(StirlingErrorConnector),     REGISTRY_PAIR(TCPStatsConnector),
+    REGISTRY_PAIR(BPFStatsConnector),
 };
 #undef REGISTRY_PAIR
 
@@ -203,7 +239,16 @@ class StirlingImpl final : public Stirling {
   StatusOr<stirlingpb::Publish> GetTracepointInfo(sole::uuid trace_id) override;
   Status RemoveTracepoint(sole::uuid trace_id) override;
   void GetPublishProto(stirlingpb::Publish* publish_pb) override;
+  Status SetUnusedColumns(std::string_view table_name,
+                          const std::vector<std::string>& column_names) override;
+  void SetMemoryPressure(bool under_pressure) override { memory_pressure_ = under_pressure; }
   void RegisterDataPushCallback(DataPushCallback f) override { data_push_callback_ = f; }
+  void RegisterDataPushSinkFactory(DataPushSinkFactory f) override {
+    data_push_sink_factory_ = f;
+  }
+  void RegisterArrowDataPushSinkFactory(ArrowDataPushSinkFactory f) override {
+    arrow_data_push_sink_factory_ = f;
+  }
   void RegisterAgentMetadataCallback(AgentMetadataCallback f) override {
     DCHECK(f != nullptr);
     agent_metadata_callback_ = f;
@@ -242,6 +287,10 @@ class StirlingImpl final : public Stirling {
   // Main run implementation.
   void RunCore();
 
+  // Runs the data collection of a single source, on a dedicated thread.
+  void RunSourceCore(SourceConnector* source, DataPushCallback push_callback,
+                     DataPushSinkFactory sink_factory, ArrowDataPushSinkFactory arrow_sink_factory);
+
   // Computes the amount of time to sleep based on the next source connector that needs to wakeup.
   std::chrono::milliseconds TimeUntilNextTick(const time_point now);
 
@@ -251,6 +300,22 @@ class StirlingImpl final : public Stirling {
   // Main thread used to spawn off RunThread().
   std::thread run_thread_;
 
+  // Threads of the sources that don't run in the main loop, see RunSourceCore().
+  // The sources on these threads are only accessed by them while running, so they are not
+  // covered by info_class_mgrs_lock_.
+  std::vector<std::thread> source_threads_;
+  absl::flat_hash_set<const SourceConnector*> dedicated_sources_;
+
+  // Serializes the calls to data_push_callback_ and to the sinks of both sink factories
+  // when sources run on multiple threads.
+  std::mutex data_push_lock_;
+
+  // Set while running if --stirling_cpu_budget_pct is set. Shared by the dedicated source threads.
+  std::unique_ptr<CPUBudgetGovernor> cpu_budget_governor_;
+
+  // Set by the agent, see SetMemoryPressure(). Passed on to the sources by RunSourceIter().
+  std::atomic<bool> memory_pressure_ = false;
+
   std::atomic<bool> run_enable_ = false;
   std::atomic<bool> running_ = false;
   std::vector<std::unique_ptr<SourceConnector>> sources_ ABSL_GUARDED_BY(info_class_mgrs_lock_);
@@ -270,6 +335,10 @@ class StirlingImpl final : public Stirling {
    */
   DataPushCallback data_push_callback_ = nullptr;
 
+  // Optional. Resolves the sinks that skip the lookups of data_push_callback_, see PushData().
+  DataPushSinkFactory data_push_sink_factory_ = nullptr;
+  ArrowDataPushSinkFactory arrow_data_push_sink_factory_ = nullptr;
+
   AgentMetadataCallback agent_metadata_callback_ = nullptr;
   AgentMetadataType agent_metadata_;
 
@@ -507,8 +576,17 @@ StatusOr<std::unique_ptr<SourceConnector>> CreateDynamicSourceConnector(
     return error::Internal("Nothing defined in the input tracepoint_deployment.");
   }
 
+  std::string source_name = absl::StrCat(kDynTraceSourcePrefix, trace_id.str());
+
+  // Tracepoints deployed together on the same binary share one BPF program and connector,
+  // with one table per tracepoint output.
   if (tracepoint_deployment->tracepoints_size() > 1) {
-    return error::Internal("Only one Tracepoint is currently supported.");
+    for (const auto& tracepoint : tracepoint_deployment->tracepoints()) {
+      if (tracepoint.has_bpftrace()) {
+        return error::Internal("bpftrace is only supported for a single Tracepoint.");
+      }
+    }
+    return DynamicTraceConnector::Create(source_name, tracepoint_deployment);
   }
 
   auto tracepoint = tracepoint_deployment->tracepoints(0);
@@ -517,8 +595,6 @@ StatusOr<std::unique_ptr<SourceConnector>> CreateDynamicSourceConnector(
     return error::Internal("Cannot have both PXL program and bpftrace.");
   }
 
-  std::string source_name = absl::StrCat(kDynTraceSourcePrefix, trace_id.str());
-
   if (tracepoint.has_bpftrace()) {
     std::string* script = tracepoint.mutable_bpftrace()->mutable_program();
 
@@ -549,14 +625,17 @@ void StirlingImpl::DeployDynamicTraceConnector(
   LOG(INFO) << absl::Substitute("DynamicTraceConnector [$0] created in $1 ms.", source->name(),
                                 timer.ElapsedTime_us() / 1000.0);
 
-  // Cache table schema name as source will be moved below.
-  std::string output_name(source->table_schemas()[0].name());
+  // Cache table schema names as source will be moved below.
+  std::vector<std::string> output_names;
+  for (const auto& table_schema : source->table_schemas()) {
+    output_names.emplace_back(table_schema.name());
+  }
 
   {
     absl::base_internal::SpinLockHolder lock(&dynamic_trace_status_map_lock_);
     auto it = trace_id_info_map_.find(trace_id);
     if (it != trace_id_info_map_.end()) {
-      trace_id_info_map_[trace_id].output_table = output_name;
+      trace_id_info_map_[trace_id].output_table = absl::StrJoin(output_names, ",");
     }
   }
 
@@ -570,7 +649,9 @@ void StirlingImpl::DeployDynamicTraceConnector(
   stirlingpb::Publish publication;
   {
     absl::base_internal::SpinLockHolder lock(&info_class_mgrs_lock_);
-    PopulatePublishProto(&publication, info_class_mgrs_, output_name);
+    for (const auto& output_name : output_names) {
+      PopulatePublishProto(&publication, info_class_mgrs_, output_name);
+    }
   }
 
   UpdateDynamicTraceStatus(trace_id, publication);
@@ -680,6 +761,31 @@ void StirlingImpl::GetPublishProto(stirlingpb::Publish* publish_pb) {
 }
 
 // Main call to start the data collection.
+Status StirlingImpl::SetUnusedColumns(std::string_view table_name,
+                                      const std::vector<std::string>& column_names) {
+  absl::base_internal::SpinLockHolder lock(&info_class_mgrs_lock_);
+  for (const auto& mgr : info_class_mgrs_) {
+    if (mgr->name() != table_name) {
+      continue;
+    }
+    const auto elements = mgr->Schema().elements();
+    std::vector<size_t> unused_columns;
+    for (const auto& column_name : column_names) {
+      size_t i = 0;
+      while (i < elements.size() && elements[i].name() != column_name) {
+        ++i;
+      }
+      if (i == elements.size()) {
+        return error::NotFound("Column $0 not found in table $1.", column_name, table_name);
+      }
+      unused_columns.push_back(i);
+    }
+    mgr->data_table()->SetUnusedColumns(unused_columns);
+    return Status::OK();
+  }
+  return error::NotFound("Table $0 not found.", table_name);
+}
+
 Status StirlingImpl::RunAsThread() {
   if (data_push_callback_ == nullptr) {
     return error::Internal("No callback function is registered in Stirling. Refusing to run.");
@@ -732,16 +838,23 @@ void StirlingImpl::Run() {
   RunCore();
 }
 
+namespace {
+
+// Worst case, wake-up every so often.
+// This is important if there are no subscribed info classes, to avoid sleeping eternally.
+constexpr std::chrono::milliseconds kMaxSleepDuration{1000};
+
+}  // namespace
+
 std::chrono::milliseconds StirlingImpl::TimeUntilNextTick(const time_point now)
     ABSL_SHARED_LOCKS_REQUIRED(info_class_mgrs_lock_) {
   // The amount to sleep depends on when the earliest Source needs to be sampled again.
   // Do this to avoid burning CPU cycles unnecessarily
-
-  // Worst case, wake-up every so often.
-  // This is important if there are no subscribed info classes, to avoid sleeping eternally.
-  constexpr std::chrono::milliseconds kMaxSleepDuration{1000};
   auto wakeup_time = now + kMaxSleepDuration;
   for (const auto& source : sources_) {
+    if (dedicated_sources_.contains(source.get())) {
+      continue;
+    }
     wakeup_time = std::min(wakeup_time, source->sampling_freq_mgr().next());
     wakeup_time = std::min(wakeup_time, source->push_freq_mgr().next());
   }
@@ -770,6 +883,80 @@ bool DataExceedsThreshold(const std::vector<DataTable*>& data_tables) {
   return false;
 }
 
+void SetAdaptiveBounds(FrequencyManager* freq_mgr) {
+  const auto period = freq_mgr->period();
+  freq_mgr->SetAdaptiveBounds(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          period * FLAGS_stirling_adaptive_periods_min_ratio),
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          period * FLAGS_stirling_adaptive_periods_max_ratio));
+}
+
+std::chrono::nanoseconds ThreadCPUTime() {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return std::chrono::seconds{ts.tv_sec} + std::chrono::nanoseconds{ts.tv_nsec};
+}
+
+// Runs TransferData() and PushData() on the source, if they are due within the run window,
+// or if the source was woken up by new data (data_available).
+// Both are normally a significant amount of work, so "time now" is updated after each of them.
+// The CPU time spent is accounted to the governor, if any, whose level is passed to the source.
+// So is whether the process is under memory pressure.
+void RunSourceIter(SourceConnector* source, ConnectorContext* ctx,
+                   const DataPushCallback& push_callback, const DataPushSinkFactory& sink_factory,
+                   const ArrowDataPushSinkFactory& arrow_sink_factory,
+                   const std::chrono::steady_clock::time_point now_plus_run_window,
+                   std::chrono::steady_clock::time_point* now, RunCoreStats* stats,
+                   CPUBudgetGovernor* governor, bool memory_pressure,
+                   bool data_available = false) {
+  auto account_cpu_time = [&](std::chrono::nanoseconds cpu_time) {
+    stats->AddSourceCPUTime(source->name(), cpu_time);
+    if (governor != nullptr) {
+      governor->AddCPUTime(cpu_time);
+    }
+  };
+
+  if (governor != nullptr && source->degradation_level() != governor->level()) {
+    source->SetDegradationLevel(governor->level());
+  }
+  if (source->memory_pressure() != memory_pressure) {
+    source->SetMemoryPressure(memory_pressure);
+  }
+
+  // Phase 1: Probe each source for its data.
+  if (data_available || source->sampling_freq_mgr().Expired(now_plus_run_window)) {
+    const auto cpu_start = ThreadCPUTime();
+    {
+      PX_PERF_PROBE_SCOPE("stirling", "transfer_data");
+      source->TransferData(ctx);
+    }
+    account_cpu_time(ThreadCPUTime() - cpu_start);
+
+    if (FLAGS_stirling_adaptive_periods && source->transfer_load() >= 0) {
+      source->sampling_freq_mgr().UpdateLoad(source->transfer_load());
+      source->push_freq_mgr().UpdateLoad(source->transfer_load());
+      stats->RecordAdaptivePeriods(source->name(), source->sampling_freq_mgr().period(),
+                                   source->push_freq_mgr().period());
+    }
+
+    *now = std::chrono::steady_clock::now();
+    source->sampling_freq_mgr().Reset(*now);
+    stats->IncrementTransferDataCount();
+  }
+  // Phase 2: Push Data upstream.
+  if (source->push_freq_mgr().Expired(now_plus_run_window) ||
+      DataExceedsThreshold(source->dirty_tables())) {
+    const auto cpu_start = ThreadCPUTime();
+    source->PushData(push_callback, sink_factory, arrow_sink_factory);
+    account_cpu_time(ThreadCPUTime() - cpu_start);
+
+    *now = std::chrono::steady_clock::now();
+    source->push_freq_mgr().Reset(*now);
+    stats->IncrementPushDataCount();
+  }
+}
+
 }  // namespace
 
 // Main Data Collector loop.
@@ -784,10 +971,83 @@ void StirlingImpl::RunCore() {
     std::unique_ptr<ConnectorContext> initial_context = GetContext();
     for (const auto& s : sources_) {
       s->InitContext(initial_context.get());
+      if (FLAGS_stirling_adaptive_periods) {
+        SetAdaptiveBounds(&s->sampling_freq_mgr());
+        SetAdaptiveBounds(&s->push_freq_mgr());
+      }
     }
   }
   // TODO(oazizi): We need to call InitContext on dynamic sources too. Fix.
 
+  if (FLAGS_stirling_cpu_budget_pct > 0) {
+    constexpr auto kCPUBudgetWindow = std::chrono::seconds{10};
+    cpu_budget_governor_ = std::make_unique<CPUBudgetGovernor>(
+        FLAGS_stirling_cpu_budget_pct / 100, get_nprocs_conf(), kCPUBudgetWindow);
+  }
+
+  // The table store isn't safe to append to from multiple threads, so the pushes are serialized
+  // once some sources run on their own threads.
+  DataPushCallback push_callback = data_push_callback_;
+  DataPushSinkFactory sink_factory = data_push_sink_factory_;
+  ArrowDataPushSinkFactory arrow_sink_factory = arrow_data_push_sink_factory_;
+  if (!FLAGS_stirling_dedicated_thread_sources.empty()) {
+    push_callback = [this](uint32_t table_id, types::TabletID tablet_id,
+                           std::unique_ptr<types::ColumnWrapperRecordBatch> record_batch) {
+      std::lock_guard<std::mutex> lock(data_push_lock_);
+      return data_push_callback_(table_id, std::move(tablet_id), std::move(record_batch));
+    };
+    if (data_push_sink_factory_ != nullptr) {
+      sink_factory = [this](uint32_t table_id) -> DataPushSink {
+        DataPushSink sink;
+        {
+          std::lock_guard<std::mutex> lock(data_push_lock_);
+          sink = data_push_sink_factory_(table_id);
+        }
+        if (sink == nullptr) {
+          return nullptr;
+        }
+        return [this, sink = std::move(sink)](
+                   std::unique_ptr<types::ColumnWrapperRecordBatch> record_batch) {
+          std::lock_guard<std::mutex> lock(data_push_lock_);
+          return sink(std::move(record_batch));
+        };
+      };
+    }
+    if (arrow_data_push_sink_factory_ != nullptr) {
+      arrow_sink_factory = [this](uint32_t table_id) -> ArrowDataPushSink {
+        ArrowDataPushSink sink;
+        {
+          std::lock_guard<std::mutex> lock(data_push_lock_);
+          sink = arrow_data_push_sink_factory_(table_id);
+        }
+        if (sink == nullptr) {
+          return nullptr;
+        }
+        return [this, sink = std::move(sink)](ArrowRecordBatch record_batch) {
+          std::lock_guard<std::mutex> lock(data_push_lock_);
+          return sink(std::move(record_batch));
+        };
+      };
+    }
+  }
+
+  // Only the sources that exist at start-up can be dedicated a thread. Dynamic tracing sources
+  // come and go, so they always run in the main loop below.
+  {
+    absl::flat_hash_set<std::string_view> dedicated_names = absl::StrSplit(
+        FLAGS_stirling_dedicated_thread_sources, ',', absl::SkipWhitespace());
+    absl::base_internal::SpinLockHolder lock(&info_class_mgrs_lock_);
+    for (const auto& source : sources_) {
+      if (!dedicated_names.contains(source->name())) {
+        continue;
+      }
+      LOG(INFO) << absl::Substitute("Running source $0 on a dedicated thread.", source->name());
+      dedicated_sources_.insert(source.get());
+      source_threads_.emplace_back(&StirlingImpl::RunSourceCore, this, source.get(),
+                                   push_callback, sink_factory, arrow_sink_factory);
+    }
+  }
+
   // Indicates completion of initialization, and start of data collection.
   LOG(INFO) << "Stirling is running.";
 
@@ -827,31 +1087,22 @@ void StirlingImpl::RunCore() {
 
       // Run through every SourceConnector and InfoClassManager being managed.
       for (auto& source : sources_) {
-        // Phase 1: Probe each source for its data.
-        if (source->sampling_freq_mgr().Expired(now_plus_run_window)) {
-          source->TransferData(ctx.get());
-
-          // TransferData() is normally a significant amount of work: update "time now".
-          now = std::chrono::steady_clock::now();
-          source->sampling_freq_mgr().Reset(now);
-          run_core_stats_.IncrementTransferDataCount();
-        }
-        // Phase 2: Push Data upstream.
-        if (source->push_freq_mgr().Expired(now_plus_run_window) ||
-            DataExceedsThreshold(source->data_tables())) {
-          source->PushData(data_push_callback_);
-
-          // PushData() is normally a significant amount of work: update "time now".
-          now = std::chrono::steady_clock::now();
-          source->push_freq_mgr().Reset(now);
-          run_core_stats_.IncrementPushDataCount();
+        if (dedicated_sources_.contains(source.get())) {
+          continue;
         }
+        RunSourceIter(source.get(), ctx.get(), push_callback, sink_factory, arrow_sink_factory,
+                      now_plus_run_window, &now, &run_core_stats_, cpu_budget_governor_.get(),
+                      memory_pressure_);
       }
 
       // Figure the time remaining until the next required data sample or push data.
       time_until_next_tick = TimeUntilNextTick(now);
     }
 
+    if (cpu_budget_governor_ != nullptr) {
+      cpu_budget_governor_->Update(now);
+    }
+
     // Sleep, only if time_until_next_tick exceeds the "run window," i.e. if that time
     // is long enough that Stirling should go to sleep. Otherwise, don't sleep and loop back
     // through the sources, with the expectation that one of the sources triggers a call to
@@ -870,9 +1121,67 @@ void StirlingImpl::RunCore() {
       run_core_stats_.EndIter(std::chrono::milliseconds::zero());
     }
   }
+
+  for (auto& thread : source_threads_) {
+    thread.join();
+  }
+  source_threads_.clear();
+  dedicated_sources_.clear();
+  cpu_budget_governor_.reset();
   running_ = false;
 }
 
+// Same as the main loop of RunCore(), but for a single source.
+void StirlingImpl::RunSourceCore(SourceConnector* source, DataPushCallback push_callback,
+                                 DataPushSinkFactory sink_factory,
+                                 ArrowDataPushSinkFactory arrow_sink_factory) {
+  RunCoreStats stats(source->name());
+
+  auto now = std::chrono::steady_clock::now();
+  constexpr auto kRunWindow = std::chrono::milliseconds{1};
+
+  FrequencyManager ctx_freq_mgr;
+  ctx_freq_mgr.set_period(std::chrono::milliseconds{200});
+  std::unique_ptr<ConnectorContext> ctx = GetContext();
+
+  // Set when the source was woken up by new data, rather than by its timers.
+  bool data_available = false;
+
+  while (run_enable_) {
+    const auto now_plus_run_window = now + kRunWindow;
+
+    if (ctx_freq_mgr.Expired(now_plus_run_window)) {
+      ctx = GetContext();
+      now = std::chrono::steady_clock::now();
+      ctx_freq_mgr.Reset(now);
+    }
+
+    RunSourceIter(source, ctx.get(), push_callback, sink_factory, arrow_sink_factory,
+                  now_plus_run_window, &now, &stats, cpu_budget_governor_.get(), memory_pressure_,
+                  data_available);
+
+    auto wakeup_time = std::min({now + kMaxSleepDuration, source->sampling_freq_mgr().next(),
+                                 source->push_freq_mgr().next()});
+    auto time_until_next_tick =
+        std::chrono::duration_cast<std::chrono::milliseconds>(wakeup_time - now);
+    data_available = false;
+    if (time_until_next_tick >= kRunWindow) {
+      if (FLAGS_stirling_event_driven_wakeup) {
+        data_available = source->WaitForData(time_until_next_tick);
+        const auto wakeup_now = std::chrono::steady_clock::now();
+        stats.EndIter(std::chrono::duration_cast<std::chrono::milliseconds>(wakeup_now - now));
+        now = wakeup_now;
+      } else {
+        std::this_thread::sleep_for(time_until_next_tick);
+        stats.EndIter(time_until_next_tick);
+        now = std::chrono::steady_clock::now();
+      }
+    } else {
+      stats.EndIter(std::chrono::milliseconds::zero());
+    }
+  }
+}
+
 bool StirlingImpl::IsRunning() const { return running_; }
 
 Status StirlingImpl::WaitUntilRunning(std::chrono::milliseconds timeout) const {
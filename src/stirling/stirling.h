@@ -138,6 +138,22 @@ class Stirling : public NotCopyable {
    */
   virtual void GetPublishProto(stirlingpb::Publish* publish_pb) = 0;
 
+  /**
+   * Tell Stirling which columns of a table are not read by any consumer, so that it can skip
+   * collecting them. Unused string columns are stored as empty strings, the schema itself does
+   * not change. Each call replaces the unused columns previously set for the table.
+   *
+   * @return error if the table or one of the columns doesn't exist.
+   */
+  virtual Status SetUnusedColumns(std::string_view table_name,
+                                  const std::vector<std::string>& column_names) = 0;
+
+  /**
+   * Tells Stirling whether the process is short of memory, so that its sources retain less data.
+   * Thread-safe, the sources pick it up on their next iteration.
+   */
+  virtual void SetMemoryPressure(bool under_pressure) = 0;
+
   /**
    * Register call-back from Agent. Used to periodically send data.
    *
@@ -147,6 +163,20 @@ class Stirling : public NotCopyable {
    */
   virtual void RegisterDataPushCallback(DataPushCallback f) = 0;
 
+  /**
+   * Register a factory of per-table sinks from Agent. The sink of a table is resolved on its first
+   * push after the table exists in the agent, and then used instead of the DataPushCallback for
+   * the table's untabletized data.
+   */
+  virtual void RegisterDataPushSinkFactory(DataPushSinkFactory f) = 0;
+
+  /**
+   * Like RegisterDataPushSinkFactory(), for the tables whose records are consumed as Arrow arrays
+   * (see --stirling_data_table_arrow_buffers). Without it, such records are converted to
+   * column wrappers and pushed like the others.
+   */
+  virtual void RegisterArrowDataPushSinkFactory(ArrowDataPushSinkFactory f) = 0;
+
   /**
    * Register a callback from the agent to fetch the latest metadata state.
    * This state is returned is constant and valid for the duration of the shared_ptr
@@ -41,7 +41,13 @@ class MockStirling : public Stirling {
   MOCK_METHOD(StatusOr<stirlingpb::Publish>, GetTracepointInfo, (sole::uuid trace_id), (override));
   MOCK_METHOD(Status, RemoveTracepoint, (sole::uuid trace_id), (override));
   MOCK_METHOD(void, GetPublishProto, (stirlingpb::Publish * publish_pb), (override));
+  MOCK_METHOD(Status, SetUnusedColumns,
+              (std::string_view table_name, const std::vector<std::string>& column_names),
+              (override));
+  MOCK_METHOD(void, SetMemoryPressure, (bool under_pressure), (override));
   MOCK_METHOD(void, RegisterDataPushCallback, (DataPushCallback f), (override));
+  MOCK_METHOD(void, RegisterDataPushSinkFactory, (DataPushSinkFactory f), (override));
+  MOCK_METHOD(void, RegisterArrowDataPushSinkFactory, (ArrowDataPushSinkFactory f), (override));
   MOCK_METHOD(void, RegisterAgentMetadataCallback, (AgentMetadataCallback f), (override));
   MOCK_METHOD(void, Run, (), (override));
   MOCK_METHOD(Status, RunAsThread, (), (override));
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <string_view>
+#include <type_traits>
 
 #include "src/common/base/base.h"
 
@@ -41,12 +42,24 @@ class BinaryDecoder {
   std::string_view Buf() const { return buf_; }
   void SetBuf(std::string_view buf) { buf_ = buf; }
 
+  // Whether at least num_bytes remain. Parsers can check the size of a fixed layout once with
+  // this, and then read its fields with the *Unchecked functions, which skip the bounds check and
+  // the StatusOr of their checked counterparts.
+  bool HasBytes(size_t num_bytes) const { return buf_.size() >= num_bytes; }
+
   template <typename TCharType = char>
   StatusOr<TCharType> ExtractChar() {
     static_assert(sizeof(TCharType) == 1);
     if (buf_.size() < sizeof(TCharType)) {
       return error::ResourceUnavailable("Insufficient number of bytes.");
     }
+    return ExtractCharUnchecked<TCharType>();
+  }
+
+  template <typename TCharType = char>
+  TCharType ExtractCharUnchecked() {
+    static_assert(sizeof(TCharType) == 1);
+    DCHECK(!buf_.empty());
     TCharType res = buf_.front();
     buf_.remove_prefix(1);
     return res;
@@ -57,6 +70,12 @@ class BinaryDecoder {
     if (buf_.size() < sizeof(TIntType)) {
       return error::ResourceUnavailable("Insufficient number of bytes.");
     }
+    return ExtractBEIntUnchecked<TIntType>();
+  }
+
+  template <typename TIntType>
+  TIntType ExtractBEIntUnchecked() {
+    DCHECK_GE(buf_.size(), sizeof(TIntType));
     TIntType val = ::px::utils::BEndianBytesToInt<TIntType>(buf_);
     buf_.remove_prefix(sizeof(TIntType));
     return val;
@@ -67,15 +86,54 @@ class BinaryDecoder {
     if (buf_.size() < sizeof(TIntType)) {
       return error::ResourceUnavailable("Insufficient number of bytes.");
     }
+    return ExtractLEIntUnchecked<TIntType>();
+  }
+
+  template <typename TIntType>
+  TIntType ExtractLEIntUnchecked() {
+    DCHECK_GE(buf_.size(), sizeof(TIntType));
     TIntType val = ::px::utils::LEndianBytesToInt<TIntType>(buf_);
     buf_.remove_prefix(sizeof(TIntType));
     return val;
   }
 
+  // Extract num consecutive big-endian ints into out, with a single bounds check.
+  // Nothing is consumed if the buffer holds fewer than num ints.
+  template <typename TIntType>
+  Status ExtractBEInts(size_t num, TIntType* out) {
+    if (buf_.size() / sizeof(TIntType) < num) {
+      return error::ResourceUnavailable("Insufficient number of bytes.");
+    }
+    ::px::utils::BEndianBytesToIntArray<TIntType>(buf_.data(), num, out);
+    buf_.remove_prefix(num * sizeof(TIntType));
+    return Status::OK();
+  }
+
+  // Little-endian version of ExtractBEInts.
+  template <typename TIntType>
+  Status ExtractLEInts(size_t num, TIntType* out) {
+    if (buf_.size() / sizeof(TIntType) < num) {
+      return error::ResourceUnavailable("Insufficient number of bytes.");
+    }
+    ::px::utils::LEndianBytesToIntArray<TIntType>(buf_.data(), num, out);
+    buf_.remove_prefix(num * sizeof(TIntType));
+    return Status::OK();
+  }
+
   // Extract UVarInt encoded value and return result as uint64_t. The details of this encoding's
   // specification can be see in the following link:
   // https://cs.opensource.google/go/go/+/refs/tags/go1.20.5:src/encoding/binary/varint.go;l=7-25
   StatusOr<uint64_t> ExtractUVarInt() {
+    if (buf_.size() >= kMaxVarintLen64) {
+      uint64_t x = 0;
+      size_t len = DecodeUVarIntUnchecked(buf_.data(), &x);
+      if (len == 0) {
+        return error::ResourceUnavailable("Insufficient number of bytes.");
+      }
+      buf_.remove_prefix(len);
+      return x;
+    }
+
     uint64_t x = 0;
     uint bits = 0;
     int i = 0;
@@ -101,6 +159,23 @@ class BinaryDecoder {
     return 0;
   }
 
+  // Extract num consecutive UVarInts into out. Varints that are far enough from the end of the
+  // buffer are decoded without per byte bounds checks. Unlike ExtractUVarInt, a varint truncated by
+  // the end of the buffer is an error, and nothing is consumed on error.
+  Status ExtractUVarInts(size_t num, uint64_t* out) {
+    std::string_view buf = buf_;
+    for (size_t i = 0; i < num; ++i) {
+      size_t len = buf.size() >= kMaxVarintLen64 ? DecodeUVarIntUnchecked(buf.data(), &out[i])
+                                                 : DecodeUVarInt(buf, &out[i]);
+      if (len == 0) {
+        return error::ResourceUnavailable("Insufficient number of bytes.");
+      }
+      buf.remove_prefix(len);
+    }
+    buf_ = buf;
+    return Status::OK();
+  }
+
   template <typename TCharType = char>
   StatusOr<std::basic_string_view<TCharType>> ExtractString(size_t len) {
     static_assert(sizeof(TCharType) == 1);
@@ -153,8 +228,80 @@ class BinaryDecoder {
     return Status::OK();
   }
 
+  // Extract a string preceded by its length, encoded as a big-endian TLenType. Both are bounds
+  // checked at once, and nothing is consumed unless the whole string is present.
+  template <typename TLenType, typename TCharType = char>
+  StatusOr<std::basic_string_view<TCharType>> ExtractBELengthPrefixedString() {
+    static_assert(sizeof(TCharType) == 1);
+    if (buf_.size() < sizeof(TLenType)) {
+      return error::ResourceUnavailable("Insufficient number of bytes.");
+    }
+    TLenType len = ::px::utils::BEndianBytesToInt<TLenType>(buf_);
+    if constexpr (std::is_signed_v<TLenType>) {
+      if (len < 0) {
+        return error::Internal("Negative length prefix $0.", static_cast<int64_t>(len));
+      }
+    }
+    if (buf_.size() - sizeof(TLenType) < static_cast<uint64_t>(len)) {
+      return error::ResourceUnavailable("Insufficient number of bytes.");
+    }
+    auto tbuf = CreateStringView<TCharType>(buf_).substr(sizeof(TLenType), len);
+    buf_.remove_prefix(sizeof(TLenType) + len);
+    return tbuf;
+  }
+
+  // Skip over a length prefixed field, see ExtractBELengthPrefixedString.
+  template <typename TLenType>
+  Status ExtractBELengthPrefixedBufIgnore() {
+    return ExtractBELengthPrefixedString<TLenType>().status();
+  }
+
  protected:
   std::string_view buf_;
+
+ private:
+  // Decodes the UVarInt at the front of buf, and returns its length, or 0 if it is truncated or
+  // overflows 64 bits.
+  static size_t DecodeUVarInt(std::string_view buf, uint64_t* out) {
+    uint64_t x = 0;
+    uint bits = 0;
+    for (size_t i = 0; i < buf.size() && i < kMaxVarintLen64; ++i) {
+      uint8_t b = buf[i];
+      if (b < 0x80) {
+        if (i == kMaxVarintLen64 - 1 && b > 1) {
+          return 0;
+        }
+        *out = x | uint64_t(b) << bits;
+        return i + 1;
+      }
+      x |= uint64_t(b & 0x7f) << bits;
+      bits += 7;
+    }
+    return 0;
+  }
+
+  // Same as DecodeUVarInt, but p must have at least kMaxVarintLen64 readable bytes, which makes the
+  // loop bound a constant that the compiler can unroll.
+  static size_t DecodeUVarIntUnchecked(const char* p, uint64_t* out) {
+    uint8_t b = p[0];
+    if (b < 0x80) {
+      *out = b;
+      return 1;
+    }
+    uint64_t x = b & 0x7f;
+    for (int i = 1; i < kMaxVarintLen64; ++i) {
+      b = p[i];
+      if (b < 0x80) {
+        if (i == kMaxVarintLen64 - 1 && b > 1) {
+          return 0;
+        }
+        *out = x | uint64_t(b) << (7 * i);
+        return i + 1;
+      }
+      x |= uint64_t(b & 0x7f) << (7 * i);
+    }
+    return 0;
+  }
 };
 
 }  // namespace stirling
@@ -106,6 +106,90 @@ TEST(BinaryDecoderTest, ExtractUVarIntOverflow) {
   }
 }
 
+TEST(BinaryDecoderTest, ExtractUnchecked) {
+  std::string_view data("\xff\x01\x02\x03\x04\x05\x06\x07");
+  BinaryDecoder bin_decoder(data);
+
+  ASSERT_TRUE(bin_decoder.HasBytes(8));
+  EXPECT_FALSE(bin_decoder.HasBytes(9));
+  EXPECT_EQ(bin_decoder.ExtractCharUnchecked<uint8_t>(), 255);
+  EXPECT_EQ(bin_decoder.ExtractBEIntUnchecked<int16_t>(), 0x0102);
+  EXPECT_EQ(bin_decoder.ExtractLEIntUnchecked<int24_t>(), 0x050403);
+  EXPECT_EQ(bin_decoder.ExtractBEIntUnchecked<uint16_t>(), 0x0607);
+  EXPECT_EQ(0, bin_decoder.BufSize());
+}
+
+TEST(BinaryDecoderTest, ExtractInts) {
+  std::string_view data("\x00\x01\x00\x02\xff\xfe\x01\x02\x03\x04\x05\x06\x07\x08", 14);
+  BinaryDecoder bin_decoder(data);
+
+  int16_t be_vals[3];
+  ASSERT_OK(bin_decoder.ExtractBEInts<int16_t>(3, be_vals));
+  EXPECT_THAT(be_vals, ::testing::ElementsAre(1, 2, -2));
+
+  uint32_t le_vals[2];
+  ASSERT_OK(bin_decoder.ExtractLEInts<uint32_t>(2, le_vals));
+  EXPECT_THAT(le_vals, ::testing::ElementsAre(0x04030201, 0x08070605));
+  EXPECT_EQ(0, bin_decoder.BufSize());
+
+  // Nothing is consumed when the buffer is too short.
+  BinaryDecoder short_decoder(data);
+  int64_t vals[2];
+  EXPECT_NOT_OK(short_decoder.ExtractBEInts<int64_t>(2, vals));
+  EXPECT_EQ(data.size(), short_decoder.BufSize());
+  ASSERT_OK(short_decoder.ExtractBEInts<int64_t>(0, vals));
+  EXPECT_EQ(data.size(), short_decoder.BufSize());
+}
+
+TEST(BinaryDecoderTest, ExtractUVarInts) {
+  // Ends with a varint that is too close to the end of the buffer for the unchecked path.
+  std::vector<uint8_t> data = {0x01, 0xff, 0x01, 0x80, 0x80, 0x02, 0x7f, 0xd7, 0xff, 0xff, 0xff,
+                               0xff, 0xff, 0xff, 0xff, 0xff, 0x01, 0x80, 0x01};
+  std::string_view s(reinterpret_cast<char*>(data.data()), data.size());
+
+  BinaryDecoder bin_decoder(s);
+  uint64_t vals[6];
+  ASSERT_OK(bin_decoder.ExtractUVarInts(6, vals));
+  EXPECT_THAT(vals, ::testing::ElementsAre(1, 255, 32768, 127, 18446744073709551575UL, 128));
+  EXPECT_EQ(0, bin_decoder.BufSize());
+
+  // The last varint is truncated, so nothing is consumed.
+  BinaryDecoder truncated_decoder(s.substr(0, s.size() - 1));
+  EXPECT_NOT_OK(truncated_decoder.ExtractUVarInts(6, vals));
+  EXPECT_EQ(s.size() - 1, truncated_decoder.BufSize());
+
+  std::vector<uint8_t> overflow = {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x02};
+  BinaryDecoder overflow_decoder(
+      std::string_view(reinterpret_cast<char*>(overflow.data()), overflow.size()));
+  EXPECT_NOT_OK(overflow_decoder.ExtractUVarInts(1, vals));
+}
+
+TEST(BinaryDecoderTest, ExtractBELengthPrefixedString) {
+  std::string_view data("\x00\x03"
+                        "abc"
+                        "\x00"
+                        "\x01"
+                        "x"
+                        "\x00\x05"
+                        "ab",
+                        12);
+  BinaryDecoder bin_decoder(data);
+
+  ASSERT_OK_AND_EQ(bin_decoder.ExtractBELengthPrefixedString<int16_t>(), "abc");
+  ASSERT_OK_AND_EQ(bin_decoder.ExtractBELengthPrefixedString<uint8_t>(), "");
+  ASSERT_OK(bin_decoder.ExtractBELengthPrefixedBufIgnore<uint8_t>());
+  EXPECT_EQ(4, bin_decoder.BufSize());
+
+  // The length prefix says 5 bytes, but only 2 remain.
+  EXPECT_NOT_OK(bin_decoder.ExtractBELengthPrefixedString<int16_t>());
+  EXPECT_EQ(4, bin_decoder.BufSize());
+
+  BinaryDecoder negative_decoder(std::string_view("\xff\xff"
+                                                  "ab"));
+  EXPECT_NOT_OK(negative_decoder.ExtractBELengthPrefixedString<int16_t>());
+  EXPECT_EQ(4, negative_decoder.BufSize());
+}
+
 TEST(BinaryDecoderTest, ExtractString) {
   std::string_view data("abc123");
   BinaryDecoder bin_decoder(data);
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/stirling/utils/kernel_cache.h"
+
+#include <sys/utsname.h>
+
+#include <absl/strings/ascii.h>
+
+#include "src/common/base/file.h"
+#include "src/common/fs/fs_wrapper.h"
+
+DEFINE_string(stirling_kernel_cache_dir, gflags::StringFromEnv("PL_STIRLING_KERNEL_CACHE_DIR", ""),
+              "Directory where Stirling keeps the artifacts that depend only on the kernel, "
+              "e.g. installed Linux headers, across restarts. Should be on a host path. "
+              "Empty disables the cache.");
+
+namespace px {
+namespace stirling {
+namespace utils {
+
+std::string KernelCacheKey(std::string_view release, std::string_view version) {
+  std::string key = absl::StrCat(release, "_", version);
+  for (char& c : key) {
+    if (!absl::ascii_isalnum(c) && c != '.' && c != '-') {
+      c = '_';
+    }
+  }
+  return key;
+}
+
+StatusOr<std::filesystem::path> KernelCacheDir() {
+  if (FLAGS_stirling_kernel_cache_dir.empty()) {
+    return error::NotFound("Kernel cache is disabled.");
+  }
+
+  struct utsname buffer;
+  if (uname(&buffer) != 0) {
+    return error::Internal("Could not determine kernel version (uname).");
+  }
+
+  const std::filesystem::path dir = std::filesystem::path(FLAGS_stirling_kernel_cache_dir) /
+                                    KernelCacheKey(buffer.release, buffer.version);
+  PX_RETURN_IF_ERROR(fs::CreateDirectories(dir));
+  return dir;
+}
+
+StatusOr<std::string> ReadKernelCacheFile(std::string_view name) {
+  PX_ASSIGN_OR_RETURN(const std::filesystem::path dir, KernelCacheDir());
+  return ReadFileToString((dir / name).string());
+}
+
+Status WriteKernelCacheFile(std::string_view name, std::string_view contents) {
+  PX_ASSIGN_OR_RETURN(const std::filesystem::path dir, KernelCacheDir());
+  const std::filesystem::path path = dir / name;
+  const std::filesystem::path tmp_path = absl::StrCat(path.string(), ".tmp");
+  PX_RETURN_IF_ERROR(WriteFileFromString(tmp_path.string(), contents));
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path, ec);
+  if (ec) {
+    return error::Internal("Could not rename $0 to $1: $2", tmp_path.string(), path.string(),
+                           ec.message());
+  }
+  return Status::OK();
+}
+
+}  // namespace utils
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#include "src/common/base/base.h"
+
+DECLARE_string(stirling_kernel_cache_dir);
+
+namespace px {
+namespace stirling {
+namespace utils {
+
+/**
+ * Returns the name under which the artifacts of a kernel build are cached.
+ * It combines the release (uname -r) and the build version (uname -v), since distributions
+ * rebuild kernels with different configs under the same release.
+ */
+std::string KernelCacheKey(std::string_view release, std::string_view version);
+
+/**
+ * Returns a directory for the artifacts that only depend on the running kernel build,
+ * e.g. installed Linux headers or task_struct offsets, so that they outlive the process.
+ * The directory is created under --stirling_kernel_cache_dir if needed.
+ *
+ * @return error if the cache is disabled (empty flag) or the directory can't be created.
+ */
+StatusOr<std::filesystem::path> KernelCacheDir();
+
+/**
+ * Reads a file from the KernelCacheDir().
+ */
+StatusOr<std::string> ReadKernelCacheFile(std::string_view name);
+
+/**
+ * Writes a file into the KernelCacheDir(). The file is written under a temporary name first,
+ * so that readers never see a partial file, even if the process dies while writing.
+ */
+Status WriteKernelCacheFile(std::string_view name, std::string_view contents);
+
+}  // namespace utils
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/stirling/utils/kernel_cache.h"
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace utils {
+
+using ::px::testing::TempDir;
+
+TEST(KernelCacheTest, Key) {
+  EXPECT_EQ(KernelCacheKey("5.15.0-1042-gke", "#48-Ubuntu SMP Fri Aug 25 11:24:41 UTC 2023"),
+            "5.15.0-1042-gke__48-Ubuntu_SMP_Fri_Aug_25_11_24_41_UTC_2023");
+  EXPECT_NE(KernelCacheKey("5.15.0", "#1 SMP"), KernelCacheKey("5.15.0", "#2 SMP"));
+}
+
+TEST(KernelCacheTest, DisabledByDefault) {
+  PX_SET_FOR_SCOPE(FLAGS_stirling_kernel_cache_dir, "");
+  EXPECT_NOT_OK(KernelCacheDir());
+  EXPECT_NOT_OK(WriteKernelCacheFile("foo", "bar"));
+  EXPECT_NOT_OK(ReadKernelCacheFile("foo"));
+}
+
+TEST(KernelCacheTest, ReadWrite) {
+  TempDir tmp_dir;
+  PX_SET_FOR_SCOPE(FLAGS_stirling_kernel_cache_dir, tmp_dir.path().string());
+
+  ASSERT_OK_AND_ASSIGN(std::filesystem::path dir, KernelCacheDir());
+  EXPECT_EQ(dir.parent_path(), tmp_dir.path());
+  EXPECT_TRUE(std::filesystem::is_directory(dir));
+
+  EXPECT_NOT_OK(ReadKernelCacheFile("foo"));
+  ASSERT_OK(WriteKernelCacheFile("foo", "bar"));
+  EXPECT_OK_AND_EQ(ReadKernelCacheFile("foo"), "bar");
+  ASSERT_OK(WriteKernelCacheFile("foo", "baz"));
+  EXPECT_OK_AND_EQ(ReadKernelCacheFile("foo"), "baz");
+}
+
+}  // namespace utils
+}  // namespace stirling
+}  // namespace px
@@ -33,6 +33,7 @@
 #include "src/common/system/config.h"
 #include "src/common/system/proc_pid_path.h"
 #include "src/common/zlib/zlib_wrapper.h"
+#include "src/stirling/utils/kernel_cache.h"
 
 #define PX_RETURN_STATUS_OK_IF_OK(__materialized_status, __status_gen) \
   const auto& __materialized_status = __status_gen;                    \
@@ -349,8 +350,33 @@ Status InstallPackagedLinuxHeaders(const std::filesystem::path& lib_modules_dir)
   const std::string version =
       absl::Substitute("$0.$1.$2-pl", packaged_headers.version.version,
                        packaged_headers.version.major_rev, packaged_headers.version.minor_rev);
-  const std::string staging_directory = absl::StrCat("/usr/src/staging/linux-headers-", version);
-  const std::string expected_directory = absl::StrCat("/usr/src/linux-headers-", version);
+  // The directory of the headers inside the tarball.
+  const std::string packaged_directory = absl::StrCat("/usr/src/linux-headers-", version);
+  std::string staging_directory = absl::StrCat("/usr/src/staging/linux-headers-", version);
+  std::string expected_directory = packaged_directory;
+
+  // The headers are patched for the kernel of this host, so they can be reused by the next
+  // instance of this process on the same host, if they are installed in the kernel cache.
+  StatusOr<std::filesystem::path> cache_dir = KernelCacheDir();
+  if (cache_dir.ok()) {
+    staging_directory =
+        (cache_dir.ValueOrDie() / absl::StrCat("staging-linux-headers-", version)).string();
+    expected_directory =
+        (cache_dir.ValueOrDie() / absl::StrCat("linux-headers-", version)).string();
+    // The staged headers are only renamed once complete, so these can be used as-is.
+    if (fs::Exists(expected_directory)) {
+      PX_RETURN_IF_ERROR(fs::CreateSymlinkIfNotExists(expected_directory, lib_modules_build_dir));
+      LOG(INFO) << absl::Substitute("Using cached packaged copy of headers at $0",
+                                    expected_directory);
+      g_packaged_headers_installed = true;
+      return Status::OK();
+    }
+    // Left over by a previous instance that didn't finish the installation.
+    if (fs::Exists(staging_directory)) {
+      PX_RETURN_IF_ERROR(fs::RemoveAll(staging_directory));
+    }
+  }
+
   // Verify that the target directory doesn't already exist.
   // If someone built a tar.gz with an incorrect directory structure, this check wouldn't save us.
   if (fs::Exists(expected_directory)) {
@@ -359,10 +385,9 @@ Status InstallPackagedLinuxHeaders(const std::filesystem::path& lib_modules_dir)
         "$0",
         expected_directory);
   }
-  // Extract the packaged headers to a staging directory, stripping the expected target directory
-  // prefix.
+  // Extract the packaged headers to a staging directory, stripping the packaged directory prefix.
   PX_RETURN_IF_ERROR(
-      ExtractPackagedHeaders(packaged_headers, staging_directory, expected_directory));
+      ExtractPackagedHeaders(packaged_headers, staging_directory, packaged_directory));
   // Modify version.h to the specific kernel version in the staged headers.
   PX_RETURN_IF_ERROR(ModifyKernelVersion(staging_directory, kernel_version.code()));
   // Find valid kernel config and patch the staged headers to match.
@@ -48,6 +48,7 @@ class ObjPool {
    * If recycled, it will be properly initialized.
    */
   std::unique_ptr<T> Pop() {
+    ++num_popped_;
     if (obj_pool_.empty()) {
       auto obj_ptr = std::make_unique<T>();
       VLOG(1) << absl::Substitute("Pool is empty...creating new object [addr=$0].", obj_ptr.get());
@@ -60,6 +61,7 @@ class ObjPool {
     // This avoids a new memory allocation, but does still initialize the object.
     auto obj = std::unique_ptr<T>(new (obj_pool_.back()) T());
     obj_pool_.pop_back();
+    ++num_reused_;
     return obj;
   }
 
@@ -80,9 +82,17 @@ class ObjPool {
     obj_ptr->~T();
   }
 
+  /**
+   * The number of objects returned by Pop(), and how many of them were recycled.
+   */
+  size_t num_popped() const { return num_popped_; }
+  size_t num_reused() const { return num_reused_; }
+
  private:
   size_t capacity_;
   std::vector<T*> obj_pool_;
+  size_t num_popped_ = 0;
+  size_t num_reused_ = 0;
 };
 
 }  // namespace stirling
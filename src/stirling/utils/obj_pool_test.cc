@@ -51,6 +51,9 @@ TEST_F(ObjPoolTest, ObjRecycled) {
   // The object should be initialized fresh.
   EXPECT_EQ(obj->str, "uninitialized");
   EXPECT_EQ(obj->value, -1);
+
+  EXPECT_EQ(obj_pool.num_popped(), 2U);
+  EXPECT_EQ(obj_pool.num_reused(), 1U);
 }
 
 TEST_F(ObjPoolTest, Capacity) {
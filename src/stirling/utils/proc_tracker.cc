@@ -39,5 +39,23 @@ void ProcTracker::Update(absl::flat_hash_set<md::UPID> upids) {
   upids_ = std::move(upids);
 }
 
+void ProcTracker::UpdateFromEvents(const absl::flat_hash_set<md::UPID>& exec_upids,
+                                   const absl::flat_hash_set<md::UPID>& exit_upids) {
+  new_upids_.clear();
+  deleted_upids_.clear();
+  for (const auto& upid : exec_upids) {
+    if (exit_upids.contains(upid)) {
+      continue;
+    }
+    upids_.insert(upid);
+    new_upids_.insert(upid);
+  }
+  for (const auto& upid : exit_upids) {
+    if (upids_.erase(upid) > 0) {
+      deleted_upids_.insert(upid);
+    }
+  }
+}
+
 }  // namespace stirling
 }  // namespace px
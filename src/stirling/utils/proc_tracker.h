@@ -41,6 +41,16 @@ class ProcTracker : NotCopyMoveable {
    */
   void Update(absl::flat_hash_set<md::UPID> upids);
 
+  /**
+   * Updates the internal state from process events, instead of from the full set of upids.
+   * An exec'ed upid is reported as new even if it is already tracked, because exec keeps the PID
+   * and start time, but replaces the binary.
+   * @param exec_upids UPIDs of the processes that exec'ed since the last update.
+   * @param exit_upids UPIDs of the processes that exited since the last update.
+   */
+  void UpdateFromEvents(const absl::flat_hash_set<md::UPID>& exec_upids,
+                        const absl::flat_hash_set<md::UPID>& exit_upids);
+
   /**
    * Returns all current upids, as set by last call to Update().
    */
@@ -61,5 +61,33 @@ TEST_F(ProcTrackerTest, Basic) {
   EXPECT_THAT(proc_tracker_.deleted_upids(), UnorderedElementsAre(kUPID3));
 }
 
+TEST_F(ProcTrackerTest, UpdateFromEvents) {
+  using UPIDSet = absl::flat_hash_set<md::UPID>;
+
+  const md::UPID kUPID1 = md::UPID(0, 1, 111);
+  const md::UPID kUPID2 = md::UPID(0, 2, 222);
+  const md::UPID kUPID3 = md::UPID(0, 3, 333);
+  const md::UPID kUPID4 = md::UPID(0, 4, 444);
+
+  proc_tracker_.Update(UPIDSet{kUPID1, kUPID2});
+
+  proc_tracker_.UpdateFromEvents(UPIDSet{kUPID3}, UPIDSet{kUPID2});
+  EXPECT_THAT(proc_tracker_.upids(), UnorderedElementsAre(kUPID1, kUPID3));
+  EXPECT_THAT(proc_tracker_.new_upids(), UnorderedElementsAre(kUPID3));
+  EXPECT_THAT(proc_tracker_.deleted_upids(), UnorderedElementsAre(kUPID2));
+
+  // An exec'ed process that is already tracked runs a new binary, so it is new again.
+  proc_tracker_.UpdateFromEvents(UPIDSet{kUPID1}, UPIDSet{});
+  EXPECT_THAT(proc_tracker_.upids(), UnorderedElementsAre(kUPID1, kUPID3));
+  EXPECT_THAT(proc_tracker_.new_upids(), UnorderedElementsAre(kUPID1));
+  EXPECT_THAT(proc_tracker_.deleted_upids(), IsEmpty());
+
+  // A process that exec'ed and exited between updates is never reported.
+  proc_tracker_.UpdateFromEvents(UPIDSet{kUPID4}, UPIDSet{kUPID4});
+  EXPECT_THAT(proc_tracker_.upids(), UnorderedElementsAre(kUPID1, kUPID3));
+  EXPECT_THAT(proc_tracker_.new_upids(), IsEmpty());
+  EXPECT_THAT(proc_tracker_.deleted_upids(), IsEmpty());
+}
+
 }  // namespace stirling
 }  // namespace px
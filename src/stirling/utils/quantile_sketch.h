@@ -0,0 +1,107 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <map>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+namespace utils {
+
+/**
+ * A mergeable sketch of a distribution of non-negative values, which answers quantile queries
+ * within a fixed relative error (DDSketch). Values are counted in logarithmically sized buckets,
+ * so memory grows with the log of the range of the values, not with the number of values.
+ */
+class QuantileSketch {
+ public:
+  explicit QuantileSketch(double relative_accuracy = 0.01)
+      : gamma_((1 + relative_accuracy) / (1 - relative_accuracy)), log_gamma_(std::log(gamma_)) {
+    DCHECK_GT(relative_accuracy, 0);
+    DCHECK_LT(relative_accuracy, 1);
+  }
+
+  void Add(double value) {
+    ++count_;
+    if (value <= 0) {
+      ++zero_count_;
+      return;
+    }
+    ++buckets_[static_cast<int>(std::ceil(std::log(value) / log_gamma_))];
+  }
+
+  // Both sketches must have been created with the same relative accuracy.
+  void Merge(const QuantileSketch& other) {
+    DCHECK_EQ(gamma_, other.gamma_);
+    count_ += other.count_;
+    zero_count_ += other.zero_count_;
+    for (const auto& [idx, count] : other.buckets_) {
+      buckets_[idx] += count;
+    }
+  }
+
+  /**
+   * Returns the value at quantile q, in [0, 1], or 0 if the sketch is empty.
+   */
+  double Quantile(double q) const {
+    if (count_ == 0) {
+      return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(q * (count_ - 1));
+    uint64_t seen = zero_count_;
+    if (seen > rank) {
+      return 0;
+    }
+    for (const auto& [idx, count] : buckets_) {
+      seen += count;
+      if (seen > rank) {
+        // The value that minimizes the relative error to anything in (gamma^(i-1), gamma^i].
+        return 2 * std::pow(gamma_, idx) / (gamma_ + 1);
+      }
+    }
+    return 2 * std::pow(gamma_, buckets_.rbegin()->first) / (gamma_ + 1);
+  }
+
+  uint64_t count() const { return count_; }
+  bool empty() const { return count_ == 0; }
+
+  void Clear() {
+    buckets_.clear();
+    zero_count_ = 0;
+    count_ = 0;
+  }
+
+ private:
+  const double gamma_;
+  const double log_gamma_;
+
+  // Bucket i counts the values in (gamma^(i-1), gamma^i].
+  std::map<int, uint64_t> buckets_;
+  uint64_t zero_count_ = 0;
+  uint64_t count_ = 0;
+};
+
+}  // namespace utils
+}  // namespace stirling
+}  // namespace px
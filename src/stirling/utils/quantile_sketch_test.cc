@@ -0,0 +1,76 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/stirling/utils/quantile_sketch.h"
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace utils {
+
+TEST(QuantileSketchTest, EmptySketch) {
+  QuantileSketch sketch;
+  EXPECT_TRUE(sketch.empty());
+  EXPECT_EQ(sketch.Quantile(0.5), 0);
+}
+
+TEST(QuantileSketchTest, QuantilesWithinRelativeAccuracy) {
+  QuantileSketch sketch(0.01);
+  for (int i = 1; i <= 1000; ++i) {
+    sketch.Add(i);
+  }
+
+  EXPECT_EQ(sketch.count(), 1000U);
+  EXPECT_NEAR(sketch.Quantile(0), 1, 0.02);
+  EXPECT_NEAR(sketch.Quantile(0.5), 500, 500 * 0.01);
+  EXPECT_NEAR(sketch.Quantile(0.9), 900, 900 * 0.01);
+  EXPECT_NEAR(sketch.Quantile(0.99), 990, 990 * 0.01);
+  EXPECT_NEAR(sketch.Quantile(1), 1000, 1000 * 0.01);
+}
+
+TEST(QuantileSketchTest, NonPositiveValuesCountAsZero) {
+  QuantileSketch sketch;
+  sketch.Add(0);
+  sketch.Add(-5);
+  sketch.Add(100);
+
+  EXPECT_EQ(sketch.Quantile(0.5), 0);
+  EXPECT_NEAR(sketch.Quantile(1), 100, 1);
+}
+
+TEST(QuantileSketchTest, Merge) {
+  QuantileSketch low;
+  QuantileSketch high;
+  for (int i = 1; i <= 500; ++i) {
+    low.Add(i);
+    high.Add(500 + i);
+  }
+
+  low.Merge(high);
+  EXPECT_EQ(low.count(), 1000U);
+  EXPECT_NEAR(low.Quantile(0.99), 990, 990 * 0.01);
+
+  low.Clear();
+  EXPECT_TRUE(low.empty());
+}
+
+}  // namespace utils
+}  // namespace stirling
+}  // namespace px
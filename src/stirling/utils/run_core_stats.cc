@@ -48,10 +48,10 @@ static constexpr std::array<std::chrono::nanoseconds, 23> kSleepBuckets = {
     std::chrono::nanoseconds{1000000000},
     std::chrono::nanoseconds{10000000000000}};
 
-std::string CreateHeaderString() {
+std::string CreateHeaderString(std::string_view log_prefix) {
   std::stringstream s;
 
-  s << "|main_loop_iters,no_work_iters,useful_iters,push+transfer";
+  s << log_prefix << "main_loop_iters,no_work_iters,useful_iters,push+transfer";
   s << ",transfer,push,min_push+transfer,max_push+transfer";
 
   for (const auto bucket : kSleepBuckets) {
@@ -66,8 +66,9 @@ std::string CreateHeaderString() {
 
 }  // namespace
 
-RunCoreStats::RunCoreStats()
-    : header_string_(CreateHeaderString()),
+RunCoreStats::RunCoreStats(std::string_view name)
+    : log_prefix_(name.empty() ? "|" : absl::StrCat("|", name, "|")),
+      header_string_(CreateHeaderString(log_prefix_)),
       sleep_histo_(kSleepBuckets.size(), 0),
       no_work_histo_(kSleepBuckets.size(), 0) {}
 
@@ -81,14 +82,69 @@ void RunCoreStats::IncrementPushDataCount() {
   ++push_or_transfer_this_iter_;
 }
 
+void RunCoreStats::AddSourceCPUTime(std::string_view source_name,
+                                    std::chrono::nanoseconds cpu_time) {
+  auto iter = source_cpu_time_.find(source_name);
+  if (iter == source_cpu_time_.end()) {
+    iter = source_cpu_time_.emplace(std::string(source_name), std::chrono::nanoseconds{0}).first;
+  }
+  iter->second += cpu_time;
+}
+
+std::chrono::nanoseconds RunCoreStats::SourceCPUTime(std::string_view source_name) const {
+  auto iter = source_cpu_time_.find(source_name);
+  return iter == source_cpu_time_.end() ? std::chrono::nanoseconds{0} : iter->second;
+}
+
+void RunCoreStats::RecordAdaptivePeriods(std::string_view source_name,
+                                         std::chrono::milliseconds sampling_period,
+                                         std::chrono::milliseconds push_period) {
+  auto iter = source_adaptive_periods_.find(source_name);
+  if (iter == source_adaptive_periods_.end()) {
+    source_adaptive_periods_.emplace(std::string(source_name),
+                                     AdaptivePeriods{sampling_period, push_period});
+    return;
+  }
+  AdaptivePeriods& periods = iter->second;
+  if (periods.sampling_period != sampling_period || periods.push_period != push_period) {
+    periods.sampling_period = sampling_period;
+    periods.push_period = push_period;
+    ++periods.num_changes;
+  }
+}
+
+const RunCoreStats::AdaptivePeriods* RunCoreStats::SourceAdaptivePeriods(
+    std::string_view source_name) const {
+  auto iter = source_adaptive_periods_.find(source_name);
+  return iter == source_adaptive_periods_.end() ? nullptr : &iter->second;
+}
+
 void RunCoreStats::LogStats() const {
   std::string s = absl::StrJoin(sleep_histo_, ",");
   absl::StrAppend(&s, ",", absl::StrJoin(no_work_histo_, ","));
 
-  LOG(INFO) << absl::Substitute("|$0,$1,$2,$3,$4,$5,$6,$7,$8", num_main_loop_iters_,
+  LOG(INFO) << absl::Substitute("$0$1,$2,$3,$4,$5,$6,$7,$8,$9", log_prefix_, num_main_loop_iters_,
                                 num_no_work_iters_, (num_main_loop_iters_ - num_no_work_iters_),
                                 (num_transfer_data_ + num_push_data_), num_transfer_data_,
                                 num_push_data_, min_push_or_transfer_, max_push_or_transfer_, s);
+  if (!source_cpu_time_.empty()) {
+    LOG(INFO) << absl::StrCat(
+        log_prefix_, "source_cpu_ms,",
+        absl::StrJoin(source_cpu_time_, ",", [](std::string* out, const auto& entry) {
+          absl::StrAppend(out, entry.first, "=",
+                          std::chrono::duration_cast<std::chrono::milliseconds>(entry.second)
+                              .count());
+        }));
+  }
+  if (!source_adaptive_periods_.empty()) {
+    LOG(INFO) << absl::StrCat(
+        log_prefix_, "adaptive_periods_ms,",
+        absl::StrJoin(source_adaptive_periods_, ",", [](std::string* out, const auto& entry) {
+          absl::StrAppend(out, entry.first, "=", entry.second.sampling_period.count(), "/",
+                          entry.second.push_period.count(), "(changes=",
+                          entry.second.num_changes, ")");
+        }));
+  }
 }
 
 void RunCoreStats::EndIter(const std::chrono::milliseconds sleep_duration) {
@@ -21,8 +21,10 @@
 #include <algorithm>
 #include <chrono>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include <absl/container/btree_map.h>
 #include <absl/strings/str_cat.h>
 #include <absl/strings/str_join.h>
 
@@ -33,15 +35,26 @@ namespace stirling {
 
 // RunCoreStats tracks the work done in each iteration of StirlingImpl::RunCore.
 // It counts the number of PushData() and TransferData() calls.
-// It also keeps a histogram of sleep durations: total, and those sleeps where no work is done.
+// It also keeps a histogram of sleep durations: total, and those sleeps where no work is done,
+// and the CPU time spent by each source in TransferData() and PushData(),
+// and the periods that adaptive sources were last set to.
+// Sources that run on dedicated threads have their own instance, identified by name in the logs.
 class RunCoreStats {
  public:
-  RunCoreStats();
+  explicit RunCoreStats(std::string_view name = "");
 
   // Increment totals and per iteration counts.
   void IncrementTransferDataCount();
   void IncrementPushDataCount();
 
+  // Accounts CPU time that the named source spent in TransferData() or PushData().
+  void AddSourceCPUTime(std::string_view source_name, std::chrono::nanoseconds cpu_time);
+
+  // Records the periods that the named source adapted to, after its load changed.
+  void RecordAdaptivePeriods(std::string_view source_name,
+                             std::chrono::milliseconds sampling_period,
+                             std::chrono::milliseconds push_period);
+
   // Logs the stats.
   void LogStats() const;
 
@@ -56,6 +69,16 @@ class RunCoreStats {
   uint64_t max_push_or_transfer() const { return max_push_or_transfer_; }
   uint64_t num_no_work_iters() const { return num_no_work_iters_; }
   uint64_t push_or_transfer_this_iter() const { return push_or_transfer_this_iter_; }
+  std::chrono::nanoseconds SourceCPUTime(std::string_view source_name) const;
+
+  struct AdaptivePeriods {
+    std::chrono::milliseconds sampling_period;
+    std::chrono::milliseconds push_period;
+    // Number of times that the periods changed.
+    uint64_t num_changes = 0;
+  };
+  // Returns nullptr if the source never adapted its periods.
+  const AdaptivePeriods* SourceAdaptivePeriods(std::string_view source_name) const;
 
   // These two accessors give the histogram count based on a duration passed as in input.
   // For now, they are useful only for the test case in run_core_stats_test.cc.
@@ -66,6 +89,9 @@ class RunCoreStats {
   // Update a particular sleep histogram (passed in as *h). Called by EndIter().
   void UpdateSleepDurationHisto(std::chrono::milliseconds d, std::vector<uint64_t>* h);
 
+  // Prefix of the printouts, tells apart the main loop and the dedicated source threads.
+  const std::string log_prefix_;
+
   // Header string used for stats printouts, populated in the ctor.
   const std::string header_string_;
 
@@ -78,6 +104,9 @@ class RunCoreStats {
   uint64_t push_or_transfer_this_iter_ = 0;
   std::vector<uint64_t> sleep_histo_;
   std::vector<uint64_t> no_work_histo_;
+  // Ordered, so that the printouts list the sources in a stable order.
+  absl::btree_map<std::string, std::chrono::nanoseconds> source_cpu_time_;
+  absl::btree_map<std::string, AdaptivePeriods> source_adaptive_periods_;
 };
 
 }  // namespace stirling
@@ -67,5 +67,38 @@ TEST(RunCoreStatsTest, RunCoreStatsTest) {
   stats.LogStats();
 }
 
+TEST(RunCoreStatsTest, SourceCPUTime) {
+  RunCoreStats stats("perf_profiler");
+
+  stats.AddSourceCPUTime("perf_profiler", std::chrono::milliseconds{3});
+  stats.AddSourceCPUTime("perf_profiler", std::chrono::milliseconds{4});
+  stats.AddSourceCPUTime("jvm_stats", std::chrono::milliseconds{1});
+  EXPECT_EQ(std::chrono::milliseconds{7}, stats.SourceCPUTime("perf_profiler"));
+  EXPECT_EQ(std::chrono::milliseconds{1}, stats.SourceCPUTime("jvm_stats"));
+  EXPECT_EQ(std::chrono::nanoseconds{0}, stats.SourceCPUTime("socket_tracer"));
+
+  stats.LogStats();
+}
+
+TEST(RunCoreStatsTest, AdaptivePeriods) {
+  RunCoreStats stats;
+  EXPECT_EQ(stats.SourceAdaptivePeriods("socket_tracer"), nullptr);
+
+  stats.RecordAdaptivePeriods("socket_tracer", std::chrono::milliseconds{200},
+                              std::chrono::milliseconds{1000});
+  stats.RecordAdaptivePeriods("socket_tracer", std::chrono::milliseconds{200},
+                              std::chrono::milliseconds{1000});
+  stats.RecordAdaptivePeriods("socket_tracer", std::chrono::milliseconds{100},
+                              std::chrono::milliseconds{500});
+
+  const RunCoreStats::AdaptivePeriods* periods = stats.SourceAdaptivePeriods("socket_tracer");
+  ASSERT_NE(periods, nullptr);
+  EXPECT_EQ(periods->sampling_period, std::chrono::milliseconds{100});
+  EXPECT_EQ(periods->push_period, std::chrono::milliseconds{500});
+  EXPECT_EQ(periods->num_changes, 1U);
+
+  stats.LogStats();
+}
+
 }  // namespace stirling
 }  // namespace px
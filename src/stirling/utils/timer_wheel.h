@@ -0,0 +1,219 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace px {
+namespace stirling {
+namespace utils {
+
+/**
+ * A hierarchical timer wheel, which hands out values once their deadline has passed.
+ *
+ * Deadlines are in abstract ticks (e.g. milliseconds or iterations). Advancing the wheel only
+ * touches the values that expire, plus a cascade of each value down the levels, so the cost of
+ * expiry doesn't grow with the number of values that are still waiting.
+ *
+ * Level L holds the values whose deadline first differs from the current tick in bit group L,
+ * where a group is kSlotBits wide. Deadlines beyond the last level wait in an overflow list until
+ * the wheel gets close enough.
+ *
+ * Values can't be cancelled. Instead, callers re-check a value when it expires, and schedule it
+ * again if its deadline has moved. A value must not be scheduled more than once if it can be
+ * destroyed while one of its entries is still in the wheel.
+ */
+template <typename T, int kSlotBits = 6, int kNumLevels = 4>
+class TimerWheel {
+  static_assert(kSlotBits * kNumLevels < 64, "The levels must fit in the 64-bit deadlines.");
+
+ public:
+  explicit TimerWheel(uint64_t now = 0) : now_(now) {}
+
+  /**
+   * Schedules value to expire at the first Advance() to a tick that is at or after deadline.
+   * Deadlines that have already passed expire at the next Advance().
+   */
+  void Schedule(uint64_t deadline, T value) {
+    ++size_;
+    if (deadline <= now_) {
+      due_.push_back({deadline, std::move(value)});
+      return;
+    }
+    Insert({deadline, std::move(value)});
+  }
+
+  /**
+   * Moves the wheel to tick now, and calls fn(T) on each value whose deadline is at or before it.
+   * fn may schedule values again; those with a deadline at or before now expire at the next call.
+   */
+  template <typename TFn>
+  void Advance(uint64_t now, TFn fn) {
+    std::vector<Entry> due = std::move(due_);
+    due_.clear();
+    size_ -= due.size();
+    for (auto& e : due) {
+      fn(std::move(e.value));
+    }
+
+    while (now_ < now) {
+      if (size_ == due_.size()) {
+        now_ = now;
+        break;
+      }
+
+      // Nothing fires until the lowest non-empty level is cascaded, so jump right before it.
+      int level = 0;
+      while (level < kNumLevels && level_sizes_[level] == 0) {
+        ++level;
+      }
+      if (level == kNumLevels) {
+        // Only deadlines in later revolutions of the top level are left. Jump right before the
+        // revolution of the earliest one, which spreads them out.
+        uint64_t min_deadline = overflow_.front().deadline;
+        for (const auto& e : overflow_) {
+          min_deadline = std::min(min_deadline, e.deadline);
+        }
+        constexpr int kTopShift = kNumLevels * kSlotBits;
+        const uint64_t revolution = (min_deadline >> kTopShift) << kTopShift;
+        if (revolution > now) {
+          now_ = now;
+          break;
+        }
+        now_ = revolution - 1;
+      } else if (level > 0) {
+        const int shift = level * kSlotBits;
+        const uint64_t next_cascade = ((now_ >> shift) + 1) << shift;
+        if (next_cascade > now) {
+          now_ = now;
+          break;
+        }
+        now_ = next_cascade - 1;
+      }
+
+      ++now_;
+      if ((now_ & kSlotMask) == 0) {
+        Cascade();
+      }
+      FireSlot(0, now_ & kSlotMask, fn);
+    }
+  }
+
+  /**
+   * Drops all values.
+   */
+  void Clear() {
+    slots_.clear();
+    level_sizes_.fill(0);
+    overflow_.clear();
+    due_.clear();
+    size_ = 0;
+  }
+
+  uint64_t now() const { return now_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+ private:
+  static constexpr uint64_t kNumSlots = uint64_t{1} << kSlotBits;
+  static constexpr uint64_t kSlotMask = kNumSlots - 1;
+
+  struct Entry {
+    uint64_t deadline;
+    T value;
+  };
+
+  std::vector<Entry>& Slot(int level, uint64_t slot) {
+    // Allocated on first use, so that idle wheels stay small.
+    if (slots_.empty()) {
+      slots_.resize(kNumLevels * kNumSlots);
+    }
+    return slots_[level * kNumSlots + slot];
+  }
+
+  // Places an entry with deadline >= now_ by the highest bit group in which it differs from now_.
+  void Insert(Entry e) {
+    const uint64_t diff = e.deadline ^ now_;
+    const int level = diff == 0 ? 0 : (63 - __builtin_clzll(diff)) / kSlotBits;
+    if (level >= kNumLevels) {
+      overflow_.push_back(std::move(e));
+      return;
+    }
+    ++level_sizes_[level];
+    Slot(level, (e.deadline >> (level * kSlotBits)) & kSlotMask).push_back(std::move(e));
+  }
+
+  void ReinsertOverflow() {
+    std::vector<Entry> overflow = std::move(overflow_);
+    overflow_.clear();
+    for (auto& e : overflow) {
+      Insert(std::move(e));
+    }
+  }
+
+  // Called when now_ enters a new level 0 revolution. Moves the entries of the slots that now_
+  // has reached in the higher levels down, starting from the highest level that turned over.
+  void Cascade() {
+    int level = 1;
+    while (level < kNumLevels && ((now_ >> (level * kSlotBits)) & kSlotMask) == 0) {
+      ++level;
+    }
+    if (level == kNumLevels) {
+      ReinsertOverflow();
+      level = kNumLevels - 1;
+    }
+    for (; level > 0; --level) {
+      const uint64_t slot = (now_ >> (level * kSlotBits)) & kSlotMask;
+      std::vector<Entry> entries = std::move(Slot(level, slot));
+      level_sizes_[level] -= entries.size();
+      for (auto& e : entries) {
+        Insert(std::move(e));
+      }
+    }
+  }
+
+  template <typename TFn>
+  void FireSlot(int level, uint64_t slot, TFn& fn) {
+    std::vector<Entry> entries = std::move(Slot(level, slot));
+    level_sizes_[level] -= entries.size();
+    size_ -= entries.size();
+    for (auto& e : entries) {
+      fn(std::move(e.value));
+    }
+  }
+
+  uint64_t now_;
+  size_t size_ = 0;
+
+  // kNumLevels levels of kNumSlots slots each, flattened.
+  std::vector<std::vector<Entry>> slots_;
+  std::array<size_t, kNumLevels> level_sizes_ = {};
+  std::vector<Entry> overflow_;
+
+  // Values scheduled at or before now_, which expire at the next Advance().
+  std::vector<Entry> due_;
+};
+
+}  // namespace utils
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/utils/timer_wheel.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace utils {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+std::vector<int> Advance(TimerWheel<int, 2, 2>* wheel, uint64_t now) {
+  std::vector<int> expired;
+  wheel->Advance(now, [&expired](int v) { expired.push_back(v); });
+  return expired;
+}
+
+TEST(TimerWheelTest, ExpiresAtDeadline) {
+  // 2 levels of 4 slots, so deadlines more than 16 ticks away overflow.
+  TimerWheel<int, 2, 2> wheel;
+  wheel.Schedule(3, 3);
+  wheel.Schedule(5, 5);
+  wheel.Schedule(17, 17);
+  wheel.Schedule(100, 100);
+  wheel.Schedule(100, 101);
+  EXPECT_EQ(wheel.size(), 5);
+
+  EXPECT_THAT(Advance(&wheel, 2), IsEmpty());
+  EXPECT_THAT(Advance(&wheel, 3), ElementsAre(3));
+  EXPECT_THAT(Advance(&wheel, 16), ElementsAre(5));
+  EXPECT_THAT(Advance(&wheel, 99), ElementsAre(17));
+  EXPECT_THAT(Advance(&wheel, 1000), UnorderedElementsAre(100, 101));
+  EXPECT_TRUE(wheel.empty());
+  EXPECT_EQ(wheel.now(), 1000);
+}
+
+TEST(TimerWheelTest, PastDeadlinesExpireAtNextAdvance) {
+  TimerWheel<int, 2, 2> wheel(10);
+  wheel.Schedule(5, 5);
+  wheel.Schedule(10, 10);
+  EXPECT_THAT(Advance(&wheel, 10), UnorderedElementsAre(5, 10));
+
+  // Values rescheduled while advancing, at or before the target, expire at the next call.
+  wheel.Schedule(12, 12);
+  std::vector<int> expired;
+  wheel.Advance(20, [&](int v) {
+    expired.push_back(v);
+    wheel.Schedule(v, v + 1);
+  });
+  EXPECT_THAT(expired, ElementsAre(12));
+  EXPECT_THAT(Advance(&wheel, 20), ElementsAre(13));
+}
+
+TEST(TimerWheelTest, MatchesSortedDeadlines) {
+  std::default_random_engine rng(37);
+  std::uniform_int_distribution<uint64_t> delta_dist(0, 300);
+  std::uniform_int_distribution<uint64_t> step_dist(0, 40);
+
+  TimerWheel<int, 2, 2> wheel;
+  std::multimap<uint64_t, int> expected;
+  uint64_t now = 0;
+  for (int i = 0; i < 10000; ++i) {
+    uint64_t deadline = now + delta_dist(rng);
+    wheel.Schedule(deadline, i);
+    // Deadlines that have passed expire at the next Advance().
+    expected.emplace(deadline <= now ? 0 : deadline, i);
+
+    now += step_dist(rng);
+    std::vector<int> expired = Advance(&wheel, now);
+    std::vector<int> expected_expired;
+    while (!expected.empty() && expected.begin()->first <= now) {
+      expected_expired.push_back(expected.begin()->second);
+      expected.erase(expected.begin());
+    }
+    std::sort(expired.begin(), expired.end());
+    std::sort(expected_expired.begin(), expected_expired.end());
+    ASSERT_EQ(expired, expected_expired) << "now=" << now;
+    ASSERT_EQ(wheel.size(), expected.size());
+  }
+}
+
+}  // namespace utils
+}  // namespace stirling
+}  // namespace px
@@ -18,8 +18,10 @@
 
 #include <arrow/array.h>
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <absl/strings/str_format.h>
@@ -34,7 +36,42 @@ namespace schema {
 
 using types::DataType;
 
-std::shared_ptr<arrow::Array> RowBatch::ColumnAt(int64_t i) const { return columns_[i]; }
+template <DataType T>
+Status TakeValues(const arrow::Array* input_col, const std::vector<int64_t>& rows,
+                  std::shared_ptr<arrow::Array>* output_col) {
+  auto builder = MakeArrowBuilder(T, arrow::default_memory_pool());
+  PX_RETURN_IF_ERROR(builder->Reserve(rows.size()));
+  for (auto row : rows) {
+    PX_RETURN_IF_ERROR(
+        CopyValue<T>(builder.get(), types::GetValueFromArrowArray<T>(input_col, row)));
+  }
+  PX_RETURN_IF_ERROR(builder->Finish(output_col));
+  return Status::OK();
+}
+
+std::shared_ptr<arrow::Array> RowBatch::ColumnAt(int64_t i) const {
+  if (selection_ == nullptr) {
+    return columns_[i];
+  }
+  auto& col = materialized_columns_[i];
+  if (col == nullptr) {
+#define TYPE_CASE(_dt_) PX_CHECK_OK(TakeValues<_dt_>(columns_[i].get(), *selection_, &col));
+    PX_SWITCH_FOREACH_DATATYPE(desc_.type(i), TYPE_CASE);
+#undef TYPE_CASE
+  }
+  return col;
+}
+
+std::vector<std::shared_ptr<arrow::Array>> RowBatch::columns() const {
+  if (selection_ == nullptr) {
+    return columns_;
+  }
+  std::vector<std::shared_ptr<arrow::Array>> cols;
+  for (size_t i = 0; i < columns_.size(); ++i) {
+    cols.push_back(ColumnAt(i));
+  }
+  return cols;
+}
 
 Status RowBatch::AddColumn(const std::shared_ptr<arrow::Array>& col) {
   if (columns_.size() >= desc_.size()) {
@@ -47,10 +84,30 @@ Status RowBatch::AddColumn(const std::shared_ptr<arrow::Array>& col) {
     return error::InvalidArgument("Column[$0] was given incorrect type", columns_.size());
   }
 
+  if (selection_ != nullptr) {
+    materialized_columns_[columns_.size()] = col;
+    columns_.emplace_back(nullptr);
+    return Status::OK();
+  }
   columns_.emplace_back(col);
   return Status::OK();
 }
 
+Status RowBatch::AddColumnFrom(const RowBatch& other, int64_t i) {
+  if (selection_ == nullptr || selection_ != other.selection_) {
+    return AddColumn(other.ColumnAt(i));
+  }
+  if (columns_.size() >= desc_.size()) {
+    return error::InvalidArgument("Schema only allows $0 columns", desc_.size());
+  }
+  if (desc_.type(columns_.size()) != other.desc_.type(i)) {
+    return error::InvalidArgument("Column[$0] was given incorrect type", columns_.size());
+  }
+  materialized_columns_[columns_.size()] = other.materialized_columns_[i];
+  columns_.emplace_back(other.columns_[i]);
+  return Status::OK();
+}
+
 bool RowBatch::HasColumn(int64_t i) const { return columns_.size() > static_cast<size_t>(i); }
 
 std::string RowBatch::DebugString() const {
@@ -58,7 +115,7 @@ std::string RowBatch::DebugString() const {
     return "RowBatch: <empty>";
   }
   std::string debug_string = absl::StrFormat("RowBatch(eow=%d, eos=%d):\n", eow_, eos_);
-  for (const auto& col : columns_) {
+  for (const auto& col : columns()) {
     debug_string += absl::StrFormat("  %s\n", col->ToString());
   }
   return debug_string;
@@ -70,10 +127,18 @@ int64_t RowBatch::NumBytes() const {
   }
 
   int64_t total_bytes = 0;
-  for (auto col : columns_) {
-#define TYPE_CASE(_dt_) total_bytes += types::GetArrowArrayBytes<_dt_>(col.get());
-    PX_SWITCH_FOREACH_DATATYPE(types::ArrowToDataType(col->type_id()), TYPE_CASE);
+  for (size_t i = 0; i < columns_.size(); ++i) {
+    // Columns of views that haven't been materialized are estimated from the underlying array.
+    bool estimate = selection_ != nullptr && materialized_columns_[i] == nullptr;
+    const auto& col = estimate ? columns_[i] : ColumnAt(i);
+    int64_t col_bytes = 0;
+#define TYPE_CASE(_dt_) col_bytes = types::GetArrowArrayBytes<_dt_>(col.get());
+    PX_SWITCH_FOREACH_DATATYPE(desc_.type(i), TYPE_CASE);
 #undef TYPE_CASE
+    if (estimate && col->length() > 0) {
+      col_bytes = col_bytes * num_rows_ / col->length();
+    }
+    total_bytes += col_bytes;
   }
   return total_bytes;
 }
@@ -158,6 +223,141 @@ Status CopyFromInputPB(std::shared_ptr<arrow::Array>* output_column,
   return Status::OK();
 }
 
+// Packed serialization. Each column of n rows is laid out back to back as:
+//   BOOLEAN: n bytes of 0 or 1.
+//   INT64, TIME64NS, FLOAT64: the n values, copied straight out of the arrow buffer.
+//   UINT128: n pairs of (low, high) 64-bit words.
+//   STRING: n + 1 int32 offsets starting at 0, followed by the string data.
+// Columns with no rows take no space.
+
+template <typename TValue>
+void AppendPacked(const TValue& value, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(TValue));
+}
+
+// The packed buffer carries no alignment guarantees, so values are always loaded with memcpy.
+template <typename TValue>
+TValue LoadPacked(const char* data) {
+  TValue value;
+  std::memcpy(&value, data, sizeof(TValue));
+  return value;
+}
+
+template <DataType T>
+void PackColumn(const arrow::Array* input_column, std::string* out) {
+  int64_t num_rows = input_column->length();
+  if (num_rows == 0) {
+    return;
+  }
+  if constexpr (T == DataType::BOOLEAN) {
+    const auto* arr = static_cast<const arrow::BooleanArray*>(input_column);
+    for (int64_t i = 0; i < num_rows; ++i) {
+      out->push_back(arr->Value(i) ? 1 : 0);
+    }
+  } else if constexpr (T == DataType::UINT128) {
+    for (int64_t i = 0; i < num_rows; ++i) {
+      auto val = types::GetValueFromArrowArray<T>(input_column, i);
+      AppendPacked(absl::Uint128Low64(val), out);
+      AppendPacked(absl::Uint128High64(val), out);
+    }
+  } else if constexpr (T == DataType::STRING) {
+    const auto* arr = static_cast<const arrow::StringArray*>(input_column);
+    int32_t base = arr->value_offset(0);
+    for (int64_t i = 0; i <= num_rows; ++i) {
+      AppendPacked<int32_t>(arr->value_offset(i) - base, out);
+    }
+    int32_t data_size = arr->value_offset(num_rows) - base;
+    if (data_size > 0) {
+      out->append(reinterpret_cast<const char*>(arr->value_data()->data()) + base, data_size);
+    }
+  } else {
+    using arrow_array_type = typename types::DataTypeTraits<T>::arrow_array_type;
+    using native_type = typename types::DataTypeTraits<T>::native_type;
+    const auto* arr = static_cast<const arrow_array_type*>(input_column);
+    out->append(reinterpret_cast<const char*>(arr->raw_values()), num_rows * sizeof(native_type));
+  }
+}
+
+// Returns the next `size` bytes of the packed columns and advances past them.
+StatusOr<const char*> TakePacked(std::string_view* packed, size_t size) {
+  if (packed->size() < size) {
+    return error::InvalidArgument("Packed row batch is truncated: need $0 bytes, have $1", size,
+                                  packed->size());
+  }
+  const char* data = packed->data();
+  packed->remove_prefix(size);
+  return data;
+}
+
+template <DataType T>
+Status UnpackColumn(int64_t num_rows, std::string_view* packed,
+                    std::shared_ptr<arrow::Array>* output_column) {
+  auto builder = MakeArrowBuilder(T, arrow::default_memory_pool());
+  auto* typed_builder =
+      static_cast<typename types::DataTypeTraits<T>::arrow_builder_type*>(builder.get());
+  PX_RETURN_IF_ERROR(builder->Reserve(num_rows));
+
+  if (num_rows == 0) {
+    // Nothing was packed for this column.
+  } else if constexpr (T == DataType::BOOLEAN) {
+    PX_ASSIGN_OR_RETURN(const char* data, TakePacked(packed, num_rows));
+    for (int64_t i = 0; i < num_rows; ++i) {
+      typed_builder->UnsafeAppend(data[i] != 0);
+    }
+  } else if constexpr (T == DataType::UINT128) {
+    PX_ASSIGN_OR_RETURN(const char* data, TakePacked(packed, num_rows * 2 * sizeof(uint64_t)));
+    for (int64_t i = 0; i < num_rows; ++i) {
+      auto low = LoadPacked<uint64_t>(data + 2 * i * sizeof(uint64_t));
+      auto high = LoadPacked<uint64_t>(data + (2 * i + 1) * sizeof(uint64_t));
+      typed_builder->UnsafeAppend(absl::MakeUint128(high, low));
+    }
+  } else if constexpr (T == DataType::STRING) {
+    PX_ASSIGN_OR_RETURN(const char* offsets, TakePacked(packed, (num_rows + 1) * sizeof(int32_t)));
+    auto data_size = LoadPacked<int32_t>(offsets + num_rows * sizeof(int32_t));
+    if (data_size < 0) {
+      return error::InvalidArgument("Packed string column has negative size $0", data_size);
+    }
+    PX_ASSIGN_OR_RETURN(const char* data, TakePacked(packed, data_size));
+    PX_RETURN_IF_ERROR(typed_builder->ReserveData(data_size));
+    int32_t start = 0;
+    for (int64_t i = 0; i < num_rows; ++i) {
+      auto end = LoadPacked<int32_t>(offsets + (i + 1) * sizeof(int32_t));
+      if (end < start || end > data_size) {
+        return error::InvalidArgument("Packed string column has invalid offset $0 at row $1", end,
+                                      i);
+      }
+      typed_builder->UnsafeAppend(data + start, end - start);
+      start = end;
+    }
+  } else {
+    using native_type = typename types::DataTypeTraits<T>::native_type;
+    PX_ASSIGN_OR_RETURN(const char* data, TakePacked(packed, num_rows * sizeof(native_type)));
+    for (int64_t i = 0; i < num_rows; ++i) {
+      typed_builder->UnsafeAppend(LoadPacked<native_type>(data + i * sizeof(native_type)));
+    }
+  }
+  PX_RETURN_IF_ERROR(builder->Finish(output_column));
+  return Status::OK();
+}
+
+Status RowBatch::ToPackedProto(table_store::schemapb::RowBatchData* proto) const {
+  proto->set_num_rows(num_rows_);
+  proto->set_eow(eow_);
+  proto->set_eos(eos_);
+
+  auto* packed = proto->mutable_packed_cols();
+  // Enough for the values plus the string offsets, so the buffer is only allocated once.
+  packed->reserve(NumBytes() + num_columns() * (num_rows_ + 1) * sizeof(int32_t));
+  for (auto col_idx = 0; col_idx < num_columns(); ++col_idx) {
+    auto dt = desc_.type(col_idx);
+    proto->add_packed_col_types(dt);
+#define TYPE_CASE(_dt_) PackColumn<_dt_>(ColumnAt(col_idx).get(), packed);
+    PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
+#undef TYPE_CASE
+  }
+  return Status::OK();
+}
+
 Status RowBatch::ToProto(table_store::schemapb::RowBatchData* proto) const {
   proto->set_num_rows(num_rows_);
   proto->set_eow(eow_);
@@ -197,8 +397,40 @@ StatusOr<DataType> ProtoDataType(const table_store::schemapb::Column& proto) {
   }
 }
 
+StatusOr<std::unique_ptr<RowBatch>> FromPackedProto(
+    const table_store::schemapb::RowBatchData& proto) {
+  std::vector<DataType> types;
+  std::vector<std::shared_ptr<arrow::Array>> data_columns(proto.packed_col_types_size());
+  std::string_view packed = proto.packed_cols();
+
+  for (auto i = 0; i < proto.packed_col_types_size(); ++i) {
+    types.push_back(static_cast<DataType>(proto.packed_col_types(i)));
+    if (types[i] == DataType::DATA_TYPE_UNKNOWN) {
+      return error::InvalidArgument("Packed row batch column $0 has an unknown type", i);
+    }
+#define TYPE_CASE(_dt_) \
+  PX_RETURN_IF_ERROR(UnpackColumn<_dt_>(proto.num_rows(), &packed, &data_columns[i]));
+    PX_SWITCH_FOREACH_DATATYPE(types[i], TYPE_CASE);
+#undef TYPE_CASE
+  }
+  if (!packed.empty()) {
+    return error::InvalidArgument("Packed row batch has $0 trailing bytes", packed.size());
+  }
+
+  auto output_rb = std::make_unique<RowBatch>(RowDescriptor(types), proto.num_rows());
+  output_rb->set_eow(proto.eow());
+  output_rb->set_eos(proto.eos());
+  for (const auto& col : data_columns) {
+    PX_RETURN_IF_ERROR(output_rb->AddColumn(col));
+  }
+  return output_rb;
+}
+
 StatusOr<std::unique_ptr<RowBatch>> RowBatch::FromProto(
     const table_store::schemapb::RowBatchData& proto) {
+  if (proto.packed_col_types_size() > 0) {
+    return FromPackedProto(proto);
+  }
   std::vector<DataType> types(proto.cols_size());
   std::vector<std::shared_ptr<arrow::Array>> data_columns(proto.cols_size());
 
@@ -265,6 +497,64 @@ StatusOr<std::unique_ptr<RowBatch>> RowBatch::Slice(int64_t offset, int64_t leng
   return output_rb;
 }
 
+StatusOr<std::unique_ptr<RowBatch>> RowBatch::Select(const std::vector<int64_t>& col_indices,
+                                                     std::vector<int64_t> rows) const {
+  std::vector<DataType> types;
+  for (auto col_idx : col_indices) {
+    if (col_idx < 0 || col_idx >= num_columns()) {
+      return error::InvalidArgument("Select of column $0 on rowbatch with $1 columns is invalid",
+                                    col_idx, num_columns());
+    }
+    types.push_back(desc_.type(col_idx));
+  }
+  for (auto row : rows) {
+    if (row < 0 || row >= num_rows_) {
+      return error::InvalidArgument("Select of row $0 on rowbatch of length $1 is invalid", row,
+                                    num_rows_);
+    }
+  }
+
+  auto output_rb = std::make_unique<RowBatch>(RowDescriptor(types), rows.size());
+  output_rb->materialized_columns_.resize(col_indices.size());
+  for (const auto& [out_idx, col_idx] : Enumerate(col_indices)) {
+    output_rb->columns_.push_back(columns_[col_idx]);
+    if (columns_[col_idx] == nullptr) {
+      // Columns that were added to this view have no underlying array to select from.
+#define TYPE_CASE(_dt_)                                                           \
+  PX_RETURN_IF_ERROR(TakeValues<_dt_>(materialized_columns_[col_idx].get(), rows, \
+                                      &output_rb->materialized_columns_[out_idx]));
+      PX_SWITCH_FOREACH_DATATYPE(desc_.type(col_idx), TYPE_CASE);
+#undef TYPE_CASE
+    }
+  }
+  if (selection_ != nullptr) {
+    for (auto& row : rows) {
+      row = (*selection_)[row];
+    }
+  }
+  output_rb->selection_ = std::make_shared<const std::vector<int64_t>>(std::move(rows));
+  return output_rb;
+}
+
+std::unique_ptr<RowBatch> RowBatch::WithRowsOf(RowDescriptor desc, const RowBatch& other) {
+  auto output_rb = std::make_unique<RowBatch>(std::move(desc), other.num_rows_);
+  if (other.selection_ != nullptr) {
+    output_rb->materialized_columns_.resize(output_rb->desc_.size());
+    output_rb->selection_ = other.selection_;
+  }
+  return output_rb;
+}
+
+StatusOr<std::unique_ptr<RowBatch>> RowBatch::Materialize() const {
+  auto output_rb = std::make_unique<RowBatch>(desc_, num_rows_);
+  output_rb->set_eow(eow_);
+  output_rb->set_eos(eos_);
+  for (int64_t col_idx = 0; col_idx < num_columns(); ++col_idx) {
+    PX_RETURN_IF_ERROR(output_rb->AddColumn(ColumnAt(col_idx)));
+  }
+  return output_rb;
+}
+
 }  // namespace schema
 }  // namespace table_store
 }  // namespace px
@@ -36,6 +36,9 @@ namespace schema {
 /**
  * A RowBatch is a table-like structure which consists of equal-length arrays
  * that match the schema described by the RowDescriptor.
+ *
+ * A RowBatch can also be a view of a subset of the rows of other arrays (see Select), in which
+ * case each column is only copied out of the underlying array when it is first accessed.
  */
 class RowBatch {
  public:
@@ -50,6 +53,12 @@ class RowBatch {
   }
 
   Status ToProto(table_store::schemapb::RowBatchData* row_batch_proto) const;
+  /**
+   * Serializes the row batch with each column packed into a single bytes buffer, rather than
+   * one proto field per value. Fixed width columns are copied straight out of their arrow
+   * buffers. FromProto accepts either form.
+   */
+  Status ToPackedProto(table_store::schemapb::RowBatchData* row_batch_proto) const;
   static StatusOr<std::unique_ptr<RowBatch>> FromProto(
       const table_store::schemapb::RowBatchData& row_batch_proto);
 
@@ -76,15 +85,52 @@ class RowBatch {
    */
   StatusOr<std::unique_ptr<RowBatch>> Slice(int64_t offset, int64_t length) const;
 
+  /**
+   * @brief Returns a view of the rows `rows` of the columns `col_indices` of this RowBatch.
+   *
+   * No values are copied up front. A selected column is materialized the first time it is
+   * accessed through ColumnAt (or when the batch is serialized), so consumers only pay for the
+   * columns they actually read. Selecting from a view selects from its underlying arrays.
+   * Does not set eow and eos.
+   *
+   * @param col_indices The columns of this RowBatch that make up the output, in order.
+   * @param rows The indices of the rows to keep, in output order.
+   * @return StatusOr<std::unique_ptr<RowBatch>>
+   */
+  StatusOr<std::unique_ptr<RowBatch>> Select(const std::vector<int64_t>& col_indices,
+                                             std::vector<int64_t> rows) const;
+
+  /**
+   * @brief Returns an empty RowBatch for the given schema, with the same rows as `other`.
+   *
+   * If `other` is a view, the output is a view of the same selection, so that the columns that
+   * are forwarded from `other` with AddColumnFrom don't have to be materialized. Columns added with
+   * AddColumn have one value per row of the output, as usual.
+   */
+  static std::unique_ptr<RowBatch> WithRowsOf(RowDescriptor desc, const RowBatch& other);
+
+  /**
+   * Returns a copy of this RowBatch with every column materialized, including eow and eos.
+   * Views should be materialized before they are shared between threads.
+   */
+  StatusOr<std::unique_ptr<RowBatch>> Materialize() const;
+
   /**
    * Adds the given column to the row batch, given that it correctly fits the schema.
    * param col ptr to the arrow array that should be added to the row batch.
    */
   Status AddColumn(const std::shared_ptr<arrow::Array>& col);
 
+  /**
+   * Adds column `i` of `other`, which must have the same rows. The column is shared rather than
+   * materialized if both RowBatches are views of the same selection (see WithRowsOf).
+   */
+  Status AddColumnFrom(const RowBatch& other, int64_t i);
+
   /**
    * @ param i the index of the column to be accessed.
-   * @ returns the Arrow array for the column at the given index.
+   * @ returns the Arrow array for the column at the given index. Materializes the column if
+   * this RowBatch is a view.
    */
   std::shared_ptr<arrow::Array> ColumnAt(int64_t i) const;
 
@@ -110,13 +156,16 @@ class RowBatch {
 
   bool eos() const { return eos_; }
   void set_eos(bool val) { eos_ = val; }
+
+  // Whether this RowBatch is a view of selected rows of its underlying arrays.
+  bool has_selection() const { return selection_ != nullptr; }
   /**
    * @ return the row descriptor which describes the schema of the row batch.
    */
   const RowDescriptor& desc() const { return desc_; }
 
   std::string DebugString() const;
-  std::vector<std::shared_ptr<arrow::Array>> columns() const { return columns_; }
+  std::vector<std::shared_ptr<arrow::Array>> columns() const;
 
   int64_t NumBytes() const;
 
@@ -126,6 +175,13 @@ class RowBatch {
   bool eow_ = false;
   bool eos_ = false;
   std::vector<std::shared_ptr<arrow::Array>> columns_;
+
+  // For views, the rows of columns_ that are in this RowBatch, and the columns that have been
+  // materialized so far. Like the rest of RowBatch, materialization is not thread-safe. Columns
+  // that were added to a view with AddColumn only have a materialized array, their entry in
+  // columns_ is null.
+  std::shared_ptr<const std::vector<int64_t>> selection_;
+  mutable std::vector<std::shared_ptr<arrow::Array>> materialized_columns_;
 };
 
 // Append a scalar value to an arrow::Array.
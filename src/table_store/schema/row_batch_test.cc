@@ -179,6 +179,50 @@ TEST_F(RowBatchTest, to_from_proto) {
   EXPECT_TRUE(differ.Compare(input_proto, output_proto));
 }
 
+TEST_F(RowBatchTest, to_from_packed_proto) {
+  table_store::schemapb::RowBatchData input_proto;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(kTestRowBatchProto, &input_proto));
+  ASSERT_OK_AND_ASSIGN(auto rb, RowBatch::FromProto(input_proto));
+
+  table_store::schemapb::RowBatchData packed_proto;
+  EXPECT_OK(rb->ToPackedProto(&packed_proto));
+  EXPECT_EQ(0, packed_proto.cols_size());
+  EXPECT_EQ(3, packed_proto.packed_col_types_size());
+  EXPECT_LT(packed_proto.ByteSizeLong(), input_proto.ByteSizeLong());
+
+  ASSERT_OK_AND_ASSIGN(auto from_packed, RowBatch::FromProto(packed_proto));
+  EXPECT_EQ(rb->desc(), from_packed->desc());
+  EXPECT_TRUE(from_packed->eow());
+  EXPECT_FALSE(from_packed->eos());
+  table_store::schemapb::RowBatchData output_proto;
+  EXPECT_OK(from_packed->ToProto(&output_proto));
+  google::protobuf::util::MessageDifferencer differ;
+  EXPECT_TRUE(differ.Compare(input_proto, output_proto));
+
+  // Slices pack only their own rows, including booleans.
+  ASSERT_OK_AND_ASSIGN(auto slice, rb_->Slice(1, 2));
+  table_store::schemapb::RowBatchData packed_slice;
+  EXPECT_OK(slice->ToPackedProto(&packed_slice));
+  ASSERT_OK_AND_ASSIGN(auto from_packed_slice, RowBatch::FromProto(packed_slice));
+  EXPECT_EQ(slice->DebugString(), from_packed_slice->DebugString());
+
+  // Zero row batches keep their types.
+  ASSERT_OK_AND_ASSIGN(auto zero_rows, RowBatch::WithZeroRows(*rd_, false, true));
+  table_store::schemapb::RowBatchData packed_zero_rows;
+  EXPECT_OK(zero_rows->ToPackedProto(&packed_zero_rows));
+  ASSERT_OK_AND_ASSIGN(auto from_packed_zero_rows, RowBatch::FromProto(packed_zero_rows));
+  EXPECT_EQ(*rd_, from_packed_zero_rows->desc());
+  EXPECT_EQ(0, from_packed_zero_rows->num_rows());
+
+  // Truncated or padded buffers are rejected.
+  auto truncated = packed_proto;
+  truncated.mutable_packed_cols()->pop_back();
+  EXPECT_NOT_OK(RowBatch::FromProto(truncated));
+  auto padded = packed_proto;
+  padded.mutable_packed_cols()->push_back(0);
+  EXPECT_NOT_OK(RowBatch::FromProto(padded));
+}
+
 TEST_F(RowBatchTest, with_zero_rows) {
   bool eow = true;
   bool eos = false;
@@ -231,6 +275,60 @@ TEST_F(RowBatchTest, slice) {
   ASSERT_EQ(status2.msg(), "Slice(offset=-1, length=3) on rowbatch of length 3 is invalid");
 }
 
+TEST_F(RowBatchTest, select) {
+  ASSERT_OK_AND_ASSIGN(auto view, rb_->Select({2, 1}, {0, 2}));
+  EXPECT_TRUE(view->has_selection());
+  EXPECT_EQ(2, view->num_rows());
+  EXPECT_EQ(2, view->num_columns());
+  EXPECT_EQ(types::DataType::FLOAT64, view->desc().type(0));
+  EXPECT_EQ("RowBatch(eow=0, eos=0):\n  [\n  3.3,\n  5.6\n]\n  [\n  3,\n  5\n]\n",
+            view->DebugString());
+
+  // Selecting from a view selects from the underlying rows.
+  ASSERT_OK_AND_ASSIGN(auto view_of_view, view->Select({1}, {1}));
+  EXPECT_EQ("RowBatch(eow=0, eos=0):\n  [\n  5\n]\n", view_of_view->DebugString());
+
+  // A view round trips through its proto like a regular RowBatch.
+  table_store::schemapb::RowBatchData pb;
+  EXPECT_OK(view->ToProto(&pb));
+  ASSERT_OK_AND_ASSIGN(auto from_pb, RowBatch::FromProto(pb));
+  EXPECT_FALSE(from_pb->has_selection());
+  EXPECT_EQ(view->DebugString(), from_pb->DebugString());
+
+  ASSERT_OK_AND_ASSIGN(auto materialized, view->Materialize());
+  EXPECT_FALSE(materialized->has_selection());
+  EXPECT_EQ(view->NumBytes(), materialized->NumBytes());
+
+  ASSERT_NOT_OK(rb_->Select({3}, {0}));
+  ASSERT_NOT_OK(rb_->Select({0}, {3}));
+}
+
+TEST_F(RowBatchTest, with_rows_of_view) {
+  ASSERT_OK_AND_ASSIGN(auto view, rb_->Select({0, 1, 2}, {2, 0}));
+  auto output = RowBatch::WithRowsOf(
+      RowDescriptor({types::DataType::INT64, types::DataType::FLOAT64}), *view);
+  EXPECT_TRUE(output->has_selection());
+  EXPECT_EQ(2, output->num_rows());
+  // A forwarded column and a computed one, with one value per row of the view.
+  EXPECT_OK(output->AddColumnFrom(*view, 1));
+  std::vector<types::Float64Value> computed = {1.5, 2.5};
+  EXPECT_OK(output->AddColumn(types::ToArrow(computed, arrow::default_memory_pool())));
+  EXPECT_EQ("RowBatch(eow=0, eos=0):\n  [\n  5,\n  3\n]\n  [\n  1.5,\n  2.5\n]\n",
+            output->DebugString());
+
+  // Selecting from the output selects from the computed column too.
+  ASSERT_OK_AND_ASSIGN(auto view_of_output, output->Select({1, 0}, {1}));
+  EXPECT_EQ("RowBatch(eow=0, eos=0):\n  [\n  2.5\n]\n  [\n  3\n]\n",
+            view_of_output->DebugString());
+
+  // Without a view, the columns are simply shared.
+  auto plain = RowBatch::WithRowsOf(RowDescriptor({types::DataType::INT64}), *rb_);
+  EXPECT_FALSE(plain->has_selection());
+  EXPECT_OK(plain->AddColumnFrom(*rb_, 1));
+  EXPECT_EQ(rb_->ColumnAt(1), plain->ColumnAt(0));
+  EXPECT_NOT_OK(plain->AddColumnFrom(*rb_, 1));
+}
+
 }  // namespace schema
 }  // namespace table_store
 }  // namespace px
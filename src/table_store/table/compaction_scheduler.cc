@@ -0,0 +1,157 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/compaction_scheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <absl/time/time.h>
+
+DEFINE_int32(table_store_compaction_threads,
+             gflags::Int32FromEnv("PL_TABLE_STORE_COMPACTION_THREADS", 2),
+             "The number of threads that compact the tables of the table store in the background.");
+
+DEFINE_int32(table_store_compaction_cpu_budget_percent,
+             gflags::Int32FromEnv("PL_TABLE_STORE_COMPACTION_CPU_BUDGET_PERCENT", 10),
+             "The percent of one core that background compaction of the table store may use. "
+             "Compaction rounds are delayed to stay within the budget.");
+
+namespace px {
+namespace table_store {
+
+void CompactionScheduler::AddTable(const std::shared_ptr<Table>& table) {
+  absl::MutexLock lock(&lock_);
+  auto& state = tables_[table.get()];
+  // The entry of a dropped table can still be around if a new table was allocated at its address.
+  if (state.table.expired()) {
+    state.table = table;
+    state.last_compaction = std::chrono::steady_clock::now();
+  }
+}
+
+void CompactionScheduler::Start(std::chrono::milliseconds period) {
+  if (thread_.joinable()) {
+    return;
+  }
+  period_ = period;
+  // The scheduler thread takes part in every round, so the pool gets one thread less.
+  size_t num_threads = std::max(FLAGS_table_store_compaction_threads, 1);
+  thread_pool_ = std::make_unique<ThreadPool>(num_threads - 1);
+  stop_ = std::make_unique<absl::Notification>();
+  thread_ = std::thread([this]() {
+    std::chrono::nanoseconds delay = period_;
+    while (!stop_->WaitForNotificationWithTimeout(absl::FromChrono(delay))) {
+      auto start = std::chrono::steady_clock::now();
+      std::chrono::nanoseconds compaction_time(0);
+      auto s = RunRound(&compaction_time);
+      LOG_IF(ERROR, !s.ok()) << "Table store compaction failed: " << s.msg();
+      delay = NextRoundDelay(std::chrono::steady_clock::now() - start, compaction_time);
+    }
+  });
+}
+
+void CompactionScheduler::Stop() {
+  if (!thread_.joinable()) {
+    return;
+  }
+  stop_->Notify();
+  thread_.join();
+  thread_pool_.reset();
+}
+
+Status CompactionScheduler::RunRound() {
+  std::chrono::nanoseconds compaction_time(0);
+  return RunRound(&compaction_time);
+}
+
+Status CompactionScheduler::RunRound(std::chrono::nanoseconds* compaction_time) {
+  struct Work {
+    std::shared_ptr<Table> table;
+    double priority;
+  };
+  std::vector<Work> work;
+  auto now = std::chrono::steady_clock::now();
+  auto period = std::max(period_, std::chrono::milliseconds(1));
+  {
+    absl::MutexLock lock(&lock_);
+    for (auto it = tables_.begin(); it != tables_.end();) {
+      auto table = it->second.table.lock();
+      if (table == nullptr) {
+        tables_.erase(it++);
+        continue;
+      }
+      auto hot_bytes = table->GetTableStats().hot_bytes;
+      if (hot_bytes > 0) {
+        // A table that waited for a whole period has the priority of one with twice the hot bytes.
+        double periods_waited =
+            std::chrono::duration<double>(now - it->second.last_compaction) / period;
+        work.push_back({std::move(table), hot_bytes * (1.0 + periods_waited)});
+      }
+      ++it;
+    }
+  }
+  std::sort(work.begin(), work.end(),
+            [](const Work& a, const Work& b) { return a.priority > b.priority; });
+
+  std::vector<Status> statuses(work.size());
+  std::vector<std::chrono::nanoseconds> durations(work.size());
+  auto compact = [&](size_t i) {
+    auto start = std::chrono::steady_clock::now();
+    statuses[i] = work[i].table->CompactHotToCold(mem_pool_);
+    durations[i] = std::chrono::steady_clock::now() - start;
+  };
+  if (thread_pool_ != nullptr) {
+    // ParallelFor hands out the indices in order, so the tables with the highest priority go first.
+    thread_pool_->ParallelFor(work.size(), compact);
+  } else {
+    for (size_t i = 0; i < work.size(); ++i) {
+      compact(i);
+    }
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  {
+    absl::MutexLock lock(&lock_);
+    for (const auto& w : work) {
+      auto it = tables_.find(w.table.get());
+      if (it != tables_.end()) {
+        it->second.last_compaction = end;
+      }
+    }
+  }
+  for (const auto& duration : durations) {
+    *compaction_time += duration;
+  }
+  for (const auto& s : statuses) {
+    PX_RETURN_IF_ERROR(s);
+  }
+  return Status::OK();
+}
+
+std::chrono::nanoseconds CompactionScheduler::NextRoundDelay(
+    std::chrono::nanoseconds round_duration, std::chrono::nanoseconds compaction_time) const {
+  int64_t budget_percent = std::clamp(FLAGS_table_store_compaction_cpu_budget_percent, 1, 100);
+  // Spending compaction_time of CPU within the budget takes at least this long.
+  auto budget_delay = compaction_time * 100 / budget_percent - round_duration;
+  auto period_delay = std::chrono::nanoseconds(period_) - round_duration;
+  return std::max({budget_delay, period_delay, std::chrono::nanoseconds(0)});
+}
+
+}  // namespace table_store
+}  // namespace px
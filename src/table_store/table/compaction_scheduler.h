@@ -0,0 +1,105 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+#include <absl/synchronization/notification.h>
+#include <arrow/memory_pool.h>
+
+#include "src/common/base/base.h"
+#include "src/common/base/thread_pool.h"
+#include "src/table_store/table/table.h"
+
+DECLARE_int32(table_store_compaction_threads);
+DECLARE_int32(table_store_compaction_cpu_budget_percent);
+
+namespace px {
+namespace table_store {
+
+/**
+ * CompactionScheduler compacts the hot data of a set of tables into cold in the background.
+ *
+ * Each round compacts the tables on a small thread pool, in order of priority: the more hot bytes a
+ * table has, and the longer it's been since it was last compacted, the earlier it's compacted.
+ * Rounds run at most once per period, and are spread out further so that the time spent compacting
+ * stays within `table_store_compaction_cpu_budget_percent` of one core.
+ *
+ * Tables are only referenced weakly, so dropping a table from the table store stops its
+ * compaction.
+ */
+class CompactionScheduler : public NotCopyMoveable {
+ public:
+  explicit CompactionScheduler(arrow::MemoryPool* mem_pool) : mem_pool_(mem_pool) {}
+  ~CompactionScheduler() { Stop(); }
+
+  /**
+   * Adds a table to compact. Adding a table that was already added is a no-op.
+   */
+  void AddTable(const std::shared_ptr<Table>& table);
+
+  /**
+   * Starts running compaction rounds on a background thread.
+   * @param period the minimum time between the starts of two rounds.
+   */
+  void Start(std::chrono::milliseconds period);
+
+  /**
+   * Stops the background thread, waiting for the current round to finish.
+   */
+  void Stop();
+
+  /**
+   * Runs a single compaction round on the calling thread (and the thread pool, if started).
+   * @return the first error of the round, if any table failed to compact.
+   */
+  Status RunRound();
+
+ private:
+  struct TableState {
+    std::weak_ptr<Table> table;
+    std::chrono::steady_clock::time_point last_compaction;
+  };
+
+  Status RunRound(std::chrono::nanoseconds* compaction_time);
+
+  // The time to wait before the next round, given the duration of the last round and the total
+  // time that round spent compacting.
+  std::chrono::nanoseconds NextRoundDelay(std::chrono::nanoseconds round_duration,
+                                          std::chrono::nanoseconds compaction_time) const;
+
+  arrow::MemoryPool* mem_pool_;
+  std::chrono::milliseconds period_ = std::chrono::milliseconds(0);
+
+  absl::Mutex lock_;
+  // Keyed by the table, which is only used for lookups, never dereferenced.
+  absl::flat_hash_map<const Table*, TableState> tables_ ABSL_GUARDED_BY(lock_);
+
+  std::unique_ptr<ThreadPool> thread_pool_;
+  std::unique_ptr<absl::Notification> stop_;
+  std::thread thread_;
+};
+
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/compaction_scheduler.h"
+
+namespace px {
+namespace table_store {
+
+class CompactionSchedulerTest : public ::testing::Test {
+ protected:
+  std::shared_ptr<Table> MakeTableWithHotData(int64_t num_rows) {
+    schema::Relation rel({types::DataType::INT64}, {"col1"});
+    auto table = std::make_shared<Table>("test_table", rel, 1024 * 1024, 64);
+    std::vector<types::Int64Value> col1(num_rows, 1);
+    auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+    rb_wrapper->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(col1, arrow::default_memory_pool())));
+    PX_CHECK_OK(table->TransferRecordBatch(std::move(rb_wrapper)));
+    return table;
+  }
+};
+
+TEST_F(CompactionSchedulerTest, run_round_compacts_all_tables) {
+  CompactionScheduler scheduler(arrow::default_memory_pool());
+  auto table1 = MakeTableWithHotData(100);
+  auto table2 = MakeTableWithHotData(10);
+  scheduler.AddTable(table1);
+  scheduler.AddTable(table2);
+  // Adding a table twice doesn't compact it twice.
+  scheduler.AddTable(table1);
+  {
+    // Dropped tables are skipped.
+    auto dropped_table = MakeTableWithHotData(10);
+    scheduler.AddTable(dropped_table);
+  }
+
+  ASSERT_OK(scheduler.RunRound());
+  EXPECT_EQ(0, table1->GetTableStats().hot_bytes);
+  EXPECT_GT(table1->GetTableStats().compacted_batches, 0);
+  EXPECT_EQ(0, table2->GetTableStats().hot_bytes);
+  EXPECT_GT(table2->GetTableStats().compacted_batches, 0);
+}
+
+TEST_F(CompactionSchedulerTest, background_compaction) {
+  CompactionScheduler scheduler(arrow::default_memory_pool());
+  auto table = MakeTableWithHotData(100);
+  scheduler.AddTable(table);
+  scheduler.Start(std::chrono::milliseconds(1));
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (table->GetTableStats().hot_bytes > 0 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  scheduler.Stop();
+  EXPECT_EQ(0, table->GetTableStats().hot_bytes);
+}
+
+}  // namespace table_store
+}  // namespace px
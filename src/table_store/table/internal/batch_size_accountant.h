@@ -134,6 +134,12 @@ class BatchSizeAccountant {
    * into the cold store via CompactedBatchSpec.
    */
   uint64_t FinishCompactedBatch();
+  /**
+   * FinishCompactedBatch is the same as above, for a compacted batch that takes cold_batch_bytes
+   * in the cold store (eg. because some of its columns were dictionary encoded), rather than the
+   * bytes of its hot slices.
+   */
+  uint64_t FinishCompactedBatch(uint64_t cold_batch_bytes);
   /**
    * @return the number of bytes stored in the hot store.
    */
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/internal/column_encodings.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/schema/row_batch.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+using types::DataType;
+
+namespace {
+
+void PutVarint(uint64_t val, std::vector<uint8_t>* data) {
+  while (val >= 0x80) {
+    data->push_back(static_cast<uint8_t>(val) | 0x80);
+    val >>= 7;
+  }
+  data->push_back(static_cast<uint8_t>(val));
+}
+
+uint64_t GetVarint(const uint8_t** pos) {
+  uint64_t val = 0;
+  for (int shift = 0;; shift += 7) {
+    uint8_t byte = *(*pos)++;
+    val |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return val;
+    }
+  }
+}
+
+// Deltas are computed with unsigned arithmetic, where overflow wraps around instead of being
+// undefined. The zigzag encoding maps small negative values to small unsigned values.
+uint64_t ZigZagEncode(uint64_t val) {
+  return (val << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(val) >> 63);
+}
+
+uint64_t ZigZagDecode(uint64_t val) { return (val >> 1) ^ (~(val & 1) + 1); }
+
+}  // namespace
+
+std::unique_ptr<DeltaEncodedColumn> DeltaEncodedColumn::Encode(DataType data_type,
+                                                               const arrow::Array& col) {
+  DCHECK(data_type == DataType::INT64 || data_type == DataType::TIME64NS);
+  auto encoded = std::unique_ptr<DeltaEncodedColumn>(new DeltaEncodedColumn(data_type));
+  encoded->length_ = col.length();
+  encoded->blocks_.reserve((col.length() + kBlockSize - 1) / kBlockSize);
+  encoded->data_.reserve(col.length());
+
+  // INT64 and TIME64NS arrays share their layout.
+  const auto* values = col.data()->GetValues<int64_t>(1);
+  uint64_t prev = 0;
+  uint64_t prev_delta = 0;
+  for (int64_t i = 0; i < col.length(); ++i) {
+    auto val = static_cast<uint64_t>(values[i]);
+    if (i % kBlockSize == 0) {
+      encoded->blocks_.push_back({values[i], static_cast<int64_t>(encoded->data_.size())});
+      prev_delta = 0;
+    } else {
+      uint64_t delta = val - prev;
+      PutVarint(ZigZagEncode(delta - prev_delta), &encoded->data_);
+      prev_delta = delta;
+    }
+    prev = val;
+  }
+
+  if (encoded->Bytes() >= static_cast<int64_t>(col.length() * sizeof(int64_t))) {
+    return nullptr;
+  }
+  encoded->data_.shrink_to_fit();
+  return encoded;
+}
+
+int64_t DeltaEncodedColumn::Bytes() const {
+  return data_.size() + blocks_.size() * sizeof(Block);
+}
+
+template <DataType T>
+StatusOr<std::shared_ptr<arrow::Array>> DeltaEncodedColumn::DecodeAs(
+    int64_t offset, int64_t length, arrow::MemoryPool* mem_pool) const {
+  auto builder = types::MakeArrowBuilder(T, mem_pool);
+  PX_RETURN_IF_ERROR(builder->Reserve(length));
+
+  const uint8_t* pos = nullptr;
+  uint64_t val = 0;
+  uint64_t delta = 0;
+  for (int64_t row = offset - offset % kBlockSize; row < offset + length; ++row) {
+    if (row % kBlockSize == 0) {
+      const auto& block = blocks_[row / kBlockSize];
+      val = static_cast<uint64_t>(block.first_value);
+      delta = 0;
+      pos = data_.data() + block.data_offset;
+    } else {
+      delta += ZigZagDecode(GetVarint(&pos));
+      val += delta;
+    }
+    if (row >= offset) {
+      PX_RETURN_IF_ERROR(schema::CopyValue<T>(builder.get(), static_cast<int64_t>(val)));
+    }
+  }
+  std::shared_ptr<arrow::Array> out;
+  PX_RETURN_IF_ERROR(builder->Finish(&out));
+  return out;
+}
+
+StatusOr<std::shared_ptr<arrow::Array>> DeltaEncodedColumn::Decode(
+    int64_t offset, int64_t length, arrow::MemoryPool* mem_pool) const {
+  DCHECK_LE(offset + length, length_);
+  if (data_type_ == DataType::TIME64NS) {
+    return DecodeAs<DataType::TIME64NS>(offset, length, mem_pool);
+  }
+  return DecodeAs<DataType::INT64>(offset, length, mem_pool);
+}
+
+std::unique_ptr<RunLengthEncodedUInt128Column> RunLengthEncodedUInt128Column::Encode(
+    const arrow::Array& col) {
+  DCHECK_EQ(col.type_id(), arrow::Type::UINT128);
+  auto encoded =
+      std::unique_ptr<RunLengthEncodedUInt128Column>(new RunLengthEncodedUInt128Column());
+  for (int64_t i = 0; i < col.length(); ++i) {
+    auto val = types::GetValueFromArrowArray<DataType::UINT128>(&col, i);
+    if (encoded->values_.empty() || encoded->values_.back() != val) {
+      encoded->values_.push_back(val);
+      encoded->run_ends_.push_back(i + 1);
+    } else {
+      encoded->run_ends_.back() = i + 1;
+    }
+  }
+
+  if (encoded->Bytes() >= static_cast<int64_t>(col.length() * sizeof(absl::uint128))) {
+    return nullptr;
+  }
+  encoded->values_.shrink_to_fit();
+  encoded->run_ends_.shrink_to_fit();
+  return encoded;
+}
+
+int64_t RunLengthEncodedUInt128Column::Bytes() const {
+  return values_.size() * sizeof(absl::uint128) + run_ends_.size() * sizeof(int64_t);
+}
+
+StatusOr<std::shared_ptr<arrow::Array>> RunLengthEncodedUInt128Column::Decode(
+    int64_t offset, int64_t length, arrow::MemoryPool* mem_pool) const {
+  DCHECK_LE(offset + length, this->length());
+  auto builder = types::MakeArrowBuilder(DataType::UINT128, mem_pool);
+  PX_RETURN_IF_ERROR(builder->Reserve(length));
+
+  // The first run that ends after offset.
+  size_t run = std::upper_bound(run_ends_.begin(), run_ends_.end(), offset) - run_ends_.begin();
+  for (int64_t row = offset; row < offset + length; ++row) {
+    if (row >= run_ends_[run]) {
+      ++run;
+    }
+    PX_RETURN_IF_ERROR(schema::CopyValue<DataType::UINT128>(builder.get(), values_[run]));
+  }
+  std::shared_ptr<arrow::Array> out;
+  PX_RETURN_IF_ERROR(builder->Finish(&out));
+  return out;
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
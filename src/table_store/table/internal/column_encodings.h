@@ -0,0 +1,104 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <memory>
+#include <vector>
+
+#include <absl/numeric/int128.h>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/table/internal/encoded_column.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * DeltaEncodedColumn holds an INT64 or TIME64NS column as the varint encoded (zigzagged)
+ * differences between the consecutive deltas of its values. Timestamps and counters, whose
+ * deltas hardly change, take about a byte per row this way. The absolute value is kept every
+ * kBlockSize rows, so that decoding a slice doesn't require decoding from the start.
+ */
+class DeltaEncodedColumn : public EncodedColumn {
+ public:
+  static constexpr int64_t kBlockSize = 128;
+
+  /**
+   * Encode delta encodes the given column.
+   * @return the encoded column, or nullptr when encoding it wouldn't save any memory.
+   */
+  static std::unique_ptr<DeltaEncodedColumn> Encode(types::DataType data_type,
+                                                    const arrow::Array& col);
+
+  int64_t length() const override { return length_; }
+  int64_t Bytes() const override;
+  StatusOr<std::shared_ptr<arrow::Array>> Decode(int64_t offset, int64_t length,
+                                                 arrow::MemoryPool* mem_pool) const override;
+
+ private:
+  struct Block {
+    int64_t first_value;
+    // The offset in data_ of the first encoded delta of the block.
+    int64_t data_offset;
+  };
+  explicit DeltaEncodedColumn(types::DataType data_type) : data_type_(data_type) {}
+
+  template <types::DataType T>
+  StatusOr<std::shared_ptr<arrow::Array>> DecodeAs(int64_t offset, int64_t length,
+                                                   arrow::MemoryPool* mem_pool) const;
+
+  types::DataType data_type_;
+  int64_t length_ = 0;
+  std::vector<Block> blocks_;
+  std::vector<uint8_t> data_;
+};
+
+/**
+ * RunLengthEncodedUInt128Column holds a UINT128 column, such as a upid, as runs of equal values.
+ * Records from the same process tend to arrive together, so the runs are long.
+ */
+class RunLengthEncodedUInt128Column : public EncodedColumn {
+ public:
+  /**
+   * Encode run length encodes the given column.
+   * @return the encoded column, or nullptr when encoding it wouldn't save any memory.
+   */
+  static std::unique_ptr<RunLengthEncodedUInt128Column> Encode(const arrow::Array& col);
+
+  int64_t length() const override { return run_ends_.empty() ? 0 : run_ends_.back(); }
+  int64_t Bytes() const override;
+  StatusOr<std::shared_ptr<arrow::Array>> Decode(int64_t offset, int64_t length,
+                                                 arrow::MemoryPool* mem_pool) const override;
+
+ private:
+  RunLengthEncodedUInt128Column() = default;
+
+  std::vector<absl::uint128> values_;
+  // The (exclusive) end row of each run.
+  std::vector<int64_t> run_ends_;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/internal/column_encodings.h"
+
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+TEST(DeltaEncodedColumnTest, round_trip) {
+  std::vector<types::Time64NSValue> vals;
+  int64_t time = 1'600'000'000'000'000'000;
+  for (int i = 0; i < 1000; ++i) {
+    time += 1'000'000 + (i % 7) * 1000;
+    vals.push_back(time);
+  }
+  auto col = types::ToArrow(vals, arrow::default_memory_pool());
+
+  auto encoded = DeltaEncodedColumn::Encode(types::DataType::TIME64NS, *col);
+  ASSERT_NE(nullptr, encoded);
+  EXPECT_EQ(1000, encoded->length());
+  EXPECT_LT(encoded->Bytes(), 1000 * 8 / 2);
+
+  ASSERT_OK_AND_ASSIGN(auto decoded, encoded->Decode(0, 1000, arrow::default_memory_pool()));
+  EXPECT_TRUE(decoded->Equals(col));
+  // Slices starting in the middle of a block, and spanning blocks.
+  for (auto [offset, length] : std::vector<std::pair<int64_t, int64_t>>{
+           {0, 1}, {127, 2}, {128, 128}, {300, 500}, {999, 1}}) {
+    ASSERT_OK_AND_ASSIGN(auto slice,
+                         encoded->Decode(offset, length, arrow::default_memory_pool()));
+    EXPECT_TRUE(slice->Equals(col->Slice(offset, length)));
+  }
+}
+
+TEST(DeltaEncodedColumnTest, extreme_values) {
+  std::vector<types::Int64Value> vals;
+  for (int i = 0; i < 200; ++i) {
+    vals.push_back(i % 2 ? std::numeric_limits<int64_t>::max()
+                         : std::numeric_limits<int64_t>::min());
+  }
+  vals.push_back(0);
+  auto col = types::ToArrow(vals, arrow::default_memory_pool());
+
+  // The deltas are too large to save any memory.
+  EXPECT_EQ(nullptr, DeltaEncodedColumn::Encode(types::DataType::INT64, *col));
+}
+
+TEST(DeltaEncodedColumnTest, constant_column) {
+  std::vector<types::Int64Value> vals(500, -42);
+  auto col = types::ToArrow(vals, arrow::default_memory_pool());
+
+  auto encoded = DeltaEncodedColumn::Encode(types::DataType::INT64, *col);
+  ASSERT_NE(nullptr, encoded);
+  ASSERT_OK_AND_ASSIGN(auto decoded, encoded->Decode(0, 500, arrow::default_memory_pool()));
+  EXPECT_TRUE(decoded->Equals(col));
+}
+
+TEST(RunLengthEncodedUInt128ColumnTest, round_trip) {
+  std::vector<types::UInt128Value> vals;
+  for (int i = 0; i < 300; ++i) {
+    vals.push_back(types::UInt128Value(i / 100, 1234));
+  }
+  auto col = types::ToArrow(vals, arrow::default_memory_pool());
+
+  auto encoded = RunLengthEncodedUInt128Column::Encode(*col);
+  ASSERT_NE(nullptr, encoded);
+  EXPECT_EQ(300, encoded->length());
+  EXPECT_LT(encoded->Bytes(), 100);
+
+  ASSERT_OK_AND_ASSIGN(auto decoded, encoded->Decode(0, 300, arrow::default_memory_pool()));
+  EXPECT_TRUE(decoded->Equals(col));
+  ASSERT_OK_AND_ASSIGN(auto slice, encoded->Decode(99, 102, arrow::default_memory_pool()));
+  EXPECT_TRUE(slice->Equals(col->Slice(99, 102)));
+}
+
+TEST(RunLengthEncodedUInt128ColumnTest, short_runs) {
+  std::vector<types::UInt128Value> vals;
+  for (int i = 0; i < 100; ++i) {
+    vals.push_back(types::UInt128Value(i, 1234));
+  }
+  auto col = types::ToArrow(vals, arrow::default_memory_pool());
+  EXPECT_EQ(nullptr, RunLengthEncodedUInt128Column::Encode(*col));
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/internal/decoded_column_cache.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+// The memory held by the buffers of the array, including those of its children (e.g. the
+// dictionary of a dictionary array).
+int64_t ArrayDataBytes(const arrow::ArrayData& data) {
+  int64_t bytes = 0;
+  for (const auto& buffer : data.buffers) {
+    if (buffer != nullptr) {
+      bytes += buffer->capacity();
+    }
+  }
+  for (const auto& child : data.child_data) {
+    bytes += ArrayDataBytes(*child);
+  }
+  if (data.dictionary != nullptr) {
+    bytes += ArrayDataBytes(*data.dictionary);
+  }
+  return bytes;
+}
+
+}  // namespace
+
+ArrowArrayPtr DecodedColumnCache::Get(const Key& key) {
+  absl::MutexLock lock(&lock_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    ++misses_;
+    return nullptr;
+  }
+  ++hits_;
+  lru_.splice(lru_.begin(), lru_, it->second.lru_it);
+  return it->second.decoded;
+}
+
+void DecodedColumnCache::Put(const Key& key, ArrowArrayPtr decoded) {
+  int64_t bytes = ArrayDataBytes(*decoded->data());
+  absl::MutexLock lock(&lock_);
+  if (bytes > capacity_bytes_) {
+    return;
+  }
+  EraseUnlocked(key);
+  EvictUnlocked(capacity_bytes_ - bytes);
+  lru_.push_front(key);
+  entries_.emplace(key, Entry{std::move(decoded), bytes, lru_.begin()});
+  size_bytes_ += bytes;
+}
+
+void DecodedColumnCache::EraseBatch(int64_t table_id, RowID batch_first_row_id,
+                                    int64_t num_cols) {
+  absl::MutexLock lock(&lock_);
+  if (entries_.empty()) {
+    return;
+  }
+  for (int64_t col_idx = 0; col_idx < num_cols; ++col_idx) {
+    EraseUnlocked(Key{table_id, batch_first_row_id, col_idx});
+  }
+}
+
+void DecodedColumnCache::SetCapacity(int64_t capacity_bytes) {
+  absl::MutexLock lock(&lock_);
+  capacity_bytes_ = capacity_bytes;
+  EvictUnlocked(std::max<int64_t>(capacity_bytes, 0));
+}
+
+int64_t DecodedColumnCache::capacity_bytes() const {
+  absl::MutexLock lock(&lock_);
+  return capacity_bytes_;
+}
+
+int64_t DecodedColumnCache::size_bytes() const {
+  absl::MutexLock lock(&lock_);
+  return size_bytes_;
+}
+
+int64_t DecodedColumnCache::hits() const {
+  absl::MutexLock lock(&lock_);
+  return hits_;
+}
+
+int64_t DecodedColumnCache::misses() const {
+  absl::MutexLock lock(&lock_);
+  return misses_;
+}
+
+void DecodedColumnCache::EvictUnlocked(int64_t capacity_bytes) {
+  while (size_bytes_ > capacity_bytes && !lru_.empty()) {
+    Key key = lru_.back();
+    EraseUnlocked(key);
+  }
+}
+
+void DecodedColumnCache::EraseUnlocked(const Key& key) {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return;
+  }
+  size_bytes_ -= it->second.bytes;
+  lru_.erase(it->second.lru_it);
+  entries_.erase(it);
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <utility>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/common/base/base.h"
+#include "src/table_store/table/internal/types.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * DecodedColumnCache keeps the decoded arrays of encoded cold batch columns, shared by all of the
+ * tables of a table store, so that repeated scans of the same columns (e.g. a live view refreshing
+ * over time_ and upid) don't decode them every time.
+ *
+ * Entries are keyed by the table, the first row ID of the cold batch and the column. Row IDs are
+ * never reused within a table, and cold batches don't change once compacted, so an entry is valid
+ * for as long as its batch is in the cold store. The cold store erases the entries of the batches
+ * that leave it. The least recently used entries are evicted to keep the cache within its capacity.
+ */
+class DecodedColumnCache : public NotCopyMoveable {
+ public:
+  struct Key {
+    bool operator==(const Key& other) const {
+      return table_id == other.table_id && batch_first_row_id == other.batch_first_row_id &&
+             col_idx == other.col_idx;
+    }
+
+    template <typename H>
+    friend H AbslHashValue(H h, const Key& k) {
+      return H::combine(std::move(h), k.table_id, k.batch_first_row_id, k.col_idx);
+    }
+
+    int64_t table_id;
+    RowID batch_first_row_id;
+    int64_t col_idx;
+  };
+
+  /**
+   * @param capacity_bytes the number of bytes of decoded arrays the cache can hold. The cache is
+   * disabled if it isn't positive.
+   */
+  explicit DecodedColumnCache(int64_t capacity_bytes) : capacity_bytes_(capacity_bytes) {}
+
+  /**
+   * Returns an ID for a new table, which is used in the keys of its entries.
+   */
+  int64_t NewTableID() { return next_table_id_++; }
+
+  /**
+   * Returns the decoded array of the given key, or nullptr if it isn't cached.
+   */
+  ArrowArrayPtr Get(const Key& key);
+
+  /**
+   * Caches the decoded array of the given key, evicting the least recently used entries to make
+   * room for it. Arrays larger than the whole capacity aren't cached.
+   */
+  void Put(const Key& key, ArrowArrayPtr decoded);
+
+  /**
+   * Erases the entries of the given cold batch of a table, for all of its num_cols columns.
+   */
+  void EraseBatch(int64_t table_id, RowID batch_first_row_id, int64_t num_cols);
+
+  /**
+   * Changes the capacity, evicting entries if the cache holds more than the new capacity.
+   */
+  void SetCapacity(int64_t capacity_bytes);
+
+  int64_t capacity_bytes() const;
+  int64_t size_bytes() const;
+  int64_t hits() const;
+  int64_t misses() const;
+
+ private:
+  struct Entry {
+    ArrowArrayPtr decoded;
+    int64_t bytes;
+    // Position of the key in lru_.
+    std::list<Key>::iterator lru_it;
+  };
+
+  void EvictUnlocked(int64_t capacity_bytes) ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void EraseUnlocked(const Key& key) ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  std::atomic<int64_t> next_table_id_ = 0;
+
+  mutable absl::Mutex lock_;
+  int64_t capacity_bytes_ ABSL_GUARDED_BY(lock_);
+  int64_t size_bytes_ ABSL_GUARDED_BY(lock_) = 0;
+  int64_t hits_ ABSL_GUARDED_BY(lock_) = 0;
+  int64_t misses_ ABSL_GUARDED_BY(lock_) = 0;
+  absl::flat_hash_map<Key, Entry> entries_ ABSL_GUARDED_BY(lock_);
+  // Most recently used first.
+  std::list<Key> lru_ ABSL_GUARDED_BY(lock_);
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
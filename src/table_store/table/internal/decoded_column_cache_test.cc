@@ -0,0 +1,103 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/internal/decoded_column_cache.h"
+
+#include <memory>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+ArrowArrayPtr Int64Array(int64_t val) {
+  std::vector<types::Int64Value> vals(100, val);
+  return types::ToArrow(vals, arrow::default_memory_pool());
+}
+
+}  // namespace
+
+TEST(DecodedColumnCacheTest, get_put) {
+  DecodedColumnCache cache(1024 * 1024);
+  DecodedColumnCache::Key key{cache.NewTableID(), 0, 1};
+
+  EXPECT_EQ(cache.Get(key), nullptr);
+  auto arr = Int64Array(1);
+  cache.Put(key, arr);
+  EXPECT_EQ(cache.Get(key), arr);
+  EXPECT_EQ(cache.Get(DecodedColumnCache::Key{key.table_id, 0, 0}), nullptr);
+  EXPECT_EQ(cache.Get(DecodedColumnCache::Key{key.table_id + 1, 0, 1}), nullptr);
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_EQ(cache.misses(), 3);
+  EXPECT_GE(cache.size_bytes(), static_cast<int64_t>(100 * sizeof(int64_t)));
+}
+
+TEST(DecodedColumnCacheTest, evicts_least_recently_used) {
+  DecodedColumnCache cache(1024 * 1024);
+  int64_t table_id = cache.NewTableID();
+  DecodedColumnCache::Key key0{table_id, 0, 0};
+  DecodedColumnCache::Key key1{table_id, 100, 0};
+  DecodedColumnCache::Key key2{table_id, 200, 0};
+
+  cache.Put(key0, Int64Array(0));
+  int64_t entry_bytes = cache.size_bytes();
+  cache.SetCapacity(2 * entry_bytes);
+  cache.Put(key1, Int64Array(1));
+  // Makes key1 the least recently used entry.
+  EXPECT_NE(cache.Get(key0), nullptr);
+  cache.Put(key2, Int64Array(2));
+
+  EXPECT_NE(cache.Get(key0), nullptr);
+  EXPECT_EQ(cache.Get(key1), nullptr);
+  EXPECT_NE(cache.Get(key2), nullptr);
+  EXPECT_EQ(cache.size_bytes(), 2 * entry_bytes);
+
+  cache.SetCapacity(entry_bytes);
+  EXPECT_EQ(cache.Get(key0), nullptr);
+  EXPECT_EQ(cache.size_bytes(), entry_bytes);
+
+  // Entries that don't fit at all aren't cached.
+  cache.SetCapacity(0);
+  cache.Put(key0, Int64Array(0));
+  EXPECT_EQ(cache.Get(key0), nullptr);
+  EXPECT_EQ(cache.size_bytes(), 0);
+}
+
+TEST(DecodedColumnCacheTest, erase_batch) {
+  DecodedColumnCache cache(1024 * 1024);
+  int64_t table_id = cache.NewTableID();
+  for (int64_t col_idx = 0; col_idx < 3; ++col_idx) {
+    cache.Put(DecodedColumnCache::Key{table_id, 0, col_idx}, Int64Array(col_idx));
+    cache.Put(DecodedColumnCache::Key{table_id, 100, col_idx}, Int64Array(col_idx));
+  }
+
+  cache.EraseBatch(table_id, 0, 3);
+  for (int64_t col_idx = 0; col_idx < 3; ++col_idx) {
+    EXPECT_EQ(cache.Get(DecodedColumnCache::Key{table_id, 0, col_idx}), nullptr);
+    EXPECT_NE(cache.Get(DecodedColumnCache::Key{table_id, 100, col_idx}), nullptr);
+  }
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
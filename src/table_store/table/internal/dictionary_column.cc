@@ -0,0 +1,97 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/internal/dictionary_column.h"
+
+#include <arrow/builder.h>
+
+#include <algorithm>
+#include <utility>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+std::unique_ptr<DictionaryEncodedStringColumn> DictionaryEncodedStringColumn::Encode(
+    const arrow::Array& col, size_t max_dictionary_size) {
+  DCHECK_EQ(col.type_id(), arrow::Type::STRING);
+  max_dictionary_size = std::min(max_dictionary_size, kMaxDictionarySize);
+
+  auto encoded =
+      std::unique_ptr<DictionaryEncodedStringColumn>(new DictionaryEncodedStringColumn());
+  encoded->codes_.reserve(col.length());
+  absl::flat_hash_map<std::string, Code> codes;
+  for (int64_t i = 0; i < col.length(); ++i) {
+    auto val = types::GetValueFromArrowArray<types::DataType::STRING>(&col, i);
+    auto it = codes.find(val);
+    if (it == codes.end()) {
+      if (encoded->dictionary_.size() == max_dictionary_size) {
+        return nullptr;
+      }
+      it = codes.emplace(val, encoded->dictionary_.size()).first;
+      encoded->dictionary_.push_back(std::move(val));
+    }
+    encoded->codes_.push_back(it->second);
+  }
+
+  if (encoded->Bytes() >= PlainBytes(col)) {
+    return nullptr;
+  }
+  encoded->codes_.shrink_to_fit();
+  return encoded;
+}
+
+int64_t DictionaryEncodedStringColumn::PlainBytes(const arrow::Array& col) {
+  return types::GetArrowArrayBytes<types::DataType::STRING>(&col) + col.length() * sizeof(int32_t);
+}
+
+int64_t DictionaryEncodedStringColumn::Bytes() const {
+  int64_t bytes = codes_.size() * sizeof(Code);
+  for (const auto& val : dictionary_) {
+    bytes += sizeof(std::string) + val.size();
+  }
+  return bytes;
+}
+
+StatusOr<std::shared_ptr<arrow::Array>> DictionaryEncodedStringColumn::Decode(
+    int64_t offset, int64_t length, arrow::MemoryPool* mem_pool) const {
+  DCHECK_LE(offset + length, this->length());
+  int64_t data_bytes = 0;
+  for (int64_t i = offset; i < offset + length; ++i) {
+    data_bytes += dictionary_[codes_[i]].size();
+  }
+
+  arrow::StringBuilder builder(mem_pool);
+  PX_RETURN_IF_ERROR(builder.Reserve(length));
+  PX_RETURN_IF_ERROR(builder.ReserveData(data_bytes));
+  for (int64_t i = offset; i < offset + length; ++i) {
+    builder.UnsafeAppend(dictionary_[codes_[i]]);
+  }
+  std::shared_ptr<arrow::Array> out;
+  PX_RETURN_IF_ERROR(builder.Finish(&out));
+  return out;
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/table_store/table/internal/encoded_column.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * DictionaryEncodedStringColumn holds a string column as the list of its distinct values, and the
+ * index of the value of each row in that list. Low cardinality columns, such as HTTP methods,
+ * request paths or pod names, take a fraction of the memory of an arrow::StringArray this way.
+ */
+class DictionaryEncodedStringColumn : public EncodedColumn {
+ public:
+  using Code = uint16_t;
+  static constexpr size_t kMaxDictionarySize = std::numeric_limits<Code>::max() + 1;
+
+  /**
+   * Encode dictionary encodes the given string column.
+   * @param col the arrow::StringArray to encode.
+   * @param max_dictionary_size the maximum number of distinct values to encode.
+   * @return the encoded column, or nullptr when the column has more distinct values than
+   * max_dictionary_size or encoding it wouldn't save any memory.
+   */
+  static std::unique_ptr<DictionaryEncodedStringColumn> Encode(const arrow::Array& col,
+                                                               size_t max_dictionary_size);
+
+  /**
+   * PlainBytes returns the memory held by the given (plain) string column, as accounted for by the
+   * table store: the string data and an offset per row.
+   */
+  static int64_t PlainBytes(const arrow::Array& col);
+
+  int64_t length() const override { return codes_.size(); }
+  size_t dictionary_size() const { return dictionary_.size(); }
+
+  int64_t Bytes() const override;
+  StatusOr<std::shared_ptr<arrow::Array>> Decode(int64_t offset, int64_t length,
+                                                 arrow::MemoryPool* mem_pool) const override;
+
+ private:
+  std::vector<std::string> dictionary_;
+  std::vector<Code> codes_;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/internal/dictionary_column.h"
+
+#include <string>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+TEST(DictionaryEncodedStringColumnTest, round_trip) {
+  std::vector<types::StringValue> vals;
+  for (int i = 0; i < 100; ++i) {
+    vals.push_back(i % 2 ? "a longer string value" : "another string value");
+  }
+  auto col = types::ToArrow(vals, arrow::default_memory_pool());
+
+  auto encoded = DictionaryEncodedStringColumn::Encode(*col, 16);
+  ASSERT_NE(nullptr, encoded);
+  EXPECT_EQ(100, encoded->length());
+  EXPECT_EQ(2, encoded->dictionary_size());
+  EXPECT_LT(encoded->Bytes(), DictionaryEncodedStringColumn::PlainBytes(*col));
+
+  ASSERT_OK_AND_ASSIGN(auto decoded, encoded->Decode(0, 100, arrow::default_memory_pool()));
+  EXPECT_TRUE(decoded->Equals(col));
+  ASSERT_OK_AND_ASSIGN(auto slice, encoded->Decode(11, 20, arrow::default_memory_pool()));
+  EXPECT_TRUE(slice->Equals(col->Slice(11, 20)));
+}
+
+TEST(DictionaryEncodedStringColumnTest, high_cardinality) {
+  std::vector<types::StringValue> vals;
+  for (int i = 0; i < 100; ++i) {
+    vals.push_back(absl::StrCat("a string value ", i));
+  }
+  auto col = types::ToArrow(vals, arrow::default_memory_pool());
+  EXPECT_EQ(nullptr, DictionaryEncodedStringColumn::Encode(*col, 16));
+}
+
+TEST(DictionaryEncodedStringColumnTest, no_savings) {
+  std::vector<types::StringValue> vals = {"a", "b", "c"};
+  auto col = types::ToArrow(vals, arrow::default_memory_pool());
+  EXPECT_EQ(nullptr, DictionaryEncodedStringColumn::Encode(*col, 16));
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
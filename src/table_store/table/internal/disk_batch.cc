@@ -0,0 +1,139 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/internal/disk_batch.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <absl/strings/substitute.h>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/schema/row_batch.h"
+#include "src/table_store/schemapb/schema.pb.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+StatusOr<std::shared_ptr<DiskSegment>> DiskSegment::Create(const std::string& dir) {
+  std::string path = absl::Substitute("$0/table_store_segment_XXXXXX", dir);
+  int fd = mkstemp(path.data());
+  if (fd < 0) {
+    return error::Internal("Failed to create table store segment in $0: $1", dir,
+                           std::strerror(errno));
+  }
+  // The file stays usable through the open descriptor.
+  unlink(path.c_str());
+  return std::shared_ptr<DiskSegment>(new DiskSegment(fd));
+}
+
+DiskSegment::~DiskSegment() { close(fd_); }
+
+StatusOr<int64_t> DiskSegment::Append(std::string_view data) {
+  int64_t offset = size_;
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t n = pwrite(fd_, data.data() + written, data.size() - written, offset + written);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return error::Internal("Failed to write table store segment: $0", std::strerror(errno));
+    }
+    written += n;
+  }
+  size_ += data.size();
+  return offset;
+}
+
+Status DiskSegment::Read(int64_t offset, int64_t size, std::string* out) const {
+  out->resize(size);
+  int64_t read = 0;
+  while (read < size) {
+    ssize_t n = pread(fd_, out->data() + read, size - read, offset + read);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return error::Internal("Failed to read table store segment: $0", std::strerror(errno));
+    }
+    if (n == 0) {
+      return error::Internal("Truncated table store segment");
+    }
+    read += n;
+  }
+  return Status::OK();
+}
+
+StatusOr<DiskBatch> DiskBatch::Write(const ColdBatch& batch,
+                                     const std::vector<types::DataType>& col_types,
+                                     int64_t time_col_idx, std::shared_ptr<DiskSegment> segment) {
+  DiskBatch disk_batch;
+  disk_batch.length = batch.Length();
+  disk_batch.zone_maps = batch.zone_maps;
+  std::string buf;
+  for (size_t col_idx = 0; col_idx < col_types.size(); ++col_idx) {
+    auto col = batch.PlainColumn(col_idx);
+    if (static_cast<int64_t>(col_idx) == time_col_idx) {
+      disk_batch.first_time =
+          types::GetValueFromArrowArray<types::DataType::TIME64NS>(col.get(), 0);
+      disk_batch.last_time = types::GetValueFromArrowArray<types::DataType::TIME64NS>(
+          col.get(), disk_batch.length - 1);
+    }
+    schema::RowBatch rb(schema::RowDescriptor({col_types[col_idx]}), disk_batch.length);
+    PX_RETURN_IF_ERROR(rb.AddColumn(col));
+    schemapb::RowBatchData proto;
+    PX_RETURN_IF_ERROR(rb.ToProto(&proto));
+    if (!proto.SerializeToString(&buf)) {
+      return error::Internal("Failed to serialize table store column");
+    }
+    PX_ASSIGN_OR_RETURN(auto offset, segment->Append(buf));
+    disk_batch.column_extents.push_back({offset, static_cast<int64_t>(buf.size())});
+  }
+  disk_batch.segment = std::move(segment);
+  return disk_batch;
+}
+
+int64_t DiskBatch::Bytes() const {
+  int64_t bytes = 0;
+  for (const auto& extent : column_extents) {
+    bytes += extent.size;
+  }
+  return bytes;
+}
+
+StatusOr<ArrowArrayPtr> DiskBatch::ReadColumn(int64_t col_idx) const {
+  DCHECK_LT(col_idx, static_cast<int64_t>(column_extents.size()));
+  const auto& extent = column_extents[col_idx];
+  std::string buf;
+  PX_RETURN_IF_ERROR(segment->Read(extent.offset, extent.size, &buf));
+  schemapb::RowBatchData proto;
+  if (!proto.ParseFromString(buf)) {
+    return error::Internal("Failed to parse table store column");
+  }
+  PX_ASSIGN_OR_RETURN(auto rb, schema::RowBatch::FromProto(proto));
+  return rb->ColumnAt(0);
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/table/internal/types.h"
+#include "src/table_store/table/internal/zone_map.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * DiskSegment is an append only file on local disk that the disk tier of a table writes its
+ * batches to. The file is unlinked right after it's created, so it's removed once the segment is
+ * destroyed, which happens once every batch that refers to it has expired.
+ *
+ * Appends must be serialized by the caller. Reads of ranges that were already appended are safe
+ * to run concurrently with appends.
+ */
+class DiskSegment : public NotCopyable {
+ public:
+  static StatusOr<std::shared_ptr<DiskSegment>> Create(const std::string& dir);
+  ~DiskSegment();
+
+  /**
+   * Appends the given data to the end of the segment.
+   * @return the offset in the segment that the data was written to.
+   */
+  StatusOr<int64_t> Append(std::string_view data);
+
+  /**
+   * Reads size bytes at the given offset of the segment into out.
+   */
+  Status Read(int64_t offset, int64_t size, std::string* out) const;
+
+  int64_t size() const { return size_; }
+
+ private:
+  explicit DiskSegment(int fd) : fd_(fd) {}
+
+  int fd_;
+  int64_t size_ = 0;
+};
+
+/**
+ * DiskBatch is a batch of the disk tier, i.e. a cold batch that expired out of memory and was
+ * written to a DiskSegment. Each column is stored on its own, so that reads only have to load the
+ * columns they project. The zone maps of the cold batch are kept in memory.
+ */
+struct DiskBatch {
+  struct ColumnExtent {
+    int64_t offset;
+    int64_t size;
+  };
+
+  /**
+   * Write writes the columns of the given cold batch to the end of the segment.
+   * @param time_col_idx index of the time column of the batch or -1 if there is none.
+   */
+  static StatusOr<DiskBatch> Write(const ColdBatch& batch,
+                                   const std::vector<types::DataType>& col_types,
+                                   int64_t time_col_idx, std::shared_ptr<DiskSegment> segment);
+
+  int64_t Length() const { return length; }
+
+  // The bytes the batch takes on disk.
+  int64_t Bytes() const;
+
+  StatusOr<ArrowArrayPtr> ReadColumn(int64_t col_idx) const;
+
+  std::shared_ptr<DiskSegment> segment;
+  std::vector<ColumnExtent> column_extents;
+  int64_t length = 0;
+  // The first and last values of the time column, if there is one.
+  Time first_time = -1;
+  Time last_time = -1;
+  std::vector<std::shared_ptr<const ColumnZoneMap>> zone_maps;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <memory>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * EncodedColumn is a column of a cold batch held in a more compact form than an arrow::Array. It
+ * is decoded back into an arrow::Array for the rows that are read.
+ */
+class EncodedColumn {
+ public:
+  virtual ~EncodedColumn() = default;
+
+  virtual int64_t length() const = 0;
+
+  /**
+   * Bytes returns the memory held by the encoded column.
+   */
+  virtual int64_t Bytes() const = 0;
+
+  /**
+   * Decode decodes the rows [offset, offset + length) of the column into an arrow::Array.
+   */
+  virtual StatusOr<std::shared_ptr<arrow::Array>> Decode(int64_t offset, int64_t length,
+                                                         arrow::MemoryPool* mem_pool) const = 0;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
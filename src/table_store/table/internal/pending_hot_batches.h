@@ -0,0 +1,97 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/table_store/table/internal/batch_size_accountant.h"
+#include "src/table_store/table/internal/record_or_row_batch.h"
+#include "src/table_store/table/internal/zone_map.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * PendingHotBatches holds the batches written to a table that haven't been published to its hot
+ * store yet. Writers push batches without taking any lock, and whichever thread next holds the hot
+ * lock of the table moves them into the hot store, in the order they were pushed. This way a write
+ * never has to wait for a reader to release the hot lock.
+ *
+ * Push is safe to call from any number of threads. TakeAll must only be called by one thread at a
+ * time.
+ */
+class PendingHotBatches : public NotCopyable {
+ public:
+  struct Batch {
+    RecordOrRowBatch batch;
+    BatchSizeAccountant::BatchStats stats;
+    // The distinct values of each of the indexed columns of the table, if any.
+    std::vector<std::vector<ZoneMapValue>> index_values;
+  };
+
+  PendingHotBatches() = default;
+  ~PendingHotBatches() { TakeAll(); }
+
+  void Push(RecordOrRowBatch&& batch, BatchSizeAccountant::BatchStats&& stats,
+            std::vector<std::vector<ZoneMapValue>>&& index_values = {}) {
+    auto node =
+        new Node{Batch{std::move(batch), std::move(stats), std::move(index_values)}, nullptr};
+    node->next = head_.load(std::memory_order_relaxed);
+    while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+    }
+  }
+
+  bool Empty() const { return head_.load(std::memory_order_acquire) == nullptr; }
+
+  /**
+   * TakeAll removes every pending batch.
+   * @return the removed batches, in the order they were pushed.
+   */
+  std::vector<Batch> TakeAll() {
+    std::vector<Node*> nodes;
+    for (Node* node = head_.exchange(nullptr, std::memory_order_acquire); node != nullptr;
+         node = node->next) {
+      nodes.push_back(node);
+    }
+    std::vector<Batch> batches;
+    batches.reserve(nodes.size());
+    for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+      batches.push_back(std::move((*it)->batch));
+      delete *it;
+    }
+    return batches;
+  }
+
+ private:
+  // The pending batches are a stack, so that pushes are a single compare and swap of the head.
+  struct Node {
+    Batch batch;
+    Node* next;
+  };
+  std::atomic<Node*> head_ = nullptr;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <thread>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/schema/row_batch.h"
+#include "src/table_store/table/internal/pending_hot_batches.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+// Makes a batch with a single INT64 row holding value.
+RecordOrRowBatch MakeBatch(int64_t value) {
+  schema::RowBatch rb(schema::RowDescriptor({types::DataType::INT64}), 1);
+  PX_CHECK_OK(rb.AddColumn(
+      types::ToArrow(std::vector<types::Int64Value>{value}, arrow::default_memory_pool())));
+  return RecordOrRowBatch(rb);
+}
+
+int64_t BatchValue(const PendingHotBatches::Batch& batch) {
+  schema::RowBatch rb(schema::RowDescriptor({types::DataType::INT64}), 1);
+  PX_CHECK_OK(batch.batch.AddBatchSliceToRowBatch(0, 1, {0}, &rb));
+  return types::GetValueFromArrowArray<types::DataType::INT64>(rb.ColumnAt(0).get(), 0);
+}
+
+TEST(PendingHotBatchesTest, take_all_in_push_order) {
+  PendingHotBatches pending;
+  EXPECT_TRUE(pending.Empty());
+  for (int64_t i = 0; i < 3; ++i) {
+    BatchSizeAccountant::BatchStats stats;
+    stats.num_rows = 1;
+    pending.Push(MakeBatch(i), std::move(stats));
+  }
+  EXPECT_FALSE(pending.Empty());
+
+  auto batches = pending.TakeAll();
+  ASSERT_THAT(batches, ::testing::SizeIs(3));
+  for (int64_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(i, BatchValue(batches[i]));
+    EXPECT_EQ(1, batches[i].stats.num_rows);
+  }
+  EXPECT_TRUE(pending.Empty());
+  EXPECT_THAT(pending.TakeAll(), ::testing::IsEmpty());
+}
+
+TEST(PendingHotBatchesTest, concurrent_pushes) {
+  constexpr int kNumThreads = 4;
+  constexpr int64_t kBatchesPerThread = 1000;
+  PendingHotBatches pending;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&pending, t]() {
+      for (int64_t i = 0; i < kBatchesPerThread; ++i) {
+        pending.Push(MakeBatch(t * kBatchesPerThread + i), BatchSizeAccountant::BatchStats{});
+      }
+    });
+  }
+  std::vector<PendingHotBatches::Batch> batches;
+  while (static_cast<int64_t>(batches.size()) < kNumThreads * kBatchesPerThread) {
+    for (auto& batch : pending.TakeAll()) {
+      batches.push_back(std::move(batch));
+    }
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // The batches of each thread come out in the order that thread pushed them.
+  std::vector<int64_t> next_value(kNumThreads);
+  for (const auto& batch : batches) {
+    int64_t value = BatchValue(batch);
+    int64_t thread_idx = value / kBatchesPerThread;
+    EXPECT_EQ(next_value[thread_idx], value % kBatchesPerThread);
+    next_value[thread_idx]++;
+  }
+  EXPECT_TRUE(pending.Empty());
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
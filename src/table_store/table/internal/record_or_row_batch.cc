@@ -116,9 +116,9 @@ Status RecordOrRowBatch::AddBatchSliceToRowBatch(size_t row_start, size_t batch_
             for (auto col_idx : cols) {
               if (!record_batch_w_cache.cache_validity[col_idx]) {
                 // Arrow array wasn't in cache, convert it to arrow and then add
-                // to cache.
-                auto arr = (*record_batch_w_cache.record_batch)[col_idx]->ConvertToArrow(
-                    arrow::default_memory_pool());
+                // to cache. Hot batches aren't modified, so the values can be shared.
+                auto arr = types::ColumnWrapper::ShareAsArrow(
+                    (*record_batch_w_cache.record_batch)[col_idx], arrow::default_memory_pool());
                 record_batch_w_cache.arrow_cache[col_idx] = arr;
                 record_batch_w_cache.cache_validity[col_idx] = true;
               }
@@ -138,6 +138,29 @@ Status RecordOrRowBatch::AddBatchSliceToRowBatch(size_t row_start, size_t batch_
       batch_);
 }
 
+std::vector<ArrowArrayPtr> RecordOrRowBatch::ShareColumns() const {
+  std::vector<ArrowArrayPtr> columns;
+  std::visit(overloaded{
+                 [this, &columns](const RecordBatchWithCache& record_batch_w_cache) {
+                   const auto& record_batch = *record_batch_w_cache.record_batch;
+                   for (const auto& [col_idx, col] : Enumerate(record_batch)) {
+                     auto arr = record_batch_w_cache.cache_validity[col_idx]
+                                    ? record_batch_w_cache.arrow_cache[col_idx]
+                                    : types::ColumnWrapper::ShareAsArrow(
+                                          col, arrow::default_memory_pool());
+                     columns.push_back(row_offset_ > 0 ? arr->Slice(row_offset_) : arr);
+                   }
+                 },
+                 [this, &columns](const schema::RowBatch& row_batch) {
+                   for (const auto& col : row_batch.columns()) {
+                     columns.push_back(row_offset_ > 0 ? col->Slice(row_offset_) : col);
+                   }
+                 },
+             },
+             batch_);
+  return columns;
+}
+
 void RecordOrRowBatch::UnsafeAppendColumnToBuilder(types::TypeErasedArrowBuilder* builder,
                                                    types::DataType data_type, int64_t col_idx,
                                                    size_t start_row, size_t end_row) const {
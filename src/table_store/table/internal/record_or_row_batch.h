@@ -100,6 +100,14 @@ class RecordOrRowBatch {
                                  const std::vector<int64_t>& cols,
                                  schema::RowBatch* output_rb) const;
 
+  /**
+   * ShareColumns returns all of the columns of this record or row batch as arrow arrays, which
+   * share the values of the batch where possible instead of copying them (see
+   * `types::ColumnWrapper::ShareAsArrow`).
+   * @return the arrow array of each column.
+   */
+  std::vector<ArrowArrayPtr> ShareColumns() const;
+
   /**
    * UnsafeAppendColumnToBuilder appends a slice of a column of this record or row batch to the
    * given arrow array builder. This method expects that the given builder already has the space
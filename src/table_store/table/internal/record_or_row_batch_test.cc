@@ -157,6 +157,16 @@ TEST_P(RecordOrRowBatchTest, RemovePrefix_AddBatchSliceToRowBatch) {
       rb1.ColumnAt(2)->Equals(types::ToArrow(strings_, arrow::default_memory_pool())->Slice(2, 1)));
 }
 
+TEST_P(RecordOrRowBatchTest, ShareColumns) {
+  rb_->RemovePrefix(1);
+  auto columns = rb_->ShareColumns();
+  ASSERT_EQ(3, columns.size());
+  EXPECT_TRUE(columns[0]->Equals(types::ToArrow(times_, arrow::default_memory_pool())->Slice(1)));
+  EXPECT_TRUE(columns[1]->Equals(types::ToArrow(bools_, arrow::default_memory_pool())->Slice(1)));
+  EXPECT_TRUE(
+      columns[2]->Equals(types::ToArrow(strings_, arrow::default_memory_pool())->Slice(1)));
+}
+
 TEST_P(RecordOrRowBatchTest, UnsafeAppendColumnToBuilder) {
   auto time_builder =
       types::MakeTypeErasedArrowBuilder(types::DataType::TIME64NS, arrow::default_memory_pool());
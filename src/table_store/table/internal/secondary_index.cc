@@ -0,0 +1,197 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/internal/secondary_index.h"
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <absl/container/flat_hash_set.h>
+#include <absl/strings/match.h>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+using types::DataType;
+
+namespace {
+
+template <DataType T>
+std::vector<ZoneMapValue> DistinctValuesOfType(const arrow::Array& col) {
+  using TNative = typename types::DataTypeTraits<T>::native_type;
+  absl::flat_hash_set<TNative> distinct;
+  for (int64_t i = 0; i < col.length(); ++i) {
+    distinct.insert(types::GetValueFromArrowArray<T>(&col, i));
+  }
+  return std::vector<ZoneMapValue>(distinct.begin(), distinct.end());
+}
+
+}  // namespace
+
+bool SecondaryIndex::CanIndex(DataType data_type) {
+  return data_type == DataType::INT64 || data_type == DataType::UINT128 ||
+         data_type == DataType::STRING;
+}
+
+SecondaryIndex::SecondaryIndex(DataType data_type) {
+  DCHECK(CanIndex(data_type));
+  switch (data_type) {
+    case DataType::UINT128:
+      value_index_ = ZoneMapValue(absl::uint128()).index();
+      break;
+    case DataType::STRING:
+      value_index_ = ZoneMapValue(std::string()).index();
+      break;
+    default:
+      value_index_ = ZoneMapValue(int64_t{0}).index();
+      break;
+  }
+}
+
+std::vector<ZoneMapValue> SecondaryIndex::DistinctValues(DataType data_type,
+                                                         const arrow::Array& col) {
+  switch (data_type) {
+    case DataType::INT64:
+      return DistinctValuesOfType<DataType::INT64>(col);
+    case DataType::UINT128:
+      return DistinctValuesOfType<DataType::UINT128>(col);
+    case DataType::STRING: {
+      absl::flat_hash_set<std::string_view> distinct;
+      for (int64_t i = 0; i < col.length(); ++i) {
+        distinct.insert(types::GetStringViewFromArrowArray(&col, i));
+      }
+      std::vector<ZoneMapValue> values;
+      values.reserve(distinct.size());
+      for (auto val : distinct) {
+        values.emplace_back(std::string(val));
+      }
+      return values;
+    }
+    default:
+      DCHECK(false) << "Can't index columns of type " << types::ToString(data_type);
+      return {};
+  }
+}
+
+void SecondaryIndex::AddBatch(RowID first_row_id, RowID last_row_id,
+                              const std::vector<ZoneMapValue>& values) {
+  DCHECK_GE(first_row_id, end_row_id_);
+  for (const auto& value : values) {
+    auto& postings = postings_[value];
+    if (!postings.empty() && postings.back().last + 1 == first_row_id) {
+      postings.back().last = last_row_id;
+    } else {
+      postings.push_back({first_row_id, last_row_id});
+    }
+  }
+  end_row_id_ = last_row_id + 1;
+}
+
+void SecondaryIndex::Coalesce(RowID first_row_id, RowID last_row_id) {
+  for (auto& [value, postings] : postings_) {
+    auto begin = std::lower_bound(postings.begin(), postings.end(), first_row_id,
+                                  [](const Range& range, RowID id) { return range.last < id; });
+    auto end = begin;
+    while (end != postings.end() && end->first <= last_row_id) {
+      ++end;
+    }
+    if (end - begin < 2) {
+      continue;
+    }
+    // The ranges at either end may reach past the cold batch, if they were only partially
+    // compacted.
+    Range merged{std::min(first_row_id, begin->first), std::max(last_row_id, (end - 1)->last)};
+    *begin = merged;
+    postings.erase(begin + 1, end);
+  }
+}
+
+void SecondaryIndex::Trim(RowID first_row_id) {
+  for (auto it = postings_.begin(); it != postings_.end();) {
+    auto& postings = it->second;
+    while (!postings.empty() && postings.front().last < first_row_id) {
+      postings.pop_front();
+    }
+    if (postings.empty()) {
+      postings_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+RowID SecondaryIndex::NextRowID(const PostingList& postings, RowID row_id) const {
+  auto it = std::lower_bound(postings.begin(), postings.end(), row_id,
+                             [](const Range& range, RowID id) { return range.last < id; });
+  if (it == postings.end()) {
+    return end_row_id_;
+  }
+  return std::max(it->first, row_id);
+}
+
+RowID SecondaryIndex::NextMatchingRowID(const ColumnPredicate& predicate, RowID row_id) const {
+  // Values of another type than the column's never compare equal to its values.
+  if (row_id >= end_row_id_ || predicate.value.index() != value_index_) {
+    return row_id;
+  }
+  switch (predicate.op) {
+    case ColumnPredicate::kEqual: {
+      auto it = postings_.find(predicate.value);
+      if (it == postings_.end()) {
+        return end_row_id_;
+      }
+      return NextRowID(it->second, row_id);
+    }
+    case ColumnPredicate::kContains: {
+      const auto& substr = std::get<std::string>(predicate.value);
+      RowID next = end_row_id_;
+      for (const auto& [value, postings] : postings_) {
+        if (absl::StrContains(std::get<std::string>(value), substr)) {
+          next = std::min(next, NextRowID(postings, row_id));
+          if (next == row_id) {
+            break;
+          }
+        }
+      }
+      return next;
+    }
+    default:
+      return row_id;
+  }
+}
+
+int64_t SecondaryIndex::Bytes() const {
+  int64_t bytes = sizeof(SecondaryIndex);
+  for (const auto& [value, postings] : postings_) {
+    bytes += sizeof(value) + sizeof(postings) + postings.size() * sizeof(Range);
+    if (std::holds_alternative<std::string>(value)) {
+      bytes += std::get<std::string>(value).size();
+    }
+  }
+  return bytes;
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+
+#include <deque>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/table/internal/types.h"
+#include "src/table_store/table/internal/zone_map.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * SecondaryIndex maps each value of a column of a table to the row ID ranges of the batches that
+ * contain it (the posting list of the value), so that a reader looking for one value can jump
+ * straight to the next batch that contains it instead of scanning every batch.
+ *
+ * Batches are added in row order as they're written, and the ranges of a value in consecutive
+ * batches are merged. When hot batches are compacted into a cold batch, the ranges of each value
+ * within the cold batch are coalesced into one, so that the index shrinks along with the number of
+ * batches.
+ */
+class SecondaryIndex : public NotCopyable {
+ public:
+  /**
+   * Whether columns of the given data type can be indexed.
+   */
+  static bool CanIndex(types::DataType data_type);
+
+  /**
+   * DistinctValues returns the distinct values of the given column, which must be of an indexable
+   * data type.
+   */
+  static std::vector<ZoneMapValue> DistinctValues(types::DataType data_type,
+                                                  const arrow::Array& col);
+
+  /**
+   * @param data_type the data type of the indexed column, for which CanIndex must be true.
+   */
+  explicit SecondaryIndex(types::DataType data_type);
+
+  /**
+   * Adds a batch with the given distinct values, spanning rows first_row_id to last_row_id. Batches
+   * must be added in row order.
+   */
+  void AddBatch(RowID first_row_id, RowID last_row_id, const std::vector<ZoneMapValue>& values);
+
+  /**
+   * Coalesces the ranges of each value within rows first_row_id to last_row_id into one.
+   */
+  void Coalesce(RowID first_row_id, RowID last_row_id);
+
+  /**
+   * Drops the ranges of the rows before first_row_id, which have expired from the table.
+   */
+  void Trim(RowID first_row_id);
+
+  /**
+   * NextMatchingRowID returns the first row ID from row_id on of a batch with a value that may
+   * satisfy the predicate, or EndRowID() if no indexed row from row_id on does. Returns row_id for
+   * predicates the index can't evaluate.
+   */
+  RowID NextMatchingRowID(const ColumnPredicate& predicate, RowID row_id) const;
+
+  /**
+   * EndRowID returns the row ID after the last indexed row.
+   */
+  RowID EndRowID() const { return end_row_id_; }
+
+  /**
+   * Bytes returns the memory held by the index.
+   */
+  int64_t Bytes() const;
+
+ private:
+  struct Range {
+    RowID first;
+    RowID last;
+  };
+  using PostingList = std::deque<Range>;
+
+  // Returns the first row ID from row_id on in the given posting list, or end_row_id_.
+  RowID NextRowID(const PostingList& postings, RowID row_id) const;
+
+  // The index of the alternative of ZoneMapValue that holds the values of the column.
+  size_t value_index_;
+  absl::flat_hash_map<ZoneMapValue, PostingList> postings_;
+  RowID end_row_id_ = 0;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/internal/secondary_index.h"
+
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+using ::testing::UnorderedElementsAre;
+
+TEST(SecondaryIndexTest, distinct_values) {
+  std::vector<types::StringValue> vals = {"cart", "checkout", "cart"};
+  auto col = types::ToArrow(vals, arrow::default_memory_pool());
+  EXPECT_THAT(SecondaryIndex::DistinctValues(types::DataType::STRING, *col),
+              UnorderedElementsAre(ZoneMapValue(std::string("cart")),
+                                   ZoneMapValue(std::string("checkout"))));
+  EXPECT_FALSE(SecondaryIndex::CanIndex(types::DataType::FLOAT64));
+}
+
+TEST(SecondaryIndexTest, next_matching_row_id) {
+  SecondaryIndex index(types::DataType::UINT128);
+  index.AddBatch(0, 9, {absl::uint128(1), absl::uint128(2)});
+  index.AddBatch(10, 19, {absl::uint128(2)});
+  index.AddBatch(20, 29, {absl::uint128(1)});
+  EXPECT_EQ(30, index.EndRowID());
+
+  ColumnPredicate upid_1{0, ColumnPredicate::kEqual, absl::uint128(1)};
+  EXPECT_EQ(5, index.NextMatchingRowID(upid_1, 5));
+  EXPECT_EQ(20, index.NextMatchingRowID(upid_1, 10));
+  EXPECT_EQ(30, index.NextMatchingRowID(upid_1, 30));
+
+  // Consecutive batches with the same value are merged.
+  ColumnPredicate upid_2{0, ColumnPredicate::kEqual, absl::uint128(2)};
+  EXPECT_EQ(15, index.NextMatchingRowID(upid_2, 15));
+  EXPECT_EQ(30, index.NextMatchingRowID(upid_2, 20));
+
+  ColumnPredicate upid_3{0, ColumnPredicate::kEqual, absl::uint128(3)};
+  EXPECT_EQ(30, index.NextMatchingRowID(upid_3, 0));
+
+  // Predicates the index can't evaluate don't skip any row.
+  ColumnPredicate less_than{0, ColumnPredicate::kLessThan, absl::uint128(2)};
+  EXPECT_EQ(10, index.NextMatchingRowID(less_than, 10));
+  ColumnPredicate wrong_type{0, ColumnPredicate::kEqual, int64_t{1}};
+  EXPECT_EQ(10, index.NextMatchingRowID(wrong_type, 10));
+}
+
+TEST(SecondaryIndexTest, contains) {
+  SecondaryIndex index(types::DataType::STRING);
+  index.AddBatch(0, 9, {std::string("pl/vizier-metadata")});
+  index.AddBatch(10, 19, {std::string("px-sock-shop/carts")});
+  index.AddBatch(20, 29, {std::string("px-sock-shop/orders")});
+
+  ColumnPredicate sock_shop{0, ColumnPredicate::kContains, std::string("sock-shop")};
+  EXPECT_EQ(10, index.NextMatchingRowID(sock_shop, 0));
+  EXPECT_EQ(25, index.NextMatchingRowID(sock_shop, 25));
+  ColumnPredicate kelvin{0, ColumnPredicate::kContains, std::string("kelvin")};
+  EXPECT_EQ(30, index.NextMatchingRowID(kelvin, 0));
+}
+
+TEST(SecondaryIndexTest, coalesce_and_trim) {
+  SecondaryIndex index(types::DataType::INT64);
+  index.AddBatch(0, 9, {int64_t{1}});
+  index.AddBatch(10, 19, {int64_t{2}});
+  index.AddBatch(20, 29, {int64_t{1}});
+  index.AddBatch(30, 39, {int64_t{2}});
+  auto bytes = index.Bytes();
+
+  // Compacting rows 0 to 24 into one batch merges the ranges of value 1 within them, including the
+  // range of the partially compacted batch.
+  index.Coalesce(0, 24);
+  ColumnPredicate value_1{0, ColumnPredicate::kEqual, int64_t{1}};
+  EXPECT_EQ(15, index.NextMatchingRowID(value_1, 15));
+  EXPECT_EQ(40, index.NextMatchingRowID(value_1, 30));
+  EXPECT_LT(index.Bytes(), bytes);
+
+  index.Trim(30);
+  EXPECT_EQ(40, index.NextMatchingRowID(value_1, 30));
+  ColumnPredicate value_2{0, ColumnPredicate::kEqual, int64_t{2}};
+  EXPECT_EQ(30, index.NextMatchingRowID(value_2, 30));
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
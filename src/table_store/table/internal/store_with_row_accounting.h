@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <optional>
@@ -28,6 +29,8 @@
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/column_wrapper.h"
 #include "src/table_store/schema/relation.h"
+#include "src/table_store/table/internal/decoded_column_cache.h"
+#include "src/table_store/table/internal/disk_batch.h"
 #include "src/table_store/table/internal/types.h"
 
 namespace px {
@@ -54,12 +57,12 @@ void constexpr_else_static_assert_false() {
 }
 
 /**
- * StoreWithRowTimeAccounting stores a deque of batches (hot or cold) and keeps track of the first
- * and last unique RowID's for each batch, as well as the first and last times for each batch (if
- * there is a time column in the table). The template parameter specifies whether this is the Hot or
- * Cold store. Since the logic between the Hot and Cold stores is roughly identical, this class
- * deduplicates that logic while allowing the explicit batch accesses to use the correct Hot or Cold
- * batch methods.
+ * StoreWithRowTimeAccounting stores a deque of batches (hot, cold or disk) and keeps track of the
+ * first and last unique RowID's for each batch, as well as the first and last times for each batch
+ * (if there is a time column in the table). The template parameter specifies whether this is the
+ * Hot, Cold or Disk store. Since the logic between the stores is roughly identical, this class
+ * deduplicates that logic while allowing the explicit batch accesses to use the correct Hot, Cold
+ * or Disk batch methods.
  *
  * Times are used to find row batch's within a given time
  * range. RowIDs are used in case table compaction occurs during query execution. Since the size of
@@ -75,6 +78,28 @@ class StoreWithRowTimeAccounting {
   StoreWithRowTimeAccounting(const schema::Relation& rel, int64_t time_col_idx)
       : rel_(rel), time_col_idx_(time_col_idx) {}
 
+  ~StoreWithRowTimeAccounting() {
+    if (decoded_cache_ != nullptr) {
+      for (const auto& row_ids : row_ids_) {
+        decoded_cache_->EraseBatch(cache_table_id_, row_ids.first, rel_.NumColumns());
+      }
+    }
+  }
+
+  /**
+   * SetDecodedColumnCache makes reads of the encoded columns of the cold store go through the
+   * given cache, so that each column of a batch is decoded once for as long as it stays cached.
+   * Only the first cache that is set is used.
+   */
+  void SetDecodedColumnCache(std::shared_ptr<DecodedColumnCache> cache) {
+    static_assert(TStoreType == StoreType::Cold, "Only cold batches have encoded columns");
+    if (decoded_cache_ != nullptr) {
+      return;
+    }
+    cache_table_id_ = cache->NewTableID();
+    decoded_cache_ = std::move(cache);
+  }
+
   /**
    * GetNextRowBatch returns the next row batch in this store after the given unique row id.
    * @param last_read_row_id, pointer to the unique RowID of the last read row. The outputted batch
@@ -126,8 +151,8 @@ class StoreWithRowTimeAccounting {
     }
     auto output_rb =
         std::make_unique<schema::RowBatch>(schema::RowDescriptor(col_types), batch_size);
-    PX_RETURN_IF_ERROR(
-        AddBatchSliceToRowBatch(batch, row_offset, batch_size, cols, output_rb.get()));
+    PX_RETURN_IF_ERROR(AddBatchSliceToRowBatch(batch, batch_first_row_id, row_offset, batch_size,
+                                               cols, output_rb.get()));
 
     // Update the ptr to the last read row.
     *last_read_row_id = start_row_id + batch_size - 1;
@@ -139,6 +164,48 @@ class StoreWithRowTimeAccounting {
     return output_rb;
   }
 
+  /**
+   * SkipBatches skips the batches after the given unique row id for as long as skip_batch returns
+   * true for them, by advancing last_read_row_id past them. A batch that was partially read is
+   * skipped as a whole.
+   * @param last_read_row_id, pointer to the unique RowID of the last read row.
+   * @param hints, pointer to a BatchHints object, see GetNextRowBatch.
+   * @param stop_row_id, an optional unique RowID that last_read_row_id isn't advanced past.
+   * @param skip_batch, predicate on a TBatch that returns whether to skip it.
+   * @return the number of batches skipped.
+   */
+  template <typename TSkipFn>
+  int64_t SkipBatches(RowID* last_read_row_id, BatchHints* hints, std::optional<RowID> stop_row_id,
+                      TSkipFn skip_batch) const {
+    int64_t num_skipped = 0;
+    while (!batches_.empty()) {
+      auto start_row_id = *last_read_row_id + 1;
+      if (start_row_id < FirstRowID() || start_row_id > LastRowID() ||
+          (stop_row_id.has_value() && start_row_id >= stop_row_id.value())) {
+        break;
+      }
+      BatchID batch_id;
+      if (hints != nullptr && BatchHintValid(*hints, start_row_id)) {
+        batch_id = hints->batch_id;
+      } else {
+        batch_id = FindBatchIDFromRowID(start_row_id);
+      }
+      if (!skip_batch(GetBatchFromBatchID(batch_id))) {
+        break;
+      }
+      *last_read_row_id = BatchLastRowID(batch_id);
+      if (stop_row_id.has_value()) {
+        *last_read_row_id = std::min(*last_read_row_id, stop_row_id.value() - 1);
+      }
+      if (hints != nullptr) {
+        hints->batch_id = batch_id + 1;
+        hints->hint_type = TStoreType;
+      }
+      ++num_skipped;
+    }
+    return num_skipped;
+  }
+
   /**
    * Size returns the number of batches in this store.
    * @return number of batches.
@@ -161,6 +228,9 @@ class StoreWithRowTimeAccounting {
   TBatch&& PopFront() {
     DCHECK(!batches_.empty());
     first_batch_id_++;
+    if (decoded_cache_ != nullptr) {
+      decoded_cache_->EraseBatch(cache_table_id_, row_ids_.front().first, rel_.NumColumns());
+    }
 
     row_ids_.pop_front();
     if (time_col_idx_ != -1) times_.pop_front();
@@ -207,6 +277,36 @@ class StoreWithRowTimeAccounting {
     return row_ids_.back().second;
   }
 
+  /**
+   * FindBatchFirstRowID returns the RowID of the first row of the batch that holds the given row.
+   * @param row_id, the RowID to search for.
+   * @return RowID of the first row of the batch, or std::nullopt if the row isn't in the store.
+   */
+  std::optional<RowID> FindBatchFirstRowID(RowID row_id) const {
+    if (batches_.empty() || row_id < FirstRowID() || row_id > LastRowID()) {
+      return std::nullopt;
+    }
+    return BatchFirstRowID(FindBatchIDFromRowID(row_id));
+  }
+
+  /**
+   * AppendBatchFirstRowIDs appends the RowIDs of the first rows of the batches that start within
+   * the given range of RowIDs to row_ids, in order.
+   * @param first_row_id, the first RowID of the range.
+   * @param last_row_id, the last RowID of the range.
+   * @param row_ids, pointer to the vector to append to.
+   */
+  void AppendBatchFirstRowIDs(RowID first_row_id, RowID last_row_id,
+                              std::vector<RowID>* row_ids) const {
+    auto it = std::lower_bound(row_ids_.begin(), row_ids_.end(), first_row_id,
+                               [](const RowIDInterval& interval, RowID row_id) {
+                                 return interval.first < row_id;
+                               });
+    for (; it != row_ids_.end() && it->first <= last_row_id; ++it) {
+      row_ids->push_back(it->first);
+    }
+  }
+
   /**
    * FindRowIDFromTimeFirstGreaterThanOrEqual returns the RowID of the first row in the store with
    * time greater than or equal to the given time, or returns std::nullopt if no such row exists.
@@ -342,9 +442,11 @@ class StoreWithRowTimeAccounting {
 
   size_t BatchLength(const TBatch& batch) const {
     if constexpr (std::is_same_v<ColdBatch, TBatch>) {
-      return batch[0]->length();
+      return batch.Length();
     } else if constexpr (std::is_same_v<HotBatch, TBatch>) {
       return batch.Length();
+    } else if constexpr (std::is_same_v<DiskBatch, TBatch>) {
+      return batch.Length();
     } else {
       constexpr_else_static_assert_false();
     }
@@ -353,9 +455,15 @@ class StoreWithRowTimeAccounting {
   size_t FindTimeFirstGreaterThanOrEqual(const TBatch& batch, Time time) const {
     if constexpr (std::is_same_v<TBatch, ColdBatch>) {
       return types::SearchArrowArrayGreaterThanOrEqual<types::DataType::TIME64NS>(
-          batch[time_col_idx_].get(), time);
+          batch.PlainColumn(time_col_idx_).get(), time);
     } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
       return batch.FindTimeFirstGreaterThanOrEqual(time_col_idx_, time);
+    } else if constexpr (std::is_same_v<TBatch, DiskBatch>) {
+      // If the time column can't be read, the batch is treated as if all of its rows were before
+      // the given time.
+      PX_ASSIGN_OR(auto time_col, batch.ReadColumn(time_col_idx_), return batch.Length());
+      return types::SearchArrowArrayGreaterThanOrEqual<types::DataType::TIME64NS>(time_col.get(),
+                                                                                  time);
     } else {
       constexpr_else_static_assert_false();
     }
@@ -364,10 +472,15 @@ class StoreWithRowTimeAccounting {
   size_t FindTimeFirstGreaterThan(const TBatch& batch, Time time) const {
     if constexpr (std::is_same_v<TBatch, ColdBatch>) {
       return types::SearchArrowArrayLessThanOrEqual<types::DataType::TIME64NS>(
-                 batch[time_col_idx_].get(), time) +
+                 batch.PlainColumn(time_col_idx_).get(), time) +
              1;
     } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
       return batch.FindTimeFirstGreaterThan(time_col_idx_, time);
+    } else if constexpr (std::is_same_v<TBatch, DiskBatch>) {
+      PX_ASSIGN_OR(auto time_col, batch.ReadColumn(time_col_idx_), return batch.Length());
+      return types::SearchArrowArrayLessThanOrEqual<types::DataType::TIME64NS>(time_col.get(),
+                                                                               time) +
+             1;
     } else {
       constexpr_else_static_assert_false();
     }
@@ -375,26 +488,62 @@ class StoreWithRowTimeAccounting {
 
   Time GetTimeValue(const TBatch& batch, int64_t row_idx) const {
     if constexpr (std::is_same_v<TBatch, ColdBatch>) {
-      return types::GetValueFromArrowArray<types::DataType::TIME64NS>(batch[time_col_idx_].get(),
-                                                                      row_idx);
+      if (batch.columns[time_col_idx_] == nullptr) {
+        PX_ASSIGN_OR(auto time_col, batch.Slice(time_col_idx_, row_idx, 1), return -1);
+        return types::GetValueFromArrowArray<types::DataType::TIME64NS>(time_col.get(), 0);
+      }
+      return types::GetValueFromArrowArray<types::DataType::TIME64NS>(
+          batch.columns[time_col_idx_].get(), row_idx);
     } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
       return batch.GetTimeValue(time_col_idx_, row_idx);
+    } else if constexpr (std::is_same_v<TBatch, DiskBatch>) {
+      if (row_idx == 0) {
+        return batch.first_time;
+      }
+      if (row_idx == batch.Length() - 1) {
+        return batch.last_time;
+      }
+      PX_ASSIGN_OR(auto time_col, batch.ReadColumn(time_col_idx_), return -1);
+      return types::GetValueFromArrowArray<types::DataType::TIME64NS>(time_col.get(), row_idx);
     } else {
       constexpr_else_static_assert_false();
     }
   }
 
-  Status AddBatchSliceToRowBatch(const TBatch& batch, size_t row_offset, size_t batch_size,
-                                 const std::vector<int64_t>& cols,
+  // Slices a column of a cold batch, decoding the whole column through the decoded column cache if
+  // it is encoded and there is a cache.
+  StatusOr<ArrowArrayPtr> SliceColdColumn(const ColdBatch& batch, RowID batch_first_row_id,
+                                          int64_t col_idx, int64_t offset, int64_t length) const {
+    if (decoded_cache_ == nullptr || batch.encoded_columns[col_idx] == nullptr) {
+      return batch.Slice(col_idx, offset, length);
+    }
+    DecodedColumnCache::Key key{cache_table_id_, batch_first_row_id, col_idx};
+    ArrowArrayPtr decoded = decoded_cache_->Get(key);
+    if (decoded == nullptr) {
+      PX_ASSIGN_OR_RETURN(decoded, batch.Slice(col_idx, 0, batch.Length()));
+      decoded_cache_->Put(key, decoded);
+    }
+    return decoded->Slice(offset, length);
+  }
+
+  Status AddBatchSliceToRowBatch(const TBatch& batch, RowID batch_first_row_id, size_t row_offset,
+                                 size_t batch_size, const std::vector<int64_t>& cols,
                                  schema::RowBatch* output_rb) const {
     if constexpr (std::is_same_v<TBatch, ColdBatch>) {
       for (auto col_idx : cols) {
-        auto arr = batch[col_idx]->Slice(row_offset, batch_size);
+        PX_ASSIGN_OR_RETURN(auto arr, SliceColdColumn(batch, batch_first_row_id, col_idx,
+                                                      row_offset, batch_size));
         PX_RETURN_IF_ERROR(output_rb->AddColumn(arr));
       }
       return Status::OK();
     } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
       return batch.AddBatchSliceToRowBatch(row_offset, batch_size, cols, output_rb);
+    } else if constexpr (std::is_same_v<TBatch, DiskBatch>) {
+      for (auto col_idx : cols) {
+        PX_ASSIGN_OR_RETURN(auto arr, batch.ReadColumn(col_idx));
+        PX_RETURN_IF_ERROR(output_rb->AddColumn(arr->Slice(row_offset, batch_size)));
+      }
+      return Status::OK();
     } else {
       constexpr_else_static_assert_false();
     }
@@ -406,6 +555,9 @@ class StoreWithRowTimeAccounting {
   std::deque<TBatch> batches_;
   std::deque<RowIDInterval> row_ids_;
   std::deque<TimeInterval> times_;
+  // Only set for the cold store, see SetDecodedColumnCache.
+  std::shared_ptr<DecodedColumnCache> decoded_cache_;
+  int64_t cache_table_id_ = -1;
 };
 
 }  // namespace internal
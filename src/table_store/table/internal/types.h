@@ -19,6 +19,7 @@
 #pragma once
 
 #include <arrow/array.h>
+#include <arrow/memory_pool.h>
 
 #include <deque>
 #include <memory>
@@ -26,9 +27,12 @@
 #include <variant>
 #include <vector>
 
+#include "src/common/base/base.h"
 #include "src/shared/types/column_wrapper.h"
 #include "src/shared/types/types.h"
 #include "src/table_store/schema/row_batch.h"
+#include "src/table_store/table/internal/encoded_column.h"
+#include "src/table_store/table/internal/zone_map.h"
 
 namespace px {
 namespace table_store {
@@ -53,6 +57,7 @@ struct RecordBatchWithCache {
 enum StoreType {
   Hot,
   Cold,
+  Disk,
 };
 
 struct BatchHints {
@@ -61,8 +66,43 @@ struct BatchHints {
 };
 
 class RecordOrRowBatch;
+struct DiskBatch;
 
-using ColdBatch = std::vector<ArrowArrayPtr>;
+/**
+ * ColdBatch is a compacted batch of the cold store. Its columns may be held encoded (e.g.
+ * dictionary encoded strings or delta encoded times), in which case they are decoded whenever they
+ * are read. Columns may have a zone map, which lets reads with predicates skip the batch.
+ */
+struct ColdBatch {
+  // NOLINTNEXTLINE: runtime/explicit
+  ColdBatch(std::vector<ArrowArrayPtr> cols)
+      : columns(std::move(cols)), encoded_columns(columns.size()), zone_maps(columns.size()) {}
+
+  int64_t Length() const {
+    return columns[0] != nullptr ? columns[0]->length() : encoded_columns[0]->length();
+  }
+
+  StatusOr<ArrowArrayPtr> Slice(int64_t col_idx, int64_t offset, int64_t length) const {
+    if (encoded_columns[col_idx] != nullptr) {
+      return encoded_columns[col_idx]->Decode(offset, length, arrow::default_memory_pool());
+    }
+    return columns[col_idx]->Slice(offset, length);
+  }
+
+  // Returns the whole column as an arrow::Array, decoding it if needed.
+  ArrowArrayPtr PlainColumn(int64_t col_idx) const {
+    if (columns[col_idx] != nullptr) {
+      return columns[col_idx];
+    }
+    return Slice(col_idx, 0, Length()).ConsumeValueOrDie();
+  }
+
+  // The plain columns, with nullptr in place of the encoded ones.
+  std::vector<ArrowArrayPtr> columns;
+  std::vector<std::shared_ptr<const EncodedColumn>> encoded_columns;
+  // nullptr for the columns without a zone map.
+  std::vector<std::shared_ptr<const ColumnZoneMap>> zone_maps;
+};
 
 template <StoreType type>
 struct StoreTypeTraits {};
@@ -74,6 +114,10 @@ template <>
 struct StoreTypeTraits<StoreType::Cold> {
   using batch_type = ColdBatch;
 };
+template <>
+struct StoreTypeTraits<StoreType::Disk> {
+  using batch_type = DiskBatch;
+};
 
 }  // namespace internal
 }  // namespace table_store
@@ -0,0 +1,261 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/internal/zone_map.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include <absl/container/flat_hash_set.h>
+#include <absl/strings/match.h>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+using types::DataType;
+
+// String columns with more distinct values than this in a batch only get a min/max. Beyond that,
+// the bloom filter would cost more memory than it likely saves in scanning.
+constexpr int64_t kZoneMapMaxBloomFilterEntries = 4096;
+constexpr double kZoneMapBloomFilterErrorRate = 0.01;
+
+namespace {
+
+// Sets min and max to the min and max values of the column. Returns false if the column has values
+// without an order (NaNs).
+template <DataType T>
+bool BuildMinMax(const arrow::Array& col, ZoneMapValue* min, ZoneMapValue* max) {
+  using TNative = typename types::DataTypeTraits<T>::native_type;
+  TNative min_val = types::GetValueFromArrowArray<T>(&col, 0);
+  TNative max_val = min_val;
+  for (int64_t i = 0; i < col.length(); ++i) {
+    TNative val = types::GetValueFromArrowArray<T>(&col, i);
+    if constexpr (T == DataType::FLOAT64) {
+      if (std::isnan(val)) {
+        return false;
+      }
+    }
+    if (val < min_val) {
+      min_val = val;
+    } else if (max_val < val) {
+      max_val = val;
+    }
+  }
+  *min = min_val;
+  *max = max_val;
+  return true;
+}
+
+template <typename TValue>
+bool ValueMatches(ColumnPredicate::Op op, const TValue& val, const TValue& predicate_val) {
+  switch (op) {
+    case ColumnPredicate::kEqual:
+      return val == predicate_val;
+    case ColumnPredicate::kLessThan:
+      return val < predicate_val;
+    case ColumnPredicate::kLessThanEqual:
+      return !(predicate_val < val);
+    case ColumnPredicate::kGreaterThan:
+      return predicate_val < val;
+    case ColumnPredicate::kGreaterThanEqual:
+      return !(val < predicate_val);
+    case ColumnPredicate::kContains:
+      if constexpr (std::is_same_v<TValue, std::string_view>) {
+        return absl::StrContains(val, predicate_val);
+      }
+      return false;
+  }
+  return false;
+}
+
+template <DataType T, typename TValue>
+Status FilterMatchingRows(const arrow::Array& col, const ColumnPredicate& predicate,
+                          std::vector<int64_t>* rows) {
+  if (!std::holds_alternative<TValue>(predicate.value)) {
+    return error::InvalidArgument("Predicate value on column $0 doesn't match the column type $1",
+                                  predicate.column_index, types::ToString(T));
+  }
+  const auto& predicate_val = std::get<TValue>(predicate.value);
+  auto end = std::remove_if(rows->begin(), rows->end(), [&](int64_t row) {
+    if constexpr (T == DataType::STRING) {
+      return !ValueMatches<std::string_view>(
+          predicate.op, types::GetStringViewFromArrowArray(&col, row), predicate_val);
+    } else {
+      return !ValueMatches<TValue>(predicate.op, types::GetValueFromArrowArray<T>(&col, row),
+                                   predicate_val);
+    }
+  });
+  rows->erase(end, rows->end());
+  return Status::OK();
+}
+
+}  // namespace
+
+std::unique_ptr<ColumnZoneMap> ColumnZoneMap::Build(DataType data_type, const arrow::Array& col) {
+  if (col.length() == 0) {
+    return nullptr;
+  }
+  ZoneMapValue min;
+  ZoneMapValue max;
+  std::unique_ptr<bloomfilter::XXHash64BloomFilter> bloom_filter;
+  switch (data_type) {
+    case DataType::BOOLEAN:
+      BuildMinMax<DataType::BOOLEAN>(col, &min, &max);
+      break;
+    case DataType::INT64:
+      BuildMinMax<DataType::INT64>(col, &min, &max);
+      break;
+    case DataType::TIME64NS:
+      BuildMinMax<DataType::TIME64NS>(col, &min, &max);
+      break;
+    case DataType::UINT128:
+      BuildMinMax<DataType::UINT128>(col, &min, &max);
+      break;
+    case DataType::FLOAT64:
+      if (!BuildMinMax<DataType::FLOAT64>(col, &min, &max)) {
+        return nullptr;
+      }
+      break;
+    case DataType::STRING: {
+      absl::flat_hash_set<std::string_view> distinct;
+      std::string_view min_val = types::GetStringViewFromArrowArray(&col, 0);
+      std::string_view max_val = min_val;
+      for (int64_t i = 0; i < col.length(); ++i) {
+        auto val = types::GetStringViewFromArrowArray(&col, i);
+        min_val = std::min(min_val, val);
+        max_val = std::max(max_val, val);
+        if (static_cast<int64_t>(distinct.size()) <= kZoneMapMaxBloomFilterEntries) {
+          distinct.insert(val);
+        }
+      }
+      min = std::string(min_val);
+      max = std::string(max_val);
+      if (static_cast<int64_t>(distinct.size()) <= kZoneMapMaxBloomFilterEntries) {
+        auto bloom_filter_or_s = bloomfilter::XXHash64BloomFilter::Create(
+            distinct.size(), kZoneMapBloomFilterErrorRate);
+        if (bloom_filter_or_s.ok()) {
+          bloom_filter = bloom_filter_or_s.ConsumeValueOrDie();
+          for (auto val : distinct) {
+            bloom_filter->Insert(val);
+          }
+        }
+      }
+      break;
+    }
+    default:
+      return nullptr;
+  }
+  return std::unique_ptr<ColumnZoneMap>(
+      new ColumnZoneMap(std::move(min), std::move(max), std::move(bloom_filter)));
+}
+
+bool ColumnZoneMap::MayMatch(ColumnPredicate::Op op, const ZoneMapValue& value) const {
+  if (value.index() != min_.index()) {
+    return true;
+  }
+  return std::visit(
+      [&](const auto& val) {
+        using TValue = std::decay_t<decltype(val)>;
+        const auto& min = std::get<TValue>(min_);
+        const auto& max = std::get<TValue>(max_);
+        switch (op) {
+          case ColumnPredicate::kEqual:
+            if (val < min || max < val) {
+              return false;
+            }
+            if constexpr (std::is_same_v<TValue, std::string>) {
+              return bloom_filter_ == nullptr || bloom_filter_->Contains(val);
+            }
+            return true;
+          case ColumnPredicate::kLessThan:
+            return min < val;
+          case ColumnPredicate::kLessThanEqual:
+            return !(val < min);
+          case ColumnPredicate::kGreaterThan:
+            return val < max;
+          case ColumnPredicate::kGreaterThanEqual:
+            return !(max < val);
+          case ColumnPredicate::kContains:
+            return true;
+        }
+        return true;
+      },
+      value);
+}
+
+int64_t ColumnZoneMap::Bytes() const {
+  int64_t bytes = sizeof(ColumnZoneMap);
+  if (std::holds_alternative<std::string>(min_)) {
+    bytes += std::get<std::string>(min_).size() + std::get<std::string>(max_).size();
+  }
+  if (bloom_filter_ != nullptr) {
+    bytes += bloom_filter_->buffer_size_bytes();
+  }
+  return bytes;
+}
+
+bool BatchMayMatch(const std::vector<std::shared_ptr<const ColumnZoneMap>>& zone_maps,
+                   const std::vector<ColumnPredicate>& predicates) {
+  for (const auto& predicate : predicates) {
+    if (predicate.column_index < 0 ||
+        predicate.column_index >= static_cast<int64_t>(zone_maps.size())) {
+      continue;
+    }
+    const auto& zone_map = zone_maps[predicate.column_index];
+    if (zone_map != nullptr && !zone_map->MayMatch(predicate.op, predicate.value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Status FilterMatchingRows(DataType data_type, const arrow::Array& col,
+                          const ColumnPredicate& predicate, std::vector<int64_t>* rows) {
+  if (predicate.op == ColumnPredicate::kContains && data_type != DataType::STRING) {
+    return error::InvalidArgument("Contains predicate on non-string column $0",
+                                  predicate.column_index);
+  }
+  switch (data_type) {
+    case DataType::BOOLEAN:
+      return FilterMatchingRows<DataType::BOOLEAN, bool>(col, predicate, rows);
+    case DataType::INT64:
+      return FilterMatchingRows<DataType::INT64, int64_t>(col, predicate, rows);
+    case DataType::TIME64NS:
+      return FilterMatchingRows<DataType::TIME64NS, int64_t>(col, predicate, rows);
+    case DataType::UINT128:
+      return FilterMatchingRows<DataType::UINT128, absl::uint128>(col, predicate, rows);
+    case DataType::FLOAT64:
+      return FilterMatchingRows<DataType::FLOAT64, double>(col, predicate, rows);
+    case DataType::STRING:
+      return FilterMatchingRows<DataType::STRING, std::string>(col, predicate, rows);
+    default:
+      return error::InvalidArgument("Predicates are not supported on columns of type $0",
+                                    types::ToString(data_type));
+  }
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <absl/numeric/int128.h>
+
+#include "src/common/base/base.h"
+#include "src/shared/bloomfilter/bloomfilter.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+// A value of a column, as the native type of the column's DataType.
+using ZoneMapValue = std::variant<bool, int64_t, double, absl::uint128, std::string>;
+
+/**
+ * ColumnPredicate is a comparison of a table column against a constant, e.g. `col == value`.
+ * A ColumnPredicate only ever needs to hold for the rows a reader is interested in: batches with
+ * no row that can satisfy it may be skipped, but the rows that are read must still be filtered.
+ */
+struct ColumnPredicate {
+  enum Op {
+    kEqual,
+    kLessThan,
+    kLessThanEqual,
+    kGreaterThan,
+    kGreaterThanEqual,
+    // The string column contains the value as a substring.
+    kContains,
+  };
+  int64_t column_index;
+  Op op;
+  // Must be of the native type of the column, otherwise the predicate never skips a batch.
+  ZoneMapValue value;
+};
+
+/**
+ * ColumnZoneMap summarizes the values of a column of a cold batch: their min and max, and for
+ * string columns a bloom filter of the distinct values, so that reads with a ColumnPredicate on
+ * the column can skip the batches where the predicate can't hold.
+ */
+class ColumnZoneMap {
+ public:
+  /**
+   * Build the zone map of the given column.
+   * @return the zone map, or nullptr if the column is empty or has no meaningful order.
+   */
+  static std::unique_ptr<ColumnZoneMap> Build(types::DataType data_type, const arrow::Array& col);
+
+  /**
+   * MayMatch returns false only if no value of the column satisfies the given predicate.
+   */
+  bool MayMatch(ColumnPredicate::Op op, const ZoneMapValue& value) const;
+
+  /**
+   * Bytes returns the memory held by the zone map.
+   */
+  int64_t Bytes() const;
+
+ private:
+  ColumnZoneMap(ZoneMapValue min, ZoneMapValue max,
+                std::unique_ptr<bloomfilter::XXHash64BloomFilter> bloom_filter)
+      : min_(std::move(min)), max_(std::move(max)), bloom_filter_(std::move(bloom_filter)) {}
+
+  ZoneMapValue min_;
+  ZoneMapValue max_;
+  // Only set for string columns with few enough distinct values.
+  std::unique_ptr<bloomfilter::XXHash64BloomFilter> bloom_filter_;
+};
+
+/**
+ * BatchMayMatch returns false if the zone maps of a batch (indexed by column, nullptr for the
+ * columns without one) show that no row of the batch satisfies all the given predicates.
+ */
+bool BatchMayMatch(const std::vector<std::shared_ptr<const ColumnZoneMap>>& zone_maps,
+                   const std::vector<ColumnPredicate>& predicates);
+
+/**
+ * FilterMatchingRows removes from rows (ascending indices into col) the rows whose value doesn't
+ * satisfy the predicate. Comparisons have the same semantics as the equivalent scalar UDFs.
+ * Returns an error if the predicate value isn't of the native type of the column.
+ */
+Status FilterMatchingRows(types::DataType data_type, const arrow::Array& col,
+                          const ColumnPredicate& predicate, std::vector<int64_t>* rows);
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
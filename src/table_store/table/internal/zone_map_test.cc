@@ -0,0 +1,125 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/internal/zone_map.h"
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+TEST(ColumnZoneMapTest, int64_min_max) {
+  std::vector<types::Int64Value> vals = {5, 3, 9, 7};
+  auto col = types::ToArrow(vals, arrow::default_memory_pool());
+  auto zone_map = ColumnZoneMap::Build(types::DataType::INT64, *col);
+  ASSERT_NE(nullptr, zone_map);
+
+  EXPECT_TRUE(zone_map->MayMatch(ColumnPredicate::kEqual, int64_t{3}));
+  EXPECT_TRUE(zone_map->MayMatch(ColumnPredicate::kEqual, int64_t{4}));
+  EXPECT_FALSE(zone_map->MayMatch(ColumnPredicate::kEqual, int64_t{10}));
+  EXPECT_FALSE(zone_map->MayMatch(ColumnPredicate::kLessThan, int64_t{3}));
+  EXPECT_TRUE(zone_map->MayMatch(ColumnPredicate::kLessThanEqual, int64_t{3}));
+  EXPECT_FALSE(zone_map->MayMatch(ColumnPredicate::kGreaterThan, int64_t{9}));
+  EXPECT_TRUE(zone_map->MayMatch(ColumnPredicate::kGreaterThanEqual, int64_t{9}));
+  // A value of the wrong type never rules out the batch.
+  EXPECT_TRUE(zone_map->MayMatch(ColumnPredicate::kEqual, 100.0));
+}
+
+TEST(ColumnZoneMapTest, string_bloom_filter) {
+  std::vector<types::StringValue> vals = {"checkout", "cart", "payments", "cart"};
+  auto col = types::ToArrow(vals, arrow::default_memory_pool());
+  auto zone_map = ColumnZoneMap::Build(types::DataType::STRING, *col);
+  ASSERT_NE(nullptr, zone_map);
+
+  EXPECT_TRUE(zone_map->MayMatch(ColumnPredicate::kEqual, std::string("cart")));
+  EXPECT_TRUE(zone_map->MayMatch(ColumnPredicate::kEqual, std::string("payments")));
+  // Out of the [min, max] range.
+  EXPECT_FALSE(zone_map->MayMatch(ColumnPredicate::kEqual, std::string("apple")));
+  EXPECT_FALSE(zone_map->MayMatch(ColumnPredicate::kGreaterThan, std::string("payments")));
+  // In range, so only the bloom filter rules these out.
+  int64_t num_may_match = 0;
+  for (int i = 0; i < 100; ++i) {
+    num_may_match +=
+        zone_map->MayMatch(ColumnPredicate::kEqual, std::string("d") + std::to_string(i));
+  }
+  EXPECT_LT(num_may_match, 10);
+}
+
+TEST(ColumnZoneMapTest, float64_with_nan) {
+  std::vector<types::Float64Value> vals = {1.0, std::nan(""), 2.0};
+  auto col = types::ToArrow(vals, arrow::default_memory_pool());
+  EXPECT_EQ(nullptr, ColumnZoneMap::Build(types::DataType::FLOAT64, *col));
+}
+
+TEST(ColumnZoneMapTest, batch_may_match) {
+  std::vector<types::Int64Value> ints = {1, 2, 3};
+  std::vector<types::StringValue> strs = {"a", "b", "c"};
+  std::vector<std::shared_ptr<const ColumnZoneMap>> zone_maps;
+  zone_maps.push_back(ColumnZoneMap::Build(
+      types::DataType::INT64, *types::ToArrow(ints, arrow::default_memory_pool())));
+  zone_maps.push_back(ColumnZoneMap::Build(
+      types::DataType::STRING, *types::ToArrow(strs, arrow::default_memory_pool())));
+  zone_maps.push_back(nullptr);
+
+  EXPECT_TRUE(BatchMayMatch(zone_maps, {}));
+  EXPECT_TRUE(BatchMayMatch(zone_maps, {{0, ColumnPredicate::kGreaterThan, int64_t{2}},
+                                        {1, ColumnPredicate::kEqual, std::string("b")}}));
+  EXPECT_FALSE(BatchMayMatch(zone_maps, {{0, ColumnPredicate::kGreaterThan, int64_t{2}},
+                                         {1, ColumnPredicate::kEqual, std::string("z")}}));
+  // Columns without a zone map never rule out the batch.
+  EXPECT_TRUE(BatchMayMatch(zone_maps, {{2, ColumnPredicate::kEqual, int64_t{0}}}));
+}
+
+TEST(ColumnZoneMapTest, filter_matching_rows) {
+  std::vector<types::Int64Value> ints = {5, 3, 9, 7};
+  auto int_col = types::ToArrow(ints, arrow::default_memory_pool());
+  std::vector<int64_t> rows = {0, 1, 2, 3};
+  EXPECT_OK(FilterMatchingRows(types::DataType::INT64, *int_col,
+                               {0, ColumnPredicate::kGreaterThanEqual, int64_t{7}}, &rows));
+  EXPECT_THAT(rows, ::testing::ElementsAre(2, 3));
+  EXPECT_OK(FilterMatchingRows(types::DataType::INT64, *int_col,
+                               {0, ColumnPredicate::kLessThan, int64_t{9}}, &rows));
+  EXPECT_THAT(rows, ::testing::ElementsAre(3));
+
+  std::vector<types::StringValue> strs = {"checkout", "cart", "payments", "cart"};
+  auto str_col = types::ToArrow(strs, arrow::default_memory_pool());
+  rows = {0, 1, 2, 3};
+  EXPECT_OK(FilterMatchingRows(types::DataType::STRING, *str_col,
+                               {0, ColumnPredicate::kContains, std::string("c")}, &rows));
+  EXPECT_THAT(rows, ::testing::ElementsAre(0, 1, 3));
+  EXPECT_OK(FilterMatchingRows(types::DataType::STRING, *str_col,
+                               {0, ColumnPredicate::kEqual, std::string("cart")}, &rows));
+  EXPECT_THAT(rows, ::testing::ElementsAre(1, 3));
+
+  // The value has to be of the native type of the column.
+  EXPECT_NOT_OK(FilterMatchingRows(types::DataType::INT64, *int_col,
+                                   {0, ColumnPredicate::kEqual, 7.0}, &rows));
+  EXPECT_NOT_OK(FilterMatchingRows(types::DataType::INT64, *int_col,
+                                   {0, ColumnPredicate::kContains, int64_t{7}}, &rows));
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,243 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/retention_budget.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_split.h>
+
+namespace px {
+namespace table_store {
+
+namespace {
+
+// Tables are offered at least this fraction of their share, even when they haven't been written
+// to, so that idle tables can start growing again.
+constexpr int64_t kIdleShareDivisor = 8;
+
+int64_t CurrentTimeNS() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// Calls fn(table_name, value) for each `table_name=value` pair of the list.
+template <typename TFn>
+Status ForEachTableValue(std::string_view list, TFn fn) {
+  for (std::string_view pair : absl::StrSplit(list, ',', absl::SkipWhitespace())) {
+    std::vector<std::string_view> kv = absl::StrSplit(pair, absl::MaxSplits('=', 1));
+    double value;
+    if (kv.size() != 2 || kv[0].empty() || !absl::SimpleAtod(kv[1], &value)) {
+      return error::InvalidArgument("Invalid table retention spec '$0', expected table_name=value",
+                                    pair);
+    }
+    PX_RETURN_IF_ERROR(fn(std::string(kv[0]), value));
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status RetentionBudget::ParseSpecs(std::string_view weights, std::string_view min_retentions_s,
+                                   TableRetentionSpecs* specs) {
+  PX_RETURN_IF_ERROR(ForEachTableValue(weights, [&](std::string name, double weight) {
+    if (weight <= 0) {
+      return error::InvalidArgument("The weight of table $0 must be positive, got $1", name,
+                                    weight);
+    }
+    (*specs)[name].weight = weight;
+    return Status::OK();
+  }));
+  PX_RETURN_IF_ERROR(ForEachTableValue(min_retentions_s, [&](std::string name, double seconds) {
+    if (seconds < 0) {
+      return error::InvalidArgument("The minimum retention of table $0 can't be negative", name);
+    }
+    auto min_retention = std::chrono::duration<double>(seconds);
+    (*specs)[name].min_retention =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(min_retention);
+    return Status::OK();
+  }));
+  return Status::OK();
+}
+
+void RetentionBudget::Configure(int64_t budget_bytes, TableRetentionSpecs specs) {
+  absl::MutexLock lock(&lock_);
+  budget_bytes_ = budget_bytes;
+  specs_ = std::move(specs);
+}
+
+void RetentionBudget::AddTable(const std::string& table_name,
+                               const std::shared_ptr<Table>& table) {
+  absl::MutexLock lock(&lock_);
+  auto& state = tables_[table.get()];
+  // The entry of a dropped table can still be around if a new table was allocated at its address.
+  if (state.table.expired()) {
+    state = TableState{table_name, table, 0};
+  }
+}
+
+Status RetentionBudget::Rebalance() { return Rebalance(CurrentTimeNS()); }
+
+Status RetentionBudget::Rebalance(int64_t now_ns) {
+  int64_t budget_bytes;
+  std::vector<Share> shares;
+  {
+    absl::MutexLock lock(&lock_);
+    budget_bytes = budget_bytes_;
+    if (budget_bytes <= 0) {
+      return Status::OK();
+    }
+    for (auto it = tables_.begin(); it != tables_.end();) {
+      auto table = it->second.table.lock();
+      if (table == nullptr) {
+        tables_.erase(it++);
+        continue;
+      }
+      TableRetentionSpec spec;
+      auto spec_it = specs_.find(it->second.name);
+      if (spec_it != specs_.end()) {
+        spec = spec_it->second;
+      }
+      auto stats = table->GetTableStats();
+      int64_t bytes_added = stats.bytes_added - it->second.last_bytes_added;
+      it->second.last_bytes_added = stats.bytes_added;
+      // Tables without a time column (or any data) can't be aged, so they are always retained.
+      bool within_min_retention = stats.memory_min_time == -1 ||
+                                  now_ns - stats.memory_min_time < spec.min_retention.count();
+      int64_t floor = spec.min_retention.count() > 0 && within_min_retention ? stats.bytes : 0;
+      shares.push_back({std::move(table), spec.weight, stats.bytes + bytes_added, floor,
+                        stats.max_table_size});
+      ++it;
+    }
+  }
+  if (shares.empty()) {
+    return Status::OK();
+  }
+
+  double total_weight = 0;
+  for (const auto& share : shares) {
+    total_weight += share.weight;
+  }
+  for (auto& share : shares) {
+    auto idle_share = static_cast<int64_t>(budget_bytes * share.weight / total_weight);
+    share.demand = std::max(share.demand, idle_share / kIdleShareDivisor);
+  }
+  Split(budget_bytes, &shares);
+
+  // Shrink tables before growing others, so that the tables as a whole stay within the budget.
+  std::sort(shares.begin(), shares.end(), [](const Share& a, const Share& b) {
+    return a.max_table_size - a.current_max_table_size <
+           b.max_table_size - b.current_max_table_size;
+  });
+  Status status;
+  for (const auto& share : shares) {
+    if (share.max_table_size == share.current_max_table_size) {
+      continue;
+    }
+    auto s = share.table->SetMaxTableSize(share.max_table_size);
+    if (status.ok()) {
+      status = s;
+    }
+  }
+  return status;
+}
+
+void RetentionBudget::Split(int64_t budget_bytes, std::vector<Share>* shares) {
+  // If the minimum retentions don't fit in the budget, scale them down to fit.
+  int64_t total_floor = 0;
+  for (const auto& share : *shares) {
+    total_floor += share.floor;
+  }
+  if (total_floor > budget_bytes) {
+    for (auto& share : *shares) {
+      share.floor = static_cast<int64_t>(static_cast<double>(share.floor) * budget_bytes /
+                                         total_floor);
+    }
+  }
+
+  // Fix the max sizes of the tables whose shares don't apply one pass at a time, recomputing the
+  // shares of the remaining tables after each pass. Tables that need at least their floor are
+  // fixed before tables that need less than their share, so that the remaining budget always
+  // covers the floors of the remaining tables.
+  int64_t remaining = budget_bytes;
+  std::vector<Share*> unfixed;
+  for (auto& share : *shares) {
+    unfixed.push_back(&share);
+  }
+  auto share_of = [&](const Share* share, double total_weight) {
+    return static_cast<int64_t>(remaining * share->weight / total_weight);
+  };
+  while (!unfixed.empty()) {
+    double total_weight = 0;
+    for (const auto* share : unfixed) {
+      total_weight += share->weight;
+    }
+    bool fixed_floor = false;
+    for (auto* share : unfixed) {
+      if (share->floor >= share_of(share, total_weight)) {
+        share->max_table_size = share->floor;
+        fixed_floor = true;
+      }
+    }
+    if (!fixed_floor) {
+      for (auto* share : unfixed) {
+        if (share->demand <= share_of(share, total_weight)) {
+          share->max_table_size = share->demand;
+        }
+      }
+    }
+    std::vector<Share*> next_unfixed;
+    for (auto* share : unfixed) {
+      if (share->max_table_size == -1) {
+        next_unfixed.push_back(share);
+      } else {
+        remaining -= share->max_table_size;
+      }
+    }
+    if (next_unfixed.size() == unfixed.size()) {
+      // Every remaining table needs more than its share, so they split the rest of the budget.
+      for (auto* share : unfixed) {
+        share->max_table_size = share_of(share, total_weight);
+      }
+      break;
+    }
+    unfixed = std::move(next_unfixed);
+  }
+
+  // If every table got what it needs, the rest of the budget is headroom for all of them.
+  int64_t total_max_table_size = 0;
+  double total_weight = 0;
+  for (const auto& share : *shares) {
+    total_max_table_size += share.max_table_size;
+    total_weight += share.weight;
+  }
+  int64_t unused = budget_bytes - total_max_table_size;
+  if (unused > 0) {
+    for (auto& share : *shares) {
+      share.max_table_size += static_cast<int64_t>(unused * share.weight / total_weight);
+    }
+  }
+}
+
+}  // namespace table_store
+}  // namespace px
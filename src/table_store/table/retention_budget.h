@@ -0,0 +1,129 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/common/base/base.h"
+#include "src/table_store/table/table.h"
+
+namespace px {
+namespace table_store {
+
+/**
+ * TableRetentionSpec configures the share of a table in the retention budget.
+ */
+struct TableRetentionSpec {
+  // The weight of the table, relative to the weights of the other tables.
+  double weight = 1.0;
+  // As long as the table holds less than this much data in memory, it isn't shrunk to make room
+  // for other tables.
+  std::chrono::nanoseconds min_retention = std::chrono::nanoseconds(0);
+};
+
+using TableRetentionSpecs = absl::flat_hash_map<std::string, TableRetentionSpec>;
+
+/**
+ * RetentionBudget splits a memory budget between the tables of a table store, by setting their
+ * maximum sizes.
+ *
+ * Each rebalance gives every table a share of the budget proportional to its weight. A table that
+ * needs less than its share (its current size plus what it was written since the last rebalance)
+ * only gets what it needs, and the rest of its share is split between the other tables (or between
+ * all of them, once every table has what it needs). A table
+ * that holds less than its minimum retention of data keeps at least its current size. Tables whose
+ * maximum size shrinks expire their oldest batches right away, so that the tables stay within the
+ * budget as a whole.
+ *
+ * Tablets of a table each get the full weight of the table. Tables are only referenced weakly, so
+ * dropped tables leave the budget.
+ */
+class RetentionBudget : public NotCopyMoveable {
+ public:
+  RetentionBudget() = default;
+
+  /**
+   * Parses the retention specs of tables from comma separated lists of `table_name=value` pairs,
+   * e.g. "http_events=4,process_stats=0.5" for the weights and "process_stats=3600" for the minimum
+   * retentions in seconds, into the given specs. Values that are missing from the lists are left
+   * as they are in specs.
+   */
+  static Status ParseSpecs(std::string_view weights, std::string_view min_retentions_s,
+                           TableRetentionSpecs* specs);
+
+  /**
+   * Sets the memory budget and the retention specs of the tables. A budget that isn't positive
+   * disables rebalancing, leaving the tables at their current maximum sizes.
+   */
+  void Configure(int64_t budget_bytes, TableRetentionSpecs specs);
+
+  /**
+   * Adds a table to the budget under the given name. Adding a table again is a no-op.
+   */
+  void AddTable(const std::string& table_name, const std::shared_ptr<Table>& table);
+
+  /**
+   * Recomputes the shares of the tables and applies them, as of the current time.
+   */
+  Status Rebalance();
+
+  /**
+   * Recomputes the shares of the tables and applies them, as of the given time.
+   * @param now_ns the current time, in the time base of the time_ columns of the tables.
+   */
+  Status Rebalance(int64_t now_ns);
+
+ private:
+  struct TableState {
+    std::string name;
+    std::weak_ptr<Table> table;
+    // The bytes_added of the table as of the last rebalance.
+    int64_t last_bytes_added = 0;
+  };
+
+  struct Share {
+    std::shared_ptr<Table> table;
+    double weight;
+    // The bytes the table needs until the next rebalance.
+    int64_t demand;
+    // The bytes the table keeps to honor its minimum retention.
+    int64_t floor;
+    int64_t current_max_table_size;
+    int64_t max_table_size = -1;
+  };
+
+  // Splits the budget between the shares, setting their max_table_size.
+  static void Split(int64_t budget_bytes, std::vector<Share>* shares);
+
+  absl::Mutex lock_;
+  int64_t budget_bytes_ ABSL_GUARDED_BY(lock_) = 0;
+  TableRetentionSpecs specs_ ABSL_GUARDED_BY(lock_);
+  // Keyed by the table, which is only used for lookups, never dereferenced.
+  absl::flat_hash_map<const Table*, TableState> tables_ ABSL_GUARDED_BY(lock_);
+};
+
+}  // namespace table_store
+}  // namespace px
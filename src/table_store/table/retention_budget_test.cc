@@ -0,0 +1,158 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/retention_budget.h"
+
+namespace px {
+namespace table_store {
+
+constexpr int64_t kBudget = 100000;
+// Each batch has 1000 rows of 16 bytes.
+constexpr int64_t kBatchBytes = 16000;
+constexpr int64_t kNow = 1000L * 1000 * 1000 * 1000;
+
+class RetentionBudgetTest : public ::testing::Test {
+ protected:
+  std::shared_ptr<Table> MakeTable(int num_batches) {
+    schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "col1"});
+    auto table = std::make_shared<Table>("test_table", rel, kBudget);
+    WriteBatches(table.get(), num_batches);
+    return table;
+  }
+
+  void WriteBatches(Table* table, int num_batches) {
+    for (int batch = 0; batch < num_batches; ++batch) {
+      std::vector<types::Time64NSValue> times(1000, kNow);
+      std::vector<types::Int64Value> col1(1000, batch);
+      auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+      rb_wrapper->push_back(types::ColumnWrapper::FromArrow(
+          types::DataType::TIME64NS, types::ToArrow(times, arrow::default_memory_pool())));
+      rb_wrapper->push_back(
+          types::ColumnWrapper::FromArrow(types::ToArrow(col1, arrow::default_memory_pool())));
+      PX_CHECK_OK(table->TransferRecordBatch(std::move(rb_wrapper)));
+    }
+  }
+
+  RetentionBudget budget_;
+};
+
+TEST_F(RetentionBudgetTest, parse_specs) {
+  TableRetentionSpecs specs;
+  specs["http_events"].weight = 2;
+  ASSERT_OK(RetentionBudget::ParseSpecs("process_stats=0.5, conn_stats=3", "http_events=60",
+                                        &specs));
+  EXPECT_EQ(3, specs.size());
+  EXPECT_EQ(2, specs["http_events"].weight);
+  EXPECT_EQ(std::chrono::seconds(60), specs["http_events"].min_retention);
+  EXPECT_EQ(0.5, specs["process_stats"].weight);
+  EXPECT_EQ(3, specs["conn_stats"].weight);
+
+  EXPECT_NOT_OK(RetentionBudget::ParseSpecs("process_stats", "", &specs));
+  EXPECT_NOT_OK(RetentionBudget::ParseSpecs("process_stats=abc", "", &specs));
+  EXPECT_NOT_OK(RetentionBudget::ParseSpecs("process_stats=0", "", &specs));
+  EXPECT_NOT_OK(RetentionBudget::ParseSpecs("", "process_stats=-1", &specs));
+}
+
+TEST_F(RetentionBudgetTest, disabled_without_budget) {
+  auto table = MakeTable(5);
+  budget_.AddTable("a", table);
+  ASSERT_OK(budget_.Rebalance(kNow));
+  EXPECT_EQ(kBudget, table->GetTableStats().max_table_size);
+}
+
+TEST_F(RetentionBudgetTest, split_by_weight) {
+  auto table_a = MakeTable(5);
+  auto table_b = MakeTable(5);
+  TableRetentionSpecs specs;
+  specs["a"].weight = 3;
+  budget_.Configure(kBudget, specs);
+  budget_.AddTable("a", table_a);
+  budget_.AddTable("b", table_b);
+
+  ASSERT_OK(budget_.Rebalance(kNow));
+  auto stats_a = table_a->GetTableStats();
+  auto stats_b = table_b->GetTableStats();
+  EXPECT_EQ(75000, stats_a.max_table_size);
+  EXPECT_EQ(25000, stats_b.max_table_size);
+  EXPECT_EQ(4 * kBatchBytes, stats_a.bytes);
+  EXPECT_EQ(kBatchBytes, stats_b.bytes);
+}
+
+TEST_F(RetentionBudgetTest, unused_share_goes_to_other_tables) {
+  auto table_a = MakeTable(1);
+  auto table_b = MakeTable(5);
+  budget_.Configure(kBudget, {});
+  budget_.AddTable("a", table_a);
+  budget_.AddTable("b", table_b);
+
+  ASSERT_OK(budget_.Rebalance(kNow));
+  // Table a needs its current bytes, plus the bytes it was written since the last rebalance.
+  EXPECT_EQ(2 * kBatchBytes, table_a->GetTableStats().max_table_size);
+  EXPECT_EQ(kBudget - 2 * kBatchBytes, table_b->GetTableStats().max_table_size);
+  EXPECT_EQ(4 * kBatchBytes, table_b->GetTableStats().bytes);
+
+  // Without new writes, the tables only need their current bytes, and split the rest by weight.
+  ASSERT_OK(budget_.Rebalance(kNow));
+  EXPECT_EQ(kBatchBytes + 10000, table_a->GetTableStats().max_table_size);
+  EXPECT_EQ(4 * kBatchBytes + 10000, table_b->GetTableStats().max_table_size);
+}
+
+TEST_F(RetentionBudgetTest, min_retention) {
+  auto table_a = MakeTable(5);
+  auto table_b = MakeTable(5);
+  TableRetentionSpecs specs;
+  specs["b"].weight = 3;
+  specs["a"].min_retention = std::chrono::hours(1);
+  budget_.Configure(kBudget, specs);
+  budget_.AddTable("a", table_a);
+  budget_.AddTable("b", table_b);
+
+  // Table a holds less than an hour of data, so it keeps all of it.
+  ASSERT_OK(budget_.Rebalance(kNow));
+  EXPECT_EQ(5 * kBatchBytes, table_a->GetTableStats().bytes);
+  EXPECT_EQ(kBudget - 5 * kBatchBytes, table_b->GetTableStats().max_table_size);
+  EXPECT_EQ(kBatchBytes, table_b->GetTableStats().bytes);
+
+  WriteBatches(table_b.get(), 5);
+  auto later = kNow + std::chrono::nanoseconds(std::chrono::hours(2)).count();
+  ASSERT_OK(budget_.Rebalance(later));
+  EXPECT_EQ(25000, table_a->GetTableStats().max_table_size);
+  EXPECT_EQ(kBatchBytes, table_a->GetTableStats().bytes);
+  EXPECT_EQ(75000, table_b->GetTableStats().max_table_size);
+}
+
+TEST_F(RetentionBudgetTest, dropped_tables_leave_the_budget) {
+  auto table_a = MakeTable(5);
+  budget_.Configure(kBudget, {});
+  budget_.AddTable("a", table_a);
+  {
+    auto table_b = MakeTable(5);
+    budget_.AddTable("b", table_b);
+  }
+  ASSERT_OK(budget_.Rebalance(kNow));
+  EXPECT_EQ(kBudget, table_a->GetTableStats().max_table_size);
+}
+
+}  // namespace table_store
+}  // namespace px
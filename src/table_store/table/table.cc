@@ -17,23 +17,31 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstddef>
 #include <iterator>
 #include <memory>
+#include <numeric>
 #include <optional>
 #include <string>
 #include <variant>
 #include <vector>
 
+#include <absl/strings/ascii.h>
 #include <absl/strings/str_format.h>
+#include <absl/strings/str_split.h>
+#include <absl/strings/substitute.h>
 #include "internal/store_with_row_accounting.h"
 #include "src/common/base/base.h"
 #include "src/common/base/status.h"
+#include "src/common/perf/perf.h"
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/type_utils.h"
 #include "src/table_store/schema/relation.h"
 #include "src/table_store/table/internal/batch_size_accountant.h"
+#include "src/table_store/table/internal/column_encodings.h"
+#include "src/table_store/table/internal/dictionary_column.h"
 #include "src/table_store/table/internal/record_or_row_batch.h"
 #include "src/table_store/table/internal/types.h"
 #include "src/table_store/table/table.h"
@@ -45,6 +53,46 @@ DEFINE_int32(table_store_table_size_limit,
              "The maximal size a table allows. When the size grows beyond this limit, "
              "old data will be discarded.");
 
+DEFINE_bool(table_store_zone_maps, gflags::BoolFromEnv("PL_TABLE_STORE_ZONE_MAPS", true),
+            "Keep the min/max and a bloom filter of the distinct values of the columns of each "
+            "batch of the cold store, so that reads with predicates can skip batches.");
+
+DEFINE_bool(table_store_encode_cold_columns,
+            gflags::BoolFromEnv("PL_TABLE_STORE_ENCODE_COLD_COLUMNS", true),
+            "Delta encode the int and time columns, and run length encode the UINT128 columns, of "
+            "the batches of the cold store whenever that saves memory.");
+
+DEFINE_int32(table_store_dictionary_encode_max_cardinality,
+             gflags::Int32FromEnv("PL_TABLE_STORE_DICTIONARY_ENCODE_MAX_CARDINALITY", 1024),
+             "String columns of a compacted batch with at most this many distinct values are "
+             "stored dictionary encoded in the cold store. Zero disables dictionary encoding.");
+
+DEFINE_string(table_store_disk_tier_dir,
+              gflags::StringFromEnv("PL_TABLE_STORE_DISK_TIER_DIR", ""),
+              "The local directory that cold batches are written to once they expire out of "
+              "memory, so that they stay queryable. Empty disables the disk tier.");
+
+DEFINE_int64(table_store_disk_tier_max_bytes,
+             gflags::Int64FromEnv("PL_TABLE_STORE_DISK_TIER_MAX_BYTES", 256 * 1024 * 1024),
+             "The maximal size of the disk tier of a table. When the size grows beyond this limit, "
+             "the oldest batches on disk are discarded.");
+
+DEFINE_int64(table_store_disk_segment_bytes,
+             gflags::Int64FromEnv("PL_TABLE_STORE_DISK_SEGMENT_BYTES", 64 * 1024 * 1024),
+             "The size after which the disk tier of a table starts writing to a new segment file. "
+             "A segment file is removed once all of its batches are discarded.");
+
+DEFINE_string(table_store_index_columns,
+              gflags::StringFromEnv("PL_TABLE_STORE_INDEX_COLUMNS", "upid"),
+              "Comma separated names of the columns that get a secondary index in every table that "
+              "has them, so that reads filtering on one of their values skip the other batches.");
+
+DEFINE_int64(table_store_decoded_column_cache_bytes,
+             gflags::Int64FromEnv("PL_TABLE_STORE_DECODED_COLUMN_CACHE_BYTES", 32 * 1024 * 1024),
+             "The size of the cache of decoded cold batch columns shared by the tables of a table "
+             "store, so that repeated reads of encoded columns don't decode them every time. It is "
+             "taken out of the retention budget of the table store. Zero disables the cache.");
+
 namespace px {
 namespace table_store {
 
@@ -128,6 +176,13 @@ bool Table::Cursor::NextBatchReady() {
 }
 
 bool Table::Cursor::Done() {
+  if (reverse_) {
+    return reverse_first_row_id_ >= stop_.stop_row_id;
+  }
+  return ReachedStop();
+}
+
+bool Table::Cursor::ReachedStop() {
   auto next_row_id = last_read_row_id_ + 1;
   switch (stop_.spec.type) {
     case StopSpec::StopType::StopAtTimeOrEndOfTable:
@@ -151,6 +206,16 @@ bool Table::Cursor::Done() {
 
 void Table::Cursor::UpdateStopSpec(Cursor::StopSpec stop) { StopStateFromSpec(std::move(stop)); }
 
+Status Table::Cursor::SetReverse() {
+  if (stop_.spec.type != StopSpec::StopType::CurrentEndOfTable &&
+      stop_.spec.type != StopSpec::StopType::StopAtTimeOrEndOfTable) {
+    return error::InvalidArgument("Only cursors that stop at a fixed row can be reversed.");
+  }
+  reverse_ = true;
+  reverse_first_row_id_ = last_read_row_id_ + 1;
+  return Status::OK();
+}
+
 internal::RowID* Table::Cursor::LastReadRowID() { return &last_read_row_id_; }
 
 internal::BatchHints* Table::Cursor::Hints() { return &hints_; }
@@ -162,9 +227,150 @@ std::optional<internal::RowID> Table::Cursor::StopRowID() const {
   return stop_.stop_row_id;
 }
 
+std::vector<Table::Cursor> Table::SplitCursor(Cursor::StartSpec start, Cursor::StopSpec stop,
+                                              int64_t num_splits) const {
+  std::vector<Cursor> cursors;
+  cursors.emplace_back(this, std::move(start), std::move(stop));
+  auto stop_type = cursors.front().stop_.spec.type;
+  if (num_splits <= 1 || cursors.front().Done() ||
+      (stop_type != Cursor::StopSpec::StopType::CurrentEndOfTable &&
+       stop_type != Cursor::StopSpec::StopType::StopAtTimeOrEndOfTable)) {
+    return cursors;
+  }
+  RowID first_row_id = cursors.front().last_read_row_id_ + 1;
+  RowID stop_row_id = cursors.front().stop_.stop_row_id;
+
+  // The batch boundaries strictly within the rows of the cursor.
+  std::vector<RowID> boundaries;
+  {
+    absl::ReaderMutexLock disk_lock(&disk_lock_);
+    absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+    PublishPendingHotBatchesUnlocked();
+    disk_store_->AppendBatchFirstRowIDs(first_row_id + 1, stop_row_id - 1, &boundaries);
+    cold_store_->AppendBatchFirstRowIDs(first_row_id + 1, stop_row_id - 1, &boundaries);
+    hot_store_->AppendBatchFirstRowIDs(first_row_id + 1, stop_row_id - 1, &boundaries);
+  }
+
+  // Split at the first boundary after each multiple of the target number of rows, so that the
+  // cursors get about as many rows each.
+  std::vector<RowID> split_row_ids;
+  auto target_rows = static_cast<double>(stop_row_id - first_row_id) / num_splits;
+  for (RowID boundary : boundaries) {
+    if (static_cast<int64_t>(split_row_ids.size()) + 1 >= num_splits) {
+      break;
+    }
+    if (boundary >= first_row_id + target_rows * (split_row_ids.size() + 1)) {
+      split_row_ids.push_back(boundary);
+    }
+  }
+
+  for (RowID split_row_id : split_row_ids) {
+    // Each cursor stops where the next one starts.
+    auto& prev = cursors.back();
+    prev.stop_.spec.type = Cursor::StopSpec::StopType::CurrentEndOfTable;
+    prev.stop_.stop_row_id = split_row_id;
+    Cursor next = prev;
+    next.last_read_row_id_ = split_row_id - 1;
+    next.stop_.stop_row_id = stop_row_id;
+    cursors.push_back(std::move(next));
+  }
+  return cursors;
+}
+
+void Table::Cursor::UpdatePredicates() {
+  predicates_ = hint_predicates_;
+  predicates_.insert(predicates_.end(), filter_predicates_.begin(), filter_predicates_.end());
+}
+
 StatusOr<std::unique_ptr<schema::RowBatch>> Table::Cursor::GetNextRowBatch(
     const std::vector<int64_t>& cols) {
-  return table_->GetNextRowBatch(this, cols);
+  if (reverse_) {
+    return ReadPrevRowBatch(cols);
+  }
+  return ReadNextRowBatch(cols);
+}
+
+StatusOr<int64_t> Table::Cursor::SkipNextRowBatch() {
+  std::unique_ptr<schema::RowBatch> rb;
+  if (reverse_) {
+    PX_ASSIGN_OR_RETURN(rb, ReadPrevRowBatch({}));
+  } else {
+    // The filter predicates don't need to be evaluated on rows that are skipped anyway.
+    PX_ASSIGN_OR_RETURN(rb, table_->GetNextRowBatch(this, {}));
+  }
+  return rb->num_rows();
+}
+
+StatusOr<std::unique_ptr<schema::RowBatch>> Table::Cursor::ReadPrevRowBatch(
+    const std::vector<int64_t>& cols) {
+  DCHECK(!Done()) << "Calling GetNextRowBatch on an exhausted Cursor";
+  RowID last_row_id = stop_.stop_row_id - 1;
+  std::unique_ptr<schema::RowBatch> rb;
+  while (true) {
+    auto batch_first_row_id = table_->BatchFirstRowID(last_row_id);
+    if (!batch_first_row_id.has_value()) {
+      // The rest of the rows expired.
+      stop_.stop_row_id = reverse_first_row_id_;
+      return table_->EmptyRowBatch(cols);
+    }
+    // The batch is read forwards, up to the stop row.
+    RowID first_row_id = std::max(batch_first_row_id.value(), reverse_first_row_id_);
+    last_read_row_id_ = first_row_id - 1;
+    PX_ASSIGN_OR_RETURN(rb, ReadNextRowBatch(cols));
+    // If the batch was compacted in between, the read can stop at the end of the new batch that
+    // holds first_row_id, in which case the lookup is repeated.
+    if (last_read_row_id_ >= last_row_id) {
+      stop_.stop_row_id = first_row_id;
+      break;
+    }
+  }
+  if (rb->num_rows() <= 1) {
+    return rb;
+  }
+  std::vector<int64_t> col_positions(cols.size());
+  std::iota(col_positions.begin(), col_positions.end(), 0);
+  std::vector<int64_t> rows(rb->num_rows());
+  std::iota(rows.rbegin(), rows.rend(), 0);
+  PX_ASSIGN_OR_RETURN(auto reversed, rb->Select(col_positions, std::move(rows)));
+  reversed->set_eow(rb->eow());
+  reversed->set_eos(rb->eos());
+  return reversed;
+}
+
+StatusOr<std::unique_ptr<schema::RowBatch>> Table::Cursor::ReadNextRowBatch(
+    const std::vector<int64_t>& cols) {
+  if (filter_predicates_.empty()) {
+    return table_->GetNextRowBatch(this, cols);
+  }
+  // Also read the predicate columns that weren't requested, after the requested ones.
+  std::vector<int64_t> read_cols = cols;
+  std::vector<int64_t> predicate_positions;
+  for (const auto& predicate : filter_predicates_) {
+    auto it = std::find(read_cols.begin(), read_cols.end(), predicate.column_index);
+    predicate_positions.push_back(std::distance(read_cols.begin(), it));
+    if (it == read_cols.end()) {
+      read_cols.push_back(predicate.column_index);
+    }
+  }
+  PX_ASSIGN_OR_RETURN(auto rb, table_->GetNextRowBatch(this, read_cols));
+  std::vector<int64_t> rows(rb->num_rows());
+  std::iota(rows.begin(), rows.end(), 0);
+  for (size_t i = 0; i < filter_predicates_.size() && !rows.empty(); ++i) {
+    const auto& predicate = filter_predicates_[i];
+    PX_RETURN_IF_ERROR(internal::FilterMatchingRows(
+        table_->rel_.GetColumnType(static_cast<size_t>(predicate.column_index)),
+        *rb->ColumnAt(predicate_positions[i]), predicate, &rows));
+  }
+  if (static_cast<int64_t>(rows.size()) == rb->num_rows() && read_cols.size() == cols.size()) {
+    return rb;
+  }
+  std::vector<int64_t> col_positions(cols.size());
+  std::iota(col_positions.begin(), col_positions.end(), 0);
+  PX_ASSIGN_OR_RETURN(auto filtered, rb->Select(col_positions, std::move(rows)));
+  filtered->set_eow(rb->eow());
+  filtered->set_eos(rb->eos());
+  return filtered;
 }
 
 Table::Table(std::string_view table_name, const schema::Relation& relation, size_t max_table_size,
@@ -175,6 +381,7 @@ Table::Table(std::string_view table_name, const schema::Relation& relation, size
       compacted_batch_size_(compacted_batch_size),
       // TODO(james): move mem_pool into constructor.
       compactor_(rel_, arrow::default_memory_pool()) {
+  absl::MutexLock disk_lock(&disk_lock_);
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
   for (const auto& [i, col_name] : Enumerate(rel_.col_names())) {
@@ -182,11 +389,26 @@ Table::Table(std::string_view table_name, const schema::Relation& relation, size
       time_col_idx_ = i;
     }
   }
+  for (std::string_view col_name :
+       absl::StrSplit(FLAGS_table_store_index_columns, ',', absl::SkipWhitespace())) {
+    std::string name(absl::StripAsciiWhitespace(col_name));
+    if (!rel_.HasColumn(name)) {
+      continue;
+    }
+    int64_t col_idx = rel_.GetColumnIndex(name);
+    auto data_type = rel_.GetColumnType(col_idx);
+    if (internal::SecondaryIndex::CanIndex(data_type)) {
+      indexes_.push_back(
+          {col_idx, data_type, std::make_unique<internal::SecondaryIndex>(data_type)});
+    }
+  }
   batch_size_accountant_ = internal::BatchSizeAccountant::Create(rel_, compacted_batch_size_);
   hot_store_ = std::make_unique<internal::StoreWithRowTimeAccounting<internal::StoreType::Hot>>(
       rel_, time_col_idx_);
   cold_store_ = std::make_unique<internal::StoreWithRowTimeAccounting<internal::StoreType::Cold>>(
       rel_, time_col_idx_);
+  disk_store_ = std::make_unique<internal::StoreWithRowTimeAccounting<internal::StoreType::Disk>>(
+      rel_, time_col_idx_);
 }
 
 Status Table::ToProto(table_store::schemapb::Table* table_proto) const {
@@ -211,55 +433,129 @@ Status Table::ToProto(table_store::schemapb::Table* table_proto) const {
 
 StatusOr<std::unique_ptr<schema::RowBatch>> Table::GetNextRowBatch(
     Cursor* cursor, const std::vector<int64_t>& cols) const {
-  DCHECK(!cursor->Done()) << "Calling GetNextRowBatch on an exhausted Cursor";
+  DCHECK(!cursor->ReachedStop()) << "Calling GetNextRowBatch on an exhausted Cursor";
+  absl::ReaderMutexLock disk_lock(&disk_lock_);
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+  auto stop_row_id = cursor->StopRowID();
+  if (disk_store_->Size() > 0 && *cursor->LastReadRowID() + 1 < disk_store_->FirstRowID()) {
+    // If the cursor was pointing to a batch that expired from the disk tier, update the cursor to
+    // point to the start of the table.
+    *cursor->LastReadRowID() = disk_store_->FirstRowID() - 1;
+    if (stop_row_id.has_value() && disk_store_->FirstRowID() >= stop_row_id.value()) {
+      return EmptyRowBatch(cols);
+    }
+  }
+  int64_t num_skipped = 0;
+  if (!cursor->predicates_.empty() && !indexes_.empty()) {
+    auto start_row_id = *cursor->LastReadRowID() + 1;
+    RowID indexed_end_row_id;
+    auto next_row_id = NextIndexedRowID(start_row_id, cursor->predicates_, &indexed_end_row_id);
+    if (stop_row_id.has_value()) {
+      next_row_id = std::min(next_row_id, stop_row_id.value());
+    }
+    if (next_row_id > start_row_id) {
+      *cursor->LastReadRowID() = next_row_id - 1;
+      if (next_row_id >= indexed_end_row_id ||
+          (stop_row_id.has_value() && next_row_id >= stop_row_id.value())) {
+        // None of the rows written so far (before the stop) can match.
+        return EmptyRowBatch(cols);
+      }
+      ++num_skipped;
+    }
+  }
+  if (!cursor->predicates_.empty()) {
+    auto skip_batch = [&](const auto& batch) {
+      return !internal::BatchMayMatch(batch.zone_maps, cursor->predicates_);
+    };
+    num_skipped = disk_store_->SkipBatches(cursor->LastReadRowID(), cursor->Hints(), stop_row_id,
+                                           skip_batch);
+    num_skipped += cold_store_->SkipBatches(cursor->LastReadRowID(), cursor->Hints(),
+                                            stop_row_id, skip_batch);
+  }
+  if (num_skipped > 0 && stop_row_id.has_value() &&
+      *cursor->LastReadRowID() + 1 >= stop_row_id.value()) {
+    // Every row left before the stop was skipped.
+    return EmptyRowBatch(cols);
+  }
   PX_ASSIGN_OR_RETURN(auto rb,
-                      cold_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
+                      disk_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
                                                    cursor->StopRowID(), cols));
+  if (rb == nullptr) {
+    PX_ASSIGN_OR_RETURN(rb, cold_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
+                                                         cursor->StopRowID(), cols));
+  }
   if (rb == nullptr) {
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+    PublishPendingHotBatchesUnlocked();
     PX_ASSIGN_OR_RETURN(rb, hot_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
                                                         cursor->StopRowID(), cols));
     if (rb == nullptr && hot_store_->Size() > 0) {
       // If the cursor was pointing to an expired row batch, update the cursor to point to the start
       // of the table, then try to get the next row batch.
       *cursor->LastReadRowID() = hot_store_->FirstRowID() - 1;
-      if (!cursor->Done()) {
+      if (!cursor->ReachedStop()) {
         PX_ASSIGN_OR_RETURN(rb,
                             hot_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
                                                         cursor->StopRowID(), cols));
       }
     }
   }
+  if (rb == nullptr && num_skipped > 0) {
+    // The skipped batches were the last ones in the table.
+    return EmptyRowBatch(cols);
+  }
   if (rb == nullptr) {
     return error::InvalidArgument("Data after Cursor is not in the table.");
   }
   return rb;
 }
 
-Status Table::ExpireRowBatches(int64_t row_batch_size) {
-  if (row_batch_size > max_table_size_) {
-    return error::InvalidArgument("RowBatch size ($0) is bigger than maximum table size ($1).",
-                                  row_batch_size, max_table_size_);
+std::optional<Table::RowID> Table::BatchFirstRowID(RowID row_id) const {
+  absl::ReaderMutexLock disk_lock(&disk_lock_);
+  absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+  absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+  PublishPendingHotBatchesUnlocked();
+  auto first_row_id = disk_store_->FindBatchFirstRowID(row_id);
+  if (!first_row_id.has_value()) {
+    first_row_id = cold_store_->FindBatchFirstRowID(row_id);
   }
-  int64_t bytes;
-  {
-    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-    bytes = batch_size_accountant_->HotBytes() + batch_size_accountant_->ColdBytes();
+  if (!first_row_id.has_value()) {
+    first_row_id = hot_store_->FindBatchFirstRowID(row_id);
+  }
+  return first_row_id;
+}
+
+StatusOr<std::unique_ptr<schema::RowBatch>> Table::EmptyRowBatch(
+    const std::vector<int64_t>& cols) const {
+  std::vector<types::DataType> col_types;
+  for (int64_t col_idx : cols) {
+    col_types.push_back(rel_.col_types()[col_idx]);
+  }
+  return schema::RowBatch::WithZeroRows(schema::RowDescriptor(col_types), /* eow */ false,
+                                        /* eos */ false);
+}
+
+StatusOr<bool> Table::ExpireRowBatches(int64_t row_batch_size) {
+  int64_t max_table_size = max_table_size_.load();
+  if (row_batch_size > max_table_size) {
+    return error::InvalidArgument("RowBatch size ($0) is bigger than maximum table size ($1).",
+                                  row_batch_size, max_table_size);
   }
-  while (bytes + row_batch_size > max_table_size_) {
+  // The byte counts are read without the hot lock, so that writes only wait for readers when they
+  // have to expire data.
+  int64_t bytes = stored_bytes_.load() + pending_hot_bytes_.load();
+  bool expired = false;
+  while (bytes + row_batch_size > max_table_size_.load()) {
     PX_RETURN_IF_ERROR(ExpireBatch());
-    {
-      absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-      bytes = batch_size_accountant_->HotBytes() + batch_size_accountant_->ColdBytes();
-    }
+    expired = true;
+    bytes = stored_bytes_.load() + pending_hot_bytes_.load();
     {
       absl::base_internal::SpinLockHolder lock(&stats_lock_);
       batches_expired_++;
       metrics_.batches_expired_counter.Increment();
     }
   }
-  return Status::OK();
+  return expired;
 }
 
 Status Table::WriteRowBatch(const schema::RowBatch& rb) {
@@ -267,6 +563,11 @@ Status Table::WriteRowBatch(const schema::RowBatch& rb) {
   if (rb.num_columns() == 0 || rb.ColumnAt(0)->length() == 0) {
     return Status::OK();
   }
+  // Views materialize their columns lazily, which isn't safe once readers share the batch.
+  if (rb.has_selection()) {
+    PX_ASSIGN_OR_RETURN(auto materialized_rb, rb.Materialize());
+    return WriteRowBatch(*materialized_rb);
+  }
 
   internal::RecordOrRowBatch record_or_row_batch(rb);
 
@@ -292,41 +593,118 @@ Status Table::TransferRecordBatch(
   return Status::OK();
 }
 
+std::vector<std::vector<internal::ZoneMapValue>> Table::IndexValues(
+    const internal::RecordOrRowBatch& batch) const {
+  std::vector<std::vector<internal::ZoneMapValue>> index_values;
+  for (const auto& index : indexes_) {
+    schema::RowBatch rb(schema::RowDescriptor({index.data_type}), batch.Length());
+    auto s = batch.AddBatchSliceToRowBatch(0, batch.Length(), {index.col_idx}, &rb);
+    DCHECK(s.ok()) << s.msg();
+    index_values.push_back(
+        internal::SecondaryIndex::DistinctValues(index.data_type, *rb.ColumnAt(0)));
+  }
+  return index_values;
+}
+
+Table::RowID Table::NextIndexedRowID(RowID row_id,
+                                     const std::vector<internal::ColumnPredicate>& predicates,
+                                     RowID* indexed_end_row_id) const {
+  absl::base_internal::SpinLockHolder index_lock(&index_lock_);
+  *indexed_end_row_id = indexes_.front().index->EndRowID();
+  // Advance row_id until every indexed predicate agrees that it may match.
+  bool advanced = true;
+  while (advanced && row_id < *indexed_end_row_id) {
+    advanced = false;
+    for (const auto& predicate : predicates) {
+      for (const auto& index : indexes_) {
+        if (index.col_idx != predicate.column_index) {
+          continue;
+        }
+        auto next_row_id = index.index->NextMatchingRowID(predicate, row_id);
+        if (next_row_id > row_id) {
+          row_id = next_row_id;
+          advanced = true;
+        }
+      }
+    }
+  }
+  return row_id;
+}
+
 Status Table::WriteHot(internal::RecordOrRowBatch&& record_or_row_batch) {
   // See BatchSizeAccountantNonMutableState for an explanation of the thread safety and necessity of
   // NonMutableState.
   auto batch_stats = internal::BatchSizeAccountant::CalcBatchStats(
       ABSL_TS_UNCHECKED_READ(batch_size_accountant_)->NonMutableState(), record_or_row_batch);
 
-  PX_RETURN_IF_ERROR(ExpireRowBatches(batch_stats.bytes));
-
-  {
-    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-    auto batch_length = record_or_row_batch.Length();
-    batch_size_accountant_->NewHotBatch(std::move(batch_stats));
-    hot_store_->EmplaceBack(next_row_id_, std::move(record_or_row_batch));
-    next_row_id_ += batch_length;
-  }
+  PX_ASSIGN_OR_RETURN(bool expired, ExpireRowBatches(batch_stats.bytes));
 
+  int64_t batch_bytes = batch_stats.bytes;
   {
     absl::base_internal::SpinLockHolder lock(&stats_lock_);
     ++batches_added_;
     metrics_.batches_added_counter.Increment();
-    bytes_added_ += batch_stats.bytes;
-    metrics_.bytes_added_counter.Increment(batch_stats.bytes);
+    bytes_added_ += batch_bytes;
+    metrics_.bytes_added_counter.Increment(batch_bytes);
   }
 
-  // Make sure locks are released for this call, since they are reacquired inside.
-  PX_RETURN_IF_ERROR(UpdateTableMetricGauges());
+  // The batch is published to the hot store by whoever next holds the hot lock. If a reader holds
+  // it right now, the write doesn't wait for it.
+  pending_hot_bytes_ += batch_bytes;
+  auto index_values = IndexValues(record_or_row_batch);
+  pending_hot_batches_.Push(std::move(record_or_row_batch), std::move(batch_stats),
+                            std::move(index_values));
+  if (hot_lock_.TryLock()) {
+    PublishPendingHotBatchesUnlocked();
+    hot_lock_.Unlock();
+  }
+  NotifyWriteListeners();
+
+  // Updating the gauges has to take the store locks, so it's only done by the writes that already
+  // had to take them to expire data. Compaction updates the gauges as well.
+  if (expired) {
+    // Make sure locks are released for this call, since they are reacquired inside.
+    PX_RETURN_IF_ERROR(UpdateTableMetricGauges());
+  }
   return Status::OK();
 }
 
+void Table::PublishPendingHotBatchesUnlocked() const {
+  if (pending_hot_batches_.Empty()) {
+    return;
+  }
+  for (auto& pending : pending_hot_batches_.TakeAll()) {
+    auto batch_length = pending.batch.Length();
+    batch_size_accountant_->NewHotBatch(pending.stats);
+    hot_store_->EmplaceBack(next_row_id_, std::move(pending.batch));
+    if (!indexes_.empty()) {
+      absl::base_internal::SpinLockHolder index_lock(&index_lock_);
+      for (const auto& [i, index] : Enumerate(indexes_)) {
+        index.index->AddBatch(next_row_id_, next_row_id_ + batch_length - 1,
+                              pending.index_values[i]);
+      }
+    }
+    next_row_id_ += batch_length;
+    UpdateStoredBytesUnlocked();
+    pending_hot_bytes_ -= pending.stats.bytes;
+  }
+}
+
+void Table::UpdateStoredBytesUnlocked() const {
+  stored_bytes_ = batch_size_accountant_->HotBytes() + batch_size_accountant_->ColdBytes();
+}
+
 Table::RowID Table::FirstRowID() const {
+  absl::ReaderMutexLock disk_lock(&disk_lock_);
+  if (disk_store_->Size() > 0) {
+    return disk_store_->FirstRowID();
+  }
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
   if (cold_store_->Size() > 0) {
     return cold_store_->FirstRowID();
   }
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+  PublishPendingHotBatchesUnlocked();
   if (hot_store_->Size() > 0) {
     return hot_store_->FirstRowID();
   }
@@ -334,36 +712,77 @@ Table::RowID Table::FirstRowID() const {
 }
 
 Table::RowID Table::LastRowID() const {
+  absl::ReaderMutexLock disk_lock(&disk_lock_);
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+  PublishPendingHotBatchesUnlocked();
   if (hot_store_->Size() > 0) {
     return hot_store_->LastRowID();
   }
   if (cold_store_->Size() > 0) {
     return cold_store_->LastRowID();
   }
+  if (disk_store_->Size() > 0) {
+    return disk_store_->LastRowID();
+  }
   return -1;
 }
 
 Table::Time Table::MaxTime() const {
+  absl::ReaderMutexLock disk_lock(&disk_lock_);
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+  PublishPendingHotBatchesUnlocked();
   if (hot_store_->Size() > 0) {
     return hot_store_->MaxTime();
   }
   if (cold_store_->Size() > 0) {
     return cold_store_->MaxTime();
   }
+  if (disk_store_->Size() > 0) {
+    return disk_store_->MaxTime();
+  }
   return -1;
 }
 
+std::pair<Table::Time, Table::Time> Table::TimeRange() const {
+  absl::ReaderMutexLock disk_lock(&disk_lock_);
+  absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+  absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+  PublishPendingHotBatchesUnlocked();
+  // The stores hold consecutive time ranges, in the order disk, cold, hot.
+  Time min_time = -1;
+  if (disk_store_->Size() > 0) {
+    min_time = disk_store_->MinTime();
+  } else if (cold_store_->Size() > 0) {
+    min_time = cold_store_->MinTime();
+  } else if (hot_store_->Size() > 0) {
+    min_time = hot_store_->MinTime();
+  }
+  Time max_time = -1;
+  if (hot_store_->Size() > 0) {
+    max_time = hot_store_->MaxTime();
+  } else if (cold_store_->Size() > 0) {
+    max_time = cold_store_->MaxTime();
+  } else if (disk_store_->Size() > 0) {
+    max_time = disk_store_->MaxTime();
+  }
+  return {min_time, max_time};
+}
+
 Table::RowID Table::FindRowIDFromTimeFirstGreaterThanOrEqual(Time time) const {
+  absl::ReaderMutexLock disk_lock(&disk_lock_);
+  auto optional_row_id = disk_store_->FindRowIDFromTimeFirstGreaterThanOrEqual(time);
+  if (optional_row_id.has_value()) {
+    return optional_row_id.value();
+  }
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-  auto optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThanOrEqual(time);
+  optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThanOrEqual(time);
   if (optional_row_id.has_value()) {
     return optional_row_id.value();
   }
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+  PublishPendingHotBatchesUnlocked();
   optional_row_id = hot_store_->FindRowIDFromTimeFirstGreaterThanOrEqual(time);
   if (optional_row_id.has_value()) {
     return optional_row_id.value();
@@ -372,12 +791,18 @@ Table::RowID Table::FindRowIDFromTimeFirstGreaterThanOrEqual(Time time) const {
 }
 
 Table::RowID Table::FindRowIDFromTimeFirstGreaterThan(Time time) const {
+  absl::ReaderMutexLock disk_lock(&disk_lock_);
+  auto optional_row_id = disk_store_->FindRowIDFromTimeFirstGreaterThan(time);
+  if (optional_row_id.has_value()) {
+    return optional_row_id.value();
+  }
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-  auto optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThan(time);
+  optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThan(time);
   if (optional_row_id.has_value()) {
     return optional_row_id.value();
   }
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+  PublishPendingHotBatchesUnlocked();
   optional_row_id = hot_store_->FindRowIDFromTimeFirstGreaterThan(time);
   if (optional_row_id.has_value()) {
     return optional_row_id.value();
@@ -390,19 +815,39 @@ schema::Relation Table::GetRelation() const { return rel_; }
 TableStats Table::GetTableStats() const {
   TableStats info;
   int64_t min_time = -1;
+  int64_t memory_min_time = -1;
   int64_t num_batches = 0;
   int64_t hot_bytes = 0;
   int64_t cold_bytes = 0;
+  int64_t disk_bytes = 0;
+  int64_t num_rows = 0;
   {
+    absl::ReaderMutexLock disk_lock(&disk_lock_);
+    min_time = disk_store_->MinTime();
+    num_batches += disk_store_->Size();
+    disk_bytes = disk_bytes_;
     absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-    min_time = cold_store_->MinTime();
+    memory_min_time = cold_store_->MinTime();
     num_batches += cold_store_->Size();
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+    PublishPendingHotBatchesUnlocked();
     num_batches += hot_store_->Size();
     hot_bytes = batch_size_accountant_->HotBytes();
     cold_bytes = batch_size_accountant_->ColdBytes();
+    // Row IDs are contiguous and survive compaction, so the memory row count is the span between
+    // the first cold (or hot) row and the last hot (or cold) row.
+    if (cold_store_->Size() > 0 || hot_store_->Size() > 0) {
+      RowID first_row_id =
+          cold_store_->Size() > 0 ? cold_store_->FirstRowID() : hot_store_->FirstRowID();
+      RowID last_row_id =
+          hot_store_->Size() > 0 ? hot_store_->LastRowID() : cold_store_->LastRowID();
+      num_rows = last_row_id - first_row_id + 1;
+    }
+    if (memory_min_time == -1) {
+      memory_min_time = hot_store_->MinTime();
+    }
     if (min_time == -1) {
-      min_time = hot_store_->MinTime();
+      min_time = memory_min_time;
     }
   }
   absl::base_internal::SpinLockHolder lock(&stats_lock_);
@@ -414,36 +859,113 @@ TableStats Table::GetTableStats() const {
   info.bytes = hot_bytes + cold_bytes;
   info.hot_bytes = hot_bytes;
   info.cold_bytes = cold_bytes;
+  info.disk_bytes = disk_bytes;
+  info.num_rows = num_rows;
   info.compacted_batches = compacted_batches_;
-  info.max_table_size = max_table_size_;
+  info.max_table_size = max_table_size_.load();
   info.min_time = min_time;
+  info.memory_min_time = memory_min_time;
 
   return info;
 }
 
+namespace {
+
+// Returns the encoding of the given column that takes less memory than the plain column, if any.
+// plain_bytes is set to the memory of the plain column.
+std::unique_ptr<internal::EncodedColumn> EncodeColdColumn(types::DataType data_type,
+                                                          const arrow::Array& col,
+                                                          int64_t* plain_bytes) {
+  switch (data_type) {
+    case types::DataType::STRING:
+      if (FLAGS_table_store_dictionary_encode_max_cardinality <= 0) {
+        return nullptr;
+      }
+      *plain_bytes = internal::DictionaryEncodedStringColumn::PlainBytes(col);
+      return internal::DictionaryEncodedStringColumn::Encode(
+          col, FLAGS_table_store_dictionary_encode_max_cardinality);
+    case types::DataType::INT64:
+    case types::DataType::TIME64NS:
+      if (!FLAGS_table_store_encode_cold_columns) {
+        return nullptr;
+      }
+      *plain_bytes = col.length() * sizeof(int64_t);
+      return internal::DeltaEncodedColumn::Encode(data_type, col);
+    case types::DataType::UINT128:
+      if (!FLAGS_table_store_encode_cold_columns) {
+        return nullptr;
+      }
+      *plain_bytes = col.length() * sizeof(absl::uint128);
+      return internal::RunLengthEncodedUInt128Column::Encode(col);
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace
+
 Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool*) {
   const auto& compaction_spec = batch_size_accountant_->GetNextCompactedBatchSpec();
 
-  PX_RETURN_IF_ERROR(
-      compactor_.Reserve(compaction_spec.num_rows, compaction_spec.variable_col_bytes));
-
   RowID first_row_id = -1;
-  for (auto hot_slice : compaction_spec.hot_slices) {
-    if (first_row_id == -1) {
-      first_row_id = hot_store_->FirstRowID() + hot_slice.start_row;
-    }
+  std::vector<ArrowArrayPtr> out_columns;
+  const auto& hot_slices = compaction_spec.hot_slices;
+  if (hot_slices.size() == 1 && hot_slices[0].start_row == 0 &&
+      hot_slices[0].end_row == hot_store_->front().Length() && hot_slices[0].last_slice_for_batch) {
+    // The compacted batch is exactly one hot batch, so the cold batch shares its columns instead of
+    // copying them.
+    first_row_id = hot_store_->FirstRowID();
+    out_columns = hot_store_->front().ShareColumns();
+    hot_store_->PopFront();
+  } else {
+    PX_RETURN_IF_ERROR(
+        compactor_.Reserve(compaction_spec.num_rows, compaction_spec.variable_col_bytes));
+    for (auto hot_slice : hot_slices) {
+      if (first_row_id == -1) {
+        first_row_id = hot_store_->FirstRowID() + hot_slice.start_row;
+      }
 
-    compactor_.UnsafeAppendBatchSlice(hot_store_->front(), hot_slice.start_row, hot_slice.end_row);
-    if (hot_slice.last_slice_for_batch) {
-      hot_store_->PopFront();
+      compactor_.UnsafeAppendBatchSlice(hot_store_->front(), hot_slice.start_row,
+                                        hot_slice.end_row);
+      if (hot_slice.last_slice_for_batch) {
+        hot_store_->PopFront();
+      }
     }
+    PX_ASSIGN_OR_RETURN(out_columns, compactor_.Finish());
   }
 
-  PX_ASSIGN_OR_RETURN(std::vector<ArrowArrayPtr> out_columns, compactor_.Finish());
-
-  cold_store_->EmplaceBack(first_row_id, out_columns);
+  internal::ColdBatch cold_batch(std::move(out_columns));
+  int64_t cold_batch_bytes = compaction_spec.bytes;
+  if (FLAGS_table_store_zone_maps) {
+    for (const auto& [col_idx, col_type] : Enumerate(rel_.col_types())) {
+      auto zone_map = internal::ColumnZoneMap::Build(col_type, *cold_batch.columns[col_idx]);
+      if (zone_map != nullptr) {
+        cold_batch_bytes += zone_map->Bytes();
+        cold_batch.zone_maps[col_idx] = std::move(zone_map);
+      }
+    }
+  }
+  for (const auto& [col_idx, col_type] : Enumerate(rel_.col_types())) {
+    const auto& col = cold_batch.columns[col_idx];
+    int64_t plain_bytes = 0;
+    auto encoded = EncodeColdColumn(col_type, *col, &plain_bytes);
+    if (encoded == nullptr) {
+      continue;
+    }
+    cold_batch_bytes -= plain_bytes - encoded->Bytes();
+    cold_batch.encoded_columns[col_idx] = std::move(encoded);
+    cold_batch.columns[col_idx] = nullptr;
+  }
+  cold_store_->EmplaceBack(first_row_id, std::move(cold_batch));
+  if (!indexes_.empty()) {
+    absl::base_internal::SpinLockHolder index_lock(&index_lock_);
+    for (const auto& index : indexes_) {
+      index.index->Coalesce(first_row_id, first_row_id + compaction_spec.num_rows - 1);
+    }
+  }
 
-  auto num_rows_to_remove = batch_size_accountant_->FinishCompactedBatch();
+  auto num_rows_to_remove =
+      batch_size_accountant_->FinishCompactedBatch(std::max<int64_t>(cold_batch_bytes, 0));
   if (num_rows_to_remove > 0) {
     hot_store_->RemovePrefix(num_rows_to_remove);
   }
@@ -456,12 +978,96 @@ Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool*) {
   return Status::OK();
 }
 
+Status Table::SetMaxTableSize(int64_t max_table_size) {
+  max_table_size_ = max_table_size;
+  PX_RETURN_IF_ERROR(ExpireRowBatches(0));
+  return UpdateTableMetricGauges();
+}
+
+Status Table::ExpireToSize(int64_t target_bytes) {
+  int64_t max_table_size = max_table_size_.load();
+  target_bytes = std::max<int64_t>(target_bytes, 0);
+  if (target_bytes >= max_table_size) {
+    return Status::OK();
+  }
+  // Making room for a batch of this size leaves at most target_bytes in the table.
+  PX_ASSIGN_OR_RETURN(bool expired, ExpireRowBatches(max_table_size - target_bytes));
+  if (!expired) {
+    return Status::OK();
+  }
+  return UpdateTableMetricGauges();
+}
+
+void Table::SetDecodedColumnCache(std::shared_ptr<internal::DecodedColumnCache> cache) {
+  absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+  cold_store_->SetDecodedColumnCache(std::move(cache));
+}
+
+void Table::SetExpiryCallback(ExpiryCallback callback) {
+  std::shared_ptr<const ExpiryCallback> expiry_callback;
+  if (callback != nullptr) {
+    expiry_callback = std::make_shared<const ExpiryCallback>(std::move(callback));
+  }
+  absl::base_internal::SpinLockHolder lock(&expiry_callback_lock_);
+  expiry_callback_ = std::move(expiry_callback);
+}
+
+std::shared_ptr<const Table::ExpiryCallback> Table::GetExpiryCallback() const {
+  absl::base_internal::SpinLockHolder lock(&expiry_callback_lock_);
+  return expiry_callback_;
+}
+
+int64_t Table::AddWriteListener(WriteListener listener) {
+  absl::MutexLock lock(&write_listeners_lock_);
+  int64_t id = next_write_listener_id_++;
+  write_listeners_.emplace(id, std::move(listener));
+  ++num_write_listeners_;
+  return id;
+}
+
+void Table::RemoveWriteListener(int64_t id) {
+  absl::MutexLock lock(&write_listeners_lock_);
+  if (write_listeners_.erase(id) > 0) {
+    --num_write_listeners_;
+  }
+}
+
+void Table::NotifyWriteListeners() const {
+  if (num_write_listeners_ == 0) {
+    return;
+  }
+  absl::ReaderMutexLock lock(&write_listeners_lock_);
+  for (const auto& [id, listener] : write_listeners_) {
+    listener();
+  }
+}
+
+template <typename TStore>
+std::unique_ptr<schema::RowBatch> Table::FrontRowBatch(const TStore& store) const {
+  std::vector<int64_t> cols(rel_.NumColumns());
+  std::iota(cols.begin(), cols.end(), 0);
+  RowID last_read_row_id = store.FirstRowID() - 1;
+  auto rb_or_s = store.GetNextRowBatch(&last_read_row_id, nullptr, std::nullopt, cols);
+  if (!rb_or_s.ok()) {
+    // The batch is expired anyways, so only its rows are lost to the expiry callback.
+    LOG_FIRST_N(WARNING, 10) << "Failed to read an expired batch: " << rb_or_s.msg();
+    return nullptr;
+  }
+  return rb_or_s.ConsumeValueOrDie();
+}
+
 Status Table::CompactHotToCold(arrow::MemoryPool* mem_pool) {
+  PX_PERF_PROBE_SCOPE("table_store", "compaction");
   bool next_ready = false;
   {
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+    PublishPendingHotBatchesUnlocked();
     next_ready = batch_size_accountant_->CompactedBatchReady();
   }
+  if (!next_ready) {
+    return Status::OK();
+  }
+  auto start = std::chrono::steady_clock::now();
   while (next_ready) {
     absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
@@ -471,29 +1077,123 @@ Status Table::CompactHotToCold(arrow::MemoryPool* mem_pool) {
       break;
     }
     PX_RETURN_IF_ERROR(CompactSingleBatchUnlocked(mem_pool));
+    UpdateStoredBytesUnlocked();
     next_ready = batch_size_accountant_->CompactedBatchReady();
   }
-  return Status::OK();
+  if (!indexes_.empty()) {
+    // Compaction is also when the ranges of the expired rows are dropped from the indexes.
+    auto first_row_id = FirstRowID();
+    absl::base_internal::SpinLockHolder index_lock(&index_lock_);
+    for (const auto& index : indexes_) {
+      index.index->Trim(first_row_id);
+    }
+  }
+  metrics_.compaction_ns_counter.Increment(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+          .count());
+  return UpdateTableMetricGauges();
 }
 
 StatusOr<bool> Table::ExpireCold() {
-  absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-  if (cold_store_->Size() == 0) {
-    return false;
+  if (!FLAGS_table_store_disk_tier_dir.empty()) {
+    auto expired_or = ExpireColdToDisk();
+    if (expired_or.ok()) {
+      return expired_or;
+    }
+    // Rather than failing the write that needed the memory, the batch is dropped as if there were
+    // no disk tier.
+    LOG_FIRST_N(WARNING, 10) << absl::Substitute(
+        "Failed to move cold batch to the disk tier, dropping it: $0", expired_or.msg());
+  }
+  auto expiry_callback = GetExpiryCallback();
+  std::unique_ptr<schema::RowBatch> expired_rb;
+  {
+    absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+    if (cold_store_->Size() == 0) {
+      return false;
+    }
+    if (expiry_callback != nullptr) {
+      expired_rb = FrontRowBatch(*cold_store_);
+    }
+    cold_store_->PopFront();
+    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+    batch_size_accountant_->ExpireColdBatch();
+    UpdateStoredBytesUnlocked();
+  }
+  if (expired_rb != nullptr) {
+    (*expiry_callback)(*expired_rb);
+  }
+  return true;
+}
+
+StatusOr<bool> Table::ExpireColdToDisk() {
+  absl::MutexLock write_lock(&disk_write_lock_);
+  // Only ExpireCold pops cold batches, so the front batch stays the same until it's moved below.
+  std::optional<ColdBatch> batch;
+  RowID first_row_id;
+  {
+    absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+    if (cold_store_->Size() == 0) {
+      return false;
+    }
+    batch.emplace(cold_store_->front());
+    first_row_id = cold_store_->FirstRowID();
+  }
+  if (disk_segment_ == nullptr || disk_segment_->size() >= FLAGS_table_store_disk_segment_bytes) {
+    PX_ASSIGN_OR_RETURN(disk_segment_,
+                        internal::DiskSegment::Create(FLAGS_table_store_disk_tier_dir));
+  }
+  PX_ASSIGN_OR_RETURN(auto disk_batch, internal::DiskBatch::Write(*batch, rel_.col_types(),
+                                                                  time_col_idx_, disk_segment_));
+
+  auto expiry_callback = GetExpiryCallback();
+  std::vector<std::unique_ptr<schema::RowBatch>> expired_rbs;
+  {
+    absl::MutexLock disk_lock(&disk_lock_);
+    {
+      absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+      cold_store_->PopFront();
+      absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+      batch_size_accountant_->ExpireColdBatch();
+      UpdateStoredBytesUnlocked();
+    }
+    disk_bytes_ += disk_batch.Bytes();
+    disk_store_->EmplaceBack(first_row_id, std::move(disk_batch));
+    while (disk_bytes_ > FLAGS_table_store_disk_tier_max_bytes) {
+      if (expiry_callback != nullptr) {
+        expired_rbs.push_back(FrontRowBatch(*disk_store_));
+      }
+      disk_bytes_ -= disk_store_->front().Bytes();
+      disk_store_->PopFront();
+    }
+  }
+  for (const auto& expired_rb : expired_rbs) {
+    if (expired_rb != nullptr) {
+      (*expiry_callback)(*expired_rb);
+    }
   }
-  cold_store_->PopFront();
-  absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-  batch_size_accountant_->ExpireColdBatch();
   return true;
 }
 
 Status Table::ExpireHot() {
-  absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-  if (hot_store_->Size() == 0) {
-    return error::InvalidArgument("Failed to expire row batch, no row batches in table");
+  auto expiry_callback = GetExpiryCallback();
+  std::unique_ptr<schema::RowBatch> expired_rb;
+  {
+    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+    PublishPendingHotBatchesUnlocked();
+    if (hot_store_->Size() == 0) {
+      return error::InvalidArgument("Failed to expire row batch, no row batches in table");
+    }
+    if (expiry_callback != nullptr) {
+      expired_rb = FrontRowBatch(*hot_store_);
+    }
+    hot_store_->PopFront();
+    batch_size_accountant_->ExpireHotBatch();
+    UpdateStoredBytesUnlocked();
+  }
+  if (expired_rb != nullptr) {
+    (*expiry_callback)(*expired_rb);
   }
-  hot_store_->PopFront();
-  batch_size_accountant_->ExpireHotBatch();
   return Status::OK();
 }
 
@@ -513,6 +1213,7 @@ Status Table::UpdateTableMetricGauges() {
   // Set gauge values
   metrics_.cold_bytes_gauge.Set(stats.cold_bytes);
   metrics_.hot_bytes_gauge.Set(stats.hot_bytes);
+  metrics_.disk_bytes_gauge.Set(stats.disk_bytes);
   metrics_.num_batches_gauge.Set(stats.num_batches);
   metrics_.max_table_size_gauge.Set(stats.max_table_size);
   // Compute retention gauge
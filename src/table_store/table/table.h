@@ -22,7 +22,9 @@
 #include <arrow/array.h>
 #include <arrow/record_batch.h>
 #include <algorithm>
+#include <atomic>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -32,6 +34,7 @@
 #include <vector>
 
 #include <absl/base/internal/spinlock.h>
+#include <absl/container/flat_hash_map.h>
 #include <absl/strings/str_format.h>
 #include "src/common/base/base.h"
 #include "src/common/metrics/metrics.h"
@@ -43,12 +46,25 @@
 #include "src/table_store/schemapb/schema.pb.h"
 #include "src/table_store/table/internal/arrow_array_compactor.h"
 #include "src/table_store/table/internal/batch_size_accountant.h"
+#include "src/table_store/table/internal/decoded_column_cache.h"
+#include "src/table_store/table/internal/disk_batch.h"
+#include "src/table_store/table/internal/pending_hot_batches.h"
 #include "src/table_store/table/internal/record_or_row_batch.h"
+#include "src/table_store/table/internal/secondary_index.h"
 #include "src/table_store/table/internal/store_with_row_accounting.h"
 #include "src/table_store/table/internal/types.h"
+#include "src/table_store/table/internal/zone_map.h"
 #include "src/table_store/table/table_metrics.h"
 
 DECLARE_int32(table_store_table_size_limit);
+DECLARE_int32(table_store_dictionary_encode_max_cardinality);
+DECLARE_bool(table_store_zone_maps);
+DECLARE_bool(table_store_encode_cold_columns);
+DECLARE_string(table_store_disk_tier_dir);
+DECLARE_int64(table_store_disk_tier_max_bytes);
+DECLARE_int64(table_store_disk_segment_bytes);
+DECLARE_string(table_store_index_columns);
+DECLARE_int64(table_store_decoded_column_cache_bytes);
 
 namespace px {
 namespace table_store {
@@ -59,6 +75,9 @@ struct TableStats {
   int64_t bytes;
   int64_t hot_bytes;
   int64_t cold_bytes;
+  int64_t disk_bytes;
+  // The number of rows in memory, i.e. in the hot or cold store.
+  int64_t num_rows;
   int64_t num_batches;
   int64_t batches_added;
   int64_t batches_expired;
@@ -66,6 +85,8 @@ struct TableStats {
   int64_t compacted_batches;
   int64_t max_table_size;
   int64_t min_time;
+  // The time of the oldest row in memory, i.e. in the hot or cold store.
+  int64_t memory_min_time;
 };
 
 /**
@@ -77,8 +98,18 @@ struct TableStats {
  * to store the data while keeping track of row and time indexes (see `StoreWithRowTimeAccounting`
  * and `Time and Row Indexing` below).
  *
+ * Disk Tier:
+ * If `table_store_disk_tier_dir` is set, cold batches that expire out of memory are written to
+ * segment files in that directory instead of being dropped, and are kept there until the disk tier
+ * of the table is over `table_store_disk_tier_max_bytes`. Reads go through the disk, cold and hot
+ * stores in that order, with the same row and time indexing as the in-memory stores.
+ *
  * Synchronization Scheme:
- * The hot and cold partitions are synchronized separately with spinlocks.
+ * The hot and cold partitions are synchronized separately with spinlocks. Writes don't take the hot
+ * lock unless they have to expire data: they push the batch to a lock-free list of pending batches,
+ * which are published to the hot store by whichever thread next holds the hot lock. The disk
+ * partition is synchronized with a reader/writer mutex, since reads of it do IO. Locks are always
+ * acquired in the order disk, cold, hot.
  *
  * Compaction Scheme:
  * Hot batches are compacted into batches of size roughly `compacted_batch_size_` +/- the size of a
@@ -100,6 +131,12 @@ struct TableStats {
  * Cursor stores the unique row identifier of the last read row, so
  * that when GetNextRowBatch is called on the cursor it can work out that it needs to return a slice
  * of the batch with the original "second" batch's data.
+ *
+ * Secondary Indexes:
+ * The columns named by `table_store_index_columns` (e.g. upid) get a posting list of the row ID
+ * ranges of the batches containing each of their values, see `SecondaryIndex`. Cursors with
+ * equality or substring predicates on an indexed column jump straight to the next batch that can
+ * match, instead of checking the zone maps of every batch in between.
  */
 class Table : public NotCopyable {
   using RecordBatchPtr = internal::RecordBatchPtr;
@@ -184,15 +221,43 @@ class Table : public NotCopyable {
     // is past the stopping condition. In this case `GetNextRowBatch(...)` will return an error.
     bool NextBatchReady();
     StatusOr<std::unique_ptr<schema::RowBatch>> GetNextRowBatch(const std::vector<int64_t>& cols);
+    // Moves the cursor past the batch GetNextRowBatch would return, without reading any of its
+    // columns. Returns the number of rows skipped.
+    StatusOr<int64_t> SkipNextRowBatch();
     // In the case of StopType == Infinite, this function always returns false.
     bool Done();
+    // Makes the cursor return its rows newest first: the batches from the end of its range
+    // backwards, with the rows of each batch reversed. Only cursors that stop at a row fixed at
+    // creation (CurrentEndOfTable or StopAtTimeOrEndOfTable) can be reversed, before they are read.
+    Status SetReverse();
+    bool reverse() const { return reverse_; }
     // Change the StopSpec of the cursor.
     void UpdateStopSpec(StopSpec stop);
+    // Set predicates that the rows the caller is interested in all satisfy. The cursor may skip
+    // batches of the table where no row satisfies them, but the rows it returns still need to be
+    // filtered.
+    void SetPredicates(std::vector<internal::ColumnPredicate> predicates) {
+      hint_predicates_ = std::move(predicates);
+      UpdatePredicates();
+    }
+    // Set predicates that the cursor applies itself: the row batches it returns only contain the
+    // rows that satisfy all of them. The predicate columns don't need to be among the columns read.
+    void SetFilterPredicates(std::vector<internal::ColumnPredicate> predicates) {
+      filter_predicates_ = std::move(predicates);
+      UpdatePredicates();
+    }
 
    private:
     void AdvanceToStart(const StartSpec& start);
     void StopStateFromSpec(StopSpec&& stop);
     void UpdateStopStateForStopAtTime();
+    void UpdatePredicates();
+    // Whether the row after the last read one is past the stop, i.e. Done() of a forward cursor.
+    bool ReachedStop();
+    // Reads the rows after the last read one, applying the filter predicates.
+    StatusOr<std::unique_ptr<schema::RowBatch>> ReadNextRowBatch(const std::vector<int64_t>& cols);
+    // Reads the last batch of the rows left, reversed.
+    StatusOr<std::unique_ptr<schema::RowBatch>> ReadPrevRowBatch(const std::vector<int64_t>& cols);
 
     // The following methods are made private so that they are only accessible from Table.
     internal::RowID* LastReadRowID();
@@ -210,6 +275,14 @@ class Table : public NotCopyable {
     internal::BatchHints hints_;
     RowID last_read_row_id_;
     StopState stop_;
+    std::vector<internal::ColumnPredicate> hint_predicates_;
+    std::vector<internal::ColumnPredicate> filter_predicates_;
+    // All the predicates the rows returned by the cursor satisfy, used to skip batches.
+    std::vector<internal::ColumnPredicate> predicates_;
+    // A reverse cursor reads its range from the end. The rows left are the ones from
+    // reverse_first_row_id_ up to the stop row.
+    bool reverse_ = false;
+    RowID reverse_first_row_id_ = -1;
 
     friend class Table;
   };
@@ -268,6 +341,28 @@ class Table : public NotCopyable {
    */
   RowID FindRowIDFromTimeFirstGreaterThan(Time time) const;
 
+  /**
+   * Get the times of the first and last rows in the table, from the time ranges of its batches.
+   * @return the first and last times, or {-1, -1} if the table has no rows or no time column.
+   */
+  std::pair<Time, Time> TimeRange() const;
+
+  /**
+   * SplitCursor splits the rows that a cursor with the given specs would return into up to
+   * num_splits cursors over disjoint, consecutive ranges of rows, so that they can be read
+   * concurrently. The ranges start at batch boundaries where possible, and are tracked by row ID,
+   * so compactions between reads don't make the cursors return a row twice or skip one.
+   *
+   * Only cursors that stop at a fixed row (CurrentEndOfTable or StopAtTimeOrEndOfTable) can be
+   * split. Otherwise, or if there are too few batches, fewer cursors are returned.
+   * @param start the StartSpec of the cursor to split.
+   * @param stop the StopSpec of the cursor to split.
+   * @param num_splits the maximum number of cursors to return.
+   * @return the cursors, in row order.
+   */
+  std::vector<Cursor> SplitCursor(Cursor::StartSpec start, Cursor::StopSpec stop,
+                                  int64_t num_splits) const;
+
   /**
    * Writes a row batch to the table.
    * @param rb Rowbatch to write to the table.
@@ -294,6 +389,57 @@ class Table : public NotCopyable {
 
   TableStats GetTableStats() const;
 
+  /**
+   * Changes the maximum number of bytes the table can hold in memory, expiring the oldest batches
+   * right away if the table holds more than that.
+   * @param max_table_size the new maximum size of the table.
+   */
+  Status SetMaxTableSize(int64_t max_table_size);
+
+  /**
+   * Expires the oldest batches until the table holds at most target_bytes, without changing the
+   * maximum size of the table. Used to give memory back early when the process is short of it.
+   */
+  Status ExpireToSize(int64_t target_bytes);
+
+  using ExpiryCallback = std::function<void(const schema::RowBatch&)>;
+
+  /**
+   * Sets the callback that's called with the rows of each batch that is dropped from the table, so
+   * that the rows can be kept in another form (e.g. aggregated into a rollup table) before they're
+   * gone. Batches that move to the disk tier aren't dropped until they leave the disk tier. The
+   * callback is called by the thread that expires the batch, usually a writer of the table, without
+   * any of the table's locks held.
+   * @param callback the callback, or nullptr to stop calling back.
+   */
+  void SetExpiryCallback(ExpiryCallback callback);
+
+  /**
+   * Sets the cache that keeps the decoded encoded columns of the cold batches of the table, see
+   * internal::DecodedColumnCache. Only the first cache that is set is used.
+   * @param cache the cache, usually shared by all of the tables of a table store.
+   */
+  void SetDecodedColumnCache(std::shared_ptr<internal::DecodedColumnCache> cache);
+
+  using WriteListener = std::function<void()>;
+
+  /**
+   * Adds a listener that's called after every batch written to the table, so that streaming
+   * readers can wait for new rows instead of polling the table. The listener is called by the
+   * writer without any of the store locks held, so it should be cheap and must not write to the
+   * table.
+   * @param listener the listener.
+   * @return the ID to remove the listener with.
+   */
+  int64_t AddWriteListener(WriteListener listener);
+
+  /**
+   * Removes a listener added with AddWriteListener. Once this returns, the listener isn't called
+   * anymore, so it may refer to objects that are destroyed right after.
+   * @param id the ID returned by AddWriteListener.
+   */
+  void RemoveWriteListener(int64_t id);
+
   /**
    * Compacts hot batches into compacted_batch_size_ sized cold batches. Each call to
    * CompactHotToCold will create a maximum of kMaxBatchesPerCompactionCall cold batches.
@@ -311,7 +457,8 @@ class Table : public NotCopyable {
   int64_t batches_added_ ABSL_GUARDED_BY(stats_lock_) = 0;
   int64_t bytes_added_ ABSL_GUARDED_BY(stats_lock_) = 0;
   int64_t compacted_batches_ ABSL_GUARDED_BY(stats_lock_) = 0;
-  int64_t max_table_size_ = 0;
+  // Atomic, since the retention budget of the table store can change it concurrently with writes.
+  std::atomic<int64_t> max_table_size_ = 0;
   const int64_t compacted_batch_size_;
   mutable absl::base_internal::SpinLock hot_lock_;
   std::unique_ptr<internal::StoreWithRowTimeAccounting<internal::StoreType::Hot>> hot_store_
@@ -322,20 +469,83 @@ class Table : public NotCopyable {
       ABSL_GUARDED_BY(cold_lock_);
   std::deque<int64_t> cold_batch_bytes_ ABSL_GUARDED_BY(cold_lock_);
 
+  mutable absl::Mutex disk_lock_;
+  std::unique_ptr<internal::StoreWithRowTimeAccounting<internal::StoreType::Disk>> disk_store_
+      ABSL_GUARDED_BY(disk_lock_);
+  int64_t disk_bytes_ ABSL_GUARDED_BY(disk_lock_) = 0;
+  // Serializes the writes of expired cold batches to disk, which happen without holding any of the
+  // store locks.
+  absl::Mutex disk_write_lock_ ABSL_ACQUIRED_BEFORE(disk_lock_);
+  std::shared_ptr<internal::DiskSegment> disk_segment_ ABSL_GUARDED_BY(disk_write_lock_);
+
+  // Batches that were written but not yet published to the hot store. Whoever holds hot_lock_ next
+  // publishes them, which is why even the const methods may modify the hot store.
+  mutable internal::PendingHotBatches pending_hot_batches_;
+  mutable std::atomic<int64_t> pending_hot_bytes_ = 0;
+  // The hot and cold bytes of the batch size accountant, so that writes can check whether they
+  // have to expire data without taking hot_lock_.
+  mutable std::atomic<int64_t> stored_bytes_ = 0;
+
   // Counter to assign a unique row ID to each row. Synchronized by hot_lock_ since its only
-  // accessed on a hot write.
-  int64_t next_row_id_ ABSL_GUARDED_BY(hot_lock_) = 0;
+  // accessed when publishing hot batches.
+  mutable int64_t next_row_id_ ABSL_GUARDED_BY(hot_lock_) = 0;
   int64_t time_col_idx_ = -1;
 
+  struct ColumnIndex {
+    int64_t col_idx;
+    types::DataType data_type;
+    std::unique_ptr<internal::SecondaryIndex> index;
+  };
+  // Taken after hot_lock_ when publishing hot batches, and on its own by readers.
+  mutable absl::base_internal::SpinLock index_lock_;
+  // The secondary indexes of the columns named by table_store_index_columns. The set of indexes is
+  // fixed on construction, while the indexes themselves are guarded by index_lock_.
+  std::vector<ColumnIndex> indexes_;
+
+  // Guards the expiry callback, which is copied out before it's called.
+  mutable absl::base_internal::SpinLock expiry_callback_lock_;
+  std::shared_ptr<const ExpiryCallback> expiry_callback_ ABSL_GUARDED_BY(expiry_callback_lock_);
+
+  // Writers call the listeners holding a reader lock, so that RemoveWriteListener() can wait for
+  // the calls that are in flight. The count lets writes skip the lock when nobody listens.
+  mutable absl::Mutex write_listeners_lock_;
+  absl::flat_hash_map<int64_t, WriteListener> write_listeners_
+      ABSL_GUARDED_BY(write_listeners_lock_);
+  int64_t next_write_listener_id_ ABSL_GUARDED_BY(write_listeners_lock_) = 0;
+  std::atomic<int64_t> num_write_listeners_ = 0;
+
   Status WriteHot(internal::RecordOrRowBatch&& record_or_row_batch);
 
   Status ExpireBatch();
   Status ExpireHot();
   StatusOr<bool> ExpireCold();
-  Status ExpireRowBatches(int64_t row_batch_size);
+  // Moves the first cold batch to the disk tier.
+  StatusOr<bool> ExpireColdToDisk();
+  // Expires batches until a batch of the given size fits in the table. Returns whether any batch
+  // was expired.
+  StatusOr<bool> ExpireRowBatches(int64_t row_batch_size);
   Status CompactSingleBatchUnlocked(arrow::MemoryPool* mem_pool)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_) ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
   Status UpdateTableMetricGauges();
+  // Moves the pending hot batches into the hot store.
+  void PublishPendingHotBatchesUnlocked() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
+  void UpdateStoredBytesUnlocked() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
+  // Returns the distinct values of each indexed column of the batch.
+  std::vector<std::vector<internal::ZoneMapValue>> IndexValues(
+      const internal::RecordOrRowBatch& batch) const;
+  // Returns the first row ID from row_id on that the secondary indexes don't rule out for the
+  // predicates, and sets indexed_end_row_id to the row ID after the last indexed row.
+  RowID NextIndexedRowID(RowID row_id, const std::vector<internal::ColumnPredicate>& predicates,
+                         RowID* indexed_end_row_id) const;
+  std::shared_ptr<const ExpiryCallback> GetExpiryCallback() const;
+  void NotifyWriteListeners() const;
+  // All of the columns of the first batch of the given store, to pass to the expiry callback.
+  template <typename TStore>
+  std::unique_ptr<schema::RowBatch> FrontRowBatch(const TStore& store) const;
+  // A 0-row batch of the given columns.
+  StatusOr<std::unique_ptr<schema::RowBatch>> EmptyRowBatch(const std::vector<int64_t>& cols) const;
+  // The first row ID of the batch that holds the given row, if the row is in the table.
+  std::optional<RowID> BatchFirstRowID(RowID row_id) const;
 
   Time MaxTime() const;
 
@@ -19,6 +19,7 @@
 #include <absl/synchronization/barrier.h>
 #include <absl/synchronization/notification.h>
 #include <benchmark/benchmark.h>
+#include <algorithm>
 #include <chrono>
 #include <deque>
 #include <numeric>
@@ -360,6 +361,52 @@ static void BM_TableThreaded(benchmark::State& state) {
   state.counters["Write"] = benchmark::Counter(write_average_time);
 }
 
+// Measures the latency of writes while streaming readers keep reading the hot data of the table,
+// i.e. a data push callback under concurrent long-running queries.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_TableWriteWithConcurrentReaders(benchmark::State& state) {
+  int64_t table_size = 4 * 1024 * 1024;
+  // Compaction never runs, so the readers keep converting hot batches to arrow.
+  int64_t compaction_size = 64 * 1024;
+  int64_t batch_length = 256;
+  int num_read_threads = state.range(0);
+  std::shared_ptr<Table> table = MakeTable(table_size, compaction_size);
+  int64_t time_counter = FillTableHot(table.get(), table_size / 2, batch_length);
+
+  absl::Notification done;
+  std::vector<std::thread> reader_threads;
+  for (int i = 0; i < num_read_threads; ++i) {
+    reader_threads.emplace_back([&table, &done]() {
+      while (!done.HasBeenNotified()) {
+        Table::Cursor cursor(table.get());
+        ReadFullTable(&cursor);
+      }
+    });
+  }
+
+  std::vector<double> write_times;
+  for (auto _ : state) {
+    auto batch = MakeHotBatch(batch_length, &time_counter);
+    auto start = std::chrono::high_resolution_clock::now();
+    PX_CHECK_OK(table->TransferRecordBatch(std::move(batch)));
+    auto end = std::chrono::high_resolution_clock::now();
+    auto elapsed_seconds = std::chrono::duration_cast<std::chrono::duration<double>>(end - start);
+    state.SetIterationTime(elapsed_seconds.count());
+    write_times.push_back(elapsed_seconds.count());
+  }
+  done.Notify();
+  for (auto& thread : reader_threads) {
+    thread.join();
+  }
+
+  std::sort(write_times.begin(), write_times.end());
+  state.counters["WriteP50"] = benchmark::Counter(write_times[write_times.size() / 2]);
+  state.counters["WriteP99"] = benchmark::Counter(write_times[write_times.size() * 99 / 100]);
+  state.counters["WriteMax"] = benchmark::Counter(write_times.back());
+  int64_t batch_size = batch_length * sizeof(int64_t) + batch_length * sizeof(double);
+  state.SetBytesProcessed(state.iterations() * batch_size);
+}
+
 BENCHMARK(BM_TableReadAllHot);
 BENCHMARK(BM_TableReadAllCold);
 BENCHMARK(BM_TableReadLastBatchAllHot)->Iterations(1000);
@@ -368,5 +415,6 @@ BENCHMARK(BM_TableWriteEmpty);
 BENCHMARK(BM_TableWriteFull);
 BENCHMARK(BM_TableCompaction);
 BENCHMARK(BM_TableThreaded)->UseManualTime()->Iterations(1);
+BENCHMARK(BM_TableWriteWithConcurrentReaders)->UseManualTime()->Iterations(10000)->Arg(1)->Arg(4);
 
 }  // namespace px::table_store
@@ -36,6 +36,11 @@ TableMetrics::TableMetrics(prometheus::Registry* registry, std::string table_nam
                           .Help("Current hot data bytes in the table")
                           .Register(*registry)
                           .Add({{"name", table_name}})),
+      disk_bytes_gauge(prometheus::BuildGauge()
+                           .Name("table_disk_bytes")
+                           .Help("Current bytes of the disk tier of the table")
+                           .Register(*registry)
+                           .Add({{"name", table_name}})),
       num_batches_gauge(prometheus::BuildGauge()
                             .Name("table_num_batches")
                             .Help("Current number of row batches in the table")
@@ -58,6 +63,12 @@ TableMetrics::TableMetrics(prometheus::Registry* registry, std::string table_nam
               .Help("Total batches compacted in the table in the table's lifetime")
               .Register(*registry)
               .Add({{"name", table_name}})),
+      compaction_ns_counter(
+          prometheus::BuildCounter()
+              .Name("table_compaction_ns")
+              .Help("Total time spent compacting the table in the table's lifetime")
+              .Register(*registry)
+              .Add({{"name", table_name}})),
       max_table_size_gauge(prometheus::BuildGauge()
                                .Name("table_max_table_size")
                                .Help("The cap on the table size")
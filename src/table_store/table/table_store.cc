@@ -17,14 +17,46 @@
  */
 
 #include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <numeric>
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_set.h>
+#include <absl/strings/str_cat.h>
+
 #include "src/table_store/table/table_store.h"
 
 namespace px {
 namespace table_store {
 
+namespace {
+
+// The number of row batches in each record of a snapshot, which bounds the memory needed to write
+// or read the snapshot of a large table.
+constexpr int kSnapshotBatchesPerRecord = 64;
+
+// A snapshot is a sequence of length prefixed records, where each record is a schemapb::Table
+// with some of the row batches of a table.
+Status WriteSnapshotRecord(const schemapb::Table& record, std::ofstream* out) {
+  std::string buf;
+  if (!record.SerializeToString(&buf)) {
+    return error::Internal("Failed to serialize table store snapshot of table $0", record.name());
+  }
+  uint64_t len = buf.size();
+  out->write(reinterpret_cast<const char*>(&len), sizeof(len));
+  out->write(buf.data(), len);
+  if (!*out) {
+    return error::Internal("Failed to write table store snapshot: $0", std::strerror(errno));
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
 std::unique_ptr<std::unordered_map<std::string, schema::Relation>> TableStore::GetRelationMap() {
   auto map = std::make_unique<RelationMap>();
   map->reserve(name_to_relation_map_.size());
@@ -34,6 +66,16 @@ std::unique_ptr<std::unordered_map<std::string, schema::Relation>> TableStore::G
   return map;
 }
 
+void TableStore::SetRetentionBudget(int64_t budget_bytes, TableRetentionSpecs specs) {
+  if (budget_bytes > 0) {
+    int64_t cache_bytes =
+        std::min<int64_t>(FLAGS_table_store_decoded_column_cache_bytes, budget_bytes / 4);
+    decoded_column_cache_->SetCapacity(cache_bytes);
+    budget_bytes -= cache_bytes;
+  }
+  retention_budget_->Configure(budget_bytes, std::move(specs));
+}
+
 StatusOr<Table*> TableStore::CreateNewTablet(uint64_t table_id, const types::TabletID& tablet_id) {
   auto id_to_table_info_map_iter = id_to_table_info_map_.find(table_id);
   if (id_to_table_info_map_iter == id_to_table_info_map_.end()) {
@@ -47,6 +89,9 @@ StatusOr<Table*> TableStore::CreateNewTablet(uint64_t table_id, const types::Tab
 
   TableIDTablet id_key = {table_id, tablet_id};
   id_to_table_map_[id_key] = new_tablet;
+  new_tablet->SetDecodedColumnCache(decoded_column_cache_);
+  compaction_scheduler_->AddTable(new_tablet);
+  retention_budget_->AddTable(table_info.table_name, new_tablet);
 
   const std::string& table_name = table_info.table_name;
   DCHECK(relation == name_to_relation_map_.find(table_name)->second);
@@ -83,6 +128,17 @@ table_store::Table* TableStore::GetTable(uint64_t table_id,
   return id_to_table_iter->second.get();
 }
 
+std::vector<const table_store::Table*> TableStore::GetTablets(
+    const std::string& table_name) const {
+  std::vector<const table_store::Table*> tablets;
+  for (const auto& [name_tablet, table] : name_to_table_map_) {
+    if (name_tablet.name_ == table_name) {
+      tablets.push_back(table.get());
+    }
+  }
+  return tablets;
+}
+
 void TableStore::RegisterTableName(const std::string& table_name, const types::TabletID& tablet_id,
                                    const schema::Relation& table_relation,
                                    std::shared_ptr<table_store::Table> table) {
@@ -94,6 +150,9 @@ void TableStore::RegisterTableName(const std::string& table_name, const types::T
   }
 
   NameTablet key = {table_name, tablet_id};
+  table->SetDecodedColumnCache(decoded_column_cache_);
+  compaction_scheduler_->AddTable(table);
+  retention_budget_->AddTable(table_name, table);
   name_to_table_map_[key] = table;
 }
 
@@ -165,5 +224,123 @@ Status TableStore::RunCompaction(arrow::MemoryPool* mem_pool) {
   return Status::OK();
 }
 
+Status TableStore::ExpireToFraction(double fraction) {
+  for (const auto& it : name_to_table_map_) {
+    Table* table = it.second.get();
+    auto target_bytes =
+        static_cast<int64_t>(fraction * static_cast<double>(table->GetTableStats().max_table_size));
+    PX_RETURN_IF_ERROR(table->ExpireToSize(target_bytes));
+  }
+  return Status::OK();
+}
+
+Status TableStore::WriteSnapshot(const std::string& path) const {
+  std::string tmp_path = absl::StrCat(path, ".tmp");
+  std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    return error::Internal("Failed to open $0: $1", tmp_path, std::strerror(errno));
+  }
+  // Aliases register the same table under several names, but the data is only written once.
+  absl::flat_hash_set<const Table*> written_tables;
+  for (const auto& [key, table] : name_to_table_map_) {
+    if (!written_tables.insert(table.get()).second) {
+      continue;
+    }
+    auto relation = table->GetRelation();
+    schemapb::Table record;
+    record.set_name(key.name_);
+    record.set_tablet_id(key.tablet_id_);
+    PX_RETURN_IF_ERROR(relation.ToProto(record.mutable_relation()));
+
+    std::vector<int64_t> cols(relation.NumColumns());
+    std::iota(cols.begin(), cols.end(), 0);
+    Table::Cursor cursor(table.get());
+    while (!cursor.Done()) {
+      PX_ASSIGN_OR_RETURN(auto rb, cursor.GetNextRowBatch(cols));
+      if (rb->num_rows() == 0) {
+        continue;
+      }
+      PX_RETURN_IF_ERROR(rb->ToProto(record.add_row_batches()));
+      if (record.row_batches_size() == kSnapshotBatchesPerRecord) {
+        PX_RETURN_IF_ERROR(WriteSnapshotRecord(record, &out));
+        record.clear_row_batches();
+      }
+    }
+    if (record.row_batches_size() > 0) {
+      PX_RETURN_IF_ERROR(WriteSnapshotRecord(record, &out));
+    }
+  }
+  out.close();
+  if (!out) {
+    return error::Internal("Failed to write table store snapshot: $0", std::strerror(errno));
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    return error::Internal("Failed to move table store snapshot to $0: $1", path,
+                           std::strerror(errno));
+  }
+  return Status::OK();
+}
+
+StatusOr<Table*> TableStore::TableForSnapshot(const schemapb::Table& snapshot) {
+  schema::Relation relation;
+  PX_RETURN_IF_ERROR(relation.FromProto(&snapshot.relation()));
+  Table* table = GetTable(snapshot.name(), snapshot.tablet_id());
+  if (table == nullptr) {
+    for (const auto& [table_id, table_info] : id_to_table_info_map_) {
+      if (table_info.table_name == snapshot.name() && table_info.relation == relation) {
+        PX_ASSIGN_OR_RETURN(table, CreateNewTablet(table_id, snapshot.tablet_id()));
+        break;
+      }
+    }
+  }
+  if (table == nullptr || table->GetRelation() != relation) {
+    return static_cast<Table*>(nullptr);
+  }
+  return table;
+}
+
+Status TableStore::RestoreSnapshot(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return error::NotFound("Failed to open table store snapshot $0: $1", path,
+                           std::strerror(errno));
+  }
+  absl::flat_hash_set<std::string> skipped_tables;
+  while (true) {
+    uint64_t len = 0;
+    if (!in.read(reinterpret_cast<char*>(&len), sizeof(len))) {
+      if (in.gcount() == 0) {
+        break;
+      }
+      return error::Internal("Truncated table store snapshot $0", path);
+    }
+    std::string buf(len, '\0');
+    if (!in.read(buf.data(), len)) {
+      return error::Internal("Truncated table store snapshot $0", path);
+    }
+    schemapb::Table record;
+    if (!record.ParseFromString(buf)) {
+      return error::Internal("Failed to parse table store snapshot $0", path);
+    }
+    PX_ASSIGN_OR_RETURN(auto table, TableForSnapshot(record));
+    if (table == nullptr) {
+      if (skipped_tables.insert(record.name()).second) {
+        LOG(WARNING) << absl::Substitute(
+            "Not restoring table $0 from the snapshot, since it's not in the table store or its "
+            "relation changed.",
+            record.name());
+      }
+      continue;
+    }
+    for (const auto& rb_proto : record.row_batches()) {
+      PX_ASSIGN_OR_RETURN(auto rb, schema::RowBatch::FromProto(rb_proto));
+      PX_RETURN_IF_ERROR(table->WriteRowBatch(*rb));
+    }
+    // Compact as the records are read, so the restored data doesn't pile up in the hot store.
+    PX_RETURN_IF_ERROR(table->CompactHotToCold(arrow::default_memory_pool()));
+  }
+  return Status::OK();
+}
+
 }  // namespace table_store
 }  // namespace px
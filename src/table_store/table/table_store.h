@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -31,6 +32,8 @@
 #include "src/shared/types/hash_utils.h"
 #include "src/table_store/schema/relation.h"
 #include "src/table_store/schema/schema.h"
+#include "src/table_store/table/compaction_scheduler.h"
+#include "src/table_store/table/retention_budget.h"
 #include "src/table_store/table/table.h"
 #include "src/table_store/table/tablets_group.h"
 
@@ -107,6 +110,15 @@ class TableStore {
   table_store::Table* GetTable(uint64_t table_id,
                                const types::TabletID& tablet_id = kDefaultTablet) const;
 
+  /**
+   * @brief Get all the tablets of the table with the given name, e.g. to read them in time order
+   * with a TabletsMergeCursor.
+   *
+   * @param table_name: the name of the table.
+   * @return the tablets, in no particular order, or none if the table doesn't exist.
+   */
+  std::vector<const table_store::Table*> GetTablets(const std::string& table_name) const;
+
   /**
    * Add a table under the given name and optionally tablet id.
    *
@@ -167,6 +179,69 @@ class TableStore {
 
   Status RunCompaction(arrow::MemoryPool* mem_pool);
 
+  /**
+   * Expires the oldest data of every table until it holds at most the given fraction of its
+   * maximum size, see Table::ExpireToSize().
+   */
+  Status ExpireToFraction(double fraction);
+
+  /**
+   * Starts compacting every table and tablet of the store on background threads, see
+   * CompactionScheduler. Tables added later are compacted as well.
+   *
+   * @param period: the minimum time between two compaction rounds.
+   */
+  void StartCompactionScheduler(std::chrono::milliseconds period) {
+    compaction_scheduler_->Start(period);
+  }
+
+  /**
+   * Stops the background compaction, waiting for the running round to finish.
+   */
+  void StopCompactionScheduler() { compaction_scheduler_->Stop(); }
+
+  /**
+   * Splits the given memory budget between the tables and tablets of the store, see
+   * RetentionBudget. The split is only applied by RebalanceRetention. The decoded column cache of
+   * the store is charged against the budget, taking at most a quarter of it.
+   *
+   * @param budget_bytes: the number of bytes all of the tables can hold, or 0 to keep the maximum
+   * sizes the tables were created with.
+   * @param specs: the weights and minimum retentions of the tables, by table name.
+   */
+  void SetRetentionBudget(int64_t budget_bytes, TableRetentionSpecs specs);
+
+  const internal::DecodedColumnCache& decoded_column_cache() const {
+    return *decoded_column_cache_;
+  }
+
+  /**
+   * Recomputes the maximum sizes of the tables from the retention budget, expiring data from the
+   * tables that shrink.
+   */
+  Status RebalanceRetention() { return retention_budget_->Rebalance(); }
+
+  /**
+   * WriteSnapshot writes the data of every table in the store to the file at the given path, so
+   * that it can be restored with RestoreSnapshot after a restart. The file is replaced atomically,
+   * so a failed write leaves the previous snapshot in place.
+   *
+   * @param path: the path of the snapshot file.
+   * @return Status: error if the snapshot couldn't be written.
+   */
+  Status WriteSnapshot(const std::string& path) const;
+
+  /**
+   * RestoreSnapshot writes the data of the snapshot at the given path back into the tables of the
+   * store. The data of a table is only restored if the store has a table of that name with the
+   * same relation, since the schemas may have changed across restarts. Missing tablets of a table
+   * that has a table ID are created.
+   *
+   * @param path: the path of the snapshot file.
+   * @return Status: error if the snapshot couldn't be read.
+   */
+  Status RestoreSnapshot(const std::string& path);
+
  private:
   void RegisterTableName(const std::string& table_name, const types::TabletID& tablet_id,
                          const schema::Relation& table_relation,
@@ -184,6 +259,10 @@ class TableStore {
    */
   StatusOr<Table*> CreateNewTablet(uint64_t table_id, const types::TabletID& tablet_id);
 
+  // Returns the table for the given snapshot of a table, creating the tablet if needed, or nullptr
+  // if the snapshot doesn't match any table of the store.
+  StatusOr<Table*> TableForSnapshot(const schemapb::Table& snapshot);
+
   // The default value for tablets, when tablet is not specified.
   inline static types::TabletID kDefaultTablet = "";
   // Map a name to a table.
@@ -197,6 +276,13 @@ class TableStore {
   absl::flat_hash_map<std::string, schema::Relation> name_to_relation_map_;
   // Mapping from id to name and relation pair for adding new tablets.
   absl::flat_hash_map<uint64_t, TableInfo> id_to_table_info_map_;
+  std::unique_ptr<RetentionBudget> retention_budget_ = std::make_unique<RetentionBudget>();
+  // Shared by the cold stores of all of the tables, see Table::SetDecodedColumnCache.
+  std::shared_ptr<internal::DecodedColumnCache> decoded_column_cache_ =
+      std::make_shared<internal::DecodedColumnCache>(FLAGS_table_store_decoded_column_cache_bytes);
+  // Declared last, so that its threads are stopped before the tables are destroyed.
+  std::unique_ptr<CompactionScheduler> compaction_scheduler_ =
+      std::make_unique<CompactionScheduler>(arrow::default_memory_pool());
 };
 
 }  // namespace table_store
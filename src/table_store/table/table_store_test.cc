@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
 #include "src/table_store/schema/relation.h"
 #include "src/table_store/schema/row_descriptor.h"
 #include "src/table_store/table/table_store.h"
@@ -276,6 +277,48 @@ TEST_F(TableStoreTabletsTest, add_tablet_on_append_data) {
   EXPECT_EQ(tablet2->GetTableStats().batches_added, 0);
 }
 
+TEST_F(TableStoreTabletsTest, snapshot_restore) {
+  px::testing::TempDir snapshot_dir;
+  std::string snapshot_path = (snapshot_dir.path() / "table_store_snapshot").string();
+  uint64_t table_id = 123;
+  types::TabletID tablet_id = "456";
+
+  {
+    auto table_store = TableStore();
+    table_store.AddTable(tablet1_1, "a", table_id);
+    table_store.AddTable(table2, "b");
+    EXPECT_OK(table_store.AppendData(table_id, "", MakeRel1ColumnWrapperBatch()));
+    EXPECT_OK(table_store.AppendData(table_id, tablet_id, MakeRel1ColumnWrapperBatch()));
+    EXPECT_OK(table_store.AppendData(table_id, tablet_id, MakeRel1ColumnWrapperBatch()));
+    EXPECT_OK(table_store.WriteSnapshot(snapshot_path));
+  }
+
+  auto table_store = TableStore();
+  auto restored_table = Table::Create("test_table1", rel1);
+  table_store.AddTable(restored_table, "a", table_id);
+  // The relation of b changed, so its data isn't restored.
+  auto changed_table = Table::Create("test_table2", rel1);
+  table_store.AddTable(changed_table, "b");
+  EXPECT_OK(table_store.RestoreSnapshot(snapshot_path));
+
+  EXPECT_EQ(1, restored_table->GetTableStats().batches_added);
+  Table* restored_tablet = table_store.GetTable("a", tablet_id);
+  ASSERT_NE(nullptr, restored_tablet);
+  EXPECT_EQ(2, restored_tablet->GetTableStats().batches_added);
+  EXPECT_EQ(0, changed_table->GetTableStats().batches_added);
+
+  Table::Cursor cursor(restored_table.get());
+  auto rb = cursor.GetNextRowBatch({1}).ConsumeValueOrDie();
+  ASSERT_EQ(3, rb->num_rows());
+  EXPECT_EQ(5.0,
+            types::GetValueFromArrowArray<types::DataType::FLOAT64>(rb->ColumnAt(0).get(), 1));
+}
+
+TEST_F(TableStoreTest, restore_missing_snapshot) {
+  auto table_store = TableStore();
+  EXPECT_NOT_OK(table_store.RestoreSnapshot("/does/not/exist"));
+}
+
 using TableStoreTabletsDeathTest = TableStoreTabletsTest;
 TEST_F(TableStoreTabletsDeathTest, tablet_test) {
   auto table_store = TableStore();
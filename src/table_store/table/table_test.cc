@@ -16,11 +16,14 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <absl/strings/str_cat.h>
 #include <absl/synchronization/notification.h>
 #include <arrow/array.h>
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/message_differencer.h>
+#include <numeric>
 #include <random>
+#include <thread>
 #include <vector>
 
 #include "src/common/testing/testing.h"
@@ -147,6 +150,9 @@ TEST(TableTest, bytes_test) {
 }
 
 TEST(TableTest, bytes_test_w_compaction) {
+  // Compacted batches keep their plain size.
+  PX_SET_FOR_SCOPE(FLAGS_table_store_zone_maps, false);
+  PX_SET_FOR_SCOPE(FLAGS_table_store_encode_cold_columns, false);
   auto rd = schema::RowDescriptor({types::DataType::INT64, types::DataType::STRING});
   schema::Relation rel(rd.types(), {"col1", "col2"});
 
@@ -205,6 +211,9 @@ TEST(TableTest, bytes_test_w_compaction) {
 }
 
 TEST(TableTest, expiry_test) {
+  // Compacted batches keep their plain size.
+  PX_SET_FOR_SCOPE(FLAGS_table_store_zone_maps, false);
+  PX_SET_FOR_SCOPE(FLAGS_table_store_encode_cold_columns, false);
   auto rd = schema::RowDescriptor({types::DataType::INT64, types::DataType::STRING});
   schema::Relation rel(rd.types(), {"col1", "col2"});
 
@@ -499,6 +508,512 @@ TEST(TableTest, hot_batches_w_compaction_test) {
   EXPECT_TRUE(rb2->ColumnAt(1)->Equals(types::ToArrow(col2_in2, arrow::default_memory_pool())));
 }
 
+TEST(TableTest, dictionary_encoded_compaction) {
+  schema::Relation rel({types::DataType::INT64, types::DataType::STRING}, {"col1", "col2"});
+
+  std::vector<types::Int64Value> col1(1000);
+  std::vector<types::StringValue> col2(1000);
+  for (int i = 0; i < 1000; ++i) {
+    col1[i] = i;
+    col2[i] = i % 3 == 0 ? "GET /api/v1/debug/healthz" : "POST /api/v1/metrics";
+  }
+  auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+  rb_wrapper->push_back(
+      types::ColumnWrapper::FromArrow(types::ToArrow(col1, arrow::default_memory_pool())));
+  rb_wrapper->push_back(
+      types::ColumnWrapper::FromArrow(types::ToArrow(col2, arrow::default_memory_pool())));
+
+  Table table("test_table", rel, 128 * 1024, 1);
+  EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+  auto hot_bytes = table.GetTableStats().bytes;
+
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_EQ(1, table.GetTableStats().compacted_batches);
+  EXPECT_LT(table.GetTableStats().bytes, hot_bytes / 2);
+
+  Table::Cursor cursor(&table);
+  auto rb = cursor.GetNextRowBatch({0, 1}).ConsumeValueOrDie();
+  EXPECT_TRUE(rb->ColumnAt(0)->Equals(types::ToArrow(col1, arrow::default_memory_pool())));
+  EXPECT_TRUE(rb->ColumnAt(1)->Equals(types::ToArrow(col2, arrow::default_memory_pool())));
+}
+
+TEST(TableTest, decoded_column_cache) {
+  schema::Relation rel({types::DataType::INT64, types::DataType::STRING}, {"col1", "col2"});
+
+  std::vector<types::Int64Value> col1(1000);
+  std::vector<types::StringValue> col2(1000);
+  for (int i = 0; i < 1000; ++i) {
+    col1[i] = i;
+    col2[i] = i % 3 == 0 ? "GET /api/v1/debug/healthz" : "POST /api/v1/metrics";
+  }
+  auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+  rb_wrapper->push_back(
+      types::ColumnWrapper::FromArrow(types::ToArrow(col1, arrow::default_memory_pool())));
+  rb_wrapper->push_back(
+      types::ColumnWrapper::FromArrow(types::ToArrow(col2, arrow::default_memory_pool())));
+
+  auto cache = std::make_shared<internal::DecodedColumnCache>(1024 * 1024);
+  Table table("test_table", rel, 128 * 1024, 1);
+  table.SetDecodedColumnCache(cache);
+  EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+
+  // Both columns are encoded, so the first read decodes and caches them, and the second read is
+  // served from the cache.
+  for (int read = 0; read < 2; ++read) {
+    Table::Cursor cursor(&table);
+    auto rb = cursor.GetNextRowBatch({0, 1}).ConsumeValueOrDie();
+    EXPECT_TRUE(rb->ColumnAt(0)->Equals(types::ToArrow(col1, arrow::default_memory_pool())));
+    EXPECT_TRUE(rb->ColumnAt(1)->Equals(types::ToArrow(col2, arrow::default_memory_pool())));
+  }
+  EXPECT_EQ(cache->misses(), 2);
+  EXPECT_EQ(cache->hits(), 2);
+  EXPECT_GT(cache->size_bytes(), 0);
+
+  // The entries of the batch go away with the batch.
+  EXPECT_OK(table.ExpireToSize(0));
+  EXPECT_EQ(cache->size_bytes(), 0);
+}
+
+TEST(TableTest, zone_maps_skip_cold_batches) {
+  schema::Relation rel({types::DataType::INT64, types::DataType::STRING}, {"col1", "col2"});
+  Table table("test_table", rel, 128 * 1024, 1);
+
+  for (int batch = 0; batch < 3; ++batch) {
+    std::vector<types::Int64Value> col1(100);
+    std::vector<types::StringValue> col2(100);
+    for (int i = 0; i < 100; ++i) {
+      col1[i] = batch * 100 + i;
+      col2[i] = absl::StrCat("service-", batch);
+    }
+    auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+    rb_wrapper->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(col1, arrow::default_memory_pool())));
+    rb_wrapper->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(col2, arrow::default_memory_pool())));
+    EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+  }
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_EQ(3, table.GetTableStats().compacted_batches);
+
+  auto read_rows = [&](std::vector<internal::ColumnPredicate> predicates) {
+    std::vector<int64_t> rows;
+    Table::Cursor cursor(&table);
+    cursor.SetPredicates(std::move(predicates));
+    while (!cursor.Done()) {
+      auto rb = cursor.GetNextRowBatch({0}).ConsumeValueOrDie();
+      for (int64_t i = 0; i < rb->num_rows(); ++i) {
+        rows.push_back(types::GetValueFromArrowArray<types::DataType::INT64>(
+            rb->ColumnAt(0).get(), i));
+      }
+    }
+    return rows;
+  };
+
+  EXPECT_THAT(read_rows({}), ::testing::SizeIs(300));
+
+  auto rows = read_rows({{1, internal::ColumnPredicate::kEqual, std::string("service-1")}});
+  ASSERT_THAT(rows, ::testing::SizeIs(100));
+  EXPECT_EQ(100, rows.front());
+  EXPECT_EQ(199, rows.back());
+
+  rows = read_rows({{0, internal::ColumnPredicate::kGreaterThanEqual, int64_t{250}}});
+  ASSERT_THAT(rows, ::testing::SizeIs(100));
+  EXPECT_EQ(200, rows.front());
+
+  EXPECT_THAT(read_rows({{1, internal::ColumnPredicate::kEqual, std::string("service-9")}}),
+              ::testing::IsEmpty());
+}
+
+TEST(TableTest, filter_predicates_filter_rows) {
+  schema::Relation rel({types::DataType::INT64, types::DataType::STRING}, {"col1", "col2"});
+  Table table("test_table", rel, 128 * 1024);
+
+  std::vector<types::Int64Value> col1 = {1, 2, 3, 4, 5, 6};
+  std::vector<types::StringValue> col2 = {"carts", "orders", "carts", "orders", "carts", "users"};
+  auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+  rb_wrapper->push_back(
+      types::ColumnWrapper::FromArrow(types::ToArrow(col1, arrow::default_memory_pool())));
+  rb_wrapper->push_back(
+      types::ColumnWrapper::FromArrow(types::ToArrow(col2, arrow::default_memory_pool())));
+  EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+
+  // The predicate column isn't read, but the rows are still filtered on it.
+  Table::Cursor cursor(&table);
+  cursor.SetFilterPredicates({{1, internal::ColumnPredicate::kEqual, std::string("carts")},
+                              {0, internal::ColumnPredicate::kGreaterThan, int64_t{1}}});
+  auto rb = cursor.GetNextRowBatch({0}).ConsumeValueOrDie();
+  ASSERT_EQ(1, rb->num_columns());
+  EXPECT_TRUE(rb->ColumnAt(0)->Equals(types::ToArrow(std::vector<types::Int64Value>{3, 5},
+                                                     arrow::default_memory_pool())));
+  EXPECT_TRUE(cursor.Done());
+
+  // Predicate values have to match the column type.
+  Table::Cursor bad_cursor(&table);
+  bad_cursor.SetFilterPredicates({{1, internal::ColumnPredicate::kEqual, int64_t{1}}});
+  EXPECT_NOT_OK(bad_cursor.GetNextRowBatch({0}));
+}
+
+TEST(TableTest, secondary_index_skips_batches) {
+  PX_SET_FOR_SCOPE(FLAGS_table_store_index_columns, "col2");
+  schema::Relation rel({types::DataType::INT64, types::DataType::STRING}, {"col1", "col2"});
+  Table table("test_table", rel, 128 * 1024, 2000);
+
+  for (int batch = 0; batch < 10; ++batch) {
+    std::vector<types::Int64Value> col1(100);
+    std::vector<types::StringValue> col2(100);
+    for (int i = 0; i < 100; ++i) {
+      col1[i] = batch * 100 + i;
+      col2[i] = batch == 3 || batch == 7 ? "px-sock-shop/carts" : "pl/kelvin";
+    }
+    auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+    rb_wrapper->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(col1, arrow::default_memory_pool())));
+    rb_wrapper->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(col2, arrow::default_memory_pool())));
+    EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+  }
+
+  auto read_rows = [&](internal::ColumnPredicate predicate, std::vector<int64_t>* first_rows) {
+    std::vector<int64_t> rows;
+    Table::Cursor cursor(&table);
+    cursor.SetPredicates({predicate});
+    while (!cursor.Done()) {
+      auto rb = cursor.GetNextRowBatch({0}).ConsumeValueOrDie();
+      if (rb->num_rows() > 0 && first_rows != nullptr) {
+        first_rows->push_back(
+            types::GetValueFromArrowArray<types::DataType::INT64>(rb->ColumnAt(0).get(), 0));
+      }
+      for (int64_t i = 0; i < rb->num_rows(); ++i) {
+        rows.push_back(types::GetValueFromArrowArray<types::DataType::INT64>(
+            rb->ColumnAt(0).get(), i));
+      }
+    }
+    return rows;
+  };
+  auto read_batches = [&](internal::ColumnPredicate predicate) {
+    std::vector<int64_t> first_rows;
+    read_rows(predicate, &first_rows);
+    return first_rows;
+  };
+
+  // Only the hot batches with the value are read.
+  internal::ColumnPredicate carts{1, internal::ColumnPredicate::kEqual,
+                                  std::string("px-sock-shop/carts")};
+  EXPECT_THAT(read_batches(carts), ::testing::ElementsAre(300, 700));
+  internal::ColumnPredicate sock_shop{1, internal::ColumnPredicate::kContains,
+                                      std::string("sock-shop")};
+  EXPECT_THAT(read_batches(sock_shop), ::testing::ElementsAre(300, 700));
+  internal::ColumnPredicate missing{1, internal::ColumnPredicate::kEqual, std::string("pl/pem")};
+  EXPECT_THAT(read_batches(missing), ::testing::IsEmpty());
+
+  // After compaction, the cold batches with the value are read in full, but no others.
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_GT(table.GetTableStats().compacted_batches, 0);
+  auto rows = read_rows(carts, nullptr);
+  EXPECT_LT(static_cast<int64_t>(rows.size()), 800);
+  for (int64_t row : {300, 399, 700, 799}) {
+    EXPECT_THAT(rows, ::testing::Contains(row));
+  }
+}
+
+TEST(TableTest, split_cursor) {
+  schema::Relation rel({types::DataType::INT64}, {"col1"});
+  Table table("test_table", rel, 128 * 1024, 1600);
+  for (int batch = 0; batch < 20; ++batch) {
+    std::vector<types::Int64Value> col1(100);
+    for (int i = 0; i < 100; ++i) {
+      col1[i] = batch * 100 + i;
+    }
+    auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+    rb_wrapper->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(col1, arrow::default_memory_pool())));
+    EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+  }
+
+  auto cursors = table.SplitCursor({}, {}, 4);
+  ASSERT_THAT(cursors, ::testing::SizeIs(4));
+  EXPECT_THAT(table.SplitCursor({}, {}, 100), ::testing::SizeIs(20));
+  Table::Cursor::StopSpec infinite{Table::Cursor::StopSpec::StopType::Infinite};
+  EXPECT_THAT(table.SplitCursor({}, infinite, 4), ::testing::SizeIs(1));
+
+  // Read the cursors concurrently, while the hot batches are compacted into cold batches of 2
+  // hot batches each.
+  std::vector<std::vector<int64_t>> rows(cursors.size());
+  std::vector<std::thread> readers;
+  for (size_t i = 0; i < cursors.size(); ++i) {
+    readers.emplace_back([&, i]() {
+      while (!cursors[i].Done()) {
+        auto rb = cursors[i].GetNextRowBatch({0}).ConsumeValueOrDie();
+        for (int64_t j = 0; j < rb->num_rows(); ++j) {
+          rows[i].push_back(types::GetValueFromArrowArray<types::DataType::INT64>(
+              rb->ColumnAt(0).get(), j));
+        }
+      }
+    });
+  }
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  std::vector<int64_t> all_rows;
+  for (const auto& cursor_rows : rows) {
+    EXPECT_THAT(cursor_rows, ::testing::SizeIs(500));
+    all_rows.insert(all_rows.end(), cursor_rows.begin(), cursor_rows.end());
+  }
+  std::vector<int64_t> expected(2000);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_EQ(expected, all_rows);
+}
+
+TEST(TableTest, skip_next_row_batch) {
+  schema::Relation rel({types::DataType::INT64}, {"col1"});
+  Table table("test_table", rel, 128 * 1024);
+  for (int batch = 0; batch < 3; ++batch) {
+    std::vector<types::Int64Value> col1 = {batch * 10, batch * 10 + 1};
+    auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+    rb_wrapper->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(col1, arrow::default_memory_pool())));
+    EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+  }
+
+  Table::Cursor cursor(&table);
+  EXPECT_EQ(2, cursor.SkipNextRowBatch().ConsumeValueOrDie());
+  auto rb = cursor.GetNextRowBatch({0}).ConsumeValueOrDie();
+  EXPECT_TRUE(rb->ColumnAt(0)->Equals(types::ToArrow(std::vector<types::Int64Value>{10, 11},
+                                                     arrow::default_memory_pool())));
+  EXPECT_EQ(2, cursor.SkipNextRowBatch().ConsumeValueOrDie());
+  EXPECT_TRUE(cursor.Done());
+}
+
+TEST(TableTest, reverse_cursor) {
+  schema::Relation rel({types::DataType::INT64}, {"col1"});
+  Table table("test_table", rel, 128 * 1024, 250);
+  for (int batch = 0; batch < 10; ++batch) {
+    std::vector<types::Int64Value> col1(100);
+    for (int i = 0; i < 100; ++i) {
+      col1[i] = batch * 100 + i;
+    }
+    auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+    rb_wrapper->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(col1, arrow::default_memory_pool())));
+    EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+    if (batch == 4) {
+      // Half of the rows are in cold batches, which don't line up with the hot batches.
+      EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+    }
+  }
+
+  auto read_rows = [](Table::Cursor* cursor) {
+    std::vector<int64_t> rows;
+    while (!cursor->Done()) {
+      auto rb = cursor->GetNextRowBatch({0}).ConsumeValueOrDie();
+      for (int64_t i = 0; i < rb->num_rows(); ++i) {
+        rows.push_back(types::GetValueFromArrowArray<types::DataType::INT64>(
+            rb->ColumnAt(0).get(), i));
+      }
+    }
+    return rows;
+  };
+
+  Table::Cursor cursor(&table);
+  ASSERT_OK(cursor.SetReverse());
+  EXPECT_TRUE(cursor.reverse());
+  // Rows written after the cursor was created aren't read.
+  std::vector<types::Int64Value> col1 = {1000};
+  auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+  rb_wrapper->push_back(
+      types::ColumnWrapper::FromArrow(types::ToArrow(col1, arrow::default_memory_pool())));
+  EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+  std::vector<int64_t> expected(1000);
+  std::iota(expected.rbegin(), expected.rend(), 0);
+  EXPECT_EQ(expected, read_rows(&cursor));
+
+  // Predicates still apply to the reversed rows.
+  Table::Cursor filtered(&table);
+  filtered.SetFilterPredicates({{0, internal::ColumnPredicate::kLessThan, int64_t{3}}});
+  ASSERT_OK(filtered.SetReverse());
+  EXPECT_THAT(read_rows(&filtered), ::testing::ElementsAre(2, 1, 0));
+
+  Table::Cursor::StopSpec infinite{Table::Cursor::StopSpec::StopType::Infinite};
+  Table::Cursor infinite_cursor(&table, {}, infinite);
+  EXPECT_NOT_OK(infinite_cursor.SetReverse());
+}
+
+TEST(TableTest, write_listeners_are_called_until_removed) {
+  schema::Relation rel({types::DataType::INT64}, {"col1"});
+  Table table("test_table", rel, 128 * 1024);
+  int num_calls_a = 0;
+  int num_calls_b = 0;
+  int64_t a = table.AddWriteListener([&] { ++num_calls_a; });
+  table.AddWriteListener([&] { ++num_calls_b; });
+
+  auto write_batch = [&]() {
+    std::vector<types::Int64Value> col1 = {1, 2, 3};
+    auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+    rb_wrapper->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(col1, arrow::default_memory_pool())));
+    EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+  };
+  write_batch();
+  write_batch();
+  EXPECT_EQ(2, num_calls_a);
+  EXPECT_EQ(2, num_calls_b);
+
+  table.RemoveWriteListener(a);
+  write_batch();
+  EXPECT_EQ(2, num_calls_a);
+  EXPECT_EQ(3, num_calls_b);
+}
+
+TEST(TableTest, expire_to_size_keeps_max_table_size) {
+  schema::Relation rel({types::DataType::INT64}, {"col1"});
+  Table table("test_table", rel, 1024);
+  for (int i = 0; i < 10; ++i) {
+    std::vector<types::Int64Value> col1 = {i, i, i, i};
+    auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+    rb_wrapper->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(col1, arrow::default_memory_pool())));
+    EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+  }
+  EXPECT_EQ(10 * 32, table.GetTableStats().bytes);
+
+  EXPECT_OK(table.ExpireToSize(100));
+  TableStats stats = table.GetTableStats();
+  EXPECT_EQ(3 * 32, stats.bytes);
+  EXPECT_EQ(1024, stats.max_table_size);
+
+  // A target above the current size doesn't expire anything.
+  EXPECT_OK(table.ExpireToSize(512));
+  EXPECT_EQ(3 * 32, table.GetTableStats().bytes);
+}
+
+TEST(TableTest, expiry_callback_gets_expired_rows) {
+  schema::Relation rel({types::DataType::INT64}, {"col1"});
+  Table table("test_table", rel, 2400, 1600);
+  std::vector<int64_t> expired_rows;
+  table.SetExpiryCallback([&](const schema::RowBatch& rb) {
+    for (int64_t i = 0; i < rb.num_rows(); ++i) {
+      expired_rows.push_back(
+          types::GetValueFromArrowArray<types::DataType::INT64>(rb.ColumnAt(0).get(), i));
+    }
+  });
+
+  auto write_batch = [&](int batch) {
+    std::vector<types::Int64Value> col1(100);
+    for (int i = 0; i < 100; ++i) {
+      col1[i] = batch * 100 + i;
+    }
+    auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+    rb_wrapper->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(col1, arrow::default_memory_pool())));
+    EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+  };
+  // Expires hot batches, then cold batches after the compaction.
+  for (int batch = 0; batch < 5; ++batch) {
+    write_batch(batch);
+  }
+  EXPECT_THAT(expired_rows, ::testing::SizeIs(200));
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  for (int batch = 5; batch < 8; ++batch) {
+    write_batch(batch);
+  }
+
+  // The expired rows and the rows left in the table are all of the written rows, in order.
+  Table::Cursor cursor(&table);
+  while (!cursor.Done()) {
+    auto rb = cursor.GetNextRowBatch({0}).ConsumeValueOrDie();
+    for (int64_t i = 0; i < rb->num_rows(); ++i) {
+      expired_rows.push_back(
+          types::GetValueFromArrowArray<types::DataType::INT64>(rb->ColumnAt(0).get(), i));
+    }
+  }
+  std::vector<int64_t> expected(800);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_EQ(expected, expired_rows);
+
+  table.SetExpiryCallback(nullptr);
+  write_batch(8);
+}
+
+TEST(TableTest, disk_tier_keeps_expired_cold_batches) {
+  px::testing::TempDir disk_dir;
+  PX_SET_FOR_SCOPE(FLAGS_table_store_disk_tier_dir, disk_dir.path().string());
+  // Keeps the sizes of the cold batches the same as the sizes of the hot ones.
+  PX_SET_FOR_SCOPE(FLAGS_table_store_encode_cold_columns, false);
+
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "col1"});
+  Table table("test_table", rel, 4000, 1);
+
+  for (int batch = 0; batch < 10; ++batch) {
+    std::vector<types::Time64NSValue> times(100);
+    std::vector<types::Int64Value> col1(100);
+    for (int i = 0; i < 100; ++i) {
+      times[i] = batch * 100 + i;
+      col1[i] = batch * 100 + i;
+    }
+    auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+    rb_wrapper->push_back(types::ColumnWrapper::FromArrow(
+        types::DataType::TIME64NS, types::ToArrow(times, arrow::default_memory_pool())));
+    rb_wrapper->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(col1, arrow::default_memory_pool())));
+    EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+    EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  }
+
+  auto stats = table.GetTableStats();
+  EXPECT_GT(stats.disk_bytes, 0);
+  EXPECT_LE(stats.bytes, 4000);
+  EXPECT_EQ(0, stats.min_time);
+  EXPECT_EQ(0, table.FirstRowID());
+  EXPECT_EQ(150, table.FindRowIDFromTimeFirstGreaterThanOrEqual(150));
+  EXPECT_EQ(251, table.FindRowIDFromTimeFirstGreaterThan(250));
+
+  std::vector<int64_t> rows;
+  Table::Cursor cursor(&table);
+  while (!cursor.Done()) {
+    auto rb = cursor.GetNextRowBatch({1}).ConsumeValueOrDie();
+    for (int64_t i = 0; i < rb->num_rows(); ++i) {
+      rows.push_back(
+          types::GetValueFromArrowArray<types::DataType::INT64>(rb->ColumnAt(0).get(), i));
+    }
+  }
+  ASSERT_THAT(rows, ::testing::SizeIs(1000));
+  for (int64_t i = 0; i < 1000; ++i) {
+    EXPECT_EQ(i, rows[i]);
+  }
+}
+
+TEST(TableTest, disk_tier_expires_oldest_batches) {
+  px::testing::TempDir disk_dir;
+  PX_SET_FOR_SCOPE(FLAGS_table_store_disk_tier_dir, disk_dir.path().string());
+  PX_SET_FOR_SCOPE(FLAGS_table_store_disk_tier_max_bytes, 1);
+  PX_SET_FOR_SCOPE(FLAGS_table_store_encode_cold_columns, false);
+
+  schema::Relation rel({types::DataType::INT64}, {"col1"});
+  Table table("test_table", rel, 2000, 1);
+
+  for (int batch = 0; batch < 10; ++batch) {
+    std::vector<types::Int64Value> col1(100, batch);
+    auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+    rb_wrapper->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(col1, arrow::default_memory_pool())));
+    EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+    EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  }
+
+  // Every batch is over the size of the disk tier, so it's discarded as soon as it's written.
+  EXPECT_EQ(0, table.GetTableStats().disk_bytes);
+  EXPECT_GT(table.FirstRowID(), 0);
+
+  Table::Cursor cursor(&table);
+  auto rb = cursor.GetNextRowBatch({0}).ConsumeValueOrDie();
+  ASSERT_GT(rb->num_rows(), 0);
+  EXPECT_EQ(table.FirstRowID() / 100,
+            types::GetValueFromArrowArray<types::DataType::INT64>(rb->ColumnAt(0).get(), 0));
+}
+
 TEST(TableTest, find_rowid_from_time_first_greater_than_or_equal) {
   schema::Relation rel(std::vector<types::DataType>({types::DataType::TIME64NS}),
                        std::vector<std::string>({"time_"}));
@@ -18,6 +18,11 @@
 
 #include "src/table_store/table/tablets_group.h"
 
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
 namespace px {
 namespace table_store {
 
@@ -46,5 +51,157 @@ bool TabletsGroup::HasTablet(const types::TabletID& tablet_id) const {
   return tablet_id_to_tablet_map_.find(tablet_id) != tablet_id_to_tablet_map_.end();
 }
 
+std::vector<const Table*> TabletsGroup::GetTablets() const {
+  std::vector<const Table*> tablets;
+  tablets.reserve(tablet_id_to_tablet_map_.size());
+  for (const auto& [tablet_id, tablet] : tablet_id_to_tablet_map_) {
+    tablets.push_back(tablet.get());
+  }
+  return tablets;
+}
+
+TabletsMergeCursor::TabletsMergeCursor(const std::vector<const Table*>& tablets,
+                                       const schema::Relation& relation, StartSpec start,
+                                       StopSpec stop) {
+  for (const auto& [i, col_name] : Enumerate(relation.col_names())) {
+    if (col_name == "time_" && relation.GetColumnType(i) == types::DataType::TIME64NS) {
+      time_col_idx_ = i;
+    }
+  }
+
+  // Cursors that stop at the current end of the table never see rows added later, so their
+  // tablets can also be skipped for being empty or ending before the start time.
+  const bool fixed_end = stop.type == StopSpec::StopType::CurrentEndOfTable ||
+                         stop.type == StopSpec::StopType::StopAtTimeOrEndOfTable;
+  const bool has_stop_time = stop.type == StopSpec::StopType::StopAtTime ||
+                             stop.type == StopSpec::StopType::StopAtTimeOrEndOfTable;
+  const bool has_start_time = start.type == StartSpec::StartType::StartAtTime;
+
+  tablets_.reserve(tablets.size());
+  for (const Table* tablet : tablets) {
+    if (time_col_idx_ != -1) {
+      auto [min_time, max_time] = tablet->TimeRange();
+      if (fixed_end && min_time == -1) {
+        continue;
+      }
+      // Rows are appended in time order, so rows added later can't be before the stop time either.
+      if (has_stop_time && min_time > stop.stop_time) {
+        continue;
+      }
+      if (fixed_end && has_start_time && max_time < start.start_time) {
+        continue;
+      }
+    }
+    tablets_.push_back(TabletState{Table::Cursor(tablet, start, stop), nullptr});
+  }
+}
+
+bool TabletsMergeCursor::NextBatchReady() {
+  for (auto& tablet : tablets_) {
+    if (tablet.pending != nullptr || tablet.cursor.NextBatchReady()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool TabletsMergeCursor::Done() {
+  for (auto& tablet : tablets_) {
+    if (tablet.pending != nullptr || !tablet.cursor.Done()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+internal::Time TabletsMergeCursor::RowTime(const schema::RowBatch& rb, int64_t row) const {
+  auto time_col = rb.ColumnAt(time_pos_);
+  return types::GetValueFromArrowArray<types::DataType::TIME64NS>(time_col.get(), row);
+}
+
+Status TabletsMergeCursor::ReadPending() {
+  for (auto& tablet : tablets_) {
+    // Empty batches (e.g. of rows expired since the last read) are skipped.
+    while (tablet.pending == nullptr && !tablet.cursor.Done() && tablet.cursor.NextBatchReady()) {
+      PX_ASSIGN_OR_RETURN(auto rb, tablet.cursor.GetNextRowBatch(read_cols_));
+      if (rb->num_rows() > 0) {
+        tablet.pending = std::move(rb);
+      }
+    }
+  }
+  return Status::OK();
+}
+
+StatusOr<std::unique_ptr<schema::RowBatch>> TabletsMergeCursor::GetNextRowBatch(
+    const std::vector<int64_t>& cols) {
+  if (read_cols_.empty()) {
+    read_cols_ = cols;
+    if (time_col_idx_ != -1) {
+      auto it = std::find(read_cols_.begin(), read_cols_.end(), time_col_idx_);
+      time_pos_ = std::distance(read_cols_.begin(), it);
+      if (it == read_cols_.end()) {
+        read_cols_.push_back(time_col_idx_);
+      }
+    }
+  }
+  DCHECK(cols.size() <= read_cols_.size() &&
+         std::equal(cols.begin(), cols.end(), read_cols_.begin()))
+      << "All the reads of a TabletsMergeCursor must be of the same columns.";
+  PX_RETURN_IF_ERROR(ReadPending());
+
+  // Find the tablet whose pending rows start the earliest, and the time at which the pending rows
+  // of the others start.
+  TabletState* earliest = nullptr;
+  internal::Time earliest_time = 0;
+  internal::Time next_time = std::numeric_limits<internal::Time>::max();
+  for (auto& tablet : tablets_) {
+    if (tablet.pending == nullptr) {
+      continue;
+    }
+    if (time_pos_ == -1) {
+      earliest = &tablet;
+      break;
+    }
+    internal::Time time = RowTime(*tablet.pending, 0);
+    if (earliest == nullptr || time < earliest_time) {
+      if (earliest != nullptr) {
+        next_time = earliest_time;
+      }
+      earliest = &tablet;
+      earliest_time = time;
+    } else {
+      next_time = std::min(next_time, time);
+    }
+  }
+  if (earliest == nullptr) {
+    return error::ResourceUnavailable("No tablet has a row batch ready.");
+  }
+
+  std::unique_ptr<schema::RowBatch> rb = std::move(earliest->pending);
+  if (time_pos_ != -1 && RowTime(*rb, rb->num_rows() - 1) > next_time) {
+    // Only the rows up to where another tablet starts keep the output in time order, the others
+    // stay pending. There is at least one, since this tablet starts the earliest.
+    auto time_col = rb->ColumnAt(time_pos_);
+    int64_t last_row = types::SearchArrowArrayLessThanOrEqual<types::DataType::TIME64NS>(
+        time_col.get(), next_time);
+    int64_t num_rows = last_row + 1;
+    PX_ASSIGN_OR_RETURN(earliest->pending, rb->Slice(num_rows, rb->num_rows() - num_rows));
+    PX_ASSIGN_OR_RETURN(rb, rb->Slice(0, num_rows));
+  }
+  if (read_cols_.size() == cols.size()) {
+    return rb;
+  }
+  // Drop the time column, which was only read for the merge.
+  std::vector<types::DataType> types;
+  for (size_t i = 0; i < cols.size(); ++i) {
+    types.push_back(rb->desc().type(i));
+  }
+  auto output = std::make_unique<schema::RowBatch>(schema::RowDescriptor(types), rb->num_rows());
+  for (size_t i = 0; i < cols.size(); ++i) {
+    PX_RETURN_IF_ERROR(output->AddColumn(rb->ColumnAt(i)));
+  }
+  return output;
+}
+
 }  // namespace table_store
 }  // namespace px
@@ -21,6 +21,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "src/common/base/base.h"
 #include "src/shared/types/column_wrapper.h"
@@ -81,10 +82,69 @@ class TabletsGroup {
    */
   const schema::Relation& GetRelation() const { return relation_; }
 
+  /**
+   * @brief Get all the tablets of this TabletsGroup, e.g. to read them with a TabletsMergeCursor.
+   *
+   * @return the tablets, in no particular order.
+   */
+  std::vector<const Table*> GetTablets() const;
+
  private:
   schema::Relation relation_;
   std::unordered_map<types::TabletID, std::shared_ptr<Table>> tablet_id_to_tablet_map_;
 };
 
+/**
+ * TabletsMergeCursor reads the tablets of a tabletized table as a single stream of row batches in
+ * time order, instead of a Table::Cursor per tablet whose outputs have to be unioned. Tablets whose
+ * time range is outside of the window of the start and stop specs are skipped up front, without
+ * creating a cursor for them.
+ *
+ * The tablets are merged batch by batch: the next batch comes from the tablet whose pending rows
+ * start the earliest, and is cut short where the pending rows of another tablet start, so that the
+ * rows come out sorted by time even when the tablets overlap. Tables without a time column are
+ * read one tablet after the other.
+ *
+ * The tablets must outlive the cursor, and all the calls to GetNextRowBatch() must read the same
+ * columns, since rows are read ahead.
+ */
+class TabletsMergeCursor {
+ public:
+  using StartSpec = Table::Cursor::StartSpec;
+  using StopSpec = Table::Cursor::StopSpec;
+
+  TabletsMergeCursor(const std::vector<const Table*>& tablets, const schema::Relation& relation,
+                     StartSpec start, StopSpec stop);
+
+  // Whether any of the tablets has rows ready, see Table::Cursor::NextBatchReady().
+  bool NextBatchReady();
+  StatusOr<std::unique_ptr<schema::RowBatch>> GetNextRowBatch(const std::vector<int64_t>& cols);
+  // Whether all the tablets are done. With a StopType of Infinite, this always returns false.
+  bool Done();
+
+  // The number of tablets read, i.e. not skipped for being outside of the window.
+  size_t num_tablets() const { return tablets_.size(); }
+
+ private:
+  struct TabletState {
+    Table::Cursor cursor;
+    // Rows read from the tablet but not returned yet, with the columns of read_cols_.
+    std::unique_ptr<schema::RowBatch> pending;
+  };
+
+  // Reads the next batch of each tablet that has no pending rows and has a batch ready.
+  Status ReadPending();
+  internal::Time RowTime(const schema::RowBatch& rb, int64_t row) const;
+
+  std::vector<TabletState> tablets_;
+  // The index of the time column in the relation, or -1 if it has none.
+  int64_t time_col_idx_ = -1;
+  // The columns read from the tablets: the requested ones, then the time column if it wasn't
+  // requested.
+  std::vector<int64_t> read_cols_;
+  // The position of the time column in read_cols_, or -1 if there is no time column.
+  int64_t time_pos_ = -1;
+};
+
 }  // namespace table_store
 }  // namespace px
@@ -21,6 +21,8 @@
 #include <gtest/gtest.h>
 #include <vector>
 
+#include "src/common/testing/testing.h"
+
 #include "src/table_store/schema/relation.h"
 #include "src/table_store/schema/row_descriptor.h"
 #include "src/table_store/table/table_store.h"
@@ -62,5 +64,88 @@ TEST_F(TabletsGroupTest, TabletIdNotFoundMissing) {
   EXPECT_EQ(table.GetTablet(tablet_id2), nullptr);
 }
 
+class TabletsMergeCursorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    rel_ = schema::Relation({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "x"});
+  }
+
+  // Writes a batch with the given times to the tablet, where x is the time plus the offset.
+  void WriteBatch(Table* tablet, const std::vector<types::Time64NSValue>& times, int64_t offset) {
+    std::vector<types::Int64Value> xs;
+    for (const auto& time : times) {
+      xs.push_back(time.val + offset);
+    }
+    schema::RowBatch rb(RowDescriptor(rel_.col_types()), times.size());
+    PX_CHECK_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+    PX_CHECK_OK(rb.AddColumn(types::ToArrow(xs, arrow::default_memory_pool())));
+    PX_CHECK_OK(tablet->WriteRowBatch(rb));
+  }
+
+  // Reads the x column until the cursor is done.
+  std::vector<int64_t> ReadAll(TabletsMergeCursor* cursor) {
+    std::vector<int64_t> xs;
+    while (!cursor->Done()) {
+      auto rb_or_s = cursor->GetNextRowBatch({1});
+      EXPECT_OK(rb_or_s);
+      auto rb = rb_or_s.ConsumeValueOrDie();
+      EXPECT_EQ(rb->num_columns(), 1);
+      auto* col = static_cast<arrow::Int64Array*>(rb->ColumnAt(0).get());
+      for (int64_t i = 0; i < col->length(); ++i) {
+        xs.push_back(col->Value(i));
+      }
+    }
+    return xs;
+  }
+
+  schema::Relation rel_;
+};
+
+TEST_F(TabletsMergeCursorTest, MergesInTimeOrder) {
+  auto tablet1 = Table::Create("tablet1", rel_);
+  auto tablet2 = Table::Create("tablet2", rel_);
+  auto tablet3 = Table::Create("tablet3", rel_);
+  WriteBatch(tablet1.get(), {1, 4, 7}, 1000);
+  WriteBatch(tablet1.get(), {10, 13}, 1000);
+  WriteBatch(tablet2.get(), {2, 3, 8}, 2000);
+  WriteBatch(tablet3.get(), {5, 6}, 3000);
+
+  TabletsMergeCursor cursor({tablet1.get(), tablet2.get(), tablet3.get()}, rel_, {}, {});
+  EXPECT_EQ(cursor.num_tablets(), 3);
+  EXPECT_THAT(ReadAll(&cursor), ::testing::ElementsAre(1001, 2002, 2003, 1004, 3005, 3006, 1007,
+                                                       2008, 1010, 1013));
+}
+
+TEST_F(TabletsMergeCursorTest, SkipsTabletsOutsideOfWindow) {
+  auto before = Table::Create("before", rel_);
+  auto inside = Table::Create("inside", rel_);
+  auto after = Table::Create("after", rel_);
+  auto empty = Table::Create("empty", rel_);
+  WriteBatch(before.get(), {1, 2}, 1000);
+  WriteBatch(inside.get(), {5, 10, 20}, 2000);
+  WriteBatch(after.get(), {30, 40}, 3000);
+
+  TabletsMergeCursor cursor(
+      {before.get(), inside.get(), after.get(), empty.get()}, rel_,
+      {TabletsMergeCursor::StartSpec::StartAtTime, 5},
+      {TabletsMergeCursor::StopSpec::StopAtTimeOrEndOfTable, 25});
+  EXPECT_EQ(cursor.num_tablets(), 1);
+  EXPECT_THAT(ReadAll(&cursor), ::testing::ElementsAre(2005, 2010, 2020));
+}
+
+TEST(TableStoreTest, GetTablets) {
+  schema::Relation rel({types::DataType::TIME64NS}, {"time_"});
+  TableStore table_store;
+  auto tablet1 = Table::Create("table", rel);
+  auto tablet2 = Table::Create("table", rel);
+  table_store.AddTable(tablet1, "table", std::nullopt, "1");
+  table_store.AddTable(tablet2, "table", std::nullopt, "2");
+  table_store.AddTable(Table::Create("other", rel), "other");
+
+  EXPECT_THAT(table_store.GetTablets("table"),
+              ::testing::UnorderedElementsAre(tablet1.get(), tablet2.get()));
+  EXPECT_TRUE(table_store.GetTablets("missing").empty());
+}
+
 }  // namespace table_store
 }  // namespace px
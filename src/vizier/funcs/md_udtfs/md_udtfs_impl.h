@@ -34,6 +34,7 @@
 #include "src/carnot/udf/registry.h"
 #include "src/carnot/udf/udf.h"
 #include "src/common/base/base.h"
+#include "src/common/perf/perf.h"
 #include "src/common/uuid/uuid.h"
 #include "src/shared/types/typespb/types.pb.h"
 #include "src/vizier/services/agent/shared/manager/manager.h"
@@ -780,6 +781,58 @@ class GetDebugTableInfo final : public carnot::udf::UDTF<GetDebugTableInfo> {
   std::vector<uint64_t> table_ids_;
 };
 
+/**
+ * This UDTF reports the latency histograms of the perf probes of each agent.
+ */
+class GetPerfCounters final : public carnot::udf::UDTF<GetPerfCounters> {
+ public:
+  static constexpr auto Executor() { return carnot::udfspb::UDTFSourceExecutor::UDTF_ALL_AGENTS; }
+
+  static constexpr auto OutputRelation() {
+    return MakeArray(ColInfo("asid", types::DataType::INT64, types::PatternType::GENERAL,
+                             "The short ID of the agent"),
+                     ColInfo("subsystem", types::DataType::STRING, types::PatternType::GENERAL,
+                             "The subsystem of the probe"),
+                     ColInfo("probe", types::DataType::STRING, types::PatternType::GENERAL,
+                             "The name of the probe"),
+                     ColInfo("count", types::DataType::INT64, types::PatternType::METRIC_COUNTER,
+                             "The number of times the probe was hit"),
+                     ColInfo("total_ns", types::DataType::INT64, types::PatternType::METRIC_COUNTER,
+                             "The total time spent in the probe, in nanoseconds"),
+                     ColInfo("p50_ns", types::DataType::INT64, types::PatternType::METRIC_GAUGE,
+                             "The median time spent in the probe, rounded up to a power of 2"),
+                     ColInfo("p99_ns", types::DataType::INT64, types::PatternType::METRIC_GAUGE,
+                             "The 99th percentile of the time spent in the probe, rounded up to "
+                             "a power of 2"));
+  }
+
+  Status Init(FunctionContext*) {
+    stats_ = perf::PerfProbe::AllStats();
+    return Status::OK();
+  }
+
+  bool NextRecord(FunctionContext* ctx, RecordWriter* rw) {
+    if (current_idx_ >= stats_.size()) {
+      return false;
+    }
+    const auto& stats = stats_[current_idx_];
+    rw->Append<IndexOf("asid")>(ctx->metadata_state()->asid());
+    rw->Append<IndexOf("subsystem")>(stats.subsystem);
+    rw->Append<IndexOf("probe")>(stats.name);
+    rw->Append<IndexOf("count")>(stats.count);
+    rw->Append<IndexOf("total_ns")>(stats.sum_ns);
+    rw->Append<IndexOf("p50_ns")>(stats.Quantile(0.5));
+    rw->Append<IndexOf("p99_ns")>(stats.Quantile(0.99));
+
+    ++current_idx_;
+    return current_idx_ < stats_.size();
+  }
+
+ private:
+  std::vector<perf::ProbeStats> stats_;
+  size_t current_idx_ = 0;
+};
+
 /**
  * This UDTF fetches information about tracepoints from MDS.
  */
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/vizier/services/agent/pem/memory_pressure.h"
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <absl/strings/ascii.h>
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_split.h>
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+namespace {
+
+StatusOr<int64_t> ParseInt(const std::filesystem::path& path, std::string_view text) {
+  int64_t bytes;
+  if (!absl::SimpleAtoi(absl::StripAsciiWhitespace(text), &bytes)) {
+    return error::Internal("Failed to parse $0 from $1.", text, path.string());
+  }
+  return bytes;
+}
+
+}  // namespace
+
+StatusOr<CgroupMemoryStats> ReadCgroupMemoryStats(const std::filesystem::path& cgroup_dir) {
+  CgroupMemoryStats stats;
+
+  const auto current_path = cgroup_dir / "memory.current";
+  PX_ASSIGN_OR_RETURN(std::string current, ReadFileToString(current_path.string()));
+  PX_ASSIGN_OR_RETURN(stats.current_bytes, ParseInt(current_path, current));
+
+  const auto max_path = cgroup_dir / "memory.max";
+  PX_ASSIGN_OR_RETURN(std::string max, ReadFileToString(max_path.string()));
+  if (absl::StripAsciiWhitespace(max) != "max") {
+    PX_ASSIGN_OR_RETURN(stats.max_bytes, ParseInt(max_path, max));
+  }
+
+  // Without the inactive_file of memory.stat, the working set is all of memory.current, which
+  // overestimates the pressure rather than failing to measure it at all.
+  const auto stat_path = cgroup_dir / "memory.stat";
+  auto stat_or_s = ReadFileToString(stat_path.string());
+  if (stat_or_s.ok()) {
+    for (std::string_view line :
+         absl::StrSplit(stat_or_s.ValueOrDie(), '\n', absl::SkipWhitespace())) {
+      std::vector<std::string_view> fields = absl::StrSplit(line, ' ', absl::SkipWhitespace());
+      if (fields.size() == 2 && fields[0] == "inactive_file") {
+        auto inactive_file_or_s = ParseInt(stat_path, fields[1]);
+        if (inactive_file_or_s.ok()) {
+          stats.inactive_file_bytes = inactive_file_or_s.ValueOrDie();
+        }
+      }
+    }
+  }
+
+  const auto events_path = cgroup_dir / "memory.events";
+  PX_ASSIGN_OR_RETURN(std::string events, ReadFileToString(events_path.string()));
+  for (std::string_view line : absl::StrSplit(events, '\n', absl::SkipWhitespace())) {
+    std::vector<std::string_view> fields = absl::StrSplit(line, ' ', absl::SkipWhitespace());
+    if (fields.size() != 2) {
+      return error::Internal("Unexpected line '$0' in $1.", line, events_path.string());
+    }
+    int64_t* count = nullptr;
+    if (fields[0] == "high") {
+      count = &stats.high_events;
+    } else if (fields[0] == "max") {
+      count = &stats.max_events;
+    } else if (fields[0] == "oom_kill") {
+      count = &stats.oom_kill_events;
+    } else {
+      continue;
+    }
+    PX_ASSIGN_OR_RETURN(*count, ParseInt(events_path, fields[1]));
+  }
+  return stats;
+}
+
+MemoryPressureLevel MemoryPressureMonitor::UsageLevel(const CgroupMemoryStats& stats) const {
+  if (stats.max_bytes <= 0) {
+    return MemoryPressureLevel::kNone;
+  }
+  double usage =
+      static_cast<double>(stats.working_set_bytes()) / static_cast<double>(stats.max_bytes);
+  if (usage >= config_.critical_usage) {
+    return MemoryPressureLevel::kCritical;
+  }
+  if (usage >= config_.high_usage) {
+    return MemoryPressureLevel::kHigh;
+  }
+  if (usage >= config_.moderate_usage) {
+    return MemoryPressureLevel::kModerate;
+  }
+  return MemoryPressureLevel::kNone;
+}
+
+MemoryPressureLevel MemoryPressureMonitor::Update(const CgroupMemoryStats& stats) {
+  MemoryPressureLevel target = UsageLevel(stats);
+  if (has_prev_stats_) {
+    if (stats.max_events > prev_stats_.max_events ||
+        stats.oom_kill_events > prev_stats_.oom_kill_events) {
+      target = MemoryPressureLevel::kCritical;
+    } else if (stats.high_events > prev_stats_.high_events) {
+      target = std::max(target, MemoryPressureLevel::kHigh);
+    }
+  }
+  has_prev_stats_ = true;
+  prev_stats_ = stats;
+
+  if (target >= level_) {
+    level_ = target;
+  } else {
+    level_ = static_cast<MemoryPressureLevel>(static_cast<int>(level_) - 1);
+  }
+  return level_;
+}
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
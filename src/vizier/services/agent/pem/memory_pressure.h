@@ -0,0 +1,110 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+/**
+ * How short of memory the PEM is, from the least to the most severe. Each level includes the
+ * responses of the levels before it.
+ */
+enum class MemoryPressureLevel {
+  kNone,
+  // Release the free memory of tcmalloc.
+  kModerate,
+  // Also expire the oldest data of the table store early, and shrink the data stream buffers that
+  // Stirling retains between transfers.
+  kHigh,
+  // Also hold back the export queries.
+  kCritical,
+};
+
+/**
+ * The memory accounting of a cgroup v2, from its memory.current, memory.max, memory.stat and
+ * memory.events.
+ */
+struct CgroupMemoryStats {
+  int64_t current_bytes = 0;
+  // The page cache that hasn't been accessed recently, which the kernel reclaims before it has to
+  // OOM kill anything. memory.current includes it. 0 if memory.stat can't be read.
+  int64_t inactive_file_bytes = 0;
+  // -1 if the cgroup has no memory limit.
+  int64_t max_bytes = -1;
+  // The number of times the usage went over memory.high, reached memory.max, and got a process
+  // OOM killed.
+  int64_t high_events = 0;
+  int64_t max_events = 0;
+  int64_t oom_kill_events = 0;
+
+  // The memory that can't be reclaimed without swapping, as measured by the kubelet's evictions.
+  int64_t working_set_bytes() const {
+    return std::max<int64_t>(0, current_bytes - inactive_file_bytes);
+  }
+};
+
+StatusOr<CgroupMemoryStats> ReadCgroupMemoryStats(const std::filesystem::path& cgroup_dir);
+
+/**
+ * Turns the memory accounting of the cgroup of the PEM into a MemoryPressureLevel.
+ *
+ * The level follows the working set relative to memory.max. New high events raise it to at least
+ * kHigh, and new max or OOM kill events to kCritical, since they mean that the kernel is already
+ * reclaiming or killing. The level goes up right away, but down by one step per update, so that
+ * the responses aren't undone by the memory they just freed.
+ */
+class MemoryPressureMonitor {
+ public:
+  struct Config {
+    // The fractions of memory.max at which the levels start.
+    double moderate_usage = 0.75;
+    double high_usage = 0.85;
+    double critical_usage = 0.92;
+  };
+
+  explicit MemoryPressureMonitor(const Config& config) : config_(config) {}
+
+  /**
+   * Updates the level with new stats of the cgroup.
+   * @return the new level.
+   */
+  MemoryPressureLevel Update(const CgroupMemoryStats& stats);
+
+  MemoryPressureLevel level() const { return level_; }
+
+ private:
+  MemoryPressureLevel UsageLevel(const CgroupMemoryStats& stats) const;
+
+  const Config config_;
+  MemoryPressureLevel level_ = MemoryPressureLevel::kNone;
+  // The event counts are cumulative, only their increments since the previous update count.
+  bool has_prev_stats_ = false;
+  CgroupMemoryStats prev_stats_;
+};
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+
+#include "src/common/testing/temp_dir.h"
+#include "src/common/testing/testing.h"
+#include "src/vizier/services/agent/pem/memory_pressure.h"
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+TEST(ReadCgroupMemoryStatsTest, ParsesFiles) {
+  px::testing::TempDir cgroup_dir;
+  ASSERT_OK(WriteFileFromString((cgroup_dir.path() / "memory.current").string(), "1000\n"));
+  ASSERT_OK(WriteFileFromString((cgroup_dir.path() / "memory.max").string(), "4000\n"));
+  ASSERT_OK(WriteFileFromString((cgroup_dir.path() / "memory.stat").string(),
+                                "anon 400\nfile 500\nactive_file 200\ninactive_file 300\n"));
+  ASSERT_OK(WriteFileFromString((cgroup_dir.path() / "memory.events").string(),
+                                "low 0\nhigh 3\nmax 2\noom 1\noom_kill 1\n"));
+
+  ASSERT_OK_AND_ASSIGN(CgroupMemoryStats stats, ReadCgroupMemoryStats(cgroup_dir.path()));
+  EXPECT_EQ(1000, stats.current_bytes);
+  EXPECT_EQ(4000, stats.max_bytes);
+  EXPECT_EQ(300, stats.inactive_file_bytes);
+  EXPECT_EQ(700, stats.working_set_bytes());
+  EXPECT_EQ(3, stats.high_events);
+  EXPECT_EQ(2, stats.max_events);
+  EXPECT_EQ(1, stats.oom_kill_events);
+
+  ASSERT_OK(WriteFileFromString((cgroup_dir.path() / "memory.max").string(), "max\n"));
+  ASSERT_OK_AND_ASSIGN(stats, ReadCgroupMemoryStats(cgroup_dir.path()));
+  EXPECT_EQ(-1, stats.max_bytes);
+}
+
+TEST(ReadCgroupMemoryStatsTest, FallsBackToCurrentWithoutInactiveFile) {
+  px::testing::TempDir cgroup_dir;
+  ASSERT_OK(WriteFileFromString((cgroup_dir.path() / "memory.current").string(), "1000\n"));
+  ASSERT_OK(WriteFileFromString((cgroup_dir.path() / "memory.max").string(), "4000\n"));
+  ASSERT_OK(WriteFileFromString((cgroup_dir.path() / "memory.events").string(),
+                                "low 0\nhigh 3\nmax 2\noom 1\noom_kill 1\n"));
+
+  // No memory.stat.
+  ASSERT_OK_AND_ASSIGN(CgroupMemoryStats stats, ReadCgroupMemoryStats(cgroup_dir.path()));
+  EXPECT_EQ(0, stats.inactive_file_bytes);
+  EXPECT_EQ(1000, stats.working_set_bytes());
+  EXPECT_EQ(3, stats.high_events);
+
+  // A memory.stat without inactive_file.
+  ASSERT_OK(WriteFileFromString((cgroup_dir.path() / "memory.stat").string(),
+                                "anon 400\nfile 500\n"));
+  ASSERT_OK_AND_ASSIGN(stats, ReadCgroupMemoryStats(cgroup_dir.path()));
+  EXPECT_EQ(1000, stats.working_set_bytes());
+
+  // An inactive_file that isn't a number.
+  ASSERT_OK(WriteFileFromString((cgroup_dir.path() / "memory.stat").string(),
+                                "anon 400\ninactive_file abc\n"));
+  ASSERT_OK_AND_ASSIGN(stats, ReadCgroupMemoryStats(cgroup_dir.path()));
+  EXPECT_EQ(1000, stats.working_set_bytes());
+}
+
+TEST(ReadCgroupMemoryStatsTest, MissingFiles) {
+  px::testing::TempDir cgroup_dir;
+  EXPECT_NOT_OK(ReadCgroupMemoryStats(cgroup_dir.path()));
+}
+
+CgroupMemoryStats Stats(int64_t current_bytes, int64_t high_events = 0, int64_t max_events = 0,
+                        int64_t inactive_file_bytes = 0) {
+  CgroupMemoryStats stats;
+  stats.current_bytes = current_bytes;
+  stats.inactive_file_bytes = inactive_file_bytes;
+  stats.max_bytes = 100;
+  stats.high_events = high_events;
+  stats.max_events = max_events;
+  return stats;
+}
+
+TEST(MemoryPressureMonitorTest, FollowsUsage) {
+  MemoryPressureMonitor monitor({/*moderate_usage*/ 0.7, /*high_usage*/ 0.8,
+                                 /*critical_usage*/ 0.9});
+  EXPECT_EQ(MemoryPressureLevel::kNone, monitor.Update(Stats(50)));
+  EXPECT_EQ(MemoryPressureLevel::kModerate, monitor.Update(Stats(75)));
+  // Goes up right away.
+  EXPECT_EQ(MemoryPressureLevel::kCritical, monitor.Update(Stats(95)));
+  // Goes down one step at a time.
+  EXPECT_EQ(MemoryPressureLevel::kHigh, monitor.Update(Stats(50)));
+  EXPECT_EQ(MemoryPressureLevel::kModerate, monitor.Update(Stats(50)));
+  EXPECT_EQ(MemoryPressureLevel::kNone, monitor.Update(Stats(50)));
+}
+
+TEST(MemoryPressureMonitorTest, IgnoresInactivePageCache) {
+  MemoryPressureMonitor monitor({/*moderate_usage*/ 0.7, /*high_usage*/ 0.8,
+                                 /*critical_usage*/ 0.9});
+  // The kernel reclaims the inactive page cache before it runs out of memory.
+  EXPECT_EQ(MemoryPressureLevel::kNone, monitor.Update(Stats(95, 0, 0, 40)));
+  EXPECT_EQ(MemoryPressureLevel::kModerate, monitor.Update(Stats(95, 0, 0, 20)));
+}
+
+TEST(MemoryPressureMonitorTest, ReactsToNewEvents) {
+  MemoryPressureMonitor monitor({/*moderate_usage*/ 0.7, /*high_usage*/ 0.8,
+                                 /*critical_usage*/ 0.9});
+  // The events from before the first update don't count.
+  EXPECT_EQ(MemoryPressureLevel::kNone, monitor.Update(Stats(50, 10, 10)));
+  EXPECT_EQ(MemoryPressureLevel::kHigh, monitor.Update(Stats(50, 11, 10)));
+  EXPECT_EQ(MemoryPressureLevel::kCritical, monitor.Update(Stats(50, 11, 11)));
+  EXPECT_EQ(MemoryPressureLevel::kHigh, monitor.Update(Stats(50, 11, 11)));
+}
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
@@ -18,7 +18,26 @@
 
 #include "src/vizier/services/agent/pem/pem_manager.h"
 
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_set.h>
+#include <absl/strings/ascii.h>
+#include <absl/strings/str_join.h>
+#include <absl/strings/str_split.h>
+#include <absl/strings/substitute.h>
+#include <arrow/array.h>
+#include <magic_enum.hpp>
+
+#include "src/common/perf/tcmalloc.h"
 #include "src/common/system/config.h"
+#include "src/vizier/services/agent/pem/self_profile.h"
 #include "src/vizier/services/agent/shared/manager/exec.h"
 #include "src/vizier/services/agent/shared/manager/manager.h"
 
@@ -43,10 +62,94 @@ DEFINE_int32(table_store_proc_exit_events_limit_bytes,
              gflags::Int32FromEnv("PL_TABLE_STORE_PROC_EXIT_EVENTS_LIMIT_BYTES", 10 * 1024 * 1024),
              "The maximum amount of data to store in the proc_exit_events table.");
 
+DEFINE_string(table_store_snapshot_path,
+              gflags::StringFromEnv("PL_TABLE_STORE_SNAPSHOT_PATH", ""),
+              "The local file that the table store is snapshotted to when the PEM stops, and "
+              "restored from when it starts, so that a restart doesn't lose the buffered data. "
+              "Empty disables snapshots.");
+
+DEFINE_int32(table_store_snapshot_period_s,
+             gflags::Int32FromEnv("PL_TABLE_STORE_SNAPSHOT_PERIOD_S", 0),
+             "If positive, the table store is also snapshotted with this period, so that data "
+             "survives restarts that don't stop the PEM gracefully.");
+
+DEFINE_bool(table_store_dynamic_retention,
+            gflags::BoolFromEnv("PL_TABLE_STORE_DYNAMIC_RETENTION", false),
+            "Split the table store data limit between the tables dynamically, by their weights and "
+            "how much they are written, instead of giving each table a fixed size.");
+
+DEFINE_string(table_store_table_weights, gflags::StringFromEnv("PL_TABLE_STORE_TABLE_WEIGHTS", ""),
+              "Comma separated table_name=weight pairs for the dynamic retention of the table "
+              "store. Tables default to a weight proportional to their fixed size.");
+
+DEFINE_string(table_store_table_min_retention_s,
+              gflags::StringFromEnv("PL_TABLE_STORE_TABLE_MIN_RETENTION_S", ""),
+              "Comma separated table_name=seconds pairs for the dynamic retention of the table "
+              "store. A table that holds less than this much data isn't shrunk for other tables.");
+
+DEFINE_int32(table_store_retention_rebalance_period_s,
+             gflags::Int32FromEnv("PL_TABLE_STORE_RETENTION_REBALANCE_PERIOD_S", 10),
+             "The period with which the dynamic retention of the table store is rebalanced.");
+
+DEFINE_string(table_store_rollup_dir, gflags::StringFromEnv("PL_TABLE_STORE_ROLLUP_DIR", ""),
+              "A directory of PxL scripts (*.pxl) that each aggregate the rows that expire from "
+              "one table into rollup tables, one per displayed result. Empty disables rollups.");
+
+DEFINE_int32(table_store_rollup_period_s,
+             gflags::Int32FromEnv("PL_TABLE_STORE_ROLLUP_PERIOD_S", 60),
+             "The period with which the expired rows are aggregated into the rollup tables.");
+
+DEFINE_int32(table_store_rollup_table_limit_bytes,
+             gflags::Int32FromEnv("PL_TABLE_STORE_ROLLUP_TABLE_LIMIT_BYTES", 8 * 1024 * 1024),
+             "The maximum amount of data to store in each rollup table.");
+
+DEFINE_string(stirling_unused_columns, gflags::StringFromEnv("PL_STIRLING_UNUSED_COLUMNS", ""),
+              "Comma separated table_name.column_name list of the columns that no script or "
+              "rollup reads (e.g. http_events.req_body,http_events.resp_body). Stirling stores "
+              "unused string columns as empty strings to save memory.");
+
+DEFINE_int32(memory_pressure_check_period_ms,
+             gflags::Int32FromEnv("PL_MEMORY_PRESSURE_CHECK_PERIOD_MS", 1000),
+             "The period with which the memory of the cgroup of the PEM is checked, to free memory "
+             "before the PEM is OOM killed. 0 disables the checks.");
+
+DEFINE_string(memory_pressure_cgroup_dir,
+              gflags::StringFromEnv("PL_MEMORY_PRESSURE_CGROUP_DIR", "/sys/fs/cgroup"),
+              "The cgroup v2 directory of the PEM, with its memory.current, memory.max, "
+              "memory.stat and memory.events.");
+
+DEFINE_int32(memory_pressure_moderate_pct,
+             gflags::Int32FromEnv("PL_MEMORY_PRESSURE_MODERATE_PCT", 75),
+             "The percent of memory.max, used by the working set of the PEM (i.e. excluding the "
+             "inactive page cache), from which the PEM releases free memory.");
+
+DEFINE_int32(memory_pressure_high_pct, gflags::Int32FromEnv("PL_MEMORY_PRESSURE_HIGH_PCT", 85),
+             "The percent of memory.max from which the PEM also expires the oldest data of the "
+             "table store early, and Stirling retains less data between transfers.");
+
+DEFINE_int32(memory_pressure_critical_pct,
+             gflags::Int32FromEnv("PL_MEMORY_PRESSURE_CRITICAL_PCT", 92),
+             "The percent of memory.max from which export queries are also held back.");
+
+DECLARE_uint32(stirling_profiler_stack_trace_sample_period_ms);
+DECLARE_bool(stirling_profiler_intern_frames);
+
 namespace px {
 namespace vizier {
 namespace agent {
 
+namespace {
+
+// The fraction of their maximum size that the tables are expired down to, by pressure level. The
+// tables keep their whole budget under moderate pressure, and only lose data early once releasing
+// the free memory of tcmalloc hasn't been enough.
+constexpr double kTableStoreFractionAtPressure[] = {1.0, 1.0, 0.7, 0.5};
+
+// Releasing the free memory of tcmalloc walks its page heap, which isn't worth it for a little.
+constexpr size_t kMinFreeMemoryToReleaseBytes = 16 * 1024 * 1024;
+
+}  // namespace
+
 Status PEMManager::InitImpl() {
   PX_RETURN_IF_ERROR(InitClockConverters());
   StartNodeMemoryCollector();
@@ -57,6 +160,36 @@ Status PEMManager::PostRegisterHookImpl() {
   stirling_->RegisterDataPushCallback(std::bind(&table_store::TableStore::AppendData, table_store(),
                                                 std::placeholders::_1, std::placeholders::_2,
                                                 std::placeholders::_3));
+  // Tables are never removed from the table store, so the sinks can hold on to them.
+  stirling_->RegisterDataPushSinkFactory([this](uint32_t table_id) -> stirling::DataPushSink {
+    table_store::Table* table = table_store()->GetTable(table_id);
+    if (table == nullptr) {
+      return nullptr;
+    }
+    return [table](std::unique_ptr<types::ColumnWrapperRecordBatch> record_batch) {
+      return table->TransferRecordBatch(std::move(record_batch));
+    };
+  });
+  // Arrow batches are already in the format of the hot store, so they are written as they are.
+  stirling_->RegisterArrowDataPushSinkFactory(
+      [this](uint32_t table_id) -> stirling::ArrowDataPushSink {
+        table_store::Table* table = table_store()->GetTable(table_id);
+        if (table == nullptr) {
+          return nullptr;
+        }
+        table_store::schema::RowDescriptor desc(table->GetRelation().col_types());
+        return [table, desc = std::move(desc)](stirling::ArrowRecordBatch record_batch) {
+          if (record_batch.size() != desc.size()) {
+            return error::Internal("Expected $0 columns, got $1", desc.size(),
+                                   record_batch.size());
+          }
+          table_store::schema::RowBatch rb(desc, record_batch[0]->length());
+          for (auto& col : record_batch) {
+            PX_RETURN_IF_ERROR(rb.AddColumn(std::move(col)));
+          }
+          return table->WriteRowBatch(rb);
+        };
+      });
 
   // Enable use of USR1/USR2 for controlling Stirling debug.
   stirling_->RegisterUserDebugSignalHandlers();
@@ -66,12 +199,21 @@ Status PEMManager::PostRegisterHookImpl() {
       std::bind(&px::md::AgentMetadataStateManager::CurrentAgentMetadataState, mds_manager()));
 
   PX_RETURN_IF_ERROR(InitSchemas());
+  PX_RETURN_IF_ERROR(InitUnusedColumns());
+  InitRollups();
+  // The snapshot is restored before Stirling starts pushing data, so that the restored data stays
+  // in time order.
+  RestoreTableStoreSnapshot();
   PX_RETURN_IF_ERROR(stirling_->RunAsThread());
+  StartTableStoreSnapshots();
+  StartRetentionRebalancing();
+  StartRollups();
 
-  auto execute_query_handler = std::make_shared<ExecuteQueryMessageHandler>(
+  execute_query_handler_ = std::make_shared<ExecuteQueryMessageHandler>(
       dispatcher(), info(), agent_nats_connector(), carnot());
   PX_RETURN_IF_ERROR(RegisterMessageHandler(messages::VizierMessage::MsgCase::kExecuteQueryRequest,
-                                            execute_query_handler));
+                                            execute_query_handler_));
+  StartMemoryPressureMonitor();
 
   tracepoint_manager_ =
       std::make_shared<TracepointManager>(dispatcher(), info(), agent_nats_connector(),
@@ -82,11 +224,55 @@ Status PEMManager::PostRegisterHookImpl() {
 }
 
 Status PEMManager::StopImpl(std::chrono::milliseconds) {
+  memory_pressure_timer_.reset();
   stirling_->Stop();
   stirling_.reset();
+  if (!FLAGS_table_store_snapshot_path.empty()) {
+    auto s = table_store()->WriteSnapshot(FLAGS_table_store_snapshot_path);
+    LOG_IF(ERROR, !s.ok()) << "Failed to snapshot the table store: " << s.msg();
+  }
   return Status::OK();
 }
 
+StatusOr<std::string> PEMManager::CPUProfile(std::chrono::seconds duration) {
+  // Stirling's profiler samples the PEM along with the rest of the node, so the profile is built
+  // out of the stack traces it already recorded. This also avoids gperftools, which conflicts
+  // with BCC kprobes.
+  return BuildSelfCPUProfile(table_store(), info()->asid, info()->pid,
+                             CurrentTimeNS() - std::chrono::nanoseconds(duration).count(),
+                             FLAGS_stirling_profiler_stack_trace_sample_period_ms,
+                             FLAGS_stirling_profiler_intern_frames);
+}
+
+void PEMManager::RestoreTableStoreSnapshot() {
+  if (FLAGS_table_store_snapshot_path.empty()) {
+    return;
+  }
+  auto s = table_store()->RestoreSnapshot(FLAGS_table_store_snapshot_path);
+  if (error::IsNotFound(s)) {
+    LOG(INFO) << "No table store snapshot to restore.";
+  } else if (!s.ok()) {
+    LOG(ERROR) << "Failed to restore the table store snapshot: " << s.msg();
+  } else {
+    LOG(INFO) << "Restored the table store snapshot.";
+  }
+}
+
+void PEMManager::StartTableStoreSnapshots() {
+  if (FLAGS_table_store_snapshot_path.empty() || FLAGS_table_store_snapshot_period_s <= 0) {
+    return;
+  }
+  auto period = std::chrono::seconds(FLAGS_table_store_snapshot_period_s);
+  table_store_snapshot_timer_ = dispatcher()->CreateTimer([this, period]() {
+    auto s = table_store()->WriteSnapshot(FLAGS_table_store_snapshot_path);
+    LOG_IF(ERROR, !s.ok()) << "Failed to snapshot the table store: " << s.msg();
+    if (table_store_snapshot_timer_) {
+      table_store_snapshot_timer_->EnableTimer(period);
+    }
+  });
+  table_store_snapshot_timer_->EnableTimer(period);
+}
+
 Status PEMManager::InitSchemas() {
   px::stirling::stirlingpb::Publish publish_pb;
   stirling_->GetPublishProto(&publish_pb);
@@ -102,6 +288,9 @@ Status PEMManager::InitSchemas() {
                               probe_status_table_size - proc_exit_events_table_size) /
                              (num_tables - 4);
 
+  // The fixed sizes are the initial sizes of the tables, and their default weights when the
+  // retention is dynamic.
+  table_store::TableRetentionSpecs retention_specs;
   for (const auto& relation_info : relation_info_vec) {
     std::shared_ptr<table_store::Table> table_ptr;
     if (relation_info.name == "http_events") {
@@ -124,12 +313,132 @@ Status PEMManager::InitSchemas() {
                                                        other_table_size);
     }
 
+    retention_specs[relation_info.name].weight = table_ptr->GetTableStats().max_table_size;
     table_store()->AddTable(std::move(table_ptr), relation_info.name, relation_info.id);
-    PX_RETURN_IF_ERROR(relation_info_manager()->AddRelationInfo(relation_info));
+  }
+  PX_RETURN_IF_ERROR(relation_info_manager()->AddRelationInfos(std::move(relation_info_vec)));
+
+  if (FLAGS_table_store_dynamic_retention) {
+    PX_RETURN_IF_ERROR(table_store::RetentionBudget::ParseSpecs(
+        FLAGS_table_store_table_weights, FLAGS_table_store_table_min_retention_s,
+        &retention_specs));
+    table_store()->SetRetentionBudget(memory_limit, std::move(retention_specs));
   }
   return Status::OK();
 }
 
+Status PEMManager::InitUnusedColumns() {
+  // Keep the tables in flag order, so that errors are deterministic.
+  std::vector<std::pair<std::string, std::vector<std::string>>> unused_columns;
+  for (std::string_view spec :
+       absl::StrSplit(FLAGS_stirling_unused_columns, ',', absl::SkipWhitespace())) {
+    std::vector<std::string> parts = absl::StrSplit(absl::StripAsciiWhitespace(spec),
+                                                    absl::MaxSplits('.', 1));
+    if (parts.size() != 2 || parts[0].empty() || parts[1].empty()) {
+      return error::InvalidArgument("Expected table_name.column_name, got '$0'.", spec);
+    }
+    auto iter = std::find_if(unused_columns.begin(), unused_columns.end(),
+                             [&](const auto& entry) { return entry.first == parts[0]; });
+    if (iter == unused_columns.end()) {
+      unused_columns.emplace_back(parts[0], std::vector<std::string>{});
+      iter = std::prev(unused_columns.end());
+    }
+    iter->second.push_back(parts[1]);
+  }
+
+  for (const auto& [table_name, column_names] : unused_columns) {
+    PX_RETURN_IF_ERROR(stirling_->SetUnusedColumns(table_name, column_names));
+    LOG(INFO) << absl::Substitute("Stirling won't collect the columns [$0] of table $1.",
+                                  absl::StrJoin(column_names, ","), table_name);
+  }
+  return Status::OK();
+}
+
+void PEMManager::StartRetentionRebalancing() {
+  if (!FLAGS_table_store_dynamic_retention) {
+    return;
+  }
+  auto period = std::chrono::seconds(std::max(FLAGS_table_store_retention_rebalance_period_s, 1));
+  retention_rebalance_timer_ = dispatcher()->CreateTimer([this, period]() {
+    auto s = table_store()->RebalanceRetention();
+    LOG_IF(ERROR, !s.ok()) << "Failed to rebalance the table store retention: " << s.msg();
+    if (retention_rebalance_timer_) {
+      retention_rebalance_timer_->EnableTimer(period);
+    }
+  });
+  retention_rebalance_timer_->EnableTimer(period);
+}
+
+void PEMManager::InitRollups() {
+  if (FLAGS_table_store_rollup_dir.empty()) {
+    return;
+  }
+  std::error_code ec;
+  std::filesystem::directory_iterator dir(FLAGS_table_store_rollup_dir, ec);
+  if (ec) {
+    LOG(ERROR) << absl::Substitute("Failed to list the rollup dir $0: $1",
+                                   FLAGS_table_store_rollup_dir, ec.message());
+    return;
+  }
+  // A bad rollup script only disables its own rollups.
+  absl::flat_hash_set<std::string> source_table_names;
+  for (const auto& entry : dir) {
+    if (entry.path().extension() != ".pxl") {
+      continue;
+    }
+    auto query_or_s = ReadFileToString(entry.path().string());
+    if (!query_or_s.ok()) {
+      LOG(ERROR) << absl::Substitute("Failed to read rollup $0: $1", entry.path().string(),
+                                     query_or_s.msg());
+      continue;
+    }
+    carnot::TableRollup::Spec spec;
+    spec.query = query_or_s.ConsumeValueOrDie();
+    spec.max_table_size = FLAGS_table_store_rollup_table_limit_bytes;
+    auto rollup_or_s = carnot::TableRollup::Create(carnot(), table_store(), std::move(spec));
+    if (!rollup_or_s.ok()) {
+      LOG(ERROR) << absl::Substitute("Failed to create rollup $0: $1", entry.path().string(),
+                                     rollup_or_s.msg());
+      continue;
+    }
+    auto rollup = rollup_or_s.ConsumeValueOrDie();
+    if (!source_table_names.insert(rollup->source_table_name()).second) {
+      LOG(ERROR) << absl::Substitute("Ignoring rollup $0, table $1 already has a rollup.",
+                                     entry.path().string(), rollup->source_table_name());
+      continue;
+    }
+    for (const auto& output : rollup->outputs()) {
+      RelationInfo relation_info(output.name, kRollupTableIDStart + num_rollup_tables_++,
+                                 absl::Substitute("Rollup of $0.", rollup->source_table_name()),
+                                 output.relation);
+      table_store()->AddTable(output.table, relation_info.name, relation_info.id);
+      auto s = relation_info_manager()->AddRelationInfo(std::move(relation_info));
+      LOG_IF(ERROR, !s.ok()) << "Failed to add the relation of a rollup table: " << s.msg();
+    }
+    LOG(INFO) << absl::Substitute("Rolling up table $0 with $1.", rollup->source_table_name(),
+                                  entry.path().string());
+    rollups_.push_back(std::move(rollup));
+  }
+}
+
+void PEMManager::StartRollups() {
+  if (rollups_.empty()) {
+    return;
+  }
+  auto period = std::chrono::seconds(std::max(FLAGS_table_store_rollup_period_s, 1));
+  rollup_timer_ = dispatcher()->CreateTimer([this, period]() {
+    for (const auto& rollup : rollups_) {
+      auto s = rollup->Run();
+      LOG_IF(ERROR, !s.ok()) << absl::Substitute("Failed to roll up table $0: $1",
+                                                 rollup->source_table_name(), s.msg());
+    }
+    if (rollup_timer_) {
+      rollup_timer_->EnableTimer(period);
+    }
+  });
+  rollup_timer_->EnableTimer(period);
+}
+
 Status PEMManager::InitClockConverters() {
   clock_converter_timer_ = dispatcher()->CreateTimer([this]() {
     auto clock_converter = px::system::Config::GetInstance().clock_converter();
@@ -160,6 +469,64 @@ void PEMManager::StartNodeMemoryCollector() {
   node_memory_timer_->EnableTimer(kNodeMemoryCollectionPeriod);
 }
 
+void PEMManager::StartMemoryPressureMonitor() {
+  if (FLAGS_memory_pressure_check_period_ms <= 0) {
+    return;
+  }
+  auto stats_or_s = ReadCgroupMemoryStats(FLAGS_memory_pressure_cgroup_dir);
+  if (!stats_or_s.ok()) {
+    LOG(WARNING) << absl::Substitute(
+        "Memory pressure checks are disabled, failed to read the cgroup memory stats in $0: $1",
+        FLAGS_memory_pressure_cgroup_dir, stats_or_s.msg());
+    return;
+  }
+  MemoryPressureMonitor::Config config;
+  config.moderate_usage = FLAGS_memory_pressure_moderate_pct / 100.0;
+  config.high_usage = FLAGS_memory_pressure_high_pct / 100.0;
+  config.critical_usage = FLAGS_memory_pressure_critical_pct / 100.0;
+  memory_pressure_monitor_ = std::make_unique<MemoryPressureMonitor>(config);
+  memory_pressure_monitor_->Update(stats_or_s.ValueOrDie());
+
+  auto period = std::chrono::milliseconds(FLAGS_memory_pressure_check_period_ms);
+  memory_pressure_timer_ = dispatcher()->CreateTimer([this, period]() {
+    auto stats_or_s = ReadCgroupMemoryStats(FLAGS_memory_pressure_cgroup_dir);
+    if (stats_or_s.ok()) {
+      ApplyMemoryPressure(memory_pressure_monitor_->Update(stats_or_s.ValueOrDie()));
+    } else {
+      LOG_FIRST_N(ERROR, 10) << "Failed to read the cgroup memory stats: " << stats_or_s.msg();
+    }
+    if (memory_pressure_timer_) {
+      memory_pressure_timer_->EnableTimer(period);
+    }
+  });
+  memory_pressure_timer_->EnableTimer(period);
+}
+
+void PEMManager::ApplyMemoryPressure(MemoryPressureLevel level) {
+  const auto prev_level = static_cast<MemoryPressureLevel>(memory_pressure_level_.Value());
+  LOG_IF(WARNING, level != prev_level) << absl::Substitute(
+      "Memory pressure level changed from $0 to $1.", magic_enum::enum_name(prev_level),
+      magic_enum::enum_name(level));
+  memory_pressure_level_.Set(static_cast<double>(level));
+
+  if (level >= MemoryPressureLevel::kModerate) {
+    // Memory that tcmalloc keeps for reuse counts against the cgroup limit all the same.
+    if (FreeMemoryBytes() >= kMinFreeMemoryToReleaseBytes) {
+      ReleaseFreeMemory();
+    }
+  }
+  if (level >= MemoryPressureLevel::kHigh) {
+    auto s = table_store()->ExpireToFraction(
+        kTableStoreFractionAtPressure[static_cast<int>(level)]);
+    LOG_IF(ERROR, !s.ok()) << "Failed to expire table store data under memory pressure: "
+                           << s.msg();
+  }
+  if (stirling_ != nullptr) {
+    stirling_->SetMemoryPressure(level >= MemoryPressureLevel::kHigh);
+  }
+  execute_query_handler_->SetMemoryPressure(level >= MemoryPressureLevel::kCritical);
+}
+
 }  // namespace agent
 }  // namespace vizier
 }  // namespace px
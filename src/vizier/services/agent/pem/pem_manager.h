@@ -23,12 +23,16 @@
 #include <numeric>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <prometheus/gauge.h>
 
+#include "src/carnot/table_rollup.h"
 #include "src/common/system/kernel_version.h"
 #include "src/stirling/stirling.h"
+#include "src/vizier/services/agent/pem/memory_pressure.h"
 #include "src/vizier/services/agent/pem/tracepoint_manager.h"
+#include "src/vizier/services/agent/shared/manager/exec.h"
 #include "src/vizier/services/agent/shared/manager/manager.h"
 
 DECLARE_uint32(stirling_profiler_stack_trace_sample_period_ms);
@@ -38,6 +42,8 @@ namespace vizier {
 namespace agent {
 
 constexpr auto kNodeMemoryCollectionPeriod = std::chrono::minutes(1);
+// The IDs of the rollup tables start well past the IDs that Stirling assigns to its tables.
+constexpr uint64_t kRollupTableIDStart = uint64_t{1} << 32;
 
 class PEMManager : public Manager {
  public:
@@ -77,18 +83,37 @@ class PEMManager : public Manager {
                                .Help("Total amount of memory on the node (includes inuse and free "
                                      "memory). Corresponds to /proc/meminfo MemTotal.")
                                .Register(GetMetricsRegistry())
-                               .Add({})) {}
+                               .Add({})),
+        memory_pressure_level_(prometheus::BuildGauge()
+                                   .Name("memory_pressure_level")
+                                   .Help("The memory pressure level of the PEM, from 0 (none) to "
+                                         "3 (critical), from the memory accounting of its "
+                                         "cgroup.")
+                                   .Register(GetMetricsRegistry())
+                                   .Add({})) {}
 
   std::string k8s_update_selector() const override { return info()->host_ip; }
 
   Status InitImpl() override;
   Status PostRegisterHookImpl() override;
   Status StopImpl(std::chrono::milliseconds) override;
+  StatusOr<std::string> CPUProfile(std::chrono::seconds duration) override;
 
  private:
   Status InitSchemas();
+  // Tells Stirling which columns aren't read by any script, so that it doesn't collect them.
+  Status InitUnusedColumns();
   Status InitClockConverters();
   void StartNodeMemoryCollector();
+  void RestoreTableStoreSnapshot();
+  void StartTableStoreSnapshots();
+  void StartRetentionRebalancing();
+  // Creates the rollups of the table store from the scripts in the rollup dir.
+  void InitRollups();
+  void StartRollups();
+  // Periodically checks the memory of the cgroup of the PEM, see MemoryPressureMonitor.
+  void StartMemoryPressureMonitor();
+  void ApplyMemoryPressure(MemoryPressureLevel level);
   static services::shared::agent::AgentCapabilities Capabilities() {
     services::shared::agent::AgentCapabilities capabilities;
     capabilities.set_collects_data(true);
@@ -104,13 +129,26 @@ class PEMManager : public Manager {
 
   std::unique_ptr<stirling::Stirling> stirling_;
   std::shared_ptr<TracepointManager> tracepoint_manager_;
+  std::shared_ptr<ExecuteQueryMessageHandler> execute_query_handler_;
 
   // Timer for triggering ClockConverter polls.
   px::event::TimerUPtr clock_converter_timer_;
   // Timer for collecting info about the node's available memory.
   px::event::TimerUPtr node_memory_timer_;
+  // Timer for the periodic snapshots of the table store.
+  px::event::TimerUPtr table_store_snapshot_timer_;
+  // Timer to rebalance the retention budget of the table store, if the retention is dynamic.
+  px::event::TimerUPtr retention_rebalance_timer_;
+  // Timer to aggregate the expired rows of the tables into their rollups.
+  px::event::TimerUPtr rollup_timer_;
+  std::vector<std::unique_ptr<carnot::TableRollup>> rollups_;
+  uint64_t num_rollup_tables_ = 0;
+  // Timer for checking the memory pressure of the cgroup.
+  px::event::TimerUPtr memory_pressure_timer_;
+  std::unique_ptr<MemoryPressureMonitor> memory_pressure_monitor_;
   prometheus::Gauge& node_available_memory_;
   prometheus::Gauge& node_total_memory_;
+  prometheus::Gauge& memory_pressure_level_;
 };
 
 }  // namespace agent
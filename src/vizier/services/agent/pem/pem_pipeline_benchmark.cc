@@ -0,0 +1,230 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// End-to-end benchmark of the PEM data path: the sequence generator source feeds Stirling, which
+// pushes into the table store (with background compaction running), while Carnot queries the
+// tables. Reports the ingest rate, the query latency percentiles and the resident memory.
+
+#include <benchmark/benchmark.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+#include <sole.hpp>
+
+#include "src/carnot/carnot.h"
+#include "src/carnot/exec/local_grpc_result_server.h"
+#include "src/carnot/funcs/funcs.h"
+#include "src/common/base/base.h"
+#include "src/common/system/proc_parser.h"
+#include "src/shared/schema/utils.h"
+#include "src/stirling/core/source_registry.h"
+#include "src/stirling/source_connectors/seq_gen/seq_gen_connector.h"
+#include "src/stirling/stirling.h"
+#include "src/table_store/table_store.h"
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+using carnot::Carnot;
+using carnot::exec::LocalGRPCResultSinkServer;
+using stirling::SeqGenConnector;
+using stirling::SourceRegistry;
+using stirling::Stirling;
+
+constexpr std::chrono::milliseconds kCompactionPeriod{1000};
+constexpr std::chrono::seconds kWarmupTime{2};
+
+constexpr char kAggQuery[] = R"pxl(
+import px
+df = px.DataFrame(table='sequence_generator0', select=['x', 'xsquared'])
+df = df.agg(sum=('xsquared', px.sum), count=('x', px.count))
+px.display(df, '$0')
+)pxl";
+
+constexpr char kGroupByQuery[] = R"pxl(
+import px
+df = px.DataFrame(table='sequence_generator0', select=['xmod10', 'PIx'])
+df = df.groupby('xmod10').agg(mean=('PIx', px.mean))
+px.display(df, '$0')
+)pxl";
+
+constexpr char kTabletizedGroupByQuery[] = R"pxl(
+import px
+df = px.DataFrame(table='sequence_generator1', select=['xmod8', 'x'])
+df = df.groupby('xmod8').agg(max=('x', px.max))
+px.display(df, '$0')
+)pxl";
+
+std::unique_ptr<Carnot> SetUpCarnot(std::shared_ptr<table_store::TableStore> table_store,
+                                    LocalGRPCResultSinkServer* server) {
+  auto func_registry = std::make_unique<carnot::udf::Registry>("default_registry");
+  carnot::funcs::RegisterFuncsOrDie(func_registry.get());
+  auto clients_config = std::make_unique<Carnot::ClientsConfig>(Carnot::ClientsConfig{
+      [server](const std::string& address, const std::string&) {
+        return server->StubGenerator(address);
+      },
+      [](grpc::ClientContext*) {},
+  });
+  auto server_config = std::make_unique<Carnot::ServerConfig>();
+  server_config->grpc_server_port = 0;
+
+  return Carnot::Create(sole::uuid4(), std::move(func_registry), table_store,
+                        std::move(clients_config), std::move(server_config))
+      .ConsumeValueOrDie();
+}
+
+// Sets up Stirling with only the sequence generator, pushing into the table store the same way
+// as the PEM does. Every row that reaches the table store is counted in num_rows_ingested.
+std::unique_ptr<Stirling> SetUpStirling(uint32_t num_rows_per_get,
+                                        table_store::TableStore* table_store,
+                                        std::atomic<int64_t>* num_rows_ingested) {
+  auto registry = std::make_unique<SourceRegistry>();
+  PX_CHECK_OK(registry->Register(
+      {std::string(SeqGenConnector::kName),
+       [num_rows_per_get](std::string_view name) {
+         auto source = SeqGenConnector::Create(name);
+         static_cast<SeqGenConnector*>(source.get())->ConfigureNumRowsPerGet(num_rows_per_get);
+         return source;
+       },
+       SeqGenConnector::kTables}));
+  auto stirling = Stirling::Create(std::move(registry));
+
+  stirling::stirlingpb::Publish publish_pb;
+  stirling->GetPublishProto(&publish_pb);
+  for (const auto& relation_info : ConvertPublishPBToRelationInfo(publish_pb)) {
+    table_store->AddTable(table_store::Table::Create(relation_info.name, relation_info.relation),
+                          relation_info.name, relation_info.id);
+  }
+
+  stirling->RegisterDataPushCallback(
+      [table_store, num_rows_ingested](uint32_t table_id, types::TabletID tablet_id,
+                                       std::unique_ptr<types::ColumnWrapperRecordBatch> rb) {
+        if (!rb->empty()) {
+          *num_rows_ingested += rb->front()->Size();
+        }
+        return table_store->AppendData(table_id, std::move(tablet_id), std::move(rb));
+      });
+  stirling->RegisterDataPushSinkFactory(
+      [table_store, num_rows_ingested](uint32_t table_id) -> stirling::DataPushSink {
+        table_store::Table* table = table_store->GetTable(table_id);
+        if (table == nullptr) {
+          return nullptr;
+        }
+        return [table, num_rows_ingested](std::unique_ptr<types::ColumnWrapperRecordBatch> rb) {
+          if (!rb->empty()) {
+            *num_rows_ingested += rb->front()->Size();
+          }
+          return table->TransferRecordBatch(std::move(rb));
+        };
+      });
+  return stirling;
+}
+
+double Percentile(std::vector<double> values, double p) {
+  if (values.empty()) {
+    return 0;
+  }
+  size_t idx = std::min(values.size() - 1, static_cast<size_t>(p * values.size()));
+  std::nth_element(values.begin(), values.begin() + idx, values.end());
+  return values[idx];
+}
+
+int64_t ResidentBytes() {
+  system::ProcParser proc_parser;
+  system::ProcParser::ProcessStatus status;
+  if (!proc_parser.ParseProcPIDStatus(getpid(), &status).ok()) {
+    return 0;
+  }
+  return status.vm_rss_bytes;
+}
+
+// Arg 0 is the number of rows the sequence generator produces per sampling period.
+// NOLINTNEXTLINE : runtime/references.
+void BM_PEMPipeline(benchmark::State& state, const std::string& query) {
+  auto table_store = std::make_shared<table_store::TableStore>();
+  LocalGRPCResultSinkServer server;
+  auto carnot = SetUpCarnot(table_store, &server);
+
+  std::atomic<int64_t> num_rows_ingested = 0;
+  auto stirling = SetUpStirling(state.range(0), table_store.get(), &num_rows_ingested);
+  table_store->StartCompactionScheduler(kCompactionPeriod);
+  PX_CHECK_OK(stirling->RunAsThread());
+  PX_CHECK_OK(stirling->WaitUntilRunning(std::chrono::seconds(5)));
+
+  // Let the tables fill up, so that the first queries don't run on empty tables.
+  std::this_thread::sleep_for(kWarmupTime);
+
+  int64_t start_rows = num_rows_ingested;
+  auto start_time = std::chrono::steady_clock::now();
+  std::vector<double> latencies_ms;
+  int i = 0;
+  for (auto _ : state) {
+    auto query_start = std::chrono::steady_clock::now();
+    auto s = carnot->ExecuteQuery(absl::Substitute(query, "results_" + std::to_string(i)),
+                                  sole::uuid4(), CurrentTimeNS());
+    latencies_ms.push_back(std::chrono::duration<double, std::milli>(
+                               std::chrono::steady_clock::now() - query_start)
+                               .count());
+    if (!s.ok()) {
+      LOG(FATAL) << "Pipeline benchmark query did not execute successfully: " << s.msg();
+    }
+    server.ResetQueryResults();
+    ++i;
+  }
+  double elapsed_s =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  int64_t rows = num_rows_ingested - start_rows;
+
+  stirling->Stop();
+  table_store->StopCompactionScheduler();
+
+  state.counters["ingest_rows_per_s"] = elapsed_s > 0 ? rows / elapsed_s : 0;
+  state.counters["query_p50_ms"] = Percentile(latencies_ms, 0.50);
+  state.counters["query_p99_ms"] = Percentile(latencies_ms, 0.99);
+  state.counters["rss_bytes"] = ResidentBytes();
+}
+
+BENCHMARK_CAPTURE(BM_PEMPipeline, agg, kAggQuery)
+    ->RangeMultiplier(10)
+    ->Range(100, 100000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_PEMPipeline, group_by, kGroupByQuery)
+    ->RangeMultiplier(10)
+    ->Range(100, 100000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_PEMPipeline, tabletized_group_by, kTabletizedGroupByQuery)
+    ->RangeMultiplier(10)
+    ->Range(100, 100000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
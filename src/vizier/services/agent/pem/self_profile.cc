@@ -0,0 +1,115 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "src/vizier/services/agent/pem/self_profile.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "src/shared/pprof/pprof.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/upid/upid.h"
+#include "src/stirling/source_connectors/perf_profiler/stack_traces_table.h"
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+namespace {
+
+using table_store::Table;
+
+// The frame ids of the frames table are scoped to this PEM, so they all share one source.
+constexpr uint64_t kFramesSource = 0;
+
+Status AddFrames(const Table& frames_table, shared::PProfBuilder* builder) {
+  const std::vector<int64_t> cols = {stirling::kStackTraceFramesFrameIDIdx,
+                                     stirling::kStackTraceFramesFrameIdx};
+  Table::Cursor cursor(&frames_table);
+  while (!cursor.Done()) {
+    PX_ASSIGN_OR_RETURN(auto rb, cursor.GetNextRowBatch(cols));
+    const auto frame_ids = rb->ColumnAt(0);
+    const auto frames = rb->ColumnAt(1);
+    for (int64_t i = 0; i < rb->num_rows(); ++i) {
+      builder->AddFrame(kFramesSource,
+                        types::GetValueFromArrowArray<types::INT64>(frame_ids.get(), i),
+                        types::GetStringViewFromArrowArray(frames.get(), i));
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+StatusOr<std::string> BuildSelfCPUProfile(table_store::TableStore* table_store, uint32_t asid,
+                                          uint32_t pid, int64_t start_time_ns,
+                                          uint32_t period_ms, bool intern_frames) {
+  const Table* table = table_store->GetTable(std::string(stirling::kStackTraceTable.name()));
+  if (table == nullptr) {
+    return error::NotFound("The profiler's stack traces table '$0' was not found.",
+                           stirling::kStackTraceTable.name());
+  }
+  const Table* frames_table = nullptr;
+  if (intern_frames) {
+    frames_table = table_store->GetTable(std::string(stirling::kStackTraceFramesTable.name()));
+    if (frames_table == nullptr) {
+      return error::NotFound("The profiler's frames table '$0' was not found.",
+                             stirling::kStackTraceFramesTable.name());
+    }
+  }
+
+  shared::PProfBuilder builder;
+  const std::vector<int64_t> cols = {stirling::kStackTraceUPIDIdx,
+                                     stirling::kStackTraceStackTraceStrIdx,
+                                     stirling::kStackTraceCountIdx};
+  Table::Cursor::StartSpec start;
+  start.type = Table::Cursor::StartSpec::StartAtTime;
+  start.start_time = start_time_ns;
+  Table::Cursor cursor(table, start, Table::Cursor::StopSpec{});
+  while (!cursor.Done()) {
+    PX_ASSIGN_OR_RETURN(auto rb, cursor.GetNextRowBatch(cols));
+    const auto upids = rb->ColumnAt(0);
+    const auto stack_traces = rb->ColumnAt(1);
+    const auto counts = rb->ColumnAt(2);
+    for (int64_t i = 0; i < rb->num_rows(); ++i) {
+      const md::UPID upid(
+          types::UInt128Value(types::GetValueFromArrowArray<types::UINT128>(upids.get(), i)).val);
+      if (upid.asid() != asid || upid.pid() != pid) {
+        continue;
+      }
+      const std::string_view stack_trace =
+          types::GetStringViewFromArrowArray(stack_traces.get(), i);
+      const auto count = types::GetValueFromArrowArray<types::INT64>(counts.get(), i);
+      if (intern_frames) {
+        builder.AddInternedStackTrace(kFramesSource, stack_trace, count);
+      } else {
+        builder.AddStackTrace(stack_trace, count);
+      }
+    }
+  }
+  if (intern_frames) {
+    PX_RETURN_IF_ERROR(AddFrames(*frames_table, &builder));
+    builder.ResolveFrames();
+  }
+  return builder.Build(period_ms).SerializeAsString();
+}
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
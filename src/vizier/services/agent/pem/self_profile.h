@@ -0,0 +1,45 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include "src/common/base/base.h"
+#include "src/table_store/table_store.h"
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+/**
+ * Builds a pprof CPU profile of the process with the given ASID and PID out of the stack traces
+ * that the Stirling profiler recorded in the table store since start_time_ns. The profiler
+ * samples every process on the node, including the PEM, so the PEM profiles itself continuously
+ * at no extra cost, with the profiler's symbolizers. intern_frames tells whether the profiler
+ * records frame ids in place of symbols, see --stirling_profiler_intern_frames.
+ *
+ * @return the serialized pprof profile.
+ */
+StatusOr<std::string> BuildSelfCPUProfile(table_store::TableStore* table_store, uint32_t asid,
+                                          uint32_t pid, int64_t start_time_ns,
+                                          uint32_t period_ms, bool intern_frames);
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/pprof/pprof.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/upid/upid.h"
+#include "src/vizier/services/agent/pem/self_profile.h"
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+using table_store::schema::Relation;
+
+constexpr uint32_t kASID = 1;
+constexpr uint32_t kPID = 123;
+constexpr uint32_t kPeriodMS = 11;
+
+class SelfProfileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Relation stack_traces_relation(
+        {types::TIME64NS, types::UINT128, types::INT64, types::STRING, types::INT64},
+        {"time_", "upid", "stack_trace_id", "stack_trace", "count"});
+    stack_traces_ = table_store::Table::Create("stack_traces.beta", stack_traces_relation);
+    table_store_.AddTable("stack_traces.beta", stack_traces_);
+
+    Relation frames_relation({types::TIME64NS, types::INT64, types::STRING},
+                             {"time_", "frame_id", "frame"});
+    frames_ = table_store::Table::Create("stack_trace_frames.beta", frames_relation);
+    table_store_.AddTable("stack_trace_frames.beta", frames_);
+  }
+
+  void WriteStackTraces(std::vector<types::Time64NSValue> times,
+                        std::vector<types::UInt128Value> upids,
+                        std::vector<types::StringValue> stack_traces,
+                        std::vector<types::Int64Value> counts) {
+    const size_t num_rows = times.size();
+    std::vector<types::Int64Value> ids(num_rows, 0);
+    table_store::schema::RowBatch rb(
+        table_store::schema::RowDescriptor(stack_traces_->GetRelation().col_types()), num_rows);
+    auto* pool = arrow::default_memory_pool();
+    EXPECT_OK(rb.AddColumn(types::ToArrow(times, pool)));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(upids, pool)));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(ids, pool)));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(stack_traces, pool)));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(counts, pool)));
+    EXPECT_OK(stack_traces_->WriteRowBatch(rb));
+  }
+
+  void WriteFrames(std::vector<types::Int64Value> frame_ids,
+                   std::vector<types::StringValue> frames) {
+    std::vector<types::Time64NSValue> times(frame_ids.size(), 1);
+    table_store::schema::RowBatch rb(
+        table_store::schema::RowDescriptor(frames_->GetRelation().col_types()), frame_ids.size());
+    auto* pool = arrow::default_memory_pool();
+    EXPECT_OK(rb.AddColumn(types::ToArrow(times, pool)));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(frame_ids, pool)));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(frames, pool)));
+    EXPECT_OK(frames_->WriteRowBatch(rb));
+  }
+
+  shared::PProfHisto ParseProfile(const std::string& profile) {
+    shared::PProfProfile pprof;
+    EXPECT_TRUE(pprof.ParseFromString(profile));
+    return shared::DeserializePProfProfile(pprof);
+  }
+
+  const types::UInt128Value kSelf = md::UPID(kASID, kPID, 1000).value();
+  const types::UInt128Value kOther = md::UPID(kASID, kPID + 1, 1000).value();
+  const types::UInt128Value kOtherPEM = md::UPID(kASID + 1, kPID, 1000).value();
+
+  table_store::TableStore table_store_;
+  std::shared_ptr<table_store::Table> stack_traces_;
+  std::shared_ptr<table_store::Table> frames_;
+};
+
+TEST_F(SelfProfileTest, keeps_own_recent_stack_traces) {
+  WriteStackTraces({10, 20, 20, 20, 30}, {kSelf, kSelf, kOther, kOtherPEM, kSelf},
+                   {"main;old", "main;foo", "main;other", "main;other_pem", "main;foo"},
+                   {5, 2, 3, 4, 1});
+
+  ASSERT_OK_AND_ASSIGN(std::string profile,
+                       BuildSelfCPUProfile(&table_store_, kASID, kPID, /* start_time_ns */ 20,
+                                           kPeriodMS, /* intern_frames */ false));
+  EXPECT_THAT(ParseProfile(profile), UnorderedElementsAre(Pair("main;foo", 3)));
+}
+
+TEST_F(SelfProfileTest, resolves_interned_frames) {
+  WriteStackTraces({10, 20}, {kSelf, kOther}, {"1;2", "1;3"}, {4, 1});
+  WriteFrames({1, 2, 3}, {"main", "foo", "bar"});
+
+  ASSERT_OK_AND_ASSIGN(std::string profile,
+                       BuildSelfCPUProfile(&table_store_, kASID, kPID, /* start_time_ns */ 0,
+                                           kPeriodMS, /* intern_frames */ true));
+  EXPECT_THAT(ParseProfile(profile), UnorderedElementsAre(Pair("main;foo", 4)));
+}
+
+TEST_F(SelfProfileTest, missing_table) {
+  table_store::TableStore empty_table_store;
+  EXPECT_NOT_OK(BuildSelfCPUProfile(&empty_table_store, kASID, kPID, /* start_time_ns */ 0,
+                                    kPeriodMS, /* intern_frames */ false));
+}
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
@@ -18,6 +18,7 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "src/carnot/planner/dynamic_tracing/ir/logicalpb/logical.pb.h"
 #include "src/common/base/base.h"
@@ -217,11 +218,12 @@ Status TracepointManager::UpdateSchema(const stirling::stirlingpb::Publish& publ
 
   // TODO(zasgar): Failure here can lead to an inconsistent schema state. We should
   // figure out how to handle this as part of the data model refactor project.
+  std::vector<RelationInfo> new_relation_infos;
   for (const auto& relation_info : relation_info_vec) {
     if (!relation_info_manager_->HasRelation(relation_info.name)) {
       table_store_->AddTable(table_store::Table::Create(relation_info.name, relation_info.relation),
                              relation_info.name, relation_info.id);
-      PX_RETURN_IF_ERROR(relation_info_manager_->AddRelationInfo(relation_info));
+      new_relation_infos.push_back(relation_info);
     } else {
       if (relation_info.relation != table_store_->GetTable(relation_info.name)->GetRelation()) {
         return error::Internal(
@@ -232,7 +234,8 @@ Status TracepointManager::UpdateSchema(const stirling::stirlingpb::Publish& publ
       PX_RETURN_IF_ERROR(table_store_->AddTableAlias(relation_info.id, relation_info.name));
     }
   }
-  return Status::OK();
+  // Register all of the new output tables at once so they reach the MDS in one schema update.
+  return relation_info_manager_->AddRelationInfos(std::move(new_relation_infos));
 }
 
 }  // namespace agent
@@ -18,45 +18,76 @@
 
 #include "src/vizier/services/agent/shared/manager/chan_cache.h"
 
+#include <algorithm>
+#include <utility>
 #include <vector>
 
 namespace px {
 namespace vizier {
 namespace agent {
 
+namespace {
+
+bool IsFailing(grpc_connectivity_state state) {
+  return state == grpc_connectivity_state::GRPC_CHANNEL_SHUTDOWN ||
+         state == grpc_connectivity_state::GRPC_CHANNEL_TRANSIENT_FAILURE;
+}
+
+}  // namespace
+
 std::shared_ptr<::grpc::Channel> ChanCache::GetChan(std::string_view remote_addr) {
   absl::base_internal::SpinLockHolder lock(&chan_cache_lock_);
   auto it = chan_cache_.find(remote_addr);
   if (it == chan_cache_.end()) {
     return nullptr;
   }
-  return it->second.chan;
+  auto& pool = it->second;
+  for (size_t i = 0; i < pool.chans.size(); ++i) {
+    const auto& chan = pool.chans[pool.next % pool.chans.size()].chan;
+    pool.next = (pool.next + 1) % pool.chans.size();
+    if (!IsFailing(chan->GetState(/*try_to_connect*/ false))) {
+      return chan;
+    }
+  }
+  return nullptr;
 }
 
 void ChanCache::Add(std::string remote_addr, std::shared_ptr<::grpc::Channel> chan) {
   absl::base_internal::SpinLockHolder lock(&chan_cache_lock_);
-  chan_cache_[remote_addr] = {chan, std::chrono::system_clock::now()};
+  auto& pool = chan_cache_[remote_addr];
+  if (pool.chans.size() >= max_chans_per_addr_) {
+    pool.chans.erase(pool.chans.begin());
+  }
+  pool.chans.push_back({std::move(chan), std::chrono::system_clock::now()});
+}
+
+bool ChanCache::NeedsChan(std::string_view remote_addr) {
+  absl::base_internal::SpinLockHolder lock(&chan_cache_lock_);
+  auto it = chan_cache_.find(remote_addr);
+  return it == chan_cache_.end() || it->second.chans.size() < max_chans_per_addr_;
 }
 
 Status ChanCache::CleanupChans() {
   absl::base_internal::SpinLockHolder lock(&chan_cache_lock_);
   std::vector<std::string> remote_addrs_to_delete;
   auto time_now = std::chrono::system_clock::now();
-  for (const auto& [remote_addr, chan] : chan_cache_) {
-    // Get the state of the channel.
-    auto state = chan.chan->GetState(/*try_to_connect*/ false);
-    if (state == grpc_connectivity_state::GRPC_CHANNEL_SHUTDOWN ||
-        state == grpc_connectivity_state::GRPC_CHANNEL_TRANSIENT_FAILURE) {
-      remote_addrs_to_delete.push_back(remote_addr);
-      continue;
-    }
-    std::chrono::nanoseconds age = time_now - chan.start_time;
-    // If the age of the channel is still warming up, we don't kill it for being idle.
-    if (age < warm_up_period_) {
-      continue;
-    }
-
-    if (state == grpc_connectivity_state::GRPC_CHANNEL_IDLE) {
+  for (auto& [remote_addr, pool] : chan_cache_) {
+    auto out_of_use = [&](const Channel& chan) {
+      // Get the state of the channel.
+      auto state = chan.chan->GetState(/*try_to_connect*/ false);
+      if (IsFailing(state)) {
+        return true;
+      }
+      std::chrono::nanoseconds age = time_now - chan.start_time;
+      // If the age of the channel is still warming up, we don't kill it for being idle.
+      if (age < warm_up_period_) {
+        return false;
+      }
+      return state == grpc_connectivity_state::GRPC_CHANNEL_IDLE;
+    };
+    pool.chans.erase(std::remove_if(pool.chans.begin(), pool.chans.end(), out_of_use),
+                     pool.chans.end());
+    if (pool.chans.empty()) {
       remote_addrs_to_delete.push_back(remote_addr);
     }
   }
@@ -20,9 +20,11 @@
 
 #include <grpcpp/grpcpp.h>
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <absl/base/internal/spinlock.h>
 #include <absl/container/flat_hash_map.h>
@@ -32,6 +34,11 @@ namespace px {
 namespace vizier {
 namespace agent {
 
+/**
+ * ChanCache keeps a small pool of channels (grpc conns) to each remote address. Queries to the
+ * same address take turns on the healthy channels of its pool, so concurrent result streams are
+ * spread over several connections and a broken connection doesn't stall every query.
+ */
 class ChanCache {
  public:
   /**
@@ -41,15 +48,21 @@ class ChanCache {
    * channel to be out of use. This is in place to prevent a race where we add a Chan and
    * CleanupChans() is called before the Connection can be used, meaning the channel will come up
    * idle.
+   * @param max_chans_per_addr the size of the channel pool of each remote address.
    */
-  explicit ChanCache(std::chrono::nanoseconds warm_up_period) : warm_up_period_(warm_up_period) {}
+  explicit ChanCache(std::chrono::nanoseconds warm_up_period, size_t max_chans_per_addr = 1)
+      : warm_up_period_(warm_up_period),
+        max_chans_per_addr_(std::max<size_t>(max_chans_per_addr, 1)) {}
   // Template to handle other duration types.
   template <typename T>
-  explicit ChanCache(std::chrono::duration<int64_t, T> warm_up_period)
-      : ChanCache(std::chrono::duration_cast<std::chrono::nanoseconds>(warm_up_period)) {}
+  explicit ChanCache(std::chrono::duration<int64_t, T> warm_up_period,
+                     size_t max_chans_per_addr = 1)
+      : ChanCache(std::chrono::duration_cast<std::chrono::nanoseconds>(warm_up_period),
+                  max_chans_per_addr) {}
   /**
-   * @brief Gets the Chan at remote_addr. If the cache doesn't contain the channel, it returns a
-   * nullptr.
+   * @brief Gets a healthy Chan at remote_addr, taking turns between the channels of its pool.
+   * Channels that are shut down or failing are skipped. If the cache doesn't contain a healthy
+   * channel, it returns a nullptr.
    *
    * @param remote_addr the remote_address to look up.
    * @return std::shared_ptr<::grpc::Channel> the channel or a nullptr if not found.
@@ -57,13 +70,19 @@ class ChanCache {
   std::shared_ptr<::grpc::Channel> GetChan(std::string_view remote_addr);
 
   /**
-   * @brief Caches `chan` for the `remote_addr`.
+   * @brief Adds `chan` to the pool of `remote_addr`. If the pool is full, its oldest channel is
+   * replaced.
    *
    * @param remote_addr the remote address corresponding to the channel.
    * @param chan the channel to cache.
    */
   void Add(std::string remote_addr, std::shared_ptr<::grpc::Channel> chan);
 
+  /**
+   * @brief Whether the pool of `remote_addr` has room for more channels.
+   */
+  bool NeedsChan(std::string_view remote_addr);
+
   /**
    * @brief Goes through the cached channels and verify whether they are still alive and have been
    * used recently. We consider a connection out of use if it is in a failure state or is idle and
@@ -82,11 +101,19 @@ class ChanCache {
     std::chrono::system_clock::time_point start_time;
   };
 
+  struct ChannelPool {
+    // Ordered from oldest to newest.
+    std::vector<Channel> chans;
+    // The index of the channel to hand out next.
+    size_t next = 0;
+  };
+
   // The cache of channels (grpc conns) made to other agents.
-  absl::flat_hash_map<std::string, Channel> chan_cache_ GUARDED_BY(chan_cache_lock_);
+  absl::flat_hash_map<std::string, ChannelPool> chan_cache_ GUARDED_BY(chan_cache_lock_);
   absl::base_internal::SpinLock chan_cache_lock_;
   // Connections that are alive for shorter than warm_up_period_ won't be cleared.
   std::chrono::nanoseconds warm_up_period_;
+  const size_t max_chans_per_addr_;
 };
 }  // namespace agent
 }  // namespace vizier
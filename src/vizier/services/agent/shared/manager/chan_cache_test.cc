@@ -87,6 +87,13 @@ class ChanCacheTest : public ::testing::Test {
     return carnotpb::ResultSinkService::NewStub(channel);
   }
 
+  // Channels with their own connection, like the ones the agent pools.
+  std::shared_ptr<Channel> BuildPooledChannel(const std::string& address) {
+    grpc::ChannelArguments args;
+    args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+    return ::grpc::CreateCustomChannel(address, InsecureChannelCredentials(), args);
+  }
+
   std::unique_ptr<FakeGRPCRouter> service_;
 
   std::unique_ptr<Server> server_;
@@ -136,14 +143,65 @@ TEST_F(ChanCacheTest, gc_on_failing_conn) {
   // State should be failing.
   EXPECT_EQ(channel->GetState(false), grpc_connectivity_state::GRPC_CHANNEL_TRANSIENT_FAILURE);
 
-  // Garbage collector has not run yet, so channel should still be findable.
-  EXPECT_EQ(chan_cache.GetChan(wrong_server_address), channel);
+  // Garbage collector has not run yet, but failing channels aren't handed out.
+  EXPECT_EQ(chan_cache.GetChan(wrong_server_address), nullptr);
+  EXPECT_FALSE(chan_cache.NeedsChan(wrong_server_address));
 
   // Garbage Collector should rm the channel.
   EXPECT_OK(chan_cache.CleanupChans());
   EXPECT_EQ(chan_cache.GetChan(wrong_server_address), nullptr);
 }
 
+TEST_F(ChanCacheTest, pool_takes_turns_between_chans) {
+  ChanCache chan_cache(std::chrono::minutes(5), /* max_chans_per_addr */ 2);
+  EXPECT_TRUE(chan_cache.NeedsChan(GetServerAddress()));
+
+  auto channel0 = BuildPooledChannel(GetServerAddress());
+  chan_cache.Add(GetServerAddress(), channel0);
+  EXPECT_TRUE(chan_cache.NeedsChan(GetServerAddress()));
+  EXPECT_EQ(chan_cache.GetChan(GetServerAddress()), channel0);
+  EXPECT_EQ(chan_cache.GetChan(GetServerAddress()), channel0);
+
+  auto channel1 = BuildPooledChannel(GetServerAddress());
+  chan_cache.Add(GetServerAddress(), channel1);
+  EXPECT_FALSE(chan_cache.NeedsChan(GetServerAddress()));
+  auto first = chan_cache.GetChan(GetServerAddress());
+  auto second = chan_cache.GetChan(GetServerAddress());
+  EXPECT_NE(first, second);
+  EXPECT_EQ(chan_cache.GetChan(GetServerAddress()), first);
+
+  // Adding to a full pool replaces its oldest channel.
+  auto channel2 = BuildPooledChannel(GetServerAddress());
+  chan_cache.Add(GetServerAddress(), channel2);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_NE(chan_cache.GetChan(GetServerAddress()), channel0);
+  }
+}
+
+TEST_F(ChanCacheTest, pool_skips_failing_chans) {
+  ChanCache chan_cache(std::chrono::minutes(5), /* max_chans_per_addr */ 2);
+  auto wrong_server_address = absl::Substitute("$0:$1", hostname, port_ + 1);
+
+  // Both channels are to the wrong address, but only the first one has tried to connect.
+  auto failing_channel = BuildPooledChannel(wrong_server_address);
+  auto idle_channel = BuildPooledChannel(wrong_server_address);
+  chan_cache.Add(wrong_server_address, failing_channel);
+  chan_cache.Add(wrong_server_address, idle_channel);
+
+  auto stub = BuildStub(failing_channel);
+  RunRPC(stub.get());
+  ASSERT_EQ(failing_channel->GetState(false),
+            grpc_connectivity_state::GRPC_CHANNEL_TRANSIENT_FAILURE);
+
+  EXPECT_EQ(chan_cache.GetChan(wrong_server_address), idle_channel);
+  EXPECT_EQ(chan_cache.GetChan(wrong_server_address), idle_channel);
+
+  // Only the failing channel is removed, which leaves room for a new one.
+  EXPECT_OK(chan_cache.CleanupChans());
+  EXPECT_TRUE(chan_cache.NeedsChan(wrong_server_address));
+  EXPECT_EQ(chan_cache.GetChan(wrong_server_address), idle_channel);
+}
+
 TEST_F(ChanCacheTest, channel_idleness_triggers_gc) {
   ChanCache chan_cache(std::chrono::milliseconds(500));
   EXPECT_EQ(chan_cache.GetChan(GetServerAddress()), nullptr);
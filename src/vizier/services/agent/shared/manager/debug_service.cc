@@ -0,0 +1,109 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "src/vizier/services/agent/shared/manager/debug_service.h"
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <string>
+#include <thread>
+
+#include <absl/strings/substitute.h>
+
+#include "src/common/base/file.h"
+#include "src/common/perf/perf.h"
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+namespace {
+
+::grpc::Status ToGRPCStatus(const Status& s) {
+  if (s.ok()) {
+    return ::grpc::Status::OK;
+  }
+  ::grpc::StatusCode code = ::grpc::StatusCode::INTERNAL;
+  if (error::IsInvalidArgument(s)) {
+    code = ::grpc::StatusCode::INVALID_ARGUMENT;
+  } else if (error::IsNotFound(s)) {
+    code = ::grpc::StatusCode::NOT_FOUND;
+  } else if (error::IsUnimplemented(s)) {
+    code = ::grpc::StatusCode::UNIMPLEMENTED;
+  } else if (error::IsResourceUnavailable(s)) {
+    code = ::grpc::StatusCode::UNAVAILABLE;
+  }
+  return ::grpc::Status(code, s.msg());
+}
+
+}  // namespace
+
+::grpc::Status AgentDebugServer::GetCPUProfile(::grpc::ServerContext*,
+                                               const services::agent::CPUProfileRequest* req,
+                                               services::agent::ProfileResponse* resp) {
+  std::chrono::seconds duration(req->duration_s());
+  if (duration.count() == 0) {
+    duration = kDefaultCPUProfileDuration;
+  }
+  if (duration.count() < 0 || duration > kMaxCPUProfileDuration) {
+    return ToGRPCStatus(error::InvalidArgument("CPU profile duration must be in (0, $0] seconds.",
+                                               kMaxCPUProfileDuration.count()));
+  }
+  if (cpu_profile_running_.exchange(true)) {
+    return ToGRPCStatus(error::ResourceUnavailable("A CPU profile is already being taken."));
+  }
+  auto profile_or_s = cpu_profile_func_(duration);
+  cpu_profile_running_ = false;
+  if (!profile_or_s.ok()) {
+    return ToGRPCStatus(profile_or_s.status());
+  }
+  resp->set_profile(profile_or_s.ConsumeValueOrDie());
+  return ::grpc::Status::OK;
+}
+
+::grpc::Status AgentDebugServer::GetHeapProfile(::grpc::ServerContext*,
+                                                const services::agent::HeapProfileRequest*,
+                                                services::agent::ProfileResponse* resp) {
+  if (!profiler::Heap::GetHeapSample(resp->mutable_profile())) {
+    return ToGRPCStatus(
+        error::Unimplemented("Heap profiles are not available in this build of the agent."));
+  }
+  return ::grpc::Status::OK;
+}
+
+StatusOr<std::string> AgentDebugServer::ProfileCPUFor(std::chrono::seconds duration) {
+  if (!profiler::CPU::ProfilerAvailable()) {
+    return error::Unimplemented("CPU profiles are not available in this build of the agent.");
+  }
+  std::filesystem::path path = std::filesystem::temp_directory_path() /
+                               absl::Substitute("agent_cpu_profile_$0.prof", getpid());
+  if (!profiler::CPU::StartProfiler(path.string())) {
+    return error::Internal("Failed to start the CPU profiler.");
+  }
+  std::this_thread::sleep_for(duration);
+  profiler::CPU::StopProfiler();
+
+  auto profile_or_s = ReadFileToString(path.string(), std::ios_base::in | std::ios_base::binary);
+  std::error_code ec;
+  std::filesystem::remove(path, ec);
+  return profile_or_s;
+}
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
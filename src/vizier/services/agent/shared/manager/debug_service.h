@@ -0,0 +1,72 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <utility>
+
+#include "src/common/base/base.h"
+#include "src/vizier/services/agent/shared/debugpb/debug.grpc.pb.h"
+#include "src/vizier/services/agent/shared/debugpb/debug.pb.h"
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+/**
+ * Serves CPU and heap profiles of the agent over gRPC, so that a running agent can be profiled
+ * without redeploying it.
+ */
+class AgentDebugServer final : public services::agent::AgentDebugService::Service {
+ public:
+  // Returns a CPU profile that pprof can read, covering the given duration.
+  using CPUProfileFunc = std::function<StatusOr<std::string>(std::chrono::seconds)>;
+
+  static constexpr std::chrono::seconds kDefaultCPUProfileDuration{30};
+  static constexpr std::chrono::seconds kMaxCPUProfileDuration{300};
+
+  explicit AgentDebugServer(CPUProfileFunc cpu_profile_func)
+      : cpu_profile_func_(std::move(cpu_profile_func)) {}
+
+  ::grpc::Status GetCPUProfile(::grpc::ServerContext* context,
+                               const services::agent::CPUProfileRequest* req,
+                               services::agent::ProfileResponse* resp) override;
+
+  ::grpc::Status GetHeapProfile(::grpc::ServerContext* context,
+                                const services::agent::HeapProfileRequest* req,
+                                services::agent::ProfileResponse* resp) override;
+
+  /**
+   * Profiles this process with gperftools for the given duration. This is the CPU profile of
+   * agents that don't profile themselves continuously. Note that gperftools can make BCC kprobe
+   * attachment fail while it runs, see src/common/perf/README.md.
+   */
+  static StatusOr<std::string> ProfileCPUFor(std::chrono::seconds duration);
+
+ private:
+  CPUProfileFunc cpu_profile_func_;
+  // Only one CPU profile is taken at a time, since the profilers are process wide.
+  std::atomic<bool> cpu_profile_running_ = false;
+};
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
@@ -85,10 +85,12 @@ ExecuteQueryMessageHandler::ExecuteQueryMessageHandler(px::event::Dispatcher* di
                                  .Name("num_queries_in_flight")
                                  .Help("The number of queries currently running.")
                                  .Register(GetMetricsRegistry())
-                                 .Add({})) {}
+                                 .Add({})),
+      scheduler_(QueryScheduler::DefaultConfig()) {}
 
 Status ExecuteQueryMessageHandler::HandleMessage(std::unique_ptr<messages::VizierMessage> msg) {
-  // Create a task and run it on the threadpool.
+  // Create a task and run it on the threadpool once the scheduler admits it.
+  auto query_class = ClassifyQuery(msg->execute_query_request().plan());
   auto task = std::make_unique<ExecuteQueryTask>(this, carnot_, std::move(msg));
 
   auto query_id = task->query_id();
@@ -96,8 +98,9 @@ Status ExecuteQueryMessageHandler::HandleMessage(std::unique_ptr<messages::Vizie
   auto runnable_ptr = runnable.get();
   LOG(INFO) << "Queries in flight: " << running_queries_.size();
   num_queries_in_flight_.Set(running_queries_.size());
-  running_queries_[query_id] = std::move(runnable);
-  runnable_ptr->Run();
+  running_queries_[query_id] = {std::move(runnable), query_class};
+  // The task is only deleted after it completes, so it outlives the wait in the queue.
+  scheduler_.Submit(query_class, [runnable_ptr]() { runnable_ptr->Run(); });
 
   return Status::OK();
 }
@@ -109,7 +112,8 @@ void ExecuteQueryMessageHandler::HandleQueryExecutionComplete(sole::uuid query_i
     LOG(ERROR) << "Attempting to delete non-existent query: " << query_id.str();
     return;
   }
-  dispatcher()->DeferredDelete(std::move(node.mapped()));
+  scheduler_.Finish(node.mapped().query_class);
+  dispatcher()->DeferredDelete(std::move(node.mapped().task));
 }
 
 }  // namespace agent
@@ -24,6 +24,7 @@
 #include <prometheus/registry.h>
 #include "src/carnot/plan/plan.h"
 #include "src/vizier/services/agent/shared/manager/manager.h"
+#include "src/vizier/services/agent/shared/manager/query_scheduler.h"
 
 namespace px {
 namespace vizier {
@@ -35,6 +36,8 @@ namespace agent {
  * otherwise only query execution is performed.
  *
  * This class runs all of it's work on a thread pool and tracks pending queries internally.
+ * When the query is started is decided by a QueryScheduler, which gives priority to the
+ * interactive queries.
  */
 class ExecuteQueryMessageHandler : public Manager::MessageHandler {
  public:
@@ -45,6 +48,14 @@ class ExecuteQueryMessageHandler : public Manager::MessageHandler {
 
   Status HandleMessage(std::unique_ptr<messages::VizierMessage> msg) override;
 
+  /**
+   * Under memory pressure, the export queries, which are the heavy periodic ones, wait until the
+   * pressure is gone. Interactive queries still run.
+   */
+  void SetMemoryPressure(bool under_pressure) {
+    scheduler_.SetPaused(QueryClass::kExport, under_pressure);
+  }
+
  protected:
   /**
    * HandleQueryExecutionComplete can be called by the async task to signal that work has been
@@ -56,9 +67,15 @@ class ExecuteQueryMessageHandler : public Manager::MessageHandler {
   // Forward declare private task class.
   class ExecuteQueryTask;
 
+  struct RunningQuery {
+    px::event::RunnableAsyncTaskUPtr task;
+    QueryClass query_class;
+  };
+
   carnot::Carnot* carnot_;
-  // Map from query_id -> Running query task.
-  absl::flat_hash_map<sole::uuid, px::event::RunnableAsyncTaskUPtr> running_queries_;
+  // Map from query_id -> Running or queued query task.
+  absl::flat_hash_map<sole::uuid, RunningQuery> running_queries_;
+  QueryScheduler scheduler_;
 
   prometheus::Gauge& num_queries_in_flight_;
 };
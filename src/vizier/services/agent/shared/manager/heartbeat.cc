@@ -18,7 +18,10 @@
 
 #include "src/vizier/services/agent/shared/manager/heartbeat.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -53,6 +56,7 @@ HeartbeatMessageHandler::HeartbeatMessageHandler(Dispatcher* d,
 void HeartbeatMessageHandler::DisableHeartbeats() {
   last_metadata_epoch_id_ = 0;
   sent_schema_ = false;
+  heartbeats_until_full_state_ = 0;
   heartbeat_send_timer_->DisableTimer();
   heartbeat_watchdog_timer_->DisableTimer();
 }
@@ -99,16 +103,26 @@ Status HeartbeatMessageHandler::SendHeartbeatInternal() {
 
   auto* update_info = hb->mutable_update_info();
 
+  // Heartbeats only hold what changed since the previous one, which the metadata service receives
+  // in order of sequence number. The full state is periodically sent again.
+  bool full_state = heartbeats_until_full_state_ == 0;
+  heartbeats_until_full_state_ = full_state ? kHeartbeatsBetweenFullStates - 1
+                                            : heartbeats_until_full_state_ - 1;
+
   ConsumeAgentPIDUpdates(update_info);
   if (agent_info()->capabilities.collects_data() &&
-      (!sent_schema_ || relation_info_manager_->has_updates())) {
+      (full_state || !sent_schema_ || relation_info_manager_->has_updates())) {
     sent_schema_ = true;
     relation_info_manager_->AddSchemaToUpdateInfo(update_info);
   }
+  if (agent_info()->capabilities.collects_data()) {
+    relation_info_manager_->AddTableStatsToUpdateInfo(update_info);
+    FilterTableStats(full_state, update_info);
+  }
 
   // We skip sending the metadata update when there have been no changes.
   auto current_epoch = mds_manager_->metadata_filter()->epoch_id();
-  if (last_metadata_epoch_id_ == 0 || last_metadata_epoch_id_ != current_epoch) {
+  if (full_state || last_metadata_epoch_id_ == 0 || last_metadata_epoch_id_ != current_epoch) {
     auto metadata_filter = update_info->mutable_data()->mutable_metadata_info();
     *metadata_filter = mds_manager_->metadata_filter()->ToProto();
     last_metadata_epoch_id_ = current_epoch;
@@ -120,6 +134,39 @@ Status HeartbeatMessageHandler::SendHeartbeatInternal() {
   return nats_conn()->Publish(req);
 }
 
+namespace {
+
+bool ChangedSignificantly(int64_t prev, int64_t next, double threshold) {
+  return std::abs(next - prev) > threshold * std::max<int64_t>(std::abs(prev), 1);
+}
+
+}  // namespace
+
+void HeartbeatMessageHandler::FilterTableStats(bool full_state,
+                                               messages::AgentUpdateInfo* update_info) {
+  auto* table_stats = update_info->mutable_table_stats();
+  if (full_state) {
+    update_info->set_full_table_stats(true);
+    sent_table_stats_.clear();
+  }
+
+  std::vector<std::string> unchanged_tables;
+  for (const auto& [name, stats] : *table_stats) {
+    auto it = sent_table_stats_.find(name);
+    if (it != sent_table_stats_.end() &&
+        !ChangedSignificantly(it->second.num_rows(), stats.num_rows(),
+                              kTableStatsChangeThreshold) &&
+        !ChangedSignificantly(it->second.bytes(), stats.bytes(), kTableStatsChangeThreshold)) {
+      unchanged_tables.push_back(name);
+      continue;
+    }
+    sent_table_stats_[name] = stats;
+  }
+  for (const auto& name : unchanged_tables) {
+    table_stats->erase(name);
+  }
+}
+
 void HeartbeatMessageHandler::HeartbeatWatchdog() {
   if (heartbeat_info_.last_ackd_seq_num < heartbeat_info_.last_sent_seq_num) {
     auto diff = time_source_.MonotonicTime() - heartbeat_info_.last_heartbeat_send_time_;
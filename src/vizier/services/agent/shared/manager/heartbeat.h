@@ -19,6 +19,9 @@
 #pragma once
 
 #include <memory>
+#include <string>
+
+#include <absl/container/flat_hash_map.h>
 
 #include "src/vizier/services/agent/shared/manager/manager.h"
 
@@ -48,6 +51,10 @@ class HeartbeatMessageHandler : public Manager::MessageHandler {
   void ProcessPIDTerminatedEvent(const px::md::PIDTerminatedEvent& ev,
                                  messages::AgentUpdateInfo* update_info);
 
+  // Removes the table stats that changed little since they were last sent, unless the heartbeat
+  // sends the full state.
+  void FilterTableStats(bool full_state, messages::AgentUpdateInfo* update_info);
+
   void DoHeartbeats();
 
   void SendHeartbeat();
@@ -64,6 +71,11 @@ class HeartbeatMessageHandler : public Manager::MessageHandler {
   std::unique_ptr<px::vizier::messages::VizierMessage> last_sent_hb_;
   int64_t last_metadata_epoch_id_ = 0;
   bool sent_schema_ = false;
+  // The full state is sent when this is 0.
+  int64_t heartbeats_until_full_state_ = 0;
+  // The table stats as of the last heartbeat that included them, by table name.
+  absl::flat_hash_map<std::string, carnot::planner::distributedpb::TableStatsInfo>
+      sent_table_stats_;
 
   HeartbeatInfo heartbeat_info_;
   const px::event::TimeSource& time_source_;
@@ -78,6 +90,11 @@ class HeartbeatMessageHandler : public Manager::MessageHandler {
 
   static constexpr std::chrono::seconds kAgentHeartbeatInterval{5};
   static constexpr int kHeartbeatRetryCount = 5;
+  // Heartbeats only hold what changed since the previous heartbeat, except for one in this many
+  // which holds the full state of the agent.
+  static constexpr int64_t kHeartbeatsBetweenFullStates = 60;
+  // The relative change in a table's size estimates for which they are sent again.
+  static constexpr double kTableStatsChangeThreshold = 0.1;
   // The amount of time to wait for a heartbeat ack.
   static constexpr std::chrono::milliseconds kHeartbeatWaitMillis{5000};
 };
@@ -28,6 +28,8 @@
 #include "src/common/testing/event/simulated_time_system.h"
 #include "src/common/testing/testing.h"
 #include "src/shared/metadatapb/metadata.pb.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table_store.h"
 #include "src/vizier/messages/messagespb/messages.pb.h"
 #include "src/vizier/services/agent/shared/manager/heartbeat.h"
 #include "src/vizier/services/agent/shared/manager/manager.h"
@@ -119,8 +121,12 @@ class HeartbeatMessageHandlerTest : public ::testing::Test {
     Relation relation1({types::TIME64NS, types::FLOAT64}, {"time_", "gauge"});
     RelationInfo relation_info1("relation1", /* id */ 1, "desc1", relation1);
     std::vector<RelationInfo> relation_info_vec({relation_info0, relation_info1});
+    // Only relation0 has a table, so only it has table stats.
+    table_store_ = std::make_unique<table_store::TableStore>();
+    table0_ = table_store::Table::Create("relation0", relation0);
+    table_store_->AddTable("relation0", table0_);
     // Pass relation info to the manager.
-    relation_info_manager_ = std::make_unique<RelationInfoManager>();
+    relation_info_manager_ = std::make_unique<RelationInfoManager>(table_store_.get());
     for (const auto& relation_info : relation_info_vec) {
       EXPECT_OK(relation_info_manager_->AddRelationInfo(relation_info));
     }
@@ -145,9 +151,31 @@ class HeartbeatMessageHandlerTest : public ::testing::Test {
     }
   }
 
+  void WriteRows(const std::vector<types::Int64Value>& counts) {
+    std::vector<types::Time64NSValue> times(counts.size(), 1);
+    table_store::schema::RowBatch rb(
+        table_store::schema::RowDescriptor({types::TIME64NS, types::INT64}), counts.size());
+    EXPECT_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(counts, arrow::default_memory_pool())));
+    EXPECT_OK(table0_->WriteRowBatch(rb));
+  }
+
+  // Acks the heartbeat with the given sequence number and returns the next heartbeat.
+  messages::Heartbeat AckAndSendHeartbeat(int64_t seq_num) {
+    auto hb_ack = std::make_unique<messages::VizierMessage>();
+    hb_ack->mutable_heartbeat_ack()->set_sequence_number(seq_num);
+    EXPECT_OK(heartbeat_handler_->HandleMessage(std::move(hb_ack)));
+
+    time_system_->Sleep(std::chrono::milliseconds(5000 + 1));
+    dispatcher_->Run(event::Dispatcher::RunType::NonBlock);
+    return nats_conn_->published_msgs().back().heartbeat();
+  }
+
   std::unique_ptr<event::SimulatedTimeSystem> time_system_;
   std::unique_ptr<event::APIImpl> api_;
   std::unique_ptr<event::Dispatcher> dispatcher_;
+  std::unique_ptr<table_store::TableStore> table_store_;
+  std::shared_ptr<table_store::Table> table0_;
   std::unique_ptr<FakeAgentMetadataStateManager> mds_manager_;
   std::unique_ptr<RelationInfoManager> relation_info_manager_;
   std::unique_ptr<HeartbeatMessageHandler> heartbeat_handler_;
@@ -312,6 +340,41 @@ TEST_F(HeartbeatMessageHandlerTest, HandleHeartbeatRelationUpdates) {
   EXPECT_EQ(3, hb.update_info().schema().size());
 }
 
+TEST_F(HeartbeatMessageHandlerTest, HandleHeartbeatTableStatsDelta) {
+  WriteRows({1, 2, 3});
+  dispatcher_->Run(event::Dispatcher::RunType::NonBlock);
+  ASSERT_EQ(1, nats_conn_->published_msgs().size());
+  auto hb = nats_conn_->published_msgs()[0].heartbeat();
+  EXPECT_TRUE(hb.update_info().full_table_stats());
+  ASSERT_EQ(1, hb.update_info().table_stats_size());
+  EXPECT_EQ(3, hb.update_info().table_stats().at("relation0").num_rows());
+
+  // Stats that didn't change are left out.
+  hb = AckAndSendHeartbeat(hb.sequence_number());
+  EXPECT_EQ(1, hb.sequence_number());
+  EXPECT_FALSE(hb.update_info().full_table_stats());
+  EXPECT_EQ(0, hb.update_info().table_stats_size());
+  EXPECT_EQ(0, hb.update_info().schema_size());
+
+  WriteRows({4, 5, 6});
+  hb = AckAndSendHeartbeat(hb.sequence_number());
+  ASSERT_EQ(1, hb.update_info().table_stats_size());
+  EXPECT_EQ(6, hb.update_info().table_stats().at("relation0").num_rows());
+
+  // The full state is periodically resent, even without changes.
+  for (int i = 0; i < 57; ++i) {
+    hb = AckAndSendHeartbeat(hb.sequence_number());
+    EXPECT_FALSE(hb.update_info().full_table_stats());
+    EXPECT_EQ(0, hb.update_info().table_stats_size());
+  }
+  hb = AckAndSendHeartbeat(hb.sequence_number());
+  EXPECT_EQ(60, hb.sequence_number());
+  EXPECT_TRUE(hb.update_info().full_table_stats());
+  EXPECT_EQ(1, hb.update_info().table_stats_size());
+  EXPECT_EQ(2, hb.update_info().schema_size());
+  CheckFilterElements(hb.update_info().data(), {"pl/service"}, {"pl/another_service"});
+}
+
 class HeartbeatNackMessageHandlerTest : public ::testing::Test {
  protected:
   void TearDown() override { dispatcher_->Exit(); }
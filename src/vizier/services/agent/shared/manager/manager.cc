@@ -37,6 +37,7 @@
 #include "src/vizier/funcs/funcs.h"
 #include "src/vizier/services/agent/shared/manager/chan_cache.h"
 #include "src/vizier/services/agent/shared/manager/config_manager.h"
+#include "src/vizier/services/agent/shared/manager/debug_service.h"
 #include "src/vizier/services/agent/shared/manager/exec.h"
 #include "src/vizier/services/agent/shared/manager/heartbeat.h"
 #include "src/vizier/services/agent/shared/manager/k8s_update.h"
@@ -60,6 +61,13 @@ px::StatusOr<std::string> GetHostname() {
 DEFINE_string(jwt_signing_key, gflags::StringFromEnv("PL_JWT_SIGNING_KEY", ""),
               "The JWT signing key for outgoing requests");
 
+DEFINE_uint32(result_sink_channels_per_addr,
+              gflags::Uint32FromEnv("PL_RESULT_SINK_CHANNELS_PER_ADDR", 2),
+              "The number of gRPC channels kept to each agent that query results are sent to.");
+
+DEFINE_bool(agent_debug_service, gflags::BoolFromEnv("PL_AGENT_DEBUG_SERVICE", true),
+            "Whether to serve CPU and heap profiles of the agent on its gRPC port.");
+
 DEFINE_string(vizier_id, gflags::StringFromEnv("PL_VIZIER_ID", ""), "The ID of the cluster.");
 
 DEFINE_string(vizier_name, gflags::StringFromEnv("PL_VIZIER_NAME", ""),
@@ -105,7 +113,7 @@ Manager::Manager(sole::uuid agent_id, std::string_view pod_name, std::string_vie
       dispatcher_(api_->AllocateDispatcher("manager")),
       nats_addr_(nats_url),
       table_store_(std::make_shared<table_store::TableStore>()),
-      relation_info_manager_(std::make_unique<RelationInfoManager>()),
+      relation_info_manager_(std::make_unique<RelationInfoManager>(table_store_.get())),
       mds_channel_(grpc::CreateChannel(std::string(mds_url), grpc_channel_creds_)),
       func_context_(this, CreateMDSStub(mds_channel_), CreateMDTPStub(mds_channel_),
                     CreateCronScriptStub(mds_channel_), table_store_,
@@ -124,6 +132,11 @@ Manager::Manager(sole::uuid agent_id, std::string_view pod_name, std::string_vie
   auto server_config = std::make_unique<px::carnot::Carnot::ServerConfig>();
   server_config->grpc_server_creds = SSL::DefaultGRPCServerCreds();
   server_config->grpc_server_port = grpc_server_port;
+  if (FLAGS_agent_debug_service) {
+    // CPUProfile() is virtual, but is only called once the server runs, after construction.
+    server_config->services.push_back(std::make_shared<AgentDebugServer>(
+        [this](std::chrono::seconds duration) { return CPUProfile(duration); }));
+  }
 
   carnot_ = px::carnot::Carnot::Create(agent_id, std::move(func_registry), table_store_,
                                        std::move(clients_config), std::move(server_config))
@@ -142,7 +155,8 @@ Status Manager::Init() {
       agent_metadata_filter_,
       md::AgentMetadataFilter::Create(kMetadataFilterMaxEntries, kMetadataFilterMaxErrorRate,
                                       md::kMetadataFilterEntities));
-  chan_cache_ = std::make_unique<ChanCache>(kChanIdleGracePeriod);
+  chan_cache_ =
+      std::make_unique<ChanCache>(kChanIdleGracePeriod, FLAGS_result_sink_channels_per_addr);
   auto hostname_or_s = GetHostname();
   if (!hostname_or_s.ok()) {
     return hostname_or_s.status();
@@ -195,6 +209,7 @@ Status Manager::Stop(std::chrono::milliseconds timeout) {
   stop_called_ = true;
 
   dispatcher_->Stop();
+  table_store()->StopCompactionScheduler();
   auto s = StopImpl(timeout);
 
   // Wait for a limited amount of time for main thread to stop processing.
@@ -325,17 +340,9 @@ Status Manager::PostRegisterHook(uint32_t asid) {
 
   PX_RETURN_IF_ERROR(metrics_nats_connector_->Connect(dispatcher_.get()));
 
-  tablestore_compaction_timer_ = dispatcher()->CreateTimer([this]() {
-    // TODO(james): when we change ExecState::exec_mem_pool to not return just the default pool, we
-    // will need to figure out how to use the correct memory pool here, but for now we can just use
-    // the default pool.
-    auto status = table_store()->RunCompaction(arrow::default_memory_pool());
-    LOG_IF(ERROR, !status.ok()) << status.msg();
-    if (tablestore_compaction_timer_) {
-      tablestore_compaction_timer_->EnableTimer(kTableStoreCompactionPeriod);
-    }
-  });
-  tablestore_compaction_timer_->EnableTimer(kTableStoreCompactionPeriod);
+  // ExecState::exec_mem_pool is a per query pool, and compaction is not part of any query, so the
+  // table store compacts with the default pool.
+  table_store()->StartCompactionScheduler(kTableStoreCompactionPeriod);
 
   memory_metrics_timer_ = dispatcher()->CreateTimer([this]() {
     memory_metrics_.MeasureMemory();
@@ -353,6 +360,7 @@ Status Manager::PostRegisterHook(uint32_t asid) {
     }
     auto& registry = GetMetricsRegistry();
     auto metrics = registry.Collect();
+    CollectPerfProbeMetrics(&metrics);
     int64_t timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
                                std::chrono::system_clock::now().time_since_epoch())
                                .count();
@@ -396,7 +404,9 @@ Status Manager::PostReregisterHook(uint32_t asid) {
 std::unique_ptr<Manager::ResultSinkStub> Manager::ResultSinkStubGenerator(
     const std::string& remote_addr, const std::string& ssl_targetname) {
   auto chan = chan_cache_->GetChan(remote_addr);
-  if (chan != nullptr) {
+  // Fill up the pool of the address one channel at a time, and only wait for a new channel when
+  // the pool has no healthy one to use meanwhile.
+  if (chan != nullptr && !chan_cache_->NeedsChan(remote_addr)) {
     return px::carnotpb::ResultSinkService::NewStub(chan);
   }
 
@@ -410,10 +420,15 @@ std::unique_ptr<Manager::ResultSinkStub> Manager::ResultSinkStubGenerator(
   args.SetInt(GRPC_ARG_HTTP2_BDP_PROBE, 1);
   args.SetInt(GRPC_ARG_HTTP2_MIN_RECV_PING_INTERVAL_WITHOUT_DATA_MS, 50000);
   args.SetInt(GRPC_ARG_HTTP2_MIN_SENT_PING_INTERVAL_WITHOUT_DATA_MS, 100000);
-
-  chan = grpc::CreateCustomChannel(remote_addr, grpc_channel_creds_, args);
-  chan_cache_->Add(remote_addr, chan);
-  return px::carnotpb::ResultSinkService::NewStub(chan);
+  // Channels with the same arguments share their connection through the global subchannel pool,
+  // which would make every channel of the pool use the same connection.
+  args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+
+  auto new_chan = grpc::CreateCustomChannel(remote_addr, grpc_channel_creds_, args);
+  // Start connecting right away, so that the channel is warm by the time it is used.
+  new_chan->GetState(/*try_to_connect*/ true);
+  chan_cache_->Add(remote_addr, new_chan);
+  return px::carnotpb::ResultSinkService::NewStub(chan != nullptr ? chan : new_chan);
 }
 
 Manager::MessageHandler::MessageHandler(Dispatcher* dispatcher, Info* agent_info,
@@ -38,6 +38,7 @@
 #include "src/vizier/services/agent/shared/base/base_manager.h"
 #include "src/vizier/services/agent/shared/base/info.h"
 #include "src/vizier/services/agent/shared/manager/chan_cache.h"
+#include "src/vizier/services/agent/shared/manager/debug_service.h"
 #include "src/vizier/services/agent/shared/manager/relation_info_manager.h"
 
 #include "src/vizier/services/metadata/metadatapb/service.grpc.pb.h"
@@ -148,6 +149,14 @@ class Manager : public BaseManager {
   // Kelvin and PEMs use different selectors to request k8s updates.
   virtual std::string k8s_update_selector() const = 0;
 
+  /**
+   * Returns a CPU profile of this agent covering the given duration, for the debug service.
+   * By default the agent profiles itself with gperftools for the duration.
+   */
+  virtual StatusOr<std::string> CPUProfile(std::chrono::seconds duration) {
+    return AgentDebugServer::ProfileCPUFor(duration);
+  }
+
  private:
   std::unique_ptr<ResultSinkStub> ResultSinkStubGenerator(const std::string& remote_addr,
                                                           const std::string& ssl_targetname);
@@ -211,9 +220,6 @@ class Manager : public BaseManager {
   // Factory context for vizier functions.
   funcs::VizierFuncFactoryContext func_context_;
 
-  // Timer to manage table store compaction.
-  px::event::TimerUPtr tablestore_compaction_timer_;
-
   px::metrics::MemoryMetrics memory_metrics_;
   // Timer to collect MemoryMetrics for this agent.
   px::event::TimerUPtr memory_metrics_timer_;
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/vizier/services/agent/shared/manager/query_scheduler.h"
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "src/common/metrics/metrics.h"
+
+// The libuv thread pool that runs the queries has 4 threads by default, a query that is admitted
+// beyond that would only wait in the thread pool's queue, where it can't be prioritized.
+DEFINE_uint32(query_max_running, gflags::Uint32FromEnv("PL_QUERY_MAX_RUNNING", 4),
+              "The maximum number of queries that an agent runs at the same time.");
+DEFINE_uint32(query_max_running_export, gflags::Uint32FromEnv("PL_QUERY_MAX_RUNNING_EXPORT", 2),
+              "The maximum number of export queries that an agent runs at the same time.");
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+namespace {
+
+constexpr std::array<std::string_view, kNumQueryClasses> kQueryClassNames = {"interactive",
+                                                                              "export"};
+
+}  // namespace
+
+QueryClass ClassifyQuery(const carnot::planpb::Plan& plan) {
+  for (const auto& fragment : plan.nodes()) {
+    for (const auto& node : fragment.nodes()) {
+      if (node.op().op_type() == carnot::planpb::OTEL_EXPORT_SINK_OPERATOR ||
+          node.op().op_type() == carnot::planpb::FILE_EXPORT_SINK_OPERATOR) {
+        return QueryClass::kExport;
+      }
+    }
+  }
+  return QueryClass::kInteractive;
+}
+
+QueryScheduler::Config QueryScheduler::DefaultConfig() {
+  Config config;
+  config.max_running = FLAGS_query_max_running;
+  config.classes[static_cast<size_t>(QueryClass::kInteractive)] = {FLAGS_query_max_running, 4};
+  config.classes[static_cast<size_t>(QueryClass::kExport)] = {FLAGS_query_max_running_export, 1};
+  return config;
+}
+
+QueryScheduler::QueryScheduler(const Config& config) : max_running_(config.max_running) {
+  auto& running_family = prometheus::BuildGauge()
+                             .Name("query_scheduler_running")
+                             .Help("The number of running queries, by query class.")
+                             .Register(GetMetricsRegistry());
+  auto& queued_family = prometheus::BuildGauge()
+                            .Name("query_scheduler_queued")
+                            .Help("The number of queries waiting to run, by query class.")
+                            .Register(GetMetricsRegistry());
+  auto& wait_family = BuildCounterFamily("query_scheduler_wait_seconds",
+                                         "Total time that queries waited to run, by query class.");
+  for (size_t i = 0; i < kNumQueryClasses; ++i) {
+    const std::map<std::string, std::string> labels = {{"class", std::string(kQueryClassNames[i])}};
+    classes_[i].config = config.classes[i];
+    classes_[i].running_gauge = &running_family.Add(labels);
+    classes_[i].queued_gauge = &queued_family.Add(labels);
+    classes_[i].wait_seconds_counter = &wait_family.Add(labels);
+  }
+}
+
+bool QueryScheduler::CanStart(const ClassState& cls) const {
+  return !cls.paused && num_running_ < max_running_ && cls.num_running < cls.config.max_running;
+}
+
+void QueryScheduler::Start(ClassState* cls, std::function<void()> start_fn) {
+  ++num_running_;
+  ++cls->num_running;
+  cls->running_gauge->Set(cls->num_running);
+  start_fn();
+}
+
+void QueryScheduler::Submit(QueryClass query_class, std::function<void()> start_fn) {
+  ClassState* cls = &classes_[static_cast<size_t>(query_class)];
+  // Queries of a class start in the order they were submitted.
+  if (cls->queue.empty() && CanStart(*cls)) {
+    Start(cls, std::move(start_fn));
+    return;
+  }
+  cls->queue.push_back({std::move(start_fn), std::chrono::steady_clock::now()});
+  cls->queued_gauge->Set(cls->queue.size());
+}
+
+QueryScheduler::ClassState* QueryScheduler::NextClassToStart() {
+  ClassState* next = nullptr;
+  for (auto& cls : classes_) {
+    if (cls.queue.empty() || !CanStart(cls)) {
+      continue;
+    }
+    // Picks the class with the smallest num_running / weight, compared without dividing.
+    if (next == nullptr ||
+        cls.num_running * next->config.weight < next->num_running * cls.config.weight) {
+      next = &cls;
+    }
+  }
+  return next;
+}
+
+void QueryScheduler::Finish(QueryClass query_class) {
+  ClassState* cls = &classes_[static_cast<size_t>(query_class)];
+  DCHECK_GT(cls->num_running, 0U);
+  --num_running_;
+  --cls->num_running;
+  cls->running_gauge->Set(cls->num_running);
+  StartQueued();
+}
+
+void QueryScheduler::SetPaused(QueryClass query_class, bool paused) {
+  classes_[static_cast<size_t>(query_class)].paused = paused;
+  if (!paused) {
+    StartQueued();
+  }
+}
+
+void QueryScheduler::StartQueued() {
+  while (ClassState* next = NextClassToStart()) {
+    QueuedQuery query = std::move(next->queue.front());
+    next->queue.pop_front();
+    next->queued_gauge->Set(next->queue.size());
+    next->wait_seconds_counter->Increment(
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - query.submit_time)
+            .count());
+    Start(next, std::move(query.start_fn));
+  }
+}
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
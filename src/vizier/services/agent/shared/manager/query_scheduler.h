@@ -0,0 +1,141 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <prometheus/counter.h>
+#include <prometheus/gauge.h>
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <functional>
+
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/common/base/base.h"
+
+DECLARE_uint32(query_max_running);
+DECLARE_uint32(query_max_running_export);
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+/**
+ * The classes of queries that the QueryScheduler tells apart, from the most latency sensitive to
+ * the least.
+ */
+enum class QueryClass {
+  // Queries run by users, such as the live views.
+  kInteractive = 0,
+  // Queries that export data, which are run periodically by scripts.
+  kExport = 1,
+};
+
+constexpr size_t kNumQueryClasses = 2;
+
+/**
+ * Returns the class of a query from its plan: queries that export to OpenTelemetry are export
+ * queries, the others are interactive.
+ */
+QueryClass ClassifyQuery(const carnot::planpb::Plan& plan);
+
+/**
+ * QueryScheduler decides when the queries of an agent start running.
+ *
+ * A query starts right away if fewer than max_running queries are running, and fewer than the
+ * max_running of its class. Otherwise it waits in the FIFO queue of its class. When a query
+ * finishes, the next query is taken from the class with the fewest running queries relative to
+ * its weight, so that a burst of export queries doesn't delay the interactive ones.
+ *
+ * Not thread-safe, it is meant to be used from the dispatcher thread.
+ */
+class QueryScheduler : public NotCopyable {
+ public:
+  struct ClassConfig {
+    size_t max_running;
+    size_t weight;
+  };
+
+  struct Config {
+    size_t max_running;
+    std::array<ClassConfig, kNumQueryClasses> classes;
+  };
+
+  /**
+   * The config from the command line flags.
+   */
+  static Config DefaultConfig();
+
+  explicit QueryScheduler(const Config& config);
+
+  /**
+   * Calls start_fn to start the query when it is admitted, which may be right away.
+   */
+  void Submit(QueryClass query_class, std::function<void()> start_fn);
+
+  /**
+   * Must be called when a query that was started by the scheduler finishes. Starts the queued
+   * queries that can now run.
+   */
+  void Finish(QueryClass query_class);
+
+  /**
+   * Stops starting the queries of a class, which are queued until it is resumed. The running
+   * queries are not affected. Resuming starts the queued queries that can run.
+   */
+  void SetPaused(QueryClass query_class, bool paused);
+
+  size_t num_running(QueryClass query_class) const {
+    return classes_[static_cast<size_t>(query_class)].num_running;
+  }
+  size_t num_queued(QueryClass query_class) const {
+    return classes_[static_cast<size_t>(query_class)].queue.size();
+  }
+
+ private:
+  struct QueuedQuery {
+    std::function<void()> start_fn;
+    std::chrono::steady_clock::time_point submit_time;
+  };
+
+  struct ClassState {
+    ClassConfig config;
+    size_t num_running = 0;
+    bool paused = false;
+    std::deque<QueuedQuery> queue;
+
+    prometheus::Gauge* running_gauge = nullptr;
+    prometheus::Gauge* queued_gauge = nullptr;
+    prometheus::Counter* wait_seconds_counter = nullptr;
+  };
+
+  bool CanStart(const ClassState& cls) const;
+  void Start(ClassState* cls, std::function<void()> start_fn);
+  // Returns the class of the next queued query to start, or nullptr if none can start.
+  ClassState* NextClassToStart();
+  void StartQueued();
+
+  const size_t max_running_;
+  size_t num_running_ = 0;
+  std::array<ClassState, kNumQueryClasses> classes_;
+};
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/vizier/services/agent/shared/manager/query_scheduler.h"
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+using ::testing::ElementsAre;
+
+class QuerySchedulerTest : public ::testing::Test {
+ protected:
+  QueryScheduler::Config MakeConfig(size_t max_running, size_t max_running_export) {
+    QueryScheduler::Config config;
+    config.max_running = max_running;
+    config.classes[static_cast<size_t>(QueryClass::kInteractive)] = {max_running, 4};
+    config.classes[static_cast<size_t>(QueryClass::kExport)] = {max_running_export, 1};
+    return config;
+  }
+
+  void Submit(QueryScheduler* scheduler, QueryClass query_class, std::string name) {
+    scheduler->Submit(query_class, [this, name]() { started_.push_back(name); });
+  }
+
+  std::vector<std::string> started_;
+};
+
+TEST_F(QuerySchedulerTest, QueuesBeyondMaxRunning) {
+  QueryScheduler scheduler(MakeConfig(2, 2));
+  Submit(&scheduler, QueryClass::kInteractive, "q1");
+  Submit(&scheduler, QueryClass::kInteractive, "q2");
+  Submit(&scheduler, QueryClass::kInteractive, "q3");
+  EXPECT_THAT(started_, ElementsAre("q1", "q2"));
+  EXPECT_EQ(1, scheduler.num_queued(QueryClass::kInteractive));
+
+  scheduler.Finish(QueryClass::kInteractive);
+  EXPECT_THAT(started_, ElementsAre("q1", "q2", "q3"));
+  EXPECT_EQ(2, scheduler.num_running(QueryClass::kInteractive));
+  EXPECT_EQ(0, scheduler.num_queued(QueryClass::kInteractive));
+}
+
+TEST_F(QuerySchedulerTest, LimitsExportQueries) {
+  QueryScheduler scheduler(MakeConfig(4, 2));
+  Submit(&scheduler, QueryClass::kExport, "e1");
+  Submit(&scheduler, QueryClass::kExport, "e2");
+  Submit(&scheduler, QueryClass::kExport, "e3");
+  Submit(&scheduler, QueryClass::kInteractive, "i1");
+  EXPECT_THAT(started_, ElementsAre("e1", "e2", "i1"));
+  EXPECT_EQ(1, scheduler.num_queued(QueryClass::kExport));
+
+  scheduler.Finish(QueryClass::kInteractive);
+  EXPECT_THAT(started_, ElementsAre("e1", "e2", "i1"));
+
+  scheduler.Finish(QueryClass::kExport);
+  EXPECT_THAT(started_, ElementsAre("e1", "e2", "i1", "e3"));
+}
+
+TEST_F(QuerySchedulerTest, StartsQueuedQueriesByWeight) {
+  QueryScheduler scheduler(MakeConfig(2, 2));
+  Submit(&scheduler, QueryClass::kExport, "e1");
+  Submit(&scheduler, QueryClass::kExport, "e2");
+  Submit(&scheduler, QueryClass::kExport, "e3");
+  Submit(&scheduler, QueryClass::kInteractive, "i1");
+  Submit(&scheduler, QueryClass::kInteractive, "i2");
+  EXPECT_THAT(started_, ElementsAre("e1", "e2"));
+
+  // i1 was submitted after e3, but starts first because more export queries are running relative
+  // to their weight.
+  scheduler.Finish(QueryClass::kExport);
+  EXPECT_THAT(started_, ElementsAre("e1", "e2", "i1"));
+  // Now fewer export queries are running relative to their weight.
+  scheduler.Finish(QueryClass::kExport);
+  EXPECT_THAT(started_, ElementsAre("e1", "e2", "i1", "e3"));
+  scheduler.Finish(QueryClass::kInteractive);
+  EXPECT_THAT(started_, ElementsAre("e1", "e2", "i1", "e3", "i2"));
+}
+
+TEST_F(QuerySchedulerTest, PausedClassQueuesUntilResumed) {
+  QueryScheduler scheduler(MakeConfig(4, 2));
+  Submit(&scheduler, QueryClass::kExport, "e1");
+  scheduler.SetPaused(QueryClass::kExport, true);
+  Submit(&scheduler, QueryClass::kExport, "e2");
+  Submit(&scheduler, QueryClass::kInteractive, "i1");
+  EXPECT_THAT(started_, ElementsAre("e1", "i1"));
+  EXPECT_EQ(1, scheduler.num_queued(QueryClass::kExport));
+
+  // Finishing a query doesn't start the queries of the paused class.
+  scheduler.Finish(QueryClass::kExport);
+  EXPECT_THAT(started_, ElementsAre("e1", "i1"));
+
+  scheduler.SetPaused(QueryClass::kExport, false);
+  EXPECT_THAT(started_, ElementsAre("e1", "i1", "e2"));
+  EXPECT_EQ(0, scheduler.num_queued(QueryClass::kExport));
+}
+
+TEST(ClassifyQueryTest, ExportQueries) {
+  carnot::planpb::Plan plan;
+  auto* node = plan.add_nodes()->add_nodes();
+  node->mutable_op()->set_op_type(carnot::planpb::MEMORY_SOURCE_OPERATOR);
+  EXPECT_EQ(QueryClass::kInteractive, ClassifyQuery(plan));
+
+  node = plan.add_nodes()->add_nodes();
+  node->mutable_op()->set_op_type(carnot::planpb::OTEL_EXPORT_SINK_OPERATOR);
+  EXPECT_EQ(QueryClass::kExport, ClassifyQuery(plan));
+}
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
@@ -16,7 +16,11 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <string>
 #include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
 
 #include "src/vizier/services/agent/shared/manager/relation_info_manager.h"
 
@@ -24,14 +28,81 @@ namespace px {
 namespace vizier {
 namespace agent {
 
+services::metadata::TableInfo RelationInfoManager::ToTableInfo(
+    const RelationInfo& relation_info) {
+  services::metadata::TableInfo schema;
+  schema.set_name(relation_info.name);
+  schema.set_desc(relation_info.desc);
+  const table_store::schema::Relation& relation = relation_info.relation;
+  if (relation_info.tabletized) {
+    schema.set_tabletized(relation_info.tabletized);
+    schema.set_tabletization_key(relation.GetColumnName(relation_info.tabletization_key_idx));
+  }
+  for (size_t i = 0; i < relation.NumColumns(); ++i) {
+    auto* column = schema.add_columns();
+    column->set_name(relation.GetColumnName(i));
+    column->set_data_type(relation.GetColumnType(i));
+    column->set_desc(relation.GetColumnDesc(i));
+    column->set_semantic_type(relation.GetColumnSemanticType(i));
+    column->set_pattern_type(relation.GetColumnPatternType(i));
+  }
+  return schema;
+}
+
+StatusOr<bool> RelationInfoManager::CheckNewRelation(
+    const RelationInfo& relation_info, const services::metadata::TableInfo& table_info) const {
+  auto it = relation_info_map_.find(relation_info.name);
+  if (it == relation_info_map_.end()) {
+    return true;
+  }
+  if (it->second.table_info.SerializeAsString() != table_info.SerializeAsString()) {
+    return error::AlreadyExists("Relation '$0' already exists", relation_info.name);
+  }
+  return false;
+}
+
 Status RelationInfoManager::AddRelationInfo(RelationInfo relation_info) {
+  std::vector<RelationInfo> relation_infos;
+  relation_infos.push_back(std::move(relation_info));
+  return AddRelationInfos(std::move(relation_infos));
+}
+
+Status RelationInfoManager::AddRelationInfos(std::vector<RelationInfo> relation_infos) {
+  // Build the schema messages outside of the lock.
+  std::vector<services::metadata::TableInfo> table_infos;
+  table_infos.reserve(relation_infos.size());
+  for (const auto& relation_info : relation_infos) {
+    table_infos.push_back(ToTableInfo(relation_info));
+  }
+
   absl::base_internal::SpinLockHolder lock(&relation_info_map_lock_);
-  if (relation_info_map_.contains(relation_info.name)) {
-    return error::AlreadyExists("Relation '$0' already exists", relation_info.name);
+  std::vector<bool> is_new(relation_infos.size());
+  absl::flat_hash_map<std::string_view, size_t> batch_idx;
+  for (size_t i = 0; i < relation_infos.size(); ++i) {
+    const auto& name = relation_infos[i].name;
+    auto [it, inserted] = batch_idx.emplace(name, i);
+    if (!inserted) {
+      // A name repeated within the batch must also carry identical content.
+      if (table_infos[it->second].SerializeAsString() != table_infos[i].SerializeAsString()) {
+        return error::AlreadyExists("Relation '$0' already exists", name);
+      }
+      continue;
+    }
+    PX_ASSIGN_OR_RETURN(is_new[i], CheckNewRelation(relation_infos[i], table_infos[i]));
+  }
+
+  bool added = false;
+  for (size_t i = 0; i < relation_infos.size(); ++i) {
+    if (!is_new[i]) {
+      continue;
+    }
+    std::string name = relation_infos[i].name;
+    relation_info_map_[name] = {std::move(relation_infos[i]), std::move(table_infos[i])};
+    added = true;
+  }
+  if (added) {
+    has_updates_ = true;
   }
-  std::string name = relation_info.name;
-  relation_info_map_[name] = std::move(relation_info);
-  has_updates_ = true;
   return Status::OK();
 }
 
@@ -45,25 +116,29 @@ void RelationInfoManager::AddSchemaToUpdateInfo(messages::AgentUpdateInfo* updat
   absl::base_internal::SpinLockHolder lock(&relation_info_map_lock_);
 
   update_info->set_does_update_schema(true);
+  update_info->mutable_schema()->Reserve(relation_info_map_.size());
+  for (const auto& [name, entry] : relation_info_map_) {
+    *update_info->add_schema() = entry.table_info;
+  }
+  has_updates_ = false;
+}
+
+void RelationInfoManager::AddTableStatsToUpdateInfo(messages::AgentUpdateInfo* update_info) const {
+  if (table_store_ == nullptr) {
+    return;
+  }
+  absl::base_internal::SpinLockHolder lock(&relation_info_map_lock_);
+  auto* table_stats = update_info->mutable_table_stats();
   for (const auto& [name, relation_info] : relation_info_map_) {
-    auto* schema = update_info->add_schema();
-    schema->set_name(relation_info.name);
-    schema->set_desc(relation_info.desc);
-    const table_store::schema::Relation& relation = relation_info.relation;
-    if (relation_info.tabletized) {
-      schema->set_tabletized(relation_info.tabletized);
-      schema->set_tabletization_key(relation.GetColumnName(relation_info.tabletization_key_idx));
-    }
-    for (size_t i = 0; i < relation.NumColumns(); ++i) {
-      auto* column = schema->add_columns();
-      column->set_name(relation.GetColumnName(i));
-      column->set_data_type(relation.GetColumnType(i));
-      column->set_desc(relation.GetColumnDesc(i));
-      column->set_semantic_type(relation.GetColumnSemanticType(i));
-      column->set_pattern_type(relation.GetColumnPatternType(i));
+    table_store::Table* table = table_store_->GetTable(name);
+    if (table == nullptr) {
+      continue;
     }
+    table_store::TableStats stats = table->GetTableStats();
+    auto& stats_pb = (*table_stats)[name];
+    stats_pb.set_num_rows(stats.num_rows);
+    stats_pb.set_bytes(stats.bytes);
   }
-  has_updates_ = false;
 }
 
 }  // namespace agent
@@ -24,6 +24,7 @@
 #include <absl/container/btree_map.h>
 
 #include "src/shared/schema/utils.h"
+#include "src/table_store/table_store.h"
 #include "src/vizier/messages/messagespb/messages.pb.h"
 
 namespace px {
@@ -35,15 +36,32 @@ namespace agent {
  */
 class RelationInfoManager {
  public:
+  RelationInfoManager() = default;
+  /**
+   * @brief Creates a manager that also reports the size of the tables in table_store.
+   */
+  explicit RelationInfoManager(table_store::TableStore* table_store) : table_store_(table_store) {}
+
   /**
    * @brief Adds the relation info to the agent state. Conflicting relation will
-   * will be rejected with error.
+   * will be rejected with error. Re-adding an identical relation is a no-op and does not
+   * mark the schema as updated.
    *
    * @param relation_info: The new relation to add.
    * @return Status: Error if relation is a conflict.
    */
   Status AddRelationInfo(RelationInfo relation_info);
 
+  /**
+   * @brief Adds a batch of relation infos under a single lock. The batch is all or nothing: if
+   * any relation conflicts with an existing one (or another in the batch), none are added.
+   * The schema is marked as updated at most once, and only if a relation was new.
+   *
+   * @param relation_infos: The new relations to add.
+   * @return Status: Error if any relation is a conflict.
+   */
+  Status AddRelationInfos(std::vector<RelationInfo> relation_infos);
+
   /**
    * Checks to see if a relation with the given name exists.
    * @param name The name of the relation.
@@ -60,12 +78,36 @@ class RelationInfoManager {
    */
   void AddSchemaToUpdateInfo(messages::AgentUpdateInfo* update_info) const;
 
+  /**
+   * @brief Adds the current row and byte counts of each relation's table to the update_info
+   * message. Does nothing if the manager has no table store.
+   *
+   * @param update_info: the message that should receive the table stats.
+   */
+  void AddTableStatsToUpdateInfo(messages::AgentUpdateInfo* update_info) const;
+
   bool has_updates() const { return has_updates_; }
 
  private:
+  struct RelationEntry {
+    RelationInfo relation_info;
+    // The schema message for the relation, built once when it is added so heartbeats only copy
+    // it. Its serialized form identifies relations with identical content.
+    services::metadata::TableInfo table_info;
+  };
+
+  static services::metadata::TableInfo ToTableInfo(const RelationInfo& relation_info);
+  // Returns true if the relation is new, false if an identical relation already exists, and an
+  // error if a different relation with the same name exists.
+  StatusOr<bool> CheckNewRelation(const RelationInfo& relation_info,
+                                  const services::metadata::TableInfo& table_info) const
+      EXCLUSIVE_LOCKS_REQUIRED(relation_info_map_lock_);
+
+  table_store::TableStore* table_store_ = nullptr;
   mutable std::atomic<bool> has_updates_ = false;
   mutable absl::base_internal::SpinLock relation_info_map_lock_;
-  absl::btree_map<std::string, RelationInfo> relation_info_map_ GUARDED_BY(relation_info_map_lock_);
+  absl::btree_map<std::string, RelationEntry> relation_info_map_
+      GUARDED_BY(relation_info_map_lock_);
 };
 
 }  // namespace agent
@@ -22,10 +22,12 @@
 #include <gtest/gtest.h>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "src/vizier/services/agent/shared/manager/relation_info_manager.h"
 
 #include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
 
 namespace px {
 namespace vizier {
@@ -157,6 +159,82 @@ TEST_F(RelationInfoManagerTest, test_tabletization_keys) {
   EXPECT_THAT(update_info, EqualsProto(kAgentUpdateInfoSchemaHasTablets));
 }
 
+TEST_F(RelationInfoManagerTest, table_stats) {
+  Relation relation0({types::TIME64NS, types::INT64}, {"time_", "count"});
+  Relation relation1({types::TIME64NS, types::FLOAT64}, {"time_", "gauge"});
+
+  table_store::TableStore table_store;
+  auto table0 = table_store::Table::Create("relation0", relation0);
+  table_store.AddTable("relation0", table0);
+
+  table_store::schema::RowBatch rb(table_store::schema::RowDescriptor(relation0.col_types()), 3);
+  std::vector<types::Time64NSValue> time_col = {1, 2, 3};
+  std::vector<types::Int64Value> count_col = {4, 5, 6};
+  EXPECT_OK(rb.AddColumn(types::ToArrow(time_col, arrow::default_memory_pool())));
+  EXPECT_OK(rb.AddColumn(types::ToArrow(count_col, arrow::default_memory_pool())));
+  EXPECT_OK(table0->WriteRowBatch(rb));
+
+  RelationInfoManager relation_info_manager(&table_store);
+  EXPECT_OK(relation_info_manager.AddRelationInfo(
+      RelationInfo("relation0", /* id */ 0, "desc0", relation0)));
+  // relation1 has no table in the table store yet.
+  EXPECT_OK(relation_info_manager.AddRelationInfo(
+      RelationInfo("relation1", /* id */ 1, "desc1", relation1)));
+
+  messages::AgentUpdateInfo update_info;
+  relation_info_manager.AddTableStatsToUpdateInfo(&update_info);
+  ASSERT_EQ(update_info.table_stats_size(), 1);
+  const auto& stats = update_info.table_stats().at("relation0");
+  EXPECT_EQ(stats.num_rows(), 3);
+  EXPECT_GT(stats.bytes(), 0);
+
+  // Without a table store, no stats are reported.
+  messages::AgentUpdateInfo empty_update_info;
+  relation_info_manager_->AddTableStatsToUpdateInfo(&empty_update_info);
+  EXPECT_EQ(empty_update_info.table_stats_size(), 0);
+}
+
+TEST_F(RelationInfoManagerTest, identical_relations_are_deduped) {
+  Relation relation0({types::TIME64NS, types::INT64}, {"time_", "count"});
+  Relation relation1({types::TIME64NS, types::FLOAT64}, {"time_", "gauge"});
+
+  EXPECT_OK(relation_info_manager_->AddRelationInfo(
+      RelationInfo("relation0", /* id */ 0, "desc0", relation0)));
+  messages::AgentUpdateInfo update_info0;
+  relation_info_manager_->AddSchemaToUpdateInfo(&update_info0);
+  EXPECT_FALSE(relation_info_manager_->has_updates());
+
+  // Re-adding the same relation does not trigger another schema update.
+  EXPECT_OK(relation_info_manager_->AddRelationInfo(
+      RelationInfo("relation0", /* id */ 0, "desc0", relation0)));
+  EXPECT_FALSE(relation_info_manager_->has_updates());
+
+  // A different relation under the same name is still a conflict.
+  EXPECT_NOT_OK(relation_info_manager_->AddRelationInfo(
+      RelationInfo("relation0", /* id */ 0, "desc0", relation1)));
+  EXPECT_FALSE(relation_info_manager_->has_updates());
+
+  // A batch with a conflict adds nothing.
+  std::vector<RelationInfo> conflicting_batch;
+  conflicting_batch.emplace_back("relation1", /* id */ 1, "desc1", relation1);
+  conflicting_batch.emplace_back("relation0", /* id */ 0, "other desc", relation0);
+  EXPECT_NOT_OK(relation_info_manager_->AddRelationInfos(std::move(conflicting_batch)));
+  EXPECT_FALSE(relation_info_manager_->HasRelation("relation1"));
+  EXPECT_FALSE(relation_info_manager_->has_updates());
+
+  // A batch mixing known and new relations adds the new ones as one update.
+  std::vector<RelationInfo> batch;
+  batch.emplace_back("relation0", /* id */ 0, "desc0", relation0);
+  batch.emplace_back("relation1", /* id */ 1, "desc1", relation1);
+  batch.emplace_back("relation1", /* id */ 1, "desc1", relation1);
+  EXPECT_OK(relation_info_manager_->AddRelationInfos(std::move(batch)));
+  EXPECT_TRUE(relation_info_manager_->has_updates());
+
+  messages::AgentUpdateInfo update_info;
+  relation_info_manager_->AddSchemaToUpdateInfo(&update_info);
+  EXPECT_THAT(update_info, EqualsProto(kAgentUpdateInfoSchemaNoTablets));
+}
+
 }  // namespace agent
 }  // namespace vizier
 }  // namespace px
@@ -31,6 +31,7 @@ import (
 	"github.com/prometheus/client_golang/prometheus/promauto"
 	log "github.com/sirupsen/logrus"
 
+	"px.dev/pixie/src/carnot/planner/distributedpb"
 	"px.dev/pixie/src/shared/k8s/metadatapb"
 	types "px.dev/pixie/src/shared/types/gotypes"
 	"px.dev/pixie/src/utils"
@@ -130,6 +131,8 @@ type Manager interface {
 
 	// GetComputedSchema gets the computed schemas
 	GetComputedSchema() (*storepb.ComputedSchema, error)
+	// GetTableStats gets the size estimates of the tables, summed over the agents.
+	GetTableStats() map[string]*distributedpb.TableStatsInfo
 	// GetAgentIDForHostnamePair gets the agent for the given hostnamePair, if it exists.
 	GetAgentIDForHostnamePair(hnPair *HostnameIPPair) (string, error)
 
@@ -173,6 +176,12 @@ type ManagerImpl struct {
 	// Protects agentUpdateTrackers.
 	agentUpdateTrackersMutex sync.Mutex
 
+	// The latest table size estimates reported by each agent, keyed by table name. These are only
+	// estimates for the planner, so they are kept in memory rather than in the metadata store.
+	agentTableStats map[uuid.UUID]map[string]*distributedpb.TableStatsInfo
+	// Protects agentTableStats.
+	agentTableStatsMutex sync.Mutex
+
 	// Prometheus counter to keep track of agent registrations.
 	agentRegCounter *prometheus.CounterVec
 }
@@ -186,6 +195,7 @@ func NewManager(agtStore Store, cidr CIDRInfoProvider, conn *nats.Conn) *Manager
 		cidr:                cidr,
 		conn:                conn,
 		agentUpdateTrackers: make(map[uuid.UUID]*agentUpdateTracker),
+		agentTableStats:     make(map[uuid.UUID]map[string]*distributedpb.TableStatsInfo),
 		agentRegCounter:     agentRegCounter,
 	}
 
@@ -249,6 +259,10 @@ func (m *ManagerImpl) deleteAgentWrapper(agentID uuid.UUID) error {
 		return err
 	}
 
+	m.agentTableStatsMutex.Lock()
+	delete(m.agentTableStats, agentID)
+	m.agentTableStatsMutex.Unlock()
+
 	m.agentUpdateTrackersMutex.Lock()
 	defer m.agentUpdateTrackersMutex.Unlock()
 
@@ -370,6 +384,31 @@ func (m *ManagerImpl) updateAgentDataInfoWrapper(agentID uuid.UUID, agentDataInf
 	return nil
 }
 
+// updateAgentTableStats records the table size estimates sent by an agent. Unless full is set, they
+// only hold the tables that changed, which are merged into the previous estimates of the agent.
+// The schemas are marked as updated across all of the agent update trackers, so that the estimates
+// reach the planner.
+func (m *ManagerImpl) updateAgentTableStats(agentID uuid.UUID,
+	tableStats map[string]*distributedpb.TableStatsInfo, full bool) {
+	m.agentTableStatsMutex.Lock()
+	agentTableStats, ok := m.agentTableStats[agentID]
+	if full || !ok {
+		agentTableStats = make(map[string]*distributedpb.TableStatsInfo)
+		m.agentTableStats[agentID] = agentTableStats
+	}
+	for name, stats := range tableStats {
+		agentTableStats[name] = stats
+	}
+	m.agentTableStatsMutex.Unlock()
+
+	m.agentUpdateTrackersMutex.Lock()
+	defer m.agentUpdateTrackersMutex.Unlock()
+
+	for _, tracker := range m.agentUpdateTrackers {
+		tracker.schemaUpdated = true
+	}
+}
+
 // ApplyAgentUpdate updates the metadata store with the information from the agent update.
 func (m *ManagerImpl) ApplyAgentUpdate(update *Update) error {
 	resp, err := m.agtStore.GetAgent(update.AgentID)
@@ -396,6 +435,10 @@ func (m *ManagerImpl) ApplyAgentUpdate(update *Update) error {
 			return err
 		}
 	}
+	if len(update.UpdateInfo.TableStats) > 0 || update.UpdateInfo.FullTableStats {
+		m.updateAgentTableStats(update.AgentID, update.UpdateInfo.TableStats,
+			update.UpdateInfo.FullTableStats)
+	}
 	if !update.UpdateInfo.DoesUpdateSchema {
 		return nil
 	}
@@ -693,6 +736,26 @@ func (m *ManagerImpl) GetComputedSchema() (*storepb.ComputedSchema, error) {
 	return m.agtStore.GetComputedSchema()
 }
 
+// GetTableStats gets the size estimates of the tables, summed over the agents that reported them.
+func (m *ManagerImpl) GetTableStats() map[string]*distributedpb.TableStatsInfo {
+	m.agentTableStatsMutex.Lock()
+	defer m.agentTableStatsMutex.Unlock()
+
+	tableStats := make(map[string]*distributedpb.TableStatsInfo)
+	for _, agentTableStats := range m.agentTableStats {
+		for name, stats := range agentTableStats {
+			total, ok := tableStats[name]
+			if !ok {
+				total = &distributedpb.TableStatsInfo{}
+				tableStats[name] = total
+			}
+			total.NumRows += stats.NumRows
+			total.Bytes += stats.Bytes
+		}
+	}
+	return tableStats
+}
+
 // GetAgentIDForHostnamePair gets the agent for the given hostnamePair, if it exists.
 func (m *ManagerImpl) GetAgentIDForHostnamePair(hnPair *HostnameIPPair) (string, error) {
 	return m.agtStore.GetAgentIDForHostnamePair(hnPair)
@@ -741,6 +741,98 @@ func TestAgent_GetAgentUpdate(t *testing.T) {
 	assert.NotNil(t, err)
 }
 
+func TestAgent_TableStats(t *testing.T) {
+	_, agtMgr, _, cleanup := setupManager(t)
+	defer cleanup()
+
+	agUUID1, err := uuid.FromString(testutils.UnhealthyAgentUUID)
+	require.NoError(t, err)
+	agUUID2, err := uuid.FromString(testutils.ExistingAgentUUID)
+	require.NoError(t, err)
+
+	// Read the initial agent state.
+	cursor := agtMgr.NewAgentUpdateCursor()
+	_, _, err = agtMgr.GetAgentUpdates(cursor)
+	require.NoError(t, err)
+
+	err = agtMgr.ApplyAgentUpdate(&agent.Update{
+		UpdateInfo: &messagespb.AgentUpdateInfo{
+			TableStats: map[string]*distributedpb.TableStatsInfo{
+				"a_table": {NumRows: 10, Bytes: 100},
+			},
+		},
+		AgentID: agUUID1,
+	})
+	require.NoError(t, err)
+	err = agtMgr.ApplyAgentUpdate(&agent.Update{
+		UpdateInfo: &messagespb.AgentUpdateInfo{
+			TableStats: map[string]*distributedpb.TableStatsInfo{
+				"a_table": {NumRows: 5, Bytes: 50},
+				"b_table": {NumRows: 1, Bytes: 2},
+			},
+		},
+		AgentID: agUUID2,
+	})
+	require.NoError(t, err)
+
+	// The schema is sent again, so that the planner gets the new estimates.
+	_, schema, err := agtMgr.GetAgentUpdates(cursor)
+	require.NoError(t, err)
+	assert.NotNil(t, schema)
+	assert.Equal(t, map[string]*distributedpb.TableStatsInfo{
+		"a_table": {NumRows: 15, Bytes: 150},
+		"b_table": {NumRows: 1, Bytes: 2},
+	}, agtMgr.GetTableStats())
+
+	// Updates only hold the tables that changed.
+	err = agtMgr.ApplyAgentUpdate(&agent.Update{
+		UpdateInfo: &messagespb.AgentUpdateInfo{
+			TableStats: map[string]*distributedpb.TableStatsInfo{
+				"a_table": {NumRows: 20, Bytes: 200},
+			},
+		},
+		AgentID: agUUID1,
+	})
+	require.NoError(t, err)
+	err = agtMgr.ApplyAgentUpdate(&agent.Update{
+		UpdateInfo: &messagespb.AgentUpdateInfo{
+			TableStats: map[string]*distributedpb.TableStatsInfo{
+				"c_table": {NumRows: 3, Bytes: 4},
+			},
+		},
+		AgentID: agUUID1,
+	})
+	require.NoError(t, err)
+	assert.Equal(t, map[string]*distributedpb.TableStatsInfo{
+		"a_table": {NumRows: 25, Bytes: 250},
+		"b_table": {NumRows: 1, Bytes: 2},
+		"c_table": {NumRows: 3, Bytes: 4},
+	}, agtMgr.GetTableStats())
+
+	// Full updates replace the previous estimates of the agent.
+	err = agtMgr.ApplyAgentUpdate(&agent.Update{
+		UpdateInfo: &messagespb.AgentUpdateInfo{
+			TableStats: map[string]*distributedpb.TableStatsInfo{
+				"a_table": {NumRows: 20, Bytes: 200},
+			},
+			FullTableStats: true,
+		},
+		AgentID: agUUID1,
+	})
+	require.NoError(t, err)
+	assert.Equal(t, map[string]*distributedpb.TableStatsInfo{
+		"a_table": {NumRows: 25, Bytes: 250},
+		"b_table": {NumRows: 1, Bytes: 2},
+	}, agtMgr.GetTableStats())
+
+	// The estimates of deleted agents are dropped.
+	err = agtMgr.DeleteAgent(agUUID2)
+	require.NoError(t, err)
+	assert.Equal(t, map[string]*distributedpb.TableStatsInfo{
+		"a_table": {NumRows: 20, Bytes: 200},
+	}, agtMgr.GetTableStats())
+}
+
 func TestAgent_UpdateConfig(t *testing.T) {
 	_, agtMgr, nc, cleanup := setupManager(t)
 	defer cleanup()
@@ -104,7 +104,8 @@ func convertToRelationMap(computedSchema *storepb.ComputedSchema) (*schemapb.Sch
 	return respSchemaPb, nil
 }
 
-func convertToSchemaInfo(computedSchema *storepb.ComputedSchema) ([]*distributedpb.SchemaInfo, error) {
+func convertToSchemaInfo(computedSchema *storepb.ComputedSchema,
+	tableStats map[string]*distributedpb.TableStatsInfo) ([]*distributedpb.SchemaInfo, error) {
 	schemaInfo := make([]*distributedpb.SchemaInfo, len(computedSchema.Tables))
 
 	for idx, schema := range computedSchema.Tables {
@@ -131,6 +132,7 @@ func convertToSchemaInfo(computedSchema *storepb.ComputedSchema) ([]*distributed
 			Name:      schema.Name,
 			Relation:  schemaPb,
 			AgentList: agentIDs.AgentID,
+			Stats:     tableStats[schema.Name],
 		}
 	}
 
@@ -278,7 +280,7 @@ func (s *Server) GetAgentUpdates(req *metadatapb.AgentUpdatesRequest, srv metada
 					// That way, the schema will never prematurely refer to an agent that the client
 					// is currently unaware of.
 					if finishedUpdates && !finishedSchema {
-						schemas, err := convertToSchemaInfo(newComputedSchema)
+						schemas, err := convertToSchemaInfo(newComputedSchema, s.agtMgr.GetTableStats())
 						if err != nil {
 							log.WithError(err).Errorf("Received error converting schemas in GetAgentUpdates")
 							return err
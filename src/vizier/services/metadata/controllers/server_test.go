@@ -890,6 +890,15 @@ func TestGetAgentUpdates(t *testing.T) {
 		Return(nil, nil, nil).
 		AnyTimes()
 
+	// Table stats, for each of the two schema updates.
+	mockAgtMgr.
+		EXPECT().
+		GetTableStats().
+		Return(map[string]*distributedpb.TableStatsInfo{
+			"table1": {NumRows: 10, Bytes: 100},
+		}).
+		Times(2)
+
 	// Remove cursor
 	mockAgtMgr.
 		EXPECT().
@@ -1019,10 +1028,12 @@ func TestGetAgentUpdates(t *testing.T) {
 	assert.Equal(t, 2, len(r1.AgentSchemas[0].AgentList))
 	assert.Equal(t, u1pb, r1.AgentSchemas[0].AgentList[0])
 	assert.Equal(t, u2pb, r1.AgentSchemas[0].AgentList[1])
+	assert.Equal(t, &distributedpb.TableStatsInfo{NumRows: 10, Bytes: 100}, r1.AgentSchemas[0].Stats)
 	assert.Equal(t, "table2", r1.AgentSchemas[1].Name)
 	assert.Equal(t, 2, len(r1.AgentSchemas[1].Relation.Columns))
 	assert.Equal(t, 1, len(r1.AgentSchemas[1].AgentList))
 	assert.Equal(t, u1pb, r1.AgentSchemas[1].AgentList[0])
+	assert.Nil(t, r1.AgentSchemas[1].Stats)
 
 	// Check empty message
 	r2 := resps[2]